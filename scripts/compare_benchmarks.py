@@ -0,0 +1,61 @@
+#!/usr/bin/env python3
+#
+# Copyright (c) 2021 vesoft inc. All rights reserved.
+#
+# This source code is licensed under Apache 2.0 License,
+# attached with Common Clause Condition 1.0, found in the LICENSES directory.
+#
+# Compare two runs of a folly benchmark, each of the json printed by --json, or written by
+# --bm_json_verbose, and exit with 1 if any benchmark of the new run is slower than the base
+# one by more than the threshold in percent.
+#
+#   scripts/compare_benchmarks.py base.json new.json --threshold=10
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    """Return the time in ns of each benchmark"""
+    with open(path) as f:
+        data = json.load(f)
+    if isinstance(data, dict):
+        # --json, the time is in ps
+        return {name: time / 1000.0 for name, time in data.items()}
+    # --bm_json_verbose, the rows of [file, name, time in ns]
+    return {row[1]: float(row[2]) for row in data if not row[1].startswith('-')}
+
+
+def main():
+    parser = argparse.ArgumentParser(description='Compare two runs of a benchmark')
+    parser.add_argument('base', help='the json of the base run')
+    parser.add_argument('new', help='the json of the new run')
+    parser.add_argument('--threshold', type=float, default=10.0,
+                        help='the percent a benchmark may be slower by')
+    args = parser.parse_args()
+
+    base = load(args.base)
+    new = load(args.new)
+    regressed = []
+    print('%-40s %14s %14s %9s' % ('benchmark', 'base(ns)', 'new(ns)', 'change'))
+    for name in sorted(set(base) | set(new)):
+        if name not in base or name not in new:
+            print('%-40s %s' % (name, 'only in ' + ('new' if name in new else 'base')))
+            continue
+        change = (new[name] - base[name]) / base[name] * 100 if base[name] > 0 else 0.0
+        mark = ''
+        if change > args.threshold:
+            regressed.append(name)
+            mark = ' REGRESSED'
+        print('%-40s %14.2f %14.2f %+8.2f%%%s' % (name, base[name], new[name], change, mark))
+
+    if regressed:
+        print('%d benchmarks are slower by more than %.2f%%: %s'
+              % (len(regressed), args.threshold, ', '.join(regressed)))
+        return 1
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
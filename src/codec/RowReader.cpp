@@ -55,6 +55,31 @@ RowReader::Iterator& RowReader::Iterator::operator++() {
  *
  ********************************************/
 
+bool RowReader::getNumericByIndex(const int64_t index, Numeric* value) const noexcept {
+    auto v = getValueByIndex(index);
+    if (v.isInt()) {
+        value->isInt_ = true;
+        value->int_ = v.getInt();
+        return true;
+    } else if (v.isFloat()) {
+        value->isInt_ = false;
+        value->float_ = v.getFloat();
+        return true;
+    }
+    return false;
+}
+
+
+void RowReader::decodeAll(std::vector<Value>& values) const noexcept {
+    auto num = numFields();
+    values.clear();
+    values.reserve(num);
+    for (size_t i = 0; i < num; i++) {
+        values.emplace_back(getValueByIndex(i));
+    }
+}
+
+
 bool RowReader::resetImpl(meta::SchemaProviderIf const* schema,
                           folly::StringPiece row) noexcept {
     schema_ = schema;
@@ -65,6 +65,14 @@ public:
     };
 
 
+    // A numeric field, the integer types and timestamp are read as int, float and double
+    // are read as float
+    struct Numeric {
+        bool        isInt_;
+        int64_t     int_;
+        double      float_;
+    };
+
 public:
     virtual ~RowReader() = default;
 
@@ -72,6 +80,14 @@ public:
     virtual Value getValueByIndex(const int64_t index) const noexcept = 0;
     virtual int64_t getTimestamp() const noexcept = 0;
 
+    // Read a numeric field without constructing a Value. Return false if the field is null,
+    // not found or not numeric, then the caller could read it by getValueByIndex.
+    virtual bool getNumericByIndex(const int64_t index, Numeric* value) const noexcept;
+
+    // Decode all fields in the order of schema into values, which is cleared first. It is the
+    // same as calling getValueByIndex for each field, but the reader could do it in one pass.
+    virtual void decodeAll(std::vector<Value>& values) const noexcept;
+
     virtual int32_t readerVer() const noexcept = 0;
 
     // Return the number of bytes used for the header info
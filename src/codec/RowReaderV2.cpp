@@ -26,6 +26,14 @@ bool RowReaderV2::resetImpl(meta::SchemaProviderIf const* schema,
     DCHECK_EQ(schemaVer, schema_->getVersion());
 #endif
 
+    if (schema_ != layoutSchema_ || schema_->getVersion() != layoutVer_) {
+        buildLayouts();
+    }
+    return true;
+}
+
+
+void RowReaderV2::buildLayouts() {
     // Null flags
     size_t numNullables = schema_->getNumNullableFields();
     if (numNullables > 0) {
@@ -34,7 +42,20 @@ bool RowReaderV2::resetImpl(meta::SchemaProviderIf const* schema,
         numNullBytes_ = 0;
     }
 
-    return true;
+    auto numFields = schema_->getNumFields();
+    layouts_.clear();
+    layouts_.reserve(numFields);
+    for (size_t i = 0; i < numFields; i++) {
+        auto field = schema_->field(i);
+        layouts_.emplace_back(FieldLayout{field->type(),
+                                          field->nullable()
+                                              ? static_cast<int32_t>(field->nullFlagPos())
+                                              : -1,
+                                          field->offset(),
+                                          field->size()});
+    }
+    layoutSchema_ = schema_;
+    layoutVer_ = schema_->getVersion();
 }
 
 
@@ -54,18 +75,56 @@ Value RowReaderV2::getValueByName(const std::string& prop) const noexcept {
 
 
 Value RowReaderV2::getValueByIndex(const int64_t index) const noexcept {
-    if (index < 0 || static_cast<size_t>(index) >= schema_->getNumFields()) {
+    if (index < 0 || static_cast<size_t>(index) >= layouts_.size()) {
         return Value(NullType::UNKNOWN_PROP);
     }
 
-    auto field = schema_->field(index);
-    size_t offset = headerLen_ + numNullBytes_ + field->offset();
-
-    if (field->nullable() && isNull(field->nullFlagPos())) {
+    const auto& field = layouts_[index];
+    if (field.nullFlagPos_ >= 0 && isNull(field.nullFlagPos_)) {
         return NullType::__NULL__;
     }
+    return decodeValue(field);
+}
+
+
+void RowReaderV2::decodeAll(std::vector<Value>& values) const noexcept {
+    values.clear();
+    values.reserve(layouts_.size());
+    // Most rows have no null field, then the null flags are not checked field by field
+    auto checkNull = hasNull();
+    for (const auto& field : layouts_) {
+        if (checkNull && field.nullFlagPos_ >= 0 && isNull(field.nullFlagPos_)) {
+            values.emplace_back(NullType::__NULL__);
+        } else {
+            values.emplace_back(decodeValue(field));
+        }
+    }
+}
 
-    switch (field->type()) {
+
+bool RowReaderV2::hasNull() const {
+    const char* flags = data_.data() + headerLen_;
+    size_t i = 0;
+    for (; i + sizeof(uint64_t) <= numNullBytes_; i += sizeof(uint64_t)) {
+        uint64_t word;
+        memcpy(&word, flags + i, sizeof(uint64_t));
+        if (word != 0) {
+            return true;
+        }
+    }
+    for (; i < numNullBytes_; i++) {
+        if (flags[i] != 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+
+Value RowReaderV2::decodeValue(const FieldLayout& field) const noexcept {
+    size_t offset = headerLen_ + numNullBytes_ + field.offset_;
+
+    switch (field.type_) {
         case meta::cpp2::PropertyType::BOOL: {
             if (data_[offset]) {
                 return true;
@@ -120,7 +179,7 @@ Value RowReaderV2::getValueByIndex(const int64_t index) const noexcept {
             return std::string(&data_[strOffset], strLen);
         }
         case meta::cpp2::PropertyType::FIXED_STRING: {
-            return std::string(&data_[offset], field->size());
+            return std::string(&data_[offset], field.size_);
         }
         case meta::cpp2::PropertyType::TIMESTAMP: {
             Timestamp ts;
@@ -197,6 +256,65 @@ Value RowReaderV2::getValueByIndex(const int64_t index) const noexcept {
     LOG(FATAL) << "Should not reach here";
 }
 
+bool RowReaderV2::getNumericByIndex(const int64_t index, Numeric* value) const noexcept {
+    if (index < 0 || static_cast<size_t>(index) >= layouts_.size()) {
+        return false;
+    }
+
+    const auto& field = layouts_[index];
+    size_t offset = headerLen_ + numNullBytes_ + field.offset_;
+
+    if (field.nullFlagPos_ >= 0 && isNull(field.nullFlagPos_)) {
+        return false;
+    }
+
+    switch (field.type_) {
+        case meta::cpp2::PropertyType::INT8: {
+            value->isInt_ = true;
+            value->int_ = static_cast<int8_t>(data_[offset]);
+            return true;
+        }
+        case meta::cpp2::PropertyType::INT16: {
+            int16_t val;
+            memcpy(reinterpret_cast<void*>(&val), &data_[offset], sizeof(int16_t));
+            value->isInt_ = true;
+            value->int_ = val;
+            return true;
+        }
+        case meta::cpp2::PropertyType::INT32: {
+            int32_t val;
+            memcpy(reinterpret_cast<void*>(&val), &data_[offset], sizeof(int32_t));
+            value->isInt_ = true;
+            value->int_ = val;
+            return true;
+        }
+        case meta::cpp2::PropertyType::INT64:
+        case meta::cpp2::PropertyType::TIMESTAMP: {
+            int64_t val;
+            memcpy(reinterpret_cast<void*>(&val), &data_[offset], sizeof(int64_t));
+            value->isInt_ = true;
+            value->int_ = val;
+            return true;
+        }
+        case meta::cpp2::PropertyType::FLOAT: {
+            float val;
+            memcpy(reinterpret_cast<void*>(&val), &data_[offset], sizeof(float));
+            value->isInt_ = false;
+            value->float_ = val;
+            return true;
+        }
+        case meta::cpp2::PropertyType::DOUBLE: {
+            double val;
+            memcpy(reinterpret_cast<void*>(&val), &data_[offset], sizeof(double));
+            value->isInt_ = false;
+            value->float_ = val;
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
 int64_t RowReaderV2::getTimestamp() const noexcept {
     return *reinterpret_cast<const int64_t*>(data_.begin() + (data_.size() - sizeof(int64_t)));
 }
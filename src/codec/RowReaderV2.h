@@ -30,6 +30,8 @@ public:
 
     Value getValueByName(const std::string& prop) const noexcept override;
     Value getValueByIndex(const int64_t index) const noexcept override;
+    bool getNumericByIndex(const int64_t index, Numeric* value) const noexcept override;
+    void decodeAll(std::vector<Value>& values) const noexcept override;
     int64_t getTimestamp() const noexcept override;
 
     int32_t readerVer() const noexcept override {
@@ -45,13 +47,37 @@ protected:
         noexcept override;
 
 private:
+    // The layout of a field copied from the schema, so the fields could be decoded without
+    // calling the virtual methods of the schema and its fields
+    struct FieldLayout {
+        meta::cpp2::PropertyType    type_;
+        // -1 when the field is not nullable
+        int32_t                     nullFlagPos_;
+        size_t                      offset_;
+        size_t                      size_;
+    };
+
     size_t headerLen_;
     size_t numNullBytes_;
 
+    // The layouts of all fields of layoutSchema_. The reader is usually reset with the same
+    // schema row by row, so they are only built when the schema is changed
+    const meta::SchemaProviderIf* layoutSchema_{nullptr};
+    SchemaVer layoutVer_{-1};
+    std::vector<FieldLayout> layouts_;
+
     RowReaderV2() = default;
 
+    void buildLayouts();
+
     // Check whether the flag at the given position is set or not
     bool isNull(size_t pos) const;
+
+    // Whether any null flag is set, the flags are checked 8 bytes at a time
+    bool hasNull() const;
+
+    // Decode the value of a field which is not null
+    Value decodeValue(const FieldLayout& field) const noexcept;
 };
 
 }  // namespace nebula
@@ -96,6 +96,16 @@ public:
         return currReader_->getValueByIndex(index);
     }
 
+    bool getNumericByIndex(const int64_t index, Numeric* value) const noexcept override {
+        DCHECK(!!currReader_);
+        return currReader_->getNumericByIndex(index, value);
+    }
+
+    void decodeAll(std::vector<Value>& values) const noexcept override {
+        DCHECK(!!currReader_);
+        currReader_->decodeAll(values);
+    }
+
     int64_t getTimestamp() const noexcept override {
         DCHECK(!!currReader_);
         return currReader_->getTimestamp();
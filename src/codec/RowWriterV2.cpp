@@ -90,8 +90,9 @@ RowWriterV2::RowWriterV2(const meta::SchemaProviderIf* schema, std::string&& enc
         : schema_(schema)
         , finished_(false)
         , outOfSpaceStr_(false) {
-    auto len = encoded.size();
-    buf_ = std::move(encoded).substr(0, len - sizeof(int64_t));
+    buf_ = std::move(encoded);
+    // Drop the timestamp, it is appended again in finish()
+    buf_.resize(buf_.size() - sizeof(int64_t));
     processV2EncodedStr();
 }
 
@@ -164,8 +165,19 @@ void RowWriterV2::processV2EncodedStr() noexcept {
         numNullBytes_ = 0;
     }
 
-    approxStrLen_ = buf_.size() - headerLen_ - numNullBytes_ - schema_->size() - sizeof(int64_t);
-    isSet_.resize(schema_->getNumFields(), true);
+    // The timestamp has been removed from buf_ already
+    approxStrLen_ = buf_.size() - headerLen_ - numNullBytes_ - schema_->size();
+    isSet_.assign(schema_->getNumFields(), true);
+}
+
+
+void RowWriterV2::reset(std::string&& encoded) noexcept {
+    buf_ = std::move(encoded);
+    buf_.resize(buf_.size() - sizeof(int64_t));
+    finished_ = false;
+    outOfSpaceStr_ = false;
+    strList_.clear();
+    processV2EncodedStr();
 }
 
 
@@ -94,6 +94,11 @@ public:
     // This constructor can handle both V1 and V2 readers
     explicit RowWriterV2(RowReader& reader);
 
+    // The two constructors above taking a V2 encoded string patch the row in place: the fields
+    // of fixed length are overwritten in the buffer, and the strings are only re-arranged in
+    // finish() when any STRING field is set. So updating a few fields of a wide row costs the
+    // size of the row, rather than encoding every field again.
+
     ~RowWriterV2() = default;
 
     // Return the exact length of the encoded binary array
@@ -117,6 +122,10 @@ public:
 
     WriteResult finish() noexcept;
 
+    // Start over with another V2 encoded string of the same schema, the buffer of the given
+    // string is taken, so a writer could be reused to patch the rows of a batch one by one
+    void reset(std::string&& encoded) noexcept;
+
     // Data write
     template<typename T>
     WriteResult set(size_t index, T&& v) noexcept {
@@ -117,6 +117,16 @@ void sequentialRead(SchemaWriter* schema, const std::string& encoded, size_t ite
 }
 
 
+void decodeAll(SchemaWriter* schema, const std::string& encoded, size_t iters) {
+    auto reader = RowReaderWrapper::getRowReader(schema, encoded);
+    std::vector<nebula::Value> values;
+    for (size_t i = 0; i < iters; i++) {
+        reader->decodeAll(values);
+        folly::doNotOptimizeAway(values);
+    }
+}
+
+
 void randomRead(SchemaWriter* schema,
                 const std::string& encoded,
                 const std::vector<size_t>& randomList,
@@ -149,6 +159,17 @@ void sequentialTest(SchemaWriter* schema,
 }
 
 
+void decodeAllTest(SchemaWriter* schema, const std::string& encoded) {
+    auto reader = RowReaderWrapper::getRowReader(schema, encoded);
+    std::vector<nebula::Value> values;
+    reader->decodeAll(values);
+    ASSERT_EQ(schema->getNumFields(), values.size());
+    for (size_t i = 0; i < values.size(); i++) {
+        EXPECT_EQ(reader->getValueByIndex(i), values[i]);
+    }
+}
+
+
 void randomTest(SchemaWriter* schema,
                 const std::string& encodedV1,
                 const std::string& encodedV2,
@@ -177,6 +198,16 @@ TEST(RowReader, SequentialLong) {
     sequentialTest(&schemaLong, dataLongV1, dataLongV2);
 }
 
+TEST(RowReader, DecodeAllShort) {
+    decodeAllTest(&schemaShort, dataShortV1);
+    decodeAllTest(&schemaShort, dataShortV2);
+}
+
+TEST(RowReader, DecodeAllLong) {
+    decodeAllTest(&schemaLong, dataLongV1);
+    decodeAllTest(&schemaLong, dataLongV2);
+}
+
 TEST(RowReader, RandomShort) {
     randomTest(&schemaShort, dataShortV1, dataShortV2, shortRandom);
 }
@@ -210,6 +241,15 @@ BENCHMARK_RELATIVE(seq_read_long_v2, iters) {
 
 BENCHMARK_DRAW_LINE();
 
+BENCHMARK(seq_read_long_v2_by_index, iters) {
+    sequentialRead(&schemaLong, dataLongV2, iters);
+}
+BENCHMARK_RELATIVE(seq_read_long_v2_decode_all, iters) {
+    decodeAll(&schemaLong, dataLongV2, iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
 BENCHMARK(random_read_short_v1, iters) {
     randomRead(&schemaShort, dataShortV1, shortRandom, iters);
 }
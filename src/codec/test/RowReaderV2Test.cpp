@@ -8,6 +8,7 @@
 #include "common/datatypes/Value.h"
 #include <gtest/gtest.h>
 #include "codec/RowReaderWrapper.h"
+#include "codec/RowWriterV2.h"
 #include "codec/test/SchemaWriter.h"
 
 namespace nebula {
@@ -314,6 +315,29 @@ TEST(RowReaderV2, encodedData) {
     // Col 13 -- non-existing column
     val = reader->getValueByIndex(13);
     EXPECT_EQ(Value::Type::NULLVALUE, val.type());
+
+    // Read the numeric columns directly
+    RowReader::Numeric num;
+    EXPECT_TRUE(reader->getNumericByIndex(2, &num));
+    EXPECT_TRUE(num.isInt_);
+    EXPECT_EQ(100, num.int_);
+    EXPECT_TRUE(reader->getNumericByIndex(3, &num));
+    EXPECT_TRUE(num.isInt_);
+    EXPECT_EQ(0xFFFFFFFFFFFFFFFFL, num.int_);
+    EXPECT_TRUE(reader->getNumericByIndex(7, &num));
+    EXPECT_FALSE(num.isInt_);
+    EXPECT_DOUBLE_EQ(pi, num.float_);
+    EXPECT_TRUE(reader->getNumericByIndex(8, &num));
+    EXPECT_FALSE(num.isInt_);
+    EXPECT_DOUBLE_EQ(e, num.float_);
+    EXPECT_TRUE(reader->getNumericByIndex(9, &num));
+    EXPECT_TRUE(num.isInt_);
+    EXPECT_EQ(1551331827, num.int_);
+    // Not numeric or not existing
+    EXPECT_FALSE(reader->getNumericByIndex(0, &num));
+    EXPECT_FALSE(reader->getNumericByIndex(1, &num));
+    EXPECT_FALSE(reader->getNumericByIndex(10, &num));
+    EXPECT_FALSE(reader->getNumericByIndex(13, &num));
 }
 
 
@@ -346,6 +370,89 @@ TEST(RowReaderV2, iterator) {
     EXPECT_EQ(64, index);
 }
 
+TEST(RowReaderV2, decodeAll) {
+    // 70 nullable fields, so there are more than 8 bytes of null flags
+    SchemaWriter schema;
+    for (int i = 0; i < 70; i++) {
+        schema.appendCol(folly::stringPrintf("Col%02d", i),
+                         i % 2 == 0 ? PropertyType::INT64 : PropertyType::STRING,
+                         0,
+                         true);
+    }
+    schema.appendCol("NotNull", PropertyType::DOUBLE);
+
+    auto encode = [&] (std::vector<int> nulls) {
+        RowWriterV2 writer(&schema);
+        for (int i = 0; i < 70; i++) {
+            if (std::find(nulls.begin(), nulls.end(), i) != nulls.end()) {
+                EXPECT_EQ(WriteResult::SUCCEEDED, writer.setNull(i));
+            } else if (i % 2 == 0) {
+                EXPECT_EQ(WriteResult::SUCCEEDED, writer.set(i, i));
+            } else {
+                EXPECT_EQ(WriteResult::SUCCEEDED, writer.set(i, folly::to<std::string>(i)));
+            }
+        }
+        EXPECT_EQ(WriteResult::SUCCEEDED, writer.set(70, 3.14));
+        EXPECT_EQ(WriteResult::SUCCEEDED, writer.finish());
+        return writer.moveEncodedStr();
+    };
+
+    // no null, the null in the first 8 bytes of flags, and the null in the rest
+    for (const auto& nulls : std::vector<std::vector<int>>{{}, {3}, {0, 68}, {69}}) {
+        auto encoded = encode(nulls);
+        auto reader = RowReaderWrapper::getRowReader(&schema, encoded);
+        ASSERT_TRUE(!!reader);
+        std::vector<Value> values;
+        reader->decodeAll(values);
+        ASSERT_EQ(71, values.size());
+        for (size_t i = 0; i < values.size(); i++) {
+            EXPECT_EQ(reader->getValueByIndex(i), values[i]) << i;
+        }
+        for (auto i : nulls) {
+            EXPECT_EQ(Value(NullType::__NULL__), values[i]);
+        }
+    }
+}
+
+TEST(RowReaderV2, resetWithSchemas) {
+    // Two versions of a tag, the layouts of the fields are different
+    SchemaWriter schema1(1);
+    schema1.appendCol("Col01", PropertyType::INT64);
+    schema1.appendCol("Col02", PropertyType::STRING);
+    SchemaWriter schema2(2);
+    schema2.appendCol("Col01", PropertyType::INT64);
+    schema2.appendCol("Col02", PropertyType::STRING);
+    schema2.appendCol("Col03", PropertyType::BOOL, 0, true);
+
+    RowWriterV2 writer1(&schema1);
+    EXPECT_EQ(WriteResult::SUCCEEDED, writer1.set(0, 1));
+    EXPECT_EQ(WriteResult::SUCCEEDED, writer1.set(1, "v1"));
+    ASSERT_EQ(WriteResult::SUCCEEDED, writer1.finish());
+    auto row1 = writer1.moveEncodedStr();
+    RowWriterV2 writer2(&schema2);
+    EXPECT_EQ(WriteResult::SUCCEEDED, writer2.set(0, 2));
+    EXPECT_EQ(WriteResult::SUCCEEDED, writer2.set(1, "v2"));
+    EXPECT_EQ(WriteResult::SUCCEEDED, writer2.setNull(2));
+    ASSERT_EQ(WriteResult::SUCCEEDED, writer2.finish());
+    auto row2 = writer2.moveEncodedStr();
+
+    // The same reader is reset with the rows of both versions back and forth
+    RowReaderWrapper reader;
+    for (int i = 0; i < 2; i++) {
+        ASSERT_TRUE(reader.reset(&schema1, row1));
+        EXPECT_EQ(2, reader.numFields());
+        EXPECT_EQ(Value(1), reader.getValueByIndex(0));
+        EXPECT_EQ(Value("v1"), reader.getValueByName("Col02"));
+        EXPECT_EQ(Value(NullType::UNKNOWN_PROP), reader.getValueByIndex(2));
+
+        ASSERT_TRUE(reader.reset(&schema2, row2));
+        EXPECT_EQ(3, reader.numFields());
+        EXPECT_EQ(Value(2), reader.getValueByIndex(0));
+        EXPECT_EQ(Value("v2"), reader.getValueByName("Col02"));
+        EXPECT_EQ(Value(NullType::__NULL__), reader.getValueByIndex(2));
+    }
+}
+
 }  // namespace nebula
 
 
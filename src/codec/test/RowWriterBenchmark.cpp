@@ -9,14 +9,18 @@
 #include "codec/test/SchemaWriter.h"
 #include "codec/test/RowWriterV1.h"
 #include "codec/RowWriterV2.h"
+#include "codec/RowReaderWrapper.h"
 
 using nebula::SchemaWriter;
 using nebula::RowWriterV1;
 using nebula::RowWriterV2;
+using nebula::RowReaderWrapper;
 using nebula::meta::cpp2::PropertyType;
 
 SchemaWriter schemaShort;
 SchemaWriter schemaLong;
+std::string encodedShort;
+std::string encodedLong;
 
 const double e = 2.71828182845904523536028747135266249775724709369995;
 const float pi = 3.14159265358979;
@@ -73,6 +77,53 @@ void writeDataV2(SchemaWriter* schema, int32_t iters) {
 }
 
 
+std::string encodeV2(SchemaWriter* schema) {
+    RowWriterV2 writer(schema);
+    size_t idx = 0;
+    for (size_t j = 0; j < schema->getNumFields() / 6; j++) {
+        writer.set(idx++, true);
+        writer.set(idx++, j);
+        writer.set(idx++, 1551331827);
+        writer.set(idx++, pi);
+        writer.set(idx++, e);
+        writer.set(idx++, str);
+    }
+    writer.finish();
+    return writer.moveEncodedStr();
+}
+
+
+// Update the INT64 field of the first group by encoding the whole row again
+void rewriteRowV2(SchemaWriter* schema, const std::string& encoded, int32_t iters) {
+    for (int32_t i = 0; i < iters; i++) {
+        auto reader = RowReaderWrapper::getRowReader(schema, encoded);
+        RowWriterV2 writer(schema);
+        for (size_t j = 0; j < schema->getNumFields(); j++) {
+            writer.setValue(j, reader->getValueByIndex(j));
+        }
+        writer.set(1, i);
+        writer.finish();
+        std::string updated = writer.moveEncodedStr();
+        folly::doNotOptimizeAway(updated);
+    }
+}
+
+
+// Update the INT64 field of the first group in place, the writer is reused between the rows
+void patchRowV2(SchemaWriter* schema, const std::string& encoded, int32_t iters) {
+    RowWriterV2 writer(schema, encoded);
+    for (int32_t i = 0; i < iters; i++) {
+        if (i > 0) {
+            writer.reset(std::string(encoded));
+        }
+        writer.set(1, i);
+        writer.finish();
+        std::string updated = writer.moveEncodedStr();
+        folly::doNotOptimizeAway(updated);
+    }
+}
+
+
 /*************************
  * Begining of benchmarks
  ************************/
@@ -93,6 +144,26 @@ BENCHMARK(WriteLongRowV1, iters) {
 BENCHMARK_RELATIVE(WriteLongRowV2, iters) {
     writeDataV2(&schemaLong, iters);
 }
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(RewriteShortRowV2, iters) {
+    rewriteRowV2(&schemaShort, encodedShort, iters);
+}
+
+BENCHMARK_RELATIVE(PatchShortRowV2, iters) {
+    patchRowV2(&schemaShort, encodedShort, iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(RewriteLongRowV2, iters) {
+    rewriteRowV2(&schemaLong, encodedLong, iters);
+}
+
+BENCHMARK_RELATIVE(PatchLongRowV2, iters) {
+    patchRowV2(&schemaLong, encodedLong, iters);
+}
 /*************************
  * End of benchmarks
  ************************/
@@ -103,6 +174,8 @@ int main(int argc, char** argv) {
 
     prepareSchema(&schemaShort, 2);
     prepareSchema(&schemaLong, 24);
+    encodedShort = encodeV2(&schemaShort);
+    encodedLong = encodeV2(&schemaLong);
 
     folly::runBenchmarks();
     return 0;
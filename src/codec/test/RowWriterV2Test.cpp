@@ -378,6 +378,51 @@ TEST(RowWriterV2, Update) {
     EXPECT_EQ(v1, v2);
 }
 
+TEST(RowWriterV2, PatchInPlace) {
+    SchemaWriter schema(3 /*Schema version*/);
+    schema.appendCol("Col01", PropertyType::INT64);
+    schema.appendCol("Col02", PropertyType::STRING);
+    schema.appendCol("Col03", PropertyType::DOUBLE, 0, true);
+
+    auto encode = [&schema] (int64_t i, const std::string& s) {
+        RowWriterV2 writer(&schema);
+        EXPECT_EQ(WriteResult::SUCCEEDED, writer.set("Col01", i));
+        EXPECT_EQ(WriteResult::SUCCEEDED, writer.set("Col02", s));
+        EXPECT_EQ(WriteResult::SUCCEEDED, writer.setNull("Col03"));
+        EXPECT_EQ(WriteResult::SUCCEEDED, writer.finish());
+        return writer.moveEncodedStr();
+    };
+
+    // Only the fixed length fields are updated, the strings are kept as they are
+    std::string encoded = encode(1, "");
+    auto size = encoded.size();
+    RowWriterV2 updater(&schema, std::move(encoded));
+    EXPECT_EQ(WriteResult::SUCCEEDED, updater.set("Col01", 2));
+    EXPECT_EQ(WriteResult::SUCCEEDED, updater.set("Col03", e));
+    ASSERT_EQ(WriteResult::SUCCEEDED, updater.finish());
+    encoded = updater.moveEncodedStr();
+    EXPECT_EQ(size, encoded.size());
+    {
+        auto reader = RowReaderWrapper::getRowReader(&schema, encoded);
+        EXPECT_EQ(2, reader->getValueByName("Col01").getInt());
+        EXPECT_EQ("", reader->getValueByName("Col02").getStr());
+        EXPECT_DOUBLE_EQ(e, reader->getValueByName("Col03").getFloat());
+    }
+
+    // Reuse the writer for another row, and update the string
+    updater.reset(encode(3, str));
+    EXPECT_EQ(WriteResult::SUCCEEDED, updater.set("Col02", fixed));
+    EXPECT_EQ(WriteResult::SUCCEEDED, updater.setNull("Col03"));
+    ASSERT_EQ(WriteResult::SUCCEEDED, updater.finish());
+    encoded = updater.moveEncodedStr();
+    {
+        auto reader = RowReaderWrapper::getRowReader(&schema, encoded);
+        EXPECT_EQ(3, reader->getValueByName("Col01").getInt());
+        EXPECT_EQ(fixed, reader->getValueByName("Col02").getStr());
+        EXPECT_EQ(Value::Type::NULLVALUE, reader->getValueByName("Col03").type());
+    }
+}
+
 TEST(RowWriterV2, Timestamp) {
     SchemaWriter schema(20 /*Schema version*/);
     schema.appendCol("Col01", PropertyType::TIMESTAMP);
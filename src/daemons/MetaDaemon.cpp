@@ -22,12 +22,20 @@
 #include "meta/MetaHttpIngestHandler.h"
 #include "meta/MetaHttpDownloadHandler.h"
 #include "meta/MetaHttpReplaceHostHandler.h"
+#include "meta/MetaHttpChangesHandler.h"
+#include "meta/MetaHttpPartLoadHandler.h"
+#include "meta/MetaHttpLeaderZoneHandler.h"
+#include "meta/MetaHttpSplitPartsHandler.h"
 #include "meta/KVBasedClusterIdMan.h"
 #include "meta/ActiveHostsMan.h"
 #include "meta/processors/jobMan/JobManager.h"
+#include "meta/processors/sessionMan/SessionTable.h"
 #include "meta/RootUserMan.h"
 #include "meta/MetaServiceUtils.h"
 #include "meta/MetaVersionMan.h"
+#include "meta/MetaWarmup.h"
+#include "utils/HttpProfileHandler.h"
+#include "utils/ThreadPoolStats.h"
 
 using nebula::operator<<;
 using nebula::ProcessUtils;
@@ -49,9 +57,13 @@ DEFINE_int32(meta_http_thread_num, 3, "Number of meta daemon's http thread");
 DEFINE_int32(num_worker_threads, 32, "Number of workers");
 DEFINE_string(pid_file, "pids/nebula-metad.pid", "File to hold the process id");
 DEFINE_bool(daemonize, true, "Whether run as a daemon process");
+DEFINE_int32(meta_start_poll_interval_ms, 1000,
+             "The interval to check again when metad starts waiting for the leader elected, "
+             "the cluster id or the upgrade of the leader");
 
 static std::unique_ptr<apache::thrift::ThriftServer> gServer;
 static std::unique_ptr<nebula::kvstore::KVStore> gKVStore;
+static std::unique_ptr<nebula::ThreadPoolStats> gThreadPoolStats;
 static void signalHandler(int sig);
 static Status setupSignalHandler();
 extern Status setupLogging();
@@ -92,6 +104,20 @@ std::unique_ptr<nebula::kvstore::KVStore> initKV(std::vector<nebula::HostAddr> p
         return nullptr;
     }
 
+    if (FLAGS_thread_pool_stats_interval_ms > 0) {
+        gThreadPoolStats =
+            std::make_unique<nebula::ThreadPoolStats>(FLAGS_thread_pool_stats_interval_ms);
+        gThreadPoolStats->addPool("io", ioPool.get());
+        gThreadPoolStats->addPool("executor", threadManager.get());
+        auto snapshot = kvstore->getSnapshotManager();
+        gThreadPoolStats->addPool("snapshot_worker", snapshot->workers());
+        gThreadPoolStats->addPool("snapshot_io", snapshot->ioPool());
+        if (!gThreadPoolStats->start()) {
+            LOG(ERROR) << "Start thread pool stats failed";
+            return nullptr;
+        }
+    }
+
     LOG(INFO) << "Waiting for the leader elected...";
     nebula::HostAddr leader;
     while (true) {
@@ -105,8 +131,9 @@ std::unique_ptr<nebula::kvstore::KVStore> initKV(std::vector<nebula::HostAddr> p
         if (leader != nebula::HostAddr("", 0)) {
             break;
         }
-        LOG(INFO) << "Leader has not been elected, sleep 1s";
-        sleep(1);
+        LOG(INFO) << "Leader has not been elected, sleep "
+                  << FLAGS_meta_start_poll_interval_ms << "ms";
+        usleep(FLAGS_meta_start_poll_interval_ms * 1000);
     }
 
     gClusterId = nebula::meta::ClusterIdMan::getClusterIdFromKV(kvstore.get(),
@@ -125,7 +152,7 @@ std::unique_ptr<nebula::kvstore::KVStore> initKV(std::vector<nebula::HostAddr> p
             LOG(INFO) << "I am follower, wait for the leader's clusterId";
             while (gClusterId == 0) {
                 LOG(INFO) << "Waiting for the leader's clusterId";
-                sleep(1);
+                usleep(FLAGS_meta_start_poll_interval_ms * 1000);
                 gClusterId = nebula::meta::ClusterIdMan::getClusterIdFromKV(
                                                 kvstore.get(),
                                                 nebula::meta::kClusterIdKey);
@@ -151,7 +178,7 @@ std::unique_ptr<nebula::kvstore::KVStore> initKV(std::vector<nebula::HostAddr> p
             LOG(INFO) << "I am follower, wait for leader to sync upgrade";
             while (version != nebula::meta::MetaVersion::V2) {
                 VLOG(1) << "Waiting for leader to upgrade";
-                sleep(1);
+                usleep(FLAGS_meta_start_poll_interval_ms * 1000);
                 version = nebula::meta::MetaVersionMan::getMetaVersionFromKV(kvstore.get());
             }
         }
@@ -186,6 +213,29 @@ Status initWebService(nebula::WebService* svc,
         handler->init(kvstore);
         return handler;
     });
+    router.get("/changes").handler([kvstore](PathParams &&) {
+        auto handler = new nebula::meta::MetaHttpChangesHandler();
+        handler->init(kvstore);
+        return handler;
+    });
+    router.get("/part-load").handler([kvstore](PathParams &&) {
+        auto handler = new nebula::meta::MetaHttpPartLoadHandler();
+        handler->init(kvstore);
+        return handler;
+    });
+    router.get("/leader-zone").handler([kvstore](PathParams &&) {
+        auto handler = new nebula::meta::MetaHttpLeaderZoneHandler();
+        handler->init(kvstore);
+        return handler;
+    });
+    router.get("/split-parts").handler([kvstore](PathParams &&) {
+        auto handler = new nebula::meta::MetaHttpSplitPartsHandler();
+        handler->init(kvstore);
+        return handler;
+    });
+    router.get("/pprof").handler([](PathParams &&) {
+        return new nebula::HttpProfileHandler();
+    });
     return svc->start();
 }
 
@@ -272,6 +322,13 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    if (FLAGS_session_flush_interval_ms > 0) {
+        if (!nebula::meta::SessionTable::getInstance()->start(gKVStore.get())) {
+            LOG(ERROR) << "Start the session table failed";
+            return EXIT_FAILURE;
+        }
+    }
+
     {
         /**
          *  Only leader part needed.
@@ -293,6 +350,8 @@ int main(int argc, char *argv[]) {
         }
     }
 
+    nebula::meta::MetaWarmup::run(gKVStore.get());
+
     // Setup the signal handlers
     status = setupSignalHandler();
     if (!status.ok()) {
@@ -349,6 +408,10 @@ void signalHandler(int sig) {
                     gJobMgr->shutDown();
                 }
             }
+            nebula::meta::SessionTable::getInstance()->stop();
+            if (gThreadPoolStats) {
+                gThreadPoolStats->stop();
+            }
             if (gKVStore) {
                 gKVStore->stop();
                 gKVStore.reset();
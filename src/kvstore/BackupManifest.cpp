@@ -0,0 +1,249 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/BackupManifest.h"
+#include "common/fs/FileUtils.h"
+#include <fstream>
+#include <sys/stat.h>
+
+namespace nebula {
+namespace kvstore {
+
+using fs::FileUtils;
+
+namespace {
+
+std::string checkpointDir(const std::string& root, const std::string& name) {
+    return folly::stringPrintf("%s/checkpoints/%s", root.c_str(), name.c_str());
+}
+
+bool listFiles(const std::string& dir,
+               const std::string& prefix,
+               const std::string& name,
+               std::vector<BackupManifest::Entry>* entries) {
+    for (auto& file : FileUtils::listAllFilesInDir(dir.c_str())) {
+        struct stat st;
+        auto path = FileUtils::joinPath(dir, file);
+        if (::stat(path.c_str(), &st) != 0) {
+            LOG(ERROR) << "Stat " << path << " failed, error: " << strerror(errno);
+            return false;
+        }
+        BackupManifest::Entry entry;
+        entry.checkpoint = name;
+        entry.size = st.st_size;
+        entry.inode = st.st_ino;
+        entry.path = prefix + file;
+        entries->emplace_back(std::move(entry));
+    }
+    return true;
+}
+
+}  // namespace
+
+// static
+bool BackupManifest::build(const std::string& dataRoot,
+                           const std::string& walRoot,
+                           const std::string& name) {
+    auto dataDir = checkpointDir(dataRoot, name);
+    auto walDir = checkpointDir(walRoot, name);
+    std::vector<Entry> entries;
+    if (!listFiles(dataDir + "/data", "data/", name, &entries)) {
+        return false;
+    }
+    // the last wal of each part is never reused
+    std::unordered_set<std::string> lastWals;
+    auto walParts = walDir + "/wal";
+    if (FileUtils::exist(walParts)) {
+        for (auto& part : FileUtils::listAllDirsInDir(walParts.c_str())) {
+            auto prefix = folly::stringPrintf("wal/%s/", part.c_str());
+            auto start = entries.size();
+            if (!listFiles(walParts + "/" + part, prefix, name, &entries)) {
+                return false;
+            }
+            std::string last;
+            for (auto i = start; i < entries.size(); i++) {
+                last = std::max(last, entries[i].path);
+            }
+            lastWals.emplace(std::move(last));
+        }
+    }
+
+    std::unordered_map<std::string, Entry> base;
+    auto prev = previous(dataRoot, name);
+    if (!prev.empty()) {
+        std::vector<Entry> prevEntries;
+        auto path = folly::stringPrintf("%s/%s", checkpointDir(dataRoot, prev).c_str(), kFileName);
+        if (read(path, &prevEntries)) {
+            for (auto& entry : prevEntries) {
+                auto key = entry.path;
+                base.emplace(std::move(key), std::move(entry));
+            }
+        }
+    }
+
+    size_t reused = 0;
+    for (auto& entry : entries) {
+        bool sst = folly::StringPiece(entry.path).endsWith(".sst");
+        bool wal = folly::StringPiece(entry.path).endsWith(".wal") && !lastWals.count(entry.path);
+        if (!sst && !wal) {
+            continue;
+        }
+        auto it = base.find(entry.path);
+        if (it == base.end() || it->second.size != entry.size || it->second.inode != entry.inode) {
+            continue;
+        }
+        auto path = FileUtils::joinPath(sst ? dataDir : walDir, entry.path);
+        if (::unlink(path.c_str()) != 0) {
+            LOG(ERROR) << "Unlink " << path << " failed, error: " << strerror(errno);
+            return false;
+        }
+        entry.checkpoint = it->second.checkpoint;
+        reused++;
+    }
+    LOG(INFO) << "Checkpoint " << name << " of " << dataRoot << " has " << entries.size()
+              << " files, " << reused << " of them are in the backup " << prev;
+    return write(folly::stringPrintf("%s/%s", dataDir.c_str(), kFileName), entries);
+}
+
+// static
+bool BackupManifest::release(const std::string& dataRoot,
+                             const std::string& walRoot,
+                             const std::string& name) {
+    auto root = folly::stringPrintf("%s/checkpoints", dataRoot.c_str());
+    auto dirs = FileUtils::listAllDirsInDir(root.c_str());
+    std::sort(dirs.begin(), dirs.end());
+    // the path of each file released, and the checkpoint which has it now
+    std::unordered_map<std::string, std::string> released;
+    for (auto& dir : dirs) {
+        if (dir == name) {
+            continue;
+        }
+        std::vector<Entry> entries;
+        auto path = folly::stringPrintf("%s/%s/%s", root.c_str(), dir.c_str(), kFileName);
+        if (!read(path, &entries)) {
+            continue;
+        }
+        size_t changed = 0;
+        for (auto& entry : entries) {
+            if (entry.checkpoint != name) {
+                continue;
+            }
+            auto it = released.find(entry.path);
+            if (it != released.end()) {
+                entry.checkpoint = it->second;
+                changed++;
+                continue;
+            }
+            bool sst = folly::StringPiece(entry.path).endsWith(".sst");
+            auto from = FileUtils::joinPath(checkpointDir(sst ? dataRoot : walRoot, name),
+                                            entry.path);
+            auto to = FileUtils::joinPath(checkpointDir(sst ? dataRoot : walRoot, dir),
+                                          entry.path);
+            auto parent = to.substr(0, to.rfind('/'));
+            if (!FileUtils::exist(parent) && !FileUtils::makeDir(parent)) {
+                LOG(ERROR) << "Make dir " << parent << " failed";
+                return false;
+            }
+            if (::link(from.c_str(), to.c_str()) != 0 && errno != EEXIST) {
+                LOG(ERROR) << "Link " << from << " to " << to << " failed, error: "
+                           << strerror(errno);
+                return false;
+            }
+            entry.checkpoint = dir;
+            released.emplace(entry.path, dir);
+            changed++;
+        }
+        if (changed > 0) {
+            LOG(INFO) << changed << " files of the backup " << dir << " are released from "
+                      << "the checkpoint " << name;
+            if (!write(path, entries)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// static
+std::string BackupManifest::previous(const std::string& dataRoot, const std::string& name) {
+    auto root = folly::stringPrintf("%s/checkpoints", dataRoot.c_str());
+    auto dirs = FileUtils::listAllDirsInDir(root.c_str());
+    std::sort(dirs.begin(), dirs.end(), std::greater<std::string>());
+    for (auto& dir : dirs) {
+        if (dir >= name) {
+            continue;
+        }
+        std::vector<Entry> entries;
+        if (!read(folly::stringPrintf("%s/%s/%s", root.c_str(), dir.c_str(), kFileName),
+                  &entries)) {
+            continue;
+        }
+        std::unordered_set<std::string> checkpoints;
+        for (auto& entry : entries) {
+            checkpoints.emplace(entry.checkpoint);
+        }
+        bool kept = std::all_of(checkpoints.begin(), checkpoints.end(), [&](const auto& cp) {
+            return FileUtils::exist(FileUtils::joinPath(root, cp));
+        });
+        if (kept) {
+            return dir;
+        }
+        LOG(INFO) << "Some checkpoints of the backup " << dir << " are dropped, skip it";
+    }
+    return "";
+}
+
+// static
+bool BackupManifest::read(const std::string& path, std::vector<Entry>* entries) {
+    if (!FileUtils::exist(path)) {
+        return false;
+    }
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::vector<folly::StringPiece> fields;
+        folly::split(' ', line, fields);
+        Entry entry;
+        if (fields.size() != 4 ||
+            !folly::tryTo<uint64_t>(fields[1]).hasValue() ||
+            !folly::tryTo<uint64_t>(fields[2]).hasValue()) {
+            LOG(ERROR) << "Invalid line of the backup manifest " << path << ": " << line;
+            return false;
+        }
+        entry.checkpoint = fields[0].str();
+        entry.size = folly::to<uint64_t>(fields[1]);
+        entry.inode = folly::to<uint64_t>(fields[2]);
+        entry.path = fields[3].str();
+        entries->emplace_back(std::move(entry));
+    }
+    return !in.bad();
+}
+
+// static
+bool BackupManifest::write(const std::string& path, const std::vector<Entry>& entries) {
+    // the manifest written partly is never read
+    auto tmpPath = path + ".tmp";
+    {
+        std::ofstream out(tmpPath, std::ios::trunc);
+        for (auto& entry : entries) {
+            out << entry.checkpoint << " " << entry.size << " " << entry.inode << " "
+                << entry.path << "\n";
+        }
+        out.flush();
+        if (!out.good()) {
+            LOG(ERROR) << "Write the backup manifest " << tmpPath << " failed";
+            return false;
+        }
+    }
+    if (::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        LOG(ERROR) << "Rename " << tmpPath << " failed, error: " << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+}  // namespace kvstore
+}  // namespace nebula
@@ -0,0 +1,69 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_BACKUPMANIFEST_H_
+#define KVSTORE_BACKUPMANIFEST_H_
+
+#include "common/base/Base.h"
+
+namespace nebula {
+namespace kvstore {
+
+/*
+BackupManifest lists the files of the checkpoint of an engine, the sst files under "data" and the
+wal files of each part under "wal/<part>", which is written beside them when
+enable_incremental_backup is on. Each file is listed with the checkpoint which has it.
+
+The checkpoint files are hard links of the files of the engine and the wal, so a file of the same
+path, size and inode in the manifest of the previous backup is the same file. It is unlinked from
+the new checkpoint and listed with the checkpoint of the previous manifest, then only the change
+set is left in the new checkpoint to upload. The last wal of each part could be appended or
+truncated, and the other files of rocksdb are rewritten by it, so they are always kept.
+
+A backup is restored with the files of all the checkpoints listed in its manifest. Before a
+checkpoint is dropped, its files listed in the manifests of the later backups are released to
+them: the first backup listing a file links it into its own checkpoint, and the manifests are
+rewritten to list the file with that one, so the later backups are still restorable. The previous
+one is skipped if any checkpoint of it has been dropped otherwise.
+*/
+class BackupManifest final {
+public:
+    static constexpr const char* kFileName = "BACKUP_MANIFEST";
+
+    struct Entry {
+        // the checkpoint which has the file
+        std::string     checkpoint;
+        uint64_t        size{0};
+        uint64_t        inode{0};
+        // relative to the checkpoint dir, "data/<file>" or "wal/<part>/<file>"
+        std::string     path;
+    };
+
+    // Write the manifest of checkpoint "name" of the engine, with the files in the manifest of
+    // the previous backup unlinked from the checkpoint
+    static bool build(const std::string& dataRoot,
+                      const std::string& walRoot,
+                      const std::string& name);
+
+    // Link the files of checkpoint "name" which the manifests of the other backups list into
+    // the checkpoints of them, which must be called before "name" is dropped
+    static bool release(const std::string& dataRoot,
+                        const std::string& walRoot,
+                        const std::string& name);
+
+    // The latest backup before "name" of which all checkpoints are kept, the backups are named
+    // by the time they are created
+    static std::string previous(const std::string& dataRoot, const std::string& name);
+
+    static bool read(const std::string& path, std::vector<Entry>* entries);
+
+    static bool write(const std::string& path, const std::vector<Entry>& entries);
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+
+#endif  // KVSTORE_BACKUPMANIFEST_H_
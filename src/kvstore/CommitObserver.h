@@ -0,0 +1,61 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_COMMITOBSERVER_H_
+#define KVSTORE_COMMITOBSERVER_H_
+
+#include "common/base/Base.h"
+
+namespace nebula {
+namespace kvstore {
+
+/*
+CommitObserver is told of the keys put into each part, on every replica, after they are
+committed into the engine by the logs or the snapshot. The data changed other than by them, i.e.
+the files ingested, the compaction and the part or space removed, is told by onReset, after
+which the observer should not trust what it has seen of the part. It is set by
+KVOptions::commitObserver_, and called on the threads committing, so it must be quick.
+*/
+class CommitObserver {
+public:
+    virtual ~CommitObserver() = default;
+
+    virtual void onCommit(GraphSpaceID spaceId,
+                          PartitionID partId,
+                          const std::vector<std::string>& keys) = 0;
+
+    // partId 0 means all parts of the space
+    virtual void onReset(GraphSpaceID spaceId, PartitionID partId) = 0;
+};
+
+// Tell each of the observers in order, when more than one is set
+class CommitObserverList final : public CommitObserver {
+public:
+    explicit CommitObserverList(std::vector<std::shared_ptr<CommitObserver>> observers)
+        : observers_(std::move(observers)) {}
+
+    void onCommit(GraphSpaceID spaceId,
+                  PartitionID partId,
+                  const std::vector<std::string>& keys) override {
+        for (auto& observer : observers_) {
+            observer->onCommit(spaceId, partId, keys);
+        }
+    }
+
+    void onReset(GraphSpaceID spaceId, PartitionID partId) override {
+        for (auto& observer : observers_) {
+            observer->onReset(spaceId, partId);
+        }
+    }
+
+private:
+    std::vector<std::shared_ptr<CommitObserver>>    observers_;
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+
+#endif  // KVSTORE_COMMITOBSERVER_H_
@@ -28,6 +28,38 @@ public:
     virtual bool filter(GraphSpaceID spaceId,
                         const folly::StringPiece& key,
                         const folly::StringPiece& val) const = 0;
+
+    /**
+     * The id of the schema (tag, edge or index) of the key, and the time when it is expired by
+     * ttl, which are recorded in the properties of SST file, so that only the files holding
+     * expired or dropped data are compacted. The id is opaque to kvstore, it is only passed
+     * back to schemaDropped. Return false if the key has no schema.
+     * */
+    virtual bool schemaOf(GraphSpaceID,
+                          const folly::StringPiece&,
+                          const folly::StringPiece&,
+                          int64_t*,
+                          int64_t*) const {
+        return false;
+    }
+
+    /**
+     * Whether the schema of id returned by schemaOf has been dropped.
+     * */
+    virtual bool schemaDropped(GraphSpaceID, int64_t) const {
+        return false;
+    }
+
+    /**
+     * Replace the val of the key kept by filter with newVal in background compaction if return
+     * true, e.g. to encode it in a newer format. Return false to keep the val as it is.
+     * */
+    virtual bool rewrite(GraphSpaceID,
+                         const folly::StringPiece&,
+                         const folly::StringPiece&,
+                         std::string*) const {
+        return false;
+    }
 };
 
 using KV = std::pair<std::string, std::string>;
@@ -38,6 +70,15 @@ inline rocksdb::Slice toSlice(const folly::StringPiece& str) {
     return rocksdb::Slice(str.begin(), str.size());
 }
 
+// How the keys of a scan are read, which decides the read options of engine
+enum class ScanHint : uint8_t {
+    // seek and read a few keys, e.g. the edges of a vertex
+    kDefault = 0,
+    // read through a large range once, e.g. scan and admin tasks, the blocks are read ahead
+    // and not filled into block cache
+    kFullScan = 1,
+};
+
 using KVMap = std::unordered_map<std::string, std::string>;
 using KVArrayIterator = std::vector<KV>::const_iterator;
 
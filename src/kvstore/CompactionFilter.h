@@ -10,9 +10,11 @@
 #include "common/base/Base.h"
 #include "common/time/WallClock.h"
 #include <rocksdb/compaction_filter.h>
+#include <rocksdb/table_properties.h>
 #include "kvstore/Common.h"
 
 DECLARE_int32(custom_filter_interval_secs);
+DECLARE_bool(rocksdb_compact_expired_files);
 
 namespace nebula {
 namespace kvstore {
@@ -27,11 +29,15 @@ public:
     bool Filter(int,
                 const rocksdb::Slice& key,
                 const rocksdb::Slice& val,
-                std::string*,
-                bool*) const override {
-        return kvFilter_->filter(spaceId_,
-                                 folly::StringPiece(key.data(), key.size()),
-                                 folly::StringPiece(val.data(), val.size()));
+                std::string* newVal,
+                bool* valChanged) const override {
+        folly::StringPiece k(key.data(), key.size());
+        folly::StringPiece v(val.data(), val.size());
+        if (kvFilter_->filter(spaceId_, k, v)) {
+            return true;
+        }
+        *valChanged = kvFilter_->rewrite(spaceId_, k, v, newVal);
+        return false;
     }
 
     const char* Name() const override {
@@ -57,6 +63,11 @@ public:
             lastRunCustomFilterTimeSec_ = now;
             return std::make_unique<KVCompactionFilter>(spaceId_, createKVFilter());
         } else {
+            // The files holding expired or dropped data are compacted by
+            // RocksEngine::compactExpired, the other compactions skip the filter
+            if (FLAGS_rocksdb_compact_expired_files) {
+                return std::unique_ptr<rocksdb::CompactionFilter>(nullptr);
+            }
             if (FLAGS_custom_filter_interval_secs >= 0
                     && now - lastRunCustomFilterTimeSec_ > FLAGS_custom_filter_interval_secs) {
                 LOG(INFO) << "Do custom minor compaction!";
@@ -79,6 +90,108 @@ private:
     int32_t lastRunCustomFilterTimeSec_ = 0;
 };
 
+/**
+ * Record the schema ids and the earliest ttl expiration time of the keys in a SST file as its
+ * properties, with the help of KVFilter::schemaOf.
+ * */
+class KVTablePropertiesCollector final : public rocksdb::TablePropertiesCollector {
+public:
+    static constexpr const char* kSchemasProperty = "nebula.schemas";
+    static constexpr const char* kMinExpireTimeProperty = "nebula.min_expire_time";
+
+    KVTablePropertiesCollector(GraphSpaceID spaceId, std::unique_ptr<KVFilter> kvFilter)
+        : spaceId_(spaceId)
+        , kvFilter_(std::move(kvFilter)) {}
+
+    rocksdb::Status AddUserKey(const rocksdb::Slice& key,
+                               const rocksdb::Slice& val,
+                               rocksdb::EntryType type,
+                               rocksdb::SequenceNumber,
+                               uint64_t) override {
+        if (type != rocksdb::kEntryPut) {
+            return rocksdb::Status::OK();
+        }
+        int64_t schemaId = 0;
+        int64_t expireTime = std::numeric_limits<int64_t>::max();
+        if (kvFilter_->schemaOf(spaceId_,
+                                folly::StringPiece(key.data(), key.size()),
+                                folly::StringPiece(val.data(), val.size()),
+                                &schemaId,
+                                &expireTime)) {
+            schemas_.emplace(schemaId);
+            minExpireTime_ = std::min(minExpireTime_, expireTime);
+        }
+        return rocksdb::Status::OK();
+    }
+
+    rocksdb::Status Finish(rocksdb::UserCollectedProperties* properties) override {
+        *properties = GetReadableProperties();
+        return rocksdb::Status::OK();
+    }
+
+    rocksdb::UserCollectedProperties GetReadableProperties() const override {
+        return {{kSchemasProperty, folly::join(",", schemas_)},
+                {kMinExpireTimeProperty, folly::to<std::string>(minExpireTime_)}};
+    }
+
+    const char* Name() const override {
+        return "KVTablePropertiesCollector";
+    }
+
+    // Whether the file of the properties have expired or dropped data, the files written
+    // without the properties are regarded as having
+    static bool hasExpired(GraphSpaceID spaceId,
+                           const KVFilter* kvFilter,
+                           const rocksdb::UserCollectedProperties& properties,
+                           int64_t now) {
+        auto schemas = properties.find(kSchemasProperty);
+        auto minExpireTime = properties.find(kMinExpireTimeProperty);
+        if (schemas == properties.end() || minExpireTime == properties.end()) {
+            return true;
+        }
+        auto expireTime = folly::tryTo<int64_t>(minExpireTime->second);
+        if (!expireTime.hasValue() || now > expireTime.value()) {
+            return true;
+        }
+        std::vector<folly::StringPiece> ids;
+        folly::split(",", schemas->second, ids, true);
+        for (const auto& id : ids) {
+            auto schemaId = folly::tryTo<int64_t>(id);
+            if (!schemaId.hasValue() || kvFilter->schemaDropped(spaceId, schemaId.value())) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    GraphSpaceID spaceId_;
+    std::unique_ptr<KVFilter> kvFilter_;
+    std::set<int64_t> schemas_;
+    int64_t minExpireTime_ = std::numeric_limits<int64_t>::max();
+};
+
+class KVTablePropertiesCollectorFactory final : public rocksdb::TablePropertiesCollectorFactory {
+public:
+    KVTablePropertiesCollectorFactory(GraphSpaceID spaceId,
+                                      std::shared_ptr<KVCompactionFilterFactory> cfFactory)
+        : spaceId_(spaceId)
+        , cfFactory_(std::move(cfFactory)) {}
+
+    rocksdb::TablePropertiesCollector*
+    CreateTablePropertiesCollector(rocksdb::TablePropertiesCollectorFactory::Context) override {
+        return new KVTablePropertiesCollector(spaceId_, cfFactory_->createKVFilter());
+    }
+
+    const char* Name() const override {
+        return "KVTablePropertiesCollectorFactory";
+    }
+
+private:
+    GraphSpaceID spaceId_;
+    std::shared_ptr<KVCompactionFilterFactory> cfFactory_;
+};
+
 class CompactionFilterFactoryBuilder {
 public:
     CompactionFilterFactoryBuilder() = default;
@@ -0,0 +1,137 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/CompactionScheduler.h"
+#include "kvstore/RocksEngine.h"
+#include "kvstore/RocksEngineConfig.h"
+
+namespace nebula {
+namespace kvstore {
+
+CompactionScheduler::CompactionScheduler(NebulaStore* store, std::function<size_t()> load)
+    : store_(store)
+    , load_(std::move(load)) {
+    CHECK_NOTNULL(store_);
+}
+
+CompactionScheduler::~CompactionScheduler() {
+    stop();
+}
+
+bool CompactionScheduler::start() {
+    worker_ = std::make_unique<thread::GenericWorker>();
+    if (!worker_->start("compact-sched")) {
+        return false;
+    }
+    catchUpWorker_ = std::make_unique<thread::GenericWorker>();
+    if (!catchUpWorker_->start("compact-catchup")) {
+        return false;
+    }
+    worker_->addRepeatTask(FLAGS_compaction_scheduler_interval_ms,
+                           &CompactionScheduler::check,
+                           this);
+    return true;
+}
+
+void CompactionScheduler::stop() {
+    if (worker_ != nullptr) {
+        worker_->stop();
+        worker_->wait();
+        worker_.reset();
+    }
+    if (catchUpWorker_ != nullptr) {
+        // wait for the compaction running
+        catchUpWorker_->stop();
+        catchUpWorker_->wait();
+        catchUpWorker_.reset();
+    }
+    // never leave the compactions throttled
+    setBusy(false);
+}
+
+void CompactionScheduler::check() {
+    auto load = load_();
+    if (!busy_ && load >= static_cast<size_t>(FLAGS_compaction_busy_queue_depth)) {
+        LOG(INFO) << "Storage is busy, " << load << " requests pending, throttle compactions";
+        setBusy(true);
+    } else if (busy_ && load < static_cast<size_t>(FLAGS_compaction_busy_queue_depth) / 2) {
+        LOG(INFO) << "Storage is idle, " << load << " requests pending, restore compactions";
+        setBusy(false);
+    }
+    if (!busy_ && sinceCatchUp_.elapsedInSec() >= FLAGS_compaction_catch_up_interval_secs &&
+        !catchingUp_.exchange(true)) {
+        catchUpWorker_->addTask([this] {
+            catchUp();
+            catchingUp_ = false;
+        });
+        sinceCatchUp_.reset();
+    }
+}
+
+void CompactionScheduler::setBusy(bool busy) {
+    busy_ = busy;
+    auto threadLimiter = getCompactionThreadLimiter();
+    if (threadLimiter != nullptr) {
+        if (busy) {
+            threadLimiter->SetMaxOutstandingTask(std::max(0, FLAGS_compaction_busy_threads));
+        } else {
+            threadLimiter->SetMaxOutstandingTask(compactionThreadsLimit());
+        }
+    }
+    auto rateLimiter = getRateLimiter();
+    if (rateLimiter != nullptr) {
+        if (busy && FLAGS_compaction_busy_rate_limit > 0) {
+            rateLimiter->SetBytesPerSecond(FLAGS_compaction_busy_rate_limit * 1024L * 1024L);
+        } else {
+            rateLimiter->SetBytesPerSecond(rateLimitBytesPerSec());
+        }
+    }
+}
+
+void CompactionScheduler::catchUp() {
+    RocksEngine* target = nullptr;
+    GraphSpaceID targetSpace = 0;
+    double targetScore = 0;
+    // the spaces are kept so the target engine is not destroyed during compaction
+    auto spaces = store_->allSpaces();
+    for (const auto& spaceEntry : spaces) {
+        for (const auto& engine : spaceEntry.second->engines_) {
+            auto* rocksEngine = dynamic_cast<RocksEngine*>(engine.get());
+            if (rocksEngine == nullptr) {
+                continue;
+            }
+            // how far the engine is over the thresholds, the larger the more urgent
+            double score = 0;
+            if (FLAGS_compaction_catch_up_level0_files > 0) {
+                score = std::max(score,
+                                 static_cast<double>(rocksEngine->numLevel0Files()) /
+                                     FLAGS_compaction_catch_up_level0_files);
+            }
+            if (FLAGS_compaction_catch_up_tombstone_ratio > 0) {
+                score = std::max(score,
+                                 rocksEngine->tombstoneRatio() /
+                                     FLAGS_compaction_catch_up_tombstone_ratio);
+            }
+            if (score >= 1.0 && score > targetScore) {
+                target = rocksEngine;
+                targetSpace = spaceEntry.first;
+                targetScore = score;
+            }
+        }
+    }
+    if (target == nullptr) {
+        return;
+    }
+    LOG(INFO) << "Catch up compaction of space " << targetSpace << " in "
+              << target->getDataRoot() << ", score " << targetScore;
+    auto code = target->compact();
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Catch up compaction of space " << targetSpace << " failed";
+    }
+}
+
+}  // namespace kvstore
+}  // namespace nebula
@@ -0,0 +1,69 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_COMPACTIONSCHEDULER_H_
+#define KVSTORE_COMPACTIONSCHEDULER_H_
+
+#include "common/base/Base.h"
+#include "common/time/Duration.h"
+#include "common/thread/GenericWorker.h"
+#include "kvstore/NebulaStore.h"
+
+namespace nebula {
+namespace kvstore {
+
+/**
+ * CompactionScheduler makes the compactions of rocksdb load aware. The load is the number of
+ * requests waiting for the storage workers, checked every compaction_scheduler_interval_ms:
+ *
+ * 1. When it reaches compaction_busy_queue_depth, the storage is busy. The compactions shared
+ *    limiter is tightened to compaction_busy_threads, and the write rate of flush and compaction
+ *    to compaction_busy_rate_limit, so the readers get most of the disk and cpu.
+ * 2. When it drops below half of the depth, the storage is idle. The limits are restored, and
+ *    every compaction_catch_up_interval_secs, the engine with most level 0 files or tombstones
+ *    over the thresholds is compacted, to catch up the compactions delayed in the busy time.
+ *    The compaction runs on a worker of its own, so the load is still checked meanwhile, and
+ *    it is throttled by the limits once the storage turns busy. No more catch up is started
+ *    until the running one is finished.
+ *
+ * An engine is shared by all parts of a space in the same data path, so the priority is per
+ * engine.
+ */
+class CompactionScheduler final {
+public:
+    CompactionScheduler(NebulaStore* store, std::function<size_t()> load);
+
+    ~CompactionScheduler();
+
+    bool start();
+
+    void stop();
+
+    bool isBusy() const {
+        return busy_;
+    }
+
+private:
+    void check();
+
+    void setBusy(bool busy);
+
+    // Compact the engine with the highest score over the thresholds, run by catchUpWorker_
+    void catchUp();
+
+private:
+    NebulaStore* store_{nullptr};
+    std::function<size_t()> load_;
+    std::unique_ptr<thread::GenericWorker> worker_;
+    std::unique_ptr<thread::GenericWorker> catchUpWorker_;
+    std::atomic<bool> catchingUp_{false};
+    std::atomic<bool> busy_{false};
+    time::Duration sinceCatchUp_;
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+#endif  // KVSTORE_COMPACTIONSCHEDULER_H_
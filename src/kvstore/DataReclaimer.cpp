@@ -0,0 +1,159 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/DataReclaimer.h"
+#include "common/time/WallClock.h"
+#include <boost/filesystem.hpp>
+
+namespace nebula {
+namespace kvstore {
+
+namespace bfs = boost::filesystem;
+
+namespace {
+
+int64_t dirSize(const std::string& dir) {
+    int64_t size = 0;
+    boost::system::error_code ec;
+    for (bfs::recursive_directory_iterator it(dir, ec), end; !ec && it != end; it.increment(ec)) {
+        if (bfs::is_regular_file(it->status())) {
+            size += bfs::file_size(it->path(), ec);
+        }
+    }
+    return size;
+}
+
+}  // namespace
+
+DataReclaimer::~DataReclaimer() {
+    stop();
+}
+
+bool DataReclaimer::start(const std::vector<std::string>& dataPaths) {
+    for (const auto& path : dataPaths) {
+        auto root = bfs::path(path) / "reclaim";
+        boost::system::error_code ec;
+        if (!bfs::is_directory(root, ec)) {
+            continue;
+        }
+        for (bfs::directory_iterator it(root, ec), end; !ec && it != end; it.increment(ec)) {
+            LOG(INFO) << "Resume reclaiming " << it->path().string();
+            addTrash(it->path().string());
+        }
+    }
+    worker_ = std::make_unique<thread::GenericWorker>();
+    if (!worker_->start("data-reclaim")) {
+        return false;
+    }
+    worker_->addRepeatTask(kReclaimIntervalMs, &DataReclaimer::reclaim, this);
+    return true;
+}
+
+void DataReclaimer::stop() {
+    if (worker_ != nullptr) {
+        worker_->stop();
+        worker_->wait();
+        worker_.reset();
+    }
+}
+
+bool DataReclaimer::add(const std::string& dir) {
+    auto source = bfs::path(dir);
+    auto root = source.parent_path().parent_path() / "reclaim";
+    auto target = root / folly::stringPrintf("%s.%ld",
+                                             source.filename().c_str(),
+                                             time::WallClock::fastNowInMilliSec());
+    boost::system::error_code ec;
+    bfs::create_directories(root, ec);
+    if (!ec) {
+        bfs::rename(source, target, ec);
+    }
+    if (ec) {
+        LOG(ERROR) << "Move " << dir << " to be reclaimed failed: " << ec.message();
+        return false;
+    }
+    LOG(INFO) << "Move " << dir << " to " << target.string() << " to be reclaimed";
+    addTrash(target.string());
+    return true;
+}
+
+void DataReclaimer::addTrash(std::string dir) {
+    auto size = dirSize(dir);
+    std::lock_guard<std::mutex> g(lock_);
+    Trash trash;
+    trash.dir = std::move(dir);
+    trashes_.emplace_back(std::move(trash));
+    progress_.dirs++;
+    progress_.bytesLeft += size;
+}
+
+DataReclaimer::Progress DataReclaimer::progress() const {
+    std::lock_guard<std::mutex> g(lock_);
+    return progress_;
+}
+
+void DataReclaimer::reclaim() {
+    int64_t budget = bytesPerSec_ * kReclaimIntervalMs / 1000;
+    // only the worker removes the trashes, the one in front is not changed by add
+    while (budget > 0) {
+        Trash* trash = nullptr;
+        {
+            std::lock_guard<std::mutex> g(lock_);
+            if (trashes_.empty()) {
+                return;
+            }
+            trash = &trashes_.front();
+        }
+        boost::system::error_code ec;
+        if (!trash->listed) {
+            for (bfs::recursive_directory_iterator it(trash->dir, ec), end;
+                 !ec && it != end;
+                 it.increment(ec)) {
+                if (bfs::is_regular_file(it->status())) {
+                    trash->files.emplace_back(it->path().string());
+                }
+            }
+            trash->listed = true;
+        }
+        int64_t reclaimed = 0;
+        while (budget > 0 && !trash->files.empty()) {
+            const auto& file = trash->files.front();
+            auto size = static_cast<int64_t>(bfs::file_size(file, ec));
+            if (ec) {
+                // removed by someone else
+                trash->files.pop_front();
+                continue;
+            }
+            if (size > budget) {
+                bfs::resize_file(file, size - budget, ec);
+                reclaimed += ec ? 0 : budget;
+                budget = 0;
+                break;
+            }
+            bfs::remove(file, ec);
+            reclaimed += size;
+            budget -= std::max<int64_t>(size, 1);
+            trash->files.pop_front();
+        }
+        std::lock_guard<std::mutex> g(lock_);
+        progress_.bytesReclaimed += reclaimed;
+        progress_.bytesLeft = std::max<int64_t>(progress_.bytesLeft - reclaimed, 0);
+        if (!trash->files.empty()) {
+            return;
+        }
+        // only the empty dirs are left
+        bfs::remove_all(trash->dir, ec);
+        LOG(INFO) << "Reclaimed " << trash->dir;
+        trashes_.pop_front();
+        progress_.dirs--;
+        if (trashes_.empty()) {
+            progress_.bytesLeft = 0;
+        }
+    }
+}
+
+}  // namespace kvstore
+}  // namespace nebula
@@ -0,0 +1,74 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_DATARECLAIMER_H_
+#define KVSTORE_DATARECLAIMER_H_
+
+#include "common/base/Base.h"
+#include "common/thread/GenericWorker.h"
+
+namespace nebula {
+namespace kvstore {
+
+/*
+DataReclaimer removes the data dirs of the spaces dropped in the background, at most
+bytesPerSec bytes per second, instead of removing a whole space at once, which would saturate
+the disk shared with the other spaces.
+
+A dir is moved into "<dataPath>/reclaim" at once, so the space is never loaded again, and its
+files are deleted in the order they are found every kReclaimIntervalMs. A file larger than the
+bytes left in the interval is truncated by the bytes left, it is deleted once it is small enough.
+The dirs left under "<dataPath>/reclaim" are resumed when the reclaimer is started again.
+*/
+class DataReclaimer final {
+public:
+    static constexpr int64_t kReclaimIntervalMs = 100;
+
+    struct Progress {
+        // the dirs not reclaimed yet
+        int64_t     dirs{0};
+        int64_t     bytesLeft{0};
+        int64_t     bytesReclaimed{0};
+    };
+
+    explicit DataReclaimer(int64_t bytesPerSec) : bytesPerSec_(bytesPerSec) {}
+
+    ~DataReclaimer();
+
+    bool start(const std::vector<std::string>& dataPaths);
+
+    void stop();
+
+    // Move the dir, which is "<dataPath>/nebula/<spaceId>", to be reclaimed. Return false if it
+    // could not be moved, the caller should remove it instead
+    bool add(const std::string& dir);
+
+    Progress progress() const;
+
+private:
+    struct Trash {
+        std::string                 dir;
+        // the files of the dir not deleted yet, listed when it is reclaimed first
+        std::deque<std::string>     files;
+        bool                        listed{false};
+    };
+
+    void reclaim();
+
+    void addTrash(std::string dir);
+
+private:
+    int64_t                                     bytesPerSec_;
+    std::unique_ptr<thread::GenericWorker>      worker_;
+    mutable std::mutex                          lock_;
+    std::deque<Trash>                           trashes_;
+    Progress                                    progress_;
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+
+#endif  // KVSTORE_DATARECLAIMER_H_
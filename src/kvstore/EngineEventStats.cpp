@@ -0,0 +1,75 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/EngineEventStats.h"
+
+namespace nebula {
+namespace kvstore {
+
+// static
+EngineEventStats& EngineEventStats::instance() {
+    static EngineEventStats stats;
+    return stats;
+}
+
+EngineEventStats::EngineEventStats() {
+    // up to 10 minutes for the background jobs
+    flushLatency_ = stats::StatsManager::registerHisto(
+        "rocksdb_flush_latency_us", 100000, 0, 600000000, "avg, p75, p95, p99");
+    compactionLatency_ = stats::StatsManager::registerHisto(
+        "rocksdb_compaction_latency_us", 100000, 0, 600000000, "avg, p75, p95, p99");
+    stallDuration_ = stats::StatsManager::registerHisto(
+        "rocksdb_write_stall_duration_us", 100000, 0, 600000000, "avg, p75, p95, p99");
+}
+
+void EngineEventStats::addFlush(GraphSpaceID spaceId,
+                                const std::string& cf,
+                                int64_t bytes,
+                                int64_t micros) {
+    stats::StatsManager::addValue(flushLatency_, micros);
+    std::lock_guard<std::mutex> g(lock_);
+    auto& counters = counters_[std::make_pair(spaceId, cf)];
+    counters.flushes++;
+    counters.flushBytes += bytes;
+    counters.flushMicros += micros;
+}
+
+void EngineEventStats::addCompaction(GraphSpaceID spaceId,
+                                     const std::string& cf,
+                                     int64_t readBytes,
+                                     int64_t writeBytes,
+                                     int64_t micros) {
+    stats::StatsManager::addValue(compactionLatency_, micros);
+    std::lock_guard<std::mutex> g(lock_);
+    auto& counters = counters_[std::make_pair(spaceId, cf)];
+    counters.compactions++;
+    counters.compactionReadBytes += readBytes;
+    counters.compactionWriteBytes += writeBytes;
+    counters.compactionMicros += micros;
+}
+
+void EngineEventStats::addStall(GraphSpaceID spaceId, const std::string& cf, int64_t micros) {
+    stats::StatsManager::addValue(stallDuration_, micros);
+    std::lock_guard<std::mutex> g(lock_);
+    auto& counters = counters_[std::make_pair(spaceId, cf)];
+    counters.stalls++;
+    counters.stallMicros += micros;
+}
+
+void EngineEventStats::addIngest(GraphSpaceID spaceId, const std::string& cf, int64_t bytes) {
+    std::lock_guard<std::mutex> g(lock_);
+    auto& counters = counters_[std::make_pair(spaceId, cf)];
+    counters.ingestedFiles++;
+    counters.ingestedBytes += bytes;
+}
+
+std::map<EngineEventStats::Key, EngineEventStats::Counters> EngineEventStats::snapshot() const {
+    std::lock_guard<std::mutex> g(lock_);
+    return counters_;
+}
+
+}  // namespace kvstore
+}  // namespace nebula
@@ -0,0 +1,77 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_ENGINEEVENTSTATS_H_
+#define KVSTORE_ENGINEEVENTSTATS_H_
+
+#include "common/base/Base.h"
+#include "common/stats/StatsManager.h"
+#include "common/thrift/ThriftTypes.h"
+
+namespace nebula {
+namespace kvstore {
+
+/*
+EngineEventStats accumulates the flushes, compactions, write stalls and ingests reported by the
+EventListener of each engine when enable_rocksdb_event_stats is on, by space and column family.
+The latencies are added into the histograms of the StatsManager as well, the counters are read by
+StorageHttpStatsHandler. The write amplification of a column family is the bytes written by the
+flushes and compactions over the bytes written by the flushes.
+*/
+class EngineEventStats final {
+public:
+    struct Counters {
+        int64_t     flushes{0};
+        int64_t     flushBytes{0};
+        int64_t     flushMicros{0};
+        int64_t     compactions{0};
+        int64_t     compactionReadBytes{0};
+        int64_t     compactionWriteBytes{0};
+        int64_t     compactionMicros{0};
+        int64_t     stalls{0};
+        int64_t     stallMicros{0};
+        int64_t     ingestedFiles{0};
+        int64_t     ingestedBytes{0};
+
+        // in percent, 0 if nothing is flushed yet
+        int64_t writeAmplification() const {
+            return flushBytes > 0 ? (flushBytes + compactionWriteBytes) * 100 / flushBytes : 0;
+        }
+    };
+
+    using Key = std::pair<GraphSpaceID, std::string>;
+
+    static EngineEventStats& instance();
+
+    void addFlush(GraphSpaceID spaceId, const std::string& cf, int64_t bytes, int64_t micros);
+
+    void addCompaction(GraphSpaceID spaceId,
+                       const std::string& cf,
+                       int64_t readBytes,
+                       int64_t writeBytes,
+                       int64_t micros);
+
+    void addStall(GraphSpaceID spaceId, const std::string& cf, int64_t micros);
+
+    void addIngest(GraphSpaceID spaceId, const std::string& cf, int64_t bytes);
+
+    std::map<Key, Counters> snapshot() const;
+
+private:
+    EngineEventStats();
+
+private:
+    mutable std::mutex          lock_;
+    std::map<Key, Counters>     counters_;
+    stats::CounterId            flushLatency_;
+    stats::CounterId            compactionLatency_;
+    stats::CounterId            stallDuration_;
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+
+#endif  // KVSTORE_ENGINEEVENTSTATS_H_
@@ -5,14 +5,22 @@
  */
 
 #include "common/base/Base.h"
+#include "common/time/WallClock.h"
 #include "rocksdb/db.h"
 #include "rocksdb/listener.h"
+#include "kvstore/EngineEventStats.h"
 
 namespace nebula {
 namespace kvstore {
 
+DECLARE_bool(enable_rocksdb_event_stats);
+
+// The events of the engine of the space are logged, and added into EngineEventStats if
+// enable_rocksdb_event_stats is on
 class EventListener : public rocksdb::EventListener {
 public:
+    explicit EventListener(GraphSpaceID spaceId = 0) : spaceId_(spaceId) {}
+
     // A callback function to RocksDB which will be called before a RocksDB starts to compact.
     void OnCompactionBegin(rocksdb::DB*, const rocksdb::CompactionJobInfo& info) override {
         LOG(INFO) << "Rocksdb start compaction column family: " << info.cf_name
@@ -34,6 +42,13 @@ public:
                   << " files into " << info.output_files.size()
                   << ", base level is " << info.base_input_level
                   << ", output level is " << info.output_level;
+        if (FLAGS_enable_rocksdb_event_stats) {
+            EngineEventStats::instance().addCompaction(spaceId_,
+                                                       info.cf_name,
+                                                       info.stats.total_input_bytes,
+                                                       info.stats.total_output_bytes,
+                                                       info.stats.elapsed_micros);
+        }
     }
 
     // A callback function to RocksDB which will be called
@@ -45,6 +60,10 @@ public:
                 << ", the smallest sequence number is " << info.smallest_seqno
                 << ", the largest sequence number is " << info.largest_seqno
                 << ", the properties of the table: " << info.table_properties.ToString();
+        if (FLAGS_enable_rocksdb_event_stats) {
+            std::lock_guard<std::mutex> g(lock_);
+            flushStarts_[info.job_id] = time::WallClock::fastNowInMicroSec();
+        }
     }
 
     // A callback function to RocksDB which will be called
@@ -56,6 +75,19 @@ public:
                 << " the smallest sequence number is " << info.smallest_seqno
                 << " the largest sequence number is " << info.largest_seqno
                 << " the properties of the table: " << info.table_properties.ToString();
+        if (FLAGS_enable_rocksdb_event_stats) {
+            int64_t micros = 0;
+            {
+                std::lock_guard<std::mutex> g(lock_);
+                auto it = flushStarts_.find(info.job_id);
+                if (it != flushStarts_.end()) {
+                    micros = time::WallClock::fastNowInMicroSec() - it->second;
+                    flushStarts_.erase(it);
+                }
+            }
+            EngineEventStats::instance().addFlush(
+                spaceId_, info.cf_name, tableBytes(info.table_properties), micros);
+        }
     }
 
     // A callback function for RocksDB which will be called whenever a SST file is created.
@@ -97,6 +129,10 @@ public:
                   << ", the external file path " << info. external_file_path
                   << ", the internal file path " << info.internal_file_path
                   << ", the properties of the table: " << info.table_properties.ToString();
+        if (FLAGS_enable_rocksdb_event_stats) {
+            EngineEventStats::instance().addIngest(
+                spaceId_, info.cf_name, tableBytes(info.table_properties));
+        }
     }
 
     // A callback function for RocksDB which will be called before setting the
@@ -112,6 +148,27 @@ public:
         LOG(INFO) << "Stall conditions changed column family: " << info.cf_name
                   << ", current condition: " << writeStallConditionString(info.condition.cur)
                   << ", previous condition: " << writeStallConditionString(info.condition.prev);
+        if (!FLAGS_enable_rocksdb_event_stats) {
+            return;
+        }
+        // the stall lasts from the condition leaving normal until it is back
+        auto now = time::WallClock::fastNowInMicroSec();
+        int64_t micros = -1;
+        {
+            std::lock_guard<std::mutex> g(lock_);
+            if (info.condition.prev == rocksdb::WriteStallCondition::kNormal) {
+                stallStarts_[info.cf_name] = now;
+            } else if (info.condition.cur == rocksdb::WriteStallCondition::kNormal) {
+                auto it = stallStarts_.find(info.cf_name);
+                if (it != stallStarts_.end()) {
+                    micros = now - it->second;
+                    stallStarts_.erase(it);
+                }
+            }
+        }
+        if (micros >= 0) {
+            EngineEventStats::instance().addStall(spaceId_, info.cf_name, micros);
+        }
     }
 
     // A callback function for RocksDB which will be called whenever a file read
@@ -177,6 +234,10 @@ public:
     }
 
 private:
+    static int64_t tableBytes(const rocksdb::TableProperties& properties) {
+        return properties.data_size + properties.index_size + properties.filter_size;
+    }
+
     std::string compactionReasonString(const rocksdb::CompactionReason& reason) {
         switch (reason) {
             case rocksdb::CompactionReason::kUnknown:
@@ -296,6 +357,14 @@ private:
                 return "Unknown";
         }
     }
+
+private:
+    GraphSpaceID                                spaceId_;
+    std::mutex                                  lock_;
+    // the start time of the flush jobs, by job id
+    std::unordered_map<int, int64_t>            flushStarts_;
+    // the start time of the stall of each column family
+    std::unordered_map<std::string, int64_t>    stallStarts_;
 };
 
 }  // namespace kvstore
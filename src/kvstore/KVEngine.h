@@ -7,6 +7,7 @@
 #ifndef KVSTORE_KVENGINE_H_
 #define KVSTORE_KVENGINE_H_
 
+#include <rocksdb/options.h>
 #include "common/base/Base.h"
 #include "common/base/Status.h"
 #include "kvstore/Common.h"
@@ -28,6 +29,10 @@ public:
     // Remove all keys in the range [start, end)
     virtual nebula::cpp2::ErrorCode
     removeRange(folly::StringPiece start, folly::StringPiece end) = 0;
+
+    // Write a merge operand of key, which is resolved by the merge operator of engine when
+    // the key is read or compacted
+    virtual nebula::cpp2::ErrorCode merge(folly::StringPiece key, folly::StringPiece operand) = 0;
 };
 
 
@@ -66,17 +71,46 @@ public:
     virtual nebula::cpp2::ErrorCode
     range(const std::string& start,
           const std::string& end,
-          std::unique_ptr<KVIterator>* iter) = 0;
+          std::unique_ptr<KVIterator>* iter,
+          ScanHint hint = ScanHint::kDefault) = 0;
 
     // Get all results with 'prefix' str as prefix.
     virtual nebula::cpp2::ErrorCode
-    prefix(const std::string& prefix, std::unique_ptr<KVIterator>* iter) = 0;
+    prefix(const std::string& prefix,
+           std::unique_ptr<KVIterator>* iter,
+           ScanHint hint = ScanHint::kDefault) = 0;
 
-    // Get all results with 'prefix' str as prefix starting form 'start'
+    // Get all results with 'prefix' str as prefix starting form 'start',
+    // read the given snapshot if it is not nullptr
     virtual nebula::cpp2::ErrorCode
     rangeWithPrefix(const std::string& start,
                     const std::string& prefix,
-                    std::unique_ptr<KVIterator>* iter) = 0;
+                    std::unique_ptr<KVIterator>* iter,
+                    const void* snapshot = nullptr,
+                    ScanHint hint = ScanHint::kDefault) = 0;
+
+    // Create a prefix iterator which could be moved to other prefixes by KVIterator::seek, so
+    // one iterator is reused for many prefixes. Return false if the engine doesn't support it
+    // or the prefix, then nothing is created.
+    virtual bool reusablePrefix(const std::string& prefix, std::unique_ptr<KVIterator>* iter) {
+        UNUSED(prefix);
+        UNUSED(iter);
+        return false;
+    }
+
+    // Take a snapshot of current data, which must be released by releaseSnapshot
+    // before the engine is destroyed. Return nullptr if not supported.
+    virtual const void* getSnapshot() = 0;
+
+    virtual void releaseSnapshot(const void* snapshot) = 0;
+
+    // Estimate the number of keys in [start, end) without reading them, and return the keys
+    // splitting the range into pieces of about the same size by splits, from which the range
+    // could be sampled evenly
+    virtual nebula::cpp2::ErrorCode estimateRange(const std::string& start,
+                                                  const std::string& end,
+                                                  int64_t* keys,
+                                                  std::vector<std::string>* splits) = 0;
 
     // Write a single record
     virtual nebula::cpp2::ErrorCode put(std::string key, std::string value) = 0;
@@ -110,6 +144,12 @@ public:
     virtual nebula::cpp2::ErrorCode ingest(const std::vector<std::string>& files,
                                            bool verifyFileChecksum = false) = 0;
 
+    // The options to write the sst files to ingest, so that they are in the same format
+    // (comparator, compression, table options) as the ones flushed by the engine
+    virtual rocksdb::Options sstOptions() {
+        return rocksdb::Options();
+    }
+
     // Set Config Option
     virtual nebula::cpp2::ErrorCode
     setOption(const std::string& configKey, const std::string& configValue) = 0;
@@ -121,6 +161,16 @@ public:
 
     virtual nebula::cpp2::ErrorCode compact() = 0;
 
+    // Compact the data in [start, end), an empty end is after all keys. If level is not
+    // negative, only the files of the level overlapping the range are compacted, into the next
+    // level.
+    virtual nebula::cpp2::ErrorCode compactRange(const std::string& start,
+                                                 const std::string& end,
+                                                 int32_t level) = 0;
+
+    // Compact the files holding the data expired by ttl or of the dropped schemas
+    virtual nebula::cpp2::ErrorCode compactExpired() = 0;
+
     virtual nebula::cpp2::ErrorCode flush() = 0;
 
     virtual nebula::cpp2::ErrorCode createCheckpoint(const std::string& name) = 0;
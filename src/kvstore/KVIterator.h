@@ -25,6 +25,13 @@ public:
     virtual folly::StringPiece key() const = 0;
 
     virtual folly::StringPiece val() const = 0;
+
+    // Move to the first key with the prefix, the iterator keeps a copy of it. Return false if
+    // the iterator can't be moved to it, which is left as it was.
+    virtual bool seek(const std::string& prefix) {
+        UNUSED(prefix);
+        return false;
+    }
 };
 
 }  // namespace kvstore
@@ -14,6 +14,7 @@
 #include "common/base/Status.h"
 #include "common/meta/SchemaManager.h"
 #include "kvstore/Common.h"
+#include "kvstore/CommitObserver.h"
 #include "kvstore/CompactionFilter.h"
 #include "kvstore/KVIterator.h"
 #include "kvstore/PartManager.h"
@@ -47,6 +48,9 @@ struct KVOptions {
 
     // Custom CompactionFilter used in compaction.
     std::unique_ptr<CompactionFilterFactoryBuilder> cffBuilder_{nullptr};
+
+    // Told of the keys committed into the parts, nullptr if none.
+    std::shared_ptr<CommitObserver> commitObserver_{nullptr};
 };
 
 struct StoreCapability {
@@ -56,6 +60,46 @@ struct StoreCapability {
 #define SUPPORT_FILTERING(store) (store.capability() & StoreCapability::SC_FILTERING)
 
 class Part;
+
+/**
+ * The reads of one part, which is looked up and leader checked once when the handle is created
+ * by KVStore::partHandle, instead of on each read. A handle is meant for the reads of one
+ * request, the leader changed after it is created is not noticed by the reads through it.
+ **/
+class PartHandle {
+public:
+    virtual ~PartHandle() = default;
+
+    virtual nebula::cpp2::ErrorCode get(const std::string& key, std::string* value) = 0;
+
+    virtual std::pair<nebula::cpp2::ErrorCode, std::vector<Status>>
+    multiGet(const std::vector<std::string>& keys, std::vector<std::string>* values) = 0;
+
+    virtual nebula::cpp2::ErrorCode
+    range(const std::string& start,
+          const std::string& end,
+          std::unique_ptr<KVIterator>* iter,
+          ScanHint hint = ScanHint::kDefault) = 0;
+
+    virtual nebula::cpp2::ErrorCode
+    prefix(const std::string& prefix,
+           std::unique_ptr<KVIterator>* iter,
+           ScanHint hint = ScanHint::kDefault) = 0;
+
+    // To forbid to pass rvalue via the `prefix' parameter, see KVStore::prefix
+    nebula::cpp2::ErrorCode
+    prefix(std::string&& prefix,
+           std::unique_ptr<KVIterator>* iter,
+           ScanHint hint = ScanHint::kDefault) = delete;
+
+    virtual nebula::cpp2::ErrorCode
+    rangeWithPrefix(const std::string& start,
+                    const std::string& prefix,
+                    std::unique_ptr<KVIterator>* iter,
+                    const void* snapshot = nullptr,
+                    ScanHint hint = ScanHint::kDefault) = 0;
+};
+
 /**
  * Interface for all kv-stores
  **/
@@ -101,7 +145,8 @@ public:
           const std::string& start,
           const std::string& end,
           std::unique_ptr<KVIterator>* iter,
-          bool canReadFromFollower = false) = 0;
+          bool canReadFromFollower = false,
+          ScanHint hint = ScanHint::kDefault) = 0;
 
     // Since the `range' interface will hold references to its 3rd & 4th parameter, in `iter',
     // thus the arguments must outlive `iter'.
@@ -112,7 +157,8 @@ public:
           std::string&& start,
           std::string&& end,
           std::unique_ptr<KVIterator>* iter,
-          bool canReadFromFollower = false) = delete;
+          bool canReadFromFollower = false,
+          ScanHint hint = ScanHint::kDefault) = delete;
 
     // Get all results with prefix.
     virtual nebula::cpp2::ErrorCode
@@ -120,7 +166,8 @@ public:
            PartitionID partId,
            const std::string& prefix,
            std::unique_ptr<KVIterator>* iter,
-           bool canReadFromFollower = false) = 0;
+           bool canReadFromFollower = false,
+           ScanHint hint = ScanHint::kDefault) = 0;
 
     // To forbid to pass rvalue via the `prefix' parameter.
     virtual nebula::cpp2::ErrorCode
@@ -128,16 +175,20 @@ public:
            PartitionID partId,
            std::string&& prefix,
            std::unique_ptr<KVIterator>* iter,
-           bool canReadFromFollower = false) = delete;
+           bool canReadFromFollower = false,
+           ScanHint hint = ScanHint::kDefault) = delete;
 
-    // Get all results with prefix starting from start
+    // Get all results with prefix starting from start, read the snapshot of the part's
+    // engine if it is not nullptr, see KVEngine::getSnapshot
     virtual nebula::cpp2::ErrorCode
     rangeWithPrefix(GraphSpaceID spaceId,
                     PartitionID partId,
                     const std::string& start,
                     const std::string& prefix,
                     std::unique_ptr<KVIterator>* iter,
-                    bool canReadFromFollower = false) = 0;
+                    bool canReadFromFollower = false,
+                    const void* snapshot = nullptr,
+                    ScanHint hint = ScanHint::kDefault) = 0;
 
     // To forbid to pass rvalue via the `rangeWithPrefix' parameter.
     virtual nebula::cpp2::ErrorCode
@@ -146,11 +197,25 @@ public:
                     std::string&& start,
                     std::string&& prefix,
                     std::unique_ptr<KVIterator>* iter,
-                    bool canReadFromFollower = false) = delete;
+                    bool canReadFromFollower = false,
+                    const void* snapshot = nullptr,
+                    ScanHint hint = ScanHint::kDefault) = delete;
+
+    // The handle of the part to read it without looking it up and checking the leader again,
+    // which reads through the store if the store has no faster way
+    virtual ErrorOr<nebula::cpp2::ErrorCode, std::unique_ptr<PartHandle>>
+    partHandle(GraphSpaceID spaceId, PartitionID partId, bool canReadFromFollower = false);
 
     virtual nebula::cpp2::ErrorCode
     sync(GraphSpaceID spaceId, PartitionID partId) = 0;
 
+    // Make sure the reads afterwards see all writes finished before, without writing a log
+    // if the store supports it
+    virtual nebula::cpp2::ErrorCode
+    readIndex(GraphSpaceID spaceId, PartitionID partId) {
+        return sync(spaceId, partId);
+    }
+
     virtual void asyncMultiPut(GraphSpaceID spaceId,
                                PartitionID partId,
                                std::vector<KV>&& keyValues,
@@ -191,6 +256,11 @@ public:
 
     virtual nebula::cpp2::ErrorCode ingest(GraphSpaceID spaceId) = 0;
 
+    /**
+     * @brief Ingest the downloaded SST files of a part, which are removed once ingested
+     */
+    virtual nebula::cpp2::ErrorCode ingest(GraphSpaceID spaceId, PartitionID partId) = 0;
+
     virtual int32_t allLeader(std::unordered_map<GraphSpaceID,
                               std::vector<meta::cpp2::LeaderInfo>>& leaderIds) = 0;
 
@@ -230,6 +300,65 @@ protected:
     KVStore() = default;
 };
 
+// The handle reading through the store, which looks up the part on each read
+class StorePartHandle final : public PartHandle {
+public:
+    StorePartHandle(KVStore* store,
+                    GraphSpaceID spaceId,
+                    PartitionID partId,
+                    bool canReadFromFollower)
+        : store_(store)
+        , spaceId_(spaceId)
+        , partId_(partId)
+        , canReadFromFollower_(canReadFromFollower) {}
+
+    nebula::cpp2::ErrorCode get(const std::string& key, std::string* value) override {
+        return store_->get(spaceId_, partId_, key, value, canReadFromFollower_);
+    }
+
+    std::pair<nebula::cpp2::ErrorCode, std::vector<Status>>
+    multiGet(const std::vector<std::string>& keys, std::vector<std::string>* values) override {
+        return store_->multiGet(spaceId_, partId_, keys, values, canReadFromFollower_);
+    }
+
+    nebula::cpp2::ErrorCode
+    range(const std::string& start,
+          const std::string& end,
+          std::unique_ptr<KVIterator>* iter,
+          ScanHint hint) override {
+        return store_->range(spaceId_, partId_, start, end, iter, canReadFromFollower_, hint);
+    }
+
+    nebula::cpp2::ErrorCode
+    prefix(const std::string& prefix,
+           std::unique_ptr<KVIterator>* iter,
+           ScanHint hint) override {
+        return store_->prefix(spaceId_, partId_, prefix, iter, canReadFromFollower_, hint);
+    }
+
+    nebula::cpp2::ErrorCode
+    rangeWithPrefix(const std::string& start,
+                    const std::string& prefix,
+                    std::unique_ptr<KVIterator>* iter,
+                    const void* snapshot,
+                    ScanHint hint) override {
+        return store_->rangeWithPrefix(spaceId_, partId_, start, prefix, iter,
+                                       canReadFromFollower_, snapshot, hint);
+    }
+
+private:
+    KVStore*            store_;
+    GraphSpaceID        spaceId_;
+    PartitionID         partId_;
+    bool                canReadFromFollower_;
+};
+
+inline ErrorOr<nebula::cpp2::ErrorCode, std::unique_ptr<PartHandle>>
+KVStore::partHandle(GraphSpaceID spaceId, PartitionID partId, bool canReadFromFollower) {
+    return std::unique_ptr<PartHandle>(
+        new StorePartHandle(this, spaceId, partId, canReadFromFollower));
+}
+
 }   // namespace kvstore
 }   // namespace nebula
 
@@ -5,15 +5,27 @@
  */
 
 #include "common/time/WallClock.h"
+#include "common/fs/FileUtils.h"
 #include "kvstore/Listener.h"
 #include "kvstore/LogEncoder.h"
 #include "codec/RowReaderWrapper.h"
+#include "utils/NebulaKeyUtils.h"
+#include <rocksdb/db.h>
 
 DEFINE_int32(listener_commit_interval_secs, 1, "Listener commit interval");
 DEFINE_int32(listener_commit_batch_size, 1000, "Max batch size when listener commit");
 DEFINE_int32(ft_request_retry_times, 3, "Retry times if fulltext request failed");
 DEFINE_int32(ft_bulk_batch_size, 100, "Max batch size when bulk insert");
+DEFINE_int32(ft_bulk_batch_bytes, 0, "Max bytes of the texts when bulk insert, 0 for no limit");
+DEFINE_int32(ft_bulk_parallelism, 1,
+             "The bulk inserts sent at once by a listener, to the fulltext clients in turn");
 DEFINE_int32(listener_pursue_leader_threshold, 1000, "Catch up with the leader's threshold");
+DEFINE_string(listener_bootstrap_dir, "",
+              "The dir of the checkpoints a new listener is bootstrapped from, the data dirs of "
+              "the checkpoints of a space are copied into <dir>/<spaceId>/<any name>");
+DEFINE_int32(listener_apply_batches, 1,
+             "The batches of listener_commit_batch_size applied at once by a listener, the logs "
+             "left are applied at once instead of in the next interval if more than 1");
 
 namespace nebula {
 namespace kvstore {
@@ -46,6 +58,11 @@ void Listener::start(std::vector<HostAddr>&& peers, bool) {
     // Set the quorum number
     quorum_ = (peers.size() + 1) / 2;
 
+    std::pair<LogID, TermID> checkpoint{0, 0};
+    if (lastCommittedLogId().first == 0) {
+        checkpoint = bootstrap();
+    }
+
     auto logIdAndTerm = lastCommittedLogId();
     committedLogId_ = logIdAndTerm.first;
 
@@ -56,6 +73,10 @@ void Listener::start(std::vector<HostAddr>&& peers, bool) {
         lastLogTerm_ = term_;
         wal_->reset();
     }
+    if (checkpoint.first > 0) {
+        // the leader sends the logs after the checkpoint
+        lastLogTerm_ = term_ = proposedTerm_ = checkpoint.second;
+    }
 
     lastApplyLogId_ = lastApplyLogId();
 
@@ -89,6 +110,96 @@ void Listener::stop() {
     }
 }
 
+std::pair<LogID, TermID> Listener::bootstrap() {
+    if (FLAGS_listener_bootstrap_dir.empty()) {
+        return {0, 0};
+    }
+    auto spaceDir = folly::stringPrintf("%s/%d", FLAGS_listener_bootstrap_dir.c_str(), spaceId_);
+    if (!fs::FileUtils::exist(spaceDir)) {
+        return {0, 0};
+    }
+    // The part could be in the checkpoints of all its replicas, the latest one is used
+    std::unique_ptr<rocksdb::DB> db;
+    std::string path;
+    LogID logId = 0;
+    TermID termId = 0;
+    for (auto& name : fs::FileUtils::listAllDirsInDir(spaceDir.c_str())) {
+        auto dir = fs::FileUtils::joinPath(spaceDir, name);
+        rocksdb::DB* raw = nullptr;
+        auto status = rocksdb::DB::OpenForReadOnly(rocksdb::Options(), dir, &raw);
+        if (!status.ok()) {
+            LOG(WARNING) << idStr_ << "Open the checkpoint " << dir << " failed: "
+                         << status.ToString();
+            continue;
+        }
+        std::unique_ptr<rocksdb::DB> checkpoint(raw);
+        std::string val;
+        status = checkpoint->Get(rocksdb::ReadOptions(),
+                                 NebulaKeyUtils::systemCommitKey(partId_),
+                                 &val);
+        if (!status.ok() || val.size() != sizeof(LogID) + sizeof(TermID)) {
+            continue;
+        }
+        LogID id;
+        memcpy(reinterpret_cast<void*>(&id), val.data(), sizeof(LogID));
+        if (id > logId) {
+            logId = id;
+            memcpy(reinterpret_cast<void*>(&termId), val.data() + sizeof(LogID), sizeof(TermID));
+            db = std::move(checkpoint);
+            path = std::move(dir);
+        }
+    }
+    if (db == nullptr) {
+        return {0, 0};
+    }
+
+    LOG(INFO) << idStr_ << "Bootstrap from the checkpoint " << path << " of log " << logId
+              << ", term " << termId;
+    size_t num = std::max(FLAGS_listener_apply_batches, 1);
+    size_t limit = FLAGS_listener_commit_batch_size * num;
+    int64_t count = 0;
+    for (auto& prefix : {NebulaKeyUtils::vertexPrefix(partId_),
+                         NebulaKeyUtils::edgePrefix(partId_)}) {
+        std::unique_ptr<rocksdb::Iterator> iter(db->NewIterator(rocksdb::ReadOptions()));
+        std::vector<KV> data;
+        iter->Seek(prefix);
+        while (true) {
+            bool valid = iter->Valid() && iter->key().starts_with(prefix);
+            if (valid) {
+                data.emplace_back(iter->key().ToString(), iter->value().ToString());
+                iter->Next();
+            }
+            if (data.size() < limit && valid) {
+                continue;
+            }
+            count += data.size();
+            if (!data.empty() && !applyBatches(std::move(data), {}, num).get()) {
+                LOG(ERROR) << idStr_ << "Bootstrap failed after " << count << " keys";
+                return {0, 0};
+            }
+            data.clear();
+            if (!valid) {
+                break;
+            }
+            if (isStopped()) {
+                return {0, 0};
+            }
+        }
+        if (!iter->status().ok()) {
+            LOG(ERROR) << idStr_ << "Read the checkpoint " << path << " failed: "
+                       << iter->status().ToString();
+            return {0, 0};
+        }
+    }
+
+    committedLogId_ = logId;
+    leaderCommitId_ = logId;
+    lastApplyLogId_ = logId;
+    persist(logId, termId, logId);
+    LOG(INFO) << idStr_ << "Bootstrapped " << count << " keys from the checkpoint " << path;
+    return {logId, termId};
+}
+
 bool Listener::preProcessLog(LogID logId,
                              TermID termId,
                              ClusterID clusterId,
@@ -130,7 +241,10 @@ void Listener::doApply() {
     if (isStopped()) {
         return;
     }
-    // todo(doodle): only put is handled, all remove is ignored for now
+    if (FLAGS_listener_apply_batches > 1) {
+        doApplyBatches();
+        return;
+    }
     folly::via(executor_.get(), [this] {
         SCOPE_EXIT {
             bgWorkers_->addDelayTask(FLAGS_listener_commit_interval_secs * 1000,
@@ -146,79 +260,223 @@ void Listener::doApply() {
             iter = wal_->iterator(lastApplyLogId_ + 1, committedLogId_);
         }
 
-        LogID lastApplyId = -1;
         // the kv pair which can sync to remote safely
         std::vector<KV> data;
-        while (iter->valid()) {
-            lastApplyId = iter->logId();
+        std::vector<KV> removes;
+        auto lastApplyId = decodeLogs(iter.get(), FLAGS_listener_commit_batch_size,
+                                      &data, &removes);
 
-            auto log = iter->logMsg();
-            if (log.empty()) {
-                // skip the heartbeat
-                ++(*iter);
-                continue;
+        // apply to state machine
+        if (!apply(data) || (!removes.empty() && !remove(removes))) {
+            abortApply();
+            return;
+        }
+        commitApplyId(lastApplyId);
+    });
+}
+
+void Listener::doApplyBatches() {
+    folly::via(executor_.get(), [this] {
+        std::unique_ptr<LogIterator> iter;
+        {
+            std::lock_guard<std::mutex> guard(raftLock_);
+            if (lastApplyLogId_ >= committedLogId_) {
+                bgWorkers_->addDelayTask(FLAGS_listener_commit_interval_secs * 1000,
+                                         &Listener::doApply, this);
+                return;
             }
+            iter = wal_->iterator(lastApplyLogId_ + 1, committedLogId_);
+        }
 
-            DCHECK_GE(log.size(), sizeof(int64_t) + 1 + sizeof(uint32_t));
-            switch (log[sizeof(int64_t)]) {
-                case OP_PUT: {
-                    auto pieces = decodeMultiValues(log);
-                    DCHECK_EQ(2, pieces.size());
-                    data.emplace_back(pieces[0], pieces[1]);
-                    break;
-                }
-                case OP_MULTI_PUT: {
-                    auto kvs = decodeMultiValues(log);
-                    DCHECK_EQ((kvs.size() + 1) / 2, kvs.size() / 2);
-                    for (size_t i = 0; i < kvs.size(); i += 2) {
-                        data.emplace_back(kvs[i], kvs[i + 1]);
-                    }
-                    break;
+        size_t num = FLAGS_listener_apply_batches;
+        std::vector<KV> data;
+        std::vector<KV> removes;
+        auto lastApplyId = decodeLogs(iter.get(), FLAGS_listener_commit_batch_size * num,
+                                      &data, &removes);
+        // stopped by the size, there are more logs to apply
+        bool full = iter->valid();
+
+        // the logs are applied once all the batches succeeded
+        applyBatches(std::move(data), std::move(removes), num).thenValue(
+                [this, lastApplyId, full] (bool succeeded) {
+            if (succeeded) {
+                succeeded = commitApplyId(lastApplyId);
+            } else {
+                abortApply();
+            }
+            if (succeeded && full) {
+                bgWorkers_->addTask(&Listener::doApply, this);
+            } else {
+                bgWorkers_->addDelayTask(FLAGS_listener_commit_interval_secs * 1000,
+                                         &Listener::doApply, this);
+            }
+        });
+    });
+}
+
+folly::Future<bool> Listener::applyBatches(std::vector<KV> data,
+                                           std::vector<KV> removes,
+                                           size_t num) {
+    // The changes of a key are in the same batch in order, so the batches could be applied in
+    // any order
+    std::vector<std::vector<KV>> batches(num);
+    std::vector<std::vector<KV>> batchRemoves(num);
+    for (auto& kv : data) {
+        batches[std::hash<std::string>()(kv.first) % num].emplace_back(std::move(kv));
+    }
+    for (auto& kv : removes) {
+        batchRemoves[std::hash<std::string>()(kv.first) % num].emplace_back(std::move(kv));
+    }
+    std::vector<folly::Future<bool>> futures;
+    for (size_t i = 0; i < num; i++) {
+        if (batches[i].empty() && batchRemoves[i].empty()) {
+            continue;
+        }
+        futures.emplace_back(folly::via(executor_.get(),
+                                        [this,
+                                         kvs = std::move(batches[i]),
+                                         dels = std::move(batchRemoves[i])] {
+            return apply(kvs) && (dels.empty() || remove(dels));
+        }));
+    }
+    return folly::collectAll(futures).via(executor_.get()).thenValue(
+            [] (std::vector<folly::Try<bool>>&& tries) {
+        return std::all_of(tries.begin(), tries.end(), [] (const auto& t) {
+            return t.hasValue() && t.value();
+        });
+    });
+}
+
+LogID Listener::decodeLogs(LogIterator* iter,
+                           int32_t limit,
+                           std::vector<KV>* data,
+                           std::vector<KV>* removes) {
+    LogID lastApplyId = -1;
+    while (iter->valid()) {
+        auto log = iter->logMsg();
+        if (log.empty()) {
+            // skip the heartbeat
+            lastApplyId = iter->logId();
+            ++(*iter);
+            continue;
+        }
+        std::string decompressed;
+        if (log[sizeof(int64_t)] == OP_COMPRESSED) {
+            decompressed = decompressLog(log);
+            log = decompressed;
+        }
+
+        DCHECK_GE(log.size(), sizeof(int64_t) + 1 + sizeof(uint32_t));
+        std::vector<KV> puts;
+        std::vector<KV> dels;
+        switch (log[sizeof(int64_t)]) {
+            case OP_PUT: {
+                auto pieces = decodeMultiValues(log);
+                DCHECK_EQ(2, pieces.size());
+                puts.emplace_back(pieces[0], pieces[1]);
+                break;
+            }
+            case OP_MULTI_PUT: {
+                auto kvs = decodeMultiValues(log);
+                DCHECK_EQ((kvs.size() + 1) / 2, kvs.size() / 2);
+                for (size_t i = 0; i < kvs.size(); i += 2) {
+                    puts.emplace_back(kvs[i], kvs[i + 1]);
                 }
-                case OP_REMOVE:
-                case OP_REMOVE_RANGE:
-                case OP_MULTI_REMOVE: {
-                    break;
+                break;
+            }
+            case OP_REMOVE: {
+                dels.emplace_back(decodeSingleValue(log), "");
+                break;
+            }
+            case OP_MULTI_REMOVE: {
+                for (auto& key : decodeMultiValues(log)) {
+                    dels.emplace_back(key, "");
                 }
-                case OP_BATCH_WRITE: {
-                    auto batch = decodeBatchValue(log);
-                    for (auto& op : batch) {
-                        // OP_BATCH_PUT and OP_BATCH_REMOVE_RANGE is igored
-                        if (op.first == BatchLogType::OP_BATCH_PUT) {
-                            data.emplace_back(op.second.first, op.second.second);
-                        }
+                break;
+            }
+            case OP_REMOVE_RANGE: {
+                // the ranges are only removed by the parts or the indexes dropped
+                break;
+            }
+            case OP_BATCH_WRITE: {
+                auto batch = decodeBatchValue(log);
+                // The puts and the removes of a log are applied separately, so a key put and
+                // removed in it only takes the last change, which is what the log is written.
+                // The changes before are never seen as the log is written at once.
+                std::unordered_set<std::string> changed;
+                for (auto op = batch.rbegin(); op != batch.rend(); ++op) {
+                    // OP_BATCH_REMOVE_RANGE is igored
+                    if (op->first == BatchLogType::OP_BATCH_MERGE) {
+                        // the parts with listeners are not written by merge operands, see
+                        // update_by_merge_operand_spaces
+                        LOG(WARNING) << idStr_ << "Skip the merge operand of log "
+                                     << iter->logId();
+                        continue;
+                    }
+                    if ((op->first != BatchLogType::OP_BATCH_PUT &&
+                         op->first != BatchLogType::OP_BATCH_REMOVE) ||
+                        !changed.emplace(op->second.first.str()).second) {
+                        continue;
+                    }
+                    if (op->first == BatchLogType::OP_BATCH_PUT) {
+                        puts.emplace_back(op->second.first, op->second.second);
+                    } else {
+                        // with the value removed if it's logged
+                        dels.emplace_back(op->second.first, op->second.second);
                     }
-                    break;
-                }
-                case OP_TRANS_LEADER:
-                case OP_ADD_LEARNER:
-                case OP_ADD_PEER:
-                case OP_REMOVE_PEER: {
-                    break;
-                }
-                default: {
-                    LOG(WARNING) << idStr_ << "Unknown operation: " << static_cast<int32_t>(log[0]);
                 }
+                std::reverse(puts.begin(), puts.end());
+                std::reverse(dels.begin(), dels.end());
+                break;
             }
-
-            if (static_cast<int32_t>(data.size()) > FLAGS_listener_commit_batch_size) {
+            case OP_TRANS_LEADER:
+            case OP_ADD_LEARNER:
+            case OP_ADD_PEER:
+            case OP_REMOVE_PEER: {
                 break;
             }
-            ++(*iter);
+            default: {
+                LOG(WARNING) << idStr_ << "Unknown operation: " << static_cast<int32_t>(log[0]);
+            }
         }
 
-        // apply to state machine
-        if (apply(data)) {
-            std::lock_guard<std::mutex> guard(raftLock_);
-            lastApplyLogId_ = lastApplyId;
-            persist(committedLogId_, term_, lastApplyLogId_);
-            VLOG(1) << idStr_ << "Listener succeeded apply log to " << lastApplyLogId_;
-            lastApplyTime_ = time::WallClock::fastNowInMilliSec();
-            VLOG(1) << folly::sformat("Commit snapshot to : committedLogId={},"
-                                      "committedLogTerm={}, lastApplyLogId_={}",
-                                      committedLogId_, term_, lastApplyLogId_);
+        // The puts are applied before the removes, so the batch is split once the kind of
+        // changes differs from the logs before: the removes after the puts, or the puts after
+        // the removes, are left to the next batch. A log of both kinds is only taken as the
+        // first one of a batch, and no log after it, the keys changed in it are distinct.
+        if ((!dels.empty() && !data->empty()) || (!puts.empty() && !removes->empty())) {
+            break;
         }
-    });
+        lastApplyId = iter->logId();
+        for (auto& kv : puts) {
+            data->emplace_back(std::move(kv));
+        }
+        for (auto& kv : dels) {
+            removes->emplace_back(std::move(kv));
+        }
+
+        if (static_cast<int32_t>(data->size() + removes->size()) > limit) {
+            break;
+        }
+        ++(*iter);
+    }
+    return lastApplyId;
+}
+
+bool Listener::commitApplyId(LogID lastApplyId) {
+    std::lock_guard<std::mutex> guard(raftLock_);
+    if (!persist(committedLogId_, term_, lastApplyId)) {
+        LOG(WARNING) << idStr_ << "Persist the apply log " << lastApplyId << " failed";
+        abortApply();
+        return false;
+    }
+    lastApplyLogId_ = lastApplyId;
+    VLOG(1) << idStr_ << "Listener succeeded apply log to " << lastApplyLogId_;
+    lastApplyTime_ = time::WallClock::fastNowInMilliSec();
+    VLOG(1) << folly::sformat("Commit snapshot to : committedLogId={},"
+                              "committedLogTerm={}, lastApplyLogId_={}",
+                              committedLogId_, term_, lastApplyLogId_);
+    return true;
 }
 
 std::pair<int64_t, int64_t> Listener::commitSnapshot(const std::vector<std::string>& rows,
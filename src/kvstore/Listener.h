@@ -33,6 +33,12 @@ trigger the apply within a certain interval (listener_commit_interval_secs), it
 in range of [lastApplyLogId_ + 1, committedLogId_], and decode these logs into kv, and apply them
 to state machine.
 
+A new listener could be bootstrapped from the checkpoints of the storage in listener_bootstrap_dir
+instead of the snapshot sent by the leader, which applies the rows one batch after another. The
+vertices and edges of the part in the latest checkpoint are applied in parallel batches before it
+joins the raft group, then it starts at the commit log of the checkpoint, so the leader only sends
+the logs after it, as long as they are still in the wal of the leader.
+
 If you want to add a new type of listener, just inherit from Listener. There are some interface you
 need to implement, some of them has been implemented in Listener. Others need to impelemented in
 derived class.
@@ -79,9 +85,16 @@ derived class.
     // apply the kv to state machine
     bool apply(const std::vector<KV>& data)
 
-    // persist last commit log id/term and lastApplyId
+    // remove the keys from state machine, with the values removed if logged, the removes are
+    // ignored by default
+    bool remove(const std::vector<KV>& removes)
+
+    // persist last commit log id/term and lastApplyId, the logs are applied again if it fails
     bool persist(LogID, TermID, LogID)
 
+    // the logs decoded are not applied by all the batches, they are applied again later
+    void abortApply()
+
     // extra cleanup work, will be invoked when listener is about to be removed, or raft is reseted
     virtual void cleanup() = 0
 */
@@ -129,8 +142,19 @@ protected:
 
     virtual bool apply(const std::vector<KV>& data) = 0;
 
+    // The removes of the logs, applied after the puts before them. Each key comes with the value
+    // removed if the log has it, otherwise empty, see DeleteVerticesProcessor. The ranges removed
+    // are not passed, they are only removed by the parts or the indexes dropped
+    virtual bool remove(const std::vector<KV>& removes) {
+        UNUSED(removes);
+        return true;
+    }
+
     virtual bool persist(LogID, TermID, LogID) = 0;
 
+    // The logs applied in part are to be applied again from lastApplyLogId_ + 1
+    virtual void abortApply() {}
+
     void onLostLeadership(TermID) override {
         LOG(FATAL) << "Should not reach here";
     }
@@ -173,6 +197,30 @@ protected:
 
     void doApply();
 
+    // Apply the part in the checkpoints of listener_bootstrap_dir if there is any, return the log
+    // id and term of the checkpoint applied, or 0 if it's not bootstrapped
+    std::pair<LogID, TermID> bootstrap();
+
+    // Apply the changes in num batches at once, split by the hash of the keys
+    folly::Future<bool> applyBatches(std::vector<KV> data,
+                                     std::vector<KV> removes,
+                                     size_t num);
+
+    // Apply up to listener_apply_batches batches at once, split by the hash of the keys
+    void doApplyBatches();
+
+    // Decode the puts of the logs into data and the removes into removes, until there are more
+    // than limit of them, or a remove follows a put or the other way around. A log of both puts
+    // and removes is only decoded as the first one, with the last change of each key in it.
+    // Return the id of the last log decoded, the iter is still valid if it's stopped
+    LogID decodeLogs(LogIterator* iter,
+                     int32_t limit,
+                     std::vector<KV>* data,
+                     std::vector<KV>* removes);
+
+    // Persist the last apply log, it's not moved if the persist fails
+    bool commitApplyId(LogID lastApplyId);
+
 protected:
     LogID leaderCommitId_ = 0;
     LogID lastApplyLogId_ = 0;
@@ -10,6 +10,12 @@
 #include "kvstore/LogEncoder.h"
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 #include <thrift/lib/cpp2/protocol/CompactProtocol.h>
+#include <folly/compression/Compression.h>
+
+DEFINE_int32(wal_compress_threshold, 0,
+             "The data logs larger than so many bytes are compressed before written into wal "
+             "and replicated, 0 means never");
+DEFINE_string(wal_compression, "lz4", "The compression of the logs, lz4 or zstd");
 
 namespace nebula {
 namespace kvstore {
@@ -253,6 +259,62 @@ int64_t getTimestamp(const folly::StringPiece& command) {
     return *reinterpret_cast<const int64_t*>(command.begin());
 }
 
+bool isDataLog(char type) {
+    switch (type) {
+        case OP_PUT:
+        case OP_MULTI_PUT:
+        case OP_REMOVE:
+        case OP_MULTI_REMOVE:
+        case OP_REMOVE_RANGE:
+        case OP_BATCH_WRITE:
+        case OP_COMPRESSED:
+            return true;
+        default:
+            return false;
+    }
+}
+
+/**
+ * The compressed log is made up of the timestamp, OP_COMPRESSED, the codec type (1 byte) and
+ * the original log compressed, whose size is encoded by the codec itself.
+ * */
+std::string compressLog(std::string log) {
+    if (FLAGS_wal_compress_threshold <= 0 ||
+            log.size() <= static_cast<size_t>(FLAGS_wal_compress_threshold)) {
+        return log;
+    }
+    auto type = FLAGS_wal_compression == "zstd" ? folly::io::CodecType::ZSTD
+                                                : folly::io::CodecType::LZ4_VARINT_SIZE;
+    if (!folly::io::hasCodec(type)) {
+        LOG_EVERY_N(WARNING, 1000) << "The compression " << FLAGS_wal_compression
+                                   << " is not supported";
+        return log;
+    }
+    auto compressed = folly::io::getCodec(type)->compress(log);
+    if (compressed.size() + sizeof(int64_t) + 2 >= log.size()) {
+        return log;
+    }
+
+    std::string encoded;
+    encoded.reserve(sizeof(int64_t) + 2 + compressed.size());
+    int64_t ts = time::WallClock::fastNowInMilliSec();
+    auto logType = OP_COMPRESSED;
+    auto codecType = static_cast<char>(type);
+    encoded.append(reinterpret_cast<char*>(&ts), sizeof(int64_t))
+           .append(reinterpret_cast<char*>(&logType), 1)
+           .append(&codecType, 1)
+           .append(compressed);
+    return encoded;
+}
+
+std::string decompressLog(folly::StringPiece encoded) {
+    CHECK_GT(encoded.size(), sizeof(int64_t) + 2);
+    CHECK(encoded[sizeof(int64_t)] == OP_COMPRESSED);
+    auto type = static_cast<folly::io::CodecType>(encoded[sizeof(int64_t) + 1]);
+    encoded.advance(sizeof(int64_t) + 2);
+    return folly::io::getCodec(type)->uncompress(encoded);
+}
+
 }  // namespace kvstore
 }  // namespace nebula
 
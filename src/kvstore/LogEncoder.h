@@ -23,12 +23,16 @@ enum LogType : char {
     OP_ADD_PEER       = 0x09,
     OP_REMOVE_PEER    = 0x10,
     OP_BATCH_WRITE    = 0x11,
+    OP_COMPRESSED     = 0x12,
+    // The split of the part, see PartSplit
+    OP_SPLIT_PART     = 0x13,
 };
 
 enum BatchLogType : char {
     OP_BATCH_PUT            = 0x1,
     OP_BATCH_REMOVE         = 0x2,
     OP_BATCH_REMOVE_RANGE   = 0x3,
+    OP_BATCH_MERGE          = 0x4,
 };
 
 std::string encodeKV(const folly::StringPiece& key,
@@ -57,6 +61,15 @@ HostAddr decodeHost(LogType type, const folly::StringPiece& encoded);
 
 int64_t getTimestamp(const folly::StringPiece& command);
 
+// Whether the log of the type changes the data, rather than the raft group or the part
+bool isDataLog(char type);
+
+// Compress the log if it is larger than FLAGS_wal_compress_threshold and gets smaller after
+// compressed, the compressed log is of OP_COMPRESSED, otherwise return the log itself
+std::string compressLog(std::string log);
+// Return the original log of the OP_COMPRESSED log
+std::string decompressLog(folly::StringPiece encoded);
+
 
 class BatchHolder {
 public:
@@ -77,6 +90,14 @@ public:
         batch_.emplace_back(std::move(op));
     }
 
+    // The value removed is only logged for the listeners, it is not read by the parts
+    void remove(std::string&& key, std::string&& removed) {
+        auto op = std::make_tuple(BatchLogType::OP_BATCH_REMOVE,
+                                  std::forward<std::string>(key),
+                                  std::forward<std::string>(removed));
+        batch_.emplace_back(std::move(op));
+    }
+
     void rangeRemove(std::string&& begin, std::string&& end) {
         auto op = std::make_tuple(BatchLogType::OP_BATCH_REMOVE_RANGE,
                                   std::forward<std::string>(begin),
@@ -84,6 +105,13 @@ public:
         batch_.emplace_back(std::move(op));
     }
 
+    void merge(std::string&& key, std::string&& operand) {
+        auto op = std::make_tuple(BatchLogType::OP_BATCH_MERGE,
+                                  std::forward<std::string>(key),
+                                  std::forward<std::string>(operand));
+        batch_.emplace_back(std::move(op));
+    }
+
     void clear() {
         batch_.clear();
     }
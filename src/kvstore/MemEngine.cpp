@@ -0,0 +1,456 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/MemEngine.h"
+#include <rocksdb/sst_file_reader.h>
+#include <rocksdb/sst_file_writer.h>
+#include "common/fs/FileUtils.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace kvstore {
+
+using fs::FileUtils;
+using fs::FileType;
+
+class MemWriteBatch : public WriteBatch {
+private:
+    enum class Op {
+        kPut,
+        kRemove,
+        kRemoveRange,
+    };
+
+    std::vector<std::tuple<Op, std::string, std::string>> ops_;
+
+public:
+    nebula::cpp2::ErrorCode put(folly::StringPiece key, folly::StringPiece value) override {
+        ops_.emplace_back(Op::kPut, key.str(), value.str());
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    nebula::cpp2::ErrorCode remove(folly::StringPiece key) override {
+        ops_.emplace_back(Op::kRemove, key.str(), "");
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    // Remove all keys in the range [start, end)
+    nebula::cpp2::ErrorCode
+    removeRange(folly::StringPiece start, folly::StringPiece end) override {
+        ops_.emplace_back(Op::kRemoveRange, start.str(), end.str());
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    // There is no merge operator of the memory engine
+    nebula::cpp2::ErrorCode merge(folly::StringPiece, folly::StringPiece) override {
+        return nebula::cpp2::ErrorCode::E_UNSUPPORTED;
+    }
+
+    // The lock of engine must be held
+    void apply(MemEngine* engine) {
+        for (auto& op : ops_) {
+            switch (std::get<0>(op)) {
+                case Op::kPut:
+                    engine->table_[std::move(std::get<1>(op))] = std::move(std::get<2>(op));
+                    break;
+                case Op::kRemove:
+                    engine->table_.erase(std::get<1>(op));
+                    break;
+                case Op::kRemoveRange:
+                    engine->removeRangeLocked(std::get<1>(op), std::get<2>(op));
+                    break;
+            }
+        }
+    }
+};
+
+MemEngine::MemEngine(GraphSpaceID spaceId,
+                     const std::string& dataPath,
+                     const std::string& walPath)
+    : KVEngine(spaceId)
+    , dataPath_(folly::stringPrintf("%s/nebula/%d", dataPath.c_str(), spaceId)) {
+    if (walPath.empty()) {
+        walPath_ = dataPath_;
+    } else {
+        walPath_ = folly::stringPrintf("%s/nebula/%d", walPath.c_str(), spaceId);
+    }
+    auto path = folly::stringPrintf("%s/data", dataPath_.c_str());
+    if (FileUtils::fileType(path.c_str()) == FileType::NOTEXIST) {
+        if (!FileUtils::makeDir(path)) {
+            LOG(FATAL) << "makeDir " << path << " failed";
+        }
+    }
+    if (FileUtils::fileType(path.c_str()) != FileType::DIRECTORY) {
+        LOG(FATAL) << path << " is not directory";
+    }
+
+    dumpPath_ = folly::stringPrintf("%s/mem.sst", path.c_str());
+    if (FileUtils::exist(dumpPath_)) {
+        CHECK(load(dumpPath_) == nebula::cpp2::ErrorCode::SUCCEEDED)
+            << "Load " << dumpPath_ << " failed";
+    }
+    partsNum_ = allParts().size();
+    LOG(INFO) << "open memory engine on " << path << ", " << table_.size() << " keys loaded";
+}
+
+MemEngine::~MemEngine() {
+    dump(dumpPath_);
+    LOG(INFO) << "Release memory engine on " << dataPath_;
+}
+
+void MemEngine::stop() {
+    dump(dumpPath_);
+}
+
+std::unique_ptr<WriteBatch> MemEngine::startBatchWrite() {
+    return std::make_unique<MemWriteBatch>();
+}
+
+nebula::cpp2::ErrorCode MemEngine::commitBatchWrite(std::unique_ptr<WriteBatch> batch,
+                                                    bool,
+                                                    bool,
+                                                    bool) {
+    auto* b = static_cast<MemWriteBatch*>(batch.get());
+    std::unique_lock<folly::SharedMutex> guard(lock_);
+    b->apply(this);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::get(const std::string& key, std::string* value) {
+    folly::SharedMutex::ReadHolder guard(lock_);
+    auto it = table_.find(key);
+    if (it == table_.end()) {
+        VLOG(3) << "Get: " << key << " Not Found";
+        return nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND;
+    }
+    *value = it->second;
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+std::vector<Status> MemEngine::multiGet(const std::vector<std::string>& keys,
+                                        std::vector<std::string>* values) {
+    std::vector<Status> ret;
+    ret.reserve(keys.size());
+    values->resize(keys.size());
+    folly::SharedMutex::ReadHolder guard(lock_);
+    for (size_t index = 0; index < keys.size(); index++) {
+        auto it = table_.find(keys[index]);
+        if (it == table_.end()) {
+            ret.emplace_back(Status::KeyNotFound());
+        } else {
+            (*values)[index] = it->second;
+            ret.emplace_back(Status::OK());
+        }
+    }
+    return ret;
+}
+
+std::vector<std::pair<std::string, std::string>>
+MemEngine::copyRange(folly::StringPiece start, folly::StringPiece end, folly::StringPiece prefix) {
+    std::vector<std::pair<std::string, std::string>> kvs;
+    folly::SharedMutex::ReadHolder guard(lock_);
+    for (auto it = table_.lower_bound(start.str()); it != table_.end(); ++it) {
+        folly::StringPiece key(it->first);
+        if ((!end.empty() && key >= end) || !key.startsWith(prefix)) {
+            break;
+        }
+        kvs.emplace_back(it->first, it->second);
+    }
+    return kvs;
+}
+
+nebula::cpp2::ErrorCode MemEngine::range(const std::string& start,
+                                         const std::string& end,
+                                         std::unique_ptr<KVIterator>* iter,
+                                         ScanHint) {
+    // the empty end means no upper bound in copyRange, but nothing in [start, "")
+    if (end.empty()) {
+        iter->reset(new MemIter({}));
+    } else {
+        iter->reset(new MemIter(copyRange(start, end, "")));
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::prefix(const std::string& prefix,
+                                          std::unique_ptr<KVIterator>* iter,
+                                          ScanHint) {
+    iter->reset(new MemIter(copyRange(prefix, "", prefix)));
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::rangeWithPrefix(const std::string& start,
+                                                   const std::string& prefix,
+                                                   std::unique_ptr<KVIterator>* iter,
+                                                   const void*,
+                                                   ScanHint) {
+    iter->reset(new MemIter(copyRange(start, "", prefix)));
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::estimateRange(const std::string& start,
+                                                 const std::string& end,
+                                                 int64_t* keys,
+                                                 std::vector<std::string>* splits) {
+    folly::SharedMutex::ReadHolder guard(lock_);
+    *keys = start < end ? std::distance(table_.lower_bound(start), table_.lower_bound(end)) : 0;
+    splits->clear();
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::put(std::string key, std::string value) {
+    std::unique_lock<folly::SharedMutex> guard(lock_);
+    table_[std::move(key)] = std::move(value);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::multiPut(std::vector<KV> keyValues) {
+    std::unique_lock<folly::SharedMutex> guard(lock_);
+    for (auto& kv : keyValues) {
+        table_[std::move(kv.first)] = std::move(kv.second);
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::remove(const std::string& key) {
+    std::unique_lock<folly::SharedMutex> guard(lock_);
+    table_.erase(key);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::multiRemove(std::vector<std::string> keys) {
+    std::unique_lock<folly::SharedMutex> guard(lock_);
+    for (const auto& key : keys) {
+        table_.erase(key);
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::removeRange(const std::string& start,
+                                               const std::string& end) {
+    std::unique_lock<folly::SharedMutex> guard(lock_);
+    removeRangeLocked(start, end);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+void MemEngine::removeRangeLocked(folly::StringPiece start, folly::StringPiece end) {
+    if (start >= end) {
+        return;
+    }
+    table_.erase(table_.lower_bound(start.str()), table_.lower_bound(end.str()));
+}
+
+void MemEngine::addPart(PartitionID partId) {
+    auto ret = put(NebulaKeyUtils::systemPartKey(partId), "");
+    if (ret == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        partsNum_++;
+        CHECK_GE(partsNum_, 0);
+    }
+}
+
+void MemEngine::removePart(PartitionID partId) {
+    auto code = multiRemove({NebulaKeyUtils::systemPartKey(partId),
+                             NebulaKeyUtils::systemCommitKey(partId)});
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        partsNum_--;
+        CHECK_GE(partsNum_, 0);
+    }
+    // the same as RocksEngine, the keys of each type of a part are in the range of its prefix
+    static const std::vector<NebulaKeyType> kDataTypes = {NebulaKeyType::kVertex,
+                                                          NebulaKeyType::kEdge,
+                                                          NebulaKeyType::kIndex,
+                                                          NebulaKeyType::kOperation,
+                                                          NebulaKeyType::kKeyValue,
+                                                          NebulaKeyType::kDegree};
+    auto prefixOf = [] (PartitionID part, NebulaKeyType type) {
+        PartitionID item = (part << kPartitionOffset) | static_cast<uint32_t>(type);
+        return std::string(reinterpret_cast<const char*>(&item), sizeof(PartitionID));
+    };
+    std::unique_lock<folly::SharedMutex> guard(lock_);
+    for (auto type : kDataTypes) {
+        auto start = prefixOf(partId, type);
+        removeRangeLocked(start, NebulaKeyUtils::prefixEnd(start));
+    }
+}
+
+std::vector<PartitionID> MemEngine::allParts() {
+    std::unique_ptr<KVIterator> iter;
+    std::vector<PartitionID> parts;
+    prefix(NebulaKeyUtils::systemPrefix(), &iter);
+    for (; iter->valid(); iter->next()) {
+        auto key = iter->key();
+        if (!NebulaKeyUtils::isSystemPart(key)) {
+            continue;
+        }
+        parts.emplace_back(*reinterpret_cast<const PartitionID*>(key.data()) >> 8);
+    }
+    return parts;
+}
+
+int32_t MemEngine::totalPartsNum() {
+    return partsNum_;
+}
+
+nebula::cpp2::ErrorCode MemEngine::ingest(const std::vector<std::string>& files, bool) {
+    for (const auto& file : files) {
+        auto code = load(file);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::setOption(const std::string& configKey,
+                                             const std::string& configValue) {
+    LOG(INFO) << "Memory engine ignores option " << configKey << ":" << configValue;
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::setDBOption(const std::string& configKey,
+                                               const std::string& configValue) {
+    LOG(INFO) << "Memory engine ignores db option " << configKey << ":" << configValue;
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::compact() {
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::flush() {
+    return dump(dumpPath_);
+}
+
+nebula::cpp2::ErrorCode MemEngine::backup() {
+    return dump(dumpPath_);
+}
+
+nebula::cpp2::ErrorCode MemEngine::createCheckpoint(const std::string& name) {
+    // the same directory structure as RocksEngine, the data is a single SST file
+    auto checkpointPath = folly::stringPrintf("%s/checkpoints/%s/data",
+                                              dataPath_.c_str(), name.c_str());
+    LOG(INFO) << "Target checkpoint path : " << checkpointPath;
+    if (FileUtils::exist(checkpointPath) && !FileUtils::remove(checkpointPath.data(), true)) {
+        LOG(ERROR) << "Remove exist dir failed of checkpoint : " << checkpointPath;
+        return nebula::cpp2::ErrorCode::E_STORE_FAILURE;
+    }
+    if (!FileUtils::makeDir(checkpointPath)) {
+        LOG(ERROR) << "Make dir " << checkpointPath << " failed";
+        return nebula::cpp2::ErrorCode::E_UNKNOWN;
+    }
+    auto code = dump(folly::stringPrintf("%s/mem.sst", checkpointPath.c_str()));
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return nebula::cpp2::ErrorCode::E_FAILED_TO_CHECKPOINT;
+    }
+    return code;
+}
+
+ErrorOr<nebula::cpp2::ErrorCode, std::string> MemEngine::backupTable(
+    const std::string& name,
+    const std::string& tablePrefix,
+    std::function<bool(const folly::StringPiece& key)> filter) {
+    auto backupPath = folly::stringPrintf(
+        "%s/checkpoints/%s/%s.sst", dataPath_.c_str(), name.c_str(), tablePrefix.c_str());
+    auto parent = backupPath.substr(0, backupPath.rfind('/'));
+    if (!FileUtils::exist(parent) && !FileUtils::makeDir(parent)) {
+        LOG(ERROR) << "Make dir " << parent << " failed";
+        return nebula::cpp2::ErrorCode::E_BACKUP_FAILED;
+    }
+
+    size_t count = 0;
+    rocksdb::Options options;
+    options.file_checksum_gen_factory = rocksdb::GetFileChecksumGenCrc32cFactory();
+    rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
+    auto s = writer.Open(backupPath);
+    for (const auto& kv : copyRange(tablePrefix, "", tablePrefix)) {
+        if (!s.ok()) {
+            break;
+        }
+        if (filter && filter(kv.first)) {
+            continue;
+        }
+        s = writer.Put(kv.first, kv.second);
+        count++;
+    }
+    if (s.ok() && count == 0) {
+        return nebula::cpp2::ErrorCode::E_BACKUP_EMPTY_TABLE;
+    }
+    if (s.ok()) {
+        s = writer.Finish();
+    }
+    if (!s.ok()) {
+        LOG(ERROR) << "BackupTable failed, path: " << backupPath << ", error: " << s.ToString();
+        return nebula::cpp2::ErrorCode::E_BACKUP_TABLE_FAILED;
+    }
+
+    if (backupPath[0] == '/') {
+        return backupPath;
+    }
+    auto result = FileUtils::realPath(backupPath.c_str());
+    if (!result.ok()) {
+        return nebula::cpp2::ErrorCode::E_BACKUP_TABLE_FAILED;
+    }
+    return result.value();
+}
+
+nebula::cpp2::ErrorCode MemEngine::dump(const std::string& path) {
+    // Write into a temporary file and rename it, so the last dump is intact if it fails
+    auto tmpPath = path + ".tmp";
+    rocksdb::Options options;
+    rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
+    auto s = writer.Open(tmpPath);
+    size_t count = 0;
+    {
+        folly::SharedMutex::ReadHolder guard(lock_);
+        for (auto it = table_.begin(); s.ok() && it != table_.end(); ++it) {
+            s = writer.Put(it->first, it->second);
+        }
+        count = table_.size();
+        if (s.ok() && count > 0) {
+            s = writer.Finish();
+        }
+    }
+    if (!s.ok()) {
+        LOG(ERROR) << "Dump memory engine into " << tmpPath << " failed: " << s.ToString();
+        FileUtils::remove(tmpPath.c_str());
+        return nebula::cpp2::ErrorCode::E_STORE_FAILURE;
+    }
+    if (count == 0) {
+        // an empty SST file can't be finished, nothing to load
+        FileUtils::remove(tmpPath.c_str());
+        FileUtils::remove(path.c_str());
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    if (::rename(tmpPath.c_str(), path.c_str()) != 0) {
+        LOG(ERROR) << "Rename " << tmpPath << " to " << path << " failed, errno " << errno;
+        return nebula::cpp2::ErrorCode::E_STORE_FAILURE;
+    }
+    VLOG(1) << "Dump " << count << " keys of space " << spaceId_ << " into " << path;
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode MemEngine::load(const std::string& path) {
+    rocksdb::Options options;
+    rocksdb::SstFileReader reader(options);
+    auto s = reader.Open(path);
+    if (!s.ok()) {
+        LOG(ERROR) << "Open " << path << " failed: " << s.ToString();
+        return nebula::cpp2::ErrorCode::E_UNKNOWN;
+    }
+    std::unique_ptr<rocksdb::Iterator> iter(reader.NewIterator(rocksdb::ReadOptions()));
+    std::unique_lock<folly::SharedMutex> guard(lock_);
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        table_[iter->key().ToString()] = iter->value().ToString();
+    }
+    if (!iter->status().ok()) {
+        LOG(ERROR) << "Read " << path << " failed: " << iter->status().ToString();
+        return nebula::cpp2::ErrorCode::E_UNKNOWN;
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+}  // namespace kvstore
+}  // namespace nebula
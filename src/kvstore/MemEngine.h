@@ -0,0 +1,218 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_MEMENGINE_H_
+#define KVSTORE_MEMENGINE_H_
+
+#include "common/base/Base.h"
+#include <folly/SharedMutex.h>
+#include "kvstore/KVEngine.h"
+#include "kvstore/KVIterator.h"
+
+namespace nebula {
+namespace kvstore {
+
+using MemTable = std::map<std::string, std::string>;
+
+/**
+ * The keys and values in a range of MemEngine, which are copied out when the iterator is
+ * created, so it is not affected by the writes after that.
+ */
+class MemIter : public KVIterator {
+public:
+    explicit MemIter(std::vector<std::pair<std::string, std::string>> kvs)
+        : kvs_(std::move(kvs)) {}
+
+    bool valid() const override {
+        return pos_ < kvs_.size();
+    }
+
+    void next() override {
+        pos_++;
+    }
+
+    void prev() override {
+        if (pos_ == 0) {
+            pos_ = kvs_.size();
+        } else {
+            pos_--;
+        }
+    }
+
+    folly::StringPiece key() const override {
+        return kvs_[pos_].first;
+    }
+
+    folly::StringPiece val() const override {
+        return kvs_[pos_].second;
+    }
+
+private:
+    std::vector<std::pair<std::string, std::string>> kvs_;
+    size_t pos_ = 0;
+};
+
+/**************************************************************************
+ *
+ * An implementation of KVEngine keeping all data in memory, for the small and hot spaces
+ * which don't need the write amplification and the block cache of rocksdb.
+ *
+ * The data is dumped into a SST file in the data path when backup, flush and stop, and
+ * loaded from it when the engine is opened. The commit log id of each part is dumped along
+ * with the data, so the logs after the dump are replayed from the raft wal after restart.
+ *
+ *************************************************************************/
+class MemEngine : public KVEngine {
+public:
+    MemEngine(GraphSpaceID spaceId,
+              const std::string& dataPath,
+              const std::string& walPath = "");
+
+    ~MemEngine();
+
+    void stop() override;
+
+    const char* getDataRoot() const override {
+        return dataPath_.c_str();
+    }
+
+    const char* getWalRoot() const override {
+        return walPath_.c_str();
+    }
+
+    std::unique_ptr<WriteBatch> startBatchWrite() override;
+
+    nebula::cpp2::ErrorCode commitBatchWrite(std::unique_ptr<WriteBatch> batch,
+                                             bool disableWAL,
+                                             bool sync,
+                                             bool wait) override;
+
+    /*********************
+     * Data retrieval
+     ********************/
+    nebula::cpp2::ErrorCode get(const std::string& key, std::string* value) override;
+
+    std::vector<Status> multiGet(const std::vector<std::string>& keys,
+                                 std::vector<std::string>* values) override;
+
+    nebula::cpp2::ErrorCode range(const std::string& start,
+                                  const std::string& end,
+                                  std::unique_ptr<KVIterator>* iter,
+                                  ScanHint hint = ScanHint::kDefault) override;
+
+    nebula::cpp2::ErrorCode prefix(const std::string& prefix,
+                                   std::unique_ptr<KVIterator>* iter,
+                                   ScanHint hint = ScanHint::kDefault) override;
+
+    nebula::cpp2::ErrorCode rangeWithPrefix(const std::string& start,
+                                            const std::string& prefix,
+                                            std::unique_ptr<KVIterator>* iter,
+                                            const void* snapshot = nullptr,
+                                            ScanHint hint = ScanHint::kDefault) override;
+
+    // The iterators copy the data out already, snapshot is not supported
+    const void* getSnapshot() override {
+        return nullptr;
+    }
+
+    void releaseSnapshot(const void*) override {}
+
+    // The keys are counted exactly, the range is not split
+    nebula::cpp2::ErrorCode estimateRange(const std::string& start,
+                                          const std::string& end,
+                                          int64_t* keys,
+                                          std::vector<std::string>* splits) override;
+
+    /*********************
+     * Data modification
+     ********************/
+    nebula::cpp2::ErrorCode put(std::string key, std::string value) override;
+
+    nebula::cpp2::ErrorCode multiPut(std::vector<KV> keyValues) override;
+
+    nebula::cpp2::ErrorCode remove(const std::string& key) override;
+
+    nebula::cpp2::ErrorCode multiRemove(std::vector<std::string> keys) override;
+
+    nebula::cpp2::ErrorCode removeRange(const std::string& start,
+                                        const std::string& end) override;
+
+    /*********************
+     * Non-data operation
+     ********************/
+    void addPart(PartitionID partId) override;
+
+    void removePart(PartitionID partId) override;
+
+    std::vector<PartitionID> allParts() override;
+
+    int32_t totalPartsNum() override;
+
+    nebula::cpp2::ErrorCode ingest(const std::vector<std::string>& files,
+                                   bool verifyFileChecksum = false) override;
+
+    // There is no option of the memory engine, the options are ignored
+    nebula::cpp2::ErrorCode setOption(const std::string& configKey,
+                                      const std::string& configValue) override;
+
+    nebula::cpp2::ErrorCode setDBOption(const std::string& configKey,
+                                        const std::string& configValue) override;
+
+    nebula::cpp2::ErrorCode compact() override;
+
+    nebula::cpp2::ErrorCode compactRange(const std::string&,
+                                         const std::string&,
+                                         int32_t) override {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    // There is no compaction filter of the memory engine
+    nebula::cpp2::ErrorCode compactExpired() override {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    // Dump the data into the data path
+    nebula::cpp2::ErrorCode flush() override;
+
+    nebula::cpp2::ErrorCode createCheckpoint(const std::string& name) override;
+
+    ErrorOr<nebula::cpp2::ErrorCode, std::string>
+    backupTable(const std::string& path,
+                const std::string& tablePrefix,
+                std::function<bool(const folly::StringPiece& key)> filter) override;
+
+    // Dump the data into the data path, which is called periodically by NebulaStore
+    nebula::cpp2::ErrorCode backup() override;
+
+private:
+    std::vector<std::pair<std::string, std::string>>
+    copyRange(folly::StringPiece start, folly::StringPiece end, folly::StringPiece prefix);
+
+    // Dump all data into a SST file, and replace the file of path with it
+    nebula::cpp2::ErrorCode dump(const std::string& path);
+
+    // Put all keys of the SST file into the table
+    nebula::cpp2::ErrorCode load(const std::string& path);
+
+    // Remove keys in [start, end), the lock must be held
+    void removeRangeLocked(folly::StringPiece start, folly::StringPiece end);
+
+private:
+    std::string dataPath_;
+    std::string walPath_;
+    // the SST file the data is dumped into
+    std::string dumpPath_;
+
+    folly::SharedMutex lock_;
+    MemTable table_;
+    int32_t partsNum_ = 0;
+
+    friend class MemWriteBatch;
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+#endif  // KVSTORE_MEMENGINE_H_
@@ -7,28 +7,208 @@
 #include <algorithm>
 #include <folly/Likely.h>
 #include <folly/ScopeGuard.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
 
 #include "kvstore/NebulaStore.h"
 #include "common/fs/FileUtils.h"
 #include "common/network/NetworkUtils.h"
+#include "kvstore/BackupManifest.h"
+#include "kvstore/MemEngine.h"
 #include "kvstore/RocksEngine.h"
+#include "kvstore/RocksEngineConfig.h"
 #include "kvstore/SnapshotManagerImpl.h"
+#include "utils/IndexKeyUtils.h"
 
-DEFINE_string(engine_type, "rocksdb", "rocksdb, memory...");
+DEFINE_string(engine_type, "rocksdb", "rocksdb or memory");
 DEFINE_int32(custom_filter_interval_secs, 24 * 3600,
              "interval to trigger custom compaction, < 0 means always do default minor compaction");
 DEFINE_int32(num_workers, 4, "Number of worker threads");
 DEFINE_int32(clean_wal_interval_secs, 600, "inerval to trigger clean expired wal");
 DEFINE_bool(auto_remove_invalid_space, false, "whether remove data of invalid space when restart");
-
+DEFINE_bool(transfer_leaders_before_stop, false,
+            "Whether to transfer the leaders on this host to their followers when stopped, so "
+            "the writes don't wait for an election");
+DEFINE_int32(transfer_leaders_timeout_ms, 10000,
+             "How long the stop waits for the leaders to be transferred");
+DEFINE_int64(reclaim_removed_space_bytes_per_sec, 0,
+             "The max bytes per second to delete the data of the spaces removed in the "
+             "background, 0 means the dir of a space is removed at once");
+DEFINE_bool(parallel_ingest, false,
+            "Whether to ingest the downloaded SST files of the engines in parallel, all files of "
+            "an engine at once rather than one by one");
+DEFINE_bool(enable_incremental_backup, false,
+            "whether the checkpoint of a backup keeps only the files not in the previous backup");
+DEFINE_string(raft_witness_hosts, "",
+              "The storage hosts split by comma whose replicas are witnesses, which keep the wal "
+              "and vote as the members of the quorum, but never apply the data or serve");
+DEFINE_int64(follower_read_max_staleness_ms, -1,
+             "The max milliseconds the data read from a follower or learner could be behind the "
+             "leader, < 0 means unbounded");
+DEFINE_bool(async_remove_part, false,
+            "Whether the parts and spaces are only detached while the store is locked, and "
+            "stopped and removed from the disk by the background worker one at a time, so the "
+            "reads of the other parts are not blocked by the removal");
+DEFINE_int32(raft_control_io_threads, 0,
+             "Number of io threads the raft heartbeats and votes are sent by, with connections of "
+             "their own apart from the logs and snapshots, 0 to share them with the logs");
+DEFINE_int32(raft_apply_threads, 4,
+             "Number of threads the leaders apply the committed logs by, when raft_apply_async "
+             "is on, 0 to apply them inline");
+DEFINE_bool(enable_prefix_iterator_reuse, false,
+            "whether the prefix iterators of a part handle are reused by seek for the prefixes "
+            "read later by the same request, instead of creating a rocksdb iterator each");
+
+DECLARE_bool(raft_apply_async);
 DECLARE_bool(rocksdb_disable_wal);
 DECLARE_int32(rocksdb_backup_interval_secs);
 DECLARE_int32(wal_ttl);
+DECLARE_int32(wal_retention_for_lagging_secs);
+DECLARE_bool(rocksdb_compact_expired_files);
 
 namespace nebula {
 namespace kvstore {
 
+namespace {
+
+std::pair<nebula::cpp2::ErrorCode, std::vector<Status>>
+multiGetResult(std::vector<Status> status) {
+    auto allExist = std::all_of(status.begin(), status.end(),
+                                [] (const auto& s) {
+                                    return s.ok();
+                                });
+    if (allExist) {
+        return {nebula::cpp2::ErrorCode::SUCCEEDED, std::move(status)};
+    } else {
+        return {nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, std::move(status)};
+    }
+}
+
+// The idle prefix iterators of a part handle, which hold the part as the iterators taken from it
+// could outlive the handle
+struct IterPool {
+    static constexpr size_t kMaxIdle = 4;
+
+    explicit IterPool(std::shared_ptr<Part> p) : part(std::move(p)) {}
+
+    std::shared_ptr<Part>                       part;
+    std::vector<std::unique_ptr<KVIterator>>    idle;
+};
+
+// The iterator taken from the pool, which is put back when it is destroyed. Not thread safe, the
+// same as the handle.
+class PooledIter final : public KVIterator {
+public:
+    PooledIter(std::shared_ptr<IterPool> pool, std::unique_ptr<KVIterator> iter)
+        : pool_(std::move(pool))
+        , iter_(std::move(iter)) {}
+
+    ~PooledIter() {
+        if (pool_->idle.size() < IterPool::kMaxIdle) {
+            pool_->idle.emplace_back(std::move(iter_));
+        }
+    }
+
+    bool valid() const override {
+        return iter_->valid();
+    }
+
+    void next() override {
+        iter_->next();
+    }
+
+    void prev() override {
+        iter_->prev();
+    }
+
+    folly::StringPiece key() const override {
+        return iter_->key();
+    }
+
+    folly::StringPiece val() const override {
+        return iter_->val();
+    }
+
+    bool seek(const std::string& prefix) override {
+        return iter_->seek(prefix);
+    }
+
+private:
+    std::shared_ptr<IterPool>       pool_;
+    std::unique_ptr<KVIterator>     iter_;
+};
+
+// The part is held, so its engine is valid until the handle is destroyed
+class EnginePartHandle final : public PartHandle {
+public:
+    explicit EnginePartHandle(std::shared_ptr<Part> part)
+        : part_(std::move(part))
+        , engine_(part_->engine()) {}
+
+    nebula::cpp2::ErrorCode get(const std::string& key, std::string* value) override {
+        return engine_->get(key, value);
+    }
+
+    std::pair<nebula::cpp2::ErrorCode, std::vector<Status>>
+    multiGet(const std::vector<std::string>& keys, std::vector<std::string>* values) override {
+        return multiGetResult(engine_->multiGet(keys, values));
+    }
+
+    nebula::cpp2::ErrorCode
+    range(const std::string& start,
+          const std::string& end,
+          std::unique_ptr<KVIterator>* iter,
+          ScanHint hint) override {
+        return engine_->range(start, end, iter, hint);
+    }
+
+    nebula::cpp2::ErrorCode
+    prefix(const std::string& prefix,
+           std::unique_ptr<KVIterator>* iter,
+           ScanHint hint) override {
+        if (!FLAGS_enable_prefix_iterator_reuse || hint != ScanHint::kDefault) {
+            return engine_->prefix(prefix, iter, hint);
+        }
+        // Reuse an idle iterator of the request, the vertices of a request are read one by one
+        if (pool_ == nullptr) {
+            pool_ = std::make_shared<IterPool>(part_);
+        }
+        auto& idle = pool_->idle;
+        for (auto it = idle.rbegin(); it != idle.rend(); ++it) {
+            if ((*it)->seek(prefix)) {
+                auto reused = std::move(*it);
+                idle.erase(std::next(it).base());
+                *iter = std::make_unique<PooledIter>(pool_, std::move(reused));
+                return nebula::cpp2::ErrorCode::SUCCEEDED;
+            }
+        }
+        std::unique_ptr<KVIterator> created;
+        if (engine_->reusablePrefix(prefix, &created)) {
+            *iter = std::make_unique<PooledIter>(pool_, std::move(created));
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+        return engine_->prefix(prefix, iter, hint);
+    }
+
+    nebula::cpp2::ErrorCode
+    rangeWithPrefix(const std::string& start,
+                    const std::string& prefix,
+                    std::unique_ptr<KVIterator>* iter,
+                    const void* snapshot,
+                    ScanHint hint) override {
+        return engine_->rangeWithPrefix(start, prefix, iter, snapshot, hint);
+    }
+
+private:
+    std::shared_ptr<Part>       part_;
+    KVEngine*                   engine_;
+    std::shared_ptr<IterPool>   pool_;
+};
+
+}  // namespace
+
 NebulaStore::~NebulaStore() {
     LOG(INFO) << "Cut off the relationship with meta client";
     options_.partMan_.reset();
@@ -42,6 +222,9 @@ NebulaStore::~NebulaStore() {
     bgWorkers_->wait();
     storeWorker_->stop();
     storeWorker_->wait();
+    if (reclaimer_ != nullptr) {
+        reclaimer_->stop();
+    }
     LOG(INFO) << "~NebulaStore()";
 }
 
@@ -55,11 +238,41 @@ bool NebulaStore::init() {
     raftService_ = raftex::RaftexService::createService(ioPool_,
                                                         workers_,
                                                         raftAddr_.port);
+    if (FLAGS_raft_control_io_threads > 0) {
+        controlIoPool_ = std::make_shared<folly::IOThreadPoolExecutor>(
+            FLAGS_raft_control_io_threads,
+            std::make_shared<folly::NamedThreadFactory>("raft-control"));
+        controlClientMan_ =
+            std::make_shared<thrift::ThriftClientManager<raftex::cpp2::RaftexServiceAsyncClient>>();
+        raftService_->setControlIOThreadPool(controlIoPool_);
+    }
+    if (FLAGS_raft_apply_async && FLAGS_raft_apply_threads > 0) {
+        applyPool_ = std::make_shared<folly::CPUThreadPoolExecutor>(
+            FLAGS_raft_apply_threads,
+            std::make_shared<folly::NamedThreadFactory>("raft-apply"));
+    }
     if (!raftService_->start()) {
         LOG(ERROR) << "Start the raft service failed";
         return false;
     }
     diskMan_.reset(new DiskManager(options_.dataPaths_, storeWorker_));
+    if (!FLAGS_raft_witness_hosts.empty()) {
+        auto hosts = network::NetworkUtils::toHosts(FLAGS_raft_witness_hosts);
+        if (!hosts.ok()) {
+            LOG(ERROR) << "Invalid raft_witness_hosts: " << hosts.status().toString();
+            return false;
+        }
+        for (auto& host : hosts.value()) {
+            witnesses_.emplace(getRaftAddr(host));
+        }
+    }
+    if (FLAGS_reclaim_removed_space_bytes_per_sec > 0) {
+        reclaimer_ = std::make_unique<DataReclaimer>(FLAGS_reclaim_removed_space_bytes_per_sec);
+        if (!reclaimer_->start(options_.dataPaths_)) {
+            LOG(ERROR) << "Start the data reclaimer failed";
+            return false;
+        }
+    }
     // todo(doodle): we could support listener and normal storage start at same instance
     if (!isListener()) {
         loadPartFromDataPath();
@@ -72,6 +285,10 @@ bool NebulaStore::init() {
     storeWorker_->addDelayTask(FLAGS_clean_wal_interval_secs * 1000, &NebulaStore::cleanWAL, this);
     storeWorker_->addRepeatTask(
         FLAGS_rocksdb_backup_interval_secs * 1000, &NebulaStore::backup, this);
+    if (FLAGS_rocksdb_compact_expired_files && FLAGS_custom_filter_interval_secs > 0) {
+        storeWorker_->addRepeatTask(
+            FLAGS_custom_filter_interval_secs * 1000, &NebulaStore::compactExpired, this);
+    }
     LOG(INFO) << "Register handler...";
     options_.partMan_->registerHandler(this);
     return true;
@@ -81,6 +298,10 @@ void NebulaStore::loadPartFromDataPath() {
     CHECK(!!options_.partMan_);
     LOG(INFO) << "Scan the local path, and init the spaces_";
     std::unordered_set<std::pair<GraphSpaceID, PartitionID>> spacePartIdSet;
+    // The parts of all spaces and data paths are opened in parallel, the counter starts from 1
+    // so that it won't reach 0 before all parts are added
+    std::atomic<size_t> counter(1);
+    folly::Baton<true, std::atomic> baton;
     for (auto& path : options_.dataPaths_) {
         auto rootPath = folly::stringPrintf("%s/nebula", path.c_str());
         auto dirs = fs::FileUtils::listAllDirsInDir(rootPath.c_str());
@@ -99,6 +320,7 @@ void NebulaStore::loadPartFromDataPath() {
                     if (FLAGS_auto_remove_invalid_space) {
                         auto spaceDir = folly::stringPrintf("%s/%s", rootPath.c_str(), dir.c_str());
                         removeSpaceDir(spaceDir);
+                        removeColdSpaceDir(path, spaceId);
                     }
                     continue;
                 }
@@ -127,6 +349,12 @@ void NebulaStore::loadPartFromDataPath() {
                         enginePtr->removePart(partId);
                         continue;
                     } else {
+                        if (!checkIndexEncoding(enginePtr, spaceId, partId)) {
+                            LOG(FATAL) << "The index encoding of space " << spaceId
+                                       << ", part " << partId << " differs from "
+                                       << "index_string_prefix_len, restore the flag or "
+                                       << "rebuild the part";
+                        }
                         auto spacePart = std::make_pair(spaceId, partId);
                         if (spacePartIdSet.find(spacePart) == spacePartIdSet.end()) {
                             spacePartIdSet.emplace(spacePart);
@@ -138,9 +366,8 @@ void NebulaStore::loadPartFromDataPath() {
                     continue;
                 }
 
-                std::atomic<size_t> counter(partIds.size());
-                folly::Baton<true, std::atomic> baton;
                 LOG(INFO) << "Need to open " << partIds.size() << " parts of space " << spaceId;
+                counter.fetch_add(partIds.size());
                 for (auto& partId : partIds) {
                     bgWorkers_->addTask([
                             spaceId, partId, enginePtr, &counter, &baton, this] () mutable {
@@ -153,19 +380,49 @@ void NebulaStore::loadPartFromDataPath() {
                             CHECK(iter != spaces_.end());
                             iter->second->parts_.emplace(partId, part);
                         }
-                        counter.fetch_sub(1);
-                        if (counter.load() == 0) {
+                        if (counter.fetch_sub(1) == 1) {
                             baton.post();
                         }
                     });
                 }
-                baton.wait();
-                LOG(INFO) << "Load space " << spaceId << " complete";
             } catch (std::exception& e) {
                 LOG(FATAL) << "Invalid data directory \"" << dir << "\"";
             }
         }
     }
+    if (counter.fetch_sub(1) != 1) {
+        baton.wait();
+    }
+    LOG(INFO) << "Load all parts from disk complete";
+}
+
+bool NebulaStore::checkIndexEncoding(KVEngine* engine,
+                                     GraphSpaceID spaceId,
+                                     PartitionID partId) {
+    auto key = NebulaKeyUtils::systemIndexEncodingKey(partId);
+    auto expected = IndexKeyUtils::indexEncoding();
+    std::string val;
+    auto code = engine->get(key, &val);
+    if (code == nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND) {
+        // The part is written before the encoding is recorded, which is the one of now
+        LOG(INFO) << "Record the index encoding of space " << spaceId << ", part " << partId;
+        return engine->put(std::move(key), std::move(expected)) ==
+               nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Read the index encoding of space " << spaceId << ", part " << partId
+                   << " failed: " << apache::thrift::util::enumNameSafe(code);
+        return false;
+    }
+    if (val != expected) {
+        LOG(ERROR) << "Space " << spaceId << ", part " << partId
+                   << " is written with index_string_prefix_len "
+                   << (val.size() == sizeof(int32_t)
+                       ? *reinterpret_cast<const int32_t*>(val.data()) : -1)
+                   << ", but it is " << FLAGS_index_string_prefix_len << " now";
+        return false;
+    }
+    return true;
 }
 
 void NebulaStore::loadPartFromPartManager() {
@@ -218,6 +475,9 @@ void NebulaStore::loadRemoteListenerFromPartManager() {
 }
 
 void NebulaStore::stop() {
+    if (FLAGS_transfer_leaders_before_stop) {
+        transferLeaders();
+    }
     for (const auto& space : spaces_) {
         for (const auto& engine : space.second->engines_) {
             engine->stop();
@@ -225,6 +485,46 @@ void NebulaStore::stop() {
     }
 }
 
+void NebulaStore::transferLeaders() {
+    struct State {
+        std::atomic<int32_t> pending{1};
+        folly::Baton<true, std::atomic> baton;
+    };
+    auto state = std::make_shared<State>();
+    auto done = [state] (nebula::cpp2::ErrorCode) {
+        if (--state->pending == 0) {
+            state->baton.post();
+        }
+    };
+    int32_t count = 0;
+    {
+        folly::RWSpinLock::ReadHolder rh(&lock_);
+        for (const auto& spaceEntry : spaces_) {
+            for (const auto& partEntry : spaceEntry.second->parts_) {
+                auto& part = partEntry.second;
+                if (!part->isLeader()) {
+                    continue;
+                }
+                auto target = part->mostCaughtUpFollower();
+                if (target == HostAddr("", 0)) {
+                    continue;
+                }
+                state->pending++;
+                count++;
+                // All parts are transferred at the same time
+                part->asyncTransferLeader(target, done);
+            }
+        }
+    }
+    done(nebula::cpp2::ErrorCode::SUCCEEDED);
+    LOG(INFO) << "Transfer " << count << " leaders before stop";
+    if (!state->baton.try_wait_for(
+            std::chrono::milliseconds(FLAGS_transfer_leaders_timeout_ms))) {
+        LOG(WARNING) << state->pending << " leaders are not transferred in "
+                     << FLAGS_transfer_leaders_timeout_ms << "ms, stop anyway";
+    }
+}
+
 std::unique_ptr<KVEngine> NebulaStore::newEngine(GraphSpaceID spaceId,
                                                  const std::string& dataPath,
                                                  const std::string& walPath) {
@@ -236,6 +536,8 @@ std::unique_ptr<KVEngine> NebulaStore::newEngine(GraphSpaceID spaceId,
         auto vIdLen = getSpaceVidLen(spaceId);
         return std::make_unique<RocksEngine>(
             spaceId, vIdLen, dataPath, walPath, options_.mergeOp_, cfFactory);
+    } else if (FLAGS_engine_type == "memory") {
+        return std::make_unique<MemEngine>(spaceId, dataPath, walPath);
     } else {
         LOG(FATAL) << "Unknown engine type " << FLAGS_engine_type;
         return nullptr;
@@ -258,6 +560,10 @@ NebulaStore::partLeader(GraphSpaceID spaceId, PartitionID partId) {
 }
 
 void NebulaStore::addSpace(GraphSpaceID spaceId, bool isListener) {
+    if (!isListener) {
+        // the engines of the space removed have to be closed before it is opened again
+        waitUntilRemoved(spaceId);
+    }
     folly::RWSpinLock::WriteHolder wh(&lock_);
     if (!isListener) {
         if (this->spaces_.find(spaceId) != this->spaces_.end()) {
@@ -297,6 +603,7 @@ void NebulaStore::addPart(GraphSpaceID spaceId,
                           PartitionID partId,
                           bool asLearner,
                           const std::vector<HostAddr>& peers) {
+    waitUntilRemoved(spaceId);
     folly::RWSpinLock::WriteHolder wh(&lock_);
     auto spaceIt = this->spaces_.find(spaceId);
     CHECK(spaceIt != this->spaces_.end()) << "Space should exist!";
@@ -375,6 +682,14 @@ std::shared_ptr<Part> NebulaStore::newPart(GraphSpaceID spaceId,
             }
         }
     }
+    part->setCommitObserver(options_.commitObserver_.get());
+    part->setWitnesses(witnesses_);
+    if (controlIoPool_ != nullptr) {
+        part->setControlChannel(controlIoPool_, controlClientMan_);
+    }
+    if (applyPool_ != nullptr) {
+        part->setApplyExecutor(applyPool_);
+    }
     raftService_->addPartition(part);
     part->start(std::move(peers), asLearner);
     diskMan_->addPartToPath(spaceId, partId, engine->getDataRoot());
@@ -386,26 +701,44 @@ void NebulaStore::removeSpace(GraphSpaceID spaceId, bool isListener) {
     if (!isListener) {
         auto spaceIt = this->spaces_.find(spaceId);
         if (spaceIt != this->spaces_.end()) {
-            auto& engines = spaceIt->second->engines_;
-            for (auto& engine : engines) {
-                auto parts = engine->allParts();
-                for (auto& partId : parts) {
-                    engine->removePart(partId);
-                }
-                CHECK_EQ(0, engine->totalPartsNum());
-            }
             CHECK(spaceIt->second->parts_.empty());
             std::vector<std::string> enginePaths;
             if (FLAGS_auto_remove_invalid_space) {
-                for (auto& engine : engines) {
+                for (auto& engine : spaceIt->second->engines_) {
                     enginePaths.emplace_back(engine->getDataRoot());
                 }
             }
-            this->spaces_.erase(spaceIt);
-            if (FLAGS_auto_remove_invalid_space) {
+            auto cleanup = [this, space = spaceIt->second, enginePaths, spaceId] () mutable {
+                for (auto& engine : space->engines_) {
+                    auto parts = engine->allParts();
+                    for (auto& partId : parts) {
+                        engine->removePart(partId);
+                    }
+                    CHECK_EQ(0, engine->totalPartsNum());
+                }
+                // the engines are closed before their dirs are removed, unless still in use
+                space.reset();
                 for (const auto& path : enginePaths) {
                     removeSpaceDir(path);
                 }
+                if (FLAGS_auto_remove_invalid_space) {
+                    for (const auto& path : options_.dataPaths_) {
+                        removeColdSpaceDir(path, spaceId);
+                    }
+                }
+            };
+            if (beforeRemoveSpace_) {
+                beforeRemoveSpace_(spaceId);
+            }
+            if (options_.commitObserver_ != nullptr) {
+                options_.commitObserver_->onReset(spaceId, 0);
+            }
+            this->spaces_.erase(spaceIt);
+            if (FLAGS_async_remove_part) {
+                // after the removals of its parts queued before
+                removeInBackground(spaceId, std::move(cleanup));
+            } else {
+                cleanup();
             }
         }
         LOG(INFO) << "Data space " << spaceId << " has been removed!";
@@ -428,13 +761,32 @@ void NebulaStore::removePart(GraphSpaceID spaceId, PartitionID partId) {
     if (spaceIt != this->spaces_.end()) {
         auto partIt = spaceIt->second->parts_.find(partId);
         if (partIt != spaceIt->second->parts_.end()) {
-            auto* e = partIt->second->engine();
+            auto part = partIt->second;
+            auto* e = part->engine();
             CHECK_NOTNULL(e);
-            raftService_->removePartition(partIt->second);
+            if (beforeRemovePart_) {
+                beforeRemovePart_(spaceId, partId);
+            }
             diskMan_->removePartFromPath(spaceId, partId, e->getDataRoot());
-            partIt->second->resetPart();
-            spaceIt->second->parts_.erase(partId);
-            e->removePart(partId);
+            spaceIt->second->parts_.erase(partIt);
+            // the space, which owns the engine, is kept until the part is removed
+            auto cleanup = [this, part, space = spaceIt->second, e, spaceId, partId] {
+                raftService_->removePartition(part);
+                part->resetPart();
+                e->removePart(partId);
+                if (options_.commitObserver_ != nullptr) {
+                    options_.commitObserver_->onReset(spaceId, partId);
+                }
+            };
+            if (FLAGS_async_remove_part) {
+                // The part is not found by the requests any more, it is stopped and its data
+                // is removed without the lock held
+                removeInBackground(spaceId, std::move(cleanup));
+                LOG(INFO) << "Space " << spaceId << ", part " << partId
+                          << " is detached, to be removed in the background";
+                return;
+            }
+            cleanup();
         }
     }
     LOG(INFO) << "Space " << spaceId << ", part " << partId << " has been removed!";
@@ -553,7 +905,34 @@ void NebulaStore::updateSpaceOption(GraphSpaceID spaceId,
     });
 }
 
+void NebulaStore::removeInBackground(GraphSpaceID spaceId, std::function<void()> task) {
+    {
+        std::lock_guard<std::mutex> g(removingLock_);
+        ++removing_[spaceId];
+    }
+    storeWorker_->addTask([this, spaceId, task = std::move(task)] {
+        task();
+        std::lock_guard<std::mutex> g(removingLock_);
+        auto it = removing_.find(spaceId);
+        if (--it->second == 0) {
+            removing_.erase(it);
+        }
+        removingCV_.notify_all();
+        LOG(INFO) << "The removal of space " << spaceId << " in the background is done";
+    });
+}
+
+void NebulaStore::waitUntilRemoved(GraphSpaceID spaceId) {
+    std::unique_lock<std::mutex> g(removingLock_);
+    removingCV_.wait(g, [this, spaceId] {
+        return removing_.count(spaceId) == 0;
+    });
+}
+
 void NebulaStore::removeSpaceDir(const std::string& dir) {
+    if (reclaimer_ != nullptr && reclaimer_->add(dir)) {
+        return;
+    }
     try {
         LOG(INFO) << "Try to remove space directory: " << dir;
         boost::filesystem::remove_all(dir);
@@ -563,6 +942,18 @@ void NebulaStore::removeSpaceDir(const std::string& dir) {
     }
 }
 
+void NebulaStore::removeColdSpaceDir(const std::string& dataPath, GraphSpaceID spaceId) {
+    std::string coldRoot;
+    if (!coldDataPath(dataPath, &coldRoot).ok() || coldRoot.empty()) {
+        return;
+    }
+    // the dir is left even if the cold path is not used any more
+    auto coldDir = folly::stringPrintf("%s/nebula/%d", coldRoot.c_str(), spaceId);
+    if (fs::FileUtils::exist(coldDir)) {
+        removeSpaceDir(coldDir);
+    }
+}
+
 nebula::cpp2::ErrorCode
 NebulaStore::get(GraphSpaceID spaceId,
                  PartitionID partId,
@@ -596,16 +987,7 @@ NebulaStore::multiGet(GraphSpaceID spaceId,
     if (!checkLeader(part, canReadFromFollower)) {
         return {nebula::cpp2::ErrorCode::E_LEADER_CHANGED, status};
     }
-    status = part->engine()->multiGet(keys, values);
-    auto allExist = std::all_of(status.begin(), status.end(),
-                                [] (const auto& s) {
-                                    return s.ok();
-                                });
-    if (allExist) {
-        return {nebula::cpp2::ErrorCode::SUCCEEDED, status};
-    } else {
-        return {nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, status};
-    }
+    return multiGetResult(part->engine()->multiGet(keys, values));
 }
 
 
@@ -615,7 +997,8 @@ NebulaStore::range(GraphSpaceID spaceId,
                    const std::string& start,
                    const std::string& end,
                    std::unique_ptr<KVIterator>* iter,
-                   bool canReadFromFollower) {
+                   bool canReadFromFollower,
+                   ScanHint hint) {
     auto ret = part(spaceId, partId);
     if (!ok(ret)) {
         return error(ret);
@@ -624,7 +1007,7 @@ NebulaStore::range(GraphSpaceID spaceId,
     if (!checkLeader(part, canReadFromFollower)) {
         return nebula::cpp2::ErrorCode::E_LEADER_CHANGED;
     }
-    return part->engine()->range(start, end, iter);
+    return part->engine()->range(start, end, iter, hint);
 }
 
 
@@ -633,7 +1016,8 @@ NebulaStore::prefix(GraphSpaceID spaceId,
                     PartitionID partId,
                     const std::string& prefix,
                     std::unique_ptr<KVIterator>* iter,
-                    bool canReadFromFollower) {
+                    bool canReadFromFollower,
+                    ScanHint hint) {
     auto ret = part(spaceId, partId);
     if (!ok(ret)) {
         return error(ret);
@@ -642,7 +1026,7 @@ NebulaStore::prefix(GraphSpaceID spaceId,
     if (!checkLeader(part, canReadFromFollower)) {
         return nebula::cpp2::ErrorCode::E_LEADER_CHANGED;
     }
-    return part->engine()->prefix(prefix, iter);
+    return part->engine()->prefix(prefix, iter, hint);
 }
 
 
@@ -652,7 +1036,23 @@ NebulaStore::rangeWithPrefix(GraphSpaceID spaceId,
                              const std::string& start,
                              const std::string& prefix,
                              std::unique_ptr<KVIterator>* iter,
-                             bool canReadFromFollower) {
+                             bool canReadFromFollower,
+                             const void* snapshot,
+                             ScanHint hint) {
+    auto ret = part(spaceId, partId);
+    if (!ok(ret)) {
+        return error(ret);
+    }
+    auto part = nebula::value(ret);
+    if (!checkLeader(part, canReadFromFollower)) {
+        return nebula::cpp2::ErrorCode::E_LEADER_CHANGED;
+    }
+    return part->engine()->rangeWithPrefix(start, prefix, iter, snapshot, hint);
+}
+
+
+ErrorOr<nebula::cpp2::ErrorCode, std::unique_ptr<PartHandle>>
+NebulaStore::partHandle(GraphSpaceID spaceId, PartitionID partId, bool canReadFromFollower) {
     auto ret = part(spaceId, partId);
     if (!ok(ret)) {
         return error(ret);
@@ -661,7 +1061,7 @@ NebulaStore::rangeWithPrefix(GraphSpaceID spaceId,
     if (!checkLeader(part, canReadFromFollower)) {
         return nebula::cpp2::ErrorCode::E_LEADER_CHANGED;
     }
-    return part->engine()->rangeWithPrefix(start, prefix, iter);
+    return std::unique_ptr<PartHandle>(new EnginePartHandle(std::move(part)));
 }
 
 
@@ -685,6 +1085,23 @@ NebulaStore::sync(GraphSpaceID spaceId, PartitionID partId) {
     return ret;
 }
 
+nebula::cpp2::ErrorCode
+NebulaStore::readIndex(GraphSpaceID spaceId, PartitionID partId) {
+    auto partRet = part(spaceId, partId);
+    if (!ok(partRet)) {
+        return error(partRet);
+    }
+    auto part = nebula::value(partRet);
+    auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
+    folly::Baton<true, std::atomic> baton;
+    part->readIndex([&] (nebula::cpp2::ErrorCode code) {
+        ret = code;
+        baton.post();
+    });
+    baton.wait();
+    return ret;
+}
+
 void NebulaStore::asyncAppendBatch(GraphSpaceID spaceId,
                                    PartitionID partId,
                                    std::string&& batch,
@@ -788,6 +1205,25 @@ nebula::cpp2::ErrorCode NebulaStore::ingest(GraphSpaceID spaceId) {
         return error(spaceRet);
     }
     auto space = nebula::value(spaceRet);
+    // the files ingested, even partly, are not seen by the observer
+    SCOPE_EXIT {
+        if (options_.commitObserver_ != nullptr) {
+            options_.commitObserver_->onReset(spaceId, 0);
+        }
+        // nor counted by the degrees, which are removed by the next commit of each part
+        for (auto& engine : space->engines_) {
+            for (auto part : engine->allParts()) {
+                engine->remove(NebulaKeyUtils::systemDegreeKey(part));
+            }
+        }
+        folly::RWSpinLock::ReadHolder rh(&lock_);
+        for (auto& part : space->parts_) {
+            part.second->bumpWriteVersion();
+        }
+    };
+    if (FLAGS_parallel_ingest) {
+        return ingestInParallel(space.get());
+    }
     for (auto& engine : space->engines_) {
         auto parts = engine->allParts();
         for (auto part : parts) {
@@ -815,6 +1251,77 @@ nebula::cpp2::ErrorCode NebulaStore::ingest(GraphSpaceID spaceId) {
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
+nebula::cpp2::ErrorCode NebulaStore::ingest(GraphSpaceID spaceId, PartitionID partId) {
+    auto ret = engine(spaceId, partId);
+    if (!ok(ret)) {
+        return error(ret);
+    }
+    auto* engine = value(ret);
+    SCOPE_EXIT {
+        if (options_.commitObserver_ != nullptr) {
+            options_.commitObserver_->onReset(spaceId, partId);
+        }
+        engine->remove(NebulaKeyUtils::systemDegreeKey(partId));
+        auto partRet = part(spaceId, partId);
+        if (ok(partRet)) {
+            value(partRet)->bumpWriteVersion();
+        }
+    };
+    auto path = folly::stringPrintf("%s/download/%d", engine->getDataRoot(), partId);
+    if (!fs::FileUtils::exist(path)) {
+        LOG(INFO) << path << " not existed";
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    auto files = fs::FileUtils::listAllFilesInDir(path.c_str(), true, "*.sst");
+    if (!files.empty()) {
+        LOG(INFO) << "Ingesting " << files.size() << " extra files of space " << spaceId
+                  << " part " << partId;
+        auto code = engine->ingest(files);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+    }
+    // the files are not ingested again by the ingest of the space
+    fs::FileUtils::remove(path.c_str(), true);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode NebulaStore::ingestInParallel(SpacePartInfo* space) {
+    // Each engine is on a disk of its own, so the engines are ingested in parallel, and the
+    // files of all parts of an engine at once, then the db is flushed and stalled only once
+    auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
+    std::mutex lock;
+    std::vector<std::thread> threads;
+    for (auto& engine : space->engines_) {
+        std::vector<std::string> files;
+        for (auto part : engine->allParts()) {
+            auto path = folly::stringPrintf("%s/download/%d", engine->getDataRoot(), part);
+            if (!fs::FileUtils::exist(path)) {
+                LOG(INFO) << path << " not existed";
+                continue;
+            }
+            auto partFiles = fs::FileUtils::listAllFilesInDir(path.c_str(), true, "*.sst");
+            files.insert(files.end(), partFiles.begin(), partFiles.end());
+        }
+        if (files.empty()) {
+            continue;
+        }
+        threads.emplace_back([&engine, &code, &lock, files = std::move(files)] {
+            LOG(INFO) << "Ingesting " << files.size() << " extra files into "
+                      << engine->getDataRoot();
+            auto ret = engine->ingest(files);
+            if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                std::lock_guard<std::mutex> g(lock);
+                code = ret;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return code;
+}
+
 
 nebula::cpp2::ErrorCode
 NebulaStore::setOption(GraphSpaceID spaceId,
@@ -878,6 +1385,10 @@ nebula::cpp2::ErrorCode NebulaStore::compact(GraphSpaceID spaceId) {
         t.join();
     }
     LOG(INFO) << "Space " << spaceId << " compaction done.";
+    // what the observer has seen could be removed by the compaction filter
+    if (options_.commitObserver_ != nullptr) {
+        options_.commitObserver_->onReset(spaceId, 0);
+    }
     return code;
 }
 
@@ -941,6 +1452,12 @@ ErrorOr<nebula::cpp2::ErrorCode, std::vector<cpp2::CheckpointInfo>> NebulaStore:
                 partitionInfo.emplace(part, std::move(info));
             }
         }
+        // the snapshots are restored locally, only the backups are uploaded incrementally
+        if (FLAGS_enable_incremental_backup &&
+            folly::StringPiece(name).startsWith("BACKUP_") &&
+            !BackupManifest::build(engine->getDataRoot(), engine->getWalRoot(), name)) {
+            return nebula::cpp2::ErrorCode::E_FAILED_TO_CHECKPOINT;
+        }
         auto result = nebula::fs::FileUtils::realPath(cpPath.c_str());
         if (!result.ok()) {
             return nebula::cpp2::ErrorCode::E_FAILED_TO_CHECKPOINT;
@@ -974,10 +1491,23 @@ NebulaStore::dropCheckpoint(GraphSpaceID spaceId, const std::string& name) {
         if (!fs::FileUtils::exist(checkpointPath)) {
             continue;
         }
+        // the later backups still list the files of it, which are kept in them instead
+        if (!BackupManifest::release(engine->getDataRoot(), engine->getWalRoot(), name)) {
+            LOG(ERROR) << "Release the files of checkpoint failed : " << checkpointPath;
+            return nebula::cpp2::ErrorCode::E_STORE_FAILURE;
+        }
         if (!fs::FileUtils::remove(checkpointPath.data(), true)) {
             LOG(ERROR) << "Drop checkpoint dir failed : " << checkpointPath;
             return nebula::cpp2::ErrorCode::E_STORE_FAILURE;
         }
+        auto walCheckpointPath = folly::stringPrintf("%s/checkpoints/%s",
+                                                     engine->getWalRoot(),
+                                                     name.c_str());
+        if (walCheckpointPath != checkpointPath && fs::FileUtils::exist(walCheckpointPath) &&
+            !fs::FileUtils::remove(walCheckpointPath.data(), true)) {
+            LOG(ERROR) << "Drop checkpoint wal dir failed : " << walCheckpointPath;
+            return nebula::cpp2::ErrorCode::E_STORE_FAILURE;
+        }
     }
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
@@ -1010,7 +1540,7 @@ bool NebulaStore::isLeader(GraphSpaceID spaceId, PartitionID partId) {
     if (spaceIt != this->spaces_.end()) {
         auto partIt = spaceIt->second->parts_.find(partId);
         if (partIt != spaceIt->second->parts_.end()) {
-            return partIt->second->isLeader();
+            return partIt->second->isLeader() && !partIt->second->isWitness();
         } else {
             return false;
         }
@@ -1043,6 +1573,168 @@ NebulaStore::space(GraphSpaceID spaceId) {
     return it->second;
 }
 
+ErrorOr<nebula::cpp2::ErrorCode, NebulaStore::SplitStatus>
+NebulaStore::splitParts(GraphSpaceID spaceId, const PartSplit& split) {
+    auto spaceRet = space(spaceId);
+    if (!ok(spaceRet)) {
+        return error(spaceRet);
+    }
+    auto spaceInfo = nebula::value(spaceRet);
+    std::vector<std::pair<std::shared_ptr<Part>, std::shared_ptr<Part>>> parts;
+    {
+        folly::RWSpinLock::ReadHolder rh(&lock_);
+        for (const auto& partEntry : spaceInfo->parts_) {
+            if (partEntry.first > split.parts) {
+                continue;
+            }
+            auto sibling = spaceInfo->parts_.find(partEntry.first + split.parts);
+            parts.emplace_back(partEntry.second,
+                               sibling == spaceInfo->parts_.end() ? nullptr : sibling->second);
+        }
+    }
+
+    using Status = PartSplit::Status;
+    auto inStatus = [&split] (const std::shared_ptr<Part>& part, Status status) {
+        auto current = part->split();
+        return current != nullptr && current->parts == split.parts && current->status == status;
+    };
+    // The rows copied or cleaned up are written to the engines without logs, so just like
+    // ingest, they are not seen by the observer, nor counted by the stats and the degrees
+    auto reset = [this, spaceId] (const std::shared_ptr<Part>& part) {
+        if (part == nullptr) {
+            return;
+        }
+        auto partId = part->partitionId();
+        if (options_.commitObserver_ != nullptr) {
+            options_.commitObserver_->onReset(spaceId, partId);
+        }
+        part->engine()->remove(NebulaKeyUtils::systemStatisKey(partId));
+        part->engine()->remove(NebulaKeyUtils::systemDegreeKey(partId));
+        part->bumpWriteVersion();
+    };
+    auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
+    if (split.status == Status::FROZEN || split.status == Status::COPYING) {
+        std::vector<folly::Future<nebula::cpp2::ErrorCode>> futures;
+        for (auto& entry : parts) {
+            auto& part = entry.first;
+            // FROZEN is appended again in case the log appended before is lost
+            auto current = part->split();
+            bool done = current != nullptr && current->parts == split.parts &&
+                        current->status >= split.status && split.status != Status::FROZEN;
+            if (!part->isLeader() || done) {
+                continue;
+            }
+            folly::Promise<nebula::cpp2::ErrorCode> promise;
+            futures.emplace_back(promise.getFuture());
+            part->asyncSplit(split, [p = std::move(promise)] (auto ret) mutable {
+                p.setValue(ret);
+            });
+        }
+        for (auto& ret : folly::collectAll(futures).get()) {
+            if (ret.hasValue() && ret.value() != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                code = ret.value();
+            }
+        }
+    } else {
+        auto from = split.status == Status::COPIED ? Status::COPYING : Status::COPIED;
+        for (auto& entry : parts) {
+            auto& part = entry.first;
+            if (!inStatus(part, from)) {
+                continue;
+            }
+            auto current = part->split();
+            auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
+            if (split.status == Status::COPIED) {
+                // The part split into is added by metad, wait for it
+                if (entry.second == nullptr) {
+                    LOG(INFO) << "Part " << part->partitionId() + split.parts << " of space "
+                              << spaceId << " is not added yet";
+                    continue;
+                }
+                ret = PartSplitter::copy(part->engine(), entry.second->engine(),
+                                         part->partitionId(), *current);
+            } else {
+                ret = PartSplitter::cleanup(part->engine(), part->partitionId(), *current);
+            }
+            // even partly copied or cleaned up
+            reset(part);
+            reset(entry.second);
+            if (ret == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                ret = part->updateSplit(split.status);
+            }
+            if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                code = ret;
+            }
+        }
+    }
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    return splitStatus(spaceId, split.parts);
+}
+
+ErrorOr<nebula::cpp2::ErrorCode, NebulaStore::SplitStatus>
+NebulaStore::splitStatus(GraphSpaceID spaceId, int32_t parts) {
+    auto spaceRet = space(spaceId);
+    if (!ok(spaceRet)) {
+        return error(spaceRet);
+    }
+    auto spaceInfo = nebula::value(spaceRet);
+    SplitStatus status;
+    folly::RWSpinLock::ReadHolder rh(&lock_);
+    for (const auto& partEntry : spaceInfo->parts_) {
+        auto current = partEntry.second->split();
+        if (partEntry.first <= parts && current != nullptr && current->parts == parts) {
+            status.emplace(partEntry.first, current->status);
+        }
+    }
+    return status;
+}
+
+ErrorOr<nebula::cpp2::ErrorCode, NebulaStore::PartVersions>
+NebulaStore::partVersions(GraphSpaceID spaceId) {
+    auto spaceRet = space(spaceId);
+    if (!ok(spaceRet)) {
+        return error(spaceRet);
+    }
+    auto spaceInfo = nebula::value(spaceRet);
+    std::vector<std::shared_ptr<Part>> parts;
+    {
+        folly::RWSpinLock::ReadHolder rh(&lock_);
+        for (const auto& partEntry : spaceInfo->parts_) {
+            if (!partEntry.second->isWitness()) {
+                parts.emplace_back(partEntry.second);
+            }
+        }
+    }
+    // the commit key of a part might be read out of the lock of spaces
+    PartVersions versions;
+    for (const auto& part : parts) {
+        versions.emplace(part->partitionId(),
+                         PartVersion{part->appliedLogId(), part->isLeader()});
+    }
+    return versions;
+}
+
+std::vector<std::pair<GraphSpaceID, std::shared_ptr<SpacePartInfo>>> NebulaStore::allSpaces() {
+    folly::RWSpinLock::ReadHolder rh(&lock_);
+    return {spaces_.begin(), spaces_.end()};
+}
+
+double NebulaStore::writeStallPressure() {
+    double pressure = 0;
+    auto spaces = allSpaces();
+    for (const auto& spaceEntry : spaces) {
+        for (const auto& engine : spaceEntry.second->engines_) {
+            auto* rocksEngine = dynamic_cast<RocksEngine*>(engine.get());
+            if (rocksEngine != nullptr) {
+                pressure = std::max(pressure, rocksEngine->writeStallPressure());
+            }
+        }
+    }
+    return pressure;
+}
+
 ErrorOr<nebula::cpp2::ErrorCode, std::shared_ptr<SpaceListenerInfo>>
 NebulaStore::spaceListener(GraphSpaceID spaceId) {
     folly::RWSpinLock::ReadHolder rh(&lock_);
@@ -1061,7 +1753,8 @@ int32_t NebulaStore::allLeader(
         auto spaceId = spaceIt.first;
         for (const auto& partIt : spaceIt.second->parts_) {
             auto partId = partIt.first;
-            if (partIt.second->isLeader()) {
+            // a witness leader is giving up the leadership, it is not reported
+            if (partIt.second->isLeader() && !partIt.second->isWitness()) {
                 meta::cpp2::LeaderInfo partInfo;
                 partInfo.set_part_id(partId);
                 partInfo.set_term(partIt.second->termId());
@@ -1074,7 +1767,14 @@ int32_t NebulaStore::allLeader(
 }
 
 bool NebulaStore::checkLeader(std::shared_ptr<Part> part, bool canReadFromFollower) const {
-    return canReadFromFollower || (part->isLeader() && part->leaseValid());
+    if (part->isWitness()) {
+        return false;
+    }
+    if (canReadFromFollower) {
+        return FLAGS_follower_read_max_staleness_ms < 0 ||
+               part->readableWithin(FLAGS_follower_read_max_staleness_ms);
+    }
+    return part->isLeader() && part->leaseValid();
 }
 
 void NebulaStore::cleanWAL() {
@@ -1092,8 +1792,12 @@ void NebulaStore::cleanWAL() {
         for (const auto& partEntry : spaceEntry.second->parts_) {
             auto& part = partEntry.second;
             if (part->needToCleanWal()) {
-                // clean wal by expired time
-                part->wal()->cleanWAL();
+                // clean wal by expired time and size, keep the logs the lagging peers still
+                // need, which are only known on the leader
+                auto lowest = part->lowestLogIdOfPeers();
+                auto needed = FLAGS_wal_retention_for_lagging_secs > 0
+                                ? lowest : std::numeric_limits<LogID>::max();
+                part->wal()->cleanWALKeeping(needed, part->isLeader() ? lowest : -1);
             }
         }
     }
@@ -1108,6 +1812,18 @@ void NebulaStore::cleanWAL() {
     }
 }
 
+void NebulaStore::compactExpired() {
+    // the compaction takes long, don't hold the lock during it
+    for (const auto& spaceEntry : allSpaces()) {
+        for (const auto& engine : spaceEntry.second->engines_) {
+            auto code = engine->compactExpired();
+            if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                LOG(ERROR) << "Compact expired data of space " << spaceEntry.first << " failed";
+            }
+        }
+    }
+}
+
 nebula::cpp2::ErrorCode NebulaStore::backup() {
     for (const auto& spaceEntry : spaces_) {
         for (const auto& engine : spaceEntry.second->engines_) {
@@ -19,6 +19,7 @@
 #include "kvstore/Listener.h"
 #include "kvstore/ListenerFactory.h"
 #include "kvstore/KVEngine.h"
+#include "kvstore/DataReclaimer.h"
 #include "kvstore/DiskManager.h"
 #include "kvstore/raftex/SnapshotManager.h"
 #include "utils/Utils.h"
@@ -51,6 +52,7 @@ class NebulaStore : public KVStore, public Handler {
     FRIEND_TEST(NebulaStoreTest, CheckpointTest);
     FRIEND_TEST(NebulaStoreTest, ThreeCopiesCheckpointTest);
     FRIEND_TEST(NebulaStoreTest, RemoveInvalidSpaceTest);
+    FRIEND_TEST(NebulaStoreTest, AsyncRemoveSpaceTest);
     friend class ListenerBasicTest;
 
 public:
@@ -85,6 +87,10 @@ public:
 
     void stop() override;
 
+    // Transfer the leaders to their followers in parallel and wait for a while, see
+    // FLAGS_transfer_leaders_before_stop
+    void transferLeaders();
+
     uint32_t capability() const override {
         return 0;
     }
@@ -105,6 +111,10 @@ public:
         return workers_;
     }
 
+    std::shared_ptr<raftex::SnapshotManager> getSnapshotManager() const {
+        return snapshot_;
+    }
+
     // Return the current leader
     ErrorOr<nebula::cpp2::ErrorCode, HostAddr>
     partLeader(GraphSpaceID spaceId, PartitionID partId) override;
@@ -142,7 +152,8 @@ public:
           const std::string& start,
           const std::string& end,
           std::unique_ptr<KVIterator>* iter,
-          bool canReadFromFollower = false) override;
+          bool canReadFromFollower = false,
+          ScanHint hint = ScanHint::kDefault) override;
 
     // Delete the overloading with a rvalue `start' and `end'
     nebula::cpp2::ErrorCode
@@ -151,7 +162,8 @@ public:
           std::string&& start,
           std::string&& end,
           std::unique_ptr<KVIterator>* iter,
-          bool canReadFromFollower = false) override = delete;
+          bool canReadFromFollower = false,
+          ScanHint hint = ScanHint::kDefault) override = delete;
 
     // Get all results with prefix.
     nebula::cpp2::ErrorCode
@@ -159,7 +171,8 @@ public:
            PartitionID partId,
            const std::string& prefix,
            std::unique_ptr<KVIterator>* iter,
-           bool canReadFromFollower = false) override;
+           bool canReadFromFollower = false,
+           ScanHint hint = ScanHint::kDefault) override;
 
     // Delete the overloading with a rvalue `prefix'
     nebula::cpp2::ErrorCode
@@ -167,7 +180,8 @@ public:
            PartitionID partId,
            std::string&& prefix,
            std::unique_ptr<KVIterator>* iter,
-           bool canReadFromFollower = false) override = delete;
+           bool canReadFromFollower = false,
+           ScanHint hint = ScanHint::kDefault) override = delete;
 
     // Get all results with prefix starting from start
     nebula::cpp2::ErrorCode
@@ -176,7 +190,9 @@ public:
                     const std::string& start,
                     const std::string& prefix,
                     std::unique_ptr<KVIterator>* iter,
-                    bool canReadFromFollower = false) override;
+                    bool canReadFromFollower = false,
+                    const void* snapshot = nullptr,
+                    ScanHint hint = ScanHint::kDefault) override;
 
     // Delete the overloading with a rvalue `prefix'
     nebula::cpp2::ErrorCode
@@ -185,10 +201,20 @@ public:
                     std::string&& start,
                     std::string&& prefix,
                     std::unique_ptr<KVIterator>* iter,
-                    bool canReadFromFollower = false) override = delete;
+                    bool canReadFromFollower = false,
+                    const void* snapshot = nullptr,
+                    ScanHint hint = ScanHint::kDefault) override = delete;
+
+    // The handle reads the engine of the part directly
+    ErrorOr<nebula::cpp2::ErrorCode, std::unique_ptr<PartHandle>>
+    partHandle(GraphSpaceID spaceId,
+               PartitionID partId,
+               bool canReadFromFollower = false) override;
 
     nebula::cpp2::ErrorCode sync(GraphSpaceID spaceId, PartitionID partId) override;
 
+    nebula::cpp2::ErrorCode readIndex(GraphSpaceID spaceId, PartitionID partId) override;
+
     // async batch put.
     void asyncMultiPut(GraphSpaceID spaceId,
                        PartitionID partId,
@@ -226,6 +252,8 @@ public:
 
     nebula::cpp2::ErrorCode ingest(GraphSpaceID spaceId) override;
 
+    nebula::cpp2::ErrorCode ingest(GraphSpaceID spaceId, PartitionID partId) override;
+
     nebula::cpp2::ErrorCode
     setOption(GraphSpaceID spaceId,
               const std::string& configKey,
@@ -253,9 +281,42 @@ public:
 
     bool isLeader(GraphSpaceID spaceId, PartitionID partId);
 
+    using SplitStatus = std::unordered_map<PartitionID, PartSplit::Status>;
+
+    // A step of the split of the first split.parts parts of the space when its parts are
+    // doubled, see PartSplit. For FROZEN and COPYING, the leaders on this host append the split
+    // logs, and for COPIED and CLEANED, the keys moved are copied or removed by the replicas on
+    // this host in the status before. Return the status of the parts on this host after it.
+    ErrorOr<nebula::cpp2::ErrorCode, SplitStatus>
+    splitParts(GraphSpaceID spaceId, const PartSplit& split);
+
+    // The status of the split of the parts on this host, the parts split into another number
+    // of parts or not split are not included
+    ErrorOr<nebula::cpp2::ErrorCode, SplitStatus>
+    splitStatus(GraphSpaceID spaceId, int32_t parts);
+
+    struct PartVersion {
+        LogID   version;
+        bool    leader;
+    };
+    using PartVersions = std::unordered_map<PartitionID, PartVersion>;
+
+    // The version of the data of each part on this host, which is the id of the last log
+    // applied, so it only grows and is the same on the replicas having applied the same logs.
+    // The SST files ingested are written without a log, which don't change the version, nor do
+    // the rows of a snapshot until it is finished. The witnesses are not included, which never
+    // apply the logs.
+    ErrorOr<nebula::cpp2::ErrorCode, PartVersions> partVersions(GraphSpaceID spaceId);
+
     ErrorOr<nebula::cpp2::ErrorCode, std::shared_ptr<SpacePartInfo>>
     space(GraphSpaceID spaceId);
 
+    // All spaces, whose engines could be used for long without holding the lock of spaces
+    std::vector<std::pair<GraphSpaceID, std::shared_ptr<SpacePartInfo>>> allSpaces();
+
+    // The max write stall pressure of all rocksdb engines, see RocksEngine::writeStallPressure
+    double writeStallPressure();
+
     ErrorOr<nebula::cpp2::ErrorCode, std::shared_ptr<SpaceListenerInfo>>
     spaceListener(GraphSpaceID spaceId);
 
@@ -302,9 +363,32 @@ public:
     nebula::cpp2::ErrorCode
     multiPutWithoutReplicator(GraphSpaceID spaceId, std::vector<KV> keyValues) override;
 
+    // The callback is invoked before the engines of a space are destroyed, the iterators of
+    // the space held by the caller must be released in it. Not thread safe, set it before use.
+    void setBeforeRemoveSpace(std::function<void(GraphSpaceID)> callback) {
+        beforeRemoveSpace_ = std::move(callback);
+    }
+
+    // The callback is invoked before a part is removed, the iterators and snapshots of the part
+    // held by the caller should be released in it. Not thread safe, set it before use.
+    void setBeforeRemovePart(std::function<void(GraphSpaceID, PartitionID)> callback) {
+        beforeRemovePart_ = std::move(callback);
+    }
+
+    // The reclaimer of the dirs of the spaces removed, null if the dirs are removed at once
+    const DataReclaimer* reclaimer() const {
+        return reclaimer_.get();
+    }
+
 private:
     void loadPartFromDataPath();
 
+    /**
+     * Whether the index keys of the part on disk are in the encoding of this process, see
+     * IndexKeyUtils::indexEncoding. A part added before the encoding is recorded takes it.
+     * */
+    bool checkIndexEncoding(KVEngine* engine, GraphSpaceID spaceId, PartitionID partId);
+
     void loadPartFromPartManager();
 
     void loadLocalListenerFromPartManager();
@@ -333,14 +417,33 @@ private:
     ErrorOr<nebula::cpp2::ErrorCode, KVEngine*>
     engine(GraphSpaceID spaceId, PartitionID partId);
 
+    // Ingest the downloaded files of each engine at once, the engines in parallel
+    nebula::cpp2::ErrorCode ingestInParallel(SpacePartInfo* space);
+
+    // A follower or learner could serve the read if canReadFromFollower, as long as its data is
+    // at most follower_read_max_staleness_ms behind the leader
     bool checkLeader(std::shared_ptr<Part> part, bool canReadFromFollower = false) const;
 
     void cleanWAL();
 
+    // Compact the files with expired or dropped data of all engines
+    void compactExpired();
+
     int32_t getSpaceVidLen(GraphSpaceID spaceId);
 
     void removeSpaceDir(const std::string& dir);
 
+    // Remove the dir of the space in the cold path of dataPath, see rocksdb_cold_data_paths
+    void removeColdSpaceDir(const std::string& dataPath, GraphSpaceID spaceId);
+
+    // Run the task removing the data of a part or space on storeWorker_, see
+    // FLAGS_async_remove_part
+    void removeInBackground(GraphSpaceID spaceId, std::function<void()> task);
+
+    // Block until the parts and the space being removed in the background are removed, so a
+    // part or space added again is not removed by them
+    void waitUntilRemoved(GraphSpaceID spaceId);
+
 private:
     // The lock used to protect spaces_
     folly::RWSpinLock                                                    lock_;
@@ -353,12 +456,30 @@ private:
     HostAddr                                                             storeSvcAddr_;
     std::shared_ptr<folly::Executor>                                     workers_;
     HostAddr                                                             raftAddr_;
+    // the raft addresses of the witnesses, see FLAGS_raft_witness_hosts
+    std::set<HostAddr>                                                   witnesses_;
     KVOptions                                                            options_;
 
     std::shared_ptr<raftex::RaftexService>                               raftService_;
     std::shared_ptr<raftex::SnapshotManager>                             snapshot_;
     std::shared_ptr<thrift::ThriftClientManager<raftex::cpp2::RaftexServiceAsyncClient>> clientMan_;
+    // the io threads and the clients of the raft heartbeats and votes, see
+    // FLAGS_raft_control_io_threads, null if they share ioPool_ and clientMan_
+    std::shared_ptr<folly::IOThreadPoolExecutor>                         controlIoPool_;
+    std::shared_ptr<thrift::ThriftClientManager<raftex::cpp2::RaftexServiceAsyncClient>>
+                                                                         controlClientMan_;
+    // the threads the leaders apply the committed logs by, see FLAGS_raft_apply_threads, null
+    // if the logs are applied inline
+    std::shared_ptr<folly::Executor>                                     applyPool_;
     std::shared_ptr<DiskManager> diskMan_;
+    std::function<void(GraphSpaceID)>                                    beforeRemoveSpace_;
+    std::function<void(GraphSpaceID, PartitionID)>                       beforeRemovePart_;
+    // disabled if null
+    std::unique_ptr<DataReclaimer>                                       reclaimer_;
+    // the number of the removals of each space not finished in the background
+    std::mutex                                                           removingLock_;
+    std::condition_variable                                              removingCV_;
+    std::unordered_map<GraphSpaceID, int32_t>                            removing_;
 };
 
 }   // namespace kvstore
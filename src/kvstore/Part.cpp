@@ -5,11 +5,26 @@
  */
 
 #include "kvstore/Part.h"
+#include "common/fs/FileUtils.h"
 #include "kvstore/LogEncoder.h"
+#include "kvstore/PartStats.h"
 #include "kvstore/RocksEngineConfig.h"
 #include "utils/NebulaKeyUtils.h"
 
+DECLARE_uint32(raft_heartbeat_interval_secs);
+
 DEFINE_int32(cluster_id, 0, "A unique id for each cluster");
+DEFINE_bool(snapshot_ingest_sst, false,
+            "Whether to write the rows of a snapshot received into SST files and ingest them, "
+            "instead of putting them through memtable");
+DEFINE_int32(snapshot_ingest_sst_file_mb, 64,
+             "The size of each SST file written by the snapshot received, see snapshot_ingest_sst");
+DEFINE_bool(enable_incremental_statis, false,
+            "Whether to count the vertices and edges of each part when the logs are committed, "
+            "so that the STATS job does not scan the part every time");
+DEFINE_bool(enable_degree_counters, false,
+            "Whether to count the edges of each vertex and edge type when the logs are "
+            "committed, so that the degree of a vertex is a single point read");
 
 namespace nebula {
 namespace kvstore {
@@ -42,6 +57,16 @@ Part::Part(GraphSpaceID spaceId,
         , partId_(partId)
         , walPath_(walPath)
         , engine_(engine) {
+    std::string val;
+    if (engine_->get(NebulaKeyUtils::systemSplitKey(partId_), &val) ==
+            nebula::cpp2::ErrorCode::SUCCEEDED) {
+        auto split = std::make_shared<PartSplit>();
+        if (PartSplit::decode(val, split.get())) {
+            setSplit(std::move(split));
+        } else {
+            LOG(ERROR) << idStr_ << "Invalid split of the part";
+        }
+    }
 }
 
 
@@ -62,9 +87,26 @@ std::pair<LogID, TermID> Part::lastCommittedLogId() {
     return std::make_pair(lastId, termId);
 }
 
+LogID Part::appliedLogId() {
+    auto id = appliedLogId_.load(std::memory_order_acquire);
+    if (id >= 0) {
+        return id;
+    }
+    id = lastCommittedLogId().first;
+    LogID unset = -1;
+    if (!appliedLogId_.compare_exchange_strong(unset, id, std::memory_order_acq_rel)) {
+        // a log is applied meanwhile
+        return unset;
+    }
+    return id;
+}
 
 void Part::asyncPut(folly::StringPiece key, folly::StringPiece value, KVCallback cb) {
     std::string log = encodeMultiValues(OP_PUT, key, value);
+    if (splitMoved(log)) {
+        cb(nebula::cpp2::ErrorCode::E_PART_NOT_FOUND);
+        return;
+    }
 
     appendAsync(FLAGS_cluster_id, std::move(log))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
@@ -73,7 +115,11 @@ void Part::asyncPut(folly::StringPiece key, folly::StringPiece value, KVCallback
 }
 
 void Part::asyncAppendBatch(std::string&& batch, KVCallback cb) {
-    appendAsync(FLAGS_cluster_id, std::move(batch))
+    if (splitMoved(batch)) {
+        cb(nebula::cpp2::ErrorCode::E_PART_NOT_FOUND);
+        return;
+    }
+    appendAsync(FLAGS_cluster_id, compressLog(std::move(batch)))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
             callback(this->toResultCode(res));
         });
@@ -81,7 +127,11 @@ void Part::asyncAppendBatch(std::string&& batch, KVCallback cb) {
 
 
 void Part::asyncMultiPut(const std::vector<KV>& keyValues, KVCallback cb) {
-    std::string log = encodeMultiValues(OP_MULTI_PUT, keyValues);
+    std::string log = compressLog(encodeMultiValues(OP_MULTI_PUT, keyValues));
+    if (splitMoved(log)) {
+        cb(nebula::cpp2::ErrorCode::E_PART_NOT_FOUND);
+        return;
+    }
 
     appendAsync(FLAGS_cluster_id, std::move(log))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
@@ -92,6 +142,10 @@ void Part::asyncMultiPut(const std::vector<KV>& keyValues, KVCallback cb) {
 
 void Part::asyncRemove(folly::StringPiece key, KVCallback cb) {
     std::string log = encodeSingleValue(OP_REMOVE, key);
+    if (splitMoved(log)) {
+        cb(nebula::cpp2::ErrorCode::E_PART_NOT_FOUND);
+        return;
+    }
 
     appendAsync(FLAGS_cluster_id, std::move(log))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
@@ -101,7 +155,11 @@ void Part::asyncRemove(folly::StringPiece key, KVCallback cb) {
 
 
 void Part::asyncMultiRemove(const std::vector<std::string>& keys, KVCallback cb) {
-    std::string log = encodeMultiValues(OP_MULTI_REMOVE, keys);
+    std::string log = compressLog(encodeMultiValues(OP_MULTI_REMOVE, keys));
+    if (splitMoved(log)) {
+        cb(nebula::cpp2::ErrorCode::E_PART_NOT_FOUND);
+        return;
+    }
 
     appendAsync(FLAGS_cluster_id, std::move(log))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
@@ -114,6 +172,10 @@ void Part::asyncRemoveRange(folly::StringPiece start,
                             folly::StringPiece end,
                             KVCallback cb) {
     std::string log = encodeMultiValues(OP_REMOVE_RANGE, start, end);
+    if (splitMoved(log)) {
+        cb(nebula::cpp2::ErrorCode::E_PART_NOT_FOUND);
+        return;
+    }
 
     appendAsync(FLAGS_cluster_id, std::move(log))
         .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
@@ -128,8 +190,25 @@ void Part::sync(KVCallback cb) {
     });
 }
 
+void Part::readIndex(KVCallback cb) {
+    readIndexAsync()
+        .thenValue([this, callback = std::move(cb)] (AppendLogResult res) mutable {
+        callback(this->toResultCode(res));
+    });
+}
+
 void Part::asyncAtomicOp(raftex::AtomicOp op, KVCallback cb) {
-    atomicOpAsync(std::move(op)).thenValue(
+    atomicOpAsync([this, op = std::move(op)] () mutable -> folly::Optional<std::string> {
+        auto log = op();
+        if (log.hasValue()) {
+            if (splitMoved(log.value())) {
+                VLOG(1) << idStr_ << "The atomic op writes the keys moved by the split";
+                return folly::none;
+            }
+            return compressLog(std::move(log).value());
+        }
+        return log;
+    }).thenValue(
             [this, callback = std::move(cb)] (AppendLogResult res) mutable {
         callback(this->toResultCode(res));
     });
@@ -175,6 +254,46 @@ void Part::asyncRemovePeer(const HostAddr& peer, KVCallback cb) {
     });
 }
 
+void Part::asyncSplit(const PartSplit& split, KVCallback cb) {
+    std::string log = encodeSingleValue(OP_SPLIT_PART, split.encode());
+    auto status = split.status;
+    sendCommandAsync(std::move(log))
+        .thenValue([callback = std::move(cb), status, this] (AppendLogResult res) mutable {
+        LOG(INFO) << idStr_ << "split " << PartSplit::toString(status)
+                  << ", result: " << static_cast<int32_t>(this->toResultCode(res));
+        callback(this->toResultCode(res));
+    });
+}
+
+nebula::cpp2::ErrorCode Part::updateSplit(PartSplit::Status status) {
+    auto current = split();
+    if (current == nullptr) {
+        return nebula::cpp2::ErrorCode::E_PART_NOT_FOUND;
+    }
+    auto split = std::make_shared<PartSplit>(*current);
+    split->status = status;
+    auto code = engine_->put(NebulaKeyUtils::systemSplitKey(partId_), split->encode());
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(INFO) << idStr_ << "The split is " << PartSplit::toString(status);
+        setSplit(std::move(split));
+    }
+    return code;
+}
+
+bool Part::splitMoved(folly::StringPiece log) const {
+    if (!hasSplit_.load(std::memory_order_acquire)) {
+        return false;
+    }
+    auto current = split();
+    return current != nullptr && current->movedLog(partId_, log);
+}
+
+void Part::setSplit(std::shared_ptr<const PartSplit> split) {
+    std::lock_guard<std::mutex> g(splitLock_);
+    split_ = std::move(split);
+    hasSplit_.store(split_ != nullptr, std::memory_order_release);
+}
+
 void Part::setBlocking(bool sign) {
     blocking_ = sign;
 }
@@ -186,6 +305,26 @@ void Part::onLostLeadership(TermID term) {
 
 void Part::onElected(TermID term) {
     VLOG(1) << "Being elected as the leader for the term " << term;
+    if (isWitness()) {
+        transferFromWitness(term);
+    }
+}
+
+void Part::transferFromWitness(TermID term) {
+    // The followers have got the logs before the command once it reaches them, so the one got
+    // most logs could be elected. Try again later until the leadership is given up.
+    bgWorkers_->addDelayTask(FLAGS_raft_heartbeat_interval_secs * 1000,
+                             [self = std::static_pointer_cast<Part>(shared_from_this()), term] {
+        if (!self->isRunning() || !self->isLeader() || self->termId() != term) {
+            return;
+        }
+        auto target = self->mostCaughtUpFollower();
+        if (target != HostAddr("", 0)) {
+            LOG(INFO) << self->idStr_ << "Witness gives the leadership to " << target;
+            self->asyncTransferLeader(target, [] (nebula::cpp2::ErrorCode) {});
+        }
+        self->transferFromWitness(term);
+    });
 }
 
 void Part::onDiscoverNewLeader(HostAddr nLeader) {
@@ -199,6 +338,19 @@ cpp2::ErrorCode Part::commitLogs(std::unique_ptr<LogIterator> iter, bool wait) {
     auto batch = engine_->startBatchWrite();
     LogID lastId = -1;
     TermID lastTerm = -1;
+    std::unique_ptr<PartStatsUpdater> stats;
+    if ((FLAGS_enable_incremental_statis || FLAGS_enable_degree_counters) && !isWitness()) {
+        stats = std::make_unique<PartStatsUpdater>(engine_, partId_,
+                                                   FLAGS_enable_incremental_statis,
+                                                   FLAGS_enable_degree_counters);
+    }
+    // the keys put are told to the observer once they are committed
+    std::vector<std::string> putKeys;
+    auto observe = [this, &putKeys] (folly::StringPiece key) {
+        if (commitObserver_ != nullptr) {
+            putKeys.emplace_back(key.str());
+        }
+    };
     while (iter->valid()) {
         lastId = iter->logId();
         lastTerm = iter->logTerm();
@@ -208,12 +360,27 @@ cpp2::ErrorCode Part::commitLogs(std::unique_ptr<LogIterator> iter, bool wait) {
             ++(*iter);
             continue;
         }
+        // A witness applies the commands only, the data is not kept
+        if (isWitness() && isDataLog(log[sizeof(int64_t)])) {
+            ++(*iter);
+            continue;
+        }
+        // The compressed log is only decompressed when it is applied
+        std::string decompressed;
+        if (log[sizeof(int64_t)] == OP_COMPRESSED) {
+            decompressed = decompressLog(log);
+            log = decompressed;
+        }
         DCHECK_GE(log.size(), sizeof(int64_t) + 1 + sizeof(uint32_t));
         // Skip the timestamp (type of int64_t)
         switch (log[sizeof(int64_t)]) {
         case OP_PUT: {
             auto pieces = decodeMultiValues(log);
             DCHECK_EQ(2, pieces.size());
+            if (stats) {
+                stats->put(lastId, pieces[0]);
+            }
+            observe(pieces[0]);
             auto code = batch->put(pieces[0], pieces[1]);
             if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 LOG(ERROR) << idStr_ << "Failed to call WriteBatch::put()";
@@ -226,6 +393,10 @@ cpp2::ErrorCode Part::commitLogs(std::unique_ptr<LogIterator> iter, bool wait) {
             // Make the number of values are an even number
             DCHECK_EQ((kvs.size() + 1) / 2, kvs.size() / 2);
             for (size_t i = 0; i < kvs.size(); i += 2) {
+                if (stats) {
+                    stats->put(lastId, kvs[i]);
+                }
+                observe(kvs[i]);
                 auto code = batch->put(kvs[i], kvs[i + 1]);
                 if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                     LOG(ERROR) << idStr_ << "Failed to call WriteBatch::put()";
@@ -236,6 +407,9 @@ cpp2::ErrorCode Part::commitLogs(std::unique_ptr<LogIterator> iter, bool wait) {
         }
         case OP_REMOVE: {
             auto key = decodeSingleValue(log);
+            if (stats) {
+                stats->remove(lastId, key);
+            }
             auto code = batch->remove(key);
             if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 LOG(ERROR) << idStr_ << "Failed to call WriteBatch::remove()";
@@ -246,6 +420,9 @@ cpp2::ErrorCode Part::commitLogs(std::unique_ptr<LogIterator> iter, bool wait) {
         case OP_MULTI_REMOVE: {
             auto keys = decodeMultiValues(log);
             for (auto k : keys) {
+                if (stats) {
+                    stats->remove(lastId, k);
+                }
                 auto code = batch->remove(k);
                 if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                     LOG(ERROR) << idStr_ << "Failed to call WriteBatch::remove()";
@@ -257,6 +434,9 @@ cpp2::ErrorCode Part::commitLogs(std::unique_ptr<LogIterator> iter, bool wait) {
         case OP_REMOVE_RANGE: {
             auto range = decodeMultiValues(log);
             DCHECK_EQ(2, range.size());
+            if (stats) {
+                stats->removeRange(lastId, range[0], range[1]);
+            }
             auto code = batch->removeRange(range[0], range[1]);
             if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 LOG(ERROR) << idStr_ << "Failed to call WriteBatch::removeRange()";
@@ -268,12 +448,19 @@ cpp2::ErrorCode Part::commitLogs(std::unique_ptr<LogIterator> iter, bool wait) {
             auto data = decodeBatchValue(log);
             for (auto& op : data) {
                 auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
+                if (stats) {
+                    stats->apply(lastId, op);
+                }
                 if (op.first == BatchLogType::OP_BATCH_PUT) {
+                    observe(op.second.first);
                     code = batch->put(op.second.first, op.second.second);
                 } else if (op.first == BatchLogType::OP_BATCH_REMOVE) {
                     code = batch->remove(op.second.first);
                 } else if (op.first == BatchLogType::OP_BATCH_REMOVE_RANGE) {
                     code = batch->removeRange(op.second.first, op.second.second);
+                } else if (op.first == BatchLogType::OP_BATCH_MERGE) {
+                    observe(op.second.first);
+                    code = batch->merge(op.second.first, op.second.second);
                 }
                 if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                     LOG(ERROR) << idStr_ << "Failed to call WriteBatch";
@@ -298,6 +485,28 @@ cpp2::ErrorCode Part::commitLogs(std::unique_ptr<LogIterator> iter, bool wait) {
             }
             break;
         }
+        case OP_SPLIT_PART: {
+            auto split = std::make_shared<PartSplit>();
+            if (!PartSplit::decode(decodeSingleValue(log), split.get())) {
+                LOG(ERROR) << idStr_ << "Invalid split log " << lastId;
+                break;
+            }
+            // The log replayed never takes the split on this replica back
+            auto current = this->split();
+            if (current != nullptr && current->parts == split->parts &&
+                current->status > split->status) {
+                break;
+            }
+            auto code = batch->put(NebulaKeyUtils::systemSplitKey(partId_), split->encode());
+            if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                LOG(ERROR) << idStr_ << "Failed to put the split";
+                return code;
+            }
+            LOG(INFO) << idStr_ << "Commit the split of " << split->parts << " parts, "
+                      << PartSplit::toString(split->status);
+            setSplit(std::move(split));
+            break;
+        }
         case OP_REMOVE_PEER: {
             auto peer = decodeHost(OP_REMOVE_PEER, log);
             auto ts = getTimestamp(log);
@@ -318,6 +527,13 @@ cpp2::ErrorCode Part::commitLogs(std::unique_ptr<LogIterator> iter, bool wait) {
         ++(*iter);
     }
 
+    if (stats) {
+        auto code = stats->flush(batch.get(), lastId);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << idStr_ << "Put the counters failed";
+            return code;
+        }
+    }
     if (lastId >= 0) {
         auto code = putCommitMsg(batch.get(), lastId, lastTerm);
         if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
@@ -325,8 +541,18 @@ cpp2::ErrorCode Part::commitLogs(std::unique_ptr<LogIterator> iter, bool wait) {
             return code;
         }
     }
-    return engine_->commitBatchWrite(
+    auto code = engine_->commitBatchWrite(
         std::move(batch), FLAGS_rocksdb_disable_wal, FLAGS_rocksdb_wal_sync, wait);
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        bumpWriteVersion();
+        if (lastId >= 0) {
+            appliedLogId_.store(lastId, std::memory_order_release);
+        }
+        if (!putKeys.empty()) {
+            commitObserver_->onCommit(spaceId_, partId_, putKeys);
+        }
+    }
+    return code;
 }
 
 std::pair<int64_t, int64_t> Part::commitSnapshot(const std::vector<std::string>& rows,
@@ -336,9 +562,19 @@ std::pair<int64_t, int64_t> Part::commitSnapshot(const std::vector<std::string>&
     auto batch = engine_->startBatchWrite();
     int64_t count = 0;
     int64_t size = 0;
+    // The rows of the snapshot are ingested before the commit key is written, so they are in
+    // the engine once the snapshot is finished
+    bool ingest = !isWitness() && FLAGS_snapshot_ingest_sst;
+    if (ingest && ingestSnapshot(rows, finished) != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return std::make_pair(0, 0);
+    }
     for (auto& row : rows) {
         count++;
         size += row.size();
+        // The rows sent to a witness are counted only
+        if (ingest || isWitness()) {
+            continue;
+        }
         auto kv = decodeKV(row);
         if (nebula::cpp2::ErrorCode::SUCCEEDED != batch->put(kv.first, kv.second)) {
             LOG(ERROR) << idStr_ << "Put failed in commit";
@@ -359,9 +595,112 @@ std::pair<int64_t, int64_t> Part::commitSnapshot(const std::vector<std::string>&
         LOG(ERROR) << idStr_ << "Put failed in commit";
         return std::make_pair(0, 0);
     }
+    bumpWriteVersion();
+    if (finished) {
+        appliedLogId_.store(committedLogId, std::memory_order_release);
+    }
+    if (commitObserver_ != nullptr && !rows.empty() && !isWitness()) {
+        std::vector<std::string> keys;
+        keys.reserve(rows.size());
+        for (auto& row : rows) {
+            keys.emplace_back(decodeKV(row).first.str());
+        }
+        commitObserver_->onCommit(spaceId_, partId_, keys);
+    }
     return std::make_pair(count, size);
 }
 
+nebula::cpp2::ErrorCode Part::ingestSnapshot(const std::vector<std::string>& rows,
+                                             bool finished) {
+    // The rows skip the memtable and the WAL, and land in the db as SST files, which saves the
+    // flush and most of the compaction on the learner. The rows of the batches are appended to
+    // one file until it is large enough, rather than a tiny file per batch. The SST file
+    // requires the keys in order, the rows are sent in order of prefix, sort them anyway in
+    // case they are not.
+    std::vector<std::pair<folly::StringPiece, folly::StringPiece>> kvs;
+    kvs.reserve(rows.size());
+    for (auto& row : rows) {
+        kvs.emplace_back(decodeKV(row));
+    }
+    auto byKey = [] (const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first;
+    };
+    if (!std::is_sorted(kvs.begin(), kvs.end(), byKey)) {
+        std::stable_sort(kvs.begin(), kvs.end(), byKey);
+    }
+
+    // A batch not after the rows written starts a new file, the later file wins on ingest
+    if (snapshotWriter_ != nullptr && !kvs.empty() && kvs.front().first <= snapshotLastKey_) {
+        auto code = ingestSnapshotFile();
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+    }
+    auto fileSize = static_cast<uint64_t>(std::max(FLAGS_snapshot_ingest_sst_file_mb, 1)) << 20;
+    rocksdb::Status status;
+    for (size_t i = 0; i < kvs.size(); i++) {
+        // the later one wins if the key is duplicated
+        if (i + 1 < kvs.size() && kvs[i].first == kvs[i + 1].first) {
+            continue;
+        }
+        if (snapshotWriter_ == nullptr) {
+            snapshotWriter_ = std::make_unique<rocksdb::SstFileWriter>(rocksdb::EnvOptions(),
+                                                                       engine_->sstOptions());
+            status = snapshotWriter_->Open(snapshotFile());
+        }
+        if (status.ok()) {
+            status = snapshotWriter_->Put(toSlice(kvs[i].first), toSlice(kvs[i].second));
+        }
+        if (!status.ok()) {
+            LOG(ERROR) << idStr_ << "Write snapshot into sst failed: " << status.ToString();
+            dropSnapshotFile();
+            return nebula::cpp2::ErrorCode::E_UNKNOWN;
+        }
+        if (snapshotWriter_->FileSize() >= fileSize) {
+            auto code = ingestSnapshotFile();
+            if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                return code;
+            }
+        } else {
+            snapshotLastKey_ = kvs[i].first.str();
+        }
+    }
+    return finished ? ingestSnapshotFile() : nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode Part::ingestSnapshotFile() {
+    if (snapshotWriter_ == nullptr) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    SCOPE_EXIT {
+        dropSnapshotFile();
+    };
+    auto status = snapshotWriter_->Finish();
+    if (!status.ok()) {
+        LOG(ERROR) << idStr_ << "Finish the sst of snapshot failed: " << status.ToString();
+        return nebula::cpp2::ErrorCode::E_UNKNOWN;
+    }
+    auto code = engine_->ingest({snapshotFile()});
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << idStr_ << "Ingest snapshot failed";
+    }
+    return code;
+}
+
+void Part::dropSnapshotFile() {
+    if (snapshotWriter_ == nullptr) {
+        return;
+    }
+    snapshotWriter_.reset();
+    snapshotLastKey_.clear();
+    auto file = snapshotFile();
+    fs::FileUtils::remove(file.c_str());
+}
+
+std::string Part::snapshotFile() const {
+    return folly::stringPrintf("%s/snapshot_%d.sst", engine_->getDataRoot(), partId_);
+}
+
 nebula::cpp2::ErrorCode
 Part::putCommitMsg(WriteBatch* batch, LogID committedLogId, TermID committedLogTerm) {
     std::string commitMsg;
@@ -419,6 +758,21 @@ bool Part::preProcessLog(LogID logId,
                 }
                 break;
             }
+            case OP_SPLIT_PART: {
+                // The writes of the keys moved are rejected once the split is appended, the
+                // status is only changed when it is committed
+                auto split = std::make_shared<PartSplit>();
+                if (!PartSplit::decode(decodeSingleValue(log), split.get())) {
+                    break;
+                }
+                auto current = this->split();
+                if (current == nullptr || current->parts != split->parts) {
+                    LOG(INFO) << idStr_ << "preprocess split of " << split->parts << " parts";
+                    split->status = PartSplit::Status::FROZEN;
+                    setSplit(std::move(split));
+                }
+                break;
+            }
             case OP_REMOVE_PEER: {
                 auto peer = decodeHost(OP_REMOVE_PEER, log);
                 auto ts = getTimestamp(log);
@@ -441,12 +795,21 @@ bool Part::preProcessLog(LogID logId,
 }
 
 void Part::cleanup() {
+    // the rows of the snapshot given up are sent again
+    dropSnapshotFile();
     LOG(INFO) << idStr_ << "Clean rocksdb commit key";
     auto res = engine_->remove(NebulaKeyUtils::systemCommitKey(partId_));
     if (res != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(WARNING) << idStr_ << "Remove the committedLogId failed, error "
                      << static_cast<int32_t>(res);
     }
+    // the counters are started again after the part is rebuilt by snapshot
+    res = engine_->remove(NebulaKeyUtils::systemStatisKey(partId_));
+    if (res != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(WARNING) << idStr_ << "Remove the statis failed, error "
+                     << static_cast<int32_t>(res);
+    }
+    bumpWriteVersion();
     return;
 }
 
@@ -7,11 +7,14 @@
 #ifndef KVSTORE_PART_H_
 #define KVSTORE_PART_H_
 
+#include <rocksdb/sst_file_writer.h>
 #include "common/base/Base.h"
 #include "utils/NebulaKeyUtils.h"
 #include "raftex/RaftPart.h"
 #include "kvstore/Common.h"
+#include "kvstore/CommitObserver.h"
 #include "kvstore/KVEngine.h"
+#include "kvstore/PartSplit.h"
 #include "kvstore/raftex/SnapshotManager.h"
 #include "kvstore/wal/FileBasedWal.h"
 
@@ -36,6 +39,7 @@ public:
          std::shared_ptr<DiskManager> diskMan);
 
     virtual ~Part() {
+        dropSnapshotFile();
         LOG(INFO) << idStr_ << "~Part()";
     }
 
@@ -64,11 +68,27 @@ public:
 
     void asyncRemovePeer(const HostAddr& peer, KVCallback cb);
 
+    // Freeze the keys moved by the split, or start to copy them, by a raft log of the part
+    void asyncSplit(const PartSplit& split, KVCallback cb);
+
+    // The last split of the part, nullptr if it is never split
+    std::shared_ptr<const PartSplit> split() const {
+        std::lock_guard<std::mutex> g(splitLock_);
+        return split_;
+    }
+
+    // Update the status of the split on this replica only, for COPIED and CLEANED
+    nebula::cpp2::ErrorCode updateSplit(PartSplit::Status status);
+
     void setBlocking(bool sign);
 
     // Sync the information committed on follower.
     void sync(KVCallback cb);
 
+    // Linearizable read barrier, the reads on the leader after cb see all the writes
+    // finished before the call. Unlike sync(), no log is appended, see readIndexAsync.
+    void readIndex(KVCallback cb);
+
     void registerNewLeaderCb(NewLeaderCallback cb) {
         newLeaderCb_ = std::move(cb);
     }
@@ -77,8 +97,14 @@ public:
         newLeaderCb_ = nullptr;
     }
 
+    // Set before the part is started, told of the keys committed
+    void setCommitObserver(CommitObserver* observer) {
+        commitObserver_ = observer;
+    }
+
     // clean up all data about this part.
     void resetPart() {
+        waitApplied();
         std::lock_guard<std::mutex> g(raftLock_);
         reset();
     }
@@ -93,6 +119,9 @@ private:
 
     void onElected(TermID term) override;
 
+    // Transfer the leadership of the witness elected in the term to the follower got most logs
+    void transferFromWitness(TermID term);
+
     void onDiscoverNewLeader(HostAddr nLeader) override;
 
     cpp2::ErrorCode commitLogs(std::unique_ptr<LogIterator> iter, bool wait) override;
@@ -110,10 +139,41 @@ private:
     nebula::cpp2::ErrorCode
     putCommitMsg(WriteBatch* batch, LogID committedLogId, TermID committedLogTerm);
 
+    // Write the rows of snapshot into the SST file, which is ingested once it reaches
+    // snapshot_ingest_sst_file_mb or the snapshot is finished
+    nebula::cpp2::ErrorCode ingestSnapshot(const std::vector<std::string>& rows, bool finished);
+
+    // Finish the SST file of snapshot being written and ingest it
+    nebula::cpp2::ErrorCode ingestSnapshotFile();
+
+    // Drop the SST file of snapshot being written without ingesting it
+    void dropSnapshotFile();
+
+    std::string snapshotFile() const;
+
     void cleanup() override;
 
     nebula::cpp2::ErrorCode toResultCode(raftex::AppendLogResult res);
 
+    // Whether the log writes any key moved by the split of the part
+    bool splitMoved(folly::StringPiece log) const;
+
+    void setSplit(std::shared_ptr<const PartSplit> split);
+
+    // Bumped whenever the data of the part has changed on this replica, after the change is
+    // visible to the reads, so a result read at a version is stale once the version differs
+    uint64_t writeVersion() const {
+        return writeVersion_.load(std::memory_order_acquire);
+    }
+
+    void bumpWriteVersion() {
+        writeVersion_.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    // The id of the last log applied to the engine, which only grows and is the same on the
+    // replicas having applied the same logs, unlike the write version
+    LogID appliedLogId();
+
 protected:
     GraphSpaceID spaceId_;
     PartitionID partId_;
@@ -122,6 +182,19 @@ protected:
 
 private:
     KVEngine* engine_ = nullptr;
+
+    mutable std::mutex splitLock_;
+    std::shared_ptr<const PartSplit> split_;
+    // Skip the lock in the writes of the parts never split
+    std::atomic<bool> hasSplit_{false};
+    CommitObserver* commitObserver_{nullptr};
+    std::atomic<uint64_t> writeVersion_{0};
+    // -1 until it is read from the commit key or a log is applied
+    std::atomic<LogID> appliedLogId_{-1};
+    // The SST file written by the rows of the snapshot received, only touched in the commit of
+    // snapshot and the cleanup before it, which are serial
+    std::unique_ptr<rocksdb::SstFileWriter> snapshotWriter_;
+    std::string snapshotLastKey_;
 };
 
 }  // namespace kvstore
@@ -0,0 +1,251 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/PartSplit.h"
+#include "kvstore/LogEncoder.h"
+#include "common/base/MurmurHash2.h"
+#include "utils/NebulaKeyUtils.h"
+#include "utils/IndexKeyUtils.h"
+
+DEFINE_int32(split_batch_size, 1024, "The number of keys copied or removed at once by a split");
+
+namespace nebula {
+namespace kvstore {
+
+std::string PartSplit::encode() const {
+    std::string val;
+    int32_t vidLenVal = vidLen;
+    int32_t num = edgeIndexes.size();
+    val.reserve(sizeof(int32_t) * 3 + 2 + sizeof(IndexID) * num);
+    val.append(reinterpret_cast<const char*>(&parts), sizeof(int32_t))
+       .append(1, intId ? 1 : 0)
+       .append(reinterpret_cast<const char*>(&vidLenVal), sizeof(int32_t))
+       .append(1, static_cast<char>(status))
+       .append(reinterpret_cast<const char*>(&num), sizeof(int32_t));
+    for (auto indexId : edgeIndexes) {
+        val.append(reinterpret_cast<const char*>(&indexId), sizeof(IndexID));
+    }
+    return val;
+}
+
+// static
+bool PartSplit::decode(folly::StringPiece value, PartSplit* split) {
+    constexpr size_t kHeadSize = sizeof(int32_t) * 3 + 2;
+    if (value.size() < kHeadSize) {
+        return false;
+    }
+    auto* data = value.data();
+    int32_t vidLenVal = 0;
+    int32_t num = 0;
+    memcpy(&split->parts, data, sizeof(int32_t));
+    split->intId = data[sizeof(int32_t)] != 0;
+    memcpy(&vidLenVal, data + sizeof(int32_t) + 1, sizeof(int32_t));
+    split->status = static_cast<Status>(data[sizeof(int32_t) * 2 + 1]);
+    memcpy(&num, data + sizeof(int32_t) * 2 + 2, sizeof(int32_t));
+    if (split->parts <= 0 || vidLenVal <= 0 || num < 0 ||
+        value.size() != kHeadSize + sizeof(IndexID) * num) {
+        return false;
+    }
+    split->vidLen = vidLenVal;
+    split->edgeIndexes.clear();
+    for (int32_t i = 0; i < num; i++) {
+        IndexID indexId;
+        memcpy(&indexId, data + kHeadSize + sizeof(IndexID) * i, sizeof(IndexID));
+        split->edgeIndexes.emplace(indexId);
+    }
+    return true;
+}
+
+// static
+const char* PartSplit::toString(Status status) {
+    switch (status) {
+        case Status::FROZEN:
+            return "FROZEN";
+        case Status::COPYING:
+            return "COPYING";
+        case Status::COPIED:
+            return "COPIED";
+        case Status::CLEANED:
+            return "CLEANED";
+    }
+    return "UNKNOWN";
+}
+
+PartitionID PartSplit::partOf(folly::StringPiece vid) const {
+    // The same as the part of a vid the clients route to, the vid in the key is padded by '\0'
+    uint64_t hash = 0;
+    if (intId) {
+        memcpy(static_cast<void*>(&hash), vid.data(), sizeof(int64_t));
+    } else {
+        MurmurHash2 murmur;
+        hash = murmur(vid.data(), strnlen(vid.data(), vid.size()));
+    }
+    return hash % (parts * 2) + 1;
+}
+
+bool PartSplit::moved(PartitionID partId, folly::StringPiece key) const {
+    if (key.size() < sizeof(PartitionID)) {
+        return false;
+    }
+    folly::StringPiece vid;
+    switch (static_cast<NebulaKeyType>(static_cast<uint8_t>(key[0]))) {
+        case NebulaKeyType::kVertex:
+        case NebulaKeyType::kEdge: {
+            // type(1) + partId(3) + vid(*) + ..., the src of an edge
+            if (key.size() < sizeof(PartitionID) + vidLen) {
+                return false;
+            }
+            vid = key.subpiece(sizeof(PartitionID), vidLen);
+            break;
+        }
+        case NebulaKeyType::kIndex: {
+            // type(1) + partId(3) + indexId(4) + values(*) + vid(*), or src(*) + rank(8) + dst(*)
+            // for an edge index, a range of the index values has no vid
+            if (key.size() < sizeof(PartitionID) + sizeof(IndexID) + vidLen) {
+                return false;
+            }
+            if (edgeIndexes.count(IndexKeyUtils::getIndexId(key))) {
+                if (key.size() < sizeof(PartitionID) + sizeof(IndexID) + vidLen * 2 +
+                                 sizeof(EdgeRanking)) {
+                    return false;
+                }
+                vid = IndexKeyUtils::getIndexSrcId(vidLen, key);
+            } else {
+                vid = IndexKeyUtils::getIndexVertexID(vidLen, key);
+            }
+            break;
+        }
+        default:
+            return false;
+    }
+    return partOf(vid) != partId;
+}
+
+bool PartSplit::movedLog(PartitionID partId, folly::StringPiece log) const {
+    if (log.size() <= sizeof(int64_t)) {
+        return false;
+    }
+    std::string decompressed;
+    if (log[sizeof(int64_t)] == OP_COMPRESSED) {
+        decompressed = decompressLog(log);
+        log = decompressed;
+    }
+    auto movedAny = [&] (const std::vector<folly::StringPiece>& pieces, size_t step) {
+        for (size_t i = 0; i < pieces.size(); i += step) {
+            if (moved(partId, pieces[i])) {
+                return true;
+            }
+        }
+        return false;
+    };
+    switch (log[sizeof(int64_t)]) {
+        case OP_PUT:
+        case OP_MULTI_PUT:
+        case OP_REMOVE_RANGE:
+            return movedAny(decodeMultiValues(log), 2);
+        case OP_MULTI_REMOVE:
+            return movedAny(decodeMultiValues(log), 1);
+        case OP_REMOVE:
+            return moved(partId, decodeSingleValue(log));
+        case OP_BATCH_WRITE: {
+            for (auto& op : decodeBatchValue(log)) {
+                if (moved(partId, op.second.first)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        default:
+            return false;
+    }
+}
+
+// static
+template <class Fn>
+nebula::cpp2::ErrorCode PartSplitter::forEachMoved(KVEngine* engine,
+                                                   PartitionID partId,
+                                                   const PartSplit& split,
+                                                   Fn&& fn) {
+    for (auto& prefix : {NebulaKeyUtils::vertexPrefix(partId),
+                         NebulaKeyUtils::edgePrefix(partId),
+                         IndexKeyUtils::indexPrefix(partId)}) {
+        std::unique_ptr<KVIterator> iter;
+        auto code = engine->prefix(prefix, &iter, ScanHint::kFullScan);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+        for (; iter->valid(); iter->next()) {
+            if (split.moved(partId, iter->key())) {
+                code = fn(iter->key(), iter->val());
+                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    return code;
+                }
+            }
+        }
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+// static
+nebula::cpp2::ErrorCode PartSplitter::copy(KVEngine* from,
+                                           KVEngine* to,
+                                           PartitionID partId,
+                                           const PartSplit& split) {
+    auto batch = to->startBatchWrite();
+    int32_t count = 0;
+    int64_t total = 0;
+    auto code = forEachMoved(from, partId, split, [&] (auto key, auto val) {
+        // Replace the part of the key, and keep its type
+        std::string newKey = key.str();
+        PartitionID item = ((partId + split.parts) << kPartitionOffset) |
+                           static_cast<uint8_t>(key[0]);
+        memcpy(&newKey[0], &item, sizeof(PartitionID));
+        auto ret = batch->put(newKey, val);
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED || ++count < FLAGS_split_batch_size) {
+            return ret;
+        }
+        total += count;
+        count = 0;
+        ret = to->commitBatchWrite(std::move(batch), false, false, true);
+        batch = to->startBatchWrite();
+        return ret;
+    });
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED && count > 0) {
+        total += count;
+        code = to->commitBatchWrite(std::move(batch), false, false, true);
+    }
+    LOG(INFO) << "Copy " << total << " keys of part " << partId << " to part "
+              << partId + split.parts << ", result " << static_cast<int32_t>(code);
+    return code;
+}
+
+// static
+nebula::cpp2::ErrorCode PartSplitter::cleanup(KVEngine* engine,
+                                              PartitionID partId,
+                                              const PartSplit& split) {
+    std::vector<std::string> keys;
+    int64_t total = 0;
+    auto code = forEachMoved(engine, partId, split, [&] (auto key, auto) {
+        keys.emplace_back(key.str());
+        if (keys.size() < static_cast<size_t>(FLAGS_split_batch_size)) {
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+        total += keys.size();
+        auto ret = engine->multiRemove(std::move(keys));
+        keys.clear();
+        return ret;
+    });
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED && !keys.empty()) {
+        total += keys.size();
+        code = engine->multiRemove(std::move(keys));
+    }
+    LOG(INFO) << "Remove " << total << " keys moved from part " << partId
+              << ", result " << static_cast<int32_t>(code);
+    return code;
+}
+
+}  // namespace kvstore
+}  // namespace nebula
@@ -0,0 +1,92 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_PARTSPLIT_H_
+#define KVSTORE_PARTSPLIT_H_
+
+#include "common/base/Base.h"
+#include "kvstore/KVEngine.h"
+
+namespace nebula {
+namespace kvstore {
+
+/*
+PartSplit is the split of a part when the parts of the space are doubled. The part of a vertex
+is its hash modulo the number of parts plus 1, so a vertex of part p either stays in p or moves
+to p + parts, and no other part is involved. The edges move with their src, the tag indexes with
+their vertex and the edge indexes with their src, the keys of the other types stay in p.
+
+A split goes through the status in order, and is kept in the system split key of the part:
+  FROZEN    p rejects the writes of the keys moved, set by a raft log of p
+  COPYING   the keys moved are copied into p + parts on each replica, set by a raft log of p.
+            Every write the frozen check let through is committed before this log, so the keys
+            moved never change after it, and the copies on all the replicas are the same.
+  COPIED    the copy on this replica is finished, the space could be switched to the doubled
+            parts once all the replicas are copied
+  CLEANED   the keys moved are removed from p on this replica
+The writes of the keys moved are still rejected after the split, they belong to p + parts.
+*/
+struct PartSplit {
+    enum class Status : int8_t {
+        FROZEN  = 1,
+        COPYING = 2,
+        COPIED  = 3,
+        CLEANED = 4,
+    };
+
+    // the number of parts before the split
+    int32_t                         parts{0};
+    bool                            intId{false};
+    size_t                          vidLen{0};
+    std::unordered_set<IndexID>     edgeIndexes;
+    Status                          status{Status::FROZEN};
+
+    std::string encode() const;
+
+    static bool decode(folly::StringPiece value, PartSplit* split);
+
+    static const char* toString(Status status);
+
+    // The part of the vertex when the parts are doubled
+    PartitionID partOf(folly::StringPiece vid) const;
+
+    // Whether the key of the part, or the range starting from it, is moved
+    bool moved(PartitionID partId, folly::StringPiece key) const;
+
+    // Whether any key written by the encoded log is moved
+    bool movedLog(PartitionID partId, folly::StringPiece log) const;
+};
+
+/*
+PartSplitter copies and removes the keys moved by a split on the engines of a replica, in
+batches of split_batch_size keys. Both are idempotent, so they are simply done again if the
+storaged is restarted halfway.
+*/
+class PartSplitter final {
+public:
+    // Copy the keys moved from the part in "from" into the part partId + split.parts in "to"
+    static nebula::cpp2::ErrorCode copy(KVEngine* from,
+                                        KVEngine* to,
+                                        PartitionID partId,
+                                        const PartSplit& split);
+
+    // Remove the keys moved from the part
+    static nebula::cpp2::ErrorCode cleanup(KVEngine* engine,
+                                           PartitionID partId,
+                                           const PartSplit& split);
+
+private:
+    template <class Fn>
+    static nebula::cpp2::ErrorCode forEachMoved(KVEngine* engine,
+                                                PartitionID partId,
+                                                const PartSplit& split,
+                                                Fn&& fn);
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+
+#endif  // KVSTORE_PARTSPLIT_H_
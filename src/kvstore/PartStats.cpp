@@ -0,0 +1,362 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/PartStats.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace kvstore {
+
+namespace {
+
+template <typename T>
+void appendInt(std::string* value, T i) {
+    value->append(reinterpret_cast<const char*>(&i), sizeof(T));
+}
+
+template <typename T>
+bool readNext(folly::StringPiece* value, T* i) {
+    if (value->size() < sizeof(T)) {
+        return false;
+    }
+    memcpy(i, value->data(), sizeof(T));
+    value->advance(sizeof(T));
+    return true;
+}
+
+template <typename K>
+bool readCounters(folly::StringPiece* value, std::unordered_map<K, int64_t>* counters) {
+    uint32_t num = 0;
+    if (!readNext(value, &num)) {
+        return false;
+    }
+    for (uint32_t i = 0; i < num; i++) {
+        K id;
+        int64_t count = 0;
+        if (!readNext(value, &id) || !readNext(value, &count)) {
+            return false;
+        }
+        counters->emplace(id, count);
+    }
+    return true;
+}
+
+// Some keys with the prefix are in [start, end)
+bool intersects(folly::StringPiece start, folly::StringPiece end, const std::string& prefix) {
+    auto prefixEnd = NebulaKeyUtils::prefixEnd(prefix);
+    return start < prefixEnd && prefix < end;
+}
+
+// All keys with the prefix are in [start, end)
+bool covers(folly::StringPiece start, folly::StringPiece end, const std::string& prefix) {
+    return start <= prefix && NebulaKeyUtils::prefixEnd(prefix) <= end;
+}
+
+}  // namespace
+
+std::string PartStats::encode() const {
+    std::string value;
+    value.reserve(sizeof(LogID) + 2 * sizeof(int64_t) + 2 * sizeof(uint32_t) +
+                  (tags.size() + edgeTypes.size()) * (sizeof(int32_t) + sizeof(int64_t)));
+    appendInt(&value, since);
+    appendInt(&value, vertices);
+    appendInt(&value, edges);
+    appendInt(&value, static_cast<uint32_t>(tags.size()));
+    for (const auto& tag : tags) {
+        appendInt(&value, tag.first);
+        appendInt(&value, tag.second);
+    }
+    appendInt(&value, static_cast<uint32_t>(edgeTypes.size()));
+    for (const auto& edgeType : edgeTypes) {
+        appendInt(&value, edgeType.first);
+        appendInt(&value, edgeType.second);
+    }
+    return value;
+}
+
+// static
+bool PartStats::decode(folly::StringPiece value, PartStats* stats) {
+    return readNext(&value, &stats->since) &&
+           readNext(&value, &stats->vertices) &&
+           readNext(&value, &stats->edges) &&
+           readCounters(&value, &stats->tags) &&
+           readCounters(&value, &stats->edgeTypes);
+}
+
+void PartStatsUpdater::load(LogID logId) {
+    if (loaded_) {
+        return;
+    }
+    loaded_ = true;
+    std::string value;
+    auto code = engine_->get(NebulaKeyUtils::systemStatisKey(partId_), &value);
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED && PartStats::decode(value, &stats_)) {
+        return;
+    }
+    stats_ = PartStats();
+    // the counters are exact from the start if the part has no data yet
+    stats_.since = empty(NebulaKeyUtils::vertexPrefix(partId_)) &&
+                   empty(NebulaKeyUtils::edgePrefix(partId_)) ? 0 : logId;
+    changed_ = true;
+}
+
+bool PartStatsUpdater::empty(const std::string& prefix) {
+    std::unique_ptr<KVIterator> iter;
+    auto code = engine_->prefix(prefix, &iter);
+    return code == nebula::cpp2::ErrorCode::SUCCEEDED && !iter->valid();
+}
+
+bool PartStatsUpdater::exists(folly::StringPiece key) {
+    auto it = keys_.find(key.str());
+    if (it != keys_.end()) {
+        return it->second;
+    }
+    if (removed(key)) {
+        return false;
+    }
+    std::string value;
+    return engine_->get(key.str(), &value) == nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+int64_t& PartStatsUpdater::tagsOf(folly::StringPiece vertexKey) {
+    auto prefix = vertexKey.subpiece(0, vertexKey.size() - sizeof(TagID)).str();
+    auto it = vertexTags_.find(prefix);
+    if (it != vertexTags_.end()) {
+        return it->second;
+    }
+    int64_t count = 0;
+    std::unique_ptr<KVIterator> iter;
+    if (!removed(prefix) &&
+        engine_->prefix(prefix, &iter) == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        for (; iter->valid(); iter->next()) {
+            count++;
+        }
+    }
+    return vertexTags_.emplace(std::move(prefix), count).first->second;
+}
+
+void PartStatsUpdater::update(LogID logId, folly::StringPiece key, bool exist) {
+    bool isVertex = key.size() > static_cast<size_t>(kVertexLen) &&
+                    NebulaKeyUtils::isVertex(key.size() - kVertexLen, key);
+    bool isEdge = !isVertex && key.size() > static_cast<size_t>(kEdgeLen) &&
+                  (key.size() - kEdgeLen) % 2 == 0 &&
+                  NebulaKeyUtils::isEdge((key.size() - kEdgeLen) / 2, key);
+    if (!isVertex && !isEdge) {
+        return;
+    }
+    EdgeType edgeType = 0;
+    if (isEdge) {
+        edgeType = NebulaKeyUtils::getEdgeType((key.size() - kEdgeLen) / 2, key);
+    }
+    // only the out edges are in the statis, the degrees are of both directions
+    bool stats = countStats_ && (isVertex || edgeType > 0);
+    bool degree = countDegrees_ && isEdge && !degreesDropped_;
+    if (!stats && !degree) {
+        return;
+    }
+    if (stats) {
+        load(logId);
+    }
+    bool existed = exists(key);
+    keys_[key.str()] = exist;
+    if (existed == exist) {
+        return;
+    }
+    int64_t delta = exist ? 1 : -1;
+    if (degree) {
+        degreeOf(key) += delta;
+    }
+    if (!stats) {
+        return;
+    }
+    changed_ = true;
+    if (isVertex) {
+        stats_.tags[NebulaKeyUtils::getTagId(key.size() - kVertexLen, key)] += delta;
+        auto& tags = tagsOf(key);
+        if ((exist && tags == 0) || (!exist && tags == 1)) {
+            stats_.vertices += delta;
+        }
+        tags += delta;
+    } else {
+        stats_.edgeTypes[edgeType] += delta;
+        stats_.edges += delta;
+    }
+}
+
+int64_t& PartStatsUpdater::degreeOf(folly::StringPiece edgeKey) {
+    auto vIdLen = (edgeKey.size() - kEdgeLen) / 2;
+    auto key = NebulaKeyUtils::degreeKey(vIdLen,
+                                         partId_,
+                                         NebulaKeyUtils::getSrcId(vIdLen, edgeKey).str(),
+                                         NebulaKeyUtils::getEdgeType(vIdLen, edgeKey));
+    auto it = degrees_.find(key);
+    if (it != degrees_.end()) {
+        return it->second;
+    }
+    if (!degreesValid_.hasValue()) {
+        degreesValid_ = PartDegrees::valid(engine_, partId_);
+    }
+    int64_t degree = -1;
+    std::string value;
+    if (degreesValid_.value() &&
+        engine_->get(key, &value) == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        degree = PartDegrees::decode(value);
+    }
+    if (degree < 0) {
+        // the first change of the edges of the vertex since counted, which are scanned once
+        degree = 0;
+        auto prefix = edgeKey.subpiece(0, sizeof(PartitionID) + vIdLen + sizeof(EdgeType)).str();
+        std::unique_ptr<KVIterator> iter;
+        if (engine_->prefix(prefix, &iter) == nebula::cpp2::ErrorCode::SUCCEEDED) {
+            for (; iter->valid(); iter->next()) {
+                if (NebulaKeyUtils::isEdge(vIdLen, iter->key())) {
+                    degree++;
+                }
+            }
+        }
+    }
+    return degrees_.emplace(std::move(key), degree).first->second;
+}
+
+void PartStatsUpdater::put(LogID logId, folly::StringPiece key) {
+    update(logId, key, true);
+}
+
+void PartStatsUpdater::remove(LogID logId, folly::StringPiece key) {
+    update(logId, key, false);
+}
+
+void PartStatsUpdater::removeRange(LogID logId, folly::StringPiece start, folly::StringPiece end) {
+    auto vertexPrefix = NebulaKeyUtils::vertexPrefix(partId_);
+    auto edgePrefix = NebulaKeyUtils::edgePrefix(partId_);
+    bool vertices = intersects(start, end, vertexPrefix);
+    bool edges = intersects(start, end, edgePrefix);
+    if (!vertices && !edges) {
+        return;
+    }
+    bool allVertices = vertices && covers(start, end, vertexPrefix);
+    bool allEdges = edges && covers(start, end, edgePrefix);
+    if ((vertices && !allVertices) || (edges && !allEdges)) {
+        // The rows of part of a table are counted one by one as removed before the range is
+        // removed, so the counters are still exact
+        std::set<std::string> rows;
+        std::unique_ptr<KVIterator> iter;
+        if (engine_->range(start.str(), end.str(), &iter) == nebula::cpp2::ErrorCode::SUCCEEDED) {
+            for (; iter->valid(); iter->next()) {
+                auto key = iter->key();
+                if ((allVertices && key.startsWith(vertexPrefix)) ||
+                    (allEdges && key.startsWith(edgePrefix))) {
+                    continue;
+                }
+                rows.emplace(key.str());
+            }
+        }
+        // and the ones put by the previous ops of the commit
+        for (const auto& key : keys_) {
+            if (key.second && start <= key.first && key.first < end) {
+                rows.emplace(key.first);
+            }
+        }
+        for (const auto& row : rows) {
+            update(logId, row, false);
+        }
+    }
+    if (allEdges && countDegrees_) {
+        degreesDropped_ = true;
+        degrees_.clear();
+    }
+    if (countStats_ && (allVertices || allEdges)) {
+        load(logId);
+        changed_ = true;
+        if (allVertices) {
+            stats_.vertices = 0;
+            stats_.tags.clear();
+        }
+        if (allEdges) {
+            stats_.edges = 0;
+            stats_.edgeTypes.clear();
+        }
+    }
+    // the keys removed are still in the engine until the batch is committed
+    for (auto& key : keys_) {
+        if (start <= key.first && key.first < end) {
+            key.second = false;
+        }
+    }
+    if (allVertices) {
+        for (auto& vertex : vertexTags_) {
+            if (start <= vertex.first && vertex.first < end) {
+                vertex.second = 0;
+            }
+        }
+    }
+    ranges_.emplace_back(start.str(), end.str());
+}
+
+void PartStatsUpdater::apply(
+        LogID logId,
+        const std::pair<BatchLogType, std::pair<folly::StringPiece, folly::StringPiece>>& op) {
+    switch (op.first) {
+        case BatchLogType::OP_BATCH_PUT:
+        case BatchLogType::OP_BATCH_MERGE:
+            put(logId, op.second.first);
+            break;
+        case BatchLogType::OP_BATCH_REMOVE:
+            remove(logId, op.second.first);
+            break;
+        case BatchLogType::OP_BATCH_REMOVE_RANGE:
+            removeRange(logId, op.second.first, op.second.second);
+            break;
+    }
+}
+
+bool PartStatsUpdater::removed(folly::StringPiece key) {
+    for (const auto& range : ranges_) {
+        if (range.first <= key && key < range.second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+nebula::cpp2::ErrorCode PartStatsUpdater::flush(WriteBatch* batch, LogID lastId) {
+    if (countDegrees_ && lastId >= 0) {
+        if (!degreesValid_.hasValue()) {
+            degreesValid_ = PartDegrees::valid(engine_, partId_);
+        }
+        if (!degreesValid_.value() || degreesDropped_) {
+            // the degrees before are stale, the ones counted by the commit are put after. The
+            // prefix is little endian, so the range is ended by prefixEnd of it, rather than
+            // the prefix of next part
+            auto prefix = NebulaKeyUtils::degreePrefix(partId_);
+            auto code = batch->removeRange(prefix, NebulaKeyUtils::prefixEnd(prefix));
+            if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                return code;
+            }
+        }
+        if (!degreesDropped_) {
+            for (const auto& degree : degrees_) {
+                auto code = batch->put(degree.first, PartDegrees::encode(degree.second));
+                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    return code;
+                }
+            }
+            auto code = batch->put(NebulaKeyUtils::systemDegreeKey(partId_),
+                                   std::string(reinterpret_cast<const char*>(&lastId),
+                                               sizeof(LogID)));
+            if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                return code;
+            }
+        }
+    }
+    if (!countStats_ || !changed_) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    return batch->put(NebulaKeyUtils::systemStatisKey(partId_), stats_.encode());
+}
+
+}  // namespace kvstore
+}  // namespace nebula
@@ -0,0 +1,157 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_PARTSTATS_H_
+#define KVSTORE_PARTSTATS_H_
+
+#include "common/base/Base.h"
+#include "kvstore/KVEngine.h"
+#include "kvstore/LogEncoder.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace kvstore {
+
+/*
+PartStats is the number of vertices and edges of a part, and that of each tag and edge type,
+which is kept in the system statis key of the part when enable_incremental_statis is on. Only
+the out edges are counted, as StatisTask does.
+
+The counters are exact only for the logs after "since", since the part could have data before
+the flag is on. So StatisTask scans the part once to get the offset of the counters, which is
+kept with "since" in the system statis base key.
+The offset is valid as long as "since" is not changed. The part without any data when the
+counters start has nothing to offset, "since" is 0 then.
+*/
+struct PartStats {
+    LogID                                   since{0};
+    int64_t                                 vertices{0};
+    int64_t                                 edges{0};
+    std::unordered_map<TagID, int64_t>      tags;
+    std::unordered_map<EdgeType, int64_t>   edgeTypes;
+
+    std::string encode() const;
+
+    static bool decode(folly::StringPiece value, PartStats* stats);
+};
+
+/*
+PartDegrees is the number of edges of each vertex and edge type, the out edges by the positive
+edge type and the in edges by the negative one, which is kept in the degree keys of the part
+when enable_degree_counters is on. They are changed in the same batch as the edges, so the
+degree of a vertex is a single point read instead of a scan of its edges.
+
+A vertex has its counter from the first change of its edges since the flag is on, at which its
+edges are scanned once, so a missing counter means unknown rather than zero. The system degree
+key is the last log counted, written by every commit counting. The counters are valid only if
+it is the last log committed, otherwise some logs are committed without counting, e.g. when the
+flag is off for a while, or the rows are ingested or rebuilt by a snapshot, and they are all
+removed by the next commit. The edges expired by ttl are counted until they are removed.
+*/
+struct PartDegrees {
+    // Whether the counters of the part are valid, `engine` is a KVEngine or a PartHandle
+    template <typename Engine>
+    static bool valid(Engine* engine, PartitionID partId) {
+        std::string counted, committed;
+        if (engine->get(NebulaKeyUtils::systemDegreeKey(partId), &counted) !=
+                nebula::cpp2::ErrorCode::SUCCEEDED ||
+            engine->get(NebulaKeyUtils::systemCommitKey(partId), &committed) !=
+                nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return false;
+        }
+        return counted.size() == sizeof(LogID) && committed.size() >= sizeof(LogID) &&
+               memcmp(counted.data(), committed.data(), sizeof(LogID)) == 0;
+    }
+
+    // The degree in the value of the degree key, -1 if it is bad
+    static int64_t decode(folly::StringPiece value) {
+        int64_t degree = -1;
+        if (value.size() == sizeof(int64_t)) {
+            memcpy(&degree, value.data(), sizeof(int64_t));
+        }
+        return degree;
+    }
+
+    static std::string encode(int64_t degree) {
+        return std::string(reinterpret_cast<const char*>(&degree), sizeof(int64_t));
+    }
+};
+
+/*
+PartStatsUpdater counts the writes of one commit in Part::commitLogs. Each key put or removed is
+checked if it exists before, in the engine or by the previous ops of the commit, so that an
+overwrite or the remove of a key missing is not counted. The counters are loaded at the first op
+and written into the batch of the commit by flush if they are changed. The rows in a remove range
+of part of a table are counted one by one as removed, while the counters of a table removed as a
+whole are just cleared. The degrees are counted in the same way if `degrees` is set, and a remove
+range of all edges stops counting them for the commit, so they are removed by the next one.
+*/
+class PartStatsUpdater final {
+public:
+    PartStatsUpdater(KVEngine* engine, PartitionID partId, bool stats = true, bool degrees = false)
+        : engine_(engine)
+        , partId_(partId)
+        , countStats_(stats)
+        , countDegrees_(degrees) {}
+
+    void put(LogID logId, folly::StringPiece key);
+
+    void remove(LogID logId, folly::StringPiece key);
+
+    void removeRange(LogID logId, folly::StringPiece start, folly::StringPiece end);
+
+    // Count an op of OP_BATCH_WRITE, the merge is counted as a put
+    void apply(LogID logId,
+               const std::pair<BatchLogType,
+                               std::pair<folly::StringPiece, folly::StringPiece>>& op);
+
+    // lastId is the last log of the commit, which is counted by the degrees
+    nebula::cpp2::ErrorCode flush(WriteBatch* batch, LogID lastId = -1);
+
+private:
+    void load(LogID logId);
+
+    bool empty(const std::string& prefix);
+
+    bool exists(folly::StringPiece key);
+
+    // Whether the key is in the ranges removed by the previous ops of the commit
+    bool removed(folly::StringPiece key);
+
+    // The number of tags of the vertex, counted in the engine at the first change of it
+    int64_t& tagsOf(folly::StringPiece vertexKey);
+
+    void update(LogID logId, folly::StringPiece key, bool exist);
+
+    // The degree of the src and edge type of the edge before the commit, or counted by the
+    // previous ops of it
+    int64_t& degreeOf(folly::StringPiece edgeKey);
+
+private:
+    KVEngine*                                       engine_{nullptr};
+    PartitionID                                     partId_;
+    bool                                            loaded_{false};
+    bool                                            changed_{false};
+    PartStats                                       stats_;
+    // Whether the key exists after the previous ops of the commit
+    std::unordered_map<std::string, bool>           keys_;
+    std::unordered_map<std::string, int64_t>        vertexTags_;
+    std::vector<std::pair<std::string, std::string>> ranges_;
+
+    const bool                                      countStats_;
+    const bool                                      countDegrees_;
+    // Whether the degree counters before the commit are valid, checked at the first use
+    folly::Optional<bool>                           degreesValid_;
+    // Whether an edge range is removed, then the degrees are not counted by the commit
+    bool                                            degreesDropped_{false};
+    // degree key => degree
+    std::unordered_map<std::string, int64_t>        degrees_;
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+
+#endif  // KVSTORE_PARTSTATS_H_
@@ -7,14 +7,28 @@
 #include "kvstore/RocksEngine.h"
 #include <folly/String.h>
 #include <rocksdb/convenience.h>
+#include <rocksdb/slice_transform.h>
+#include <rocksdb/sst_file_reader.h>
+#include <rocksdb/sst_file_writer.h>
 #include "common/base/Base.h"
 #include "common/fs/FileUtils.h"
 #include "kvstore/KVStore.h"
 #include "kvstore/RocksEngineConfig.h"
+#include "utils/IndexKeyUtils.h"
 #include "utils/NebulaKeyUtils.h"
 
 DEFINE_bool(move_files, false,
             "Move the SST files instead of copy when ingest into dataset");
+DEFINE_int32(compact_expired_max_files, 0,
+             "The max SST files compacted at a time by the compaction of expired or dropped data, "
+             "0 means all files of a level at once");
+DEFINE_int32(ingest_prepare_threads, 1,
+             "Number of threads to verify and split the SST files before they are ingested, "
+             "1 means preparing them one by one");
+DEFINE_int32(ingest_flush_retry_times, 0,
+             "The times to flush the memtable without stalling the writes and ingest again, if "
+             "the SST files ingested overlap the memtable, before the ingest blocks the writes "
+             "to flush it, 0 means blocking at once");
 
 namespace nebula {
 namespace kvstore {
@@ -32,15 +46,18 @@ namespace {
 class RocksWriteBatch : public WriteBatch {
 private:
     rocksdb::WriteBatch batch_;
+    const RocksEngine* engine_;
 
 public:
-    RocksWriteBatch() : batch_(FLAGS_rocksdb_batch_size) {}
+    explicit RocksWriteBatch(const RocksEngine* engine)
+        : batch_(FLAGS_rocksdb_batch_size)
+        , engine_(engine) {}
 
     virtual ~RocksWriteBatch() = default;
 
     nebula::cpp2::ErrorCode
     put(folly::StringPiece key, folly::StringPiece value) override {
-        if (batch_.Put(toSlice(key), toSlice(value)).ok()) {
+        if (batch_.Put(engine_->columnFamily(key), toSlice(key), toSlice(value)).ok()) {
             return nebula::cpp2::ErrorCode::SUCCEEDED;
         } else {
             return nebula::cpp2::ErrorCode::E_UNKNOWN;
@@ -48,7 +65,7 @@ public:
     }
 
     nebula::cpp2::ErrorCode remove(folly::StringPiece key) override {
-        if (batch_.Delete(toSlice(key)).ok()) {
+        if (batch_.Delete(engine_->columnFamily(key), toSlice(key)).ok()) {
             return nebula::cpp2::ErrorCode::SUCCEEDED;
         } else {
             return nebula::cpp2::ErrorCode::E_UNKNOWN;
@@ -58,7 +75,16 @@ public:
     // Remove all keys in the range [start, end)
     nebula::cpp2::ErrorCode
     removeRange(folly::StringPiece start, folly::StringPiece end) override {
-        if (batch_.DeleteRange(toSlice(start), toSlice(end)).ok()) {
+        for (auto* cf : engine_->columnFamilies(start, end)) {
+            if (!batch_.DeleteRange(cf, toSlice(start), toSlice(end)).ok()) {
+                return nebula::cpp2::ErrorCode::E_UNKNOWN;
+            }
+        }
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    nebula::cpp2::ErrorCode merge(folly::StringPiece key, folly::StringPiece operand) override {
+        if (batch_.Merge(engine_->columnFamily(key), toSlice(key), toSlice(operand)).ok()) {
             return nebula::cpp2::ErrorCode::SUCCEEDED;
         } else {
             return nebula::cpp2::ErrorCode::E_UNKNOWN;
@@ -114,26 +140,194 @@ RocksEngine::RocksEngine(GraphSpaceID spaceId,
     rocksdb::DB* db = nullptr;
     rocksdb::Status status = initRocksdbOptions(options, spaceId, vIdLen);
     CHECK(status.ok()) << status.ToString();
+    status = initRocksdbDbPaths(options, dataPath, spaceId);
+    CHECK(status.ok()) << status.ToString();
     if (mergeOp != nullptr) {
         options.merge_operator = mergeOp;
     }
     if (cfFactory != nullptr) {
         options.compaction_filter_factory = cfFactory;
+        if (FLAGS_rocksdb_compact_expired_files) {
+            kvFilterFactory_ = std::dynamic_pointer_cast<KVCompactionFilterFactory>(cfFactory);
+        }
+        if (kvFilterFactory_ != nullptr) {
+            options.table_properties_collector_factories.emplace_back(
+                std::make_shared<KVTablePropertiesCollectorFactory>(spaceId, kvFilterFactory_));
+        }
     }
 
-    if (readonly) {
-        status = rocksdb::DB::OpenForReadOnly(options, path, &db);
-    } else {
-        status = rocksdb::DB::Open(options, path, &db);
-    }
+    status = openByKeyType(options, path, readonly, &db);
     CHECK(status.ok()) << status.ToString();
     db_.reset(db);
+    if (cfHandles_.empty()) {
+        cfHandles_.emplace_back(db_->DefaultColumnFamily());
+    }
+    prefixExtractor_ = options.prefix_extractor;
     partsNum_ = allParts().size();
     LOG(INFO) << "open rocksdb on " << path;
 
     backup();
 }
 
+rocksdb::Status RocksEngine::openByKeyType(const rocksdb::Options& options,
+                                           const std::string& path,
+                                           bool readonly,
+                                           rocksdb::DB** db) {
+    // All column families of an existing db must be opened, so the flag only decides how a new
+    // db is created. The meta and the default space never split the keys.
+    std::vector<std::string> existing;
+    bool byKeyType = false;
+    if (rocksdb::DB::ListColumnFamilies(options, path, &existing).ok()) {
+        byKeyType = existing.size() > 1;
+        if (!byKeyType && FLAGS_rocksdb_column_family_per_key_type && spaceId_ != 0) {
+            LOG(WARNING) << "Space " << spaceId_ << " is created with only the default column "
+                         << "family, rocksdb_column_family_per_key_type is ignored";
+        }
+    } else {
+        byKeyType = FLAGS_rocksdb_column_family_per_key_type && spaceId_ != 0;
+    }
+
+    if (!byKeyType) {
+        return readonly ? rocksdb::DB::OpenForReadOnly(options, path, db)
+                        : rocksdb::DB::Open(options, path, db);
+    }
+
+    std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+    for (size_t family = 0; family < kNumFamilies; family++) {
+        rocksdb::ColumnFamilyOptions cfOpts(options);
+        rocksdb::Status s;
+        if (family == kEdgeFamily) {
+            s = initRocksdbColumnFamilyOptions(
+                options, FLAGS_rocksdb_edge_column_family_options, cfOpts);
+        } else if (family == kIndexFamily) {
+            s = initRocksdbColumnFamilyOptions(
+                options, FLAGS_rocksdb_index_column_family_options, cfOpts);
+        }
+        if (!s.ok()) {
+            return s;
+        }
+        descriptors.emplace_back(familyName(family), cfOpts);
+    }
+
+    rocksdb::DBOptions dbOpts(options);
+    dbOpts.create_missing_column_families = true;
+    std::vector<rocksdb::ColumnFamilyHandle*> handles;
+    auto status = readonly
+                ? rocksdb::DB::OpenForReadOnly(dbOpts, path, descriptors, &handles, db)
+                : rocksdb::DB::Open(dbOpts, path, descriptors, &handles, db);
+    if (!status.ok()) {
+        return status;
+    }
+    // use the handle owned by db for the default column family
+    (*db)->DestroyColumnFamilyHandle(handles[kDefaultFamily]);
+    handles[kDefaultFamily] = (*db)->DefaultColumnFamily();
+    cfHandles_ = std::move(handles);
+    LOG(INFO) << "Space " << spaceId_ << " puts edges and indexes in their own column families";
+    return status;
+}
+
+// static
+const char* RocksEngine::familyName(size_t family) {
+    switch (family) {
+        case kEdgeFamily:
+            return "edge";
+        case kIndexFamily:
+            return "index";
+        default:
+            return rocksdb::kDefaultColumnFamilyName.c_str();
+    }
+}
+
+std::vector<rocksdb::ColumnFamilyHandle*>
+RocksEngine::columnFamilies(folly::StringPiece start, folly::StringPiece end) const {
+    // the keys in between have the same key type only if start and end have
+    if (cfHandles_.size() == 1 ||
+        (!start.empty() && !end.empty() && start[0] == end[0])) {
+        return {columnFamily(start)};
+    }
+    return cfHandles_;
+}
+
+std::vector<rocksdb::ColumnFamilyHandle*>
+RocksEngine::columnFamilies(folly::StringPiece prefix) const {
+    if (cfHandles_.size() == 1 || !prefix.empty()) {
+        return {columnFamily(prefix)};
+    }
+    return cfHandles_;
+}
+
+std::unique_ptr<KVIterator> RocksEngine::newRangeIter(rocksdb::ReadOptions options,
+                                                      const std::string& start,
+                                                      const std::string& end) {
+    std::vector<std::unique_ptr<KVIterator>> iters;
+    for (auto* cf : columnFamilies(start, end)) {
+        // the upper bound saves skipping the tombstones after end
+        auto bound = std::make_unique<RocksIterBound>(end);
+        options.iterate_upper_bound = &bound->slice_;
+        rocksdb::Iterator* iter = db_->NewIterator(options, cf);
+        if (iter) {
+            iter->Seek(rocksdb::Slice(start));
+        }
+        iters.emplace_back(new RocksRangeIter(iter, start, end, std::move(bound)));
+    }
+    if (iters.size() == 1) {
+        return std::move(iters[0]);
+    }
+    return std::make_unique<RocksMergeIter>(std::move(iters));
+}
+
+rocksdb::Status RocksEngine::groupSyncWal() {
+    // The write is done before it takes a ticket, so a sync started after that covers it. If
+    // a sync is running, wait for it and the next sync would cover all writes arrived meanwhile.
+    std::unique_lock<std::mutex> guard(syncLock_);
+    auto ticket = ++writesToSync_;
+    while (writesSynced_ < ticket) {
+        if (syncing_) {
+            syncCond_.wait(guard);
+            continue;
+        }
+        syncing_ = true;
+        auto target = writesToSync_;
+        guard.unlock();
+        auto status = db_->SyncWAL();
+        guard.lock();
+        syncing_ = false;
+        if (status.ok()) {
+            writesSynced_ = std::max(writesSynced_, target);
+        }
+        syncCond_.notify_all();
+        if (!status.ok()) {
+            LOG(ERROR) << "Sync wal failed: " << status.ToString();
+            return status;
+        }
+    }
+    return rocksdb::Status::OK();
+}
+
+std::unique_ptr<KVIterator> RocksEngine::newPrefixIter(rocksdb::ReadOptions options,
+                                                       const std::string& start,
+                                                       const std::string& prefix) {
+    // The smallest key greater than all keys with the prefix, none if the prefix is all 0xFF
+    auto upper = NebulaKeyUtils::prefixEnd(prefix);
+    std::vector<std::unique_ptr<KVIterator>> iters;
+    for (auto* cf : columnFamilies(prefix)) {
+        std::unique_ptr<RocksIterBound> bound;
+        if (!upper.empty()) {
+            bound = std::make_unique<RocksIterBound>(upper);
+            options.iterate_upper_bound = &bound->slice_;
+        }
+        rocksdb::Iterator* iter = db_->NewIterator(options, cf);
+        if (iter) {
+            iter->Seek(rocksdb::Slice(start));
+        }
+        iters.emplace_back(new RocksPrefixIter(iter, prefix, std::move(bound)));
+    }
+    if (iters.size() == 1) {
+        return std::move(iters[0]);
+    }
+    return std::make_unique<RocksMergeIter>(std::move(iters));
+}
+
 void RocksEngine::stop() {
     if (db_) {
         // Because we trigger compaction in WebService, we need to stop all background work
@@ -143,7 +337,7 @@ void RocksEngine::stop() {
 }
 
 std::unique_ptr<WriteBatch> RocksEngine::startBatchWrite() {
-    return std::make_unique<RocksWriteBatch>();
+    return std::make_unique<RocksWriteBatch>(this);
 }
 
 nebula::cpp2::ErrorCode
@@ -153,10 +347,14 @@ RocksEngine::commitBatchWrite(std::unique_ptr<WriteBatch> batch,
                               bool wait) {
     rocksdb::WriteOptions options;
     options.disableWAL = disableWAL;
-    options.sync = sync;
+    bool groupSync = sync && !disableWAL && FLAGS_rocksdb_group_wal_sync;
+    options.sync = sync && !groupSync;
     options.no_slowdown = !wait;
     auto* b = static_cast<RocksWriteBatch*>(batch.get());
     rocksdb::Status status = db_->Write(options, b->data());
+    if (status.ok() && groupSync) {
+        status = groupSyncWal();
+    }
     if (status.ok()) {
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     } else if (!wait && status.IsIncomplete()) {
@@ -168,7 +366,7 @@ RocksEngine::commitBatchWrite(std::unique_ptr<WriteBatch> batch,
 
 nebula::cpp2::ErrorCode RocksEngine::get(const std::string& key, std::string* value) {
     rocksdb::ReadOptions options;
-    rocksdb::Status status = db_->Get(options, rocksdb::Slice(key), value);
+    rocksdb::Status status = db_->Get(options, columnFamily(key), rocksdb::Slice(key), value);
     if (status.ok()) {
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     } else if (status.IsNotFound()) {
@@ -183,63 +381,181 @@ nebula::cpp2::ErrorCode RocksEngine::get(const std::string& key, std::string* va
 std::vector<Status> RocksEngine::multiGet(const std::vector<std::string>& keys,
                                           std::vector<std::string>* values) {
     rocksdb::ReadOptions options;
+    auto num = keys.size();
+    std::vector<rocksdb::ColumnFamilyHandle*> cfs;
     std::vector<rocksdb::Slice> slices;
-    for (size_t index = 0; index < keys.size(); index++) {
+    cfs.reserve(num);
+    slices.reserve(num);
+    for (size_t index = 0; index < num; index++) {
+        cfs.emplace_back(columnFamily(keys[index]));
         slices.emplace_back(keys[index]);
     }
 
-    auto status = db_->MultiGet(options, slices, values);
+    // The batched MultiGet looks up the keys in the same SST block together, and reads the
+    // blocks missed in block cache of all keys by one MultiRead, which is served in parallel
+    // by the file system, instead of a blocking Get for each key.
+    std::vector<rocksdb::PinnableSlice> pinned(num);
+    std::vector<rocksdb::Status> status(num);
+    db_->MultiGet(options, num, cfs.data(), slices.data(), pinned.data(), status.data());
+    values->resize(num);
     std::vector<Status> ret;
-    std::transform(status.begin(), status.end(), std::back_inserter(ret), [](const auto& s) {
+    ret.reserve(num);
+    for (size_t index = 0; index < num; index++) {
+        const auto& s = status[index];
         if (s.ok()) {
-            return Status::OK();
+            (*values)[index].assign(pinned[index].data(), pinned[index].size());
+            ret.emplace_back(Status::OK());
         } else if (s.IsNotFound()) {
-            return Status::KeyNotFound();
+            ret.emplace_back(Status::KeyNotFound());
         } else {
-            return Status::Error();
+            ret.emplace_back(Status::Error());
         }
-    });
+    }
     return ret;
 }
 
 nebula::cpp2::ErrorCode
 RocksEngine::range(const std::string& start,
                    const std::string& end,
-                   std::unique_ptr<KVIterator>* storageIter) {
+                   std::unique_ptr<KVIterator>* storageIter,
+                   ScanHint hint) {
     rocksdb::ReadOptions options;
     options.total_order_seek = true;
-    rocksdb::Iterator* iter = db_->NewIterator(options);
-    if (iter) {
-        iter->Seek(rocksdb::Slice(start));
-    }
-    storageIter->reset(new RocksRangeIter(iter, start, end));
+    setScanOptions(hint, options);
+    *storageIter = newRangeIter(options, start, end);
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
 nebula::cpp2::ErrorCode
 RocksEngine::prefix(const std::string& prefix,
-                    std::unique_ptr<KVIterator>* storageIter) {
+                    std::unique_ptr<KVIterator>* storageIter,
+                    ScanHint hint) {
     rocksdb::ReadOptions options;
-    options.prefix_same_as_start = true;
-    rocksdb::Iterator* iter = db_->NewIterator(options);
-    if (iter) {
-        iter->Seek(rocksdb::Slice(prefix));
-    }
-    storageIter->reset(new RocksPrefixIter(iter, prefix));
+    setPrefixSeekOptions(prefix, options);
+    setScanOptions(hint, options);
+    *storageIter = newPrefixIter(options, prefix, prefix);
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
 nebula::cpp2::ErrorCode
 RocksEngine::rangeWithPrefix(const std::string& start,
                              const std::string& prefix,
-                             std::unique_ptr<KVIterator>* storageIter) {
+                             std::unique_ptr<KVIterator>* storageIter,
+                             const void* snapshot,
+                             ScanHint hint) {
     rocksdb::ReadOptions options;
-    options.prefix_same_as_start = true;
-    rocksdb::Iterator* iter = db_->NewIterator(options);
-    if (iter) {
-        iter->Seek(rocksdb::Slice(start));
+    setPrefixSeekOptions(prefix, options);
+    setScanOptions(hint, options);
+    if (snapshot != nullptr) {
+        options.snapshot = reinterpret_cast<const rocksdb::Snapshot*>(snapshot);
+    }
+    *storageIter = newPrefixIter(options, start, prefix);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+bool RocksEngine::reusablePrefix(const std::string& prefix,
+                                 std::unique_ptr<KVIterator>* iter) {
+    auto upper = NebulaKeyUtils::prefixEnd(prefix);
+    auto cfs = columnFamilies(prefix);
+    if (prefix.empty() || upper.empty() || cfs.size() != 1) {
+        return false;
+    }
+    rocksdb::ReadOptions options;
+    setPrefixSeekOptions(prefix, options);
+    auto reusable = std::make_unique<RocksReusablePrefixIter>(
+        this, cfs[0], options.total_order_seek, prefix, std::move(upper));
+    options.iterate_upper_bound = reusable->upperBound();
+    reusable->start(db_->NewIterator(options, cfs[0]));
+    *iter = std::move(reusable);
+    return true;
+}
+
+bool RocksReusablePrefixIter::seek(const std::string& prefix) {
+    auto upper = NebulaKeyUtils::prefixEnd(prefix);
+    if (prefix.empty() || upper.empty() || iter_ == nullptr) {
+        return false;
+    }
+    // The options of the rocksdb iterator are fixed once created, the prefix must be in the
+    // same column family and seeked the same way
+    auto cfs = engine_->columnFamilies(prefix);
+    if (cfs.size() != 1 || cfs[0] != cf_ || engine_->totalOrderSeek(prefix) != totalOrderSeek_) {
+        return false;
+    }
+    prefix_ = prefix;
+    bound_.key_ = std::move(upper);
+    bound_.slice_ = rocksdb::Slice(bound_.key_);
+    iter_->Seek(prefix_);
+    return true;
+}
+
+// static
+void RocksEngine::setScanOptions(ScanHint hint, rocksdb::ReadOptions& options) {
+    if (hint == ScanHint::kFullScan) {
+        // the blocks read once are not worth evicting the hot ones in block cache
+        options.fill_cache = false;
+        options.readahead_size = FLAGS_rocksdb_scan_readahead_size * 1024;
+    }
+}
+
+void RocksEngine::setPrefixSeekOptions(const std::string& prefix,
+                                       rocksdb::ReadOptions& options) {
+    if (totalOrderSeek(prefix)) {
+        // The prefix is shorter than the prefix extractor, or not the key type it handles, the
+        // bloom filter can't be used. Seek in total order, RocksPrefixIter stops by the prefix.
+        options.total_order_seek = true;
+    } else {
+        options.prefix_same_as_start = true;
+    }
+}
+
+const void* RocksEngine::getSnapshot() {
+    return db_->GetSnapshot();
+}
+
+void RocksEngine::releaseSnapshot(const void* snapshot) {
+    if (snapshot != nullptr) {
+        db_->ReleaseSnapshot(reinterpret_cast<const rocksdb::Snapshot*>(snapshot));
     }
-    storageIter->reset(new RocksPrefixIter(iter, prefix));
+}
+
+nebula::cpp2::ErrorCode RocksEngine::estimateRange(const std::string& start,
+                                                   const std::string& end,
+                                                   int64_t* keys,
+                                                   std::vector<std::string>* splits) {
+    auto* cf = columnFamily(start);
+    rocksdb::Range range(start, end);
+    uint64_t size = 0;
+    db_->GetApproximateSizes(cf, &range, 1, &size);
+    uint64_t memKeys = 0;
+    uint64_t memSize = 0;
+    db_->GetApproximateMemTableStats(cf, range, &memKeys, &memSize);
+
+    rocksdb::TablePropertiesCollection properties;
+    auto status = db_->GetPropertiesOfTablesInRange(cf, &range, 1, &properties);
+    if (!status.ok()) {
+        LOG(ERROR) << "Get table properties failed: " << status.ToString();
+        return nebula::cpp2::ErrorCode::E_UNKNOWN;
+    }
+    uint64_t entries = 0;
+    uint64_t dataSize = 0;
+    for (const auto& prop : properties) {
+        entries += prop.second->num_entries;
+        dataSize += prop.second->data_size;
+    }
+    *keys = memKeys + (dataSize == 0 ? 0 : static_cast<int64_t>(
+                static_cast<double>(size) * entries / dataSize));
+
+    splits->clear();
+    std::vector<rocksdb::LiveFileMetaData> files;
+    db_->GetLiveFilesMetaData(&files);
+    for (const auto& file : files) {
+        if (file.column_family_name == cf->GetName() &&
+            file.smallestkey > start && file.smallestkey < end) {
+            splits->emplace_back(file.smallestkey);
+        }
+    }
+    std::sort(splits->begin(), splits->end());
+    splits->erase(std::unique(splits->begin(), splits->end()), splits->end());
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
@@ -247,7 +563,7 @@ nebula::cpp2::ErrorCode
 RocksEngine::put(std::string key, std::string value) {
     rocksdb::WriteOptions options;
     options.disableWAL = FLAGS_rocksdb_disable_wal;
-    rocksdb::Status status = db_->Put(options, key, value);
+    rocksdb::Status status = db_->Put(options, columnFamily(key), key, value);
     if (status.ok()) {
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     } else {
@@ -260,7 +576,7 @@ nebula::cpp2::ErrorCode
 RocksEngine::multiPut(std::vector<KV> keyValues) {
     rocksdb::WriteBatch updates(FLAGS_rocksdb_batch_size);
     for (size_t i = 0; i < keyValues.size(); i++) {
-        updates.Put(keyValues[i].first, keyValues[i].second);
+        updates.Put(columnFamily(keyValues[i].first), keyValues[i].first, keyValues[i].second);
     }
     rocksdb::WriteOptions options;
     options.disableWAL = FLAGS_rocksdb_disable_wal;
@@ -277,7 +593,7 @@ nebula::cpp2::ErrorCode
 RocksEngine::remove(const std::string& key) {
     rocksdb::WriteOptions options;
     options.disableWAL = FLAGS_rocksdb_disable_wal;
-    auto status = db_->Delete(options, key);
+    auto status = db_->Delete(options, columnFamily(key), key);
     if (status.ok()) {
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     } else {
@@ -290,7 +606,7 @@ nebula::cpp2::ErrorCode
 RocksEngine::multiRemove(std::vector<std::string> keys) {
     rocksdb::WriteBatch deletes(FLAGS_rocksdb_batch_size);
     for (size_t i = 0; i < keys.size(); i++) {
-        deletes.Delete(keys[i]);
+        deletes.Delete(columnFamily(keys[i]), keys[i]);
     }
     rocksdb::WriteOptions options;
     options.disableWAL = FLAGS_rocksdb_disable_wal;
@@ -307,13 +623,14 @@ nebula::cpp2::ErrorCode
 RocksEngine::removeRange(const std::string& start, const std::string& end) {
     rocksdb::WriteOptions options;
     options.disableWAL = FLAGS_rocksdb_disable_wal;
-    auto status = db_->DeleteRange(options, db_->DefaultColumnFamily(), start, end);
-    if (status.ok()) {
-        return nebula::cpp2::ErrorCode::SUCCEEDED;
-    } else {
-        VLOG(3) << "RemoveRange Failed: " << status.ToString();
-        return nebula::cpp2::ErrorCode::E_UNKNOWN;
+    for (auto* cf : columnFamilies(start, end)) {
+        auto status = db_->DeleteRange(options, cf, start, end);
+        if (!status.ok()) {
+            VLOG(3) << "RemoveRange Failed: " << status.ToString();
+            return nebula::cpp2::ErrorCode::E_UNKNOWN;
+        }
     }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
 std::string RocksEngine::partKey(PartitionID partId) {
@@ -321,7 +638,11 @@ std::string RocksEngine::partKey(PartitionID partId) {
 }
 
 void RocksEngine::addPart(PartitionID partId) {
-    auto ret = put(partKey(partId), "");
+    std::vector<KV> sysKeys;
+    sysKeys.emplace_back(partKey(partId), "");
+    sysKeys.emplace_back(NebulaKeyUtils::systemIndexEncodingKey(partId),
+                         IndexKeyUtils::indexEncoding());
+    auto ret = multiPut(std::move(sysKeys));
     if (ret == nebula::cpp2::ErrorCode::SUCCEEDED) {
         partsNum_++;
         CHECK_GE(partsNum_, 0);
@@ -334,11 +655,55 @@ void RocksEngine::removePart(PartitionID partId) {
     std::vector<std::string> sysKeysToDelete;
     sysKeysToDelete.emplace_back(partKey(partId));
     sysKeysToDelete.emplace_back(NebulaKeyUtils::systemCommitKey(partId));
+    sysKeysToDelete.emplace_back(NebulaKeyUtils::systemIndexEncodingKey(partId));
     auto code = multiRemove(sysKeysToDelete);
     if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
         partsNum_--;
         CHECK_GE(partsNum_, 0);
     }
+    // The system keys go first, so the part won't be loaded with its data partly removed.
+    code = removePartData(partId);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(WARNING) << "Remove the data of space " << spaceId_ << ", part " << partId
+                     << " failed, it would be left on disk";
+    }
+}
+
+nebula::cpp2::ErrorCode RocksEngine::removePartData(PartitionID partId) {
+    // The key starts with (partId << 8 | type) in little endian, so the keys of each type of a
+    // part are the ones with the 4 bytes prefix, which is a range ended by prefixEnd. Note the
+    // prefix of partId + 1 doesn't end it, its bytes are not ordered after the ones of partId.
+    // The SST files fully inside the ranges are deleted at once, and the rest are covered by
+    // the range tombstones, instead of waiting for the compaction to reclaim them key by key.
+    static const std::vector<NebulaKeyType> kDataTypes = {NebulaKeyType::kVertex,
+                                                          NebulaKeyType::kEdge,
+                                                          NebulaKeyType::kIndex,
+                                                          NebulaKeyType::kOperation,
+                                                          NebulaKeyType::kKeyValue,
+                                                          NebulaKeyType::kDegree};
+    auto prefixOf = [] (PartitionID part, NebulaKeyType type) {
+        PartitionID item = (part << kPartitionOffset) | static_cast<uint32_t>(type);
+        return std::string(reinterpret_cast<const char*>(&item), sizeof(PartitionID));
+    };
+    rocksdb::WriteOptions options;
+    options.disableWAL = FLAGS_rocksdb_disable_wal;
+    for (auto type : kDataTypes) {
+        auto start = prefixOf(partId, type);
+        auto end = NebulaKeyUtils::prefixEnd(start);
+        rocksdb::Slice begin(start), limit(end);
+        for (auto* cf : columnFamilies(start, end)) {
+            auto status = rocksdb::DeleteFilesInRange(db_.get(), cf, &begin, &limit);
+            if (status.ok()) {
+                status = db_->DeleteRange(options, cf, begin, limit);
+            }
+            if (!status.ok()) {
+                LOG(ERROR) << "Remove the data of part " << partId << " failed: "
+                           << status.ToString();
+                return nebula::cpp2::ErrorCode::E_UNKNOWN;
+            }
+        }
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
 std::vector<PartitionID> RocksEngine::allParts() {
@@ -376,7 +741,28 @@ nebula::cpp2::ErrorCode RocksEngine::ingest(const std::vector<std::string>& file
     rocksdb::IngestExternalFileOptions options;
     options.move_files = FLAGS_move_files;
     options.verify_file_checksum = verifyFileChecksum;
-    rocksdb::Status status = db_->IngestExternalFile(files, options);
+    rocksdb::Status status;
+    if (verifyFileChecksum && FLAGS_ingest_prepare_threads > 1 && files.size() > 1) {
+        // verify the blocks of the files in parallel, rather than one by one in the ingest
+        status = forEachFile(files.size(), [&](size_t i) {
+            return verifyFile(files[i]);
+        });
+    }
+    // The ingest fails rather than flushes if the files overlap the memtable, which is then
+    // flushed while the writes go on, at last the ingest flushes it with the writes stalled
+    for (int32_t i = 0; status.ok() && i <= FLAGS_ingest_flush_retry_times; i++) {
+        options.allow_blocking_flush = i == FLAGS_ingest_flush_retry_times;
+        status = cfHandles_.size() == 1
+               ? db_->IngestExternalFile(files, options)
+               : ingestByKeyType(files, options);
+        if (status.ok() || options.allow_blocking_flush || !status.IsInvalidArgument()) {
+            break;
+        }
+        VLOG(1) << "Flush before ingesting again: " << status.ToString();
+        rocksdb::FlushOptions flushOpts;
+        flushOpts.allow_write_stall = true;
+        status = db_->Flush(flushOpts, cfHandles_);
+    }
     if (status.ok()) {
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     } else {
@@ -385,18 +771,150 @@ nebula::cpp2::ErrorCode RocksEngine::ingest(const std::vector<std::string>& file
     }
 }
 
+rocksdb::Status RocksEngine::verifyFile(const std::string& file) {
+    rocksdb::Options sstOpts;
+    rocksdb::SstFileReader reader(sstOpts);
+    auto status = reader.Open(file);
+    return status.ok() ? reader.VerifyChecksum() : status;
+}
+
+rocksdb::Status RocksEngine::ingestByKeyType(const std::vector<std::string>& files,
+                                             rocksdb::IngestExternalFileOptions options) {
+    // The keys of all types are in the same SST file when it is generated, so copy the keys
+    // of each column family into a file of its own. The keys of a file are sorted, so are the
+    // keys of each split. The files are split in parallel, each into splits[file][family].
+    std::vector<std::vector<std::string>> splits(files.size(),
+                                                 std::vector<std::string>(cfHandles_.size()));
+    SCOPE_EXIT {
+        for (const auto& fileSplits : splits) {
+            for (const auto& split : fileSplits) {
+                // the file has been moved into db if succeeded
+                if (!split.empty()) {
+                    FileUtils::remove(split.c_str());
+                }
+            }
+        }
+    };
+    auto status = forEachFile(files.size(), [&](size_t i) {
+        return splitByKeyType(files[i], &splits[i]);
+    });
+    if (!status.ok()) {
+        return status;
+    }
+
+    // the split files are generated here, the checksum of the original files doesn't apply
+    options.move_files = true;
+    options.verify_file_checksum = false;
+    std::vector<rocksdb::IngestExternalFileArg> nonEmpty;
+    for (size_t family = 0; family < cfHandles_.size(); family++) {
+        rocksdb::IngestExternalFileArg arg;
+        for (const auto& fileSplits : splits) {
+            if (!fileSplits[family].empty()) {
+                arg.external_files.emplace_back(fileSplits[family]);
+            }
+        }
+        if (!arg.external_files.empty()) {
+            arg.column_family = cfHandles_[family];
+            arg.options = options;
+            nonEmpty.emplace_back(std::move(arg));
+        }
+    }
+    if (nonEmpty.empty()) {
+        return rocksdb::Status::OK();
+    }
+    return db_->IngestExternalFiles(nonEmpty);
+}
+
+rocksdb::Status RocksEngine::splitByKeyType(const std::string& file,
+                                            std::vector<std::string>* splits) {
+    rocksdb::Options sstOpts;
+    rocksdb::SstFileReader reader(sstOpts);
+    auto status = reader.Open(file);
+    if (!status.ok()) {
+        return status;
+    }
+    std::vector<std::unique_ptr<rocksdb::SstFileWriter>> writers(cfHandles_.size());
+    std::unique_ptr<rocksdb::Iterator> iter(reader.NewIterator(rocksdb::ReadOptions()));
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+        auto family = familyOf(folly::StringPiece(iter->key().data(), iter->key().size()));
+        auto& writer = writers[family];
+        if (writer == nullptr) {
+            auto split = folly::stringPrintf("%s.%s", file.c_str(), familyName(family));
+            writer = std::make_unique<rocksdb::SstFileWriter>(
+                rocksdb::EnvOptions(), db_->GetOptions(cfHandles_[family]));
+            status = writer->Open(split);
+            if (!status.ok()) {
+                return status;
+            }
+            (*splits)[family] = std::move(split);
+        }
+        status = writer->Put(iter->key(), iter->value());
+        if (!status.ok()) {
+            return status;
+        }
+    }
+    if (!iter->status().ok()) {
+        return iter->status();
+    }
+    for (auto& writer : writers) {
+        if (writer != nullptr) {
+            status = writer->Finish();
+            if (!status.ok()) {
+                return status;
+            }
+        }
+    }
+    return rocksdb::Status::OK();
+}
+
+// static
+rocksdb::Status RocksEngine::forEachFile(size_t num, std::function<rocksdb::Status(size_t)> fn) {
+    size_t threadsNum = std::min<size_t>(std::max(FLAGS_ingest_prepare_threads, 1), num);
+    if (threadsNum <= 1) {
+        for (size_t i = 0; i < num; i++) {
+            auto status = fn(i);
+            if (!status.ok()) {
+                return status;
+            }
+        }
+        return rocksdb::Status::OK();
+    }
+    std::atomic<size_t> next{0};
+    std::mutex lock;
+    rocksdb::Status result;
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < threadsNum; t++) {
+        threads.emplace_back([&] {
+            for (auto i = next++; i < num; i = next++) {
+                auto status = fn(i);
+                if (!status.ok()) {
+                    std::lock_guard<std::mutex> g(lock);
+                    result = status;
+                    // the files left are skipped
+                    next = num;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    return result;
+}
+
 nebula::cpp2::ErrorCode
 RocksEngine::setOption(const std::string& configKey, const std::string& configValue) {
     std::unordered_map<std::string, std::string> configOptions = {{configKey, configValue}};
 
-    rocksdb::Status status = db_->SetOptions(configOptions);
-    if (status.ok()) {
-        LOG(INFO) << "SetOption Succeeded: " << configKey << ":" << configValue;
-        return nebula::cpp2::ErrorCode::SUCCEEDED;
-    } else {
-        LOG(ERROR) << "SetOption Failed: " << configKey << ":" << configValue;
-        return nebula::cpp2::ErrorCode::E_INVALID_PARM;
+    for (auto* cf : cfHandles_) {
+        rocksdb::Status status = db_->SetOptions(cf, configOptions);
+        if (!status.ok()) {
+            LOG(ERROR) << "SetOption Failed: " << configKey << ":" << configValue;
+            return nebula::cpp2::ErrorCode::E_INVALID_PARM;
+        }
     }
+    LOG(INFO) << "SetOption Succeeded: " << configKey << ":" << configValue;
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
 nebula::cpp2::ErrorCode
@@ -417,18 +935,184 @@ nebula::cpp2::ErrorCode RocksEngine::compact() {
     rocksdb::CompactRangeOptions options;
     options.change_level = FLAGS_rocksdb_compact_change_level;
     options.target_level = FLAGS_rocksdb_compact_target_level;
-    rocksdb::Status status = db_->CompactRange(options, nullptr, nullptr);
-    if (status.ok()) {
+    for (auto* cf : cfHandles_) {
+        rocksdb::Status status = db_->CompactRange(options, cf, nullptr, nullptr);
+        if (!status.ok()) {
+            LOG(ERROR) << "CompactAll Failed: " << status.ToString();
+            return nebula::cpp2::ErrorCode::E_UNKNOWN;
+        }
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode RocksEngine::compactRange(const std::string& start,
+                                                  const std::string& end,
+                                                  int32_t level) {
+    if (!end.empty() && start >= end) {
         return nebula::cpp2::ErrorCode::SUCCEEDED;
-    } else {
-        LOG(ERROR) << "CompactAll Failed: " << status.ToString();
-        return nebula::cpp2::ErrorCode::E_UNKNOWN;
     }
+    rocksdb::Slice begin(start);
+    // the end of CompactRange is inclusive, compacting one more key does no harm
+    rocksdb::Slice last(end);
+    for (auto* cf : cfHandles_) {
+        if (level < 0) {
+            rocksdb::CompactRangeOptions options;
+            options.change_level = FLAGS_rocksdb_compact_change_level;
+            options.target_level = FLAGS_rocksdb_compact_target_level;
+            auto status = db_->CompactRange(options, cf, start.empty() ? nullptr : &begin,
+                                            end.empty() ? nullptr : &last);
+            if (!status.ok()) {
+                LOG(ERROR) << "CompactRange Failed: " << status.ToString();
+                return nebula::cpp2::ErrorCode::E_UNKNOWN;
+            }
+            continue;
+        }
+
+        rocksdb::ColumnFamilyMetaData meta;
+        db_->GetColumnFamilyMetaData(cf, &meta);
+        if (static_cast<size_t>(level) >= meta.levels.size()) {
+            continue;
+        }
+        std::vector<std::string> files;
+        for (const auto& file : meta.levels[level].files) {
+            if (!file.being_compacted && (end.empty() || file.smallestkey < end) &&
+                file.largestkey >= start) {
+                files.emplace_back(file.name);
+            }
+        }
+        if (files.empty()) {
+            continue;
+        }
+        auto outputLevel = std::min<int32_t>(level + 1, meta.levels.size() - 1);
+        LOG(INFO) << "Compact " << files.size() << " files of space " << spaceId_
+                  << " in level " << level << " into level " << outputLevel;
+        auto status = db_->CompactFiles(rocksdb::CompactionOptions(), cf, files, outputLevel);
+        if (!status.ok()) {
+            LOG(ERROR) << "Compact files failed: " << status.ToString();
+            return nebula::cpp2::ErrorCode::E_UNKNOWN;
+        }
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode RocksEngine::compactExpired() {
+    if (kvFilterFactory_ == nullptr) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    auto kvFilter = kvFilterFactory_->createKVFilter();
+    auto now = time::WallClock::fastNowInSec();
+    for (auto* cf : cfHandles_) {
+        rocksdb::TablePropertiesCollection properties;
+        auto status = db_->GetPropertiesOfAllTables(cf, &properties);
+        if (!status.ok()) {
+            LOG(ERROR) << "Get table properties failed: " << status.ToString();
+            return nebula::cpp2::ErrorCode::E_UNKNOWN;
+        }
+        rocksdb::ColumnFamilyMetaData meta;
+        db_->GetColumnFamilyMetaData(cf, &meta);
+        // The files in level 0 are compacted into level 1 soon, which records the properties
+        for (const auto& level : meta.levels) {
+            if (level.level == 0) {
+                continue;
+            }
+            std::vector<std::string> files;
+            for (const auto& file : level.files) {
+                if (file.being_compacted) {
+                    continue;
+                }
+                auto it = properties.find(file.db_path + file.name);
+                if (it != properties.end() &&
+                    KVTablePropertiesCollector::hasExpired(spaceId_,
+                                                           kvFilter.get(),
+                                                           it->second->user_collected_properties,
+                                                           now)) {
+                    files.emplace_back(file.name);
+                }
+            }
+            if (files.empty()) {
+                continue;
+            }
+            LOG(INFO) << "Compact " << files.size() << " files with expired data of space "
+                      << spaceId_ << " in level " << level.level;
+            // the files are compacted in chunks, so the disk is not busy with one large
+            // compaction of the dropped data for long
+            size_t chunk = FLAGS_compact_expired_max_files > 0
+                         ? FLAGS_compact_expired_max_files : files.size();
+            for (size_t i = 0; i < files.size(); i += chunk) {
+                std::vector<std::string> chunkFiles(
+                    files.begin() + i, files.begin() + std::min(i + chunk, files.size()));
+                status = db_->CompactFiles(
+                    rocksdb::CompactionOptions(), cf, chunkFiles, level.level);
+                if (!status.ok()) {
+                    // the files might be picked by other compactions meanwhile
+                    LOG(WARNING) << "Compact files failed: " << status.ToString();
+                }
+            }
+        }
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+int64_t RocksEngine::numLevel0Files() {
+    int64_t total = 0;
+    for (auto* cf : cfHandles_) {
+        uint64_t num = 0;
+        if (db_->GetIntProperty(cf, "rocksdb.num-files-at-level0", &num)) {
+            total += num;
+        }
+    }
+    return total;
+}
+
+double RocksEngine::writeStallPressure() {
+    double pressure = 0;
+    for (auto* cf : cfHandles_) {
+        auto options = db_->GetOptions(cf);
+        uint64_t num = 0;
+        if (options.level0_slowdown_writes_trigger > 0 &&
+            db_->GetIntProperty(cf, "rocksdb.num-files-at-level0", &num)) {
+            pressure = std::max(pressure,
+                                static_cast<double>(num) / options.level0_slowdown_writes_trigger);
+        }
+        uint64_t pending = 0;
+        if (options.soft_pending_compaction_bytes_limit > 0 &&
+            db_->GetIntProperty(cf, "rocksdb.estimate-pending-compaction-bytes", &pending)) {
+            pressure = std::max(pressure,
+                                static_cast<double>(pending) /
+                                    options.soft_pending_compaction_bytes_limit);
+        }
+    }
+    uint64_t delayedRate = 0;
+    uint64_t stopped = 0;
+    if ((db_->GetIntProperty("rocksdb.actual-delayed-write-rate", &delayedRate) &&
+         delayedRate > 0) ||
+        (db_->GetIntProperty("rocksdb.is-write-stopped", &stopped) && stopped > 0)) {
+        pressure = std::max(pressure, 1.0);
+    }
+    return pressure;
+}
+
+double RocksEngine::tombstoneRatio() {
+    uint64_t entries = 0;
+    uint64_t deletions = 0;
+    for (auto* cf : cfHandles_) {
+        rocksdb::TablePropertiesCollection properties;
+        auto status = db_->GetPropertiesOfAllTables(cf, &properties);
+        if (!status.ok()) {
+            LOG(ERROR) << "Get table properties failed: " << status.ToString();
+            continue;
+        }
+        for (const auto& prop : properties) {
+            entries += prop.second->num_entries;
+            deletions += prop.second->num_deletions + prop.second->num_range_deletions;
+        }
+    }
+    return entries == 0 ? 0.0 : static_cast<double>(deletions) / entries;
 }
 
 nebula::cpp2::ErrorCode RocksEngine::flush() {
     rocksdb::FlushOptions options;
-    rocksdb::Status status = db_->Flush(options);
+    rocksdb::Status status = db_->Flush(options, cfHandles_);
     if (status.ok()) {
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     } else {
@@ -12,16 +12,36 @@
 #include <rocksdb/utilities/checkpoint.h>
 #include <rocksdb/utilities/backupable_db.h>
 #include "common/base/Base.h"
+#include "kvstore/CompactionFilter.h"
 #include "kvstore/KVEngine.h"
 #include "kvstore/KVIterator.h"
+#include "utils/Types.h"
 
 namespace nebula {
 namespace kvstore {
 
+/**
+ * The iterate_upper_bound of ReadOptions is referred by the rocksdb iterator all along, so it
+ * is owned by the KVIterator wrapping the rocksdb iterator.
+ */
+struct RocksIterBound {
+    explicit RocksIterBound(std::string key)
+        : key_(std::move(key)), slice_(key_) {}
+
+    RocksIterBound(const RocksIterBound&) = delete;
+    RocksIterBound& operator=(const RocksIterBound&) = delete;
+
+    std::string key_;
+    rocksdb::Slice slice_;
+};
+
 class RocksRangeIter : public KVIterator {
 public:
-    RocksRangeIter(rocksdb::Iterator* iter, rocksdb::Slice start, rocksdb::Slice end)
-        : iter_(iter), start_(start), end_(end) {}
+    RocksRangeIter(rocksdb::Iterator* iter,
+                   rocksdb::Slice start,
+                   rocksdb::Slice end,
+                   std::unique_ptr<RocksIterBound> bound = nullptr)
+        : bound_(std::move(bound)), iter_(iter), start_(start), end_(end) {}
 
     ~RocksRangeIter() = default;
 
@@ -46,6 +66,8 @@ public:
     }
 
 private:
+    // destroyed after iter_
+    std::unique_ptr<RocksIterBound> bound_;
     std::unique_ptr<rocksdb::Iterator> iter_;
     rocksdb::Slice start_;
     rocksdb::Slice end_;
@@ -53,8 +75,10 @@ private:
 
 class RocksPrefixIter : public KVIterator {
 public:
-    RocksPrefixIter(rocksdb::Iterator* iter, rocksdb::Slice prefix)
-        : iter_(iter), prefix_(prefix) {}
+    RocksPrefixIter(rocksdb::Iterator* iter,
+                    rocksdb::Slice prefix,
+                    std::unique_ptr<RocksIterBound> bound = nullptr)
+        : bound_(std::move(bound)), iter_(iter), prefix_(prefix) {}
 
     ~RocksPrefixIter() = default;
 
@@ -79,10 +103,124 @@ public:
     }
 
 protected:
+    // destroyed after iter_
+    std::unique_ptr<RocksIterBound> bound_;
     std::unique_ptr<rocksdb::Iterator> iter_;
     rocksdb::Slice prefix_;
 };
 
+class RocksEngine;
+
+/**
+ * The prefix iterator of one column family which keeps its prefix and upper bound, so it could
+ * be moved to another prefix of the same column family and the same way of seek by seek. It is
+ * created by RocksEngine::reusablePrefix. The rocksdb iterator refers to the upper bound by the
+ * pointer, the bound is changed in place before the seek.
+ */
+class RocksReusablePrefixIter : public KVIterator {
+public:
+    RocksReusablePrefixIter(const RocksEngine* engine,
+                            rocksdb::ColumnFamilyHandle* cf,
+                            bool totalOrderSeek,
+                            std::string prefix,
+                            std::string upper)
+        : engine_(engine)
+        , cf_(cf)
+        , totalOrderSeek_(totalOrderSeek)
+        , prefix_(std::move(prefix))
+        , bound_(std::move(upper)) {}
+
+    const rocksdb::Slice* upperBound() const {
+        return &bound_.slice_;
+    }
+
+    // Take the rocksdb iterator created with upperBound, and seek the prefix
+    void start(rocksdb::Iterator* iter) {
+        iter_.reset(iter);
+        iter_->Seek(prefix_);
+    }
+
+    bool valid() const override {
+        return !!iter_ && iter_->Valid() && iter_->key().starts_with(prefix_);
+    }
+
+    void next() override {
+        iter_->Next();
+    }
+
+    void prev() override {
+        iter_->Prev();
+    }
+
+    folly::StringPiece key() const override {
+        return folly::StringPiece(iter_->key().data(), iter_->key().size());
+    }
+
+    folly::StringPiece val() const override {
+        return folly::StringPiece(iter_->value().data(), iter_->value().size());
+    }
+
+    bool seek(const std::string& prefix) override;
+
+private:
+    const RocksEngine*                  engine_;
+    rocksdb::ColumnFamilyHandle*        cf_;
+    const bool                          totalOrderSeek_;
+    std::string                         prefix_;
+    // destroyed after iter_
+    RocksIterBound                      bound_;
+    std::unique_ptr<rocksdb::Iterator>  iter_;
+};
+
+/**
+ * Iterate the iterators of several column families as one in the key order, which is used when
+ * the keys of a range or prefix could be in more than one column family.
+ */
+class RocksMergeIter : public KVIterator {
+public:
+    explicit RocksMergeIter(std::vector<std::unique_ptr<KVIterator>> iters)
+        : iters_(std::move(iters)) {
+        pick();
+    }
+
+    ~RocksMergeIter() = default;
+
+    bool valid() const override {
+        return curr_ != nullptr;
+    }
+
+    void next() override {
+        curr_->next();
+        pick();
+    }
+
+    void prev() override {
+        LOG(FATAL) << "RocksMergeIter does not support prev";
+    }
+
+    folly::StringPiece key() const override {
+        return curr_->key();
+    }
+
+    folly::StringPiece val() const override {
+        return curr_->val();
+    }
+
+private:
+    // The keys of different column families never overlap, just pick the smallest one
+    void pick() {
+        curr_ = nullptr;
+        for (auto& iter : iters_) {
+            if (iter->valid() && (curr_ == nullptr || iter->key() < curr_->key())) {
+                curr_ = iter.get();
+            }
+        }
+    }
+
+    std::vector<std::unique_ptr<KVIterator>> iters_;
+    KVIterator* curr_{nullptr};
+};
+
 /**************************************************************************
  *
  * An implementation of KVEngine based on Rocksdb
@@ -101,6 +239,10 @@ public:
                 bool readonly = false);
 
     ~RocksEngine() {
+        // the default column family handle is owned by db
+        for (size_t i = 1; i < cfHandles_.size(); i++) {
+            db_->DestroyColumnFamilyHandle(cfHandles_[i]);
+        }
         LOG(INFO) << "Release rocksdb on " << dataPath_;
     }
 
@@ -135,15 +277,36 @@ public:
     nebula::cpp2::ErrorCode
     range(const std::string& start,
           const std::string& end,
-          std::unique_ptr<KVIterator>* iter) override;
+          std::unique_ptr<KVIterator>* iter,
+          ScanHint hint = ScanHint::kDefault) override;
 
     nebula::cpp2::ErrorCode
-    prefix(const std::string& prefix, std::unique_ptr<KVIterator>* iter) override;
+    prefix(const std::string& prefix,
+           std::unique_ptr<KVIterator>* iter,
+           ScanHint hint = ScanHint::kDefault) override;
 
     nebula::cpp2::ErrorCode
     rangeWithPrefix(const std::string& start,
                     const std::string& prefix,
-                    std::unique_ptr<KVIterator>* iter) override;
+                    std::unique_ptr<KVIterator>* iter,
+                    const void* snapshot = nullptr,
+                    ScanHint hint = ScanHint::kDefault) override;
+
+    // Not supported if the keys with the prefix could be in several column families, or there
+    // is no upper bound of the prefix
+    bool reusablePrefix(const std::string& prefix, std::unique_ptr<KVIterator>* iter) override;
+
+    const void* getSnapshot() override;
+
+    void releaseSnapshot(const void* snapshot) override;
+
+    // The keys in the SST files are estimated by the approximate size of the range over the
+    // average size of the entries in the table properties, the ones in the memtables are
+    // counted by the memtable stats. The splits are the smallest keys of the SST files.
+    nebula::cpp2::ErrorCode estimateRange(const std::string& start,
+                                          const std::string& end,
+                                          int64_t* keys,
+                                          std::vector<std::string>* splits) override;
 
     /*********************
      * Data modification
@@ -173,6 +336,13 @@ public:
     nebula::cpp2::ErrorCode ingest(const std::vector<std::string>& files,
                                    bool verifyFileChecksum = false) override;
 
+    rocksdb::Options sstOptions() override {
+        return db_->GetOptions();
+    }
+
+    // Verify the checksums of all blocks of the SST file
+    static rocksdb::Status verifyFile(const std::string& file);
+
     nebula::cpp2::ErrorCode
     setOption(const std::string& configKey, const std::string& configValue) override;
 
@@ -181,6 +351,27 @@ public:
 
     nebula::cpp2::ErrorCode compact() override;
 
+    nebula::cpp2::ErrorCode compactRange(const std::string& start,
+                                         const std::string& end,
+                                         int32_t level) override;
+
+    // Only the files whose properties show they have expired or dropped data are compacted by
+    // the compaction filter, each into its own level. It works with
+    // rocksdb_compact_expired_files, which records the properties.
+    nebula::cpp2::ErrorCode compactExpired() override;
+
+    // The number of files in level 0 of all column families, used by CompactionScheduler
+    int64_t numLevel0Files();
+
+    // The ratio of deletions in all SST files, used by CompactionScheduler
+    double tombstoneRatio();
+
+    // How close the writes are to being slowed down by rocksdb, the max of level 0 files over
+    // level0_slowdown_writes_trigger and pending compaction bytes over
+    // soft_pending_compaction_bytes_limit of all column families. It is at least 1.0 once the
+    // writes are delayed or stopped.
+    double writeStallPressure();
+
     nebula::cpp2::ErrorCode flush() override;
 
     nebula::cpp2::ErrorCode backup() override;
@@ -195,19 +386,115 @@ public:
                 const std::string& tablePrefix,
                 std::function<bool(const folly::StringPiece& key)> filter) override;
 
+    /*********************
+     * Column families
+     ********************/
+    // Return the column family of the key. If the space is created with
+    // rocksdb_column_family_per_key_type, the edges and the indexes are in their own column
+    // families, otherwise all keys are in the default one.
+    rocksdb::ColumnFamilyHandle* columnFamily(folly::StringPiece key) const {
+        return cfHandles_.size() == 1 ? cfHandles_[0] : cfHandles_[familyOf(key)];
+    }
+
+    // Return the column families the keys in [start, end) could be in
+    std::vector<rocksdb::ColumnFamilyHandle*>
+    columnFamilies(folly::StringPiece start, folly::StringPiece end) const;
+
+    // Return the column families the keys with the prefix could be in
+    std::vector<rocksdb::ColumnFamilyHandle*> columnFamilies(folly::StringPiece prefix) const;
+
+    // Whether the prefix is seeked in total order, instead of by the prefix extractor
+    bool totalOrderSeek(folly::StringPiece prefix) const {
+        return prefixExtractor_ != nullptr &&
+               !prefixExtractor_->InDomain(rocksdb::Slice(prefix.data(), prefix.size()));
+    }
+
+private:
+    enum Family : size_t {
+        kDefaultFamily = 0,
+        kEdgeFamily,
+        kIndexFamily,
+        kNumFamilies,
+    };
+
+    static const char* familyName(size_t family);
+
+    // The first byte of a key is its NebulaKeyType
+    static size_t familyOf(folly::StringPiece key) {
+        if (key.empty()) {
+            return kDefaultFamily;
+        }
+        switch (static_cast<NebulaKeyType>(static_cast<uint8_t>(key[0]))) {
+            case NebulaKeyType::kEdge:
+                return kEdgeFamily;
+            case NebulaKeyType::kIndex:
+                return kIndexFamily;
+            default:
+                return kDefaultFamily;
+        }
+    }
+
+    // Open the db with a column family for each key type if it is created by this means
+    rocksdb::Status openByKeyType(const rocksdb::Options& options,
+                                  const std::string& path,
+                                  bool readonly,
+                                  rocksdb::DB** db);
+
+    // Split the SST files by column family and ingest them all at once
+    rocksdb::Status ingestByKeyType(const std::vector<std::string>& files,
+                                    rocksdb::IngestExternalFileOptions options);
+
+    // Split the keys of the file into a file of each column family, the split of a family
+    // without any keys is left empty
+    rocksdb::Status splitByKeyType(const std::string& file, std::vector<std::string>* splits);
+
+    // Call fn for each of the files by ingest_prepare_threads threads, return an error of them
+    static rocksdb::Status forEachFile(size_t num, std::function<rocksdb::Status(size_t)> fn);
+
+    std::unique_ptr<KVIterator> newRangeIter(rocksdb::ReadOptions options,
+                                             const std::string& start,
+                                             const std::string& end);
+
+    // Sync the WAL after the write, the concurrent writes before the sync share it
+    rocksdb::Status groupSyncWal();
+
+    std::unique_ptr<KVIterator> newPrefixIter(rocksdb::ReadOptions options,
+                                              const std::string& start,
+                                              const std::string& prefix);
+
 private:
     std::string partKey(PartitionID partId);
 
+    // Drop the vertices, edges, indexes, operations and kvs of the part
+    nebula::cpp2::ErrorCode removePartData(PartitionID partId);
+
     void openBackupEngine(GraphSpaceID spaceId);
 
+    // Use the prefix bloom filter only if the prefix is in domain of prefix extractor
+    void setPrefixSeekOptions(const std::string& prefix, rocksdb::ReadOptions& options);
+
+    static void setScanOptions(ScanHint hint, rocksdb::ReadOptions& options);
+
 private:
     GraphSpaceID spaceId_;
     std::string dataPath_;
     std::string walPath_;
     std::unique_ptr<rocksdb::DB> db_{nullptr};
+    // indexed by Family if keys are split by key type, otherwise only the default one
+    std::vector<rocksdb::ColumnFamilyHandle*> cfHandles_;
+    std::shared_ptr<const rocksdb::SliceTransform> prefixExtractor_{nullptr};
+    // the filter factory of the space, if the properties of expired data are recorded
+    std::shared_ptr<KVCompactionFilterFactory> kvFilterFactory_{nullptr};
     std::string backupPath_;
     std::unique_ptr<rocksdb::BackupEngine> backupDb_{nullptr};
     int32_t partsNum_ = -1;
+
+    // the writes waiting for the WAL sync, and the ones synced
+    std::mutex syncLock_;
+    std::condition_variable syncCond_;
+    uint64_t writesToSync_{0};
+    uint64_t writesSynced_{0};
+    bool syncing_{false};
 };
 
 }   // namespace kvstore
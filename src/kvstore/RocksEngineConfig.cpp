@@ -17,6 +17,7 @@
 #include <rocksdb/filter_policy.h>
 #include <rocksdb/concurrent_task_limiter.h>
 #include <rocksdb/rate_limiter.h>
+#include <rocksdb/utilities/table_properties_collectors.h>
 #include "utils/NebulaKeyUtils.h"
 
 // [WAL]
@@ -28,6 +29,12 @@ DEFINE_bool(rocksdb_wal_sync,
             false,
             "Whether WAL writes are synchronized to disk or not");
 
+DEFINE_bool(rocksdb_group_wal_sync,
+            false,
+            "When rocksdb_wal_sync is true, whether the concurrent writes of an engine share "
+            "one WAL sync instead of a sync for each write. The data written could be read "
+            "before the sync is done");
+
 // [DBOptions]
 DEFINE_string(rocksdb_db_options,
               "{}",
@@ -38,6 +45,21 @@ DEFINE_string(rocksdb_column_family_options,
               "{}",
               "json string of ColumnFamilyOptions, all keys and values are string");
 
+DEFINE_bool(rocksdb_column_family_per_key_type, false,
+            "Whether to put the edges and the indexes of a new space into their own column "
+            "families, apart from the vertices and the others. A space keeps the column "
+            "families it is created with");
+
+DEFINE_string(rocksdb_edge_column_family_options,
+              "{}",
+              "json string of ColumnFamilyOptions of the edge column family, which overrides "
+              "rocksdb_column_family_options");
+
+DEFINE_string(rocksdb_index_column_family_options,
+              "{}",
+              "json string of ColumnFamilyOptions of the index column family, which overrides "
+              "rocksdb_column_family_options");
+
 //  [TableOptions/BlockBasedTable "default"]
 DEFINE_string(rocksdb_block_based_table_options,
               "{}",
@@ -55,6 +77,18 @@ DEFINE_int32(rocksdb_batch_size,
 DEFINE_int64(rocksdb_block_cache, 1024,
              "The default block cache size used in BlockBasedTable. The unit is MB");
 
+DEFINE_double(rocksdb_block_cache_high_pri_pool_ratio, 0.0,
+              "Ratio of the block cache reserved for the high priority blocks, which are the "
+              "index and filter blocks when enable_partitioned_index_filter is true");
+
+DEFINE_string(rocksdb_space_block_cache, "",
+              "Comma separated spaceId:MB pairs, each space listed has a block cache of its own "
+              "of the given size, the other spaces share the one of rocksdb_block_cache");
+
+DEFINE_int32(rocksdb_scan_readahead_size, 2048,
+             "Readahead size in KB of the iterators of full scan, e.g. scan vertex/edge and "
+             "the admin tasks, 0 means the auto readahead of rocksdb");
+
 DEFINE_bool(enable_partitioned_index_filter, false, "True for partitioned index filters");
 
 DEFINE_string(rocksdb_compression, "snappy", "Compression algorithm used by RocksDB, "
@@ -64,9 +98,19 @@ DEFINE_string(rocksdb_compression_per_level, "", "Specify per level compression
                                                  "replaced by FLAGS_rocksdb_compression. "
                                                  "e.g. \"no:no:lz4:lz4::zstd\" === "
                                                  "\"no:no:lz4:lz4:lz4:snappy:zstd:snappy\"");
+DEFINE_int32(rocksdb_compression_dict_bytes, 0,
+             "The max size in KB of the dictionary built for each SST file, which is shared by "
+             "all blocks of it, so the repeated strings in rows are compressed across blocks. "
+             "0 means no dictionary. It works with lz4, zstd and zlib");
+DEFINE_int32(rocksdb_compression_dict_train_bytes, 0,
+             "The max size in KB of the samples to train the dictionary, only used by zstd. "
+             "0 means the samples are used as the dictionary directly");
 
 DEFINE_bool(enable_rocksdb_statistics, false, "Whether or not to enable rocksdb's statistics");
 DEFINE_string(rocksdb_stats_level, "kExceptHistogramOrTimers", "rocksdb statistics level");
+DEFINE_bool(enable_rocksdb_event_stats, false,
+            "Whether to count the flushes, compactions, write stalls and ingests of each space "
+            "and column family by the rocksdb events");
 
 DEFINE_int32(num_compaction_threads, 0,
             "Number of total compaction threads. 0 means unlimited.");
@@ -74,11 +118,44 @@ DEFINE_int32(num_compaction_threads, 0,
 DEFINE_int32(rate_limit, 0,
             "write limit in bytes per sec. The unit is MB. 0 means unlimited.");
 
+DEFINE_bool(enable_load_aware_compaction, false,
+            "Whether to slow down the compactions when the storage is busy, and compact the "
+            "engines with most level 0 files or tombstones when it is idle");
+
+DEFINE_int32(compaction_busy_queue_depth, 64,
+             "The storage is busy if the number of requests waiting for the workers reaches it, "
+             "and idle if it is below half of it");
+
+DEFINE_int32(compaction_busy_threads, 1,
+             "The max number of compactions at the same time when the storage is busy, "
+             "0 means pausing the compactions");
+
+DEFINE_int32(compaction_busy_rate_limit, 0,
+             "The write limit of flush and compaction in MB per sec when the storage is busy, "
+             "0 means rate_limit");
+
+DEFINE_int32(compaction_scheduler_interval_ms, 1000,
+             "The interval to check whether the storage is busy");
+
+DEFINE_int32(compaction_catch_up_interval_secs, 600,
+             "The interval to compact an engine when the storage is idle");
+
+DEFINE_int32(compaction_catch_up_level0_files, 8,
+             "An engine is compacted when the storage is idle, if it has so many level 0 files");
+
+DEFINE_double(compaction_catch_up_tombstone_ratio, 0.3,
+              "An engine is compacted when the storage is idle, if so many of its entries are "
+              "deletions");
+
 DEFINE_bool(enable_rocksdb_prefix_filtering, false,
             "Whether or not to enable rocksdb's prefix bloom filter.");
 DEFINE_bool(rocksdb_prefix_bloom_filter_length_flag, false,
             "If true, prefix bloom filter will be sizeof(PartitionID) + vidLen + sizeof(EdgeType). "
             "If false, prefix bloom filter will be sizeof(PartitionID) + vidLen. ");
+DEFINE_int32(rocksdb_index_prefix_bloom_filter_length, 0,
+             "Bytes of index values covered by prefix bloom filter, the prefix of index key will "
+             "be sizeof(PartitionID) + sizeof(IndexID) + this length. "
+             "0 means index keys are not in the prefix bloom filter.");
 DEFINE_bool(enable_rocksdb_whole_key_filtering, true,
             "Whether or not to enable the whole key filtering.");
 
@@ -97,6 +174,15 @@ DEFINE_string(rocksdb_table_format,
 
 DEFINE_string(rocksdb_wal_dir, "", "Rocksdb wal directory");
 
+DEFINE_string(rocksdb_cold_data_paths, "",
+              "Comma separated data_path=cold_path pairs, e.g. /nvme/data=/hdd/data. The newer "
+              "SST files of a space stay in the data path up to rocksdb_hot_data_target_size_gb, "
+              "the older levels are placed in its cold path");
+
+DEFINE_int32(rocksdb_hot_data_target_size_gb, 0,
+             "Target size in GB of the SST files of each space kept in the data path when it "
+             "has a cold path, 0 means the cold path is not used");
+
 DEFINE_string(rocksdb_backup_dir, "", "Rocksdb backup directory, only used in PlainTable format");
 
 DEFINE_int32(rocksdb_backup_interval_secs, 300,
@@ -110,33 +196,73 @@ DEFINE_int32(rocksdb_memtable_hash_bucket_count,
              1024 * 1024,
              "Bucket count of Rocksdb HashSkiplist memtable");
 
+DEFINE_int32(rocksdb_compact_on_deletion_window, 0,
+             "The sliding window of entries in which the SST file is marked to be compacted if "
+             "there are rocksdb_compact_on_deletion_trigger deletions, 0 means disabled");
+
+DEFINE_int32(rocksdb_compact_on_deletion_trigger, 0,
+             "The number of deletions in the sliding window to mark the SST file to be compacted");
+
+DEFINE_bool(rocksdb_compact_expired_files, false,
+            "Whether to record the schemas and ttl of data in the properties of SST files, and "
+            "only compact the files holding expired or dropped data by the compaction filter "
+            "each custom_filter_interval_secs, instead of filtering in the minor compactions");
+
 namespace nebula {
 namespace kvstore {
 
+/**
+ * The prefix of vertex and edge key is partId + vid (+ edgeType), and the prefix of index key
+ * is partId + indexId + the first `indexPrefixLen - 8` bytes of index values, so that both the
+ * prefix scan of vertex/edge and the equality probe on the leading columns of index could be
+ * filtered by the bloom filter. If indexPrefixLen is 0, index keys are not in domain.
+ */
 class GraphPrefixTransform : public rocksdb::SliceTransform {
 private:
     size_t prefixLen_;
+    size_t indexPrefixLen_;
     std::string name_;
 
 public:
-    explicit GraphPrefixTransform(size_t prefixLen)
-        : prefixLen_(prefixLen), name_("nebula.GraphPrefix." + std::to_string(prefixLen_)) {}
+    explicit GraphPrefixTransform(size_t prefixLen, size_t indexPrefixLen = 0)
+        : prefixLen_(prefixLen)
+        , indexPrefixLen_(indexPrefixLen)
+        , name_("nebula.GraphPrefix." + std::to_string(prefixLen_)) {
+        // keep the name of old version if index is not in domain, so the filters built before
+        // are still valid
+        if (indexPrefixLen_ > 0) {
+            name_.append(".").append(std::to_string(indexPrefixLen_));
+        }
+    }
 
     const char* Name() const override { return name_.c_str(); }
 
     rocksdb::Slice Transform(const rocksdb::Slice& src) const override {
-        return rocksdb::Slice(src.data(), prefixLen_);
+        return rocksdb::Slice(src.data(), isIndex(src) ? indexPrefixLen_ : prefixLen_);
     }
 
     bool InDomain(const rocksdb::Slice& key) const override {
-        if (key.size() < prefixLen_) {
+        if (key.size() < sizeof(NebulaKeyType)) {
             return false;
         }
         // And we should not use NebulaKeyUtils::isVertex or isEdge here, because it will regard the
         // prefix itself not in domain since its length does not satisfy
+        auto type = keyType(key);
+        if (type == NebulaKeyType::kEdge || type == NebulaKeyType::kVertex) {
+            return key.size() >= prefixLen_;
+        }
+        return type == NebulaKeyType::kIndex && indexPrefixLen_ > 0 &&
+               key.size() >= indexPrefixLen_;
+    }
+
+private:
+    static NebulaKeyType keyType(const rocksdb::Slice& key) {
         constexpr int32_t len = static_cast<int32_t>(sizeof(NebulaKeyType));
-        auto type = static_cast<NebulaKeyType>(readInt<uint32_t>(key.data(), len) & kTypeMask);
-        return type == NebulaKeyType::kEdge || type == NebulaKeyType::kVertex;
+        return static_cast<NebulaKeyType>(readInt<uint32_t>(key.data(), len) & kTypeMask);
+    }
+
+    static bool isIndex(const rocksdb::Slice& key) {
+        return key.size() >= sizeof(NebulaKeyType) && keyType(key) == NebulaKeyType::kIndex;
     }
 };
 
@@ -186,6 +312,94 @@ static rocksdb::Status initRocksdbCompression(rocksdb::Options &baseOpts) {
     return rocksdb::Status::OK();
 }
 
+static void initRocksdbCompressionDict(rocksdb::Options &baseOpts) {
+    if (FLAGS_rocksdb_compression_dict_bytes <= 0) {
+        return;
+    }
+    // The dictionary is sampled from the data of the SST file being written, the low
+    // cardinality strings of the rows, such as country or status, are likely in it
+    baseOpts.compression_opts.max_dict_bytes = FLAGS_rocksdb_compression_dict_bytes * 1024;
+    if (FLAGS_rocksdb_compression_dict_train_bytes > 0) {
+        baseOpts.compression_opts.zstd_max_train_bytes =
+            FLAGS_rocksdb_compression_dict_train_bytes * 1024;
+    }
+    LOG(INFO) << "compression dictionary size " << FLAGS_rocksdb_compression_dict_bytes
+              << "KB, train size " << FLAGS_rocksdb_compression_dict_train_bytes << "KB";
+}
+
+static std::shared_ptr<rocksdb::Cache> newBlockCache(int64_t capacityMB) {
+    return rocksdb::NewLRUCache(capacityMB * 1024 * 1024,
+                                8/*shard bits*/,
+                                false/*strict capacity limit*/,
+                                FLAGS_rocksdb_block_cache_high_pri_pool_ratio);
+}
+
+std::shared_ptr<rocksdb::Cache> getBlockCache(GraphSpaceID spaceId) {
+    static std::shared_ptr<rocksdb::Cache> sharedCache = newBlockCache(FLAGS_rocksdb_block_cache);
+    static std::mutex lock;
+    static std::unordered_map<GraphSpaceID, std::shared_ptr<rocksdb::Cache>> spaceCaches;
+
+    std::vector<std::string> pairs;
+    folly::split(",", FLAGS_rocksdb_space_block_cache, pairs, true);
+    for (const auto& pair : pairs) {
+        std::vector<folly::StringPiece> fields;
+        folly::split(":", pair, fields, true);
+        if (fields.size() != 2) {
+            LOG(WARNING) << "Illegal rocksdb_space_block_cache " << pair;
+            continue;
+        }
+        auto id = folly::tryTo<GraphSpaceID>(folly::trimWhitespace(fields[0]));
+        auto capacityMB = folly::tryTo<int64_t>(folly::trimWhitespace(fields[1]));
+        if (!id.hasValue() || !capacityMB.hasValue() || capacityMB.value() <= 0) {
+            LOG(WARNING) << "Illegal rocksdb_space_block_cache " << pair;
+            continue;
+        }
+        if (id.value() != spaceId) {
+            continue;
+        }
+        std::lock_guard<std::mutex> guard(lock);
+        auto& cache = spaceCaches[spaceId];
+        if (cache == nullptr) {
+            LOG(INFO) << "Space " << spaceId << " has a block cache of "
+                      << capacityMB.value() << "MB";
+            cache = newBlockCache(capacityMB.value());
+        }
+        return cache;
+    }
+    return sharedCache;
+}
+
+std::shared_ptr<rocksdb::ConcurrentTaskLimiter> getCompactionThreadLimiter() {
+    static std::shared_ptr<rocksdb::ConcurrentTaskLimiter> limiter =
+        FLAGS_num_compaction_threads > 0 || FLAGS_enable_load_aware_compaction
+            ? std::shared_ptr<rocksdb::ConcurrentTaskLimiter>(
+                  rocksdb::NewConcurrentTaskLimiter("compaction",
+                                                    compactionThreadsLimit()))
+            : nullptr;
+    return limiter;
+}
+
+int32_t compactionThreadsLimit() {
+    // negative means unlimited
+    return FLAGS_num_compaction_threads > 0 ? FLAGS_num_compaction_threads : -1;
+}
+
+std::shared_ptr<rocksdb::RateLimiter> getRateLimiter() {
+    static std::shared_ptr<rocksdb::RateLimiter> limiter =
+        FLAGS_rate_limit > 0 ||
+        (FLAGS_enable_load_aware_compaction && FLAGS_compaction_busy_rate_limit > 0)
+            ? std::shared_ptr<rocksdb::RateLimiter>(
+                  rocksdb::NewGenericRateLimiter(rateLimitBytesPerSec()))
+            : nullptr;
+    return limiter;
+}
+
+int64_t rateLimitBytesPerSec() {
+    // the rate limiter is only created for the busy time, it is almost unlimited otherwise
+    return FLAGS_rate_limit > 0 ? FLAGS_rate_limit * 1024L * 1024L
+                                : 1024L * 1024L * 1024L * 1024L;
+}
+
 rocksdb::Status initRocksdbOptions(rocksdb::Options& baseOpts,
                                    GraphSpaceID spaceId,
                                    int32_t vidLen) {
@@ -208,7 +422,7 @@ rocksdb::Status initRocksdbOptions(rocksdb::Options& baseOpts,
         dbOpts.statistics = std::move(stats);
         dbOpts.stats_dump_period_sec = 0;  // exposing statistics ourself
     }
-    dbOpts.listeners.emplace_back(new EventListener());
+    dbOpts.listeners.emplace_back(new EventListener(spaceId));
 
     // if rocksdb_wal_dir is set, specify it to rocksdb
     if (!FLAGS_rocksdb_wal_dir.empty()) {
@@ -239,17 +453,10 @@ rocksdb::Status initRocksdbOptions(rocksdb::Options& baseOpts,
     if (!s.ok()) {
         return s;
     }
+    initRocksdbCompressionDict(baseOpts);
 
-    if (FLAGS_num_compaction_threads > 0) {
-        static std::shared_ptr<rocksdb::ConcurrentTaskLimiter> compaction_thread_limiter{
-            rocksdb::NewConcurrentTaskLimiter("compaction", FLAGS_num_compaction_threads)};
-        baseOpts.compaction_thread_limiter = compaction_thread_limiter;
-    }
-    if (FLAGS_rate_limit > 0) {
-        static std::shared_ptr<rocksdb::RateLimiter> rate_limiter{
-            rocksdb::NewGenericRateLimiter(FLAGS_rate_limit * 1024 * 1024)};
-        baseOpts.rate_limiter = rate_limiter;
-    }
+    baseOpts.compaction_thread_limiter = getCompactionThreadLimiter();
+    baseOpts.rate_limiter = getRateLimiter();
 
     size_t prefixLength = FLAGS_rocksdb_prefix_bloom_filter_length_flag
                               ? sizeof(PartitionID) + vidLen + sizeof(EdgeType)
@@ -269,9 +476,7 @@ rocksdb::Status initRocksdbOptions(rocksdb::Options& baseOpts,
         if (FLAGS_rocksdb_block_cache <= 0) {
             bbtOpts.no_block_cache = true;
         } else {
-            static std::shared_ptr<rocksdb::Cache> blockCache
-                = rocksdb::NewLRUCache(FLAGS_rocksdb_block_cache * 1024 * 1024, 8/*shard bits*/);
-            bbtOpts.block_cache = blockCache;
+            bbtOpts.block_cache = getBlockCache(spaceId);
         }
 
         bbtOpts.filter_policy.reset(rocksdb::NewBloomFilterPolicy(10, false));
@@ -285,7 +490,12 @@ rocksdb::Status initRocksdbOptions(rocksdb::Options& baseOpts,
                 baseOpts.compaction_style == rocksdb::CompactionStyle::kCompactionStyleLevel;
         }
         if (FLAGS_enable_rocksdb_prefix_filtering) {
-            baseOpts.prefix_extractor.reset(new GraphPrefixTransform(prefixLength));
+            size_t indexPrefixLength = FLAGS_rocksdb_index_prefix_bloom_filter_length > 0
+                ? sizeof(PartitionID) + sizeof(IndexID) +
+                  FLAGS_rocksdb_index_prefix_bloom_filter_length
+                : 0;
+            baseOpts.prefix_extractor.reset(
+                new GraphPrefixTransform(prefixLength, indexPrefixLength));
         }
         bbtOpts.whole_key_filtering = FLAGS_enable_rocksdb_whole_key_filtering;
         baseOpts.table_factory.reset(NewBlockBasedTableFactory(bbtOpts));
@@ -314,9 +524,76 @@ rocksdb::Status initRocksdbOptions(rocksdb::Options& baseOpts,
         return rocksdb::Status::NotSupported("Illegal memtable format");
     }
 
+    // The files with many tombstones, e.g. left by deleting vertices and their indexes, are
+    // compacted soon, rather than slowing down the scans over them until compacted by size
+    if (FLAGS_rocksdb_compact_on_deletion_window > 0 &&
+        FLAGS_rocksdb_compact_on_deletion_trigger > 0) {
+        baseOpts.table_properties_collector_factories.emplace_back(
+            rocksdb::NewCompactOnDeletionCollectorFactory(
+                FLAGS_rocksdb_compact_on_deletion_window,
+                FLAGS_rocksdb_compact_on_deletion_trigger));
+    }
+
     return s;
 }
 
+rocksdb::Status coldDataPath(const std::string& dataPath, std::string* coldPath) {
+    coldPath->clear();
+    std::vector<std::string> pairs;
+    folly::split(",", FLAGS_rocksdb_cold_data_paths, pairs, true);
+    for (const auto& pair : pairs) {
+        std::vector<std::string> paths;
+        folly::split("=", pair, paths, true);
+        if (paths.size() != 2) {
+            return rocksdb::Status::InvalidArgument("Illegal rocksdb_cold_data_paths", pair);
+        }
+        if (folly::trimWhitespace(paths[0]) == dataPath) {
+            *coldPath = folly::trimWhitespace(paths[1]).str();
+            break;
+        }
+    }
+    return rocksdb::Status::OK();
+}
+
+rocksdb::Status initRocksdbDbPaths(rocksdb::Options& baseOpts,
+                                   const std::string& dataPath,
+                                   GraphSpaceID spaceId) {
+    if (FLAGS_rocksdb_cold_data_paths.empty() || FLAGS_rocksdb_hot_data_target_size_gb <= 0) {
+        return rocksdb::Status::OK();
+    }
+    std::string coldRoot;
+    auto status = coldDataPath(dataPath, &coldRoot);
+    if (!status.ok() || coldRoot.empty()) {
+        return status;
+    }
+    // the paths are laid out the same as the data path
+    auto hotPath = folly::stringPrintf("%s/nebula/%d/data", dataPath.c_str(), spaceId);
+    auto coldPath = folly::stringPrintf("%s/nebula/%d/data", coldRoot.c_str(), spaceId);
+    if (!fs::FileUtils::exist(coldPath) && !fs::FileUtils::makeDir(coldPath)) {
+        return rocksdb::Status::IOError("makeDir failed", coldPath);
+    }
+    // rocksdb puts the newer data in the paths ahead, the last path takes all the rest
+    baseOpts.db_paths.clear();
+    baseOpts.db_paths.emplace_back(
+        hotPath, static_cast<uint64_t>(FLAGS_rocksdb_hot_data_target_size_gb) << 30);
+    baseOpts.db_paths.emplace_back(coldPath, std::numeric_limits<uint64_t>::max());
+    LOG(INFO) << "Space " << spaceId << " places the colder SST files in " << coldPath;
+    return rocksdb::Status::OK();
+}
+
+rocksdb::Status initRocksdbColumnFamilyOptions(const rocksdb::Options& baseOpts,
+                                               const std::string& gflags,
+                                               rocksdb::ColumnFamilyOptions& cfOpts) {
+    std::unordered_map<std::string, std::string> cfOptsMap;
+    if (!loadOptionsMap(cfOptsMap, gflags)) {
+        return rocksdb::Status::InvalidArgument();
+    }
+    return GetColumnFamilyOptionsFromMap(rocksdb::ColumnFamilyOptions(baseOpts),
+                                         cfOptsMap,
+                                         &cfOpts,
+                                         true);
+}
+
 bool loadOptionsMap(std::unordered_map<std::string, std::string> &map, const std::string& gflags) {
     conf::Configuration conf;
     auto status = conf.parseFromString(gflags);
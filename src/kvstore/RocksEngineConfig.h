@@ -10,6 +10,8 @@
 #include "common/base/Base.h"
 #include "common/thrift/ThriftTypes.h"
 #include <rocksdb/db.h>
+#include <rocksdb/concurrent_task_limiter.h>
+#include <rocksdb/rate_limiter.h>
 
 // [Version]
 DECLARE_string(rocksdb_options_version);
@@ -19,6 +21,9 @@ DECLARE_string(rocksdb_db_options);
 
 // [CFOptions "default"]
 DECLARE_string(rocksdb_column_family_options);
+DECLARE_bool(rocksdb_column_family_per_key_type);
+DECLARE_string(rocksdb_edge_column_family_options);
+DECLARE_string(rocksdb_index_column_family_options);
 
 //  [TableOptions/BlockBasedTable "default"]
 DECLARE_string(rocksdb_block_based_table_options);
@@ -30,9 +35,13 @@ DECLARE_string(memtable_factory);
 DECLARE_bool(rocksdb_disable_wal);
 
 DECLARE_bool(rocksdb_wal_sync);
+DECLARE_bool(rocksdb_group_wal_sync);
 
 // BlockBasedTable block_cache
 DECLARE_int64(rocksdb_block_cache);
+DECLARE_double(rocksdb_block_cache_high_pri_pool_ratio);
+DECLARE_string(rocksdb_space_block_cache);
+DECLARE_int32(rocksdb_scan_readahead_size);
 
 DECLARE_int32(rocksdb_batch_size);
 
@@ -43,12 +52,16 @@ DECLARE_string(part_man_type);
 
 DECLARE_string(rocksdb_compression_per_level);
 DECLARE_string(rocksdb_compression);
+DECLARE_int32(rocksdb_compression_dict_bytes);
+DECLARE_int32(rocksdb_compression_dict_train_bytes);
 
 DECLARE_bool(enable_rocksdb_statistics);
 DECLARE_string(rocksdb_stats_level);
+DECLARE_bool(enable_rocksdb_event_stats);
 
 DECLARE_bool(enable_rocksdb_prefix_filtering);
 DECLARE_bool(rocksdb_prefix_bloom_filter_length_flag);
+DECLARE_int32(rocksdb_index_prefix_bloom_filter_length);
 DECLARE_bool(enable_rocksdb_whole_key_filtering);
 
 // rocksdb compact RangeOptions
@@ -56,11 +69,26 @@ DECLARE_bool(rocksdb_compact_change_level);
 DECLARE_int32(rocksdb_compact_target_level);
 
 DECLARE_string(rocksdb_wal_dir);
+DECLARE_string(rocksdb_cold_data_paths);
+DECLARE_int32(rocksdb_hot_data_target_size_gb);
 DECLARE_string(rocksdb_backup_dir);
 DECLARE_int32(rocksdb_backup_interval_secs);
 
 DECLARE_string(rocksdb_memtable_type);
 DECLARE_int32(rocksdb_memtable_hash_bucket_count);
+DECLARE_int32(rocksdb_compact_on_deletion_window);
+DECLARE_int32(rocksdb_compact_on_deletion_trigger);
+DECLARE_bool(rocksdb_compact_expired_files);
+
+// load aware compaction, see CompactionScheduler
+DECLARE_bool(enable_load_aware_compaction);
+DECLARE_int32(compaction_busy_queue_depth);
+DECLARE_int32(compaction_busy_threads);
+DECLARE_int32(compaction_busy_rate_limit);
+DECLARE_int32(compaction_scheduler_interval_ms);
+DECLARE_int32(compaction_catch_up_interval_secs);
+DECLARE_int32(compaction_catch_up_level0_files);
+DECLARE_double(compaction_catch_up_tombstone_ratio);
 
 namespace nebula {
 namespace kvstore {
@@ -69,6 +97,34 @@ rocksdb::Status initRocksdbOptions(rocksdb::Options &baseOpts,
                                    GraphSpaceID spaceId,
                                    int32_t vidLen = 8);
 
+// The cold path of dataPath in rocksdb_cold_data_paths, empty if it has none
+rocksdb::Status coldDataPath(const std::string& dataPath, std::string* coldPath);
+
+// Place the older SST files of the space in the cold path of dataPath, if there is one
+rocksdb::Status initRocksdbDbPaths(rocksdb::Options& baseOpts,
+                                   const std::string& dataPath,
+                                   GraphSpaceID spaceId);
+
+// The options of a column family, which are the ones of baseOpts overridden by the json gflags
+rocksdb::Status initRocksdbColumnFamilyOptions(const rocksdb::Options& baseOpts,
+                                               const std::string& gflags,
+                                               rocksdb::ColumnFamilyOptions& cfOpts);
+
+// The block cache of the space, either its own one in rocksdb_space_block_cache or the shared
+// one. The engines of a space on different data paths share the same cache.
+std::shared_ptr<rocksdb::Cache> getBlockCache(GraphSpaceID spaceId);
+
+// The compaction thread limiter and the rate limiter shared by all engines, nullptr if there is
+// no limit. They are tightened by CompactionScheduler when the storage is busy, and restored
+// to the limits of flags, num_compaction_threads and rate_limit, when it is idle.
+std::shared_ptr<rocksdb::ConcurrentTaskLimiter> getCompactionThreadLimiter();
+
+int32_t compactionThreadsLimit();
+
+std::shared_ptr<rocksdb::RateLimiter> getRateLimiter();
+
+int64_t rateLimitBytesPerSec();
+
 bool loadOptionsMap(std::unordered_map<std::string, std::string> &map, const std::string& gflags);
 
 std::shared_ptr<rocksdb::Statistics> getDBStatistics();
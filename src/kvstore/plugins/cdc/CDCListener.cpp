@@ -0,0 +1,188 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/plugins/cdc/CDCListener.h"
+#include "utils/NebulaKeyUtils.h"
+#include "codec/RowReaderWrapper.h"
+
+DEFINE_string(cdc_sink, "", "The name of the sink registered the CDC listeners send to");
+DEFINE_int32(cdc_batch_size, 1024, "The number of events a CDC listener sends at once");
+
+namespace nebula {
+namespace kvstore {
+
+void CDCListener::init() {
+    auto vRet = schemaMan_->getSpaceVidLen(spaceId_);
+    if (!vRet.ok()) {
+        LOG(FATAL) << "vid length error";
+    }
+    vIdLen_ = vRet.value();
+
+    sink_ = CDCSink::create(FLAGS_cdc_sink, spaceId_, partId_);
+    if (sink_ == nullptr) {
+        LOG(FATAL) << "cdc sink \"" << FLAGS_cdc_sink << "\" is not registered";
+    }
+}
+
+bool CDCListener::apply(const std::vector<KV>& data) {
+    std::vector<CDCEvent> events;
+    for (const auto& kv : data) {
+        CDCEvent event;
+        if (!decodeKey(kv.first, &event)) {
+            continue;
+        }
+        event.op = CDCEvent::Op::PUT;
+        decodeProps(kv, &event);
+        events.emplace_back(std::move(event));
+    }
+    return addEvents(std::move(events));
+}
+
+bool CDCListener::remove(const std::vector<KV>& removes) {
+    std::vector<CDCEvent> events;
+    for (const auto& kv : removes) {
+        CDCEvent event;
+        if (!decodeKey(kv.first, &event)) {
+            continue;
+        }
+        event.op = CDCEvent::Op::REMOVE;
+        if (!kv.second.empty()) {
+            decodeProps(kv, &event);
+        }
+        events.emplace_back(std::move(event));
+    }
+    return addEvents(std::move(events));
+}
+
+bool CDCListener::persist(LogID lastId, TermID lastTerm, LogID lastApplyLogId) {
+    {
+        std::lock_guard<std::mutex> g(lock_);
+        if (!pending_.empty() && !sink_->send(pending_)) {
+            return false;
+        }
+        pending_.clear();
+        // the position is reset by the cleanup
+        if (lastApplyLogId > 0 && !sink_->commit(lastApplyLogId)) {
+            return false;
+        }
+    }
+    if (!writeAppliedId(lastId, lastTerm, lastApplyLogId)) {
+        LOG(FATAL) << "last apply ids write failed";
+    }
+    return true;
+}
+
+void CDCListener::abortApply() {
+    std::lock_guard<std::mutex> g(lock_);
+    pending_.clear();
+    sink_->abort();
+}
+
+std::pair<LogID, TermID> CDCListener::lastCommittedLogId() {
+    auto ids = readAppliedId();
+    return {std::get<0>(ids), std::get<1>(ids)};
+}
+
+LogID CDCListener::lastApplyLogId() {
+    return std::get<2>(readAppliedId());
+}
+
+bool CDCListener::decodeKey(folly::StringPiece key, CDCEvent* event) const {
+    event->partId = partId_;
+    if (NebulaKeyUtils::isVertex(vIdLen_, key)) {
+        event->vid = NebulaKeyUtils::getVertexId(vIdLen_, key).str();
+        event->tagId = NebulaKeyUtils::getTagId(vIdLen_, key);
+        return true;
+    }
+    if (NebulaKeyUtils::isEdge(vIdLen_, key)) {
+        event->vid = NebulaKeyUtils::getSrcId(vIdLen_, key).str();
+        event->edgeType = NebulaKeyUtils::getEdgeType(vIdLen_, key);
+        event->rank = NebulaKeyUtils::getRank(vIdLen_, key);
+        event->dst = NebulaKeyUtils::getDstId(vIdLen_, key).str();
+        return true;
+    }
+    return false;
+}
+
+void CDCListener::decodeProps(const KV& kv, CDCEvent* event) const {
+    auto reader = event->isEdge()
+        ? RowReaderWrapper::getEdgePropReader(schemaMan_, spaceId_, event->edgeType, kv.second)
+        : RowReaderWrapper::getTagPropReader(schemaMan_, spaceId_, event->tagId, kv.second);
+    if (reader == nullptr) {
+        // the schema is dropped, the change is still sent without the props
+        VLOG(3) << idStr_ << "get the reader failed, schema "
+                << (event->isEdge() ? event->edgeType : event->tagId);
+        return;
+    }
+    auto* schema = reader->getSchema();
+    for (size_t i = 0; i < schema->getNumFields(); i++) {
+        event->props.emplace(schema->getFieldName(i), reader->getValueByIndex(i));
+    }
+}
+
+bool CDCListener::addEvents(std::vector<CDCEvent> events) {
+    std::lock_guard<std::mutex> g(lock_);
+    for (auto& event : events) {
+        pending_.emplace_back(std::move(event));
+        if (pending_.size() < static_cast<size_t>(FLAGS_cdc_batch_size)) {
+            continue;
+        }
+        if (!sink_->send(pending_)) {
+            return false;
+        }
+        pending_.clear();
+    }
+    return true;
+}
+
+bool CDCListener::writeAppliedId(LogID lastId, TermID lastTerm, LogID lastApplyLogId) {
+    int32_t fd = open(lastApplyLogFile_.c_str(), O_CREAT | O_WRONLY | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        VLOG(3) << "Failed to open file \"" << lastApplyLogFile_
+                << "\" (errno: " << errno << "): " << strerror(errno);
+        return false;
+    }
+    std::string raw;
+    raw.reserve(sizeof(LogID) * 2 + sizeof(TermID));
+    raw.append(reinterpret_cast<const char*>(&lastId), sizeof(LogID))
+       .append(reinterpret_cast<const char*>(&lastTerm), sizeof(TermID))
+       .append(reinterpret_cast<const char*>(&lastApplyLogId), sizeof(LogID));
+    ssize_t written = write(fd, raw.c_str(), raw.size());
+    close(fd);
+    if (written != static_cast<ssize_t>(raw.size())) {
+        VLOG(3) << idStr_ << "bytesWritten:" << written << ", expected:" << raw.size()
+                << ", error:" << strerror(errno);
+        return false;
+    }
+    return true;
+}
+
+std::tuple<LogID, TermID, LogID> CDCListener::readAppliedId() const {
+    if (access(lastApplyLogFile_.c_str(), 0) != 0) {
+        VLOG(3) << "Invalid or non-existent file : " << lastApplyLogFile_;
+        return {0, 0, 0};
+    }
+    int32_t fd = open(lastApplyLogFile_.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG(FATAL) << "Failed to open the file \"" << lastApplyLogFile_ << "\" ("
+                   << errno << "): " << strerror(errno);
+    }
+    LogID lastId;
+    TermID lastTerm;
+    LogID lastApplyLogId;
+    CHECK_EQ(pread(fd, reinterpret_cast<char*>(&lastId), sizeof(LogID), 0),
+             static_cast<ssize_t>(sizeof(LogID)));
+    CHECK_EQ(pread(fd, reinterpret_cast<char*>(&lastTerm), sizeof(TermID), sizeof(LogID)),
+             static_cast<ssize_t>(sizeof(TermID)));
+    CHECK_EQ(pread(fd, reinterpret_cast<char*>(&lastApplyLogId), sizeof(LogID),
+                   sizeof(LogID) + sizeof(TermID)),
+             static_cast<ssize_t>(sizeof(LogID)));
+    close(fd);
+    return {lastId, lastTerm, lastApplyLogId};
+}
+
+}  // namespace kvstore
+}  // namespace nebula
@@ -0,0 +1,83 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_PLUGINS_CDC_CDCLISTENER_H_
+#define KVSTORE_PLUGINS_CDC_CDCLISTENER_H_
+
+#include "kvstore/Listener.h"
+#include "kvstore/plugins/cdc/CDCSink.h"
+
+namespace nebula {
+namespace kvstore {
+
+/*
+CDCListener sends the puts and removes of the vertices and edges of a part to the sink named by
+cdc_sink, as the events of CDCSink. The events of the logs applied at once are sent in batches of
+cdc_batch_size events, and committed at the last log applied when the apply log is persisted, so
+the position is kept by the sink and the listener together. The old values are mostly not in the
+logs, the puts have the values written, and the removes have the props only for the tags with a
+fulltext index, whose rows are logged with the removes by DeleteVerticesProcessor.
+*/
+class CDCListener : public Listener {
+public:
+    CDCListener(GraphSpaceID spaceId,
+                PartitionID partId,
+                HostAddr localAddr,
+                const std::string& walPath,
+                std::shared_ptr<folly::IOThreadPoolExecutor> ioPool,
+                std::shared_ptr<thread::GenericThreadPool> workers,
+                std::shared_ptr<folly::Executor> handlers,
+                std::shared_ptr<raftex::SnapshotManager> snapshotMan,
+                std::shared_ptr<RaftClient> clientMan,
+                std::shared_ptr<DiskManager> diskMan,
+                meta::SchemaManager* schemaMan)
+        : Listener(spaceId, partId, std::move(localAddr), walPath,
+                   ioPool, workers, handlers, snapshotMan, clientMan, diskMan, schemaMan) {
+        CHECK(!!schemaMan);
+        lastApplyLogFile_ = folly::stringPrintf("%s/last_apply_log_%d", walPath.c_str(), partId);
+    }
+
+protected:
+    void init() override;
+
+    bool apply(const std::vector<KV>& data) override;
+
+    bool remove(const std::vector<KV>& removes) override;
+
+    bool persist(LogID lastId, TermID lastTerm, LogID lastApplyLogId) override;
+
+    void abortApply() override;
+
+    std::pair<LogID, TermID> lastCommittedLogId() override;
+
+    LogID lastApplyLogId() override;
+
+private:
+    // Decode the key of a vertex or an edge, return false if it's neither
+    bool decodeKey(folly::StringPiece key, CDCEvent* event) const;
+
+    void decodeProps(const KV& kv, CDCEvent* event) const;
+
+    // Add the events to the pending ones, and send them if there are enough
+    bool addEvents(std::vector<CDCEvent> events);
+
+    bool writeAppliedId(LogID lastId, TermID lastTerm, LogID lastApplyLogId);
+
+    // Return {lastId, lastTerm, lastApplyLogId}, all 0 if they are not written yet
+    std::tuple<LogID, TermID, LogID> readAppliedId() const;
+
+private:
+    std::string                     lastApplyLogFile_;
+    int32_t                         vIdLen_{0};
+    std::unique_ptr<CDCSink>        sink_;
+    // the events not sent to the sink, the applies of the batches are sent in turn
+    std::mutex                      lock_;
+    std::vector<CDCEvent>           pending_;
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+#endif  // KVSTORE_PLUGINS_CDC_CDCLISTENER_H_
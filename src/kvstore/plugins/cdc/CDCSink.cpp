@@ -0,0 +1,49 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/plugins/cdc/CDCSink.h"
+
+namespace nebula {
+namespace kvstore {
+
+namespace {
+
+std::mutex& sinksLock() {
+    static std::mutex lock;
+    return lock;
+}
+
+std::unordered_map<std::string, CDCSink::Factory>& sinks() {
+    static std::unordered_map<std::string, CDCSink::Factory> factories;
+    return factories;
+}
+
+}  // namespace
+
+// static
+void CDCSink::registerSink(const std::string& name, Factory factory) {
+    std::lock_guard<std::mutex> g(sinksLock());
+    sinks()[name] = std::move(factory);
+}
+
+// static
+std::unique_ptr<CDCSink> CDCSink::create(const std::string& name,
+                                         GraphSpaceID spaceId,
+                                         PartitionID partId) {
+    Factory factory;
+    {
+        std::lock_guard<std::mutex> g(sinksLock());
+        auto it = sinks().find(name);
+        if (it == sinks().end()) {
+            return nullptr;
+        }
+        factory = it->second;
+    }
+    return factory(spaceId, partId);
+}
+
+}  // namespace kvstore
+}  // namespace nebula
@@ -0,0 +1,75 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef KVSTORE_PLUGINS_CDC_CDCSINK_H_
+#define KVSTORE_PLUGINS_CDC_CDCSINK_H_
+
+#include "common/base/Base.h"
+#include "common/datatypes/Value.h"
+
+namespace nebula {
+namespace kvstore {
+
+// A change of a vertex or an edge decoded from the logs of a part
+struct CDCEvent {
+    enum class Op : int8_t {
+        PUT    = 1,
+        REMOVE = 2,
+    };
+
+    Op                                          op{Op::PUT};
+    PartitionID                                 partId{0};
+    // the vertex of a tag or the src of an edge, padded to the vid length as it's in the key
+    std::string                                 vid;
+    // 0 for an edge
+    TagID                                       tagId{0};
+    // 0 for a vertex
+    EdgeType                                    edgeType{0};
+    EdgeRanking                                 rank{0};
+    std::string                                 dst;
+    // the props of the row put, decoded by the schema it's written with, empty for a remove
+    std::unordered_map<std::string, Value>      props;
+
+    bool isEdge() const {
+        return edgeType != 0;
+    }
+};
+
+/*
+CDCSink is where a CDC listener sends the changes of a part, e.g. a topic of Kafka. Each part has
+its own sink, created by the factory registered by the name in cdc_sink.
+
+The events since the last commit are sent in batches in the order of each key, and then committed
+at the position of the last log of them. The position is persisted by the listener once the sink
+commits, and the events after it are sent again when the logs are applied again, after an abort
+or a restart of the listener. A sink delivering the events only on commit, and skipping a commit
+at or before a position it has committed, e.g. a transaction of Kafka storing the position, delivers
+each event exactly once.
+*/
+class CDCSink {
+public:
+    using Factory = std::function<std::unique_ptr<CDCSink>(GraphSpaceID, PartitionID)>;
+
+    virtual ~CDCSink() = default;
+
+    virtual bool send(const std::vector<CDCEvent>& events) = 0;
+
+    virtual bool commit(LogID position) = 0;
+
+    // Drop the events sent since the last commit
+    virtual void abort() = 0;
+
+    static void registerSink(const std::string& name, Factory factory);
+
+    // Return nullptr if no sink is registered by the name
+    static std::unique_ptr<CDCSink> create(const std::string& name,
+                                           GraphSpaceID spaceId,
+                                           PartitionID partId);
+};
+
+}  // namespace kvstore
+}  // namespace nebula
+#endif  // KVSTORE_PLUGINS_CDC_CDCSINK_H_
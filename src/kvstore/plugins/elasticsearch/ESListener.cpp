@@ -7,9 +7,13 @@
 #include "utils/NebulaKeyUtils.h"
 #include "kvstore/plugins/elasticsearch/ESListener.h"
 #include "common/plugin/fulltext/elasticsearch/ESStorageAdapter.h"
+#include "common/process/ProcessUtils.h"
+#include <folly/executors/CPUThreadPoolExecutor.h>
 
 DECLARE_int32(ft_request_retry_times);
 DECLARE_int32(ft_bulk_batch_size);
+DECLARE_int32(ft_bulk_batch_bytes);
+DECLARE_int32(ft_bulk_parallelism);
 
 namespace nebula {
 namespace kvstore {
@@ -42,29 +46,93 @@ void ESListener::init() {
 }
 
 bool ESListener::apply(const std::vector<KV>& data) {
-    std::vector<nebula::plugin::DocItem> docItems;
+    // the bulks sent at once, the last one is being filled
+    std::vector<std::vector<DocItem>> bulks(1);
+    size_t bytes = 0;
     for (const auto& kv : data) {
         if (!nebula::NebulaKeyUtils::isVertex(vIdLen_, kv.first) &&
             !nebula::NebulaKeyUtils::isEdge(vIdLen_, kv.first)) {
             continue;
         }
+        auto& docItems = bulks.back();
+        auto start = docItems.size();
         if (!appendDocItem(docItems, kv)) {
             return false;
         }
-        if (docItems.size() >= static_cast<size_t>(FLAGS_ft_bulk_batch_size)) {
-            auto suc = writeData(docItems);
-            if (!suc) {
-                return suc;
-            }
-            docItems.clear();
+        for (auto i = start; i < docItems.size(); i++) {
+            bytes += docItems[i].column.size() + docItems[i].val.size();
+        }
+        bool full = docItems.size() >= static_cast<size_t>(FLAGS_ft_bulk_batch_size) ||
+                    (FLAGS_ft_bulk_batch_bytes > 0 &&
+                     bytes >= static_cast<size_t>(FLAGS_ft_bulk_batch_bytes));
+        if (!full) {
+            continue;
         }
+        bytes = 0;
+        if (bulks.size() < static_cast<size_t>(FLAGS_ft_bulk_parallelism)) {
+            bulks.emplace_back();
+            continue;
+        }
+        if (!writeBulks(bulks)) {
+            return false;
+        }
+        bulks.clear();
+        bulks.emplace_back();
+    }
+    if (bulks.back().empty()) {
+        bulks.pop_back();
     }
-    if (!docItems.empty()) {
-        return writeData(docItems);
+    return bulks.empty() || writeBulks(bulks);
+}
+
+bool ESListener::remove(const std::vector<KV>& removes) {
+    std::vector<DocItem> items;
+    for (const auto& kv : removes) {
+        if (kv.second.empty()) {
+            continue;
+        }
+        if (!nebula::NebulaKeyUtils::isVertex(vIdLen_, kv.first) &&
+            !nebula::NebulaKeyUtils::isEdge(vIdLen_, kv.first)) {
+            continue;
+        }
+        if (!appendDocItem(items, kv)) {
+            return false;
+        }
+    }
+    size_t batchSize = std::max(FLAGS_ft_bulk_batch_size, 1);
+    for (size_t start = 0; start < items.size(); start += batchSize) {
+        auto end = std::min(items.size(), start + batchSize);
+        if (!deleteData(std::vector<DocItem>(items.begin() + start, items.begin() + end))) {
+            return false;
+        }
     }
     return true;
 }
 
+bool ESListener::writeBulks(const std::vector<std::vector<DocItem>>& bulks) const {
+    if (bulks.size() == 1) {
+        return writeData(bulks.front());
+    }
+    // The docs are identified by the column and the text, so the bulks could be written in any
+    // order. They are sent to the clients in turn, by a pool shared by all listeners
+    static auto pool = std::make_shared<folly::CPUThreadPoolExecutor>(
+        FLAGS_ft_bulk_parallelism * 2,
+        std::make_shared<folly::NamedThreadFactory>("ft-bulk"));
+    auto first = folly::Random::rand32(esClients_.size());
+    std::vector<folly::Future<bool>> futures;
+    for (size_t i = 0; i < bulks.size(); i++) {
+        auto client = static_cast<int32_t>((first + i) % esClients_.size());
+        futures.emplace_back(folly::via(pool.get(), [this, &bulks, i, client] {
+            return writeData(bulks[i], client);
+        }));
+    }
+    bool succeeded = true;
+    for (auto& t : folly::collectAll(futures).get()) {
+        succeeded = succeeded && t.hasValue() && t.value();
+    }
+    return succeeded;
+}
+
 bool ESListener::persist(LogID lastId, TermID lastTerm, LogID lastApplyLogId) {
     if (!writeAppliedId(lastId, lastTerm, lastApplyLogId)) {
         LOG(FATAL) << "last apply ids write failed";
@@ -201,11 +269,17 @@ bool ESListener::appendDocs(std::vector<DocItem>& items,
     return true;
 }
 
-bool ESListener::writeData(const std::vector<nebula::plugin::DocItem>& items) const {
+bool ESListener::writeData(const std::vector<nebula::plugin::DocItem>& items,
+                           int32_t client) const {
     bool isNeedWriteOneByOne = false;
     auto retryCnt = FLAGS_ft_request_retry_times;
     while (--retryCnt > 0) {
         auto index = folly::Random::rand32(esClients_.size() - 1);
+        if (client >= 0) {
+            // the client given is tried first
+            index = client;
+            client = -1;
+        }
         auto suc = nebula::plugin::ESStorageAdapter::kAdapter->bulk(esClients_[index], items);
         if (!suc.ok()) {
             VLOG(3) << "bulk failed. retry : " << retryCnt;
@@ -224,6 +298,42 @@ bool ESListener::writeData(const std::vector<nebula::plugin::DocItem>& items) co
     return false;
 }
 
+bool ESListener::deleteData(const std::vector<nebula::plugin::DocItem>& items) const {
+    std::stringstream body;
+    for (const auto& item : items) {
+        auto docId = nebula::plugin::DocIDTraits::docId(item);
+        folly::dynamic doc = folly::dynamic::object("_index", item.index)("_id", docId);
+        body << folly::toJson(folly::dynamic::object("delete", std::move(doc))) << "\n";
+    }
+    auto retryCnt = FLAGS_ft_request_retry_times;
+    while (--retryCnt > 0) {
+        const auto& client = esClients_[folly::Random::rand32(esClients_.size())];
+        std::stringstream cmd;
+        cmd << "/usr/bin/curl -s -H \"Content-Type: application/x-ndjson; charset=utf-8\"";
+        if (!client.user.empty()) {
+            cmd << " -u " << client.user << ":" << client.password;
+        }
+        cmd << " -XPOST \"http://" << client.host.host << ":" << client.host.port
+            << "/_bulk\" -d'" << body.str() << "'";
+        auto ret = nebula::ProcessUtils::runCommand(cmd.str().c_str());
+        if (!ret.ok() || ret.value().empty()) {
+            VLOG(3) << "bulk delete failed. retry : " << retryCnt;
+            continue;
+        }
+        try {
+            auto resp = folly::parseJson(ret.value());
+            if (resp.isObject() && resp.count("errors") && !resp["errors"].asBool()) {
+                return true;
+            }
+        } catch (const std::exception& e) {
+            VLOG(3) << "bad response of bulk delete : " << e.what();
+        }
+        VLOG(3) << "bulk delete failed. retry : " << retryCnt;
+    }
+    LOG(ERROR) << "A fatal error . Full-text engine is not working.";
+    return false;
+}
+
 bool ESListener::writeDatum(const std::vector<nebula::plugin::DocItem>& items) const {
     bool done = false;
     for (const auto& item : items) {
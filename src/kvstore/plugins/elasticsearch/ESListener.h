@@ -41,6 +41,13 @@ protected:
 
     bool apply(const std::vector<KV>& data) override;
 
+    // Delete the docs of the rows removed with their values, i.e. the vertices of the tags with
+    // a fulltext index. A doc is identified by the part, the column and the text, it is shared
+    // by the rows of the part with the same text, so the text of such a row is deleted with the
+    // others until it is written again. The removes without the value are skipped, the docs
+    // left are filtered by the lookup on the storage.
+    bool remove(const std::vector<KV>& removes) override;
+
     bool persist(LogID lastId, TermID lastTerm, LogID lastApplyLogId) override;
 
     std::pair<LogID, TermID> lastCommittedLogId() override;
@@ -61,10 +68,17 @@ private:
     bool appendDocs(std::vector<DocItem>& items, RowReader* reader,
                     const std::pair<std::string, nebula::meta::cpp2::FTIndex>& fti) const;
 
-    bool writeData(const std::vector<nebula::plugin::DocItem>& items) const;
+    // Write the bulks, at once by the clients in turn if there are more than one
+    bool writeBulks(const std::vector<std::vector<DocItem>>& bulks) const;
+
+    // Write the items by the client, or a random one if it's -1
+    bool writeData(const std::vector<nebula::plugin::DocItem>& items, int32_t client = -1) const;
 
     bool writeDatum(const std::vector<nebula::plugin::DocItem>& items) const;
 
+    // Delete the docs of the items by the bulk api, the docs missing are ignored
+    bool deleteData(const std::vector<nebula::plugin::DocItem>& items) const;
+
 private:
     std::unique_ptr<std::string>            lastApplyLogFile_{nullptr};
     std::unique_ptr<std::string>            spaceName_{nullptr};
@@ -13,17 +13,42 @@
 #include <thrift/lib/cpp/async/TAsyncSocket.h>
 #include <thrift/lib/cpp2/async/HeaderClientChannel.h>
 
+DEFINE_int32(hbase_batch_rows, 1024,
+             "The number of rows of a multi get, put or remove sent to HBase at once");
+DEFINE_int32(hbase_scan_caching, 1024,
+             "The number of rows a HBase scanner fetches by each call");
 
 namespace nebula {
 namespace kvstore {
 
 const char* kColumnFamilyName = "cf";
 
-HBaseClient::HBaseClient(const HostAddr& host) {
+namespace {
+
+// Split the items into the batches of hbase_batch_rows
+template <class T>
+std::vector<std::vector<T>> splitBatches(std::vector<T> items) {
+    size_t batchRows = std::max(FLAGS_hbase_batch_rows, 1);
+    std::vector<std::vector<T>> batches;
+    for (auto& item : items) {
+        if (batches.empty() || batches.back().size() >= batchRows) {
+            batches.emplace_back();
+            batches.back().reserve(std::min(batchRows, items.size()));
+        }
+        batches.back().emplace_back(std::move(item));
+    }
+    return batches;
+}
+
+}  // namespace
+
+HBaseClient::HBaseClient(const HostAddr& host,
+                         std::shared_ptr<folly::IOThreadPoolExecutor> ioPool)
+        : host_(host)
+        , ioPool_(std::move(ioPool)) {
+    CHECK(!!ioPool_);
     clientsMan_ = std::make_shared<thrift::ThriftClientManager<
                                    THBaseServiceAsyncClient>>();
-    auto evb = folly::EventBaseManager::get()->getEventBase();
-    client_ = clientsMan_->client(host, evb, true);
 }
 
 
@@ -31,6 +56,26 @@ HBaseClient::~HBaseClient() {
 }
 
 
+template <class Fn>
+auto HBaseClient::call(Fn&& fn) {
+    auto* evb = ioPool_->getEventBase();
+    return folly::via(evb, [this, evb, fn = std::forward<Fn>(fn)] () mutable {
+        auto client = clientsMan_->client(host_, evb, true);
+        return fn(client.get());
+    });
+}
+
+
+// static
+ResultCode HBaseClient::toResultCode(const folly::Try<folly::Unit>& t) {
+    if (t.hasException()) {
+        LOG(ERROR) << "HBase call failed: " << t.exception().what();
+        return ResultCode::ERR_IO_ERROR;
+    }
+    return ResultCode::SUCCEEDED;
+}
+
+
 ResultCode HBaseClient::get(const std::string& tableName,
                             const std::string& rowKey,
                             KVMap& data) {
@@ -44,7 +89,9 @@ ResultCode HBaseClient::get(const std::string& tableName,
 
     TResult tResult;
     try {
-        client_->sync_get(tResult, tableName, tGet);
+        tResult = call([&tableName, &tGet] (auto* client) {
+            return client->future_get(tableName, tGet);
+        }).get();
         std::vector<TColumnValue> tColumnValueList = tResult.columnValues;
         if (tColumnValueList.size() > 0) {
             for (auto& cv : tColumnValueList) {
@@ -69,6 +116,14 @@ std::pair<ResultCode, std::vector<Status>> HBaseClient::multiGet(
         const std::string& tableName,
         const std::vector<std::string>& rowKeys,
         std::vector<std::pair<std::string, KVMap>>& dataList) {
+    return asyncMultiGet(tableName, rowKeys, &dataList).get();
+}
+
+
+folly::Future<std::pair<ResultCode, std::vector<Status>>> HBaseClient::asyncMultiGet(
+        const std::string& tableName,
+        const std::vector<std::string>& rowKeys,
+        std::vector<std::pair<std::string, KVMap>>* dataList) {
     std::vector<TGet> tGetList;
     for (auto& rowKey : rowKeys) {
         TGet tGet;
@@ -81,35 +136,40 @@ std::pair<ResultCode, std::vector<Status>> HBaseClient::multiGet(
         tGetList.emplace_back(tGet);
     }
 
-    std::vector<TResult> tResultList;
-    std::vector<Status> status;
-    ResultCode resultCode = ResultCode::SUCCEEDED;
-    try {
-        client_->sync_getMultiple(tResultList, tableName, tGetList);
-        for (auto& tResult : tResultList) {
-            std::vector<TColumnValue> tColumnValueList = tResult.columnValues;
-            if (tColumnValueList.size() > 0) {
-                std::string rowKey = tResult.row;
-                KVMap data;
-                for (auto& cv : tColumnValueList) {
-                    data.emplace(cv.qualifier, cv.value);
+    std::vector<folly::Future<std::vector<TResult>>> futures;
+    for (auto& batch : splitBatches(std::move(tGetList))) {
+        futures.emplace_back(call([tableName, batch = std::move(batch)] (auto* client) {
+            return client->future_getMultiple(tableName, batch);
+        }));
+    }
+    // the results are in the order of the rows
+    return folly::collectAll(futures).thenValue(
+            [dataList] (std::vector<folly::Try<std::vector<TResult>>>&& tries) {
+        std::vector<Status> status;
+        ResultCode resultCode = ResultCode::SUCCEEDED;
+        for (auto& t : tries) {
+            if (t.hasException()) {
+                LOG(ERROR) << "HBase getMultiple failed: " << t.exception().what();
+                return std::make_pair(ResultCode::ERR_IO_ERROR, std::move(status));
+            }
+            for (auto& tResult : t.value()) {
+                std::vector<TColumnValue> tColumnValueList = tResult.columnValues;
+                if (tColumnValueList.size() > 0) {
+                    std::string rowKey = tResult.row;
+                    KVMap data;
+                    for (auto& cv : tColumnValueList) {
+                        data.emplace(cv.qualifier, cv.value);
+                    }
+                    dataList->emplace_back(std::make_pair(rowKey, std::move(data)));
+                    status.emplace_back(Status::OK());
+                } else {
+                    resultCode = ResultCode::ERR_PARTIAL_RESULT;
+                    status.emplace_back(Status::KeyNotFound());
                 }
-                dataList.emplace_back(std::make_pair(rowKey, std::move(data)));
-                status.emplace_back(Status::OK());
-            } else {
-                resultCode = ResultCode::ERR_PARTIAL_RESULT;
-                status.emplace_back(Status::KeyNotFound());
             }
         }
-        return {resultCode, status};
-    } catch (const TIOError &ex) {
-        LOG(ERROR) << "TIOError: " << ex.message;
-        return {ResultCode::ERR_IO_ERROR, status};
-    } catch (const apache::thrift::transport::TTransportException &tte) {
-        LOG(ERROR) << "TTransportException: " << tte.what();
-        return {ResultCode::ERR_IO_ERROR, status};
-    }
-    return {ResultCode::E_UNKNOWN, status};
+        return std::make_pair(resultCode, std::move(status));
+    });
 }
 
 
@@ -129,7 +189,9 @@ ResultCode HBaseClient::put(const std::string& tableName,
     tPut.set_columnValues(tColumnValueList);
 
     try {
-        client_->sync_put(tableName, tPut);
+        call([&tableName, &tPut] (auto* client) {
+            return client->future_put(tableName, tPut);
+        }).get();
         return ResultCode::SUCCEEDED;
     } catch (const TIOError &ex) {
         LOG(ERROR) << "TIOError: " << ex.message;
@@ -144,13 +206,19 @@ ResultCode HBaseClient::put(const std::string& tableName,
 
 ResultCode HBaseClient::multiPut(const std::string& tableName,
                                  std::vector<std::pair<std::string, std::vector<KV>>>& dataList) {
+    return asyncMultiPut(tableName, dataList).get();
+}
+
+
+folly::Future<ResultCode> HBaseClient::asyncMultiPut(
+        const std::string& tableName,
+        const std::vector<std::pair<std::string, std::vector<KV>>>& dataList) {
     std::vector<TPut> tPutList;
     for (auto& data : dataList) {
         TPut tPut;
         tPut.set_row(data.first);
-        auto kvs = data.second;
         std::vector<TColumnValue> tColumnValueList;
-        for (auto& kv : kvs) {
+        for (auto& kv : data.second) {
             TColumnValue tColumnValue;
             tColumnValue.set_family(kColumnFamilyName);
             tColumnValue.set_qualifier(kv.first);
@@ -161,17 +229,22 @@ ResultCode HBaseClient::multiPut(const std::string& tableName,
         tPutList.emplace_back(tPut);
     }
 
-    try {
-        client_->sync_putMultiple(tableName, tPutList);
-        return ResultCode::SUCCEEDED;
-    } catch (const TIOError &ex) {
-        LOG(ERROR) << "TIOError: " << ex.message;
-        return ResultCode::ERR_IO_ERROR;
-    } catch (const apache::thrift::transport::TTransportException &tte) {
-        LOG(ERROR) << "TTransportException: " << tte.what();
-        return ResultCode::ERR_IO_ERROR;
+    std::vector<folly::Future<folly::Unit>> futures;
+    for (auto& batch : splitBatches(std::move(tPutList))) {
+        futures.emplace_back(call([tableName, batch = std::move(batch)] (auto* client) {
+            return client->future_putMultiple(tableName, batch);
+        }));
     }
-    return ResultCode::E_UNKNOWN;
+    return folly::collectAll(futures).thenValue(
+            [] (std::vector<folly::Try<folly::Unit>>&& tries) {
+        for (auto& t : tries) {
+            auto code = toResultCode(t);
+            if (code != ResultCode::SUCCEEDED) {
+                return code;
+            }
+        }
+        return ResultCode::SUCCEEDED;
+    });
 }
 
 
@@ -181,6 +254,8 @@ ResultCode HBaseClient::range(const std::string& tableName,
                               std::vector<std::pair<std::string, KVMap>>& dataList) {
     // TODO(zhangguoqing) This is a simple implementation that get all results immediately,
     // and in the future, it will use HBaseScanIter to improve performance.
+    // The scanner caches the rows fetched by each call on the region server
+    auto caching = std::max(FLAGS_hbase_scan_caching, 1);
     TScan tScan;
     tScan.set_startRow(startRowKey);
     tScan.set_stopRow(endRowKey);
@@ -189,14 +264,17 @@ ResultCode HBaseClient::range(const std::string& tableName,
     tColumn.set_family(kColumnFamilyName);
     tColumnList.emplace_back(tColumn);
     tScan.set_columns(tColumnList);
-    tScan.set_caching(kScanRowNum * kScanRowNum);
+    tScan.set_caching(caching);
 
     int32_t scannerId = -1;
     try {
-        scannerId = client_->sync_openScanner(tableName, tScan);
+        scannerId = call([&tableName, &tScan] (auto* client) {
+            return client->future_openScanner(tableName, tScan);
+        }).get();
         while (true) {
-            std::vector<TResult> tResultList;
-            client_->sync_getScannerRows(tResultList, scannerId, kScanRowNum);
+            auto tResultList = call([scannerId, caching] (auto* client) {
+                return client->future_getScannerRows(scannerId, caching);
+            }).get();
             if (tResultList.size() == 0) break;
             for (auto& tResult : tResultList) {
                 std::vector<TColumnValue> tColumnValueList = tResult.columnValues;
@@ -211,14 +289,14 @@ ResultCode HBaseClient::range(const std::string& tableName,
             }
             tResultList.clear();
         }
-        client_->sync_closeScanner(scannerId);
+        closeScanner(scannerId);
         return ResultCode::SUCCEEDED;
     } catch (const TIOError &ex) {
-        if (scannerId >= 0) client_->sync_closeScanner(scannerId);
+        if (scannerId >= 0) closeScanner(scannerId);
         LOG(ERROR) << "TIOError: " << ex.message;
         return ResultCode::ERR_IO_ERROR;
     } catch (const apache::thrift::transport::TTransportException &tte) {
-        if (scannerId >= 0) client_->sync_closeScanner(scannerId);
+        if (scannerId >= 0) closeScanner(scannerId);
         LOG(ERROR) << "TTransportException: " << tte.what();
         return ResultCode::ERR_IO_ERROR;
     }
@@ -226,6 +304,16 @@ ResultCode HBaseClient::range(const std::string& tableName,
 }
 
 
+void HBaseClient::closeScanner(int32_t scannerId) {
+    auto t = call([scannerId] (auto* client) {
+        return client->future_closeScanner(scannerId);
+    }).getTry();
+    if (t.hasException()) {
+        LOG(ERROR) << "Close the scanner " << scannerId << " failed: " << t.exception().what();
+    }
+}
+
+
 ResultCode HBaseClient::remove(const std::string& tableName,
                                const std::string& rowKey) {
     TDelete tDelete;
@@ -238,7 +326,9 @@ ResultCode HBaseClient::remove(const std::string& tableName,
     tDelete.set_durability(TDurability::ASYNC_WAL);
 
     try {
-        client_->sync_deleteSingle(tableName, tDelete);
+        call([&tableName, &tDelete] (auto* client) {
+            return client->future_deleteSingle(tableName, tDelete);
+        }).get();
         return ResultCode::SUCCEEDED;
     } catch (const TIOError &ex) {
         LOG(ERROR) << "TIOError: " << ex.message;
@@ -252,6 +342,12 @@ ResultCode HBaseClient::remove(const std::string& tableName,
 
 ResultCode HBaseClient::multiRemove(const std::string& tableName,
                                     std::vector<std::string>& rowKeys) {
+    return asyncMultiRemove(tableName, rowKeys).get();
+}
+
+
+folly::Future<ResultCode> HBaseClient::asyncMultiRemove(const std::string& tableName,
+                                                        const std::vector<std::string>& rowKeys) {
     std::vector<TDelete> tDeleteList;
     for (auto& rowKey : rowKeys) {
         TDelete tDelete;
@@ -265,18 +361,22 @@ ResultCode HBaseClient::multiRemove(const std::string& tableName,
         tDeleteList.emplace_back(tDelete);
     }
 
-    std::vector<TDelete> tDeleteResultList;
-    try {
-        client_->sync_deleteMultiple(tDeleteResultList, tableName, tDeleteList);
-        return ResultCode::SUCCEEDED;
-    } catch (const TIOError &ex) {
-        LOG(ERROR) << "TIOError: " << ex.message;
-        return ResultCode::ERR_IO_ERROR;
-    } catch (const apache::thrift::transport::TTransportException &tte) {
-        LOG(ERROR) << "TTransportException: " << tte.what();
-        return ResultCode::ERR_IO_ERROR;
+    std::vector<folly::Future<folly::Unit>> futures;
+    for (auto& batch : splitBatches(std::move(tDeleteList))) {
+        futures.emplace_back(call([tableName, batch = std::move(batch)] (auto* client) {
+            return client->future_deleteMultiple(tableName, batch).unit();
+        }));
     }
-    return ResultCode::E_UNKNOWN;
+    return folly::collectAll(futures).thenValue(
+            [] (std::vector<folly::Try<folly::Unit>>&& tries) {
+        for (auto& t : tries) {
+            auto code = toResultCode(t);
+            if (code != ResultCode::SUCCEEDED) {
+                return code;
+            }
+        }
+        return ResultCode::SUCCEEDED;
+    });
 }
 
 }  // namespace kvstore
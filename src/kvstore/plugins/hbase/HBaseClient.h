@@ -22,9 +22,15 @@ namespace kvstore {
 
 using namespace apache::hadoop::hbase::thrift2::cpp2;  // NOLINT
 
+/*
+HBaseClient calls the HBase thrift2 server on the event bases of the io pool. The multi gets, puts
+and removes are split into batches of hbase_batch_rows rows, which are sent at once, and a
+scanner fetches hbase_scan_caching rows by each call. The sync calls wait for the async ones, so
+they must not be called on the io pool.
+*/
 class HBaseClient final {
 public:
-    explicit HBaseClient(const HostAddr& host);
+    HBaseClient(const HostAddr& host, std::shared_ptr<folly::IOThreadPoolExecutor> ioPool);
     ~HBaseClient();
 
     ResultCode get(const std::string& tableName,
@@ -54,12 +60,32 @@ public:
     ResultCode multiRemove(const std::string& tableName,
                            std::vector<std::string>& rowKeys);
 
+    folly::Future<std::pair<ResultCode, std::vector<Status>>> asyncMultiGet(
+            const std::string& tableName,
+            const std::vector<std::string>& rowKeys,
+            std::vector<std::pair<std::string, KVMap>>* dataList);
+
+    folly::Future<ResultCode> asyncMultiPut(
+            const std::string& tableName,
+            const std::vector<std::pair<std::string, std::vector<KV>>>& dataList);
+
+    folly::Future<ResultCode> asyncMultiRemove(const std::string& tableName,
+                                               const std::vector<std::string>& rowKeys);
+
 private:
-    std::shared_ptr<thrift::ThriftClientManager<THBaseServiceAsyncClient>> clientsMan_;
+    // Call the server by the client of an event base of the io pool
+    template <class Fn>
+    auto call(Fn&& fn);
+
+    void closeScanner(int32_t scannerId);
 
-    std::shared_ptr<THBaseServiceAsyncClient> client_;
+    // The code of the call finished, the exceptions are the io errors
+    static ResultCode toResultCode(const folly::Try<folly::Unit>& t);
 
-    const int32_t kScanRowNum = {1024};
+private:
+    HostAddr host_;
+    std::shared_ptr<folly::IOThreadPoolExecutor> ioPool_;
+    std::shared_ptr<thrift::ThriftClientManager<THBaseServiceAsyncClient>> clientsMan_;
 };
 
 }  // namespace kvstore
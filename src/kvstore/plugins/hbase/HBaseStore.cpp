@@ -23,8 +23,9 @@ const size_t kMaxRowKeyLength = sizeof(PartitionID) + sizeof(VertexID)
                               + sizeof(EdgeType) + sizeof(VertexID)
                               + sizeof(EdgeRanking) + sizeof(EdgeVerPlaceHolder);
 
-HBaseStore::HBaseStore(KVOptions options)
-        : options_(std::move(options)) {
+HBaseStore::HBaseStore(KVOptions options, std::shared_ptr<folly::IOThreadPoolExecutor> ioPool)
+        : options_(std::move(options))
+        , ioPool_(std::move(ioPool)) {
     schemaMan_ = std::move(options_.schemaMan_);
     CHECK_NOTNULL(schemaMan_);
 }
@@ -34,7 +35,7 @@ void HBaseStore::init() {
     LOG(INFO) << "Connect to the HBase thrift server "
               << network::NetworkUtils::intToIPv4(options_.hbaseServer_.first)
               << ":" << options_.hbaseServer_.second;
-    client_ = std::make_unique<HBaseClient>(options_.hbaseServer_);
+    client_ = std::make_unique<HBaseClient>(options_.hbaseServer_, ioPool_);
     CHECK_NOTNULL(client_.get());
 }
 
@@ -319,24 +320,22 @@ ResultCode HBaseStore::prefix(GraphSpaceID spaceId,
 
 void HBaseStore::asyncMultiPut(GraphSpaceID spaceId,
                                PartitionID partId,
-                               std::vector<KV>&& keyValues,
+                               std::vector<KV> keyValues,
                                KVCallback cb) {
     UNUSED(partId);
-    auto multiPut = [this, &spaceId, &keyValues] () -> ResultCode {
-        auto tableName = this->spaceIdToTableName(spaceId);
-        std::vector<std::pair<std::string, std::vector<KV>>> dataList;
-        for (size_t i = 0; i < keyValues.size(); i++) {
-            auto rowKey = this->getRowKey(keyValues[i].first);
-            auto data = this->decode(spaceId, keyValues[i].first, keyValues[i].second);
-            dataList.emplace_back(std::make_pair(rowKey, data));
-        }
-        ResultCode code = client_->multiPut(tableName, dataList);
+    auto tableName = this->spaceIdToTableName(spaceId);
+    std::vector<std::pair<std::string, std::vector<KV>>> dataList;
+    for (size_t i = 0; i < keyValues.size(); i++) {
+        auto rowKey = this->getRowKey(keyValues[i].first);
+        auto data = this->decode(spaceId, keyValues[i].first, keyValues[i].second);
+        dataList.emplace_back(std::make_pair(std::move(rowKey), std::move(data)));
+    }
+    client_->asyncMultiPut(tableName, dataList).thenValue([cb = std::move(cb)] (ResultCode code) {
         if (code == ResultCode::ERR_IO_ERROR) {
             LOG(ERROR) << "MultiPut Failed: the HBase I/O error.";
         }
-        return code;
-    };
-    return cb(multiPut());
+        cb(code);
+    });
 }
 
 
@@ -363,7 +362,18 @@ void HBaseStore::asyncMultiRemove(GraphSpaceID spaceId,
                                   std::vector<std::string> keys,
                                   KVCallback cb) {
     UNUSED(partId);
-    return cb(this->multiRemove(spaceId, keys));
+    auto tableName = this->spaceIdToTableName(spaceId);
+    std::vector<std::string> rowKeys;
+    rowKeys.reserve(keys.size());
+    for (auto& key : keys) {
+        rowKeys.emplace_back(this->getRowKey(key));
+    }
+    client_->asyncMultiRemove(tableName, rowKeys).thenValue([cb = std::move(cb)] (ResultCode code) {
+        if (code == ResultCode::ERR_IO_ERROR) {
+            LOG(ERROR) << "MultiRemove Failed: the HBase I/O error.";
+        }
+        cb(code);
+    });
 }
 
 
@@ -427,6 +437,10 @@ ResultCode HBaseStore::ingest(GraphSpaceID) {
     LOG(FATAL) << "Unimplement";
 }
 
+ResultCode HBaseStore::ingest(GraphSpaceID, PartitionID) {
+    LOG(FATAL) << "Unimplement";
+}
+
 int32_t HBaseStore::allLeader(std::unordered_map<GraphSpaceID, std::vector<PartitionID>>&) {
     LOG(FATAL) << "Unimplement";
 }
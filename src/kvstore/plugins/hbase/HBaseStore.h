@@ -58,7 +58,7 @@ private:
 
 class HBaseStore : public KVStore {
 public:
-    explicit HBaseStore(KVOptions options);
+    HBaseStore(KVOptions options, std::shared_ptr<folly::IOThreadPoolExecutor> ioPool);
 
     ~HBaseStore() = default;
 
@@ -141,7 +141,7 @@ public:
 
     ResultCode sync(GraphSpaceID spaceId, PartitionID partId) override;
 
-    // async batch put.
+    // async batch put, the callback is invoked on the io pool once all the batches are put
     void asyncMultiPut(GraphSpaceID spaceId,
                        PartitionID  partId,
                        std::vector<KV> keyValues,
@@ -184,6 +184,8 @@ public:
 
     ResultCode ingest(GraphSpaceID spaceId) override;
 
+    ResultCode ingest(GraphSpaceID spaceId, PartitionID partId) override;
+
     int32_t allLeader(std::unordered_map<GraphSpaceID,
                                          std::vector<PartitionID>>& leaderIds) override;
 
@@ -245,6 +247,7 @@ private:
 
 private:
     KVOptions options_;
+    std::shared_ptr<folly::IOThreadPoolExecutor> ioPool_;
 
     std::unique_ptr<meta::SchemaManager> schemaMan_{nullptr};
 
@@ -9,6 +9,9 @@
 #include "kvstore/plugins/hbase/HBaseClient.h"
 #include <gtest/gtest.h>
 
+DECLARE_int32(hbase_batch_rows);
+DECLARE_int32(hbase_scan_caching);
+
 /**
  * TODO(zhangguoqing) Add a test runner to provide HBase/thrift2 service.
  * hbase/bin/hbase-daemon.sh start thrift2 -b 127.0.0.1 -p 9096
@@ -19,7 +22,8 @@ namespace nebula {
 namespace kvstore {
 
 TEST(HBaseClientTest, SimpleTest) {
-    auto hbaseClient = std::make_shared<HBaseClient>(HostAddr(0, 9096));
+    auto ioPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+    auto hbaseClient = std::make_shared<HBaseClient>(HostAddr(0, 9096), ioPool);
     std::string tableName = "Nebula_Graph_Space_0";
     std::string rowKey = "rowKey";
     std::vector<KV> putData;
@@ -46,7 +50,10 @@ TEST(HBaseClientTest, SimpleTest) {
 
 
 TEST(HBaseClientTest, MultiTest) {
-    auto hbaseClient = std::make_shared<HBaseClient>(HostAddr(0, 9096));
+    // the rows are sent in batches
+    FLAGS_hbase_batch_rows = 3;
+    auto ioPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+    auto hbaseClient = std::make_shared<HBaseClient>(HostAddr(0, 9096), ioPool);
     std::string tableName = "Nebula_Graph_Space_0";
     std::vector<std::string> rowKeys;
     std::vector<std::pair<std::string, std::vector<KV>>> dataList;
@@ -83,11 +90,15 @@ TEST(HBaseClientTest, MultiTest) {
     ret = hbaseClient->multiGet(tableName, rowKeys, retDataList);
     EXPECT_EQ(ResultCode::E_UNKNOWN, ret.first);
     EXPECT_EQ(0, retDataList.size());
+    FLAGS_hbase_batch_rows = 1024;
 }
 
 
 TEST(HBaseClientTest, RangeTest) {
-    auto hbaseClient = std::make_shared<HBaseClient>(HostAddr(0, 9096));
+    // the rows are fetched by more than one call of the scanner
+    FLAGS_hbase_scan_caching = 4;
+    auto ioPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+    auto hbaseClient = std::make_shared<HBaseClient>(HostAddr(0, 9096), ioPool);
     std::string tableName = "Nebula_Graph_Space_0";
     std::vector<std::string> rowKeys;
     std::vector<std::pair<std::string, std::vector<KV>>> dataList;
@@ -129,6 +140,7 @@ TEST(HBaseClientTest, RangeTest) {
     checkRange(15, 23, 15, 5);
     checkRange(1, 15, 10, 5);
     EXPECT_EQ(ResultCode::SUCCEEDED, hbaseClient->multiRemove(tableName, rowKeys));
+    FLAGS_hbase_scan_caching = 1024;
 }
 
 }  // namespace kvstore
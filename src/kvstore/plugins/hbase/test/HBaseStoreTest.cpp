@@ -26,7 +26,8 @@ TEST(HBaseStoreTest, SimpleTest) {
     CHECK_NOTNULL(sm);
     options.hbaseServer_ = HostAddr(0, 9096);
     options.schemaMan_ = schemaMan.get();
-    auto hbaseStore = std::make_unique<HBaseStore>(std::move(options));
+    auto ioPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+    auto hbaseStore = std::make_unique<HBaseStore>(std::move(options), ioPool);
     hbaseStore->init();
 
     LOG(INFO) << "Put some data then read them...";
@@ -6,8 +6,10 @@
 
 #include "kvstore/raftex/Host.h"
 #include "kvstore/raftex/RaftPart.h"
+#include "kvstore/raftex/RpcCompression.h"
 #include "kvstore/wal/FileBasedWal.h"
 #include "common/network/NetworkUtils.h"
+#include "common/time/WallClock.h"
 #include <folly/io/async/EventBase.h>
 #include <folly/executors/IOThreadPoolExecutor.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
@@ -17,6 +19,18 @@ DEFINE_uint32(max_appendlog_batch_size, 128,
 DEFINE_uint32(max_outstanding_requests, 1024,
               "The max number of outstanding appendLog requests");
 DEFINE_int32(raft_rpc_timeout_ms, 500, "rpc timeout for raft client");
+DEFINE_uint32(raft_max_inflight_appendlog, 1,
+              "The max number of appendLog requests in flight to each host, the logs after "
+              "the first request are sent without waiting for its response if larger than 1");
+DEFINE_uint32(raft_catch_up_lag_logs, 0,
+              "A follower whose next log is behind the last log in the wal by at least this "
+              "many logs is caught up in larger batches under raft_catch_up_rate_limit, "
+              "0 means never");
+DEFINE_uint32(raft_catch_up_batch_size, 1024,
+              "The max number of logs in each appendLog request to a follower catching up");
+DEFINE_int32(raft_catch_up_rate_limit, 0,
+             "The bandwidth of the logs sent to each follower catching up in MB per sec, "
+             "0 means unlimited.");
 
 DECLARE_bool(trace_raft);
 DECLARE_uint32(raft_heartbeat_interval_secs);
@@ -44,7 +58,7 @@ void Host::waitForStop() {
 
     CHECK(stopped_);
     noMoreRequestCV_.wait(g, [this] {
-        return !requestOnGoing_;
+        return !requestOnGoing_ && inflight_ == 0;
     });
     LOG(INFO) << idStr_ << "The host has been stopped!";
 }
@@ -82,7 +96,8 @@ folly::Future<cpp2::AskForVoteResponse> Host::askForVote(
         }
     }
     auto client =
-        part_->clientMan_->client(addr_, eb, false, FLAGS_raft_heartbeat_interval_secs * 1000);
+        part_->controlClientMan_->client(addr_, eb, false,
+                                         FLAGS_raft_heartbeat_interval_secs * 1000);
     return client->future_askForVote(req);
 }
 
@@ -97,7 +112,8 @@ folly::Future<cpp2::AppendLogResponse> Host::appendLogs(
     VLOG(3) << idStr_ << "Entering Host::appendLogs()";
 
     auto ret = folly::Future<cpp2::AppendLogResponse>::makeEmpty();
-    std::shared_ptr<cpp2::AppendLogRequest> req;
+    std::vector<std::shared_ptr<cpp2::AppendLogRequest>> reqs;
+    uint64_t epoch = 0;
     {
         std::lock_guard<std::mutex> g(lock_);
 
@@ -111,52 +127,59 @@ folly::Future<cpp2::AppendLogResponse> Host::appendLogs(
         }
 
         if (requestOnGoing_ && res == cpp2::ErrorCode::SUCCEEDED) {
-            if (cachingPromise_.size() <= FLAGS_max_outstanding_requests) {
-                pendingReq_ = std::make_tuple(term,
-                                              logId,
-                                              committedLogId);
-                return cachingPromise_.getFuture();
-            } else {
+            if (cachingPromise_.size() > FLAGS_max_outstanding_requests) {
                 LOG_EVERY_N(INFO, 200) << idStr_ << "Too many requests are waiting, return error";
                 cpp2::AppendLogResponse r;
                 r.set_error_code(cpp2::ErrorCode::E_TOO_MANY_REQUESTS);
                 return r;
             }
-        }
-
-        if (res != cpp2::ErrorCode::SUCCEEDED) {
-            VLOG(2) << idStr_
-                    << "The host is not in a proper status, just return";
-            cpp2::AppendLogResponse r;
-            r.set_error_code(res);
-            return r;
-        }
+            pendingReq_ = std::make_tuple(term,
+                                          logId,
+                                          committedLogId);
+            ret = cachingPromise_.getFuture();
+            // The logs of the pending request could be sent before the ongoing ones are
+            // accepted, if the window is not full
+            reqs = prepareInflightRequests();
+            epoch = epoch_;
+        } else {
+            if (res != cpp2::ErrorCode::SUCCEEDED) {
+                VLOG(2) << idStr_
+                        << "The host is not in a proper status, just return";
+                cpp2::AppendLogResponse r;
+                r.set_error_code(res);
+                return r;
+            }
 
-        VLOG(2) << idStr_ << "About to send the AppendLog request";
+            VLOG(2) << idStr_ << "About to send the AppendLog request";
 
-        // No request is ongoing, let's send a new request
-        if (UNLIKELY(lastLogIdSent_ == 0 && lastLogTermSent_ == 0)) {
-            lastLogIdSent_ = prevLogId;
-            lastLogTermSent_ = prevLogTerm;
-            LOG(INFO) << idStr_ << "This is the first time to send the logs to this host"
-                      << ", lastLogIdSent = " << lastLogIdSent_
-                      << ", lastLogTermSent = " << lastLogTermSent_;
+            // No request is ongoing, let's send a new request
+            if (UNLIKELY(lastLogIdSent_ == 0 && lastLogTermSent_ == 0)) {
+                lastLogIdSent_ = prevLogId;
+                lastLogTermSent_ = prevLogTerm;
+                LOG(INFO) << idStr_ << "This is the first time to send the logs to this host"
+                          << ", lastLogIdSent = " << lastLogIdSent_
+                          << ", lastLogTermSent = " << lastLogTermSent_;
+            }
+            logTermToSend_ = term;
+            logIdToSend_ = logId;
+            committedLogId_ = committedLogId;
+            pendingReq_ = std::make_tuple(0, 0, 0);
+            promise_ = std::move(cachingPromise_);
+            cachingPromise_ = folly::SharedPromise<cpp2::AppendLogResponse>();
+            ret = promise_.getFuture();
+
+            requestOnGoing_ = true;
+
+            lastLogIdInflight_ = lastLogIdSent_;
+            lastLogTermInflight_ = lastLogTermSent_;
+            reqs = prepareInflightRequests();
+            epoch = epoch_;
         }
-        logTermToSend_ = term;
-        logIdToSend_ = logId;
-        committedLogId_ = committedLogId;
-        pendingReq_ = std::make_tuple(0, 0, 0);
-        promise_ = std::move(cachingPromise_);
-        cachingPromise_ = folly::SharedPromise<cpp2::AppendLogResponse>();
-        ret = promise_.getFuture();
-
-        requestOnGoing_ = true;
-
-        req = prepareAppendLogRequest();
     }
 
-    // Get a new promise
-    appendLogsInternal(eb, std::move(req));
+    for (auto& req : reqs) {
+        appendLogsInternal(eb, std::move(req), epoch);
+    }
 
     return ret;
 }
@@ -168,276 +191,357 @@ void Host::setResponse(const cpp2::AppendLogResponse& r) {
     cachingPromise_ = folly::SharedPromise<cpp2::AppendLogResponse>();
     pendingReq_ = std::make_tuple(0, 0, 0);
     requestOnGoing_ = false;
+    // the responses of the requests still in flight are ignored
+    ++epoch_;
+}
+
+void Host::rollback() {
+    CHECK(!lock_.try_lock());
+    VLOG(2) << idStr_ << "Rollback the logs in flight from " << lastLogIdInflight_
+            << " to " << lastLogIdSent_;
+    lastLogIdInflight_ = lastLogIdSent_;
+    lastLogTermInflight_ = lastLogTermSent_;
+    ++epoch_;
+}
+
+std::vector<std::shared_ptr<cpp2::AppendLogRequest>> Host::prepareInflightRequests() {
+    CHECK(!lock_.try_lock());
+    std::vector<std::shared_ptr<cpp2::AppendLogRequest>> reqs;
+    size_t window = std::max<uint32_t>(1, FLAGS_raft_max_inflight_appendlog);
+    LogID lastLogIdToSend = noRequest() ? logIdToSend_
+                                        : std::max(logIdToSend_, std::get<1>(pendingReq_));
+    // At least one request is sent if nothing is in flight
+    while (inflight_ < window && (inflight_ == 0 || lastLogIdInflight_ < lastLogIdToSend)) {
+        auto req = prepareAppendLogRequest();
+        auto numLogs = req->get_log_str_list().size();
+        if (numLogs == 0 && inflight_ > 0) {
+            // nothing more could be sent now
+            break;
+        }
+        ++inflight_;
+        reqs.emplace_back(std::move(req));
+        if (numLogs == 0) {
+            // wait for the response, the follower might be waiting for the snapshot
+            break;
+        }
+        lastLogIdInflight_ += numLogs;
+        lastLogTermInflight_ = reqs.back()->get_log_term();
+    }
+    return reqs;
+}
+
+bool Host::isCatchingUp(LogID firstId) const {
+    return FLAGS_raft_catch_up_lag_logs > 0 &&
+           part_->wal()->lastLogId() - firstId >=
+               static_cast<LogID>(FLAGS_raft_catch_up_lag_logs);
+}
+
+std::chrono::milliseconds Host::catchUpDelay(const cpp2::AppendLogRequest& req) {
+    if (FLAGS_raft_catch_up_rate_limit <= 0 || !isCatchingUp(req.get_last_log_id_sent() + 1)) {
+        return std::chrono::milliseconds(0);
+    }
+    double bytes = 0;
+    for (const auto& log : req.get_log_str_list()) {
+        bytes += log.get_log_str().size();
+    }
+    double rate = FLAGS_raft_catch_up_rate_limit * 1024.0 * 1024.0;
+    auto wait = catchUpBucket_.consumeWithBorrowNonBlocking(bytes, rate, std::max(rate, bytes));
+    if (!wait.hasValue() || *wait <= 0) {
+        return std::chrono::milliseconds(0);
+    }
+    return std::chrono::milliseconds(static_cast<int64_t>(std::ceil(*wait * 1000)));
 }
 
 void Host::appendLogsInternal(folly::EventBase* eb,
-                              std::shared_ptr<cpp2::AppendLogRequest> req) {
+                              std::shared_ptr<cpp2::AppendLogRequest> req,
+                              uint64_t epoch) {
+    auto delay = catchUpDelay(*req);
+    if (delay.count() > 0) {
+        // The request waits for the bandwidth without blocking the event base, so the live
+        // logs sent to the other followers by it are not held up
+        VLOG(2) << idStr_ << "Delay the catch-up request by " << delay.count() << " ms";
+        folly::futures::sleep(delay)
+            .via(eb)
+            .thenValue([eb, req = std::move(req), epoch, self = shared_from_this()]
+                       (auto&&) mutable {
+                self->doAppendLogs(eb, std::move(req), epoch);
+            });
+        return;
+    }
+    doAppendLogs(eb, std::move(req), epoch);
+}
+
+void Host::doAppendLogs(folly::EventBase* eb,
+                        std::shared_ptr<cpp2::AppendLogRequest> req,
+                        uint64_t epoch) {
     sendAppendLogRequest(eb, std::move(req)).via(eb).then(
-            [eb, self = shared_from_this()] (folly::Try<cpp2::AppendLogResponse>&& t) {
+            [eb, epoch, self = shared_from_this()] (folly::Try<cpp2::AppendLogResponse>&& t) {
         VLOG(3) << self->idStr_ << "appendLogs() call got response";
-        if (t.hasException()) {
-            VLOG(2) << self->idStr_ << t.exception().what();
-            cpp2::AppendLogResponse r;
-            r.set_error_code(cpp2::ErrorCode::E_EXCEPTION);
-            {
-                std::lock_guard<std::mutex> g(self->lock_);
-                self->setResponse(r);
-                self->lastLogIdSent_ = self->logIdToSend_ - 1;
+        if (t.hasValue()) {
+            auto code = t.value().get_error_code();
+            if (code == cpp2::ErrorCode::SUCCEEDED ||
+                code == cpp2::ErrorCode::E_LOG_GAP ||
+                code == cpp2::ErrorCode::E_LOG_STALE) {
+                // the follower has taken it as the message of leader, just like a heartbeat
+                self->lastAppendLogAcceptedMs_ = time::WallClock::fastNowInMilliSec();
             }
-            self->noMoreRequestCV_.notify_all();
-            return;
         }
-
-        cpp2::AppendLogResponse resp = std::move(t).value();
-        LOG_IF(INFO, FLAGS_trace_raft)
-            << self->idStr_ << "AppendLogResponse "
-            << "code " << apache::thrift::util::enumNameSafe(resp.get_error_code())
-            << ", currTerm " << resp.get_current_term()
-            << ", lastLogId " << resp.get_last_log_id()
-            << ", lastLogTerm " << resp.get_last_log_term()
-            << ", commitLogId " << resp.get_committed_log_id()
-            << ", lastLogIdSent_ " << self->lastLogIdSent_
-            << ", lastLogTermSent_ " << self->lastLogTermSent_;
-        switch (resp.get_error_code()) {
-            case cpp2::ErrorCode::SUCCEEDED: {
+        std::vector<std::shared_ptr<cpp2::AppendLogRequest>> newReqs;
+        uint64_t newEpoch = 0;
+        {
+            std::lock_guard<std::mutex> g(self->lock_);
+            --self->inflight_;
+            if (epoch != self->epoch_) {
                 VLOG(2) << self->idStr_
-                        << "AppendLog request sent successfully";
-
-                std::shared_ptr<cpp2::AppendLogRequest> newReq;
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    auto res = self->checkStatus();
-                    if (res != cpp2::ErrorCode::SUCCEEDED) {
-                        VLOG(2) << self->idStr_
-                                << "The host is not in a proper status,"
-                                   " just return";
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else if (self->lastLogIdSent_ >= resp.get_last_log_id()) {
-                        VLOG(2) << self->idStr_
-                                << "We send nothing in the last request"
-                                << ", so we don't send the same logs again";
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else {
-                        self->lastLogIdSent_ = resp.get_last_log_id();
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        if (self->lastLogIdSent_ < self->logIdToSend_) {
-                            // More to send
-                            VLOG(2) << self->idStr_
-                                    << "There are more logs to send";
-                            newReq = self->prepareAppendLogRequest();
-                        } else {
-                            VLOG(2) << self->idStr_
-                                    << "Fulfill the promise, size = " << self->promise_.size();
-                            // Fulfill the promise
-                            self->promise_.setValue(resp);
-
-                            if (self->noRequest()) {
-                                VLOG(2) << self->idStr_ << "No request any more!";
-                                self->requestOnGoing_ = false;
-                            } else {
-                                auto& tup = self->pendingReq_;
-                                self->logTermToSend_ = std::get<0>(tup);
-                                self->logIdToSend_ = std::get<1>(tup);
-                                self->committedLogId_ = std::get<2>(tup);
-                                VLOG(2) << self->idStr_
-                                        << "Sending the pending request in the queue"
-                                        << ", from " << self->lastLogIdSent_ + 1
-                                        << " to " << self->logIdToSend_;
-                                newReq = self->prepareAppendLogRequest();
-                                self->promise_ = std::move(self->cachingPromise_);
-                                self->cachingPromise_
-                                    = folly::SharedPromise<cpp2::AppendLogResponse>();
-                                self->pendingReq_ = std::make_tuple(0, 0, 0);
-                            }  // self->noRequest()
-                        }  // self->lastLogIdSent_ < self->logIdToSend_
-                    }  // else
-                }
-                if (newReq) {
-                    self->appendLogsInternal(eb, newReq);
-                } else {
-                    self->noMoreRequestCV_.notify_all();
-                }
-                return;
+                        << "The request has been rolled back, ignore the response";
+            } else {
+                newReqs = self->processAppendLogResponse(std::move(t));
+                newEpoch = self->epoch_;
             }
-            case cpp2::ErrorCode::E_LOG_GAP: {
-                VLOG(2) << self->idStr_
-                        << "The host's log is behind, need to catch up";
-                std::shared_ptr<cpp2::AppendLogRequest> newReq;
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    auto res = self->checkStatus();
-                    if (res != cpp2::ErrorCode::SUCCEEDED) {
-                        VLOG(2) << self->idStr_
-                                << "The host is not in a proper status,"
-                                   " skip catching up the gap";
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else if (self->lastLogIdSent_ == resp.get_last_log_id()) {
-                        VLOG(2) << self->idStr_
-                                << "We send nothing in the last request"
-                                << ", so we don't send the same logs again";
-                        self->lastLogIdSent_ = resp.get_last_log_id();
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
-                        self->setResponse(r);
-                    } else {
-                        self->lastLogIdSent_ = std::min(resp.get_last_log_id(),
-                                                        self->logIdToSend_ - 1);
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        newReq = self->prepareAppendLogRequest();
-                    }
-                }
-                if (newReq) {
-                    self->appendLogsInternal(eb, newReq);
-                } else {
-                    self->noMoreRequestCV_.notify_all();
-                }
-                return;
+        }
+        for (auto& newReq : newReqs) {
+            self->appendLogsInternal(eb, std::move(newReq), newEpoch);
+        }
+        self->noMoreRequestCV_.notify_all();
+    });
+}
+
+std::vector<std::shared_ptr<cpp2::AppendLogRequest>>
+Host::processAppendLogResponse(folly::Try<cpp2::AppendLogResponse>&& t) {
+    CHECK(!lock_.try_lock());
+    if (t.hasException()) {
+        VLOG(2) << idStr_ << t.exception().what();
+        cpp2::AppendLogResponse r;
+        r.set_error_code(cpp2::ErrorCode::E_EXCEPTION);
+        setResponse(r);
+        lastLogIdSent_ = logIdToSend_ - 1;
+        return {};
+    }
+
+    cpp2::AppendLogResponse resp = std::move(t).value();
+    LOG_IF(INFO, FLAGS_trace_raft)
+        << idStr_ << "AppendLogResponse "
+        << "code " << apache::thrift::util::enumNameSafe(resp.get_error_code())
+        << ", currTerm " << resp.get_current_term()
+        << ", lastLogId " << resp.get_last_log_id()
+        << ", lastLogTerm " << resp.get_last_log_term()
+        << ", commitLogId " << resp.get_committed_log_id()
+        << ", lastLogIdSent_ " << lastLogIdSent_
+        << ", lastLogTermSent_ " << lastLogTermSent_;
+    switch (resp.get_error_code()) {
+        case cpp2::ErrorCode::SUCCEEDED: {
+            VLOG(2) << idStr_
+                    << "AppendLog request sent successfully";
+            auto res = checkStatus();
+            if (res != cpp2::ErrorCode::SUCCEEDED) {
+                VLOG(2) << idStr_
+                        << "The host is not in a proper status,"
+                           " just return";
+                cpp2::AppendLogResponse r;
+                r.set_error_code(res);
+                setResponse(r);
+                return {};
             }
-            case cpp2::ErrorCode::E_WAITING_SNAPSHOT: {
-                LOG(INFO) << self->idStr_
-                          << "The host is waiting for the snapshot, so we need to send log from "
-                          << "current committedLogId " << self->committedLogId_;
-                std::shared_ptr<cpp2::AppendLogRequest> newReq;
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    auto res = self->checkStatus();
-                    if (res != cpp2::ErrorCode::SUCCEEDED) {
-                        VLOG(2) << self->idStr_
-                                << "The host is not in a proper status,"
-                                   " skip waiting the snapshot";
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else {
-                        self->lastLogIdSent_ = self->committedLogId_;
-                        self->lastLogTermSent_ = self->logTermToSend_;
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        newReq = self->prepareAppendLogRequest();
-                    }
+            if (lastLogIdSent_ >= resp.get_last_log_id()) {
+                if (inflight_ > 0) {
+                    // The other requests in flight will move on
+                    return {};
                 }
-                if (newReq) {
-                    self->appendLogsInternal(eb, newReq);
-                } else {
-                    self->noMoreRequestCV_.notify_all();
-                }
-                return;
+                VLOG(2) << idStr_
+                        << "We send nothing in the last request"
+                        << ", so we don't send the same logs again";
+                followerCommittedLogId_ = resp.get_committed_log_id();
+                cpp2::AppendLogResponse r;
+                r.set_error_code(res);
+                setResponse(r);
+                return {};
             }
-            case cpp2::ErrorCode::E_LOG_STALE: {
-                VLOG(2) << self->idStr_ << "Log stale, reset lastLogIdSent " << self->lastLogIdSent_
-                        << " to the followers lastLodId " << resp.get_last_log_id();
-                std::shared_ptr<cpp2::AppendLogRequest> newReq;
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    auto res = self->checkStatus();
-                    if (res != cpp2::ErrorCode::SUCCEEDED) {
-                        VLOG(2) << self->idStr_
-                                << "The host is not in a proper status,"
-                                   " skip waiting the snapshot";
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(res);
-                        self->setResponse(r);
-                    } else if (self->logIdToSend_ <= resp.get_last_log_id()) {
-                        VLOG(2) << self->idStr_
-                                << "It means the request has been received by follower";
-                        self->lastLogIdSent_ = self->logIdToSend_ - 1;
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        cpp2::AppendLogResponse r;
-                        r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
-                        self->setResponse(r);
-                    } else {
-                        self->lastLogIdSent_ = std::min(resp.get_last_log_id(),
-                                                        self->logIdToSend_ - 1);
-                        self->lastLogTermSent_ = resp.get_last_log_term();
-                        self->followerCommittedLogId_ = resp.get_committed_log_id();
-                        newReq = self->prepareAppendLogRequest();
-                    }
-                }
-                if (newReq) {
-                    self->appendLogsInternal(eb, newReq);
-                } else {
-                    self->noMoreRequestCV_.notify_all();
-                }
-                return;
+            lastLogIdSent_ = resp.get_last_log_id();
+            lastLogTermSent_ = resp.get_last_log_term();
+            followerCommittedLogId_ = resp.get_committed_log_id();
+            if (lastLogIdInflight_ < lastLogIdSent_) {
+                lastLogIdInflight_ = lastLogIdSent_;
+                lastLogTermInflight_ = lastLogTermSent_;
             }
-            default: {
-                LOG_EVERY_N(ERROR, 100)
-                           << self->idStr_
-                           << "Failed to append logs to the host (Err: "
-                           << apache::thrift::util::enumNameSafe(resp.get_error_code())
-                           << ")";
-                {
-                    std::lock_guard<std::mutex> g(self->lock_);
-                    self->setResponse(resp);
-                    self->lastLogIdSent_ = self->logIdToSend_ - 1;
+            // The logs of the pending request might have been sent in the window as well
+            while (lastLogIdSent_ >= logIdToSend_) {
+                VLOG(2) << idStr_
+                        << "Fulfill the promise, size = " << promise_.size();
+                // Fulfill the promise
+                promise_.setValue(resp);
+
+                if (noRequest()) {
+                    VLOG(2) << idStr_ << "No request any more!";
+                    requestOnGoing_ = false;
+                    ++epoch_;
+                    return {};
                 }
-                self->noMoreRequestCV_.notify_all();
-                return;
+                auto& tup = pendingReq_;
+                logTermToSend_ = std::get<0>(tup);
+                logIdToSend_ = std::get<1>(tup);
+                committedLogId_ = std::get<2>(tup);
+                VLOG(2) << idStr_
+                        << "Sending the pending request in the queue"
+                        << ", from " << lastLogIdSent_ + 1
+                        << " to " << logIdToSend_;
+                promise_ = std::move(cachingPromise_);
+                cachingPromise_ = folly::SharedPromise<cpp2::AppendLogResponse>();
+                pendingReq_ = std::make_tuple(0, 0, 0);
             }
+            VLOG(2) << idStr_ << "There are more logs to send";
+            return prepareInflightRequests();
         }
-    });
+        case cpp2::ErrorCode::E_LOG_GAP: {
+            VLOG(2) << idStr_
+                    << "The host's log is behind, need to catch up";
+            auto res = checkStatus();
+            if (res != cpp2::ErrorCode::SUCCEEDED) {
+                VLOG(2) << idStr_
+                        << "The host is not in a proper status,"
+                           " skip catching up the gap";
+                cpp2::AppendLogResponse r;
+                r.set_error_code(res);
+                setResponse(r);
+                return {};
+            }
+            if (inflight_ == 0 && lastLogIdSent_ == resp.get_last_log_id()) {
+                VLOG(2) << idStr_
+                        << "We send nothing in the last request"
+                        << ", so we don't send the same logs again";
+                lastLogIdSent_ = resp.get_last_log_id();
+                lastLogTermSent_ = resp.get_last_log_term();
+                followerCommittedLogId_ = resp.get_committed_log_id();
+                cpp2::AppendLogResponse r;
+                r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
+                setResponse(r);
+                return {};
+            }
+            // The requests in flight after the gap are rejected too, send them again after
+            // the gap is filled. It happens as well if the requests arrive out of order.
+            lastLogIdSent_ = std::min(resp.get_last_log_id(), logIdToSend_ - 1);
+            lastLogTermSent_ = resp.get_last_log_term();
+            followerCommittedLogId_ = resp.get_committed_log_id();
+            rollback();
+            return prepareInflightRequests();
+        }
+        case cpp2::ErrorCode::E_WAITING_SNAPSHOT: {
+            LOG(INFO) << idStr_
+                      << "The host is waiting for the snapshot, so we need to send log from "
+                      << "current committedLogId " << committedLogId_;
+            auto res = checkStatus();
+            if (res != cpp2::ErrorCode::SUCCEEDED) {
+                VLOG(2) << idStr_
+                        << "The host is not in a proper status,"
+                           " skip waiting the snapshot";
+                cpp2::AppendLogResponse r;
+                r.set_error_code(res);
+                setResponse(r);
+                return {};
+            }
+            lastLogIdSent_ = committedLogId_;
+            lastLogTermSent_ = logTermToSend_;
+            followerCommittedLogId_ = resp.get_committed_log_id();
+            rollback();
+            return prepareInflightRequests();
+        }
+        case cpp2::ErrorCode::E_LOG_STALE: {
+            VLOG(2) << idStr_ << "Log stale, reset lastLogIdSent " << lastLogIdSent_
+                    << " to the followers lastLodId " << resp.get_last_log_id();
+            auto res = checkStatus();
+            if (res != cpp2::ErrorCode::SUCCEEDED) {
+                VLOG(2) << idStr_
+                        << "The host is not in a proper status,"
+                           " skip waiting the snapshot";
+                cpp2::AppendLogResponse r;
+                r.set_error_code(res);
+                setResponse(r);
+                return {};
+            }
+            if (logIdToSend_ <= resp.get_last_log_id()) {
+                VLOG(2) << idStr_
+                        << "It means the request has been received by follower";
+                lastLogIdSent_ = logIdToSend_ - 1;
+                lastLogTermSent_ = resp.get_last_log_term();
+                followerCommittedLogId_ = resp.get_committed_log_id();
+                cpp2::AppendLogResponse r;
+                r.set_error_code(cpp2::ErrorCode::SUCCEEDED);
+                setResponse(r);
+                return {};
+            }
+            lastLogIdSent_ = std::min(resp.get_last_log_id(), logIdToSend_ - 1);
+            lastLogTermSent_ = resp.get_last_log_term();
+            followerCommittedLogId_ = resp.get_committed_log_id();
+            rollback();
+            return prepareInflightRequests();
+        }
+        default: {
+            LOG_EVERY_N(ERROR, 100)
+                       << idStr_
+                       << "Failed to append logs to the host (Err: "
+                       << apache::thrift::util::enumNameSafe(resp.get_error_code())
+                       << ")";
+            setResponse(resp);
+            lastLogIdSent_ = logIdToSend_ - 1;
+            return {};
+        }
+    }
 }
 
 
 std::shared_ptr<cpp2::AppendLogRequest>
 Host::prepareAppendLogRequest() {
     CHECK(!lock_.try_lock());
+    // The logs after the ongoing request are sent with the pending one
+    TermID term = logTermToSend_;
+    LogID logIdToSend = logIdToSend_;
+    LogID committedLogId = committedLogId_;
+    if (lastLogIdInflight_ >= logIdToSend_ && !noRequest()) {
+        std::tie(term, logIdToSend, committedLogId) = pendingReq_;
+    }
     auto req = std::make_shared<cpp2::AppendLogRequest>();
     req->set_space(part_->spaceId());
     req->set_part(part_->partitionId());
-    req->set_current_term(logTermToSend_);
-    req->set_last_log_id(logIdToSend_);
+    req->set_current_term(term);
+    req->set_last_log_id(logIdToSend);
     req->set_leader_addr(part_->address().host);
     req->set_leader_port(part_->address().port);
-    req->set_committed_log_id(committedLogId_);
-    req->set_last_log_term_sent(lastLogTermSent_);
-    req->set_last_log_id_sent(lastLogIdSent_);
+    req->set_committed_log_id(committedLogId);
+    req->set_last_log_term_sent(lastLogTermInflight_);
+    req->set_last_log_id_sent(lastLogIdInflight_);
 
     VLOG(2) << idStr_ << "Prepare AppendLogs request from Log "
-                      << lastLogIdSent_ + 1 << " to " << logIdToSend_;
-    if (lastLogIdSent_ + 1 > part_->wal()->lastLogId()) {
+                      << lastLogIdInflight_ + 1 << " to " << logIdToSend;
+    if (lastLogIdInflight_ + 1 > part_->wal()->lastLogId()) {
         LOG(INFO) << idStr_ << "My lastLogId in wal is " << part_->wal()->lastLogId()
-                  << ", but you are seeking " << lastLogIdSent_ + 1
+                  << ", but you are seeking " << lastLogIdInflight_ + 1
                   << ", so i have nothing to send.";
         return req;
     }
-    auto it = part_->wal()->iterator(lastLogIdSent_ + 1, logIdToSend_);
-    if (it->valid()) {
+    auto logs = part_->logEntriesToSend(term,
+                                        lastLogIdInflight_ + 1,
+                                        logIdToSend,
+                                        isCatchingUp(lastLogIdInflight_ + 1));
+    if (logs != nullptr) {
         VLOG(2) << idStr_ << "Prepare the list of log entries to send";
-
-        auto term = it->logTerm();
-        req->set_log_term(term);
-
-        std::vector<cpp2::LogEntry> logs;
-        for (size_t cnt = 0;
-             it->valid()
-                && it->logTerm() == term
-                && cnt < FLAGS_max_appendlog_batch_size;
-             ++(*it), ++cnt) {
-            cpp2::LogEntry le;
-            le.set_cluster(it->logSource());
-            le.set_log_str(it->logMsg().toString());
-            logs.emplace_back(std::move(le));
+        req->set_log_term(logs->logTerm);
+        // The request owns a copy of the entries if they are shared with the other hosts
+        if (logs.use_count() == 1) {
+            req->set_log_str_list(std::move(logs->entries));
+        } else {
+            req->set_log_str_list(logs->entries);
         }
-        req->set_log_str_list(std::move(logs));
+        req->set_sending_snapshot(false);
+    } else if (part_->isWitness()) {
+        // The witness has no data to send, the follower waits for the next leader
+        LOG_EVERY_N(WARNING, 30) << idStr_ << "Can't find log " << lastLogIdInflight_ + 1
+                                   << " in wal, and a witness has no snapshot to send";
         req->set_sending_snapshot(false);
     } else {
         req->set_sending_snapshot(true);
         if (!sendingSnapshot_) {
-            LOG(INFO) << idStr_ << "Can't find log " << lastLogIdSent_ + 1
+            LOG(INFO) << idStr_ << "Can't find log " << lastLogIdInflight_ + 1
                       << " in wal, send the snapshot"
-                      << ", logIdToSend = " << logIdToSend_
+                      << ", logIdToSend = " << logIdToSend
                       << ", firstLogId in wal = " << part_->wal()->firstLogId()
                       << ", lastLogId in wal = " << part_->wal()->lastLogId();
             sendingSnapshot_ = true;
@@ -488,6 +592,7 @@ folly::Future<cpp2::AppendLogResponse> Host::sendAppendLogRequest(
         << ", last_log_id_sent " << req->get_last_log_id_sent();
     // Get client connection
     auto client = part_->clientMan_->client(addr_, eb, false, FLAGS_raft_rpc_timeout_ms);
+    RpcCompression::apply(client->getChannel());
     return client->future_appendLog(*req);
 }
 
@@ -552,7 +657,8 @@ folly::Future<cpp2::HeartbeatResponse> Host::sendHeartbeatRequest(
         << ", last_log_term_sent " << req->get_last_log_term_sent()
         << ", last_log_id_sent " << req->get_last_log_id_sent();
     // Get client connection
-    auto client = part_->clientMan_->client(addr_, eb, false, FLAGS_raft_rpc_timeout_ms);
+    auto client =
+        part_->controlClientMan_->client(addr_, eb, false, FLAGS_raft_rpc_timeout_ms);
     return client->future_heartbeat(*req);
 }
 
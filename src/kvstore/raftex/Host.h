@@ -11,6 +11,7 @@
 #include "common/interface/gen-cpp2/raftex_types.h"
 #include "common/interface/gen-cpp2/RaftexServiceAsyncClient.h"
 #include "common/thrift/ThriftClientManager.h"
+#include <folly/TokenBucket.h>
 #include <folly/futures/Future.h>
 
 namespace folly {
@@ -55,14 +56,17 @@ public:
 
     void reset() {
         std::unique_lock<std::mutex> g(lock_);
-        noMoreRequestCV_.wait(g, [this] { return !requestOnGoing_; });
+        noMoreRequestCV_.wait(g, [this] { return !requestOnGoing_ && inflight_ == 0; });
         logIdToSend_ = 0;
         logTermToSend_ = 0;
         lastLogIdSent_ = 0;
         lastLogTermSent_ = 0;
+        lastLogIdInflight_ = 0;
+        lastLogTermInflight_ = 0;
         committedLogId_ = 0;
         sendingSnapshot_ = false;
         followerCommittedLogId_ = 0;
+        ++epoch_;
     }
 
     void waitForStop();
@@ -100,6 +104,18 @@ public:
         return addr_;
     }
 
+    // The last time the follower accepted an appendLog request of the leader, which resets
+    // its election timer as a heartbeat does
+    int64_t lastAppendLogAcceptedMs() const {
+        return lastAppendLogAcceptedMs_;
+    }
+
+    // The last log the follower has accepted, as far as the leader knows
+    LogID lastLogIdSent() const {
+        std::lock_guard<std::mutex> g(lock_);
+        return lastLogIdSent_;
+    }
+
 private:
     cpp2::ErrorCode checkStatus() const;
 
@@ -107,9 +123,35 @@ private:
         folly::EventBase* eb,
         std::shared_ptr<cpp2::AppendLogRequest> req);
 
+    // Send the request, after the delay by raft_catch_up_rate_limit if the follower is
+    // catching up
     void appendLogsInternal(
         folly::EventBase* eb,
-        std::shared_ptr<cpp2::AppendLogRequest> req);
+        std::shared_ptr<cpp2::AppendLogRequest> req,
+        uint64_t epoch);
+
+    void doAppendLogs(
+        folly::EventBase* eb,
+        std::shared_ptr<cpp2::AppendLogRequest> req,
+        uint64_t epoch);
+
+    // Whether the follower is catching up from firstId, far behind the last log in the wal,
+    // see raft_catch_up_lag_logs
+    bool isCatchingUp(LogID firstId) const;
+
+    // How long the request to the follower catching up waits for the bandwidth
+    std::chrono::milliseconds catchUpDelay(const cpp2::AppendLogRequest& req);
+
+    // Handle the response of a request in current epoch, return the requests to send next
+    std::vector<std::shared_ptr<cpp2::AppendLogRequest>>
+    processAppendLogResponse(folly::Try<cpp2::AppendLogResponse>&& t);
+
+    // Prepare the requests of logs after lastLogIdInflight_, until the window of in-flight
+    // requests is full or all logs to send are in flight
+    std::vector<std::shared_ptr<cpp2::AppendLogRequest>> prepareInflightRequests();
+
+    // Drop the requests in flight, the logs after lastLogIdSent_ will be sent again
+    void rollback();
 
     folly::Future<cpp2::HeartbeatResponse> sendHeartbeatRequest(
         folly::EventBase* eb,
@@ -150,11 +192,24 @@ private:
     LogID lastLogIdSent_{0};
     TermID lastLogTermSent_{0};
 
+    // Up to raft_max_inflight_appendlog requests are sent without waiting for the responses,
+    // the logs are sent up to lastLogIdInflight_. The epoch is increased whenever the requests
+    // in flight are dropped, so their responses are ignored.
+    LogID lastLogIdInflight_{0};
+    TermID lastLogTermInflight_{0};
+    size_t inflight_{0};
+    uint64_t epoch_{0};
+
     LogID committedLogId_{0};
     std::atomic_bool sendingSnapshot_{false};
 
     // CommittedLogId of follower
     LogID followerCommittedLogId_{0};
+
+    std::atomic<int64_t> lastAppendLogAcceptedMs_{0};
+
+    // The bandwidth of the logs sent to the follower catching up, see raft_catch_up_rate_limit
+    folly::DynamicTokenBucket catchUpBucket_;
 };
 
 }  // namespace raftex
@@ -15,6 +15,7 @@
 #include <folly/io/async/EventBaseManager.h>
 #include <folly/executors/IOThreadPoolExecutor.h>
 #include <folly/gen/Base.h>
+#include <folly/TokenBucket.h>
 #include "kvstore/wal/FileBasedWal.h"
 #include "kvstore/raftex/LogStrListIterator.h"
 #include "kvstore/raftex/Host.h"
@@ -30,10 +31,50 @@ DEFINE_uint32(max_batch_size, 256, "The max number of logs in a batch");
 
 DEFINE_bool(trace_raft, false, "Enable trace one raft request");
 
+DEFINE_int32(raft_quiesce_idle_secs, 0,
+             "The leader without writes for so many seconds becomes quiescent, and its "
+             "heartbeats are sent in the node heartbeats, 0 means never");
+
+DEFINE_bool(raft_skip_heartbeat_after_append, false,
+            "Skip the heartbeat to the hosts which accepted an appendLog request in the last "
+            "half of heartbeat interval");
+
+DEFINE_bool(raft_apply_async, false,
+            "The leader fulfills the writes after the logs are applied in the background, "
+            "so replicating the next batch doesn't wait for the state machine. The logs are "
+            "applied by the threads of raft_apply_threads");
+
+DEFINE_int32(raft_buffer_full_wait_ms, 0,
+             "How long a write waits for the buffered logs to be sent when the buffer is full, "
+             "before it fails with E_BUFFER_OVERFLOW, 0 means failing at once");
+
+DEFINE_bool(raft_reject_disruptive_vote, false,
+            "Reject the vote requests while the leader is alive, i.e. a follower has heard from "
+            "it or a leader is accepted by the quorum in the last heartbeat interval, unless "
+            "the leader is being transferred to the candidate");
+
+DEFINE_int32(snapshot_recv_rate_limit, 0,
+             "The bandwidth of receiving the snapshot of each part in MB per sec, the batches "
+             "over it are refused with E_TOO_MANY_REQUESTS and sent again by the leader "
+             "later. 0 means unlimited.");
+
+DEFINE_bool(raft_parallel_wal_flush, false,
+            "The leader sends the logs to the followers before they are written and synced "
+            "into its WAL, and the logs are committed once both are done, so a batch costs "
+            "the slower of the two instead of the sum");
+
+DEFINE_bool(raft_share_log_entries, false,
+            "The log entries of an AppendLog request are read from the WAL once and shared by "
+            "the followers asking for the same logs, instead of once for each of them");
+
+DECLARE_uint32(max_appendlog_batch_size);
+DECLARE_uint32(raft_catch_up_batch_size);
 DECLARE_int32(wal_ttl);
 DECLARE_int64(wal_file_size);
 DECLARE_int32(wal_buffer_size);
 DECLARE_bool(wal_sync);
+DECLARE_bool(wal_preallocate);
+DECLARE_bool(wal_group_sync);
 
 namespace nebula {
 namespace raftex {
@@ -79,6 +120,11 @@ public:
         return hasNonAtomicOpLogs_;
     }
 
+    // Whether a COMMAND log has been iterated in the current batch
+    bool hasCommandLogs() const {
+        return hasCommandLogs_;
+    }
+
     LogID firstLogId() const {
         return firstLogId_;
     }
@@ -110,6 +156,9 @@ public:
     }
 
     LogIterator& operator++() override {
+        if (currLogType_ == LogType::COMMAND) {
+            hasCommandLogs_ = true;
+        }
         ++idx_;
         ++logId_;
         if (idx_ < logs_.size()) {
@@ -156,6 +205,11 @@ public:
         }
     }
 
+    // Whether the next log left is an AtomicOp, which is evaluated by resume()
+    bool atAtomicOp() const {
+        return idx_ < logs_.size() && std::get<1>(logs_.at(idx_)) == LogType::ATOMIC_OP;
+    }
+
     // Return true when there is no more log left for processing
     bool empty() const {
         return idx_ >= logs_.size();
@@ -164,6 +218,7 @@ public:
     // Resume the iterator so that we can continue to process the remaining logs
     void resume() {
         CHECK(!valid_);
+        hasCommandLogs_ = false;
         if (!empty()) {
             leadByAtomicOp_ = processAtomicOp();
             valid_ = idx_ < logs_.size();
@@ -182,6 +237,7 @@ private:
     size_t idx_{0};
     bool leadByAtomicOp_{false};
     bool hasNonAtomicOpLogs_{false};
+    bool hasCommandLogs_{false};
     bool valid_{true};
     LogType lastLogType_{LogType::NORMAL};
     LogType currLogType_{LogType::NORMAL};
@@ -225,12 +281,16 @@ RaftPart::RaftPart(
         , executor_(executor)
         , snapshot_(snapshotMan)
         , clientMan_(clientMan)
+        , controlIoThreadPool_{pool}
+        , controlClientMan_(clientMan)
         , diskMan_(diskMan)
         , weight_(1) {
     FileBasedWalPolicy policy;
     policy.fileSize = FLAGS_wal_file_size;
     policy.bufferSize = FLAGS_wal_buffer_size;
     policy.sync = FLAGS_wal_sync;
+    policy.preallocate = FLAGS_wal_preallocate;
+    policy.groupSync = FLAGS_wal_group_sync;
     FileBasedWalInfo info;
     info.idStr_ = idStr_;
     info.spaceId_ = spaceId_;
@@ -274,6 +334,24 @@ const char* RaftPart::roleStr(Role role) const {
 }
 
 
+void RaftPart::setWitnesses(std::set<HostAddr> witnesses) {
+    std::lock_guard<std::mutex> g(raftLock_);
+    witnesses_ = std::move(witnesses);
+    witness_ = witnesses_.count(addr_) != 0;
+}
+
+void RaftPart::setControlChannel(
+        std::shared_ptr<folly::IOThreadPoolExecutor> pool,
+        std::shared_ptr<thrift::ThriftClientManager<cpp2::RaftexServiceAsyncClient>> clientMan) {
+    CHECK(pool != nullptr && clientMan != nullptr);
+    controlIoThreadPool_ = std::move(pool);
+    controlClientMan_ = std::move(clientMan);
+}
+
+void RaftPart::setApplyExecutor(std::shared_ptr<folly::Executor> executor) {
+    applyExecutor_ = std::move(executor);
+}
+
 void RaftPart::start(std::vector<HostAddr>&& peers, bool asLearner) {
     std::lock_guard<std::mutex> g(raftLock_);
 
@@ -292,6 +370,7 @@ void RaftPart::start(std::vector<HostAddr>&& peers, bool asLearner) {
                   << " to be the committedLogId " << committedLogId_;
         lastLogId_ = committedLogId_;
         lastLogTerm_ = term_;
+        waitWalFlushed();
         wal_->reset();
     }
     LOG(INFO) << idStr_ << "There are "
@@ -300,6 +379,7 @@ void RaftPart::start(std::vector<HostAddr>&& peers, bool asLearner) {
                         << peers.size() + 1
                         << " copies. The quorum is " << quorum_ + 1
                         << ", as learner " << asLearner
+                        << ", as witness " << witness_
                         << ", lastLogId " << lastLogId_
                         << ", lastLogTerm " << lastLogTerm_
                         << ", committedLogId " << committedLogId_
@@ -338,6 +418,7 @@ void RaftPart::stop() {
 
         hosts = std::move(hosts_);
     }
+    waitApplied();
 
     for (auto& h : hosts) {
         h->stop();
@@ -403,6 +484,7 @@ void RaftPart::preProcessTransLeader(const HostAddr& target) {
         case Role::FOLLOWER: {
             if (target != addr_ && target != HostAddr("", 0)) {
                 LOG(INFO) << idStr_ << "I am follower, just wait for the new leader.";
+                transferTarget_ = target;
             } else {
                 LOG(INFO) << idStr_ << "I will be the new leader, trigger leader election now!";
                 bgWorkers_->addTask([self = shared_from_this()] {
@@ -627,11 +709,19 @@ folly::Future<AppendLogResult> RaftPart::appendLogAsync(ClusterID source,
              return AppendLogResult::E_WRITE_BLOCKING;
          }
     }
+    if (witness_ && ((logType == LogType::NORMAL && !log.empty()) ||
+                     logType == LogType::ATOMIC_OP)) {
+        // A witness leader has no data to check the writes, which wait for the next leader
+        return AppendLogResult::E_NOT_A_LEADER;
+    }
+    if (FLAGS_raft_quiesce_idle_secs > 0 && (logType != LogType::NORMAL || !log.empty())) {
+        wakeUp();
+    }
 
     LogCache swappedOutLogs;
     auto retFuture = folly::Future<AppendLogResult>::makeEmpty();
 
-    if (bufferOverFlow_) {
+    if (bufferOverFlow_ && FLAGS_raft_buffer_full_wait_ms <= 0) {
         LOG_EVERY_N(WARNING, 100) << idStr_
                      << "The appendLog buffer is full."
                         " Please slow down the log appending rate."
@@ -639,10 +729,16 @@ folly::Future<AppendLogResult> RaftPart::appendLogAsync(ClusterID source,
         return AppendLogResult::E_BUFFER_OVERFLOW;
     }
     {
-        std::lock_guard<std::mutex> lck(logsLock_);
+        std::unique_lock<std::mutex> lck(logsLock_);
 
         VLOG(2) << idStr_ << "Checking whether buffer overflow";
 
+        if (logs_.size() >= FLAGS_max_batch_size && FLAGS_raft_buffer_full_wait_ms > 0) {
+            // Back pressure, wait for the buffer to be swapped out by the replication
+            logsCond_.wait_for(lck,
+                               std::chrono::milliseconds(FLAGS_raft_buffer_full_wait_ms),
+                               [this] { return logs_.size() < FLAGS_max_batch_size; });
+        }
         if (logs_.size() >= FLAGS_max_batch_size) {
             // Buffer is full
             LOG(WARNING) << idStr_
@@ -677,6 +773,7 @@ folly::Future<AppendLogResult> RaftPart::appendLogAsync(ClusterID source,
             sendingPromise_ = std::move(cachingPromise_);
             cachingPromise_.reset();
             std::swap(swappedOutLogs, logs_);
+            logs_.reserve(FLAGS_max_batch_size);
             bufferOverFlow_ = false;
         } else {
             VLOG(2) << idStr_
@@ -707,6 +804,31 @@ folly::Future<AppendLogResult> RaftPart::appendLogAsync(ClusterID source,
     // until majority accept the logs, the leadership changes, or
     // the partition stops
     VLOG(2) << idStr_ << "Calling appendLogsInternal()";
+    if (std::get<1>(swappedOutLogs.front()) == LogType::ATOMIC_OP && !applied()) {
+        // The AtomicOp reads the state machine, so it is evaluated after the logs before are
+        // applied, in the executor instead of blocking the caller
+        appliedFuture()
+            .via(executor_.get())
+            .thenValue([self = shared_from_this(), firstId, termId,
+                        logs = std::move(swappedOutLogs)] (auto&&) mutable {
+                self->appendLogsInternal(
+                    AppendLogsIterator(
+                        firstId,
+                        termId,
+                        std::move(logs),
+                        [raw = self.get()] (AtomicOp opCB) -> folly::Optional<std::string> {
+                            CHECK(opCB != nullptr);
+                            auto opRet = opCB();
+                            if (!opRet.hasValue()) {
+                                raw->sendingPromise_.setOneSingleValue(
+                                    AppendLogResult::E_ATOMIC_OP_FAILURE);
+                            }
+                            return opRet;
+                        }),
+                    termId);
+            });
+        return retFuture;
+    }
     AppendLogsIterator it(
         firstId,
         termId,
@@ -751,9 +873,11 @@ void RaftPart::appendLogsInternal(AppendLogsIterator iter, TermID termId) {
         prevLogId = lastLogId_;
         prevLogTerm = lastLogTerm_;
         committed = committedLogId_;
-        // Step 1: Write WAL
+        // Step 1: Write WAL, which is only buffered when flushed in parallel with the
+        // replication, the hosts read the logs from the buffer
         SlowOpTracker tracker;
-        if (!wal_->appendLogs(iter)) {
+        waitWalFlushed();
+        if (!wal_->appendLogs(iter, !FLAGS_raft_parallel_wal_flush)) {
             LOG_EVERY_N(WARNING, 100) << idStr_ << "Failed to write into WAL";
             res = AppendLogResult::E_WAL_FAILURE;
             break;
@@ -771,6 +895,10 @@ void RaftPart::appendLogsInternal(AppendLogsIterator iter, TermID termId) {
         LOG_EVERY_N(WARNING, 100) << idStr_ << "Failed to write wal";
         return;
     }
+    if (FLAGS_raft_parallel_wal_flush) {
+        std::lock_guard<std::mutex> g(walFlushLock_);
+        walFlushing_ = true;
+    }
     // Step 2: Replicate to followers
     auto* eb = ioThreadPool_->getEventBase();
     replicateLogs(eb,
@@ -780,10 +908,72 @@ void RaftPart::appendLogsInternal(AppendLogsIterator iter, TermID termId) {
                   committed,
                   prevLogTerm,
                   prevLogId);
+    if (FLAGS_raft_parallel_wal_flush) {
+        // The requests are sent in the io threads, the logs are flushed meanwhile. The
+        // responses wait for it before the logs are committed, see processAppendLogResponses
+        SlowOpTracker tracker;
+        wal_->flush();
+        if (tracker.slow()) {
+            tracker.output(idStr_, folly::stringPrintf("Flush WAL, total %ld",
+                                                       lastId - prevLogId));
+        }
+        std::lock_guard<std::mutex> g(walFlushLock_);
+        walFlushing_ = false;
+        walFlushCond_.notify_all();
+    }
     return;
 }
 
 
+void RaftPart::waitWalFlushed() {
+    std::unique_lock<std::mutex> lck(walFlushLock_);
+    walFlushCond_.wait(lck, [this] { return !walFlushing_; });
+}
+
+
+std::shared_ptr<RaftPart::LogEntries>
+RaftPart::logEntriesToSend(TermID term, LogID firstId, LogID lastId, bool catchUp) {
+    auto key = std::make_tuple(term, firstId, lastId);
+    // the old logs read for a follower catching up are rarely asked for by another one
+    bool share = FLAGS_raft_share_log_entries && !catchUp;
+    if (share) {
+        std::lock_guard<std::mutex> g(logEntriesLock_);
+        for (const auto& cached : sharedLogEntries_) {
+            if (cached.first == key) {
+                return cached.second;
+            }
+        }
+    }
+
+    auto it = wal_->iterator(firstId, lastId);
+    if (!it->valid()) {
+        return nullptr;
+    }
+    auto logs = std::make_shared<LogEntries>();
+    logs->logTerm = it->logTerm();
+    size_t batchSize = catchUp ? FLAGS_raft_catch_up_batch_size : FLAGS_max_appendlog_batch_size;
+    for (size_t cnt = 0;
+         it->valid()
+            && it->logTerm() == logs->logTerm
+            && cnt < batchSize;
+         ++(*it), ++cnt) {
+        cpp2::LogEntry le;
+        le.set_cluster(it->logSource());
+        le.set_log_str(it->logMsg().toString());
+        logs->entries.emplace_back(std::move(le));
+    }
+
+    if (share) {
+        std::lock_guard<std::mutex> g(logEntriesLock_);
+        sharedLogEntries_.emplace_back(key, logs);
+        if (sharedLogEntries_.size() > kSharedLogEntries) {
+            sharedLogEntries_.pop_front();
+        }
+    }
+    return logs;
+}
+
+
 void RaftPart::replicateLogs(folly::EventBase* eb,
                              AppendLogsIterator iter,
                              TermID currTerm,
@@ -897,6 +1087,8 @@ void RaftPart::processAppendLogResponses(
         // Majority have succeeded
         VLOG(2) << idStr_ << numSucceeded
                 << " hosts have accepted the logs";
+        // The leader itself is one of the quorum only once the logs are in its WAL
+        waitWalFlushed();
 
         LogID firstLogId = 0;
         AppendLogResult res = AppendLogResult::SUCCEEDED;
@@ -917,7 +1109,51 @@ void RaftPart::processAppendLogResponses(
             return;
         }
 
-        {
+        // The AtomicOp is evaluated against the state machine, and the COMMAND log might
+        // take the raftLock_, so only the other batches are applied in the background
+        if (FLAGS_raft_apply_async && applyExecutor_ != nullptr &&
+            !iter.leadByAtomicOp() && !iter.hasCommandLogs()) {
+            // Step 4: The promise is fulfilled after the batch is applied
+            folly::Optional<folly::SharedPromise<AppendLogResult>> promise;
+            if (iter.hasNonAtomicOpLogs()) {
+                promise = sendingPromise_.takeOneShared();
+            }
+            // Step 3: Commit the batch, which is applied in order after the previous ones. It
+            // is enqueued with the raftLock_ held, so once the part is not the leader, the
+            // commits of any other way see it by applied()
+            {
+                std::lock_guard<std::mutex> g(raftLock_);
+                // the leader steps down when a batch before fails to apply
+                res = canAppendLogs(currTerm);
+                if (res == AppendLogResult::SUCCEEDED) {
+                    committedLogId_ = lastLogId;
+                    firstLogId = lastLogId_ + 1;
+                    lastMsgAcceptedCostMs_ = lastMsgSentDur_.elapsedInMSec();
+                    lastMsgAcceptedTime_ = time::WallClock::fastNowInMilliSec();
+                    commitInThisTerm_ = true;
+                    applyAsync(committedId, lastLogId, std::move(promise));
+                }
+            }
+            if (res != AppendLogResult::SUCCEEDED) {
+                if (promise.hasValue()) {
+                    promise->setValue(res);
+                }
+                checkAppendLogResult(res);
+                return;
+            }
+        } else if (!applied()) {
+            // The batches applied in the background go first, without blocking the executor
+            appliedFuture()
+                .via(executor_.get())
+                .thenValue([self = shared_from_this(), resps, eb, iter = std::move(iter),
+                            currTerm, lastLogId, committedId, prevLogTerm, prevLogId,
+                            hosts = std::move(hosts)] (auto&&) mutable {
+                    self->processAppendLogResponses(resps, eb, std::move(iter), currTerm,
+                                                    lastLogId, committedId, prevLogTerm,
+                                                    prevLogId, std::move(hosts));
+                });
+            return;
+        } else {
             auto walIt = wal_->iterator(committedId + 1, lastLogId);
             SlowOpTracker tracker;
             // Step 3: Commit the batch
@@ -937,57 +1173,18 @@ void RaftPart::processAppendLogResponses(
             }
             VLOG(2) << idStr_ << "Leader succeeded in committing the logs "
                               << committedId + 1 << " to " << lastLogId;
-        }
 
-        // Step 4: Fulfill the promise
-        if (iter.hasNonAtomicOpLogs()) {
-            sendingPromise_.setOneSharedValue(AppendLogResult::SUCCEEDED);
-        }
-        if (iter.leadByAtomicOp()) {
-            sendingPromise_.setOneSingleValue(AppendLogResult::SUCCEEDED);
+            // Step 4: Fulfill the promise
+            if (iter.hasNonAtomicOpLogs()) {
+                sendingPromise_.setOneSharedValue(AppendLogResult::SUCCEEDED);
+            }
+            if (iter.leadByAtomicOp()) {
+                sendingPromise_.setOneSingleValue(AppendLogResult::SUCCEEDED);
+            }
         }
         // Step 5: Check whether need to continue
         // the log replication
-        {
-            std::lock_guard<std::mutex> lck(logsLock_);
-            CHECK(replicatingLogs_);
-            // Continue to process the original AppendLogsIterator if necessary
-            iter.resume();
-            // If no more valid logs to be replicated in iter, create a new one if we have new log
-            if (iter.empty()) {
-                VLOG(2) << idStr_ << "logs size " << logs_.size();
-                if (logs_.size() > 0) {
-                    // continue to replicate the logs
-                    sendingPromise_ = std::move(cachingPromise_);
-                    cachingPromise_.reset();
-                    iter = AppendLogsIterator(
-                        firstLogId,
-                        currTerm,
-                        std::move(logs_),
-                        [this] (AtomicOp op) -> folly::Optional<std::string> {
-                            auto opRet = op();
-                            if (!opRet.hasValue()) {
-                                // Failed
-                                sendingPromise_.setOneSingleValue(
-                                    AppendLogResult::E_ATOMIC_OP_FAILURE);
-                            }
-                            return opRet;
-                        });
-                    logs_.clear();
-                    bufferOverFlow_ = false;
-                }
-                // Reset replicatingLogs_ one of the following is true:
-                // 1. old iter is empty && logs_.size() == 0
-                // 2. old iter is empty && logs_.size() > 0, but all logs in new iter is atomic op,
-                //    and all of them failed, which would make iter is empty again
-                if (iter.empty()) {
-                    replicatingLogs_ = false;
-                    VLOG(2) << idStr_ << "No more log to be replicated";
-                    return;
-                }
-            }
-        }
-        this->appendLogsInternal(std::move(iter), currTerm);
+        replicateNextLogs(std::move(iter), firstLogId, currTerm);
     } else {
         // Not enough hosts accepted the log, re-try
         LOG_EVERY_N(WARNING, 100) << idStr_ << "Only " << numSucceeded
@@ -1003,6 +1200,173 @@ void RaftPart::processAppendLogResponses(
 }
 
 
+void RaftPart::replicateNextLogs(AppendLogsIterator iter, LogID firstLogId, TermID currTerm) {
+    {
+        std::lock_guard<std::mutex> lck(logsLock_);
+        CHECK(replicatingLogs_);
+        // The AtomicOp reads the state machine, so it is evaluated after the batches applied in
+        // the background, which are waited for without blocking the executor
+        bool atomicOpNext = iter.empty()
+            ? !logs_.empty() && std::get<1>(logs_.front()) == LogType::ATOMIC_OP
+            : iter.atAtomicOp();
+        if (atomicOpNext && !applied()) {
+            appliedFuture()
+                .via(executor_.get())
+                .thenValue([self = shared_from_this(), iter = std::move(iter), firstLogId,
+                            currTerm] (auto&&) mutable {
+                    self->replicateNextLogs(std::move(iter), firstLogId, currTerm);
+                });
+            return;
+        }
+        // Continue to process the original AppendLogsIterator if necessary
+        iter.resume();
+        // If no more valid logs to be replicated in iter, create a new one if we have new log
+        if (iter.empty()) {
+            VLOG(2) << idStr_ << "logs size " << logs_.size();
+            if (logs_.size() > 0) {
+                // continue to replicate the logs
+                sendingPromise_ = std::move(cachingPromise_);
+                cachingPromise_.reset();
+                iter = AppendLogsIterator(
+                    firstLogId,
+                    currTerm,
+                    std::move(logs_),
+                    [this] (AtomicOp op) -> folly::Optional<std::string> {
+                        auto opRet = op();
+                        if (!opRet.hasValue()) {
+                            // Failed
+                            sendingPromise_.setOneSingleValue(
+                                AppendLogResult::E_ATOMIC_OP_FAILURE);
+                        }
+                        return opRet;
+                    });
+                logs_.clear();
+                logs_.reserve(FLAGS_max_batch_size);
+                bufferOverFlow_ = false;
+                logsCond_.notify_all();
+            }
+            // Reset replicatingLogs_ one of the following is true:
+            // 1. old iter is empty && logs_.size() == 0
+            // 2. old iter is empty && logs_.size() > 0, but all logs in new iter is atomic op,
+            //    and all of them failed, which would make iter is empty again
+            if (iter.empty()) {
+                replicatingLogs_ = false;
+                VLOG(2) << idStr_ << "No more log to be replicated";
+                return;
+            }
+        }
+    }
+    this->appendLogsInternal(std::move(iter), currTerm);
+}
+
+
+void RaftPart::applyAsync(LogID committedId,
+                          LogID lastLogId,
+                          folly::Optional<folly::SharedPromise<AppendLogResult>> promise) {
+    std::lock_guard<std::mutex> g(applyLock_);
+    ++applyingBatches_;
+    applyChain_ = std::move(applyChain_)
+        .via(applyExecutor_.get())
+        .thenValue([self = shared_from_this(), committedId, lastLogId,
+                    promise = std::move(promise)] (auto&&) mutable {
+            bool failed = false;
+            {
+                std::lock_guard<std::mutex> lck(self->applyLock_);
+                failed = self->applyFailed_;
+            }
+            if (!failed) {
+                SlowOpTracker tracker;
+                auto walIt = self->wal_->iterator(committedId + 1, lastLogId);
+                auto code = self->commitLogs(std::move(walIt), true);
+                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    LOG(ERROR) << self->idStr_ << "Failed to apply the logs " << committedId + 1
+                               << " to " << lastLogId << ", error "
+                               << apache::thrift::util::enumNameSafe(code) << ", step down";
+                    failed = true;
+                    self->stepDownOnApplyFailure(committedId);
+                } else {
+                    if (tracker.slow()) {
+                        tracker.output(self->idStr_, folly::stringPrintf(
+                            "Total commit: %ld", lastLogId - committedId));
+                    }
+                    VLOG(2) << self->idStr_ << "Leader succeeded in applying the logs "
+                                            << committedId + 1 << " to " << lastLogId;
+                }
+            }
+            std::vector<folly::Promise<folly::Unit>> waiters;
+            {
+                std::lock_guard<std::mutex> lck(self->applyLock_);
+                ++self->appliedBatches_;
+                if (failed) {
+                    self->applyFailed_ = true;
+                }
+                // the chain is drained, the logs not applied are committed again as a follower
+                if (self->appliedBatches_ >= self->applyingBatches_) {
+                    self->applyFailed_ = false;
+                }
+                auto& all = self->appliedWaiters_;
+                auto it = std::partition(all.begin(), all.end(), [&self] (const auto& w) {
+                    return w.first > self->appliedBatches_;
+                });
+                for (auto w = it; w != all.end(); ++w) {
+                    waiters.emplace_back(std::move(w->second));
+                }
+                all.erase(it, all.end());
+            }
+            self->applyCond_.notify_all();
+            for (auto& p : waiters) {
+                p.setValue();
+            }
+            if (promise.hasValue()) {
+                promise->setValue(failed ? AppendLogResult::E_NOT_A_LEADER
+                                         : AppendLogResult::SUCCEEDED);
+            }
+        });
+}
+
+
+void RaftPart::stepDownOnApplyFailure(LogID committedId) {
+    TermID oldTerm = 0;
+    {
+        std::lock_guard<std::mutex> g(raftLock_);
+        // The logs from the failed batch are committed again as a follower
+        committedLogId_ = std::min(committedLogId_, committedId);
+        if (role_ != Role::LEADER) {
+            return;
+        }
+        role_ = Role::FOLLOWER;
+        leader_ = HostAddr("", 0);
+        oldTerm = term_;
+    }
+    bgWorkers_->addTask([self = shared_from_this(), oldTerm] {
+        self->onLostLeadership(oldTerm);
+    });
+}
+
+
+void RaftPart::waitApplied() {
+    std::unique_lock<std::mutex> lck(applyLock_);
+    auto target = applyingBatches_;
+    applyCond_.wait(lck, [this, target] { return appliedBatches_ >= target; });
+}
+
+
+bool RaftPart::applied() {
+    std::lock_guard<std::mutex> lck(applyLock_);
+    return appliedBatches_ >= applyingBatches_;
+}
+
+
+folly::Future<folly::Unit> RaftPart::appliedFuture() {
+    std::lock_guard<std::mutex> lck(applyLock_);
+    if (appliedBatches_ >= applyingBatches_) {
+        return folly::makeFuture();
+    }
+    appliedWaiters_.emplace_back(applyingBatches_, folly::Promise<folly::Unit>());
+    return appliedWaiters_.back().second.getFuture();
+}
+
+
 bool RaftPart::needToSendHeartbeat() {
     std::lock_guard<std::mutex> g(raftLock_);
     return status_ == Status::RUNNING && role_ == Role::LEADER;
@@ -1013,8 +1377,9 @@ bool RaftPart::needToStartElection() {
     std::lock_guard<std::mutex> g(raftLock_);
     if (status_ == Status::RUNNING &&
         role_ == Role::FOLLOWER &&
-        (lastMsgRecvDur_.elapsedInMSec() >= weight_ * FLAGS_raft_heartbeat_interval_secs * 1000 ||
-         isBlindFollower_)) {
+        (lastMsgRecvDur_.elapsedInMSec() >=
+             (witness_ ? 2 : 1) * weight_ * FLAGS_raft_heartbeat_interval_secs * 1000 ||
+         (isBlindFollower_ && !witness_))) {
         LOG(INFO) << idStr_ << "Start leader election, reason: lastMsgDur "
                   << lastMsgRecvDur_.elapsedInMSec()
                   << ", term " << term_;
@@ -1130,6 +1495,7 @@ typename RaftPart::Role RaftPart::processElectionResponses(
         term_ = proposedTerm;
         role_ = Role::LEADER;
         isBlindFollower_ = false;
+        wakeUp();
     }
 
     return role_;
@@ -1181,7 +1547,7 @@ bool RaftPart::leaderElection() {
     if (hosts.empty()) {
         VLOG(2) << idStr_ << "No peer found, I will be the leader";
     } else {
-        auto eb = ioThreadPool_->getEventBase();
+        auto eb = controlIoThreadPool_->getEventBase();
         auto futures = collectNSucceeded(
             gen::from(hosts)
             | gen::map([eb, self = shared_from_this(), &voteReq] (auto& host) {
@@ -1284,8 +1650,15 @@ void RaftPart::statusPolling(int64_t startTime) {
             delay = (folly::Random::rand32(1500) + 500) * weight_;
         }
     } else if (needToSendHeartbeat()) {
-        VLOG(2) << idStr_ << "Need to send heartbeat";
-        sendHeartbeat();
+        bool isQuiescent = false;
+        {
+            std::lock_guard<std::mutex> g(raftLock_);
+            isQuiescent = quiescent();
+        }
+        if (!isQuiescent) {
+            VLOG(2) << idStr_ << "Need to send heartbeat";
+            sendHeartbeat();
+        }
     }
     if (needToCleanupSnapshot()) {
         LOG(INFO) << idStr_ << "Clean up the snapshot";
@@ -1313,7 +1686,12 @@ bool RaftPart::needToCleanupSnapshot() {
 
 void RaftPart::cleanupSnapshot() {
     LOG(INFO) << idStr_ << "Clean up the snapshot";
+    waitApplied();
     std::lock_guard<std::mutex> g(raftLock_);
+    // tried again by the next check
+    if (!applied()) {
+        return;
+    }
     reset();
     status_ = Status::RUNNING;
 }
@@ -1331,6 +1709,22 @@ bool RaftPart::needToCleanWal() {
     return true;
 }
 
+LogID RaftPart::lowestLogIdOfPeers() {
+    decltype(hosts_) hosts;
+    {
+        std::lock_guard<std::mutex> g(raftLock_);
+        if (role_ != Role::LEADER) {
+            return std::numeric_limits<LogID>::max();
+        }
+        hosts = hosts_;
+    }
+    auto lowest = std::numeric_limits<LogID>::max();
+    for (auto& host : hosts) {
+        lowest = std::min(lowest, host->lastLogIdSent());
+    }
+    return lowest;
+}
+
 void RaftPart::processAskForVoteRequest(
         const cpp2::AskForVoteRequest& req,
         cpp2::AskForVoteResponse& resp) {
@@ -1346,6 +1740,8 @@ void RaftPart::processAskForVoteRequest(
               << ", lastLogTerm = " << req.get_last_log_term();
 
     std::lock_guard<std::mutex> g(raftLock_);
+    // Some peer has missed the heartbeats, so the leader can't be quiescent
+    wakeUp();
 
     // Make sure the partition is running
     if (UNLIKELY(status_ == Status::STOPPED)) {
@@ -1378,6 +1774,15 @@ void RaftPart::processAskForVoteRequest(
     }
 
     auto candidate = HostAddr(req.get_candidate_addr(), req.get_candidate_port());
+    // A peer which missed the heartbeats for a while, e.g. restarted or partitioned, would
+    // depose a healthy leader by the higher term it proposes
+    if (FLAGS_raft_reject_disruptive_vote && leaderAlive() && candidate != transferTarget_) {
+        LOG(INFO) << idStr_ << "The leader " << leader_ << " is still alive, "
+                  << "so the candidate " << candidate << " will be rejected";
+        resp.set_error_code(cpp2::ErrorCode::E_BAD_STATE);
+        return;
+    }
+
     // Check term id
     auto term = term_;
     if (req.get_term() <= term) {
@@ -1443,12 +1848,14 @@ void RaftPart::processAskForVoteRequest(
     if (role_ == Role::LEADER && wal_->lastLogId() > lastLogId_) {
         LOG(INFO) << idStr_ << "There is one log " << wal_->lastLogId()
                   << " i did not commit when i was leader, rollback to " << lastLogId_;
+        waitWalFlushed();
         wal_->rollbackToLog(lastLogId_);
     }
     role_ = Role::FOLLOWER;
     votedAddr_ = candidate;
     proposedTerm_ = req.get_term();
     leader_ = HostAddr("", 0);
+    transferTarget_ = HostAddr("", 0);
 
     // Reset the last message time
     lastMsgRecvDur_.reset();
@@ -1479,6 +1886,9 @@ void RaftPart::processAppendLogRequest(
         << ", local lastLogTerm = " << lastLogTerm_
         << ", local committedLogId = " << committedLogId_
         << ", local current term = " << term_;
+    // The batches applied in the background when it was the leader are waited for without the
+    // raftLock_ held, the ones enqueued meanwhile are checked by applied() below
+    waitApplied();
     std::lock_guard<std::mutex> g(raftLock_);
 
     resp.set_current_term(term_);
@@ -1511,8 +1921,13 @@ void RaftPart::processAppendLogRequest(
 
     // Reset the timeout timer
     lastMsgRecvDur_.reset();
+    leaderCommittedLogId_ = req.get_committed_log_id();
 
     if (req.get_sending_snapshot() && status_ != Status::WAITING_SNAPSHOT) {
+        if (!applied()) {
+            resp.set_error_code(cpp2::ErrorCode::E_NOT_READY);
+            return;
+        }
         LOG(INFO) << idStr_ << "Begin to wait for the snapshot"
                   << " " << req.get_committed_log_id();
         reset();
@@ -1545,6 +1960,7 @@ void RaftPart::processAppendLogRequest(
         LogStrListIterator iter(firstId,
                                 req.get_log_term(),
                                 req.get_log_str_list());
+        waitWalFlushed();
         if (wal_->appendLogs(iter)) {
             // When leader has been sending a snapshot already, sometimes it would send a request
             // with empty log list, and lastLogId in wal may be 0 because of reset.
@@ -1571,6 +1987,10 @@ void RaftPart::processAppendLogRequest(
         resp.set_error_code(cpp2::ErrorCode::E_LOG_STALE);
         return;
     } else if (req.get_last_log_id_sent() < committedLogId_) {
+        if (!applied()) {
+            resp.set_error_code(cpp2::ErrorCode::E_NOT_READY);
+            return;
+        }
         LOG(INFO) << idStr_ << "What?? How it happens! The log id is "
                   <<  req.get_last_log_id_sent()
                   << ", the log term is " << req.get_last_log_term_sent()
@@ -1592,6 +2012,7 @@ void RaftPart::processAppendLogRequest(
                 << req.get_last_log_term_sent()
                 << ", the prevLogId is " << req.get_last_log_id_sent()
                 << ". So need to rollback to last committedLogId_ " << committedLogId_;
+        waitWalFlushed();
         if (wal_->rollbackToLog(committedLogId_)) {
             lastLogId_ = wal_->lastLogId();
             lastLogTerm_ = wal_->lastLogTerm();
@@ -1636,6 +2057,7 @@ void RaftPart::processAppendLogRequest(
     LogStrListIterator iter(firstId,
                             req.get_log_term(),
                             req.get_log_str_list());
+    waitWalFlushed();
     if (wal_->appendLogs(iter)) {
         if (numLogs != 0) {
             CHECK_EQ(firstId + numLogs - 1, wal_->lastLogId()) << "First Id is " << firstId;
@@ -1651,7 +2073,9 @@ void RaftPart::processAppendLogRequest(
     }
 
     LogID lastLogIdCanCommit = std::min(lastLogId_, req.get_committed_log_id());
-    if (lastLogIdCanCommit > committedLogId_) {
+    // The logs are committed by the upcoming requests, if the batches applied in the background
+    // are not done yet
+    if (lastLogIdCanCommit > committedLogId_ && applied()) {
         // Commit some logs
         // We can only commit logs from firstId to min(lastLogId_, leader's commit log id),
         // follower can't always commit to leader's commit id because of lack of log
@@ -1758,6 +2182,7 @@ cpp2::ErrorCode RaftPart::verifyLeader(const REQ& req) {
     if (wal_->lastLogId() > lastLogId_) {
         LOG(INFO) << idStr_ << "There is one log " << wal_->lastLogId()
                   << " i did not commit when i was leader, rollback to " << lastLogId_;
+        waitWalFlushed();
         wal_->rollbackToLog(lastLogId_);
     }
     if (oldRole == Role::LEADER) {
@@ -1822,6 +2247,7 @@ void RaftPart::processHeartbeatRequest(
 
     // Reset the timeout timer
     lastMsgRecvDur_.reset();
+    leaderCommittedLogId_ = req.get_committed_log_id();
 
     // As for heartbeat, return ok after verifyLeader
     resp.set_error_code(cpp2::ErrorCode::SUCCEEDED);
@@ -1834,6 +2260,22 @@ void RaftPart::processSendSnapshotRequest(const cpp2::SendSnapshotRequest& req,
             << ", total count received " << req.get_total_count()
             << ", total size received " << req.get_total_size()
             << ", finished " << req.get_done();
+    if (FLAGS_snapshot_recv_rate_limit > 0) {
+        // The leader waits for the response before sending the next batch, so it is slowed
+        // down as well. The worker thread is never blocked here, the batch over the rate is
+        // refused and the leader sends it again later.
+        double bytes = 0;
+        for (const auto& row : req.get_rows()) {
+            bytes += row.size();
+        }
+        double rate = FLAGS_snapshot_recv_rate_limit * 1024.0 * 1024.0;
+        if (!snapshotRecvBucket_.consume(bytes, rate, std::max(rate, bytes))) {
+            VLOG(2) << idStr_ << "Receiving snapshot is over the rate limit";
+            resp.set_error_code(cpp2::ErrorCode::E_TOO_MANY_REQUESTS);
+            return;
+        }
+    }
+    waitApplied();
     std::lock_guard<std::mutex> g(raftLock_);
     // Check status
     if (UNLIKELY(status_ == Status::STOPPED)) {
@@ -1859,6 +2301,11 @@ void RaftPart::processSendSnapshotRequest(const cpp2::SendSnapshotRequest& req,
         resp.set_error_code(cpp2::ErrorCode::E_TERM_OUT_OF_DATE);
         return;
     }
+    // The batches applied in the background when it was the leader are enqueued meanwhile
+    if (!applied()) {
+        resp.set_error_code(cpp2::ErrorCode::E_NOT_READY);
+        return;
+    }
     if (status_ != Status::WAITING_SNAPSHOT) {
         LOG(INFO) << idStr_ << "Begin to receive the snapshot";
         reset();
@@ -1889,6 +2336,7 @@ void RaftPart::processSendSnapshotRequest(const cpp2::SendSnapshotRequest& req,
         }
         if (wal_->lastLogId() <= committedLogId_) {
             LOG(INFO) << idStr_ << "Reset invalid wal after snapshot received";
+            waitWalFlushed();
             wal_->reset();
         }
         status_ = Status::RUNNING;
@@ -1909,7 +2357,6 @@ void RaftPart::sendHeartbeat() {
         });
     }
 
-    using namespace folly;  // NOLINT since the fancy overload of | operator
     VLOG(2) << idStr_ << "Send heartbeat";
     TermID currTerm = 0;
     LogID latestLogId = 0;
@@ -1928,9 +2375,36 @@ void RaftPart::sendHeartbeat() {
         replica = quorum_;
         hosts = hosts_;
     }
-    auto eb = ioThreadPool_->getEventBase();
     auto startMs = time::WallClock::fastNowInMilliSec();
-    collectNSucceeded(
+    if (FLAGS_raft_skip_heartbeat_after_append) {
+        // The hosts which accepted an appendLog recently don't need the heartbeat, they are
+        // not counted for the lease either, which is renewed when the logs are committed.
+        int64_t skipMs = FLAGS_raft_heartbeat_interval_secs * 1000 / 2;
+        hosts.erase(std::remove_if(hosts.begin(), hosts.end(),
+                                   [startMs, skipMs] (const std::shared_ptr<Host>& host) {
+                                       return startMs - host->lastAppendLogAcceptedMs() < skipMs;
+                                   }),
+                    hosts.end());
+        if (hosts.empty()) {
+            VLOG(2) << idStr_ << "All hosts have accepted logs recently, skip heartbeat";
+            return;
+        }
+    }
+    sendHeartbeatTo(std::move(hosts), currTerm, latestLogId, commitLogId,
+                    prevLogTerm, prevLogId, replica);
+}
+
+folly::Future<bool> RaftPart::sendHeartbeatTo(std::vector<std::shared_ptr<Host>> hosts,
+                                              TermID currTerm,
+                                              LogID latestLogId,
+                                              LogID commitLogId,
+                                              TermID prevLogTerm,
+                                              LogID prevLogId,
+                                              size_t replica) {
+    using namespace folly;  // NOLINT since the fancy overload of | operator
+    auto startMs = time::WallClock::fastNowInMilliSec();
+    auto eb = controlIoThreadPool_->getEventBase();
+    return collectNSucceeded(
         gen::from(hosts)
         | gen::map([self = shared_from_this(), eb, currTerm, latestLogId, commitLogId,
                     prevLogId, prevLogTerm] (std::shared_ptr<Host> hostPtr) {
@@ -1964,10 +2438,117 @@ void RaftPart::sendHeartbeat() {
             auto now = time::WallClock::fastNowInMilliSec();
             lastMsgAcceptedCostMs_ = now - startMs;
             lastMsgAcceptedTime_ = now;
+            return true;
         }
+        return false;
     });
 }
 
+folly::Future<AppendLogResult> RaftPart::readIndexAsync() {
+    {
+        std::lock_guard<std::mutex> g(raftLock_);
+        if (UNLIKELY(status_ == Status::STOPPED)) {
+            return AppendLogResult::E_STOPPED;
+        }
+        if (UNLIKELY(status_ != Status::RUNNING)) {
+            return AppendLogResult::E_NOT_READY;
+        }
+        if (UNLIKELY(role_ != Role::LEADER)) {
+            return AppendLogResult::E_NOT_A_LEADER;
+        }
+        // The logs of previous terms might not be committed yet
+        if (UNLIKELY(!commitInThisTerm_)) {
+            return AppendLogResult::E_NOT_READY;
+        }
+    }
+    if (leaseValid()) {
+        return appliedFuture().thenValue([] (auto&&) {
+            return AppendLogResult::SUCCEEDED;
+        });
+    }
+    folly::Promise<AppendLogResult> p;
+    auto fut = p.getFuture();
+    {
+        std::lock_guard<std::mutex> g(readIndexLock_);
+        readIndexWaiters_.emplace_back(std::move(p));
+        // The waiters are served by the next round, which is sent after they come
+        if (readIndexInflight_) {
+            return fut;
+        }
+        readIndexInflight_ = true;
+    }
+    confirmLeadership();
+    return fut;
+}
+
+void RaftPart::confirmLeadership() {
+    // The waiters are moved out under the locks, and fulfilled after the locks are released
+    while (true) {
+        std::vector<folly::Promise<AppendLogResult>> waiters;
+        {
+            std::lock_guard<std::mutex> g(readIndexLock_);
+            if (readIndexWaiters_.empty()) {
+                readIndexInflight_ = false;
+                return;
+            }
+            waiters.swap(readIndexWaiters_);
+        }
+        bool leader = true;
+        TermID currTerm = 0;
+        LogID latestLogId = 0;
+        LogID commitLogId = 0;
+        TermID prevLogTerm = 0;
+        LogID prevLogId = 0;
+        size_t replica = 0;
+        decltype(hosts_) hosts;
+        {
+            std::lock_guard<std::mutex> g(raftLock_);
+            if (role_ != Role::LEADER) {
+                leader = false;
+            } else {
+                currTerm = term_;
+                latestLogId = wal_->lastLogId();
+                commitLogId = committedLogId_;
+                prevLogTerm = lastLogTerm_;
+                prevLogId = lastLogId_;
+                replica = quorum_;
+                hosts = hosts_;
+            }
+        }
+        if (!leader) {
+            for (auto& p : waiters) {
+                p.setValue(AppendLogResult::E_NOT_A_LEADER);
+            }
+            // serve the waiters queued meanwhile
+            continue;
+        }
+        VLOG(2) << idStr_ << "Confirm the leadership for " << waiters.size() << " reads";
+        sendHeartbeatTo(std::move(hosts), currTerm, latestLogId, commitLogId,
+                        prevLogTerm, prevLogId, replica)
+        .thenValue([self = shared_from_this(), currTerm, waiters = std::move(waiters)]
+                   (bool accepted) mutable {
+            auto res = accepted ? AppendLogResult::SUCCEEDED : AppendLogResult::E_NOT_A_LEADER;
+            if (accepted) {
+                std::lock_guard<std::mutex> g(self->raftLock_);
+                if (self->role_ != Role::LEADER || self->term_ != currTerm) {
+                    res = AppendLogResult::E_TERM_OUT_OF_DATE;
+                }
+            }
+            // the reads wait for the logs applied in the background, not on the io thread
+            auto appliedFut = res == AppendLogResult::SUCCEEDED ? self->appliedFuture()
+                                                                : folly::makeFuture();
+            std::move(appliedFut).thenValue([self, res, waiters = std::move(waiters)]
+                                            (auto&&) mutable {
+                for (auto& p : waiters) {
+                    p.setValue(res);
+                }
+                self->confirmLeadership();
+            });
+        });
+        return;
+    }
+}
+
 std::vector<std::shared_ptr<Host>> RaftPart::followers() const {
     CHECK(!raftLock_.try_lock());
     decltype(hosts_) hosts;
@@ -1988,6 +2569,27 @@ std::vector<HostAddr> RaftPart::peers() const {
     return peer;
 }
 
+HostAddr RaftPart::mostCaughtUpFollower() const {
+    decltype(hosts_) hosts;
+    {
+        std::lock_guard<std::mutex> lck(raftLock_);
+        hosts = followers();
+    }
+    HostAddr target("", 0);
+    LogID maxLogId = -1;
+    for (auto& host : hosts) {
+        if (witnesses_.count(host->address()) != 0) {
+            continue;
+        }
+        auto logId = host->lastLogIdSent();
+        if (logId > maxLogId) {
+            maxLogId = logId;
+            target = host->address();
+        }
+    }
+    return target;
+}
+
 std::set<HostAddr> RaftPart::listeners() const {
     std::lock_guard<std::mutex> lck(raftLock_);
     return listeners_;
@@ -2005,6 +2607,7 @@ bool RaftPart::checkAppendLogResult(AppendLogResult res) {
             cachingPromise_.setValue(res);
             cachingPromise_.reset();
             bufferOverFlow_ = false;
+            logsCond_.notify_all();
         }
         sendingPromise_.setValue(res);
         replicatingLogs_ = false;
@@ -2015,6 +2618,10 @@ bool RaftPart::checkAppendLogResult(AppendLogResult res) {
 
 void RaftPart::reset() {
     CHECK(!raftLock_.try_lock());
+    if (!applied()) {
+        LOG(WARNING) << idStr_ << "Reset with some batches still applying in the background";
+    }
+    waitWalFlushed();
     wal_->reset();
     cleanup();
     lastLogId_ = committedLogId_ = 0;
@@ -2107,6 +2714,127 @@ bool RaftPart::leaseValid() {
         < FLAGS_raft_heartbeat_interval_secs * 1000 - lastMsgAcceptedCostMs_;
 }
 
+bool RaftPart::leaderAlive() {
+    CHECK(!raftLock_.try_lock());
+    int64_t intervalMs = FLAGS_raft_heartbeat_interval_secs * 1000;
+    if (role_ == Role::LEADER) {
+        return static_cast<int64_t>(
+            time::WallClock::fastNowInMilliSec() - lastMsgAcceptedTime_) < intervalMs;
+    }
+    return role_ == Role::FOLLOWER &&
+           leader_ != HostAddr("", 0) &&
+           static_cast<int64_t>(lastMsgRecvDur_.elapsedInMSec()) < intervalMs;
+}
+
+bool RaftPart::quiescent() {
+    CHECK(!raftLock_.try_lock());
+    bool isQuiescent = FLAGS_raft_quiesce_idle_secs > 0 &&
+                       status_ == Status::RUNNING &&
+                       role_ == Role::LEADER &&
+                       commitInThisTerm_ &&
+                       !replicatingLogs_ &&
+                       committedLogId_ == wal_->lastLogId() &&
+                       time::WallClock::fastNowInMilliSec() - lastActiveTimeMs_ >=
+                           FLAGS_raft_quiesce_idle_secs * 1000L;
+    if (isQuiescent) {
+        // The followers won't get any log while quiescent, the lagging ones need to catch up
+        for (auto& host : hosts_) {
+            std::lock_guard<std::mutex> hg(host->lock_);
+            if (host->requestOnGoing_ || host->lastLogIdSent_ < committedLogId_) {
+                isQuiescent = false;
+                break;
+            }
+        }
+    }
+    if (isQuiescent != quiescent_) {
+        LOG(INFO) << idStr_ << (isQuiescent ? "Enter" : "Leave") << " the quiescent state"
+                  << ", committedLogId " << committedLogId_ << ", term " << term_;
+        quiescent_ = isQuiescent;
+    }
+    return isQuiescent;
+}
+
+bool RaftPart::quiescentInfo(TermID* term,
+                             LogID* committedLogId,
+                             size_t* quorum,
+                             std::vector<HostAddr>* hosts) {
+    std::lock_guard<std::mutex> g(raftLock_);
+    if (!quiescent()) {
+        return false;
+    }
+    *term = term_;
+    *committedLogId = committedLogId_;
+    *quorum = quorum_;
+    hosts->clear();
+    // The learners never start an election, and are not counted in the quorum
+    for (auto& host : hosts_) {
+        if (!host->isLearner()) {
+            hosts->emplace_back(host->address());
+        }
+    }
+    return true;
+}
+
+void RaftPart::renewLease(int64_t startMs) {
+    std::lock_guard<std::mutex> g(raftLock_);
+    if (role_ != Role::LEADER) {
+        return;
+    }
+    auto now = time::WallClock::fastNowInMilliSec();
+    lastMsgAcceptedCostMs_ = now - startMs;
+    lastMsgAcceptedTime_ = now;
+}
+
+void RaftPart::wakeUp() {
+    // It is called with or without raftLock_, the state is changed in next quiescent()
+    lastActiveTimeMs_ = time::WallClock::fastNowInMilliSec();
+}
+
+bool RaftPart::processQuiescentHeartbeat(const HostAddr& leader,
+                                         TermID term,
+                                         LogID committedLogId) {
+    waitApplied();
+    std::lock_guard<std::mutex> g(raftLock_);
+    if (status_ != Status::RUNNING ||
+        (role_ != Role::FOLLOWER && role_ != Role::LEARNER) ||
+        term_ != term ||
+        leader_ != leader) {
+        VLOG(2) << idStr_ << "Reject the node heartbeat from " << leader << ", term " << term
+                << ", local leader " << leader_ << ", local term " << term_;
+        return false;
+    }
+    lastMsgRecvDur_.reset();
+    leaderCommittedLogId_ = committedLogId;
+
+    // The last log sent before the leader became quiescent might not be committed yet
+    LogID lastLogIdCanCommit = std::min(lastLogId_, committedLogId);
+    // Otherwise they are committed by the next request
+    if (lastLogIdCanCommit > committedLogId_ && applied()) {
+        auto code = commitLogs(wal_->iterator(committedLogId_ + 1, lastLogIdCanCommit), false);
+        if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+            VLOG(1) << idStr_ << "Follower succeeded committing log "
+                              << committedLogId_ + 1 << " to "
+                              << lastLogIdCanCommit;
+            committedLogId_ = lastLogIdCanCommit;
+        }
+    }
+    return true;
+}
+
+bool RaftPart::readableWithin(int64_t maxStalenessMs) {
+    if (isLeader()) {
+        return leaseValid();
+    }
+    std::lock_guard<std::mutex> g(raftLock_);
+    if (status_ != Status::RUNNING || (role_ != Role::FOLLOWER && role_ != Role::LEARNER)) {
+        return false;
+    }
+    // The leader may be idle, which sends a heartbeat each raft_heartbeat_interval_secs, so
+    // a bound shorter than that makes the follower readable only when there are writes.
+    return static_cast<int64_t>(lastMsgRecvDur_.elapsedInMSec()) <= maxStalenessMs &&
+           committedLogId_ >= leaderCommittedLogId_;
+}
+
 }  // namespace raftex
 }  // namespace nebula
 
@@ -94,20 +94,44 @@ public:
     }
 
     bool isLeader() const {
-        std::lock_guard<std::mutex> g(raftLock_);
-        return role_ == Role::LEADER;
+        return role_.load(std::memory_order_acquire) == Role::LEADER;
     }
 
     bool isFollower() const {
-        std::lock_guard<std::mutex> g(raftLock_);
-        return role_ == Role::FOLLOWER;
+        return role_.load(std::memory_order_acquire) == Role::FOLLOWER;
     }
 
     bool isLearner() const {
-        std::lock_guard<std::mutex> g(raftLock_);
-        return role_ == Role::LEARNER;
+        return role_.load(std::memory_order_acquire) == Role::LEARNER;
     }
 
+    /**
+     * A witness keeps the wal and votes as a member of the quorum like a follower, but never
+     * applies the logs to its state machine. It starts the election later than the others, and
+     * only leads when the followers left are behind it, in which case it takes no writes and
+     * sends no snapshot, but catches the followers up with its logs and gives the leadership to
+     * one of them.
+     * */
+    bool isWitness() const {
+        return witness_;
+    }
+
+    // The witnesses of the part by their raft addresses, set before the part is started
+    void setWitnesses(std::set<HostAddr> witnesses);
+
+    // The io threads and the clients the heartbeats and the votes are sent by, apart from
+    // the logs and the snapshots, so they are not queued behind a large batch of logs on the
+    // same event base or connection. Set before the part is started, see
+    // raft_control_io_threads.
+    void setControlChannel(
+        std::shared_ptr<folly::IOThreadPoolExecutor> pool,
+        std::shared_ptr<thrift::ThriftClientManager<cpp2::RaftexServiceAsyncClient>> clientMan);
+
+    // The committed logs of the leader are applied in the executor, which must never wait for
+    // the workers or the raftLock_. Set before the part is started, the logs are applied inline
+    // if it is not set, see raft_apply_async.
+    void setApplyExecutor(std::shared_ptr<folly::Executor> executor);
+
     ClusterID clusterId() const {
         return clusterId_;
     }
@@ -231,19 +255,70 @@ public:
 
     bool leaseValid();
 
+    // Confirm the part is still the leader without appending a log, and wait for the logs
+    // committed before the call are applied, so a read after it is linearizable. The lease
+    // is used if it is valid, otherwise the calls at the same time share one round of
+    // heartbeats, which renews the lease when accepted by the quorum.
+    folly::Future<AppendLogResult> readIndexAsync();
+
+    // Whether the data of a follower or learner is at most maxStalenessMs behind the leader,
+    // i.e. it has received a message from the leader in maxStalenessMs, and has committed all
+    // logs which the leader had committed when sending it. Leader is the same as leaseValid.
+    bool readableWithin(int64_t maxStalenessMs);
+
+    /****************************************************
+     *
+     * Quiescent parts
+     *
+     * A leader without writes for raft_quiesce_idle_secs, whose followers have got all logs,
+     * stops sending the heartbeats and empty logs itself. Instead, RaftexService sends one
+     * node heartbeat to each peer for all of its quiescent parts. A write, a vote request or
+     * a node heartbeat rejected by a peer wakes the part up.
+     *
+     ***************************************************/
+    // Return false if the part is not a quiescent leader, otherwise the info to be sent
+    // in the node heartbeats
+    bool quiescentInfo(TermID* term,
+                       LogID* committedLogId,
+                       size_t* quorum,
+                       std::vector<HostAddr>* hosts);
+
+    // The node heartbeat sent at startMs has been accepted by the quorum
+    void renewLease(int64_t startMs);
+
+    void wakeUp();
+
+    // Same as processHeartbeatRequest, return false if the part is not the follower or learner
+    // of the leader in the term
+    bool processQuiescentHeartbeat(const HostAddr& leader, TermID term, LogID committedLogId);
+
     bool needToCleanWal();
 
+    // The lowest log id the peers have accepted if the part is the leader, the wal after it
+    // is still needed to catch them up. Return the max LogID for a follower.
+    LogID lowestLogIdOfPeers();
+
     // leader + follwers
     std::vector<HostAddr> peers() const;
 
+    // The follower which has accepted most logs, the target to transfer the leader to.
+    // Return an empty address if there is no follower, the witnesses are not counted.
+    HostAddr mostCaughtUpFollower() const;
+
     std::set<HostAddr> listeners() const;
 
     std::pair<LogID, TermID> lastLogInfo() const;
 
-    // Reset the part, clean up all data and WALs.
+    // Reset the part, clean up all data and WALs. The batches applied in the background must
+    // have been drained, see applied().
     void reset();
 
 protected:
+    // Block until all batches enqueued by applyAsync() so far are applied. It must be called
+    // before the logs are committed in any other way, or the state machine is read by AtomicOp,
+    // but never with the raftLock_ held or in the executor_, use applied() there instead.
+    void waitApplied();
+
     // Protected constructor to prevent from instantiating directly
     RaftPart(
          ClusterID clusterId,
@@ -352,6 +427,19 @@ private:
      ****************************************************************/
     void sendHeartbeat();
 
+    // Send the heartbeat to the hosts, the future is true if it is accepted by the quorum, in
+    // which case the lease is renewed
+    folly::Future<bool> sendHeartbeatTo(std::vector<std::shared_ptr<Host>> hosts,
+                                        TermID term,
+                                        LogID latestLogId,
+                                        LogID commitLogId,
+                                        TermID prevLogTerm,
+                                        LogID prevLogId,
+                                        size_t replica);
+
+    // Start a round of heartbeats for the calls of readIndexAsync waiting, if there is any
+    void confirmLeadership();
+
     /****************************************************
      *
      * Methods used by the status polling logic
@@ -359,6 +447,9 @@ private:
      ***************************************************/
     bool needToSendHeartbeat();
 
+    // Check whether the leader is quiescent, the raftLock_ must be held
+    bool quiescent();
+
     bool needToStartElection();
 
     void statusPolling(int64_t startTime);
@@ -418,6 +509,52 @@ private:
         LogID prevLogId,
         std::vector<std::shared_ptr<Host>> hosts);
 
+    // Apply the committed logs (committedId, lastLogId] in the executor after the batches
+    // enqueued before, and fulfill the promise when it is done, see FLAGS_raft_apply_async
+    void applyAsync(LogID committedId,
+                    LogID lastLogId,
+                    folly::Optional<folly::SharedPromise<AppendLogResult>> promise);
+
+    // Step down when a batch applied in the background fails, and commit the logs again from
+    // committedId as a follower, where the leader's commits go on
+    void stepDownOnApplyFailure(LogID committedId);
+
+    // Whether all batches enqueued by applyAsync() so far are applied, which doesn't block
+    bool applied();
+
+    // Fulfilled once all batches enqueued by applyAsync() so far are applied
+    folly::Future<folly::Unit> appliedFuture();
+
+    // Step 5 of processAppendLogResponses: continue with the rest of iter or the logs buffered,
+    // an AtomicOp is evaluated after the batches applied in the background
+    void replicateNextLogs(AppendLogsIterator iter, LogID firstLogId, TermID currTerm);
+
+    // Block until the logs appended by the leader without flush are written into the WAL, see
+    // raft_parallel_wal_flush. It must be called before the WAL is changed or the logs are
+    // committed
+    void waitWalFlushed();
+
+    // The log entries of an AppendLog request, from one log to the last one of the same term,
+    // at most max_appendlog_batch_size of them
+    struct LogEntries {
+        TermID                          logTerm{0};
+        std::vector<cpp2::LogEntry>     entries;
+    };
+
+    // The entries of the logs in [firstId, lastId] sent by the leader of term, or null if
+    // firstId is not in the WAL. When raft_share_log_entries is set, the entries read are kept
+    // for the other hosts asking for the same logs, so the WAL is read once for all of them,
+    // and the shared entries must not be changed. The entries sent to a follower catching up
+    // are read in larger batches and never shared, see raft_catch_up_lag_logs
+    std::shared_ptr<LogEntries> logEntriesToSend(TermID term,
+                                                 LogID firstId,
+                                                 LogID lastId,
+                                                 bool catchUp = false);
+
+    // Whether the part is a leader accepted by the quorum recently, or a follower which has
+    // heard from its leader recently, see FLAGS_raft_reject_disruptive_vote
+    bool leaderAlive();
+
     // followers return Host of which could vote, in other words, learner is not counted in
     std::vector<std::shared_ptr<Host>> followers() const;
 
@@ -475,6 +612,14 @@ protected:
             sharedPromises_.pop_front();
         }
 
+        // Take the first shared promise out, which is fulfilled by the caller later
+        folly::SharedPromise<ValueType> takeOneShared() {
+            CHECK(!sharedPromises_.empty());
+            auto promise = std::move(sharedPromises_.front());
+            sharedPromises_.pop_front();
+            return promise;
+        }
+
         template<class VT>
         void setOneSingleValue(VT&& val) {
             CHECK(!singlePromises_.empty());
@@ -516,8 +661,13 @@ protected:
     // all listener's role is learner (cannot promote to follower)
     std::set<HostAddr> listeners_;
 
+    std::set<HostAddr> witnesses_;
+    bool witness_{false};
+
     // The lock is used to protect logs_ and cachingPromise_
     mutable std::mutex logsLock_;
+    // Notified when logs_ is swapped out, see FLAGS_raft_buffer_full_wait_ms
+    std::condition_variable logsCond_;
     std::atomic_bool replicatingLogs_{false};
     std::atomic_bool bufferOverFlow_{false};
     PromiseSet<AppendLogResult> cachingPromise_;
@@ -529,7 +679,8 @@ protected:
     PromiseSet<AppendLogResult> sendingPromise_;
 
     Status status_;
-    Role role_;
+    // only changed with raftLock_ held, it is atomic so the role is checked without the lock
+    std::atomic<Role> role_;
 
     // When the partition is the leader, the leader_ is same as addr_
     HostAddr leader_;
@@ -538,6 +689,10 @@ protected:
     // And it will be reset to empty after current election finished.
     HostAddr votedAddr_;
 
+    // The new leader the leader is being transferred to, which is voted even though the
+    // leader is alive
+    HostAddr transferTarget_;
+
     // The current term id
     // the term id proposed by that candidate
     TermID term_{0};
@@ -562,6 +717,8 @@ protected:
     TermID lastLogTerm_{0};
     // The id for the last globally committed log (from the leader)
     LogID committedLogId_{0};
+    // The committed log id of leader in the last message received from it
+    LogID leaderCommittedLogId_{0};
 
     // To record how long ago when the last leader message received
     time::Duration lastMsgRecvDur_;
@@ -578,6 +735,42 @@ protected:
     // Check leader has commit log in this term (accepted by majority is not enough),
     // leader is not allowed to service until it is true.
     bool commitInThisTerm_{false};
+    // The time of the last write or vote request, see quiescent()
+    std::atomic<int64_t> lastActiveTimeMs_{0};
+    bool quiescent_{false};
+
+    // The batches applied by applyAsync() are chained in order, applyLock_ protects the chain
+    // and the counters of the batches
+    std::mutex applyLock_;
+    std::condition_variable applyCond_;
+    folly::Future<folly::Unit> applyChain_{folly::makeFuture()};
+    uint64_t applyingBatches_{0};
+    uint64_t appliedBatches_{0};
+    // The waiters of appliedFuture() with the batches they wait for
+    std::vector<std::pair<uint64_t, folly::Promise<folly::Unit>>> appliedWaiters_;
+    // Set when a batch fails to apply, the batches after it are not applied either until the
+    // chain is drained, and the logs are committed again as a follower
+    bool applyFailed_{false};
+    std::shared_ptr<folly::Executor> applyExecutor_;
+
+    // The calls of readIndexAsync waiting for the next round of heartbeats, at most one
+    // round is in flight
+    std::mutex readIndexLock_;
+    bool readIndexInflight_{false};
+    std::vector<folly::Promise<AppendLogResult>> readIndexWaiters_;
+
+    // Whether the logs being replicated are flushed into the WAL in parallel, the lock is
+    // taken after raftLock_ if both are held
+    std::mutex walFlushLock_;
+    std::condition_variable walFlushCond_;
+    bool walFlushing_{false};
+
+    // The entries read by logEntriesToSend() lately, keyed by the term, the first and the last
+    // log id asked for. The logs of a term never change on its leader, so they are never stale
+    static constexpr size_t kSharedLogEntries = 4;
+    using LogEntriesKey = std::tuple<TermID, LogID, LogID>;
+    std::mutex logEntriesLock_;
+    std::deque<std::pair<LogEntriesKey, std::shared_ptr<LogEntries>>> sharedLogEntries_;
 
     // Write-ahead Log
     std::shared_ptr<wal::FileBasedWal> wal_;
@@ -592,10 +785,16 @@ protected:
     std::shared_ptr<SnapshotManager> snapshot_;
 
     std::shared_ptr<thrift::ThriftClientManager<cpp2::RaftexServiceAsyncClient>> clientMan_;
+    // The same as ioThreadPool_ and clientMan_ unless the control channel is set
+    std::shared_ptr<folly::IOThreadPoolExecutor> controlIoThreadPool_;
+    std::shared_ptr<thrift::ThriftClientManager<cpp2::RaftexServiceAsyncClient>>
+        controlClientMan_;
     // Used in snapshot, record the last total count and total size received from request
     int64_t lastTotalCount_ = 0;
     int64_t lastTotalSize_ = 0;
     time::Duration lastSnapshotRecvDur_;
+    // The bandwidth of receiving snapshot, see snapshot_recv_rate_limit
+    folly::DynamicTokenBucket snapshotRecvBucket_;
 
     // Check if disk has enough space before write wal
     std::shared_ptr<kvstore::DiskManager> diskMan_;
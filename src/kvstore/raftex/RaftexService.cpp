@@ -6,12 +6,58 @@
 
 #include "common/base/Base.h"
 #include "kvstore/raftex/RaftexService.h"
+#include "common/time/WallClock.h"
 #include <folly/ScopeGuard.h>
+#include <folly/executors/IOThreadPoolExecutor.h>
+#include <folly/futures/Future.h>
 #include "kvstore/raftex/RaftPart.h"
+#include "kvstore/raftex/RpcCompression.h"
+
+DECLARE_int32(raft_quiesce_idle_secs);
+DECLARE_uint32(raft_heartbeat_interval_secs);
+DECLARE_int32(raft_rpc_timeout_ms);
 
 namespace nebula {
 namespace raftex {
 
+namespace {
+
+// The heartbeat of a quiescent part in the node heartbeat
+struct PartHeartbeat {
+    GraphSpaceID spaceId;
+    PartitionID partId;
+    TermID term;
+    LogID committedLogId;
+};
+
+std::string encodePartHeartbeat(const PartHeartbeat& hb) {
+    std::string str;
+    str.reserve(sizeof(PartHeartbeat));
+    str.append(reinterpret_cast<const char*>(&hb.spaceId), sizeof(GraphSpaceID))
+       .append(reinterpret_cast<const char*>(&hb.partId), sizeof(PartitionID))
+       .append(reinterpret_cast<const char*>(&hb.term), sizeof(TermID))
+       .append(reinterpret_cast<const char*>(&hb.committedLogId), sizeof(LogID));
+    return str;
+}
+
+bool decodePartHeartbeat(folly::StringPiece str, PartHeartbeat* hb) {
+    if (str.size() != sizeof(GraphSpaceID) + sizeof(PartitionID) + sizeof(TermID) +
+                      sizeof(LogID)) {
+        return false;
+    }
+    auto* ptr = str.data();
+    memcpy(&hb->spaceId, ptr, sizeof(GraphSpaceID));
+    ptr += sizeof(GraphSpaceID);
+    memcpy(&hb->partId, ptr, sizeof(PartitionID));
+    ptr += sizeof(PartitionID);
+    memcpy(&hb->term, ptr, sizeof(TermID));
+    ptr += sizeof(TermID);
+    memcpy(&hb->committedLogId, ptr, sizeof(LogID));
+    return true;
+}
+
+}  // namespace
+
 /*******************************************************
  *
  * Implementation of RaftexService
@@ -65,6 +111,8 @@ void RaftexService::initThriftServer(std::shared_ptr<folly::IOThreadPoolExecutor
     LOG(INFO) << "Init thrift server for raft service, port: " << port;
     server_->setPort(port);
     server_->setIdleTimeout(std::chrono::seconds(0));
+    // a reply is compressed only if the request is, and not smaller than it
+    server_->setMinCompressBytes(FLAGS_raft_rpc_compress_min_bytes);
     if (pool != nullptr) {
         server_->setIOThreadPool(pool);
     }
@@ -108,6 +156,16 @@ void RaftexService::serve() {
 
     status_.store(STATUS_RUNNING);
     LOG(INFO) << "Start the Raftex Service successfully";
+
+    if (FLAGS_raft_quiesce_idle_secs > 0) {
+        clientMan_ = std::make_unique<
+            thrift::ThriftClientManager<cpp2::RaftexServiceAsyncClient>>();
+        nodeHeartbeatWorker_ = std::make_unique<thread::GenericWorker>();
+        CHECK(nodeHeartbeatWorker_->start("raft-node-hb"));
+        nodeHeartbeatWorker_->addRepeatTask(FLAGS_raft_heartbeat_interval_secs * 1000 / 3,
+                                            &RaftexService::sendNodeHeartbeats,
+                                            this);
+    }
     server_->getEventBaseManager()->getEventBase()->loopForever();
 
     status_.store(STATUS_NOT_RUNNING);
@@ -131,6 +189,11 @@ void RaftexService::stop() {
 
     // stop service
     LOG(INFO) << "Stopping the raftex service on port " << serverPort_;
+    if (nodeHeartbeatWorker_ != nullptr) {
+        nodeHeartbeatWorker_->stop();
+        nodeHeartbeatWorker_->wait();
+        nodeHeartbeatWorker_.reset();
+    }
     {
         folly::RWSpinLock::WriteHolder wh(partsLock_);
         for (auto& p : parts_) {
@@ -205,6 +268,17 @@ void RaftexService::askForVote(
 void RaftexService::appendLog(
         cpp2::AppendLogResponse& resp,
         const cpp2::AppendLogRequest& req) {
+    // the shared_ptr is only loaded in the tests set the hook
+    if (UNLIKELY(hasAppendLogHook_.load(std::memory_order_relaxed))) {
+        auto hook = std::atomic_load(&appendLogHook_);
+        if (hook != nullptr && *hook) {
+            (*hook)(req);
+        }
+    }
+    if (req.get_space() == kNodeHeartbeatSpace) {
+        processNodeHeartbeat(resp, req);
+        return;
+    }
     auto part = findPart(req.get_space(), req.get_part());
     if (!part) {
         // Not found
@@ -243,6 +317,110 @@ void RaftexService::async_eb_heartbeat(
     callback->result(resp);
 }
 
+void RaftexService::sendNodeHeartbeats() {
+    struct PeerHeartbeat {
+        std::vector<PartHeartbeat> heartbeats;
+        std::vector<std::shared_ptr<RaftPart>> parts;
+    };
+    std::unordered_map<HostAddr, PeerHeartbeat> peers;
+    // the number of peers which still need to accept the heartbeat of each part
+    std::unordered_map<std::shared_ptr<RaftPart>, size_t> quorums;
+    HostAddr localAddr;
+    {
+        folly::RWSpinLock::ReadHolder rh(partsLock_);
+        for (auto& p : parts_) {
+            TermID term = 0;
+            LogID committedLogId = 0;
+            size_t quorum = 0;
+            std::vector<HostAddr> hosts;
+            if (!p.second->quiescentInfo(&term, &committedLogId, &quorum, &hosts)) {
+                continue;
+            }
+            localAddr = p.second->address();
+            quorums.emplace(p.second, quorum);
+            for (auto& host : hosts) {
+                auto& peer = peers[host];
+                peer.heartbeats.emplace_back(
+                    PartHeartbeat{p.first.first, p.first.second, term, committedLogId});
+                peer.parts.emplace_back(p.second);
+            }
+        }
+    }
+    if (quorums.empty()) {
+        return;
+    }
+
+    VLOG(2) << "Send the node heartbeats of " << quorums.size() << " quiescent parts to "
+            << peers.size() << " peers";
+    auto startMs = time::WallClock::fastNowInMilliSec();
+    std::vector<folly::Future<cpp2::AppendLogResponse>> futures;
+    std::vector<std::vector<std::shared_ptr<RaftPart>>> partsOfPeers;
+    for (auto& peer : peers) {
+        auto req = std::make_shared<cpp2::AppendLogRequest>();
+        req->set_space(kNodeHeartbeatSpace);
+        req->set_part(0);
+        req->set_leader_addr(localAddr.host);
+        req->set_leader_port(localAddr.port);
+        std::vector<cpp2::LogEntry> logs;
+        for (auto& hb : peer.second.heartbeats) {
+            cpp2::LogEntry le;
+            le.set_log_str(encodePartHeartbeat(hb));
+            logs.emplace_back(std::move(le));
+        }
+        req->set_log_str_list(std::move(logs));
+        auto* eb = controlIoPool_ != nullptr ? controlIoPool_->getEventBase()
+                                             : getIOThreadPool()->getEventBase();
+        futures.emplace_back(folly::via(eb, [this, eb, addr = peer.first, req] {
+            auto client = clientMan_->client(addr, eb, false, FLAGS_raft_rpc_timeout_ms);
+            return client->future_appendLog(*req);
+        }));
+        partsOfPeers.emplace_back(std::move(peer.second.parts));
+    }
+
+    auto tries = folly::collectAll(std::move(futures)).get();
+    for (size_t i = 0; i < tries.size(); i++) {
+        if (tries[i].hasValue() &&
+            tries[i].value().get_error_code() == cpp2::ErrorCode::SUCCEEDED) {
+            for (auto& part : partsOfPeers[i]) {
+                auto it = quorums.find(part);
+                if (it->second > 0) {
+                    it->second--;
+                }
+            }
+        } else {
+            // let the parts send their own heartbeats to find out what's wrong
+            for (auto& part : partsOfPeers[i]) {
+                part->wakeUp();
+            }
+        }
+    }
+    for (auto& q : quorums) {
+        if (q.second == 0) {
+            q.first->renewLease(startMs);
+        }
+    }
+}
+
+void RaftexService::processNodeHeartbeat(cpp2::AppendLogResponse& resp,
+                                         const cpp2::AppendLogRequest& req) {
+    HostAddr leader(req.get_leader_addr(), req.get_leader_port());
+    bool accepted = true;
+    for (auto& log : req.get_log_str_list()) {
+        PartHeartbeat hb;
+        if (!decodePartHeartbeat(log.get_log_str(), &hb)) {
+            LOG(ERROR) << "Invalid node heartbeat from " << leader;
+            accepted = false;
+            continue;
+        }
+        auto part = findPart(hb.spaceId, hb.partId);
+        if (!part || !part->processQuiescentHeartbeat(leader, hb.term, hb.committedLogId)) {
+            accepted = false;
+        }
+    }
+    // If any part rejects it, all parts in the request will send their own heartbeats
+    resp.set_error_code(accepted ? cpp2::ErrorCode::SUCCEEDED : cpp2::ErrorCode::E_BAD_STATE);
+}
+
 }  // namespace raftex
 }  // namespace nebula
 
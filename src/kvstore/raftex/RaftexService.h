@@ -9,6 +9,9 @@
 
 #include "common/base/Base.h"
 #include "common/interface/gen-cpp2/RaftexService.h"
+#include "common/interface/gen-cpp2/RaftexServiceAsyncClient.h"
+#include "common/thread/GenericWorker.h"
+#include "common/thrift/ThriftClientManager.h"
 #include <folly/RWSpinLock.h>
 #include <thrift/lib/cpp2/server/ThriftServer.h>
 
@@ -59,6 +62,27 @@ public:
     std::shared_ptr<RaftPart> findPart(GraphSpaceID spaceId,
                                        PartitionID partId);
 
+    using AppendLogHook = std::function<void(const cpp2::AppendLogRequest&)>;
+
+    // The hook is called with each appendLog request before it is processed, the tests and
+    // benchmarks inject the network faults by it, it sleeps to delay the request, or throws to
+    // fail it like a request lost. The requests only check a flag unless it's set.
+    void setAppendLogHook(AppendLogHook hook) {
+        bool hasHook = !!hook;
+        std::atomic_store(&appendLogHook_, std::make_shared<AppendLogHook>(std::move(hook)));
+        hasAppendLogHook_.store(hasHook, std::memory_order_relaxed);
+    }
+
+    // The node heartbeat is an appendLog request of this space, each log of which is the
+    // heartbeat of a quiescent part, see RaftPart::quiescentInfo
+    static constexpr GraphSpaceID kNodeHeartbeatSpace = -1;
+
+    // The io threads the node heartbeats are sent by, the io threads of the service if not set,
+    // set before the service is started
+    void setControlIOThreadPool(std::shared_ptr<folly::IOThreadPoolExecutor> pool) {
+        controlIoPool_ = std::move(pool);
+    }
+
 private:
     void initThriftServer(std::shared_ptr<folly::IOThreadPoolExecutor> pool,
                           std::shared_ptr<folly::Executor> workers,
@@ -69,6 +93,12 @@ private:
     // Block until the service is ready to serve
     void waitUntilReady();
 
+    // Send the heartbeats of all quiescent leaders, one request to each peer
+    void sendNodeHeartbeats();
+
+    void processNodeHeartbeat(cpp2::AppendLogResponse& resp,
+                              const cpp2::AppendLogRequest& req);
+
     RaftexService() = default;
 
 private:
@@ -86,6 +116,12 @@ private:
     folly::RWSpinLock partsLock_;
     std::unordered_map<std::pair<GraphSpaceID, PartitionID>,
                        std::shared_ptr<RaftPart>> parts_;
+
+    std::unique_ptr<thread::GenericWorker> nodeHeartbeatWorker_;
+    std::shared_ptr<folly::IOThreadPoolExecutor> controlIoPool_;
+    std::shared_ptr<AppendLogHook> appendLogHook_;
+    std::atomic<bool> hasAppendLogHook_{false};
+    std::unique_ptr<thrift::ThriftClientManager<cpp2::RaftexServiceAsyncClient>> clientMan_;
 };
 
 }  // namespace raftex
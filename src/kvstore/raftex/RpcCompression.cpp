@@ -0,0 +1,63 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/raftex/RpcCompression.h"
+#include <thrift/lib/cpp/transport/THeader.h>
+#include <thrift/lib/cpp2/async/HeaderClientChannel.h>
+
+DEFINE_string(raft_rpc_compression, "",
+              "Codec compressing the AppendLog and SendSnapshot requests of raft, one of "
+              "zstd, zlib and snappy, empty means not compressed");
+DEFINE_uint32(raft_rpc_compress_min_bytes, 64 * 1024,
+              "The raft requests smaller than it are not compressed");
+
+namespace nebula {
+namespace raftex {
+
+using apache::thrift::transport::THeader;
+
+// static
+uint16_t RpcCompression::transformOf(const std::string& codec) {
+    if (codec == "zstd") {
+        return THeader::ZSTD_TRANSFORM;
+    } else if (codec == "zlib") {
+        return THeader::ZLIB_TRANSFORM;
+    } else if (codec == "snappy") {
+        return THeader::SNAPPY_TRANSFORM;
+    }
+    return 0;
+}
+
+// static
+uint16_t RpcCompression::transform() {
+    if (FLAGS_raft_rpc_compression.empty()) {
+        return 0;
+    }
+    auto trans = transformOf(FLAGS_raft_rpc_compression);
+    LOG_IF_EVERY_N(WARNING, trans == 0, 1000)
+        << "Unknown raft_rpc_compression " << FLAGS_raft_rpc_compression;
+    return trans;
+}
+
+// static
+void RpcCompression::apply(apache::thrift::RequestChannel* channel) {
+    auto* header = dynamic_cast<apache::thrift::HeaderClientChannel*>(channel);
+    if (header == nullptr) {
+        return;
+    }
+    auto trans = transform();
+    if (trans == 0) {
+        if (!header->getWriteTransforms().empty()) {
+            header->setTransforms({});
+        }
+        return;
+    }
+    header->setTransforms({trans});
+    header->setMinCompressBytes(FLAGS_raft_rpc_compress_min_bytes);
+}
+
+}  // namespace raftex
+}  // namespace nebula
@@ -0,0 +1,41 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef RAFTEX_RPCCOMPRESSION_H_
+#define RAFTEX_RPCCOMPRESSION_H_
+
+#include "common/base/Base.h"
+#include <thrift/lib/cpp2/async/RequestChannel.h>
+
+DECLARE_string(raft_rpc_compression);
+DECLARE_uint32(raft_rpc_compress_min_bytes);
+
+namespace nebula {
+namespace raftex {
+
+/*
+The AppendLog and SendSnapshot requests of raft are compressed by the transform of the thrift
+header protocol if raft_rpc_compression is set, only the ones not smaller than
+raft_rpc_compress_min_bytes. The peer decompresses a request by the transform in its header, and
+replies with the same transform, so a peer of an older version without this works as well.
+*/
+class RpcCompression final {
+public:
+    // The header transform of raft_rpc_compression, or 0 if not compressed
+    static uint16_t transform();
+
+    // Compress the requests sent by the channel of a raft client, which is shared by all the
+    // requests of the client, so it is set every time with the current flags
+    static void apply(apache::thrift::RequestChannel* channel);
+
+    // The transform of the codec name, "zstd", "zlib" or "snappy", 0 if none or unknown
+    static uint16_t transformOf(const std::string& codec);
+};
+
+}  // namespace raftex
+}  // namespace nebula
+
+#endif  // RAFTEX_RPCCOMPRESSION_H_
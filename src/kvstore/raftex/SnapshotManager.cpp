@@ -5,13 +5,21 @@
  */
 
 #include "kvstore/raftex/SnapshotManager.h"
+#include "common/time/Duration.h"
 #include "kvstore/raftex/RaftPart.h"
+#include "kvstore/raftex/RpcCompression.h"
 #include <thrift/lib/cpp/util/EnumUtils.h>
 
 DEFINE_int32(snapshot_worker_threads, 4, "Threads number for snapshot");
 DEFINE_int32(snapshot_io_threads, 4, "Threads number for snapshot");
 DEFINE_int32(snapshot_send_retry_times, 3, "Retry times if send failed");
 DEFINE_int32(snapshot_send_timeout_ms, 60000, "Rpc timeout for sending snapshot");
+DEFINE_int32(snapshot_send_rate_limit, 0,
+             "The bandwidth of sending snapshots to one host in bytes per sec, shared by all "
+             "parts sending to it. The unit is MB. 0 means unlimited.");
+DEFINE_int32(snapshot_send_max_parts_per_host, 0,
+             "The max number of parts sending snapshots to one host at the same time, "
+             "0 means unlimited");
 
 namespace nebula {
 namespace raftex {
@@ -25,7 +33,11 @@ folly::Future<Status> SnapshotManager::sendSnapshot(std::shared_ptr<RaftPart> pa
                                                     const HostAddr& dst) {
     folly::Promise<Status> p;
     auto fut = p.getFuture();
-    executor_->add([this, p = std::move(p), part, dst] () mutable {
+    auto budget = getHostBudget(dst);
+    folly::Func task = [this, p = std::move(p), part, dst, budget] () mutable {
+        SCOPE_EXIT {
+            onSnapshotFinished(budget);
+        };
         auto spaceId = part->spaceId_;
         auto partId = part->partId_;
         auto termId = part->term_;
@@ -49,7 +61,19 @@ folly::Future<Status> SnapshotManager::sendSnapshot(std::shared_ptr<RaftPart> pa
                 p.setValue(Status::Error("Send snapshot failed!"));
                 return false;
             }
+            if (FLAGS_snapshot_send_rate_limit > 0) {
+                double bytes = 0;
+                for (const auto& row : data) {
+                    bytes += row.size();
+                }
+                double rate = FLAGS_snapshot_send_rate_limit * 1024.0 * 1024.0;
+                budget->bucket.consumeWithBorrowAndWait(bytes, rate, std::max(rate, bytes));
+            }
             int retry = FLAGS_snapshot_send_retry_times;
+            // the batch refused by the rate limit of receiver is sent again after a backoff,
+            // which is not counted in the retries, until snapshot_send_timeout_ms
+            time::Duration batchDur;
+            int64_t backoffMs = kMinThrottleBackoffMs;
             while (retry-- > 0) {
                 auto f = send(spaceId,
                               partId,
@@ -73,6 +97,15 @@ folly::Future<Status> SnapshotManager::sendSnapshot(std::shared_ptr<RaftPart> pa
                             p.setValue(Status::OK());
                         }
                         return true;
+                    } else if (resp.get_error_code() ==
+                                   cpp2::ErrorCode::E_TOO_MANY_REQUESTS &&
+                               batchDur.elapsedInMSec() < FLAGS_snapshot_send_timeout_ms) {
+                        VLOG(2) << part->idStr_ << "Receiver is over the rate limit, send again "
+                                << "in " << backoffMs << "ms";
+                        std::this_thread::sleep_for(std::chrono::milliseconds(backoffMs));
+                        backoffMs = std::min(backoffMs * 2, kMaxThrottleBackoffMs);
+                        retry++;
+                        continue;
                     } else {
                         LOG(INFO) << part->idStr_
                                   << "Sending snapshot failed, we don't retry anymore! "
@@ -91,10 +124,46 @@ folly::Future<Status> SnapshotManager::sendSnapshot(std::shared_ptr<RaftPart> pa
             p.setValue(Status::Error("Send snapshot failed!"));
             return false;
         });
-    });
+    };
+    {
+        std::lock_guard<std::mutex> g(budget->lock);
+        if (FLAGS_snapshot_send_max_parts_per_host > 0
+                && budget->sending >= FLAGS_snapshot_send_max_parts_per_host) {
+            LOG(INFO) << part->idStr_ << "Too many snapshots are being sent to " << dst
+                      << ", wait for one of them finished";
+            budget->pending.emplace_back(std::move(task));
+            return fut;
+        }
+        budget->sending++;
+    }
+    executor_->add(std::move(task));
     return fut;
 }
 
+std::shared_ptr<SnapshotManager::HostBudget>
+SnapshotManager::getHostBudget(const HostAddr& dst) {
+    std::lock_guard<std::mutex> g(budgetsLock_);
+    auto& budget = budgets_[dst];
+    if (budget == nullptr) {
+        budget = std::make_shared<HostBudget>();
+    }
+    return budget;
+}
+
+void SnapshotManager::onSnapshotFinished(std::shared_ptr<HostBudget> budget) {
+    folly::Func next;
+    {
+        std::lock_guard<std::mutex> g(budget->lock);
+        if (budget->pending.empty()) {
+            budget->sending--;
+            return;
+        }
+        next = std::move(budget->pending.front());
+        budget->pending.pop_front();
+    }
+    executor_->add(std::move(next));
+}
+
 folly::Future<raftex::cpp2::SendSnapshotResponse> SnapshotManager::send(
                                                             GraphSpaceID spaceId,
                                                             PartitionID partId,
@@ -123,6 +192,7 @@ folly::Future<raftex::cpp2::SendSnapshotResponse> SnapshotManager::send(
     auto* evb = ioThreadPool_->getEventBase();
     return folly::via(evb, [this, addr, evb, req = std::move(req)] () mutable {
         auto client = connManager_.client(addr, evb, false, FLAGS_snapshot_send_timeout_ms);
+        RpcCompression::apply(client->getChannel());
         return client->future_sendSnapshot(req);
     });
 }
@@ -14,6 +14,7 @@
 #include "common/thrift/ThriftClientManager.h"
 #include <folly/futures/Future.h>
 #include <folly/Function.h>
+#include <folly/TokenBucket.h>
 #include <folly/executors/IOThreadPoolExecutor.h>
 
 namespace nebula {
@@ -42,7 +43,34 @@ public:
     folly::Future<Status> sendSnapshot(std::shared_ptr<RaftPart> part,
                                        const HostAddr& dst);
 
+    folly::IOThreadPoolExecutor* workers() const {
+        return executor_.get();
+    }
+
+    folly::IOThreadPoolExecutor* ioPool() const {
+        return ioThreadPool_.get();
+    }
+
 private:
+    // The backoff of sending a batch again which the receiver refused by its rate limit
+    static constexpr int64_t kMinThrottleBackoffMs = 10;
+    static constexpr int64_t kMaxThrottleBackoffMs = 1000;
+
+    // The snapshots sent to the same host share the bandwidth of snapshot_send_rate_limit, and
+    // at most snapshot_send_max_parts_per_host of them are sent at the same time, the others
+    // wait in pending until one of them is finished
+    struct HostBudget {
+        folly::DynamicTokenBucket bucket;
+        std::mutex lock;
+        int32_t sending{0};
+        std::deque<folly::Func> pending;
+    };
+
+    std::shared_ptr<HostBudget> getHostBudget(const HostAddr& dst);
+
+    // Start the next pending snapshot of the host if there is any
+    void onSnapshotFinished(std::shared_ptr<HostBudget> budget);
+
     folly::Future<raftex::cpp2::SendSnapshotResponse> send(
                                                    GraphSpaceID spaceId,
                                                    PartitionID partId,
@@ -64,6 +92,9 @@ private:
     std::unique_ptr<folly::IOThreadPoolExecutor> executor_;
     std::unique_ptr<folly::IOThreadPoolExecutor> ioThreadPool_;
     thrift::ThriftClientManager<raftex::cpp2::RaftexServiceAsyncClient> connManager_;
+
+    std::mutex budgetsLock_;
+    std::unordered_map<HostAddr, std::shared_ptr<HostBudget>> budgets_;
 };
 
 }  // namespace raftex
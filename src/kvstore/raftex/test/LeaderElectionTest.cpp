@@ -39,6 +39,34 @@ TEST(LeaderElection, ElectionWithThreeCopies) {
 }
 
 
+TEST(LeaderElection, ElectionWithControlChannel) {
+    LOG(INFO) << "=====> Start ElectionWithControlChannel test";
+    fs::TempDir walRoot("/tmp/election_with_control_channel.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    // the votes and heartbeats are sent by the io threads of their own
+    auto controlPool = std::make_shared<folly::IOThreadPoolExecutor>(2);
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader, {}, controlPool);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    // the logs are still replicated by the io threads of the service
+    std::vector<std::string> msgs;
+    appendLogs(0, 9, leader, msgs, true);
+    ASSERT_TRUE(checkConsensus(copies, 0, 9, msgs));
+
+    finishRaft(services, copies, workers, leader);
+
+    LOG(INFO) << "<===== Done ElectionWithControlChannel test";
+}
+
+
 TEST(LeaderElection, ElectionWithOneCopy) {
     LOG(INFO) << "=====> Start ElectionWithOneCopy test";
     fs::TempDir walRoot("/tmp/election_with_one_copy.XXXXXX");
@@ -16,6 +16,7 @@
 #include "kvstore/raftex/test/TestShard.h"
 
 DECLARE_uint32(raft_heartbeat_interval_secs);
+DECLARE_bool(raft_reject_disruptive_vote);
 
 namespace nebula {
 namespace raftex {
@@ -55,6 +56,41 @@ TEST(LeaderTransferTest, SimpleTest) {
     finishRaft(services, copies, workers, leader);
 }
 
+TEST(LeaderTransferTest, RejectDisruptiveVoteTest) {
+    FLAGS_raft_heartbeat_interval_secs = 1;
+    FLAGS_raft_reject_disruptive_vote = true;
+    SCOPE_EXIT {
+        FLAGS_raft_reject_disruptive_vote = false;
+    };
+    fs::TempDir walRoot("/tmp/leader_transfer_test.reject_disruptive_vote.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    auto index = checkLeadership(copies, leader);
+
+    // The other followers still hear from the leader, but vote for the transfer target
+    auto nLeaderIndex = (index + 1) % 3;
+    auto f = leader->sendCommandAsync(test::encodeTransferLeader(allHosts[nLeaderIndex]));
+    f.wait();
+
+    leader.reset();
+    waitUntilLeaderElected(copies, leader);
+
+    checkLeadership(copies, nLeaderIndex, leader);
+
+    std::vector<std::string> msgs;
+    appendLogs(0, 99, leader, msgs);
+    checkConsensus(copies, 0, 99, msgs);
+    finishRaft(services, copies, workers, leader);
+}
+
 TEST(LeaderTransferTest, ChangeLeaderServalTimesTest) {
     fs::TempDir walRoot("/tmp/leader_transfer_test.simple_test.XXXXXX");
     std::shared_ptr<thread::GenericThreadPool> workers;
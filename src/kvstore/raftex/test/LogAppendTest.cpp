@@ -10,13 +10,27 @@
 #include "common/thread/GenericThreadPool.h"
 #include "common/network/NetworkUtils.h"
 #include "kvstore/raftex/RaftexService.h"
+#include "kvstore/raftex/RpcCompression.h"
 #include "kvstore/raftex/test/RaftexTestBase.h"
 #include "kvstore/raftex/test/TestShard.h"
+#include "kvstore/wal/FileBasedWal.h"
 #include <gtest/gtest.h>
 #include <folly/String.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 
 DECLARE_uint32(raft_heartbeat_interval_secs);
 DECLARE_uint32(max_batch_size);
+DECLARE_uint32(max_appendlog_batch_size);
+DECLARE_uint32(raft_max_inflight_appendlog);
+DECLARE_bool(raft_skip_heartbeat_after_append);
+DECLARE_int32(raft_quiesce_idle_secs);
+DECLARE_bool(raft_apply_async);
+DECLARE_int32(raft_buffer_full_wait_ms);
+DECLARE_bool(raft_parallel_wal_flush);
+DECLARE_bool(raft_share_log_entries);
+DECLARE_uint32(raft_catch_up_lag_logs);
+DECLARE_uint32(raft_catch_up_batch_size);
+DECLARE_int32(raft_catch_up_rate_limit);
 
 namespace nebula {
 namespace raftex {
@@ -65,6 +79,32 @@ TEST(LogAppend, SimpleAppendWithThreeCopies) {
 }
 
 
+TEST(LogAppend, CompressedAppend) {
+    EXPECT_EQ(0, RpcCompression::transformOf("lz4"));
+    EXPECT_NE(0, RpcCompression::transformOf("zstd"));
+    FLAGS_raft_rpc_compression = "zstd";
+    FLAGS_raft_rpc_compress_min_bytes = 0;
+    fs::TempDir walRoot("/tmp/compressed_append.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+    checkLeadership(copies, leader);
+
+    std::vector<std::string> msgs;
+    appendLogs(0, 99, leader, msgs);
+    checkConsensus(copies, 0, 99, msgs);
+
+    finishRaft(services, copies, workers, leader);
+    FLAGS_raft_rpc_compression = "";
+    FLAGS_raft_rpc_compress_min_bytes = 64 * 1024;
+}
+
+
 TEST(LogAppend, MultiThreadAppend) {
     fs::TempDir walRoot("/tmp/multi_thread_append.XXXXXX");
     std::shared_ptr<thread::GenericThreadPool> workers;
@@ -135,6 +175,354 @@ TEST(LogAppend, MultiThreadAppend) {
     finishRaft(services, copies, workers, leader);
 }
 
+TEST(LogAppend, BufferFullBackPressure) {
+    // The buffer is much smaller than the logs appended concurrently, so the writes have to
+    // wait when it is full instead of failing
+    auto batchSize = FLAGS_max_batch_size;
+    FLAGS_max_batch_size = 8;
+    FLAGS_raft_buffer_full_wait_ms = 10000;
+    SCOPE_EXIT {
+        FLAGS_max_batch_size = batchSize;
+        FLAGS_raft_buffer_full_wait_ms = 0;
+    };
+    fs::TempDir walRoot("/tmp/buffer_full_back_pressure.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    const int numThreads = 4;
+    const int numLogs = 100;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < numThreads; ++i) {
+        threads.emplace_back(std::thread([i, leader] {
+            std::vector<folly::Future<AppendLogResult>> futures;
+            for (int j = 1; j <= numLogs; ++j) {
+                futures.emplace_back(leader->appendAsync(
+                    0, folly::stringPrintf("Log %03d for t%d", j, i)));
+            }
+            for (auto& fut : futures) {
+                ASSERT_EQ(AppendLogResult::SUCCEEDED, std::move(fut).get());
+            }
+        }));
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // Sleep a while to make sure the last log has been committed on followers
+    sleep(FLAGS_raft_heartbeat_interval_secs);
+    for (auto& c : copies) {
+        ASSERT_EQ(numThreads * numLogs, c->getNumLogs());
+    }
+
+    finishRaft(services, copies, workers, leader);
+}
+
+TEST(LogAppend, ReadFromFollowerWithinStaleness) {
+    fs::TempDir walRoot("/tmp/read_from_follower_within_staleness.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    std::vector<std::string> msgs;
+    appendLogs(0, 99, leader, msgs);
+    checkConsensus(copies, 0, 99, msgs);
+
+    // The followers have received the heartbeat or logs of leader in a heartbeat interval
+    int64_t staleness = FLAGS_raft_heartbeat_interval_secs * 2000;
+    for (auto& c : copies) {
+        EXPECT_TRUE(c->readableWithin(staleness));
+    }
+    size_t index = leader->index() == 0 ? 1 : 0;
+    killOneCopy(services, copies, leader, index);
+    EXPECT_FALSE(copies[index]->readableWithin(staleness));
+
+    finishRaft(services, copies, workers, leader);
+}
+
+TEST(LogAppend, PipelinedAppend) {
+    // Each request carries a few logs, so the logs are sent in several requests in flight
+    auto batchSize = FLAGS_max_appendlog_batch_size;
+    FLAGS_max_appendlog_batch_size = 8;
+    FLAGS_raft_max_inflight_appendlog = 4;
+    SCOPE_EXIT {
+        FLAGS_max_appendlog_batch_size = batchSize;
+        FLAGS_raft_max_inflight_appendlog = 1;
+    };
+    fs::TempDir walRoot("/tmp/pipelined_append.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    std::vector<std::string> msgs;
+    appendLogs(0, 99, leader, msgs);
+    checkConsensus(copies, 0, 99, msgs);
+
+    // The follower catches up the logs it missed by the pipelined requests
+    size_t index = leader->index() == 0 ? 1 : 0;
+    killOneCopy(services, copies, leader, index);
+    appendLogs(100, 299, leader, msgs);
+    rebootOneCopy(services, copies, allHosts, index);
+    appendLogs(300, 399, leader, msgs);
+    checkConsensus(copies, 0, 399, msgs);
+
+    finishRaft(services, copies, workers, leader);
+}
+
+TEST(LogAppend, ThrottledCatchUp) {
+    // The follower more than 50 logs behind is caught up by 64 logs a request, 1MB per sec
+    FLAGS_raft_catch_up_lag_logs = 50;
+    FLAGS_raft_catch_up_batch_size = 64;
+    FLAGS_raft_catch_up_rate_limit = 1;
+    SCOPE_EXIT {
+        FLAGS_raft_catch_up_lag_logs = 0;
+        FLAGS_raft_catch_up_batch_size = 1024;
+        FLAGS_raft_catch_up_rate_limit = 0;
+    };
+    fs::TempDir walRoot("/tmp/throttled_catch_up.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    std::vector<std::string> msgs;
+    appendLogs(0, 9, leader, msgs);
+    checkConsensus(copies, 0, 9, msgs);
+
+    // The logs are committed by the leader and the other follower while one is catching up
+    size_t index = leader->index() == 0 ? 1 : 0;
+    killOneCopy(services, copies, leader, index);
+    appendLogs(10, 309, leader, msgs);
+    rebootOneCopy(services, copies, allHosts, index);
+    appendLogs(310, 409, leader, msgs);
+    checkConsensus(copies, 0, 409, msgs);
+
+    finishRaft(services, copies, workers, leader);
+}
+
+TEST(LogAppend, ApplyAsync) {
+    FLAGS_raft_apply_async = true;
+    SCOPE_EXIT {
+        FLAGS_raft_apply_async = false;
+    };
+    fs::TempDir walRoot("/tmp/apply_async.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    auto applyPool = std::make_shared<folly::CPUThreadPoolExecutor>(2);
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader, {}, nullptr,
+              applyPool);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    // The future of each log is fulfilled after it is applied on the leader
+    std::vector<std::string> msgs;
+    appendLogs(0, 149, leader, msgs);
+    // The AtomicOp is evaluated after the logs applied in the background
+    auto fut = leader->atomicOpAsync([] () { return test::compareAndSet("TCAS Log Message"); });
+    msgs.emplace_back("CAS Log Message");
+    appendLogs(151, 299, leader, msgs);
+    ASSERT_EQ(AppendLogResult::SUCCEEDED, std::move(fut).get());
+    checkConsensus(copies, 0, 299, msgs);
+
+    finishRaft(services, copies, workers, leader);
+}
+
+TEST(LogAppend, ParallelWalFlush) {
+    FLAGS_raft_parallel_wal_flush = true;
+    SCOPE_EXIT {
+        FLAGS_raft_parallel_wal_flush = false;
+    };
+    fs::TempDir walRoot("/tmp/parallel_wal_flush.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    // The logs are committed after both the quorum and the leader's WAL have them
+    std::vector<std::string> msgs;
+    appendLogs(0, 299, leader, msgs);
+    checkConsensus(copies, 0, 299, msgs);
+
+    finishRaft(services, copies, workers, leader);
+}
+
+TEST(LogAppend, ShareLogEntries) {
+    FLAGS_raft_share_log_entries = true;
+    SCOPE_EXIT {
+        FLAGS_raft_share_log_entries = false;
+    };
+    fs::TempDir walRoot("/tmp/share_log_entries.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(5, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    // The followers are sent the same entries read once
+    std::vector<std::string> msgs;
+    appendLogs(0, 299, leader, msgs);
+    checkConsensus(copies, 0, 299, msgs);
+
+    finishRaft(services, copies, workers, leader);
+}
+
+TEST(LogAppend, ReadIndex) {
+    fs::TempDir walRoot("/tmp/read_index.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    std::vector<std::string> msgs;
+    appendLogs(0, 99, leader, msgs);
+
+    // The reads at the same time are confirmed together
+    std::vector<folly::Future<AppendLogResult>> futures;
+    for (int i = 0; i < 10; i++) {
+        futures.emplace_back(leader->readIndexAsync());
+    }
+    for (auto& f : futures) {
+        ASSERT_EQ(AppendLogResult::SUCCEEDED, std::move(f).get());
+    }
+    for (auto& c : copies) {
+        if (c != leader) {
+            ASSERT_EQ(AppendLogResult::E_NOT_A_LEADER, c->readIndexAsync().get());
+        }
+    }
+    checkConsensus(copies, 0, 99, msgs);
+
+    finishRaft(services, copies, workers, leader);
+}
+
+TEST(LogAppend, SkipHeartbeatAfterAppend) {
+    FLAGS_raft_skip_heartbeat_after_append = true;
+    SCOPE_EXIT {
+        FLAGS_raft_skip_heartbeat_after_append = false;
+    };
+    fs::TempDir walRoot("/tmp/skip_heartbeat_after_append.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    std::vector<std::string> msgs;
+    appendLogs(0, 99, leader, msgs);
+    checkConsensus(copies, 0, 99, msgs);
+
+    // The empty logs appended periodically keep the followers from starting an election
+    auto term = leader->termId();
+    sleep(FLAGS_raft_heartbeat_interval_secs * 3);
+    EXPECT_TRUE(leader->isLeader());
+    EXPECT_EQ(term, leader->termId());
+
+    finishRaft(services, copies, workers, leader);
+}
+
+TEST(LogAppend, QuiescentLeader) {
+    // The flag is checked when the services start
+    FLAGS_raft_quiesce_idle_secs = 1;
+    SCOPE_EXIT {
+        FLAGS_raft_quiesce_idle_secs = 0;
+    };
+    fs::TempDir walRoot("/tmp/quiescent_leader.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(3, walRoot, workers, wals, allHosts, services, copies, leader);
+
+    // Check all hosts agree on the same leader
+    checkLeadership(copies, leader);
+
+    std::vector<std::string> msgs;
+    appendLogs(0, 99, leader, msgs);
+    checkConsensus(copies, 0, 99, msgs);
+
+    // No empty log is appended once the leader is quiescent, and the node heartbeats keep
+    // the followers from starting an election and renew the lease of leader
+    auto term = leader->termId();
+    sleep(FLAGS_raft_heartbeat_interval_secs * 3);
+    auto lastLogId = leader->wal()->lastLogId();
+    sleep(FLAGS_raft_heartbeat_interval_secs * 2);
+    EXPECT_EQ(lastLogId, leader->wal()->lastLogId());
+    EXPECT_TRUE(leader->isLeader());
+    EXPECT_EQ(term, leader->termId());
+    EXPECT_TRUE(leader->leaseValid());
+
+    // A write wakes it up
+    appendLogs(100, 199, leader, msgs);
+    checkConsensus(copies, 0, 199, msgs);
+
+    finishRaft(services, copies, workers, leader);
+}
+
 }  // namespace raftex
 }  // namespace nebula
 
@@ -0,0 +1,144 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+/*
+The benchmark of the raft replication end to end. It sets up --replicas copies of a part in
+process, appends --total_logs logs of --log_size bytes to the leader with at most --inflight
+of them not committed yet, and reports the commits per second and the percentiles of the
+commit latency.
+
+The network of the followers is faulted by --rtt_ms, which every appendLog request to a
+follower is delayed by, and by --loss_percent of the requests failed, which the leader sends
+again like the requests lost. The replication is tuned by the flags of raftex and wal as they
+are, such as --max_batch_size, --max_appendlog_batch_size, --raft_max_inflight_appendlog for
+the pipelining, and --wal_sync.
+*/
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include "common/thread/GenericThreadPool.h"
+#include "common/time/Duration.h"
+#include "common/time/WallClock.h"
+#include "kvstore/raftex/RaftexService.h"
+#include "kvstore/raftex/test/RaftexTestBase.h"
+#include "kvstore/raftex/test/TestShard.h"
+
+DEFINE_int32(replicas, 3, "The number of the copies of the part");
+DEFINE_int32(total_logs, 100000, "The number of the logs appended");
+DEFINE_int32(log_size, 128, "The size of each log");
+DEFINE_int32(inflight, 64, "The max logs appended but not committed yet");
+DEFINE_int32(rtt_ms, 0, "The delay of each appendLog request to the followers");
+DEFINE_int32(loss_percent, 0, "The percent of the appendLog requests to the followers failed");
+
+namespace nebula {
+namespace raftex {
+
+int64_t percentile(const std::vector<int64_t>& sorted, double p) {
+    if (sorted.empty()) {
+        return 0;
+    }
+    auto index = std::min<size_t>(sorted.size() * p, sorted.size() - 1);
+    return sorted[index];
+}
+
+int run() {
+    fs::TempDir walRoot("/tmp/raft_benchmark.XXXXXX");
+    std::shared_ptr<thread::GenericThreadPool> workers;
+    std::vector<std::string> wals;
+    std::vector<HostAddr> allHosts;
+    std::vector<std::shared_ptr<RaftexService>> services;
+    std::vector<std::shared_ptr<test::TestShard>> copies;
+    std::shared_ptr<test::TestShard> leader;
+    setupRaft(FLAGS_replicas, walRoot, workers, wals, allHosts, services, copies, leader);
+    checkLeadership(copies, leader);
+
+    // only the requests to the followers are faulted, the heartbeats are faulted as well, so a
+    // rtt_ms or loss_percent beyond the election timeout makes the leader change, and the logs
+    // appended then fail and are counted
+    std::atomic<int64_t> lost{0};
+    for (size_t i = 0; i < copies.size(); i++) {
+        if (copies[i] == leader) {
+            continue;
+        }
+        services[i]->setAppendLogHook([&lost] (const cpp2::AppendLogRequest&) {
+            if (FLAGS_rtt_ms > 0) {
+                usleep(FLAGS_rtt_ms * 1000);
+            }
+            if (FLAGS_loss_percent > 0 &&
+                folly::Random::rand32(100) < static_cast<uint32_t>(FLAGS_loss_percent)) {
+                lost++;
+                throw std::runtime_error("The request is lost");
+            }
+        });
+    }
+
+    std::mutex lock;
+    std::condition_variable cv;
+    int32_t inflight = 0;
+    int32_t finished = 0;
+    int64_t failed = 0;
+    std::vector<int64_t> latencies;
+    latencies.reserve(FLAGS_total_logs);
+    std::string log(FLAGS_log_size, 'A');
+
+    LOG(INFO) << "Append " << FLAGS_total_logs << " logs to " << FLAGS_replicas << " replicas";
+    time::Duration duration;
+    for (int32_t i = 0; i < FLAGS_total_logs; i++) {
+        {
+            std::unique_lock<std::mutex> g(lock);
+            cv.wait(g, [&] { return inflight < FLAGS_inflight; });
+            inflight++;
+        }
+        auto start = time::WallClock::fastNowInMicroSec();
+        leader->appendAsync(0, log).thenValue([&, start] (AppendLogResult res) {
+            auto latency = time::WallClock::fastNowInMicroSec() - start;
+            std::lock_guard<std::mutex> g(lock);
+            if (res == AppendLogResult::SUCCEEDED) {
+                latencies.emplace_back(latency);
+            } else {
+                failed++;
+            }
+            inflight--;
+            finished++;
+            cv.notify_all();
+        });
+    }
+    {
+        std::unique_lock<std::mutex> g(lock);
+        cv.wait(g, [&] { return finished == FLAGS_total_logs; });
+    }
+    auto elapsedUs = std::max<int64_t>(duration.elapsedInUSec(), 1);
+
+    std::sort(latencies.begin(), latencies.end());
+    LOG(INFO) << "Committed " << latencies.size() << " logs in " << elapsedUs / 1000 << "ms, "
+              << "failed " << failed << ", requests lost " << lost
+              << ", commits/sec " << latencies.size() * 1000000.0 / elapsedUs;
+    LOG(INFO) << "Commit latency(us) p50 = " << percentile(latencies, 0.5)
+              << ", p90 = " << percentile(latencies, 0.9)
+              << ", p99 = " << percentile(latencies, 0.99)
+              << ", p999 = " << percentile(latencies, 0.999)
+              << ", max = " << (latencies.empty() ? 0 : latencies.back());
+
+    for (auto& service : services) {
+        service->setAppendLogHook(nullptr);
+    }
+    finishRaft(services, copies, workers, leader);
+    return 0;
+}
+
+}  // namespace raftex
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    if (FLAGS_replicas <= 0 || FLAGS_total_logs <= 0 || FLAGS_inflight <= 0 ||
+        FLAGS_loss_percent < 0 || FLAGS_loss_percent >= 100) {
+        LOG(ERROR) << "Invalid replicas, total_logs, inflight or loss_percent";
+        return 1;
+    }
+    return nebula::raftex::run();
+}
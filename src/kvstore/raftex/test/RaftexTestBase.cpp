@@ -159,7 +159,9 @@ void setupRaft(
         std::vector<std::shared_ptr<RaftexService>>& services,
         std::vector<std::shared_ptr<test::TestShard>>& copies,
         std::shared_ptr<test::TestShard>& leader,
-        std::vector<bool> isLearner) {
+        std::vector<bool> isLearner,
+        std::shared_ptr<folly::IOThreadPoolExecutor> controlPool,
+        std::shared_ptr<folly::Executor> applyPool) {
     std::string ipStr("127.0.0.1");
 
     workers = std::make_shared<thread::GenericThreadPool>();
@@ -211,6 +213,14 @@ void setupRaft(
                       std::placeholders::_1,
                       std::placeholders::_2,
                       std::placeholders::_3)));
+        if (controlPool != nullptr) {
+            copies.back()->setControlChannel(
+                controlPool,
+                std::make_shared<thrift::ThriftClientManager<cpp2::RaftexServiceAsyncClient>>());
+        }
+        if (applyPool != nullptr) {
+            copies.back()->setApplyExecutor(applyPool);
+        }
         services[i]->addPartition(copies.back());
         copies.back()->start(getPeers(allHosts, allHosts[i], isLearner),
                              isLearner[i]);
@@ -64,7 +64,11 @@ void setupRaft(
         std::vector<std::shared_ptr<RaftexService>>& services,
         std::vector<std::shared_ptr<test::TestShard>>& copies,
         std::shared_ptr<test::TestShard>& leader,
-        std::vector<bool> isLearner = {});
+        std::vector<bool> isLearner = {},
+        // the heartbeats and votes are sent by it if not null, see RaftPart::setControlChannel
+        std::shared_ptr<folly::IOThreadPoolExecutor> controlPool = nullptr,
+        // the leaders apply the logs by it if not null, see RaftPart::setApplyExecutor
+        std::shared_ptr<folly::Executor> applyPool = nullptr);
 
 void finishRaft(std::vector<std::shared_ptr<RaftexService>>& services,
                 std::vector<std::shared_ptr<test::TestShard>>& copies,
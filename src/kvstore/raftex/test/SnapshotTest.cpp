@@ -21,11 +21,14 @@ DECLARE_int64(wal_file_size);
 DECLARE_int32(wal_buffer_size);
 DECLARE_int32(wal_buffer_num);
 DECLARE_int32(raft_rpc_timeout_ms);
+DECLARE_int32(snapshot_send_rate_limit);
+DECLARE_int32(snapshot_send_max_parts_per_host);
+DECLARE_int32(snapshot_recv_rate_limit);
 
 namespace nebula {
 namespace raftex {
 
-TEST(SnapshotTest, LearnerCatchUpDataTest) {
+void learnerCatchUpData() {
     fs::TempDir walRoot("/tmp/catch_up_data.XXXXXX");
     FLAGS_wal_file_size = 1024;
     FLAGS_wal_buffer_size = 512;
@@ -88,6 +91,20 @@ TEST(SnapshotTest, LearnerCatchUpDataTest) {
     finishRaft(services, copies, workers, leader);
 }
 
+TEST(SnapshotTest, LearnerCatchUpDataTest) {
+    learnerCatchUpData();
+}
+
+TEST(SnapshotTest, LearnerCatchUpDataWithRateLimitTest) {
+    FLAGS_snapshot_send_rate_limit = 1;
+    FLAGS_snapshot_send_max_parts_per_host = 1;
+    FLAGS_snapshot_recv_rate_limit = 1;
+    learnerCatchUpData();
+    FLAGS_snapshot_send_rate_limit = 0;
+    FLAGS_snapshot_send_max_parts_per_host = 0;
+    FLAGS_snapshot_recv_rate_limit = 0;
+}
+
 }  // namespace raftex
 }  // namespace nebula
 
@@ -0,0 +1,199 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/FileUtils.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include "kvstore/BackupManifest.h"
+
+namespace nebula {
+namespace kvstore {
+
+using fs::FileUtils;
+
+class BackupManifestTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root_ = std::make_unique<fs::TempDir>("/tmp/backup_manifest_test.XXXXXX");
+        live_ = folly::stringPrintf("%s/live", root_->path());
+        ASSERT_TRUE(FileUtils::makeDir(live_));
+    }
+
+    void writeLive(const std::string& file, const std::string& content) {
+        std::ofstream out(FileUtils::joinPath(live_, file), std::ios::trunc);
+        out << content;
+    }
+
+    void appendLive(const std::string& file, const std::string& content) {
+        std::ofstream out(FileUtils::joinPath(live_, file), std::ios::app);
+        out << content;
+    }
+
+    // Link the live files into the checkpoint, as the engine and the wal do
+    void checkpoint(const std::string& name,
+                    const std::vector<std::string>& data,
+                    const std::vector<std::string>& wals) {
+        auto dataDir = folly::stringPrintf("%s/checkpoints/%s/data", root_->path(), name.c_str());
+        auto walDir = folly::stringPrintf("%s/checkpoints/%s/wal/1", root_->path(), name.c_str());
+        ASSERT_TRUE(FileUtils::makeDir(dataDir));
+        ASSERT_TRUE(FileUtils::makeDir(walDir));
+        for (auto& file : data) {
+            ASSERT_EQ(0, ::link(FileUtils::joinPath(live_, file).c_str(),
+                                FileUtils::joinPath(dataDir, file).c_str()));
+        }
+        for (auto& file : wals) {
+            ASSERT_EQ(0, ::link(FileUtils::joinPath(live_, file).c_str(),
+                                FileUtils::joinPath(walDir, file).c_str()));
+        }
+        ASSERT_TRUE(BackupManifest::build(root_->path(), root_->path(), name));
+    }
+
+    std::map<std::string, std::string> manifest(const std::string& name) {
+        std::vector<BackupManifest::Entry> entries;
+        auto path = folly::stringPrintf("%s/checkpoints/%s/%s",
+                                        root_->path(), name.c_str(), BackupManifest::kFileName);
+        EXPECT_TRUE(BackupManifest::read(path, &entries));
+        std::map<std::string, std::string> files;
+        for (auto& entry : entries) {
+            files[entry.path] = entry.checkpoint;
+        }
+        return files;
+    }
+
+    bool exist(const std::string& name, const std::string& path) {
+        return FileUtils::exist(
+            folly::stringPrintf("%s/checkpoints/%s/%s", root_->path(), name.c_str(), path.c_str()));
+    }
+
+protected:
+    std::unique_ptr<fs::TempDir> root_;
+    std::string live_;
+};
+
+TEST_F(BackupManifestTest, IncrementalTest) {
+    writeLive("000001.sst", "sst1");
+    writeLive("CURRENT", "MANIFEST-000001");
+    writeLive("0000000000000000001.wal", "wal1");
+    writeLive("0000000000000000010.wal", "wal10");
+    checkpoint("BACKUP_1", {"000001.sst", "CURRENT"},
+               {"0000000000000000001.wal", "0000000000000000010.wal"});
+    // nothing to reuse for the first backup
+    auto files = manifest("BACKUP_1");
+    ASSERT_EQ(4, files.size());
+    for (auto& file : files) {
+        ASSERT_EQ("BACKUP_1", file.second);
+        ASSERT_TRUE(exist("BACKUP_1", file.first));
+    }
+
+    writeLive("000002.sst", "sst2");
+    appendLive("0000000000000000010.wal", "wal11");
+    writeLive("0000000000000000020.wal", "wal20");
+    checkpoint("BACKUP_2", {"000001.sst", "000002.sst", "CURRENT"},
+               {"0000000000000000001.wal", "0000000000000000010.wal", "0000000000000000020.wal"});
+    files = manifest("BACKUP_2");
+    ASSERT_EQ(6, files.size());
+    ASSERT_EQ("BACKUP_1", files["data/000001.sst"]);
+    ASSERT_FALSE(exist("BACKUP_2", "data/000001.sst"));
+    ASSERT_EQ("BACKUP_1", files["wal/1/0000000000000000001.wal"]);
+    ASSERT_FALSE(exist("BACKUP_2", "wal/1/0000000000000000001.wal"));
+    // the last wal of the previous backup has been appended, and the rocksdb files other than
+    // sst are always kept
+    ASSERT_EQ("BACKUP_2", files["wal/1/0000000000000000010.wal"]);
+    ASSERT_TRUE(exist("BACKUP_2", "wal/1/0000000000000000010.wal"));
+    ASSERT_EQ("BACKUP_2", files["data/CURRENT"]);
+    ASSERT_TRUE(exist("BACKUP_2", "data/CURRENT"));
+    ASSERT_EQ("BACKUP_2", files["data/000002.sst"]);
+    ASSERT_EQ("BACKUP_2", files["wal/1/0000000000000000020.wal"]);
+
+    // the files reused are listed with the checkpoint which has them
+    checkpoint("BACKUP_3", {"000001.sst", "000002.sst", "CURRENT"},
+               {"0000000000000000010.wal", "0000000000000000020.wal"});
+    files = manifest("BACKUP_3");
+    ASSERT_EQ(5, files.size());
+    ASSERT_EQ("BACKUP_1", files["data/000001.sst"]);
+    ASSERT_EQ("BACKUP_2", files["data/000002.sst"]);
+    ASSERT_EQ("BACKUP_2", files["wal/1/0000000000000000010.wal"]);
+    ASSERT_EQ("BACKUP_3", files["wal/1/0000000000000000020.wal"]);
+    ASSERT_EQ("BACKUP_3", BackupManifest::previous(root_->path(), "BACKUP_4"));
+
+    // the backup depending on a checkpoint dropped is not reused
+    ASSERT_TRUE(FileUtils::remove(
+        folly::stringPrintf("%s/checkpoints/BACKUP_1", root_->path()).c_str(), true));
+    ASSERT_EQ("", BackupManifest::previous(root_->path(), "BACKUP_4"));
+    checkpoint("BACKUP_4", {"000001.sst", "000002.sst"}, {"0000000000000000020.wal"});
+    files = manifest("BACKUP_4");
+    ASSERT_EQ(3, files.size());
+    for (auto& file : files) {
+        ASSERT_EQ("BACKUP_4", file.second);
+    }
+}
+
+TEST_F(BackupManifestTest, DropBaseTest) {
+    writeLive("000001.sst", "sst1");
+    writeLive("0000000000000000001.wal", "wal1");
+    writeLive("0000000000000000010.wal", "wal10");
+    checkpoint("BACKUP_1", {"000001.sst"},
+               {"0000000000000000001.wal", "0000000000000000010.wal"});
+    writeLive("000002.sst", "sst2");
+    checkpoint("BACKUP_2", {"000001.sst", "000002.sst"}, {"0000000000000000010.wal"});
+    writeLive("000003.sst", "sst3");
+    checkpoint("BACKUP_3", {"000001.sst", "000002.sst", "000003.sst"},
+               {"0000000000000000010.wal"});
+    ASSERT_EQ("BACKUP_1", manifest("BACKUP_3")["data/000001.sst"]);
+
+    // drop the base, its files listed later are kept in the first backup listing them
+    ASSERT_TRUE(BackupManifest::release(root_->path(), root_->path(), "BACKUP_1"));
+    ASSERT_TRUE(FileUtils::remove(
+        folly::stringPrintf("%s/checkpoints/BACKUP_1", root_->path()).c_str(), true));
+    auto files = manifest("BACKUP_2");
+    ASSERT_EQ("BACKUP_2", files["data/000001.sst"]);
+    ASSERT_TRUE(exist("BACKUP_2", "data/000001.sst"));
+    files = manifest("BACKUP_3");
+    ASSERT_EQ("BACKUP_2", files["data/000001.sst"]);
+    ASSERT_EQ("BACKUP_2", files["data/000002.sst"]);
+    ASSERT_FALSE(exist("BACKUP_3", "data/000001.sst"));
+
+    // the incremental backups are still restorable, and reused by the next one
+    for (const auto& name : {"BACKUP_2", "BACKUP_3"}) {
+        for (auto& file : manifest(name)) {
+            ASSERT_TRUE(exist(file.second, file.first)) << name << " " << file.first;
+        }
+    }
+    ASSERT_EQ("BACKUP_3", BackupManifest::previous(root_->path(), "BACKUP_4"));
+    std::ifstream in(folly::stringPrintf("%s/checkpoints/BACKUP_2/data/000001.sst",
+                                         root_->path()));
+    std::string content;
+    std::getline(in, content);
+    ASSERT_EQ("sst1", content);
+}
+
+TEST_F(BackupManifestTest, ChangedFileTest) {
+    writeLive("000001.sst", "sst1");
+    writeLive("0000000000000000001.wal", "wal1");
+    checkpoint("BACKUP_1", {"000001.sst"}, {"0000000000000000001.wal"});
+    // a file of the same name and size but not the same one
+    ASSERT_TRUE(FileUtils::remove(FileUtils::joinPath(live_, "000001.sst").c_str()));
+    writeLive("000001.sst", "sst2");
+    writeLive("0000000000000000002.wal", "wal2");
+    checkpoint("BACKUP_2", {"000001.sst"}, {"0000000000000000001.wal", "0000000000000000002.wal"});
+    auto files = manifest("BACKUP_2");
+    ASSERT_EQ("BACKUP_2", files["data/000001.sst"]);
+    ASSERT_TRUE(exist("BACKUP_2", "data/000001.sst"));
+    // the last wal of BACKUP_1 is not the last one now, it's reused as its size is not changed
+    ASSERT_EQ("BACKUP_1", files["wal/1/0000000000000000001.wal"]);
+}
+
+}  // namespace kvstore
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
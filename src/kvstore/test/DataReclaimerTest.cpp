@@ -0,0 +1,85 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/FileUtils.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include <fstream>
+#include "kvstore/DataReclaimer.h"
+
+namespace nebula {
+namespace kvstore {
+
+using fs::FileUtils;
+
+namespace {
+
+void writeFile(const std::string& path, size_t size) {
+    std::ofstream out(path, std::ios::trunc);
+    out << std::string(size, 'x');
+}
+
+void waitReclaimed(const DataReclaimer& reclaimer) {
+    for (int32_t i = 0; i < 1000 && reclaimer.progress().dirs > 0; i++) {
+        usleep(10000);
+    }
+}
+
+}  // namespace
+
+TEST(DataReclaimerTest, ReclaimTest) {
+    fs::TempDir rootPath("/tmp/DataReclaimerTest.XXXXXX");
+    auto spaceDir = folly::stringPrintf("%s/nebula/1", rootPath.path());
+    ASSERT_TRUE(FileUtils::makeDir(spaceDir + "/data"));
+    ASSERT_TRUE(FileUtils::makeDir(spaceDir + "/wal/1"));
+    writeFile(spaceDir + "/data/000001.sst", 300 * 1024);
+    writeFile(spaceDir + "/data/000002.sst", 10 * 1024);
+    writeFile(spaceDir + "/wal/1/0000000000000000001.wal", 100 * 1024);
+
+    // 100KB in each interval
+    DataReclaimer reclaimer(1024 * 1024);
+    ASSERT_TRUE(reclaimer.start({rootPath.path()}));
+    ASSERT_TRUE(reclaimer.add(spaceDir));
+    // the dir is moved at once
+    ASSERT_FALSE(FileUtils::exist(spaceDir));
+    auto progress = reclaimer.progress();
+    ASSERT_GE(progress.bytesLeft + progress.bytesReclaimed, 410 * 1024);
+
+    waitReclaimed(reclaimer);
+    progress = reclaimer.progress();
+    ASSERT_EQ(0, progress.dirs);
+    ASSERT_EQ(0, progress.bytesLeft);
+    ASSERT_EQ(410 * 1024, progress.bytesReclaimed);
+    auto reclaimDir = folly::stringPrintf("%s/reclaim", rootPath.path());
+    ASSERT_TRUE(FileUtils::listAllDirsInDir(reclaimDir.c_str()).empty());
+    reclaimer.stop();
+}
+
+TEST(DataReclaimerTest, ResumeTest) {
+    fs::TempDir rootPath("/tmp/DataReclaimerTest.XXXXXX");
+    // left by the last run
+    auto trashDir = folly::stringPrintf("%s/reclaim/1.1000/data", rootPath.path());
+    ASSERT_TRUE(FileUtils::makeDir(trashDir));
+    writeFile(trashDir + "/000001.sst", 50 * 1024);
+
+    DataReclaimer reclaimer(1024 * 1024);
+    ASSERT_TRUE(reclaimer.start({rootPath.path()}));
+    waitReclaimed(reclaimer);
+    ASSERT_EQ(0, reclaimer.progress().dirs);
+    ASSERT_EQ(50 * 1024, reclaimer.progress().bytesReclaimed);
+    ASSERT_FALSE(FileUtils::exist(folly::stringPrintf("%s/reclaim/1.1000", rootPath.path())));
+}
+
+}  // namespace kvstore
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -8,6 +8,8 @@
 #include <gtest/gtest.h>
 #include "kvstore/LogEncoder.h"
 
+DECLARE_int32(wal_compress_threshold);
+DECLARE_string(wal_compression);
 
 namespace nebula {
 namespace kvstore {
@@ -114,6 +116,42 @@ TEST(LogEncoderTest, MultiValuesTest) {
     }
 }
 
+TEST(LogEncoderTest, CompressTest) {
+    std::vector<KV> kvs;
+    for (int32_t i = 0; i < 1000; i++) {
+        kvs.emplace_back(folly::stringPrintf("key_%04d", i), std::string(100, 'v'));
+    }
+    auto log = encodeMultiValues(OP_MULTI_PUT, kvs);
+
+    // Not compressed by default
+    ASSERT_EQ(log, compressLog(log));
+
+    FLAGS_wal_compress_threshold = 1024;
+    SCOPE_EXIT {
+        FLAGS_wal_compress_threshold = 0;
+        FLAGS_wal_compression = "lz4";
+    };
+    // The small log is not compressed
+    auto small = encodeSingleValue(OP_REMOVE, "key");
+    ASSERT_EQ(small, compressLog(small));
+
+    for (auto compression : {"lz4", "zstd"}) {
+        FLAGS_wal_compression = compression;
+        auto compressed = compressLog(log);
+        if (compressed == log) {
+            LOG(INFO) << "The compression " << compression << " is not supported";
+            continue;
+        }
+        ASSERT_EQ(OP_COMPRESSED, compressed[sizeof(int64_t)]);
+        ASSERT_LT(compressed.size(), log.size());
+        auto decompressed = decompressLog(compressed);
+        ASSERT_EQ(log, decompressed);
+        auto values = decodeMultiValues(decompressed);
+        ASSERT_EQ(2000, values.size());
+        EXPECT_EQ("key_0999", values[1998]);
+    }
+}
+
 TEST(LogEncoderTest, KVTest) {
     auto encoded = encodeKV("KV_key", "KV_val");
     auto decoded = decodeKV(encoded);
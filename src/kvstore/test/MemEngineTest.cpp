@@ -0,0 +1,185 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include "kvstore/MemEngine.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace kvstore {
+
+TEST(MemEngineTest, SimpleTest) {
+    fs::TempDir rootPath("/tmp/mem_engine_SimpleTest.XXXXXX");
+    auto engine = std::make_unique<MemEngine>(0, rootPath.path());
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->put("key", "val"));
+    std::string val;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->get("key", &val));
+    EXPECT_EQ("val", val);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND, engine->get("not_exist", &val));
+
+    std::vector<std::string> values;
+    auto ret = engine->multiGet({"key", "not_exist"}, &values);
+    ASSERT_EQ(2, ret.size());
+    EXPECT_TRUE(ret[0].ok());
+    EXPECT_EQ("val", values[0]);
+    EXPECT_FALSE(ret[1].ok());
+
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->remove("key"));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND, engine->get("key", &val));
+}
+
+TEST(MemEngineTest, RangeAndPrefixTest) {
+    fs::TempDir rootPath("/tmp/mem_engine_RangeAndPrefixTest.XXXXXX");
+    auto engine = std::make_unique<MemEngine>(0, rootPath.path());
+    std::vector<KV> data;
+    for (int32_t i = 0; i < 10; i++) {
+        data.emplace_back(folly::stringPrintf("a_%d", i), folly::stringPrintf("val_%d", i));
+        data.emplace_back(folly::stringPrintf("b_%d", i), folly::stringPrintf("val_%d", i));
+    }
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+
+    auto check = [] (std::unique_ptr<KVIterator> iter, int32_t from, int32_t to) {
+        for (int32_t i = from; i < to; i++) {
+            ASSERT_TRUE(iter->valid());
+            EXPECT_EQ(folly::stringPrintf("val_%d", i), iter->val());
+            iter->next();
+        }
+        EXPECT_FALSE(iter->valid());
+    };
+    std::unique_ptr<KVIterator> iter;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix("a_", &iter));
+    check(std::move(iter), 0, 10);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->range("b_3", "b_7", &iter));
+    check(std::move(iter), 3, 7);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->rangeWithPrefix("a_5", "a_", &iter));
+    check(std::move(iter), 5, 10);
+    int64_t keys = 0;
+    std::vector<std::string> splits;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              engine->estimateRange("b_3", "b_7", &keys, &splits));
+    EXPECT_EQ(4, keys);
+
+    // the iterator is not affected by the writes after it is created
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix("b_", &iter));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->removeRange("b_", "b_9"));
+    check(std::move(iter), 0, 10);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix("b_", &iter));
+    check(std::move(iter), 9, 10);
+
+    auto batch = engine->startBatchWrite();
+    batch->put("a_10", "val_10");
+    batch->remove("a_0");
+    batch->removeRange("b_", "c_");
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              engine->commitBatchWrite(std::move(batch), false, false, true));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix("a_", &iter));
+    int32_t num = 0;
+    for (; iter->valid(); iter->next()) {
+        num++;
+    }
+    EXPECT_EQ(10, num);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix("b_", &iter));
+    EXPECT_FALSE(iter->valid());
+}
+
+TEST(MemEngineTest, RemovePartDataTest) {
+    fs::TempDir rootPath("/tmp/mem_engine_RemovePartDataTest.XXXXXX");
+    auto engine = std::make_unique<MemEngine>(1, rootPath.path());
+    // part 257 shares the lowest byte of key prefix with part 1, part 256 is ordered before 255
+    std::vector<PartitionID> parts = {1, 2, 255, 256, 257};
+    for (auto partId : parts) {
+        engine->addPart(partId);
+        for (int32_t i = 0; i < 10; i++) {
+            auto vId = folly::to<std::string>(i);
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                      engine->put(NebulaKeyUtils::vertexKey(8, partId, vId, 1), "vertex"));
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                      engine->put(NebulaKeyUtils::edgeKey(8, partId, vId, 1, 0, vId), "edge"));
+        }
+    }
+    auto check = [&] (const std::set<PartitionID>& removed) {
+        for (auto partId : parts) {
+            int32_t expected = removed.count(partId) ? 0 : 10;
+            for (const auto& prefix : {NebulaKeyUtils::vertexPrefix(partId),
+                                       NebulaKeyUtils::edgePrefix(partId)}) {
+                std::unique_ptr<KVIterator> iter;
+                engine->prefix(prefix, &iter);
+                int32_t num = 0;
+                for (; iter->valid(); iter->next()) {
+                    num++;
+                }
+                EXPECT_EQ(expected, num) << partId;
+            }
+        }
+    };
+    engine->removePart(1);
+    check({1});
+    engine->removePart(255);
+    check({1, 255});
+    EXPECT_EQ(3, engine->totalPartsNum());
+}
+
+TEST(MemEngineTest, PartAndReloadTest) {
+    fs::TempDir rootPath("/tmp/mem_engine_PartAndReloadTest.XXXXXX");
+    auto vertexKey = [] (PartitionID partId, int32_t i) {
+        return NebulaKeyUtils::vertexKey(8, partId, folly::to<std::string>(i), 1);
+    };
+    {
+        auto engine = std::make_unique<MemEngine>(1, rootPath.path());
+        engine->addPart(1);
+        engine->addPart(2);
+        EXPECT_EQ(2, engine->totalPartsNum());
+        for (PartitionID partId = 1; partId <= 2; partId++) {
+            for (int32_t i = 0; i < 10; i++) {
+                EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                          engine->put(vertexKey(partId, i), "vertex"));
+            }
+        }
+        engine->removePart(1);
+        EXPECT_EQ(1, engine->totalPartsNum());
+        std::unique_ptr<KVIterator> iter;
+        engine->prefix(NebulaKeyUtils::vertexPrefix(1), &iter);
+        EXPECT_FALSE(iter->valid());
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->put(vertexKey(2, 10), "vertex"));
+    }
+
+    // the data is dumped when the engine is released, and loaded when opened
+    auto engine = std::make_unique<MemEngine>(1, rootPath.path());
+    auto parts = engine->allParts();
+    ASSERT_EQ(1, parts.size());
+    EXPECT_EQ(2, parts[0]);
+    EXPECT_EQ(1, engine->totalPartsNum());
+    std::unique_ptr<KVIterator> iter;
+    engine->prefix(NebulaKeyUtils::vertexPrefix(2), &iter);
+    int32_t num = 0;
+    for (; iter->valid(); iter->next()) {
+        num++;
+    }
+    EXPECT_EQ(11, num);
+
+    auto ret = engine->backupTable("backup", NebulaKeyUtils::vertexPrefix(2), nullptr);
+    ASSERT_TRUE(ok(ret));
+    auto other = std::make_unique<MemEngine>(2, rootPath.path());
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, other->ingest({value(ret)}));
+    std::string val;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, other->get(vertexKey(2, 10), &val));
+    EXPECT_EQ("vertex", val);
+}
+
+}  // namespace kvstore
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+
+    return RUN_ALL_TESTS();
+}
@@ -15,6 +15,8 @@
 #include "kvstore/PartManager.h"
 #include "kvstore/LogEncoder.h"
 #include "meta/ActiveHostsMan.h"
+#include "utils/NebulaKeyUtils.h"
+#include <rocksdb/db.h>
 
 DECLARE_uint32(raft_heartbeat_interval_secs);
 DECLARE_int32(wal_ttl);
@@ -22,6 +24,8 @@ DECLARE_int64(wal_file_size);
 DECLARE_int32(wal_buffer_size);
 DECLARE_int32(listener_pursue_leader_threshold);
 DECLARE_int32(clean_wal_interval_secs);
+DECLARE_int32(listener_apply_batches);
+DECLARE_string(listener_bootstrap_dir);
 
 using nebula::meta::PartHosts;
 using nebula::meta::ListenerHosts;
@@ -44,13 +48,20 @@ public:
     }
 
     std::vector<KV> data() {
+        std::lock_guard<std::mutex> g(lock_);
         return data_;
     }
 
     void clearData() {
+        std::lock_guard<std::mutex> g(lock_);
         data_.clear();
     }
 
+    std::vector<std::string> removed() {
+        std::lock_guard<std::mutex> g(lock_);
+        return removed_;
+    }
+
     std::pair<int64_t, int64_t> commitSnapshot(const std::vector<std::string>& data,
                                                LogID committedLogId,
                                                TermID committedLogTerm,
@@ -79,12 +90,22 @@ protected:
     }
 
     bool apply(const std::vector<KV>& kvs) override {
+        // the batches could be applied at once
+        std::lock_guard<std::mutex> g(lock_);
         for (const auto& kv : kvs) {
             data_.emplace_back(kv);
         }
         return true;
     }
 
+    bool remove(const std::vector<KV>& removes) override {
+        std::lock_guard<std::mutex> g(lock_);
+        for (const auto& kv : removes) {
+            removed_.emplace_back(kv.first);
+        }
+        return true;
+    }
+
     bool persist(LogID, TermID, LogID) override {
         return true;
     }
@@ -98,7 +119,9 @@ protected:
     }
 
 private:
+    std::mutex lock_;
     std::vector<KV> data_;
+    std::vector<std::string> removed_;
     std::pair<int64_t, int64_t> committedSnapshot_{0, 0};
 };
 
@@ -305,6 +328,46 @@ public:
     }
 };
 
+class ListenerBootstrapTest : public ListenerBasicTest {
+public:
+    void SetUp() override {
+        // the checkpoint of part 1 at log 1 of term 1, the first log of the leader elected
+        bootstrapDir_ = std::make_unique<fs::TempDir>("/tmp/listener_bootstrap.XXXXXX");
+        auto path = folly::stringPrintf("%s/1/ckpt", bootstrapDir_->path());
+        CHECK(fs::FileUtils::makeDir(path));
+        rocksdb::Options options;
+        options.create_if_missing = true;
+        rocksdb::DB* db = nullptr;
+        CHECK(rocksdb::DB::Open(options, path, &db).ok());
+        LogID logId = 1;
+        TermID termId = 1;
+        std::string commit;
+        commit.append(reinterpret_cast<const char*>(&logId), sizeof(LogID))
+              .append(reinterpret_cast<const char*>(&termId), sizeof(TermID));
+        CHECK(db->Put(rocksdb::WriteOptions(), NebulaKeyUtils::systemCommitKey(1), commit).ok());
+        for (int32_t i = 0; i < 100; i++) {
+            auto key = NebulaKeyUtils::vertexKey(8, 1, folly::to<std::string>(i), 5);
+            CHECK(db->Put(rocksdb::WriteOptions(), key, folly::stringPrintf("val_%d", i)).ok());
+        }
+        // the keys of the other parts are not applied
+        CHECK(db->Put(rocksdb::WriteOptions(),
+                      NebulaKeyUtils::vertexKey(8, 2, "other", 5), "other").ok());
+        delete db;
+        FLAGS_listener_apply_batches = 4;
+        FLAGS_listener_bootstrap_dir = bootstrapDir_->path();
+        ListenerBasicTest::SetUp();
+    }
+
+    void TearDown() override {
+        ListenerBasicTest::TearDown();
+        FLAGS_listener_bootstrap_dir = "";
+        FLAGS_listener_apply_batches = 1;
+    }
+
+protected:
+    std::unique_ptr<fs::TempDir> bootstrapDir_;
+};
+
 TEST_P(ListenerBasicTest, SimpleTest) {
     LOG(INFO) << "Insert some data";
     for (int32_t partId = 1; partId <= partCount_; partId++) {
@@ -339,6 +402,92 @@ TEST_P(ListenerBasicTest, SimpleTest) {
     }
 }
 
+TEST_P(ListenerBasicTest, RemoveTest) {
+    for (int32_t partId = 1; partId <= partCount_; partId++) {
+        auto leader = findLeader(partId);
+        auto index = findStoreIndex(leader);
+        std::vector<KV> data;
+        std::vector<std::string> keys;
+        for (int32_t i = 0; i < 100; i++) {
+            data.emplace_back(folly::stringPrintf("key_%d_%d", partId, i),
+                              folly::stringPrintf("val_%d_%d", partId, i));
+            if (i % 2 == 0) {
+                keys.emplace_back(folly::stringPrintf("key_%d_%d", partId, i));
+            }
+        }
+        folly::Baton<true, std::atomic> baton;
+        stores_[index]->asyncMultiPut(spaceId_, partId, std::move(data),
+                                      [&baton](cpp2::ErrorCode code) {
+            EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+        baton.reset();
+        stores_[index]->asyncMultiRemove(spaceId_, partId, std::move(keys),
+                                         [&baton](cpp2::ErrorCode code) {
+            EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+        baton.reset();
+        stores_[index]->asyncRemove(spaceId_, partId, folly::stringPrintf("key_%d_1", partId),
+                                    [&baton](cpp2::ErrorCode code) {
+            EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+
+    // wait listener commit
+    sleep(FLAGS_raft_heartbeat_interval_secs + 1);
+
+    for (int32_t partId = 1; partId <= partCount_; partId++) {
+        auto dummy = dummys_[partId];
+        CHECK_EQ(100, dummy->data().size());
+        auto removed = dummy->removed();
+        CHECK_EQ(51, removed.size());
+        for (int32_t i = 0; i < 50; i++) {
+            CHECK_EQ(folly::stringPrintf("key_%d_%d", partId, i * 2), removed[i]);
+        }
+        CHECK_EQ(folly::stringPrintf("key_%d_1", partId), removed[50]);
+    }
+}
+
+TEST_P(ListenerBasicTest, BatchWriteOrderTest) {
+    for (int32_t partId = 1; partId <= partCount_; partId++) {
+        auto leader = findLeader(partId);
+        auto index = findStoreIndex(leader);
+        auto putThenRemove = folly::stringPrintf("put_then_remove_%d", partId);
+        auto removeThenPut = folly::stringPrintf("remove_then_put_%d", partId);
+        std::vector<std::tuple<BatchLogType, std::string, std::string>> batch;
+        batch.emplace_back(BatchLogType::OP_BATCH_PUT, putThenRemove, "val");
+        batch.emplace_back(BatchLogType::OP_BATCH_REMOVE, removeThenPut, "");
+        batch.emplace_back(BatchLogType::OP_BATCH_REMOVE, putThenRemove, "");
+        batch.emplace_back(BatchLogType::OP_BATCH_PUT, removeThenPut, "val");
+        folly::Baton<true, std::atomic> baton;
+        stores_[index]->asyncAppendBatch(spaceId_, partId, encodeBatchValue(batch),
+                                         [&baton](cpp2::ErrorCode code) {
+            EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+
+    // wait listener commit
+    sleep(FLAGS_raft_heartbeat_interval_secs + 1);
+
+    for (int32_t partId = 1; partId <= partCount_; partId++) {
+        // only the last change of each key in the log is applied
+        auto dummy = dummys_[partId];
+        auto data = dummy->data();
+        ASSERT_EQ(1, data.size());
+        EXPECT_EQ(folly::stringPrintf("remove_then_put_%d", partId), data[0].first);
+        auto removed = dummy->removed();
+        ASSERT_EQ(1, removed.size());
+        EXPECT_EQ(folly::stringPrintf("put_then_remove_%d", partId), removed[0]);
+    }
+}
+
 TEST_P(ListenerBasicTest, TransLeaderTest) {
     LOG(INFO) << "Insert some data";
     for (int32_t partId = 1; partId <= partCount_; partId++) {
@@ -499,6 +648,68 @@ TEST_P(ListenerBasicTest, ListenerResetByWalTest) {
     }
 }
 
+TEST_P(ListenerBasicTest, ApplyBatchesTest) {
+    FLAGS_listener_apply_batches = 4;
+    for (int32_t partId = 1; partId <= partCount_; partId++) {
+        std::vector<KV> data;
+        for (int32_t i = 0; i < 10000; i++) {
+            data.emplace_back(folly::stringPrintf("key_%d_%d", partId, i),
+                              folly::stringPrintf("val_%d_%d", partId, i));
+        }
+        auto leader = findLeader(partId);
+        auto index = findStoreIndex(leader);
+        folly::Baton<true, std::atomic> baton;
+        stores_[index]->asyncMultiPut(spaceId_, partId, std::move(data),
+                                      [&baton](cpp2::ErrorCode code) {
+            EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+
+    // wait listener commit
+    sleep(FLAGS_raft_heartbeat_interval_secs + 1);
+
+    for (int32_t partId = 1; partId <= partCount_; partId++) {
+        // the batches are applied in any order, each key is applied once
+        std::map<std::string, std::string> applied;
+        for (auto& kv : dummys_[partId]->data()) {
+            EXPECT_TRUE(applied.emplace(kv.first, kv.second).second);
+        }
+        CHECK_EQ(10000, applied.size());
+        for (int32_t i = 0; i < 10000; i++) {
+            CHECK_EQ(folly::stringPrintf("val_%d_%d", partId, i),
+                     applied[folly::stringPrintf("key_%d_%d", partId, i)]);
+        }
+    }
+    FLAGS_listener_apply_batches = 1;
+}
+
+TEST_P(ListenerBootstrapTest, BootstrapTest) {
+    auto dummy = dummys_[1];
+    CHECK_EQ(100, dummy->data().size());
+    CHECK_EQ(1, dummy->getApplyId());
+
+    // the logs after the checkpoint are applied
+    std::vector<KV> data;
+    for (int32_t i = 0; i < 10; i++) {
+        data.emplace_back(folly::stringPrintf("key_%d", i), folly::stringPrintf("val_%d", i));
+    }
+    auto leader = findLeader(1);
+    auto index = findStoreIndex(leader);
+    folly::Baton<true, std::atomic> baton;
+    stores_[index]->asyncMultiPut(spaceId_, 1, std::move(data),
+                                  [&baton](cpp2::ErrorCode code) {
+        EXPECT_EQ(cpp2::ErrorCode::SUCCEEDED, code);
+        baton.post();
+    });
+    baton.wait();
+
+    // wait listener commit
+    sleep(FLAGS_raft_heartbeat_interval_secs + 1);
+    CHECK_EQ(110, dummy->data().size());
+}
+
 TEST_P(ListenerAdvanceTest, ListenerResetBySnapshotTest) {
     for (int32_t partId = 1; partId <= partCount_; partId++) {
         std::vector<KV> data;
@@ -571,6 +782,11 @@ INSTANTIATE_TEST_CASE_P(
     ListenerBasicTest,
     ::testing::Values(std::make_tuple(1, 1, 1)));
 
+INSTANTIATE_TEST_CASE_P(
+    PartCount_Replicas_ListenerCount,
+    ListenerBootstrapTest,
+    ::testing::Values(std::make_tuple(1, 1, 1)));
+
 INSTANTIATE_TEST_CASE_P(
     PartCount_Replicas_ListenerCount,
     ListenerAdvanceTest,
@@ -22,6 +22,8 @@
 
 DECLARE_uint32(raft_heartbeat_interval_secs);
 DECLARE_bool(auto_remove_invalid_space);
+DECLARE_string(raft_witness_hosts);
+DECLARE_bool(async_remove_part);
 const int32_t kDefaultVidLen = 8;
 using nebula::meta::PartHosts;
 
@@ -136,6 +138,33 @@ TEST(NebulaStoreTest, SimpleTest) {
         num++;
     }
     EXPECT_EQ(100, num);
+
+    VLOG(1) << "Read them through the part handle...";
+    {
+        auto ret = store->partHandle(1, 6);
+        ASSERT_FALSE(ok(ret));
+        EXPECT_EQ(nebula::cpp2::ErrorCode::E_PART_NOT_FOUND, error(ret));
+    }
+    {
+        auto ret = store->partHandle(1, 1);
+        ASSERT_TRUE(ok(ret));
+        auto handle = std::move(value(ret));
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, handle->prefix(prefix, &iter));
+        num = 0;
+        for (; iter->valid(); iter->next()) {
+            num++;
+        }
+        EXPECT_EQ(100, num);
+
+        std::vector<std::string> keys = {s, e};
+        std::vector<std::string> values;
+        auto result = handle->multiGet(keys, &values);
+        EXPECT_EQ(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, result.first);
+        ASSERT_EQ(2, result.second.size());
+        EXPECT_TRUE(result.second[0].ok());
+        EXPECT_EQ("val_0", values[0]);
+        EXPECT_TRUE(result.second[1].isKeyNotFound());
+    }
 }
 
 TEST(NebulaStoreTest, PartsTest) {
@@ -391,6 +420,89 @@ TEST(NebulaStoreTest, ThreeCopiesTest) {
     }
 }
 
+TEST(NebulaStoreTest, WitnessTest) {
+    fs::TempDir rootPath("/tmp/nebula_store_witness_test.XXXXXX");
+    int32_t replicas = 3;
+    std::string ip("127.0.0.1");
+    std::vector<HostAddr> peers;
+    for (int32_t i = 0; i < replicas; i++) {
+        peers.emplace_back(ip, network::NetworkUtils::getAvailablePort());
+    }
+    // the last replica of each part is a witness
+    FLAGS_raft_witness_hosts = folly::stringPrintf("%s:%d", ip.c_str(), peers[2].port);
+
+    std::vector<std::unique_ptr<NebulaStore>> stores;
+    for (int32_t i = 0; i < replicas; i++) {
+        auto partMan = std::make_unique<MemPartManager>();
+        for (auto partId = 0; partId < 3; partId++) {
+            PartHosts pm;
+            pm.spaceId_ = 0;
+            pm.partId_ = partId;
+            pm.hosts_ = peers;
+            partMan->partsMap_[0][partId] = std::move(pm);
+        }
+        KVOptions options;
+        options.dataPaths_ = {folly::stringPrintf("%s/disk%d", rootPath.path(), i)};
+        options.partMan_ = std::move(partMan);
+        stores.emplace_back(std::make_unique<NebulaStore>(
+            std::move(options), std::make_shared<folly::IOThreadPoolExecutor>(4), peers[i],
+            getHandlers()));
+        ASSERT_TRUE(stores.back()->init());
+    }
+    LOG(INFO) << "Waiting for all leaders elected!";
+    while (true) {
+        int32_t leaderCount = 0;
+        for (int32_t i = 0; i < replicas; i++) {
+            nebula::meta::ActiveHostsMan::AllLeaders leaderIds;
+            leaderCount += stores[i]->allLeader(leaderIds);
+        }
+        if (leaderCount == 3) {
+            break;
+        }
+        usleep(100000);
+    }
+
+    for (int32_t part = 0; part < 3; part++) {
+        int32_t index = stores[0]->isLeader(0, part) ? 0 : 1;
+        ASSERT_TRUE(stores[index]->isLeader(0, part));
+        EXPECT_FALSE(stores[2]->isLeader(0, part));
+        folly::Baton<true, std::atomic> baton;
+        stores[index]->asyncMultiPut(0, part, {{"key", "val"}},
+                                     [&baton](nebula::cpp2::ErrorCode code) {
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+    sleep(FLAGS_raft_heartbeat_interval_secs);
+
+    for (int32_t part = 0; part < 3; part++) {
+        // the witness has got the logs, but keeps no data
+        for (int32_t i = 0; i < replicas; i++) {
+            auto ret = stores[i]->part(0, part);
+            ASSERT_TRUE(ok(ret));
+            auto p = value(ret);
+            EXPECT_EQ(i == 2, p->isWitness());
+            EXPECT_LT(0, p->wal()->lastLogId());
+            auto engineRet = stores[i]->engine(0, part);
+            ASSERT_TRUE(ok(engineRet));
+            std::string val;
+            auto code = value(engineRet)->get("key", &val);
+            if (i == 2) {
+                EXPECT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND, code);
+            } else {
+                EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+                EXPECT_EQ("val", val);
+            }
+        }
+        // nor serves the reads
+        std::string val;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::E_LEADER_CHANGED,
+                  stores[2]->get(0, part, "key", &val, true));
+    }
+    FLAGS_raft_witness_hosts = "";
+}
+
 TEST(NebulaStoreTest, TransLeaderTest) {
     fs::TempDir rootPath("/tmp/trans_leader_test.XXXXXX");
     auto initNebulaStore = [](const std::vector<HostAddr>& peers,
@@ -953,6 +1065,93 @@ TEST(NebulaStoreTest, RemoveInvalidSpaceTest) {
     CHECK(boost::filesystem::exists(space2));
 }
 
+TEST(NebulaStoreTest, AsyncRemoveSpaceTest) {
+    auto partMan = std::make_unique<MemPartManager>();
+    auto ioThreadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+    for (auto partId = 1; partId <= 6; partId++) {
+        partMan->partsMap_[1][partId] = PartHosts();
+    }
+
+    fs::TempDir disk1("/tmp/nebula_store_test.XXXXXX");
+    KVOptions options;
+    options.dataPaths_ = {disk1.path()};
+    options.partMan_ = std::move(partMan);
+    HostAddr local = {"", 0};
+    auto store = std::make_unique<NebulaStore>(std::move(options),
+                                               ioThreadPool,
+                                               local,
+                                               getHandlers());
+    store->init();
+    sleep(1);
+    ASSERT_EQ(1, store->spaces_.size());
+    auto space1 = folly::stringPrintf("%s/nebula/%d", disk1.path(), 1);
+    CHECK(boost::filesystem::exists(space1));
+
+    FLAGS_async_remove_part = true;
+    FLAGS_auto_remove_invalid_space = true;
+    SCOPE_EXIT {
+        FLAGS_async_remove_part = false;
+        FLAGS_auto_remove_invalid_space = false;
+    };
+    // the parts and the space are detached at once, and removed in the background
+    for (auto partId = 1; partId <= 6; partId++) {
+        store->removePart(1, partId);
+        EXPECT_FALSE(ok(store->part(1, partId)));
+    }
+    store->removeSpace(1, false);
+    EXPECT_EQ(0, store->spaces_.size());
+    store->waitUntilRemoved(1);
+    CHECK(!boost::filesystem::exists(space1));
+
+    // the space could be added again once removed
+    store->addSpace(1);
+    store->addPart(1, 1, false, {});
+    EXPECT_TRUE(ok(store->part(1, 1)));
+}
+
+TEST(NebulaStoreTest, RemoveColdSpaceDirTest) {
+    auto partMan = std::make_unique<MemPartManager>();
+    auto ioThreadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+    for (auto partId = 1; partId <= 6; partId++) {
+        partMan->partsMap_[1][partId] = PartHosts();
+    }
+
+    fs::TempDir disk1("/tmp/nebula_store_test.XXXXXX");
+    fs::TempDir cold1("/tmp/nebula_store_test_cold.XXXXXX");
+    FLAGS_rocksdb_cold_data_paths = folly::stringPrintf("%s=%s", disk1.path(), cold1.path());
+    FLAGS_rocksdb_hot_data_target_size_gb = 1;
+    FLAGS_auto_remove_invalid_space = true;
+    SCOPE_EXIT {
+        FLAGS_rocksdb_cold_data_paths = "";
+        FLAGS_rocksdb_hot_data_target_size_gb = 0;
+        FLAGS_auto_remove_invalid_space = false;
+    };
+    KVOptions options;
+    options.dataPaths_ = {disk1.path()};
+    options.partMan_ = std::move(partMan);
+    HostAddr local = {"", 0};
+    auto store = std::make_unique<NebulaStore>(std::move(options),
+                                               ioThreadPool,
+                                               local,
+                                               getHandlers());
+    store->init();
+    sleep(1);
+    ASSERT_EQ(1, store->spaces_.size());
+    auto space1 = folly::stringPrintf("%s/nebula/%d", disk1.path(), 1);
+    auto coldSpace1 = folly::stringPrintf("%s/nebula/%d", cold1.path(), 1);
+    CHECK(boost::filesystem::exists(space1));
+    CHECK(boost::filesystem::exists(coldSpace1));
+
+    // the cold dir of the space is removed along with the hot one
+    for (auto partId = 1; partId <= 6; partId++) {
+        store->removePart(1, partId);
+    }
+    store->removeSpace(1, false);
+    EXPECT_EQ(0, store->spaces_.size());
+    CHECK(!boost::filesystem::exists(space1));
+    CHECK(!boost::filesystem::exists(coldSpace1));
+}
+
 TEST(NebulaStoreTest, BackupRestoreTest) {
     GraphSpaceID spaceId = 1;
     PartitionID partId = 1;
@@ -0,0 +1,119 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include "kvstore/PartSplit.h"
+#include "kvstore/MemEngine.h"
+#include "kvstore/LogEncoder.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace kvstore {
+
+namespace {
+
+std::string intVid(int64_t vid) {
+    return std::string(reinterpret_cast<const char*>(&vid), sizeof(int64_t));
+}
+
+PartSplit intSplit(int32_t parts) {
+    PartSplit split;
+    split.parts = parts;
+    split.intId = true;
+    split.vidLen = sizeof(int64_t);
+    return split;
+}
+
+size_t countPrefix(KVEngine* engine, const std::string& prefix) {
+    std::unique_ptr<KVIterator> iter;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix(prefix, &iter));
+    size_t count = 0;
+    for (; iter->valid(); iter->next()) {
+        count++;
+    }
+    return count;
+}
+
+}  // namespace
+
+TEST(PartSplitTest, EncodeTest) {
+    auto split = intSplit(10);
+    split.edgeIndexes = {3, 7};
+    split.status = PartSplit::Status::COPIED;
+    PartSplit decoded;
+    ASSERT_TRUE(PartSplit::decode(split.encode(), &decoded));
+    EXPECT_EQ(10, decoded.parts);
+    EXPECT_TRUE(decoded.intId);
+    EXPECT_EQ(sizeof(int64_t), decoded.vidLen);
+    EXPECT_EQ(split.edgeIndexes, decoded.edgeIndexes);
+    EXPECT_EQ(PartSplit::Status::COPIED, decoded.status);
+
+    EXPECT_FALSE(PartSplit::decode("", &decoded));
+    EXPECT_FALSE(PartSplit::decode(split.encode().substr(1), &decoded));
+}
+
+TEST(PartSplitTest, MovedTest) {
+    // with 2 parts, part 1 has the even vids, and the vids of 4k + 2 move to part 3
+    auto split = intSplit(2);
+    for (int64_t vid = 0; vid < 20; vid += 2) {
+        auto moved = vid % 4 == 2;
+        EXPECT_EQ(moved ? 3 : 1, split.partOf(intVid(vid)));
+        EXPECT_EQ(moved, split.moved(1, NebulaKeyUtils::vertexKey(8, 1, intVid(vid), 1)));
+        EXPECT_EQ(moved,
+                  split.moved(1, NebulaKeyUtils::edgeKey(8, 1, intVid(vid), 1, 0, intVid(1))));
+    }
+    EXPECT_FALSE(split.moved(1, NebulaKeyUtils::systemCommitKey(1)));
+
+    std::vector<KV> data = {{NebulaKeyUtils::vertexKey(8, 1, intVid(4), 1), "v"}};
+    EXPECT_FALSE(split.movedLog(1, encodeMultiValues(OP_MULTI_PUT, data)));
+    data.emplace_back(NebulaKeyUtils::vertexKey(8, 1, intVid(6), 1), "v");
+    EXPECT_TRUE(split.movedLog(1, encodeMultiValues(OP_MULTI_PUT, data)));
+    EXPECT_TRUE(split.movedLog(1, encodeSingleValue(OP_REMOVE, data.back().first)));
+}
+
+TEST(PartSplitTest, CopyAndCleanupTest) {
+    fs::TempDir rootPath("/tmp/part_split_CopyAndCleanupTest.XXXXXX");
+    auto from = std::make_unique<MemEngine>(0, rootPath.path());
+    auto to = std::make_unique<MemEngine>(0, rootPath.path());
+    std::vector<KV> data;
+    for (int64_t vid = 0; vid < 100; vid += 2) {
+        data.emplace_back(NebulaKeyUtils::vertexKey(8, 1, intVid(vid), 1), "v");
+        data.emplace_back(NebulaKeyUtils::edgeKey(8, 1, intVid(vid), 1, 0, intVid(1)), "e");
+    }
+    data.emplace_back(NebulaKeyUtils::systemCommitKey(1), "commit");
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, from->multiPut(data));
+
+    auto split = intSplit(2);
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              PartSplitter::copy(from.get(), to.get(), 1, split));
+    EXPECT_EQ(25, countPrefix(to.get(), NebulaKeyUtils::vertexPrefix(3)));
+    EXPECT_EQ(25, countPrefix(to.get(), NebulaKeyUtils::edgePrefix(3)));
+    EXPECT_EQ(0, countPrefix(to.get(), NebulaKeyUtils::vertexPrefix(1)));
+    std::string val;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              to->get(NebulaKeyUtils::vertexKey(8, 3, intVid(2), 1), &val));
+    EXPECT_EQ("v", val);
+
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, PartSplitter::cleanup(from.get(), 1, split));
+    EXPECT_EQ(25, countPrefix(from.get(), NebulaKeyUtils::vertexPrefix(1)));
+    EXPECT_EQ(25, countPrefix(from.get(), NebulaKeyUtils::edgePrefix(1)));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              from->get(NebulaKeyUtils::systemCommitKey(1), &val));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND,
+              from->get(NebulaKeyUtils::vertexKey(8, 1, intVid(2), 1), &val));
+}
+
+}  // namespace kvstore
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
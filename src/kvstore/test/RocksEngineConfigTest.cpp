@@ -165,6 +165,103 @@ TEST(RocksEngineConfigTest, CompressionConfigTest) {
     }
 }
 
+TEST(RocksEngineConfigTest, CompressionDictConfigTest) {
+    FLAGS_rocksdb_compression = "zstd";
+    FLAGS_rocksdb_compression_per_level = "";
+    FLAGS_rocksdb_compression_dict_bytes = 16;
+    FLAGS_rocksdb_compression_dict_train_bytes = 1024;
+    SCOPE_EXIT {
+        FLAGS_rocksdb_compression = "snappy";
+        FLAGS_rocksdb_compression_dict_bytes = 0;
+        FLAGS_rocksdb_compression_dict_train_bytes = 0;
+    };
+    rocksdb::Options options;
+    auto status = initRocksdbOptions(options, 1);
+    ASSERT_TRUE(status.ok()) << status.ToString();
+    ASSERT_EQ(rocksdb::kZSTD, options.compression);
+    ASSERT_EQ(16 * 1024, options.compression_opts.max_dict_bytes);
+    ASSERT_EQ(1024 * 1024, options.compression_opts.zstd_max_train_bytes);
+
+    rocksdb::DB* db = nullptr;
+    SCOPE_EXIT { delete db; };
+    options.create_if_missing = true;
+    fs::TempDir rootPath("/tmp/RocksDBCompressionDictConfigTest.XXXXXX");
+    status = rocksdb::DB::Open(options, rootPath.path(), &db);
+    ASSERT_TRUE(status.ok()) << status.ToString();
+
+    // rows with the same low cardinality strings, flushed into a dictionary compressed SST
+    rocksdb::WriteOptions wOpts;
+    for (int i = 0; i < 1000; i++) {
+        auto value = folly::stringPrintf("%d:America:active:forward", i);
+        status = db->Put(wOpts, folly::stringPrintf("key_%04d", i), value);
+        ASSERT_TRUE(status.ok()) << status.ToString();
+    }
+    status = db->Flush(rocksdb::FlushOptions());
+    ASSERT_TRUE(status.ok()) << status.ToString();
+    std::string value;
+    status = db->Get(rocksdb::ReadOptions(), "key_0500", &value);
+    ASSERT_TRUE(status.ok()) << status.ToString();
+    ASSERT_EQ("500:America:active:forward", value);
+}
+
+TEST(RocksEngineConfigTest, ColdDataPathTest) {
+    fs::TempDir hotPath("/tmp/RocksDBColdDataPathTest_hot.XXXXXX");
+    fs::TempDir coldPath("/tmp/RocksDBColdDataPathTest_cold.XXXXXX");
+    FLAGS_rocksdb_cold_data_paths = folly::stringPrintf("/not_this_path=/tmp, %s=%s",
+                                                        hotPath.path(), coldPath.path());
+    FLAGS_rocksdb_hot_data_target_size_gb = 1;
+    SCOPE_EXIT {
+        FLAGS_rocksdb_cold_data_paths = "";
+        FLAGS_rocksdb_hot_data_target_size_gb = 0;
+    };
+    {
+        rocksdb::Options options;
+        auto status = initRocksdbDbPaths(options, hotPath.path(), 1);
+        ASSERT_TRUE(status.ok()) << status.ToString();
+        ASSERT_EQ(2, options.db_paths.size());
+        ASSERT_EQ(KV_DATA_PATH_FORMAT(hotPath.path(), 1), options.db_paths[0].path);
+        ASSERT_EQ(1UL << 30, options.db_paths[0].target_size);
+        ASSERT_EQ(KV_DATA_PATH_FORMAT(coldPath.path(), 1), options.db_paths[1].path);
+        ASSERT_TRUE(fs::FileUtils::exist(KV_DATA_PATH_FORMAT(coldPath.path(), 1)));
+    }
+    {
+        // no cold path for the other data path
+        rocksdb::Options options;
+        auto status = initRocksdbDbPaths(options, coldPath.path(), 1);
+        ASSERT_TRUE(status.ok()) << status.ToString();
+        ASSERT_TRUE(options.db_paths.empty());
+    }
+    {
+        auto engine = std::make_unique<RocksEngine>(1, 8, hotPath.path());
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->put("key", "val"));
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+        std::string val;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->get("key", &val));
+        EXPECT_EQ("val", val);
+    }
+}
+
+TEST(RocksEngineConfigTest, SpaceBlockCacheTest) {
+    FLAGS_rocksdb_space_block_cache = "2:16, 3:32, illegal";
+    SCOPE_EXIT {
+        FLAGS_rocksdb_space_block_cache = "";
+    };
+    auto shared = getBlockCache(1);
+    ASSERT_NE(nullptr, shared);
+    ASSERT_EQ(shared, getBlockCache(4));
+    auto cache2 = getBlockCache(2);
+    ASSERT_NE(shared, cache2);
+    ASSERT_EQ(16 * 1024 * 1024, cache2->GetCapacity());
+    ASSERT_EQ(cache2, getBlockCache(2));
+    auto cache3 = getBlockCache(3);
+    ASSERT_NE(cache2, cache3);
+    ASSERT_EQ(32 * 1024 * 1024, cache3->GetCapacity());
+
+    rocksdb::Options options;
+    auto status = initRocksdbOptions(options, 2);
+    ASSERT_TRUE(status.ok()) << status.ToString();
+}
+
 }  // namespace kvstore
 }  // namespace nebula
 
@@ -5,15 +5,22 @@
  */
 
 #include "common/base/Base.h"
+#include "common/fs/FileUtils.h"
 #include "common/fs/TempDir.h"
 #include <gtest/gtest.h>
+#include <fstream>
 #include <rocksdb/db.h>
 #include <rocksdb/table.h>
 #include <folly/lang/Bits.h>
+#include "kvstore/EngineEventStats.h"
 #include "kvstore/RocksEngine.h"
 #include "kvstore/RocksEngineConfig.h"
+#include "utils/IndexKeyUtils.h"
 #include "utils/NebulaKeyUtils.h"
 
+DECLARE_int32(ingest_prepare_threads);
+DECLARE_int32(ingest_flush_retry_times);
+
 namespace nebula {
 namespace kvstore {
 
@@ -117,6 +124,167 @@ TEST(RocksEngineTest, PrefixTest) {
     checkPrefix("c", 20, 20);
 }
 
+TEST(RocksEngineTest, ReusablePrefixTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_ReusablePrefixTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
+    std::vector<KV> data;
+    for (int32_t i = 0; i < 10;  i++) {
+        data.emplace_back(folly::stringPrintf("a_%d", i), folly::stringPrintf("val_%d", i));
+    }
+    for (int32_t i = 10; i < 15;  i++) {
+        data.emplace_back(folly::stringPrintf("b_%d", i), folly::stringPrintf("val_%d", i));
+    }
+    for (int32_t i = 20; i < 40;  i++) {
+        data.emplace_back(folly::stringPrintf("c_%d", i), folly::stringPrintf("val_%d", i));
+    }
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+
+    auto count = [] (KVIterator* iter, const std::string& prefix) {
+        int32_t num = 0;
+        while (iter->valid()) {
+            EXPECT_TRUE(iter->key().startsWith(prefix));
+            num++;
+            iter->next();
+        }
+        return num;
+    };
+
+    std::unique_ptr<KVIterator> iter;
+    ASSERT_TRUE(engine->reusablePrefix("a", &iter));
+    EXPECT_EQ(10, count(iter.get(), "a"));
+    // seek forward and backward with the same iterator
+    ASSERT_TRUE(iter->seek("c"));
+    EXPECT_EQ(20, count(iter.get(), "c"));
+    ASSERT_TRUE(iter->seek("b"));
+    EXPECT_EQ(5, count(iter.get(), "b"));
+    ASSERT_TRUE(iter->seek("d"));
+    EXPECT_EQ(0, count(iter.get(), "d"));
+
+    // no upper bound of the prefix
+    std::unique_ptr<KVIterator> none;
+    EXPECT_FALSE(engine->reusablePrefix("", &none));
+    EXPECT_FALSE(engine->reusablePrefix("\xFF", &none));
+    EXPECT_EQ(nullptr, none);
+    EXPECT_FALSE(iter->seek("\xFF"));
+}
+
+
+TEST(RocksEngineTest, ScanHintTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_ScanHintTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
+    // the prefix ends with 0xFF, whose upper bound is the successor of "a"
+    std::string prefix = "a\xFF";
+    std::vector<KV> data;
+    data.emplace_back("a", "val");
+    data.emplace_back(prefix, "val");
+    data.emplace_back(prefix + "\xFF", "val");
+    data.emplace_back(prefix + "c", "val");
+    data.emplace_back("b", "val");
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+
+    for (auto hint : {ScanHint::kDefault, ScanHint::kFullScan}) {
+        std::unique_ptr<KVIterator> iter;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix(prefix, &iter, hint));
+        int32_t num = 0;
+        for (; iter->valid(); iter->next()) {
+            EXPECT_TRUE(iter->key().startsWith(prefix));
+            num++;
+        }
+        EXPECT_EQ(3, num);
+
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->range("a", "b", &iter, hint));
+        num = 0;
+        for (; iter->valid(); iter->next()) {
+            num++;
+        }
+        EXPECT_EQ(4, num);
+    }
+}
+
+TEST(RocksEngineTest, PrefixBloomFilterTest) {
+    FLAGS_enable_rocksdb_prefix_filtering = true;
+    FLAGS_rocksdb_index_prefix_bloom_filter_length = sizeof(int64_t);
+    fs::TempDir rootPath("/tmp/rocksdb_engine_PrefixBloomFilterTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
+    PartitionID partId = 1;
+    IndexID indexId = 1;
+
+    std::vector<KV> data;
+    for (int64_t value = 0; value < 10; value++) {
+        for (int32_t i = 0; i < 5; i++) {
+            auto vId = folly::stringPrintf("%ld_%d", value, i);
+            auto indexValue = IndexKeyUtils::encodeValue(Value(value));
+            data.emplace_back(
+                IndexKeyUtils::vertexIndexKey(kDefaultVIdLen, partId, indexId, vId,
+                                              std::move(indexValue)),
+                "");
+            data.emplace_back(NebulaKeyUtils::vertexKey(kDefaultVIdLen, partId, vId, 1),
+                              folly::stringPrintf("val_%ld_%d", value, i));
+        }
+    }
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+
+    auto count = [&] (const std::string& prefix) {
+        std::unique_ptr<KVIterator> iter;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix(prefix, &iter));
+        int32_t num = 0;
+        for (; iter->valid(); iter->next()) {
+            EXPECT_TRUE(iter->key().startsWith(prefix));
+            num++;
+        }
+        return num;
+    };
+    auto indexPrefix = IndexKeyUtils::indexPrefix(partId, indexId);
+    // equality probe on the index value, which is in domain of the prefix extractor
+    for (int64_t value = 0; value < 10; value++) {
+        EXPECT_EQ(5, count(indexPrefix + IndexKeyUtils::encodeValue(Value(value))));
+    }
+    EXPECT_EQ(0, count(indexPrefix + IndexKeyUtils::encodeValue(Value(100L))));
+    // the prefix shorter than prefix extractor is scanned in total order
+    EXPECT_EQ(50, count(indexPrefix));
+    // all values share the high 4 bytes
+    EXPECT_EQ(50, count(indexPrefix + IndexKeyUtils::encodeValue(Value(3L)).substr(0, 4)));
+    EXPECT_EQ(1, count(NebulaKeyUtils::vertexPrefix(kDefaultVIdLen, partId, "3_1")));
+    EXPECT_EQ(50, count(NebulaKeyUtils::vertexPrefix(partId)));
+
+    FLAGS_enable_rocksdb_prefix_filtering = false;
+    FLAGS_rocksdb_index_prefix_bloom_filter_length = 0;
+}
+
+TEST(RocksEngineTest, SnapshotTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_SnapshotTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
+    std::vector<KV> data;
+    for (int32_t i = 0; i < 10;  i++) {
+        data.emplace_back(folly::stringPrintf("a_%d", i),
+                          folly::stringPrintf("val_%d", i));
+    }
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+
+    auto count = [&] (const std::string& start, const void* snapshot) {
+        std::unique_ptr<KVIterator> iter;
+        std::string prefix = "a";
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  engine->rangeWithPrefix(start, prefix, &iter, snapshot));
+        int32_t num = 0;
+        for (; iter->valid(); iter->next()) {
+            num++;
+        }
+        return num;
+    };
+
+    const void* snapshot = engine->getSnapshot();
+    ASSERT_NE(nullptr, snapshot);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->remove("a_5"));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->remove("a_6"));
+    EXPECT_EQ(10, count("a", snapshot));
+    EXPECT_EQ(5, count("a_5", snapshot));
+    EXPECT_EQ(8, count("a", nullptr));
+    EXPECT_EQ(3, count("a_5", nullptr));
+    engine->releaseSnapshot(snapshot);
+}
 
 TEST(RocksEngineTest, RemoveTest) {
     fs::TempDir rootPath("/tmp/rocksdb_engine_RemoveTest.XXXXXX");
@@ -171,6 +339,93 @@ TEST(RocksEngineTest, RemoveRangeTest) {
 }
 
 
+TEST(RocksEngineTest, RemovePartDataTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_RemovePartDataTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
+    // the key prefixes are little endian, part 257 shares the lowest byte with part 1, and the
+    // prefix of part 256 is ordered before the one of part 255
+    std::vector<PartitionID> parts = {1, 2, 255, 256, 257};
+    for (auto partId : parts) {
+        engine->addPart(partId);
+    }
+    for (auto partId : parts) {
+        std::vector<KV> data;
+        for (int32_t i = 0; i < 10; i++) {
+            auto vId = folly::to<std::string>(i);
+            data.emplace_back(NebulaKeyUtils::vertexKey(kDefaultVIdLen, partId, vId, 1), "");
+            data.emplace_back(NebulaKeyUtils::edgeKey(kDefaultVIdLen, partId, vId, 1, 0, vId),
+                              "");
+            data.emplace_back(IndexKeyUtils::vertexIndexKey(kDefaultVIdLen, partId, 1, vId, ""),
+                              "");
+        }
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+        // so that some of the data are in SST files
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+    }
+
+    auto count = [&] (const std::string& prefix) {
+        std::unique_ptr<KVIterator> iter;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix(prefix, &iter));
+        int32_t num = 0;
+        for (; iter->valid(); iter->next()) {
+            num++;
+        }
+        return num;
+    };
+    auto check = [&] (const std::set<PartitionID>& removed) {
+        for (auto partId : parts) {
+            int32_t expected = removed.count(partId) ? 0 : 10;
+            EXPECT_EQ(expected, count(NebulaKeyUtils::vertexPrefix(partId))) << partId;
+            EXPECT_EQ(expected, count(NebulaKeyUtils::edgePrefix(partId))) << partId;
+            EXPECT_EQ(expected, count(IndexKeyUtils::indexPrefix(partId))) << partId;
+        }
+    };
+    // the encoding of the index keys is recorded on adding the part, and removed with it
+    std::string encoding;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              engine->get(NebulaKeyUtils::systemIndexEncodingKey(1), &encoding));
+    EXPECT_EQ(IndexKeyUtils::indexEncoding(), encoding);
+
+    engine->removePart(1);
+    EXPECT_EQ(4, engine->allParts().size());
+    check({1});
+    EXPECT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND,
+              engine->get(NebulaKeyUtils::systemIndexEncodingKey(1), &encoding));
+    engine->removePart(255);
+    EXPECT_EQ(3, engine->allParts().size());
+    check({1, 255});
+}
+
+TEST(RocksEngineTest, GroupWalSyncTest) {
+    FLAGS_rocksdb_group_wal_sync = true;
+    SCOPE_EXIT {
+        FLAGS_rocksdb_group_wal_sync = false;
+    };
+    fs::TempDir rootPath("/tmp/rocksdb_engine_GroupWalSyncTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
+    std::vector<std::thread> threads;
+    for (int32_t t = 0; t < 8; t++) {
+        threads.emplace_back([&engine, t] () {
+            for (int32_t i = 0; i < 100; i++) {
+                auto batch = engine->startBatchWrite();
+                batch->put(folly::stringPrintf("key_%d_%d", t, i), "val");
+                EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                          engine->commitBatchWrite(std::move(batch), false, true, true));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+    std::unique_ptr<KVIterator> iter;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix("key_", &iter));
+    int32_t num = 0;
+    for (; iter->valid(); iter->next()) {
+        num++;
+    }
+    EXPECT_EQ(800, num);
+}
+
 TEST(RocksEngineTest, OptionTest) {
     fs::TempDir rootPath("/tmp/rocksdb_engine_OptionTest.XXXXXX");
     auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
@@ -203,6 +458,206 @@ TEST(RocksEngineTest, CompactTest) {
     EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->compact());
 }
 
+// Keys starting with "expired" are expired, they are removed only if the filter is enabled
+class ExpiredFilter final : public KVFilter {
+public:
+    bool filter(GraphSpaceID,
+                const folly::StringPiece& key,
+                const folly::StringPiece&) const override {
+        return enabled_ && key.startsWith("expired");
+    }
+
+    bool schemaOf(GraphSpaceID,
+                  const folly::StringPiece& key,
+                  const folly::StringPiece&,
+                  int64_t* schemaId,
+                  int64_t* expireTime) const override {
+        *schemaId = 1;
+        if (key.startsWith("expired")) {
+            *expireTime = 0;
+        }
+        return true;
+    }
+
+    static std::atomic<bool> enabled_;
+};
+
+std::atomic<bool> ExpiredFilter::enabled_{false};
+
+class ExpiredFilterFactory final : public KVCompactionFilterFactory {
+public:
+    explicit ExpiredFilterFactory(GraphSpaceID spaceId) : KVCompactionFilterFactory(spaceId) {}
+
+    std::unique_ptr<KVFilter> createKVFilter() override {
+        return std::make_unique<ExpiredFilter>();
+    }
+};
+
+TEST(RocksEngineTest, CompactExpiredTest) {
+    FLAGS_rocksdb_compact_expired_files = true;
+    SCOPE_EXIT {
+        FLAGS_rocksdb_compact_expired_files = false;
+        ExpiredFilter::enabled_ = false;
+    };
+    fs::TempDir rootPath("/tmp/rocksdb_engine_CompactExpiredTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path(), "", nullptr,
+                                                std::make_shared<ExpiredFilterFactory>(0));
+    std::vector<KV> data;
+    for (int32_t i = 0; i < 10;  i++) {
+        data.emplace_back(folly::stringPrintf("expired_%d", i), "val");
+        data.emplace_back(folly::stringPrintf("valid_%d", i), "val");
+    }
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+    // move the data out of level 0, nothing is removed since the filter is disabled
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->compact());
+
+    auto count = [&] (const std::string& prefix) {
+        std::unique_ptr<KVIterator> iter;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix(prefix, &iter));
+        int32_t num = 0;
+        for (; iter->valid(); iter->next()) {
+            num++;
+        }
+        return num;
+    };
+    EXPECT_EQ(10, count("expired"));
+
+    ExpiredFilter::enabled_ = true;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->compactExpired());
+    EXPECT_EQ(0, count("expired"));
+    EXPECT_EQ(10, count("valid"));
+}
+
+TEST(RocksEngineTest, CompactionStatsTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_CompactionStatsTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
+    EXPECT_EQ(0, engine->numLevel0Files());
+    EXPECT_EQ(0.0, engine->tombstoneRatio());
+    EXPECT_EQ(0.0, engine->writeStallPressure());
+
+    std::vector<KV> data;
+    std::vector<std::string> keys;
+    for (int32_t i = 0; i < 10;  i++) {
+        data.emplace_back(folly::stringPrintf("key_%d", i), "val");
+        keys.emplace_back(folly::stringPrintf("key_%d", i));
+    }
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+    EXPECT_EQ(1, engine->numLevel0Files());
+    EXPECT_EQ(0.0, engine->tombstoneRatio());
+
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiRemove(std::move(keys)));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+    EXPECT_EQ(2, engine->numLevel0Files());
+    EXPECT_DOUBLE_EQ(0.5, engine->tombstoneRatio());
+    // far from the slowdown trigger of level 0 files
+    EXPECT_GT(engine->writeStallPressure(), 0.0);
+    EXPECT_LT(engine->writeStallPressure(), 1.0);
+
+    // the deletions are dropped with the keys
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->compact());
+    EXPECT_EQ(0, engine->numLevel0Files());
+    EXPECT_EQ(0.0, engine->tombstoneRatio());
+}
+
+TEST(RocksEngineTest, EstimateRangeTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_EstimateRangeTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
+    std::vector<KV> data;
+    for (int32_t i = 0; i < 10000; i++) {
+        data.emplace_back(folly::stringPrintf("key_%05d", i), std::string(100, 'v'));
+    }
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+
+    int64_t keys = 0;
+    std::vector<std::string> splits;
+    // the keys in the memtable are counted
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              engine->estimateRange("key_", "key_99999", &keys, &splits));
+    EXPECT_GT(keys, 8000);
+    EXPECT_LT(keys, 12000);
+    EXPECT_TRUE(splits.empty());
+
+    // the keys in the SST files are estimated by the size
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              engine->estimateRange("key_", "key_99999", &keys, &splits));
+    EXPECT_GT(keys, 8000);
+    EXPECT_LT(keys, 12000);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              engine->estimateRange("key_00000", "key_05000", &keys, &splits));
+    EXPECT_GT(keys, 3000);
+    EXPECT_LT(keys, 7000);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              engine->estimateRange("other", "other_end", &keys, &splits));
+    EXPECT_EQ(0, keys);
+}
+
+TEST(RocksEngineTest, CompactRangeTest) {
+    fs::TempDir rootPath("/tmp/rocksdb_engine_CompactRangeTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
+    std::vector<KV> data;
+    for (int32_t i = 0; i < 1000; i++) {
+        data.emplace_back(folly::stringPrintf("key_%05d", i), std::string(100, 'v'));
+    }
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+    EXPECT_EQ(1, engine->numLevel0Files());
+
+    // the files out of the range or the level are not compacted
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->compactRange("other", "other_end", 0));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->compactRange("key_", "key_99999", 1));
+    EXPECT_EQ(1, engine->numLevel0Files());
+
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->compactRange("key_", "key_00100", 0));
+    EXPECT_EQ(0, engine->numLevel0Files());
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->compactRange("key_", "key_99999", -1));
+
+    std::unique_ptr<KVIterator> iter;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix("key_", &iter));
+    int32_t num = 0;
+    for (; iter->valid(); iter->next()) {
+        num++;
+    }
+    EXPECT_EQ(1000, num);
+}
+
+TEST(RocksEngineTest, EventStatsTest) {
+    FLAGS_enable_rocksdb_event_stats = true;
+    fs::TempDir rootPath("/tmp/rocksdb_engine_EventStatsTest.XXXXXX");
+    GraphSpaceID spaceId = 7;
+    auto engine = std::make_unique<RocksEngine>(spaceId, kDefaultVIdLen, rootPath.path());
+    for (int32_t round = 0; round < 2; round++) {
+        std::vector<KV> data;
+        for (int32_t i = 0; i < 100; i++) {
+            data.emplace_back(folly::stringPrintf("key_%d", i), folly::stringPrintf("val_%d", i));
+        }
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+    }
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->compact());
+
+    // the events are reported by the background threads of rocksdb
+    auto key = std::make_pair(spaceId, std::string(rocksdb::kDefaultColumnFamilyName));
+    EngineEventStats::Counters counters;
+    for (int32_t i = 0; i < 100; i++) {
+        auto stats = EngineEventStats::instance().snapshot();
+        if (stats.count(key) && stats[key].flushes >= 2 && stats[key].compactions >= 1) {
+            counters = stats[key];
+            break;
+        }
+        usleep(10000);
+    }
+    EXPECT_EQ(2, counters.flushes);
+    EXPECT_GT(counters.flushBytes, 0);
+    EXPECT_GE(counters.compactions, 1);
+    EXPECT_GT(counters.compactionReadBytes, 0);
+    EXPECT_GT(counters.compactionWriteBytes, 0);
+    EXPECT_GT(counters.writeAmplification(), 100);
+    FLAGS_enable_rocksdb_event_stats = false;
+}
+
 TEST(RocksEngineTest, IngestTest) {
     rocksdb::Options options;
     rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
@@ -229,6 +684,194 @@ TEST(RocksEngineTest, IngestTest) {
     EXPECT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND, engine->get("key_not_exist", &result));
 }
 
+TEST(RocksEngineTest, ColumnFamilyPerKeyTypeTest) {
+    FLAGS_rocksdb_column_family_per_key_type = true;
+    fs::TempDir rootPath("/tmp/rocksdb_engine_ColumnFamilyPerKeyTypeTest.XXXXXX");
+    GraphSpaceID spaceId = 1;
+    PartitionID partId = 1;
+    auto vertexKey = [&](int32_t i) {
+        return NebulaKeyUtils::vertexKey(kDefaultVIdLen, partId, folly::to<std::string>(i), 1);
+    };
+    auto edgeKey = [&](int32_t i) {
+        return NebulaKeyUtils::edgeKey(kDefaultVIdLen, partId, folly::to<std::string>(i), 1, 0,
+                                       folly::to<std::string>(i));
+    };
+    auto indexKey = [&](int32_t i) {
+        return IndexKeyUtils::vertexIndexKey(kDefaultVIdLen, partId, 1,
+                                             folly::to<std::string>(i), "");
+    };
+    auto count = [](std::unique_ptr<KVIterator> iter) {
+        int32_t num = 0;
+        std::string last;
+        for (; iter->valid(); iter->next()) {
+            EXPECT_LT(last, iter->key().str());
+            last = iter->key().str();
+            num++;
+        }
+        return num;
+    };
+
+    {
+        auto engine = std::make_unique<RocksEngine>(spaceId, kDefaultVIdLen, rootPath.path());
+        std::vector<KV> data;
+        for (int32_t i = 0; i < 10; i++) {
+            data.emplace_back(vertexKey(i), "vertex");
+            data.emplace_back(edgeKey(i), "edge");
+            data.emplace_back(indexKey(i), "");
+        }
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+        EXPECT_NE(engine->columnFamily(vertexKey(0)), engine->columnFamily(edgeKey(0)));
+        EXPECT_NE(engine->columnFamily(edgeKey(0)), engine->columnFamily(indexKey(0)));
+
+        std::string val;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->get(edgeKey(3), &val));
+        EXPECT_EQ("edge", val);
+        std::vector<std::string> values;
+        auto ret = engine->multiGet({vertexKey(1), edgeKey(1), indexKey(1)}, &values);
+        EXPECT_EQ(3, ret.size());
+        EXPECT_EQ("vertex", values[0]);
+        EXPECT_EQ("edge", values[1]);
+
+        std::unique_ptr<KVIterator> iter;
+        auto prefix = NebulaKeyUtils::edgePrefix(partId);
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix(prefix, &iter));
+        EXPECT_EQ(10, count(std::move(iter)));
+        prefix = IndexKeyUtils::indexPrefix(partId);
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix(prefix, &iter));
+        EXPECT_EQ(10, count(std::move(iter)));
+
+        // the range from vertices to indexes of the part is across all column families
+        auto start = NebulaKeyUtils::vertexPrefix(partId);
+        auto end = IndexKeyUtils::indexPrefix(partId);
+        end[0]++;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->range(start, end, &iter));
+        EXPECT_EQ(30, count(std::move(iter)));
+
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->removeRange(prefix, end));
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix(prefix, &iter));
+        EXPECT_EQ(0, count(std::move(iter)));
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->compact());
+    }
+
+    // the existing db keeps its column families even if the flag is off
+    FLAGS_rocksdb_column_family_per_key_type = false;
+    auto engine = std::make_unique<RocksEngine>(spaceId, kDefaultVIdLen, rootPath.path());
+    EXPECT_NE(engine->columnFamily(vertexKey(0)), engine->columnFamily(edgeKey(0)));
+    std::string val;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->get(vertexKey(3), &val));
+    EXPECT_EQ("vertex", val);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND, engine->get(indexKey(3), &val));
+
+    // the keys of all types in one SST file are split into the column families
+    rocksdb::Options options;
+    rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
+    auto file = folly::stringPrintf("%s/%s", rootPath.path(), "data.sst");
+    ASSERT_TRUE(writer.Open(file).ok());
+    ASSERT_TRUE(writer.Put(vertexKey(20), "vertex").ok());
+    ASSERT_TRUE(writer.Put(edgeKey(20), "edge").ok());
+    ASSERT_TRUE(writer.Put(indexKey(20), "").ok());
+    ASSERT_TRUE(writer.Finish().ok());
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->ingest({file}));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->get(edgeKey(20), &val));
+    EXPECT_EQ("edge", val);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->get(indexKey(20), &val));
+    std::unique_ptr<KVIterator> iter;
+    auto prefix = NebulaKeyUtils::edgePrefix(partId);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix(prefix, &iter));
+    EXPECT_EQ(11, count(std::move(iter)));
+}
+
+TEST(RocksEngineTest, IngestFlushRetryTest) {
+    FLAGS_ingest_flush_retry_times = 2;
+    fs::TempDir rootPath("/tmp/rocksdb_engine_IngestFlushRetryTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(0, kDefaultVIdLen, rootPath.path());
+    // the key in the memtable overlaps the file
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->put("key_b", "old"));
+
+    rocksdb::Options options;
+    rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
+    auto file = folly::stringPrintf("%s/%s", rootPath.path(), "data.sst");
+    ASSERT_TRUE(writer.Open(file).ok());
+    ASSERT_TRUE(writer.Put("key_a", "a").ok());
+    ASSERT_TRUE(writer.Put("key_b", "new").ok());
+    ASSERT_TRUE(writer.Finish().ok());
+    EXPECT_TRUE(RocksEngine::verifyFile(file).ok());
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->ingest({file}));
+
+    std::string result;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->get("key_a", &result));
+    EXPECT_EQ("a", result);
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->get("key_b", &result));
+    EXPECT_EQ("new", result);
+
+    {
+        std::ofstream out(folly::stringPrintf("%s/broken.sst", rootPath.path()));
+        out << "broken";
+    }
+    EXPECT_FALSE(RocksEngine::verifyFile(
+        folly::stringPrintf("%s/broken.sst", rootPath.path())).ok());
+    FLAGS_ingest_flush_retry_times = 0;
+}
+
+TEST(RocksEngineTest, ParallelIngestTest) {
+    FLAGS_rocksdb_column_family_per_key_type = true;
+    FLAGS_ingest_prepare_threads = 4;
+    fs::TempDir rootPath("/tmp/rocksdb_engine_ParallelIngestTest.XXXXXX");
+    auto engine = std::make_unique<RocksEngine>(1, kDefaultVIdLen, rootPath.path());
+    auto vertexKey = [](int32_t i) {
+        return NebulaKeyUtils::vertexKey(kDefaultVIdLen, 1, folly::to<std::string>(i), 1);
+    };
+    auto edgeKey = [](int32_t i) {
+        return NebulaKeyUtils::edgeKey(kDefaultVIdLen, 1, folly::to<std::string>(i), 1, 0,
+                                       folly::to<std::string>(i));
+    };
+
+    rocksdb::Options options;
+    std::vector<std::string> files;
+    for (int32_t i = 0; i < 10; i++) {
+        rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
+        auto file = folly::stringPrintf("%s/data_%d.sst", rootPath.path(), i);
+        ASSERT_TRUE(writer.Open(file).ok());
+        ASSERT_TRUE(writer.Put(vertexKey(i), "vertex").ok());
+        ASSERT_TRUE(writer.Put(edgeKey(i), "edge").ok());
+        ASSERT_TRUE(writer.Finish().ok());
+        files.emplace_back(std::move(file));
+    }
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->ingest(files, true));
+    for (int32_t i = 0; i < 10; i++) {
+        std::string val;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->get(vertexKey(i), &val));
+        EXPECT_EQ("vertex", val);
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->get(edgeKey(i), &val));
+        EXPECT_EQ("edge", val);
+    }
+    // the split files are removed
+    auto left = fs::FileUtils::listAllFilesInDir(rootPath.path(), false, "data_*.sst.*");
+    EXPECT_TRUE(left.empty());
+
+    // nothing is ingested if any file is broken
+    {
+        std::ofstream out(folly::stringPrintf("%s/broken.sst", rootPath.path()));
+        out << "broken";
+    }
+    files = {folly::stringPrintf("%s/broken.sst", rootPath.path())};
+    for (int32_t i = 10; i < 13; i++) {
+        rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
+        auto file = folly::stringPrintf("%s/data_%d.sst", rootPath.path(), i);
+        ASSERT_TRUE(writer.Open(file).ok());
+        ASSERT_TRUE(writer.Put(vertexKey(i), "vertex").ok());
+        ASSERT_TRUE(writer.Finish().ok());
+        files.emplace_back(std::move(file));
+    }
+    EXPECT_NE(nebula::cpp2::ErrorCode::SUCCEEDED, engine->ingest(files, true));
+    std::string val;
+    EXPECT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND, engine->get(vertexKey(11), &val));
+
+    FLAGS_rocksdb_column_family_per_key_type = false;
+    FLAGS_ingest_prepare_threads = 1;
+}
+
 TEST(RocksEngineTest, BackupRestoreTable) {
     rocksdb::Options options;
     rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
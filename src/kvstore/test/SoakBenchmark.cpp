@@ -0,0 +1,553 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+/*
+The soak benchmark of the raft stores, which tells the cost of the availability events before a
+release. It starts soak_hosts NebulaStores in process, with soak_parts parts of 3 replicas on
+them, drives a mix of reads and writes to the leaders by soak_clients threads, and every
+soak_event_interval_secs injects one of soak_events in turn:
+  transfer_leader   transfer the leader of a random part to another replica
+  restart           stop a random host and start it again at once
+  lag               stop a random host for soak_lag_secs, its parts catch up when it is back
+  balance           move a replica of a random part to a host without it, by a learner added,
+                    caught up and promoted, then the old replica removed, needs 4 hosts at least
+Every soak_report_interval_secs the throughput, the latency percentiles and the errors of the
+reads and the writes are printed with the events in the window, and the windows with and without
+an event are compared at the end, e.g.
+  soak_bm --soak_secs=300 --soak_hosts=4 --soak_events=transfer_leader,balance
+*/
+
+#include "common/base/Base.h"
+#include <folly/Random.h>
+#include <folly/SharedMutex.h>
+#include <folly/String.h>
+#include <folly/init/Init.h>
+#include <folly/futures/Future.h>
+#include <thrift/lib/cpp/concurrency/ThreadManager.h>
+#include "common/fs/TempDir.h"
+#include "common/network/NetworkUtils.h"
+#include "kvstore/NebulaStore.h"
+#include "kvstore/PartManager.h"
+
+DEFINE_int32(soak_secs, 60, "How long the soak runs");
+DEFINE_int32(soak_report_interval_secs, 5, "The window of each report");
+DEFINE_int32(soak_hosts, 4, "The hosts started, each part has 3 replicas on them");
+DEFINE_int32(soak_parts, 6, "The parts of the space");
+DEFINE_int32(soak_clients, 4, "The threads sending the requests");
+DEFINE_int32(soak_read_percent, 80, "The percent of the reads in the requests");
+DEFINE_int32(soak_keys, 10000, "The keys of each part");
+DEFINE_int32(soak_value_size, 128, "The size of the values written");
+DEFINE_int32(soak_timeout_ms, 5000, "A request not done in time is counted as an error");
+DEFINE_int32(soak_event_interval_secs, 10, "The interval between the events, 0 for no event");
+DEFINE_string(soak_events, "transfer_leader,restart,lag,balance",
+              "The events injected in turn, separated by comma");
+DEFINE_int32(soak_lag_secs, 5, "How long a lagging host is down");
+DEFINE_string(soak_path, "/tmp/soak_bm.XXXXXX", "The data path template of the hosts");
+
+namespace nebula {
+namespace kvstore {
+
+const GraphSpaceID kSpaceId = 1;
+const size_t kReplicas = 3;
+
+// The latencies (us) and the errors of one kind of requests in a window
+struct OpStats {
+    std::vector<int64_t>    latencies;
+    int64_t                 errors{0};
+
+    void merge(OpStats&& other) {
+        latencies.insert(latencies.end(), other.latencies.begin(), other.latencies.end());
+        errors += other.errors;
+    }
+
+    std::string toString(double secs) {
+        std::sort(latencies.begin(), latencies.end());
+        auto percentile = [this] (double p) -> int64_t {
+            if (latencies.empty()) {
+                return 0;
+            }
+            auto index = std::min(latencies.size() - 1,
+                                  static_cast<size_t>(latencies.size() * p / 100));
+            return latencies[index];
+        };
+        return folly::stringPrintf("%8.0f ops/s p50 %6ldus p99 %7ldus p999 %7ldus "
+                                   "max %7ldus errors %ld",
+                                   latencies.size() / secs, percentile(50), percentile(99),
+                                   percentile(99.9), percentile(100), errors);
+    }
+};
+
+// The stats of a client, swapped out by the reporter every window
+struct ClientStats {
+    std::mutex  lock;
+    OpStats     reads;
+    OpStats     writes;
+};
+
+class SoakCluster final {
+public:
+    explicit SoakCluster(std::string root)
+        : root_(std::move(root)) {
+        for (int32_t i = 0; i < FLAGS_soak_hosts; i++) {
+            hosts_.emplace_back("127.0.0.1", network::NetworkUtils::getAvailablePort());
+        }
+        for (PartitionID part = 1; part <= FLAGS_soak_parts; part++) {
+            auto& replicas = placement_[part];
+            for (size_t i = 0; i < kReplicas; i++) {
+                replicas.emplace_back(hosts_[(part + i) % hosts_.size()]);
+            }
+        }
+        stores_.resize(hosts_.size());
+    }
+
+    void start() {
+        for (size_t i = 0; i < hosts_.size(); i++) {
+            auto store = newStore(i);
+            folly::SharedMutex::WriteHolder wh(lock_);
+            stores_[i] = std::move(store);
+        }
+        LOG(INFO) << "Waiting for all leaders elected!";
+        while (!allElected()) {
+            usleep(100000);
+        }
+    }
+
+    void stop() {
+        for (size_t i = 0; i < hosts_.size(); i++) {
+            stopStore(i);
+        }
+    }
+
+    std::shared_ptr<NebulaStore> leaderOf(PartitionID part) {
+        folly::SharedMutex::ReadHolder rh(lock_);
+        for (const auto& store : stores_) {
+            if (store != nullptr && store->isLeader(kSpaceId, part)) {
+                return store;
+            }
+        }
+        return nullptr;
+    }
+
+    // The events, return false if the event could not be done
+    bool transferLeader();
+
+    bool restart(int32_t downSecs);
+
+    bool balance();
+
+private:
+    std::shared_ptr<NebulaStore> newStore(size_t index) {
+        auto partMan = std::make_unique<MemPartManager>();
+        for (const auto& part : placement_) {
+            if (std::find(part.second.begin(), part.second.end(), hosts_[index])
+                    == part.second.end()) {
+                continue;
+            }
+            meta::PartHosts pm;
+            pm.spaceId_ = kSpaceId;
+            pm.partId_ = part.first;
+            pm.hosts_ = part.second;
+            partMan->partsMap()[kSpaceId][part.first] = std::move(pm);
+        }
+        KVOptions options;
+        options.dataPaths_ = {folly::stringPrintf("%s/disk%lu", root_.c_str(), index)};
+        options.partMan_ = std::move(partMan);
+        auto handlers =
+            apache::thrift::concurrency::PriorityThreadManager::newPriorityThreadManager(
+                1, true /*stats*/);
+        handlers->setNamePrefix("executor");
+        handlers->start();
+        auto store = std::make_shared<NebulaStore>(std::move(options),
+                                                   std::make_shared<folly::IOThreadPoolExecutor>(4),
+                                                   hosts_[index],
+                                                   handlers);
+        CHECK(store->init());
+        // the host might have no part at first, but the parts are moved to it by balance
+        store->addSpace(kSpaceId);
+        return store;
+    }
+
+    // Stop the store and wait until the clients holding it are done, before it is destroyed
+    void stopStore(size_t index) {
+        std::shared_ptr<NebulaStore> store;
+        {
+            folly::SharedMutex::WriteHolder wh(lock_);
+            store.swap(stores_[index]);
+        }
+        if (store == nullptr) {
+            return;
+        }
+        store->stop();
+        while (store.use_count() > 1) {
+            usleep(1000);
+        }
+        store.reset();
+    }
+
+    std::shared_ptr<NebulaStore> store(size_t index) {
+        folly::SharedMutex::ReadHolder rh(lock_);
+        return stores_[index];
+    }
+
+    size_t indexOf(const HostAddr& host) const {
+        auto it = std::find(hosts_.begin(), hosts_.end(), host);
+        CHECK(it != hosts_.end());
+        return it - hosts_.begin();
+    }
+
+    bool allElected() {
+        for (const auto& part : placement_) {
+            if (leaderOf(part.first) == nullptr) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    std::shared_ptr<Part> leaderPart(PartitionID part) {
+        auto leader = leaderOf(part);
+        if (leader == nullptr) {
+            return nullptr;
+        }
+        auto ret = leader->part(kSpaceId, part);
+        return ok(ret) ? value(ret) : nullptr;
+    }
+
+private:
+    const std::string                                   root_;
+    std::vector<HostAddr>                               hosts_;
+    // the replicas of each part, only changed by the events
+    std::map<PartitionID, std::vector<HostAddr>>        placement_;
+    folly::SharedMutex                                  lock_;
+    // the store of each host, null if the host is down
+    std::vector<std::shared_ptr<NebulaStore>>           stores_;
+};
+
+// Run an async op of the part, and wait for its callback at most soak_timeout_ms
+nebula::cpp2::ErrorCode waitFor(std::function<void(KVCallback)> op) {
+    auto promise = std::make_shared<folly::Promise<nebula::cpp2::ErrorCode>>();
+    auto future = promise->getFuture();
+    op([promise] (nebula::cpp2::ErrorCode code) {
+        promise->setValue(code);
+    });
+    future.wait(std::chrono::milliseconds(FLAGS_soak_timeout_ms));
+    if (!future.isReady()) {
+        return nebula::cpp2::ErrorCode::E_RPC_FAILURE;
+    }
+    return future.value();
+}
+
+bool SoakCluster::transferLeader() {
+    PartitionID part = folly::Random::rand32(1, FLAGS_soak_parts + 1);
+    auto leader = leaderPart(part);
+    if (leader == nullptr) {
+        return false;
+    }
+    std::vector<HostAddr> targets;
+    for (const auto& host : placement_[part]) {
+        if (NebulaStore::getRaftAddr(host) != leader->address()) {
+            targets.emplace_back(host);
+        }
+    }
+    if (targets.empty()) {
+        return false;
+    }
+    auto target = NebulaStore::getRaftAddr(targets[folly::Random::rand32(targets.size())]);
+    LOG(INFO) << "Transfer the leader of part " << part << " to " << target;
+    auto code = waitFor([&] (KVCallback cb) {
+        leader->asyncTransferLeader(target, std::move(cb));
+    });
+    return code == nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+bool SoakCluster::restart(int32_t downSecs) {
+    auto index = folly::Random::rand32(hosts_.size());
+    LOG(INFO) << "Stop " << hosts_[index] << " for " << downSecs << " secs";
+    stopStore(index);
+    sleep(downSecs);
+    auto store = newStore(index);
+    folly::SharedMutex::WriteHolder wh(lock_);
+    stores_[index] = std::move(store);
+    return true;
+}
+
+bool SoakCluster::balance() {
+    PartitionID part = folly::Random::rand32(1, FLAGS_soak_parts + 1);
+    auto& replicas = placement_[part];
+    std::vector<HostAddr> candidates;
+    for (const auto& host : hosts_) {
+        if (std::find(replicas.begin(), replicas.end(), host) == replicas.end()) {
+            candidates.emplace_back(host);
+        }
+    }
+    if (candidates.empty()) {
+        LOG(INFO) << "No host to balance part " << part << " to, " << kReplicas
+                  << " replicas on " << hosts_.size() << " hosts";
+        return false;
+    }
+    auto dst = candidates[folly::Random::rand32(candidates.size())];
+    auto src = replicas[folly::Random::rand32(replicas.size())];
+    auto dstRaft = NebulaStore::getRaftAddr(dst);
+    auto srcRaft = NebulaStore::getRaftAddr(src);
+    auto dstStore = store(indexOf(dst));
+    auto srcStore = store(indexOf(src));
+    if (dstStore == nullptr || srcStore == nullptr) {
+        return false;
+    }
+    LOG(INFO) << "Balance part " << part << " from " << src << " to " << dst;
+
+    std::vector<HostAddr> peers;
+    for (const auto& host : replicas) {
+        peers.emplace_back(NebulaStore::getRaftAddr(host));
+    }
+    dstStore->addPart(kSpaceId, part, true, peers);
+    auto leader = leaderPart(part);
+    if (leader == nullptr ||
+        waitFor([&] (KVCallback cb) { leader->asyncAddLearner(dstRaft, std::move(cb)); })
+            != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(INFO) << "Add learner " << dst << " of part " << part << " failed";
+        return false;
+    }
+    size_t retry = 0;
+    while (leader->isCatchedUp(dstRaft) != raftex::AppendLogResult::SUCCEEDED) {
+        if (++retry > 600) {
+            LOG(INFO) << "The learner " << dst << " of part " << part << " does not catch up";
+            return false;
+        }
+        usleep(100000);
+    }
+    if (leader->address() == srcRaft) {
+        // the leader to be removed hands over to another replica first
+        HostAddr target;
+        for (const auto& peer : peers) {
+            if (peer != srcRaft) {
+                target = peer;
+            }
+        }
+        waitFor([&] (KVCallback cb) { leader->asyncTransferLeader(target, std::move(cb)); });
+        while ((leader = leaderPart(part)) == nullptr || leader->address() == srcRaft) {
+            usleep(100000);
+        }
+    }
+    if (waitFor([&] (KVCallback cb) { leader->asyncAddPeer(dstRaft, std::move(cb)); })
+            != nebula::cpp2::ErrorCode::SUCCEEDED ||
+        waitFor([&] (KVCallback cb) { leader->asyncRemovePeer(srcRaft, std::move(cb)); })
+            != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(INFO) << "Change the members of part " << part << " failed";
+        return false;
+    }
+    srcStore->removePart(kSpaceId, part);
+    std::replace(replicas.begin(), replicas.end(), src, dst);
+    return true;
+}
+
+class Soak final {
+public:
+    explicit Soak(SoakCluster* cluster)
+        : cluster_(cluster)
+        , clientStats_(FLAGS_soak_clients) {}
+
+    void run();
+
+private:
+    void client(size_t index);
+
+    // Run the events in turn until the soak is done
+    void inject(const std::vector<std::string>& events);
+
+    // Print the stats of the window, and keep them for the summary
+    void report(double secs);
+
+    void summary();
+
+private:
+    struct Summary {
+        int64_t     windows{0};
+        double      secs{0};
+        int64_t     reads{0};
+        int64_t     writes{0};
+        int64_t     errors{0};
+    };
+
+    SoakCluster*                    cluster_;
+    std::atomic<bool>               stopped_{false};
+    std::vector<ClientStats>        clientStats_;
+    std::mutex                      eventLock_;
+    // the events started in the window, and the event running
+    std::vector<std::string>        windowEvents_;
+    std::string                     runningEvent_;
+    int64_t                         elapsedSecs_{0};
+    Summary                         quiet_;
+    Summary                         eventful_;
+};
+
+void Soak::run() {
+    std::vector<std::string> events;
+    folly::split(',', FLAGS_soak_events, events, true);
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < FLAGS_soak_clients; i++) {
+        threads.emplace_back(&Soak::client, this, i);
+    }
+    std::thread injector;
+    if (FLAGS_soak_event_interval_secs > 0 && !events.empty()) {
+        injector = std::thread(&Soak::inject, this, events);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    auto last = start;
+    auto end = start + std::chrono::seconds(FLAGS_soak_secs);
+    while (std::chrono::steady_clock::now() < end) {
+        std::this_thread::sleep_for(std::chrono::seconds(FLAGS_soak_report_interval_secs));
+        auto now = std::chrono::steady_clock::now();
+        elapsedSecs_ = std::chrono::duration_cast<std::chrono::seconds>(now - start).count();
+        report(std::chrono::duration<double>(now - last).count());
+        last = now;
+    }
+    stopped_ = true;
+    for (auto& t : threads) {
+        t.join();
+    }
+    if (injector.joinable()) {
+        injector.join();
+    }
+    summary();
+}
+
+void Soak::client(size_t index) {
+    auto& stats = clientStats_[index];
+    std::string value(FLAGS_soak_value_size, 'v');
+    while (!stopped_) {
+        PartitionID part = folly::Random::rand32(1, FLAGS_soak_parts + 1);
+        auto key = folly::stringPrintf("key_%u", folly::Random::rand32(FLAGS_soak_keys));
+        bool read = folly::Random::rand32(100) < static_cast<uint32_t>(FLAGS_soak_read_percent);
+        auto start = std::chrono::steady_clock::now();
+        auto code = nebula::cpp2::ErrorCode::E_LEADER_CHANGED;
+        auto leader = cluster_->leaderOf(part);
+        if (leader != nullptr) {
+            if (read) {
+                std::string val;
+                code = leader->get(kSpaceId, part, key, &val);
+                if (code == nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND) {
+                    code = nebula::cpp2::ErrorCode::SUCCEEDED;
+                }
+            } else {
+                code = waitFor([&] (KVCallback cb) {
+                    leader->asyncMultiPut(kSpaceId, part, {{key, value}}, std::move(cb));
+                });
+            }
+        }
+        leader.reset();
+        auto latency = std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        {
+            std::lock_guard<std::mutex> g(stats.lock);
+            auto& op = read ? stats.reads : stats.writes;
+            if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                op.latencies.emplace_back(latency);
+            } else {
+                op.errors++;
+            }
+        }
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            // no leader, wait a moment for the election
+            usleep(10000);
+        }
+    }
+}
+
+void Soak::inject(const std::vector<std::string>& events) {
+    size_t next = 0;
+    while (true) {
+        for (int32_t i = 0; i < FLAGS_soak_event_interval_secs * 10; i++) {
+            if (stopped_) {
+                return;
+            }
+            usleep(100000);
+        }
+        const auto& event = events[next++ % events.size()];
+        {
+            std::lock_guard<std::mutex> g(eventLock_);
+            windowEvents_.emplace_back(event);
+            runningEvent_ = event;
+        }
+        bool done = false;
+        if (event == "transfer_leader") {
+            done = cluster_->transferLeader();
+        } else if (event == "restart") {
+            done = cluster_->restart(0);
+        } else if (event == "lag") {
+            done = cluster_->restart(FLAGS_soak_lag_secs);
+        } else if (event == "balance") {
+            done = cluster_->balance();
+        } else {
+            LOG(ERROR) << "Unknown event " << event;
+        }
+        LOG(INFO) << "Event " << event << (done ? " done" : " not done");
+        std::lock_guard<std::mutex> g(eventLock_);
+        runningEvent_.clear();
+    }
+}
+
+void Soak::report(double secs) {
+    OpStats reads;
+    OpStats writes;
+    for (auto& stats : clientStats_) {
+        std::lock_guard<std::mutex> g(stats.lock);
+        reads.merge(std::move(stats.reads));
+        writes.merge(std::move(stats.writes));
+        stats.reads = OpStats();
+        stats.writes = OpStats();
+    }
+    std::vector<std::string> events;
+    {
+        std::lock_guard<std::mutex> g(eventLock_);
+        events.swap(windowEvents_);
+        if (!runningEvent_.empty() && events.empty()) {
+            events.emplace_back(runningEvent_ + "(running)");
+        }
+    }
+    auto& summary = events.empty() ? quiet_ : eventful_;
+    summary.windows++;
+    summary.secs += secs;
+    summary.reads += reads.latencies.size();
+    summary.writes += writes.latencies.size();
+    summary.errors += reads.errors + writes.errors;
+
+    LOG(INFO) << folly::stringPrintf("[%4lds] read  %s",
+                                     elapsedSecs_, reads.toString(secs).c_str());
+    LOG(INFO) << folly::stringPrintf("[%4lds] write %s",
+                                     elapsedSecs_, writes.toString(secs).c_str());
+    LOG(INFO) << folly::stringPrintf("[%4lds] events: %s", elapsedSecs_,
+                                     events.empty() ? "none" : folly::join(",", events).c_str());
+}
+
+void Soak::summary() {
+    auto print = [] (const char* name, const Summary& s) {
+        if (s.windows == 0) {
+            LOG(INFO) << name << ": no window";
+            return;
+        }
+        LOG(INFO) << folly::stringPrintf("%s: %ld windows, read %.0f ops/s, write %.0f ops/s, "
+                                         "errors %ld", name, s.windows, s.reads / s.secs,
+                                         s.writes / s.secs, s.errors);
+    };
+    print("Windows without event", quiet_);
+    print("Windows with events", eventful_);
+}
+
+}  // namespace kvstore
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    folly::init(&argc, &argv, true);
+    nebula::fs::TempDir rootPath(FLAGS_soak_path.c_str());
+    nebula::kvstore::SoakCluster cluster(rootPath.path());
+    cluster.start();
+    nebula::kvstore::Soak soak(&cluster);
+    soak.run();
+    cluster.stop();
+    return 0;
+}
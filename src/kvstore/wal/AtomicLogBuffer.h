@@ -209,12 +209,30 @@ public:
         return std::shared_ptr<AtomicLogBuffer>(new AtomicLogBuffer(capacity));
     }
 
+    /**
+     * The memory limit shared by all log buffers in the process, 0 means no limit. Once the
+     * total size exceeds it, the buffers larger than the average share drop their oldest logs
+     * when pushing, so the busy parts keep more logs than the idle ones, and the idle ones
+     * give up theirs on the next write.
+     * */
+    static void setTotalCapacity(int64_t capacity) {
+        budget().capacity_.store(capacity, std::memory_order_relaxed);
+    }
+
+    // The total size of all log buffers in the process
+    static int64_t totalSize() {
+        return budget().size_.load(std::memory_order_relaxed);
+    }
+
     /**
      * Users should ensure there are no readers when releasing it.
      * */
     ~AtomicLogBuffer() {
         auto refs = refs_.load(std::memory_order_acquire);
         CHECK_EQ(0, refs);
+        budget().size_.fetch_sub(size_.load(std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
+        budget().buffers_.fetch_sub(1, std::memory_order_relaxed);
         auto* curr = head_.load(std::memory_order_relaxed);
         auto* prev = curr;
         while (curr != nullptr) {
@@ -248,11 +266,11 @@ public:
             } else if (head != nullptr) {
                 head->prev_.store(newNode, std::memory_order_release);
             }
-            size_.fetch_add(recSize, std::memory_order_relaxed);
+            addSize(recSize);
             head_.store(newNode, std::memory_order_relaxed);
             return;
         }
-        if (size_ + recSize > capacity_) {
+        if (size_ + recSize > capacity_ || overBudget()) {
             auto* tail = tail_.load(std::memory_order_relaxed);
             // todo(doodle): there is a potential problem is that: since Node::isFull is judeged by
             // log count, we can only add new node when previous node has enough logs. So when tail
@@ -271,13 +289,13 @@ public:
                 // All operations above SHOULD NOT be reordered.
                 tail_.store(tail->prev_, std::memory_order_release);
                 if (marked) {
-                    size_.fetch_sub(tail->size_, std::memory_order_relaxed);
+                    addSize(-tail->size_);
                     // dirtyNodes_ changes SHOULD after the tail move.
                     dirtyNodes_.fetch_add(1, std::memory_order_release);
                 }
             }
         }
-        size_.fetch_add(recSize, std::memory_order_relaxed);
+        addSize(recSize);
         head->push_back(std::move(record));
     }
 
@@ -314,7 +332,8 @@ public:
             p = p->next_;
             ++count;
         }
-        size_.store(0, std::memory_order_relaxed);
+        budget().size_.fetch_sub(size_.exchange(0, std::memory_order_relaxed),
+                                 std::memory_order_relaxed);
         firstLogId_.store(0, std::memory_order_relaxed);
         dirtyNodes_.fetch_add(count, std::memory_order_release);
     }
@@ -325,8 +344,37 @@ public:
     }
 
 private:
+    struct Budget {
+        std::atomic<int64_t>    capacity_{0};
+        std::atomic<int64_t>    size_{0};
+        std::atomic<int32_t>    buffers_{0};
+    };
+
+    static Budget& budget() {
+        static Budget budget;
+        return budget;
+    }
+
     explicit AtomicLogBuffer(int32_t capacity)
-        : capacity_(capacity) {}
+        : capacity_(capacity) {
+        budget().buffers_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void addSize(int32_t delta) {
+        size_.fetch_add(delta, std::memory_order_relaxed);
+        budget().size_.fetch_add(delta, std::memory_order_relaxed);
+    }
+
+    // Whether the total size exceeds the budget, and this buffer is larger than its share
+    bool overBudget() const {
+        auto& b = budget();
+        auto capacity = b.capacity_.load(std::memory_order_relaxed);
+        if (capacity <= 0 || b.size_.load(std::memory_order_relaxed) <= capacity) {
+            return false;
+        }
+        auto buffers = std::max(1, b.buffers_.load(std::memory_order_relaxed));
+        return size_.load(std::memory_order_relaxed) > capacity / buffers;
+    }
 
     /*
      * Find the non-deleted node contains the logId.
@@ -9,12 +9,35 @@
 #include "common/time/WallClock.h"
 #include "kvstore/wal/FileBasedWal.h"
 #include "kvstore/wal/WalFileIterator.h"
+#include <fcntl.h>
+#include <fstream>
 #include <utime.h>
 
 DEFINE_int32(wal_ttl, 14400, "Default wal ttl");
 DEFINE_int64(wal_file_size, 16 * 1024 * 1024, "Default wal file size");
 DEFINE_int32(wal_buffer_size, 8 * 1024 * 1024, "Default wal buffer size");
 DEFINE_bool(wal_sync, false, "Whether fsync needs to be called every write");
+DEFINE_int64(wal_buffer_total_size, 0,
+             "The memory limit of the wal buffers of all parts, the buffers larger than the "
+             "average drop their oldest logs when it is exceeded, 0 means no limit");
+DEFINE_bool(wal_segment_meta, false,
+            "Whether to keep the last log id and term of the closed wal files in a meta file, "
+            "so they are not read again when the wal is opened");
+DEFINE_bool(wal_group_sync, false,
+            "Whether the wals on the same file system are synced together in rounds by one "
+            "thread, only works when wal_sync is true");
+DEFINE_bool(wal_preallocate, false,
+            "Whether to preallocate the space of wal_file_size when a wal file is created");
+DEFINE_int32(wal_retention_for_lagging_secs, 0,
+             "How long the expired wal files are kept further on the leader if they are still "
+             "needed by a lagging peer, so it could catch up without a snapshot, "
+             "0 means an expired file is removed no matter it is needed or not");
+DEFINE_int32(wal_ttl_for_acked_logs, 0,
+             "How long the wal files are kept on the leader once all their logs are accepted by "
+             "all peers and listeners, when it is shorter than wal_ttl, 0 means wal_ttl");
+DEFINE_int64(wal_max_bytes_per_part, 0,
+             "The max bytes of the wal files of a part, beyond which the oldest files are "
+             "removed even if they are not expired or still needed, 0 means unlimited");
 
 namespace nebula {
 namespace wal {
@@ -57,7 +80,11 @@ FileBasedWal::FileBasedWal(const folly::StringPiece dir,
         }
     }
 
+    AtomicLogBuffer::setTotalCapacity(FLAGS_wal_buffer_total_size);
     logBuffer_ = AtomicLogBuffer::instance(policy_.bufferSize);
+    if (policy_.sync && policy_.groupSync) {
+        syncer_ = WalGroupSyncer::get(dir_);
+    }
     scanAllWalFiles();
     if (!walFiles_.empty()) {
         firstLogId_ = walFiles_.begin()->second->firstId();
@@ -87,6 +114,7 @@ FileBasedWal::~FileBasedWal() {
 
 
 void FileBasedWal::scanAllWalFiles() {
+    auto metas = loadSegmentMeta();
     std::vector<std::string> files = FileUtils::listAllFilesInDir(dir_.c_str(), false, "*.wal");
     for (auto& fn : files) {
         // Split the file name
@@ -129,6 +157,16 @@ void FileBasedWal::scanAllWalFiles() {
             continue;
         }
 
+        // The file is not modified since it was closed, no need to read it
+        auto meta = metas.find(startIdFromName);
+        if (meta != metas.end() &&
+                meta->second.size_ == info->size() &&
+                meta->second.mtime_ == info->mtime()) {
+            info->setLastId(meta->second.lastId_);
+            info->setLastTerm(meta->second.lastTerm_);
+            continue;
+        }
+
         // Open the file
         int32_t fd = open(info->path(), O_RDONLY);
         if (fd < 0) {
@@ -285,9 +323,65 @@ void FileBasedWal::scanAllWalFiles() {
             }
         }
     }
+
+    // All files except the last one are closed
+    if (FLAGS_wal_segment_meta) {
+        std::string content;
+        for (auto it = walFiles_.begin(); it != walFiles_.end(); ++it) {
+            if (std::next(it) != walFiles_.end()) {
+                content.append(encodeSegmentMeta(it->second));
+            }
+        }
+        auto path = FileUtils::joinPath(dir_, kSegmentMetaFile);
+        auto tmpPath = path + ".tmp";
+        bool written = false;
+        {
+            std::ofstream out(tmpPath, std::ios::trunc);
+            out << content;
+            written = !!out;
+        }
+        if (!written || ::rename(tmpPath.c_str(), path.c_str()) != 0) {
+            LOG(WARNING) << idStr_ << "Failed to write the wal meta \"" << path << "\"";
+        }
+    }
+}
+
+
+std::string FileBasedWal::encodeSegmentMeta(const WalFileInfoPtr& info) {
+    return folly::stringPrintf("%ld %ld %ld %lu %ld\n",
+                               info->firstId(),
+                               info->lastId(),
+                               info->lastTerm(),
+                               info->size(),
+                               static_cast<int64_t>(info->mtime()));
+}
+
+
+std::unordered_map<LogID, FileBasedWal::SegmentMeta> FileBasedWal::loadSegmentMeta() {
+    std::unordered_map<LogID, SegmentMeta> metas;
+    if (!FLAGS_wal_segment_meta) {
+        return metas;
+    }
+    auto path = FileUtils::joinPath(dir_, kSegmentMetaFile);
+    std::ifstream in(path);
+    LogID firstId;
+    SegmentMeta meta;
+    while (in >> firstId >> meta.lastId_ >> meta.lastTerm_ >> meta.size_ >> meta.mtime_) {
+        metas[firstId] = meta;
+    }
+    return metas;
 }
 
 
+void FileBasedWal::appendSegmentMeta(const WalFileInfoPtr& info) {
+    auto path = FileUtils::joinPath(dir_, kSegmentMetaFile);
+    std::ofstream out(path, std::ios::app);
+    out << encodeSegmentMeta(info);
+    if (!out) {
+        LOG(WARNING) << idStr_ << "Failed to append the wal meta \"" << path << "\"";
+    }
+}
+
 void FileBasedWal::closeCurrFile() {
     if (currFd_ < 0) {
         // Already closed
@@ -295,7 +389,13 @@ void FileBasedWal::closeCurrFile() {
         return;
     }
 
-    if (!policy_.sync) {
+    // Release the preallocated space after the end of file
+    if (policy_.preallocate && ::ftruncate(currFd_, currInfo_->size()) == -1) {
+        LOG(WARNING) << "truncate wal \"" << currInfo_->path()
+                     << "\" failed, error: " << strerror(errno);
+    }
+
+    if (!policy_.sync || policy_.preallocate) {
         if (::fsync(currFd_) == -1) {
             LOG(WARNING) << "sync wal \"" << currInfo_->path()
                          << "\" failed, error: " << strerror(errno);
@@ -316,6 +416,9 @@ void FileBasedWal::closeCurrFile() {
     timebuf.actime = currInfo_->mtime();
     VLOG(1) << "Close cur file " << currInfo_->path() << ", mtime: " << currInfo_->mtime();
     utime(currInfo_->path(), &timebuf);
+    if (FLAGS_wal_segment_meta && currInfo_->lastId() > 0) {
+        appendSegmentMeta(currInfo_);
+    }
     currInfo_.reset();
 }
 
@@ -342,6 +445,12 @@ void FileBasedWal::prepareNewFile(LogID startLogId) {
                    << "\" (errno: " << errno << "): "
                    << strerror(errno);
     }
+    // The file size is kept, so the readers still see the end of the logs written
+    if (policy_.preallocate &&
+            ::fallocate(currFd_, FALLOC_FL_KEEP_SIZE, 0, policy_.fileSize) == -1) {
+        LOG(WARNING) << "Failed to preallocate wal \"" << info->path()
+                     << "\", error: " << strerror(errno);
+    }
     currInfo_ = info;
 }
 
@@ -495,7 +604,8 @@ void FileBasedWal::scanLastWal(WalFileInfoPtr info, LogID firstId) {
 bool FileBasedWal::appendLogInternal(LogID id,
                                      TermID term,
                                      ClusterID cluster,
-                                     std::string msg) {
+                                     std::string msg,
+                                     bool flush) {
     if (stopped_) {
         LOG(ERROR) << idStr_ << "WAL has stopped. Do not accept logs any more";
         return false;
@@ -513,45 +623,38 @@ bool FileBasedWal::appendLogInternal(LogID id,
         return false;
     }
 
-    // Write to the WAL file first
-    std::string strBuf;
-    strBuf.reserve(sizeof(LogID)
-                    + sizeof(TermID)
-                    + sizeof(ClusterID)
-                    + msg.size()
-                    + 2 * sizeof(int32_t));
-    strBuf.append(reinterpret_cast<char*>(&id), sizeof(LogID));
-    strBuf.append(reinterpret_cast<char*>(&term), sizeof(TermID));
-    int32_t len = msg.size();
-    strBuf.append(reinterpret_cast<char*>(&len), sizeof(int32_t));
-    strBuf.append(reinterpret_cast<char*>(&cluster), sizeof(ClusterID));
-    strBuf.append(reinterpret_cast<const char*>(msg.data()), msg.size());
-    strBuf.append(reinterpret_cast<char*>(&len), sizeof(int32_t));
+    size_t logSize = sizeof(LogID)
+                     + sizeof(TermID)
+                     + sizeof(ClusterID)
+                     + msg.size()
+                     + 2 * sizeof(int32_t);
 
     // Prepare the WAL file if it's not opened
     if (currFd_ < 0) {
         prepareNewFile(id);
-    } else if (currInfo_->size() + strBuf.size() > policy_.fileSize) {
+    } else if (currInfo_->size() + pending_.size() + logSize > policy_.fileSize) {
         // Need to roll over
+        flushPending();
         closeCurrFile();
 
         std::lock_guard<std::mutex> g(walFilesMutex_);
         prepareNewFile(id);
     }
 
-    ssize_t bytesWritten = write(currFd_, strBuf.data(), strBuf.size());
-    if (bytesWritten != (ssize_t)strBuf.size()) {
-        LOG(FATAL) << idStr_ << "bytesWritten:" << bytesWritten << ", expected:" << strBuf.size()
-                   << ", error:" << strerror(errno);
-    }
-
-    if (policy_.sync && ::fsync(currFd_) == -1) {
-        LOG(WARNING) << "sync wal \"" << currInfo_->path()
-                     << "\" failed, error: " << strerror(errno);
+    // Write to the WAL file first
+    pending_.reserve(pending_.size() + logSize);
+    pending_.append(reinterpret_cast<char*>(&id), sizeof(LogID));
+    pending_.append(reinterpret_cast<char*>(&term), sizeof(TermID));
+    int32_t len = msg.size();
+    pending_.append(reinterpret_cast<char*>(&len), sizeof(int32_t));
+    pending_.append(reinterpret_cast<char*>(&cluster), sizeof(ClusterID));
+    pending_.append(reinterpret_cast<const char*>(msg.data()), msg.size());
+    pending_.append(reinterpret_cast<char*>(&len), sizeof(int32_t));
+    pendingLastId_ = id;
+    pendingLastTerm_ = term;
+    if (flush) {
+        flushPending();
     }
-    currInfo_->setSize(currInfo_->size() + strBuf.size());
-    currInfo_->setLastId(id);
-    currInfo_->setLastTerm(term);
 
     lastLogId_ = id;
     lastLogTerm_ = term;
@@ -564,6 +667,32 @@ bool FileBasedWal::appendLogInternal(LogID id,
 }
 
 
+void FileBasedWal::flushPending() {
+    if (pending_.empty()) {
+        return;
+    }
+    CHECK_GE(currFd_, 0);
+    ssize_t bytesWritten = write(currFd_, pending_.data(), pending_.size());
+    if (bytesWritten != (ssize_t)pending_.size()) {
+        LOG(FATAL) << idStr_ << "bytesWritten:" << bytesWritten << ", expected:" << pending_.size()
+                   << ", error:" << strerror(errno);
+    }
+
+    if (syncer_) {
+        if (!syncer_->sync(currFd_)) {
+            LOG(WARNING) << "group sync wal \"" << currInfo_->path() << "\" failed";
+        }
+    } else if (policy_.sync && ::fdatasync(currFd_) == -1) {
+        LOG(WARNING) << "sync wal \"" << currInfo_->path()
+                     << "\" failed, error: " << strerror(errno);
+    }
+    currInfo_->setSize(currInfo_->size() + pending_.size());
+    currInfo_->setLastId(pendingLastId_);
+    currInfo_->setLastTerm(pendingLastTerm_);
+    pending_.clear();
+}
+
+
 bool FileBasedWal::appendLog(LogID id,
                              TermID term,
                              ClusterID cluster,
@@ -581,25 +710,41 @@ bool FileBasedWal::appendLog(LogID id,
 
 
 bool FileBasedWal::appendLogs(LogIterator& iter) {
+    return appendLogs(iter, true);
+}
+
+
+bool FileBasedWal::appendLogs(LogIterator& iter, bool flush) {
     if (diskMan_ && !diskMan_->hasEnoughSpace(spaceId_, partId_)) {
         LOG_EVERY_N(WARNING, 100) << idStr_ << "Failed to appendLogs because of no more space";
         return false;
     }
+    // The logs of a batch are written with one write and synced once
     for (; iter.valid(); ++iter) {
         if (!appendLogInternal(iter.logId(),
                                iter.logTerm(),
                                iter.logSource(),
-                               iter.logMsg().toString())) {
+                               iter.logMsg().toString(),
+                               false)) {
             LOG(ERROR) << idStr_ << "Failed to append log for logId "
                        << iter.logId();
+            flushPending();
             return false;
         }
     }
 
+    if (flush) {
+        flushPending();
+    }
     return true;
 }
 
 
+void FileBasedWal::flush() {
+    flushPending();
+}
+
+
 std::unique_ptr<LogIterator> FileBasedWal::iterator(LogID firstLogId,
                                                     LogID lastLogId) {
     auto iter = logBuffer_->iterator(firstLogId, lastLogId);
@@ -716,6 +861,11 @@ bool FileBasedWal::reset() {
 }
 
 void FileBasedWal::cleanWAL() {
+    cleanWALKeeping(std::numeric_limits<LogID>::max());
+}
+
+
+void FileBasedWal::cleanWALKeeping(LogID neededLogId, LogID ackedLogId) {
     std::lock_guard<std::mutex> g(walFilesMutex_);
     if (walFiles_.empty()) {
         return;
@@ -732,11 +882,26 @@ void FileBasedWal::cleanWAL() {
     }
     int count = 0;
     int walTTL = FLAGS_wal_ttl;
+    int64_t maxTTL = static_cast<int64_t>(walTTL) + FLAGS_wal_retention_for_lagging_secs;
+    int64_t ackedTTL = FLAGS_wal_ttl_for_acked_logs;
+    int64_t totalBytes = 0;
+    for (const auto& file : walFiles_) {
+        totalBytes += file.second->size();
+    }
     while (it != walFiles_.end()) {
+        auto age = now - it->second->mtime();
+        // The file is needed if it has the logs after neededLogId
+        bool needed = it->second->lastId() > neededLogId && age <= maxTTL;
+        // No one needs the file any more if all peers have accepted all its logs
+        bool acked = ackedTTL > 0 && it->second->lastId() <= ackedLogId && age > ackedTTL;
+        bool overBudget = FLAGS_wal_max_bytes_per_part > 0 &&
+                          totalBytes > FLAGS_wal_max_bytes_per_part;
         // keep at least two wal
-        if (index++ < size - 2 && (now - it->second->mtime() > walTTL)) {
+        if (index++ < size - 2 && ((age > walTTL && !needed) || acked || overBudget)) {
             VLOG(1) << "Clean wals, Remove " << it->second->path() << ", now: " << now
-                    << ", mtime: " << it->second->mtime();
+                    << ", mtime: " << it->second->mtime() << ", acked: " << acked
+                    << ", over budget: " << overBudget;
+            totalBytes -= it->second->size();
             unlink(it->second->path());
             it = walFiles_.erase(it);
             count++;
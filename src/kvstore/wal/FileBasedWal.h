@@ -14,6 +14,7 @@
 #include "kvstore/wal/Wal.h"
 #include "kvstore/wal/WalFileInfo.h"
 #include "kvstore/wal/AtomicLogBuffer.h"
+#include "kvstore/wal/WalGroupSyncer.h"
 #include "kvstore/DiskManager.h"
 
 namespace nebula {
@@ -29,6 +30,12 @@ struct FileBasedWalPolicy {
 
     // Whether fsync needs to be called every write
     bool sync = false;
+
+    // Whether to preallocate the space of fileSize when a log file is created
+    bool preallocate = false;
+
+    // Whether to sync together with the wals on the same file system, see WalGroupSyncer
+    bool groupSync = false;
 };
 
 struct FileBasedWalInfo {
@@ -43,10 +50,12 @@ using PreProcessor = folly::Function<bool(LogID, TermID, ClusterID, const std::s
 class FileBasedWal final : public Wal
                          , public std::enable_shared_from_this<FileBasedWal> {
     FRIEND_TEST(FileBasedWal, TTLTest);
+    FRIEND_TEST(FileBasedWal, KeepNeededWalTest);
     FRIEND_TEST(FileBasedWal, CheckLastWalTest);
     FRIEND_TEST(FileBasedWal, LinkTest);
     FRIEND_TEST(FileBasedWal, CleanWalBeforeIdTest);
     FRIEND_TEST(WalFileIter, MultiFilesReadTest);
+    FRIEND_TEST(WalFileIter, MmapReadTest);
     friend class FileBasedWalIterator;
     friend class WalFileIterator;
 public:
@@ -97,6 +106,14 @@ public:
     // simultaneously
     bool appendLogs(LogIterator& iter) override;
 
+    // Same as appendLogs(iter) when flush is true. Otherwise the logs are only appended into
+    // the buffer, which the iterators read already, and written into the file by flush()
+    bool appendLogs(LogIterator& iter, bool flush);
+
+    // Write the logs appended without flush into the file, and sync it if policy_.sync is true
+    // This method **IS NOT** thread-safe, no logs could be appended or rolled back meanwhile
+    void flush();
+
     // Rollback to the given ID, all logs after the ID will be discarded
     // This method **IS NOT** thread-safe
     // we **EXPECT** the thread rolling back logs is the same one
@@ -109,6 +126,14 @@ public:
 
     void cleanWAL() override;
 
+    // Same as cleanWAL(), except that the expired files which have the logs after neededLogId
+    // are kept for at most wal_retention_for_lagging_secs more, so a lagging peer could still
+    // catch up from the wal instead of a snapshot. Besides, whatever they are:
+    //  - the files with no log after ackedLogId, which all peers have accepted, expire after
+    //    wal_ttl_for_acked_logs if it is set, ackedLogId is -1 unless the peers are known
+    //  - the oldest files are removed while all files take more than wal_max_bytes_per_part
+    void cleanWALKeeping(LogID neededLogId, LogID ackedLogId = -1);
+
     void cleanWAL(LogID id) override;
 
     // Scan [firstLogId, lastLogId]
@@ -153,11 +178,34 @@ private:
     // Rollback to logId in given file
     void rollbackInFile(WalFileInfoPtr info, LogID logId);
 
-    // Implementation of appendLog()
+    // The last log id and term of a closed file, which are valid if the size and mtime of the
+    // file are not changed, see FLAGS_wal_segment_meta
+    struct SegmentMeta {
+        LogID lastId_{0};
+        TermID lastTerm_{0};
+        size_t size_{0};
+        time_t mtime_{0};
+    };
+    static constexpr const char* kSegmentMetaFile = "segments.meta";
+
+    // One line of the meta file: firstId lastId lastTerm size mtime
+    static std::string encodeSegmentMeta(const WalFileInfoPtr& info);
+    // Load the meta of the closed files, keyed by their first log id
+    std::unordered_map<LogID, SegmentMeta> loadSegmentMeta();
+    // Append the meta of the file just closed
+    void appendSegmentMeta(const WalFileInfoPtr& info);
+
+    // Implementation of appendLog(), the log is written into pending_ at first, and written
+    // into the file when flush is true or the file rolls over
     bool appendLogInternal(LogID id,
                            TermID term,
                            ClusterID cluster,
-                           std::string msg);
+                           std::string msg,
+                           bool flush = true);
+
+    // Write the pending logs into the current file with one write, and sync the file once if
+    // policy_.sync is true
+    void flushPending();
 
 
 private:
@@ -191,8 +239,14 @@ private:
     int32_t currFd_{-1};
     // The WalFileInfo corresponding to the currFd_
     WalFileInfoPtr currInfo_;
+    // The encoded logs not written into currFd_ yet, and the last one of them
+    std::string pending_;
+    LogID pendingLastId_{0};
+    TermID pendingLastTerm_{0};
 
     std::shared_ptr<AtomicLogBuffer> logBuffer_;
+    // Not null if policy_.sync and policy_.groupSync are both true
+    std::shared_ptr<WalGroupSyncer> syncer_;
 
     PreProcessor preProcessor_;
 
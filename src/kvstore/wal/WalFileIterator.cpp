@@ -8,6 +8,11 @@
 #include "kvstore/wal/FileBasedWal.h"
 #include "kvstore/wal/WalFileInfo.h"
 #include "kvstore/wal/WalFileIterator.h"
+#include <sys/mman.h>
+
+DEFINE_bool(wal_mmap_read, false,
+            "Whether to read the closed wal files by mmap, the file being written is still "
+            "read by pread");
 
 namespace nebula {
 namespace wal {
@@ -38,7 +43,8 @@ WalFileIterator::WalFileIterator(
     }
 
     // We need to read from the WAL files
-    wal_->accessAllWalInfo([this] (WalFileInfoPtr info) {
+    bool newest = true;
+    wal_->accessAllWalInfo([this, &newest] (WalFileInfoPtr info) {
         int fd = open(info->path(), O_RDONLY);
         if (fd < 0) {
             LOG(ERROR) << "Failed to open wal file \""
@@ -49,6 +55,21 @@ WalFileIterator::WalFileIterator(
             return false;
         }
         fds_.push_front(fd);
+        // Only the files before the newest one are closed, whose size won't change
+        char* map = nullptr;
+        size_t size = info->size();
+        if (FLAGS_wal_mmap_read && !newest && size > 0) {
+            auto addr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+            if (addr == MAP_FAILED) {
+                LOG(WARNING) << "Failed to mmap wal file \"" << info->path()
+                             << "\", error: " << strerror(errno);
+            } else {
+                madvise(addr, size, MADV_SEQUENTIAL);
+                map = static_cast<char*>(addr);
+            }
+        }
+        maps_.push_front(std::make_pair(map, size));
+        newest = false;
         idRanges_.push_front(std::make_pair(info->firstId(), info->lastId()));
 
         if (info->firstId() <= currId_) {
@@ -82,24 +103,17 @@ WalFileIterator::WalFileIterator(
         while (true) {
             LogID logId;
             // Read the logID
-            int fd = fds_.front();
-            CHECK_EQ(pread(fd,
-                           reinterpret_cast<char*>(&logId),
-                           sizeof(LogID),
-                           currPos_),
-                     static_cast<ssize_t>(sizeof(LogID)));
+            CHECK(readAt(reinterpret_cast<char*>(&logId),
+                         sizeof(LogID),
+                         currPos_));
             // Read the termID
-            CHECK_EQ(pread(fd,
-                           reinterpret_cast<char*>(&currTerm_),
-                           sizeof(TermID),
-                           currPos_ + sizeof(LogID)),
-                     static_cast<ssize_t>(sizeof(TermID)));
+            CHECK(readAt(reinterpret_cast<char*>(&currTerm_),
+                         sizeof(TermID),
+                         currPos_ + sizeof(LogID)));
             // Read the log length
-            CHECK_EQ(pread(fd,
-                           reinterpret_cast<char*>(&currMsgLen_),
-                           sizeof(int32_t),
-                           currPos_ + sizeof(LogID) + sizeof(TermID)),
-                     static_cast<ssize_t>(sizeof(int32_t)));
+            CHECK(readAt(reinterpret_cast<char*>(&currMsgLen_),
+                         sizeof(int32_t),
+                         currPos_ + sizeof(LogID) + sizeof(TermID)));
             if (logId == currId_) {
                 break;
             }
@@ -114,6 +128,11 @@ WalFileIterator::WalFileIterator(
 
 
 WalFileIterator::~WalFileIterator() {
+    for (auto& map : maps_) {
+        if (map.first != nullptr) {
+            munmap(map.first, map.second);
+        }
+    }
     for (auto& fd : fds_) {
         close(fd);
     }
@@ -129,6 +148,10 @@ LogIterator& WalFileIterator::operator++() {
                 << nextFirstId_
                 << ", so need to move to the next file";
         // Close the current file
+        if (maps_.front().first != nullptr) {
+            munmap(maps_.front().first, maps_.front().second);
+        }
+        maps_.pop_front();
         CHECK_EQ(close(fds_.front()), 0);
         fds_.pop_front();
         idRanges_.pop_front();
@@ -158,26 +181,19 @@ LogIterator& WalFileIterator::operator++() {
         return *this;
     } else {
         LogID logId;
-        int fd = fds_.front();
         // Read the logID
-        CHECK_EQ(pread(fd,
-                       reinterpret_cast<char*>(&logId),
-                       sizeof(LogID),
-                       currPos_),
-                 static_cast<ssize_t>(sizeof(LogID))) << "currPos = " << currPos_;
+        CHECK(readAt(reinterpret_cast<char*>(&logId),
+                     sizeof(LogID),
+                     currPos_)) << "currPos = " << currPos_;
         CHECK_EQ(currId_, logId);
         // Read the termID
-        CHECK_EQ(pread(fd,
-                       reinterpret_cast<char*>(&currTerm_),
-                       sizeof(TermID),
-                       currPos_ + sizeof(LogID)),
-                 static_cast<ssize_t>(sizeof(TermID)));
+        CHECK(readAt(reinterpret_cast<char*>(&currTerm_),
+                     sizeof(TermID),
+                     currPos_ + sizeof(LogID)));
         // Read the log length
-        CHECK_EQ(pread(fd,
-                       reinterpret_cast<char*>(&currMsgLen_),
-                       sizeof(int32_t),
-                       currPos_ + sizeof(TermID) + sizeof(LogID)),
-                 static_cast<ssize_t>(sizeof(int32_t)));
+        CHECK(readAt(reinterpret_cast<char*>(&currMsgLen_),
+                     sizeof(int32_t),
+                     currPos_ + sizeof(TermID) + sizeof(LogID)));
     }
 
     return *this;
@@ -200,17 +216,15 @@ TermID WalFileIterator::logTerm() const {
 
 
 ClusterID WalFileIterator::logSource() const {
-            // Retrieve from the file
+    // Retrieve from the file
     DCHECK(!fds_.empty());
     ClusterID cluster = 0;
-    CHECK_EQ(pread(fds_.front(),
-                   &(cluster),
-                   sizeof(ClusterID),
-                   currPos_
-                    + sizeof(LogID)
-                    + sizeof(TermID)
-                    + sizeof(int32_t)),
-             static_cast<ssize_t>(sizeof(ClusterID)))
+    CHECK(readAt(&(cluster),
+                 sizeof(ClusterID),
+                 currPos_
+                  + sizeof(LogID)
+                  + sizeof(TermID)
+                  + sizeof(int32_t)))
         << "Failed to read. Curr position is " << currPos_
         << ", expected read length is " << sizeof(ClusterID)
         << " (errno: " << errno << "): " << strerror(errno);
@@ -223,16 +237,22 @@ folly::StringPiece WalFileIterator::logMsg() const {
     // Retrieve from the file
     DCHECK(!fds_.empty());
 
+    auto pos = currPos_
+               + sizeof(LogID)
+               + sizeof(TermID)
+               + sizeof(int32_t)
+               + sizeof(ClusterID);
+    auto& map = maps_.front();
+    if (map.first != nullptr) {
+        // Point to the mapping without copying, which is valid until moving to the next file
+        CHECK_LE(pos + currMsgLen_, map.second)
+            << "Failed to read. Curr position is " << currPos_
+            << ", expected read length is " << currMsgLen_;
+        return folly::StringPiece(map.first + pos, currMsgLen_);
+    }
+
     currLog_.resize(currMsgLen_);
-    CHECK_EQ(pread(fds_.front(),
-                   &(currLog_[0]),
-                   currMsgLen_,
-                   currPos_
-                    + sizeof(LogID)
-                    + sizeof(TermID)
-                    + sizeof(int32_t)
-                    + sizeof(ClusterID)),
-             static_cast<ssize_t>(currMsgLen_))
+    CHECK(readAt(&(currLog_[0]), currMsgLen_, pos))
         << "Failed to read. Curr position is " << currPos_
         << ", expected read length is " << currMsgLen_
         << " (errno: " << errno << "): " << strerror(errno);
@@ -240,6 +260,19 @@ folly::StringPiece WalFileIterator::logMsg() const {
     return currLog_;
 }
 
+
+bool WalFileIterator::readAt(void* buf, size_t len, int64_t pos) const {
+    auto& map = maps_.front();
+    if (map.first != nullptr) {
+        if (pos + len > map.second) {
+            return false;
+        }
+        memcpy(buf, map.first + pos, len);
+        return true;
+    }
+    return pread(fds_.front(), buf, len, pos) == static_cast<ssize_t>(len);
+}
+
 LogID WalFileIterator::getFirstIdInNextFile() const {
     auto it = idRanges_.begin();
     ++it;
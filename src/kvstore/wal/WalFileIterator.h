@@ -40,6 +40,9 @@ public:
 private:
     LogID getFirstIdInNextFile() const;
 
+    // Read len bytes at pos of the current file, from the mapping of it if it is mapped
+    bool readAt(void* buf, size_t len, int64_t pos) const;
+
 private:
     // Holds the Wal object, so that it will not be destroyed before the iterator
     std::shared_ptr<FileBasedWal> wal_;
@@ -53,6 +56,9 @@ private:
     // [firstId, lastId]
     std::list<std::pair<LogID, LogID>> idRanges_;
     std::list<int> fds_;
+    // The mapping of each file in fds_ and its size, the mapping is nullptr if the file is not
+    // mapped, see FLAGS_wal_mmap_read
+    std::list<std::pair<char*, size_t>> maps_;
     int64_t currPos_{0};
     int32_t currMsgLen_{0};
     mutable std::string currLog_;
@@ -0,0 +1,72 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "kvstore/wal/WalGroupSyncer.h"
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace nebula {
+namespace wal {
+
+std::shared_ptr<WalGroupSyncer> WalGroupSyncer::get(const std::string& path) {
+    static std::mutex lock;
+    static std::unordered_map<dev_t, std::shared_ptr<WalGroupSyncer>> syncers;
+
+    struct stat st;
+    if (::stat(path.c_str(), &st) != 0) {
+        LOG(ERROR) << "Failed to stat \"" << path << "\", error: " << strerror(errno);
+        return nullptr;
+    }
+    std::lock_guard<std::mutex> lck(lock);
+    auto& syncer = syncers[st.st_dev];
+    if (!syncer) {
+        syncer = std::make_shared<WalGroupSyncer>();
+    }
+    return syncer;
+}
+
+bool WalGroupSyncer::sync(int32_t fd) {
+    bool succeeded = false;
+    std::unique_lock<std::mutex> lck(lock_);
+    pending_.emplace_back(Waiter{fd, &succeeded});
+    auto target = started_ + 1;
+    while (synced_ < target) {
+        if (syncing_) {
+            cond_.wait(lck);
+            continue;
+        }
+        syncing_ = true;
+        auto round = ++started_;
+        auto waiters = std::move(pending_);
+        pending_.clear();
+        lck.unlock();
+        std::vector<int32_t> fds;
+        fds.reserve(waiters.size());
+        for (const auto& waiter : waiters) {
+            fds.emplace_back(waiter.fd);
+        }
+        std::sort(fds.begin(), fds.end());
+        fds.erase(std::unique(fds.begin(), fds.end()), fds.end());
+        std::unordered_set<int32_t> failed;
+        for (auto waitFd : fds) {
+            if (::fdatasync(waitFd) != 0) {
+                LOG(WARNING) << "fdatasync failed, error: " << strerror(errno);
+                failed.emplace(waitFd);
+            }
+        }
+        lck.lock();
+        for (const auto& waiter : waiters) {
+            *waiter.succeeded = failed.count(waiter.fd) == 0;
+        }
+        synced_ = round;
+        syncing_ = false;
+        cond_.notify_all();
+    }
+    return succeeded;
+}
+
+}  // namespace wal
+}  // namespace nebula
@@ -0,0 +1,58 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef WAL_WALGROUPSYNCER_H_
+#define WAL_WALGROUPSYNCER_H_
+
+#include "common/base/Base.h"
+
+namespace nebula {
+namespace wal {
+
+/**
+ * WalGroupSyncer syncs the wal files of all parts on the same file system together. Instead
+ * of each part syncing its own file concurrently, the files of the callers waiting at the same
+ * time are synced in one round by fdatasync() of each of them, the same file only once. The
+ * other files on the file system, e.g. the SST files, are not flushed by the round.
+ *
+ * The first caller does the sync, the callers arriving during it wait for the next round,
+ * since the round in progress might not cover the data they just wrote.
+ * */
+class WalGroupSyncer final {
+public:
+    // The syncer of the file system where path is
+    static std::shared_ptr<WalGroupSyncer> get(const std::string& path);
+
+    // Block until the data written to fd before the call is on disk, return false if failed
+    bool sync(int32_t fd);
+
+    // The number of syncs have been done
+    uint64_t rounds() const {
+        std::lock_guard<std::mutex> lck(lock_);
+        return synced_;
+    }
+
+private:
+    struct Waiter {
+        int32_t fd;
+        // Set when the round of the waiter is done, the waiter blocks until then
+        bool* succeeded;
+    };
+
+    mutable std::mutex lock_;
+    std::condition_variable cond_;
+    bool syncing_{false};
+    // The ones to sync in the next round
+    std::vector<Waiter> pending_;
+    // The round last started and last finished
+    uint64_t started_{0};
+    uint64_t synced_{0};
+};
+
+}  // namespace wal
+}  // namespace nebula
+
+#endif  // WAL_WALGROUPSYNCER_H_
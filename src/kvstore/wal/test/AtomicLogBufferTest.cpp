@@ -53,6 +53,39 @@ TEST(AtomicLogBufferTest, OverflowTest) {
     }
 }
 
+TEST(AtomicLogBufferTest, SharedBudgetTest) {
+    // Each buffer could hold 8MB itself, but all of them share 1MB
+    AtomicLogBuffer::setTotalCapacity(1024 * 1024);
+    SCOPE_EXIT {
+        AtomicLogBuffer::setTotalCapacity(0);
+    };
+    auto before = AtomicLogBuffer::totalSize();
+    std::vector<std::shared_ptr<AtomicLogBuffer>> logBuffers;
+    for (int32_t i = 0; i < 4; i++) {
+        logBuffers.emplace_back(AtomicLogBuffer::instance());
+    }
+    // 2MB for each buffer
+    std::string msg(1024, 'A');
+    for (LogID logId = 0; logId < 2000L; logId++) {
+        for (auto& logBuffer : logBuffers) {
+            logBuffer->push(logId, Record(0, 0, msg));
+        }
+    }
+    // A buffer might exceed its share by the node being written
+    auto totalSize = AtomicLogBuffer::totalSize() - before;
+    LOG(INFO) << "Total size of log buffers " << totalSize;
+    EXPECT_GT(2 * 1024 * 1024, totalSize);
+    for (auto& logBuffer : logBuffers) {
+        EXPECT_LT(0, logBuffer->firstLogId());
+        auto iter = logBuffer->iterator(1999, 1999);
+        ASSERT_TRUE(iter->valid());
+        EXPECT_EQ(msg, iter->logMsg());
+    }
+
+    logBuffers.clear();
+    EXPECT_EQ(before, AtomicLogBuffer::totalSize());
+}
+
 TEST(AtomicLogBufferTest, SingleWriterMultiReadersTest) {
     // The default size is 100K
     auto logBuffer = AtomicLogBuffer::instance(100 * 1024);
@@ -10,6 +10,10 @@
 #include "kvstore/wal/FileBasedWal.h"
 
 DECLARE_int32(wal_ttl);
+DECLARE_bool(wal_segment_meta);
+DECLARE_int32(wal_retention_for_lagging_secs);
+DECLARE_int32(wal_ttl_for_acked_logs);
+DECLARE_int64(wal_max_bytes_per_part);
 
 namespace nebula {
 namespace wal {
@@ -133,6 +137,149 @@ TEST(FileBasedWal, CacheOverflow) {
 }
 
 
+// The logs [firstId, lastId] of term 1, which are kLongMsg
+class LongMsgIterator final : public LogIterator {
+public:
+    LongMsgIterator(LogID firstId, LogID lastId)
+        : id_(firstId)
+        , lastId_(lastId)
+        , msg_(folly::stringPrintf(kLongMsg, firstId)) {}
+
+    LogIterator& operator++() override {
+        ++id_;
+        msg_ = folly::stringPrintf(kLongMsg, id_);
+        return *this;
+    }
+
+    bool valid() const override {
+        return id_ <= lastId_;
+    }
+
+    LogID logId() const override {
+        return id_;
+    }
+
+    TermID logTerm() const override {
+        return 1;
+    }
+
+    ClusterID logSource() const override {
+        return 0;
+    }
+
+    folly::StringPiece logMsg() const override {
+        return msg_;
+    }
+
+private:
+    LogID id_;
+    LogID lastId_;
+    std::string msg_;
+};
+
+
+TEST(FileBasedWal, AppendBatchesWithPreallocate) {
+    // The logs of each batch are written and synced together, and the files are preallocated
+    FileBasedWalInfo info;
+    FileBasedWalPolicy policy;
+    policy.fileSize = 1024L * 1024L;
+    policy.bufferSize = 1024L * 1024L;
+    policy.sync = true;
+    policy.preallocate = true;
+
+    TempDir walDir("/tmp/testWal.XXXXXX");
+    auto wal = FileBasedWal::getWal(walDir.path(),
+                                    info,
+                                    policy,
+                                    [](LogID, TermID, ClusterID, const std::string&) {
+                                        return true;
+                                    });
+    // Append 100 batches of 50 logs, about 5MB in total
+    for (LogID i = 1; i <= 5000; i += 50) {
+        LongMsgIterator iter(i, i + 49);
+        ASSERT_TRUE(wal->appendLogs(iter));
+    }
+    ASSERT_EQ(5000, wal->lastLogId());
+    wal.reset();
+
+    // The preallocated space after the end of file is released when the file is closed
+    auto files = FileUtils::listAllFilesInDir(walDir.path(), true, "*.wal");
+    ASSERT_LT(1, files.size());
+    for (auto& file : files) {
+        struct stat st;
+        ASSERT_EQ(0, ::stat(file.c_str(), &st));
+        ASSERT_GE(policy.fileSize, st.st_size);
+        ASSERT_GE(st.st_size + 4096, st.st_blocks * 512);
+    }
+
+    wal = FileBasedWal::getWal(walDir.path(),
+                               info,
+                               policy,
+                               [](LogID, TermID, ClusterID, const std::string&) {
+                                   return true;
+                               });
+    EXPECT_EQ(5000, wal->lastLogId());
+    auto it = wal->iterator(1, 5000);
+    LogID id = 1;
+    while (it->valid()) {
+        ASSERT_EQ(id, it->logId());
+        ASSERT_EQ(folly::stringPrintf(kLongMsg, id), it->logMsg());
+        ++(*it);
+        ++id;
+    }
+    EXPECT_EQ(5001, id);
+}
+
+TEST(FileBasedWal, SegmentMetaTest) {
+    FLAGS_wal_segment_meta = true;
+    SCOPE_EXIT {
+        FLAGS_wal_segment_meta = false;
+    };
+    FileBasedWalInfo info;
+    FileBasedWalPolicy policy;
+    policy.fileSize = 1024L * 1024L;
+    policy.bufferSize = 1024L * 1024L;
+
+    TempDir walDir("/tmp/testWal.XXXXXX");
+    auto wal = FileBasedWal::getWal(walDir.path(),
+                                    info,
+                                    policy,
+                                    [](LogID, TermID, ClusterID, const std::string&) {
+                                        return true;
+                                    });
+    for (int i = 1; i <= 5000; i++) {
+        ASSERT_TRUE(wal->appendLog(i /*id*/, i / 1000 /*term*/, 0 /*cluster*/,
+                                   folly::stringPrintf(kLongMsg, i)));
+    }
+    wal.reset();
+    auto metaPath = FileUtils::joinPath(walDir.path(), "segments.meta");
+    ASSERT_TRUE(FileUtils::exist(metaPath));
+
+    // Open it twice, the meta file is rewritten by the first open
+    for (int32_t round = 0; round < 2; round++) {
+        wal = FileBasedWal::getWal(walDir.path(),
+                                   info,
+                                   policy,
+                                   [](LogID, TermID, ClusterID, const std::string&) {
+                                       return true;
+                                   });
+        EXPECT_EQ(1, wal->firstLogId());
+        EXPECT_EQ(5000, wal->lastLogId());
+        EXPECT_EQ(5, wal->lastLogTerm());
+        auto it = wal->iterator(1, 5000);
+        LogID id = 1;
+        while (it->valid()) {
+            ASSERT_EQ(id, it->logId());
+            ASSERT_EQ(id / 1000, it->logTerm());
+            ASSERT_EQ(folly::stringPrintf(kLongMsg, id), it->logMsg());
+            ++(*it);
+            ++id;
+        }
+        EXPECT_EQ(5001, id);
+        wal.reset();
+    }
+}
+
 TEST(FileBasedWal, Rollback) {
     // Force to make each file 1MB, each buffer is 1MB, and there are two
     // buffers at most
@@ -440,6 +587,106 @@ TEST(FileBasedWal, TTLTest) {
     }
 }
 
+TEST(FileBasedWal, KeepNeededWalTest) {
+    FLAGS_wal_ttl = 1;
+    FLAGS_wal_retention_for_lagging_secs = 3600;
+    TempDir walDir("/tmp/testWal.XXXXXX");
+    FileBasedWalInfo info;
+    FileBasedWalPolicy policy;
+    policy.bufferSize = 128;
+    policy.fileSize = 1024;
+    auto wal = FileBasedWal::getWal(walDir.path(),
+                                    info,
+                                    policy,
+                                    [](LogID, TermID, ClusterID, const std::string&) {
+                                        return true;
+                                    });
+    for (int i = 1; i <= 200; i++) {
+        EXPECT_TRUE(
+            wal->appendLog(i /*id*/, 1 /*term*/, 0 /*cluster*/,
+                           folly::stringPrintf("Test string %02d", i)));
+    }
+    auto totalFilesNum = wal->walFiles_.size();
+    ASSERT_GT(totalFilesNum, 3);
+    sleep(FLAGS_wal_ttl + 1);
+
+    // The peer has accepted up to log 100, the files after it are kept though expired
+    wal->cleanWALKeeping(100);
+    auto numFilesKept = wal->walFiles_.size();
+    EXPECT_LT(numFilesKept, totalFilesNum);
+    EXPECT_LE(wal->firstLogId(), 101);
+    auto it = wal->iterator(101, 200);
+    LogID id = 101;
+    while (it->valid()) {
+        EXPECT_EQ(id, it->logId());
+        ++(*it);
+        ++id;
+    }
+    EXPECT_EQ(201, id);
+
+    // Once the peer catches up, the expired files are removed as usual
+    wal->cleanWALKeeping(200);
+    EXPECT_EQ(2, wal->walFiles_.size());
+
+    FLAGS_wal_retention_for_lagging_secs = 0;
+}
+
+TEST(FileBasedWal, RetentionBySizeAndAckedTest) {
+    FLAGS_wal_ttl = 3600;
+    TempDir walDir("/tmp/testWal.XXXXXX");
+    FileBasedWalInfo info;
+    FileBasedWalPolicy policy;
+    policy.bufferSize = 128;
+    policy.fileSize = 1024;
+    auto wal = FileBasedWal::getWal(walDir.path(),
+                                    info,
+                                    policy,
+                                    [](LogID, TermID, ClusterID, const std::string&) {
+                                        return true;
+                                    });
+    for (int i = 1; i <= 200; i++) {
+        EXPECT_TRUE(
+            wal->appendLog(i /*id*/, 1 /*term*/, 0 /*cluster*/,
+                           folly::stringPrintf("Test string %02d", i)));
+    }
+    auto totalFilesNum = wal->walFiles_.size();
+    ASSERT_GT(totalFilesNum, 4);
+
+    // Nothing is expired
+    wal->cleanWALKeeping(200, 200);
+    EXPECT_EQ(totalFilesNum, wal->walFiles_.size());
+
+    // The files accepted by all peers up to log 100 expire earlier
+    FLAGS_wal_ttl_for_acked_logs = 1;
+    sleep(FLAGS_wal_ttl_for_acked_logs + 1);
+    wal->cleanWALKeeping(100, 100);
+    auto numFilesKept = wal->walFiles_.size();
+    EXPECT_LT(numFilesKept, totalFilesNum);
+    EXPECT_LE(wal->firstLogId(), 101);
+    auto it = wal->iterator(101, 200);
+    LogID id = 101;
+    while (it->valid()) {
+        EXPECT_EQ(id, it->logId());
+        ++(*it);
+        ++id;
+    }
+    EXPECT_EQ(201, id);
+    FLAGS_wal_ttl_for_acked_logs = 0;
+
+    // The oldest files are removed beyond the size
+    FLAGS_wal_max_bytes_per_part = 2048;
+    wal->cleanWALKeeping(100);
+    int64_t totalBytes = 0;
+    for (const auto& file : wal->walFiles_) {
+        totalBytes += file.second->size();
+    }
+    EXPECT_LT(wal->walFiles_.size(), numFilesKept);
+    EXPECT_TRUE(totalBytes <= 2048 || wal->walFiles_.size() == 2);
+    EXPECT_EQ(200, wal->lastLogId());
+    FLAGS_wal_max_bytes_per_part = 0;
+    FLAGS_wal_ttl = 14400;
+}
+
 TEST(FileBasedWal, CheckLastWalTest) {
     FileBasedWalInfo info;
     FileBasedWalPolicy policy;
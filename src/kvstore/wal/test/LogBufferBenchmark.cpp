@@ -422,6 +422,38 @@ BENCHMARK_RELATIVE(AtomicLogBufferRWMixedWriteTest) {
  ************************/
 
 
+// Write 1KB logs into the buffers of 100 parts, and report the memory footprint of them
+void runManyBuffersWriteTest(size_t iters, int64_t totalCapacity) {
+    std::vector<std::shared_ptr<AtomicLogBuffer>> logBuffers;
+    std::string msg;
+    BENCHMARK_SUSPEND {
+        AtomicLogBuffer::setTotalCapacity(totalCapacity);
+        for (int32_t i = 0; i < 100; i++) {
+            logBuffers.emplace_back(AtomicLogBuffer::instance());
+        }
+        msg.assign(1024, 'A');
+    }
+    for (size_t i = 0; i < iters; i++) {
+        logBuffers[i % logBuffers.size()]->push(i / logBuffers.size(), Record(0, 0, msg));
+    }
+    BENCHMARK_SUSPEND {
+        LOG(INFO) << iters << " logs written, total capacity " << totalCapacity
+                  << ", footprint " << AtomicLogBuffer::totalSize();
+        logBuffers.clear();
+        AtomicLogBuffer::setTotalCapacity(0);
+    }
+}
+
+BENCHMARK(ManyBuffersWriteNoTotalCapacity, iters) {
+    runManyBuffersWriteTest(iters, 0);
+}
+
+BENCHMARK_RELATIVE(ManyBuffersWriteTotalCapacity64MB, iters) {
+    runManyBuffersWriteTest(iters, 64 * 1024 * 1024);
+}
+
+BENCHMARK_DRAW_LINE();
+
 int main(int argc, char** argv) {
     folly::init(&argc, &argv, true);
     google::SetStderrLogging(google::INFO);
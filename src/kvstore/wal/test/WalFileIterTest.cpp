@@ -10,6 +10,8 @@
 #include "kvstore/wal/WalFileIterator.h"
 #include <gtest/gtest.h>
 
+DECLARE_bool(wal_mmap_read);
+
 namespace nebula {
 namespace wal {
 
@@ -111,6 +113,60 @@ TEST(WalFileIter, MultiFilesReadTest) {
 }
 
 
+TEST(WalFileIter, MmapReadTest) {
+    FLAGS_wal_mmap_read = true;
+    SCOPE_EXIT {
+        FLAGS_wal_mmap_read = false;
+    };
+    FileBasedWalInfo info;
+    FileBasedWalPolicy policy;
+    policy.fileSize = 1024;
+    TempDir walDir("/tmp/testWal.XXXXXX");
+
+    auto wal = FileBasedWal::getWal(walDir.path(),
+                                    info,
+                                    policy,
+                                    [](LogID, TermID, ClusterID, const std::string&) {
+                                        return true;
+                                    });
+    for (int i = 1; i <= 1000; i++) {
+        EXPECT_TRUE(
+            wal->appendLog(i /*id*/, 1 /*term*/, 0 /*cluster*/,
+                           folly::stringPrintf("Test string %02d", i)));
+    }
+    EXPECT_LT(10, wal->walFiles_.size());
+
+    // The closed files are read by mmap, and the last one is still read by pread
+    for (LogID start : {1, 500, 1000}) {
+        auto it = std::make_unique<WalFileIterator>(wal, start, 1000);
+        LogID id = start;
+        while (it->valid()) {
+            EXPECT_EQ(id, it->logId());
+            EXPECT_EQ(1, it->logTerm());
+            EXPECT_EQ(0, it->logSource());
+            EXPECT_EQ(folly::stringPrintf("Test string %02ld", id),
+                      it->logMsg());
+            ++(*it);
+            ++id;
+        }
+        EXPECT_EQ(1001, id);
+    }
+
+    // The logs appended after the iterator is created are not seen
+    auto it = std::make_unique<WalFileIterator>(wal, 990, 1000);
+    for (int i = 1001; i <= 1010; i++) {
+        EXPECT_TRUE(
+            wal->appendLog(i /*id*/, 1 /*term*/, 0 /*cluster*/,
+                           folly::stringPrintf("Test string %02d", i)));
+    }
+    LogID id = 990;
+    for (; it->valid(); ++(*it), ++id) {
+        EXPECT_EQ(folly::stringPrintf("Test string %02ld", id), it->logMsg());
+    }
+    EXPECT_EQ(1001, id);
+}
+
+
 }  // namespace wal
 }  // namespace nebula
 
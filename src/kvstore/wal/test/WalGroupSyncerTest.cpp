@@ -0,0 +1,95 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include "kvstore/wal/WalGroupSyncer.h"
+
+namespace nebula {
+namespace wal {
+
+TEST(WalGroupSyncer, SameFileSystem) {
+    fs::TempDir dir1("/tmp/wal_group_syncer.XXXXXX");
+    fs::TempDir dir2("/tmp/wal_group_syncer.XXXXXX");
+    auto syncer = WalGroupSyncer::get(dir1.path());
+    ASSERT_NE(nullptr, syncer);
+    ASSERT_EQ(syncer, WalGroupSyncer::get(dir2.path()));
+    ASSERT_EQ(nullptr, WalGroupSyncer::get("/not/exist/path"));
+}
+
+TEST(WalGroupSyncer, ConcurrentSync) {
+    fs::TempDir dir("/tmp/wal_group_syncer.XXXXXX");
+    auto syncer = WalGroupSyncer::get(dir.path());
+    ASSERT_NE(nullptr, syncer);
+    auto before = syncer->rounds();
+
+    const int32_t numThreads = 8;
+    const int32_t numSyncs = 100;
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < numThreads; i++) {
+        threads.emplace_back([&, i] {
+            auto path = folly::stringPrintf("%s/%d.wal", dir.path(), i);
+            auto fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_APPEND, 0644);
+            ASSERT_GE(fd, 0);
+            for (int32_t j = 0; j < numSyncs; j++) {
+                auto log = folly::stringPrintf("log %d of thread %d", j, i);
+                ASSERT_EQ(static_cast<ssize_t>(log.size()), ::write(fd, log.data(), log.size()));
+                ASSERT_TRUE(syncer->sync(fd));
+            }
+            ::close(fd);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    // Each sync is covered by one round at least, and a round covers several syncs
+    auto rounds = syncer->rounds() - before;
+    LOG(INFO) << numThreads * numSyncs << " syncs are done in " << rounds << " rounds";
+    EXPECT_LT(0, rounds);
+    EXPECT_GE(numThreads * numSyncs, rounds);
+}
+
+TEST(WalGroupSyncer, FailedSync) {
+    fs::TempDir dir("/tmp/wal_group_syncer.XXXXXX");
+    auto syncer = WalGroupSyncer::get(dir.path());
+    ASSERT_NE(nullptr, syncer);
+    auto path = folly::stringPrintf("%s/0.wal", dir.path());
+    auto fd = ::open(path.c_str(), O_CREAT | O_WRONLY | O_APPEND, 0644);
+    ASSERT_GE(fd, 0);
+
+    // only the caller of the file failed to sync gets the failure, even in the same round
+    std::atomic<int32_t> failed{0};
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < 8; i++) {
+        threads.emplace_back([&, i] {
+            for (int32_t j = 0; j < 100; j++) {
+                if (i % 2 == 0) {
+                    EXPECT_TRUE(syncer->sync(fd));
+                } else if (!syncer->sync(-1)) {
+                    failed++;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(400, failed);
+    ::close(fd);
+}
+
+}  // namespace wal
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+
+    return RUN_ALL_TESTS();
+}
@@ -7,25 +7,221 @@
 #include "meta/ActiveHostsMan.h"
 #include <thrift/lib/cpp/util/EnumUtils.h>
 #include "meta/processors/Common.h"
+#include "meta/MetaChangeLog.h"
 #include "meta/common/MetaCommon.h"
 #include "utils/Utils.h"
 
 DECLARE_int32(heartbeat_interval_secs);
 DECLARE_uint32(expired_time_factor);
 
+DEFINE_int32(heartbeat_persist_interval_secs, 0,
+             "The interval to write the host info of the heartbeats not changed into the "
+             "kvstore, 0 means it's written by every heartbeat. It should be less than "
+             "heartbeat_interval_secs * expired_time_factor");
+DEFINE_bool(active_hosts_in_memory, false,
+            "Whether the infos of the hosts are kept in memory on the meta leader, which serve "
+            "the queries of the active hosts without scanning the kvstore");
+
 namespace nebula {
 namespace meta {
 
+// static
+folly::Synchronized<std::unordered_map<HostAddr, ActiveHostsMan::Heartbeat>>&
+ActiveHostsMan::heartbeats() {
+    static folly::Synchronized<std::unordered_map<HostAddr, Heartbeat>> beats;
+    return beats;
+}
+
+void ActiveHostsMan::mergeHeartbeat(const HostAddr& host, HostInfo* info) {
+    if (FLAGS_heartbeat_persist_interval_secs <= 0) {
+        return;
+    }
+    auto beats = heartbeats().rlock();
+    auto it = beats->find(host);
+    if (it != beats->end()) {
+        info->lastHBTimeInMilliSec_ = std::max(info->lastHBTimeInMilliSec_,
+                                               it->second.info.lastHBTimeInMilliSec_);
+    }
+}
+
+void ActiveHostsMan::clearHeartbeats() {
+    heartbeats().wlock()->clear();
+}
+
+// static
+folly::Synchronized<ActiveHostsMan::Registry>& ActiveHostsMan::registry() {
+    static folly::Synchronized<Registry> reg;
+    return reg;
+}
+
+void ActiveHostsMan::resetRegistry() {
+    auto reg = registry().wlock();
+    reg->kv = nullptr;
+    reg->term = -1;
+    reg->hosts.clear();
+}
+
+TermID ActiveHostsMan::leaderTerm(kvstore::KVStore* kv) {
+    auto partRet = kv->part(kDefaultSpaceId, kDefaultPartId);
+    if (!nebula::ok(partRet)) {
+        return -1;
+    }
+    auto part = nebula::value(partRet);
+    return part->isLeader() ? part->termId() : -1;
+}
+
+ErrorOr<nebula::cpp2::ErrorCode, TermID> ActiveHostsMan::loadRegistry(kvstore::KVStore* kv) {
+    auto term = leaderTerm(kv);
+    if (term < 0) {
+        return term;
+    }
+    {
+        auto reg = registry().rlock();
+        if (reg->kv == kv && reg->term == term) {
+            return term;
+        }
+    }
+    auto reg = registry().wlock();
+    if (reg->kv == kv && reg->term == term) {
+        return term;
+    }
+    const auto& prefix = MetaServiceUtils::hostPrefix();
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto retCode = kv->prefix(kDefaultSpaceId, kDefaultPartId, prefix, &iter);
+    if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Failed to load the hosts, error "
+                   << apache::thrift::util::enumNameSafe(retCode);
+        return retCode;
+    }
+    std::unordered_map<HostAddr, HostInfo> hosts;
+    for (; iter->valid(); iter->next()) {
+        auto host = MetaServiceUtils::parseHostKey(iter->key());
+        auto info = HostInfo::decode(iter->val());
+        mergeHeartbeat(host, &info);
+        hosts.emplace(std::move(host), std::move(info));
+    }
+    LOG(INFO) << "Load " << hosts.size() << " hosts into memory in term " << term;
+    reg->kv = kv;
+    reg->term = term;
+    reg->hosts = std::move(hosts);
+    return term;
+}
+
 nebula::cpp2::ErrorCode
 ActiveHostsMan::updateHostInfo(kvstore::KVStore* kv,
                                const HostAddr& hostAddr,
                                const HostInfo& info,
                                const AllLeaders* allLeaders) {
     CHECK_NOTNULL(kv);
+    if (FLAGS_heartbeat_persist_interval_secs <= 0) {
+        auto code = doUpdateHostInfo(kv, hostAddr, info, allLeaders, true);
+        if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+            registerHost(kv, hostAddr, info);
+        }
+        return code;
+    }
+
+    // the host info is read from the leader, which is not written by raft if it's not changed
+    std::string val;
+    auto code = kv->get(kDefaultSpaceId, kDefaultPartId,
+                        MetaServiceUtils::hostKey(hostAddr.host, hostAddr.port), &val);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED &&
+        code != nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND) {
+        return code;
+    }
+    bool fresh = false;
+    AllLeaders changed;
+    {
+        auto beats = heartbeats().rlock();
+        auto it = beats->find(hostAddr);
+        if (code == nebula::cpp2::ErrorCode::SUCCEEDED && it != beats->end()) {
+            const auto& last = it->second;
+            fresh = last.info.role_ == info.role_ &&
+                    last.info.gitInfoSha_ == info.gitInfoSha_ &&
+                    last.info.version_ == info.version_ &&
+                    info.lastHBTimeInMilliSec_ - last.persistedMs <
+                        FLAGS_heartbeat_persist_interval_secs * 1000L;
+        }
+        if (fresh && allLeaders != nullptr) {
+            const auto& lastLeaders = it->second.leaders;
+            for (const auto& spaceLeaders : *allLeaders) {
+                auto spaceIt = lastLeaders.find(spaceLeaders.first);
+                for (const auto& partLeader : spaceLeaders.second) {
+                    if (spaceIt != lastLeaders.end()) {
+                        auto partIt = spaceIt->second.find(partLeader.get_part_id());
+                        if (partIt != spaceIt->second.end() &&
+                            partIt->second == partLeader.get_term()) {
+                            continue;
+                        }
+                    }
+                    changed[spaceLeaders.first].emplace_back(partLeader);
+                }
+            }
+        }
+    }
+
+    if (!fresh || !changed.empty()) {
+        code = doUpdateHostInfo(kv, hostAddr, info, fresh ? &changed : allLeaders, !fresh);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+    }
+    {
+        auto beats = heartbeats().wlock();
+        auto& beat = (*beats)[hostAddr];
+        beat.info = info;
+        if (!fresh) {
+            beat.persistedMs = info.lastHBTimeInMilliSec_;
+        }
+        if (allLeaders != nullptr) {
+            beat.leaders.clear();
+            for (const auto& spaceLeaders : *allLeaders) {
+                auto& parts = beat.leaders[spaceLeaders.first];
+                for (const auto& partLeader : spaceLeaders.second) {
+                    parts[partLeader.get_part_id()] = partLeader.get_term();
+                }
+            }
+        }
+    }
+    // the registry is locked before the heartbeats when it's loaded, so not within the lock
+    registerHost(kv, hostAddr, info);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+void ActiveHostsMan::registerHost(kvstore::KVStore* kv,
+                                  const HostAddr& hostAddr,
+                                  const HostInfo& info) {
+    if (!FLAGS_active_hosts_in_memory) {
+        return;
+    }
+    auto reg = registry().wlock();
+    if (reg->kv == kv && reg->term >= 0) {
+        reg->hosts[hostAddr] = info;
+    }
+}
+
+nebula::cpp2::ErrorCode
+ActiveHostsMan::doUpdateHostInfo(kvstore::KVStore* kv,
+                                 const HostAddr& hostAddr,
+                                 const HostInfo& info,
+                                 const AllLeaders* allLeaders,
+                                 bool writeHost) {
     std::vector<kvstore::KV> data;
     std::vector<std::string> leaderKeys;
     std::vector<int64_t> terms;
+    // The heartbeats only wait for the changes of all spaces, and for each other when the
+    // leaders of the same space are reported, since the term of a leader is checked and updated
+    // in the same lock. The host info is written by its own heartbeat only.
+    folly::SharedMutex::ReadHolder rHolder(LockUtils::spaceLock());
+    std::vector<folly::SharedMutex::WriteHolder> leaderHolders;
     if (allLeaders != nullptr) {
+        std::map<size_t, GraphSpaceID> slots;
+        for (auto& spaceLeaders : *allLeaders) {
+            slots.emplace(LockUtils::spaceLockSlot(spaceLeaders.first), spaceLeaders.first);
+        }
+        for (auto& slot : slots) {
+            leaderHolders.emplace_back(LockUtils::leaderLock(slot.second));
+        }
         for (auto& spaceLeaders : *allLeaders) {
             auto spaceId = spaceLeaders.first;
             for (auto& partLeader : spaceLeaders.second) {
@@ -63,13 +259,21 @@ ActiveHostsMan::updateHostInfo(kvstore::KVStore* kv,
     }
     // indicate whether any leader info is updated
     bool hasUpdate = false;
+    std::vector<std::string> changedKeys;
     if (!data.empty()) {
         hasUpdate = true;
+        for (auto& leader : data) {
+            changedKeys.emplace_back(leader.first);
+        }
+    }
+    if (writeHost) {
+        data.emplace_back(MetaServiceUtils::hostKey(hostAddr.host, hostAddr.port),
+                          HostInfo::encodeV2(info));
+    }
+    if (data.empty()) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
-    data.emplace_back(MetaServiceUtils::hostKey(hostAddr.host, hostAddr.port),
-                      HostInfo::encodeV2(info));
 
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::spaceLock());
     folly::Baton<true, std::atomic> baton;
     nebula::cpp2::ErrorCode ret;
     kv->asyncMultiPut(kDefaultSpaceId, kDefaultPartId, std::move(data),
@@ -78,17 +282,46 @@ ActiveHostsMan::updateHostInfo(kvstore::KVStore* kv,
         baton.post();
     });
     baton.wait();
+    leaderHolders.clear();
+    rHolder.unlock();
     if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
         return ret;
     }
     if (hasUpdate) {
-        ret = LastUpdateTimeMan::update(kv, time::WallClock::fastNowInMilliSec());
+        ret = LastUpdateTimeMan::update(kv, time::WallClock::fastNowInMilliSec(), &changedKeys);
     }
     return ret;
 }
 
 ErrorOr<nebula::cpp2::ErrorCode, std::vector<HostAddr>>
 ActiveHostsMan::getActiveHosts(kvstore::KVStore* kv, int32_t expiredTTL, cpp2::HostRole role) {
+    std::vector<HostAddr> hosts;
+    int64_t threshold = (expiredTTL == 0 ?
+                         FLAGS_heartbeat_interval_secs * FLAGS_expired_time_factor :
+                         expiredTTL) * 1000;
+    auto now = time::WallClock::fastNowInMilliSec();
+    if (FLAGS_active_hosts_in_memory) {
+        auto termRet = loadRegistry(kv);
+        if (!nebula::ok(termRet)) {
+            return nebula::error(termRet);
+        }
+        if (nebula::value(termRet) >= 0) {
+            auto reg = registry().rlock();
+            for (const auto& host : reg->hosts) {
+                if (host.second.role_ == role &&
+                    now - host.second.lastHBTimeInMilliSec_ < threshold) {
+                    hosts.emplace_back(host.first);
+                }
+            }
+            // in the order of the kvstore scanned
+            std::sort(hosts.begin(), hosts.end(), [] (const auto& a, const auto& b) {
+                return MetaServiceUtils::hostKey(a.host, a.port) <
+                       MetaServiceUtils::hostKey(b.host, b.port);
+            });
+            return hosts;
+        }
+    }
+
     const auto& prefix = MetaServiceUtils::hostPrefix();
     std::unique_ptr<kvstore::KVIterator> iter;
     auto retCode = kv->prefix(kDefaultSpaceId, kDefaultPartId, prefix, &iter);
@@ -97,15 +330,10 @@ ActiveHostsMan::getActiveHosts(kvstore::KVStore* kv, int32_t expiredTTL, cpp2::H
                    << apache::thrift::util::enumNameSafe(retCode);
         return retCode;
     }
-
-    std::vector<HostAddr> hosts;
-    int64_t threshold = (expiredTTL == 0 ?
-                         FLAGS_heartbeat_interval_secs * FLAGS_expired_time_factor :
-                         expiredTTL) * 1000;
-    auto now = time::WallClock::fastNowInMilliSec();
     while (iter->valid()) {
         auto host = MetaServiceUtils::parseHostKey(iter->key());
         HostInfo info = HostInfo::decode(iter->val());
+        mergeHeartbeat(host, &info);
         if (info.role_ == role) {
             if (now - info.lastHBTimeInMilliSec_ < threshold) {
                 hosts.emplace_back(host.host, host.port);
@@ -216,6 +444,23 @@ ActiveHostsMan::isLived(kvstore::KVStore* kv, const HostAddr& host) {
 
 ErrorOr<nebula::cpp2::ErrorCode, HostInfo>
 ActiveHostsMan::getHostInfo(kvstore::KVStore* kv, const HostAddr& host) {
+    if (FLAGS_active_hosts_in_memory) {
+        auto termRet = loadRegistry(kv);
+        if (!nebula::ok(termRet)) {
+            return nebula::error(termRet);
+        }
+        if (nebula::value(termRet) >= 0) {
+            auto reg = registry().rlock();
+            auto it = reg->hosts.find(host);
+            if (it == reg->hosts.end()) {
+                LOG(ERROR) << "Get host info " << host << " failed, error: "
+                           << apache::thrift::util::enumNameSafe(
+                                  nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND);
+                return nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND;
+            }
+            return it->second;
+        }
+    }
     auto hostKey = MetaServiceUtils::hostKey(host.host, host.port);
     std::string hostValue;
     auto retCode = kv->get(kDefaultSpaceId, kDefaultPartId, hostKey, &hostValue);
@@ -224,17 +469,31 @@ ActiveHostsMan::getHostInfo(kvstore::KVStore* kv, const HostAddr& host) {
                    << apache::thrift::util::enumNameSafe(retCode);
         return retCode;
     }
-    return HostInfo::decode(hostValue);
+    auto info = HostInfo::decode(hostValue);
+    mergeHeartbeat(host, &info);
+    return info;
 }
 
 nebula::cpp2::ErrorCode
-LastUpdateTimeMan::update(kvstore::KVStore* kv, const int64_t timeInMilliSec) {
+LastUpdateTimeMan::update(kvstore::KVStore* kv,
+                          const int64_t timeInMilliSec,
+                          const std::vector<std::string>* changedKeys) {
     CHECK_NOTNULL(kv);
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::lastUpdateTimeLock());
+    auto version = timeInMilliSec;
+    if (MetaChangeLog::enabled()) {
+        // the version of the change log only increases, even if the time is taken before the
+        // update of another processor
+        auto last = get(kv);
+        if (nebula::ok(last)) {
+            version = std::max(version, nebula::value(last) + 1);
+        }
+    }
     std::vector<kvstore::KV> data;
     data.emplace_back(MetaServiceUtils::lastUpdateTimeKey(),
-                      MetaServiceUtils::lastUpdateTimeVal(timeInMilliSec));
+                      MetaServiceUtils::lastUpdateTimeVal(version));
+    MetaChangeLog::append(version, changedKeys, &data);
 
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::lastUpdateTimeLock());
     folly::Baton<true, std::atomic> baton;
     nebula::cpp2::ErrorCode ret;
     kv->asyncMultiPut(kDefaultSpaceId, kDefaultPartId, std::move(data),
@@ -243,6 +502,10 @@ LastUpdateTimeMan::update(kvstore::KVStore* kv, const int64_t timeInMilliSec) {
         baton.post();
     });
     baton.wait();
+    if (ret == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        MetaChangeLog::written(version);
+        MetaChangeLog::trim(kv, version);
+    }
     return ret;
 }
 
@@ -8,6 +8,7 @@
 #define META_ACTIVEHOSTSMAN_H_
 
 #include "common/base/Base.h"
+#include <folly/Synchronized.h>
 #include <gtest/gtest_prod.h>
 #include "kvstore/KVStore.h"
 #include "meta/MetaServiceUtils.h"
@@ -126,6 +127,21 @@ struct HostInfo {
     }
 };
 
+/*
+When heartbeat_persist_interval_secs > 0, the heartbeat time of a host is kept in memory on the
+meta leader, and the host info is only written into the kvstore if it's changed or it has not
+been written for the interval. The readers of the host info take the later heartbeat time of the
+memory and the kvstore, so the interval should be less than the expired time of the hosts, a new
+meta leader knows the hosts alive by the time written last.
+
+The leaders reported by a host are kept in memory too, only those changed since the last
+heartbeat are checked and written. All of them are checked again when the host info is written.
+
+When active_hosts_in_memory is set, the infos of all hosts are kept in a registry on the meta
+leader, which serves getActiveHosts and getHostInfo without scanning the kvstore. The registry
+is loaded from the kvstore by the first query in each term of the meta leader, and kept by the
+heartbeats since.
+*/
 class ActiveHostsMan final {
 public:
     ~ActiveHostsMan() = default;
@@ -137,6 +153,15 @@ public:
                    const HostInfo& info,
                    const AllLeaders* leaderParts = nullptr);
 
+    // Take the heartbeat time kept in memory if it's later than that of info
+    static void mergeHeartbeat(const HostAddr& host, HostInfo* info);
+
+    // Forget the heartbeats kept in memory
+    static void clearHeartbeats();
+
+    // Drop the registry of the hosts, which is loaded again by the next query
+    static void resetRegistry();
+
     static ErrorOr<nebula::cpp2::ErrorCode, std::vector<HostAddr>>
     getActiveHosts(kvstore::KVStore* kv,
                    int32_t expiredTTL = 0,
@@ -165,15 +190,54 @@ public:
 
 protected:
     ActiveHostsMan() = default;
-};
+
+private:
+    struct Heartbeat {
+        HostInfo    info;
+        // the time the host info was written into the kvstore
+        int64_t     persistedMs{0};
+        // the terms of the parts reported by the last heartbeat
+        std::unordered_map<GraphSpaceID, std::unordered_map<PartitionID, TermID>> leaders;
+    };
+
+    struct Registry {
+        const kvstore::KVStore*                 kv{nullptr};
+        // the term of the meta leader the registry is loaded in, -1 if not loaded
+        TermID                                  term{-1};
+        std::unordered_map<HostAddr, HostInfo>  hosts;
+    };
+
+    static folly::Synchronized<std::unordered_map<HostAddr, Heartbeat>>& heartbeats();
+
+    static folly::Synchronized<Registry>& registry();
+
+    // The term of the meta leader, -1 if it's not the leader
+    static TermID leaderTerm(kvstore::KVStore* kv);
+
+    // Load the registry from the kvstore if it's not loaded in the term of the meta leader,
+    // return the term, or -1 if it's not the leader and the registry could not be used
+    static ErrorOr<nebula::cpp2::ErrorCode, TermID> loadRegistry(kvstore::KVStore* kv);
+
+    // Keep the info written of the host in the registry if it's loaded
+    static void registerHost(kvstore::KVStore* kv, const HostAddr& hostAddr, const HostInfo& info);
+
+    static nebula::cpp2::ErrorCode
+    doUpdateHostInfo(kvstore::KVStore* kv,
+                     const HostAddr& hostAddr,
+                     const HostInfo& info,
+                     const AllLeaders* allLeaders,
+                     bool writeHost);
 
 
 class LastUpdateTimeMan final {
 public:
     ~LastUpdateTimeMan() = default;
 
+    // The keys changed are logged by MetaChangeLog, all tables are changed if it's nullptr
     static nebula::cpp2::ErrorCode
-    update(kvstore::KVStore* kv, const int64_t timeInMilliSec);
+    update(kvstore::KVStore* kv,
+           const int64_t timeInMilliSec,
+           const std::vector<std::string>* changedKeys = nullptr);
 
     static ErrorOr<nebula::cpp2::ErrorCode, int64_t> get(kvstore::KVStore* kv);
 
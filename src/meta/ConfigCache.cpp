@@ -0,0 +1,91 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "meta/ConfigCache.h"
+#include "meta/MetaServiceUtils.h"
+#include "meta/processors/Common.h"
+
+DEFINE_bool(enable_config_cache, false,
+            "Serve the configs listed from the items decoded in memory on the meta leader");
+
+namespace nebula {
+namespace meta {
+
+// static
+folly::Synchronized<ConfigCache::Entry>& ConfigCache::entry() {
+    static folly::Synchronized<Entry> cached;
+    return cached;
+}
+
+// static
+TermID ConfigCache::leaderTerm(kvstore::KVStore* kv) {
+    auto partRet = kv->part(kDefaultSpaceId, kDefaultPartId);
+    if (!nebula::ok(partRet)) {
+        return -1;
+    }
+    auto part = nebula::value(partRet);
+    return part->isLeader() ? part->termId() : -1;
+}
+
+// static
+ErrorOr<nebula::cpp2::ErrorCode, ConfigCache::Items>
+ConfigCache::items(kvstore::KVStore* kv, cpp2::ConfigModule module) {
+    auto term = leaderTerm(kv);
+    std::shared_ptr<const Items> all;
+    if (term >= 0) {
+        auto cached = entry().rlock();
+        if (cached->term == term) {
+            all = cached->items;
+        }
+    }
+    if (all == nullptr) {
+        auto prefix = MetaServiceUtils::configKeyPrefix(cpp2::ConfigModule::ALL);
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto code = kv->prefix(kDefaultSpaceId, kDefaultPartId, prefix, &iter);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+        all = std::make_shared<const Items>(loadItems(iter.get()));
+        if (term >= 0) {
+            auto cached = entry().wlock();
+            cached->term = term;
+            cached->items = all;
+        }
+    }
+    if (module == cpp2::ConfigModule::ALL) {
+        return *all;
+    }
+    Items items;
+    for (const auto& item : *all) {
+        if (item.get_module() == module) {
+            items.emplace_back(item);
+        }
+    }
+    return items;
+}
+
+// static
+void ConfigCache::invalidate() {
+    auto cached = entry().wlock();
+    cached->term = -1;
+    cached->items.reset();
+}
+
+// static
+ConfigCache::Items ConfigCache::loadItems(kvstore::KVIterator* iter) {
+    Items items;
+    for (; iter->valid(); iter->next()) {
+        auto item = MetaServiceUtils::parseConfigValue(iter->val());
+        auto configName = MetaServiceUtils::parseConfigKey(iter->key());
+        item.set_module(configName.first);
+        item.set_name(configName.second);
+        items.emplace_back(std::move(item));
+    }
+    return items;
+}
+
+}  // namespace meta
+}  // namespace nebula
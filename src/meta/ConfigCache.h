@@ -0,0 +1,64 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef META_CONFIGCACHE_H_
+#define META_CONFIGCACHE_H_
+
+#include "common/base/Base.h"
+#include "common/base/ErrorOr.h"
+#include "common/interface/gen-cpp2/meta_types.h"
+#include "kvstore/KVStore.h"
+#include <folly/Synchronized.h>
+
+DECLARE_bool(enable_config_cache);
+
+namespace nebula {
+namespace meta {
+
+/*
+ConfigCache keeps the config items of all modules decoded on the meta leader when
+enable_config_cache is set, so ListConfigs, which every daemon polls periodically, is served from
+memory instead of scanning and decoding the configs out of the kvstore on every call.
+
+The items are loaded the first time they are listed in a term of the meta leader, by the
+processor holding the config lock. The processors registering or setting the configs invalidate
+the cache with the write lock held, before the change is written.
+*/
+class ConfigCache final {
+public:
+    using Items = std::vector<cpp2::ConfigItem>;
+
+    static bool enabled() {
+        return FLAGS_enable_config_cache;
+    }
+
+    // The items of the module, or of all modules if it's ALL, in the order of their keys
+    static ErrorOr<nebula::cpp2::ErrorCode, Items>
+    items(kvstore::KVStore* kv, cpp2::ConfigModule module);
+
+    static void invalidate();
+
+    static Items loadItems(kvstore::KVIterator* iter);
+
+private:
+    struct Entry {
+        // the term they are loaded in, -1 if not loaded
+        TermID                          term{-1};
+        std::shared_ptr<const Items>    items;
+    };
+
+    static folly::Synchronized<Entry>& entry();
+
+    // The term of the meta leader, -1 if it's not the leader
+    static TermID leaderTerm(kvstore::KVStore* kv);
+
+    ConfigCache() = delete;
+};
+
+}  // namespace meta
+}  // namespace nebula
+
+#endif  // META_CONFIGCACHE_H_
@@ -0,0 +1,97 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "meta/IndexCache.h"
+#include "meta/MetaServiceUtils.h"
+#include "meta/processors/Common.h"
+
+DEFINE_bool(enable_index_cache, false,
+            "Find the indexes of a tag or an edge from the indexes grouped by schema in memory "
+            "on the meta leader");
+
+namespace nebula {
+namespace meta {
+
+// static
+folly::Synchronized<std::unordered_map<GraphSpaceID, IndexCache::Entry>>&
+IndexCache::entries() {
+    static folly::Synchronized<std::unordered_map<GraphSpaceID, Entry>> cached;
+    return cached;
+}
+
+// static
+TermID IndexCache::leaderTerm(kvstore::KVStore* kv) {
+    auto partRet = kv->part(kDefaultSpaceId, kDefaultPartId);
+    if (!nebula::ok(partRet)) {
+        return -1;
+    }
+    auto part = nebula::value(partRet);
+    return part->isLeader() ? part->termId() : -1;
+}
+
+// static
+ErrorOr<nebula::cpp2::ErrorCode, std::shared_ptr<const IndexCache::Indexes>>
+IndexCache::indexes(kvstore::KVStore* kv, GraphSpaceID spaceId, int32_t tagOrEdge) {
+    static const auto kNone = std::make_shared<const Indexes>();
+    auto find = [tagOrEdge] (const Entry& entry) {
+        auto it = entry.bySchema.find(tagOrEdge);
+        return it == entry.bySchema.end() ? kNone : it->second;
+    };
+    auto term = leaderTerm(kv);
+    if (term >= 0) {
+        auto cached = entries().rlock();
+        auto it = cached->find(spaceId);
+        if (it != cached->end() && it->second.term == term) {
+            return find(it->second);
+        }
+    }
+
+    // the processors changing the indexes of the space are not writing meanwhile
+    folly::SharedMutex::ReadHolder tagHolder(LockUtils::tagIndexLock(spaceId));
+    folly::SharedMutex::ReadHolder edgeHolder(LockUtils::edgeIndexLock(spaceId));
+    auto prefix = MetaServiceUtils::indexPrefix(spaceId);
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto code = kv->prefix(kDefaultSpaceId, kDefaultPartId, prefix, &iter);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    Entry entry;
+    entry.term = term;
+    entry.bySchema = loadIndexes(iter.get());
+    auto indexes = find(entry);
+    if (term >= 0) {
+        (*entries().wlock())[spaceId] = std::move(entry);
+    }
+    return indexes;
+}
+
+// static
+void IndexCache::invalidate(GraphSpaceID spaceId) {
+    entries().wlock()->erase(spaceId);
+}
+
+// static
+std::unordered_map<int32_t, std::shared_ptr<const IndexCache::Indexes>>
+IndexCache::loadIndexes(kvstore::KVIterator* iter) {
+    std::unordered_map<int32_t, Indexes> bySchema;
+    for (; iter->valid(); iter->next()) {
+        auto item = MetaServiceUtils::parseIndex(iter->val());
+        const auto& schemaId = item.get_schema_id();
+        if (schemaId.getType() == cpp2::SchemaID::Type::tag_id) {
+            bySchema[schemaId.get_tag_id()].emplace_back(std::move(item));
+        } else if (schemaId.getType() == cpp2::SchemaID::Type::edge_type) {
+            bySchema[schemaId.get_edge_type()].emplace_back(std::move(item));
+        }
+    }
+    std::unordered_map<int32_t, std::shared_ptr<const Indexes>> indexes;
+    for (auto& schema : bySchema) {
+        indexes.emplace(schema.first, std::make_shared<const Indexes>(std::move(schema.second)));
+    }
+    return indexes;
+}
+
+}  // namespace meta
+}  // namespace nebula
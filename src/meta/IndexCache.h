@@ -0,0 +1,68 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef META_INDEXCACHE_H_
+#define META_INDEXCACHE_H_
+
+#include "common/base/Base.h"
+#include "common/base/ErrorOr.h"
+#include "common/interface/gen-cpp2/meta_types.h"
+#include "kvstore/KVStore.h"
+#include <folly/Synchronized.h>
+
+DECLARE_bool(enable_index_cache);
+
+namespace nebula {
+namespace meta {
+
+/*
+IndexCache keeps the indexes of each space decoded on the meta leader when enable_index_cache is
+set, grouped by the tag or the edge they are on, so finding the indexes of a schema, which
+AlterTag, DropTag, AlterEdge and DropEdge do, costs the indexes of the schema instead of scanning
+and decoding all indexes of the space.
+
+The indexes of a space are loaded the first time they are read in a term of the meta leader,
+holding the read locks of the tag and the edge indexes of the space. The processors creating or
+dropping the indexes invalidate the cache with the write lock held, before the change is written.
+*/
+class IndexCache final {
+public:
+    using Indexes = std::vector<cpp2::IndexItem>;
+
+    static bool enabled() {
+        return FLAGS_enable_index_cache;
+    }
+
+    // The indexes on the tag or the edge of the space, in the order of their keys. An index of a
+    // tag with the id and an index of an edge with the type are both taken, as getIndexes does.
+    static ErrorOr<nebula::cpp2::ErrorCode, std::shared_ptr<const Indexes>>
+    indexes(kvstore::KVStore* kv, GraphSpaceID spaceId, int32_t tagOrEdge);
+
+    static void invalidate(GraphSpaceID spaceId);
+
+    // The indexes by the tag id or the edge type they are on
+    static std::unordered_map<int32_t, std::shared_ptr<const Indexes>>
+    loadIndexes(kvstore::KVIterator* iter);
+
+private:
+    struct Entry {
+        // the term they are loaded in, -1 if not loaded
+        TermID                                                      term{-1};
+        std::unordered_map<int32_t, std::shared_ptr<const Indexes>> bySchema;
+    };
+
+    static folly::Synchronized<std::unordered_map<GraphSpaceID, Entry>>& entries();
+
+    // The term of the meta leader, -1 if it's not the leader
+    static TermID leaderTerm(kvstore::KVStore* kv);
+
+    IndexCache() = delete;
+};
+
+}  // namespace meta
+}  // namespace nebula
+
+#endif  // META_INDEXCACHE_H_
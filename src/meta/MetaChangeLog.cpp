@@ -0,0 +1,168 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "meta/MetaChangeLog.h"
+#include <thrift/lib/cpp/util/EnumUtils.h>
+#include "meta/MetaServiceUtils.h"
+#include "meta/processors/Common.h"
+
+DEFINE_int32(meta_change_log_retention_secs, 0,
+             "How long the log of the meta changes is kept for the clients to sync the changes "
+             "since the version they have loaded, 0 means the log is off");
+
+namespace nebula {
+namespace meta {
+
+namespace {
+
+constexpr int64_t kTrimIntervalMs = 60 * 1000;
+
+std::atomic<int64_t> gSeq{0};
+std::atomic<int64_t> gLastTrimMs{0};
+std::atomic<int64_t> gLastWritten{0};
+
+}  // namespace
+
+// static
+void MetaChangeLog::append(int64_t version,
+                           const std::vector<std::string>* keys,
+                           std::vector<kvstore::KV>* data) {
+    if (!enabled()) {
+        return;
+    }
+    std::set<std::pair<std::string, GraphSpaceID>> tables;
+    if (keys == nullptr) {
+        tables.emplace(kAllTables, -1);
+    } else {
+        for (const auto& key : *keys) {
+            auto table = MetaServiceUtils::parseTableAndSpace(key);
+            if (table.first.empty()) {
+                table.first = kAllTables;
+            } else if (table.first == "last_update_time" || table.first == "change_log") {
+                continue;
+            }
+            tables.emplace(std::move(table));
+        }
+    }
+    if (tables.empty()) {
+        return;
+    }
+    std::vector<Change> changes;
+    changes.reserve(tables.size());
+    for (auto& table : tables) {
+        Change change;
+        change.version = version;
+        change.table = table.first;
+        change.space = table.second;
+        changes.emplace_back(std::move(change));
+    }
+    data->emplace_back(MetaServiceUtils::changeLogKey(version, gSeq++), encode(changes));
+}
+
+// static
+ErrorOr<nebula::cpp2::ErrorCode, std::vector<MetaChangeLog::Change>>
+MetaChangeLog::changesSince(kvstore::KVStore* kv, int64_t version, bool* complete) {
+    const auto& prefix = MetaServiceUtils::changeLogPrefix();
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto code = kv->prefix(kDefaultSpaceId, kDefaultPartId, prefix, &iter);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Get the meta change log failed, error "
+                   << apache::thrift::util::enumNameSafe(code);
+        return code;
+    }
+    // the logs are trimmed from the oldest
+    *complete = iter->valid() && MetaServiceUtils::parseChangeLogVersion(iter->key()) <= version;
+
+    std::vector<Change> changes;
+    code = kv->rangeWithPrefix(kDefaultSpaceId, kDefaultPartId,
+                               MetaServiceUtils::changeLogKey(version + 1, 0), prefix, &iter);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Get the meta change log failed, error "
+                   << apache::thrift::util::enumNameSafe(code);
+        return code;
+    }
+    for (; iter->valid(); iter->next()) {
+        auto logVersion = MetaServiceUtils::parseChangeLogVersion(iter->key());
+        if (!decode(logVersion, iter->val(), &changes)) {
+            LOG(ERROR) << "Invalid meta change log of version " << logVersion;
+            return nebula::cpp2::ErrorCode::E_INVALID_PARM;
+        }
+    }
+    return changes;
+}
+
+// static
+void MetaChangeLog::written(int64_t version) {
+    auto last = gLastWritten.load();
+    while (last < version && !gLastWritten.compare_exchange_weak(last, version)) {
+    }
+}
+
+// static
+int64_t MetaChangeLog::lastWritten() {
+    return gLastWritten.load();
+}
+
+// static
+void MetaChangeLog::trim(kvstore::KVStore* kv, int64_t now) {
+    if (!enabled()) {
+        return;
+    }
+    auto last = gLastTrimMs.load();
+    if (now - last < kTrimIntervalMs || !gLastTrimMs.compare_exchange_strong(last, now)) {
+        return;
+    }
+    auto expired = now - static_cast<int64_t>(FLAGS_meta_change_log_retention_secs) * 1000;
+    kv->asyncRemoveRange(kDefaultSpaceId,
+                         kDefaultPartId,
+                         MetaServiceUtils::changeLogKey(0, 0),
+                         MetaServiceUtils::changeLogKey(expired, 0),
+                         [] (nebula::cpp2::ErrorCode code) {
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(WARNING) << "Trim the meta change log failed, error "
+                         << apache::thrift::util::enumNameSafe(code);
+        }
+    });
+}
+
+// static
+std::string MetaChangeLog::encode(const std::vector<Change>& changes) {
+    std::string val;
+    for (const auto& change : changes) {
+        auto size = static_cast<int32_t>(change.table.size());
+        val.append(reinterpret_cast<const char*>(&change.space), sizeof(GraphSpaceID))
+           .append(reinterpret_cast<const char*>(&size), sizeof(int32_t))
+           .append(change.table);
+    }
+    return val;
+}
+
+// static
+bool MetaChangeLog::decode(int64_t version,
+                           folly::StringPiece val,
+                           std::vector<Change>* changes) {
+    while (!val.empty()) {
+        if (val.size() < sizeof(GraphSpaceID) + sizeof(int32_t)) {
+            return false;
+        }
+        Change change;
+        change.version = version;
+        change.space = *reinterpret_cast<const GraphSpaceID*>(val.data());
+        val.advance(sizeof(GraphSpaceID));
+        auto size = *reinterpret_cast<const int32_t*>(val.data());
+        val.advance(sizeof(int32_t));
+        if (size < 0 || val.size() < static_cast<size_t>(size)) {
+            return false;
+        }
+        change.table = val.subpiece(0, size).str();
+        val.advance(size);
+        changes->emplace_back(std::move(change));
+    }
+    return true;
+}
+
+}  // namespace meta
+}  // namespace nebula
@@ -0,0 +1,75 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef META_METACHANGELOG_H_
+#define META_METACHANGELOG_H_
+
+#include "common/base/Base.h"
+#include "common/base/ErrorOr.h"
+#include "kvstore/KVStore.h"
+
+DECLARE_int32(meta_change_log_retention_secs);
+
+namespace nebula {
+namespace meta {
+
+/*
+MetaChangeLog is the log of the tables of each space changed by every meta update, which is
+written with the last update time in the same batch when meta_change_log_retention_secs > 0.
+The last update time is the version of the log, so a client which has loaded the meta of a
+version could only reload the tables changed since then, instead of all of them.
+
+The logs older than the retention are trimmed. The changes since a version are complete only if
+the log of the version, or an older one, is still kept; the client should reload all otherwise.
+*/
+class MetaChangeLog final {
+public:
+    // The table of the change which could not be told, everything should be reloaded
+    static constexpr const char* kAllTables = "*";
+
+    struct Change {
+        int64_t         version{0};
+        // the name in MetaServiceUtils, such as "tags" or "parts"
+        std::string     table;
+        // -1 if the table is not of a space
+        GraphSpaceID    space{-1};
+    };
+
+    static bool enabled() {
+        return FLAGS_meta_change_log_retention_secs > 0;
+    }
+
+    // Add the log of the keys changed at version into data, of all tables if keys is nullptr
+    static void append(int64_t version,
+                       const std::vector<std::string>* keys,
+                       std::vector<kvstore::KV>* data);
+
+    // The changes after version, complete is set if none of them has been trimmed
+    static ErrorOr<nebula::cpp2::ErrorCode, std::vector<Change>>
+    changesSince(kvstore::KVStore* kv, int64_t version, bool* complete);
+
+    // Remove the logs older than the retention, at most once a minute
+    static void trim(kvstore::KVStore* kv, int64_t now);
+
+    // Keep the version of the change written last by this meta in memory, which is checked by
+    // the clients waiting for the changes instead of reading the log
+    static void written(int64_t version);
+
+    // The version of the change written last by this meta since it started, 0 if none
+    static int64_t lastWritten();
+
+    static std::string encode(const std::vector<Change>& changes);
+
+    static bool decode(int64_t version, folly::StringPiece val, std::vector<Change>* changes);
+
+private:
+    MetaChangeLog() = delete;
+};
+
+}  // namespace meta
+}  // namespace nebula
+
+#endif  // META_METACHANGELOG_H_
@@ -0,0 +1,180 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "meta/MetaHttpChangesHandler.h"
+#include "meta/ActiveHostsMan.h"
+#include "meta/MetaChangeLog.h"
+#include "common/time/WallClock.h"
+#include "common/webservice/Common.h"
+#include <folly/io/async/EventBaseManager.h>
+#include <folly/json.h>
+#include <thrift/lib/cpp/util/EnumUtils.h>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <proxygen/lib/http/ProxygenErrorEnum.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+
+DEFINE_int32(meta_changes_max_wait_ms, 30000,
+             "The longest time a request of the meta changes waits for a change to be written");
+
+namespace nebula {
+namespace meta {
+
+using proxygen::HTTPMessage;
+using proxygen::HTTPMethod;
+using proxygen::ProxygenError;
+using proxygen::UpgradeProtocol;
+using proxygen::ResponseBuilder;
+
+void MetaHttpChangesHandler::init(nebula::kvstore::KVStore *kvstore) {
+    kvstore_ = kvstore;
+    CHECK_NOTNULL(kvstore_);
+}
+
+void MetaHttpChangesHandler::onRequest(std::unique_ptr<HTTPMessage> headers) noexcept {
+    if (headers->getMethod().value() != HTTPMethod::GET) {
+        err_ = HttpCode::E_UNSUPPORTED_METHOD;
+        return;
+    }
+    if (!MetaChangeLog::enabled()) {
+        err_ = HttpCode::E_UNPROCESSABLE;
+        errMsg_ = "meta change log is off";
+        return;
+    }
+    if (!headers->hasQueryParam("since")) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        errMsg_ = "miss argument [since]";
+        return;
+    }
+    auto since = folly::tryTo<int64_t>(headers->getQueryParam("since"));
+    if (!since.hasValue()) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        errMsg_ = "invalid argument [since]";
+        return;
+    }
+    since_ = since.value();
+    if (headers->hasQueryParam("wait_ms")) {
+        auto waitMs = folly::tryTo<int64_t>(headers->getQueryParam("wait_ms"));
+        if (!waitMs.hasValue() || waitMs.value() < 0) {
+            err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+            errMsg_ = "invalid argument [wait_ms]";
+            return;
+        }
+        waitMs_ = std::min<int64_t>(waitMs.value(), FLAGS_meta_changes_max_wait_ms);
+    }
+}
+
+void MetaHttpChangesHandler::onBody(std::unique_ptr<folly::IOBuf>) noexcept {
+    // Do nothing, we only support GET
+}
+
+void MetaHttpChangesHandler::onEOM() noexcept {
+    switch (err_) {
+        case HttpCode::E_UNSUPPORTED_METHOD:
+            ResponseBuilder(downstream_)
+                .status(WebServiceUtils::to(HttpStatusCode::METHOD_NOT_ALLOWED),
+                        WebServiceUtils::toString(HttpStatusCode::METHOD_NOT_ALLOWED))
+                .sendWithEOM();
+            return;
+        case HttpCode::E_ILLEGAL_ARGUMENT:
+            ResponseBuilder(downstream_)
+                .status(WebServiceUtils::to(HttpStatusCode::BAD_REQUEST), errMsg_)
+                .sendWithEOM();
+            return;
+        case HttpCode::E_UNPROCESSABLE:
+            ResponseBuilder(downstream_)
+                .status(WebServiceUtils::to(HttpStatusCode::FORBIDDEN),
+                        WebServiceUtils::toString(HttpStatusCode::FORBIDDEN))
+                .body(errMsg_)
+                .sendWithEOM();
+            return;
+        default:
+            break;
+    }
+
+    auto ret = changes(since_);
+    if (waitMs_ > 0 && nebula::ok(ret) && nebula::value(ret)["changes"].empty()) {
+        evb_ = folly::EventBaseManager::get()->getExistingEventBase();
+        if (evb_ != nullptr) {
+            waiting_ = true;
+            waitSince_ = std::max(since_, nebula::value(ret)["version"].asInt());
+            deadlineMs_ = time::WallClock::fastNowInMilliSec() + waitMs_;
+            evb_->runAfterDelay([this] { waitForChanges(); }, kWaitIntervalMs);
+            return;
+        }
+    }
+    respond(std::move(ret));
+}
+
+void MetaHttpChangesHandler::waitForChanges() {
+    if (aborted_) {
+        delete this;
+        return;
+    }
+    if (MetaChangeLog::lastWritten() <= waitSince_ &&
+        time::WallClock::fastNowInMilliSec() < deadlineMs_) {
+        evb_->runAfterDelay([this] { waitForChanges(); }, kWaitIntervalMs);
+        return;
+    }
+    waiting_ = false;
+    respond(changes(since_));
+}
+
+void MetaHttpChangesHandler::respond(ErrorOr<nebula::cpp2::ErrorCode, folly::dynamic> ret) {
+    if (!nebula::ok(ret)) {
+        ResponseBuilder(downstream_)
+            .status(WebServiceUtils::to(HttpStatusCode::FORBIDDEN),
+                    WebServiceUtils::toString(HttpStatusCode::FORBIDDEN))
+            .body(apache::thrift::util::enumNameSafe(nebula::error(ret)))
+            .sendWithEOM();
+        return;
+    }
+    ResponseBuilder(downstream_)
+        .status(WebServiceUtils::to(HttpStatusCode::OK),
+                WebServiceUtils::toString(HttpStatusCode::OK))
+        .body(folly::toJson(nebula::value(ret)))
+        .sendWithEOM();
+}
+
+void MetaHttpChangesHandler::onUpgrade(UpgradeProtocol) noexcept {
+    // Do nothing
+}
+
+void MetaHttpChangesHandler::requestComplete() noexcept {
+    delete this;
+}
+
+void MetaHttpChangesHandler::onError(ProxygenError error) noexcept {
+    LOG(ERROR) << "Web Service MetaHttpChangesHandler got error : "
+               << proxygen::getErrorString(error);
+    if (waiting_) {
+        aborted_ = true;
+    }
+}
+
+ErrorOr<nebula::cpp2::ErrorCode, folly::dynamic> MetaHttpChangesHandler::changes(int64_t since) {
+    // the log of a version is written with it, so the logs up to the version got are all there
+    auto version = LastUpdateTimeMan::get(kvstore_);
+    if (!nebula::ok(version)) {
+        return nebula::error(version);
+    }
+    bool complete = false;
+    auto changesRet = MetaChangeLog::changesSince(kvstore_, since, &complete);
+    if (!nebula::ok(changesRet)) {
+        return nebula::error(changesRet);
+    }
+    auto changes = folly::dynamic::array();
+    for (auto& change : nebula::value(changesRet)) {
+        changes.push_back(folly::dynamic::object("version", change.version)
+                                                ("table", change.table)
+                                                ("space", change.space));
+    }
+    return folly::dynamic::object("version", nebula::value(version))
+                                 ("complete", complete)
+                                 ("changes", std::move(changes));
+}
+
+}  // namespace meta
+}  // namespace nebula
@@ -0,0 +1,78 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef META_METAHTTPCHANGESHANDLER_H_
+#define META_METAHTTPCHANGESHANDLER_H_
+
+#include "common/base/Base.h"
+#include "common/webservice/Common.h"
+#include "kvstore/KVStore.h"
+#include <folly/io/async/EventBase.h>
+#include <proxygen/httpserver/RequestHandler.h>
+
+namespace nebula {
+namespace meta {
+
+using nebula::HttpCode;
+
+/*
+Serve "/changes?since=<version>", the tables changed after the version in MetaChangeLog, as
+{"version": <last update time>, "complete": <bool>, "changes": [{"version", "table", "space"}]}.
+A client should reload all the meta if it's not complete, and take the greatest version of the
+response as the version it has loaded.
+
+With "&wait_ms=<ms>", the request is held until a change after the version is written by this
+meta, or the wait (at most meta_changes_max_wait_ms) is over, if there is none yet. So a client
+polling the meta leader again right after each response gets the changes, e.g. of the configs,
+as soon as they are written, while a quiet cluster costs a request per wait.
+*/
+class MetaHttpChangesHandler : public proxygen::RequestHandler {
+public:
+    MetaHttpChangesHandler() = default;
+
+    void init(nebula::kvstore::KVStore *kvstore);
+
+    void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers) noexcept override;
+
+    void onBody(std::unique_ptr<folly::IOBuf> body) noexcept override;
+
+    void onEOM() noexcept override;
+
+    void onUpgrade(proxygen::UpgradeProtocol protocol) noexcept override;
+
+    void requestComplete() noexcept override;
+
+    void onError(proxygen::ProxygenError error) noexcept override;
+
+    ErrorOr<nebula::cpp2::ErrorCode, folly::dynamic> changes(int64_t since);
+
+private:
+    void respond(ErrorOr<nebula::cpp2::ErrorCode, folly::dynamic> ret);
+
+    // Check for the changes every kWaitIntervalMs on the event base of the request
+    void waitForChanges();
+
+    static constexpr int64_t kWaitIntervalMs = 100;
+
+    HttpCode err_{HttpCode::SUCCEEDED};
+    std::string errMsg_;
+    int64_t since_{0};
+    int64_t waitMs_{0};
+    nebula::kvstore::KVStore *kvstore_;
+
+    folly::EventBase* evb_{nullptr};
+    // the version the changes are waited after, and the time the wait is over
+    int64_t waitSince_{0};
+    int64_t deadlineMs_{0};
+    bool waiting_{false};
+    // the request failed while waiting, the handler is deleted by the wait
+    bool aborted_{false};
+};
+
+}  // namespace meta
+}  // namespace nebula
+
+#endif  // META_METAHTTPCHANGESHANDLER_H_
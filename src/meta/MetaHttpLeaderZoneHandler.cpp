@@ -0,0 +1,140 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "meta/MetaHttpLeaderZoneHandler.h"
+#include "meta/processors/Common.h"
+#include "common/webservice/Common.h"
+#include <thrift/lib/cpp/util/EnumUtils.h>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <proxygen/lib/http/ProxygenErrorEnum.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+
+namespace nebula {
+namespace meta {
+
+using proxygen::HTTPMessage;
+using proxygen::HTTPMethod;
+using proxygen::ProxygenError;
+using proxygen::UpgradeProtocol;
+using proxygen::ResponseBuilder;
+
+void MetaHttpLeaderZoneHandler::init(nebula::kvstore::KVStore *kvstore) {
+    kvstore_ = kvstore;
+    CHECK_NOTNULL(kvstore_);
+}
+
+void MetaHttpLeaderZoneHandler::onRequest(std::unique_ptr<HTTPMessage> headers) noexcept {
+    if (headers->getMethod().value() != HTTPMethod::GET) {
+        err_ = HttpCode::E_UNSUPPORTED_METHOD;
+        return;
+    }
+    if (!headers->hasQueryParam("space")) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        errMsg_ = "miss argument [space]";
+        return;
+    }
+    auto spaceRet = folly::tryTo<GraphSpaceID>(headers->getQueryParam("space"));
+    if (!spaceRet.hasValue()) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        errMsg_ = "invalid argument [space]";
+        LOG(ERROR) << errMsg_;
+        return;
+    }
+    spaceId_ = spaceRet.value();
+    if (headers->hasQueryParam("zone")) {
+        zone_ = headers->getQueryParam("zone");
+    }
+}
+
+void MetaHttpLeaderZoneHandler::onBody(std::unique_ptr<folly::IOBuf>) noexcept {
+    // Do nothing, we only support GET
+}
+
+void MetaHttpLeaderZoneHandler::onEOM() noexcept {
+    switch (err_) {
+        case HttpCode::E_UNSUPPORTED_METHOD:
+            ResponseBuilder(downstream_)
+                .status(WebServiceUtils::to(HttpStatusCode::METHOD_NOT_ALLOWED),
+                        WebServiceUtils::toString(HttpStatusCode::METHOD_NOT_ALLOWED))
+                .sendWithEOM();
+            return;
+        case HttpCode::E_ILLEGAL_ARGUMENT:
+            ResponseBuilder(downstream_)
+                .status(WebServiceUtils::to(HttpStatusCode::BAD_REQUEST), errMsg_)
+                .sendWithEOM();
+            return;
+        default:
+            break;
+    }
+
+    auto code = saveLeaderZone(spaceId_, zone_);
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        ResponseBuilder(downstream_)
+            .status(WebServiceUtils::to(HttpStatusCode::OK),
+                    WebServiceUtils::toString(HttpStatusCode::OK))
+            .sendWithEOM();
+    } else {
+        ResponseBuilder(downstream_)
+            .status(WebServiceUtils::to(HttpStatusCode::FORBIDDEN),
+                    WebServiceUtils::toString(HttpStatusCode::FORBIDDEN))
+            .body(apache::thrift::util::enumNameSafe(code))
+            .sendWithEOM();
+    }
+}
+
+void MetaHttpLeaderZoneHandler::onUpgrade(UpgradeProtocol) noexcept {
+    // Do nothing
+}
+
+void MetaHttpLeaderZoneHandler::requestComplete() noexcept {
+    delete this;
+}
+
+void MetaHttpLeaderZoneHandler::onError(ProxygenError error) noexcept {
+    LOG(ERROR) << "Web Service MetaHttpLeaderZoneHandler got error : "
+               << proxygen::getErrorString(error);
+}
+
+nebula::cpp2::ErrorCode MetaHttpLeaderZoneHandler::saveLeaderZone(GraphSpaceID spaceId,
+                                                                  const std::string& zone) {
+    std::string val;
+    auto code = kvstore_->get(kDefaultSpaceId, kDefaultPartId,
+                              MetaServiceUtils::spaceKey(spaceId), &val);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code == nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND
+             ? nebula::cpp2::ErrorCode::E_SPACE_NOT_FOUND
+             : code;
+    }
+
+    folly::Baton<true, std::atomic> baton;
+    auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
+    auto callback = [&] (nebula::cpp2::ErrorCode result) {
+        ret = result;
+        baton.post();
+    };
+    if (zone.empty()) {
+        LOG(INFO) << "Clear the leader zone of space " << spaceId;
+        kvstore_->asyncRemove(kDefaultSpaceId, kDefaultPartId,
+                              MetaServiceUtils::leaderZoneKey(spaceId), callback);
+    } else {
+        code = kvstore_->get(kDefaultSpaceId, kDefaultPartId,
+                             MetaServiceUtils::zoneKey(zone), &val);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code == nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND
+                 ? nebula::cpp2::ErrorCode::E_ZONE_NOT_FOUND
+                 : code;
+        }
+        LOG(INFO) << "Set the leader zone of space " << spaceId << " to " << zone;
+        std::vector<kvstore::KV> data;
+        data.emplace_back(MetaServiceUtils::leaderZoneKey(spaceId), zone);
+        kvstore_->asyncMultiPut(kDefaultSpaceId, kDefaultPartId, std::move(data), callback);
+    }
+    baton.wait();
+    return ret;
+}
+
+}  // namespace meta
+}  // namespace nebula
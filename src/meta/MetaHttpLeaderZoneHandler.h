@@ -0,0 +1,57 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef META_METAHTTPLEADERZONEHANDLER_H_
+#define META_METAHTTPLEADERZONEHANDLER_H_
+
+#include "common/base/Base.h"
+#include "common/webservice/Common.h"
+#include "kvstore/KVStore.h"
+#include "meta/MetaServiceUtils.h"
+#include <proxygen/httpserver/RequestHandler.h>
+
+namespace nebula {
+namespace meta {
+
+using nebula::HttpCode;
+
+/*
+Serve "/leader-zone?space=<id>&zone=<name>", which sets the zone preferred by the leaders of the
+space, the leader balance keeps the leaders of the parts with a peer in the zone there. The zone
+preferred is cleared if no zone is given.
+*/
+class MetaHttpLeaderZoneHandler : public proxygen::RequestHandler {
+public:
+    MetaHttpLeaderZoneHandler() = default;
+
+    void init(nebula::kvstore::KVStore *kvstore);
+
+    void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers) noexcept override;
+
+    void onBody(std::unique_ptr<folly::IOBuf> body) noexcept override;
+
+    void onEOM() noexcept override;
+
+    void onUpgrade(proxygen::UpgradeProtocol protocol) noexcept override;
+
+    void requestComplete() noexcept override;
+
+    void onError(proxygen::ProxygenError error) noexcept override;
+
+    nebula::cpp2::ErrorCode saveLeaderZone(GraphSpaceID spaceId, const std::string& zone);
+
+private:
+    HttpCode err_{HttpCode::SUCCEEDED};
+    std::string errMsg_;
+    GraphSpaceID spaceId_{0};
+    std::string zone_;
+    nebula::kvstore::KVStore *kvstore_;
+};
+
+}  // namespace meta
+}  // namespace nebula
+
+#endif  // META_METAHTTPLEADERZONEHANDLER_H_
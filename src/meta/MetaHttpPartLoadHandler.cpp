@@ -0,0 +1,126 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "meta/MetaHttpPartLoadHandler.h"
+#include "meta/processors/Common.h"
+#include "common/webservice/Common.h"
+#include <thrift/lib/cpp/util/EnumUtils.h>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <proxygen/lib/http/ProxygenErrorEnum.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+
+namespace nebula {
+namespace meta {
+
+using proxygen::HTTPMessage;
+using proxygen::HTTPMethod;
+using proxygen::ProxygenError;
+using proxygen::UpgradeProtocol;
+using proxygen::ResponseBuilder;
+
+void MetaHttpPartLoadHandler::init(nebula::kvstore::KVStore *kvstore) {
+    kvstore_ = kvstore;
+    CHECK_NOTNULL(kvstore_);
+}
+
+void MetaHttpPartLoadHandler::onRequest(std::unique_ptr<HTTPMessage> headers) noexcept {
+    if (headers->getMethod().value() != HTTPMethod::GET) {
+        err_ = HttpCode::E_UNSUPPORTED_METHOD;
+        return;
+    }
+    if (!headers->hasQueryParam("space") || !headers->hasQueryParam("part")) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        errMsg_ = "miss argument [space] or [part]";
+        return;
+    }
+    auto param = [&] (const char* name, auto* value) {
+        if (!headers->hasQueryParam(name)) {
+            return true;
+        }
+        auto ret = folly::tryTo<std::decay_t<decltype(*value)>>(headers->getQueryParam(name));
+        if (!ret.hasValue() || ret.value() < 0) {
+            err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+            errMsg_ = folly::stringPrintf("invalid argument [%s]", name);
+            return false;
+        }
+        *value = ret.value();
+        return true;
+    };
+    if (!param("space", &spaceId_) || !param("part", &partId_) ||
+        !param("bytes", &load_.bytes) || !param("read_qps", &load_.readQps) ||
+        !param("write_qps", &load_.writeQps) || !param("cpu", &load_.cpu)) {
+        LOG(ERROR) << errMsg_;
+    }
+}
+
+void MetaHttpPartLoadHandler::onBody(std::unique_ptr<folly::IOBuf>) noexcept {
+    // Do nothing, we only support GET
+}
+
+void MetaHttpPartLoadHandler::onEOM() noexcept {
+    switch (err_) {
+        case HttpCode::E_UNSUPPORTED_METHOD:
+            ResponseBuilder(downstream_)
+                .status(WebServiceUtils::to(HttpStatusCode::METHOD_NOT_ALLOWED),
+                        WebServiceUtils::toString(HttpStatusCode::METHOD_NOT_ALLOWED))
+                .sendWithEOM();
+            return;
+        case HttpCode::E_ILLEGAL_ARGUMENT:
+            ResponseBuilder(downstream_)
+                .status(WebServiceUtils::to(HttpStatusCode::BAD_REQUEST), errMsg_)
+                .sendWithEOM();
+            return;
+        default:
+            break;
+    }
+
+    auto code = saveLoad(spaceId_, partId_, load_);
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        ResponseBuilder(downstream_)
+            .status(WebServiceUtils::to(HttpStatusCode::OK),
+                    WebServiceUtils::toString(HttpStatusCode::OK))
+            .sendWithEOM();
+    } else {
+        ResponseBuilder(downstream_)
+            .status(WebServiceUtils::to(HttpStatusCode::FORBIDDEN),
+                    WebServiceUtils::toString(HttpStatusCode::FORBIDDEN))
+            .body(apache::thrift::util::enumNameSafe(code))
+            .sendWithEOM();
+    }
+}
+
+void MetaHttpPartLoadHandler::onUpgrade(UpgradeProtocol) noexcept {
+    // Do nothing
+}
+
+void MetaHttpPartLoadHandler::requestComplete() noexcept {
+    delete this;
+}
+
+void MetaHttpPartLoadHandler::onError(ProxygenError error) noexcept {
+    LOG(ERROR) << "Web Service MetaHttpPartLoadHandler got error : "
+               << proxygen::getErrorString(error);
+}
+
+nebula::cpp2::ErrorCode MetaHttpPartLoadHandler::saveLoad(GraphSpaceID spaceId,
+                                                         PartitionID partId,
+                                                         PartLoad load) {
+    std::vector<kvstore::KV> data;
+    data.emplace_back(MetaServiceUtils::partLoadKey(spaceId, partId),
+                      MetaServiceUtils::partLoadVal(load));
+    folly::Baton<true, std::atomic> baton;
+    auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
+    kvstore_->asyncMultiPut(kDefaultSpaceId, kDefaultPartId, std::move(data),
+                            [&] (nebula::cpp2::ErrorCode code) {
+        ret = code;
+        baton.post();
+    });
+    baton.wait();
+    return ret;
+}
+
+}  // namespace meta
+}  // namespace nebula
@@ -0,0 +1,57 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef META_METAHTTPPARTLOADHANDLER_H_
+#define META_METAHTTPPARTLOADHANDLER_H_
+
+#include "common/base/Base.h"
+#include "common/webservice/Common.h"
+#include "kvstore/KVStore.h"
+#include "meta/MetaServiceUtils.h"
+#include <proxygen/httpserver/RequestHandler.h>
+
+namespace nebula {
+namespace meta {
+
+using nebula::HttpCode;
+
+/*
+Serve "/part-load?space=<id>&part=<id>&bytes=<n>&read_qps=<n>&write_qps=<n>&cpu=<n>", which
+records the load of a replica of the part for the balance by load, the loads not given are 0.
+*/
+class MetaHttpPartLoadHandler : public proxygen::RequestHandler {
+public:
+    MetaHttpPartLoadHandler() = default;
+
+    void init(nebula::kvstore::KVStore *kvstore);
+
+    void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers) noexcept override;
+
+    void onBody(std::unique_ptr<folly::IOBuf> body) noexcept override;
+
+    void onEOM() noexcept override;
+
+    void onUpgrade(proxygen::UpgradeProtocol protocol) noexcept override;
+
+    void requestComplete() noexcept override;
+
+    void onError(proxygen::ProxygenError error) noexcept override;
+
+    nebula::cpp2::ErrorCode saveLoad(GraphSpaceID spaceId, PartitionID partId, PartLoad load);
+
+private:
+    HttpCode err_{HttpCode::SUCCEEDED};
+    std::string errMsg_;
+    GraphSpaceID spaceId_{0};
+    PartitionID partId_{0};
+    PartLoad load_;
+    nebula::kvstore::KVStore *kvstore_;
+};
+
+}  // namespace meta
+}  // namespace nebula
+
+#endif  // META_METAHTTPPARTLOADHANDLER_H_
@@ -0,0 +1,279 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "meta/MetaHttpSplitPartsHandler.h"
+#include "meta/ActiveHostsMan.h"
+#include "meta/processors/Common.h"
+#include "common/webservice/Common.h"
+#include "common/http/HttpClient.h"
+#include "common/time/WallClock.h"
+#include <thrift/lib/cpp/util/EnumUtils.h>
+#include <proxygen/httpserver/RequestHandler.h>
+#include <proxygen/lib/http/ProxygenErrorEnum.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+
+DEFINE_int32(split_parts_timeout_secs, 3600,
+             "The seconds a step of a split of the parts waits for all the replicas");
+DECLARE_int32(ws_storage_http_port);
+
+namespace nebula {
+namespace meta {
+
+using proxygen::HTTPMessage;
+using proxygen::HTTPMethod;
+using proxygen::ProxygenError;
+using proxygen::UpgradeProtocol;
+using proxygen::ResponseBuilder;
+
+namespace {
+
+// only one split runs at a time
+std::atomic<bool> splitting{false};
+
+int32_t statusRank(const std::string& status) {
+    static const std::unordered_map<std::string, int32_t> kRanks = {
+        {"FROZEN", 1},
+        {"COPYING", 2},
+        {"COPIED", 3},
+        {"CLEANED", 4},
+    };
+    auto it = kRanks.find(status);
+    return it == kRanks.end() ? 0 : it->second;
+}
+
+}  // namespace
+
+void MetaHttpSplitPartsHandler::init(nebula::kvstore::KVStore *kvstore) {
+    kvstore_ = kvstore;
+    CHECK_NOTNULL(kvstore_);
+}
+
+void MetaHttpSplitPartsHandler::onRequest(std::unique_ptr<HTTPMessage> headers) noexcept {
+    if (headers->getMethod().value() != HTTPMethod::GET) {
+        err_ = HttpCode::E_UNSUPPORTED_METHOD;
+        return;
+    }
+    if (!headers->hasQueryParam("space")) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        errMsg_ = "miss argument [space]";
+        return;
+    }
+    auto spaceRet = folly::tryTo<GraphSpaceID>(headers->getQueryParam("space"));
+    if (!spaceRet.hasValue()) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        errMsg_ = "invalid argument [space]";
+        LOG(ERROR) << errMsg_;
+        return;
+    }
+    spaceId_ = spaceRet.value();
+}
+
+void MetaHttpSplitPartsHandler::onBody(std::unique_ptr<folly::IOBuf>) noexcept {
+    // Do nothing, we only support GET
+}
+
+void MetaHttpSplitPartsHandler::onEOM() noexcept {
+    switch (err_) {
+        case HttpCode::E_UNSUPPORTED_METHOD:
+            ResponseBuilder(downstream_)
+                .status(WebServiceUtils::to(HttpStatusCode::METHOD_NOT_ALLOWED),
+                        WebServiceUtils::toString(HttpStatusCode::METHOD_NOT_ALLOWED))
+                .sendWithEOM();
+            return;
+        case HttpCode::E_ILLEGAL_ARGUMENT:
+            ResponseBuilder(downstream_)
+                .status(WebServiceUtils::to(HttpStatusCode::BAD_REQUEST), errMsg_)
+                .sendWithEOM();
+            return;
+        default:
+            break;
+    }
+
+    bool expected = false;
+    auto code = nebula::cpp2::ErrorCode::E_CONFLICT;
+    if (splitting.compare_exchange_strong(expected, true)) {
+        code = splitParts(spaceId_);
+        splitting = false;
+    }
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        ResponseBuilder(downstream_)
+            .status(WebServiceUtils::to(HttpStatusCode::OK),
+                    WebServiceUtils::toString(HttpStatusCode::OK))
+            .body(folly::stringPrintf("Split %d parts into %d", parts_, parts_ * 2))
+            .sendWithEOM();
+    } else {
+        ResponseBuilder(downstream_)
+            .status(WebServiceUtils::to(HttpStatusCode::FORBIDDEN),
+                    WebServiceUtils::toString(HttpStatusCode::FORBIDDEN))
+            .body(apache::thrift::util::enumNameSafe(code))
+            .sendWithEOM();
+    }
+}
+
+void MetaHttpSplitPartsHandler::onUpgrade(UpgradeProtocol) noexcept {
+    // Do nothing
+}
+
+void MetaHttpSplitPartsHandler::requestComplete() noexcept {
+    delete this;
+}
+
+void MetaHttpSplitPartsHandler::onError(ProxygenError error) noexcept {
+    LOG(ERROR) << "Web Service MetaHttpSplitPartsHandler got error : "
+               << proxygen::getErrorString(error);
+}
+
+nebula::cpp2::ErrorCode MetaHttpSplitPartsHandler::splitParts(GraphSpaceID spaceId) {
+    auto spaceKey = MetaServiceUtils::spaceKey(spaceId);
+    cpp2::SpaceDesc properties;
+    {
+        folly::SharedMutex::ReadHolder rHolder(LockUtils::spaceLock());
+        std::string val;
+        auto code = kvstore_->get(kDefaultSpaceId, kDefaultPartId, spaceKey, &val);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code == nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND
+                 ? nebula::cpp2::ErrorCode::E_SPACE_NOT_FOUND
+                 : code;
+        }
+        properties = MetaServiceUtils::parseSpace(val);
+        parts_ = properties.get_partition_num();
+        for (PartitionID partId = 1; partId <= parts_; partId++) {
+            code = kvstore_->get(kDefaultSpaceId, kDefaultPartId,
+                                 MetaServiceUtils::partKey(spaceId, partId), &val);
+            if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                LOG(ERROR) << "Get part " << partId << " of space " << spaceId << " failed";
+                return code;
+            }
+            peers_[partId] = MetaServiceUtils::parsePartVal(val);
+        }
+    }
+    LOG(INFO) << "Split the " << parts_ << " parts of space " << spaceId;
+
+    if (!runStep({"freeze"}, "FROZEN")) {
+        return nebula::cpp2::ErrorCode::E_RPC_FAILURE;
+    }
+    auto code = addParts();
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    // the replicas copy once the parts added are loaded by the storaged
+    if (!runStep({"copy", "copied"}, "COPIED")) {
+        return nebula::cpp2::ErrorCode::E_RPC_FAILURE;
+    }
+    properties.set_partition_num(parts_ * 2);
+    code = updateSpace(spaceKey, std::move(properties));
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    // the keys left are only some space wasted, "/split?op=cleanup" of storaged removes them
+    if (!runStep({"cleanup"}, "CLEANED")) {
+        LOG(ERROR) << "Remove the keys moved of space " << spaceId << " failed";
+        return nebula::cpp2::ErrorCode::E_RPC_FAILURE;
+    }
+    LOG(INFO) << "Split the " << parts_ << " parts of space " << spaceId << " successfully";
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+bool MetaHttpSplitPartsHandler::runStep(const std::vector<std::string>& ops,
+                                        const std::string& status) {
+    std::set<std::string> hosts;
+    for (auto& entry : peers_) {
+        for (auto& peer : entry.second) {
+            hosts.emplace(peer.host);
+        }
+    }
+    auto target = statusRank(status);
+    auto deadline = time::WallClock::fastNowInSec() + FLAGS_split_parts_timeout_secs;
+    while (true) {
+        // the status of each part on each host after the last op
+        std::unordered_map<std::string, std::unordered_map<PartitionID, int32_t>> reported;
+        for (auto& op : ops) {
+            for (auto& host : hosts) {
+                auto url = folly::stringPrintf("http://%s:%d/split?space=%d&parts=%d&op=%s",
+                                               host.c_str(), FLAGS_ws_storage_http_port,
+                                               spaceId_, parts_, op.c_str());
+                auto resp = nebula::http::HttpClient::get(url);
+                folly::dynamic parsed;
+                try {
+                    parsed = resp.ok() ? folly::parseJson(resp.value()) : folly::dynamic();
+                } catch (const std::exception&) {
+                    // not json, the step failed on the host
+                }
+                if (!parsed.isObject()) {
+                    LOG(ERROR) << "Split step " << op << " on " << host << " failed: "
+                               << (resp.ok() ? resp.value() : resp.status().toString());
+                    continue;
+                }
+                auto& partStatus = reported[host];
+                for (auto& item : parsed.items()) {
+                    partStatus[folly::to<PartitionID>(item.first.asString())] =
+                        statusRank(item.second.asString());
+                }
+            }
+        }
+        size_t left = 0;
+        for (auto& entry : peers_) {
+            for (auto& peer : entry.second) {
+                auto& partStatus = reported[peer.host];
+                auto it = partStatus.find(entry.first);
+                if (it == partStatus.end() || it->second < target) {
+                    left++;
+                }
+            }
+        }
+        if (left == 0) {
+            LOG(INFO) << "All replicas of space " << spaceId_ << " are " << status;
+            return true;
+        }
+        if (time::WallClock::fastNowInSec() > deadline) {
+            LOG(ERROR) << left << " replicas of space " << spaceId_ << " are not " << status
+                       << " in " << FLAGS_split_parts_timeout_secs << " seconds";
+            return false;
+        }
+        VLOG(1) << left << " replicas of space " << spaceId_ << " are not " << status;
+        sleep(1);
+    }
+}
+
+nebula::cpp2::ErrorCode MetaHttpSplitPartsHandler::addParts() {
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::spaceLock());
+    std::vector<kvstore::KV> data;
+    for (auto& entry : peers_) {
+        data.emplace_back(MetaServiceUtils::partKey(spaceId_, entry.first + parts_),
+                          MetaServiceUtils::partVal(entry.second));
+    }
+    LOG(INFO) << "Add the parts " << parts_ + 1 << " to " << parts_ * 2 << " of space "
+              << spaceId_;
+    return put(std::move(data));
+}
+
+nebula::cpp2::ErrorCode MetaHttpSplitPartsHandler::updateSpace(const std::string& key,
+                                                               cpp2::SpaceDesc properties) {
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::spaceLock());
+    std::vector<kvstore::KV> data;
+    data.emplace_back(key, MetaServiceUtils::spaceVal(properties));
+    LOG(INFO) << "Switch space " << spaceId_ << " to " << properties.get_partition_num()
+              << " parts";
+    return put(std::move(data));
+}
+
+nebula::cpp2::ErrorCode MetaHttpSplitPartsHandler::put(std::vector<kvstore::KV> data) {
+    folly::Baton<true, std::atomic> baton;
+    auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
+    kvstore_->asyncMultiPut(kDefaultSpaceId, kDefaultPartId, std::move(data),
+                            [&] (nebula::cpp2::ErrorCode result) {
+        ret = result;
+        baton.post();
+    });
+    baton.wait();
+    if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return ret;
+    }
+    return LastUpdateTimeMan::update(kvstore_, time::WallClock::fastNowInMilliSec());
+}
+
+}  // namespace meta
+}  // namespace nebula
@@ -0,0 +1,77 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef META_METAHTTPSPLITPARTSHANDLER_H_
+#define META_METAHTTPSPLITPARTSHANDLER_H_
+
+#include "common/base/Base.h"
+#include "common/webservice/Common.h"
+#include "kvstore/KVStore.h"
+#include "meta/MetaServiceUtils.h"
+#include <proxygen/httpserver/RequestHandler.h>
+
+namespace nebula {
+namespace meta {
+
+using nebula::HttpCode;
+
+/*
+Serve "/split-parts?space=<id>", which doubles the parts of the space online. Part p is split
+into p and p + n, n is the number of parts before, see kvstore::PartSplit for a split on the
+storaged. The steps are run on the storaged by their "/split" in order:
+  1. freeze the writes of the keys moved of all the parts
+  2. add the parts n + 1 to 2n, part p + n has the same peers as p
+  3. copy the keys moved into the parts added on all the replicas
+  4. switch the space to 2n parts, the clients route the vids moved to the parts added
+  5. remove the keys moved from the parts before
+A step is retried until all the replicas are done or split_parts_timeout_secs passes, and the
+split could be resumed by requesting it again if it fails before step 4.
+*/
+class MetaHttpSplitPartsHandler : public proxygen::RequestHandler {
+public:
+    MetaHttpSplitPartsHandler() = default;
+
+    void init(nebula::kvstore::KVStore *kvstore);
+
+    void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers) noexcept override;
+
+    void onBody(std::unique_ptr<folly::IOBuf> body) noexcept override;
+
+    void onEOM() noexcept override;
+
+    void onUpgrade(proxygen::UpgradeProtocol protocol) noexcept override;
+
+    void requestComplete() noexcept override;
+
+    void onError(proxygen::ProxygenError error) noexcept override;
+
+    nebula::cpp2::ErrorCode splitParts(GraphSpaceID spaceId);
+
+private:
+    // Request the ops on the storaged in turn, until every replica of the parts split reaches
+    // the status
+    bool runStep(const std::vector<std::string>& ops, const std::string& status);
+
+    nebula::cpp2::ErrorCode addParts();
+
+    nebula::cpp2::ErrorCode updateSpace(const std::string& key, cpp2::SpaceDesc properties);
+
+    nebula::cpp2::ErrorCode put(std::vector<kvstore::KV> data);
+
+private:
+    HttpCode err_{HttpCode::SUCCEEDED};
+    std::string errMsg_;
+    GraphSpaceID spaceId_{0};
+    // the number of parts before the split
+    int32_t parts_{0};
+    std::map<PartitionID, std::vector<HostAddr>> peers_;
+    nebula::kvstore::KVStore *kvstore_;
+};
+
+}  // namespace meta
+}  // namespace nebula
+
+#endif  // META_METAHTTPSPLITPARTSHANDLER_H_
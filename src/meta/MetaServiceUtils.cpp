@@ -5,6 +5,7 @@
  */
 
 #include "meta/MetaServiceUtils.h"
+#include <folly/lang/Bits.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
 #include <thrift/lib/cpp2/protocol/CompactProtocol.h>
 #include <thrift/lib/cpp2/protocol/Serializer.h>
@@ -48,7 +49,10 @@ static const std::unordered_map<
         {"statis", {"__statis__", MetaServiceUtils::parseStatisSpace}},
         {"balance_task", {"__balance_task__", nullptr}},
         {"balance_plan", {"__balance_plan__", nullptr}},
-        {"ft_index", {"__ft_index__", nullptr}}};
+        {"ft_index", {"__ft_index__", nullptr}},
+        {"change_log", {"__change_log__", nullptr}},
+        {"part_load", {"__part_load__", nullptr}},
+        {"leader_zone", {"__leader_zone__", nullptr}}};
 
 static const std::string kSpacesTable         = tableMaps.at("spaces").first;         // NOLINT
 static const std::string kPartsTable          = tableMaps.at("parts").first;          // NOLINT
@@ -79,6 +83,9 @@ static const std::string kBalancePlanTable    = tableMaps.at("balance_plan").fir
 const std::string kFTIndexTable        = tableMaps.at("ft_index").first;         // NOLINT
 const std::string kFTServiceTable = systemTableMaps.at("ft_service").first;      // NOLINT
 const std::string kSessionsTable = systemTableMaps.at("sessions").first;         // NOLINT
+static const std::string kChangeLogTable     = tableMaps.at("change_log").first;       // NOLINT
+static const std::string kPartLoadTable      = tableMaps.at("part_load").first;        // NOLINT
+static const std::string kLeaderZoneTable    = tableMaps.at("leader_zone").first;      // NOLINT
 
 const int kMaxIpAddrLen = 15;   // '255.255.255.255'
 
@@ -118,6 +125,58 @@ std::string MetaServiceUtils::lastUpdateTimeVal(const int64_t timeInMilliSec) {
     return val;
 }
 
+std::string MetaServiceUtils::changeLogKey(int64_t version, int64_t seq) {
+    // big endian, so the logs are ordered by version
+    auto bigVersion = folly::Endian::big(version);
+    auto bigSeq = folly::Endian::big(seq);
+    std::string key;
+    key.reserve(kChangeLogTable.size() + sizeof(int64_t) * 2);
+    key.append(kChangeLogTable.data(), kChangeLogTable.size())
+       .append(reinterpret_cast<const char*>(&bigVersion), sizeof(int64_t))
+       .append(reinterpret_cast<const char*>(&bigSeq), sizeof(int64_t));
+    return key;
+}
+
+const std::string& MetaServiceUtils::changeLogPrefix() {
+    return kChangeLogTable;
+}
+
+int64_t MetaServiceUtils::parseChangeLogVersion(folly::StringPiece key) {
+    auto version = *reinterpret_cast<const int64_t*>(key.data() + kChangeLogTable.size());
+    return folly::Endian::big(version);
+}
+
+std::pair<std::string, GraphSpaceID>
+MetaServiceUtils::parseTableAndSpace(folly::StringPiece key) {
+    for (const auto& table : systemTableMaps) {
+        if (key.startsWith(table.second.first)) {
+            return {table.first, -1};
+        }
+    }
+    const std::string* name = nullptr;
+    size_t length = 0;
+    for (const auto& table : tableMaps) {
+        const auto& prefix = table.second.first;
+        if (prefix.size() > length && key.startsWith(prefix)) {
+            name = &table.first;
+            length = prefix.size();
+        }
+    }
+    if (name == nullptr) {
+        return {"", -1};
+    }
+    // the tables of a space skipped by backup
+    const auto& entry = tableMaps.at(*name);
+    if (entry.first == kIndexTable) {
+        return {*name, parseIndexKeySpaceID(key)};
+    } else if (entry.first == kLeaderTermsTable) {
+        return {*name, parseLeaderKeyV3(key).first};
+    } else if (entry.second == nullptr) {
+        return {*name, -1};
+    }
+    return {*name, entry.second(key)};
+}
+
 std::string MetaServiceUtils::spaceKey(GraphSpaceID spaceId) {
     std::string key;
     key.reserve(kSpacesTable.size() + sizeof(GraphSpaceID));
@@ -1358,6 +1417,59 @@ const std::string& MetaServiceUtils::statisKeyPrefix() {
     return kStatisTable;
 }
 
+std::string MetaServiceUtils::partLoadKey(GraphSpaceID spaceId, PartitionID partId) {
+    std::string key;
+    key.reserve(kPartLoadTable.size() + sizeof(GraphSpaceID) + sizeof(PartitionID));
+    key.append(kPartLoadTable.data(), kPartLoadTable.size())
+       .append(reinterpret_cast<const char*>(&spaceId), sizeof(GraphSpaceID))
+       .append(reinterpret_cast<const char*>(&partId), sizeof(PartitionID));
+    return key;
+}
+
+std::string MetaServiceUtils::partLoadVal(const PartLoad& load) {
+    std::string val;
+    val.reserve(sizeof(int64_t) * 4);
+    val.append(reinterpret_cast<const char*>(&load.bytes), sizeof(int64_t))
+       .append(reinterpret_cast<const char*>(&load.readQps), sizeof(int64_t))
+       .append(reinterpret_cast<const char*>(&load.writeQps), sizeof(int64_t))
+       .append(reinterpret_cast<const char*>(&load.cpu), sizeof(int64_t));
+    return val;
+}
+
+std::string MetaServiceUtils::partLoadPrefix(GraphSpaceID spaceId) {
+    std::string prefix;
+    prefix.reserve(kPartLoadTable.size() + sizeof(GraphSpaceID));
+    prefix.append(kPartLoadTable.data(), kPartLoadTable.size())
+          .append(reinterpret_cast<const char*>(&spaceId), sizeof(GraphSpaceID));
+    return prefix;
+}
+
+PartitionID MetaServiceUtils::parsePartLoadPart(folly::StringPiece rawData) {
+    auto offset = kPartLoadTable.size() + sizeof(GraphSpaceID);
+    return *reinterpret_cast<const PartitionID*>(rawData.data() + offset);
+}
+
+PartLoad MetaServiceUtils::parsePartLoadVal(folly::StringPiece rawData) {
+    PartLoad load;
+    if (rawData.size() < sizeof(int64_t) * 4) {
+        return load;
+    }
+    auto* data = reinterpret_cast<const int64_t*>(rawData.data());
+    load.bytes = data[0];
+    load.readQps = data[1];
+    load.writeQps = data[2];
+    load.cpu = data[3];
+    return load;
+}
+
+std::string MetaServiceUtils::leaderZoneKey(GraphSpaceID spaceId) {
+    std::string key;
+    key.reserve(kLeaderZoneTable.size() + sizeof(GraphSpaceID));
+    key.append(kLeaderZoneTable.data(), kLeaderZoneTable.size())
+       .append(reinterpret_cast<const char*>(&spaceId), sizeof(GraphSpaceID));
+    return key;
+}
+
 std::string MetaServiceUtils::fulltextServiceKey() {
     std::string key;
     key.reserve(kFTServiceTable.size());
@@ -30,6 +30,15 @@ enum class EntryType : int8_t {
 using ConfigName = std::pair<cpp2::ConfigModule, std::string>;
 using LeaderParts = std::unordered_map<GraphSpaceID, std::vector<PartitionID>>;
 
+// The load of a replica of a part, which is reported to metad for the balance by load
+struct PartLoad {
+    int64_t     bytes{0};
+    int64_t     readQps{0};
+    int64_t     writeQps{0};
+    // the cpu used, in percent of a core
+    int64_t     cpu{0};
+};
+
 class MetaServiceUtils final {
 public:
     MetaServiceUtils() = delete;
@@ -38,6 +47,17 @@ public:
 
     static std::string lastUpdateTimeVal(const int64_t timeInMilliSec);
 
+    // The log of the meta changed at version, seq tells the logs of the same version apart
+    static std::string changeLogKey(int64_t version, int64_t seq);
+
+    static const std::string& changeLogPrefix();
+
+    static int64_t parseChangeLogVersion(folly::StringPiece key);
+
+    // The name of the table of a meta key, and the space it belongs to, -1 if the table is not
+    // of a space. The name is empty if the key is of no table.
+    static std::pair<std::string, GraphSpaceID> parseTableAndSpace(folly::StringPiece key);
+
     static std::string spaceKey(GraphSpaceID spaceId);
 
     static std::string spaceVal(const cpp2::SpaceDesc& spaceDesc);
@@ -317,6 +337,19 @@ public:
 
     static GraphSpaceID parseStatisSpace(folly::StringPiece rawData);
 
+    static std::string partLoadKey(GraphSpaceID spaceId, PartitionID partId);
+
+    static std::string partLoadVal(const PartLoad& load);
+
+    static std::string partLoadPrefix(GraphSpaceID spaceId);
+
+    static PartitionID parsePartLoadPart(folly::StringPiece rawData);
+
+    static PartLoad parsePartLoadVal(folly::StringPiece rawData);
+
+    // The value is the name of the zone preferred by the leaders of the space
+    static std::string leaderZoneKey(GraphSpaceID spaceId);
+
     static std::string fulltextServiceKey();
 
     static std::string fulltextServiceVal(cpp2::FTServiceType type,
@@ -0,0 +1,118 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "meta/MetaWarmup.h"
+#include "common/thread/GenericThreadPool.h"
+#include "common/time/Duration.h"
+#include "meta/ActiveHostsMan.h"
+#include "meta/ConfigCache.h"
+#include "meta/IndexCache.h"
+#include "meta/MetaServiceUtils.h"
+#include "meta/SchemaCache.h"
+#include "meta/processors/jobMan/JobManager.h"
+#include "meta/processors/jobMan/JobUtils.h"
+
+DEFINE_int32(meta_warmup_threads, 0,
+             "The threads loading the in-memory indexes of the meta leader in parallel when "
+             "metad starts, 0 means they are loaded by the first queries");
+
+DECLARE_bool(active_hosts_in_memory);
+DECLARE_bool(enable_job_cache);
+
+namespace nebula {
+namespace meta {
+
+// static
+void MetaWarmup::run(kvstore::KVStore* kv) {
+    if (FLAGS_meta_warmup_threads <= 0) {
+        return;
+    }
+    auto partRet = kv->part(kDefaultSpaceId, kDefaultPartId);
+    if (!nebula::ok(partRet) || !nebula::value(partRet)->isLeader()) {
+        return;
+    }
+
+    std::vector<std::pair<std::string, std::function<nebula::cpp2::ErrorCode()>>> tasks;
+    if (FLAGS_active_hosts_in_memory) {
+        tasks.emplace_back("hosts", [kv] {
+            auto ret = ActiveHostsMan::getActiveHosts(kv);
+            return nebula::ok(ret) ? nebula::cpp2::ErrorCode::SUCCEEDED : nebula::error(ret);
+        });
+    }
+    if (ConfigCache::enabled()) {
+        tasks.emplace_back("configs", [kv] {
+            auto ret = ConfigCache::items(kv, cpp2::ConfigModule::ALL);
+            return nebula::ok(ret) ? nebula::cpp2::ErrorCode::SUCCEEDED : nebula::error(ret);
+        });
+    }
+    if (FLAGS_enable_job_cache) {
+        tasks.emplace_back("jobs", [kv] {
+            std::unique_ptr<kvstore::KVIterator> iter;
+            return JobManager::getInstance()->prefixJobs(kv, JobUtil::jobPrefix(), &iter);
+        });
+    }
+    if (SchemaCache::enabled() || IndexCache::enabled()) {
+        // one task of each space
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto retCode = kv->prefix(kDefaultSpaceId, kDefaultPartId,
+                                  MetaServiceUtils::spacePrefix(), &iter);
+        if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Warm up the schemas failed, error "
+                       << apache::thrift::util::enumNameSafe(retCode);
+        } else {
+            for (; iter->valid(); iter->next()) {
+                auto spaceId = MetaServiceUtils::spaceId(iter->key());
+                tasks.emplace_back(folly::stringPrintf("schemas of space %d", spaceId),
+                                   [kv, spaceId] {
+                    if (IndexCache::enabled()) {
+                        auto indexes = IndexCache::indexes(kv, spaceId, 0);
+                        if (!nebula::ok(indexes)) {
+                            return nebula::error(indexes);
+                        }
+                    }
+                    if (!SchemaCache::enabled()) {
+                        return nebula::cpp2::ErrorCode::SUCCEEDED;
+                    }
+                    auto tags = SchemaCache::tags(kv, spaceId);
+                    if (!nebula::ok(tags)) {
+                        return nebula::error(tags);
+                    }
+                    auto edges = SchemaCache::edges(kv, spaceId);
+                    return nebula::ok(edges) ? nebula::cpp2::ErrorCode::SUCCEEDED
+                                             : nebula::error(edges);
+                });
+            }
+        }
+    }
+    if (tasks.empty()) {
+        return;
+    }
+
+    time::Duration duration;
+    thread::GenericThreadPool pool;
+    pool.start(std::min<size_t>(FLAGS_meta_warmup_threads, tasks.size()), "meta-warmup");
+    std::vector<folly::SemiFuture<nebula::cpp2::ErrorCode>> futures;
+    for (auto& task : tasks) {
+        futures.emplace_back(pool.addTask(task.second));
+    }
+    auto tries = folly::collectAll(std::move(futures)).get();
+    for (size_t i = 0; i < tries.size(); i++) {
+        if (tries[i].hasException()) {
+            LOG(ERROR) << "Warm up the " << tasks[i].first << " failed: "
+                       << tries[i].exception().what();
+        } else if (tries[i].value() != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Warm up the " << tasks[i].first << " failed, error "
+                       << apache::thrift::util::enumNameSafe(tries[i].value());
+        }
+    }
+    pool.stop();
+    pool.wait();
+    LOG(INFO) << "Warm up " << tasks.size() << " indexes of the meta leader in "
+              << duration.elapsedInMSec() << "ms";
+}
+
+}  // namespace meta
+}  // namespace nebula
@@ -0,0 +1,40 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef META_METAWARMUP_H_
+#define META_METAWARMUP_H_
+
+#include "common/base/Base.h"
+#include "kvstore/KVStore.h"
+
+DECLARE_int32(meta_warmup_threads);
+
+namespace nebula {
+namespace meta {
+
+/*
+MetaWarmup loads the in-memory indexes of the meta leader enabled, i.e. the host registry of
+active_hosts_in_memory, the schemas of enable_schema_cache, the indexes of enable_index_cache,
+the configs of enable_config_cache and the job table of enable_job_cache, in
+meta_warmup_threads threads when metad starts as the leader, so the first heartbeats and
+queries after a restart don't queue up behind the prefix scans loading them one by one.
+
+It runs before the service is started, when nothing writes the metas yet. A failure is only
+logged, the index is then loaded by the first query as usual.
+*/
+class MetaWarmup final {
+public:
+    // Load the indexes if meta_warmup_threads > 0 and kv is the leader
+    static void run(kvstore::KVStore* kv);
+
+private:
+    MetaWarmup() = delete;
+};
+
+}  // namespace meta
+}  // namespace nebula
+
+#endif  // META_METAWARMUP_H_
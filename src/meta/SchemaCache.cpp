@@ -0,0 +1,155 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "meta/SchemaCache.h"
+#include <folly/Synchronized.h>
+#include "meta/MetaServiceUtils.h"
+#include "meta/processors/Common.h"
+
+DEFINE_bool(enable_schema_cache, false,
+            "Serve the tags and the edges from the schemas decoded in memory on the meta leader");
+
+namespace nebula {
+namespace meta {
+
+// static
+folly::Synchronized<std::unordered_map<GraphSpaceID, SchemaCache::Entry>>&
+SchemaCache::entries() {
+    static folly::Synchronized<std::unordered_map<GraphSpaceID, Entry>> cached;
+    return cached;
+}
+
+// static
+TermID SchemaCache::leaderTerm(kvstore::KVStore* kv) {
+    auto partRet = kv->part(kDefaultSpaceId, kDefaultPartId);
+    if (!nebula::ok(partRet)) {
+        return -1;
+    }
+    auto part = nebula::value(partRet);
+    return part->isLeader() ? part->termId() : -1;
+}
+
+// static
+ErrorOr<nebula::cpp2::ErrorCode, std::shared_ptr<const SchemaCache::Tags>>
+SchemaCache::tags(kvstore::KVStore* kv, GraphSpaceID spaceId) {
+    auto term = leaderTerm(kv);
+    if (term >= 0) {
+        auto cached = entries().rlock();
+        auto it = cached->find(spaceId);
+        if (it != cached->end() && it->second.tagsTerm == term) {
+            return it->second.tags;
+        }
+    }
+    auto prefix = MetaServiceUtils::schemaTagsPrefix(spaceId);
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto code = kv->prefix(kDefaultSpaceId, kDefaultPartId, prefix, &iter);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    auto tags = std::make_shared<const Tags>(loadTags(iter.get(), prefix));
+    if (term >= 0) {
+        auto& entry = (*entries().wlock())[spaceId];
+        entry.tagsTerm = term;
+        entry.tags = tags;
+    }
+    return tags;
+}
+
+// static
+ErrorOr<nebula::cpp2::ErrorCode, std::shared_ptr<const SchemaCache::Edges>>
+SchemaCache::edges(kvstore::KVStore* kv, GraphSpaceID spaceId) {
+    auto term = leaderTerm(kv);
+    if (term >= 0) {
+        auto cached = entries().rlock();
+        auto it = cached->find(spaceId);
+        if (it != cached->end() && it->second.edgesTerm == term) {
+            return it->second.edges;
+        }
+    }
+    auto prefix = MetaServiceUtils::schemaEdgesPrefix(spaceId);
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto code = kv->prefix(kDefaultSpaceId, kDefaultPartId, prefix, &iter);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    auto edges = std::make_shared<const Edges>(loadEdges(iter.get(), prefix));
+    if (term >= 0) {
+        auto& entry = (*entries().wlock())[spaceId];
+        entry.edgesTerm = term;
+        entry.edges = edges;
+    }
+    return edges;
+}
+
+// static
+void SchemaCache::invalidateTags(GraphSpaceID spaceId) {
+    auto cached = entries().wlock();
+    auto it = cached->find(spaceId);
+    if (it != cached->end()) {
+        it->second.tagsTerm = -1;
+        it->second.tags.reset();
+    }
+}
+
+// static
+void SchemaCache::invalidateEdges(GraphSpaceID spaceId) {
+    auto cached = entries().wlock();
+    auto it = cached->find(spaceId);
+    if (it != cached->end()) {
+        it->second.edgesTerm = -1;
+        it->second.edges.reset();
+    }
+}
+
+// static
+void SchemaCache::invalidate(GraphSpaceID spaceId) {
+    entries().wlock()->erase(spaceId);
+}
+
+// static
+SchemaCache::Tags SchemaCache::loadTags(kvstore::KVIterator* iter, const std::string& prefix) {
+    Tags tags;
+    for (; iter->valid(); iter->next()) {
+        auto key = iter->key();
+        auto val = iter->val();
+        auto tagID = *reinterpret_cast<const TagID *>(key.data() + prefix.size());
+        auto version = MetaServiceUtils::parseTagVersion(key);
+        auto nameLen = *reinterpret_cast<const int32_t *>(val.data());
+        auto tagName = val.subpiece(sizeof(int32_t), nameLen).str();
+        auto schema = MetaServiceUtils::parseSchema(val);
+        cpp2::TagItem item;
+        item.set_tag_id(tagID);
+        item.set_tag_name(std::move(tagName));
+        item.set_version(version);
+        item.set_schema(std::move(schema));
+        tags.emplace_back(std::move(item));
+    }
+    return tags;
+}
+
+// static
+SchemaCache::Edges SchemaCache::loadEdges(kvstore::KVIterator* iter, const std::string& prefix) {
+    Edges edges;
+    for (; iter->valid(); iter->next()) {
+        auto key = iter->key();
+        auto val = iter->val();
+        auto edgeType = *reinterpret_cast<const EdgeType *>(key.data() + prefix.size());
+        auto version = MetaServiceUtils::parseEdgeVersion(key);
+        auto nameLen = *reinterpret_cast<const int32_t *>(val.data());
+        auto edgeName = val.subpiece(sizeof(int32_t), nameLen).str();
+        auto schema = MetaServiceUtils::parseSchema(val);
+        cpp2::EdgeItem edge;
+        edge.set_edge_type(edgeType);
+        edge.set_edge_name(std::move(edgeName));
+        edge.set_version(version);
+        edge.set_schema(std::move(schema));
+        edges.emplace_back(std::move(edge));
+    }
+    return edges;
+}
+
+}  // namespace meta
+}  // namespace nebula
@@ -0,0 +1,76 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef META_SCHEMACACHE_H_
+#define META_SCHEMACACHE_H_
+
+#include "common/base/Base.h"
+#include "common/base/ErrorOr.h"
+#include "common/interface/gen-cpp2/meta_types.h"
+#include "kvstore/KVStore.h"
+
+DECLARE_bool(enable_schema_cache);
+
+namespace nebula {
+namespace meta {
+
+/*
+SchemaCache keeps the tags and the edges of all versions of each space decoded on the meta leader
+when enable_schema_cache is set, so GetTag, ListTags, GetEdge and ListEdges are served from
+memory instead of decoding the schemas out of the kvstore on every call.
+
+The schemas of a space are loaded the first time they are read in a term of the meta leader, by
+the processors holding the tag or the edge lock of the space. The processors creating, altering
+or dropping them invalidate the cache with the write lock held, before the change is written.
+*/
+class SchemaCache final {
+public:
+    using Tags = std::vector<cpp2::TagItem>;
+    using Edges = std::vector<cpp2::EdgeItem>;
+
+    static bool enabled() {
+        return FLAGS_enable_schema_cache;
+    }
+
+    // The tags of the space in the order of their keys, the latest version of a tag first
+    static ErrorOr<nebula::cpp2::ErrorCode, std::shared_ptr<const Tags>>
+    tags(kvstore::KVStore* kv, GraphSpaceID spaceId);
+
+    // The edges of the space in the order of their keys, the latest version of an edge first
+    static ErrorOr<nebula::cpp2::ErrorCode, std::shared_ptr<const Edges>>
+    edges(kvstore::KVStore* kv, GraphSpaceID spaceId);
+
+    static void invalidateTags(GraphSpaceID spaceId);
+
+    static void invalidateEdges(GraphSpaceID spaceId);
+
+    static void invalidate(GraphSpaceID spaceId);
+
+    static Tags loadTags(kvstore::KVIterator* iter, const std::string& prefix);
+
+    static Edges loadEdges(kvstore::KVIterator* iter, const std::string& prefix);
+
+private:
+    struct Entry {
+        // the term they are loaded in, -1 if not loaded
+        TermID                          tagsTerm{-1};
+        std::shared_ptr<const Tags>     tags;
+        TermID                          edgesTerm{-1};
+        std::shared_ptr<const Edges>    edges;
+    };
+
+    static folly::Synchronized<std::unordered_map<GraphSpaceID, Entry>>& entries();
+
+    // The term of the meta leader, -1 if it's not the leader
+    static TermID leaderTerm(kvstore::KVStore* kv);
+
+    SchemaCache() = delete;
+};
+
+}  // namespace meta
+}  // namespace nebula
+
+#endif  // META_SCHEMACACHE_H_
@@ -21,6 +21,8 @@
 #include "meta/common/MetaCommon.h"
 #include "meta/processors/Common.h"
 #include "meta/ActiveHostsMan.h"
+#include "meta/IndexCache.h"
+#include "meta/MetaChangeLog.h"
 
 namespace nebula {
 namespace meta {
@@ -366,6 +366,13 @@ nebula::cpp2::ErrorCode BaseProcessor<RESP>::doSyncPut(std::vector<kvstore::KV>
 
 template<typename RESP>
 void BaseProcessor<RESP>::doSyncPutAndUpdate(std::vector<kvstore::KV> data) {
+    std::vector<std::string> keys;
+    if (MetaChangeLog::enabled()) {
+        keys.reserve(data.size());
+        for (const auto& kv : data) {
+            keys.emplace_back(kv.first);
+        }
+    }
     folly::Baton<true, std::atomic> baton;
     auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
     kvstore_->asyncMultiPut(kDefaultSpaceId,
@@ -384,7 +391,9 @@ void BaseProcessor<RESP>::doSyncPutAndUpdate(std::vector<kvstore::KV> data) {
         this->onFinished();
         return;
     }
-    auto retCode = LastUpdateTimeMan::update(kvstore_, time::WallClock::fastNowInMilliSec());
+    auto retCode = LastUpdateTimeMan::update(kvstore_,
+                                             time::WallClock::fastNowInMilliSec(),
+                                             &keys);
     this->handleErrorCode(retCode);
     this->onFinished();
 }
@@ -392,6 +401,10 @@ void BaseProcessor<RESP>::doSyncPutAndUpdate(std::vector<kvstore::KV> data) {
 
 template<typename RESP>
 void BaseProcessor<RESP>::doSyncMultiRemoveAndUpdate(std::vector<std::string> keys) {
+    std::vector<std::string> changedKeys;
+    if (MetaChangeLog::enabled()) {
+        changedKeys = keys;
+    }
     folly::Baton<true, std::atomic> baton;
     auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
     kvstore_->asyncMultiRemove(kDefaultSpaceId,
@@ -410,7 +423,9 @@ void BaseProcessor<RESP>::doSyncMultiRemoveAndUpdate(std::vector<std::string> ke
         this->onFinished();
         return;
     }
-    auto retCode = LastUpdateTimeMan::update(kvstore_, time::WallClock::fastNowInMilliSec());
+    auto retCode = LastUpdateTimeMan::update(kvstore_,
+                                             time::WallClock::fastNowInMilliSec(),
+                                             &changedKeys);
     this->handleErrorCode(retCode);
     this->onFinished();
 }
@@ -419,6 +434,16 @@ void BaseProcessor<RESP>::doSyncMultiRemoveAndUpdate(std::vector<std::string> ke
 template<typename RESP>
 ErrorOr<nebula::cpp2::ErrorCode, std::vector<cpp2::IndexItem>>
 BaseProcessor<RESP>::getIndexes(GraphSpaceID spaceId, int32_t tagOrEdge) {
+    if (IndexCache::enabled()) {
+        auto ret = IndexCache::indexes(kvstore_, spaceId, tagOrEdge);
+        if (!nebula::ok(ret)) {
+            auto retCode = nebula::error(ret);
+            LOG(ERROR) << "Tag or edge index prefix failed, error :"
+                       << apache::thrift::util::enumNameSafe(retCode);
+            return retCode;
+        }
+        return *nebula::value(ret);
+    }
     std::vector<cpp2::IndexItem> items;
     const auto& indexPrefix = MetaServiceUtils::indexPrefix(spaceId);
     auto iterRet = doPrefix(indexPrefix);
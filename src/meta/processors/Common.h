@@ -53,19 +53,37 @@ enum class BalanceStatus : uint8_t {
 class LockUtils {
 public:
     LockUtils() = delete;
+
+    // The number of locks of an entry locked by space, the spaces of the same slot share a lock
+    static constexpr size_t kSpaceLockSlots = 64;
+
 #define GENERATE_LOCK(Entry) \
     static folly::SharedMutex& Entry##Lock() { \
         static folly::SharedMutex l; \
         return l; \
     }
 
+    // The slot of the lock of space, the locks of several spaces should be held in slot order
+    static size_t spaceLockSlot(GraphSpaceID spaceId) {
+        return static_cast<size_t>(spaceId) % kSpaceLockSlots;
+    }
+
+// The entry only changed inside a space is locked by space, so the changes of different spaces
+// don't wait for each other
+#define GENERATE_SPACE_LOCK(Entry) \
+    static folly::SharedMutex& Entry##Lock(GraphSpaceID spaceId) { \
+        static std::array<folly::SharedMutex, kSpaceLockSlots> l; \
+        return l[spaceLockSlot(spaceId)]; \
+    }
+
 GENERATE_LOCK(lastUpdateTime);
 GENERATE_LOCK(space);
 GENERATE_LOCK(id);
-GENERATE_LOCK(tag);
-GENERATE_LOCK(edge);
-GENERATE_LOCK(tagIndex);
-GENERATE_LOCK(edgeIndex);
+GENERATE_SPACE_LOCK(tag);
+GENERATE_SPACE_LOCK(edge);
+GENERATE_SPACE_LOCK(tagIndex);
+GENERATE_SPACE_LOCK(edgeIndex);
+GENERATE_SPACE_LOCK(leader);
 GENERATE_LOCK(fulltextServices);
 GENERATE_LOCK(fulltextIndex);
 GENERATE_LOCK(user);
@@ -77,6 +95,7 @@ GENERATE_LOCK(listener);
 GENERATE_LOCK(session);
 
 #undef GENERATE_LOCK
+#undef GENERATE_SPACE_LOCK
 };
 
 
@@ -11,6 +11,9 @@
 #include "meta/ActiveHostsMan.h"
 
 DEFINE_uint32(task_concurrency, 10, "The tasks number could be invoked simultaneously");
+DEFINE_uint32(task_concurrency_per_host, 0,
+              "The tasks number could be invoked simultaneously on the same host, "
+              "either as src or as dst, 0 means the tasks are dispatched into fixed buckets");
 
 namespace nebula {
 namespace meta {
@@ -39,12 +42,133 @@ void BalancePlan::dispatchTasks() {
     }
 }
 
+void BalancePlan::dispatchTasksByHost() {
+    // Key -> spaceID + partID,  Val -> index in chains_
+    std::unordered_map<std::pair<GraphSpaceID, PartitionID>, size_t> partChains;
+    taskChain_.resize(tasks_.size());
+    for (size_t index = 0; index < tasks_.size(); index++) {
+        auto key = std::make_pair(tasks_[index].spaceId_, tasks_[index].partId_);
+        auto it = partChains.find(key);
+        if (it == partChains.end()) {
+            it = partChains.emplace(key, chains_.size()).first;
+            chains_.emplace_back();
+        }
+        chains_[it->second].emplace_back(index);
+        taskChain_[index] = it->second;
+    }
+    chainRunning_.assign(chains_.size(), false);
+}
+
+std::vector<int32_t> BalancePlan::pickTasks() {
+    std::vector<int32_t> picked;
+    while (runningTaskNum_ < FLAGS_task_concurrency) {
+        // Prefer the task whose hosts are the least busy, to spread the disk and network load
+        int32_t best = -1;
+        uint32_t bestBusy = 0;
+        for (size_t i = 0; i < chains_.size(); i++) {
+            if (chainRunning_[i] || chains_[i].empty()) {
+                continue;
+            }
+            const auto& task = tasks_[chains_[i].front()];
+            auto busy = std::max(hostTasks_[task.src_], hostTasks_[task.dst_]);
+            if (busy >= FLAGS_task_concurrency_per_host) {
+                continue;
+            }
+            if (best < 0 || busy < bestBusy) {
+                best = i;
+                bestBusy = busy;
+                if (busy == 0) {
+                    break;
+                }
+            }
+        }
+        if (best < 0) {
+            break;
+        }
+        auto taskIndex = chains_[best].front();
+        chains_[best].pop_front();
+        chainRunning_[best] = true;
+        auto& task = tasks_[taskIndex];
+        hostTasks_[task.src_]++;
+        hostTasks_[task.dst_]++;
+        runningTaskNum_++;
+        if (stopped_) {
+            task.ret_ = BalanceTaskResult::INVALID;
+        }
+        picked.emplace_back(taskIndex);
+    }
+    return picked;
+}
+
+void BalancePlan::onTaskDone(int32_t taskIndex, bool failed) {
+    bool finished = false;
+    std::vector<int32_t> next;
+    {
+        std::lock_guard<std::mutex> lg(lock_);
+        finishedTaskNum_++;
+        VLOG(1) << "Balance " << id_ << " has completed " << finishedTaskNum_ << " task";
+        auto& task = tasks_[taskIndex];
+        hostTasks_[task.src_]--;
+        hostTasks_[task.dst_]--;
+        runningTaskNum_--;
+        auto chain = taskChain_[taskIndex];
+        chainRunning_[chain] = false;
+        if (failed) {
+            status_ = BalanceStatus::FAILED;
+            if (!chains_[chain].empty()) {
+                LOG(INFO) << "Skip the task for the same partId " << task.partId_;
+                tasks_[chains_[chain].front()].ret_ = BalanceTaskResult::FAILED;
+            }
+        }
+        if (finishedTaskNum_ == tasks_.size()) {
+            finished = true;
+            if (status_ == BalanceStatus::IN_PROGRESS) {
+                status_ = BalanceStatus::SUCCEEDED;
+                LOG(INFO) << "Balance " << id_ << " succeeded!";
+            } else if (status_ == BalanceStatus::FAILED) {
+                LOG(INFO) << "Balance " << id_ << " failed!";
+            }
+        } else {
+            next = pickTasks();
+        }
+    }
+    if (finished) {
+        saveInStore(true);
+        onFinished_();
+        return;
+    }
+    for (auto index : next) {
+        tasks_[index].invoke();
+    }
+}
+
 void BalancePlan::invoke() {
     status_ = BalanceStatus::IN_PROGRESS;
     // Sort the tasks by its id to ensure the order after recovery.
     std::sort(tasks_.begin(), tasks_.end(), [](auto& l, auto& r) {
         return l.taskIdStr() < r.taskIdStr();
     });
+    if (FLAGS_task_concurrency_per_host > 0) {
+        dispatchTasksByHost();
+        for (size_t i = 0; i < tasks_.size(); i++) {
+            tasks_[i].onFinished_ = [this, i]() {
+                onTaskDone(i, false);
+            };
+            tasks_[i].onError_ = [this, i]() {
+                onTaskDone(i, true);
+            };
+        }
+        std::vector<int32_t> first;
+        {
+            std::lock_guard<std::mutex> lg(lock_);
+            first = pickTasks();
+        }
+        saveInStore(true);
+        for (auto index : first) {
+            tasks_[index].invoke();
+        }
+        return;
+    }
     dispatchTasks();
     for (size_t i = 0; i < buckets_.size(); i++) {
         for (size_t j = 0; j < buckets_[i].size(); j++) {
@@ -27,6 +27,7 @@ class BalancePlan {
     FRIEND_TEST(BalanceTest, RecoveryTest);
     FRIEND_TEST(BalanceTest, DispatchTasksTest);
     FRIEND_TEST(BalanceTest, StopPlanTest);
+    FRIEND_TEST(BalanceTest, DispatchTasksByHostTest);
 
 public:
     BalancePlan(BalanceID id, kvstore::KVStore* kv, AdminClient* client)
@@ -84,6 +85,13 @@ private:
 
     void dispatchTasks();
 
+    void dispatchTasksByHost();
+
+    // Start the next tasks of the chains whose hosts are not busy, the lock_ should be held
+    std::vector<int32_t> pickTasks();
+
+    void onTaskDone(int32_t taskIndex, bool failed);
+
 private:
     BalanceID id_ = 0;
     kvstore::KVStore* kv_ = nullptr;
@@ -98,6 +106,16 @@ private:
     // List of task index in tasks_;
     using Bucket = std::vector<int32_t>;
     std::vector<Bucket> buckets_;
+
+    // When task_concurrency_per_host is set, the tasks of a part are run one by one as a chain,
+    // and the next task of a chain is started once both its src and dst run less tasks than
+    // the limit, so that a host is never loaded by too many snapshots at the same time.
+    std::vector<std::deque<int32_t>> chains_;
+    std::vector<bool> chainRunning_;
+    // The chain of each task in tasks_
+    std::vector<size_t> taskChain_;
+    std::unordered_map<HostAddr, uint32_t> hostTasks_;
+    uint32_t runningTaskNum_ = 0;
 };
 
 }  // namespace meta
@@ -17,6 +17,11 @@
 
 DEFINE_double(leader_balance_deviation, 0.05, "after leader balance, leader count should in range "
                                               "[avg * (1 - deviation), avg * (1 + deviation)]");
+DEFINE_bool(balance_parts_by_load, false, "Balance the parts of a space by the load reported of "
+                                          "each part instead of the number of parts, if any");
+DEFINE_double(balance_load_deviation, 0.1, "after the balance by load, the load of the hosts "
+                                           "should be in range [avg * (1 - deviation), "
+                                           "avg * (1 + deviation)] if possible");
 
 namespace nebula {
 namespace meta {
@@ -308,6 +313,18 @@ Balancer::genTasks(GraphSpaceID spaceId,
         return nebula::cpp2::ErrorCode::E_NO_VALID_HOST;
     }
     // 2. Make all hosts in confirmedHostParts balanced
+    if (FLAGS_balance_parts_by_load && !dependentOnGroup) {
+        auto loadsRet = getPartLoads(spaceId);
+        if (!nebula::ok(loadsRet)) {
+            return nebula::error(loadsRet);
+        }
+        if (!nebula::value(loadsRet).empty()) {
+            balancePartsByLoad(plan_->id_, spaceId, confirmedHostParts,
+                               nebula::value(loadsRet), tasks);
+            return tasks;
+        }
+        LOG(INFO) << "No load reported of space " << spaceId << ", balance by parts";
+    }
     if (balanceParts(plan_->id_, spaceId, confirmedHostParts, totalParts, tasks)) {
         return tasks;
     } else {
@@ -315,6 +332,142 @@ Balancer::genTasks(GraphSpaceID spaceId,
     }
 }
 
+ErrorOr<nebula::cpp2::ErrorCode, std::unordered_map<PartitionID, PartLoad>>
+Balancer::getPartLoads(GraphSpaceID spaceId) {
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto prefix = MetaServiceUtils::partLoadPrefix(spaceId);
+    auto retCode = kv_->prefix(kDefaultSpaceId, kDefaultPartId, prefix, &iter);
+    if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Get the part loads of space " << spaceId << " failed, error: "
+                   << apache::thrift::util::enumNameSafe(retCode);
+        return retCode;
+    }
+    std::unordered_map<PartitionID, PartLoad> loads;
+    for (; iter->valid(); iter->next()) {
+        loads.emplace(MetaServiceUtils::parsePartLoadPart(iter->key()),
+                      MetaServiceUtils::parsePartLoadVal(iter->val()));
+    }
+    return loads;
+}
+
+std::unordered_map<PartitionID, double>
+Balancer::partCosts(const HostParts& hostParts,
+                    const std::unordered_map<PartitionID, PartLoad>& loads) {
+    // the cost of a part is its average share of the bytes, the qps and the cpu of the space
+    std::array<double, 3> totals{0, 0, 0};
+    auto dims = [] (const PartLoad& load) {
+        return std::array<double, 3>{static_cast<double>(load.bytes),
+                                     static_cast<double>(load.readQps + load.writeQps),
+                                     static_cast<double>(load.cpu)};
+    };
+    for (const auto& load : loads) {
+        auto values = dims(load.second);
+        for (size_t i = 0; i < totals.size(); i++) {
+            totals[i] += std::max(values[i], 0.0);
+        }
+    }
+    auto used = std::count_if(totals.begin(), totals.end(), [] (auto t) { return t > 0; });
+
+    std::unordered_map<PartitionID, double> costs;
+    double known = 0;
+    for (const auto& load : loads) {
+        double cost = 0;
+        auto values = dims(load.second);
+        for (size_t i = 0; i < totals.size(); i++) {
+            if (totals[i] > 0) {
+                cost += std::max(values[i], 0.0) / totals[i];
+            }
+        }
+        cost = used > 0 ? cost / used : 1.0;
+        costs.emplace(load.first, cost);
+        known += cost;
+    }
+    // the part not reported is as costly as the average one
+    double avgCost = loads.empty() ? 1.0 : known / loads.size();
+    for (const auto& entry : hostParts) {
+        for (auto partId : entry.second) {
+            costs.emplace(partId, avgCost);
+        }
+    }
+    return costs;
+}
+
+void Balancer::balancePartsByLoad(BalanceID balanceId,
+                                  GraphSpaceID spaceId,
+                                  HostParts& confirmedHostParts,
+                                  const std::unordered_map<PartitionID, PartLoad>& loads,
+                                  std::vector<BalanceTask>& tasks) {
+    auto costs = partCosts(confirmedHostParts, loads);
+    std::unordered_map<HostAddr, double> hostLoads;
+    double total = 0;
+    size_t replicas = 0;
+    for (const auto& entry : confirmedHostParts) {
+        double load = 0;
+        for (auto partId : entry.second) {
+            load += costs[partId];
+        }
+        hostLoads[entry.first] = load;
+        total += load;
+        replicas += entry.second.size();
+    }
+    auto avgLoad = total / confirmedHostParts.size();
+    auto bytesOf = [&loads] (PartitionID partId) {
+        auto it = loads.find(partId);
+        return it == loads.end() ? 0 : it->second.bytes;
+    };
+
+    // Move a part from the most loaded host to the least loaded one each time, which evens
+    // them out most, the one of less data for the same gain. Moving the cost c when the
+    // difference of them is d reduces the sum of the squared loads by 2 * c * (d - c).
+    for (size_t moves = 0; moves < replicas; moves++) {
+        auto minmax = std::minmax_element(hostLoads.begin(), hostLoads.end(),
+                                          [] (const auto& l, const auto& r) {
+            return l.second < r.second;
+        });
+        auto from = minmax.second->first;
+        auto to = minmax.first->first;
+        auto diff = minmax.second->second - minmax.first->second;
+        if (diff <= FLAGS_balance_load_deviation * avgLoad) {
+            break;
+        }
+
+        auto& partsFrom = confirmedHostParts[from];
+        auto& partsTo = confirmedHostParts[to];
+        auto best = partsFrom.end();
+        double bestGain = 0;
+        for (auto it = partsFrom.begin(); it != partsFrom.end(); it++) {
+            if (std::find(partsTo.begin(), partsTo.end(), *it) != partsTo.end()) {
+                continue;
+            }
+            auto cost = costs[*it];
+            auto gain = cost * (diff - cost);
+            if (gain <= 0) {
+                continue;
+            }
+            if (best == partsFrom.end() || gain > bestGain * (1 + 1e-6) ||
+                (gain >= bestGain * (1 - 1e-6) && bytesOf(*it) < bytesOf(*best))) {
+                best = it;
+                bestGain = gain;
+            }
+        }
+        if (best == partsFrom.end()) {
+            LOG(INFO) << "No part of " << from << " to move to " << to;
+            break;
+        }
+
+        auto partId = *best;
+        LOG(INFO) << "[space:" << spaceId << ", part:" << partId << "] " << from << "->" << to
+                  << ", cost " << costs[partId] << ", load " << hostLoads[from] << " -> "
+                  << hostLoads[to];
+        partsFrom.erase(best);
+        partsTo.emplace_back(partId);
+        hostLoads[from] -= costs[partId];
+        hostLoads[to] += costs[partId];
+        tasks.emplace_back(balanceId, spaceId, partId, from, to, kv_, client_);
+    }
+    LOG(INFO) << "Balance tasks num: " << tasks.size();
+}
+
 nebula::cpp2::ErrorCode
 Balancer::transferLostHost(std::vector<BalanceTask>& tasks,
                            HostParts& confirmedHostParts,
@@ -798,32 +951,84 @@ Balancer::buildLeaderBalancePlan(HostLeaderMap* hostLeaderMap,
         return false;
     }
 
-    if (dependentOnGroup) {
+    auto zoneCode = collectLeaderZone(spaceId, peersMap, activeHosts);
+    if (zoneCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return zoneCode;
+    }
+
+    auto calcBounds = [useDeviation] (size_t parts, size_t hosts) {
+        size_t avg = parts / hosts;
+        size_t min = avg;
+        size_t max = avg;
+        if (parts % hosts != 0) {
+            max += 1;
+        }
+        if (useDeviation) {
+            min = std::ceil(static_cast<double> (parts) / hosts *
+                            (1 - FLAGS_leader_balance_deviation));
+            max = std::floor(static_cast<double> (parts) / hosts *
+                             (1 + FLAGS_leader_balance_deviation));
+        }
+        VLOG(3) << "Build leader balance plan, expected min load: " << min
+                << ", max load: " << max << " avg: " << avg;
+        return std::pair<int32_t, int32_t>(min, max);
+    };
+
+    if (!preferredParts_.empty()) {
+        // Move the leaders out of the zone preferred back at first, to the peer in the zone
+        // with the least leaders
+        std::unordered_map<PartitionID, HostAddr> leaders;
+        for (const auto& hostEntry : leaderHostParts) {
+            for (auto partId : hostEntry.second) {
+                leaders[partId] = hostEntry.first;
+            }
+        }
+        for (auto partId : preferredParts_) {
+            auto leaderIter = leaders.find(partId);
+            if (leaderIter == leaders.end() || preferredHosts_.count(leaderIter->second)) {
+                continue;
+            }
+            const HostAddr* target = nullptr;
+            for (const auto& peer : peersMap[partId]) {
+                if (!preferredHosts_.count(peer)) {
+                    continue;
+                }
+                if (target == nullptr ||
+                    leaderHostParts[peer].size() < leaderHostParts[*target].size()) {
+                    target = &peer;
+                }
+            }
+            const auto& source = leaderIter->second;
+            auto& sourceLeaders = leaderHostParts[source];
+            sourceLeaders.erase(std::find(sourceLeaders.begin(), sourceLeaders.end(), partId));
+            leaderHostParts[*target].emplace_back(partId);
+            plan.emplace_back(spaceId, partId, source, *target);
+            LOG(INFO) << "affinity plan trans leader space: " << spaceId
+                      << " part: " << partId << " from " << source << " to " << *target;
+        }
+
+        // The leaders in the zone preferred are balanced within its hosts, and the others are
+        // balanced within the rest hosts
+        auto preferredBounds = calcBounds(preferredParts_.size(), preferredHosts_.size());
+        auto restHosts = activeHosts.size() - preferredHosts_.size();
+        auto restBounds = restHosts == 0
+                        ? std::pair<int32_t, int32_t>(0, 0)
+                        : calcBounds(leaderParts - preferredParts_.size(), restHosts);
+        for (auto it = allHostParts.begin(); it != allHostParts.end(); it++) {
+            hostBounds_[it->first] = preferredHosts_.count(it->first)
+                                   ? preferredBounds
+                                   : restBounds;
+        }
+    } else if (dependentOnGroup) {
         for (auto it = allHostParts.begin(); it != allHostParts.end(); it++) {
             auto min = it->second.size() / replicaFactor;
             VLOG(3) << "Host: " << it->first << " Bounds: " << min << " : " << min + 1;
             hostBounds_[it->first] = std::make_pair(min, min + 1);
         }
     } else {
-        size_t activeSize = activeHosts.size();
-        size_t globalAvg = leaderParts / activeSize;
-        size_t globalMin = globalAvg;
-        size_t globalMax = globalAvg;
-        if (leaderParts % activeSize != 0) {
-            globalMax += 1;
-        }
-
-        if (useDeviation) {
-            globalMin = std::ceil(static_cast<double> (leaderParts) / activeSize *
-                                  (1 - FLAGS_leader_balance_deviation));
-            globalMax = std::floor(static_cast<double> (leaderParts) / activeSize *
-                                   (1 + FLAGS_leader_balance_deviation));
-        }
-        VLOG(3) << "Build leader balance plan, expected min load: " << globalMin
-                << ", max load: " << globalMax << " avg: " << globalAvg;
-
+        auto globalBounds = calcBounds(leaderParts, activeHosts.size());
         for (auto it = allHostParts.begin(); it != allHostParts.end(); it++) {
-            hostBounds_[it->first] = std::make_pair(globalMin, globalMax);
+            hostBounds_[it->first] = globalBounds;
         }
     }
 
@@ -884,6 +1089,9 @@ int32_t Balancer::acquireLeaders(HostParts& allHostParts,
     auto& targetLeaders = leaderHostParts[target];
     size_t minLoad = hostBounds_[target].first;
     for (const auto& partId : diff) {
+        if (!leaderAllowed(partId, target)) {
+            continue;
+        }
         VLOG(3) << "Try acquire leader for part " << partId;
         // find the leader of partId
         auto sources = peersMap[partId];
@@ -937,13 +1145,16 @@ int32_t Balancer::giveupLeaders(HostParts& leaderParts,
         bool isErase = false;
 
         // leader should move to the peer with lowest loading
-        auto target = std::min_element(targets.begin(), targets.end(),
-                                       [&](const auto &l, const auto &r) -> bool {
-                                           if (source == l || !activeHosts.count(l)) {
-                                               return false;
-                                           }
-                                           return leaderParts[l].size() < leaderParts[r].size();
-                                       });
+        auto target = targets.end();
+        for (auto peer = targets.begin(); peer != targets.end(); peer++) {
+            if (source == *peer || !activeHosts.count(*peer) || !leaderAllowed(partId, *peer)) {
+                continue;
+            }
+            if (target == targets.end() ||
+                leaderParts[*peer].size() < leaderParts[*target].size()) {
+                target = peer;
+            }
+        }
 
         // If peer can accept this partition leader, than host will transfer to the peer
         if (target != targets.end()) {
@@ -991,6 +1202,58 @@ void Balancer::simplifyLeaderBalnacePlan(GraphSpaceID spaceId, LeaderBalancePlan
     }
 }
 
+nebula::cpp2::ErrorCode
+Balancer::collectLeaderZone(GraphSpaceID spaceId,
+                            const PartAllocation& peersMap,
+                            const std::unordered_set<HostAddr>& activeHosts) {
+    preferredHosts_.clear();
+    preferredParts_.clear();
+    std::string zoneName;
+    auto retCode = kv_->get(kDefaultSpaceId, kDefaultPartId,
+                            MetaServiceUtils::leaderZoneKey(spaceId), &zoneName);
+    if (retCode == nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    } else if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Get the leader zone of space " << spaceId << " failed, error: "
+                   << apache::thrift::util::enumNameSafe(retCode);
+        return retCode;
+    }
+
+    std::string zoneValue;
+    retCode = kv_->get(kDefaultSpaceId, kDefaultPartId,
+                       MetaServiceUtils::zoneKey(zoneName), &zoneValue);
+    if (retCode == nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND) {
+        LOG(WARNING) << "Zone " << zoneName << " preferred by space " << spaceId
+                     << " not found, ignore it";
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    } else if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Get zone " << zoneName << " failed, error: "
+                   << apache::thrift::util::enumNameSafe(retCode);
+        return retCode;
+    }
+
+    for (auto& host : MetaServiceUtils::parseZoneHosts(std::move(zoneValue))) {
+        if (activeHosts.count(host)) {
+            preferredHosts_.emplace(std::move(host));
+        }
+    }
+    if (preferredHosts_.empty()) {
+        LOG(INFO) << "No host of zone " << zoneName << " preferred by space " << spaceId
+                  << " is active, balance the leaders across all hosts";
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    for (const auto& partEntry : peersMap) {
+        bool preferred = std::any_of(partEntry.second.begin(), partEntry.second.end(),
+                                     [this] (const auto& peer) {
+            return preferredHosts_.count(peer) != 0;
+        });
+        if (preferred) {
+            preferredParts_.emplace(partEntry.first);
+        }
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
 nebula::cpp2::ErrorCode
 Balancer::collectZoneParts(const std::string& groupName,
                            HostParts& hostParts) {
@@ -45,6 +45,7 @@ Some notes:
  * */
 class Balancer {
     FRIEND_TEST(BalanceTest, BalancePartsTest);
+    FRIEND_TEST(BalanceTest, BalancePartsByLoadTest);
     FRIEND_TEST(BalanceTest, NormalTest);
     FRIEND_TEST(BalanceTest, SimpleTestWithZone);
     FRIEND_TEST(BalanceTest, SpecifyHostTest);
@@ -63,6 +64,7 @@ class Balancer {
     FRIEND_TEST(BalanceTest, LeaderBalanceWithZoneTest);
     FRIEND_TEST(BalanceTest, LeaderBalanceWithLargerZoneTest);
     FRIEND_TEST(BalanceTest, LeaderBalanceWithComplexZoneTest);
+    FRIEND_TEST(BalanceTest, LeaderBalanceWithZoneAffinityTest);
     FRIEND_TEST(BalanceTest, ExpansionZoneTest);
     FRIEND_TEST(BalanceTest, ExpansionHostIntoZoneTest);
     FRIEND_TEST(BalanceTest, ShrinkZoneTest);
@@ -197,6 +199,23 @@ private:
                       int32_t totalParts,
                       std::vector<BalanceTask>& tasks);
 
+    ErrorOr<nebula::cpp2::ErrorCode, std::unordered_map<PartitionID, PartLoad>>
+    getPartLoads(GraphSpaceID spaceId);
+
+    // The cost of each part in hostParts by the loads reported, the parts of a space cost 1 in
+    // total if all of them are reported
+    std::unordered_map<PartitionID, double>
+    partCosts(const HostParts& hostParts,
+              const std::unordered_map<PartitionID, PartLoad>& loads);
+
+    // Balance the hosts by the sum of the costs of their parts, until the most loaded one and
+    // the least loaded one are within balance_load_deviation of the average
+    void balancePartsByLoad(BalanceID balanceId,
+                            GraphSpaceID spaceId,
+                            HostParts& newHostParts,
+                            const std::unordered_map<PartitionID, PartLoad>& loads,
+                            std::vector<BalanceTask>& tasks);
+
     nebula::cpp2::ErrorCode
     transferLostHost(std::vector<BalanceTask>& tasks,
                      HostParts& newHostParts,
@@ -241,6 +260,20 @@ private:
 
     bool checkZoneLegal(const HostAddr& source, const HostAddr& target, PartitionID part);
 
+    // Collect the active hosts of the zone preferred by the leaders of the space, and the parts
+    // which have a peer among them. Nothing is collected if no zone is preferred or all hosts
+    // of it are down, then the leaders are balanced across all the hosts as usual.
+    nebula::cpp2::ErrorCode
+    collectLeaderZone(GraphSpaceID spaceId,
+                      const PartAllocation& peersMap,
+                      const std::unordered_set<HostAddr>& activeHosts);
+
+    // Whether the leader of the part could be moved to the target, the leader of a part with a
+    // peer in the zone preferred should stay in the zone
+    bool leaderAllowed(PartitionID partId, const HostAddr& target) {
+        return !preferredParts_.count(partId) || preferredHosts_.count(target);
+    }
+
 private:
     std::atomic_bool running_{false};
     kvstore::KVStore* kv_{nullptr};
@@ -256,6 +289,9 @@ private:
 
     std::unordered_map<HostAddr, std::pair<int32_t, int32_t>> hostBounds_;
     std::unordered_map<HostAddr, ZoneNameAndParts> zoneParts_;
+
+    std::unordered_set<HostAddr> preferredHosts_;
+    std::unordered_set<PartitionID> preferredParts_;
 };
 
 }  // namespace meta
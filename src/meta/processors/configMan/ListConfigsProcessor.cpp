@@ -5,12 +5,28 @@
  */
 
 #include "meta/processors/configMan/ListConfigsProcessor.h"
+#include "meta/ConfigCache.h"
 
 namespace nebula {
 namespace meta {
 
 void ListConfigsProcessor::process(const cpp2::ListConfigsReq& req) {
     folly::SharedMutex::ReadHolder rHolder(LockUtils::configLock());
+    if (ConfigCache::enabled()) {
+        auto cached = ConfigCache::items(kvstore_, req.get_module());
+        if (!nebula::ok(cached)) {
+            auto retCode = nebula::error(cached);
+            LOG(ERROR) << "List configs failed, error: "
+                       << apache::thrift::util::enumNameSafe(retCode);
+            handleErrorCode(retCode);
+            onFinished();
+            return;
+        }
+        handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
+        resp_.set_items(std::move(nebula::value(cached)));
+        onFinished();
+        return;
+    }
 
     const auto& prefix = MetaServiceUtils::configKeyPrefix(req.get_module());
     auto iterRet = doPrefix(prefix);
@@ -21,19 +37,7 @@ void ListConfigsProcessor::process(const cpp2::ListConfigsReq& req) {
         onFinished();
         return;
     }
-    auto iter = nebula::value(iterRet).get();
-
-    std::vector<cpp2::ConfigItem> items;
-    while (iter->valid()) {
-        auto key = iter->key();
-        auto value = iter->val();
-        auto item = MetaServiceUtils::parseConfigValue(value);
-        auto configName = MetaServiceUtils::parseConfigKey(key);
-        item.set_module(configName.first);
-        item.set_name(configName.second);
-        items.emplace_back(std::move(item));
-        iter->next();
-    }
+    auto items = ConfigCache::loadItems(nebula::value(iterRet).get());
     handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
     resp_.set_items(std::move(items));
     onFinished();
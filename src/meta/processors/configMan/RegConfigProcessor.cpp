@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/configMan/RegConfigProcessor.h"
+#include "meta/ConfigCache.h"
 
 namespace nebula {
 namespace meta {
@@ -44,6 +45,7 @@ void RegConfigProcessor::process(const cpp2::RegConfigReq& req) {
         }
 
         if (!data.empty()) {
+            ConfigCache::invalidate();
             doSyncPutAndUpdate(std::move(data));
             return;
         }
@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/configMan/SetConfigProcessor.h"
+#include "meta/ConfigCache.h"
 #include "common/conf/Configuration.h"
 
 namespace nebula {
@@ -39,6 +40,7 @@ void SetConfigProcessor::process(const cpp2::SetConfigReq& req) {
         }
 
         if (!data.empty()) {
+            ConfigCache::invalidate();
             doSyncPutAndUpdate(std::move(data));
             return;
         }
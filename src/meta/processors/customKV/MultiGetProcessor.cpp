@@ -6,26 +6,34 @@
 
 #include "meta/processors/customKV/MultiGetProcessor.h"
 
+DECLARE_int32(custom_kv_max_values);
+
 namespace nebula {
 namespace meta {
 
 void MultiGetProcessor::process(const cpp2::MultiGetReq& req) {
     std::vector<std::string> keys;
+    auto retCode = nebula::cpp2::ErrorCode::SUCCEEDED;
     for (auto& key : req.get_keys()) {
+        if (FLAGS_custom_kv_max_values > 0 &&
+            keys.size() >= static_cast<size_t>(FLAGS_custom_kv_max_values)) {
+            retCode = nebula::cpp2::ErrorCode::E_PARTIAL_RESULT;
+            break;
+        }
         keys.emplace_back(MetaServiceUtils::assembleSegmentKey(req.get_segment(), key));
     }
 
     auto result = doMultiGet(std::move(keys));
     if (!nebula::ok(result)) {
-        auto retCode = nebula::error(result);
+        auto code = nebula::error(result);
         LOG(ERROR) << "MultiGet Failed, error: "
-                   << apache::thrift::util::enumNameSafe(retCode);
-        handleErrorCode(retCode);
+                   << apache::thrift::util::enumNameSafe(code);
+        handleErrorCode(code);
         onFinished();
         return;
     }
 
-    handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
+    handleErrorCode(retCode);
     resp_.set_values(std::move(nebula::value(result)));
     onFinished();
 }
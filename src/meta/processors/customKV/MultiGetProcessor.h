@@ -12,6 +12,10 @@
 namespace nebula {
 namespace meta {
 
+/*
+A multi get of more than custom_kv_max_values keys only gets the first ones of them, and returns
+E_PARTIAL_RESULT, the others could be got by the next one.
+*/
 class MultiGetProcessor : public BaseProcessor<cpp2::MultiGetResp> {
 public:
     static MultiGetProcessor* instance(kvstore::KVStore* kvstore) {
@@ -6,23 +6,41 @@
 
 #include "meta/processors/customKV/ScanProcessor.h"
 
+DEFINE_int32(custom_kv_max_values, 0,
+             "The max number of the values a scan or a multi get of the custom kv returns, "
+             "0 means no limit");
+
 namespace nebula {
 namespace meta {
 
 void ScanProcessor::process(const cpp2::ScanReq& req) {
-    auto start = MetaServiceUtils::assembleSegmentKey(req.get_segment(), req.get_start());
-    auto end   = MetaServiceUtils::assembleSegmentKey(req.get_segment(), req.get_end());
-    auto result = doScan(start, end);
-    if (!nebula::ok(result)) {
-        auto retCode = nebula::error(result);
+    const auto& segment = req.get_segment();
+    auto start = MetaServiceUtils::assembleSegmentKey(segment, req.get_start());
+    auto end   = MetaServiceUtils::assembleSegmentKey(segment, req.get_end());
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto retCode = kvstore_->range(kDefaultSpaceId, kDefaultPartId, start, end, &iter);
+    if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Scan Failed, error: " << apache::thrift::util::enumNameSafe(retCode);
         handleErrorCode(retCode);
         onFinished();
         return;
     }
 
-    handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
-    resp_.set_values(std::move(nebula::value(result)));
+    size_t limit = FLAGS_custom_kv_max_values > 0 ? FLAGS_custom_kv_max_values : 0;
+    std::vector<std::string> values;
+    retCode = nebula::cpp2::ErrorCode::SUCCEEDED;
+    for (; iter->valid(); iter->next()) {
+        if (limit > 0 && values.size() >= limit) {
+            // the key of the next page, without the segment
+            values.emplace_back(iter->key().subpiece(segment.size()).str());
+            retCode = nebula::cpp2::ErrorCode::E_PARTIAL_RESULT;
+            break;
+        }
+        values.emplace_back(iter->val().str());
+    }
+
+    handleErrorCode(retCode);
+    resp_.set_values(std::move(values));
     onFinished();
 }
 
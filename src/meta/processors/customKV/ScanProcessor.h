@@ -12,6 +12,11 @@
 namespace nebula {
 namespace meta {
 
+/*
+A scan returns at most custom_kv_max_values values if it's set. The scan cut by the limit returns
+E_PARTIAL_RESULT, and its values are followed by the key the next page starts from, so it could be
+scanned page by page from the key. It's an error to the clients not knowing the pages.
+*/
 class ScanProcessor : public BaseProcessor<cpp2::ScanResp> {
 public:
     static ScanProcessor* instance(kvstore::KVStore* kvstore) {
@@ -38,7 +38,7 @@ void CreateEdgeIndexProcessor::process(const cpp2::CreateEdgeIndexReq& req) {
     }
 
     folly::SharedMutex::ReadHolder rHolder(LockUtils::snapshotLock());
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::edgeIndexLock());
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::edgeIndexLock(space));
     auto ret = getIndexID(space, indexName);
     if (nebula::ok(ret)) {
         if (req.get_if_not_exists()) {
@@ -191,6 +191,7 @@ void CreateEdgeIndexProcessor::process(const cpp2::CreateEdgeIndexReq& req) {
                       MetaServiceUtils::indexVal(item));
     LOG(INFO) << "Create Edge Index " << indexName << ", edgeIndex " << edgeIndex;
     resp_.set_id(to(edgeIndex, EntryType::INDEX));
+    IndexCache::invalidate(space);
     doSyncPutAndUpdate(std::move(data));
 }
 
@@ -38,7 +38,7 @@ void CreateTagIndexProcessor::process(const cpp2::CreateTagIndexReq& req) {
     }
 
     folly::SharedMutex::ReadHolder rHolder(LockUtils::snapshotLock());
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::tagIndexLock());
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::tagIndexLock(space));
     auto ret = getIndexID(space, indexName);
     if (nebula::ok(ret)) {
         if (req.get_if_not_exists()) {
@@ -190,6 +190,7 @@ void CreateTagIndexProcessor::process(const cpp2::CreateTagIndexReq& req) {
                       MetaServiceUtils::indexVal(item));
     LOG(INFO) << "Create Tag Index " << indexName << ", tagIndex " << tagIndex;
     resp_.set_id(to(tagIndex, EntryType::INDEX));
+    IndexCache::invalidate(space);
     doSyncPutAndUpdate(std::move(data));
 }
 
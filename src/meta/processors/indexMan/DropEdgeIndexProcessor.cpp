@@ -13,7 +13,7 @@ void DropEdgeIndexProcessor::process(const cpp2::DropEdgeIndexReq& req) {
     auto spaceID = req.get_space_id();
     const auto& indexName = req.get_index_name();
     CHECK_SPACE_ID_AND_RETURN(spaceID);
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::edgeIndexLock());
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::edgeIndexLock(spaceID));
 
     auto edgeIndexIDRet = getIndexID(spaceID, indexName);
     if (!nebula::ok(edgeIndexIDRet)) {
@@ -42,6 +42,7 @@ void DropEdgeIndexProcessor::process(const cpp2::DropEdgeIndexReq& req) {
 
     LOG(INFO) << "Drop Edge Index " << indexName;
     resp_.set_id(to(edgeIndexID, EntryType::INDEX));
+    IndexCache::invalidate(spaceID);
     doSyncMultiRemoveAndUpdate(std::move(keys));
 }
 
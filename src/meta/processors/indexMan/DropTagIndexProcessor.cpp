@@ -13,7 +13,7 @@ void DropTagIndexProcessor::process(const cpp2::DropTagIndexReq& req) {
     auto spaceID = req.get_space_id();
     const auto& indexName = req.get_index_name();
     CHECK_SPACE_ID_AND_RETURN(spaceID);
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::tagIndexLock());
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::tagIndexLock(spaceID));
 
     auto tagIndexIDRet = getIndexID(spaceID, indexName);
     if (!nebula::ok(tagIndexIDRet)) {
@@ -41,6 +41,7 @@ void DropTagIndexProcessor::process(const cpp2::DropTagIndexReq& req) {
 
     LOG(INFO) << "Drop Tag Index " << indexName;
     resp_.set_id(to(tagIndexID, EntryType::INDEX));
+    IndexCache::invalidate(spaceID);
     doSyncMultiRemoveAndUpdate(std::move(keys));
 }
 
@@ -13,7 +13,7 @@ void ListEdgeIndexesProcessor::process(const cpp2::ListEdgeIndexesReq& req) {
     auto space = req.get_space_id();
     CHECK_SPACE_ID_AND_RETURN(space);
 
-    folly::SharedMutex::ReadHolder rHolder(LockUtils::edgeIndexLock());
+    folly::SharedMutex::ReadHolder rHolder(LockUtils::edgeIndexLock(space));
     const auto& prefix = MetaServiceUtils::indexPrefix(space);
     auto iterRet = doPrefix(prefix);
     if (!nebula::ok(iterRet)) {
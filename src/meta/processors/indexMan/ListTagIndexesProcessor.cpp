@@ -13,7 +13,7 @@ void ListTagIndexesProcessor::process(const cpp2::ListTagIndexesReq& req) {
     auto space = req.get_space_id();
     CHECK_SPACE_ID_AND_RETURN(space);
 
-    folly::SharedMutex::ReadHolder rHolder(LockUtils::tagIndexLock());
+    folly::SharedMutex::ReadHolder rHolder(LockUtils::tagIndexLock(space));
     const auto& prefix = MetaServiceUtils::indexPrefix(space);
     auto iterRet = doPrefix(prefix);
     if (!nebula::ok(iterRet)) {
@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/jobMan/CompactJobExecutor.h"
+#include <folly/String.h>
 
 namespace nebula {
 namespace meta {
@@ -15,10 +16,89 @@ CompactJobExecutor::CompactJobExecutor(JobID jobId,
                                        const std::vector<std::string>& paras)
     : SimpleConcurrentJobExecutor(jobId, kvstore, adminClient, paras) {}
 
+bool CompactJobExecutor::parseOption(const std::string& option) {
+    auto pos = option.find('=');
+    if (pos == std::string::npos) {
+        return false;
+    }
+    auto name = option.substr(0, pos);
+    auto value = option.substr(pos + 1);
+    if (name == "parts") {
+        std::vector<folly::StringPiece> ids;
+        folly::split(',', value, ids, true);
+        for (auto id : ids) {
+            auto part = folly::tryTo<PartitionID>(id);
+            if (!part.hasValue() || part.value() <= 0) {
+                return false;
+            }
+            parts_.emplace_back(part.value());
+        }
+        return !parts_.empty();
+    }
+    if (name == "prefix") {
+        std::string prefix;
+        if (value.empty() || !folly::unhexlify(value, prefix)) {
+            return false;
+        }
+    } else if (name == "tag" || name == "edge" || name == "index" || name == "level") {
+        if (!folly::tryTo<int32_t>(value).hasValue()) {
+            return false;
+        }
+    } else {
+        return false;
+    }
+    options_.emplace_back(option);
+    return true;
+}
+
+bool CompactJobExecutor::check() {
+    if (paras_.empty()) {
+        return false;
+    }
+    parts_.clear();
+    options_.clear();
+    // the last one is the space name
+    for (size_t i = 0; i + 1 < paras_.size(); i++) {
+        if (i == 0 && folly::tryTo<int32_t>(paras_[i]).hasValue()) {
+            continue;
+        }
+        if (!parseOption(paras_[i])) {
+            LOG(ERROR) << "Invalid compact option: " << paras_[i];
+            return false;
+        }
+    }
+    return true;
+}
+
+nebula::cpp2::ErrorCode CompactJobExecutor::prepare() {
+    auto errOrSpaceId = getSpaceIdFromName(paras_.back());
+    if (!nebula::ok(errOrSpaceId)) {
+        LOG(ERROR) << "Can't find the space: " << paras_.back();
+        return nebula::error(errOrSpaceId);
+    }
+    space_ = nebula::value(errOrSpaceId);
+    ErrOrHosts errOrHost = getTargetHost(space_);
+    if (!nebula::ok(errOrHost)) {
+        LOG(ERROR) << "Can't get any host according to space";
+        return nebula::error(errOrHost);
+    }
+    if (paras_.size() > 1) {
+        auto concurrency = folly::tryTo<int32_t>(paras_[0]);
+        if (concurrency.hasValue()) {
+            concurrency_ = concurrency.value();
+        }
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
 folly::Future<Status> CompactJobExecutor::executeInternal(HostAddr&& address,
                                                           std::vector<PartitionID>&& parts) {
+    // all the replicas of the parts targeted are compacted, the hosts skip the ones not on them
+    if (!parts_.empty()) {
+        parts = parts_;
+    }
     return adminClient_->addTask(cpp2::AdminCmd::COMPACT, jobId_, taskId_++, space_,
-                                 {std::move(address)}, {}, std::move(parts), concurrency_);
+                                 {std::move(address)}, options_, std::move(parts), concurrency_);
 }
 
 }  // namespace meta
@@ -12,6 +12,13 @@
 namespace nebula {
 namespace meta {
 
+/*
+The paras of the compact job are [concurrency] [options...] space. The options scope the
+compaction, the others are sent to the storage as the task specific paras:
+    parts=<id>,<id>...      the parts to compact, on all the replicas of them
+    tag=<id>, edge=<type>, index=<id>, prefix=<hex>, level=<n>
+The whole space is compacted without any option.
+*/
 class CompactJobExecutor : public SimpleConcurrentJobExecutor {
 public:
     CompactJobExecutor(JobID jobId,
@@ -19,8 +26,20 @@ public:
                        AdminClient* adminClient,
                        const std::vector<std::string>& params);
 
+    bool check() override;
+
+    nebula::cpp2::ErrorCode prepare() override;
+
     folly::Future<Status> executeInternal(HostAddr&& address,
                                           std::vector<PartitionID>&& parts) override;
+
+private:
+    // Parse an option into parts_ or options_, return false if it is invalid
+    bool parseOption(const std::string& option);
+
+private:
+    std::vector<PartitionID>    parts_;
+    std::vector<std::string>    options_;
 };
 
 }  // namespace meta
@@ -13,6 +13,7 @@
 #include <thrift/lib/cpp/util/EnumUtils.h>
 #include "kvstore/Common.h"
 #include "kvstore/KVIterator.h"
+#include "kvstore/MemEngine.h"
 #include "meta/common/MetaCommon.h"
 #include "meta/processors/Common.h"
 #include "meta/processors/admin/AdminClient.h"
@@ -24,6 +25,12 @@
 
 DEFINE_int32(job_check_intervals, 5000, "job intervals in us");
 DEFINE_double(job_expired_secs, 7 * 24 * 60 * 60, "job expired intervals in sec");
+DEFINE_int32(max_running_jobs, 1,
+             "The number of jobs running at once, the jobs of a space run one by one");
+DEFINE_string(job_type_limits, "",
+              "The number of jobs of each type running at once, e.g. \"compact:2,stats:4\"");
+DEFINE_bool(enable_job_cache, false,
+            "Serve the jobs and tasks from the job table in memory on the meta leader");
 
 using nebula::kvstore::KVIterator;
 
@@ -44,6 +51,10 @@ bool JobManager::init(nebula::kvstore::KVStore* store) {
         return false;
     }
     kvStore_ = store;
+    jobTable_.wlock()->term = -1;
+    if (!parseTypeLimits(FLAGS_job_type_limits)) {
+        LOG(WARNING) << "Invalid job_type_limits " << FLAGS_job_type_limits << ", ignore it";
+    }
 
     lowPriorityQueue_ = std::make_unique<folly::UMPSCQueue<JobID, true>>();
     highPriorityQueue_ = std::make_unique<folly::UMPSCQueue<JobID, true>>();
@@ -76,7 +87,7 @@ void JobManager::scheduleThread() {
     LOG(INFO) << "JobManager::runJobBackground() enter";
     while (status_ != JbmgrStatus::STOPPED) {
         int32_t iJob = 0;
-        while (status_ == JbmgrStatus::BUSY || !try_dequeue(iJob)) {
+        while (status_ == JbmgrStatus::BUSY || !pickJob(iJob)) {
             if (status_ == JbmgrStatus::STOPPED) {
                 LOG(INFO) << "[JobManager] detect shutdown called, exit";
                 break;
@@ -84,7 +95,7 @@ void JobManager::scheduleThread() {
             usleep(FLAGS_job_check_intervals);
         }
 
-        auto jobDescRet = JobDescription::loadJobDescription(iJob, kvStore_);
+        auto jobDescRet = loadJob(iJob);
         if (!nebula::ok(jobDescRet)) {
             LOG(ERROR) << "[JobManager] load an invalid job from queue " << iJob;
             continue;   // leader change or archive happend
@@ -97,7 +108,13 @@ void JobManager::scheduleThread() {
         save(jobDesc.jobKey(), jobDesc.jobVal());
         {
             std::lock_guard<std::mutex> lk(statusGuard_);
-            if (status_ == JbmgrStatus::IDLE) {
+            // more jobs are picked until max_running_jobs are running
+            if (concurrent()) {
+                runningJobs_.emplace(iJob, jobDesc);
+            }
+            if (status_ == JbmgrStatus::IDLE &&
+                (!concurrent() ||
+                 static_cast<int32_t>(runningJobs_.size()) >= FLAGS_max_running_jobs)) {
                 status_ = JbmgrStatus::BUSY;
             }
         }
@@ -157,17 +174,14 @@ JobManager::jobFinished(JobID jobId, cpp2::JobStatus jobStatus) {
     SCOPE_EXIT {
         cleanJob(jobId);
     };
-    auto optJobDescRet = JobDescription::loadJobDescription(jobId, kvStore_);
+    auto optJobDescRet = loadJob(jobId);
     if (!nebula::ok(optJobDescRet)) {
         LOG(WARNING) << folly::sformat("can't load job, jobId={}", jobId);
         if (jobStatus != cpp2::JobStatus::STOPPED) {
             // there is a rare condition, that when job finished,
             // the job description is deleted(default more than a week)
             // but stop an invalid job should not set status to idle.
-            std::lock_guard<std::mutex> statusLk(statusGuard_);
-            if (status_ == JbmgrStatus::BUSY) {
-                status_ = JbmgrStatus::IDLE;
-            }
+            releaseJob(jobId);
         }
         return nebula::error(optJobDescRet);
     }
@@ -178,12 +192,7 @@ JobManager::jobFinished(JobID jobId, cpp2::JobStatus jobStatus) {
         // job already been set as finished, failed or stopped
         return nebula::cpp2::ErrorCode::E_SAVE_JOB_FAILURE;
     }
-    {
-        std::lock_guard<std::mutex> statusLk(statusGuard_);
-        if (status_ == JbmgrStatus::BUSY) {
-            status_ = JbmgrStatus::IDLE;
-        }
-    }
+    releaseJob(jobId);
     auto rc = save(optJobDesc.jobKey(), optJobDesc.jobVal());
     if (rc != nebula::cpp2::ErrorCode::SUCCEEDED) {
         return rc;
@@ -230,7 +239,7 @@ JobManager::saveTaskStatus(TaskDescription& td,
     td.setStatus(status);
 
     auto jobId = req.get_job_id();
-    auto optJobDescRet = JobDescription::loadJobDescription(jobId, kvStore_);
+    auto optJobDescRet = loadJob(jobId);
     if (!nebula::ok(optJobDescRet)) {
         auto retCode = nebula::error(optJobDescRet);
         LOG(WARNING) << "LoadJobDesc failed, jobId " << jobId << " error: "
@@ -328,7 +337,7 @@ JobManager::getAllTasks(JobID jobId) {
     std::list<TaskDescription> taskDescriptions;
     auto jobKey = JobDescription::makeJobKey(jobId);
     std::unique_ptr<kvstore::KVIterator> iter;
-    auto rc = kvStore_->prefix(kDefaultSpaceId, kDefaultPartId, jobKey, &iter);
+    auto rc = prefixJobs(kvStore_, jobKey, &iter);
     if (rc != nebula::cpp2::ErrorCode::SUCCEEDED) {
         return rc;
     }
@@ -373,6 +382,93 @@ bool JobManager::try_dequeue(JobID& jobId) {
     return false;
 }
 
+bool JobManager::concurrent() const {
+    return FLAGS_max_running_jobs > 1 || !typeLimits_.empty();
+}
+
+bool JobManager::parseTypeLimits(const std::string& limits) {
+    typeLimits_.clear();
+    std::vector<folly::StringPiece> items;
+    folly::split(',', limits, items, true);
+    for (auto& item : items) {
+        folly::StringPiece name, limit;
+        if (!folly::split(':', item, name, limit)) {
+            typeLimits_.clear();
+            return false;
+        }
+        // the names of the commands, e.g. compact or rebuild_tag_index
+        auto cmdName = name.str();
+        std::transform(cmdName.begin(), cmdName.end(), cmdName.begin(), ::toupper);
+        cpp2::AdminCmd cmd;
+        auto num = folly::tryTo<int32_t>(limit);
+        if (!num.hasValue() || !apache::thrift::util::tryParseEnum(cmdName, &cmd)) {
+            typeLimits_.clear();
+            return false;
+        }
+        typeLimits_[cmd] = num.value();
+    }
+    return true;
+}
+
+bool JobManager::runnable(const JobDescription& jobDesc) const {
+    if (static_cast<int32_t>(runningJobs_.size()) >= std::max(FLAGS_max_running_jobs, 1)) {
+        return false;
+    }
+    auto limit = typeLimits_.find(jobDesc.getCmd());
+    auto paras = jobDesc.getParas();
+    int32_t sameType = 0;
+    for (auto& entry : runningJobs_) {
+        const auto& running = entry.second;
+        auto runningParas = running.getParas();
+        // the jobs of a space conflict, and a job of no space conflicts with all
+        if (runningParas.empty() || paras.empty() || runningParas.back() == paras.back()) {
+            return false;
+        }
+        if (running.getCmd() == jobDesc.getCmd()) {
+            sameType++;
+        }
+    }
+    return limit == typeLimits_.end() || sameType < limit->second;
+}
+
+bool JobManager::pickJob(JobID& jobId) {
+    if (!concurrent()) {
+        return try_dequeue(jobId);
+    }
+    JobID queued = 0;
+    while (try_dequeue(queued)) {
+        pendingJobs_.emplace_back(queued);
+    }
+    std::lock_guard<std::mutex> lk(statusGuard_);
+    // the high priority jobs first, and then the others in the order they are added
+    for (auto high : {true, false}) {
+        for (auto it = pendingJobs_.begin(); it != pendingJobs_.end(); ++it) {
+            auto jobIt = inFlightJobs_.find(*it);
+            if (jobIt == inFlightJobs_.end()) {
+                // stopped or finished, it's skipped once loaded
+                jobId = *it;
+                pendingJobs_.erase(it);
+                return true;
+            }
+            const auto& jobDesc = jobIt->second;
+            if ((jobDesc.getCmd() == cpp2::AdminCmd::STATS) == high && runnable(jobDesc)) {
+                jobId = *it;
+                pendingJobs_.erase(it);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void JobManager::releaseJob(JobID jobId) {
+    std::lock_guard<std::mutex> lk(statusGuard_);
+    runningJobs_.erase(jobId);
+    if (status_ == JbmgrStatus::BUSY) {
+        status_ = JbmgrStatus::IDLE;
+    }
+}
+
 void JobManager::enqueue(const JobID& jobId, const cpp2::AdminCmd& cmd) {
     if (cmd == cpp2::AdminCmd::STATS) {
         highPriorityQueue_->enqueue(jobId);
@@ -384,8 +480,7 @@ void JobManager::enqueue(const JobID& jobId, const cpp2::AdminCmd& cmd) {
 ErrorOr<nebula::cpp2::ErrorCode, std::vector<cpp2::JobDesc>>
 JobManager::showJobs() {
     std::unique_ptr<kvstore::KVIterator> iter;
-    auto retCode = kvStore_->prefix(kDefaultSpaceId, kDefaultPartId,
-                               JobUtil::jobPrefix(), &iter);
+    auto retCode = prefixJobs(kvStore_, JobUtil::jobPrefix(), &iter);
     if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Fetch Jobs Failed, error: " << apache::thrift::util::enumNameSafe(retCode);
         return retCode;
@@ -453,13 +548,22 @@ bool JobManager::isRunningJob(const JobDescription& jobDesc) {
 
 nebula::cpp2::ErrorCode
 JobManager::removeExpiredJobs(std::vector<std::string>&& expiredJobsAndTasks) {
+    if (expiredJobsAndTasks.empty()) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
     nebula::cpp2::ErrorCode ret;
     folly::Baton<true, std::atomic> baton;
+    auto keys = expiredJobsAndTasks;
     kvStore_->asyncMultiRemove(kDefaultSpaceId, kDefaultPartId, std::move(expiredJobsAndTasks),
                                [&](nebula::cpp2::ErrorCode code) {
                                    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                                        LOG(ERROR) << "kvstore asyncRemoveRange failed: "
                                                   << apache::thrift::util::enumNameSafe(code);
+                                   } else {
+                                       auto table = jobTable_.wlock();
+                                       for (auto& key : keys) {
+                                           table->kvs.erase(key);
+                                       }
                                    }
                                    ret = code;
                                    baton.post();
@@ -488,7 +592,7 @@ ErrorOr<nebula::cpp2::ErrorCode, std::pair<cpp2::JobDesc, std::vector<cpp2::Task
 JobManager::showJob(JobID iJob) {
     auto jobKey = JobDescription::makeJobKey(iJob);
     std::unique_ptr<kvstore::KVIterator> iter;
-    auto rc = kvStore_->prefix(kDefaultSpaceId, kDefaultPartId, jobKey, &iter);
+    auto rc = prefixJobs(kvStore_, jobKey, &iter);
     if (rc != nebula::cpp2::ErrorCode::SUCCEEDED) {
         return rc;
     }
@@ -526,7 +630,7 @@ nebula::cpp2::ErrorCode JobManager::stopJob(JobID iJob) {
 ErrorOr<nebula::cpp2::ErrorCode, JobID> JobManager::recoverJob() {
     int32_t recoveredJobNum = 0;
     std::unique_ptr<kvstore::KVIterator> iter;
-    auto retCode = kvStore_->prefix(kDefaultSpaceId, kDefaultPartId, JobUtil::jobPrefix(), &iter);
+    auto retCode = prefixJobs(kvStore_, JobUtil::jobPrefix(), &iter);
     if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Can't find jobs, error: " << apache::thrift::util::enumNameSafe(retCode);
         return retCode;
@@ -566,6 +670,9 @@ nebula::cpp2::ErrorCode JobManager::save(const std::string& k, const std::string
                                 baton.post();
                             });
     baton.wait();
+    if (rc == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        updateJobTable({{k, v}});
+    }
     return rc;
 }
 
@@ -583,9 +690,119 @@ ErrorOr<nebula::cpp2::ErrorCode, GraphSpaceID> JobManager::getSpaceId(const std:
     return *reinterpret_cast<const GraphSpaceID*>(val.c_str());
 }
 
-ErrorOr<nebula::cpp2::ErrorCode, bool> JobManager::checkIndexJobRuning() {
+TermID JobManager::jobTableTerm() {
+    if (!FLAGS_enable_job_cache || kvStore_ == nullptr) {
+        return -1;
+    }
+    auto partRet = kvStore_->part(kDefaultSpaceId, kDefaultPartId);
+    if (!nebula::ok(partRet)) {
+        return -1;
+    }
+    auto part = nebula::value(partRet);
+    return part->isLeader() ? part->termId() : -1;
+}
+
+bool JobManager::isJobTableKey(folly::StringPiece key) {
+    // a job key, or a task key with the job id and the task id
+    return JobDescription::isJobKey(key) ||
+           (key.startsWith(JobUtil::jobPrefix()) &&
+            key.size() == JobUtil::jobPrefix().size() + sizeof(JobID) + sizeof(TaskID));
+}
+
+nebula::cpp2::ErrorCode JobManager::loadJobTable(JobTable* table, TermID term) {
     std::unique_ptr<kvstore::KVIterator> iter;
     auto retCode = kvStore_->prefix(kDefaultSpaceId, kDefaultPartId, JobUtil::jobPrefix(), &iter);
+    if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return retCode;
+    }
+    table->kvs.clear();
+    for (; iter->valid(); iter->next()) {
+        if (isJobTableKey(iter->key())) {
+            table->kvs.emplace(iter->key().str(), iter->val().str());
+        }
+    }
+    table->term = term;
+    LOG(INFO) << "Load " << table->kvs.size() << " jobs and tasks in term " << term;
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+template <class Fn>
+nebula::cpp2::ErrorCode JobManager::readJobTable(TermID term, Fn&& fn) {
+    {
+        auto table = jobTable_.rlock();
+        if (table->term == term) {
+            fn(*table);
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+    }
+    auto table = jobTable_.wlock();
+    if (table->term != term) {
+        auto retCode = loadJobTable(&*table, term);
+        if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return retCode;
+        }
+    }
+    fn(*table);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode JobManager::prefixJobs(kvstore::KVStore* kv,
+                                               const std::string& prefix,
+                                               std::unique_ptr<kvstore::KVIterator>* iter) {
+    auto term = kv == kvStore_ ? jobTableTerm() : -1;
+    if (term < 0) {
+        return kv->prefix(kDefaultSpaceId, kDefaultPartId, prefix, iter);
+    }
+    return readJobTable(term, [&prefix, iter] (const JobTable& table) {
+        std::vector<std::pair<std::string, std::string>> kvs;
+        for (auto it = table.kvs.lower_bound(prefix);
+             it != table.kvs.end() && folly::StringPiece(it->first).startsWith(prefix);
+             ++it) {
+            kvs.emplace_back(it->first, it->second);
+        }
+        *iter = std::make_unique<kvstore::MemIter>(std::move(kvs));
+    });
+}
+
+ErrorOr<nebula::cpp2::ErrorCode, JobDescription> JobManager::loadJob(JobID jobId) {
+    auto term = jobTableTerm();
+    if (term < 0) {
+        return JobDescription::loadJobDescription(jobId, kvStore_);
+    }
+    auto key = JobDescription::makeJobKey(jobId);
+    std::string val;
+    bool found = false;
+    auto retCode = readJobTable(term, [&] (const JobTable& table) {
+        auto it = table.kvs.find(key);
+        if (it != table.kvs.end()) {
+            val = it->second;
+            found = true;
+        }
+    });
+    if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return retCode;
+    }
+    if (!found) {
+        return nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND;
+    }
+    return JobDescription::makeJobDescription(key, val);
+}
+
+void JobManager::updateJobTable(const std::vector<kvstore::KV>& data) {
+    auto table = jobTable_.wlock();
+    if (table->term < 0) {
+        return;
+    }
+    for (auto& kv : data) {
+        if (isJobTableKey(kv.first)) {
+            table->kvs[kv.first] = kv.second;
+        }
+    }
+}
+
+ErrorOr<nebula::cpp2::ErrorCode, bool> JobManager::checkIndexJobRuning() {
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto retCode = prefixJobs(kvStore_, JobUtil::jobPrefix(), &iter);
     if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Fetch Jobs Failed, error: " << apache::thrift::util::enumNameSafe(retCode);
         return retCode;
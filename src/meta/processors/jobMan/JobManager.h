@@ -14,6 +14,7 @@
 #include <gtest/gtest_prod.h>
 #include <folly/concurrency/UnboundedQueue.h>
 #include <folly/concurrency/ConcurrentHashMap.h>
+#include <folly/Synchronized.h>
 #include "kvstore/NebulaStore.h"
 #include "meta/processors/jobMan/JobStatus.h"
 #include "meta/processors/jobMan/JobDescription.h"
@@ -38,6 +39,8 @@ class JobManager : public nebula::cpp::NonCopyable, public nebula::cpp::NonMovab
     FRIEND_TEST(JobManagerTest, recoverJob);
     FRIEND_TEST(JobManagerTest, AddRebuildTagIndexJob);
     FRIEND_TEST(JobManagerTest, AddRebuildEdgeIndexJob);
+    FRIEND_TEST(JobManagerTest, JobTable);
+    FRIEND_TEST(JobManagerTest, ConcurrentJobs);
     FRIEND_TEST(GetStatisTest, StatisJob);
     FRIEND_TEST(GetStatisTest, MockSingleMachineTest);
     FRIEND_TEST(GetStatisTest, MockMultiMachineTest);
@@ -101,12 +104,50 @@ public:
 
     ErrorOr<nebula::cpp2::ErrorCode, bool> checkIndexJobRuning();
 
+    /*
+     * Iterate the jobs and tasks with the prefix in kv, which are served from the job table in
+     * memory on the meta leader if enable_job_cache is set and kv is the store of the manager
+     * */
+    nebula::cpp2::ErrorCode prefixJobs(kvstore::KVStore* kv,
+                                       const std::string& prefix,
+                                       std::unique_ptr<kvstore::KVIterator>* iter);
+
+    ErrorOr<nebula::cpp2::ErrorCode, JobDescription> loadJob(JobID jobId);
+
+    /*
+     * Keep the job table in sync with the jobs and tasks written into the kvstore
+     * */
+    void updateJobTable(const std::vector<kvstore::KV>& data);
+
 private:
     JobManager() = default;
 
     void scheduleThread();
     void scheduleThreadOld();
 
+    /*
+     * Pick the next job to run. The jobs run one by one if max_running_jobs is 1 and there is
+     * no job_type_limits, otherwise the jobs queued are kept pending until they could run
+     * along with the jobs running, see runnable.
+     * */
+    bool pickJob(JobID& jobId);
+
+    // Whether more than one job could run at once
+    bool concurrent() const;
+
+    /*
+     * Whether the job could run along with the jobs running, within max_running_jobs and the
+     * limit of its type. The jobs of a space never run at once, e.g. a compaction and an index
+     * rebuild, and a job of no space runs alone.
+     * */
+    bool runnable(const JobDescription& jobDesc) const;
+
+    // Parse job_type_limits, the limits are cleared if it's invalid
+    bool parseTypeLimits(const std::string& limits);
+
+    // The job is not running any more
+    void releaseJob(JobID jobId);
+
     bool runJobInternal(const JobDescription& jobDesc);
     bool runJobInternalOld(const JobDescription& jobDesc);
 
@@ -127,6 +168,29 @@ private:
     nebula::cpp2::ErrorCode
     saveTaskStatus(TaskDescription& td, const cpp2::ReportTaskReq& req);
 
+    /*
+     * The jobs and tasks in the order of their keys, the same as they are in the kvstore. They
+     * are loaded once the meta leader term changes, so the jobs written by the leader before
+     * are seen, and kept in sync by the writes of the leader since then.
+     * */
+    struct JobTable {
+        // the term the table is loaded in, -1 if not loaded
+        TermID                                  term{-1};
+        std::map<std::string, std::string>      kvs;
+    };
+
+    // The meta leader term if the job table is used, otherwise -1
+    TermID jobTableTerm();
+
+    // Call fn with the job table loaded in the term
+    template <class Fn>
+    nebula::cpp2::ErrorCode readJobTable(TermID term, Fn&& fn);
+
+    // Load the job table locked in the term from the kvstore
+    nebula::cpp2::ErrorCode loadJobTable(JobTable* table, TermID term);
+
+    static bool isJobTableKey(folly::StringPiece key);
+
 private:
     // Todo(pandasheep)
     // When folly is upgraded, PriorityUMPSCQueueSet can be used
@@ -145,6 +209,14 @@ private:
 
     std::mutex                                         muReportFinish_;
     std::mutex                                         muJobFinished_;
+
+    folly::Synchronized<JobTable>                      jobTable_;
+
+    // The jobs running when more than one job could run, guarded by statusGuard_
+    std::unordered_map<JobID, JobDescription>          runningJobs_;
+    // The jobs dequeued which could not run yet, only used by the schedule thread
+    std::list<JobID>                                   pendingJobs_;
+    std::unordered_map<cpp2::AdminCmd, int32_t>        typeLimits_;
 };
 
 }  // namespace meta
@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/jobMan/ListEdgeIndexStatusProcessor.h"
+#include "meta/processors/jobMan/JobManager.h"
 
 namespace nebula {
 namespace meta {
@@ -13,7 +14,7 @@ void ListEdgeIndexStatusProcessor::process(const cpp2::ListIndexStatusReq& req)
     auto curSpaceId = req.get_space_id();
     CHECK_SPACE_ID_AND_RETURN(curSpaceId);
     std::unique_ptr<kvstore::KVIterator> iter;
-    auto retCode = kvstore_->prefix(kDefaultSpaceId, kDefaultPartId, JobUtil::jobPrefix(), &iter);
+    auto retCode = JobManager::getInstance()->prefixJobs(kvstore_, JobUtil::jobPrefix(), &iter);
     if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Loading Job Failed" << apache::thrift::util::enumNameSafe(retCode);
         handleErrorCode(retCode);
@@ -13,6 +13,7 @@
 #include "meta/processors/admin/AdminClient.h"
 #include "meta/processors/jobMan/CompactJobExecutor.h"
 #include "meta/processors/jobMan/FlushJobExecutor.h"
+#include "meta/processors/jobMan/JobManager.h"
 #include "meta/processors/jobMan/MetaJobExecutor.h"
 #include "meta/processors/jobMan/RebuildTagJobExecutor.h"
 #include "meta/processors/jobMan/RebuildEdgeJobExecutor.h"
@@ -219,6 +220,7 @@ nebula::cpp2::ErrorCode MetaJobExecutor::execute() {
     for (auto i = 0U; i != addresses.size(); ++i) {
         TaskDescription task(jobId_, i, addresses[i].first);
         std::vector<kvstore::KV> data{{task.taskKey(), task.taskVal()}};
+        auto written = data;
         folly::Baton<true, std::atomic> baton;
         auto rc = nebula::cpp2::ErrorCode::SUCCEEDED;
         kvstore_->asyncMultiPut(kDefaultSpaceId,
@@ -234,6 +236,7 @@ nebula::cpp2::ErrorCode MetaJobExecutor::execute() {
                       << apache::thrift::util::enumNameSafe(rc);
             return rc;
         }
+        JobManager::getInstance()->updateJobTable(written);
     }
 
     std::vector<folly::SemiFuture<Status>> futs;
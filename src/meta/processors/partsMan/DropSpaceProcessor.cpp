@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/partsMan/DropSpaceProcessor.h"
+#include "meta/SchemaCache.h"
 
 namespace nebula {
 namespace meta {
@@ -101,6 +102,9 @@ void DropSpaceProcessor::process(const cpp2::DropSpaceReq& req) {
     auto statiskey = MetaServiceUtils::statisKey(spaceId);
     deleteKeys.emplace_back(statiskey);
 
+    // The zone preferred by the leaders
+    deleteKeys.emplace_back(MetaServiceUtils::leaderZoneKey(spaceId));
+
     // 6. Delte related fulltext index meta data
     auto ftPrefix = MetaServiceUtils::fulltextIndexPrefix();
     auto ftRet = doPrefix(ftPrefix);
@@ -122,6 +126,8 @@ void DropSpaceProcessor::process(const cpp2::DropSpaceReq& req) {
     }
 
     doSyncMultiRemoveAndUpdate(std::move(deleteKeys));
+    SchemaCache::invalidate(spaceId);
+    IndexCache::invalidate(spaceId);
     LOG(INFO) << "Drop space " << spaceName << ", id " << spaceId;
 }
 
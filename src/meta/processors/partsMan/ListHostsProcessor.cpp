@@ -122,6 +122,7 @@ nebula::cpp2::ErrorCode ListHostsProcessor::allHostsWithStatus(cpp2::HostRole ro
 
         cpp2::HostItem item;
         auto host = MetaServiceUtils::parseHostKey(iter->key());
+        ActiveHostsMan::mergeHeartbeat(host, &info);
         item.set_hostAddr(std::move(host));
 
         item.set_role(info.role_);
@@ -278,7 +279,10 @@ void ListHostsProcessor::removeExpiredHosts(std::vector<std::string>&& removeHos
             if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 LOG(ERROR) << "Async remove long time offline hosts failed: "
                            << apache::thrift::util::enumNameSafe(code);
+                return;
             }
+            // the hosts removed are dropped from memory as well
+            ActiveHostsMan::resetRegistry();
         });
 }
 
@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/schemaMan/AlterEdgeProcessor.h"
+#include "meta/SchemaCache.h"
 #include "meta/processors/schemaMan/SchemaUtil.h"
 
 namespace nebula {
@@ -16,7 +17,7 @@ void AlterEdgeProcessor::process(const cpp2::AlterEdgeReq& req) {
     auto edgeName = req.get_edge_name();
 
     folly::SharedMutex::ReadHolder rHolder(LockUtils::snapshotLock());
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::edgeLock());
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::edgeLock(spaceId));
     auto ret = getEdgeType(spaceId, edgeName);
     if (!nebula::ok(ret)) {
         auto retCode = nebula::error(ret);
@@ -158,6 +159,7 @@ void AlterEdgeProcessor::process(const cpp2::AlterEdgeReq& req) {
     data.emplace_back(MetaServiceUtils::schemaEdgeKey(spaceId, edgeType, version),
                       MetaServiceUtils::schemaVal(edgeName, schema));
     resp_.set_id(to(edgeType, EntryType::EDGE));
+    SchemaCache::invalidateEdges(spaceId);
     doSyncPutAndUpdate(std::move(data));
 }
 
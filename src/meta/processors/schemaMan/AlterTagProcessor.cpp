@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/schemaMan/AlterTagProcessor.h"
+#include "meta/SchemaCache.h"
 #include "meta/processors/schemaMan/SchemaUtil.h"
 
 namespace nebula {
@@ -16,7 +17,7 @@ void AlterTagProcessor::process(const cpp2::AlterTagReq& req) {
     auto tagName = req.get_tag_name();
 
     folly::SharedMutex::ReadHolder rHolder(LockUtils::snapshotLock());
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::tagLock());
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::tagLock(spaceId));
     auto ret = getTagId(spaceId, tagName);
     if (!nebula::ok(ret)) {
         auto retCode = nebula::error(ret);
@@ -151,6 +152,7 @@ void AlterTagProcessor::process(const cpp2::AlterTagReq& req) {
     data.emplace_back(MetaServiceUtils::schemaTagKey(spaceId, tagId, version),
                       MetaServiceUtils::schemaVal(tagName, schema));
     resp_.set_id(to(tagId, EntryType::TAG));
+    SchemaCache::invalidateTags(spaceId);
     doSyncPutAndUpdate(std::move(data));
 }
 
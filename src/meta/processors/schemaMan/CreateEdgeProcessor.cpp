@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/schemaMan/CreateEdgeProcessor.h"
+#include "meta/SchemaCache.h"
 #include "meta/processors/schemaMan/SchemaUtil.h"
 
 namespace nebula {
@@ -17,7 +18,7 @@ void CreateEdgeProcessor::process(const cpp2::CreateEdgeReq& req) {
     {
         // if there is an tag of the same name
         // TODO: there exists race condition, we should address it in the future
-        folly::SharedMutex::ReadHolder rHolder(LockUtils::tagLock());
+        folly::SharedMutex::ReadHolder rHolder(LockUtils::tagLock(spaceId));
         auto conflictRet = getTagId(spaceId, edgeName);
         if (nebula::ok(conflictRet)) {
             LOG(ERROR) << "Failed to create edge `" << edgeName
@@ -49,7 +50,7 @@ void CreateEdgeProcessor::process(const cpp2::CreateEdgeReq& req) {
     schema.set_columns(std::move(columns));
     schema.set_schema_prop(req.get_schema().get_schema_prop());
 
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::edgeLock());
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::edgeLock(spaceId));
     auto ret = getEdgeType(spaceId, edgeName);
     if (nebula::ok(ret)) {
         if (req.get_if_not_exists()) {
@@ -89,6 +90,7 @@ void CreateEdgeProcessor::process(const cpp2::CreateEdgeReq& req) {
 
     LOG(INFO) << "Create Edge " << edgeName << ", edgeType " << edgeType;
     resp_.set_id(to(edgeType, EntryType::EDGE));
+    SchemaCache::invalidateEdges(spaceId);
     doSyncPutAndUpdate(std::move(data));
 }
 
@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/schemaMan/CreateTagProcessor.h"
+#include "meta/SchemaCache.h"
 #include "meta/processors/schemaMan/SchemaUtil.h"
 
 namespace nebula {
@@ -17,7 +18,7 @@ void CreateTagProcessor::process(const cpp2::CreateTagReq& req) {
     {
         // if there is an edge of the same name
         // TODO: there exists race condition, we should address it in the future
-        folly::SharedMutex::ReadHolder rHolder(LockUtils::edgeLock());
+        folly::SharedMutex::ReadHolder rHolder(LockUtils::edgeLock(spaceId));
         auto conflictRet = getEdgeType(spaceId, tagName);
         if (nebula::ok(conflictRet)) {
             LOG(ERROR) << "Failed to create tag `" << tagName
@@ -49,7 +50,7 @@ void CreateTagProcessor::process(const cpp2::CreateTagReq& req) {
     schema.set_columns(std::move(columns));
     schema.set_schema_prop(req.get_schema().get_schema_prop());
 
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::tagLock());
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::tagLock(spaceId));
     auto ret = getTagId(spaceId, tagName);
     if (nebula::ok(ret)) {
         if (req.get_if_not_exists()) {
@@ -90,6 +91,7 @@ void CreateTagProcessor::process(const cpp2::CreateTagReq& req) {
     LOG(INFO) << "Create Tag " << tagName << ", TagID " << tagId;
 
     resp_.set_id(to(tagId, EntryType::TAG));
+    SchemaCache::invalidateTags(spaceId);
     doSyncPutAndUpdate(std::move(data));
 }
 
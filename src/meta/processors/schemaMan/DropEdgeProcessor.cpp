@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/schemaMan/DropEdgeProcessor.h"
+#include "meta/SchemaCache.h"
 
 namespace nebula {
 namespace meta {
@@ -14,7 +15,7 @@ void DropEdgeProcessor::process(const cpp2::DropEdgeReq& req) {
     CHECK_SPACE_ID_AND_RETURN(spaceId);
 
     folly::SharedMutex::ReadHolder rHolder(LockUtils::snapshotLock());
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::edgeLock());
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::edgeLock(spaceId));
     auto edgeName = req.get_edge_name();
 
     EdgeType edgeType;
@@ -79,6 +80,7 @@ void DropEdgeProcessor::process(const cpp2::DropEdgeReq& req) {
     auto keys = nebula::value(ret);
     keys.emplace_back(std::move(indexKey));
     LOG(INFO) << "Drop Edge " << edgeName;
+    SchemaCache::invalidateEdges(spaceId);
     doSyncMultiRemoveAndUpdate(std::move(keys));
 }
 
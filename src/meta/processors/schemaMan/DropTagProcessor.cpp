@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/schemaMan/DropTagProcessor.h"
+#include "meta/SchemaCache.h"
 
 namespace nebula {
 namespace meta {
@@ -14,7 +15,7 @@ void DropTagProcessor::process(const cpp2::DropTagReq& req) {
     CHECK_SPACE_ID_AND_RETURN(spaceId);
 
     folly::SharedMutex::ReadHolder rHolder(LockUtils::snapshotLock());
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::tagLock());
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::tagLock(spaceId));
     auto tagName = req.get_tag_name();
 
     TagID tagId;
@@ -79,6 +80,7 @@ void DropTagProcessor::process(const cpp2::DropTagReq& req) {
     auto keys = nebula::value(ret);
     keys.emplace_back(indexKey);
     LOG(INFO) << "Drop Tag " << tagName;
+    SchemaCache::invalidateTags(spaceId);
     doSyncMultiRemoveAndUpdate(std::move(keys));
 }
 
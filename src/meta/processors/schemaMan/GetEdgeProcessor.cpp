@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/schemaMan/GetEdgeProcessor.h"
+#include "meta/SchemaCache.h"
 
 namespace nebula {
 namespace meta {
@@ -15,7 +16,11 @@ void GetEdgeProcessor::process(const cpp2::GetEdgeReq& req) {
     auto edgeName = req.get_edge_name();
     auto ver = req.get_version();
 
-    folly::SharedMutex::ReadHolder rHolder(LockUtils::edgeLock());
+    folly::SharedMutex::ReadHolder rHolder(LockUtils::edgeLock(spaceId));
+    if (SchemaCache::enabled()) {
+        getCached(spaceId, edgeName, ver);
+        return;
+    }
     auto edgeTypeRet = getEdgeType(spaceId, edgeName);
     if (!nebula::ok(edgeTypeRet)) {
         LOG(ERROR) << "Get edge " << edgeName << " failed.";
@@ -66,6 +71,37 @@ void GetEdgeProcessor::process(const cpp2::GetEdgeReq& req) {
     onFinished();
 }
 
+void GetEdgeProcessor::getCached(GraphSpaceID spaceId, const std::string& edgeName, SchemaVer ver) {
+    auto cached = SchemaCache::edges(kvstore_, spaceId);
+    if (!nebula::ok(cached)) {
+        LOG(ERROR) << "Get Edge SpaceID: " << spaceId << ", edgeName: " << edgeName << " failed.";
+        handleErrorCode(nebula::error(cached));
+        onFinished();
+        return;
+    }
+    auto edges = nebula::value(cached);
+    // the latest version of an edge is the first one of its items
+    auto it = std::find_if(edges->begin(), edges->end(), [&] (const auto& item) {
+        return item.get_edge_name() == edgeName && (ver < 0 || item.get_version() == ver);
+    });
+    if (it == edges->end()) {
+        auto found = std::any_of(edges->begin(), edges->end(), [&] (const auto& item) {
+            return item.get_edge_name() == edgeName;
+        });
+        LOG(ERROR) << "Get Edge SpaceID: " << spaceId << ", edgeName: " << edgeName
+                   << ", version " << ver << " not found.";
+        handleErrorCode(found ? nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND
+                              : nebula::cpp2::ErrorCode::E_EDGE_NOT_FOUND);
+        onFinished();
+        return;
+    }
+    VLOG(3) << "Get Edge SpaceID: " << spaceId << ", edgeName: " << edgeName
+            << ", version " << ver;
+    handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
+    resp_.set_schema(it->get_schema());
+    onFinished();
+}
+
 }  // namespace meta
 }  // namespace nebula
 
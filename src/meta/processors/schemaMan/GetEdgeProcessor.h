@@ -21,6 +21,9 @@ public:
     void process(const cpp2::GetEdgeReq& req);
 
 private:
+    // Serve the schema from the edges of SchemaCache
+    void getCached(GraphSpaceID spaceId, const std::string& edgeName, SchemaVer ver);
+
     explicit GetEdgeProcessor(kvstore::KVStore* kvstore)
         : BaseProcessor<cpp2::GetEdgeResp>(kvstore) {}
 };
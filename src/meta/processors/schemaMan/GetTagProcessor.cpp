@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/schemaMan/GetTagProcessor.h"
+#include "meta/SchemaCache.h"
 
 namespace nebula {
 namespace meta {
@@ -15,7 +16,11 @@ void GetTagProcessor::process(const cpp2::GetTagReq& req) {
     auto tagName = req.get_tag_name();
     auto ver = req.get_version();
 
-    folly::SharedMutex::ReadHolder rHolder(LockUtils::tagLock());
+    folly::SharedMutex::ReadHolder rHolder(LockUtils::tagLock(spaceId));
+    if (SchemaCache::enabled()) {
+        getCached(spaceId, tagName, ver);
+        return;
+    }
     auto tagIdRet = getTagId(spaceId, tagName);
     if (!nebula::ok(tagIdRet)) {
         LOG(ERROR) << "Get tag " << tagName << " failed.";
@@ -67,6 +72,37 @@ void GetTagProcessor::process(const cpp2::GetTagReq& req) {
     onFinished();
 }
 
+void GetTagProcessor::getCached(GraphSpaceID spaceId, const std::string& tagName, SchemaVer ver) {
+    auto cached = SchemaCache::tags(kvstore_, spaceId);
+    if (!nebula::ok(cached)) {
+        LOG(ERROR) << "Get Tag SpaceID: " << spaceId << ", tagName: " << tagName << " failed.";
+        handleErrorCode(nebula::error(cached));
+        onFinished();
+        return;
+    }
+    auto tags = nebula::value(cached);
+    // the latest version of a tag is the first one of its items
+    auto it = std::find_if(tags->begin(), tags->end(), [&] (const auto& item) {
+        return item.get_tag_name() == tagName && (ver < 0 || item.get_version() == ver);
+    });
+    if (it == tags->end()) {
+        auto found = std::any_of(tags->begin(), tags->end(), [&] (const auto& item) {
+            return item.get_tag_name() == tagName;
+        });
+        LOG(ERROR) << "Get Tag SpaceID: " << spaceId << ", tagName: " << tagName
+                   << ", version " << ver << " not found.";
+        handleErrorCode(found ? nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND
+                              : nebula::cpp2::ErrorCode::E_TAG_NOT_FOUND);
+        onFinished();
+        return;
+    }
+    VLOG(3) << "Get Tag SpaceID: " << spaceId << ", tagName: " << tagName
+            << ", version " << ver;
+    handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
+    resp_.set_schema(it->get_schema());
+    onFinished();
+}
+
 }  // namespace meta
 }  // namespace nebula
 
@@ -21,6 +21,9 @@ public:
     void process(const cpp2::GetTagReq& req);
 
 private:
+    // Serve the schema from the tags of SchemaCache
+    void getCached(GraphSpaceID spaceId, const std::string& tagName, SchemaVer ver);
+
     explicit GetTagProcessor(kvstore::KVStore* kvstore)
         : BaseProcessor<cpp2::GetTagResp>(kvstore) {}
 };
@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/schemaMan/ListEdgesProcessor.h"
+#include "meta/SchemaCache.h"
 
 namespace nebula {
 namespace meta {
@@ -13,7 +14,21 @@ void ListEdgesProcessor::process(const cpp2::ListEdgesReq& req) {
     GraphSpaceID spaceId = req.get_space_id();
     CHECK_SPACE_ID_AND_RETURN(spaceId);
 
-    folly::SharedMutex::ReadHolder rHolder(LockUtils::edgeLock());
+    folly::SharedMutex::ReadHolder rHolder(LockUtils::edgeLock(spaceId));
+    if (SchemaCache::enabled()) {
+        auto cached = SchemaCache::edges(kvstore_, spaceId);
+        if (!nebula::ok(cached)) {
+            LOG(ERROR) << "List Edges failed, SpaceID: " << spaceId;
+            handleErrorCode(nebula::error(cached));
+            onFinished();
+            return;
+        }
+        resp_.set_edges(*nebula::value(cached));
+        handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
+        onFinished();
+        return;
+    }
+
     auto prefix = MetaServiceUtils::schemaEdgesPrefix(spaceId);
     auto ret = doPrefix(prefix);
     if (!nebula::ok(ret)) {
@@ -23,24 +38,7 @@ void ListEdgesProcessor::process(const cpp2::ListEdgesReq& req) {
         return;
     }
 
-    auto iter = nebula::value(ret).get();
-    std::vector<nebula::meta::cpp2::EdgeItem> edges;
-    while (iter->valid()) {
-        auto key = iter->key();
-        auto val = iter->val();
-        auto edgeType = *reinterpret_cast<const EdgeType *>(key.data() + prefix.size());
-        auto version = MetaServiceUtils::parseEdgeVersion(key);
-        auto nameLen = *reinterpret_cast<const int32_t *>(val.data());
-        auto edgeName = val.subpiece(sizeof(int32_t), nameLen).str();
-        auto schema = MetaServiceUtils::parseSchema(val);
-        cpp2::EdgeItem edge;
-        edge.set_edge_type(edgeType);
-        edge.set_edge_name(std::move(edgeName));
-        edge.set_version(version);
-        edge.set_schema(std::move(schema));
-        edges.emplace_back(std::move(edge));
-        iter->next();
-    }
+    auto edges = SchemaCache::loadEdges(nebula::value(ret).get(), prefix);
     resp_.set_edges(std::move(edges));
     handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
     onFinished();
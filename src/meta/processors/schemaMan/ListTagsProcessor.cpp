@@ -5,6 +5,7 @@
  */
 
 #include "meta/processors/schemaMan/ListTagsProcessor.h"
+#include "meta/SchemaCache.h"
 
 namespace nebula {
 namespace meta {
@@ -13,7 +14,21 @@ void ListTagsProcessor::process(const cpp2::ListTagsReq& req) {
     GraphSpaceID spaceId = req.get_space_id();
     CHECK_SPACE_ID_AND_RETURN(spaceId);
 
-    folly::SharedMutex::ReadHolder rHolder(LockUtils::tagLock());
+    folly::SharedMutex::ReadHolder rHolder(LockUtils::tagLock(spaceId));
+    if (SchemaCache::enabled()) {
+        auto cached = SchemaCache::tags(kvstore_, spaceId);
+        if (!nebula::ok(cached)) {
+            LOG(ERROR) << "List Tags failed, SpaceID: " << spaceId;
+            handleErrorCode(nebula::error(cached));
+            onFinished();
+            return;
+        }
+        resp_.set_tags(*nebula::value(cached));
+        handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
+        onFinished();
+        return;
+    }
+
     auto prefix = MetaServiceUtils::schemaTagsPrefix(spaceId);
     auto ret = doPrefix(prefix);
     if (!nebula::ok(ret)) {
@@ -23,24 +38,7 @@ void ListTagsProcessor::process(const cpp2::ListTagsReq& req) {
         return;
     }
 
-    auto iter = nebula::value(ret).get();
-    std::vector<nebula::meta::cpp2::TagItem> tags;
-    while (iter->valid()) {
-        auto key = iter->key();
-        auto val = iter->val();
-        auto tagID = *reinterpret_cast<const TagID *>(key.data() + prefix.size());
-        auto version = MetaServiceUtils::parseTagVersion(key);
-        auto nameLen = *reinterpret_cast<const int32_t *>(val.data());
-        auto tagName = val.subpiece(sizeof(int32_t), nameLen).str();
-        auto schema = MetaServiceUtils::parseSchema(val);
-        cpp2::TagItem item;
-        item.set_tag_id(tagID);
-        item.set_tag_name(std::move(tagName));
-        item.set_version(version);
-        item.set_schema(std::move(schema));
-        tags.emplace_back(std::move(item));
-        iter->next();
-    }
+    auto tags = SchemaCache::loadTags(nebula::value(ret).get(), prefix);
     resp_.set_tags(std::move(tags));
     handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
     onFinished();
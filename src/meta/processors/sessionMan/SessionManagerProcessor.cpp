@@ -5,12 +5,15 @@
  */
 
 #include "meta/processors/sessionMan/SessionManagerProcessor.h"
+#include "meta/processors/sessionMan/SessionTable.h"
 
 namespace nebula {
 namespace meta {
 
 void CreateSessionProcessor::process(const cpp2::CreateSessionReq& req) {
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::sessionLock());
+    // The session table has its own locks
+    auto* table = SessionTable::get(kvstore_);
+    folly::SharedMutex::WriteHolder wHolder(table != nullptr ? nullptr : &LockUtils::sessionLock());
     const auto& user = req.get_user();
     auto ret = userExist(user);
     if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
@@ -30,11 +33,15 @@ void CreateSessionProcessor::process(const cpp2::CreateSessionReq& req) {
     session.set_graph_addr(req.get_graph_addr());
     session.set_client_ip(req.get_client_ip());
 
-    std::vector<kvstore::KV> data;
-    data.emplace_back(MetaServiceUtils::sessionKey(session.get_session_id()),
-                      MetaServiceUtils::sessionVal(session));
     resp_.set_session(session);
-    ret = doSyncPut(std::move(data));
+    if (table != nullptr) {
+        ret = table->addSession(session);
+    } else {
+        std::vector<kvstore::KV> data;
+        data.emplace_back(MetaServiceUtils::sessionKey(session.get_session_id()),
+                          MetaServiceUtils::sessionVal(session));
+        ret = doSyncPut(std::move(data));
+    }
     if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Put data error on meta server, errorCode: "
                    << apache::thrift::util::enumNameSafe(ret);
@@ -45,6 +52,11 @@ void CreateSessionProcessor::process(const cpp2::CreateSessionReq& req) {
 
 
 void UpdateSessionsProcessor::process(const cpp2::UpdateSessionsReq& req) {
+    auto* table = SessionTable::get(kvstore_);
+    if (table != nullptr) {
+        updateInTable(table, req);
+        return;
+    }
     folly::SharedMutex::WriteHolder wHolder(LockUtils::sessionLock());
     std::vector<kvstore::KV> data;
     std::unordered_map<nebula::SessionID,
@@ -112,7 +124,66 @@ void UpdateSessionsProcessor::process(const cpp2::UpdateSessionsReq& req) {
 }
 
 
+void UpdateSessionsProcessor::updateInTable(SessionTable* table,
+                                            const cpp2::UpdateSessionsReq& req) {
+    std::unordered_map<nebula::SessionID,
+                       std::unordered_map<nebula::ExecutionPlanID, cpp2::QueryDesc>>
+        killedQueries;
+    for (auto session : req.get_sessions()) {
+        auto sessionId = session.get_session_id();
+        auto ret = table->updateSession(sessionId, [&] (cpp2::Session* sessionInMeta) {
+            // the same as the update written at once, except it's only marked dirty
+            auto& newQueries = *session.queries_ref();
+            std::unordered_map<nebula::ExecutionPlanID, cpp2::QueryDesc> killedInSession;
+            for (const auto& savedQuery : sessionInMeta->get_queries()) {
+                auto newQuery = newQueries.find(savedQuery.first);
+                if (newQuery == newQueries.end()) {
+                    continue;
+                }
+                if (savedQuery.second.get_status() == cpp2::QueryStatus::KILLING) {
+                    newQuery->second.set_status(cpp2::QueryStatus::KILLING);
+                    killedInSession.emplace(savedQuery.first, savedQuery.second);
+                }
+            }
+            if (!killedInSession.empty()) {
+                killedQueries[sessionId] = std::move(killedInSession);
+            }
+            if (sessionInMeta->get_update_time() > session.get_update_time()) {
+                VLOG(3) << "The session id: " << sessionId
+                        << ", the new update time: " << session.get_update_time()
+                        << ", the old update time: " << sessionInMeta->get_update_time();
+                return false;
+            }
+            *sessionInMeta = std::move(session);
+            return true;
+        });
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(WARNING) << "Session id `" << sessionId << "' not found";
+            handleErrorCode(ret);
+            onFinished();
+            return;
+        }
+    }
+    resp_.set_killed_queries(std::move(killedQueries));
+    handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
+    onFinished();
+}
+
+
 void ListSessionsProcessor::process(const cpp2::ListSessionsReq&) {
+    auto* table = SessionTable::get(kvstore_);
+    if (table != nullptr) {
+        auto sessionsRet = table->listSessions();
+        if (!nebula::ok(sessionsRet)) {
+            handleErrorCode(nebula::error(sessionsRet));
+            onFinished();
+            return;
+        }
+        resp_.set_sessions(std::move(nebula::value(sessionsRet)));
+        handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
+        onFinished();
+        return;
+    }
     folly::SharedMutex::ReadHolder rHolder(LockUtils::sessionLock());
     auto &prefix = MetaServiceUtils::sessionPrefix();
     auto ret = doPrefix(prefix);
@@ -140,8 +211,22 @@ void ListSessionsProcessor::process(const cpp2::ListSessionsReq&) {
 
 
 void GetSessionProcessor::process(const cpp2::GetSessionReq& req) {
-    folly::SharedMutex::ReadHolder rHolder(LockUtils::sessionLock());
     auto sessionId = req.get_session_id();
+    auto* table = SessionTable::get(kvstore_);
+    if (table != nullptr) {
+        auto sessionRet = table->getSession(sessionId);
+        if (!nebula::ok(sessionRet)) {
+            LOG(ERROR) << "Session id `" << sessionId << "' not found";
+            handleErrorCode(nebula::error(sessionRet));
+            onFinished();
+            return;
+        }
+        resp_.set_session(std::move(nebula::value(sessionRet)));
+        handleErrorCode(nebula::cpp2::ErrorCode::SUCCEEDED);
+        onFinished();
+        return;
+    }
+    folly::SharedMutex::ReadHolder rHolder(LockUtils::sessionLock());
     auto sessionKey = MetaServiceUtils::sessionKey(sessionId);
     auto ret = doGet(sessionKey);
     if (!nebula::ok(ret)) {
@@ -162,8 +247,19 @@ void GetSessionProcessor::process(const cpp2::GetSessionReq& req) {
 }
 
 void RemoveSessionProcessor::process(const cpp2::RemoveSessionReq& req) {
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::sessionLock());
     auto sessionId = req.get_session_id();
+    auto* table = SessionTable::get(kvstore_);
+    if (table != nullptr) {
+        auto code = table->removeSession(sessionId);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Remove session id `" << sessionId << "' failed, errorCode: "
+                       << apache::thrift::util::enumNameSafe(code);
+        }
+        handleErrorCode(code);
+        onFinished();
+        return;
+    }
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::sessionLock());
     auto sessionKey = MetaServiceUtils::sessionKey(sessionId);
     auto ret = doGet(sessionKey);
     if (!nebula::ok(ret)) {
@@ -182,8 +278,13 @@ void RemoveSessionProcessor::process(const cpp2::RemoveSessionReq& req) {
 }
 
 void KillQueryProcessor::process(const cpp2::KillQueryReq& req) {
-    folly::SharedMutex::WriteHolder wHolder(LockUtils::sessionLock());
     auto& killQueries = req.get_kill_queries();
+    auto* table = SessionTable::get(kvstore_);
+    if (table != nullptr) {
+        killInTable(table, killQueries);
+        return;
+    }
+    folly::SharedMutex::WriteHolder wHolder(LockUtils::sessionLock());
 
     std::vector<kvstore::KV> data;
     for (auto& kv : killQueries) {
@@ -225,5 +326,46 @@ void KillQueryProcessor::process(const cpp2::KillQueryReq& req) {
     onFinished();
 }
 
+
+void KillQueryProcessor::killInTable(
+        SessionTable* table,
+        const std::unordered_map<SessionID, std::unordered_set<ExecutionPlanID>>& killQueries) {
+    for (auto& kv : killQueries) {
+        auto sessionId = kv.first;
+        auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
+        auto ret = table->updateSession(sessionId, [&] (cpp2::Session* session) {
+            for (auto& epId : kv.second) {
+                auto query = session->queries_ref()->find(epId);
+                if (query == session->queries_ref()->end()) {
+                    code = nebula::cpp2::ErrorCode::E_QUERY_NOT_FOUND;
+                    return false;
+                }
+            }
+            for (auto& epId : kv.second) {
+                session->queries_ref()->at(epId).set_status(cpp2::QueryStatus::KILLING);
+            }
+            return true;
+        });
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Session id `" << sessionId << "' not found";
+            code = ret;
+        }
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            handleErrorCode(code);
+            onFinished();
+            return;
+        }
+    }
+
+    // the queries killed are written at once
+    auto putRet = table->flush();
+    if (putRet != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Put data error on meta server, errorCode: "
+                   << apache::thrift::util::enumNameSafe(putRet);
+    }
+    handleErrorCode(putRet);
+    onFinished();
+}
+
 }  // namespace meta
 }  // namespace nebula
@@ -13,6 +13,8 @@
 namespace nebula {
 namespace meta {
 
+class SessionTable;
+
 class CreateSessionProcessor : public BaseProcessor<cpp2::CreateSessionResp> {
 public:
     static CreateSessionProcessor* instance(kvstore::KVStore* kvstore) {
@@ -36,6 +38,8 @@ public:
     void process(const cpp2::UpdateSessionsReq& req);
 
 private:
+    void updateInTable(SessionTable* table, const cpp2::UpdateSessionsReq& req);
+
     explicit UpdateSessionsProcessor(kvstore::KVStore* kvstore)
         : BaseProcessor<cpp2::UpdateSessionsResp>(kvstore) {}
 };
@@ -90,6 +94,10 @@ public:
     void process(const cpp2::KillQueryReq& req);
 
 private:
+    void killInTable(
+        SessionTable* table,
+        const std::unordered_map<SessionID, std::unordered_set<ExecutionPlanID>>& killQueries);
+
     explicit KillQueryProcessor(kvstore::KVStore* kvstore)
         : BaseProcessor<cpp2::ExecResp>(kvstore) {}
 };
@@ -0,0 +1,277 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "meta/processors/sessionMan/SessionTable.h"
+#include <folly/synchronization/Baton.h>
+#include "meta/MetaServiceUtils.h"
+#include "meta/processors/Common.h"
+
+DEFINE_int32(session_flush_interval_ms, 0,
+             "Keep the sessions in memory on the meta leader and write their updates every "
+             "so many milliseconds, 0 to write every update at once");
+
+namespace nebula {
+namespace meta {
+
+// static
+SessionTable* SessionTable::getInstance() {
+    static SessionTable inst;
+    return &inst;
+}
+
+// static
+SessionTable* SessionTable::get(kvstore::KVStore* kv) {
+    if (FLAGS_session_flush_interval_ms <= 0) {
+        return nullptr;
+    }
+    auto* table = getInstance();
+    return table->kv_ != nullptr && table->kv_ == kv ? table : nullptr;
+}
+
+bool SessionTable::start(kvstore::KVStore* kv) {
+    CHECK_NOTNULL(kv);
+    kv_ = kv;
+    for (auto& shard : shards_) {
+        folly::SharedMutex::WriteHolder wHolder(shard.lock);
+        shard.term = -1;
+    }
+    worker_ = std::make_unique<thread::GenericWorker>();
+    if (!worker_->start("session-flush")) {
+        LOG(ERROR) << "Start the session flush worker failed";
+        return false;
+    }
+    worker_->addRepeatTask(FLAGS_session_flush_interval_ms, [this] { flush(); });
+    return true;
+}
+
+void SessionTable::stop() {
+    if (worker_ != nullptr) {
+        worker_->stop();
+        worker_->wait();
+        worker_.reset();
+    }
+    if (kv_ != nullptr) {
+        flush();
+        kv_ = nullptr;
+    }
+}
+
+TermID SessionTable::leaderTerm() {
+    auto partRet = kv_->part(kDefaultSpaceId, kDefaultPartId);
+    if (!nebula::ok(partRet)) {
+        return -1;
+    }
+    auto part = nebula::value(partRet);
+    return part->isLeader() ? part->termId() : -1;
+}
+
+nebula::cpp2::ErrorCode SessionTable::loadShard(size_t idx, TermID term) {
+    auto& shard = shards_[idx];
+    if (shard.term == term) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto code = kv_->prefix(kDefaultSpaceId, kDefaultPartId,
+                            MetaServiceUtils::sessionPrefix(), &iter);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    shard.sessions.clear();
+    shard.dirty.clear();
+    for (; iter->valid(); iter->next()) {
+        auto session = MetaServiceUtils::parseSessionVal(iter->val());
+        auto sessionId = session.get_session_id();
+        if (&shardOf(sessionId) == &shard) {
+            shard.sessions.emplace(sessionId, std::move(session));
+        }
+    }
+    shard.term = term;
+    VLOG(1) << "Load " << shard.sessions.size() << " sessions of shard " << idx
+            << " in term " << term;
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+template <class Fn>
+nebula::cpp2::ErrorCode SessionTable::withShard(size_t idx, bool write, Fn&& fn) {
+    auto term = leaderTerm();
+    if (term < 0) {
+        return nebula::cpp2::ErrorCode::E_LEADER_CHANGED;
+    }
+    auto& shard = shards_[idx];
+    if (!write) {
+        folly::SharedMutex::ReadHolder rHolder(shard.lock);
+        if (shard.term == term) {
+            return fn(shard);
+        }
+    }
+    folly::SharedMutex::WriteHolder wHolder(shard.lock);
+    auto code = loadShard(idx, term);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    return fn(shard);
+}
+
+ErrorOr<nebula::cpp2::ErrorCode, cpp2::Session> SessionTable::getSession(SessionID sessionId) {
+    cpp2::Session session;
+    auto idx = static_cast<uint64_t>(sessionId) % kShards;
+    auto code = withShard(idx, false, [&] (Shard& shard) {
+        auto it = shard.sessions.find(sessionId);
+        if (it == shard.sessions.end()) {
+            return nebula::cpp2::ErrorCode::E_SESSION_NOT_FOUND;
+        }
+        session = it->second;
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    });
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    return session;
+}
+
+ErrorOr<nebula::cpp2::ErrorCode, std::vector<cpp2::Session>> SessionTable::listSessions() {
+    std::vector<cpp2::Session> sessions;
+    for (size_t idx = 0; idx < kShards; idx++) {
+        auto code = withShard(idx, false, [&] (Shard& shard) {
+            for (auto& entry : shard.sessions) {
+                sessions.emplace_back(entry.second);
+            }
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        });
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+    }
+    std::sort(sessions.begin(), sessions.end(), [] (const auto& a, const auto& b) {
+        return a.get_session_id() < b.get_session_id();
+    });
+    return sessions;
+}
+
+nebula::cpp2::ErrorCode SessionTable::addSession(const cpp2::Session& session) {
+    auto sessionId = session.get_session_id();
+    auto idx = static_cast<uint64_t>(sessionId) % kShards;
+    return withShard(idx, true, [&] (Shard& shard) {
+        std::vector<kvstore::KV> data;
+        data.emplace_back(MetaServiceUtils::sessionKey(sessionId),
+                          MetaServiceUtils::sessionVal(session));
+        auto code = syncPut(std::move(data));
+        if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+            shard.sessions[sessionId] = session;
+            shard.dirty.erase(sessionId);
+        }
+        return code;
+    });
+}
+
+nebula::cpp2::ErrorCode
+SessionTable::updateSession(SessionID sessionId, const std::function<bool(cpp2::Session*)>& fn) {
+    auto idx = static_cast<uint64_t>(sessionId) % kShards;
+    return withShard(idx, true, [&] (Shard& shard) {
+        auto it = shard.sessions.find(sessionId);
+        if (it == shard.sessions.end()) {
+            return nebula::cpp2::ErrorCode::E_SESSION_NOT_FOUND;
+        }
+        if (fn(&it->second)) {
+            shard.dirty.emplace(sessionId);
+        }
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    });
+}
+
+nebula::cpp2::ErrorCode SessionTable::removeSession(SessionID sessionId) {
+    std::lock_guard<std::mutex> g(flushLock_);
+    auto idx = static_cast<uint64_t>(sessionId) % kShards;
+    return withShard(idx, true, [&] (Shard& shard) {
+        if (!shard.sessions.count(sessionId)) {
+            return nebula::cpp2::ErrorCode::E_SESSION_NOT_FOUND;
+        }
+        auto code = syncRemove(MetaServiceUtils::sessionKey(sessionId));
+        if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+            shard.sessions.erase(sessionId);
+            shard.dirty.erase(sessionId);
+        }
+        return code;
+    });
+}
+
+nebula::cpp2::ErrorCode SessionTable::flush() {
+    std::lock_guard<std::mutex> g(flushLock_);
+    if (kv_ == nullptr) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    auto term = leaderTerm();
+    std::vector<kvstore::KV> data;
+    std::vector<std::pair<size_t, SessionID>> flushed;
+    for (size_t idx = 0; idx < kShards; idx++) {
+        auto& shard = shards_[idx];
+        folly::SharedMutex::WriteHolder wHolder(shard.lock);
+        if (shard.term != term) {
+            // loaded in an old term, the shard is loaded again when it's used
+            shard.dirty.clear();
+            continue;
+        }
+        for (auto sessionId : shard.dirty) {
+            auto it = shard.sessions.find(sessionId);
+            if (it != shard.sessions.end()) {
+                data.emplace_back(MetaServiceUtils::sessionKey(sessionId),
+                                  MetaServiceUtils::sessionVal(it->second));
+                flushed.emplace_back(idx, sessionId);
+            }
+        }
+        shard.dirty.clear();
+    }
+    if (data.empty()) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    auto code = syncPut(std::move(data));
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Write " << flushed.size() << " sessions failed, errorCode: "
+                   << apache::thrift::util::enumNameSafe(code);
+        // written in the next flush
+        for (auto& entry : flushed) {
+            auto& shard = shards_[entry.first];
+            folly::SharedMutex::WriteHolder wHolder(shard.lock);
+            if (shard.term == term) {
+                shard.dirty.emplace(entry.second);
+            }
+        }
+        return code;
+    }
+    VLOG(2) << "Write " << flushed.size() << " sessions in term " << term;
+    return code;
+}
+
+nebula::cpp2::ErrorCode SessionTable::syncPut(std::vector<kvstore::KV> data) {
+    folly::Baton<true, std::atomic> baton;
+    auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
+    kv_->asyncMultiPut(kDefaultSpaceId,
+                       kDefaultPartId,
+                       std::move(data),
+                       [&ret, &baton] (nebula::cpp2::ErrorCode code) {
+                           ret = code;
+                           baton.post();
+                       });
+    baton.wait();
+    return ret;
+}
+
+nebula::cpp2::ErrorCode SessionTable::syncRemove(std::string key) {
+    folly::Baton<true, std::atomic> baton;
+    auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
+    kv_->asyncRemove(kDefaultSpaceId,
+                     kDefaultPartId,
+                     std::move(key),
+                     [&ret, &baton] (nebula::cpp2::ErrorCode code) {
+                         ret = code;
+                         baton.post();
+                     });
+    baton.wait();
+    return ret;
+}
+
+}  // namespace meta
+}  // namespace nebula
@@ -0,0 +1,100 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef META_SESSIONTABLE_H_
+#define META_SESSIONTABLE_H_
+
+#include "common/base/Base.h"
+#include "common/base/ErrorOr.h"
+#include "common/interface/gen-cpp2/meta_types.h"
+#include "common/thread/GenericWorker.h"
+#include "kvstore/KVStore.h"
+
+DECLARE_int32(session_flush_interval_ms);
+
+namespace nebula {
+namespace meta {
+
+/*
+SessionTable keeps the sessions in memory on the meta leader when session_flush_interval_ms > 0,
+so the session processors don't take the global session lock nor write raft for every update.
+
+The sessions are sharded by id, each shard has its own lock. The sessions of a shard are loaded
+from the kvstore the first time it's used in a term of the meta leader. The updates only change
+the sessions in memory and mark them dirty, the dirty ones are written in one batch every
+session_flush_interval_ms. Creating or removing a session and killing queries are written at
+once, since the graphds rely on them. The dirty sessions not written are lost when the leader is
+changed, the graphds update them again soon.
+*/
+class SessionTable final {
+public:
+    static constexpr size_t kShards = 16;
+
+    static SessionTable* getInstance();
+
+    // The table if it is enabled and started on kv, nullptr otherwise
+    static SessionTable* get(kvstore::KVStore* kv);
+
+    bool start(kvstore::KVStore* kv);
+
+    // Write the dirty sessions left and stop
+    void stop();
+
+    ErrorOr<nebula::cpp2::ErrorCode, cpp2::Session> getSession(SessionID sessionId);
+
+    ErrorOr<nebula::cpp2::ErrorCode, std::vector<cpp2::Session>> listSessions();
+
+    nebula::cpp2::ErrorCode addSession(const cpp2::Session& session);
+
+    // Call fn with the session in the table, which is marked dirty if fn returns true
+    nebula::cpp2::ErrorCode updateSession(SessionID sessionId,
+                                          const std::function<bool(cpp2::Session*)>& fn);
+
+    nebula::cpp2::ErrorCode removeSession(SessionID sessionId);
+
+    // Write the dirty sessions in one batch
+    nebula::cpp2::ErrorCode flush();
+
+private:
+    struct Shard {
+        folly::SharedMutex                                  lock;
+        TermID                                              term{-1};
+        std::unordered_map<SessionID, cpp2::Session>        sessions;
+        std::unordered_set<SessionID>                       dirty;
+    };
+
+    SessionTable() = default;
+
+    Shard& shardOf(SessionID sessionId) {
+        return shards_[static_cast<uint64_t>(sessionId) % kShards];
+    }
+
+    // The term of the meta leader, -1 if it's not the leader
+    TermID leaderTerm();
+
+    // Load the sessions of the shard if they are not of the term, with the write lock held
+    nebula::cpp2::ErrorCode loadShard(size_t idx, TermID term);
+
+    // Run fn with the lock of the shard loaded in the current term
+    template <class Fn>
+    nebula::cpp2::ErrorCode withShard(size_t idx, bool write, Fn&& fn);
+
+    nebula::cpp2::ErrorCode syncPut(std::vector<kvstore::KV> data);
+
+    nebula::cpp2::ErrorCode syncRemove(std::string key);
+
+private:
+    kvstore::KVStore*                           kv_{nullptr};
+    std::unique_ptr<thread::GenericWorker>      worker_;
+    std::array<Shard, kShards>                  shards_;
+    // Held by flush and removeSession when writing, so a session removed is not written back
+    std::mutex                                  flushLock_;
+};
+
+}  // namespace meta
+}  // namespace nebula
+
+#endif  // META_SESSIONTABLE_H_
@@ -9,10 +9,13 @@
 #include <gtest/gtest.h>
 #include <folly/synchronization/Baton.h>
 #include "meta/ActiveHostsMan.h"
+#include "meta/MetaChangeLog.h"
 #include "meta/test/TestUtils.h"
 
 DECLARE_int32(heartbeat_interval_secs);
 DECLARE_uint32(expired_time_factor);
+DECLARE_int32(heartbeat_persist_interval_secs);
+DECLARE_bool(active_hosts_in_memory);
 
 namespace nebula {
 namespace meta {
@@ -173,6 +176,173 @@ TEST(ActiveHostsManTest, LeaderTest) {
     ASSERT_EQ(1, nebula::value(hostsRet).size());
 }
 
+TEST(ActiveHostsManTest, ConcurrentLeaderTest) {
+    fs::TempDir rootPath("/tmp/ConcurrentLeaderTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv(MockCluster::initMetaKV(rootPath.path()));
+    auto now = time::WallClock::fastNowInMilliSec();
+    HostInfo info(now, cpp2::HostRole::STORAGE, gitInfoSha());
+
+    // each host reports it is the leader of the same parts with its own term, at the same time
+    static constexpr int32_t kHosts = 8;
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < kHosts; i++) {
+        threads.emplace_back([&, i] {
+            std::unordered_map<GraphSpaceID, std::vector<cpp2::LeaderInfo>> leaderIds;
+            for (GraphSpaceID spaceId = 1; spaceId <= 3; spaceId++) {
+                cpp2::LeaderInfo part;
+                part.set_part_id(1);
+                part.set_term(i + 1);
+                leaderIds[spaceId].emplace_back(std::move(part));
+            }
+            auto code = ActiveHostsMan::updateHostInfo(kv.get(), HostAddr("0", i), info,
+                                                       &leaderIds);
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    auto hostsRet = ActiveHostsMan::getActiveHosts(kv.get());
+    ASSERT_TRUE(nebula::ok(hostsRet));
+    ASSERT_EQ(kHosts, nebula::value(hostsRet).size());
+
+    // the leader of the greatest term is kept
+    for (GraphSpaceID spaceId = 1; spaceId <= 3; spaceId++) {
+        std::string val;
+        auto ret = kv->get(kDefaultSpaceId, kDefaultPartId,
+                           MetaServiceUtils::leaderKey(spaceId, 1), &val);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, ret);
+        HostAddr host;
+        TermID term;
+        nebula::cpp2::ErrorCode code;
+        std::tie(host, term, code) = MetaServiceUtils::parseLeaderValV3(val);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+        EXPECT_EQ(kHosts, term);
+        EXPECT_EQ(HostAddr("0", kHosts - 1), host);
+    }
+}
+
+TEST(ActiveHostsManTest, PersistIntervalTest) {
+    fs::TempDir rootPath("/tmp/PersistIntervalTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv(MockCluster::initMetaKV(rootPath.path()));
+    FLAGS_heartbeat_persist_interval_secs = 60;
+    ActiveHostsMan::clearHeartbeats();
+    HostAddr host("0", 0);
+    auto now = time::WallClock::fastNowInMilliSec();
+
+    auto persisted = [&] () {
+        std::string val;
+        auto ret = kv->get(kDefaultSpaceId, kDefaultPartId,
+                           MetaServiceUtils::hostKey(host.host, host.port), &val);
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, ret);
+        return HostInfo::decode(val).lastHBTimeInMilliSec_;
+    };
+    auto leaderTerm = [&] (PartitionID partId) {
+        std::string val;
+        auto ret = kv->get(kDefaultSpaceId, kDefaultPartId,
+                           MetaServiceUtils::leaderKey(1, partId), &val);
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, ret);
+        return std::get<1>(MetaServiceUtils::parseLeaderValV3(val));
+    };
+    auto makeLeaders = [] (TermID term1, TermID term2) {
+        ActiveHostsMan::AllLeaders leaders;
+        cpp2::LeaderInfo part1;
+        part1.set_part_id(1);
+        part1.set_term(term1);
+        cpp2::LeaderInfo part2;
+        part2.set_part_id(2);
+        part2.set_term(term2);
+        leaders[1] = {part1, part2};
+        return leaders;
+    };
+
+    auto leaders = makeLeaders(1, 1);
+    HostInfo info1(now - 1000, cpp2::HostRole::STORAGE, gitInfoSha());
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              ActiveHostsMan::updateHostInfo(kv.get(), host, info1, &leaders));
+    EXPECT_EQ(now - 1000, persisted());
+    EXPECT_EQ(1, leaderTerm(1));
+
+    // only kept in memory
+    HostInfo info2(now, cpp2::HostRole::STORAGE, gitInfoSha());
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              ActiveHostsMan::updateHostInfo(kv.get(), host, info2, &leaders));
+    EXPECT_EQ(now - 1000, persisted());
+    auto infoRet = ActiveHostsMan::getHostInfo(kv.get(), host);
+    ASSERT_TRUE(nebula::ok(infoRet));
+    EXPECT_EQ(now, nebula::value(infoRet).lastHBTimeInMilliSec_);
+
+    // only the leader changed is written
+    leaders = makeLeaders(1, 5);
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              ActiveHostsMan::updateHostInfo(kv.get(), host, info2, &leaders));
+    EXPECT_EQ(now - 1000, persisted());
+    EXPECT_EQ(1, leaderTerm(1));
+    EXPECT_EQ(5, leaderTerm(2));
+
+    // written after the interval
+    HostInfo info3(now + 61 * 1000, cpp2::HostRole::STORAGE, gitInfoSha());
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              ActiveHostsMan::updateHostInfo(kv.get(), host, info3, &leaders));
+    EXPECT_EQ(now + 61 * 1000, persisted());
+
+    ActiveHostsMan::clearHeartbeats();
+    FLAGS_heartbeat_persist_interval_secs = 0;
+}
+
+TEST(ActiveHostsManTest, InMemoryRegistryTest) {
+    fs::TempDir rootPath("/tmp/InMemoryRegistryTest.XXXXXX");
+    FLAGS_heartbeat_interval_secs = 1;
+    std::unique_ptr<kvstore::KVStore> kv(MockCluster::initMetaKV(rootPath.path()));
+    FLAGS_active_hosts_in_memory = true;
+    ActiveHostsMan::resetRegistry();
+    auto now = time::WallClock::fastNowInMilliSec();
+    HostInfo info(now, cpp2::HostRole::STORAGE, gitInfoSha());
+    auto activeHosts = [&] () {
+        auto hostsRet = ActiveHostsMan::getActiveHosts(kv.get());
+        EXPECT_TRUE(nebula::ok(hostsRet));
+        return nebula::value(hostsRet);
+    };
+
+    // loaded by the first query
+    ActiveHostsMan::updateHostInfo(kv.get(), HostAddr("0", 0), info);
+    ActiveHostsMan::updateHostInfo(kv.get(), HostAddr("0", 1), info);
+    EXPECT_EQ(2, activeHosts().size());
+
+    // kept by the heartbeats since
+    ActiveHostsMan::updateHostInfo(kv.get(), HostAddr("0", 2), info);
+    EXPECT_EQ(3, activeHosts().size());
+    HostInfo expired(now - 10 * 1000, cpp2::HostRole::STORAGE, gitInfoSha());
+    ActiveHostsMan::updateHostInfo(kv.get(), HostAddr("0", 1), expired);
+    EXPECT_EQ((std::vector<HostAddr>{HostAddr("0", 0), HostAddr("0", 2)}), activeHosts());
+    auto infoRet = ActiveHostsMan::getHostInfo(kv.get(), HostAddr("0", 1));
+    ASSERT_TRUE(nebula::ok(infoRet));
+    EXPECT_EQ(now - 10 * 1000, nebula::value(infoRet).lastHBTimeInMilliSec_);
+    infoRet = ActiveHostsMan::getHostInfo(kv.get(), HostAddr("0", 3));
+    ASSERT_FALSE(nebula::ok(infoRet));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND, nebula::error(infoRet));
+
+    // a host written into the kvstore directly is seen when the registry is loaded again
+    {
+        std::vector<kvstore::KV> data;
+        data.emplace_back(MetaServiceUtils::hostKey("0", 3), HostInfo::encodeV2(info));
+        folly::Baton<true, std::atomic> baton;
+        kv->asyncMultiPut(kDefaultSpaceId, kDefaultPartId, std::move(data),
+                          [&] (nebula::cpp2::ErrorCode code) {
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+    EXPECT_EQ(2, activeHosts().size());
+    ActiveHostsMan::resetRegistry();
+    EXPECT_EQ(3, activeHosts().size());
+
+    FLAGS_active_hosts_in_memory = false;
+    ActiveHostsMan::resetRegistry();
+    EXPECT_EQ(3, activeHosts().size());
+}
+
 TEST(LastUpdateTimeManTest, NormalTest) {
     fs::TempDir rootPath("/tmp/LastUpdateTimeManTest.XXXXXX");
     std::unique_ptr<kvstore::KVStore> kv(MockCluster::initMetaKV(rootPath.path()));
@@ -202,6 +372,71 @@ TEST(LastUpdateTimeManTest, NormalTest) {
     }
 }
 
+TEST(LastUpdateTimeManTest, ChangeLogTest) {
+    fs::TempDir rootPath("/tmp/ChangeLogTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv(MockCluster::initMetaKV(rootPath.path()));
+    FLAGS_meta_change_log_retention_secs = 3600;
+    int64_t now = time::WallClock::fastNowInMilliSec();
+
+    std::vector<std::string> keys{MetaServiceUtils::schemaTagKey(1, 10, 0),
+                                  MetaServiceUtils::schemaTagKey(1, 11, 0),
+                                  MetaServiceUtils::partKey(2, 1),
+                                  MetaServiceUtils::lastUpdateTimeKey()};
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, LastUpdateTimeMan::update(kv.get(), now, &keys));
+    keys = {MetaServiceUtils::indexIndexKey(3, "index")};
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              LastUpdateTimeMan::update(kv.get(), now + 100, &keys));
+    // the version only increases
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, LastUpdateTimeMan::update(kv.get(), now - 100));
+    auto lastUpRet = LastUpdateTimeMan::get(kv.get());
+    ASSERT_TRUE(nebula::ok(lastUpRet));
+    ASSERT_EQ(now + 101, nebula::value(lastUpRet));
+
+    {
+        // the log before the version is not kept
+        bool complete = true;
+        auto ret = MetaChangeLog::changesSince(kv.get(), now - 1, &complete);
+        ASSERT_TRUE(nebula::ok(ret));
+        EXPECT_FALSE(complete);
+        EXPECT_EQ(4, nebula::value(ret).size());
+    }
+    {
+        bool complete = false;
+        auto ret = MetaChangeLog::changesSince(kv.get(), now, &complete);
+        ASSERT_TRUE(nebula::ok(ret));
+        EXPECT_TRUE(complete);
+        const auto& changes = nebula::value(ret);
+        ASSERT_EQ(2, changes.size());
+        EXPECT_EQ(now + 100, changes[0].version);
+        EXPECT_EQ("index", changes[0].table);
+        EXPECT_EQ(3, changes[0].space);
+        EXPECT_EQ(now + 101, changes[1].version);
+        EXPECT_EQ(MetaChangeLog::kAllTables, changes[1].table);
+        EXPECT_EQ(-1, changes[1].space);
+    }
+    {
+        bool complete = false;
+        auto ret = MetaChangeLog::changesSince(kv.get(), now - 1, &complete);
+        ASSERT_TRUE(nebula::ok(ret));
+        const auto& changes = nebula::value(ret);
+        std::set<std::pair<std::string, GraphSpaceID>> tables;
+        for (size_t i = 0; i < 2; i++) {
+            EXPECT_EQ(now, changes[i].version);
+            tables.emplace(changes[i].table, changes[i].space);
+        }
+        EXPECT_EQ((std::set<std::pair<std::string, GraphSpaceID>>{{"parts", 2}, {"tags", 1}}),
+                  tables);
+    }
+    {
+        bool complete = false;
+        auto ret = MetaChangeLog::changesSince(kv.get(), now + 101, &complete);
+        ASSERT_TRUE(nebula::ok(ret));
+        EXPECT_TRUE(complete);
+        EXPECT_TRUE(nebula::value(ret).empty());
+    }
+    FLAGS_meta_change_log_retention_secs = 0;
+}
+
 }  // namespace meta
 }  // namespace nebula
 
@@ -15,6 +15,7 @@
 #include "meta/processors/partsMan/CreateSpaceProcessor.h"
 
 DECLARE_uint32(task_concurrency);
+DECLARE_uint32(task_concurrency_per_host);
 DECLARE_int32(heartbeat_interval_secs);
 DECLARE_uint32(expired_time_factor);
 DECLARE_double(leader_balance_deviation);
@@ -778,6 +779,60 @@ TEST(BalanceTest, BalancePartsTest) {
     }
 }
 
+TEST(BalanceTest, BalancePartsByLoadTest) {
+    fs::TempDir rootPath("/tmp/BalancePartsByLoadTest.XXXXXX");
+    auto store = MockCluster::initMetaKV(rootPath.path());
+    auto* kv = dynamic_cast<kvstore::KVStore*>(store.get());
+    NiceMock<MockAdminClient> client;
+
+    // part 1 is as heavy as all the others
+    std::vector<kvstore::KV> data;
+    for (PartitionID partId = 1; partId <= 6; partId++) {
+        PartLoad load;
+        load.bytes = partId == 1 ? 100 : 10;
+        load.readQps = partId == 1 ? 100 : 10;
+        data.emplace_back(MetaServiceUtils::partLoadKey(1, partId),
+                          MetaServiceUtils::partLoadVal(load));
+    }
+    folly::Baton<true, std::atomic> baton;
+    kv->asyncMultiPut(0, 0, std::move(data), [&] (nebula::cpp2::ErrorCode code) {
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+        baton.post();
+    });
+    baton.wait();
+
+    Balancer balancer(kv, &client);
+    auto loadsRet = balancer.getPartLoads(1);
+    ASSERT_TRUE(nebula::ok(loadsRet));
+    auto loads = nebula::value(loadsRet);
+    ASSERT_EQ(6, loads.size());
+    EXPECT_EQ(100, loads[1].bytes);
+    EXPECT_EQ(10, loads[2].readQps);
+
+    HostParts hostParts;
+    hostParts.emplace(HostAddr("0", 0), std::vector<PartitionID>{1, 2, 3});
+    hostParts.emplace(HostAddr("1", 0), std::vector<PartitionID>{4, 5, 6});
+    {
+        // balanced by the number of parts
+        auto copy = hostParts;
+        std::vector<BalanceTask> tasks;
+        balancer.balanceParts(0, 1, copy, 6, tasks);
+        EXPECT_EQ(0, tasks.size());
+    }
+    std::vector<BalanceTask> tasks;
+    balancer.balancePartsByLoad(0, 1, hostParts, loads, tasks);
+    EXPECT_EQ(2, tasks.size());
+    EXPECT_EQ(std::vector<PartitionID>{1}, hostParts[HostAddr("0", 0)]);
+    auto parts = hostParts[HostAddr("1", 0)];
+    std::sort(parts.begin(), parts.end());
+    EXPECT_EQ((std::vector<PartitionID>{2, 3, 4, 5, 6}), parts);
+
+    // no more moves could even them out
+    tasks.clear();
+    balancer.balancePartsByLoad(0, 1, hostParts, loads, tasks);
+    EXPECT_EQ(0, tasks.size());
+}
+
 TEST(BalanceTest, DispatchTasksTest) {
     {
         FLAGS_task_concurrency = 10;
@@ -832,6 +887,69 @@ TEST(BalanceTest, DispatchTasksTest) {
     }
 }
 
+TEST(BalanceTest, DispatchTasksByHostTest) {
+    FLAGS_task_concurrency = 10;
+    FLAGS_task_concurrency_per_host = 2;
+    {
+        BalancePlan plan(0L, nullptr, nullptr);
+        // Part 0 to 3 are moved out of host "0", part 4 and 5 are moved out of host "5"
+        for (int i = 0; i < 4; i++) {
+            BalanceTask task(0, 0, i, HostAddr("0", 0),
+                             HostAddr(std::to_string(i + 1), 0), nullptr, nullptr);
+            plan.addTask(std::move(task));
+        }
+        for (int i = 4; i < 6; i++) {
+            BalanceTask task(0, 0, i, HostAddr("5", 0),
+                             HostAddr(std::to_string(i + 2), 0), nullptr, nullptr);
+            plan.addTask(std::move(task));
+        }
+        // The second task of part 0 waits for the first one
+        BalanceTask task(0, 0, 0, HostAddr("8", 0), HostAddr("9", 0), nullptr, nullptr);
+        plan.addTask(std::move(task));
+        plan.dispatchTasksByHost();
+        ASSERT_EQ(6, plan.chains_.size());
+        ASSERT_EQ(2, plan.chains_[0].size());
+
+        auto picked = plan.pickTasks();
+        // Two tasks of each src, and the idle hosts are preferred
+        ASSERT_EQ((std::vector<int32_t>{0, 4, 1, 5}), picked);
+        ASSERT_EQ(2, plan.hostTasks_[HostAddr("0", 0)]);
+        ASSERT_EQ(2, plan.hostTasks_[HostAddr("5", 0)]);
+        ASSERT_EQ(4, plan.runningTaskNum_);
+        ASSERT_TRUE(plan.pickTasks().empty());
+    }
+    {
+        LOG(INFO) << "Test with all tasks succeeded, at most 2 tasks on a host";
+        fs::TempDir rootPath("/tmp/DispatchTasksByHostTest.XXXXXX");
+        auto store = MockCluster::initMetaKV(rootPath.path());
+        auto* kv = dynamic_cast<kvstore::KVStore*>(store.get());
+        DefaultValue<folly::Future<Status>>::SetFactory([] {
+            return folly::Future<Status>(Status::OK());
+        });
+        std::vector<HostAddr> hosts;
+        for (int i = 0; i < 4; i++) {
+            hosts.emplace_back(std::to_string(i), 0);
+        }
+        TestUtils::registerHB(kv, hosts);
+        NiceMock<MockAdminClient> client;
+        BalancePlan plan(0L, kv, &client);
+        for (int i = 0; i < 20; i++) {
+            BalanceTask task(0, 0, i, hosts[i % 2], hosts[2 + i % 2], kv, &client);
+            plan.addTask(std::move(task));
+        }
+        folly::Baton<true, std::atomic> b;
+        plan.onFinished_ = [&plan, &b] () {
+            ASSERT_EQ(BalanceStatus::SUCCEEDED, plan.status_);
+            ASSERT_EQ(20, plan.finishedTaskNum_);
+            ASSERT_EQ(0, plan.runningTaskNum_);
+            b.post();
+        };
+        plan.invoke();
+        b.wait();
+    }
+    FLAGS_task_concurrency_per_host = 0;
+}
+
 TEST(BalanceTest, BalancePlanTest) {
     fs::TempDir rootPath("/tmp/BalancePlanTest.XXXXXX");
     auto store = MockCluster::initMetaKV(rootPath.path());
@@ -1751,6 +1869,78 @@ TEST(BalanceTest, LeaderBalanceWithZoneTest) {
     }
 }
 
+TEST(BalanceTest, LeaderBalanceWithZoneAffinityTest) {
+    fs::TempDir rootPath("/tmp/LeaderBalanceWithZoneAffinityTest.XXXXXX");
+    auto store = MockCluster::initMetaKV(rootPath.path());
+    auto* kv = dynamic_cast<kvstore::KVStore*>(store.get());
+    std::vector<HostAddr> hosts = {{"0", 0}, {"1", 1}, {"2", 2}};
+    TestUtils::createSomeHosts(kv, hosts);
+    // 9 partition in space 1, 3 replica, 3 hosts
+    TestUtils::assembleSpace(kv, 1, 9, 3, 3);
+    {
+        ZoneInfo zoneInfo = {
+            {"zone_0", {HostAddr("0", 0), HostAddr("1", 1)}},
+            {"zone_1", {HostAddr("2", 2)}}
+        };
+        TestUtils::assembleGroupAndZone(kv, zoneInfo, {});
+        std::vector<kvstore::KV> data;
+        data.emplace_back(MetaServiceUtils::leaderZoneKey(1), "zone_0");
+        folly::Baton<true, std::atomic> baton;
+        kv->asyncMultiPut(0, 0, std::move(data), [&] (nebula::cpp2::ErrorCode code) {
+            ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+
+    DefaultValue<folly::Future<Status>>::SetFactory([] {
+        return folly::Future<Status>(Status::OK());
+    });
+    NiceMock<MockAdminClient> client;
+    Balancer balancer(kv, &client);
+    {
+        LOG(INFO) << "The leaders are moved into the zone preferred";
+        HostLeaderMap hostLeaderMap;
+        hostLeaderMap[HostAddr("0", 0)][1] = {1, 2, 3};
+        hostLeaderMap[HostAddr("1", 1)][1] = {4, 5, 6};
+        hostLeaderMap[HostAddr("2", 2)][1] = {7, 8, 9};
+
+        LeaderBalancePlan plan;
+        auto leaderBalanceResult = balancer.buildLeaderBalancePlan(&hostLeaderMap, 1, 3,
+                                                                   false, plan, false);
+        ASSERT_TRUE(nebula::ok(leaderBalanceResult) && nebula::value(leaderBalanceResult));
+        verifyLeaderBalancePlan(hostLeaderMap, plan, 0, 5);
+        ASSERT_EQ(0, hostLeaderMap[HostAddr("2", 2)][1].size());
+        ASSERT_LE(4, hostLeaderMap[HostAddr("0", 0)][1].size());
+        ASSERT_LE(4, hostLeaderMap[HostAddr("1", 1)][1].size());
+    }
+    {
+        LOG(INFO) << "Host 0 is down, the leaders stay in the rest host of the zone";
+        HostLeaderMap hostLeaderMap;
+        hostLeaderMap[HostAddr("1", 1)][1] = {1, 2, 3, 4, 5};
+        hostLeaderMap[HostAddr("2", 2)][1] = {6, 7, 8, 9};
+
+        LeaderBalancePlan plan;
+        auto leaderBalanceResult = balancer.buildLeaderBalancePlan(&hostLeaderMap, 1, 3,
+                                                                   false, plan, false);
+        ASSERT_TRUE(nebula::ok(leaderBalanceResult) && nebula::value(leaderBalanceResult));
+        verifyLeaderBalancePlan(hostLeaderMap, plan, 0, 9);
+        ASSERT_EQ(9, hostLeaderMap[HostAddr("1", 1)][1].size());
+        ASSERT_EQ(0, hostLeaderMap[HostAddr("2", 2)][1].size());
+    }
+    {
+        LOG(INFO) << "The zone preferred is down, the leaders fail over to the other hosts";
+        HostLeaderMap hostLeaderMap;
+        hostLeaderMap[HostAddr("2", 2)][1] = {1, 2, 3, 4, 5, 6, 7, 8, 9};
+
+        LeaderBalancePlan plan;
+        auto leaderBalanceResult = balancer.buildLeaderBalancePlan(&hostLeaderMap, 1, 3,
+                                                                   false, plan, false);
+        ASSERT_TRUE(nebula::ok(leaderBalanceResult) && nebula::value(leaderBalanceResult));
+        ASSERT_TRUE(plan.empty());
+    }
+}
+
 TEST(BalanceTest, LeaderBalanceWithLargerZoneTest) {
     fs::TempDir rootPath("/tmp/LeaderBalanceWithLargerZoneTest.XXXXXX");
     auto store = MockCluster::initMetaKV(rootPath.path());
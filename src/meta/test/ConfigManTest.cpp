@@ -13,6 +13,7 @@
 #include <rocksdb/db.h>
 #include <rocksdb/utilities/options_util.h>
 #include "meta/test/TestUtils.h"
+#include "meta/ConfigCache.h"
 #include "meta/processors/configMan/GetConfigProcessor.h"
 #include "meta/processors/configMan/SetConfigProcessor.h"
 #include "meta/processors/configMan/ListConfigsProcessor.h"
@@ -634,6 +635,79 @@ TEST(ConfigManTest, RocksdbOptionsTest) {
     }
 }
 
+TEST(ConfigManTest, ConfigCacheTest) {
+    FLAGS_enable_config_cache = true;
+    ConfigCache::invalidate();
+    fs::TempDir rootPath("/tmp/ConfigCacheTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv(MockCluster::initMetaKV(rootPath.path()));
+
+    auto makeItem = [] (cpp2::ConfigModule module, const std::string& name, Value value) {
+        cpp2::ConfigItem item;
+        item.set_module(module);
+        item.set_name(name);
+        item.set_mode(cpp2::ConfigMode::MUTABLE);
+        item.set_value(std::move(value));
+        return item;
+    };
+    auto listConfigs = [&] (cpp2::ConfigModule module) {
+        cpp2::ListConfigsReq req;
+        req.set_module(module);
+        auto* processor = ListConfigsProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, resp.get_code());
+        return resp.get_items();
+    };
+    {
+        cpp2::RegConfigReq req;
+        req.set_items({makeItem(cpp2::ConfigModule::STORAGE, "k1", "v1"),
+                       makeItem(cpp2::ConfigModule::STORAGE, "k2", "v2"),
+                       makeItem(cpp2::ConfigModule::GRAPH, "k3", "v3")});
+        auto* processor = RegConfigProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, std::move(f).get().get_code());
+    }
+    {
+        auto items = listConfigs(cpp2::ConfigModule::STORAGE);
+        ASSERT_EQ(2, items.size());
+        EXPECT_EQ("k1", items[0].get_name());
+        EXPECT_EQ("k2", items[1].get_name());
+        ASSERT_EQ(1, listConfigs(cpp2::ConfigModule::GRAPH).size());
+        ASSERT_EQ(3, listConfigs(cpp2::ConfigModule::ALL).size());
+    }
+    // a config written around the processors is not seen until the cache is invalidated
+    {
+        std::vector<kvstore::KV> data;
+        data.emplace_back(MetaServiceUtils::configKey(cpp2::ConfigModule::STORAGE, "k4"),
+                          MetaServiceUtils::configValue(cpp2::ConfigMode::MUTABLE, "v4"));
+        folly::Baton<true, std::atomic> baton;
+        kv->asyncMultiPut(0, 0, std::move(data), [&] (nebula::cpp2::ErrorCode code) {
+            ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+        ASSERT_EQ(2, listConfigs(cpp2::ConfigModule::STORAGE).size());
+    }
+    // the configs set invalidate the cache
+    {
+        cpp2::SetConfigReq req;
+        req.set_item(makeItem(cpp2::ConfigModule::STORAGE, "k1", "v1_new"));
+        auto* processor = SetConfigProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, std::move(f).get().get_code());
+
+        auto items = listConfigs(cpp2::ConfigModule::STORAGE);
+        ASSERT_EQ(3, items.size());
+        EXPECT_EQ(Value("v1_new"), items[0].get_value());
+        EXPECT_EQ("k4", items[2].get_name());
+    }
+    ConfigCache::invalidate();
+    FLAGS_enable_config_cache = false;
+}
+
 }  // namespace meta
 }  // namespace nebula
 
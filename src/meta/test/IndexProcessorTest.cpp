@@ -23,6 +23,7 @@
 #include "meta/processors/indexMan/GetEdgeIndexProcessor.h"
 #include "meta/processors/indexMan/ListEdgeIndexesProcessor.h"
 #include "meta/processors/indexMan/FTIndexProcessor.h"
+#include "meta/IndexCache.h"
 
 namespace nebula {
 namespace meta {
@@ -1240,6 +1241,71 @@ TEST(IndexProcessorTest, IndexCheckDropTagTest) {
     }
 }
 
+TEST(IndexProcessorTest, IndexCacheDropTagTest) {
+    FLAGS_enable_index_cache = true;
+    IndexCache::invalidate(1);
+    fs::TempDir rootPath("/tmp/IndexCacheDropTagTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv(MockCluster::initMetaKV(rootPath.path()));
+    TestUtils::createSomeHosts(kv.get());
+    TestUtils::assembleSpace(kv.get(), 1, 1);
+    TestUtils::mockTag(kv.get(), 2);
+    auto dropTag = [&] (const std::string& tagName) {
+        cpp2::DropTagReq req;
+        req.set_space_id(1);
+        req.set_tag_name(tagName);
+        auto* processor = DropTagProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        return std::move(f).get().get_code();
+    };
+    {
+        // load the cache with no index
+        auto ret = IndexCache::indexes(kv.get(), 1, 0);
+        ASSERT_TRUE(nebula::ok(ret));
+        ASSERT_TRUE(nebula::value(ret)->empty());
+    }
+    // The index created invalidates the cache
+    {
+        cpp2::CreateTagIndexReq req;
+        req.set_space_id(1);
+        req.set_tag_name("tag_0");
+        cpp2::IndexFieldDef field;
+        field.set_name("tag_0_col_0");
+        req.set_fields({field});
+        req.set_index_name("single_field_index");
+        auto *processor = CreateTagIndexProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, resp.get_code());
+    }
+    {
+        auto ret = IndexCache::indexes(kv.get(), 1, 0);
+        ASSERT_TRUE(nebula::ok(ret));
+        ASSERT_EQ(1, nebula::value(ret)->size());
+        ASSERT_EQ("single_field_index", nebula::value(ret)->front().get_index_name());
+        ret = IndexCache::indexes(kv.get(), 1, 1);
+        ASSERT_TRUE(nebula::ok(ret));
+        ASSERT_TRUE(nebula::value(ret)->empty());
+    }
+    ASSERT_EQ(nebula::cpp2::ErrorCode::E_CONFLICT, dropTag("tag_0"));
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, dropTag("tag_1"));
+    // The index dropped invalidates the cache
+    {
+        cpp2::DropTagIndexReq req;
+        req.set_space_id(1);
+        req.set_index_name("single_field_index");
+        auto* processor = DropTagIndexProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, resp.get_code());
+    }
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, dropTag("tag_0"));
+    IndexCache::invalidate(1);
+    FLAGS_enable_index_cache = false;
+}
+
 TEST(IndexProcessorTest, IndexTTLTagTest) {
     fs::TempDir rootPath("/tmp/IndexTTLTagTest.XXXXXX");
     std::unique_ptr<kvstore::KVStore> kv(MockCluster::initMetaKV(rootPath.path()));
@@ -13,11 +13,14 @@
 #include "meta/test/TestUtils.h"
 #include "meta/test/MockAdminClient.h"
 #include "kvstore/Common.h"
+#include "meta/processors/jobMan/CompactJobExecutor.h"
 #include "meta/processors/jobMan/JobUtils.h"
 #include "meta/processors/jobMan/TaskDescription.h"
 #include "meta/processors/jobMan/JobManager.h"
 
 DECLARE_int32(ws_storage_http_port);
+DECLARE_bool(enable_job_cache);
+DECLARE_int32(max_running_jobs);
 
 namespace nebula {
 namespace meta {
@@ -128,6 +131,27 @@ TEST_F(JobManagerTest, StatisJob) {
     ASSERT_EQ(cpp2::JobStatus::FINISHED, job1.status_);
 }
 
+TEST_F(JobManagerTest, CompactJobOptions) {
+    {
+        std::vector<std::string> paras{"4", "parts=1,3", "tag=5", "level=1", "test_space"};
+        CompactJobExecutor executor(13, kv_.get(), adminClient_.get(), paras);
+        ASSERT_TRUE(executor.check());
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, executor.prepare());
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, executor.execute());
+    }
+    {
+        std::vector<std::string> paras{"prefix=01000000", "test_space"};
+        CompactJobExecutor executor(14, kv_.get(), adminClient_.get(), paras);
+        ASSERT_TRUE(executor.check());
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, executor.prepare());
+    }
+    for (const auto& option : {"parts=", "parts=a", "tag=x", "prefix=zz", "files=1", "5"}) {
+        std::vector<std::string> paras{"1", option, "test_space"};
+        CompactJobExecutor executor(15, kv_.get(), adminClient_.get(), paras);
+        ASSERT_FALSE(executor.check()) << option;
+    }
+}
+
 TEST_F(JobManagerTest, JobPriority) {
     // For preventting job schedule in JobManager
     jobMgr->status_ = JobManager::JbmgrStatus::STOPPED;
@@ -345,6 +369,88 @@ TEST_F(JobManagerTest, recoverJob) {
     ASSERT_EQ(nebula::value(nJobRecovered), 1);
 }
 
+TEST_F(JobManagerTest, JobTable) {
+    FLAGS_enable_job_cache = true;
+    jobMgr->jobTable_.wlock()->term = -1;
+    JobDescription jd1(1, cpp2::AdminCmd::COMPACT, {"test_space"});
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, jobMgr->addJob(jd1, adminClient_.get()));
+    TaskDescription td(1, 0, toHost("127.0.0.1"));
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, jobMgr->save(td.taskKey(), td.taskVal()));
+
+    auto jobsRet = jobMgr->showJobs();
+    ASSERT_TRUE(nebula::ok(jobsRet));
+    ASSERT_EQ(1, nebula::value(jobsRet).size());
+    ASSERT_LE(0, jobMgr->jobTable_.rlock()->term);
+
+    // the jobs written by the manager are kept in the table
+    JobDescription jd2(2, cpp2::AdminCmd::FLUSH, {"test_space"});
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, jobMgr->addJob(jd2, adminClient_.get()));
+    jobsRet = jobMgr->showJobs();
+    ASSERT_TRUE(nebula::ok(jobsRet));
+    ASSERT_EQ(2, nebula::value(jobsRet).size());
+    auto jobRet = jobMgr->showJob(1);
+    ASSERT_TRUE(nebula::ok(jobRet));
+    ASSERT_EQ(1, nebula::value(jobRet).second.size());
+    auto loadRet = jobMgr->loadJob(2);
+    ASSERT_TRUE(nebula::ok(loadRet));
+    ASSERT_EQ(cpp2::AdminCmd::FLUSH, nebula::value(loadRet).getCmd());
+
+    // the jobs written by the others are seen once the table is loaded again, in a new term
+    JobDescription jd3(3, cpp2::AdminCmd::FLUSH, {"test_space"});
+    std::vector<kvstore::KV> data{{jd3.jobKey(), jd3.jobVal()}};
+    folly::Baton<true, std::atomic> baton;
+    kv_->asyncMultiPut(kDefaultSpaceId, kDefaultPartId, std::move(data),
+                       [&] (nebula::cpp2::ErrorCode) { baton.post(); });
+    baton.wait();
+    ASSERT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND, nebula::error(jobMgr->loadJob(3)));
+    jobMgr->jobTable_.wlock()->term = -1;
+    ASSERT_TRUE(nebula::ok(jobMgr->loadJob(3)));
+    jobsRet = jobMgr->showJobs();
+    ASSERT_TRUE(nebula::ok(jobsRet));
+    ASSERT_EQ(3, nebula::value(jobsRet).size());
+    FLAGS_enable_job_cache = false;
+}
+
+TEST_F(JobManagerTest, ConcurrentJobs) {
+    // For preventting job schedule in JobManager
+    jobMgr->status_ = JobManager::JbmgrStatus::STOPPED;
+    ASSERT_FALSE(jobMgr->parseTypeLimits("compact:x"));
+    ASSERT_FALSE(jobMgr->parseTypeLimits("unknown:1"));
+    ASSERT_TRUE(jobMgr->parseTypeLimits("Compact:1"));
+    FLAGS_max_running_jobs = 3;
+
+    JobDescription job1(31, cpp2::AdminCmd::COMPACT, {"space_a"});
+    JobDescription job2(32, cpp2::AdminCmd::COMPACT, {"space_b"});
+    JobDescription job3(33, cpp2::AdminCmd::FLUSH, {"space_a"});
+    JobDescription job4(34, cpp2::AdminCmd::STATS, {"space_c"});
+    for (auto& job : {job1, job2, job3, job4}) {
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, jobMgr->addJob(job, adminClient_.get()));
+    }
+    auto pick = [this] () {
+        JobID jobId = 0;
+        if (!jobMgr->pickJob(jobId)) {
+            return 0;
+        }
+        jobMgr->runningJobs_.emplace(jobId, jobMgr->inFlightJobs_.find(jobId)->second);
+        return jobId;
+    };
+    // the stats first, then a compaction, the other compaction exceeds the limit of its type
+    // and the flush conflicts with the compaction of the same space
+    ASSERT_EQ(34, pick());
+    ASSERT_EQ(31, pick());
+    ASSERT_EQ(0, pick());
+    jobMgr->releaseJob(31);
+    ASSERT_EQ(32, pick());
+    ASSERT_EQ(33, pick());
+    ASSERT_EQ(0, pick());
+
+    jobMgr->runningJobs_.clear();
+    jobMgr->pendingJobs_.clear();
+    jobMgr->typeLimits_.clear();
+    FLAGS_max_running_jobs = 1;
+    jobMgr->status_ = JobManager::JbmgrStatus::IDLE;
+}
+
 TEST(JobDescriptionTest, ctor) {
     std::vector<std::string> paras1{"test_space"};
     JobDescription jd1(1, cpp2::AdminCmd::COMPACT, paras1);
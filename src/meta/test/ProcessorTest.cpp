@@ -24,6 +24,8 @@
 #include "meta/processors/schemaMan/ListEdgesProcessor.h"
 #include "meta/processors/schemaMan/AlterTagProcessor.h"
 #include "meta/processors/schemaMan/AlterEdgeProcessor.h"
+#include "meta/SchemaCache.h"
+#include "meta/MetaWarmup.h"
 #include "meta/processors/customKV/MultiPutProcessor.h"
 #include "meta/processors/customKV/GetProcessor.h"
 #include "meta/processors/customKV/MultiGetProcessor.h"
@@ -38,11 +40,13 @@
 #include "meta/processors/zoneMan/ListZonesProcessor.h"
 #include "meta/processors/admin/CreateBackupProcessor.h"
 #include "meta/processors/sessionMan/SessionManagerProcessor.h"
+#include "meta/processors/sessionMan/SessionTable.h"
 
 
 DECLARE_int32(expired_threshold_sec);
 DECLARE_int32(heartbeat_interval_secs);
 DECLARE_uint32(expired_time_factor);
+DECLARE_int32(custom_kv_max_values);
 
 namespace nebula {
 namespace meta {
@@ -1220,6 +1224,75 @@ TEST(ProcessorTest, KVOperationTest) {
     }
 }
 
+TEST(ProcessorTest, KVPagesTest) {
+    fs::TempDir rootPath("/tmp/KVPagesTest.XXXXXX");
+    auto kv = MockCluster::initMetaKV(rootPath.path());
+    {
+        std::vector<nebula::KeyValue> pairs;
+        for (auto i = 0; i < 10; i++) {
+            pairs.emplace_back(std::make_pair(folly::stringPrintf("key_%d", i),
+                                              folly::stringPrintf("value_%d", i)));
+        }
+        cpp2::MultiPutReq req;
+        req.set_segment("test");
+        req.set_pairs(std::move(pairs));
+        auto* processor = MultiPutProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, std::move(f).get().get_code());
+    }
+    FLAGS_custom_kv_max_values = 4;
+    {
+        // Scan [key_1, key_9) by the pages of 4 values
+        std::vector<std::string> values;
+        std::string start = "key_1";
+        int32_t pages = 0;
+        while (true) {
+            cpp2::ScanReq req;
+            req.set_segment("test");
+            req.set_start(start);
+            req.set_end("key_9");
+            auto* processor = ScanProcessor::instance(kv.get());
+            auto f = processor->getFuture();
+            processor->process(req);
+            auto resp = std::move(f).get();
+            pages++;
+            auto page = resp.get_values();
+            if (resp.get_code() == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                values.insert(values.end(), page.begin(), page.end());
+                break;
+            }
+            ASSERT_EQ(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, resp.get_code());
+            ASSERT_EQ(5, page.size());
+            start = page.back();
+            values.insert(values.end(), page.begin(), page.end() - 1);
+        }
+        ASSERT_EQ(2, pages);
+        ASSERT_EQ(8, values.size());
+        for (auto i = 0; i < 8; i++) {
+            ASSERT_EQ(folly::stringPrintf("value_%d", i + 1), values[i]);
+        }
+    }
+    {
+        // Only the first 4 keys are got
+        cpp2::MultiGetReq req;
+        req.set_segment("test");
+        std::vector<std::string> keys;
+        for (auto i = 0; i < 6; i++) {
+            keys.emplace_back(folly::stringPrintf("key_%d", i));
+        }
+        req.set_keys(std::move(keys));
+        auto* processor = MultiGetProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        ASSERT_EQ(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, resp.get_code());
+        ASSERT_EQ(4, resp.get_values().size());
+        ASSERT_EQ("value_3", resp.get_values()[3]);
+    }
+    FLAGS_custom_kv_max_values = 0;
+}
+
 TEST(ProcessorTest, ListOrGetTagsTest) {
     fs::TempDir rootPath("/tmp/ListOrGetTagsTest.XXXXXX");
     auto kv = MockCluster::initMetaKV(rootPath.path());
@@ -1395,6 +1468,111 @@ TEST(ProcessorTest, ListOrGetEdgesTest) {
     }
 }
 
+TEST(ProcessorTest, SchemaCacheTest) {
+    FLAGS_enable_schema_cache = true;
+    SchemaCache::invalidate(1);
+    fs::TempDir rootPath("/tmp/SchemaCacheTest.XXXXXX");
+    auto kv = MockCluster::initMetaKV(rootPath.path());
+    TestUtils::assembleSpace(kv.get(), 1, 1);
+    TestUtils::mockTag(kv.get(), 10);
+
+    auto listTags = [&] () {
+        cpp2::ListTagsReq req;
+        req.set_space_id(1);
+        auto* processor = ListTagsProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, resp.get_code());
+        return resp.get_tags();
+    };
+    auto getTag = [&] (const std::string& tagName, SchemaVer ver) {
+        cpp2::GetTagReq req;
+        req.set_space_id(1);
+        req.set_tag_name(tagName);
+        req.set_version(ver);
+        auto* processor = GetTagProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        return std::move(f).get();
+    };
+    {
+        auto tags = listTags();
+        ASSERT_EQ(10, tags.size());
+        for (auto t = 0; t < 10; t++) {
+            ASSERT_EQ(t, tags[t].get_tag_id());
+            ASSERT_EQ(t, tags[t].get_version());
+            ASSERT_EQ(folly::stringPrintf("tag_%d", t), tags[t].get_tag_name());
+        }
+        auto resp = getTag("tag_3", -1);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, resp.get_code());
+        ASSERT_EQ(2, resp.get_schema().get_columns().size());
+        ASSERT_EQ("tag_3_col_0", resp.get_schema().get_columns()[0].get_name());
+        resp = getTag("tag_3", 3);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, resp.get_code());
+        resp = getTag("tag_3", 0);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND, resp.get_code());
+        resp = getTag("tag_no", -1);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::E_TAG_NOT_FOUND, resp.get_code());
+    }
+    // The schemas written invalidate the cache
+    {
+        cpp2::CreateTagReq req;
+        req.set_space_id(1);
+        req.set_tag_name("tag_new");
+        auto* processor = CreateTagProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, std::move(f).get().get_code());
+
+        ASSERT_EQ(11, listTags().size());
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, getTag("tag_new", -1).get_code());
+    }
+    {
+        cpp2::DropTagReq req;
+        req.set_space_id(1);
+        req.set_tag_name("tag_3");
+        auto* processor = DropTagProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, std::move(f).get().get_code());
+
+        ASSERT_EQ(10, listTags().size());
+        ASSERT_EQ(nebula::cpp2::ErrorCode::E_TAG_NOT_FOUND, getTag("tag_3", -1).get_code());
+    }
+    SchemaCache::invalidate(1);
+    FLAGS_enable_schema_cache = false;
+}
+
+TEST(ProcessorTest, MetaWarmupTest) {
+    FLAGS_enable_schema_cache = true;
+    FLAGS_meta_warmup_threads = 2;
+    SchemaCache::invalidate(1);
+    fs::TempDir rootPath("/tmp/MetaWarmupTest.XXXXXX");
+    auto kv = MockCluster::initMetaKV(rootPath.path());
+    TestUtils::assembleSpace(kv.get(), 1, 1);
+    TestUtils::mockTag(kv.get(), 10);
+
+    MetaWarmup::run(kv.get());
+    // The tags written directly into the kvstore are not seen until the cache is invalidated,
+    // which tells the tags were loaded by the warm up
+    TestUtils::mockTag(kv.get(), 12);
+    {
+        auto ret = SchemaCache::tags(kv.get(), 1);
+        ASSERT_TRUE(nebula::ok(ret));
+        ASSERT_EQ(10, nebula::value(ret)->size());
+    }
+    SchemaCache::invalidate(1);
+    {
+        auto ret = SchemaCache::tags(kv.get(), 1);
+        ASSERT_TRUE(nebula::ok(ret));
+        ASSERT_EQ(12, nebula::value(ret)->size());
+    }
+    SchemaCache::invalidate(1);
+    FLAGS_meta_warmup_threads = 0;
+    FLAGS_enable_schema_cache = false;
+}
+
 TEST(ProcessorTest, DropTagTest) {
     fs::TempDir rootPath("/tmp/DropTagTest.XXXXXX");
     auto kv = MockCluster::initMetaKV(rootPath.path());
@@ -2725,6 +2903,134 @@ TEST(ProcessorTest, SessionManagerTest) {
         ASSERT_EQ(nebula::cpp2::ErrorCode::E_SESSION_NOT_FOUND, gResp.get_code());
     }
 }
+
+TEST(ProcessorTest, SessionTableTest) {
+    fs::TempDir rootPath("/tmp/SessionTableTest.XXXXXX");
+    std::unique_ptr<kvstore::KVStore> kv(MockCluster::initMetaKV(rootPath.path()));
+    TestUtils::createSomeHosts(kv.get());
+    // only flushed by hand
+    FLAGS_session_flush_interval_ms = 3600 * 1000;
+    auto* table = SessionTable::getInstance();
+    ASSERT_TRUE(table->start(kv.get()));
+    ASSERT_EQ(table, SessionTable::get(kv.get()));
+    SessionID sessionId = 0;
+    ExecutionPlanID epId = 1;
+    {
+        cpp2::CreateUserReq req;
+        req.set_if_not_exists(false);
+        req.set_account("test_user");
+        req.set_encoded_pwd("password");
+        auto* processor = CreateUserProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, std::move(f).get().get_code());
+    }
+    auto savedSession = [&] () {
+        std::string val;
+        auto code = kv->get(kDefaultSpaceId, kDefaultPartId,
+                            MetaServiceUtils::sessionKey(sessionId), &val);
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+        return MetaServiceUtils::parseSessionVal(val);
+    };
+    // the created session is written at once
+    {
+        cpp2::CreateSessionReq req;
+        req.set_user("test_user");
+        req.set_graph_addr(HostAddr("127.0.0.1", 3699));
+        auto* processor = CreateSessionProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, resp.get_code());
+        sessionId = resp.get_session().get_session_id();
+        ASSERT_EQ(sessionId, savedSession().get_session_id());
+    }
+    // the update is only in memory until it's flushed
+    {
+        cpp2::UpdateSessionsReq req;
+        meta::cpp2::Session session;
+        session.set_session_id(sessionId);
+        session.set_space_name("test");
+        session.set_update_time(time::WallClock::fastNowInMicroSec());
+        session.queries_ref()->emplace(epId, cpp2::QueryDesc());
+        req.set_sessions({session});
+        auto* processor = UpdateSessionsProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, std::move(f).get().get_code());
+        ASSERT_EQ("", savedSession().get_space_name());
+
+        cpp2::GetSessionReq getReq;
+        getReq.set_session_id(sessionId);
+        auto* gProcessor = GetSessionProcessor::instance(kv.get());
+        auto getFut = gProcessor->getFuture();
+        gProcessor->process(getReq);
+        auto gResp = std::move(getFut).get();
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, gResp.get_code());
+        ASSERT_EQ("test", gResp.get_session().get_space_name());
+
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, table->flush());
+        ASSERT_EQ("test", savedSession().get_space_name());
+    }
+    // the killed queries are written at once
+    {
+        cpp2::KillQueryReq killReq;
+        std::unordered_map<SessionID, std::unordered_set<ExecutionPlanID>> killedQueries;
+        killedQueries[sessionId].emplace(epId);
+        killReq.set_kill_queries(std::move(killedQueries));
+        auto* processor = KillQueryProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(killReq);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, std::move(f).get().get_code());
+        ASSERT_EQ(cpp2::QueryStatus::KILLING,
+                  savedSession().get_queries().at(epId).get_status());
+
+        cpp2::UpdateSessionsReq req;
+        meta::cpp2::Session session;
+        session.set_session_id(sessionId);
+        session.queries_ref()->emplace(epId, cpp2::QueryDesc());
+        req.set_sessions({session});
+        auto* uProcessor = UpdateSessionsProcessor::instance(kv.get());
+        auto uFut = uProcessor->getFuture();
+        uProcessor->process(req);
+        auto uResp = std::move(uFut).get();
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, uResp.get_code());
+        ASSERT_EQ(1, uResp.get_killed_queries().size());
+        ASSERT_EQ(1, uResp.get_killed_queries().at(sessionId).count(epId));
+    }
+    {
+        cpp2::ListSessionsReq req;
+        auto* processor = ListSessionsProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, resp.get_code());
+        ASSERT_EQ(1, resp.get_sessions().size());
+        ASSERT_EQ(sessionId, resp.get_sessions()[0].get_session_id());
+    }
+    {
+        cpp2::RemoveSessionReq delReq;
+        delReq.set_session_id(sessionId);
+        auto* processor = RemoveSessionProcessor::instance(kv.get());
+        auto f = processor->getFuture();
+        processor->process(delReq);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, std::move(f).get().get_code());
+
+        std::string val;
+        ASSERT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND,
+                  kv->get(kDefaultSpaceId, kDefaultPartId,
+                          MetaServiceUtils::sessionKey(sessionId), &val));
+        cpp2::GetSessionReq getReq;
+        getReq.set_session_id(sessionId);
+        auto* gProcessor = GetSessionProcessor::instance(kv.get());
+        auto getFut = gProcessor->getFuture();
+        gProcessor->process(getReq);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::E_SESSION_NOT_FOUND,
+                  std::move(getFut).get().get_code());
+    }
+    table->stop();
+    FLAGS_session_flush_interval_ms = 0;
+}
 }  // namespace meta
 }  // namespace nebula
 
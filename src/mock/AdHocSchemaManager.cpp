@@ -316,5 +316,21 @@ StatusOr<std::vector<nebula::meta::cpp2::FTClient>> AdHocSchemaManager::getFTCli
 void AdHocSchemaManager::addFTClient(const nebula::meta::cpp2::FTClient& client) {
     ftClients_.emplace_back(client);
 }
+
+StatusOr<std::pair<std::string, nebula::meta::cpp2::FTIndex>>
+AdHocSchemaManager::getFTIndex(GraphSpaceID space, int32_t schemaId) {
+    auto iter = ftIndexes_.find(std::make_pair(space, schemaId));
+    if (iter == ftIndexes_.end()) {
+        return Status::IndexNotFound();
+    }
+    return iter->second;
+}
+
+void AdHocSchemaManager::addFTIndex(GraphSpaceID space,
+                                    int32_t schemaId,
+                                    const std::string& name,
+                                    const nebula::meta::cpp2::FTIndex& index) {
+    ftIndexes_[std::make_pair(space, schemaId)] = std::make_pair(name, index);
+}
 }  // namespace mock
 }  // namespace nebula
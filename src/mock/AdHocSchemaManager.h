@@ -109,10 +109,12 @@ public:
     void addFTClient(const nebula::meta::cpp2::FTClient& client);
 
     StatusOr<std::pair<std::string, nebula::meta::cpp2::FTIndex>>
-    getFTIndex(GraphSpaceID, int32_t) override {
-        LOG(FATAL) << "Unimplemented";
-        return Status::Error("Unimplemented");
-    }
+    getFTIndex(GraphSpaceID space, int32_t schemaId) override;
+
+    void addFTIndex(GraphSpaceID space,
+                    int32_t schemaId,
+                    const std::string& name,
+                    const nebula::meta::cpp2::FTIndex& index);
 
     StatusOr<int32_t> getPartsNum(GraphSpaceID) override {
         return partNum_;
@@ -148,6 +150,9 @@ private:
             std::shared_ptr<const nebula::meta::NebulaSchemaProvider>>> edgeSchemasInMap_;
 
     std::vector<nebula::meta::cpp2::FTClient> ftClients_;
+    // Key: spaceId + tagId or edgeType, Val: the name and the fulltext index
+    std::unordered_map<std::pair<GraphSpaceID, int32_t>,
+                       std::pair<std::string, nebula::meta::cpp2::FTIndex>> ftIndexes_;
     int32_t partNum_;
 };
 
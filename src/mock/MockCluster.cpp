@@ -15,6 +15,7 @@
 #include "storage/GraphStorageServiceHandler.h"
 #include "storage/GeneralStorageServiceHandler.h"
 #include "storage/CompactionFilter.h"
+#include "storage/MergeOperator.h"
 
 
 DECLARE_int32(heartbeat_interval_secs);
@@ -213,6 +214,7 @@ void MockCluster::initStorageKV(const char* dataPath,
                                                                    indexMan_.get()));
         options.cffBuilder_ = std::move(cffBuilder);
     }
+    options.mergeOp_ = std::make_shared<storage::NebulaOperator>(schemaMan_.get());
     storageKV_ = initKV(std::move(options), addr);
     waitUntilAllElected(storageKV_.get(), 1, parts);
 
@@ -15,6 +15,7 @@
 #include <folly/futures/Future.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
 #include "storage/CommonUtils.h"
+#include "storage/RequestProfile.h"
 #include "codec/RowReaderWrapper.h"
 #include "codec/RowWriterV2.h"
 #include "utils/IndexKeyUtils.h"
@@ -46,6 +47,9 @@ protected:
         }
 
         this->result_.set_latency_in_us(this->duration_.elapsedInUSec());
+        if (profile_ != nullptr) {
+            profile_->finish(this->duration_.elapsedInUSec(), this->codes_);
+        }
         this->result_.set_failed_parts(this->codes_);
         this->resp_.set_result(std::move(this->result_));
         this->promise_.setValue(std::move(this->resp_));
@@ -53,10 +57,27 @@ protected:
         if (counters_) {
             stats::StatsManager::addValue(counters_->latency_, this->duration_.elapsedInUSec());
         }
+        if (trace_ != nullptr) {
+            for (size_t stage = 0; counters_ && stage < LatencyTrace::kNumStages; stage++) {
+                if (counters_->stageLatency_[stage].valid()) {
+                    stats::StatsManager::addValue(counters_->stageLatency_[stage],
+                                                  trace_->micros(stage));
+                }
+            }
+            VLOG(1) << "The request took " << this->duration_.elapsedInUSec() << "us, "
+                    << trace_->toString();
+        }
 
         delete this;
     }
 
+    // Trace the time from the request received until it is processed
+    void traceQueued() {
+        if (trace_ != nullptr) {
+            trace_->add(LatencyTrace::kQueue, this->duration_.elapsedInUSec() * 1000);
+        }
+    }
+
     nebula::cpp2::ErrorCode getSpaceVidLen(GraphSpaceID spaceId) {
         auto len = this->env_->schemaMan_->getSpaceVidLen(spaceId);
         if (!len.ok()) {
@@ -122,6 +143,10 @@ protected:
     cpp2::ResponseCommon                            result_;
 
     time::Duration                                  duration_;
+    // null if the request is not sampled to trace
+    std::unique_ptr<LatencyTrace>                   trace_{LatencyTrace::sample()};
+    // null unless the processor profiles the slow requests, see RequestProfile
+    std::shared_ptr<RequestProfile>                 profile_;
     std::vector<cpp2::PartitionResult>              codes_;
     std::mutex                                      lock_;
     int32_t                                         callingNum_{0};
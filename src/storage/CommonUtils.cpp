@@ -5,7 +5,11 @@
  */
 
 #include "storage/CommonUtils.h"
+#include "common/expression/Expression.h"
 #include "common/time/WallClock.h"
+#include "storage/StorageFlags.h"
+#include "storage/query/QueryBaseProcessor.h"
+#include "utils/DefaultValueContext.h"
 
 namespace nebula {
 namespace storage {
@@ -53,6 +57,98 @@ std::pair<bool, std::pair<int64_t, std::string>>
     return std::make_pair(!(duration <= 0 || col.empty()), std::make_pair(duration, col));
 }
 
+IndexTTL::IndexTTL(const meta::SchemaProviderIf* schema) {
+    if (schema == nullptr) {
+        return;
+    }
+    auto ttl = CommonUtils::ttlProps(schema);
+    if (!ttl.first) {
+        return;
+    }
+    // only a column of int or timestamp expires
+    auto ftype = schema->getFieldType(ttl.second.second);
+    enabled_ = ftype == meta::cpp2::PropertyType::TIMESTAMP ||
+               ftype == meta::cpp2::PropertyType::INT64;
+    duration_ = ttl.second.first;
+    now_ = time::WallClock::fastNowInSec();
+}
+
+std::unique_ptr<QueryBudget> QueryBudget::fromFlags(GraphSpaceID spaceId) {
+    auto memory = MemoryTracker::forRequest(spaceId);
+    if (FLAGS_query_max_scanned_keys <= 0 &&
+        FLAGS_query_max_scanned_bytes <= 0 &&
+        FLAGS_query_timeout_ms <= 0 &&
+        memory == nullptr) {
+        return nullptr;
+    }
+    return std::make_unique<QueryBudget>(FLAGS_query_max_scanned_keys,
+                                         FLAGS_query_max_scanned_bytes,
+                                         FLAGS_query_timeout_ms,
+                                         std::move(memory));
+}
+
+bool QueryBudget::chargeMemory(size_t bytes) {
+    const MemoryTracker* exceeded = nullptr;
+    if (memory_->alloc(bytes, &exceeded)) {
+        return true;
+    }
+    // only the first thread exhausting it logs
+    if (!exhausted_.exchange(true, std::memory_order_relaxed)) {
+        memoryExceeded_.store(true, std::memory_order_relaxed);
+        LOG(WARNING) << "Read request stopped by the memory limit of " << exceeded->name()
+                     << ", used " << exceeded->used() << " of " << exceeded->limit()
+                     << " bytes, the request holds " << memory_->used() << " bytes";
+    }
+    return false;
+}
+
+const PropIndexCache::Projection&
+PropIndexCache::projection(const meta::SchemaProviderIf* schema,
+                           const std::vector<PropContext>* props) {
+    auto match = [schema, props] (const Entry& entry) {
+        return entry.schema_ == schema && entry.props_ == props;
+    };
+    if (last_ < entries_.size() && match(entries_[last_])) {
+        return entries_[last_].projection_;
+    }
+    for (size_t i = 0; i < entries_.size(); i++) {
+        if (match(entries_[i])) {
+            last_ = i;
+            return entries_[i].projection_;
+        }
+    }
+    if (entries_.size() >= kMaxEntries) {
+        entries_.clear();
+    }
+    Entry entry{schema, props, {}};
+    auto& indexes = entry.projection_.indexes_;
+    auto& missing = entry.projection_.missing_;
+    indexes.reserve(props->size());
+    missing.resize(props->size());
+    for (size_t i = 0; i < props->size(); i++) {
+        const auto& prop = (*props)[i];
+        if (prop.propInKeyType_ != PropContext::PropInKeyType::NONE) {
+            indexes.emplace_back(-1);
+            continue;
+        }
+        indexes.emplace_back(schema->getFieldIndex(prop.name_));
+        if (indexes.back() >= 0 || prop.field_ == nullptr) {
+            continue;
+        }
+        // the prop is added after the schema version, same as QueryUtils::checkValue
+        if (prop.field_->hasDefault()) {
+            DefaultValueContext expCtx;
+            auto expr = prop.field_->defaultValue()->clone();
+            missing[i] = Expression::eval(expr, expCtx);
+        } else if (prop.field_->nullable()) {
+            missing[i] = Value(NullType::__NULL__);
+        }
+    }
+    entries_.emplace_back(std::move(entry));
+    last_ = entries_.size() - 1;
+    return entries_.back().projection_;
+}
+
 StatusOr<Value> CommonUtils::ttlValue(const meta::SchemaProviderIf* schema, RowReader* reader) {
     DCHECK(schema != nullptr);
     const auto* ns = dynamic_cast<const meta::NebulaSchemaProvider*>(schema);
@@ -63,5 +159,48 @@ StatusOr<Value> CommonUtils::ttlValue(const meta::SchemaProviderIf* schema, RowR
     return reader->getValueByName(std::move(ttlProp).second.second);
 }
 
+std::unordered_set<EdgeType> CommonUtils::oneWayEdgeTypes(meta::SchemaManager* schemaMan,
+                                                          GraphSpaceID spaceId) {
+    std::unordered_set<EdgeType> edgeTypes;
+    if (FLAGS_one_way_edge_types.empty()) {
+        return edgeTypes;
+    }
+    std::vector<std::string> pairs;
+    folly::split(",", FLAGS_one_way_edge_types, pairs, true);
+    for (const auto& pair : pairs) {
+        std::vector<folly::StringPiece> fields;
+        folly::split(":", pair, fields, true);
+        if (fields.size() != 2) {
+            LOG(WARNING) << "Illegal one_way_edge_types " << pair;
+            continue;
+        }
+        auto id = folly::tryTo<GraphSpaceID>(folly::trimWhitespace(fields[0]));
+        if (!id.hasValue()) {
+            LOG(WARNING) << "Illegal one_way_edge_types " << pair;
+            continue;
+        }
+        if (id.value() != spaceId) {
+            continue;
+        }
+        auto edgeType = schemaMan->toEdgeType(spaceId, folly::trimWhitespace(fields[1]));
+        if (!edgeType.ok()) {
+            VLOG(1) << "Edge " << fields[1] << " of space " << spaceId << " not found";
+            continue;
+        }
+        edgeTypes.emplace(std::abs(edgeType.value()));
+    }
+    return edgeTypes;
+}
+
+// static
+int64_t CommonUtils::kvExpireTime(folly::StringPiece val) {
+    if (!FLAGS_kv_ttl_header || val.size() < sizeof(int64_t)) {
+        return std::numeric_limits<int64_t>::max();
+    }
+    int64_t expireAt = 0;
+    memcpy(&expireAt, val.data(), sizeof(int64_t));
+    return expireAt > 0 ? expireAt : std::numeric_limits<int64_t>::max();
+}
+
 }  // namespace storage
 }  // namespace nebula
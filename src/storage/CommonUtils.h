@@ -13,11 +13,29 @@
 #include "common/meta/IndexManager.h"
 #include "common/base/ConcurrentLRUCache.h"
 #include "common/interface/gen-cpp2/storage_types.h"
+#include "common/time/WallClock.h"
 #include "codec/RowReader.h"
 #include "kvstore/KVStore.h"
+#include "kvstore/PartStats.h"
+#include "utils/IndexKeyUtils.h"
 #include "utils/MemoryLockWrapper.h"
+#include "storage/IndexValueCache.h"
+#include "storage/ResultCache.h"
+#include "storage/LatencyTrace.h"
+#include "storage/RequestArena.h"
+#include "storage/VertexCache.h"
+#include "storage/ScanSessionManager.h"
+#include "storage/UpdateCombiner.h"
+#include "storage/WriteDedupWindow.h"
+#include "storage/WriteAdmission.h"
+#include "storage/PartTraffic.h"
+#include "storage/PartAffinityExecutor.h"
+#include "storage/MemoryTracker.h"
+#include "storage/VertexFilter.h"
+#include "storage/HotVertexWarmer.h"
 #include <folly/concurrency/ConcurrentHashMap.h>
 
+DECLARE_bool(enable_degree_counters);
 
 namespace nebula {
 namespace storage {
@@ -26,6 +44,8 @@ struct ProcessorCounters {
     stats::CounterId numCalls_;
     stats::CounterId numErrors_;
     stats::CounterId latency_;
+    // the latency of each stage of the requests traced, only if latency_trace_sample_rate > 0
+    std::array<stats::CounterId, LatencyTrace::kNumStages> stageLatency_;
 
     virtual ~ProcessorCounters() = default;
 
@@ -40,6 +60,18 @@ struct ProcessorCounters {
                                                           0,
                                                           20000,
                                                           "avg, p75, p95, p99");
+            for (size_t stage = 0;
+                 FLAGS_latency_trace_sample_rate > 0 && stage < LatencyTrace::kNumStages;
+                 stage++) {
+                stageLatency_[stage] = stats::StatsManager::registerHisto(
+                    folly::stringPrintf("%s_%s_latency_us",
+                                        counterName.c_str(),
+                                        LatencyTrace::stageName(stage)),
+                    1000,
+                    0,
+                    20000,
+                    "avg, p75, p95, p99");
+            }
             VLOG(1) << "Succeeded in initializing the ProcessorCounters instance";
         } else {
             VLOG(1) << "ProcessorCounters instance has been initialized";
@@ -56,7 +88,19 @@ enum class IndexState {
     FINISHED,  // The part is building index successfully.
 };
 
-using VertexCache = ConcurrentLRUCache<std::pair<VertexID, TagID>, std::string>;
+// The edges cached of an edge prefix, tagged with the write version of the part they were read
+// at. The entry is stale once the version of part moves on, which is bumped on every replica by
+// any commit, ingest, snapshot or split of the part.
+struct EdgeCacheEntry {
+    uint64_t                    version;
+    // there are too many edges to be cached, the edges are empty
+    bool                        tooMany;
+    std::vector<kvstore::KV>    edges;
+};
+
+// Edges of (space, edge prefix), the edge prefix is made up of part, srcId and edgeType.
+using EdgeCacheKey = std::pair<GraphSpaceID, std::string>;
+using EdgeCache    = ConcurrentLRUCache<EdgeCacheKey, std::shared_ptr<const EdgeCacheEntry>>;
 using IndexKey    = std::tuple<GraphSpaceID, PartitionID>;
 using IndexGuard  = folly::ConcurrentHashMap<IndexKey, IndexState>;
 
@@ -64,8 +108,11 @@ using VMLI = std::tuple<GraphSpaceID, PartitionID, TagID, VertexID>;
 using EMLI = std::tuple<GraphSpaceID, PartitionID, VertexID, EdgeType, EdgeRanking, VertexID>;
 using VerticesMemLock = MemoryLockCore<VMLI>;
 using EdgesMemLock = MemoryLockCore<EMLI>;
+using VerticesUpdateCombiner = UpdateCombiner<VMLI>;
+using EdgesUpdateCombiner = UpdateCombiner<EMLI>;
 
 class TransactionManager;
+class PlanTemplateCache;
 
 // unify TagID, EdgeType
 using SchemaID = TagID;
@@ -82,7 +129,33 @@ public:
     TransactionManager*                             txnMan_{nullptr};
     std::unique_ptr<VerticesMemLock>                verticesML_{nullptr};
     std::unique_ptr<EdgesMemLock>                   edgesML_{nullptr};
-
+    // executor to scan edges of super vertex or index range in parallel, disabled if null
+    folly::Executor*                                edgeScanPool_{nullptr};
+    // cache of edges of hot vertices, disabled if null
+    EdgeCache*                                      edgeCache_{nullptr};
+    // parked iterators of scan requests, disabled if null
+    ScanSessionManager*                             scanSessions_{nullptr};
+    // rows last written of hot vertices for the index maintenance, disabled if null
+    IndexValueCache*                                indexValueCache_{nullptr};
+    // combine the updates of the same vertex or edge at the same time, disabled if null
+    VerticesUpdateCombiner*                         verticesUC_{nullptr};
+    EdgesUpdateCombiner*                            edgesUC_{nullptr};
+    // dedup of the writes resent with the same write id, disabled if null
+    WriteDedupWindow*                               writeDedup_{nullptr};
+    // quotas and backpressure of the writes, disabled if null
+    WriteAdmission*                                 writeAdmission_{nullptr};
+    // requests of each part and the hot vertices, disabled if null
+    PartTraffic*                                    partTraffic_{nullptr};
+    // contexts built of the read requests by the request shape, disabled if null
+    PlanTemplateCache*                              planTemplates_{nullptr};
+    // executors running the read tasks of each part on the same thread, disabled if null
+    PartAffinityExecutor*                           partAffinity_{nullptr};
+    // whether a vertex may exist in a part, disabled if null
+    VertexFilter*                                   vertexFilter_{nullptr};
+    // rows of each part returned by the read requests, disabled if null
+    ResultCache*                                    resultCache_{nullptr};
+    // writes the hot vertices of a part before its leader is transferred, disabled if null
+    HotVertexWarmer*                                hotVertexWarmer_{nullptr};
 
     IndexState getIndexState(GraphSpaceID space, PartitionID part) {
         auto key = std::make_tuple(space, part);
@@ -93,6 +166,17 @@ public:
         return IndexState::FINISHED;
     }
 
+    // The executor to run the read task of the part, which is the one of the part if the
+    // affinity is enabled, otherwise the given one
+    folly::Executor* partExecutor(GraphSpaceID space,
+                                  PartitionID part,
+                                  folly::Executor* executor) const {
+        if (partAffinity_ == nullptr) {
+            return executor;
+        }
+        return partAffinity_->executorOf(space, part);
+    }
+
     bool checkRebuilding(IndexState indexState) {
         return indexState == IndexState::BUILDING;
     }
@@ -100,6 +184,28 @@ public:
     bool checkIndexLocked(IndexState indexState) {
         return indexState == IndexState::LOCKED;
     }
+
+    // Evict the cached edges which the edge key (or lock key) belongs to, when an edge is
+    // inserted, updated or removed. The stale entries are rejected by write version anyway, the
+    // eviction only frees them early.
+    void evictEdgeCache(GraphSpaceID space, size_t vIdLen, folly::StringPiece key) {
+        if (edgeCache_ == nullptr) {
+            return;
+        }
+        auto len = sizeof(PartitionID) + vIdLen + sizeof(EdgeType);
+        if (key.size() < len) {
+            return;
+        }
+        edgeCache_->evict(std::make_pair(space, key.subpiece(0, len).str()));
+    }
+
+    // Evict the row cached for index maintenance, should be called whenever a tag of vertex
+    // is written without populating the cache
+    void evictIndexValueCache(const VertexID& vId, TagID tagId) {
+        if (indexValueCache_ != nullptr) {
+            indexValueCache_->evict(std::make_pair(vId, tagId));
+        }
+    }
 };
 
 class IndexCountWrapper {
@@ -142,6 +248,75 @@ enum class ResultStatus {
 
 struct PropContext;
 
+/*
+QueryBudget bounds the keys and bytes scanned and the time spent by a read request, so that one
+runaway request can't pin a reader thread. It is shared by all threads of a request. Once any
+budget is exhausted, the iterators stop as if there is no more data, and the processor returns
+the result collected so far, with the unfinished parts reported as E_PARTIAL_RESULT.
+
+The bytes scanned are also charged to the MemoryTracker of the request if any memory limit is
+set, which is exhausted the same way when the request, its space or the process is over the limit.
+*/
+class QueryBudget final {
+public:
+    // the budget not greater than 0 is unlimited
+    QueryBudget(int64_t maxKeys,
+                int64_t maxBytes,
+                int64_t timeoutMs,
+                std::unique_ptr<MemoryTracker> memory = nullptr)
+        : maxKeys_(maxKeys)
+        , maxBytes_(maxBytes)
+        , deadline_(timeoutMs > 0 ? time::WallClock::fastNowInMilliSec() + timeoutMs : 0)
+        , memory_(std::move(memory)) {}
+
+    // Return the budget set by flags for a request of the space, nullptr if there is no limit
+    static std::unique_ptr<QueryBudget> fromFlags(GraphSpaceID spaceId);
+
+    // Charge a scanned kv, return false if any budget is exhausted
+    bool consume(size_t bytes) {
+        if (exhausted_.load(std::memory_order_relaxed)) {
+            return false;
+        }
+        auto keys = keys_.fetch_add(1, std::memory_order_relaxed) + 1;
+        auto total = bytes_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if ((maxKeys_ > 0 && keys > maxKeys_) ||
+            (maxBytes_ > 0 && total > maxBytes_) ||
+            (deadline_ > 0 && keys % kCheckTimeInterval == 0 &&
+             time::WallClock::fastNowInMilliSec() >= deadline_)) {
+            exhausted_.store(true, std::memory_order_relaxed);
+            return false;
+        }
+        if (memory_ != nullptr && !chargeMemory(bytes)) {
+            return false;
+        }
+        return true;
+    }
+
+    bool exhausted() const {
+        return exhausted_.load(std::memory_order_relaxed);
+    }
+
+    // Whether the budget is exhausted by the memory limit
+    bool memoryExceeded() const {
+        return memoryExceeded_.load(std::memory_order_relaxed);
+    }
+
+private:
+    // check the clock once every some keys
+    static constexpr int64_t kCheckTimeInterval = 64;
+
+    bool chargeMemory(size_t bytes);
+
+    const int64_t           maxKeys_;
+    const int64_t           maxBytes_;
+    const int64_t           deadline_;
+    std::atomic<int64_t>    keys_{0};
+    std::atomic<int64_t>    bytes_{0};
+    std::atomic<bool>       exhausted_{false};
+    std::unique_ptr<MemoryTracker> memory_;
+    std::atomic<bool>       memoryExceeded_{false};
+};
+
 // PlanContext stores information **unchanged** during the process.
 // All processor won't change them after request is parsed.
 class PlanContext {
@@ -160,8 +335,56 @@ public:
     // used for toss version
     int64_t             defaultEdgeVer_ = 0L;
 
+    // whether the data could be read from follower, only for the requests which don't write
+    bool                canReadFromFollower_ = false;
+
     // Manage expressions
     ObjectPool          objPool_;
+
+    // the scan budget of request, which is the only one changed during process, nullptr if
+    // there is no limit
+    std::unique_ptr<QueryBudget>    budget_;
+
+    // the latency trace of request, nullptr if it is not sampled
+    LatencyTrace*                   trace_ = nullptr;
+};
+
+/*
+PropIndexCache remembers the field index of each prop of a prop list in a row schema, so that the
+props in value are read by index for each row, instead of looking up the field by name. The rows
+of an edge type are usually written by the same schema version, so the indexes are resolved once
+for each (schema, prop list). It is not thread safe, each RunTimeContext owns one.
+
+The rows written by an older schema version don't have the props added later, their default
+values (or null) are evaluated once when the schema is met, rather than for each row.
+*/
+class PropIndexCache final {
+public:
+    struct Projection {
+        // the field index of each prop in schema, -1 if the prop is not in value or not in the
+        // schema
+        std::vector<int64_t>                    indexes_;
+        // the value of each prop in value but not in the schema, none if the prop has neither
+        // default value nor is nullable
+        std::vector<folly::Optional<Value>>     missing_;
+    };
+
+    // Return the projection of props on the schema, the result is valid until next call
+    const Projection& projection(const meta::SchemaProviderIf* schema,
+                                 const std::vector<PropContext>* props);
+
+private:
+    // the prop lists of a request are limited, just drop all when there are too many schemas
+    static constexpr size_t kMaxEntries = 64;
+
+    struct Entry {
+        const meta::SchemaProviderIf*       schema_;
+        const std::vector<PropContext>*     props_;
+        Projection                          projection_;
+    };
+
+    std::vector<Entry>      entries_;
+    size_t                  last_ = 0;
 };
 
 // RunTimeContext stores information **may changed** during the process. Since not all processor use
@@ -195,6 +418,119 @@ struct RunTimeContext {
         return &planContext_->objPool_;
     }
 
+    QueryBudget* budget() const {
+        return planContext_->budget_.get();
+    }
+
+    bool canReadFromFollower() const {
+        return planContext_->canReadFromFollower_;
+    }
+
+    LatencyTrace* trace() const {
+        return planContext_->trace_;
+    }
+
+    RequestArena* arena() {
+        return &arena_;
+    }
+
+    PropIndexCache* propIndexCache() {
+        return &propIndexCache_;
+    }
+
+    // Read the part through the handle of it, which is looked up and leader checked once for
+    // the reads of the same part in a row, see kvstore::PartHandle
+    nebula::cpp2::ErrorCode prefix(PartitionID partId,
+                                   const std::string& prefix,
+                                   std::unique_ptr<kvstore::KVIterator>* iter) {
+        auto ret = partHandle(partId);
+        if (!nebula::ok(ret)) {
+            return nebula::error(ret);
+        }
+        return nebula::value(ret)->prefix(prefix, iter);
+    }
+
+    nebula::cpp2::ErrorCode prefix(PartitionID partId,
+                                   std::string&& prefix,
+                                   std::unique_ptr<kvstore::KVIterator>* iter) = delete;
+
+    // The keys in [start, end), the iterator holds the references to start and end
+    nebula::cpp2::ErrorCode range(PartitionID partId,
+                                  const std::string& start,
+                                  const std::string& end,
+                                  std::unique_ptr<kvstore::KVIterator>* iter) {
+        auto ret = partHandle(partId);
+        if (!nebula::ok(ret)) {
+            return nebula::error(ret);
+        }
+        return nebula::value(ret)->range(start, end, iter);
+    }
+
+    std::pair<nebula::cpp2::ErrorCode, std::vector<Status>>
+    multiGet(PartitionID partId,
+             const std::vector<std::string>& keys,
+             std::vector<std::string>* values) {
+        auto ret = partHandle(partId);
+        if (!nebula::ok(ret)) {
+            return {nebula::error(ret), {}};
+        }
+        return nebula::value(ret)->multiGet(keys, values);
+    }
+
+    // False only if the vertex has neither tag nor edge in the part, by the VertexFilter. The
+    // part is checked readable first, so that the error is still returned by the read.
+    bool mayExist(PartitionID partId, const VertexID& vId) {
+        auto* filter = env()->vertexFilter_;
+        if (filter == nullptr || !nebula::ok(partHandle(partId))) {
+            return true;
+        }
+        return filter->mayExist(spaceId(), partId, vId);
+    }
+
+    // The number of edges of the edge type of the vertex by the degree counters, none if they
+    // are off, not valid for the part, or the vertex has no counter yet
+    folly::Optional<int64_t> degree(PartitionID partId, const VertexID& vId, EdgeType edgeType) {
+        if (!FLAGS_enable_degree_counters) {
+            return folly::none;
+        }
+        auto ret = partHandle(partId);
+        if (!nebula::ok(ret)) {
+            return folly::none;
+        }
+        auto* handle = nebula::value(ret);
+        // checked once for each part, the counters then follow the commits of the part
+        if (degreesPartId_ != partId) {
+            degreesPartId_ = partId;
+            degreesValid_ = kvstore::PartDegrees::valid(handle, partId);
+        }
+        std::string value;
+        if (!degreesValid_ ||
+            handle->get(NebulaKeyUtils::degreeKey(vIdLen(), partId, vId, edgeType), &value) !=
+                nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return folly::none;
+        }
+        auto count = kvstore::PartDegrees::decode(value);
+        if (count < 0) {
+            return folly::none;
+        }
+        return count;
+    }
+
+    ErrorOr<nebula::cpp2::ErrorCode, kvstore::PartHandle*> partHandle(PartitionID partId) {
+        if (partHandle_ != nullptr && handlePartId_ == partId) {
+            return partHandle_.get();
+        }
+        auto ret = env()->kvstore_->partHandle(spaceId(), partId, canReadFromFollower());
+        if (!nebula::ok(ret)) {
+            // checked again by the next read
+            partHandle_.reset();
+            return nebula::error(ret);
+        }
+        partHandle_ = std::move(nebula::value(ret));
+        handlePartId_ = partId;
+        return partHandle_.get();
+    }
+
     PlanContext                        *planContext_;
     TagID                               tagId_ = 0;
     std::string                         tagName_ = "";
@@ -210,8 +546,53 @@ struct RunTimeContext {
 
     // used for update
     bool                                insert_ = false;
+    // used for update combined, the row written by the update before but not committed yet,
+    // it is read instead of kvstore if not nullptr
+    const kvstore::KV*                  pendingRow_ = nullptr;
 
     ResultStatus                        resultStat_{ResultStatus::NORMAL};
+
+    // temporary buffers of current vertex, GetNeighborsNode resets it for each vertex
+    RequestArena                        arena_;
+
+    PropIndexCache                      propIndexCache_;
+
+    // the handle of the part read last, shared by the copies of the context
+    std::shared_ptr<kvstore::PartHandle> partHandle_;
+    PartitionID                         handlePartId_ = 0;
+    // whether the degree counters of the part read last are valid
+    PartitionID                         degreesPartId_ = 0;
+    bool                                degreesValid_ = false;
+};
+
+/*
+IndexTTL checks the ttl values kept in the index values of a tag or edge. The ttl props of the
+schema and the time are read once for a scan or compaction, instead of for each index entry, and
+the value is only decoded if the ttl column could expire. It expires the same as
+CommonUtils::checkDataExpiredForTTL.
+*/
+class IndexTTL final {
+public:
+    // Never expires if the schema is null or has no ttl
+    explicit IndexTTL(const meta::SchemaProviderIf* schema);
+
+    bool enabled() const {
+        return enabled_;
+    }
+
+    bool expired(folly::StringPiece val) const {
+        if (!enabled_ || val.empty()) {
+            return false;
+        }
+        auto v = IndexKeyUtils::parseIndexTTL(val);
+        // a value not of int, such as NULL, never expires
+        return v.isInt() && now_ > v.getInt() + duration_;
+    }
+
+private:
+    bool        enabled_{false};
+    int64_t     duration_{0};
+    int64_t     now_{0};
 };
 
 class CommonUtils final {
@@ -230,6 +611,19 @@ public:
         ttlProps(const meta::SchemaProviderIf* schema);
 
     static StatusOr<Value> ttlValue(const meta::SchemaProviderIf* schema, RowReader* reader);
+
+    // The time in seconds the value of the kv interface expires at by its header, the max of
+    // int64 if it never expires or kv_ttl_header is not set
+    static int64_t kvExpireTime(folly::StringPiece val);
+
+    static bool kvExpired(folly::StringPiece val) {
+        return kvExpireTime(val) <= time::WallClock::fastNowInSec();
+    }
+
+    // The edge types of the space listed in one_way_edge_types, whose reverse edges are not
+    // written
+    static std::unordered_set<EdgeType> oneWayEdgeTypes(meta::SchemaManager* schemaMan,
+                                                        GraphSpaceID spaceId);
 };
 
 }  // namespace storage
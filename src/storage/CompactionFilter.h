@@ -10,8 +10,10 @@
 #include "common/base/Base.h"
 #include "common/meta/NebulaSchemaProvider.h"
 #include "codec/RowReaderWrapper.h"
+#include "codec/RowWriterV2.h"
 #include "kvstore/CompactionFilter.h"
 #include "storage/CommonUtils.h"
+#include "storage/StorageFlags.h"
 #include "utils/NebulaKeyUtils.h"
 #include "utils/IndexKeyUtils.h"
 #include "utils/OperationKeyUtils.h"
@@ -35,6 +37,9 @@ public:
     bool filter(GraphSpaceID spaceId,
                 const folly::StringPiece& key,
                 const folly::StringPiece& val) const override {
+        if (FLAGS_kv_ttl_header && NebulaKeyUtils::isKV(key)) {
+            return CommonUtils::kvExpired(val);
+        }
         if (FLAGS_storage_kv_mode) {
             // in kv mode, we don't delete any data
             return false;
@@ -48,6 +53,8 @@ public:
             return !indexValid(spaceId, key, val);
         } else if (NebulaKeyUtils::isLock(vIdLen_, key)) {
             return !lockValid(spaceId, key);
+        } else if (NebulaKeyUtils::isSystemDedup(key)) {
+            return WriteDedupWindow::expired(val, FLAGS_write_dedup_ttl_secs);
         } else {
             // skip uuid/system/operation
             VLOG(3) << "Skip the system key inside, key " << key;
@@ -55,7 +62,176 @@ public:
         return false;
     }
 
+    bool schemaOf(GraphSpaceID spaceId,
+                  const folly::StringPiece& key,
+                  const folly::StringPiece& val,
+                  int64_t* schemaId,
+                  int64_t* expireTime) const override {
+        if (FLAGS_kv_ttl_header && NebulaKeyUtils::isKV(key)) {
+            *schemaId = encodeSchemaId(NebulaKeyType::kKeyValue, 0);
+            *expireTime = CommonUtils::kvExpireTime(val);
+            return true;
+        }
+        if (FLAGS_storage_kv_mode) {
+            return false;
+        }
+
+        const meta::SchemaProviderIf* schema = nullptr;
+        std::shared_ptr<const meta::NebulaSchemaProvider> holder;
+        Value ttlValue;
+        if (NebulaKeyUtils::isVertex(vIdLen_, key)) {
+            auto tagId = NebulaKeyUtils::getTagId(vIdLen_, key);
+            *schemaId = encodeSchemaId(NebulaKeyType::kVertex, tagId);
+            holder = schemaMan_->getTagSchema(spaceId, tagId);
+            schema = holder.get();
+            auto col = ttlCol(schema);
+            if (!col.empty()) {
+                auto reader = RowReaderWrapper::getTagPropReader(schemaMan_, spaceId, tagId, val);
+                if (reader == nullptr) {
+                    *expireTime = 0;
+                    return true;
+                }
+                ttlValue = reader->getValueByName(col);
+            }
+        } else if (NebulaKeyUtils::isEdge(vIdLen_, key)) {
+            auto edgeType = NebulaKeyUtils::getEdgeType(vIdLen_, key);
+            *schemaId = encodeSchemaId(NebulaKeyType::kEdge, std::abs(edgeType));
+            if (edgeType < 0 && val.empty()) {
+                // invalid reverse edge, which is always removed
+                *expireTime = 0;
+                return true;
+            }
+            holder = schemaMan_->getEdgeSchema(spaceId, std::abs(edgeType));
+            schema = holder.get();
+            auto col = ttlCol(schema);
+            if (!col.empty()) {
+                auto reader = RowReaderWrapper::getEdgePropReader(
+                    schemaMan_, spaceId, std::abs(edgeType), val);
+                if (reader == nullptr) {
+                    *expireTime = 0;
+                    return true;
+                }
+                ttlValue = reader->getValueByName(col);
+            }
+        } else if (IndexKeyUtils::isIndexKey(key)) {
+            auto indexId = IndexKeyUtils::getIndexId(key);
+            *schemaId = encodeSchemaId(NebulaKeyType::kIndex, indexId);
+            if (!val.empty()) {
+                auto eRet = indexMan_->getEdgeIndex(spaceId, indexId);
+                auto tRet = indexMan_->getTagIndex(spaceId, indexId);
+                if (eRet.ok()) {
+                    holder = schemaMan_->getEdgeSchema(
+                        spaceId, eRet.value()->get_schema_id().get_edge_type());
+                } else if (tRet.ok()) {
+                    holder = schemaMan_->getTagSchema(
+                        spaceId, tRet.value()->get_schema_id().get_tag_id());
+                }
+                schema = holder.get();
+                ttlValue = IndexKeyUtils::parseIndexTTL(val);
+            }
+        } else if (NebulaKeyUtils::isLock(vIdLen_, key)) {
+            auto edgeType = NebulaKeyUtils::getEdgeType(vIdLen_, key);
+            *schemaId = encodeSchemaId(NebulaKeyType::kEdge, std::abs(edgeType));
+        } else {
+            return false;
+        }
+        if (schema != nullptr) {
+            *expireTime = ttlExpireTime(schema, ttlValue);
+        }
+        return true;
+    }
+
+    // Encode the vertex or edge in the V1 format in V2 with the same schema version, so that
+    // it's read by the faster RowReaderV2 since
+    bool rewrite(GraphSpaceID spaceId,
+                 const folly::StringPiece& key,
+                 const folly::StringPiece& val,
+                 std::string* newVal) const override {
+        if (!FLAGS_rewrite_v1_rows_on_compaction || FLAGS_storage_kv_mode || val.empty()) {
+            return false;
+        }
+        SchemaVer schemaVer;
+        int32_t readerVer;
+        RowReaderWrapper::getVersions(val, schemaVer, readerVer);
+        if (readerVer != 1 || schemaVer < 0) {
+            return false;
+        }
+        if (NebulaKeyUtils::isVertex(vIdLen_, key)) {
+            auto tagId = NebulaKeyUtils::getTagId(vIdLen_, key);
+            auto reader = RowReaderWrapper::getTagPropReader(schemaMan_, spaceId, tagId, val);
+            return encodeV2(reader, newVal);
+        } else if (NebulaKeyUtils::isEdge(vIdLen_, key)) {
+            auto edgeType = NebulaKeyUtils::getEdgeType(vIdLen_, key);
+            auto reader =
+                RowReaderWrapper::getEdgePropReader(schemaMan_, spaceId, std::abs(edgeType), val);
+            return encodeV2(reader, newVal);
+        }
+        return false;
+    }
+
+    bool schemaDropped(GraphSpaceID spaceId, int64_t schemaId) const override {
+        auto id = static_cast<int32_t>(schemaId & 0xFFFFFFFF);
+        switch (static_cast<NebulaKeyType>(schemaId >> 32)) {
+            case NebulaKeyType::kVertex:
+                return schemaMan_->getTagSchema(spaceId, id) == nullptr;
+            case NebulaKeyType::kEdge:
+                return schemaMan_->getEdgeSchema(spaceId, id) == nullptr;
+            case NebulaKeyType::kIndex:
+                return indexMan_->getEdgeIndex(spaceId, id).status() == Status::IndexNotFound() &&
+                       indexMan_->getTagIndex(spaceId, id).status() == Status::IndexNotFound();
+            default:
+                return false;
+        }
+    }
+
 private:
+    static bool encodeV2(RowReaderWrapper& reader, std::string* encoded) {
+        if (reader == nullptr) {
+            return false;
+        }
+        // a field not decoded is kept as it is, rather than written as null
+        for (size_t i = 0; i < reader->numFields(); i++) {
+            auto v = reader->getValueByIndex(i);
+            if (v.isNull() && v.getNull() != NullType::__NULL__) {
+                return false;
+            }
+        }
+        RowWriterV2 writer(*reader);
+        if (writer.finish() != WriteResult::SUCCEEDED) {
+            VLOG(3) << "Failed to encode the row in V2";
+            return false;
+        }
+        *encoded = writer.moveEncodedStr();
+        return true;
+    }
+
+    static int64_t encodeSchemaId(NebulaKeyType type, int32_t id) {
+        return (static_cast<int64_t>(type) << 32) | static_cast<uint32_t>(id);
+    }
+
+    // The ttl column of schema, empty if it has no ttl
+    static std::string ttlCol(const meta::SchemaProviderIf* schema) {
+        if (schema == nullptr) {
+            return "";
+        }
+        auto ttl = CommonUtils::ttlProps(schema);
+        return ttl.first ? ttl.second.second : "";
+    }
+
+    // The time when the data with ttl value v is expired, the same as ttlExpired
+    int64_t ttlExpireTime(const meta::SchemaProviderIf* schema, const Value& v) const {
+        auto ttl = CommonUtils::ttlProps(schema);
+        if (!ttl.first || !v.isInt()) {
+            return std::numeric_limits<int64_t>::max();
+        }
+        const auto& ftype = schema->getFieldType(ttl.second.second);
+        if (ftype != meta::cpp2::PropertyType::TIMESTAMP &&
+            ftype != meta::cpp2::PropertyType::INT64) {
+            return std::numeric_limits<int64_t>::max();
+        }
+        return v.getInt() + ttl.second.first;
+    }
+
     bool vertexValid(GraphSpaceID spaceId,
                      const folly::StringPiece& key,
                      const folly::StringPiece& val) const {
@@ -130,62 +306,72 @@ private:
                                                    ttl.second.first);
     }
 
-    bool ttlExpired(const meta::SchemaProviderIf* schema, const Value& v) const {
-        if (schema == nullptr) {
-            return true;
+    // The index of the entries, whose schema and ttl are looked up once for a compaction, since
+    // the filter is created for each compaction and used by one thread
+    struct IndexInfo {
+        // whether the index exists, otherwise the entries are kept unless it is not found
+        bool        found{false};
+        bool        keep{true};
+        // whether the tag or edge of the index exists, otherwise the entries with ttl are dropped
+        bool        schemaValid{false};
+        IndexTTL    ttl{nullptr};
+    };
+
+    IndexInfo indexInfo(GraphSpaceID spaceId, IndexID indexId) const {
+        IndexInfo info;
+        auto eRet = indexMan_->getEdgeIndex(spaceId, indexId);
+        if (eRet.ok()) {
+            info.found = true;
+            auto id = eRet.value()->get_schema_id().get_edge_type();
+            auto schema = schemaMan_->getEdgeSchema(spaceId, id);
+            if (!schema) {
+                VLOG(3) << "Space " << spaceId << ", EdgeType " << id << " invalid";
+            }
+            info.schemaValid = schema != nullptr;
+            info.ttl = IndexTTL(schema.get());
+            return info;
         }
-        auto ttl = CommonUtils::ttlProps(schema);
-        if (!ttl.first) {
-            return false;
+        auto tRet = indexMan_->getTagIndex(spaceId, indexId);
+        if (tRet.ok()) {
+            info.found = true;
+            auto id = tRet.value()->get_schema_id().get_tag_id();
+            auto schema = schemaMan_->getTagSchema(spaceId, id);
+            if (!schema) {
+                VLOG(3) << "Space " << spaceId << ", tagId " << id << " invalid";
+            }
+            info.schemaValid = schema != nullptr;
+            info.ttl = IndexTTL(schema.get());
+            return info;
         }
-        return CommonUtils::checkDataExpiredForTTL(schema,
-                                                   v,
-                                                   ttl.second.second,
-                                                   ttl.second.first);
+        info.keep = !(eRet.status() == Status::IndexNotFound() &&
+                      tRet.status() == Status::IndexNotFound());
+        return info;
     }
 
     bool indexValid(GraphSpaceID spaceId,
                     const folly::StringPiece& key,
                     const folly::StringPiece& val) const {
         auto indexId = IndexKeyUtils::getIndexId(key);
-        auto eRet = indexMan_->getEdgeIndex(spaceId, indexId);
-        if (eRet.ok()) {
-            if (!val.empty()) {
-                auto id = eRet.value()->get_schema_id().get_edge_type();
-                auto schema = schemaMan_->getEdgeSchema(spaceId, id);
-                if (!schema) {
-                    VLOG(3) << "Space " << spaceId << ", EdgeType " << id << " invalid";
-                    return false;
-                }
-                if (ttlExpired(schema.get(), IndexKeyUtils::parseIndexTTL(val))) {
-                    return false;
-                }
-            }
-            return true;
+        auto it = indexes_.find(indexId);
+        if (it == indexes_.end()) {
+            it = indexes_.emplace(indexId, indexInfo(spaceId, indexId)).first;
         }
-        auto tRet = indexMan_->getTagIndex(spaceId, indexId);
-        if (tRet.ok()) {
-            if (!val.empty()) {
-                auto id = tRet.value()->get_schema_id().get_tag_id();
-                auto schema = schemaMan_->getTagSchema(spaceId, id);
-                if (!schema) {
-                    VLOG(3) << "Space " << spaceId << ", tagId " << id << " invalid";
-                    return false;
-                }
-                if (ttlExpired(schema.get(), IndexKeyUtils::parseIndexTTL(val))) {
-                    return false;
-                }
-            }
+        const auto& info = it->second;
+        if (!info.found) {
+            return info.keep;
+        }
+        if (val.empty()) {
             return true;
         }
-        return !(eRet.status() == Status::IndexNotFound() &&
-                 tRet.status() == Status::IndexNotFound());
+        // the expired index entries are dropped here, the reads only filter the ones left
+        return info.schemaValid && !info.ttl.expired(val);
     }
 
 private:
     meta::SchemaManager* schemaMan_ = nullptr;
     meta::IndexManager* indexMan_ = nullptr;
     size_t vIdLen_;
+    mutable std::unordered_map<IndexID, IndexInfo> indexes_;
 };
 
 class StorageCompactionFilterFactory final : public kvstore::KVCompactionFilterFactory {
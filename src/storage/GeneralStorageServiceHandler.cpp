@@ -8,6 +8,7 @@
 #include "storage/kv/GetProcessor.h"
 #include "storage/kv/RemoveProcessor.h"
 #include "storage/GeneralStorageServiceHandler.h"
+#include "storage/StorageFlags.h"
 
 #define RETURN_FUTURE(processor) \
     auto f = processor->getFuture(); \
@@ -22,6 +23,10 @@ GeneralStorageServiceHandler::GeneralStorageServiceHandler(StorageEnv* env)
     kPutCounters.init("put");
     kGetCounters.init("get");
     kRemoveCounters.init("remove");
+    if (FLAGS_kv_get_concurrently) {
+        readerPool_ = std::make_shared<folly::CPUThreadPoolExecutor>(
+            FLAGS_reader_handlers, std::make_shared<folly::NamedThreadFactory>("kv-reader"));
+    }
 }
 
 
@@ -34,7 +39,7 @@ GeneralStorageServiceHandler::future_put(const cpp2::KVPutRequest& req) {
 
 folly::Future<cpp2::KVGetResponse>
 GeneralStorageServiceHandler::future_get(const cpp2::KVGetRequest& req) {
-    auto* processor = GetProcessor::instance(env_);
+    auto* processor = GetProcessor::instance(env_, &kGetCounters, readerPool_.get());
     RETURN_FUTURE(processor);
 }
 
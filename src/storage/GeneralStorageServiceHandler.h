@@ -9,6 +9,7 @@
 
 #include "common/base/Base.h"
 #include "common/interface/gen-cpp2/GeneralStorageService.h"
+#include <folly/executors/CPUThreadPoolExecutor.h>
 
 namespace nebula {
 namespace storage {
@@ -29,7 +30,9 @@ public:
     future_remove(const cpp2::KVRemoveRequest& req) override;
 
 private:
-    StorageEnv*             env_{nullptr};
+    StorageEnv*                                         env_{nullptr};
+    // the parts of a get are got in it at once, created if kv_get_concurrently is set
+    std::shared_ptr<folly::CPUThreadPoolExecutor>       readerPool_;
 };
 
 }  // namespace storage
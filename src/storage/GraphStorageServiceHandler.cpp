@@ -18,6 +18,7 @@
 #include "storage/query/ScanEdgeProcessor.h"
 #include "storage/index/LookupProcessor.h"
 #include "storage/transaction/TransactionProcessor.h"
+#include <thrift/lib/cpp2/protocol/CompactProtocol.h>
 
 #define RETURN_FUTURE(processor) \
     auto f = processor->getFuture(); \
@@ -27,13 +28,22 @@
 namespace nebula {
 namespace storage {
 
-GraphStorageServiceHandler::GraphStorageServiceHandler(StorageEnv* env)
+GraphStorageServiceHandler::GraphStorageServiceHandler(StorageEnv* env,
+                                                       VertexCache* vertexCache)
         : env_(env)
-        , vertexCache_(FLAGS_vertex_cache_num, FLAGS_vertex_cache_bucket_exp) {
+        , vertexCache_(vertexCache) {
+    bool supportPriority = false;
     if (FLAGS_reader_handlers_type == "io") {
         auto tf = std::make_shared<folly::NamedThreadFactory>("reader-pool");
         readerPool_ = std::make_shared<folly::IOThreadPoolExecutor>(FLAGS_reader_handlers,
                                                                     std::move(tf));
+    } else if (FLAGS_reader_handlers_type == "priority") {
+        // high priority for point lookup, mid for traversal, low for scan
+        auto tf = std::make_shared<folly::NamedThreadFactory>("reader-pool");
+        readerPool_ = std::make_shared<folly::CPUThreadPoolExecutor>(FLAGS_reader_handlers,
+                                                                     3,
+                                                                     std::move(tf));
+        supportPriority = true;
     } else {
         if (FLAGS_reader_handlers_type != "cpu") {
             LOG(WARNING) << "Unknown value for --reader_handlers_type, using `cpu'";
@@ -44,6 +54,12 @@ GraphStorageServiceHandler::GraphStorageServiceHandler(StorageEnv* env)
         pool->start();
         readerPool_ = std::move(pool);
     }
+    highPriReader_ = std::make_unique<PriorityExecutor>(
+        readerPool_.get(), folly::Executor::HI_PRI, supportPriority);
+    midPriReader_ = std::make_unique<PriorityExecutor>(
+        readerPool_.get(), folly::Executor::MID_PRI, supportPriority);
+    lowPriReader_ = std::make_unique<PriorityExecutor>(
+        readerPool_.get(), folly::Executor::LO_PRI, supportPriority);
 
     // Initialize all counters
     kAddVerticesCounters.init("add_vertices");
@@ -60,28 +76,153 @@ GraphStorageServiceHandler::GraphStorageServiceHandler(StorageEnv* env)
     kScanEdgeCounters.init("scan_edge");
 }
 
+template <typename REQ>
+folly::Future<cpp2::ExecResponse>
+GraphStorageServiceHandler::admitWrite(
+        const REQ& req,
+        WriteAdmission::Priority priority,
+        std::function<folly::Future<cpp2::ExecResponse>(const REQ&)> process) {
+    auto* admission = env_->writeAdmission_;
+    if (admission == nullptr) {
+        return process(req);
+    }
+    int64_t rows = 0;
+    for (const auto& part : req.get_parts()) {
+        rows += part.second.size();
+    }
+    int64_t bytes = 0;
+    if (FLAGS_write_quota_bytes_per_sec > 0) {
+        apache::thrift::CompactProtocolWriter writer;
+        bytes = req.serializedSize(&writer);
+    }
+    std::chrono::milliseconds delay;
+    auto code = admission->admit(req.get_space_id(), priority, rows, bytes, &delay);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        std::vector<cpp2::PartitionResult> failedParts;
+        for (const auto& part : req.get_parts()) {
+            cpp2::PartitionResult result;
+            result.set_code(code);
+            result.set_part_id(part.first);
+            failedParts.emplace_back(std::move(result));
+        }
+        cpp2::ResponseCommon result;
+        result.set_latency_in_us(0);
+        result.set_failed_parts(std::move(failedParts));
+        cpp2::ExecResponse resp;
+        resp.set_result(std::move(result));
+        return resp;
+    }
+    if (delay.count() == 0) {
+        return process(req);
+    }
+    // the request is released once returned, so it is copied for the delayed write
+    return folly::futures::sleep(delay)
+        .via(midPriReader_.get())
+        .thenValue([req, process = std::move(process)] (auto&&) {
+            return process(req);
+        });
+}
+
+template <typename REQ, typename VidOf>
+void GraphStorageServiceHandler::recordTraffic(const REQ& req,
+                                               PartTraffic::Kind kind,
+                                               VidOf&& vidOf) {
+    auto* traffic = env_->partTraffic_;
+    if (traffic == nullptr) {
+        return;
+    }
+    auto spaceId = req.get_space_id();
+    int64_t rows = 0;
+    int64_t bytes = 0;
+    if (kind == PartTraffic::Kind::WRITE) {
+        for (const auto& part : req.get_parts()) {
+            rows += part.second.size();
+        }
+        apache::thrift::CompactProtocolWriter writer;
+        bytes = req.serializedSize(&writer);
+    }
+    for (const auto& part : req.get_parts()) {
+        auto items = static_cast<int64_t>(part.second.size());
+        traffic->record(spaceId, part.first, kind, items, rows > 0 ? bytes * items / rows : 0);
+        for (const auto& item : part.second) {
+            recordVertex(spaceId, part.first, vidOf(item));
+        }
+    }
+}
+
+void GraphStorageServiceHandler::recordVertex(GraphSpaceID spaceId,
+                                              PartitionID partId,
+                                              const Value* vid) {
+    auto* traffic = env_->partTraffic_;
+    if (traffic == nullptr || vid == nullptr) {
+        return;
+    }
+    if (vid->isStr()) {
+        traffic->recordVertex(spaceId, partId, vid->getStr());
+    } else {
+        traffic->recordVertex(spaceId, partId, vid->toString());
+    }
+}
+
+std::string GraphStorageServiceHandler::writeIdOf() {
+    auto* ctx = getRequestContext();
+    if (env_->writeDedup_ == nullptr || ctx == nullptr) {
+        return "";
+    }
+    const auto& headers = ctx->getHeaders();
+    auto iter = headers.find(WriteDedupWindow::kWriteIdHeader);
+    if (iter == headers.end() || iter->second.size() > WriteDedupWindow::kMaxWriteIdLen) {
+        return "";
+    }
+    return iter->second;
+}
+
 
 // Vertice section
 folly::Future<cpp2::ExecResponse>
 GraphStorageServiceHandler::future_addVertices(const cpp2::AddVerticesRequest& req) {
-    auto* processor = AddVerticesProcessor::instance(env_, &kAddVerticesCounters, &vertexCache_);
-    RETURN_FUTURE(processor);
+    recordTraffic(req, PartTraffic::Kind::WRITE, [] (const cpp2::NewVertex& v) {
+        return &v.get_id();
+    });
+    auto process = [this] (const cpp2::AddVerticesRequest& req) {
+        auto* processor = AddVerticesProcessor::instance(env_,
+                                                         &kAddVerticesCounters,
+                                                         vertexCache_,
+                                                         midPriReader_.get());
+        RETURN_FUTURE(processor);
+    };
+    return admitWrite<cpp2::AddVerticesRequest>(
+        req, WriteAdmission::Priority::LOW, std::move(process));
 }
 
 
 folly::Future<cpp2::ExecResponse>
 GraphStorageServiceHandler::future_deleteVertices(const cpp2::DeleteVerticesRequest& req) {
-    auto* processor = DeleteVerticesProcessor::instance(env_, &kDelVerticesCounters, &vertexCache_);
-    RETURN_FUTURE(processor);
+    recordTraffic(req, PartTraffic::Kind::WRITE, [] (const Value& vid) {
+        return &vid;
+    });
+    auto process = [this] (const cpp2::DeleteVerticesRequest& req) {
+        auto* processor = DeleteVerticesProcessor::instance(env_,
+                                                            &kDelVerticesCounters,
+                                                            vertexCache_);
+        RETURN_FUTURE(processor);
+    };
+    return admitWrite<cpp2::DeleteVerticesRequest>(
+        req, WriteAdmission::Priority::HIGH, std::move(process));
 }
 
 
 folly::Future<cpp2::UpdateResponse>
 GraphStorageServiceHandler::future_updateVertex(const cpp2::UpdateVertexRequest& req) {
+    if (env_->partTraffic_ != nullptr) {
+        env_->partTraffic_->record(req.get_space_id(), req.get_part_id(),
+                                   PartTraffic::Kind::WRITE, 1, 0);
+        recordVertex(req.get_space_id(), req.get_part_id(), &req.get_vertex_id());
+    }
     auto* processor = UpdateVertexProcessor::instance(env_,
                                                       &kUpdateVertexCounters,
-                                                      readerPool_.get(),
-                                                      &vertexCache_);
+                                                      midPriReader_.get(),
+                                                      vertexCache_);
     RETURN_FUTURE(processor);
 }
 
@@ -89,69 +230,113 @@ GraphStorageServiceHandler::future_updateVertex(const cpp2::UpdateVertexRequest&
 // Edge section
 folly::Future<cpp2::ExecResponse>
 GraphStorageServiceHandler::future_addEdges(const cpp2::AddEdgesRequest& req) {
-    auto* processor = AddEdgesProcessor::instance(env_, &kAddEdgesCounters);
-    RETURN_FUTURE(processor);
+    recordTraffic(req, PartTraffic::Kind::WRITE, [] (const cpp2::NewEdge& e) {
+        return &e.get_key().get_src();
+    });
+    auto process = [this, writeId = writeIdOf()] (const cpp2::AddEdgesRequest& req) {
+        auto* processor = AddEdgesProcessor::instance(env_,
+                                                      &kAddEdgesCounters,
+                                                      midPriReader_.get());
+        processor->setWriteId(writeId);
+        RETURN_FUTURE(processor);
+    };
+    return admitWrite<cpp2::AddEdgesRequest>(
+        req, WriteAdmission::Priority::LOW, std::move(process));
 }
 
 
 folly::Future<cpp2::ExecResponse>
 GraphStorageServiceHandler::future_deleteEdges(const cpp2::DeleteEdgesRequest& req) {
-    auto* processor = DeleteEdgesProcessor::instance(env_, &kDelEdgesCounters);
-    RETURN_FUTURE(processor);
+    recordTraffic(req, PartTraffic::Kind::WRITE, [] (const cpp2::EdgeKey& key) {
+        return &key.get_src();
+    });
+    auto process = [this] (const cpp2::DeleteEdgesRequest& req) {
+        auto* processor = DeleteEdgesProcessor::instance(env_, &kDelEdgesCounters);
+        RETURN_FUTURE(processor);
+    };
+    return admitWrite<cpp2::DeleteEdgesRequest>(
+        req, WriteAdmission::Priority::HIGH, std::move(process));
 }
 
 
 folly::Future<cpp2::UpdateResponse>
 GraphStorageServiceHandler::future_updateEdge(const cpp2::UpdateEdgeRequest& req) {
-    auto* processor = UpdateEdgeProcessor::instance(env_, &kUpdateEdgeCounters, readerPool_.get());
+    if (env_->partTraffic_ != nullptr) {
+        env_->partTraffic_->record(req.get_space_id(), req.get_part_id(),
+                                   PartTraffic::Kind::WRITE, 1, 0);
+        recordVertex(req.get_space_id(), req.get_part_id(), &req.get_edge_key().get_src());
+    }
+    auto* processor = UpdateEdgeProcessor::instance(env_,
+                                                    &kUpdateEdgeCounters,
+                                                    midPriReader_.get());
     RETURN_FUTURE(processor);
 }
 
 
 folly::Future<cpp2::GetNeighborsResponse>
 GraphStorageServiceHandler::future_getNeighbors(const cpp2::GetNeighborsRequest& req) {
+    recordTraffic(req, PartTraffic::Kind::READ, [] (const Row& row) {
+        return row.values.empty() ? nullptr : &row.values[0];
+    });
     auto* processor = GetNeighborsProcessor::instance(env_,
                                                       &kGetNeighborsCounters,
-                                                      readerPool_.get(),
-                                                      &vertexCache_);
+                                                      midPriReader_.get(),
+                                                      vertexCache_);
     RETURN_FUTURE(processor);
 }
 
 
 folly::Future<cpp2::GetPropResponse>
 GraphStorageServiceHandler::future_getProps(const cpp2::GetPropRequest& req) {
+    // the first column is the vertex, or the src of the edge
+    recordTraffic(req, PartTraffic::Kind::READ, [] (const Row& row) {
+        return row.values.empty() ? nullptr : &row.values[0];
+    });
     auto* processor = GetPropProcessor::instance(env_,
                                                  &kGetPropCounters,
-                                                 readerPool_.get(),
-                                                 &vertexCache_);
+                                                 highPriReader_.get(),
+                                                 vertexCache_);
     RETURN_FUTURE(processor);
 }
 
 
 folly::Future<cpp2::LookupIndexResp>
 GraphStorageServiceHandler::future_lookupIndex(const cpp2::LookupIndexRequest& req) {
+    if (env_->partTraffic_ != nullptr) {
+        for (auto partId : req.get_parts()) {
+            env_->partTraffic_->record(req.get_space_id(), partId, PartTraffic::Kind::READ, 1, 0);
+        }
+    }
     auto* processor = LookupProcessor::instance(env_,
                                                 &kLookupCounters,
-                                                readerPool_.get(),
-                                                &vertexCache_);
+                                                midPriReader_.get(),
+                                                vertexCache_);
     RETURN_FUTURE(processor);
 }
 
 
 folly::Future<cpp2::ScanVertexResponse>
 GraphStorageServiceHandler::future_scanVertex(const cpp2::ScanVertexRequest& req) {
+    if (env_->partTraffic_ != nullptr) {
+        env_->partTraffic_->record(req.get_space_id(), req.get_part_id(),
+                                   PartTraffic::Kind::READ, 1, 0);
+    }
     auto* processor = ScanVertexProcessor::instance(env_,
                                                     &kScanVertexCounters,
-                                                    readerPool_.get());
+                                                    lowPriReader_.get());
     RETURN_FUTURE(processor);
 }
 
 
 folly::Future<cpp2::ScanEdgeResponse>
 GraphStorageServiceHandler::future_scanEdge(const cpp2::ScanEdgeRequest& req) {
+    if (env_->partTraffic_ != nullptr) {
+        env_->partTraffic_->record(req.get_space_id(), req.get_part_id(),
+                                   PartTraffic::Kind::READ, 1, 0);
+    }
     auto* processor = ScanEdgeProcessor::instance(env_,
                                                   &kScanEdgeCounters,
-                                                  readerPool_.get());
+                                                  lowPriReader_.get());
     RETURN_FUTURE(processor);
 }
 
@@ -164,8 +349,15 @@ GraphStorageServiceHandler::future_getUUID(const cpp2::GetUUIDReq&) {
 
 folly::Future<cpp2::ExecResponse>
 GraphStorageServiceHandler::future_addEdgesAtomic(const cpp2::AddEdgesRequest& req) {
-    auto* processor = AddEdgesAtomicProcessor::instance(env_, &kAddEdgesAtomicCounters);
-    RETURN_FUTURE(processor);
+    recordTraffic(req, PartTraffic::Kind::WRITE, [] (const cpp2::NewEdge& e) {
+        return &e.get_key().get_src();
+    });
+    auto process = [this] (const cpp2::AddEdgesRequest& req) {
+        auto* processor = AddEdgesAtomicProcessor::instance(env_, &kAddEdgesAtomicCounters);
+        RETURN_FUTURE(processor);
+    };
+    return admitWrite<cpp2::AddEdgesRequest>(
+        req, WriteAdmission::Priority::LOW, std::move(process));
 }
 
 }  // namespace storage
@@ -10,8 +10,10 @@
 #include "common/base/Base.h"
 #include "common/interface/gen-cpp2/GraphStorageService.h"
 #include <folly/executors/IOThreadPoolExecutor.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include "storage/CommonUtils.h"
 #include "storage/StorageFlags.h"
+#include "storage/PriorityExecutor.h"
 
 namespace nebula {
 namespace storage {
@@ -20,7 +22,8 @@ class StorageEnv;
 
 class GraphStorageServiceHandler final : public cpp2::GraphStorageServiceSvIf {
 public:
-    explicit GraphStorageServiceHandler(StorageEnv* env);
+    // vertexCache is owned by the caller, the vertex cache is disabled if it is null
+    explicit GraphStorageServiceHandler(StorageEnv* env, VertexCache* vertexCache = nullptr);
 
     // Vertice section
     folly::Future<cpp2::ExecResponse>
@@ -63,10 +66,35 @@ public:
     folly::Future<cpp2::GetUUIDResp>
     future_getUUID(const cpp2::GetUUIDReq& req) override;
 
+private:
+    // Process the write once it is admitted by env_->writeAdmission_, at once or after a delay,
+    // otherwise all parts of it fail with the code rejected
+    template <typename REQ>
+    folly::Future<cpp2::ExecResponse>
+    admitWrite(const REQ& req,
+               WriteAdmission::Priority priority,
+               std::function<folly::Future<cpp2::ExecResponse>(const REQ&)> process);
+
+    // Record the requests of each part of req by env_->partTraffic_, vidOf returns the vertex
+    // of each item of a part, the bytes of a write are shared by its items
+    template <typename REQ, typename VidOf>
+    void recordTraffic(const REQ& req, PartTraffic::Kind kind, VidOf&& vidOf);
+
+    // Record the vertex requested as a hot vertex candidate, if not null
+    void recordVertex(GraphSpaceID spaceId, PartitionID partId, const Value* vid);
+
+    // The write id in the WriteDedupWindow::kWriteIdHeader of the request being handled,
+    // empty if there is none or the dedup is disabled
+    std::string writeIdOf();
+
 private:
     StorageEnv*                                     env_{nullptr};
-    VertexCache                                     vertexCache_;
+    VertexCache*                                    vertexCache_{nullptr};
     std::shared_ptr<folly::Executor>                readerPool_;
+    // views of readerPool_ with different priorities
+    std::unique_ptr<PriorityExecutor>               highPriReader_;
+    std::unique_ptr<PriorityExecutor>               midPriReader_;
+    std::unique_ptr<PriorityExecutor>               lowPriReader_;
 };
 
 }  // namespace storage
@@ -0,0 +1,209 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/HotVertexWarmer.h"
+#include "kvstore/NebulaStore.h"
+#include "utils/NebulaKeyUtils.h"
+#include <thrift/lib/cpp/util/EnumUtils.h>
+
+namespace nebula {
+namespace storage {
+
+HotVertexWarmer::HotVertexWarmer(meta::SchemaManager* schemaMan, int32_t persistIntervalSecs)
+    : schemaMan_(schemaMan)
+    , persistIntervalSecs_(persistIntervalSecs) {}
+
+HotVertexWarmer::~HotVertexWarmer() {
+    stop();
+}
+
+bool HotVertexWarmer::start() {
+    worker_ = std::make_unique<thread::GenericWorker>();
+    if (!worker_->start("hot-vertex-warmer")) {
+        return false;
+    }
+    running_.store(true, std::memory_order_release);
+    worker_->addTask(&HotVertexWarmer::warmAll, this);
+    if (traffic_ != nullptr && persistIntervalSecs_ > 0) {
+        worker_->addRepeatTask(persistIntervalSecs_ * 1000, &HotVertexWarmer::persistAll, this);
+    }
+    return true;
+}
+
+void HotVertexWarmer::stop() {
+    running_.store(false, std::memory_order_release);
+    if (worker_ != nullptr) {
+        worker_->stop();
+        worker_->wait();
+        worker_.reset();
+    }
+}
+
+// static
+std::string HotVertexWarmer::encode(const std::vector<std::string>& vIds) {
+    std::string val;
+    for (const auto& vId : vIds) {
+        uint32_t len = vId.size();
+        val.append(reinterpret_cast<const char*>(&len), sizeof(uint32_t)).append(vId);
+    }
+    return val;
+}
+
+// static
+std::vector<std::string> HotVertexWarmer::decode(folly::StringPiece val) {
+    std::vector<std::string> vIds;
+    while (val.size() >= sizeof(uint32_t)) {
+        uint32_t len;
+        memcpy(&len, val.data(), sizeof(uint32_t));
+        val.advance(sizeof(uint32_t));
+        if (val.size() < len) {
+            break;
+        }
+        vIds.emplace_back(val.subpiece(0, len).str());
+        val.advance(len);
+    }
+    return vIds;
+}
+
+std::vector<std::string>
+HotVertexWarmer::hotVertices(GraphSpaceID spaceId,
+                             PartitionID partId,
+                             const std::vector<PartTraffic::HotVertex>& hot) {
+    std::vector<std::string> vIds;
+    auto vidType = schemaMan_->getSpaceVidType(spaceId);
+    if (!vidType.ok()) {
+        return vIds;
+    }
+    bool intId = vidType.value() == meta::cpp2::PropertyType::INT64;
+    for (const auto& vertex : hot) {
+        if (vertex.partId != partId) {
+            continue;
+        }
+        if (!intId) {
+            vIds.emplace_back(vertex.vid);
+            continue;
+        }
+        // the int vId is counted by its value in string, and kept in the keys by its bytes
+        auto value = folly::tryTo<int64_t>(vertex.vid);
+        if (value.hasValue()) {
+            auto v = value.value();
+            vIds.emplace_back(reinterpret_cast<const char*>(&v), sizeof(int64_t));
+        }
+    }
+    return vIds;
+}
+
+void HotVertexWarmer::persist(GraphSpaceID spaceId, PartitionID partId, kvstore::KVCallback cb) {
+    std::vector<std::string> vIds;
+    if (traffic_ != nullptr && kvstore_ != nullptr) {
+        auto leader = kvstore_->part(spaceId, partId);
+        if (nebula::ok(leader) && nebula::value(leader)->isLeader()) {
+            vIds = hotVertices(spaceId, partId, traffic_->hotVertices(spaceId));
+        }
+    }
+    if (vIds.empty()) {
+        cb(nebula::cpp2::ErrorCode::SUCCEEDED);
+        return;
+    }
+    std::vector<kvstore::KV> data;
+    data.emplace_back(NebulaKeyUtils::systemHotVerticesKey(partId), encode(vIds));
+    kvstore_->asyncMultiPut(spaceId, partId, std::move(data), std::move(cb));
+}
+
+void HotVertexWarmer::persistAll() {
+    for (auto spaceId : traffic_->spaces()) {
+        auto hot = traffic_->hotVertices(spaceId);
+        std::set<PartitionID> parts;
+        for (const auto& vertex : hot) {
+            parts.emplace(vertex.partId);
+        }
+        for (auto partId : parts) {
+            auto part = kvstore_->part(spaceId, partId);
+            if (!nebula::ok(part) || !nebula::value(part)->isLeader()) {
+                continue;
+            }
+            std::vector<kvstore::KV> data;
+            data.emplace_back(NebulaKeyUtils::systemHotVerticesKey(partId),
+                              encode(hotVertices(spaceId, partId, hot)));
+            kvstore_->asyncMultiPut(spaceId, partId, std::move(data),
+                                    [spaceId, partId] (nebula::cpp2::ErrorCode code) {
+                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    LOG(WARNING) << "Write the hot vertices of space " << spaceId << " part "
+                                 << partId << " failed: "
+                                 << apache::thrift::util::enumNameSafe(code);
+                }
+            });
+        }
+    }
+}
+
+void HotVertexWarmer::warm(GraphSpaceID spaceId, PartitionID partId) {
+    std::string val;
+    auto code = kvstore_->get(spaceId, partId, NebulaKeyUtils::systemHotVerticesKey(partId),
+                              &val, true);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return;
+    }
+    auto vIdLen = schemaMan_->getSpaceVidLen(spaceId);
+    if (!vIdLen.ok()) {
+        return;
+    }
+    size_t keys = 0;
+    auto vIds = decode(val);
+    for (const auto& vId : vIds) {
+        if (vId.size() > static_cast<size_t>(vIdLen.value())) {
+            continue;
+        }
+        for (const auto& prefix : {NebulaKeyUtils::vertexPrefix(vIdLen.value(), partId, vId),
+                                   NebulaKeyUtils::edgePrefix(vIdLen.value(), partId, vId)}) {
+            std::unique_ptr<kvstore::KVIterator> iter;
+            if (kvstore_->prefix(spaceId, partId, prefix, &iter, true) !=
+                nebula::cpp2::ErrorCode::SUCCEEDED) {
+                return;
+            }
+            for (size_t i = 0; iter->valid() && i < kMaxKeysWarmed; iter->next(), i++) {
+                keys++;
+            }
+        }
+    }
+    VLOG(1) << "Warmed " << vIds.size() << " hot vertices, " << keys << " keys of space "
+            << spaceId << " part " << partId;
+}
+
+void HotVertexWarmer::warmAll() {
+    auto* store = dynamic_cast<kvstore::NebulaStore*>(kvstore_);
+    if (store == nullptr) {
+        return;
+    }
+    for (const auto& space : store->allSpaces()) {
+        for (const auto& engine : space.second->engines_) {
+            for (auto partId : engine->allParts()) {
+                if (!running_.load(std::memory_order_acquire)) {
+                    return;
+                }
+                warm(space.first, partId);
+            }
+        }
+    }
+}
+
+void HotVertexWarmer::onCommit(GraphSpaceID spaceId,
+                               PartitionID partId,
+                               const std::vector<std::string>& keys) {
+    if (!running_.load(std::memory_order_acquire)) {
+        return;
+    }
+    auto hotKey = NebulaKeyUtils::systemHotVerticesKey(partId);
+    for (const auto& key : keys) {
+        if (key == hotKey) {
+            worker_->addTask(&HotVertexWarmer::warm, this, spaceId, partId);
+            return;
+        }
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
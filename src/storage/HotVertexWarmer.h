@@ -0,0 +1,100 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_HOTVERTEXWARMER_H_
+#define STORAGE_HOTVERTEXWARMER_H_
+
+#include "common/base/Base.h"
+#include "common/meta/SchemaManager.h"
+#include "common/thread/GenericWorker.h"
+#include "kvstore/CommitObserver.h"
+#include "kvstore/KVStore.h"
+#include "storage/PartTraffic.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+HotVertexWarmer keeps the block cache of the replicas warm for the hot vertices of each part,
+so a new leader, after a leader transfer or a restart, does not read all of them from disk.
+
+The leader writes the hot vertices of the parts it leads estimated by PartTraffic into the system
+key of the part every hot_vertex_persist_interval_secs, and before it transfers the leadership
+away, by a raft log like any write. Every replica is told of the key by onCommit, including the
+target of the transfer before it is elected, and reads the tags and the edges of the vertices on
+the worker, which loads their blocks into the block cache. At startup, the key of each part on
+this host is read and warmed the same way, ahead of the traffic.
+
+The VertexCache is not warmed, since the rows read by a follower might be written again by the
+logs it applies before it leads, which don't evict the cache.
+*/
+class HotVertexWarmer final : public kvstore::CommitObserver {
+public:
+    HotVertexWarmer(meta::SchemaManager* schemaMan, int32_t persistIntervalSecs);
+
+    ~HotVertexWarmer() override;
+
+    // The store written and read, and the traffic estimating the hot vertices, which might be
+    // null if it is disabled, set once they are created
+    void setStore(kvstore::KVStore* kvstore, PartTraffic* traffic) {
+        kvstore_ = kvstore;
+        traffic_ = traffic;
+    }
+
+    // Start the worker, which warms all parts on this host first
+    bool start();
+
+    void stop();
+
+    // Write the hot vertices of the part if this host leads it, cb is called once it is
+    // committed, or at once if there is nothing to write
+    void persist(GraphSpaceID spaceId, PartitionID partId, kvstore::KVCallback cb);
+
+    // Write the hot vertices of all parts this host leads, called every interval
+    void persistAll();
+
+    // Read the tags and the edges of the hot vertices written of the part, on this thread
+    void warm(GraphSpaceID spaceId, PartitionID partId);
+
+    // Warm all parts on this host, on this thread
+    void warmAll();
+
+    void onCommit(GraphSpaceID spaceId,
+                  PartitionID partId,
+                  const std::vector<std::string>& keys) override;
+
+    void onReset(GraphSpaceID, PartitionID) override {}
+
+    // The vertices of the system key, each is a length and the vId
+    static std::string encode(const std::vector<std::string>& vIds);
+
+    static std::vector<std::string> decode(folly::StringPiece val);
+
+private:
+    // The vIds of the part in the keys, of the hot vertices estimated
+    std::vector<std::string> hotVertices(GraphSpaceID spaceId,
+                                         PartitionID partId,
+                                         const std::vector<PartTraffic::HotVertex>& hot);
+
+    // the keys of each prefix of a vertex read at most, which are enough to load the first
+    // blocks of a super vertex
+    static constexpr size_t kMaxKeysWarmed = 1024;
+
+private:
+    meta::SchemaManager*                        schemaMan_;
+    const int32_t                               persistIntervalSecs_;
+    kvstore::KVStore*                           kvstore_{nullptr};
+    PartTraffic*                                traffic_{nullptr};
+    std::unique_ptr<thread::GenericWorker>      worker_;
+    // the commits are told before the worker starts while the wal is replayed, which are
+    // warmed by warmAll instead
+    std::atomic<bool>                           running_{false};
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_HOTVERTEXWARMER_H_
@@ -0,0 +1,70 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_INDEXVALUECACHE_H_
+#define STORAGE_INDEXVALUECACHE_H_
+
+#include "common/base/Base.h"
+#include "storage/VertexCache.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+IndexValueCache keeps the row last written of (vId, tagId) by the leader, so that the next write
+of a hot vertex could compute the index keys to delete without reading the old row.
+
+Unlike the VertexCache, it is populated by the writes after they are committed, and each entry
+is tagged with the raft term of the part it was written in. Once the leader has changed, the term
+is different and the entry is a miss, since the row could be written by another leader since
+then. The cached row is only used to compute the old index keys, it is evicted whenever the
+vertex is written without populating it, the same as the VertexCache.
+*/
+class IndexValueCache final {
+public:
+    using Key = VertexCache::Key;
+
+    explicit IndexValueCache(size_t capacity, int32_t shardsExp = -1)
+        : cache_(capacity, shardsExp) {}
+
+    // Get the row written in the given term
+    StatusOr<std::string> get(const Key& key, TermID term) {
+        auto ret = cache_.get(key);
+        if (!ret.ok()) {
+            return ret;
+        }
+        auto value = std::move(ret).value();
+        TermID written = -1;
+        if (value.size() >= sizeof(TermID)) {
+            memcpy(&written, value.data(), sizeof(TermID));
+        }
+        if (written != term) {
+            cache_.evict(key);
+            return Status::Error("Stale term");
+        }
+        return value.substr(sizeof(TermID));
+    }
+
+    void insert(const Key& key, TermID term, folly::StringPiece row) {
+        std::string value;
+        value.reserve(sizeof(TermID) + row.size());
+        value.append(reinterpret_cast<const char*>(&term), sizeof(TermID));
+        value.append(row.data(), row.size());
+        cache_.insert(key, std::move(value));
+    }
+
+    void evict(const Key& key) {
+        cache_.evict(key);
+    }
+
+private:
+    VertexCache     cache_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_INDEXVALUECACHE_H_
@@ -0,0 +1,98 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_LATENCYTRACE_H_
+#define STORAGE_LATENCYTRACE_H_
+
+#include "common/base/Base.h"
+#include <folly/Random.h>
+#include "storage/StorageFlags.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+LatencyTrace is the time a request spends in each stage, which is only created for the requests
+sampled by latency_trace_sample_rate. The processor adds the stages into the stage histograms
+of its ProcessorCounters when finished. The parts of a request could be processed in parallel,
+so the time of a stage is the sum of all threads.
+
+The stages are recorded by LatencySpan, which does nothing but a null check if the request is
+not sampled. kvstore read covers the leader check and the seek of kvstore, which are in the
+same call.
+*/
+class LatencyTrace final {
+public:
+    enum Stage : size_t {
+        kQueue = 0,
+        kKVRead,
+        kDecode,
+        kFilter,
+        kSerialize,
+        kNumStages,
+    };
+
+    static const char* stageName(size_t stage) {
+        static const char* kNames[] = {"queue", "kvstore_read", "decode", "filter", "serialize"};
+        return kNames[stage];
+    }
+
+    // A trace if the request is sampled, otherwise null
+    static std::unique_ptr<LatencyTrace> sample() {
+        auto rate = FLAGS_latency_trace_sample_rate;
+        if (LIKELY(rate <= 0) || (rate < 1 && folly::Random::randDouble01() >= rate)) {
+            return nullptr;
+        }
+        return std::make_unique<LatencyTrace>();
+    }
+
+    void add(size_t stage, int64_t nanos) {
+        nanos_[stage].fetch_add(nanos, std::memory_order_relaxed);
+    }
+
+    int64_t micros(size_t stage) const {
+        return nanos_[stage].load(std::memory_order_relaxed) / 1000;
+    }
+
+    std::string toString() const {
+        std::string str;
+        for (size_t stage = 0; stage < kNumStages; stage++) {
+            folly::stringAppendf(&str, "%s%s: %ldus", stage == 0 ? "" : ", ",
+                                 stageName(stage), micros(stage));
+        }
+        return str;
+    }
+
+private:
+    std::array<std::atomic<int64_t>, kNumStages>    nanos_{};
+};
+
+// Add the time from construction to destruction into the stage of trace, if it's not null
+class LatencySpan final {
+public:
+    LatencySpan(LatencyTrace* trace, size_t stage) : trace_(trace), stage_(stage) {
+        if (UNLIKELY(trace_ != nullptr)) {
+            start_ = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~LatencySpan() {
+        if (UNLIKELY(trace_ != nullptr)) {
+            auto elapsed = std::chrono::steady_clock::now() - start_;
+            trace_->add(stage_,
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+private:
+    LatencyTrace*                               trace_;
+    size_t                                      stage_;
+    std::chrono::steady_clock::time_point       start_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_LATENCYTRACE_H_
@@ -0,0 +1,80 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/MemoryTracker.h"
+#include "storage/StorageFlags.h"
+
+namespace nebula {
+namespace storage {
+
+MemoryTracker::~MemoryTracker() {
+    auto used = used_.load(std::memory_order_relaxed);
+    if (used > 0 && parent_ != nullptr) {
+        parent_->free(used);
+    }
+}
+
+// static
+std::unique_ptr<MemoryTracker> MemoryTracker::forRequest(GraphSpaceID spaceId) {
+    if (FLAGS_query_max_memory_bytes <= 0 &&
+        FLAGS_space_query_memory_limit_bytes <= 0 &&
+        FLAGS_process_query_memory_limit_bytes <= 0) {
+        return nullptr;
+    }
+    return std::make_unique<MemoryTracker>("request", FLAGS_query_max_memory_bytes,
+                                           space(spaceId));
+}
+
+// static
+MemoryTracker& MemoryTracker::process() {
+    static MemoryTracker tracker("process", FLAGS_process_query_memory_limit_bytes);
+    return tracker;
+}
+
+// static
+MemoryTracker* MemoryTracker::space(GraphSpaceID spaceId) {
+    static std::mutex lock;
+    static std::unordered_map<GraphSpaceID, std::unique_ptr<MemoryTracker>> spaces;
+    std::lock_guard<std::mutex> g(lock);
+    auto& tracker = spaces[spaceId];
+    if (tracker == nullptr) {
+        tracker = std::make_unique<MemoryTracker>(folly::stringPrintf("space_%d", spaceId),
+                                                  FLAGS_space_query_memory_limit_bytes,
+                                                  &process());
+    }
+    return tracker.get();
+}
+
+bool MemoryTracker::alloc(int64_t bytes, const MemoryTracker** exceeded) {
+    for (auto* tracker = this; tracker != nullptr; tracker = tracker->parent_) {
+        auto used = tracker->used_.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (tracker->limit_ > 0 && used > tracker->limit_) {
+            tracker->refused_.fetch_add(bytes, std::memory_order_relaxed);
+            // roll back the ones charged, including this one
+            for (auto* charged = this; charged != tracker->parent_; charged = charged->parent_) {
+                charged->used_.fetch_sub(bytes, std::memory_order_relaxed);
+            }
+            if (exceeded != nullptr) {
+                *exceeded = tracker;
+            }
+            return false;
+        }
+        auto peak = tracker->peak_.load(std::memory_order_relaxed);
+        while (used > peak &&
+               !tracker->peak_.compare_exchange_weak(peak, used, std::memory_order_relaxed)) {
+        }
+    }
+    return true;
+}
+
+void MemoryTracker::free(int64_t bytes) {
+    for (auto* tracker = this; tracker != nullptr; tracker = tracker->parent_) {
+        tracker->used_.fetch_sub(bytes, std::memory_order_relaxed);
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
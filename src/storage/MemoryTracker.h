@@ -0,0 +1,86 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_MEMORYTRACKER_H_
+#define STORAGE_MEMORYTRACKER_H_
+
+#include "common/base/Base.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+MemoryTracker counts the bytes a read request holds in its result, which are charged to the
+request, its space and the process, each of them limited by a flag:
+  query_max_memory_bytes            of a request
+  space_query_memory_limit_bytes    of all the requests of a space
+  process_query_memory_limit_bytes  of all the requests of the process
+A charge is refused if it takes any of them over the limit, then the request stops reading and
+returns what it has collected, instead of the process being killed by OOM. All the bytes of a
+request are released when its tracker is destroyed with the processor.
+
+The bytes are the keys and values read into the result, which is close to the size of the
+DataSet built, not the exact memory allocated.
+*/
+class MemoryTracker final {
+public:
+    // limit not greater than 0 is unlimited
+    MemoryTracker(std::string name, int64_t limit, MemoryTracker* parent = nullptr)
+        : name_(std::move(name))
+        , limit_(limit)
+        , parent_(parent) {}
+
+    ~MemoryTracker();
+
+    // The tracker of a request of the space, nullptr if none of the limits is set
+    static std::unique_ptr<MemoryTracker> forRequest(GraphSpaceID spaceId);
+
+    // The tracker of all the requests of the process
+    static MemoryTracker& process();
+
+    // The tracker of all the requests of the space, never removed once created
+    static MemoryTracker* space(GraphSpaceID spaceId);
+
+    // Charge the bytes to this and all the ancestors. If any of them would go over its limit,
+    // nothing is charged, the one is returned by exceeded and false is returned.
+    bool alloc(int64_t bytes, const MemoryTracker** exceeded = nullptr);
+
+    void free(int64_t bytes);
+
+    const std::string& name() const {
+        return name_;
+    }
+
+    int64_t limit() const {
+        return limit_;
+    }
+
+    int64_t used() const {
+        return used_.load(std::memory_order_relaxed);
+    }
+
+    int64_t peak() const {
+        return peak_.load(std::memory_order_relaxed);
+    }
+
+    // The bytes refused by the limit of this tracker
+    int64_t refused() const {
+        return refused_.load(std::memory_order_relaxed);
+    }
+
+private:
+    const std::string           name_;
+    const int64_t               limit_;
+    MemoryTracker*              parent_;
+    std::atomic<int64_t>        used_{0};
+    std::atomic<int64_t>        peak_{0};
+    std::atomic<int64_t>        refused_{0};
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_MEMORYTRACKER_H_
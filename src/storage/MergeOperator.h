@@ -9,12 +9,158 @@
 
 #include "common/base/Base.h"
 #include <rocksdb/merge_operator.h>
+#include "codec/RowReaderWrapper.h"
+#include "codec/RowWriterV2.h"
+#include "common/meta/SchemaManager.h"
+#include "utils/DefaultValueContext.h"
 
 namespace nebula {
 namespace storage {
 
+/*
+A merge operand adds values to the props of a vertex or edge row, without reading it. The int
+and float props are added by the delta, the string props are appended.
+
+The operand is encoded as:
+    space (int32) | isEdge (char) | tagId or edgeType (int32) | number of props (uint32) |
+    (name length (uint32) | name | value type (char) | value) * number of props
+the value is an int64, a double, or a string of length (uint32) | content.
+*/
+class MergeOperand final {
+public:
+    using Props = std::vector<std::pair<std::string, Value>>;
+
+    static std::string encode(GraphSpaceID space, bool isEdge, int32_t schemaId,
+                              const Props& props) {
+        std::string operand;
+        operand.append(reinterpret_cast<const char*>(&space), sizeof(GraphSpaceID));
+        char edge = isEdge ? 1 : 0;
+        operand.append(&edge, 1);
+        operand.append(reinterpret_cast<const char*>(&schemaId), sizeof(int32_t));
+        uint32_t num = props.size();
+        operand.append(reinterpret_cast<const char*>(&num), sizeof(uint32_t));
+        for (auto& prop : props) {
+            appendStr(&operand, prop.first);
+            auto type = static_cast<char>(prop.second.type());
+            operand.append(&type, 1);
+            switch (prop.second.type()) {
+                case Value::Type::INT: {
+                    auto v = prop.second.getInt();
+                    operand.append(reinterpret_cast<const char*>(&v), sizeof(int64_t));
+                    break;
+                }
+                case Value::Type::FLOAT: {
+                    auto v = prop.second.getFloat();
+                    operand.append(reinterpret_cast<const char*>(&v), sizeof(double));
+                    break;
+                }
+                case Value::Type::STRING:
+                    appendStr(&operand, prop.second.getStr());
+                    break;
+                default:
+                    LOG(FATAL) << "Unsupported operand type " << prop.second.typeName();
+            }
+        }
+        return operand;
+    }
+
+    static bool decode(folly::StringPiece operand, GraphSpaceID* space, bool* isEdge,
+                       int32_t* schemaId, Props* props) {
+        const char* p = operand.begin();
+        const char* end = operand.end();
+        if (!read(&p, end, space) || !read(&p, end, isEdge) || !read(&p, end, schemaId)) {
+            return false;
+        }
+        uint32_t num = 0;
+        if (!read(&p, end, &num)) {
+            return false;
+        }
+        for (uint32_t i = 0; i < num; i++) {
+            std::string name;
+            char type = 0;
+            if (!readStr(&p, end, &name) || !read(&p, end, &type)) {
+                return false;
+            }
+            Value value;
+            switch (static_cast<Value::Type>(type)) {
+                case Value::Type::INT: {
+                    int64_t v = 0;
+                    if (!read(&p, end, &v)) {
+                        return false;
+                    }
+                    value = v;
+                    break;
+                }
+                case Value::Type::FLOAT: {
+                    double v = 0;
+                    if (!read(&p, end, &v)) {
+                        return false;
+                    }
+                    value = v;
+                    break;
+                }
+                case Value::Type::STRING: {
+                    std::string v;
+                    if (!readStr(&p, end, &v)) {
+                        return false;
+                    }
+                    value = std::move(v);
+                    break;
+                }
+                default:
+                    return false;
+            }
+            props->emplace_back(std::move(name), std::move(value));
+        }
+        return true;
+    }
+
+private:
+    static void appendStr(std::string* operand, const std::string& str) {
+        uint32_t len = str.size();
+        operand->append(reinterpret_cast<const char*>(&len), sizeof(uint32_t));
+        operand->append(str);
+    }
+
+    template <typename T>
+    static bool read(const char** p, const char* end, T* v) {
+        if (*p + sizeof(T) > end) {
+            return false;
+        }
+        memcpy(v, *p, sizeof(T));
+        *p += sizeof(T);
+        return true;
+    }
+
+    static bool readStr(const char** p, const char* end, std::string* str) {
+        uint32_t len = 0;
+        if (!read(p, end, &len) || *p + len > end) {
+            return false;
+        }
+        str->assign(*p, len);
+        *p += len;
+        return true;
+    }
+};
+
+/*
+NebulaOperator applies the merge operands of a row when it is read or compacted. The row is
+encoded again by the latest schema. If there is no row, the props not in the operands are
+the default value or null, and the props in the operands are added to the default value.
+
+The merge never fails, since rocksdb reports a failed merge as a corruption on every read of
+the key and stops the compactions of the db. What can't be merged is skipped instead:
+  - an operand which can't be decoded
+  - a prop not in the latest schema, e.g. dropped after the operand is written
+  - a prop whose sum can't be written, e.g. NULL or of another type, which keeps its old value
+If the row still can't be encoded, e.g. the schema is dropped, the existing row is kept, or an
+empty row if there is none, which is left to the compaction filter.
+*/
 class NebulaOperator : public rocksdb::MergeOperator {
 public:
+    explicit NebulaOperator(meta::SchemaManager* schemaMan = nullptr)
+        : schemaMan_(schemaMan) {}
+
     const char* Name() const override {
         return "NebulaMergeOperator";
     }
@@ -22,12 +168,129 @@ public:
 private:
     bool FullMergeV2(const MergeOperationInput& merge_in,
                      MergeOperationOutput* merge_out) const override {
-        UNUSED(merge_in);
-        UNUSED(merge_out);
-        LOG(ERROR) << "NebulaMergeOperator not supported yet";
-        return false;
+        auto keep = [&] () {
+            if (merge_in.existing_value != nullptr) {
+                merge_out->new_value.assign(merge_in.existing_value->data(),
+                                            merge_in.existing_value->size());
+            } else {
+                merge_out->new_value.clear();
+            }
+            return true;
+        };
+        auto keyStr = [&] () {
+            return folly::hexlify(folly::StringPiece(merge_in.key.data(), merge_in.key.size()));
+        };
+        if (schemaMan_ == nullptr) {
+            LOG(ERROR) << "NebulaMergeOperator has no schema, the operands of key " << keyStr()
+                       << " are dropped";
+            return keep();
+        }
+        GraphSpaceID space = 0;
+        bool isEdge = false;
+        int32_t schemaId = 0;
+        bool decoded = false;
+        std::vector<MergeOperand::Props> operands;
+        for (auto& slice : merge_in.operand_list) {
+            GraphSpaceID s = 0;
+            bool e = false;
+            int32_t id = 0;
+            MergeOperand::Props props;
+            if (!MergeOperand::decode(folly::StringPiece(slice.data(), slice.size()),
+                                      &s, &e, &id, &props)) {
+                LOG(ERROR) << "Skip the bad merge operand of key " << keyStr();
+                continue;
+            }
+            if (!decoded) {
+                space = s;
+                isEdge = e;
+                schemaId = id;
+                decoded = true;
+            } else if (s != space || e != isEdge || id != schemaId) {
+                LOG(ERROR) << "Skip the merge operand of another schema of key " << keyStr();
+                continue;
+            }
+            operands.emplace_back(std::move(props));
+        }
+        if (!decoded) {
+            return keep();
+        }
+
+        auto schema = isEdge ? schemaMan_->getEdgeSchema(space, std::abs(schemaId))
+                             : schemaMan_->getTagSchema(space, schemaId);
+        if (!schema) {
+            LOG(ERROR) << "No schema of space " << space << ", id " << schemaId
+                       << ", the operands of key " << keyStr() << " are dropped";
+            return keep();
+        }
+        // the values of the existing row, kept if the merged one can't be written
+        std::unordered_map<std::string, Value> old;
+        if (merge_in.existing_value != nullptr) {
+            folly::StringPiece row(merge_in.existing_value->data(),
+                                   merge_in.existing_value->size());
+            auto reader = isEdge ? RowReaderWrapper::getEdgePropReader(
+                                       schemaMan_, space, std::abs(schemaId), row)
+                                 : RowReaderWrapper::getTagPropReader(
+                                       schemaMan_, space, schemaId, row);
+            if (!reader) {
+                LOG(ERROR) << "Bad row to merge of space " << space << ", id " << schemaId
+                           << ", the operands of key " << keyStr() << " are dropped";
+                return keep();
+            }
+            for (size_t i = 0; i < schema->getNumFields(); i++) {
+                std::string name = schema->getFieldName(i);
+                auto value = reader->getValueByName(name);
+                // the prop added after the row is written is the default value
+                if (value.isNull() && value.getNull() == NullType::UNKNOWN_PROP) {
+                    continue;
+                }
+                old[name] = std::move(value);
+            }
+        }
+
+        auto values = old;
+        for (auto& props : operands) {
+            for (auto& prop : props) {
+                auto it = values.find(prop.first);
+                if (it == values.end()) {
+                    auto field = schema->field(prop.first);
+                    if (field == nullptr) {
+                        VLOG(1) << "Skip the prop " << prop.first << " not in the schema";
+                        continue;
+                    }
+                    it = values.emplace(prop.first, defaultValue(field)).first;
+                }
+                auto sum = it->second + prop.second;
+                if (sum.type() != it->second.type() && !it->second.isNull()) {
+                    VLOG(1) << "Skip the prop " << prop.first << " merged to " << sum;
+                    continue;
+                }
+                it->second = std::move(sum);
+            }
+        }
+
+        RowWriterV2 writer(schema.get());
+        for (auto& value : values) {
+            if (writer.setValue(value.first, value.second) == WriteResult::SUCCEEDED) {
+                continue;
+            }
+            auto it = old.find(value.first);
+            LOG(WARNING) << "Fail to merge prop " << value.first << ", value " << value.second
+                         << ", keep the old value";
+            if (it != old.end()) {
+                writer.setValue(value.first, it->second);
+            }
+        }
+        if (writer.finish() != WriteResult::SUCCEEDED) {
+            LOG(ERROR) << "Fail to encode the row merged of space " << space
+                       << ", id " << schemaId << ", the operands of key " << keyStr()
+                       << " are dropped";
+            return keep();
+        }
+        merge_out->new_value = writer.moveEncodedStr();
+        return true;
     }
 
+    // The operands are only resolved against the row by FullMergeV2
     bool PartialMerge(const rocksdb::Slice& key, const rocksdb::Slice& left_operand,
                       const rocksdb::Slice& right_operand, std::string* new_value,
                       rocksdb::Logger* logger) const override {
@@ -36,13 +299,22 @@ private:
         UNUSED(right_operand);
         UNUSED(new_value);
         UNUSED(logger);
-        LOG(ERROR) << "NebulaMergeOperator not supported yet";
         return false;
     }
+
+    static Value defaultValue(const meta::SchemaProviderIf::Field* field) {
+        if (field->hasDefault()) {
+            DefaultValueContext expCtx;
+            auto expr = field->defaultValue()->clone();
+            return Expression::eval(expr, expCtx);
+        }
+        return Value::kNullValue;
+    }
+
+    meta::SchemaManager* schemaMan_{nullptr};
 };
 
 
 }  // namespace storage
 }  // namespace nebula
 #endif  // KVSTORE_MERGEOPERATOR_H_
-
@@ -0,0 +1,71 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/PartAffinityExecutor.h"
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <pthread.h>
+
+namespace nebula {
+namespace storage {
+
+namespace {
+
+// Start the threads of the factory pinned to the core
+class PinnedThreadFactory final : public folly::ThreadFactory {
+public:
+    PinnedThreadFactory(const std::string& name, int32_t core)
+        : factory_(name)
+        , core_(core) {}
+
+    std::thread newThread(folly::Func&& func) override {
+        auto core = core_;
+        return factory_.newThread([core, func = std::move(func)] () mutable {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(core, &cpus);
+            auto ret = pthread_setaffinity_np(pthread_self(), sizeof(cpu_set_t), &cpus);
+            LOG_IF(WARNING, ret != 0) << "Pin the thread to core " << core << " failed: " << ret;
+            func();
+        });
+    }
+
+private:
+    folly::NamedThreadFactory   factory_;
+    int32_t                     core_;
+};
+
+}  // namespace
+
+PartAffinityExecutor::PartAffinityExecutor(size_t shards, bool pinCores) {
+    CHECK_GT(shards, 0);
+    auto cores = std::max<int32_t>(std::thread::hardware_concurrency(), 1);
+    shards_.reserve(shards);
+    for (size_t i = 0; i < shards; i++) {
+        std::shared_ptr<folly::ThreadFactory> factory;
+        if (pinCores) {
+            factory = std::make_shared<PinnedThreadFactory>("part-reader", i % cores);
+        } else {
+            factory = std::make_shared<folly::NamedThreadFactory>("part-reader");
+        }
+        shards_.emplace_back(
+            std::make_unique<folly::CPUThreadPoolExecutor>(1, std::move(factory)));
+    }
+    LOG(INFO) << "Run the read tasks of the parts on " << shards << " threads"
+              << (pinCores ? " pinned to cores" : "");
+}
+
+PartAffinityExecutor::~PartAffinityExecutor() {
+    stop();
+}
+
+void PartAffinityExecutor::stop() {
+    for (auto& shard : shards_) {
+        shard->join();
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,51 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_PARTAFFINITYEXECUTOR_H_
+#define STORAGE_PARTAFFINITYEXECUTOR_H_
+
+#include "common/base/Base.h"
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/hash/Hash.h>
+
+namespace nebula {
+namespace storage {
+
+/*
+PartAffinityExecutor runs the read tasks of each part on the same thread, so the part, its
+memtables and the blocks it reads stay in the cache of the core, instead of bouncing between
+all the threads of the reader pool. There is one single thread executor of each shard, a part
+is mapped to a shard by its space and part id. If pinCores is true, the thread of shard i is
+pinned to core i modulo the cores, adjacent cores are usually on the same NUMA node.
+
+The tasks of a part queue behind each other, so a hot part is served by one thread only.
+*/
+class PartAffinityExecutor final {
+public:
+    PartAffinityExecutor(size_t shards, bool pinCores);
+
+    ~PartAffinityExecutor();
+
+    folly::Executor* executorOf(GraphSpaceID spaceId, PartitionID partId) const {
+        auto hash = folly::hash::hash_combine(spaceId, partId);
+        return shards_[hash % shards_.size()].get();
+    }
+
+    size_t shards() const {
+        return shards_.size();
+    }
+
+    // Stop taking tasks and wait for the tasks queued
+    void stop();
+
+private:
+    std::vector<std::unique_ptr<folly::CPUThreadPoolExecutor>>  shards_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_PARTAFFINITYEXECUTOR_H_
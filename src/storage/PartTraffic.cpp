@@ -0,0 +1,203 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/PartTraffic.h"
+#include "common/time/WallClock.h"
+#include <folly/hash/SpookyHashV2.h>
+
+namespace nebula {
+namespace storage {
+
+PartTraffic::PartTraffic(int32_t windowSecs, int32_t topK, Reporter reporter)
+    : windowSecs_(windowSecs)
+    , topK_(topK > 0 ? topK : 0)
+    , reporter_(std::move(reporter))
+    , windowStart_(time::WallClock::fastNowInMilliSec()) {}
+
+PartTraffic::~PartTraffic() {
+    stop();
+}
+
+bool PartTraffic::start() {
+    worker_ = std::make_unique<thread::GenericWorker>();
+    if (!worker_->start("part-traffic")) {
+        return false;
+    }
+    worker_->addRepeatTask(windowSecs_ * 1000, &PartTraffic::rotate, this);
+    return true;
+}
+
+void PartTraffic::stop() {
+    if (worker_ != nullptr) {
+        worker_->stop();
+        worker_->wait();
+        worker_.reset();
+    }
+}
+
+PartTraffic::Counters* PartTraffic::counters(GraphSpaceID spaceId, PartitionID partId) {
+    auto key = std::make_pair(spaceId, partId);
+    auto it = counters_.find(key);
+    if (it != counters_.cend()) {
+        return it->second.get();
+    }
+    return counters_.insert(key, std::make_shared<Counters>()).first->second.get();
+}
+
+PartTraffic::HotVertices* PartTraffic::hotVerticesOf(GraphSpaceID spaceId) {
+    auto it = hotVertices_.find(spaceId);
+    if (it != hotVertices_.cend()) {
+        return it->second.get();
+    }
+    return hotVertices_.insert(spaceId, std::make_shared<HotVertices>()).first->second.get();
+}
+
+void PartTraffic::record(GraphSpaceID spaceId,
+                         PartitionID partId,
+                         Kind kind,
+                         int64_t requests,
+                         int64_t bytes) {
+    auto* c = counters(spaceId, partId);
+    if (kind == Kind::READ) {
+        c->reads.fetch_add(requests, std::memory_order_relaxed);
+    } else {
+        c->writes.fetch_add(requests, std::memory_order_relaxed);
+        c->writeBytes.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+void PartTraffic::recordVertex(GraphSpaceID spaceId, PartitionID partId, folly::StringPiece vid) {
+    if (topK_ == 0) {
+        return;
+    }
+    auto* hot = hotVerticesOf(spaceId);
+    std::string key;
+    key.reserve(sizeof(PartitionID) + vid.size());
+    key.append(reinterpret_cast<const char*>(&partId), sizeof(PartitionID))
+       .append(vid.data(), vid.size());
+    // the hash of each row is derived from two hashes
+    auto hash = folly::hash::SpookyHashV2::Hash64(key.data(), key.size(), 0);
+    uint32_t h1 = hash;
+    uint32_t h2 = hash >> 32;
+    int64_t estimate = std::numeric_limits<int64_t>::max();
+    for (size_t row = 0; row < kSketchDepth; row++) {
+        auto col = (h1 + row * h2) % kSketchWidth;
+        auto count = hot->sketch[row * kSketchWidth + col].fetch_add(
+            1, std::memory_order_relaxed) + 1;
+        estimate = std::min<int64_t>(estimate, count);
+    }
+    if (estimate <= hot->minTop.load(std::memory_order_relaxed)) {
+        return;
+    }
+    std::lock_guard<std::mutex> g(hot->lock);
+    hot->top[key] = estimate;
+    if (hot->top.size() > topK_) {
+        auto least = std::min_element(hot->top.begin(), hot->top.end(),
+                                      [] (const auto& a, const auto& b) {
+                                          return a.second < b.second;
+                                      });
+        hot->top.erase(least);
+    }
+    if (hot->top.size() == topK_) {
+        auto least = std::min_element(hot->top.begin(), hot->top.end(),
+                                      [] (const auto& a, const auto& b) {
+                                          return a.second < b.second;
+                                      });
+        hot->minTop.store(least->second, std::memory_order_relaxed);
+    }
+}
+
+void PartTraffic::rotate() {
+    auto now = time::WallClock::fastNowInMilliSec();
+    double secs = std::max<int64_t>(now - windowStart_, 1) / 1000.0;
+    windowStart_ = now;
+
+    std::unordered_map<GraphSpaceID, std::unordered_map<PartitionID, Load>> loads;
+    for (auto& entry : counters_) {
+        auto& c = *entry.second;
+        auto reads = c.reads.exchange(0, std::memory_order_relaxed);
+        auto writes = c.writes.exchange(0, std::memory_order_relaxed);
+        auto writeBytes = c.writeBytes.exchange(0, std::memory_order_relaxed);
+        if (reads == 0 && writes == 0) {
+            continue;
+        }
+        Load load;
+        load.readQps = reads / secs;
+        load.writeQps = writes / secs;
+        load.writeBytesPerSec = writeBytes / secs;
+        loads[entry.first.first][entry.first.second] = load;
+    }
+
+    std::unordered_map<GraphSpaceID, std::vector<HotVertex>> hotVertices;
+    for (auto& entry : hotVertices_) {
+        auto& hot = *entry.second;
+        std::unordered_map<std::string, int64_t> top;
+        {
+            std::lock_guard<std::mutex> g(hot.lock);
+            top.swap(hot.top);
+            for (auto& count : hot.sketch) {
+                count.store(0, std::memory_order_relaxed);
+            }
+            hot.minTop.store(0, std::memory_order_relaxed);
+        }
+        auto& vertices = hotVertices[entry.first];
+        for (auto& item : top) {
+            HotVertex vertex;
+            memcpy(&vertex.partId, item.first.data(), sizeof(PartitionID));
+            vertex.vid = item.first.substr(sizeof(PartitionID));
+            vertex.count = item.second;
+            vertices.emplace_back(std::move(vertex));
+        }
+        std::sort(vertices.begin(), vertices.end(), [] (const auto& a, const auto& b) {
+            return a.count > b.count;
+        });
+    }
+
+    if (reporter_ != nullptr) {
+        for (const auto& space : loads) {
+            for (const auto& part : space.second) {
+                reporter_(space.first, part.first, part.second);
+            }
+        }
+    }
+    std::lock_guard<std::mutex> g(lastLock_);
+    lastLoads_ = std::move(loads);
+    lastHotVertices_ = std::move(hotVertices);
+}
+
+std::unordered_map<PartitionID, PartTraffic::Load>
+PartTraffic::loads(GraphSpaceID spaceId) const {
+    std::lock_guard<std::mutex> g(lastLock_);
+    auto it = lastLoads_.find(spaceId);
+    if (it == lastLoads_.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+std::vector<PartTraffic::HotVertex> PartTraffic::hotVertices(GraphSpaceID spaceId) const {
+    std::lock_guard<std::mutex> g(lastLock_);
+    auto it = lastHotVertices_.find(spaceId);
+    if (it == lastHotVertices_.end()) {
+        return {};
+    }
+    return it->second;
+}
+
+std::vector<GraphSpaceID> PartTraffic::spaces() const {
+    std::lock_guard<std::mutex> g(lastLock_);
+    std::set<GraphSpaceID> spaces;
+    for (const auto& space : lastLoads_) {
+        spaces.emplace(space.first);
+    }
+    for (const auto& space : lastHotVertices_) {
+        spaces.emplace(space.first);
+    }
+    return std::vector<GraphSpaceID>(spaces.begin(), spaces.end());
+}
+
+}  // namespace storage
+}  // namespace nebula
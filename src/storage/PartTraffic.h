@@ -0,0 +1,122 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_PARTTRAFFIC_H_
+#define STORAGE_PARTTRAFFIC_H_
+
+#include "common/base/Base.h"
+#include "common/thread/GenericWorker.h"
+#include <folly/concurrency/ConcurrentHashMap.h>
+
+namespace nebula {
+namespace storage {
+
+/*
+PartTraffic counts the read and write requests and the bytes written of each part, and
+estimates the hottest vertices of each space, which is recorded by GraphStorageServiceHandler
+for each request. The counters are rotated every window, the rates and the hot vertices of the
+last window are served by /rocksdb_stats and reported to the balance by load.
+
+The hot vertices are estimated by a count-min sketch of each space, with the top k vertices by
+the estimate kept aside. The estimate is never below the real count, and above it by at most
+e / width of all the vertices recorded in the window with the probability 1 - e^-depth.
+*/
+class PartTraffic final {
+public:
+    enum class Kind {
+        READ,
+        WRITE,
+    };
+
+    struct Load {
+        double      readQps{0};
+        double      writeQps{0};
+        double      writeBytesPerSec{0};
+    };
+
+    struct HotVertex {
+        PartitionID     partId;
+        std::string     vid;
+        int64_t         count;
+    };
+
+    // reporter is called with the load of each part with traffic when a window is rotated
+    using Reporter = std::function<void(GraphSpaceID, PartitionID, const Load&)>;
+
+    PartTraffic(int32_t windowSecs, int32_t topK, Reporter reporter = nullptr);
+
+    ~PartTraffic();
+
+    bool start();
+
+    void stop();
+
+    void record(GraphSpaceID spaceId,
+                PartitionID partId,
+                Kind kind,
+                int64_t requests,
+                int64_t bytes);
+
+    void recordVertex(GraphSpaceID spaceId, PartitionID partId, folly::StringPiece vid);
+
+    // The spaces with traffic in the last window
+    std::vector<GraphSpaceID> spaces() const;
+
+    // The load of each part with traffic of the space in the last window
+    std::unordered_map<PartitionID, Load> loads(GraphSpaceID spaceId) const;
+
+    // The hot vertices of the space in the last window, the hottest first
+    std::vector<HotVertex> hotVertices(GraphSpaceID spaceId) const;
+
+    // Called every window by the worker started, public for the tests
+    void rotate();
+
+private:
+    static constexpr size_t kSketchDepth = 4;
+    static constexpr size_t kSketchWidth = 4096;
+
+    struct Counters {
+        std::atomic<int64_t>    reads{0};
+        std::atomic<int64_t>    writes{0};
+        std::atomic<int64_t>    writeBytes{0};
+    };
+
+    struct HotVertices {
+        std::array<std::atomic<uint32_t>, kSketchDepth * kSketchWidth> sketch{};
+        // the least count in top, a vertex below it is not hot unless the top is not full
+        std::atomic<int64_t>                                    minTop{0};
+        std::mutex                                              lock;
+        // part + vid => count
+        std::unordered_map<std::string, int64_t>                top;
+    };
+
+    using PartKey = std::pair<GraphSpaceID, PartitionID>;
+
+    Counters* counters(GraphSpaceID spaceId, PartitionID partId);
+
+    HotVertices* hotVerticesOf(GraphSpaceID spaceId);
+
+private:
+    const int32_t                                               windowSecs_;
+    const size_t                                                topK_;
+    Reporter                                                    reporter_;
+    std::unique_ptr<thread::GenericWorker>                      worker_;
+    int64_t                                                     windowStart_;
+
+    // the counters and the hot vertices are never removed once created
+    folly::ConcurrentHashMap<PartKey, std::shared_ptr<Counters>, folly::hasher<PartKey>>
+                                                                counters_;
+    folly::ConcurrentHashMap<GraphSpaceID, std::shared_ptr<HotVertices>> hotVertices_;
+
+    mutable std::mutex                                          lastLock_;
+    std::unordered_map<GraphSpaceID, std::unordered_map<PartitionID, Load>> lastLoads_;
+    std::unordered_map<GraphSpaceID, std::vector<HotVertex>>    lastHotVertices_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_PARTTRAFFIC_H_
@@ -0,0 +1,61 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_PRIORITYEXECUTOR_H_
+#define STORAGE_PRIORITYEXECUTOR_H_
+
+#include "common/base/Base.h"
+#include <folly/Executor.h>
+
+namespace nebula {
+namespace storage {
+
+/**
+ * PriorityExecutor is a view of a shared thread pool, every task added through it will be
+ * scheduled with the given priority. It is used to let latency sensitive requests (e.g. GetProp)
+ * jump ahead of long scans in the same reader pool, while all threads still take tasks from
+ * the pool's queue, so the sub tasks of a skewed request can be picked up by any idle thread.
+ *
+ * If the pool doesn't support priority, the tasks is added to it as is.
+ * */
+class PriorityExecutor final : public folly::Executor {
+public:
+    PriorityExecutor(folly::Executor* pool, int8_t priority, bool supportPriority)
+        : pool_(pool)
+        , priority_(priority)
+        , supportPriority_(supportPriority) {
+        CHECK_NOTNULL(pool_);
+    }
+
+    void add(folly::Func func) override {
+        if (supportPriority_) {
+            pool_->addWithPriority(std::move(func), priority_);
+        } else {
+            pool_->add(std::move(func));
+        }
+    }
+
+    void addWithPriority(folly::Func func, int8_t priority) override {
+        if (supportPriority_) {
+            pool_->addWithPriority(std::move(func), priority);
+        } else {
+            pool_->add(std::move(func));
+        }
+    }
+
+    uint8_t getNumPriorities() const override {
+        return pool_->getNumPriorities();
+    }
+
+private:
+    folly::Executor*        pool_;
+    int8_t                  priority_;
+    bool                    supportPriority_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_PRIORITYEXECUTOR_H_
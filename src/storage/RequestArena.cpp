@@ -0,0 +1,42 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/RequestArena.h"
+
+namespace nebula {
+namespace storage {
+
+char* RequestArena::allocate(size_t size) {
+    auto aligned = (size + kAlign - 1) & ~(kAlign - 1);
+    used_ += aligned;
+    // try the blocks kept by last reset first
+    while (current_ < blocks_.size()) {
+        auto& block = blocks_[current_];
+        if (offset_ + aligned <= block.size_) {
+            auto* buf = block.data_.get() + offset_;
+            offset_ += aligned;
+            return buf;
+        }
+        current_++;
+        offset_ = 0;
+    }
+    // the large buffer takes a block of its own
+    auto blockSize = std::max(blockSize_, aligned);
+    blocks_.emplace_back(Block{std::unique_ptr<char[]>(new char[blockSize]), blockSize});
+    capacity_ += blockSize;
+    current_ = blocks_.size() - 1;
+    offset_ = aligned;
+    return blocks_.back().data_.get();
+}
+
+void RequestArena::reset() {
+    current_ = 0;
+    offset_ = 0;
+    used_ = 0;
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,80 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_REQUESTARENA_H_
+#define STORAGE_REQUESTARENA_H_
+
+#include "common/base/Base.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+RequestArena is a bump allocator for the temporary buffers of a request, such as the key and
+value copied out of the kv iterator. Memory is allocated from blocks, and nothing is freed
+until the arena is destroyed, so it is released in one shot with the RunTimeContext when the
+processor finishes.
+
+`reset` rewinds the arena and keeps the blocks, so the one reset for each vertex (or each page)
+reuses the same memory without any malloc. A StringPiece returned before `reset` is invalid
+after it. It is not thread safe, each RunTimeContext owns one.
+*/
+class RequestArena final {
+public:
+    static constexpr size_t kDefaultBlockSize = 8 * 1024;
+
+    explicit RequestArena(size_t blockSize = kDefaultBlockSize) : blockSize_(blockSize) {}
+
+    RequestArena(RequestArena&&) = default;
+    RequestArena& operator=(RequestArena&&) = default;
+
+    // Return a buffer of `size` bytes aligned to 8 bytes
+    char* allocate(size_t size);
+
+    // Copy the string into arena, the result is valid until `reset` or destruction
+    folly::StringPiece copy(folly::StringPiece str) {
+        if (str.empty()) {
+            return folly::StringPiece();
+        }
+        auto* buf = allocate(str.size());
+        memcpy(buf, str.data(), str.size());
+        return folly::StringPiece(buf, str.size());
+    }
+
+    // Rewind to the first block, all memory allocated before is reused
+    void reset();
+
+    // bytes allocated since last reset
+    size_t used() const {
+        return used_;
+    }
+
+    // bytes of all blocks held
+    size_t capacity() const {
+        return capacity_;
+    }
+
+private:
+    struct Block {
+        std::unique_ptr<char[]>     data_;
+        size_t                      size_;
+    };
+
+    static constexpr size_t kAlign = 8;
+
+    size_t                  blockSize_;
+    std::vector<Block>      blocks_;
+    // the block in use and the offset of next allocation in it
+    size_t                  current_ = 0;
+    size_t                  offset_ = 0;
+    size_t                  used_ = 0;
+    size_t                  capacity_ = 0;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_REQUESTARENA_H_
@@ -0,0 +1,192 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/RequestProfile.h"
+#include <folly/Random.h>
+#include <folly/TokenBucket.h>
+#include <thrift/lib/cpp/util/EnumUtils.h>
+#include <rocksdb/iostats_context.h>
+#include <rocksdb/perf_context.h>
+#include <rocksdb/perf_level.h>
+
+namespace nebula {
+namespace storage {
+
+void RequestProfile::PerfCounters::add(const PerfCounters& other) {
+    blockReads += other.blockReads;
+    blockReadBytes += other.blockReadBytes;
+    blockCacheHits += other.blockCacheHits;
+    bloomUseful += other.bloomUseful;
+    bloomChecked += other.bloomChecked;
+    keysSkipped += other.keysSkipped;
+    deletesSkipped += other.deletesSkipped;
+    memtableSeeks += other.memtableSeeks;
+    childSeeks += other.childSeeks;
+    bytesRead += other.bytesRead;
+}
+
+// static
+std::shared_ptr<RequestProfile> RequestProfile::create(const char* name, GraphSpaceID spaceId) {
+    auto rate = FLAGS_rocksdb_perf_context_sample_rate;
+    bool sampled = rate > 0 && folly::Random::randDouble01() < rate;
+    if (LIKELY(FLAGS_slow_request_threshold_ms <= 0 && !sampled)) {
+        return nullptr;
+    }
+    return std::make_shared<RequestProfile>(name, spaceId, sampled);
+}
+
+void RequestProfile::addNode(size_t index, const std::string& node, int64_t calls, int64_t nanos) {
+    std::lock_guard<std::mutex> g(lock_);
+    auto& stats = nodes_[index];
+    if (stats.node.empty()) {
+        stats.node = node;
+    }
+    stats.calls += calls;
+    stats.nanos += nanos;
+}
+
+void RequestProfile::addPart(PartitionID partId, int64_t nanos, const PerfCounters& perf) {
+    std::lock_guard<std::mutex> g(lock_);
+    parts_.emplace_back(partId, nanos);
+    perf_.add(perf);
+}
+
+void RequestProfile::finish(int64_t latencyUs,
+                            const std::vector<cpp2::PartitionResult>& failedParts) {
+    if (sampled_) {
+        PerfCounters perf;
+        {
+            std::lock_guard<std::mutex> g(lock_);
+            perf = perf_;
+        }
+        RequestPerfStats::instance().add(name_, spaceId_, perf);
+    }
+    if (FLAGS_slow_request_threshold_ms <= 0 ||
+        latencyUs < FLAGS_slow_request_threshold_ms * 1000) {
+        return;
+    }
+    static folly::DynamicTokenBucket bucket;
+    auto rate = FLAGS_slow_request_log_per_sec;
+    if (rate <= 0 || !bucket.consume(1, rate, std::max(rate, 1.0))) {
+        return;
+    }
+    LOG(WARNING) << toString(latencyUs, failedParts);
+}
+
+std::string RequestProfile::toString(int64_t latencyUs,
+                                     const std::vector<cpp2::PartitionResult>& failedParts) const {
+    std::lock_guard<std::mutex> g(lock_);
+    std::string str = folly::stringPrintf("Slow %s of space %d took %ldus, returned %lu rows",
+                                          name_, spaceId_, latencyUs, rows_);
+    if (!failedParts.empty()) {
+        str.append(", failed parts [");
+        for (size_t i = 0; i < failedParts.size(); i++) {
+            folly::stringAppendf(&str, "%s%d: %s",
+                                 i == 0 ? "" : ", ",
+                                 failedParts[i].get_part_id(),
+                                 apache::thrift::util::enumNameSafe(
+                                     failedParts[i].get_code()).c_str());
+        }
+        str.append("]");
+    }
+    // the slowest parts first
+    auto parts = parts_;
+    std::sort(parts.begin(), parts.end(), [] (const auto& a, const auto& b) {
+        return a.second > b.second;
+    });
+    str.append(", parts [");
+    for (size_t i = 0; i < parts.size(); i++) {
+        folly::stringAppendf(&str, "%s%d: %ldus",
+                             i == 0 ? "" : ", ", parts[i].first, parts[i].second / 1000);
+    }
+    // the time of each node includes its dependencies
+    str.append("], plan [");
+    bool first = true;
+    for (const auto& node : nodes_) {
+        folly::stringAppendf(&str, "%s#%lu %s: %ld calls %ldus",
+                             first ? "" : ", ",
+                             node.first,
+                             node.second.node.c_str(),
+                             node.second.calls,
+                             node.second.nanos / 1000);
+        first = false;
+    }
+    folly::stringAppendf(&str,
+                         "], rocksdb [block reads %lu (%lu bytes), block cache hits %lu, "
+                         "bloom useful %lu of %lu, keys skipped %lu, deletes skipped %lu, "
+                         "memtable seeks %lu, child seeks %lu, bytes read %lu]",
+                         perf_.blockReads,
+                         perf_.blockReadBytes,
+                         perf_.blockCacheHits,
+                         perf_.bloomUseful,
+                         perf_.bloomChecked,
+                         perf_.keysSkipped,
+                         perf_.deletesSkipped,
+                         perf_.memtableSeeks,
+                         perf_.childSeeks,
+                         perf_.bytesRead);
+    return str;
+}
+
+// static
+RequestPerfStats& RequestPerfStats::instance() {
+    static RequestPerfStats stats;
+    return stats;
+}
+
+void RequestPerfStats::add(const std::string& name,
+                           GraphSpaceID spaceId,
+                           const RequestProfile::PerfCounters& perf) {
+    std::lock_guard<std::mutex> g(lock_);
+    auto& counters = counters_[std::make_pair(name, spaceId)];
+    counters.requests++;
+    counters.perf.add(perf);
+}
+
+std::map<RequestPerfStats::Key, RequestPerfStats::Counters> RequestPerfStats::snapshot() const {
+    std::lock_guard<std::mutex> g(lock_);
+    return counters_;
+}
+
+ProfileSpan::ProfileSpan(std::shared_ptr<RequestProfile> profile, PartitionID partId)
+    : profile_(std::move(profile))
+    , partId_(partId) {
+    if (LIKELY(profile_ == nullptr)) {
+        return;
+    }
+    perfLevel_ = static_cast<int>(rocksdb::GetPerfLevel());
+    rocksdb::SetPerfLevel(rocksdb::PerfLevel::kEnableCount);
+    rocksdb::get_perf_context()->Reset();
+    rocksdb::get_iostats_context()->Reset();
+    start_ = std::chrono::steady_clock::now();
+}
+
+void ProfileSpan::finish() {
+    if (LIKELY(profile_ == nullptr)) {
+        return;
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start_;
+    auto* ctx = rocksdb::get_perf_context();
+    RequestProfile::PerfCounters perf;
+    perf.blockReads = ctx->block_read_count;
+    perf.blockReadBytes = ctx->block_read_byte;
+    perf.blockCacheHits = ctx->block_cache_hit_count;
+    perf.bloomUseful = ctx->bloom_sst_miss_count;
+    perf.bloomChecked = ctx->bloom_sst_hit_count + ctx->bloom_sst_miss_count;
+    perf.keysSkipped = ctx->internal_key_skipped_count;
+    perf.deletesSkipped = ctx->internal_delete_skipped_count;
+    perf.memtableSeeks = ctx->seek_on_memtable_count;
+    perf.childSeeks = ctx->seek_child_seek_count;
+    perf.bytesRead = rocksdb::get_iostats_context()->bytes_read;
+    rocksdb::SetPerfLevel(static_cast<rocksdb::PerfLevel>(perfLevel_));
+    profile_->addPart(partId_,
+                      std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count(),
+                      perf);
+    profile_.reset();
+}
+
+}  // namespace storage
+}  // namespace nebula
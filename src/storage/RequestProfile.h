@@ -0,0 +1,145 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_REQUESTPROFILE_H_
+#define STORAGE_REQUESTPROFILE_H_
+
+#include "common/base/Base.h"
+#include "common/interface/gen-cpp2/storage_types.h"
+#include "storage/StorageFlags.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+RequestProfile is what a read request did, which is logged if the request takes longer than
+slow_request_threshold_ms, at most slow_request_log_per_sec of them are logged. It is only
+created when the threshold is set, since the profile costs a clock read around each node
+executed:
+  - the times each node of the StoragePlan is executed, and the time spent in it including
+    its dependencies, merged when the plan is destroyed
+  - the time and the rocksdb perf context of each part, counted by ProfileSpan on the thread
+    processing the part
+  - the rows returned
+A request is also profiled if it is sampled by rocksdb_perf_context_sample_rate, the perf context
+of which is summed up into RequestPerfStats by the request type and space when it finishes.
+*/
+class RequestProfile final {
+public:
+    // The rocksdb perf context counted of the parts
+    struct PerfCounters {
+        uint64_t    blockReads{0};
+        uint64_t    blockReadBytes{0};
+        uint64_t    blockCacheHits{0};
+        uint64_t    bloomUseful{0};
+        uint64_t    bloomChecked{0};
+        uint64_t    keysSkipped{0};
+        uint64_t    deletesSkipped{0};
+        uint64_t    memtableSeeks{0};
+        uint64_t    childSeeks{0};
+        // of the io stats context, the bytes read from the files
+        uint64_t    bytesRead{0};
+
+        void add(const PerfCounters& other);
+    };
+
+    // A profile if slow_request_threshold_ms is set or the request is sampled, otherwise null.
+    // It is shared by the plans and the spans, which could outlive the processor finished on
+    // an error.
+    static std::shared_ptr<RequestProfile> create(const char* name, GraphSpaceID spaceId);
+
+    RequestProfile(const char* name, GraphSpaceID spaceId, bool sampled = false)
+        : name_(name)
+        , spaceId_(spaceId)
+        , sampled_(sampled) {}
+
+    void addNode(size_t index, const std::string& node, int64_t calls, int64_t nanos);
+
+    void addPart(PartitionID partId, int64_t nanos, const PerfCounters& perf);
+
+    void setRows(size_t rows) {
+        rows_ = rows;
+    }
+
+    // Add the perf context into RequestPerfStats if sampled, and log the profile if the
+    // request is slow and the rate allows
+    void finish(int64_t latencyUs, const std::vector<cpp2::PartitionResult>& failedParts);
+
+    std::string toString(int64_t latencyUs,
+                         const std::vector<cpp2::PartitionResult>& failedParts) const;
+
+private:
+    struct NodeStats {
+        std::string     node;
+        int64_t         calls{0};
+        int64_t         nanos{0};
+    };
+
+    const char*                                 name_;
+    const GraphSpaceID                          spaceId_;
+    const bool                                  sampled_;
+    mutable std::mutex                          lock_;
+    // the nodes by their index in the plan, the plans of all parts have the same nodes
+    std::map<size_t, NodeStats>                 nodes_;
+    std::vector<std::pair<PartitionID, int64_t>> parts_;
+    PerfCounters                                perf_;
+    size_t                                      rows_{0};
+};
+
+/*
+RequestPerfStats sums up the rocksdb perf context of the requests sampled by
+rocksdb_perf_context_sample_rate, by the request type and space, which is served by
+StorageHttpStatsHandler. Dividing the counters by the requests tells what a request of the type
+costs on average, e.g. a scan skipping many deletes is slowed down by the tombstones.
+*/
+class RequestPerfStats final {
+public:
+    struct Counters {
+        int64_t                         requests{0};
+        RequestProfile::PerfCounters    perf;
+    };
+
+    // request type, space
+    using Key = std::pair<std::string, GraphSpaceID>;
+
+    static RequestPerfStats& instance();
+
+    void add(const std::string& name, GraphSpaceID spaceId,
+             const RequestProfile::PerfCounters& perf);
+
+    std::map<Key, Counters> snapshot() const;
+
+private:
+    RequestPerfStats() = default;
+
+private:
+    mutable std::mutex          lock_;
+    std::map<Key, Counters>     counters_;
+};
+
+// Count the time and the rocksdb perf context of a part on this thread, if profile is not null
+class ProfileSpan final {
+public:
+    ProfileSpan(std::shared_ptr<RequestProfile> profile, PartitionID partId);
+
+    ~ProfileSpan() {
+        finish();
+    }
+
+    // End the span before it is destroyed, once only
+    void finish();
+
+private:
+    std::shared_ptr<RequestProfile>             profile_;
+    PartitionID                                 partId_;
+    // the perf level of rocksdb on the thread before, restored when the span ends
+    int                                         perfLevel_{0};
+    std::chrono::steady_clock::time_point       start_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_REQUESTPROFILE_H_
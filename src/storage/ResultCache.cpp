@@ -0,0 +1,67 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/ResultCache.h"
+#include "common/time/WallClock.h"
+#include "kvstore/Part.h"
+
+namespace nebula {
+namespace storage {
+
+std::string ResultCache::key(GraphSpaceID spaceId,
+                             PartitionID partId,
+                             const std::string& shape,
+                             folly::StringPiece input) {
+    std::string key;
+    key.reserve(sizeof(GraphSpaceID) + sizeof(PartitionID) + shape.size() + input.size());
+    key.append(reinterpret_cast<const char*>(&spaceId), sizeof(GraphSpaceID))
+       .append(reinterpret_cast<const char*>(&partId), sizeof(PartitionID))
+       .append(shape)
+       .append(input.data(), input.size());
+    return key;
+}
+
+folly::Optional<uint64_t> ResultCache::version(kvstore::KVStore* kvstore,
+                                               GraphSpaceID spaceId,
+                                               PartitionID partId,
+                                               bool canReadFromFollower) {
+    auto ret = kvstore->part(spaceId, partId);
+    if (!nebula::ok(ret)) {
+        return folly::none;
+    }
+    auto part = nebula::value(ret);
+    if (!canReadFromFollower && !part->isLeader()) {
+        return folly::none;
+    }
+    return part->writeVersion();
+}
+
+std::shared_ptr<const ResultCache::Rows> ResultCache::get(const std::string& key,
+                                                          uint64_t version) {
+    auto cached = cache_.get(key);
+    if (!cached.ok()) {
+        return nullptr;
+    }
+    auto entry = std::move(cached).value();
+    if (entry->version != version ||
+        time::WallClock::fastNowInMilliSec() - entry->createdMs >= ttlMs_) {
+        cache_.evict(key);
+        return nullptr;
+    }
+    // aliases the entry, which is kept alive by the rows returned
+    return std::shared_ptr<const Rows>(entry, &entry->rows);
+}
+
+void ResultCache::put(const std::string& key, uint64_t version, Rows rows) {
+    auto entry = std::make_shared<Entry>();
+    entry->version = version;
+    entry->createdMs = time::WallClock::fastNowInMilliSec();
+    entry->rows = std::move(rows);
+    cache_.insert(key, std::move(entry));
+}
+
+}  // namespace storage
+}  // namespace nebula
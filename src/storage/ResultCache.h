@@ -0,0 +1,83 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_RESULTCACHE_H_
+#define STORAGE_RESULTCACHE_H_
+
+#include "common/base/Base.h"
+#include "common/base/ConcurrentLRUCache.h"
+#include "common/datatypes/DataSet.h"
+#include "kvstore/KVStore.h"
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+namespace nebula {
+namespace storage {
+
+/*
+ResultCache keeps the rows a read request returned of each part, so that the same request
+repeated, e.g. the same GO from a dashboard polled every second, is answered without reading the
+part again. The key is the space, the part, the kind of request and the request without the
+parts in its canonical thrift encoding, plus the input of the part, e.g. the vertices of the part
+of GetNeighbors.
+
+Each entry is tagged with the write version of the part it was read at, which is bumped by every
+commit, snapshot and ingest of the part, so an entry is a miss once anything is written into the
+part, whatever the keys written. The write version is read before the part is read, so a write
+committed while reading only makes the entry stale earlier. Since the schemas and the TTL of the
+data could change the rows without a write, an entry also expires after result_cache_ttl_secs.
+The results of the random sampling and the partial ones stopped by the budget are not cached.
+*/
+class ResultCache final {
+public:
+    using Rows = std::vector<nebula::Row>;
+
+    ResultCache(size_t capacity, uint32_t bucketsExp, int32_t ttlSecs)
+        : cache_(capacity, bucketsExp)
+        , ttlMs_(static_cast<int64_t>(ttlSecs) * 1000) {}
+
+    // The request without the parts in the canonical encoding, which is a thrift struct
+    template <typename T>
+    static std::string shape(const char* kind, T req) {
+        (*req.parts_ref()).clear();
+        std::string shape = kind;
+        shape.append(1, '\0');
+        apache::thrift::CompactSerializer::serialize(req, &shape);
+        return shape;
+    }
+
+    // The key of a part of the request, input is what the request reads of the part
+    static std::string key(GraphSpaceID spaceId,
+                           PartitionID partId,
+                           const std::string& shape,
+                           folly::StringPiece input = "");
+
+    // The write version of the part, which the rows read of it now are at. None if the part
+    // could not be read here, then the request reads it and fails as it would
+    static folly::Optional<uint64_t> version(kvstore::KVStore* kvstore,
+                                             GraphSpaceID spaceId,
+                                             PartitionID partId,
+                                             bool canReadFromFollower);
+
+    // The rows of the key read at the version, null if missed, stale or expired
+    std::shared_ptr<const Rows> get(const std::string& key, uint64_t version);
+
+    void put(const std::string& key, uint64_t version, Rows rows);
+
+private:
+    struct Entry {
+        uint64_t    version;
+        int64_t     createdMs;
+        Rows        rows;
+    };
+
+    ConcurrentLRUCache<std::string, std::shared_ptr<const Entry>>   cache_;
+    const int64_t                                                   ttlMs_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_RESULTCACHE_H_
@@ -0,0 +1,250 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/ScanSessionManager.h"
+#include "common/time/WallClock.h"
+#include "kvstore/Part.h"
+#include "storage/StorageFlags.h"
+
+namespace nebula {
+namespace storage {
+
+bool ScanSessionManager::start() {
+    worker_ = std::make_unique<thread::GenericWorker>();
+    if (!worker_->start("scan-session-expire")) {
+        return false;
+    }
+    auto intervalSecs = std::max(FLAGS_scan_session_ttl_secs, 1);
+    worker_->addRepeatTask(intervalSecs * 1000, &ScanSessionManager::expire, this);
+    return true;
+}
+
+std::unique_ptr<ScanSession> ScanSessionManager::create(GraphSpaceID spaceId,
+                                                        PartitionID partId) {
+    auto ret = kvstore_->part(spaceId, partId);
+    if (!ok(ret)) {
+        return nullptr;
+    }
+    auto* engine = nebula::value(ret)->engine();
+    auto id = nextId_.fetch_add(1);
+    return std::make_unique<ScanSession>(id, spaceId, partId, engine, engine->getSnapshot());
+}
+
+std::unique_ptr<ScanSession> ScanSessionManager::take(GraphSpaceID spaceId,
+                                                      PartitionID partId,
+                                                      int64_t sessionId,
+                                                      bool canReadFromFollower) {
+    std::unique_ptr<ScanSession> session;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        auto iter = sessions_.find(sessionId);
+        if (iter == sessions_.end()) {
+            return nullptr;
+        }
+        // the cursor of another part is passed by mistake
+        if (iter->second.session_->spaceId_ != spaceId ||
+            iter->second.session_->partId_ != partId) {
+            return nullptr;
+        }
+        session = std::move(iter->second.session_);
+        auto parkedTime = iter->second.parkedTime_;
+        sessions_.erase(iter);
+        // expired but not dropped by the background expiration yet
+        if (time::WallClock::fastNowInSec() - parkedTime >= FLAGS_scan_session_ttl_secs) {
+            VLOG(1) << "Scan session " << sessionId << " is expired";
+            return nullptr;
+        }
+    }
+    if (!isValid(spaceId, partId, canReadFromFollower)) {
+        VLOG(1) << "Space " << spaceId << " part " << partId
+                << " is not leader any more, drop the scan session " << sessionId;
+        return nullptr;
+    }
+    return session;
+}
+
+void ScanSessionManager::park(std::unique_ptr<ScanSession> session) {
+    if (FLAGS_scan_session_max_num <= 0 || session == nullptr) {
+        return;
+    }
+    auto now = time::WallClock::fastNowInSec();
+    // the dropped session is released out of the lock
+    std::unique_ptr<ScanSession> dropped;
+    std::lock_guard<std::mutex> guard(lock_);
+    if (stopped_) {
+        dropped = std::move(session);
+        return;
+    }
+    expireLocked(now);
+    if (sessions_.size() >= static_cast<size_t>(FLAGS_scan_session_max_num)) {
+        auto oldest = std::min_element(sessions_.begin(), sessions_.end(),
+                                       [] (const auto& lhs, const auto& rhs) {
+                                           return lhs.second.parkedTime_ <
+                                                  rhs.second.parkedTime_;
+                                       });
+        dropped = std::move(oldest->second.session_);
+        sessions_.erase(oldest);
+    }
+    auto id = session->id_;
+    sessions_[id] = Entry{std::move(session), now};
+}
+
+void ScanSessionManager::expire() {
+    std::vector<std::tuple<int64_t, GraphSpaceID, PartitionID, bool>> parked;
+    {
+        std::lock_guard<std::mutex> guard(lock_);
+        expireLocked(time::WallClock::fastNowInSec());
+        for (const auto& entry : sessions_) {
+            const auto& session = entry.second.session_;
+            parked.emplace_back(entry.first, session->spaceId_, session->partId_,
+                                session->readFromFollower_);
+        }
+    }
+    // the parts are checked out of the lock, which is taken when kvstore removes a part
+    std::vector<int64_t> invalid;
+    for (const auto& [id, spaceId, partId, readFromFollower] : parked) {
+        if (!isValid(spaceId, partId, readFromFollower)) {
+            invalid.emplace_back(id);
+        }
+    }
+    if (invalid.empty()) {
+        return;
+    }
+    // the sessions dropped are released out of the lock
+    std::vector<std::unique_ptr<ScanSession>> dropped;
+    std::lock_guard<std::mutex> guard(lock_);
+    for (auto id : invalid) {
+        auto iter = sessions_.find(id);
+        if (iter != sessions_.end()) {
+            VLOG(1) << "Space " << iter->second.session_->spaceId_ << " part "
+                    << iter->second.session_->partId_
+                    << " is removed or not leader any more, drop the scan session " << id;
+            dropped.emplace_back(std::move(iter->second.session_));
+            sessions_.erase(iter);
+        }
+    }
+}
+
+void ScanSessionManager::dropPart(GraphSpaceID spaceId, PartitionID partId) {
+    std::lock_guard<std::mutex> guard(lock_);
+    for (auto iter = sessions_.begin(); iter != sessions_.end();) {
+        if (iter->second.session_->spaceId_ == spaceId &&
+            iter->second.session_->partId_ == partId) {
+            iter = sessions_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void ScanSessionManager::dropSpace(GraphSpaceID spaceId) {
+    std::lock_guard<std::mutex> guard(lock_);
+    for (auto iter = sessions_.begin(); iter != sessions_.end();) {
+        if (iter->second.session_->spaceId_ == spaceId) {
+            iter = sessions_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+void ScanSessionManager::stop() {
+    // the expiration takes the lock
+    if (worker_ != nullptr) {
+        worker_->stop();
+        worker_->wait();
+        worker_.reset();
+    }
+    std::lock_guard<std::mutex> guard(lock_);
+    stopped_ = true;
+    sessions_.clear();
+}
+
+size_t ScanSessionManager::size() const {
+    std::lock_guard<std::mutex> guard(lock_);
+    return sessions_.size();
+}
+
+std::string ScanSessionManager::encodeCursor(int64_t sessionId, folly::StringPiece key) {
+    std::string cursor;
+    cursor.reserve(sizeof(char) + sizeof(int64_t) + key.size());
+    cursor.append(1, kSessionCursorMagic)
+          .append(reinterpret_cast<const char*>(&sessionId), sizeof(int64_t))
+          .append(key.data(), key.size());
+    return cursor;
+}
+
+bool ScanSessionManager::decodeCursor(const std::string& cursor,
+                                      int64_t* sessionId,
+                                      std::string* key) {
+    if (cursor.size() < sizeof(char) + sizeof(int64_t) || cursor[0] != kSessionCursorMagic) {
+        return false;
+    }
+    memcpy(sessionId, cursor.data() + sizeof(char), sizeof(int64_t));
+    *key = cursor.substr(sizeof(char) + sizeof(int64_t));
+    return true;
+}
+
+std::string ScanSessionManager::encodeMultiPartCursor(
+        const std::vector<std::pair<PartitionID, std::string>>& cursors) {
+    std::string cursor(1, kMultiPartCursorMagic);
+    for (const auto& part : cursors) {
+        uint32_t len = part.second.size();
+        cursor.append(reinterpret_cast<const char*>(&part.first), sizeof(PartitionID))
+              .append(reinterpret_cast<const char*>(&len), sizeof(uint32_t))
+              .append(part.second);
+    }
+    return cursor;
+}
+
+bool ScanSessionManager::decodeMultiPartCursor(
+        const std::string& cursor,
+        std::vector<std::pair<PartitionID, std::string>>* cursors) {
+    if (cursor.empty() || cursor[0] != kMultiPartCursorMagic) {
+        return false;
+    }
+    size_t offset = sizeof(char);
+    while (offset < cursor.size()) {
+        if (offset + sizeof(PartitionID) + sizeof(uint32_t) > cursor.size()) {
+            return false;
+        }
+        PartitionID partId;
+        uint32_t len;
+        memcpy(&partId, cursor.data() + offset, sizeof(PartitionID));
+        offset += sizeof(PartitionID);
+        memcpy(&len, cursor.data() + offset, sizeof(uint32_t));
+        offset += sizeof(uint32_t);
+        if (offset + len > cursor.size()) {
+            return false;
+        }
+        cursors->emplace_back(partId, cursor.substr(offset, len));
+        offset += len;
+    }
+    return true;
+}
+
+void ScanSessionManager::expireLocked(int64_t now) {
+    for (auto iter = sessions_.begin(); iter != sessions_.end();) {
+        if (now - iter->second.parkedTime_ >= FLAGS_scan_session_ttl_secs) {
+            iter = sessions_.erase(iter);
+        } else {
+            ++iter;
+        }
+    }
+}
+
+bool ScanSessionManager::isValid(GraphSpaceID spaceId,
+                                 PartitionID partId,
+                                 bool readFromFollower) {
+    auto ret = kvstore_->part(spaceId, partId);
+    if (!ok(ret)) {
+        return false;
+    }
+    return readFromFollower || nebula::value(ret)->isLeader();
+}
+
+}  // namespace storage
+}  // namespace nebula
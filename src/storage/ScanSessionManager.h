@@ -0,0 +1,162 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_SCANSESSIONMANAGER_H_
+#define STORAGE_SCANSESSIONMANAGER_H_
+
+#include "common/base/Base.h"
+#include "common/thread/GenericWorker.h"
+#include "kvstore/KVStore.h"
+#include "kvstore/KVEngine.h"
+#include "kvstore/KVIterator.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+ScanSession is the state of a ScanVertex/ScanEdge of one part across pages: a snapshot of the
+part's engine, and the iterator of last page with the range it refers to. All pages of a session
+read the snapshot, so they are consistent with each other.
+
+A session without snapshot (engine_ is null) reads the latest data, which is used when sessions
+are disabled.
+*/
+struct ScanSession {
+    ScanSession(int64_t id,
+                GraphSpaceID spaceId,
+                PartitionID partId,
+                kvstore::KVEngine* engine,
+                const void* snapshot)
+        : id_(id)
+        , spaceId_(spaceId)
+        , partId_(partId)
+        , engine_(engine)
+        , snapshot_(snapshot) {}
+
+    ~ScanSession() {
+        // the iterator must be released before the snapshot it reads
+        iter_.reset();
+        if (engine_ != nullptr && snapshot_ != nullptr) {
+            engine_->releaseSnapshot(snapshot_);
+        }
+    }
+
+    // the iterator holds references of start_ and prefix_, so the session is not movable
+    ScanSession(const ScanSession&) = delete;
+    ScanSession& operator=(const ScanSession&) = delete;
+
+    int64_t                                 id_;
+    GraphSpaceID                            spaceId_;
+    PartitionID                             partId_;
+    // the session is dropped once the part is not leader, unless it reads from follower
+    bool                                    readFromFollower_{false};
+    kvstore::KVEngine*                      engine_;
+    const void*                             snapshot_;
+    std::string                             start_;
+    std::string                             prefix_;
+    std::unique_ptr<kvstore::KVIterator>    iter_;
+};
+
+/*
+ScanSessionManager keeps the sessions of scans between pages. The cursor returned to client
+carries the session id besides the next key. When the next page comes, the session is taken
+back, and its parked iterator is reused if it stops at the cursor, or a new iterator at the
+cursor is created on the same snapshot, e.g. the client retries a page.
+
+The parked sessions are expired after FLAGS_scan_session_ttl_secs, and no more than
+FLAGS_scan_session_max_num sessions are kept, the oldest one is dropped if full. The page with
+the cursor of a dropped session starts a new session from the cursor key. Once started, the
+expiration runs every FLAGS_scan_session_ttl_secs in the background, which also drops the
+sessions of the parts removed or not leader any more, so the snapshots are not held for long
+by the scans abandoned.
+*/
+class ScanSessionManager final {
+public:
+    explicit ScanSessionManager(kvstore::KVStore* kvstore)
+        : kvstore_(kvstore) {}
+
+    ~ScanSessionManager() {
+        stop();
+    }
+
+    // Start the background expiration
+    bool start();
+
+    // Create a session of the part with a new snapshot, return nullptr if the part is not found
+    std::unique_ptr<ScanSession> create(GraphSpaceID spaceId, PartitionID partId);
+
+    // Take the parked session of the part, return nullptr if not found or expired.
+    // If canReadFromFollower is false, the session is dropped when the part is not leader.
+    std::unique_ptr<ScanSession> take(GraphSpaceID spaceId,
+                                      PartitionID partId,
+                                      int64_t sessionId,
+                                      bool canReadFromFollower);
+
+    // Park the session for next page
+    void park(std::unique_ptr<ScanSession> session);
+
+    // Drop the sessions which are not used for FLAGS_scan_session_ttl_secs, and the ones of
+    // the parts removed or not leader any more
+    void expire();
+
+    // Drop the sessions of a part, must be called before the part is removed from kvstore
+    void dropPart(GraphSpaceID spaceId, PartitionID partId);
+
+    // Drop the sessions of a space, must be called before the space is removed from kvstore
+    void dropSpace(GraphSpaceID spaceId);
+
+    // Stop the expiration, drop all sessions and park no more, must be called before kvstore
+    // is destroyed
+    void stop();
+
+    size_t size() const;
+
+    // The cursor of a session is kSessionCursorMagic + session id + key. The first byte of a key
+    // is its type, which is never kSessionCursorMagic, so the cursor of sessions and the plain
+    // key cursor could be told apart.
+    static std::string encodeCursor(int64_t sessionId, folly::StringPiece key);
+
+    // Return false if the cursor is a plain key
+    static bool decodeCursor(const std::string& cursor, int64_t* sessionId, std::string* key);
+
+    // The part id of a scan over all the parts the host leads, see FLAGS_scan_multi_part
+    static constexpr PartitionID kMultiPartId = 0;
+
+    // The cursor of a scan over several parts is kMultiPartCursorMagic + the part id, the length
+    // and the cursor of each part not finished, an empty cursor means the part is not started
+    static std::string encodeMultiPartCursor(
+        const std::vector<std::pair<PartitionID, std::string>>& cursors);
+
+    // Return false if the cursor is not of several parts or broken
+    static bool decodeMultiPartCursor(const std::string& cursor,
+                                      std::vector<std::pair<PartitionID, std::string>>* cursors);
+
+private:
+    static constexpr char kSessionCursorMagic = '\xFF';
+    static constexpr char kMultiPartCursorMagic = '\xFE';
+
+    struct Entry {
+        std::unique_ptr<ScanSession>    session_;
+        int64_t                         parkedTime_;
+    };
+
+    // Whether the part is found, and led by this host unless readFromFollower
+    bool isValid(GraphSpaceID spaceId, PartitionID partId, bool readFromFollower);
+
+    void expireLocked(int64_t now);
+
+    kvstore::KVStore*                   kvstore_;
+    std::atomic<int64_t>                nextId_{0};
+    mutable std::mutex                  lock_;
+    std::unordered_map<int64_t, Entry>  sessions_;
+    bool                                stopped_{false};
+    std::unique_ptr<thread::GenericWorker>  worker_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_SCANSESSIONMANAGER_H_
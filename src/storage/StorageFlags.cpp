@@ -26,12 +26,46 @@ DEFINE_int32(rebuild_index_batch_num, 1024,
 DEFINE_int32(rebuild_index_locked_threshold, 1024,
              "The locked threshold will refuse writing.");
 
-DEFINE_int32(vertex_cache_num, 16 * 1000 * 1000, "Total keys inside the cache");
+DEFINE_int32(rebuild_index_part_ranges, 1,
+             "The key ranges each part is split to when rebuild index, which are built in "
+             "parallel by the subtasks");
 
-DEFINE_int32(vertex_cache_bucket_exp, 4, "Total buckets number is 1 << cache_bucket_exp");
+DEFINE_int32(rebuild_index_rate_limit, 0,
+             "The write limit of rebuilding index on this host in bytes per sec. "
+             "The unit is MB. 0 means unlimited.");
+
+DEFINE_bool(rebuild_index_resume, false,
+            "Checkpoint the progress of each key range when rebuild index, and resume the job "
+            "restarted from the checkpoints if the part has no operation logs left");
+
+DEFINE_int64(vertex_cache_capacity_mb, 1024, "Total memory of the vertex cache in MB");
+
+DEFINE_int32(vertex_cache_num, 16 * 1000 * 1000,
+             "Deprecated, use vertex_cache_capacity_mb instead. When it is set and "
+             "vertex_cache_capacity_mb is not, the capacity is vertex_cache_num * 64 bytes");
+
+DEFINE_int32(vertex_cache_bucket_exp, -1, "Total shards number is 1 << vertex_cache_bucket_exp, "
+             "if negative, it is decided by the capacity and cpu cores, which keeps every shard "
+             "at least 4MB. The default used to be 4, set it to keep 16 shards");
 
 DEFINE_bool(enable_vertex_cache, true, "Enable vertex cache");
 
+DEFINE_bool(enable_index_value_cache, false,
+            "Enable cache of the rows last written of hot vertices, which are used as the old "
+            "values to update the tag index without reading them");
+
+DEFINE_int64(index_value_cache_capacity_mb, 256,
+             "Total memory of the cache of rows last written for the tag index in MB");
+
+DEFINE_bool(enable_edge_cache, false, "Enable cache of edges of hot vertices");
+
+DEFINE_int32(edge_cache_num, 100 * 1000, "Total (vertex, edge type) keys inside the edge cache");
+
+DEFINE_int32(edge_cache_bucket_exp, 4, "Total buckets number is 1 << edge_cache_bucket_exp");
+
+DEFINE_int32(edge_cache_max_edges, 10000,
+             "The edges of a vertex with given edge type won't be cached if more than it");
+
 DEFINE_int32(reader_handlers, 32, "Total reader handlers");
 
 DEFINE_uint64(default_mvcc_ver, 0L, "vertex/edge version if enable_multi_versions set to false."
@@ -39,12 +73,281 @@ DEFINE_uint64(default_mvcc_ver, 0L, "vertex/edge version if enable_multi_version
                                "because we need lock before edge. ");
 
 
-DEFINE_string(reader_handlers_type, "cpu", "Type of reader handlers, options: cpu,io");
+DEFINE_string(reader_handlers_type, "cpu",
+              "Type of reader handlers, options: cpu,io,priority. priority means GetProp "
+              "is scheduled before GetNeighbors/Lookup, and scan requests are the last");
 
 DEFINE_bool(trace_toss, false, "output verbose log of toss");
 
+DEFINE_bool(toss_read_index, false,
+            "Whether the getValue of toss confirms the leadership by the lease or a round of "
+            "heartbeats before reading, instead of failing when the lease is expired");
+
+DEFINE_bool(toss_coalesce_remote_part, false,
+            "Whether the toss chains of an AddEdges request which have the same remote part "
+            "forward their in-edges in one request, instead of one request per chain");
+
+DEFINE_int32(toss_resume_lock_interval_secs, 0,
+             "The interval of scanning the edges of the toss parts led by this host and "
+             "resuming the locks left, a part newly elected is scanned at once, "
+             "0 means the locks are only resumed by the readers");
+
+DEFINE_int32(update_combine_window_us, 0,
+             "The updates of the same vertex or edge arrived while one of them is computed are "
+             "combined into one read-modify-write and one raft log, the commit waits at most "
+             "the window for them, 0 means disabled");
+
+DEFINE_bool(update_combine_by_part, false,
+            "When update_combine_window_us > 0, the updates of different vertices or edges of the "
+            "same part arrived together are combined into one raft log too");
+
+DEFINE_int32(write_dedup_ttl_secs, 0,
+             "The seconds the AddEdges writes carrying a write id are remembered in each part, "
+             "a write resent by the client with the same id within it is acknowledged without "
+             "being applied again, 0 means disabled");
+
+DEFINE_int64(write_quota_rows_per_sec, 0,
+             "The rows written per second of each space, the low priority writes over it are "
+             "delayed or rejected, 0 means no quota");
+
+DEFINE_int64(write_quota_bytes_per_sec, 0,
+             "The bytes of requests written per second of each space, the low priority writes "
+             "over it are delayed or rejected, 0 means no quota");
+
+DEFINE_int32(write_admission_max_delay_ms, 100,
+             "The longest time a low priority write over the quota is delayed, it is rejected "
+             "with E_BUFFER_OVERFLOW if it should wait longer");
+
+DEFINE_double(write_stall_reject_pressure, 0,
+              "The low priority writes are rejected once the write stall pressure of rocksdb "
+              "reaches it, 1.0 means the level 0 files or the pending compaction bytes reach "
+              "the slowdown thresholds, 0 means disabled");
+
+DEFINE_int32(write_stall_check_interval_ms, 1000,
+             "The interval of refreshing the write stall pressure of rocksdb");
+
+DEFINE_int32(part_traffic_window_secs, 0,
+             "The window the requests of each part and the hot vertices are counted in, they "
+             "are served by /rocksdb_stats, 0 means disabled");
+
+DEFINE_int32(part_traffic_top_k, 10,
+             "The number of the hot vertices estimated of each space in a window");
+
+DEFINE_string(part_load_report_url, "",
+              "The metad web service the load of each part is reported to for the balance by "
+              "load every part_traffic_window_secs, such as http://127.0.0.1:19559, empty "
+              "means not reported");
+
+DEFINE_string(one_way_edge_types, "",
+              "Comma separated spaceId:edgeName pairs, the edges listed are only traversed "
+              "out from the source, so their reverse edges are not written");
+
+DEFINE_int32(mem_lock_wait_ms, 0,
+             "How long a write waits for the vertices or edges locked by another write, "
+             "0 means failing with E_DATA_CONFLICT_ERROR at once");
+
+DEFINE_int32(mem_lock_max_waiters, 8,
+             "The max number of writes waiting for one locked vertex or edge, the others fail "
+             "at once, only works when mem_lock_wait_ms > 0");
+
 DEFINE_int32(max_edge_returned_per_vertex, INT_MAX,
              "Max edge number returnred searching vertex");
 
 DEFINE_bool(query_concurrently, false,
             "whether to run query of each part concurrently, only lookup and go are supported");
+
+DEFINE_bool(kv_ttl_header, false,
+            "Whether the values of the kv interface start with the time in seconds they expire "
+            "at, as an int64, 0 for never. The expired ones are not got, and dropped by the "
+            "compaction");
+
+DEFINE_bool(kv_get_concurrently, false,
+            "Whether to get the parts of a kv get concurrently in the reader pool of the general "
+            "storage service, only read when the service is started");
+
+DEFINE_bool(write_concurrently, false,
+            "Whether to encode the rows and indexes of each part of AddVertices and AddEdges "
+            "concurrently in the worker pool");
+
+DEFINE_int32(get_neighbors_block_size, 1024,
+             "Number of edges decoded in a column-major block when collecting edge props in "
+             "GetNeighbors, 0 means collect edge by edge");
+
+DEFINE_uint32(storage_rpc_compress_min_bytes, 0,
+              "The responses of the storage service not smaller than it are compressed, if the "
+              "client asks for the compression by the transform of thrift header, 0 means "
+              "the default of thrift");
+
+DEFINE_bool(get_neighbors_columnar_edges, false,
+            "Return the edges of GetNeighbors column by column in the columns named "
+            "_edge_col: instead of _edge:, which must be decoded by the client");
+
+DEFINE_bool(enable_edge_rank_seek, false,
+            "Whether to seek the edges of GetNeighbors to the range of rank the filter allows, "
+            "if the filter compares the rank with constants at the top level");
+
+DEFINE_int64(get_neighbors_approximate_sample_degree, 0,
+             "A random sampling GetNeighbors without filter picks the edges of a vertex by "
+             "random seeks, if it has at least so many edges of the edge type by the degree "
+             "counters, instead of reading all of them. The sample is approximate, 0 means "
+             "never");
+
+DEFINE_int32(super_vertex_edge_threshold, 100000,
+             "If the edges of a vertex with one edge type is at least the threshold by the "
+             "degree counters, the edges will be scanned in parallel");
+
+DEFINE_int32(super_vertex_scan_parallelism, 0,
+             "Number of sub-ranges a super vertex is split into, 0 or 1 means disabled");
+
+DEFINE_int32(super_vertex_scan_batch_size, 1024,
+             "Max edges of each sub-range of a super vertex read ahead in parallel");
+
+DEFINE_int32(index_scan_parallel_threshold, 100000,
+             "If the keys of an index range scan in a part is more than the threshold, "
+             "the rest of the range will be scanned in parallel");
+
+DEFINE_int32(index_scan_parallelism, 1,
+             "Number of sub-ranges an index range scan is split into, 0 or 1 means disabled");
+
+DEFINE_bool(enable_index_intersection, false,
+            "Whether to intersect the index contexts of a lookup on different indexes with the "
+            "same filter, if the filter is a conjunction of comparisons implying the hints of "
+            "them, the others are unioned");
+
+DEFINE_int32(index_estimate_sample_num, 1000,
+             "The index keys counted at most in each part to estimate the rows of an index "
+             "scan when intersecting indexes, 0 means scan the indexes in the request order");
+
+DEFINE_int32(get_prop_batch_size, 1024,
+             "Number of vertices in the same part read by one multiGet in GetProp, "
+             "0 means read them one by one");
+
+DEFINE_int64(scan_max_bytes_per_response, 32 * 1024 * 1024,
+             "Max bytes of keys and values read by one ScanVertex/ScanEdge response, "
+             "the rest are returned by next page, 0 means only limited by row count");
+
+DEFINE_int32(scan_session_max_num, 1024,
+             "Max number of parked scan iterators, which are reused by the next page to "
+             "avoid seeking again, 0 means disabled");
+
+DEFINE_int32(scan_session_ttl_secs, 60, "Parked scan iterators not used in it are dropped");
+
+DEFINE_bool(scan_multi_part, false,
+            "A ScanVertex/ScanEdge with part id 0 scans all the parts the host leads in parallel, "
+            "the next cursor carries the cursor of each part not finished");
+
+DEFINE_bool(enable_compiled_filter, true,
+            "Evaluate the simple numeric comparisons of pushed down filter without walking "
+            "the expression, the other filters are not affected");
+
+DEFINE_int64(query_max_scanned_keys, 0,
+             "Max keys scanned by one GetNeighbors or Lookup request, the result collected "
+             "so far is returned as partial result if exceeded, 0 means no limit");
+
+DEFINE_int64(query_max_scanned_bytes, 0,
+             "Max bytes of keys and values scanned by one GetNeighbors or Lookup request, "
+             "the result collected so far is returned as partial result if exceeded, "
+             "0 means no limit");
+
+DEFINE_int64(query_timeout_ms, 0,
+             "Max time spent by one GetNeighbors or Lookup request on scanning, the result "
+             "collected so far is returned as partial result if exceeded, 0 means no limit");
+
+DEFINE_int64(query_max_memory_bytes, 0,
+             "Max bytes of the result held by one read request, the result collected so far "
+             "is returned as partial result or the next page if exceeded, 0 means no limit");
+
+DEFINE_int64(space_query_memory_limit_bytes, 0,
+             "Max bytes of the results held by all the read requests of a space, "
+             "0 means no limit");
+
+DEFINE_int64(process_query_memory_limit_bytes, 0,
+             "Max bytes of the results held by all the read requests of the process, "
+             "0 means no limit");
+
+DEFINE_bool(enable_follower_read, false,
+            "Whether GetNeighbors, GetProps and Lookup could be served by followers and learners, "
+            "whose staleness is bounded by follower_read_max_staleness_ms");
+
+DEFINE_bool(update_by_merge_operand, false,
+            "Write the upsert of a vertex which only adds constants to its props as a merge "
+            "operand of rocksdb, without reading the row before, only in the spaces listed in "
+            "update_by_merge_operand_spaces");
+
+DEFINE_string(update_by_merge_operand_spaces, "",
+              "Comma separated ids of the spaces opted in to update_by_merge_operand, the parts "
+              "with listeners are never updated by merge operands, since the listeners only "
+              "see the operands instead of the rows");
+
+DEFINE_int32(statis_reconcile_interval_secs, 86400,
+             "The STATS job scans the part again to reconcile the counters maintained by "
+             "enable_incremental_statis if they are offset longer than it, 0 for never");
+
+DEFINE_int32(statis_sample_keys, 0,
+             "The vertices and edges of each part sampled by the STATS job to estimate the "
+             "statis, instead of scanning all of them, 0 to scan");
+
+DEFINE_int64(statis_super_node_degree, 10000,
+             "The out degree from which a vertex sampled by the STATS job is a super node");
+
+DEFINE_double(latency_trace_sample_rate, 0,
+              "The ratio of the read requests of which the time spent in each stage is traced "
+              "into the stage latency histograms, 0 to trace none");
+
+DEFINE_int32(slow_request_threshold_ms, 0,
+             "The read requests taking longer are logged with the nodes of the plan, the "
+             "parts and the rocksdb perf context, 0 means disabled");
+
+DEFINE_double(slow_request_log_per_sec, 1,
+              "The most slow requests logged per second");
+
+DEFINE_double(rocksdb_perf_context_sample_rate, 0,
+              "The ratio of the read requests of which the rocksdb perf context and io stats "
+              "are counted, summed up by the request type and space into /rocksdb_stats, "
+              "0 means disabled");
+
+DEFINE_int32(multi_tag_scan_min_tags, 0,
+             "The tags of a vertex are read by one prefix scan over the vertex instead of a "
+             "seek of each tag, if at least so many tags of it are to be read, 0 means never");
+
+DEFINE_int32(plan_template_cache_num, 0,
+             "The request shapes of GetNeighbors and GetProp whose contexts are cached, so the "
+             "requests of the same shape don't build them again, 0 means disabled");
+
+DEFINE_int32(result_cache_num, 0,
+             "The results of each part of GetNeighbors and Lookup requests cached, so the same "
+             "request repeated is answered without reading the part if nothing is written into "
+             "it since, 0 means disabled");
+
+DEFINE_int32(result_cache_bucket_exp, 4, "Total buckets number is 1 << result_cache_bucket_exp");
+
+DEFINE_bool(enable_hot_vertex_warmup, false,
+            "Whether to warm the block cache for the hot vertices of each part, which the leader "
+            "writes into the part, at startup and on each replica when they are written");
+
+DEFINE_int32(hot_vertex_persist_interval_secs, 300,
+             "The interval the leader writes the hot vertices of its parts, which requires "
+             "part_traffic_window_secs, 0 means only before the leader is transferred");
+
+DEFINE_int32(result_cache_ttl_secs, 10,
+             "The results cached expire after it, which bounds how long a result is stale after "
+             "the schema is altered or the data expires by the TTL");
+
+DEFINE_int32(part_affinity_threads, 0,
+             "The read tasks of each part run by query_concurrently are always run on the same "
+             "one of so many threads, instead of any thread of the reader pool, 0 means disabled");
+
+DEFINE_bool(part_affinity_pin_cores, false,
+            "Pin each thread of part_affinity_threads to a core");
+
+DEFINE_bool(enable_vertex_filter, false,
+            "Keep a bloom filter of the vertices of each part in memory, the reads of the "
+            "vertices not existing skip the kvstore");
+
+DEFINE_int32(vertex_filter_bits_per_key, 10,
+             "Bits of the vertex filter for each vertex, more bits less false positive");
+
+DEFINE_bool(rewrite_v1_rows_on_compaction, false,
+            "Whether the vertices and edges in the V1 format are encoded in V2 when they are "
+            "compacted by the compaction filter, i.e. by the full or manual compactions, and the "
+            "minor ones every custom_filter_interval_secs");
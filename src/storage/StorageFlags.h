@@ -23,12 +23,32 @@ DECLARE_int32(rebuild_index_batch_num);
 
 DECLARE_int32(rebuild_index_locked_threshold);
 
+DECLARE_int32(rebuild_index_part_ranges);
+
+DECLARE_int32(rebuild_index_rate_limit);
+
+DECLARE_bool(rebuild_index_resume);
+
+DECLARE_int64(vertex_cache_capacity_mb);
+
 DECLARE_int32(vertex_cache_num);
 
 DECLARE_int32(vertex_cache_bucket_exp);
 
 DECLARE_bool(enable_vertex_cache);
 
+DECLARE_bool(enable_index_value_cache);
+
+DECLARE_int64(index_value_cache_capacity_mb);
+
+DECLARE_bool(enable_edge_cache);
+
+DECLARE_int32(edge_cache_num);
+
+DECLARE_int32(edge_cache_bucket_exp);
+
+DECLARE_int32(edge_cache_max_edges);
+
 DECLARE_int32(reader_handlers);
 
 DECLARE_uint64(default_mvcc_ver);
@@ -37,8 +57,140 @@ DECLARE_string(reader_handlers_type);
 
 DECLARE_bool(trace_toss);
 
+DECLARE_bool(toss_read_index);
+
+DECLARE_bool(toss_coalesce_remote_part);
+
+DECLARE_int32(toss_resume_lock_interval_secs);
+
+DECLARE_int32(update_combine_window_us);
+
+DECLARE_bool(update_combine_by_part);
+
+DECLARE_int32(write_dedup_ttl_secs);
+
+DECLARE_int64(write_quota_rows_per_sec);
+
+DECLARE_int64(write_quota_bytes_per_sec);
+
+DECLARE_int32(write_admission_max_delay_ms);
+
+DECLARE_double(write_stall_reject_pressure);
+
+DECLARE_int32(write_stall_check_interval_ms);
+
+DECLARE_int32(part_traffic_window_secs);
+
+DECLARE_int32(part_traffic_top_k);
+
+DECLARE_string(part_load_report_url);
+
+DECLARE_string(one_way_edge_types);
+
+DECLARE_int32(mem_lock_wait_ms);
+
+DECLARE_int32(mem_lock_max_waiters);
+
 DECLARE_int32(max_edge_returned_per_vertex);
 
 DECLARE_bool(query_concurrently);
 
+DECLARE_bool(write_concurrently);
+
+DECLARE_bool(kv_get_concurrently);
+
+DECLARE_bool(kv_ttl_header);
+
+DECLARE_int32(get_neighbors_block_size);
+
+DECLARE_bool(get_neighbors_columnar_edges);
+
+DECLARE_uint32(storage_rpc_compress_min_bytes);
+
+DECLARE_bool(enable_edge_rank_seek);
+
+DECLARE_int64(get_neighbors_approximate_sample_degree);
+
+DECLARE_int32(super_vertex_edge_threshold);
+
+DECLARE_int32(super_vertex_scan_parallelism);
+
+DECLARE_int32(super_vertex_scan_batch_size);
+
+DECLARE_int32(index_scan_parallel_threshold);
+
+DECLARE_int32(index_scan_parallelism);
+
+DECLARE_bool(enable_index_intersection);
+
+DECLARE_int32(index_estimate_sample_num);
+
+DECLARE_int32(get_prop_batch_size);
+
+DECLARE_int64(scan_max_bytes_per_response);
+
+DECLARE_int32(scan_session_max_num);
+
+DECLARE_int32(scan_session_ttl_secs);
+
+DECLARE_bool(scan_multi_part);
+
+DECLARE_bool(enable_compiled_filter);
+
+DECLARE_int64(query_max_scanned_keys);
+
+DECLARE_int64(query_max_scanned_bytes);
+
+DECLARE_int64(query_timeout_ms);
+
+DECLARE_int64(query_max_memory_bytes);
+
+DECLARE_int64(space_query_memory_limit_bytes);
+
+DECLARE_int64(process_query_memory_limit_bytes);
+
+DECLARE_bool(enable_follower_read);
+
+DECLARE_bool(update_by_merge_operand);
+
+DECLARE_string(update_by_merge_operand_spaces);
+
+DECLARE_int32(statis_reconcile_interval_secs);
+
+DECLARE_int32(statis_sample_keys);
+
+DECLARE_int64(statis_super_node_degree);
+
+DECLARE_double(latency_trace_sample_rate);
+
+DECLARE_int32(slow_request_threshold_ms);
+
+DECLARE_double(slow_request_log_per_sec);
+
+DECLARE_double(rocksdb_perf_context_sample_rate);
+
+DECLARE_int32(multi_tag_scan_min_tags);
+
+DECLARE_int32(plan_template_cache_num);
+
+DECLARE_int32(result_cache_num);
+
+DECLARE_int32(result_cache_bucket_exp);
+
+DECLARE_int32(result_cache_ttl_secs);
+
+DECLARE_bool(enable_hot_vertex_warmup);
+
+DECLARE_int32(hot_vertex_persist_interval_secs);
+
+DECLARE_int32(part_affinity_threads);
+
+DECLARE_bool(part_affinity_pin_cores);
+
+DECLARE_bool(enable_vertex_filter);
+
+DECLARE_int32(vertex_filter_bits_per_key);
+
+DECLARE_bool(rewrite_v1_rows_on_compaction);
+
 #endif  // STORAGE_STORAGEFLAGS_H_
@@ -16,6 +16,7 @@
 #include "common/version/Version.h"
 #include "storage/BaseProcessor.h"
 #include "storage/CompactionFilter.h"
+#include "storage/MergeOperator.h"
 #include "storage/StorageFlags.h"
 #include "storage/StorageAdminServiceHandler.h"
 #include "storage/InternalStorageServiceHandler.h"
@@ -24,7 +25,11 @@
 #include "storage/http/StorageHttpDownloadHandler.h"
 #include "storage/http/StorageHttpIngestHandler.h"
 #include "storage/http/StorageHttpAdminHandler.h"
+#include "storage/http/StorageHttpSplitHandler.h"
+#include "storage/http/StorageHttpVersionHandler.h"
+#include "utils/HttpProfileHandler.h"
 #include "storage/transaction/TransactionManager.h"
+#include "common/http/HttpClient.h"
 #include "kvstore/PartManager.h"
 #include "utils/Utils.h"
 #include <thrift/lib/cpp/concurrency/ThreadManager.h>
@@ -32,7 +37,21 @@
 DEFINE_int32(port, 44500, "Storage daemon listening port");
 DEFINE_int32(num_io_threads, 16, "Number of IO threads");
 DEFINE_int32(num_worker_threads, 32, "Number of workers");
+DEFINE_int32(num_admin_worker_threads, 0,
+             "Number of workers of the admin service, 0 to share the workers of the storage "
+             "service");
+DEFINE_int32(num_internal_worker_threads, 0,
+             "Number of workers of the internal storage service, 0 to share the workers of the "
+             "storage service");
+DEFINE_int32(storage_max_requests, 0,
+             "Max requests the storage service is processing, beyond which the requests are "
+             "rejected as overloaded, 0 for no limit");
+DEFINE_int32(storage_queue_timeout_ms, 0,
+             "Max time a request of the storage service waits in the queue of the workers, "
+             "beyond which it is dropped as overloaded, 0 for no limit");
 DEFINE_int32(storage_http_thread_num, 3, "Number of storage daemon's http thread");
+DEFINE_int32(num_edge_scan_threads, 8,
+             "Number of threads to scan edges of super vertex or index range in parallel");
 DEFINE_bool(local_config, false, "meta client will not retrieve latest configuration from meta");
 
 namespace nebula {
@@ -63,7 +82,26 @@ std::unique_ptr<kvstore::KVStore> StorageServer::getStoreInstance() {
                                                 metaClient_.get());
     options.cffBuilder_ = std::make_unique<StorageCompactionFilterFactoryBuilder>(schemaMan_.get(),
                                                                                   indexMan_.get());
+    // The merge operands written are resolved at read, so it is always installed
+    options.mergeOp_ = std::make_shared<NebulaOperator>(schemaMan_.get());
     options.schemaMan_ = schemaMan_.get();
+    std::vector<std::shared_ptr<kvstore::CommitObserver>> observers;
+    if (FLAGS_enable_vertex_filter) {
+        vertexFilter_ = std::make_shared<VertexFilter>(schemaMan_.get(),
+                                                       FLAGS_vertex_filter_bits_per_key);
+        observers.emplace_back(vertexFilter_);
+    }
+    if (FLAGS_enable_hot_vertex_warmup) {
+        hotVertexWarmer_ = std::make_shared<HotVertexWarmer>(
+            schemaMan_.get(), FLAGS_hot_vertex_persist_interval_secs);
+        observers.emplace_back(hotVertexWarmer_);
+    }
+    if (observers.size() == 1) {
+        options.commitObserver_ = observers.front();
+    } else if (observers.size() > 1) {
+        options.commitObserver_ =
+            std::make_shared<kvstore::CommitObserverList>(std::move(observers));
+    }
     if (FLAGS_store_type == "nebula") {
         auto nbStore = std::make_unique<kvstore::NebulaStore>(std::move(options),
                                                               ioThreadPool_,
@@ -104,8 +142,22 @@ bool StorageServer::initWebService() {
     router.get("/admin").handler([this](web::PathParams&&) {
         return new storage::StorageHttpAdminHandler(schemaMan_.get(), kvstore_.get());
     });
-    router.get("/rocksdb_stats").handler([](web::PathParams&&) {
-        return new storage::StorageHttpStatsHandler();
+    router.get("/split").handler([this](web::PathParams&&) {
+        return new storage::StorageHttpSplitHandler(
+            schemaMan_.get(), indexMan_.get(), kvstore_.get());
+    });
+    router.get("/part_versions").handler([this](web::PathParams&&) {
+        return new storage::StorageHttpVersionHandler(kvstore_.get());
+    });
+    router.get("/rocksdb_stats").handler([this](web::PathParams&&) {
+        auto* nbStore = dynamic_cast<kvstore::NebulaStore*>(kvstore_.get());
+        return new storage::StorageHttpStatsHandler(
+            vertexCache_.get(),
+            nbStore != nullptr ? nbStore->reclaimer() : nullptr,
+            partTraffic_.get());
+    });
+    router.get("/pprof").handler([](web::PathParams&&) {
+        return new HttpProfileHandler();
     });
 
     auto status = webSvc_->start();
@@ -118,6 +170,23 @@ bool StorageServer::start() {
                                  FLAGS_num_worker_threads, true /*stats*/);
     workers_->setNamePrefix("executor");
     workers_->start();
+    /*
+    The admin and internal services get their own workers if asked, so a flood of reads is not
+    able to delay a leader transfer or the TOSS calls by filling the queue they share. They are
+    rarely busy, so a few threads are enough.
+    */
+    auto newWorkers = [this] (int32_t threads, const char* name) {
+        if (threads <= 0) {
+            return workers_;
+        }
+        auto workers = apache::thrift::concurrency::PriorityThreadManager::
+            newPriorityThreadManager(threads, true /*stats*/);
+        workers->setNamePrefix(name);
+        workers->start();
+        return workers;
+    };
+    adminWorkers_ = newWorkers(FLAGS_num_admin_worker_threads, "admin-executor");
+    internalWorkers_ = newWorkers(FLAGS_num_internal_worker_threads, "internal-executor");
 
     // Meta client
     meta::MetaClientOptions options;
@@ -153,6 +222,18 @@ bool StorageServer::start() {
         return false;
     }
 
+    if (FLAGS_enable_vertex_cache) {
+        int64_t capacity = FLAGS_vertex_cache_capacity_mb * 1024 * 1024;
+        if (!gflags::GetCommandLineFlagInfoOrDie("vertex_cache_num").is_default &&
+            gflags::GetCommandLineFlagInfoOrDie("vertex_cache_capacity_mb").is_default) {
+            // the old default of 16M vertices takes the new default of 1GB
+            capacity = static_cast<int64_t>(FLAGS_vertex_cache_num) * 64;
+            LOG(WARNING) << "vertex_cache_num is deprecated, use vertex_cache_capacity_mb, "
+                         << "the capacity is " << (capacity >> 20) << "MB now";
+        }
+        vertexCache_ = std::make_unique<VertexCache>(capacity, FLAGS_vertex_cache_bucket_exp);
+    }
+
     if (!initWebService()) {
         LOG(ERROR) << "Init webservice failed!";
         return false;
@@ -173,18 +254,209 @@ bool StorageServer::start() {
 
     txnMan_ = std::make_unique<TransactionManager>(env_.get());
     env_->txnMan_ = txnMan_.get();
+    if (FLAGS_toss_resume_lock_interval_secs > 0 && !txnMan_->start()) {
+        LOG(ERROR) << "Start the lock resume worker failed!";
+        return false;
+    }
+
+    env_->verticesML_ = std::make_unique<VerticesMemLock>(FLAGS_mem_lock_wait_ms,
+                                                         FLAGS_mem_lock_max_waiters);
+    env_->edgesML_ = std::make_unique<EdgesMemLock>(FLAGS_mem_lock_wait_ms,
+                                                   FLAGS_mem_lock_max_waiters);
+
+    if ((FLAGS_super_vertex_scan_parallelism > 1 || FLAGS_index_scan_parallelism > 1) &&
+        FLAGS_num_edge_scan_threads > 0) {
+        edgeScanPool_ = std::make_unique<folly::CPUThreadPoolExecutor>(
+            FLAGS_num_edge_scan_threads,
+            std::make_shared<folly::NamedThreadFactory>("edge-scan"));
+        env_->edgeScanPool_ = edgeScanPool_.get();
+    }
+
+    if (FLAGS_enable_edge_cache) {
+        edgeCache_ = std::make_unique<EdgeCache>(FLAGS_edge_cache_num,
+                                                 FLAGS_edge_cache_bucket_exp);
+        env_->edgeCache_ = edgeCache_.get();
+    }
+
+    if (FLAGS_plan_template_cache_num > 0) {
+        // the shapes are few, 16 buckets are enough
+        planTemplates_ = std::make_unique<PlanTemplateCache>(FLAGS_plan_template_cache_num, 4);
+        env_->planTemplates_ = planTemplates_.get();
+    }
+
+    if (FLAGS_result_cache_num > 0) {
+        resultCache_ = std::make_unique<ResultCache>(FLAGS_result_cache_num,
+                                                     FLAGS_result_cache_bucket_exp,
+                                                     FLAGS_result_cache_ttl_secs);
+        env_->resultCache_ = resultCache_.get();
+    }
+
+    if (FLAGS_part_affinity_threads > 0) {
+        partAffinity_ = std::make_unique<PartAffinityExecutor>(FLAGS_part_affinity_threads,
+                                                               FLAGS_part_affinity_pin_cores);
+        env_->partAffinity_ = partAffinity_.get();
+    }
+
+    if (vertexFilter_ != nullptr) {
+        vertexFilter_->setStore(kvstore_.get());
+        if (!vertexFilter_->start()) {
+            LOG(ERROR) << "Start vertex filter failed";
+            return false;
+        }
+        env_->vertexFilter_ = vertexFilter_.get();
+    }
+
+    if (FLAGS_enable_index_value_cache) {
+        indexValueCache_ = std::make_unique<IndexValueCache>(
+            FLAGS_index_value_cache_capacity_mb * 1024 * 1024, FLAGS_vertex_cache_bucket_exp);
+        env_->indexValueCache_ = indexValueCache_.get();
+    }
+
+    if (FLAGS_update_combine_window_us > 0) {
+        verticesUC_ = std::make_unique<VerticesUpdateCombiner>(FLAGS_update_combine_window_us);
+        env_->verticesUC_ = verticesUC_.get();
+        edgesUC_ = std::make_unique<EdgesUpdateCombiner>(FLAGS_update_combine_window_us);
+        env_->edgesUC_ = edgesUC_.get();
+    }
+
+    if (FLAGS_write_dedup_ttl_secs > 0) {
+        writeDedup_ = std::make_unique<WriteDedupWindow>(FLAGS_write_dedup_ttl_secs);
+        env_->writeDedup_ = writeDedup_.get();
+    }
+
+    if (FLAGS_write_quota_rows_per_sec > 0 || FLAGS_write_quota_bytes_per_sec > 0 ||
+        FLAGS_write_stall_reject_pressure > 0) {
+        std::function<double()> stallPressure;
+        auto* nbStore = dynamic_cast<kvstore::NebulaStore*>(kvstore_.get());
+        if (nbStore != nullptr) {
+            stallPressure = [nbStore] { return nbStore->writeStallPressure(); };
+        }
+        writeAdmission_ = std::make_unique<WriteAdmission>(std::move(stallPressure));
+        if (!writeAdmission_->start()) {
+            LOG(ERROR) << "Start write admission failed";
+            return false;
+        }
+        env_->writeAdmission_ = writeAdmission_.get();
+    }
+
+    if (FLAGS_part_traffic_window_secs > 0) {
+        PartTraffic::Reporter reporter;
+        if (!FLAGS_part_load_report_url.empty()) {
+            reporter = [] (GraphSpaceID spaceId, PartitionID partId, const auto& load) {
+                auto url = folly::stringPrintf("%s/part-load?space=%d&part=%d&read_qps=%ld"
+                                               "&write_qps=%ld",
+                                               FLAGS_part_load_report_url.c_str(),
+                                               spaceId,
+                                               partId,
+                                               std::lround(load.readQps),
+                                               std::lround(load.writeQps));
+                auto ret = http::HttpClient::get(url);
+                if (!ret.ok()) {
+                    LOG(WARNING) << "Report the load of space " << spaceId << " part " << partId
+                                 << " failed: " << ret.status();
+                }
+            };
+        }
+        partTraffic_ = std::make_unique<PartTraffic>(FLAGS_part_traffic_window_secs,
+                                                     FLAGS_part_traffic_top_k,
+                                                     std::move(reporter));
+        if (!partTraffic_->start()) {
+            LOG(ERROR) << "Start part traffic failed";
+            return false;
+        }
+        env_->partTraffic_ = partTraffic_.get();
+    }
+
+    if (hotVertexWarmer_ != nullptr) {
+        hotVertexWarmer_->setStore(kvstore_.get(), partTraffic_.get());
+        if (!hotVertexWarmer_->start()) {
+            LOG(ERROR) << "Start hot vertex warmer failed";
+            return false;
+        }
+        env_->hotVertexWarmer_ = hotVertexWarmer_.get();
+    }
+
+    if (FLAGS_scan_session_max_num > 0) {
+        scanSessions_ = std::make_unique<ScanSessionManager>(kvstore_.get());
+        env_->scanSessions_ = scanSessions_.get();
+        auto* nbStore = dynamic_cast<kvstore::NebulaStore*>(kvstore_.get());
+        if (nbStore != nullptr) {
+            // parked iterators must be released before the engines are destroyed
+            nbStore->setBeforeRemoveSpace([this] (GraphSpaceID spaceId) {
+                scanSessions_->dropSpace(spaceId);
+            });
+            // the snapshots of a part removed pin its data
+            nbStore->setBeforeRemovePart([this] (GraphSpaceID spaceId, PartitionID partId) {
+                scanSessions_->dropPart(spaceId, partId);
+            });
+        }
+        if (!scanSessions_->start()) {
+            LOG(ERROR) << "Start scan session expiration failed";
+            return false;
+        }
+    }
+
+    if (FLAGS_enable_load_aware_compaction) {
+        auto* nbStore = dynamic_cast<kvstore::NebulaStore*>(kvstore_.get());
+        if (nbStore != nullptr) {
+            compactionScheduler_ = std::make_unique<kvstore::CompactionScheduler>(
+                nbStore, [this] () -> size_t { return workers_->pendingTaskCount(); });
+            if (!compactionScheduler_->start()) {
+                LOG(ERROR) << "Start compaction scheduler failed";
+                return false;
+            }
+            // the admin tasks yield the disks to the foreground traffic as the compactions do
+            taskMgr_->setBusyCheck([this] { return compactionScheduler_->isBusy(); });
+        }
+    }
 
-    env_->verticesML_ = std::make_unique<VerticesMemLock>();
-    env_->edgesML_ = std::make_unique<EdgesMemLock>();
+    if (FLAGS_thread_pool_stats_interval_ms > 0) {
+        threadPoolStats_ = std::make_unique<ThreadPoolStats>(FLAGS_thread_pool_stats_interval_ms);
+        // the raft service shares the io threads and the workers
+        threadPoolStats_->addPool("io", ioThreadPool_.get());
+        threadPoolStats_->addPool("executor", workers_.get());
+        if (adminWorkers_ != workers_) {
+            threadPoolStats_->addPool("admin_executor", adminWorkers_.get());
+        }
+        if (internalWorkers_ != workers_) {
+            threadPoolStats_->addPool("internal_executor", internalWorkers_.get());
+        }
+        if (edgeScanPool_ != nullptr) {
+            threadPoolStats_->addPool("edge_scan", edgeScanPool_.get());
+        }
+        auto* nbStore = dynamic_cast<kvstore::NebulaStore*>(kvstore_.get());
+        if (nbStore != nullptr) {
+            auto snapshot = nbStore->getSnapshotManager();
+            threadPoolStats_->addPool("snapshot_worker", snapshot->workers());
+            threadPoolStats_->addPool("snapshot_io", snapshot->ioPool());
+        }
+        if (!threadPoolStats_->start()) {
+            LOG(ERROR) << "Start thread pool stats failed";
+            return false;
+        }
+    }
 
     storageThread_.reset(new std::thread([this] {
         try {
-            auto handler = std::make_shared<GraphStorageServiceHandler>(env_.get());
+            auto handler = std::make_shared<GraphStorageServiceHandler>(env_.get(),
+                                                                        vertexCache_.get());
             storageServer_ = std::make_unique<apache::thrift::ThriftServer>();
             storageServer_->setPort(FLAGS_port);
             storageServer_->setIdleTimeout(std::chrono::seconds(0));
+            if (FLAGS_storage_rpc_compress_min_bytes > 0) {
+                // the responses are compressed for the clients asking for it in the header
+                storageServer_->setMinCompressBytes(FLAGS_storage_rpc_compress_min_bytes);
+            }
             storageServer_->setIOThreadPool(ioThreadPool_);
             storageServer_->setThreadManager(workers_);
+            // shed the reads beyond the workers before they pile up in the queue
+            if (FLAGS_storage_max_requests > 0) {
+                storageServer_->setMaxRequests(FLAGS_storage_max_requests);
+            }
+            if (FLAGS_storage_queue_timeout_ms > 0) {
+                storageServer_->setQueueTimeout(
+                    std::chrono::milliseconds(FLAGS_storage_queue_timeout_ms));
+            }
             storageServer_->setStopWorkersOnStopListening(false);
             storageServer_->setInterface(std::move(handler));
 
@@ -210,7 +482,7 @@ bool StorageServer::start() {
             adminServer_->setPort(adminAddr.port);
             adminServer_->setIdleTimeout(std::chrono::seconds(0));
             adminServer_->setIOThreadPool(ioThreadPool_);
-            adminServer_->setThreadManager(workers_);
+            adminServer_->setThreadManager(adminWorkers_);
             adminServer_->setStopWorkersOnStopListening(false);
             adminServer_->setInterface(std::move(handler));
 
@@ -236,7 +508,7 @@ bool StorageServer::start() {
             internalStorageServer_->setPort(internalAddr.port);
             internalStorageServer_->setIdleTimeout(std::chrono::seconds(0));
             internalStorageServer_->setIOThreadPool(ioThreadPool_);
-            internalStorageServer_->setThreadManager(workers_);
+            internalStorageServer_->setThreadManager(internalWorkers_);
             internalStorageServer_->setStopWorkersOnStopListening(false);
             internalStorageServer_->setInterface(std::move(handler));
 
@@ -287,6 +559,42 @@ void StorageServer::stop() {
     ServiceStatus interStorageExpected = ServiceStatus::STATUS_RUNNING;
     internalStorageSvcStatus_.compare_exchange_strong(interStorageExpected, STATUS_STTOPED);
 
+    if (compactionScheduler_) {
+        if (taskMgr_) {
+            taskMgr_->setBusyCheck(nullptr);
+        }
+        compactionScheduler_->stop();
+        compactionScheduler_.reset();
+    }
+    if (writeAdmission_) {
+        // stop polling the engines before the kvstore is stopped
+        writeAdmission_->stop();
+    }
+    // the hot vertices are estimated by the traffic and read from the kvstore
+    if (hotVertexWarmer_) {
+        hotVertexWarmer_->stop();
+    }
+    if (partTraffic_) {
+        partTraffic_->stop();
+    }
+    // the snapshot pools are destroyed with the kvstore
+    if (threadPoolStats_) {
+        threadPoolStats_->stop();
+    }
+    // the read tasks queued read the kvstore
+    if (partAffinity_) {
+        partAffinity_->stop();
+    }
+    // the parts being built are scanned
+    if (vertexFilter_) {
+        vertexFilter_->stop();
+    }
+
+    // stop resuming the locks before the parts are stopped
+    if (txnMan_) {
+        txnMan_->stop();
+    }
+
     // kvstore need to stop back ground job before http server dctor
     if (kvstore_) {
         kvstore_->stop();
@@ -300,6 +608,9 @@ void StorageServer::stop() {
     if (metaClient_) {
         metaClient_->stop();
     }
+    if (scanSessions_) {
+        scanSessions_->stop();
+    }
     if (kvstore_) {
         kvstore_.reset();
     }
@@ -312,6 +623,9 @@ void StorageServer::stop() {
     if (storageServer_) {
         storageServer_->stop();
     }
+    if (edgeScanPool_) {
+        edgeScanPool_->join();
+    }
 }
 
 }   // namespace storage
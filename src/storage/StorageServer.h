@@ -13,9 +13,13 @@
 #include "common/clients/meta/MetaClient.h"
 #include "common/hdfs/HdfsHelper.h"
 #include <thrift/lib/cpp2/server/ThriftServer.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include "kvstore/NebulaStore.h"
+#include "kvstore/CompactionScheduler.h"
 #include "storage/CommonUtils.h"
 #include "storage/admin/AdminTaskManager.h"
+#include "storage/query/PlanTemplateCache.h"
+#include "utils/ThreadPoolStats.h"
 
 namespace nebula {
 
@@ -54,6 +58,11 @@ private:
 
     std::shared_ptr<folly::IOThreadPoolExecutor> ioThreadPool_;
     std::shared_ptr<apache::thrift::concurrency::ThreadManager> workers_;
+    // the same as workers_ unless num_admin_worker_threads is set
+    std::shared_ptr<apache::thrift::concurrency::ThreadManager> adminWorkers_;
+    // the same as workers_ unless num_internal_worker_threads is set
+    std::shared_ptr<apache::thrift::concurrency::ThreadManager> internalWorkers_;
+    std::unique_ptr<folly::CPUThreadPoolExecutor> edgeScanPool_;
 
     std::unique_ptr<std::thread> storageThread_;
     std::unique_ptr<std::thread> adminThread_;
@@ -76,6 +85,23 @@ private:
     std::unique_ptr<meta::SchemaManager> schemaMan_;
     std::unique_ptr<meta::IndexManager> indexMan_;
     std::unique_ptr<storage::StorageEnv> env_;
+    std::unique_ptr<storage::EdgeCache> edgeCache_;
+    std::unique_ptr<storage::VertexCache> vertexCache_;
+    std::unique_ptr<storage::IndexValueCache> indexValueCache_;
+    std::unique_ptr<storage::VerticesUpdateCombiner> verticesUC_;
+    std::unique_ptr<storage::EdgesUpdateCombiner> edgesUC_;
+    std::unique_ptr<storage::WriteDedupWindow> writeDedup_;
+    std::unique_ptr<storage::WriteAdmission> writeAdmission_;
+    std::unique_ptr<storage::PartTraffic> partTraffic_;
+    std::unique_ptr<storage::ScanSessionManager> scanSessions_;
+    std::unique_ptr<storage::PlanTemplateCache> planTemplates_;
+    std::unique_ptr<storage::ResultCache> resultCache_;
+    std::unique_ptr<storage::PartAffinityExecutor> partAffinity_;
+    // shared with the kvstore told of the commits
+    std::shared_ptr<storage::VertexFilter> vertexFilter_;
+    std::shared_ptr<storage::HotVertexWarmer> hotVertexWarmer_;
+    std::unique_ptr<kvstore::CompactionScheduler> compactionScheduler_;
+    std::unique_ptr<ThreadPoolStats> threadPoolStats_;
 
     HostAddr localHost_;
     std::vector<HostAddr> metaAddrs_;
@@ -0,0 +1,192 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_UPDATECOMBINER_H_
+#define STORAGE_UPDATECOMBINER_H_
+
+#include "common/base/Base.h"
+#include <condition_variable>
+#include "kvstore/LogEncoder.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+UpdateCombiner merges the updates of the same key arrived within a short window into one
+read-modify-write and one raft log.
+
+The first update of a key opens a group and becomes its leader, the updates of the key arrived
+while the leader computes join the group. The members compute one by one, each of them is given
+the row written by the member before it, so only the first one reads the row from kvstore. Once
+all members joined have computed, or the window expires, the leader commits the batches of all
+members as one batch, and every member gets the code of it. So a leader alone commits at once,
+and the window only bounds how long a busy group keeps taking members. The next group of the key
+is opened after the commit, so it always reads the row committed.
+
+If the leader fails to compute (e.g. conflict or filtered out), nothing has been written by it,
+the group is closed at once and the members waiting retry in a new group.
+
+The updates of different keys could be combined in the same group too, e.g. all updates of a
+part, see update_combine_by_part, then the batches of the part arrived within the window are
+committed as one raft log. Each member is given the row written by the member of the same key
+before it in the group, the first member of each key reads it from kvstore. A leader failing
+then still commits the batches of the others.
+*/
+template <typename Key>
+class UpdateCombiner final {
+public:
+    using KV = std::pair<std::string, std::string>;
+    // Compute the batch and the row written of the key, pending is the row written by the
+    // members of the key before, nullptr if it should be read from kvstore. first is true if
+    // the caller is the first member of the key in the group, which should lock the key.
+    using ComputeFunc = std::function<nebula::cpp2::ErrorCode(bool first,
+                                                              const KV* pending,
+                                                              std::string* batch,
+                                                              KV* row)>;
+    using CommitFunc = std::function<nebula::cpp2::ErrorCode(std::string&& batch)>;
+
+    explicit UpdateCombiner(int32_t windowUs)
+        : windowUs_(windowUs) {}
+
+    nebula::cpp2::ErrorCode combine(const Key& key, ComputeFunc compute, CommitFunc commit) {
+        return combine(key, key, std::move(compute), std::move(commit));
+    }
+
+    // Combine the update of the key into the group of groupKey
+    nebula::cpp2::ErrorCode combine(const Key& groupKey,
+                                    const Key& key,
+                                    ComputeFunc compute,
+                                    CommitFunc commit) {
+        while (true) {
+            bool leader = false;
+            std::shared_ptr<Group> group;
+            std::unique_lock<std::mutex> g;
+            {
+                std::unique_lock<std::mutex> lg(lock_);
+                cond_.wait(lg, [&] {
+                    auto it = groups_.find(groupKey);
+                    return it == groups_.end() || !it->second->closed;
+                });
+                auto it = groups_.find(groupKey);
+                if (it == groups_.end()) {
+                    group = std::make_shared<Group>();
+                    groups_.emplace(groupKey, group);
+                    leader = true;
+                    // the leader always computes first
+                    g = std::unique_lock<std::mutex>(group->lock);
+                } else {
+                    group = it->second;
+                    group->joined.fetch_add(1, std::memory_order_release);
+                }
+            }
+
+            if (!leader) {
+                g = std::unique_lock<std::mutex>(group->lock);
+            }
+            if (group->closed) {
+                // the leader failed before we get the group, try the next group
+                continue;
+            }
+            std::string batch;
+            KV row;
+            auto pending = group->rows.find(key);
+            bool first = pending == group->rows.end();
+            auto code = compute(first, first ? nullptr : &pending->second, &batch, &row);
+            if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                for (auto& op : kvstore::decodeBatchValue(batch)) {
+                    group->ops.emplace_back(op.first, op.second.first.str(),
+                                            op.second.second.str());
+                }
+                group->rows[key] = std::move(row);
+            }
+            if (!leader) {
+                ++group->computed;
+                group->cond.notify_all();
+                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    return code;
+                }
+                group->cond.wait(g, [&] { return group->done; });
+                return group->code;
+            }
+
+            if (code != nebula::cpp2::ErrorCode::SUCCEEDED && groupKey == key) {
+                finish(groupKey, group, std::move(g), code);
+                return code;
+            }
+            // wait for the members joined to compute, there is nothing to wait when alone
+            group->cond.wait_for(g, std::chrono::microseconds(windowUs_), [&] {
+                return group->computed == group->joined.load(std::memory_order_acquire);
+            });
+            g.unlock();
+            {
+                std::lock_guard<std::mutex> lg(lock_);
+                g.lock();
+                group->closed = true;
+            }
+            bool empty = group->ops.empty();
+            kvstore::BatchHolder bat;
+            for (auto& op : group->ops) {
+                if (std::get<0>(op) == kvstore::BatchLogType::OP_BATCH_PUT) {
+                    bat.put(std::move(std::get<1>(op)), std::move(std::get<2>(op)));
+                } else if (std::get<0>(op) == kvstore::BatchLogType::OP_BATCH_REMOVE) {
+                    bat.remove(std::move(std::get<1>(op)));
+                } else if (std::get<0>(op) == kvstore::BatchLogType::OP_BATCH_MERGE) {
+                    bat.merge(std::move(std::get<1>(op)), std::move(std::get<2>(op)));
+                } else {
+                    bat.rangeRemove(std::move(std::get<1>(op)), std::move(std::get<2>(op)));
+                }
+            }
+            g.unlock();
+            auto committed = empty ? nebula::cpp2::ErrorCode::SUCCEEDED
+                                   : commit(kvstore::encodeBatchValue(bat.getBatch()));
+            finish(groupKey, group, std::unique_lock<std::mutex>(group->lock), committed);
+            return code == nebula::cpp2::ErrorCode::SUCCEEDED ? committed : code;
+        }
+    }
+
+private:
+    struct Group {
+        // held by the member computing
+        std::mutex lock;
+        std::condition_variable cond;
+        bool closed{false};
+        bool done{false};
+        // the members joined, and the ones of them have computed
+        std::atomic<int32_t> joined{0};
+        int32_t computed{0};
+        nebula::cpp2::ErrorCode code{nebula::cpp2::ErrorCode::SUCCEEDED};
+        // the row written last of each key
+        std::unordered_map<Key, KV> rows;
+        std::vector<std::tuple<kvstore::BatchLogType, std::string, std::string>> ops;
+    };
+
+    // Wake up the members of the group, and let the next group of the key open
+    void finish(const Key& key,
+                std::shared_ptr<Group> group,
+                std::unique_lock<std::mutex> g,
+                nebula::cpp2::ErrorCode code) {
+        group->closed = true;
+        group->done = true;
+        group->code = code;
+        g.unlock();
+        group->cond.notify_all();
+        {
+            std::lock_guard<std::mutex> lg(lock_);
+            groups_.erase(key);
+        }
+        cond_.notify_all();
+    }
+
+    int32_t                                         windowUs_;
+    std::mutex                                      lock_;
+    std::condition_variable                         cond_;
+    std::unordered_map<Key, std::shared_ptr<Group>> groups_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_UPDATECOMBINER_H_
@@ -0,0 +1,208 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/VertexCache.h"
+#include <folly/Bits.h>
+
+namespace nebula {
+namespace storage {
+
+// the minimum capacity of a shard when the shards number is decided automatically
+static constexpr size_t kMinShardCapacity = 4 * 1024 * 1024;
+// estimated size of an entry, which is used to decide the width of frequency sketch
+static constexpr size_t kEstimatedEntrySize = 256;
+static constexpr size_t kMaxSketchWidth = 1 << 24;
+
+FrequencySketch::FrequencySketch(size_t width) {
+    width = folly::nextPowTwo(std::max<size_t>(width, 64));
+    width = std::min(width, kMaxSketchWidth);
+    table_.resize(width * kDepth, 0);
+    mask_ = width - 1;
+    sampleSize_ = width * 10;
+}
+
+size_t FrequencySketch::index(uint64_t hash, size_t row) const {
+    static constexpr uint64_t kSeeds[kDepth] = {
+        0xc3a5c85c97cb3127ULL, 0xb492b66fbe98f273ULL,
+        0x9ae16a3b2f90404fULL, 0xcbf29ce484222325ULL};
+    uint64_t h = (hash + kSeeds[row]) * kSeeds[row];
+    h ^= h >> 32;
+    return row * (mask_ + 1) + (h & mask_);
+}
+
+void FrequencySketch::increment(uint64_t hash) {
+    bool added = false;
+    for (size_t row = 0; row < kDepth; row++) {
+        auto& counter = table_[index(hash, row)];
+        if (counter < kMaxCount) {
+            counter++;
+            added = true;
+        }
+    }
+    if (added && ++additions_ >= sampleSize_) {
+        age();
+    }
+}
+
+uint8_t FrequencySketch::estimate(uint64_t hash) const {
+    uint8_t freq = kMaxCount;
+    for (size_t row = 0; row < kDepth; row++) {
+        freq = std::min(freq, table_[index(hash, row)]);
+    }
+    return freq;
+}
+
+void FrequencySketch::age() {
+    for (auto& counter : table_) {
+        counter >>= 1;
+    }
+    additions_ /= 2;
+}
+
+VertexCache::VertexCache(size_t capacity, int32_t shardsExp) {
+    size_t shardsNum = 1;
+    if (shardsExp >= 0) {
+        shardsNum = 1UL << std::min(shardsExp, 16);
+    } else {
+        // about 4 shards each core to reduce the lock contention, but not too small
+        size_t cores = std::max(std::thread::hardware_concurrency(), 1U);
+        shardsNum = folly::nextPowTwo(cores * 4);
+        while (shardsNum > 1 && capacity / shardsNum < kMinShardCapacity) {
+            shardsNum >>= 1;
+        }
+    }
+    auto shardCapacity = capacity / shardsNum;
+    LOG(INFO) << "Vertex cache capacity " << capacity << " bytes, " << shardsNum << " shards";
+    shards_.reserve(shardsNum);
+    for (size_t i = 0; i < shardsNum; i++) {
+        shards_.emplace_back(
+            std::make_unique<Shard>(shardCapacity, shardCapacity / kEstimatedEntrySize));
+    }
+}
+
+StatusOr<std::string> VertexCache::get(const Key& key) {
+    return lookup(key, true);
+}
+
+StatusOr<std::string> VertexCache::peek(const Key& key) {
+    return lookup(key, false);
+}
+
+StatusOr<std::string> VertexCache::lookup(const Key& key, bool promote) {
+    auto hash = KeyHash()(key);
+    auto& s = shard(hash);
+    std::lock_guard<std::mutex> guard(s.lock_);
+    if (promote) {
+        s.sketch_.increment(hash);
+    }
+    auto it = s.index_.find(key);
+    if (it == s.index_.end()) {
+        s.stats_.misses_++;
+        return Status::Error("Not found");
+    }
+    s.stats_.hits_++;
+    if (promote) {
+        s.lru_.splice(s.lru_.begin(), s.lru_, it->second);
+    }
+    return it->second->value_;
+}
+
+void VertexCache::insert(const Key& key, std::string value) {
+    auto hash = KeyHash()(key);
+    auto& s = shard(hash);
+    auto size = charge(key, value);
+    std::lock_guard<std::mutex> guard(s.lock_);
+    s.sketch_.increment(hash);
+
+    auto it = s.index_.find(key);
+    if (it != s.index_.end()) {
+        // replace the value in place, the key has been admitted already
+        auto& entry = *it->second;
+        s.usage_ = s.usage_ - entry.charge_ + size;
+        entry.value_ = std::move(value);
+        entry.charge_ = size;
+        s.lru_.splice(s.lru_.begin(), s.lru_, it->second);
+    } else {
+        if (size > s.capacity_) {
+            s.stats_.rejects_++;
+            return;
+        }
+        // The candidate must be more frequent than every entry it replaces
+        auto freq = s.sketch_.estimate(hash);
+        size_t freed = 0;
+        auto victim = s.lru_.rbegin();
+        for (; s.usage_ - freed + size > s.capacity_ && victim != s.lru_.rend(); ++victim) {
+            if (freq <= s.sketch_.estimate(KeyHash()(victim->key_))) {
+                s.stats_.rejects_++;
+                return;
+            }
+            freed += victim->charge_;
+        }
+        s.lru_.emplace_front(Entry{key, std::move(value), size});
+        s.index_.emplace(key, s.lru_.begin());
+        s.usage_ += size;
+    }
+
+    while (s.usage_ > s.capacity_ && s.lru_.size() > 1) {
+        auto& last = s.lru_.back();
+        s.usage_ -= last.charge_;
+        s.index_.erase(last.key_);
+        s.lru_.pop_back();
+        s.stats_.lruEvicts_++;
+    }
+}
+
+void VertexCache::evict(const Key& key) {
+    auto hash = KeyHash()(key);
+    auto& s = shard(hash);
+    std::lock_guard<std::mutex> guard(s.lock_);
+    auto it = s.index_.find(key);
+    if (it == s.index_.end()) {
+        return;
+    }
+    s.usage_ -= it->second->charge_;
+    s.lru_.erase(it->second);
+    s.index_.erase(it);
+    s.stats_.evicts_++;
+}
+
+VertexCache::ShardStats VertexCache::shardStats(size_t idx) const {
+    CHECK_LT(idx, shards_.size());
+    auto& s = *shards_[idx];
+    std::lock_guard<std::mutex> guard(s.lock_);
+    auto stats = s.stats_;
+    stats.entries_ = s.lru_.size();
+    stats.bytes_ = s.usage_;
+    return stats;
+}
+
+uint64_t VertexCache::hits() const {
+    uint64_t hits = 0;
+    for (size_t i = 0; i < shards_.size(); i++) {
+        hits += shardStats(i).hits_;
+    }
+    return hits;
+}
+
+uint64_t VertexCache::evicts() const {
+    uint64_t evicts = 0;
+    for (size_t i = 0; i < shards_.size(); i++) {
+        evicts += shardStats(i).evicts_;
+    }
+    return evicts;
+}
+
+uint64_t VertexCache::total() const {
+    uint64_t total = 0;
+    for (size_t i = 0; i < shards_.size(); i++) {
+        auto stats = shardStats(i);
+        total += stats.hits_ + stats.misses_;
+    }
+    return total;
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,144 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_VERTEXCACHE_H_
+#define STORAGE_VERTEXCACHE_H_
+
+#include "common/base/Base.h"
+#include "common/base/StatusOr.h"
+#include "common/thrift/ThriftTypes.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+FrequencySketch is a count-min sketch with 4 rows of 4 bit counters, which estimates how often
+a key has been accessed recently. All counters are halved when the number of increments reaches
+10 times of the width, so the frequency of keys not accessed any more decays.
+It is not thread safe, VertexCache protects it by the shard lock.
+*/
+class FrequencySketch final {
+public:
+    explicit FrequencySketch(size_t width);
+
+    void increment(uint64_t hash);
+
+    uint8_t estimate(uint64_t hash) const;
+
+private:
+    static constexpr size_t kDepth = 4;
+    static constexpr uint8_t kMaxCount = 15;
+
+    size_t index(uint64_t hash, size_t row) const;
+
+    void age();
+
+    std::vector<uint8_t>        table_;
+    size_t                      mask_;
+    size_t                      additions_ = 0;
+    size_t                      sampleSize_;
+};
+
+/*
+VertexCache is a sharded LRU cache of encoded tag rows, keyed by (vId, tagId).
+
+The capacity is in bytes, each entry is charged by the size of its key and value plus a fixed
+overhead. When a shard is full, a new entry is admitted only if it is accessed more frequently
+than the entries it would evict (TinyLFU), so that a one-off scan won't flush the hot vertices.
+
+The hit/miss/evict counters are kept for each shard, see `shardStats`.
+*/
+class VertexCache final {
+public:
+    using Key = std::pair<VertexID, TagID>;
+
+    struct ShardStats {
+        uint64_t hits_{0};
+        uint64_t misses_{0};
+        // evicted explicitly, e.g. by writes of the vertex
+        uint64_t evicts_{0};
+        // evicted because the shard is full
+        uint64_t lruEvicts_{0};
+        // not admitted because the shard is full and the key is not frequent enough
+        uint64_t rejects_{0};
+        uint64_t entries_{0};
+        uint64_t bytes_{0};
+    };
+
+    // capacity is the total bytes of all shards, there are (1 << shardsExp) shards,
+    // if shardsExp is negative, the shards number is decided by capacity and cpu cores
+    explicit VertexCache(size_t capacity, int32_t shardsExp = -1);
+
+    // Get the value and make it the most recently used one
+    StatusOr<std::string> get(const Key& key);
+
+    // Get the value without touching the lru list and frequency, used by scans
+    StatusOr<std::string> peek(const Key& key);
+
+    void insert(const Key& key, std::string value);
+
+    void evict(const Key& key);
+
+    size_t shardsNum() const {
+        return shards_.size();
+    }
+
+    ShardStats shardStats(size_t idx) const;
+
+    // sum of all shards
+    uint64_t hits() const;
+
+    uint64_t evicts() const;
+
+    uint64_t total() const;
+
+private:
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return std::hash<std::string>()(key.first) ^
+                   (static_cast<uint64_t>(key.second) * 0x9E3779B97F4A7C15ULL);
+        }
+    };
+
+    struct Entry {
+        Key             key_;
+        std::string     value_;
+        size_t          charge_;
+    };
+
+    struct Shard {
+        Shard(size_t capacity, size_t sketchWidth)
+            : capacity_(capacity), sketch_(sketchWidth) {}
+
+        std::mutex                                          lock_;
+        // the front is the most recently used one
+        std::list<Entry>                                    lru_;
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index_;
+        size_t                                              capacity_;
+        size_t                                              usage_ = 0;
+        FrequencySketch                                     sketch_;
+        ShardStats                                          stats_;
+    };
+
+    static size_t charge(const Key& key, const std::string& value) {
+        // the list node, hash node and the string headers
+        constexpr size_t kOverhead = 96;
+        return key.first.size() + value.size() + kOverhead;
+    }
+
+    Shard& shard(size_t hash) {
+        return *shards_[(hash >> 32) & (shards_.size() - 1)];
+    }
+
+    StatusOr<std::string> lookup(const Key& key, bool promote);
+
+    std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_VERTEXCACHE_H_
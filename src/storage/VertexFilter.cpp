@@ -0,0 +1,225 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/VertexFilter.h"
+#include "utils/NebulaKeyUtils.h"
+#include <folly/hash/SpookyHashV2.h>
+#include <thrift/lib/cpp/util/EnumUtils.h>
+
+namespace nebula {
+namespace storage {
+
+VertexFilter::Bloom::Bloom(size_t keys, int32_t bitsPerKey)
+    : capacity_(keys)
+    , blocks_(std::max<size_t>(1, keys * bitsPerKey / (kWordsPerBlock * 64)))
+    , words_(blocks_ * kWordsPerBlock) {}
+
+bool VertexFilter::Bloom::add(uint64_t hash) {
+    auto* block = &words_[(hash >> 32) % blocks_ * kWordsPerBlock];
+    uint32_t h = hash;
+    for (size_t i = 0; i < kWordsPerBlock; i++) {
+        // one of the 64 bits of each word, by the 6 bits of h rotated
+        h = h * 0x9E3779B1U + i;
+        block[i].fetch_or(1ULL << (h >> 26), std::memory_order_relaxed);
+    }
+    return added_.fetch_add(1, std::memory_order_relaxed) < capacity_;
+}
+
+bool VertexFilter::Bloom::mayContain(uint64_t hash) const {
+    const auto* block = &words_[(hash >> 32) % blocks_ * kWordsPerBlock];
+    uint32_t h = hash;
+    for (size_t i = 0; i < kWordsPerBlock; i++) {
+        h = h * 0x9E3779B1U + i;
+        if ((block[i].load(std::memory_order_relaxed) & (1ULL << (h >> 26))) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+VertexFilter::VertexFilter(meta::SchemaManager* schemaMan, int32_t bitsPerKey)
+    : schemaMan_(schemaMan)
+    , bitsPerKey_(std::max(bitsPerKey, 1)) {}
+
+VertexFilter::~VertexFilter() {
+    stop();
+}
+
+bool VertexFilter::start() {
+    worker_ = std::make_unique<thread::GenericWorker>();
+    return worker_->start("vertex-filter");
+}
+
+void VertexFilter::stop() {
+    if (worker_ != nullptr) {
+        worker_->stop();
+        worker_->wait();
+        worker_.reset();
+    }
+}
+
+// static
+uint64_t VertexFilter::hashOf(folly::StringPiece vId) {
+    auto size = vId.size();
+    while (size > 0 && vId[size - 1] == '\0') {
+        size--;
+    }
+    return folly::hash::SpookyHashV2::Hash64(vId.data(), size, 0);
+}
+
+std::shared_ptr<VertexFilter::PartFilter>
+VertexFilter::filterOf(GraphSpaceID spaceId, PartitionID partId) const {
+    auto it = parts_.find(std::make_pair(spaceId, partId));
+    if (it == parts_.cend()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+bool VertexFilter::ready(GraphSpaceID spaceId, PartitionID partId) const {
+    auto filter = filterOf(spaceId, partId);
+    return filter != nullptr && filter->ready_.load(std::memory_order_acquire);
+}
+
+bool VertexFilter::mayExist(GraphSpaceID spaceId, PartitionID partId, folly::StringPiece vId) {
+    auto filter = filterOf(spaceId, partId);
+    if (filter != nullptr) {
+        if (!filter->ready_.load(std::memory_order_acquire)) {
+            return true;
+        }
+        return filter->bloom_->mayContain(hashOf(vId));
+    }
+    if (kvstore_ == nullptr || worker_ == nullptr) {
+        return true;
+    }
+    auto vIdLen = schemaMan_->getSpaceVidLen(spaceId);
+    if (!vIdLen.ok()) {
+        return true;
+    }
+    auto key = std::make_pair(spaceId, partId);
+    // the commits from now on are kept in pending, so none is missed by the scan
+    if (parts_.insert(key, std::make_shared<PartFilter>(vIdLen.value())).second) {
+        worker_->addTask(&VertexFilter::build, this, spaceId, partId);
+    }
+    return true;
+}
+
+void VertexFilter::build(GraphSpaceID spaceId, PartitionID partId) {
+    auto key = std::make_pair(spaceId, partId);
+    auto filter = filterOf(spaceId, partId);
+    if (filter == nullptr) {
+        auto vIdLen = schemaMan_->getSpaceVidLen(spaceId);
+        if (!vIdLen.ok()) {
+            return;
+        }
+        filter = parts_.insert(key, std::make_shared<PartFilter>(vIdLen.value()))
+                       .first->second;
+    }
+    if (filter->ready_.load(std::memory_order_acquire)) {
+        return;
+    }
+
+    std::vector<uint64_t> hashes;
+    for (const auto& prefix : {NebulaKeyUtils::vertexPrefix(partId),
+                               NebulaKeyUtils::edgePrefix(partId)}) {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto code = kvstore_->prefix(spaceId, partId, prefix, &iter, true,
+                                     kvstore::ScanHint::kFullScan);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(WARNING) << "Build the vertex filter of space " << spaceId << " part " << partId
+                         << " failed: " << apache::thrift::util::enumNameSafe(code);
+            drop(key, filter);
+            return;
+        }
+        // the edges of a vertex are adjacent, only the first one is hashed
+        std::string last;
+        for (; iter->valid(); iter->next()) {
+            auto vId = iter->key().subpiece(sizeof(PartitionID), filter->vIdLen_);
+            if (vId == last) {
+                continue;
+            }
+            last = vId.str();
+            hashes.emplace_back(hashOf(vId));
+        }
+    }
+
+    // there is room for as many vertices added, then it is built again
+    std::lock_guard<std::mutex> g(filter->lock_);
+    auto bloom = std::make_unique<Bloom>(std::max(hashes.size(), kMinKeys) * 2, bitsPerKey_);
+    for (auto hash : hashes) {
+        bloom->add(hash);
+    }
+    for (auto hash : filter->pending_) {
+        bloom->add(hash);
+    }
+    filter->pending_.clear();
+    filter->bloom_ = std::move(bloom);
+    filter->ready_.store(true, std::memory_order_release);
+    VLOG(1) << "The vertex filter of space " << spaceId << " part " << partId
+            << " is built with " << hashes.size() << " vertices";
+}
+
+void VertexFilter::onCommit(GraphSpaceID spaceId,
+                            PartitionID partId,
+                            const std::vector<std::string>& keys) {
+    auto filter = filterOf(spaceId, partId);
+    if (filter == nullptr) {
+        // not built yet, the keys are read by the scan when it is
+        return;
+    }
+    auto vIdLen = filter->vIdLen_;
+    std::vector<uint64_t> hashes;
+    hashes.reserve(keys.size());
+    for (const auto& key : keys) {
+        if (NebulaKeyUtils::isVertex(vIdLen, key) ||
+            NebulaKeyUtils::isEdge(vIdLen, key) ||
+            NebulaKeyUtils::isLock(vIdLen, key)) {
+            hashes.emplace_back(hashOf(folly::StringPiece(key).subpiece(sizeof(PartitionID),
+                                                                        vIdLen)));
+        }
+    }
+    if (hashes.empty()) {
+        return;
+    }
+    if (!filter->ready_.load(std::memory_order_acquire)) {
+        std::lock_guard<std::mutex> g(filter->lock_);
+        if (!filter->ready_.load(std::memory_order_acquire)) {
+            filter->pending_.insert(filter->pending_.end(), hashes.begin(), hashes.end());
+            return;
+        }
+    }
+    bool full = false;
+    for (auto hash : hashes) {
+        full |= !filter->bloom_->add(hash);
+    }
+    if (full && worker_ != nullptr) {
+        // the false positive gets higher, the next lookup builds it again with more room
+        drop(std::make_pair(spaceId, partId), filter);
+    }
+}
+
+void VertexFilter::onReset(GraphSpaceID spaceId, PartitionID partId) {
+    if (partId != 0) {
+        parts_.erase(std::make_pair(spaceId, partId));
+        return;
+    }
+    std::vector<PartKey> keys;
+    for (const auto& entry : parts_) {
+        if (entry.first.first == spaceId) {
+            keys.emplace_back(entry.first);
+        }
+    }
+    for (const auto& key : keys) {
+        parts_.erase(key);
+    }
+}
+
+void VertexFilter::drop(const PartKey& key, const std::shared_ptr<PartFilter>& filter) {
+    parts_.erase_if_equal(key, filter);
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,117 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_VERTEXFILTER_H_
+#define STORAGE_VERTEXFILTER_H_
+
+#include "common/base/Base.h"
+#include "common/meta/SchemaManager.h"
+#include "common/thread/GenericWorker.h"
+#include "kvstore/CommitObserver.h"
+#include "kvstore/KVStore.h"
+#include <folly/concurrency/ConcurrentHashMap.h>
+
+namespace nebula {
+namespace storage {
+
+/*
+VertexFilter is a blocked bloom filter of the vertices of each part, including the ones with only
+edges, so that TagNode and EdgeNode skip the reads of the vertices not existing at all, which are
+frequent in the expansion of a frontier. A part is built by scanning its vertices and edges on the
+worker when it is looked up for the first time, all vertices are taken as existing until then.
+
+The keys committed into the part by any replica are added by onCommit, so the filter never misses a
+vertex written, the ones deleted are only dropped when the part is built again. The part is built
+again when it is reset by the kvstore, i.e. the compaction, the files ingested or the part removed,
+or when more vertices are added than the filter is sized for.
+
+Each block is a cache line of 8 words, a vertex sets one bit in each word of the block chosen by
+its hash, so a lookup costs one cache miss at most.
+*/
+class VertexFilter final : public kvstore::CommitObserver {
+public:
+    VertexFilter(meta::SchemaManager* schemaMan, int32_t bitsPerKey);
+
+    ~VertexFilter() override;
+
+    bool start();
+
+    void stop();
+
+    // The store scanned when the parts are built, set once the kvstore is created
+    void setStore(kvstore::KVStore* kvstore) {
+        kvstore_ = kvstore;
+    }
+
+    // False only if the vertex has neither tag nor edge in the part
+    bool mayExist(GraphSpaceID spaceId, PartitionID partId, folly::StringPiece vId);
+
+    // Whether the filter of the part is built
+    bool ready(GraphSpaceID spaceId, PartitionID partId) const;
+
+    // Build the filter of the part on this thread, public for the tests
+    void build(GraphSpaceID spaceId, PartitionID partId);
+
+    void onCommit(GraphSpaceID spaceId,
+                  PartitionID partId,
+                  const std::vector<std::string>& keys) override;
+
+    void onReset(GraphSpaceID spaceId, PartitionID partId) override;
+
+private:
+    static constexpr size_t kWordsPerBlock = 8;
+    static constexpr size_t kMinKeys = 1024;
+
+    class Bloom {
+    public:
+        Bloom(size_t keys, int32_t bitsPerKey);
+
+        // Return false once more keys are added than it is sized for
+        bool add(uint64_t hash);
+
+        bool mayContain(uint64_t hash) const;
+
+    private:
+        const size_t                        capacity_;
+        const size_t                        blocks_;
+        std::vector<std::atomic<uint64_t>>  words_;
+        std::atomic<size_t>                 added_{0};
+    };
+
+    struct PartFilter {
+        explicit PartFilter(size_t vIdLen) : vIdLen_(vIdLen) {}
+
+        const size_t                vIdLen_;
+        std::atomic<bool>           ready_{false};
+        std::mutex                  lock_;
+        // the hashes committed while building, added when the bloom is created
+        std::vector<uint64_t>       pending_;
+        std::unique_ptr<Bloom>      bloom_;
+    };
+
+    using PartKey = std::pair<GraphSpaceID, PartitionID>;
+
+    // The hash of the vid in key or request, the padding is trimmed
+    static uint64_t hashOf(folly::StringPiece vId);
+
+    std::shared_ptr<PartFilter> filterOf(GraphSpaceID spaceId, PartitionID partId) const;
+
+    // Drop the filter of the part if it is still the one, it is built again by the next lookup
+    void drop(const PartKey& key, const std::shared_ptr<PartFilter>& filter);
+
+private:
+    meta::SchemaManager*                                        schemaMan_;
+    const int32_t                                               bitsPerKey_;
+    kvstore::KVStore*                                           kvstore_{nullptr};
+    std::unique_ptr<thread::GenericWorker>                      worker_;
+    folly::ConcurrentHashMap<PartKey, std::shared_ptr<PartFilter>, folly::hasher<PartKey>>
+                                                                parts_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_VERTEXFILTER_H_
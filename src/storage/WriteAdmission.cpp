@@ -0,0 +1,121 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/WriteAdmission.h"
+#include "storage/StorageFlags.h"
+
+namespace nebula {
+namespace storage {
+
+namespace {
+
+// Seconds to wait for the tokens in the bucket, without consuming them
+double waitFor(const folly::DynamicTokenBucket& bucket, double tokens, double rate) {
+    if (rate <= 0 || tokens <= 0) {
+        return 0;
+    }
+    auto available = bucket.available(rate, std::max(rate, tokens));
+    return tokens <= available ? 0 : (tokens - available) / rate;
+}
+
+// Consume the tokens, return the seconds to wait for the tokens borrowed
+double consume(folly::DynamicTokenBucket* bucket, double tokens, double rate) {
+    if (rate <= 0 || tokens <= 0) {
+        return 0;
+    }
+    auto wait = bucket->consumeWithBorrowNonBlocking(tokens, rate, std::max(rate, tokens));
+    return wait ? *wait : 0;
+}
+
+}  // namespace
+
+WriteAdmission::WriteAdmission(std::function<double()> stallPressure)
+    : stallPressure_(std::move(stallPressure)) {}
+
+WriteAdmission::~WriteAdmission() {
+    stop();
+}
+
+bool WriteAdmission::start() {
+    if (stallPressure_ == nullptr || FLAGS_write_stall_reject_pressure <= 0) {
+        return true;
+    }
+    worker_ = std::make_unique<thread::GenericWorker>();
+    if (!worker_->start("write-admit")) {
+        return false;
+    }
+    worker_->addRepeatTask(FLAGS_write_stall_check_interval_ms, &WriteAdmission::refresh, this);
+    return true;
+}
+
+void WriteAdmission::stop() {
+    if (worker_ != nullptr) {
+        worker_->stop();
+        worker_->wait();
+        worker_.reset();
+    }
+}
+
+void WriteAdmission::refresh() {
+    auto pressure = stallPressure_();
+    auto last = pressure_.exchange(pressure);
+    if (last < FLAGS_write_stall_reject_pressure && pressure >= FLAGS_write_stall_reject_pressure) {
+        LOG(INFO) << "Write stall pressure " << pressure << ", reject the low priority writes";
+    } else if (last >= FLAGS_write_stall_reject_pressure &&
+               pressure < FLAGS_write_stall_reject_pressure) {
+        LOG(INFO) << "Write stall pressure " << pressure << ", admit the low priority writes";
+    }
+}
+
+WriteAdmission::Quota* WriteAdmission::quota(GraphSpaceID spaceId) {
+    std::lock_guard<std::mutex> g(lock_);
+    auto& quota = quotas_[spaceId];
+    if (quota == nullptr) {
+        quota = std::make_unique<Quota>();
+    }
+    // the quota is never removed, so it could be used out of the lock
+    return quota.get();
+}
+
+nebula::cpp2::ErrorCode WriteAdmission::admit(GraphSpaceID spaceId,
+                                              Priority priority,
+                                              int64_t rows,
+                                              int64_t bytes,
+                                              std::chrono::milliseconds* delay) {
+    *delay = std::chrono::milliseconds(0);
+    if (priority == Priority::LOW && FLAGS_write_stall_reject_pressure > 0 &&
+        pressure_ >= FLAGS_write_stall_reject_pressure) {
+        VLOG(1) << "Reject the write of space " << spaceId << " for write stall";
+        return nebula::cpp2::ErrorCode::E_BUFFER_OVERFLOW;
+    }
+    double rowsRate = FLAGS_write_quota_rows_per_sec;
+    double bytesRate = FLAGS_write_quota_bytes_per_sec;
+    if (rowsRate <= 0 && bytesRate <= 0) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    auto* spaceQuota = quota(spaceId);
+    if (priority == Priority::LOW) {
+        // check before consuming, the tokens are not taken by the writes rejected
+        double maxWait = FLAGS_write_admission_max_delay_ms / 1000.0;
+        if (waitFor(spaceQuota->rows, rows, rowsRate) > maxWait ||
+            waitFor(spaceQuota->bytes, bytes, bytesRate) > maxWait) {
+            VLOG(1) << "Reject the write of space " << spaceId << " over the quota";
+            return nebula::cpp2::ErrorCode::E_BUFFER_OVERFLOW;
+        }
+    }
+    auto wait = std::max(consume(&spaceQuota->rows, rows, rowsRate),
+                         consume(&spaceQuota->bytes, bytes, bytesRate));
+    if (priority == Priority::LOW) {
+        // the tokens borrowed by the concurrent writes are not seen by the check above
+        wait = std::min(wait, FLAGS_write_admission_max_delay_ms / 1000.0);
+        *delay = std::chrono::milliseconds(static_cast<int64_t>(wait * 1000));
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+}  // namespace storage
+}  // namespace nebula
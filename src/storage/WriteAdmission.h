@@ -0,0 +1,83 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_WRITEADMISSION_H_
+#define STORAGE_WRITEADMISSION_H_
+
+#include "common/base/Base.h"
+#include "common/thread/GenericWorker.h"
+#include <folly/TokenBucket.h>
+
+namespace nebula {
+namespace storage {
+
+/*
+WriteAdmission pushes back the writers before one space saturates the workers and stalls
+rocksdb for every space on the host, which is checked by GraphStorageServiceHandler before a
+write is processed:
+
+1. Each space has a quota of write_quota_rows_per_sec rows and write_quota_bytes_per_sec bytes.
+   A low priority write over the quota is delayed until the tokens are refilled, or rejected
+   with E_BUFFER_OVERFLOW if it would wait longer than write_admission_max_delay_ms. A high
+   priority write consumes the tokens as well but is never delayed, so the low priority writers
+   of the space are slowed first.
+2. The write stall pressure of the engines is refreshed every write_stall_check_interval_ms.
+   Once it reaches write_stall_reject_pressure, the low priority writes of all spaces are
+   rejected, since the engines share the disks and workers of the host.
+
+The inserts are low priority, which is what the bulk loads send, the deletes are high priority.
+The client retries the writes rejected like the ones rejected by raft for buffer overflow.
+*/
+class WriteAdmission final {
+public:
+    enum class Priority {
+        HIGH,
+        LOW,
+    };
+
+    // stallPressure returns the write stall pressure of the engines, 1.0 means rocksdb is
+    // slowing down the writes
+    explicit WriteAdmission(std::function<double()> stallPressure);
+
+    ~WriteAdmission();
+
+    bool start();
+
+    void stop();
+
+    // Return E_BUFFER_OVERFLOW if the write is rejected, otherwise how long it should be delayed
+    // is returned by delay
+    nebula::cpp2::ErrorCode admit(GraphSpaceID spaceId,
+                                  Priority priority,
+                                  int64_t rows,
+                                  int64_t bytes,
+                                  std::chrono::milliseconds* delay);
+
+    double stallPressure() const {
+        return pressure_;
+    }
+
+private:
+    struct Quota {
+        folly::DynamicTokenBucket    rows;
+        folly::DynamicTokenBucket    bytes;
+    };
+
+    Quota* quota(GraphSpaceID spaceId);
+
+    void refresh();
+
+private:
+    std::function<double()>                                 stallPressure_;
+    std::unique_ptr<thread::GenericWorker>                  worker_;
+    std::atomic<double>                                     pressure_{0};
+    std::mutex                                              lock_;
+    std::unordered_map<GraphSpaceID, std::unique_ptr<Quota>> quotas_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // STORAGE_WRITEADMISSION_H_
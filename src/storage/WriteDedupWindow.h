@@ -0,0 +1,65 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_WRITEDEDUPWINDOW_H_
+#define STORAGE_WRITEDEDUPWINDOW_H_
+
+#include "common/base/Base.h"
+#include "common/time/WallClock.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+WriteDedupWindow tells whether a write resent by the client after E_LEADER_CHANGED or a timeout
+has been applied already, so that it is acknowledged without being encoded, replicated and indexed
+again.
+
+Only the writes carrying a write id in the kWriteIdHeader of the request are deduped, the client
+sends the same id with each retry of a write and a new one for each new write, so the identical
+writes sent on purpose are always applied. Each part records an applied id in its own system
+dedup key, which is written in the same batch as the write, so it is replicated with the data and
+seen by a new leader too. The value of the key is the time it was applied, the id is taken as
+applied within ttlSecs of it, and the key is dropped by the compaction once expired.
+*/
+class WriteDedupWindow final {
+public:
+    // The header of the request holding the write id
+    static constexpr const char* kWriteIdHeader = "nebula-write-id";
+    // The longer write ids are ignored, they are stored in the keys
+    static constexpr size_t kMaxWriteIdLen = 64;
+
+    explicit WriteDedupWindow(int64_t ttlSecs)
+        : ttlSecs_(ttlSecs) {}
+
+    // The value of the dedup key written with the write
+    static std::string encode() {
+        int64_t now = time::WallClock::fastNowInSec();
+        return std::string(reinterpret_cast<const char*>(&now), sizeof(int64_t));
+    }
+
+    // Whether the value read from the dedup key is within the window
+    bool applied(folly::StringPiece val) const {
+        return !expired(val, ttlSecs_);
+    }
+
+    static bool expired(folly::StringPiece val, int64_t ttlSecs) {
+        if (val.size() != sizeof(int64_t)) {
+            return true;
+        }
+        int64_t appliedAt = 0;
+        memcpy(&appliedAt, val.data(), sizeof(int64_t));
+        return appliedAt + ttlSecs <= time::WallClock::fastNowInSec();
+    }
+
+private:
+    int64_t ttlSecs_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_WRITEDEDUPWINDOW_H_
@@ -62,6 +62,30 @@ public:
             return;
         }
 
+        auto* warmer = env_->hotVertexWarmer_;
+        if (warmer != nullptr) {
+            // the hot vertices are warmed by the target once the log reaches it, before it is
+            // elected
+            warmer->persist(spaceId, partId, [this, part, host] (nebula::cpp2::ErrorCode code) {
+                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    LOG(WARNING) << "Write the hot vertices of space " << part->spaceId()
+                                 << " part " << part->partitionId() << " failed, error: "
+                                 << static_cast<int32_t>(code);
+                }
+                // the leader is not transferred on the thread committing the log
+                folly::via(folly::getIOExecutor().get(), [this, part, host] {
+                    transferLeader(part, host);
+                });
+            });
+            return;
+        }
+        transferLeader(part, host);
+    }
+
+private:
+    void transferLeader(std::shared_ptr<kvstore::Part> part, const HostAddr& host) {
+        auto spaceId = part->spaceId();
+        auto partId = part->partitionId();
         part->asyncTransferLeader(host,
                                   [this, spaceId, partId, part] (nebula::cpp2::ErrorCode code) {
             if (code == nebula::cpp2::ErrorCode::E_LEADER_CHANGED) {
@@ -115,7 +139,6 @@ public:
         });
     }
 
-private:
     explicit TransLeaderProcessor(StorageEnv* env)
         : BaseProcessor<cpp2::AdminExecResp>(env) {}
 };
@@ -19,6 +19,20 @@ std::shared_ptr<AdminTask>
 AdminTaskFactory::createAdminTask(StorageEnv* env, TaskContext&& ctx) {
     FLOG_INFO("%s (%d, %d)", __func__, ctx.jobId_, ctx.taskId_);
     std::shared_ptr<AdminTask> ret;
+    // a flush unblocks the writes stalled, the index and statis jobs could wait
+    switch (ctx.cmd_) {
+    case meta::cpp2::AdminCmd::FLUSH:
+        ctx.pri_ = TaskPriority::HI;
+        break;
+    case meta::cpp2::AdminCmd::REBUILD_TAG_INDEX:
+    case meta::cpp2::AdminCmd::REBUILD_EDGE_INDEX:
+    case meta::cpp2::AdminCmd::REBUILD_FULLTEXT_INDEX:
+    case meta::cpp2::AdminCmd::STATS:
+        ctx.pri_ = TaskPriority::LO;
+        break;
+    default:
+        break;
+    }
     switch (ctx.cmd_) {
     case meta::cpp2::AdminCmd::COMPACT:
         ret = std::make_shared<CompactTask>(env, std::move(ctx));
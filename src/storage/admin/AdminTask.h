@@ -40,6 +40,14 @@ enum class TaskPriority : int8_t {
     HI
 };
 
+// The resource mostly used by the subtasks of a task, AdminTaskManager limits the number of
+// subtasks running of each class besides CPU
+enum class ResourceClass : int8_t {
+    CPU,
+    IO,
+    RAFT_WRITE,
+};
+
 struct TaskContext {
     using CallBack = std::function<void(nebula::cpp2::ErrorCode, nebula::meta::cpp2::StatisItem&)>;
 
@@ -84,6 +92,10 @@ public:
         return static_cast<int8_t>(ctx_.pri_);
     }
 
+    virtual ResourceClass resourceClass() const {
+        return ResourceClass::CPU;
+    }
+
     virtual void finish() {
         finish(rc_);
     }
@@ -9,6 +9,12 @@
 
 DEFINE_uint32(max_task_concurrency, 10, "The tasks number could be invoked simultaneously");
 DEFINE_uint32(max_concurrent_subtasks, 10, "The sub tasks could be invoked simultaneously");
+DEFINE_uint32(max_io_subtasks, 0,
+              "The sub tasks of the IO bound tasks (compact, flush, statis) could be invoked "
+              "simultaneously, 0 means only limited by max_concurrent_subtasks");
+DEFINE_uint32(max_raft_write_subtasks, 0,
+              "The sub tasks of the tasks writing through raft (rebuild index) could be invoked "
+              "simultaneously, 0 means only limited by max_concurrent_subtasks");
 
 namespace nebula {
 namespace storage {
@@ -16,6 +22,12 @@ namespace storage {
 bool AdminTaskManager::init() {
     LOG(INFO) << "max concurrenct subtasks: " << FLAGS_max_concurrent_subtasks;
     pool_ = std::make_unique<ThreadPool>(FLAGS_max_concurrent_subtasks);
+    {
+        std::lock_guard<std::mutex> g(lock_);
+        running_.clear();
+        inflight_ = 0;
+        resourceInflight_.fill(0);
+    }
     bgThread_ = std::make_unique<thread::GenericWorker>();
     if (!bgThread_->start()) {
         LOG(ERROR) << "background thread start failed";
@@ -90,6 +102,10 @@ void AdminTaskManager::schedule() {
         folly::Optional<TaskHandle> optTaskHandle{folly::none};
         while (!optTaskHandle && !shutdown_) {
             optTaskHandle = taskQueue_.try_take_for(interval);
+            if (!optTaskHandle) {
+                // resume the subtasks held back when the storage was busy
+                dispatch();
+            }
         }
 
         if (shutdown_) {
@@ -136,24 +152,94 @@ void AdminTaskManager::schedule() {
             continue;
         }
 
-        FLOG_INFO("run task(%d, %d), %zu subtasks in %zu thread",
+        FLOG_INFO("run task(%d, %d), %zu subtasks in %zu thread, priority %d",
                   handle.first, handle.second,
                   task->unFinishedSubTask_.load(),
-                  subTaskConcurrency);
-        for (size_t i = 0; i < subTaskConcurrency; ++i) {
-            pool_->add(std::bind(&AdminTaskManager::runSubTask, this, handle));
+                  subTaskConcurrency,
+                  task->getPriority());
+        {
+            std::lock_guard<std::mutex> g(lock_);
+            Running running;
+            running.task = task;
+            running.resource = task->resourceClass();
+            running.pending = subTasks.size();
+            running.concurrency = subTaskConcurrency;
+            running.weight = 1 << task->getPriority();
+            bool first = true;
+            for (const auto& r : running_) {
+                if (first || r.second.vtime < running.vtime) {
+                    running.vtime = r.second.vtime;
+                    first = false;
+                }
+            }
+            running_.emplace(handle, std::move(running));
         }
+        dispatch();
     }  // end while (!shutdown_)
     LOG(INFO) << "AdminTaskManager::pickTaskThread(~)";
 }
 
-void AdminTaskManager::runSubTask(TaskHandle handle) {
-    auto it = tasks_.find(handle);
-    if (it == tasks_.cend()) {
-        FLOG_INFO("task(%d, %d) runSubTask() exit", handle.first, handle.second);
-        return;
+void AdminTaskManager::setBusyCheck(std::function<bool()> busy) {
+    std::lock_guard<std::mutex> g(lock_);
+    busy_ = std::move(busy);
+}
+
+bool AdminTaskManager::admitted(ResourceClass resource, bool busy) const {
+    size_t limit = 0;
+    switch (resource) {
+        case ResourceClass::CPU:
+            return true;
+        case ResourceClass::IO:
+            limit = FLAGS_max_io_subtasks;
+            break;
+        case ResourceClass::RAFT_WRITE:
+            limit = FLAGS_max_raft_write_subtasks;
+            break;
+    }
+    if (busy) {
+        // keep one running so that the task still makes progress
+        limit = 1;
+    }
+    return limit == 0 || resourceInflight_[static_cast<size_t>(resource)] < limit;
+}
+
+void AdminTaskManager::dispatch() {
+    std::vector<std::pair<TaskHandle, TTask>> started;
+    {
+        std::lock_guard<std::mutex> g(lock_);
+        bool busy = busy_ != nullptr && busy_();
+        while (inflight_ < FLAGS_max_concurrent_subtasks) {
+            // the least virtual time, the higher priority first if the same
+            auto next = running_.end();
+            for (auto it = running_.begin(); it != running_.end(); ++it) {
+                const auto& r = it->second;
+                if (r.pending == 0 || r.inflight >= r.concurrency ||
+                    !admitted(r.resource, busy)) {
+                    continue;
+                }
+                if (next == running_.end() || r.vtime < next->second.vtime ||
+                    (r.vtime == next->second.vtime && r.weight > next->second.weight)) {
+                    next = it;
+                }
+            }
+            if (next == running_.end()) {
+                break;
+            }
+            auto& r = next->second;
+            r.pending--;
+            r.inflight++;
+            r.vtime += 1 / r.weight;
+            inflight_++;
+            resourceInflight_[static_cast<size_t>(r.resource)]++;
+            started.emplace_back(next->first, r.task);
+        }
+    }
+    for (auto& s : started) {
+        pool_->add(std::bind(&AdminTaskManager::runSubTask, this, s.first, std::move(s.second)));
     }
-    auto task = it->second;
+}
+
+void AdminTaskManager::runSubTask(TaskHandle handle, TTask task) {
     std::chrono::milliseconds take_dura{10};
     if (auto subTask = task->subtasks_.try_take_for(take_dura)) {
         if (task->status() == nebula::cpp2::ErrorCode::SUCCEEDED) {
@@ -172,21 +258,34 @@ void AdminTaskManager::runSubTask(TaskHandle handle) {
             }
             task->subTaskFinish(rc);
         }
+    } else {
+        LOG(ERROR) << folly::stringPrintf("task(%d, %d) has no subtask to run",
+                                          handle.first, handle.second);
+        task->subTaskFinish(nebula::cpp2::ErrorCode::E_UNKNOWN);
+    }
 
-        auto unFinishedSubTask = --task->unFinishedSubTask_;
-        FLOG_INFO("subtask of task(%d, %d) finished, unfinished task %zu",
-                  task->getJobId(),
-                  task->getTaskId(),
-                  unFinishedSubTask);
-        if (0 == unFinishedSubTask) {
-            task->finish();
-            tasks_.erase(handle);
-        } else {
-            pool_->add(std::bind(&AdminTaskManager::runSubTask, this, handle));
+    auto unFinishedSubTask = --task->unFinishedSubTask_;
+    FLOG_INFO("subtask of task(%d, %d) finished, unfinished task %zu",
+              task->getJobId(),
+              task->getTaskId(),
+              unFinishedSubTask);
+    {
+        std::lock_guard<std::mutex> g(lock_);
+        auto it = running_.find(handle);
+        if (it != running_.end()) {
+            it->second.inflight--;
+            inflight_--;
+            resourceInflight_[static_cast<size_t>(it->second.resource)]--;
+            if (0 == unFinishedSubTask) {
+                running_.erase(it);
+            }
         }
-    } else {
-        FLOG_INFO("task(%d, %d) runSubTask() exit", handle.first, handle.second);
     }
+    if (0 == unFinishedSubTask) {
+        task->finish();
+        tasks_.erase(handle);
+    }
+    dispatch();
 }
 
 bool AdminTaskManager::isFinished(JobID jobID, TaskID taskID) {
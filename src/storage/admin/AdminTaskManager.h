@@ -19,9 +19,25 @@
 namespace nebula {
 namespace storage {
 
+/*
+AdminTaskManager runs the subtasks of all tasks on a pool of max_concurrent_subtasks threads:
+
+1. The tasks share the threads by weighted fair scheduling. Each task has a virtual time which
+   grows by 1 / weight when a subtask of it is started, the weight is 1, 2 and 4 for the low,
+   middle and high priority. The next subtask is taken from the task with the least virtual time,
+   so a flush is not starved by an index rebuild with thousands of subtasks. A new task starts at
+   the least virtual time of the tasks running, it can not save up the time when it was idle.
+2. The subtasks of the IO and RAFT_WRITE classes are limited by max_io_subtasks and
+   max_raft_write_subtasks. When the busy check (the compaction scheduler) tells the storage is
+   busy with the foreground traffic, only one subtask of each class could run, the others are held
+   back and resumed once the storage is idle.
+
+A subtask is never interrupted, the tasks are preempted at the boundary of subtasks.
+*/
 class AdminTaskManager {
     FRIEND_TEST(TaskManagerTest, happy_path);
     FRIEND_TEST(TaskManagerTest, gen_sub_task_failed);
+    FRIEND_TEST(TaskManagerTest, weighted_fair_schedule);
 
 public:
     using ThreadPool = folly::IOThreadPoolExecutor;
@@ -49,9 +65,29 @@ public:
 
     bool isFinished(JobID jobID, TaskID taskID);
 
+    // busy returns whether the storage is busy with the foreground traffic, nullptr to clear
+    void setBusyCheck(std::function<bool()> busy);
+
 private:
+    // The subtasks of a task not finished yet
+    struct Running {
+        TTask           task;
+        ResourceClass   resource{ResourceClass::CPU};
+        size_t          pending{0};
+        size_t          inflight{0};
+        size_t          concurrency{0};
+        double          weight{1};
+        double          vtime{0};
+    };
+
     void schedule();
-    void runSubTask(TaskHandle handle);
+
+    // Start the subtasks by the weighted fair order until the threads or the limits are used up
+    void dispatch();
+
+    bool admitted(ResourceClass resource, bool busy) const;
+
+    void runSubTask(TaskHandle handle, TTask task);
 
 private:
     bool                                    shutdown_{false};
@@ -59,6 +95,12 @@ private:
     TaskContainer                           tasks_;
     TaskQueue                               taskQueue_;
     std::unique_ptr<thread::GenericWorker>  bgThread_;
+
+    std::mutex                              lock_;
+    std::map<TaskHandle, Running>           running_;
+    size_t                                  inflight_{0};
+    std::array<size_t, 3>                   resourceInflight_{};
+    std::function<bool()>                   busy_;
 };
 
 }  // namespace storage
@@ -6,6 +6,9 @@
 
 #include "storage/admin/CompactTask.h"
 #include "common/base/Logging.h"
+#include "utils/IndexKeyUtils.h"
+#include "utils/NebulaKeyUtils.h"
+#include <folly/String.h>
 
 namespace nebula {
 namespace storage {
@@ -25,16 +28,123 @@ CompactTask::genSubTasks() {
 
     auto space = nebula::value(errOrSpace);
 
+    Scope scope;
+    if (ctx_.parameters_.task_specfic_paras_ref().has_value()) {
+        for (const auto& option : *ctx_.parameters_.task_specfic_paras_ref()) {
+            if (!parseOption(option, &scope)) {
+                LOG(ERROR) << "Invalid compact option: " << option;
+                return nebula::cpp2::ErrorCode::E_INVALID_TASK_PARA;
+            }
+        }
+    }
+    const auto& parts = *ctx_.parameters_.parts_ref();
+    bool byParts = !parts.empty() || scope.ranged();
+    if (!byParts && scope.prefixes.empty()) {
+        if (scope.level < 0) {
+            for (auto& engine : space->engines_) {
+                auto task = std::bind(&CompactTask::subTask, this, engine.get());
+                ret.emplace_back(task);
+            }
+            return ret;
+        }
+        // the level of the whole engine
+        scope.prefixes.emplace_back("");
+    }
+
+    // The prefixes to compact of each engine, the ones of the parts targeted on this host
+    std::unordered_map<kvstore::KVEngine*, std::vector<std::string>> ranges;
     for (auto& engine : space->engines_) {
-        auto task = std::bind(&CompactTask::subTask, this, engine.get());
+        ranges[engine.get()] = scope.prefixes;
+    }
+    if (byParts) {
+        std::unordered_set<PartitionID> targets(parts.begin(), parts.end());
+        for (const auto& part : space->parts_) {
+            if (!targets.empty() && targets.count(part.first) == 0) {
+                continue;
+            }
+            auto& prefixes = ranges[part.second->engine()];
+            for (auto& prefix : scope.prefixesOf(part.first)) {
+                prefixes.emplace_back(std::move(prefix));
+            }
+        }
+    }
+    for (auto& range : ranges) {
+        if (range.second.empty()) {
+            continue;
+        }
+        auto task = std::bind(&CompactTask::subTaskOfRanges, this, range.first,
+                              std::move(range.second), scope.level);
         ret.emplace_back(task);
     }
     return ret;
 }
 
+bool CompactTask::parseOption(const std::string& option, Scope* scope) {
+    auto pos = option.find('=');
+    if (pos == std::string::npos) {
+        return false;
+    }
+    auto name = option.substr(0, pos);
+    auto value = option.substr(pos + 1);
+    try {
+        if (name == "tag") {
+            scope->tags.emplace_back(folly::to<TagID>(value));
+        } else if (name == "edge") {
+            scope->edges.emplace_back(folly::to<EdgeType>(value));
+        } else if (name == "index") {
+            scope->indexes.emplace_back(folly::to<IndexID>(value));
+        } else if (name == "level") {
+            scope->level = folly::to<int32_t>(value);
+        } else if (name == "prefix") {
+            std::string prefix;
+            if (value.empty() || !folly::unhexlify(value, prefix)) {
+                return false;
+            }
+            scope->prefixes.emplace_back(std::move(prefix));
+        } else {
+            return false;
+        }
+    } catch (const folly::ConversionError&) {
+        return false;
+    }
+    return true;
+}
+
+std::vector<std::string> CompactTask::Scope::prefixesOf(PartitionID part) const {
+    std::vector<std::string> result;
+    if (!ranged()) {
+        return NebulaKeyUtils::snapshotPrefix(part);
+    }
+    // the keys of a tag or an edge type are spread over the vertices or edges of the part
+    if (!tags.empty()) {
+        result.emplace_back(NebulaKeyUtils::vertexPrefix(part));
+    }
+    if (!edges.empty()) {
+        result.emplace_back(NebulaKeyUtils::edgePrefix(part));
+    }
+    for (auto index : indexes) {
+        result.emplace_back(IndexKeyUtils::indexPrefix(part, index));
+    }
+    return result;
+}
+
 nebula::cpp2::ErrorCode CompactTask::subTask(kvstore::KVEngine* engine) {
     return engine->compact();
 }
 
+nebula::cpp2::ErrorCode CompactTask::subTaskOfRanges(kvstore::KVEngine* engine,
+                                                     std::vector<std::string> prefixes,
+                                                     int32_t level) {
+    for (const auto& prefix : prefixes) {
+        // the end of the empty prefix is empty, which is the whole engine
+        auto code = engine->compactRange(prefix, NebulaKeyUtils::prefixEnd(prefix), level);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Compact range from " << folly::hexlify(prefix) << " failed";
+            return code;
+        }
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
 }  // namespace storage
 }  // namespace nebula
@@ -22,6 +22,44 @@ public:
     ErrorOr<nebula::cpp2::ErrorCode, std::vector<AdminSubTask>> genSubTasks() override;
 
     nebula::cpp2::ErrorCode subTask(nebula::kvstore::KVEngine* engine);
+
+    // Compact the keys with the prefixes, only the files of the level if it is not negative
+    nebula::cpp2::ErrorCode subTaskOfRanges(nebula::kvstore::KVEngine* engine,
+                                            std::vector<std::string> prefixes,
+                                            int32_t level);
+
+    ResourceClass resourceClass() const override {
+        return ResourceClass::IO;
+    }
+
+private:
+    /*
+    The scope of the compaction, by the options of task_specfic_paras besides the parts:
+        tag=<id>, edge=<type>       the vertices or the edges of the parts, since the keys of a
+                                    tag or an edge type are not continuous
+        index=<id>                  the index of the parts
+        prefix=<hex>                the keys with the prefix in each engine of the space
+        level=<n>                   only the files of level n, compacted into level n + 1
+    The parts are all parts of the space on this host if not given. Without any option or
+    parts, the whole engines are compacted as before.
+    */
+    struct Scope {
+        std::vector<TagID>          tags;
+        std::vector<EdgeType>       edges;
+        std::vector<IndexID>        indexes;
+        std::vector<std::string>    prefixes;
+        int32_t                     level{-1};
+
+        // Whether the keys of some schemas of the parts are targeted
+        bool ranged() const {
+            return !tags.empty() || !edges.empty() || !indexes.empty();
+        }
+
+        // The prefixes of a part targeted, all data of the part if no schema is targeted
+        std::vector<std::string> prefixesOf(PartitionID part) const;
+    };
+
+    static bool parseOption(const std::string& option, Scope* scope);
 };
 
 }  // namespace storage
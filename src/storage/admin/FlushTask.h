@@ -20,6 +20,10 @@ public:
     FlushTask(StorageEnv* env, TaskContext&& ctx) : AdminTask(env, std::move(ctx)) {}
 
     ErrorOr<nebula::cpp2::ErrorCode, std::vector<AdminSubTask>> genSubTasks() override;
+
+    ResourceClass resourceClass() const override {
+        return ResourceClass::IO;
+    }
 };
 
 }  // namespace storage
@@ -22,10 +22,16 @@ RebuildEdgeIndexTask::getIndex(GraphSpaceID space, IndexID index) {
     return env_->indexMan_->getEdgeIndex(space, index);
 }
 
+std::string RebuildEdgeIndexTask::dataPrefix(PartitionID part) {
+    return NebulaKeyUtils::edgePrefix(part);
+}
+
 nebula::cpp2::ErrorCode
 RebuildEdgeIndexTask::buildIndexGlobal(GraphSpaceID space,
                                        PartitionID part,
-                                       const IndexItems& items) {
+                                       const IndexItems& items,
+                                       kvstore::KVIterator* iter,
+                                       const Checkpoint* checkpoint) {
     if (canceled_) {
         LOG(ERROR) << "Rebuild Edge Index is Canceled";
         return nebula::cpp2::ErrorCode::SUCCEEDED;
@@ -43,17 +49,10 @@ RebuildEdgeIndexTask::buildIndexGlobal(GraphSpaceID space,
     }
 
     auto vidSize = vidSizeRet.value();
-    std::unique_ptr<kvstore::KVIterator> iter;
-    const auto& prefix = NebulaKeyUtils::edgePrefix(part);
-    auto ret = env_->kvstore_->prefix(space, part, prefix, &iter);
-    if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
-        LOG(ERROR) << "Processing Part " << part << " Failed";
-        return ret;
-    }
-
     VertexID currentSrcVertex = "";
     VertexID currentDstVertex = "";
     EdgeRanking currentRanking = 0;
+    std::string lastKey;
     std::vector<kvstore::KV> data;
     data.reserve(FLAGS_rebuild_index_batch_num);
     RowReaderWrapper reader;
@@ -64,6 +63,9 @@ RebuildEdgeIndexTask::buildIndexGlobal(GraphSpaceID space,
         }
 
         if (static_cast<int32_t>(data.size()) == FLAGS_rebuild_index_batch_num) {
+            if (checkpoint != nullptr && !lastKey.empty()) {
+                checkpoint->append(&data, lastKey, false);
+            }
             auto result = writeData(space, part, data);
             if (result != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 LOG(ERROR) << "Write Part " << part << " Index Failed";
@@ -102,6 +104,9 @@ RebuildEdgeIndexTask::buildIndexGlobal(GraphSpaceID space,
             currentSrcVertex = source.toString();
             currentDstVertex = destination.toString();
             currentRanking = ranking;
+            if (checkpoint != nullptr) {
+                lastKey = key.str();
+            }
         }
 
         reader = RowReaderWrapper::getEdgePropReader(env_->schemaMan_, space, edgeType, val);
@@ -159,6 +164,9 @@ RebuildEdgeIndexTask::buildIndexGlobal(GraphSpaceID space,
         iter->next();
     }
 
+    if (checkpoint != nullptr) {
+        checkpoint->append(&data, "", true);
+    }
     auto result = writeData(space, part, std::move(data));
     if (result != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Write Part " << part << " Index Failed";
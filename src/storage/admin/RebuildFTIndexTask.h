@@ -21,6 +21,11 @@ public:
 
     ErrorOr<nebula::cpp2::ErrorCode, std::vector<AdminSubTask>> genSubTasks() override;
 
+    // scan the listener's engine
+    ResourceClass resourceClass() const override {
+        return ResourceClass::IO;
+    }
+
 protected:
     nebula::cpp2::ErrorCode taskByPart(nebula::kvstore::Listener* listener);
 };
@@ -4,6 +4,8 @@
  * attached with Common Clause Condition 1.0, found in the LICENSES directory.
  */
 
+#include <folly/String.h>
+#include <folly/TokenBucket.h>
 #include "kvstore/Common.h"
 #include "storage/StorageFlags.h"
 #include "storage/admin/RebuildIndexTask.h"
@@ -54,40 +56,95 @@ RebuildIndexTask::genSubTasks() {
         }
     }
 
+    auto ranges = static_cast<size_t>(std::max(FLAGS_rebuild_index_part_ranges, 1));
     for (const auto& part : parts) {
         env_->rebuildIndexGuard_->insert_or_assign(std::make_tuple(space_, part),
                                                    IndexState::STARTING);
-        std::function<nebula::cpp2::ErrorCode()> task =
-            std::bind(&RebuildIndexTask::invoke, this, space_, part, items);
-        tasks.emplace_back(std::move(task));
+        auto rebuild = std::make_shared<PartRebuild>(splitPart(dataPrefix(part), ranges));
+        for (size_t range = 0; range + 1 < rebuild->boundaries_.size(); range++) {
+            std::function<nebula::cpp2::ErrorCode()> task =
+                std::bind(&RebuildIndexTask::invoke, this, space_, part, items, rebuild, range);
+            tasks.emplace_back(std::move(task));
+        }
     }
     return tasks;
 }
 
+std::vector<std::string> RebuildIndexTask::splitPart(const std::string& prefix, size_t num) {
+    // The end of prefix is the prefix with the last byte (not 0xff) plus one
+    auto end = prefix;
+    while (!end.empty() && static_cast<uint8_t>(end.back()) == 0xff) {
+        end.pop_back();
+    }
+    CHECK(!end.empty());
+    end.back() = static_cast<char>(static_cast<uint8_t>(end.back()) + 1);
+
+    std::vector<std::string> boundaries{prefix};
+    num = std::min<size_t>(std::max<size_t>(num, 1), 256);
+    for (size_t i = 1; i < num; i++) {
+        auto boundary = prefix;
+        boundary.append(1, static_cast<char>(256 * i / num));
+        boundaries.emplace_back(std::move(boundary));
+    }
+    boundaries.emplace_back(std::move(end));
+    return boundaries;
+}
+
+// static
+std::string RebuildIndexTask::encodeCheckpoint(const std::string& end,
+                                               std::vector<IndexID> indexes,
+                                               bool done,
+                                               folly::StringPiece last) {
+    std::sort(indexes.begin(), indexes.end());
+    uint32_t endSize = end.size();
+    uint32_t num = indexes.size();
+    std::string value;
+    value.reserve(sizeof(uint32_t) * 2 + endSize + num * sizeof(IndexID) + 1 + last.size());
+    value.append(reinterpret_cast<const char*>(&endSize), sizeof(uint32_t))
+         .append(end)
+         .append(reinterpret_cast<const char*>(&num), sizeof(uint32_t));
+    for (auto index : indexes) {
+        value.append(reinterpret_cast<const char*>(&index), sizeof(IndexID));
+    }
+    value.append(1, done ? 1 : 0).append(last.data(), last.size());
+    return value;
+}
+
+void RebuildIndexTask::Checkpoint::append(std::vector<kvstore::KV>* data,
+                                          folly::StringPiece last,
+                                          bool done) const {
+    std::string value = prefix;
+    value.append(1, done ? 1 : 0).append(last.data(), last.size());
+    data->emplace_back(key, std::move(value));
+}
+
 nebula::cpp2::ErrorCode
 RebuildIndexTask::invoke(GraphSpaceID space,
                          PartitionID part,
-                         const IndexItems& items) {
-    auto result = removeLegacyLogs(space, part);
-    if (result != nebula::cpp2::ErrorCode::SUCCEEDED) {
-        LOG(ERROR) << "Remove legacy logs at part: " << part << " failed";
-        return nebula::cpp2::ErrorCode::E_REBUILD_INDEX_FAILED;
-    } else {
-        VLOG(1) << "Remove legacy logs at part: " << part << " successful";
+                         const IndexItems& items,
+                         std::shared_ptr<PartRebuild> rebuild,
+                         size_t range) {
+    std::call_once(rebuild->started_, [&] {
+        rebuild->startCode_ = startBuilding(space, part, &rebuild->resume_);
+    });
+    auto result = rebuild->startCode_;
+    if (result == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        result = buildRange(space, part, items,
+                            rebuild->boundaries_[range], rebuild->boundaries_[range + 1],
+                            rebuild->resume_);
     }
-
-    // todo(doodle): this place has potential bug is that we'd better lock the part at first,
-    // then switch to BUILDING, otherwise some data won't build index in worst case.
-    env_->rebuildIndexGuard_->assign(std::make_tuple(space, part), IndexState::BUILDING);
-
-    LOG(INFO) << "Start building index";
-    result = buildIndexGlobal(space, part, items);
     if (result != nebula::cpp2::ErrorCode::SUCCEEDED) {
-        LOG(ERROR) << "Building index failed";
+        rebuild->failed_ = true;
+    }
+    // Only the last range finished goes on with the operation logs
+    if (--rebuild->unfinished_ != 0) {
+        return result;
+    }
+    if (rebuild->failed_) {
+        LOG(ERROR) << folly::sformat("Building index failed, space={}, part={}", space, part);
         return nebula::cpp2::ErrorCode::E_REBUILD_INDEX_FAILED;
-    } else {
-        LOG(INFO) << folly::sformat("Building index successful, space={}, part={}", space, part);
     }
+    LOG(INFO) << folly::sformat("Building index successful, space={}, part={}", space, part);
 
     LOG(INFO) << folly::sformat("Processing operation logs, space={}, part={}", space, part);
     result = buildIndexOnOperations(space, part);
@@ -96,12 +153,97 @@ RebuildIndexTask::invoke(GraphSpaceID space,
             "Building index with operation logs failed, space={}, part={}", space, part);
         return nebula::cpp2::ErrorCode::E_INVALID_OPERATION;
     }
+    if (FLAGS_rebuild_index_resume && removeCheckpoints(space, part) !=
+            nebula::cpp2::ErrorCode::SUCCEEDED) {
+        // they are removed with the legacy logs by the next rebuild
+        LOG(WARNING) << folly::sformat("Remove checkpoints failed, space={}, part={}",
+                                       space, part);
+    }
 
     env_->rebuildIndexGuard_->assign(std::make_tuple(space, part), IndexState::FINISHED);
     LOG(INFO) << folly::sformat("RebuildIndexTask Finished, space={}, part={}", space, part);
     return result;
 }
 
+nebula::cpp2::ErrorCode
+RebuildIndexTask::startBuilding(GraphSpaceID space, PartitionID part, bool* resume) {
+    bool hasLogs = true;
+    if (FLAGS_rebuild_index_resume &&
+        hasOperationLogs(space, part, &hasLogs) == nebula::cpp2::ErrorCode::SUCCEEDED &&
+        !hasLogs) {
+        *resume = true;
+        LOG(INFO) << folly::sformat("Resume building index, space={}, part={}", space, part);
+    } else {
+        auto result = removeLegacyLogs(space, part);
+        if (result != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Remove legacy logs at part: " << part << " failed";
+            return nebula::cpp2::ErrorCode::E_REBUILD_INDEX_FAILED;
+        } else {
+            VLOG(1) << "Remove legacy logs at part: " << part << " successful";
+        }
+    }
+
+    // todo(doodle): this place has potential bug is that we'd better lock the part at first,
+    // then switch to BUILDING, otherwise some data won't build index in worst case.
+    env_->rebuildIndexGuard_->assign(std::make_tuple(space, part), IndexState::BUILDING);
+    LOG(INFO) << folly::sformat("Start building index, space={}, part={}", space, part);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode
+RebuildIndexTask::buildRange(GraphSpaceID space,
+                             PartitionID part,
+                             const IndexItems& items,
+                             const std::string& start,
+                             const std::string& end,
+                             bool resume) {
+    std::unique_ptr<Checkpoint> checkpoint;
+    auto from = start;
+    if (FLAGS_rebuild_index_resume) {
+        std::vector<IndexID> indexes;
+        for (const auto& item : items) {
+            indexes.emplace_back(item->get_index_id());
+        }
+        checkpoint = std::make_unique<Checkpoint>();
+        checkpoint->key = OperationKeyUtils::checkpointKey(part, start);
+        // without the done flag
+        checkpoint->prefix = encodeCheckpoint(end, std::move(indexes), false, "");
+        checkpoint->prefix.pop_back();
+
+        std::string value;
+        if (resume &&
+            env_->kvstore_->get(space, part, checkpoint->key, &value) ==
+                nebula::cpp2::ErrorCode::SUCCEEDED &&
+            value.size() > checkpoint->prefix.size() &&
+            folly::StringPiece(value).startsWith(checkpoint->prefix)) {
+            if (value[checkpoint->prefix.size()] != 0) {
+                LOG(INFO) << "Part " << part << " range from " << folly::hexlify(start)
+                          << " is built already";
+                return nebula::cpp2::ErrorCode::SUCCEEDED;
+            }
+            from = value.substr(checkpoint->prefix.size() + 1);
+            LOG(INFO) << "Resume part " << part << " range from " << folly::hexlify(start)
+                      << " at " << folly::hexlify(from);
+        }
+    }
+
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto ret = env_->kvstore_->range(space, part, from, end, &iter, false,
+                                     kvstore::ScanHint::kFullScan);
+    if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Processing Part " << part << " Failed";
+        return ret;
+    }
+
+    auto result = buildIndexGlobal(space, part, items, iter.get(), checkpoint.get());
+    if (result != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Building index failed, part " << part << ", range from "
+                   << folly::hexlify(start);
+        return nebula::cpp2::ErrorCode::E_REBUILD_INDEX_FAILED;
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
 nebula::cpp2::ErrorCode
 RebuildIndexTask::buildIndexOnOperations(GraphSpaceID space, PartitionID part) {
     if (canceled_) {
@@ -127,7 +269,10 @@ RebuildIndexTask::buildIndexOnOperations(GraphSpaceID space, PartitionID part) {
             auto opKey = operationIter->key();
             auto opVal = operationIter->val();
             // replay operation record
-            if (OperationKeyUtils::isModifyOperation(opKey)) {
+            if (OperationKeyUtils::isCheckpoint(opKey)) {
+                operationIter->next();
+                continue;
+            } else if (OperationKeyUtils::isModifyOperation(opKey)) {
                 VLOG(3) << "Processing Modify Operation " << opKey;
                 auto key = OperationKeyUtils::getOperationKey(opKey);
                 std::vector<kvstore::KV> pairs;
@@ -226,13 +371,69 @@ RebuildIndexTask::removeLegacyLogs(GraphSpaceID space,
         operationIter->next();
     }
 
+    if (operations.empty()) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    return cleanupOperationLogs(space, part, std::move(operations));
+}
+
+nebula::cpp2::ErrorCode
+RebuildIndexTask::hasOperationLogs(GraphSpaceID space, PartitionID part, bool* has) {
+    std::unique_ptr<kvstore::KVIterator> operationIter;
+    auto operationPrefix = OperationKeyUtils::operationPrefix(part);
+    auto operationRet = env_->kvstore_->prefix(space,
+                                               part,
+                                               operationPrefix,
+                                               &operationIter);
+    if (operationRet != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return operationRet;
+    }
+    // the checkpoints are before the logs
+    while (operationIter->valid() && OperationKeyUtils::isCheckpoint(operationIter->key())) {
+        operationIter->next();
+    }
+    *has = operationIter->valid();
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
+nebula::cpp2::ErrorCode
+RebuildIndexTask::removeCheckpoints(GraphSpaceID space, PartitionID part) {
+    std::unique_ptr<kvstore::KVIterator> operationIter;
+    auto operationPrefix = OperationKeyUtils::operationPrefix(part);
+    auto operationRet = env_->kvstore_->prefix(space,
+                                               part,
+                                               operationPrefix,
+                                               &operationIter);
+    if (operationRet != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return operationRet;
+    }
+    std::vector<std::string> checkpoints;
+    while (operationIter->valid() && OperationKeyUtils::isCheckpoint(operationIter->key())) {
+        checkpoints.emplace_back(operationIter->key());
+        operationIter->next();
+    }
+    if (checkpoints.empty()) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    return cleanupOperationLogs(space, part, std::move(checkpoints));
+}
+
 nebula::cpp2::ErrorCode
 RebuildIndexTask::writeData(GraphSpaceID space,
                             PartitionID part,
                             std::vector<kvstore::KV> data) {
+    if (FLAGS_rebuild_index_rate_limit > 0) {
+        // Both the global building and the operation logs replay are limited, the bucket is
+        // shared by all rebuild tasks of this host
+        static folly::DynamicTokenBucket bucket;
+        double bytes = 0;
+        for (const auto& kv : data) {
+            bytes += kv.first.size() + kv.second.size();
+        }
+        double rate = FLAGS_rebuild_index_rate_limit * 1024.0 * 1024.0;
+        bucket.consumeWithBorrowAndWait(bytes, rate, std::max(rate, bytes));
+    }
+
     folly::Baton<true, std::atomic> baton;
     auto result = nebula::cpp2::ErrorCode::SUCCEEDED;
     env_->kvstore_->asyncMultiPut(space, part, std::move(data),
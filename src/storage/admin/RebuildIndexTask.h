@@ -28,17 +28,69 @@ public:
 
     ErrorOr<nebula::cpp2::ErrorCode, std::vector<AdminSubTask>> genSubTasks() override;
 
+    // the index is written through raft
+    ResourceClass resourceClass() const override {
+        return ResourceClass::RAFT_WRITE;
+    }
+
+    // Split the data with prefix of a part into `num` key ranges on the first byte after the
+    // prefix, return the boundaries, the first one is the prefix and the last one is the end
+    // of the prefix. All keys of a vertex (or the out edges of a vertex) are in the same range.
+    static std::vector<std::string> splitPart(const std::string& prefix, size_t num);
+
+    // The value of the checkpoint of the range to end, building the indexes. The keys before
+    // last are built, and last itself, or the whole range if done.
+    static std::string encodeCheckpoint(const std::string& end,
+                                        std::vector<IndexID> indexes,
+                                        bool done,
+                                        folly::StringPiece last);
+
 protected:
+    // The progress of building a range of the part, which is written with each batch of the
+    // index when rebuild_index_resume is on. A job restarted on the same indexes resumes the
+    // range from the last key built, which is built again, so that the versions of an edge or
+    // the tags of a vertex after it are skipped as before.
+    struct Checkpoint {
+        std::string     key;
+        // the end of the range and the ids of the indexes, the checkpoint of another range or
+        // other indexes is not resumed
+        std::string     prefix;
+
+        void append(std::vector<kvstore::KV>* data, folly::StringPiece last, bool done) const;
+    };
+
+    // The ranges of a part are built in different subtasks, the first one started removes the
+    // legacy logs, and the last one finished replays the operation logs of the part.
+    struct PartRebuild {
+        explicit PartRebuild(std::vector<std::string> boundaries)
+            : boundaries_(std::move(boundaries))
+            , unfinished_(boundaries_.size() - 1) {}
+
+        std::vector<std::string>    boundaries_;
+        std::once_flag              started_;
+        nebula::cpp2::ErrorCode     startCode_{nebula::cpp2::ErrorCode::SUCCEEDED};
+        // resume the ranges from the checkpoints
+        bool                        resume_{false};
+        std::atomic<size_t>         unfinished_;
+        std::atomic<bool>           failed_{false};
+    };
+
+    // The key prefix of the data which the index is built on
+    virtual std::string dataPrefix(PartitionID part) = 0;
+
     virtual StatusOr<IndexItems>
     getIndexes(GraphSpaceID space) = 0;
 
     virtual StatusOr<std::shared_ptr<meta::cpp2::IndexItem>>
     getIndex(GraphSpaceID space, IndexID index) = 0;
 
+    // Build the index of the keys of iter, checkpoint is null if rebuild_index_resume is off
     virtual nebula::cpp2::ErrorCode
     buildIndexGlobal(GraphSpaceID space,
                      PartitionID part,
-                     const IndexItems& items) = 0;
+                     const IndexItems& items,
+                     kvstore::KVIterator* iter,
+                     const Checkpoint* checkpoint) = 0;
 
     void cancel() override {
         canceled_ = true;
@@ -52,6 +104,15 @@ protected:
     nebula::cpp2::ErrorCode
     removeLegacyLogs(GraphSpaceID space, PartitionID part);
 
+    // Whether there are operation logs besides the checkpoints. The writes logged before the
+    // restart could be replayed over the ones applied to the index after it, so the part
+    // with the logs left is built from the start.
+    nebula::cpp2::ErrorCode
+    hasOperationLogs(GraphSpaceID space, PartitionID part, bool* has);
+
+    nebula::cpp2::ErrorCode
+    removeCheckpoints(GraphSpaceID space, PartitionID part);
+
     nebula::cpp2::ErrorCode
     writeData(GraphSpaceID space,
               PartitionID part,
@@ -67,10 +128,23 @@ protected:
                          PartitionID part,
                          std::vector<std::string> keys);
 
+    nebula::cpp2::ErrorCode
+    startBuilding(GraphSpaceID space, PartitionID part, bool* resume);
+
+    nebula::cpp2::ErrorCode
+    buildRange(GraphSpaceID space,
+               PartitionID part,
+               const IndexItems& items,
+               const std::string& start,
+               const std::string& end,
+               bool resume);
+
     nebula::cpp2::ErrorCode
     invoke(GraphSpaceID space,
            PartitionID part,
-           const IndexItems& items);
+           const IndexItems& items,
+           std::shared_ptr<PartRebuild> rebuild,
+           size_t range);
 
 protected:
     std::atomic<bool>   canceled_{false};
@@ -22,10 +22,16 @@ RebuildTagIndexTask::getIndex(GraphSpaceID space, IndexID index) {
     return env_->indexMan_->getTagIndex(space, index);
 }
 
+std::string RebuildTagIndexTask::dataPrefix(PartitionID part) {
+    return NebulaKeyUtils::vertexPrefix(part);
+}
+
 nebula::cpp2::ErrorCode
 RebuildTagIndexTask::buildIndexGlobal(GraphSpaceID space,
                                       PartitionID part,
-                                      const IndexItems& items) {
+                                      const IndexItems& items,
+                                      kvstore::KVIterator* iter,
+                                      const Checkpoint* checkpoint) {
     if (canceled_) {
         LOG(ERROR) << "Rebuild Tag Index is Canceled";
         return nebula::cpp2::ErrorCode::SUCCEEDED;
@@ -43,15 +49,8 @@ RebuildTagIndexTask::buildIndexGlobal(GraphSpaceID space,
     }
 
     auto vidSize = vidSizeRet.value();
-    std::unique_ptr<kvstore::KVIterator> iter;
-    auto prefix = NebulaKeyUtils::vertexPrefix(part);
-    auto ret = env_->kvstore_->prefix(space, part, prefix, &iter);
-    if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
-        LOG(ERROR) << "Processing Part " << part << " Failed";
-        return ret;
-    }
-
     VertexID currentVertex = "";
+    std::string lastKey;
     std::vector<kvstore::KV> data;
     data.reserve(FLAGS_rebuild_index_batch_num);
     RowReaderWrapper reader;
@@ -62,6 +61,9 @@ RebuildTagIndexTask::buildIndexGlobal(GraphSpaceID space,
         }
 
         if (static_cast<int32_t>(data.size()) == FLAGS_rebuild_index_batch_num) {
+            if (checkpoint != nullptr && !lastKey.empty()) {
+                checkpoint->append(&data, lastKey, false);
+            }
             auto result = writeData(space, part, data);
             if (result != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 LOG(ERROR) << "Write Part " << part << " Index Failed";
@@ -90,6 +92,9 @@ RebuildTagIndexTask::buildIndexGlobal(GraphSpaceID space,
             continue;
         } else {
             currentVertex = vertex.toString();
+            if (checkpoint != nullptr) {
+                lastKey = key.str();
+            }
         }
 
         reader = RowReaderWrapper::getTagPropReader(env_->schemaMan_, space, tagID, val);
@@ -142,6 +147,9 @@ RebuildTagIndexTask::buildIndexGlobal(GraphSpaceID space,
         iter->next();
     }
 
+    if (checkpoint != nullptr) {
+        checkpoint->append(&data, "", true);
+    }
     auto result = writeData(space, part, std::move(data));
     if (result != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Write Part " << part << " Index Failed";
@@ -26,10 +26,14 @@ private:
     StatusOr<std::shared_ptr<meta::cpp2::IndexItem>>
     getIndex(GraphSpaceID space, IndexID index) override;
 
+    std::string dataPrefix(PartitionID part) override;
+
     nebula::cpp2::ErrorCode
     buildIndexGlobal(GraphSpaceID space,
                      PartitionID part,
-                     const IndexItems& items) override;
+                     const IndexItems& items,
+                     kvstore::KVIterator* iter,
+                     const Checkpoint* checkpoint) override;
 };
 
 }  // namespace storage
@@ -4,15 +4,171 @@
  * attached with Common Clause Condition 1.0, found in the LICENSES directory.
  */
 
+#include <folly/container/F14Map.h>
+#include <folly/lang/Bits.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
+#include <thrift/lib/cpp2/protocol/Serializer.h>
 #include "common/base/MurmurHash2.h"
+#include "common/time/WallClock.h"
 #include "kvstore/Common.h"
+#include "storage/StorageFlags.h"
 #include "storage/admin/StatisTask.h"
 #include "utils/NebulaKeyUtils.h"
 
+DECLARE_bool(enable_incremental_statis);
+
 namespace nebula {
 namespace storage {
 
+namespace {
+
+// The value of the statis base key: the time of the scan, the counters and statis in the snapshot
+std::string encodeBase(const kvstore::PartStats& counters,
+                       const nebula::meta::cpp2::StatisItem& item) {
+    auto countersValue = counters.encode();
+    int64_t now = time::WallClock::fastNowInSec();
+    uint32_t len = countersValue.size();
+    std::string value;
+    value.append(reinterpret_cast<const char*>(&now), sizeof(int64_t))
+         .append(reinterpret_cast<const char*>(&len), sizeof(uint32_t))
+         .append(countersValue);
+    apache::thrift::CompactSerializer::serialize(item, &value);
+    return value;
+}
+
+bool decodeBase(folly::StringPiece value,
+                int64_t* ts,
+                kvstore::PartStats* counters,
+                nebula::meta::cpp2::StatisItem* item) {
+    uint32_t len = 0;
+    if (value.size() < sizeof(int64_t) + sizeof(uint32_t)) {
+        return false;
+    }
+    memcpy(ts, value.data(), sizeof(int64_t));
+    memcpy(&len, value.data() + sizeof(int64_t), sizeof(uint32_t));
+    value.advance(sizeof(int64_t) + sizeof(uint32_t));
+    if (value.size() < len || !kvstore::PartStats::decode(value.subpiece(0, len), counters)) {
+        return false;
+    }
+    value.advance(len);
+    try {
+        apache::thrift::CompactSerializer::deserialize(value, *item);
+    } catch (const std::exception& e) {
+        LOG(ERROR) << "Decode the statis base failed: " << e.what();
+        return false;
+    }
+    return true;
+}
+
+using Correlativiyties = std::vector<nebula::meta::cpp2::Correlativity>;
+
+// The counters bumped for each key scanned
+template <typename K>
+using Counters = folly::F14FastMap<K, int64_t>;
+
+// The part of the vertex, as the part of the edges it is the src or dst of
+PartitionID partOf(const std::string& vId, bool isIntId, int32_t partitionNum) {
+    uint64_t vid = 0;
+    if (isIntId) {
+        memcpy(static_cast<void*>(&vid), vId.data(), 8);
+    } else {
+        nebula::MurmurHash2 hash;
+        vid = hash(vId.data());
+    }
+    return vid % partitionNum + 1;
+}
+
+// The proportion of the edges of the part related to each other part
+Correlativiyties toCorrelativity(const Counters<PartitionID>& relevancy,
+                                 int64_t edges) {
+    Correlativiyties correlativity;
+    for (const auto& entry : relevancy) {
+        nebula::meta::cpp2::Correlativity partProportion;
+        partProportion.set_part_id(entry.first);
+        double proportion = static_cast<double>(entry.second) / static_cast<double>(edges);
+        partProportion.set_proportion(proportion);
+        correlativity.emplace_back(std::move(partProportion));
+    }
+    std::sort(correlativity.begin(), correlativity.end(),
+              [&] (const auto& l, const auto& r) {
+                  return *l.proportion_ref() < *r.proportion_ref();
+              });
+    return correlativity;
+}
+
+// The blocks to sample the keys with the prefix, which start from the prefix and the splits
+// of the range picked evenly, the whole budget is in one block if there is no split
+struct SamplePlan {
+    std::vector<std::string>    starts;
+    std::string                 end;
+    int64_t                     blockKeys{0};
+    int64_t                     estimated{0};
+};
+
+static constexpr int64_t kMinSampleBlockKeys = 128;
+
+nebula::cpp2::ErrorCode planSample(kvstore::KVEngine* engine,
+                                   const std::string& prefix,
+                                   int64_t budget,
+                                   SamplePlan* plan) {
+    plan->end = NebulaKeyUtils::prefixEnd(prefix);
+    std::vector<std::string> splits;
+    auto code = engine->estimateRange(prefix, plan->end, &plan->estimated, &splits);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    size_t blocks = std::min<size_t>(splits.size() + 1,
+                                     std::max<int64_t>(1, budget / kMinSampleBlockKeys));
+    plan->starts.emplace_back(prefix);
+    for (size_t i = 1; i < blocks; i++) {
+        plan->starts.emplace_back(splits[i * splits.size() / blocks]);
+    }
+    plan->blockKeys = std::max<int64_t>(1, budget / blocks);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+// The ratio of the keys estimated over the keys sampled, 1 if all of them are sampled
+double sampleScale(const SamplePlan& plan, int64_t sampled, bool complete) {
+    if (complete || sampled == 0) {
+        return 1.0;
+    }
+    return std::max(1.0, static_cast<double>(plan.estimated) / sampled);
+}
+
+// The out degrees of the vertices sampled of one edge type
+struct OutDegrees {
+    // the number of vertices whose out degree is in [2^i, 2^(i+1))
+    std::vector<int64_t>                                histogram;
+    int64_t                                             vertices{0};
+    int64_t                                             edges{0};
+    // the vertices whose out degree is at least statis_super_node_degree
+    std::vector<std::pair<std::string, int64_t>>        superNodes;
+
+    void add(std::string vId, int64_t degree) {
+        size_t bucket = folly::findLastSet(static_cast<uint64_t>(degree)) - 1;
+        if (histogram.size() <= bucket) {
+            histogram.resize(bucket + 1, 0);
+        }
+        histogram[bucket]++;
+        vertices++;
+        edges += degree;
+        if (degree >= FLAGS_statis_super_node_degree) {
+            superNodes.emplace_back(std::move(vId), degree);
+        }
+    }
+};
+
+std::string printVid(const std::string& vId, bool isIntId) {
+    if (isIntId) {
+        int64_t vid = 0;
+        memcpy(&vid, vId.data(), sizeof(int64_t));
+        return folly::to<std::string>(vid);
+    }
+    return vId.substr(0, vId.find('\0'));
+}
+
+}  // namespace
+
 nebula::cpp2::ErrorCode
 StatisTask::getSchemas(GraphSpaceID spaceId) {
     CHECK_NOTNULL(env_->schemaMan_);
@@ -104,6 +260,33 @@ StatisTask::genSubTask(GraphSpaceID spaceId,
     auto partitionNum = partitionNumRet.value();
     LOG(INFO) << "Start statis task";
     CHECK_NOTNULL(env_->kvstore_);
+
+    kvstore::KVEngine* engine = nullptr;
+    const void* snapshot = nullptr;
+    if (FLAGS_enable_incremental_statis || FLAGS_statis_sample_keys > 0) {
+        auto partRet = env_->kvstore_->part(spaceId, part);
+        if (!nebula::ok(partRet)) {
+            LOG(ERROR) << "Statis task failed";
+            return nebula::error(partRet);
+        }
+        engine = nebula::value(partRet)->engine();
+    }
+    if (FLAGS_enable_incremental_statis && statisByCounters(engine, part, tags, edges)) {
+        LOG(INFO) << "Statis task finished by counters";
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    if (FLAGS_statis_sample_keys > 0) {
+        return statisBySample(engine, part, tags, edges, vIdLen, isIntId, partitionNum);
+    }
+    if (FLAGS_enable_incremental_statis) {
+        // scan a snapshot, so that the counters could be offset by the statis of it
+        snapshot = engine->getSnapshot();
+    }
+    SCOPE_EXIT {
+        if (snapshot != nullptr) {
+            engine->releaseSnapshot(snapshot);
+        }
+    };
     auto vertexPrefix = NebulaKeyUtils::vertexPrefix(part);
     std::unique_ptr<kvstore::KVIterator> vertexIter;
     auto edgePrefix = NebulaKeyUtils::edgePrefix(part);
@@ -111,21 +294,24 @@ StatisTask::genSubTask(GraphSpaceID spaceId,
 
     // When the storage occurs leader change, continue to read data from the follower
     // instead of reporting an error.
-    auto ret = env_->kvstore_->prefix(spaceId, part, vertexPrefix, &vertexIter, true);
+    auto ret = env_->kvstore_->rangeWithPrefix(spaceId, part, vertexPrefix, vertexPrefix,
+                                               &vertexIter, true, snapshot,
+                                               kvstore::ScanHint::kFullScan);
     if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Statis task failed";
         return ret;
     }
-    ret = env_->kvstore_->prefix(spaceId, part, edgePrefix, &edgeIter, true);
+    ret = env_->kvstore_->rangeWithPrefix(spaceId, part, edgePrefix, edgePrefix, &edgeIter,
+                                          true, snapshot, kvstore::ScanHint::kFullScan);
     if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Statis task failed";
         return ret;
     }
 
-    std::unordered_map<TagID, int64_t>       tagsVertices;
-    std::unordered_map<EdgeType, int64_t>    edgetypeEdges;
-    std::unordered_map<PartitionID, int64_t> positiveRelevancy;
-    std::unordered_map<PartitionID, int64_t> negativeRelevancy;
+    Counters<TagID>                          tagsVertices;
+    Counters<EdgeType>                       edgetypeEdges;
+    Counters<PartitionID>                    positiveRelevancy;
+    Counters<PartitionID>                    negativeRelevancy;
     int64_t                                  spaceVertices = 0;
     int64_t                                  spaceEdges = 0;
 
@@ -139,6 +325,20 @@ StatisTask::genSubTask(GraphSpaceID spaceId,
 
     VertexID                              lastVertexId = "";
 
+    // The string vids are padded with '\0' to the vid length in the keys, the padding is
+    // counted to tell if the space could be created with a shorter vid length
+    int64_t keyBytes = 0;
+    int64_t paddingBytes = 0;
+    size_t longestVid = 0;
+    auto countPadding = [&] (folly::StringPiece vId) {
+        auto len = vId.size();
+        while (len > 0 && vId[len - 1] == '\0') {
+            len--;
+        }
+        paddingBytes += vId.size() - len;
+        longestVid = std::max(longestVid, len);
+    };
+
     // Only statis valid vetex data, no multi version
     // For example
     // Vid  tagId
@@ -166,6 +366,10 @@ StatisTask::genSubTask(GraphSpaceID spaceId,
             spaceVertices++;
             lastVertexId  = vId;
         }
+        if (!isIntId) {
+            keyBytes += key.size();
+            countPadding(vId);
+        }
         vertexIter->next();
     }
 
@@ -189,31 +393,28 @@ StatisTask::genSubTask(GraphSpaceID spaceId,
 
         auto source = NebulaKeyUtils::getSrcId(vIdLen, key).str();
         auto destination = NebulaKeyUtils::getDstId(vIdLen, key).str();
+        if (!isIntId) {
+            keyBytes += key.size();
+            countPadding(source);
+            countPadding(destination);
+        }
         if (edgeType > 0) {
             spaceEdges++;
             edgetypeEdges[edgeType] += 1;
 
-            uint64_t destinationVid = 0;
-            if (isIntId) {
-                memcpy(static_cast<void*>(&destinationVid), destination.data(), 8);
-            } else {
-                nebula::MurmurHash2 hash;
-                destinationVid = hash(destination.data());
-            }
-            positiveRelevancy[destinationVid % partitionNum + 1]++;
+            positiveRelevancy[partOf(destination, isIntId, partitionNum)]++;
         } else {
-            uint64_t sourceVid = 0;
-            if (isIntId) {
-                memcpy(static_cast<void*>(&sourceVid), source.data(), 8);
-            } else {
-                nebula::MurmurHash2 hash;
-                sourceVid = hash(source.data());
-            }
-            negativeRelevancy[sourceVid % partitionNum + 1]++;
+            negativeRelevancy[partOf(source, isIntId, partitionNum)]++;
         }
         edgeIter->next();
     }
 
+    if (keyBytes > 0) {
+        LOG(INFO) << "Space " << spaceId << ", part " << part << ": the vid padding takes "
+                  << paddingBytes * 100 / keyBytes << "% of the vertex and edge key bytes, "
+                  << "the longest vid is " << longestVid << " of the vid length " << vIdLen;
+    }
+
     nebula::meta::cpp2::StatisItem statisItem;
 
     // convert tagId/edgeType to tagName/edgeName
@@ -232,34 +433,8 @@ StatisTask::genSubTask(GraphSpaceID spaceId,
 
     statisItem.set_space_vertices(spaceVertices);
     statisItem.set_space_edges(spaceEdges);
-    using Correlativiyties = std::vector<nebula::meta::cpp2::Correlativity>;
-    Correlativiyties positiveCorrelativity;
-    for (const auto& entry : positiveRelevancy) {
-        nebula::meta::cpp2::Correlativity partProportion;
-        partProportion.set_part_id(entry.first);
-        double proportion = static_cast<double>(entry.second) / static_cast<double>(spaceEdges);
-        partProportion.set_proportion(proportion);
-        positiveCorrelativity.emplace_back(std::move(partProportion));
-    }
-
-    Correlativiyties negativeCorrelativity;
-    for (const auto& entry : negativeRelevancy) {
-        nebula::meta::cpp2::Correlativity partProportion;
-        partProportion.set_part_id(entry.first);
-        double proportion = static_cast<double>(entry.second) / static_cast<double>(spaceEdges);
-        partProportion.set_proportion(proportion);
-        negativeCorrelativity.emplace_back(std::move(partProportion));
-    }
-
-    std::sort(positiveCorrelativity.begin(), positiveCorrelativity.end(),
-              [&] (const auto& l, const auto& r) {
-                  return *l.proportion_ref() < *r.proportion_ref();
-              });
-
-    std::sort(negativeCorrelativity.begin(), negativeCorrelativity.end(),
-              [&] (const auto& l, const auto& r) {
-                  return *l.proportion_ref() < *r.proportion_ref();
-              });
+    auto positiveCorrelativity = toCorrelativity(positiveRelevancy, spaceEdges);
+    auto negativeCorrelativity = toCorrelativity(negativeRelevancy, spaceEdges);
 
     std::unordered_map<PartitionID, Correlativiyties> positivePartCorrelativiyties;
     positivePartCorrelativiyties[part] = positiveCorrelativity;
@@ -269,11 +444,274 @@ StatisTask::genSubTask(GraphSpaceID spaceId,
     negativePartCorrelativiyties[part] = negativeCorrelativity;
     statisItem.set_negative_part_correlativity(std::move(negativePartCorrelativiyties));
 
+    if (snapshot != nullptr) {
+        saveBase(spaceId, part, engine, snapshot, statisItem);
+    }
     statistics_.emplace(part, std::move(statisItem));
     LOG(INFO) << "Statis task finished";
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
+nebula::cpp2::ErrorCode
+StatisTask::statisBySample(kvstore::KVEngine* engine,
+                           PartitionID part,
+                           const std::unordered_map<TagID, std::string>& tags,
+                           const std::unordered_map<EdgeType, std::string>& edges,
+                           size_t vIdLen,
+                           bool isIntId,
+                           int32_t partitionNum) {
+    // Sample the vertices, a vertex split by two blocks is counted twice, which is rare
+    SamplePlan plan;
+    auto ret = planSample(engine, NebulaKeyUtils::vertexPrefix(part), FLAGS_statis_sample_keys,
+                          &plan);
+    if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Statis task failed";
+        return ret;
+    }
+    Counters<TagID> tagsVertices;
+    int64_t spaceVertices = 0;
+    int64_t sampled = 0;
+    bool complete = true;
+    for (size_t i = 0; i < plan.starts.size(); i++) {
+        const auto& next = i + 1 < plan.starts.size() ? plan.starts[i + 1] : plan.end;
+        std::unique_ptr<kvstore::KVIterator> iter;
+        ret = engine->rangeWithPrefix(plan.starts[i], plan.starts.front(), &iter);
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Statis task failed";
+            return ret;
+        }
+        int64_t num = 0;
+        std::string lastVertexId;
+        for (; iter->valid() && iter->key() < next; iter->next()) {
+            if (num++ >= plan.blockKeys) {
+                complete = false;
+                break;
+            }
+            auto key = iter->key();
+            if (tags.count(NebulaKeyUtils::getTagId(vIdLen, key)) == 0) {
+                continue;
+            }
+            tagsVertices[NebulaKeyUtils::getTagId(vIdLen, key)]++;
+            auto vId = NebulaKeyUtils::getVertexId(vIdLen, key);
+            if (vId != lastVertexId) {
+                spaceVertices++;
+                lastVertexId = vId.str();
+            }
+        }
+        sampled += std::min(num, plan.blockKeys);
+    }
+    auto vertexScale = sampleScale(plan, sampled, complete);
+
+    // Sample the edges. The out degree of the vertex at either end of a block is counted
+    // by its own prefix, since only part of its edges might be in the block.
+    plan = SamplePlan();
+    ret = planSample(engine, NebulaKeyUtils::edgePrefix(part), FLAGS_statis_sample_keys, &plan);
+    if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(ERROR) << "Statis task failed";
+        return ret;
+    }
+    Counters<EdgeType> edgetypeEdges;
+    Counters<PartitionID> positiveRelevancy;
+    Counters<PartitionID> negativeRelevancy;
+    std::unordered_map<EdgeType, OutDegrees> outDegrees;
+    int64_t spaceEdges = 0;
+    sampled = 0;
+    complete = true;
+    std::string lastCounted;
+    auto countDegree = [&] (const std::string& src, EdgeType edgeType, int64_t degree, bool cut) {
+        auto prefix = NebulaKeyUtils::edgePrefix(vIdLen, part, src, edgeType);
+        if (prefix == lastCounted) {
+            return;
+        }
+        if (cut) {
+            // count the edges of the vertex, at most statis_super_node_degree of them
+            std::unique_ptr<kvstore::KVIterator> iter;
+            if (engine->prefix(prefix, &iter) == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                for (degree = 0; iter->valid() && degree < FLAGS_statis_super_node_degree;
+                     iter->next()) {
+                    degree++;
+                }
+            }
+            lastCounted = prefix;
+        }
+        if (degree > 0) {
+            outDegrees[edgeType].add(src, degree);
+        }
+    };
+    for (size_t i = 0; i < plan.starts.size(); i++) {
+        const auto& next = i + 1 < plan.starts.size() ? plan.starts[i + 1] : plan.end;
+        std::unique_ptr<kvstore::KVIterator> iter;
+        ret = engine->rangeWithPrefix(plan.starts[i], plan.starts.front(), &iter);
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Statis task failed";
+            return ret;
+        }
+        int64_t num = 0;
+        std::string src;
+        EdgeType srcType = 0;
+        int64_t degree = 0;
+        bool head = i > 0;
+        for (; iter->valid() && iter->key() < next; iter->next()) {
+            if (num++ >= plan.blockKeys) {
+                complete = false;
+                break;
+            }
+            auto key = iter->key();
+            auto edgeType = NebulaKeyUtils::getEdgeType(vIdLen, key);
+            // the lock of toss is the same as the in edge except for the last byte
+            if (NebulaKeyUtils::isLock(vIdLen, key) || edges.count(std::abs(edgeType)) == 0) {
+                continue;
+            }
+            if (edgeType < 0) {
+                negativeRelevancy[partOf(NebulaKeyUtils::getSrcId(vIdLen, key).str(),
+                                         isIntId, partitionNum)]++;
+                continue;
+            }
+            spaceEdges++;
+            edgetypeEdges[edgeType]++;
+            positiveRelevancy[partOf(NebulaKeyUtils::getDstId(vIdLen, key).str(),
+                                     isIntId, partitionNum)]++;
+            auto srcId = NebulaKeyUtils::getSrcId(vIdLen, key);
+            if (srcId != src || edgeType != srcType) {
+                if (degree > 0) {
+                    countDegree(src, srcType, degree, head);
+                    head = false;
+                }
+                src = srcId.str();
+                srcType = edgeType;
+                degree = 0;
+            }
+            degree++;
+        }
+        sampled += std::min(num, plan.blockKeys);
+        if (degree > 0) {
+            // the last vertex of the block is cut unless all keys to the next block are read
+            countDegree(src, srcType, degree, head || iter->valid());
+        }
+    }
+    auto edgeScale = sampleScale(plan, sampled, complete);
+
+    nebula::meta::cpp2::StatisItem statisItem;
+    for (const auto& tag : tags) {
+        (*statisItem.tag_vertices_ref()).emplace(
+            tag.second, std::llround(tagsVertices[tag.first] * vertexScale));
+    }
+    for (const auto& edge : edges) {
+        (*statisItem.edges_ref()).emplace(
+            edge.second, std::llround(edgetypeEdges[edge.first] * edgeScale));
+    }
+    statisItem.set_space_vertices(std::llround(spaceVertices * vertexScale));
+    statisItem.set_space_edges(std::llround(spaceEdges * edgeScale));
+    // the proportions in the sample, which are about the same as the ones of all edges
+    std::unordered_map<PartitionID, Correlativiyties> positivePartCorrelativiyties;
+    positivePartCorrelativiyties[part] = toCorrelativity(positiveRelevancy, spaceEdges);
+    statisItem.set_positive_part_correlativity(std::move(positivePartCorrelativiyties));
+    std::unordered_map<PartitionID, Correlativiyties> negativePartCorrelativiyties;
+    negativePartCorrelativiyties[part] = toCorrelativity(negativeRelevancy, spaceEdges);
+    statisItem.set_negative_part_correlativity(std::move(negativePartCorrelativiyties));
+
+    for (const auto& entry : outDegrees) {
+        const auto& degrees = entry.second;
+        std::vector<std::string> superNodes;
+        for (const auto& node : degrees.superNodes) {
+            superNodes.emplace_back(folly::stringPrintf("%s:%ld",
+                                                        printVid(node.first, isIntId).c_str(),
+                                                        node.second));
+        }
+        LOG(INFO) << "Sampled out degree of edge " << entry.first << " in part " << part
+                  << ": avg " << static_cast<double>(degrees.edges) / degrees.vertices
+                  << ", histogram by power of 2 [" << folly::join(", ", degrees.histogram)
+                  << "], super nodes [" << folly::join(", ", superNodes) << "]";
+    }
+    statistics_.emplace(part, std::move(statisItem));
+    LOG(INFO) << "Statis task finished by sample, " << sampled << " edges sampled of about "
+              << plan.estimated;
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+bool StatisTask::statisByCounters(kvstore::KVEngine* engine,
+                                  PartitionID part,
+                                  const std::unordered_map<TagID, std::string>& tags,
+                                  const std::unordered_map<EdgeType, std::string>& edges) {
+    std::string value;
+    kvstore::PartStats counters;
+    auto code = engine->get(NebulaKeyUtils::systemStatisKey(part), &value);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED ||
+        !kvstore::PartStats::decode(value, &counters)) {
+        return false;
+    }
+    int64_t ts = 0;
+    kvstore::PartStats baseCounters;
+    nebula::meta::cpp2::StatisItem base;
+    base.set_space_vertices(0);
+    base.set_space_edges(0);
+    code = engine->get(NebulaKeyUtils::systemStatisBaseKey(part), &value);
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        if (!decodeBase(value, &ts, &baseCounters, &base) ||
+            baseCounters.since != counters.since) {
+            return false;
+        }
+        if (FLAGS_statis_reconcile_interval_secs > 0 &&
+            time::WallClock::fastNowInSec() - ts > FLAGS_statis_reconcile_interval_secs) {
+            return false;
+        }
+    } else if (counters.since != 0) {
+        // the counters have not been offset
+        return false;
+    }
+
+    nebula::meta::cpp2::StatisItem statisItem;
+    for (const auto& tag : tags) {
+        auto count = counters.tags[tag.first] - baseCounters.tags[tag.first];
+        auto iter = (*base.tag_vertices_ref()).find(tag.second);
+        if (iter != (*base.tag_vertices_ref()).end()) {
+            count += iter->second;
+        }
+        (*statisItem.tag_vertices_ref()).emplace(tag.second, count);
+    }
+    for (const auto& edge : edges) {
+        auto count = counters.edgeTypes[edge.first] - baseCounters.edgeTypes[edge.first];
+        auto iter = (*base.edges_ref()).find(edge.second);
+        if (iter != (*base.edges_ref()).end()) {
+            count += iter->second;
+        }
+        (*statisItem.edges_ref()).emplace(edge.second, count);
+    }
+    statisItem.set_space_vertices(counters.vertices - baseCounters.vertices +
+                                  *base.space_vertices_ref());
+    statisItem.set_space_edges(counters.edges - baseCounters.edges + *base.space_edges_ref());
+    // the correlativity is of the last scan
+    auto positive = std::move(*base.positive_part_correlativity_ref());
+    auto negative = std::move(*base.negative_part_correlativity_ref());
+    positive.emplace(part, std::vector<nebula::meta::cpp2::Correlativity>());
+    negative.emplace(part, std::vector<nebula::meta::cpp2::Correlativity>());
+    statisItem.set_positive_part_correlativity(std::move(positive));
+    statisItem.set_negative_part_correlativity(std::move(negative));
+    statistics_.emplace(part, std::move(statisItem));
+    return true;
+}
+
+void StatisTask::saveBase(GraphSpaceID spaceId,
+                          PartitionID part,
+                          kvstore::KVEngine* engine,
+                          const void* snapshot,
+                          const nebula::meta::cpp2::StatisItem& statisItem) {
+    auto key = NebulaKeyUtils::systemStatisKey(part);
+    std::unique_ptr<kvstore::KVIterator> iter;
+    auto ret = env_->kvstore_->rangeWithPrefix(spaceId, part, key, key, &iter, true, snapshot);
+    kvstore::PartStats counters;
+    if (ret != nebula::cpp2::ErrorCode::SUCCEEDED || iter == nullptr || !iter->valid() ||
+        !kvstore::PartStats::decode(iter->val(), &counters)) {
+        // the counters have not started in the snapshot
+        return;
+    }
+    // the base is local, which is not replicated since the counters are not either
+    ret = engine->put(NebulaKeyUtils::systemStatisBaseKey(part), encodeBase(counters, statisItem));
+    if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        LOG(WARNING) << "Save the statis base of part " << part << " failed";
+    }
+}
+
 void StatisTask::finish(nebula::cpp2::ErrorCode rc) {
     FLOG_INFO("task(%d, %d) finished, rc=[%s]", ctx_.jobId_, ctx_.taskId_,
               apache::thrift::util::enumNameSafe(rc).c_str());
@@ -11,6 +11,7 @@
 #include "common/interface/gen-cpp2/meta_types.h"
 #include "kvstore/KVEngine.h"
 #include "kvstore/NebulaStore.h"
+#include "kvstore/PartStats.h"
 #include "storage/admin/AdminTask.h"
 
 namespace nebula {
@@ -30,6 +31,10 @@ public:
 
     void finish(nebula::cpp2::ErrorCode rc) override;
 
+    ResourceClass resourceClass() const override {
+        return ResourceClass::IO;
+    }
+
 protected:
     void cancel() override {
         canceled_ = true;
@@ -44,6 +49,31 @@ protected:
 private:
     nebula::cpp2::ErrorCode getSchemas(GraphSpaceID spaceId);
 
+    // Statis the part by the counters maintained by enable_incremental_statis, return false
+    // if they are not offset by a scan yet, or the scan is older than the reconcile interval
+    bool statisByCounters(kvstore::KVEngine* engine,
+                          PartitionID part,
+                          const std::unordered_map<TagID, std::string>& tags,
+                          const std::unordered_map<EdgeType, std::string>& edges);
+
+    // Estimate the statis of the part by statis_sample_keys vertices and edges sampled from the
+    // splits of the engine, and log the out degrees of each edge type sampled
+    nebula::cpp2::ErrorCode
+    statisBySample(kvstore::KVEngine* engine,
+                   PartitionID part,
+                   const std::unordered_map<TagID, std::string>& tags,
+                   const std::unordered_map<EdgeType, std::string>& edges,
+                   size_t vIdLen,
+                   bool isIntId,
+                   int32_t partitionNum);
+
+    // Keep the statis scanned in the snapshot with the counters in it, as the offset of them
+    void saveBase(GraphSpaceID spaceId,
+                  PartitionID part,
+                  kvstore::KVEngine* engine,
+                  const void* snapshot,
+                  const nebula::meta::cpp2::StatisItem& statisItem);
+
 protected:
     std::atomic<bool>                           canceled_{false};
     GraphSpaceID                                spaceId_;
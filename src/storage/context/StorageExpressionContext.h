@@ -123,20 +123,21 @@ public:
 
 
     // index key
-    void reset(const std::string& key) {
-        key_ = key;
+    void reset(folly::StringPiece key) {
+        key_.assign(key.data(), key.size());
     }
 
     // isEdge_ set in ctor
+    // the key is copied into the buffer kept by the context, so no allocation for each row
     void reset(RowReader* reader,
-               const std::string& key) {
+               folly::StringPiece key) {
         reader_ = reader;
-        key_ = key;
+        key_.assign(key.data(), key.size());
     }
 
     void reset() {
         reader_ = nullptr;
-        key_ = "";
+        key_.clear();
         name_ = "";
         schema_ = nullptr;
     }
@@ -166,6 +167,27 @@ public:
         edgeFilters_.clear();
     }
 
+    // The row set by `reset`, which is read by the compiled filter directly
+    RowReader* reader() const {
+        return reader_;
+    }
+
+    const std::string& key() const {
+        return key_;
+    }
+
+    const std::string& name() const {
+        return name_;
+    }
+
+    const meta::NebulaSchemaProvider* schema() const {
+        return schema_;
+    }
+
+    bool isEdge() const {
+        return isEdge_;
+    }
+
     Value readValue(const std::string& propName) const;
 
     Value getIndexValue(const std::string& prop, bool isEdge) const;
@@ -174,13 +196,13 @@ private:
     size_t                             vIdLen_;
     bool                               isIntId_;
 
-    RowReader                         *reader_;
+    RowReader                         *reader_{nullptr};
     std::string                        key_;
     // tag or edge name
     std::string                        name_;
     // tag or edge latest schema
-    const meta::NebulaSchemaProvider  *schema_;
-    bool                               isEdge_;
+    const meta::NebulaSchemaProvider  *schema_{nullptr};
+    bool                               isEdge_{false};
 
     // index
     bool isIndex_ = false;
@@ -10,27 +10,18 @@
 
 #include "common/base/Base.h"
 #include "storage/exec/FilterNode.h"
+#include "storage/exec/StatAccumulator.h"
 
 namespace nebula {
 namespace storage {
 
-// used to save stat value of each vertex
-struct PropStat {
-    PropStat() = default;
-
-    explicit PropStat(const cpp2::StatType& statType) : statType_(statType) {}
-
-    cpp2::StatType statType_;
-    mutable Value sum_ = 0L;
-    mutable Value count_ = 0L;
-    mutable Value min_ = std::numeric_limits<int64_t>::max();
-    mutable Value max_ = std::numeric_limits<int64_t>::min();
-};
-
 // AggregateNode will only be used in GetNeighbors for now, it need to calculate some stat of all
 // valid edges of a vertex. It could be used in ScanVertex or ScanEdge later.
 // The stat is collected during we iterate over edges via `next`, so if you want to get the
 // final result, be sure to call `calculateStat` and then retrieve the reuslt
+//
+// If `statGroupKeys_` of EdgeContext is not empty, the stats are grouped by the keys, and the
+// result is a list of groups, each one is a list of the group keys followed by the stats.
 template<typename T>
 class AggregateNode : public IterateNode<T> {
 public:
@@ -69,20 +60,14 @@ public:
     }
 
     void calculateStat() {
+        if (groups_ != nullptr) {
+            this->result_.setList(groups_->result());
+            return;
+        }
         nebula::List result;
         result.values.reserve(stats_.size());
         for (const auto& stat : stats_) {
-            if (stat.statType_ == cpp2::StatType::SUM) {
-                result.values.emplace_back(stat.sum_);
-            } else if (stat.statType_ == cpp2::StatType::COUNT) {
-                result.values.emplace_back(stat.count_);
-            } else if (stat.statType_ == cpp2::StatType::AVG) {
-                result.values.emplace_back(stat.sum_ / stat.count_);
-            } else if (stat.statType_ == cpp2::StatType::MAX) {
-                result.values.emplace_back(stat.max_);
-            } else if (stat.statType_ == cpp2::StatType::MIN) {
-                result.values.emplace_back(stat.min_);
-            }
+            result.values.emplace_back(stat.result());
         }
         this->result_.setList(std::move(result));
     }
@@ -105,6 +90,10 @@ private:
     }
 
     void initStatValue(EdgeContext* edgeContext) {
+        if (groups_ != nullptr) {
+            groups_->clear();
+            return;
+        }
         stats_.clear();
         // initialize all stat value of all edgeTypes
         if (edgeContext->statCount_ > 0) {
@@ -113,18 +102,50 @@ private:
                 for (const auto& ctx : ec.second) {
                     if (ctx.hasStat_) {
                         for (size_t i = 0; i < ctx.statType_.size(); i++) {
-                            PropStat stat(ctx.statType_[i]);
-                            stats_[ctx.statIndex_[i]] = std::move(stat);
+                            stats_[ctx.statIndex_[i]] = StatAccumulator(ctx.statType_[i]);
                         }
                     }
                 }
             }
         }
+        if (!edgeContext->statGroupKeys_.empty()) {
+            groups_ = std::make_unique<GroupedStats>(stats_, expectedGroups(edgeContext));
+        }
+    }
+
+    // The groups number is known if grouped by edge type only, otherwise the table grows from
+    // a small one, and keeps its capacity for the following vertices of the plan
+    size_t expectedGroups(EdgeContext* edgeContext) {
+        const auto& keys = edgeContext->statGroupKeys_;
+        bool typeOnly = std::all_of(keys.begin(), keys.end(), [] (const auto& key) {
+            return key.prop_.propInKeyType_ == PropContext::PropInKeyType::TYPE;
+        });
+        return typeOnly ? edgeContext->propContexts_.size() : 0;
     }
 
     nebula::cpp2::ErrorCode collectEdgeStats(folly::StringPiece key,
                                      RowReader* reader,
                                      const std::vector<PropContext>* props) {
+        StatAccumulator* stats = stats_.data();
+        if (groups_ != nullptr) {
+            std::vector<Value> groupKey;
+            groupKey.reserve(edgeContext_->statGroupKeys_.size());
+            for (const auto& groupProp : edgeContext_->statGroupKeys_) {
+                // the prop in value only belongs to the edge of its type
+                if (groupProp.prop_.propInKeyType_ == PropContext::PropInKeyType::NONE &&
+                    std::abs(context_->edgeType_) != groupProp.edgeType_) {
+                    groupKey.emplace_back(Value::kNullValue);
+                    continue;
+                }
+                auto value = QueryUtils::readEdgeProp(
+                    key, context_->vIdLen(), context_->isIntId(), reader, groupProp.prop_);
+                if (!value.ok()) {
+                    return nebula::cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND;
+                }
+                groupKey.emplace_back(std::move(value).value());
+            }
+            stats = groups_->find(std::move(groupKey));
+        }
         for (const auto& prop : *props) {
             if (prop.hasStat_) {
                 for (const auto statIndex : prop.statIndex_) {
@@ -134,30 +155,18 @@ private:
                     if (!value.ok()) {
                         return nebula::cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND;
                     }
-                    addStatValue(std::move(value).value(), stats_[statIndex]);
+                    stats[statIndex].add(std::move(value).value());
                 }
             }
         }
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
 
-    void addStatValue(const Value& value, PropStat& stat) {
-        if (stat.statType_ == cpp2::StatType::SUM || stat.statType_ == cpp2::StatType::AVG) {
-            stat.sum_ = stat.sum_ + value;
-            stat.count_ = stat.count_ + 1;
-        } else if (stat.statType_ == cpp2::StatType::COUNT) {
-            stat.count_ = stat.count_ + 1;
-        } else if (stat.statType_ == cpp2::StatType::MAX) {
-            stat.max_ = value > stat.max_ ? value : stat.max_;
-        } else if (stat.statType_ == cpp2::StatType::MIN) {
-            stat.min_ = value < stat.min_ ? value : stat.min_;
-        }
-    }
-
 private:
     RunTimeContext *context_;
     EdgeContext* edgeContext_;
-    std::vector<PropStat> stats_;
+    std::vector<StatAccumulator> stats_;
+    std::unique_ptr<GroupedStats> groups_;
     nebula::DataSet* resultSet_;
 };
 
@@ -0,0 +1,75 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_CACHEDEDGEITERATOR_H_
+#define STORAGE_EXEC_CACHEDEDGEITERATOR_H_
+
+#include "common/base/Base.h"
+#include "kvstore/KVIterator.h"
+#include "storage/CommonUtils.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+CachedEdgeIterator is a KVIterator over the edges of a vertex with specified edge type, which
+are shared with the EdgeCache. The edges are immutable once they are put into cache, the whole
+entry is stale once the part is written.
+
+When the edges are too many to be cached, the ones have been read are returned at first, then
+the rest iterator of kvstore is used.
+*/
+class CachedEdgeIterator final : public kvstore::KVIterator {
+public:
+    using Edges = std::vector<kvstore::KV>;
+
+    explicit CachedEdgeIterator(std::shared_ptr<const Edges> edges,
+                                std::unique_ptr<kvstore::KVIterator> rest = nullptr)
+        : edges_(std::move(edges))
+        , rest_(std::move(rest)) {
+        CHECK(!!edges_);
+    }
+
+    bool valid() const override {
+        return pos_ < edges_->size() || (rest_ != nullptr && rest_->valid());
+    }
+
+    void next() override {
+        if (pos_ < edges_->size()) {
+            ++pos_;
+        } else {
+            rest_->next();
+        }
+    }
+
+    void prev() override {
+        LOG(FATAL) << "CachedEdgeIterator does not support prev";
+    }
+
+    folly::StringPiece key() const override {
+        if (pos_ < edges_->size()) {
+            return (*edges_)[pos_].first;
+        }
+        return rest_->key();
+    }
+
+    folly::StringPiece val() const override {
+        if (pos_ < edges_->size()) {
+            return (*edges_)[pos_].second;
+        }
+        return rest_->val();
+    }
+
+private:
+    std::shared_ptr<const Edges>            edges_;
+    size_t                                  pos_ = 0;
+    std::unique_ptr<kvstore::KVIterator>    rest_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_CACHEDEDGEITERATOR_H_
@@ -0,0 +1,310 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_COMPILEDFILTER_H_
+#define STORAGE_EXEC_COMPILEDFILTER_H_
+
+#include "common/base/Base.h"
+#include "common/expression/ConstantExpression.h"
+#include "common/expression/LogicalExpression.h"
+#include "common/expression/PropertyExpression.h"
+#include "common/expression/RelationalExpression.h"
+#include "storage/context/StorageExpressionContext.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+CompiledFilter is the flattened form of a pushed down filter which is made up of AND/OR of
+comparisons between a property and a numeric constant, such as `e.a > 10 AND $^.t.b < 1.5`.
+It is evaluated for every row of GetNeighbors, so it reads the numeric field from RowReader
+directly, instead of walking the expression tree and building Values for every node.
+
+`compile` returns nullptr if the filter is not supported, and `evaluate` returns none if the
+row can't be decided, e.g. the property is NULL or not numeric, or the row is of another
+tag/edge. In both cases the caller should fall back to evaluate the expression itself, so the
+result is always the same as the expression.
+*/
+class CompiledFilter final {
+public:
+    static std::unique_ptr<CompiledFilter> compile(const Expression* exp) {
+        auto filter = std::unique_ptr<CompiledFilter>(new CompiledFilter());
+        if (!filter->compileExp(exp)) {
+            return nullptr;
+        }
+        return filter;
+    }
+
+    // Return none if the result can't be decided by the compiled filter
+    folly::Optional<bool> evaluate(const StorageExpressionContext& ctx) {
+        stack_.clear();
+        for (const auto& inst : program_) {
+            switch (inst.code_) {
+                case OpCode::LEAF: {
+                    auto ret = evalLeaf(leaves_[inst.operand_], ctx);
+                    if (!ret.hasValue()) {
+                        return folly::none;
+                    }
+                    stack_.emplace_back(ret.value());
+                    break;
+                }
+                case OpCode::AND:
+                case OpCode::OR: {
+                    bool isAnd = inst.code_ == OpCode::AND;
+                    bool result = isAnd;
+                    for (size_t i = stack_.size() - inst.operand_; i < stack_.size(); i++) {
+                        result = isAnd ? (result && stack_[i]) : (result || stack_[i]);
+                    }
+                    stack_.resize(stack_.size() - inst.operand_);
+                    stack_.emplace_back(result);
+                    break;
+                }
+            }
+        }
+        DCHECK_EQ(1, stack_.size());
+        return stack_.back();
+    }
+
+private:
+    enum class OpCode : uint8_t {
+        LEAF,
+        // operand_ is the number of operands on the stack
+        AND,
+        OR,
+    };
+
+    enum class CmpOp : uint8_t {
+        EQ, NE, LT, LE, GT, GE,
+    };
+
+    struct Instruction {
+        OpCode      code_;
+        size_t      operand_;
+    };
+
+    // `sym_.prop_ op constant_`
+    struct Leaf {
+        Expression::Kind        kind_;
+        std::string             sym_;
+        std::string             prop_;
+        CmpOp                   op_;
+        RowReader::Numeric      constant_;
+        // the field index of prop_ in the schema last seen, the row of an older schema
+        // version may have different index
+        const meta::SchemaProviderIf*   schema_{nullptr};
+        int64_t                         index_{-1};
+    };
+
+    CompiledFilter() = default;
+
+    bool compileExp(const Expression* exp) {
+        switch (exp->kind()) {
+            case Expression::Kind::kLogicalAnd:
+            case Expression::Kind::kLogicalOr: {
+                auto* logicExp = static_cast<const LogicalExpression*>(exp);
+                const auto& operands = logicExp->operands();
+                if (operands.empty()) {
+                    return false;
+                }
+                for (const auto* operand : operands) {
+                    if (!compileExp(operand)) {
+                        return false;
+                    }
+                }
+                auto code = exp->kind() == Expression::Kind::kLogicalAnd ? OpCode::AND
+                                                                          : OpCode::OR;
+                program_.emplace_back(Instruction{code, operands.size()});
+                return true;
+            }
+            case Expression::Kind::kRelEQ:
+            case Expression::Kind::kRelNE:
+            case Expression::Kind::kRelLT:
+            case Expression::Kind::kRelLE:
+            case Expression::Kind::kRelGT:
+            case Expression::Kind::kRelGE: {
+                auto* relExp = static_cast<const RelationalExpression*>(exp);
+                auto op = toCmpOp(exp->kind());
+                const Expression* prop = relExp->left();
+                const Expression* constant = relExp->right();
+                if (prop->kind() == Expression::Kind::kConstant) {
+                    // `10 < e.a` is `e.a > 10`
+                    std::swap(prop, constant);
+                    op = mirror(op);
+                }
+                if (constant->kind() != Expression::Kind::kConstant || !isProp(prop)) {
+                    return false;
+                }
+                const auto& value = static_cast<const ConstantExpression*>(constant)->value();
+                Leaf leaf;
+                if (value.isInt()) {
+                    leaf.constant_.isInt_ = true;
+                    leaf.constant_.int_ = value.getInt();
+                } else if (value.isFloat()) {
+                    leaf.constant_.isInt_ = false;
+                    leaf.constant_.float_ = value.getFloat();
+                } else {
+                    return false;
+                }
+                auto* propExp = static_cast<const PropertyExpression*>(prop);
+                leaf.kind_ = prop->kind();
+                leaf.sym_ = propExp->sym();
+                leaf.prop_ = propExp->prop();
+                leaf.op_ = op;
+                program_.emplace_back(Instruction{OpCode::LEAF, leaves_.size()});
+                leaves_.emplace_back(std::move(leaf));
+                return true;
+            }
+            default:
+                return false;
+        }
+    }
+
+    static bool isProp(const Expression* exp) {
+        switch (exp->kind()) {
+            case Expression::Kind::kEdgeProperty:
+            case Expression::Kind::kEdgeRank:
+            case Expression::Kind::kEdgeType:
+            case Expression::Kind::kSrcProperty:
+            case Expression::Kind::kTagProperty: {
+                // the vertex ids are not numeric when vid type is string
+                const auto& prop = static_cast<const PropertyExpression*>(exp)->prop();
+                return prop != kSrc && prop != kDst && prop != kVid && prop != kTag;
+            }
+            default:
+                return false;
+        }
+    }
+
+    static CmpOp toCmpOp(Expression::Kind kind) {
+        switch (kind) {
+            case Expression::Kind::kRelEQ:
+                return CmpOp::EQ;
+            case Expression::Kind::kRelNE:
+                return CmpOp::NE;
+            case Expression::Kind::kRelLT:
+                return CmpOp::LT;
+            case Expression::Kind::kRelLE:
+                return CmpOp::LE;
+            case Expression::Kind::kRelGT:
+                return CmpOp::GT;
+            default:
+                return CmpOp::GE;
+        }
+    }
+
+    static CmpOp mirror(CmpOp op) {
+        switch (op) {
+            case CmpOp::LT:
+                return CmpOp::GT;
+            case CmpOp::LE:
+                return CmpOp::GE;
+            case CmpOp::GT:
+                return CmpOp::LT;
+            case CmpOp::GE:
+                return CmpOp::LE;
+            default:
+                return op;
+        }
+    }
+
+    template <typename V>
+    static bool compare(CmpOp op, V lhs, V rhs) {
+        switch (op) {
+            case CmpOp::EQ:
+                return lhs == rhs;
+            case CmpOp::NE:
+                return lhs != rhs;
+            case CmpOp::LT:
+                return lhs < rhs;
+            case CmpOp::LE:
+                return lhs <= rhs;
+            case CmpOp::GT:
+                return lhs > rhs;
+            case CmpOp::GE:
+                return lhs >= rhs;
+        }
+        return false;
+    }
+
+    folly::Optional<bool> evalLeaf(Leaf& leaf, const StorageExpressionContext& ctx) {
+        RowReader::Numeric val;
+        if (!readNumeric(leaf, ctx, &val)) {
+            return folly::none;
+        }
+        // int with int is compared exactly, otherwise compared as double like Value does
+        if (val.isInt_ && leaf.constant_.isInt_) {
+            return compare(leaf.op_, val.int_, leaf.constant_.int_);
+        }
+        double lhs = val.isInt_ ? static_cast<double>(val.int_) : val.float_;
+        double rhs = leaf.constant_.isInt_ ? static_cast<double>(leaf.constant_.int_)
+                                           : leaf.constant_.float_;
+        return compare(leaf.op_, lhs, rhs);
+    }
+
+    bool readNumeric(Leaf& leaf,
+                     const StorageExpressionContext& ctx,
+                     RowReader::Numeric* val) {
+        // the edge property of current row is read from the reader directly
+        auto* reader = ctx.reader();
+        if (leaf.kind_ == Expression::Kind::kEdgeProperty && ctx.isEdge() && reader != nullptr &&
+            leaf.prop_ != kRank && leaf.prop_ != kType) {
+            if (leaf.sym_ != ctx.name()) {
+                return false;
+            }
+            auto* schema = reader->getSchema();
+            if (schema != leaf.schema_) {
+                leaf.schema_ = schema;
+                // the field dropped in the latest schema is read as NULL
+                auto* latest = ctx.schema();
+                if (latest != nullptr && latest->field(leaf.prop_) != nullptr) {
+                    leaf.index_ = schema->getFieldIndex(leaf.prop_);
+                } else {
+                    leaf.index_ = -1;
+                }
+            }
+            // the field not in the row's schema may have a default value, which is read by
+            // the expression context below
+            if (leaf.index_ >= 0 && reader->getNumericByIndex(leaf.index_, val)) {
+                return true;
+            }
+        }
+
+        Value value;
+        switch (leaf.kind_) {
+            case Expression::Kind::kEdgeProperty:
+            case Expression::Kind::kEdgeRank:
+            case Expression::Kind::kEdgeType:
+                value = ctx.getEdgeProp(leaf.sym_, leaf.prop_);
+                break;
+            case Expression::Kind::kSrcProperty:
+                value = ctx.getSrcProp(leaf.sym_, leaf.prop_);
+                break;
+            default:
+                value = ctx.getTagProp(leaf.sym_, leaf.prop_);
+                break;
+        }
+        if (value.isInt()) {
+            val->isInt_ = true;
+            val->int_ = value.getInt();
+            return true;
+        } else if (value.isFloat()) {
+            val->isInt_ = false;
+            val->float_ = value.getFloat();
+            return true;
+        }
+        return false;
+    }
+
+    std::vector<Instruction>    program_;
+    std::vector<Leaf>           leaves_;
+    // the evaluation stack, kept to avoid allocation of every row
+    std::vector<bool>           stack_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_COMPILEDFILTER_H_
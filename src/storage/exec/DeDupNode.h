@@ -9,6 +9,8 @@
 #define STORAGE_EXEC_DEDUPNODE_H_
 
 #include "common/base/Base.h"
+#include <folly/container/F14Set.h>
+#include <folly/hash/Hash.h>
 #include "storage/exec/FilterNode.h"
 
 namespace nebula {
@@ -33,7 +35,51 @@ public:
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
 
+    /*
+    The key of each row, the values at pos, is hashed once, and the rows with a key seen are
+    dropped by a flat hash set of the row indexes, so only the distinct rows are sorted by the
+    key as before. The first row of each key is kept.
+    */
     static void dedup(std::vector<Row>& rows, const std::vector<size_t>& pos) {
+        std::vector<size_t> hashes;
+        hashes.reserve(rows.size());
+        for (const auto& row : rows) {
+            size_t hash = 0;
+            for (const auto& p : pos) {
+                hash = folly::hash::hash_128_to_64(hash, std::hash<Value>()(row.values[p]));
+            }
+            hashes.emplace_back(hash);
+        }
+        auto hasher = [&hashes] (size_t i) {
+            return hashes[i];
+        };
+        auto equal = [&rows, &pos] (size_t l, size_t r) {
+            for (const auto& p : pos) {
+                if (rows[l].values[p] != rows[r].values[p]) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        std::vector<bool> distinct(rows.size(), false);
+        {
+            folly::F14FastSet<size_t, decltype(hasher), decltype(equal)> seen(
+                rows.size(), hasher, equal);
+            for (size_t i = 0; i < rows.size(); i++) {
+                distinct[i] = seen.emplace(i).second;
+            }
+        }
+        size_t kept = 0;
+        for (size_t i = 0; i < rows.size(); i++) {
+            if (distinct[i]) {
+                if (kept != i) {
+                    rows[kept] = std::move(rows[i]);
+                }
+                kept++;
+            }
+        }
+        rows.resize(kept);
+
         std::sort(rows.begin(), rows.end(), [&pos](auto& l, auto& r) {
             for (const auto& p : pos) {
                 if (l.values[p] != r.values[p]) {
@@ -42,14 +88,6 @@ public:
             }
             return false;
         });
-        rows.erase(std::unique(rows.begin(), rows.end(), [&pos](auto& l, auto& r) {
-            for (const auto& p : pos) {
-                if (l.values[p] != r.values[p]) {
-                    return false;
-                }
-            }
-            return true;
-        }), rows.end());
     }
 
 private:
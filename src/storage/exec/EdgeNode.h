@@ -8,8 +8,15 @@
 #define STORAGE_EXEC_EDGENODE_H_
 
 #include "common/base/Base.h"
+#include "kvstore/MemEngine.h"
+#include "kvstore/Part.h"
 #include "storage/exec/RelNode.h"
+#include "storage/ResultCache.h"
 #include "storage/exec/StorageIterator.h"
+#include "storage/exec/CachedEdgeIterator.h"
+#include "storage/exec/EdgeRankRange.h"
+#include "storage/exec/ParallelEdgeIterator.h"
+#include "storage/exec/SampledEdgeIterator.h"
 #include "storage/transaction/TransactionManager.h"
 #include "storage/transaction/TossEdgeIterator.h"
 
@@ -80,6 +87,7 @@ protected:
         CHECK(!schemaIter->second.empty());
         schemas_ = &(schemaIter->second);
         ttl_ = QueryUtils::getEdgeTTLInfo(edgeContext_, std::abs(edgeType_));
+        keyOnly_ = QueryUtils::isKeyOnly(props_);
         edgeName_ = edgeContext_->edgeNames_[edgeType_];
     }
 
@@ -98,6 +106,7 @@ protected:
     const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>>* schemas_ = nullptr;
     folly::Optional<std::pair<std::string, int64_t>> ttl_;
     std::string edgeName_;
+    bool keyOnly_ = false;
 
     std::unique_ptr<SingleEdgeIterator> iter_;
     std::string prefix_;
@@ -135,7 +144,14 @@ public:
                                              *edgeKey.ranking_ref(),
                                              (*edgeKey.dst_ref()).getStr());
         std::unique_ptr<kvstore::KVIterator> iter;
-        ret = context_->env()->kvstore_->prefix(context_->spaceId(), partId, prefix_, &iter);
+        if (context_->pendingRow_ != nullptr) {
+            // the row written by the update combined before
+            iter = std::make_unique<kvstore::MemIter>(
+                std::vector<std::pair<std::string, std::string>>{*context_->pendingRow_});
+        } else {
+            LatencySpan span(context_->trace(), LatencyTrace::kKVRead);
+            ret = context_->prefix(partId, prefix_, &iter);
+        }
         if (ret == nebula::cpp2::ErrorCode::SUCCEEDED && iter && iter->valid()) {
             if (context_->env()->txnMan_ &&
                 context_->env()->txnMan_->enableToss(context_->spaceId())) {
@@ -165,6 +181,12 @@ public:
                    Expression* exp = nullptr)
         : EdgeNode(context, edgeContext, edgeType, props, expCtx, exp) {}
 
+    // Read at most so many edges by random seeks for a vertex with enough edges by the degree
+    // counters, see get_neighbors_approximate_sample_degree, 0 means reading all edges
+    void setSampleSize(size_t sampleSize) {
+        sampleSize_ = sampleSize;
+    }
+
     nebula::cpp2::ErrorCode execute(PartitionID partId, const VertexID& vId) override {
         auto ret = RelNode::execute(partId, vId);
         if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
@@ -173,24 +195,177 @@ public:
 
         VLOG(1) << "partId " << partId << ", vId " << vId << ", edgeType " << edgeType_
                 << ", prop size " << props_->size();
+        if (!context_->mayExist(partId, vId)) {
+            iter_.reset();
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
         std::unique_ptr<kvstore::KVIterator> iter;
-        prefix_ = NebulaKeyUtils::edgePrefix(context_->vIdLen(), partId, vId, edgeType_);
-        ret = context_->env()->kvstore_->prefix(context_->spaceId(), partId, prefix_, &iter);
+        // the prefix is rebuilt in place for each vertex, which allocates only once
+        prefix_.clear();
+        NebulaKeyUtils::appendEdgePrefix(&prefix_, context_->vIdLen(), partId, vId, edgeType_);
+        bool toss = context_->env()->txnMan_ &&
+                    context_->env()->txnMan_->enableToss(context_->spaceId());
+        auto* edgeCache = context_->env()->edgeCache_;
+        bool cacheHit = false;
+        const EdgeRankRange* rankRange = nullptr;
+        if (!toss) {
+            auto it = edgeContext_->rankRanges_.find(edgeType_);
+            if (it != edgeContext_->rankRanges_.end()) {
+                rankRange = &it->second;
+                if (rankRange->empty()) {
+                    iter_.reset();
+                    return nebula::cpp2::ErrorCode::SUCCEEDED;
+                }
+            }
+        }
+        {
+            LatencySpan span(context_->trace(), LatencyTrace::kKVRead);
+            if (rankRange != nullptr) {
+                // only the edges of the ranks the filter allows, the iterator refers to the bounds
+                rankRange->bounds(prefix_, &rangeStart_, &rangeEnd_);
+                ret = context_->range(partId, rangeStart_, rangeEnd_, &iter);
+            } else if (!toss && FLAGS_enable_edge_cache && edgeCache != nullptr) {
+                ret = readFromCache(partId, edgeCache, &iter, &cacheHit);
+            } else {
+                ret = context_->prefix(partId, prefix_, &iter);
+            }
+        }
         if (ret == nebula::cpp2::ErrorCode::SUCCEEDED && iter && iter->valid()) {
-            if (context_->env()->txnMan_ &&
-                context_->env()->txnMan_->enableToss(context_->spaceId())) {
+            if (toss) {
                 bool stopAtFirstEdge = false;
                 iter_.reset(new TossEdgeIterator(
                     context_, std::move(iter), edgeType_, schemas_, &ttl_, stopAtFirstEdge));
             } else {
+                auto* executor = context_->env()->edgeScanPool_;
+                bool parallel = !cacheHit && rankRange == nullptr && executor != nullptr &&
+                                FLAGS_super_vertex_scan_parallelism > 1;
+                if (!cacheHit && rankRange == nullptr && sampleSize_ > 0) {
+                    // a vertex with many edges is sampled by random seeks
+                    auto degree = context_->degree(partId, vId, edgeType_);
+                    if (degree.hasValue() &&
+                        degree.value() >= FLAGS_get_neighbors_approximate_sample_degree &&
+                        static_cast<size_t>(degree.value()) > sampleSize_) {
+                        iter = std::make_unique<SampledEdgeIterator>(
+                            context_, partId, prefix_, std::move(iter), sampleSize_);
+                        parallel = false;
+                    }
+                }
+                if (parallel) {
+                    // only the degree counted tells a super vertex without reading the edges
+                    auto degree = context_->degree(partId, vId, edgeType_);
+                    parallel = degree.hasValue() &&
+                               degree.value() >= FLAGS_super_vertex_edge_threshold;
+                }
+                if (parallel) {
+                    ret = scanInParallel(partId, executor, &iter);
+                    if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                        iter_.reset();
+                        return ret;
+                    }
+                }
                 iter_.reset(new SingleEdgeIterator(
-                    context_, std::move(iter), edgeType_, schemas_, &ttl_));
+                    context_, std::move(iter), edgeType_, schemas_, &ttl_, true, keyOnly_));
             }
         } else {
             iter_.reset();
         }
         return ret;
     }
+
+private:
+    // Replace the prefix iterator by a ParallelEdgeIterator on a snapshot of the part's engine,
+    // the leadership has been checked by the prefix iterator
+    nebula::cpp2::ErrorCode scanInParallel(PartitionID partId,
+                                           folly::Executor* executor,
+                                           std::unique_ptr<kvstore::KVIterator>* iter) {
+        auto part = context_->env()->kvstore_->part(context_->spaceId(), partId);
+        if (!nebula::ok(part)) {
+            return nebula::error(part);
+        }
+        auto parallel = std::make_unique<ParallelEdgeIterator>(
+            nebula::value(part)->engine(),
+            prefix_,
+            executor,
+            FLAGS_super_vertex_scan_parallelism,
+            FLAGS_super_vertex_scan_batch_size);
+        auto ret = parallel->init();
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return ret;
+        }
+        *iter = std::move(parallel);
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    // Get the edges from cache. When cache miss, the edges are read from kvstore and put into
+    // cache, unless there are more than FLAGS_edge_cache_max_edges of them. In that case,
+    // an entry of too many edges is put into cache instead, so we don't try it again until
+    // next write.
+    //
+    // The entry is only used when it is at the current write version of part, and the version
+    // is read before the part is read, so the edges read concurrently with a write are never
+    // used after it. The part is checked to be leader as kvstore does, unless follower read.
+    nebula::cpp2::ErrorCode readFromCache(PartitionID partId,
+                                          EdgeCache* edgeCache,
+                                          std::unique_ptr<kvstore::KVIterator>* iter,
+                                          bool* cacheHit) {
+        auto version = ResultCache::version(context_->env()->kvstore_, context_->spaceId(),
+                                            partId, context_->canReadFromFollower());
+        if (!version.has_value()) {
+            // the part is not found or not a leader, let kvstore report it
+            return context_->prefix(partId, prefix_, iter);
+        }
+        auto cacheKey = std::make_pair(context_->spaceId(), prefix_);
+        auto cached = edgeCache->get(cacheKey);
+        bool tooMany = false;
+        if (cached.ok()) {
+            auto entry = std::move(cached).value();
+            if (entry->version != *version) {
+                edgeCache->evict(cacheKey);
+            } else if (entry->tooMany) {
+                tooMany = true;
+            } else {
+                VLOG(1) << "Hit edge cache of edgeType " << edgeType_;
+                *cacheHit = true;
+                // aliases the entry, which is kept alive by the edges returned
+                iter->reset(new CachedEdgeIterator(
+                    std::shared_ptr<const CachedEdgeIterator::Edges>(entry, &entry->edges)));
+                return nebula::cpp2::ErrorCode::SUCCEEDED;
+            }
+        }
+
+        std::unique_ptr<kvstore::KVIterator> rest;
+        auto ret = context_->prefix(partId, prefix_, &rest);
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED || tooMany) {
+            // failed, or known to be too large to be cached
+            *iter = std::move(rest);
+            return ret;
+        }
+        auto entry = std::make_shared<EdgeCacheEntry>();
+        entry->version = *version;
+        entry->tooMany = false;
+        size_t maxEdges = std::max(FLAGS_edge_cache_max_edges, 0);
+        for (; rest->valid() && entry->edges.size() < maxEdges; rest->next()) {
+            entry->edges.emplace_back(rest->key().str(), rest->val().str());
+        }
+        if (rest->valid()) {
+            auto marker = std::make_shared<EdgeCacheEntry>();
+            marker->version = *version;
+            marker->tooMany = true;
+            edgeCache->insert(cacheKey, std::move(marker));
+        } else {
+            edgeCache->insert(cacheKey, entry);
+            rest.reset();
+        }
+        iter->reset(new CachedEdgeIterator(
+            std::shared_ptr<const CachedEdgeIterator::Edges>(entry, &entry->edges),
+            std::move(rest)));
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    // the bounds of the rank range read, kept alive with the iterator
+    std::string rangeStart_;
+    std::string rangeEnd_;
+    size_t sampleSize_{0};
 };
 
 }  // namespace storage
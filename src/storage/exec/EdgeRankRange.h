@@ -0,0 +1,158 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_EDGERANKRANGE_H_
+#define STORAGE_EXEC_EDGERANKRANGE_H_
+
+#include "common/base/Base.h"
+#include "common/expression/ConstantExpression.h"
+#include "common/expression/LogicalExpression.h"
+#include "common/expression/PropertyExpression.h"
+#include "common/expression/RelationalExpression.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+EdgeRankRange is the range of rank [lower_, upper_] the edges of an edge type must be in to pass
+a filter, which is narrowed by the comparisons between the rank and an int constant ANDed at the
+top of the filter, such as `e._rank >= 100 AND e._rank < 200 AND e.a > 1`. Since the rank is
+encoded in order right after the edge type in the edge key, SingleEdgeNode seeks to the first
+edge in the range and stops after the last one, instead of reading all edges of the type and
+dropping them by FilterNode. The filter is still evaluated for the edges in the range.
+*/
+struct EdgeRankRange {
+    EdgeRanking     lower_{std::numeric_limits<EdgeRanking>::min()};
+    EdgeRanking     upper_{std::numeric_limits<EdgeRanking>::max()};
+
+    bool empty() const {
+        return lower_ > upper_;
+    }
+
+    // The ranges of the edges restricted by the filter, by the edge name
+    static std::unordered_map<std::string, EdgeRankRange> collect(const Expression* filter) {
+        std::unordered_map<std::string, EdgeRankRange> ranges;
+        if (filter != nullptr) {
+            collect(filter, &ranges);
+        }
+        return ranges;
+    }
+
+    // The keys of the edges in the range under the prefix of a vertex and edge type are in
+    // [start, end)
+    void bounds(const std::string& prefix, std::string* start, std::string* end) const {
+        start->clear();
+        start->append(prefix);
+        NebulaKeyUtils::appendRank(start, lower_);
+        end->clear();
+        if (upper_ == std::numeric_limits<EdgeRanking>::max()) {
+            end->append(NebulaKeyUtils::prefixEnd(prefix));
+        } else {
+            end->append(prefix);
+            NebulaKeyUtils::appendRank(end, upper_ + 1);
+        }
+    }
+
+private:
+    static void collect(const Expression* exp,
+                        std::unordered_map<std::string, EdgeRankRange>* ranges) {
+        switch (exp->kind()) {
+            case Expression::Kind::kLogicalAnd: {
+                for (const auto* operand : static_cast<const LogicalExpression*>(exp)->operands()) {
+                    collect(operand, ranges);
+                }
+                return;
+            }
+            case Expression::Kind::kRelEQ:
+            case Expression::Kind::kRelLT:
+            case Expression::Kind::kRelLE:
+            case Expression::Kind::kRelGT:
+            case Expression::Kind::kRelGE: {
+                auto* relExp = static_cast<const RelationalExpression*>(exp);
+                auto kind = exp->kind();
+                const Expression* prop = relExp->left();
+                const Expression* constant = relExp->right();
+                if (prop->kind() == Expression::Kind::kConstant) {
+                    // `10 < e._rank` is `e._rank > 10`
+                    std::swap(prop, constant);
+                    kind = mirror(kind);
+                }
+                if (constant->kind() != Expression::Kind::kConstant || !isRank(prop)) {
+                    return;
+                }
+                const auto& value = static_cast<const ConstantExpression*>(constant)->value();
+                if (!value.isInt()) {
+                    return;
+                }
+                const auto& edgeName = static_cast<const PropertyExpression*>(prop)->sym();
+                (*ranges)[edgeName].narrow(kind, value.getInt());
+                return;
+            }
+            default:
+                return;
+        }
+    }
+
+    static bool isRank(const Expression* exp) {
+        return exp->kind() == Expression::Kind::kEdgeRank ||
+               (exp->kind() == Expression::Kind::kEdgeProperty &&
+                static_cast<const PropertyExpression*>(exp)->prop() == kRank);
+    }
+
+    static Expression::Kind mirror(Expression::Kind kind) {
+        switch (kind) {
+            case Expression::Kind::kRelLT:
+                return Expression::Kind::kRelGT;
+            case Expression::Kind::kRelLE:
+                return Expression::Kind::kRelGE;
+            case Expression::Kind::kRelGT:
+                return Expression::Kind::kRelLT;
+            case Expression::Kind::kRelGE:
+                return Expression::Kind::kRelLE;
+            default:
+                return kind;
+        }
+    }
+
+    void narrow(Expression::Kind kind, int64_t c) {
+        constexpr auto kMin = std::numeric_limits<EdgeRanking>::min();
+        constexpr auto kMax = std::numeric_limits<EdgeRanking>::max();
+        switch (kind) {
+            case Expression::Kind::kRelEQ:
+                lower_ = std::max(lower_, c);
+                upper_ = std::min(upper_, c);
+                break;
+            case Expression::Kind::kRelLT:
+                if (c == kMin) {
+                    lower_ = kMax;
+                    upper_ = kMin;
+                } else {
+                    upper_ = std::min(upper_, c - 1);
+                }
+                break;
+            case Expression::Kind::kRelLE:
+                upper_ = std::min(upper_, c);
+                break;
+            case Expression::Kind::kRelGT:
+                if (c == kMax) {
+                    lower_ = kMax;
+                    upper_ = kMin;
+                } else {
+                    lower_ = std::max(lower_, c + 1);
+                }
+                break;
+            default:
+                lower_ = std::max(lower_, c);
+                break;
+        }
+    }
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_EDGERANKRANGE_H_
@@ -9,6 +9,8 @@
 
 #include "common/base/Base.h"
 #include "common/expression/Expression.h"
+#include "storage/StorageFlags.h"
+#include "storage/exec/CompiledFilter.h"
 #include "storage/exec/HashJoinNode.h"
 #include "storage/context/StorageExpressionContext.h"
 
@@ -37,7 +39,11 @@ public:
         : IterateNode<T>(upstream)
         , context_(context)
         , expCtx_(expCtx)
-        , filterExp_(exp) {}
+        , filterExp_(exp) {
+        if (filterExp_ != nullptr && FLAGS_enable_compiled_filter) {
+            compiled_ = CompiledFilter::compile(filterExp_);
+        }
+    }
 
     nebula::cpp2::ErrorCode execute(PartitionID partId, const T& vId) override {
         auto ret = RelNode<T>::execute(partId, vId);
@@ -63,7 +69,14 @@ private:
     // return true when the value iter points to a value which can filter
     bool check() override {
         if (filterExp_ != nullptr) {
-            expCtx_->reset(this->reader(), this->key().str());
+            LatencySpan span(context_->trace(), LatencyTrace::kFilter);
+            expCtx_->reset(this->reader(), this->key());
+            if (compiled_ != nullptr) {
+                auto compiledRet = compiled_->evaluate(*expCtx_);
+                if (compiledRet.hasValue()) {
+                    return compiledRet.value();
+                }
+            }
             // result is false when filter out
             auto result = filterExp_->eval(*expCtx_);
             // NULL is always false
@@ -80,6 +93,8 @@ private:
     RunTimeContext                   *context_;
     StorageExpressionContext         *expCtx_;
     Expression                       *filterExp_;
+    // nullptr if the filter can't be compiled
+    std::unique_ptr<CompiledFilter>   compiled_;
 };
 
 }  // namespace storage
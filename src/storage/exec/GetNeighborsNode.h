@@ -8,9 +8,11 @@
 #define STORAGE_EXEC_GETNEIGHBORSNODE_H_
 
 #include "common/base/Base.h"
-#include "common/algorithm/ReservoirSampling.h"
+#include <folly/Random.h>
+#include <folly/container/F14Set.h>
 #include "storage/exec/AggregateNode.h"
 #include "storage/exec/HashJoinNode.h"
+#include "storage/exec/PropBlock.h"
 #include "storage/StorageFlags.h"
 
 
@@ -20,6 +22,13 @@ namespace storage {
 // GetNeighborsNode will generate a row in response of GetNeighbors, so it need to get the tag
 // result from HashJoinNode, and the stat info and edge iterator from AggregateNode. Then collect
 // some edge props, and put them into the target cell of a row.
+//
+// If dedupDst is true, only the first edge to each dst in a part is returned, the edges of later
+// vertices to the same dst are skipped, so the response is the distinct frontier of the part.
+// The skipped edges are not counted in the limit, but still counted in the stats.
+//
+// If columnar is true, the edges of each edge type are put into the target cell column by
+// column, see PropBlock::flushColumnar.
 class GetNeighborsNode : public QueryNode<VertexID> {
 public:
     using RelNode::execute;
@@ -29,13 +38,17 @@ public:
                      IterateNode<VertexID>* upstream,
                      EdgeContext* edgeContext,
                      nebula::DataSet* resultDataSet,
-                     int64_t limit = 0)
+                     int64_t limit = 0,
+                     bool dedupDst = false,
+                     bool columnar = false)
         : context_(context)
         , hashJoinNode_(hashJoinNode)
         , upstream_(upstream)
         , edgeContext_(edgeContext)
         , resultDataSet_(resultDataSet)
-        , limit_(limit) {}
+        , limit_(limit)
+        , dedupDst_(dedupDst)
+        , columnar_(columnar) {}
 
     nebula::cpp2::ErrorCode execute(PartitionID partId, const VertexID& vId) override {
         auto ret = RelNode::execute(partId, vId);
@@ -43,14 +56,22 @@ public:
             return ret;
         }
 
+        if (dedupDst_ && partId != dedupPartId_) {
+            intDsts_.clear();
+            strDsts_.clear();
+            dedupPartId_ = partId;
+        }
+
         if (context_->resultStat_ == ResultStatus::ILLEGAL_DATA) {
             return nebula::cpp2::ErrorCode::E_INVALID_DATA;
         }
+        // the temporary buffers of last vertex are not used any more
+        context_->arena()->reset();
 
         std::vector<Value> row;
         // vertexId is the first column
         if (context_->isIntId()) {
-            row.emplace_back(*reinterpret_cast<const int64_t*>(vId.data()));
+            row.emplace_back(QueryUtils::intVid(vId));
         } else {
             row.emplace_back(vId);
         }
@@ -86,21 +107,29 @@ protected:
     GetNeighborsNode() = default;
 
     virtual nebula::cpp2::ErrorCode iterateEdges(std::vector<Value>& row) {
+        if (FLAGS_get_neighbors_block_size > 0 || columnar_) {
+            return iterateEdgesInBlock(row);
+        }
         int64_t edgeRowCount = 0;
         nebula::List list;
-        for (; upstream_->valid(); upstream_->next(), ++edgeRowCount) {
+        for (; upstream_->valid(); upstream_->next()) {
             if (edgeRowCount >= limit_) {
                 return nebula::cpp2::ErrorCode::SUCCEEDED;
             }
+            if (!isNewDst()) {
+                continue;
+            }
+            ++edgeRowCount;
             auto key = upstream_->key();
-            auto reader = upstream_->reader();
             auto props = context_->props_;
+            auto reader = QueryUtils::isKeyOnly(props) ? nullptr : upstream_->reader();
             auto columnIdx = context_->columnIdx_;
 
             list.reserve(props->size());
             // collect props need to return
             if (!QueryUtils::collectEdgeProps(key, context_->vIdLen(), context_->isIntId(),
-                                              reader, props, list).ok()) {
+                                              reader, props, list,
+                                              context_->propIndexCache()).ok()) {
                 return nebula::cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND;
             }
 
@@ -114,14 +143,188 @@ protected:
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
 
+    // Collect edge props into a column-major PropBlock, the block is flushed into the target
+    // column when it is full, or when the edge type changes
+    nebula::cpp2::ErrorCode iterateEdgesInBlock(std::vector<Value>& row) {
+        if (block_ == nullptr) {
+            block_ = std::make_unique<PropBlock>(
+                FLAGS_get_neighbors_block_size > 0 ? FLAGS_get_neighbors_block_size : 1024);
+        }
+        int64_t edgeRowCount = 0;
+        size_t columnIdx = 0;
+        for (; upstream_->valid(); upstream_->next()) {
+            if (edgeRowCount >= limit_) {
+                break;
+            }
+            if (!isNewDst()) {
+                continue;
+            }
+            ++edgeRowCount;
+            // a columnar cell is flushed at once, only when the edge type changes
+            if ((block_->full() && !columnar_) ||
+                (!block_->empty() && columnIdx != context_->columnIdx_)) {
+                flushBlock(row, columnIdx);
+            }
+            columnIdx = context_->columnIdx_;
+            block_->reset(context_->props_);
+            // don't touch the reader if all columns are in key, so the edge isn't decoded
+            auto* reader = block_->needReader() ? upstream_->reader() : nullptr;
+            if (!block_->append(upstream_->key(), context_->vIdLen(), context_->isIntId(),
+                                reader).ok()) {
+                block_->clear();
+                return nebula::cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND;
+            }
+        }
+        if (!block_->empty()) {
+            flushBlock(row, columnIdx);
+        }
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    // return false if dedupDst_ is true, and the dst of current edge has been returned
+    bool isNewDst() {
+        if (!dedupDst_) {
+            return true;
+        }
+        auto dst = NebulaKeyUtils::getDstId(context_->vIdLen(), upstream_->key());
+        if (context_->isIntId()) {
+            return intDsts_.emplace(QueryUtils::intVid(dst)).second;
+        }
+        // the dst seen is found without copying it
+        if (strDsts_.count(dst) > 0) {
+            return false;
+        }
+        strDsts_.emplace(dst.str());
+        return true;
+    }
+
+    void flushBlock(std::vector<Value>& row, size_t columnIdx) {
+        // add edge prop value to the target column
+        if (row[columnIdx].empty()) {
+            row[columnIdx].setList(nebula::List());
+        }
+        if (columnar_) {
+            block_->flushColumnar(row[columnIdx].mutableList());
+        } else {
+            block_->flush(row[columnIdx].mutableList());
+        }
+    }
+
     RunTimeContext* context_;
     IterateNode<VertexID>* hashJoinNode_;
     IterateNode<VertexID>* upstream_;
     EdgeContext* edgeContext_;
     nebula::DataSet* resultDataSet_;
     int64_t limit_;
+    std::unique_ptr<PropBlock> block_;
+    bool dedupDst_ = false;
+    bool columnar_ = false;
+    // the dst returned in current part, int vid is kept as int64 to save memory
+    PartitionID dedupPartId_ = 0;
+    folly::F14FastSet<int64_t> intDsts_;
+    folly::F14FastSet<std::string> strDsts_;
 };
 
+// GetNeighborsTopKNode only returns the top k edges of each vertex sorted by the order by
+// expressions, k is the limit of request. It keeps a bounded heap of the edges, and the props
+// of an edge are collected only when it may be one of the top k edges.
+class GetNeighborsTopKNode : public GetNeighborsNode {
+public:
+    // each order by is a pair of expression and whether it is in ascending order
+    using OrderBy = std::vector<std::pair<Expression*, bool>>;
+
+    GetNeighborsTopKNode(RunTimeContext* context,
+                         IterateNode<VertexID>* hashJoinNode,
+                         IterateNode<VertexID>* upstream,
+                         EdgeContext* edgeContext,
+                         nebula::DataSet* resultDataSet,
+                         int64_t limit,
+                         StorageExpressionContext* expCtx,
+                         OrderBy orderBy)
+        : GetNeighborsNode(context, hashJoinNode, upstream, edgeContext, resultDataSet, limit)
+        , expCtx_(expCtx)
+        , orderBy_(std::move(orderBy)) {
+        CHECK(!orderBy_.empty());
+    }
+
+private:
+    struct Candidate {
+        std::vector<Value> keys_;
+        size_t columnIdx_;
+        nebula::List props_;
+    };
+
+    // return true if the edge with lhs keys should be placed before the edge with rhs keys
+    bool before(const std::vector<Value>& lhs, const std::vector<Value>& rhs) const {
+        for (size_t i = 0; i < orderBy_.size(); i++) {
+            if (lhs[i] == rhs[i]) {
+                continue;
+            }
+            return orderBy_[i].second ? lhs[i] < rhs[i] : rhs[i] < lhs[i];
+        }
+        return false;
+    }
+
+    nebula::cpp2::ErrorCode iterateEdges(std::vector<Value>& row) override {
+        if (limit_ <= 0) {
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+        // the top of heap is the last one of current top k edges
+        auto cmp = [this] (const Candidate& lhs, const Candidate& rhs) {
+            return before(lhs.keys_, rhs.keys_);
+        };
+        auto k = static_cast<size_t>(limit_);
+        heap_.clear();
+        for (; upstream_->valid(); upstream_->next()) {
+            std::vector<Value> keys;
+            keys.reserve(orderBy_.size());
+            expCtx_->reset(upstream_->reader(), upstream_->key());
+            for (auto& order : orderBy_) {
+                keys.emplace_back(order.first->eval(*expCtx_));
+            }
+            if (heap_.size() >= k && !before(keys, heap_.front().keys_)) {
+                continue;
+            }
+
+            Candidate candidate;
+            candidate.keys_ = std::move(keys);
+            candidate.columnIdx_ = context_->columnIdx_;
+            if (!QueryUtils::collectEdgeProps(upstream_->key(), context_->vIdLen(),
+                                              context_->isIntId(), upstream_->reader(),
+                                              context_->props_, candidate.props_,
+                                              context_->propIndexCache()).ok()) {
+                return nebula::cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND;
+            }
+            if (heap_.size() >= k) {
+                std::pop_heap(heap_.begin(), heap_.end(), cmp);
+                heap_.pop_back();
+            }
+            heap_.emplace_back(std::move(candidate));
+            std::push_heap(heap_.begin(), heap_.end(), cmp);
+        }
+
+        std::sort_heap(heap_.begin(), heap_.end(), cmp);
+        for (auto& candidate : heap_) {
+            // add edge prop value to the target column
+            auto& cell = row[candidate.columnIdx_];
+            if (cell.empty()) {
+                cell.setList(nebula::List());
+            }
+            cell.mutableList().values.emplace_back(std::move(candidate.props_));
+        }
+        heap_.clear();
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    StorageExpressionContext* expCtx_;
+    OrderBy orderBy_;
+    std::vector<Candidate> heap_;
+};
+
+// GetNeighborsSampleNode returns `limit` edges of each vertex sampled by reservoir sampling.
+// The key and value of a sampled edge are copied into the arena of RunTimeContext, and the
+// buffers of a sample replaced by a later edge are reused if they are large enough, so no
+// malloc for each edge.
 class GetNeighborsSampleNode : public GetNeighborsNode {
 public:
     GetNeighborsSampleNode(RunTimeContext* context,
@@ -130,62 +333,100 @@ public:
                            EdgeContext* edgeContext,
                            nebula::DataSet* resultDataSet,
                            int64_t limit)
-        : GetNeighborsNode(context, hashJoinNode, upstream, edgeContext, resultDataSet, limit) {
-            sampler_ = std::make_unique<nebula::algorithm::ReservoirSampling<Sample>>(limit);
-        }
+        : GetNeighborsNode(context, hashJoinNode, upstream, edgeContext, resultDataSet, limit) {}
 
 private:
-    using Sample = std::tuple<EdgeType,
-                              std::string,
-                              std::string,
-                              const std::vector<PropContext>*,
-                              size_t>;
+    struct Buffer {
+        void assign(RequestArena* arena, folly::StringPiece str) {
+            if (str.size() > capacity_) {
+                capacity_ = std::max(str.size(), capacity_ * 2);
+                data_ = arena->allocate(capacity_);
+            }
+            memcpy(data_, str.data(), str.size());
+            size_ = str.size();
+        }
+
+        folly::StringPiece str() const {
+            return folly::StringPiece(data_, size_);
+        }
+
+        char*   data_ = nullptr;
+        size_t  size_ = 0;
+        size_t  capacity_ = 0;
+    };
+
+    struct Sample {
+        EdgeType                            edgeType_;
+        Buffer                              key_;
+        Buffer                              val_;
+        const std::vector<PropContext>*     props_;
+        size_t                              columnIdx_;
+    };
 
     nebula::cpp2::ErrorCode iterateEdges(std::vector<Value>& row) override {
-        int64_t edgeRowCount = 0;
-        nebula::List list;
+        if (limit_ <= 0) {
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+        auto* arena = context_->arena();
+        auto k = static_cast<uint64_t>(limit_);
+        uint64_t edgeRowCount = 0;
+        samples_.clear();
         for (; upstream_->valid(); upstream_->next(), ++edgeRowCount) {
-            auto val = upstream_->val();
-            auto key = upstream_->key();
-            auto edgeType = context_->edgeType_;
-            auto props = context_->props_;
-            auto columnIdx = context_->columnIdx_;
-            sampler_->sampling(std::make_tuple(edgeType, val.str(), key.str(), props, columnIdx));
+            // the i-th edge replaces a random sample with probability k/(i+1)
+            uint64_t slot = edgeRowCount;
+            if (edgeRowCount < k) {
+                samples_.emplace_back();
+            } else {
+                slot = folly::Random::rand64(edgeRowCount + 1);
+                if (slot >= k) {
+                    continue;
+                }
+            }
+            auto& sample = samples_[slot];
+            sample.edgeType_ = context_->edgeType_;
+            sample.key_.assign(arena, upstream_->key());
+            sample.val_.assign(arena, upstream_->val());
+            sample.props_ = context_->props_;
+            sample.columnIdx_ = context_->columnIdx_;
         }
 
         RowReaderWrapper reader;
-        auto samples = std::move(*sampler_).samples();
-        for (auto& sample : samples) {
-            auto columnIdx = std::get<4>(sample);
+        nebula::List list;
+        for (auto& sample : samples_) {
+            auto columnIdx = sample.columnIdx_;
             // add edge prop value to the target column
             if (row[columnIdx].empty()) {
                 row[columnIdx].setList(nebula::List());
             }
 
-            auto edgeType = std::get<0>(sample);
-            const auto& val = std::get<1>(sample);
-            reader = RowReaderWrapper::getEdgePropReader(context_->env()->schemaMan_,
-                                                         context_->spaceId(),
-                                                         std::abs(edgeType),
-                                                         val);
-            if (!reader) {
-                continue;
+            auto key = sample.key_.str();
+            const auto* props = sample.props_;
+            if (QueryUtils::isKeyOnly(props)) {
+                reader.reset();
+            } else {
+                reader = RowReaderWrapper::getEdgePropReader(context_->env()->schemaMan_,
+                                                             context_->spaceId(),
+                                                             std::abs(sample.edgeType_),
+                                                             sample.val_.str());
+                if (!reader) {
+                    continue;
+                }
             }
 
-            const auto& key = std::get<2>(sample);
-            const auto& props = std::get<3>(sample);
             if (!QueryUtils::collectEdgeProps(key, context_->vIdLen(), context_->isIntId(),
-                                              reader.get(), props, list).ok()) {
+                                              reader.get(), props, list,
+                                              context_->propIndexCache()).ok()) {
                 return nebula::cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND;
             }
             auto& cell = row[columnIdx].mutableList();
             cell.values.emplace_back(std::move(list));
         }
+        samples_.clear();
 
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
 
-    std::unique_ptr<nebula::algorithm::ReservoirSampling<Sample>> sampler_;
+    std::vector<Sample> samples_;
 };
 
 }  // namespace storage
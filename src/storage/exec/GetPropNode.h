@@ -41,9 +41,11 @@ public:
         }
 
         List row;
+        // the rows of a request have the same columns, reserve as many as the last one
+        row.values.reserve(rowSize_);
         // vertexId is the first column
         if (context_->isIntId()) {
-            row.emplace_back(*reinterpret_cast<const int64_t*>(vId.data()));
+            row.emplace_back(QueryUtils::intVid(vId));
         } else {
             row.emplace_back(vId);
         }
@@ -63,8 +65,8 @@ public:
                                                               RowReader* reader,
                                                               const std::vector<PropContext>* props)
                 -> nebula::cpp2::ErrorCode {
-                    if (!QueryUtils::collectVertexProps(key, vIdLen, isIntId,
-                                                        reader, props, row).ok()) {
+                    if (!QueryUtils::collectVertexProps(key, vIdLen, isIntId, reader, props, row,
+                                                        context_->propIndexCache()).ok()) {
                         return nebula::cpp2::ErrorCode::E_TAG_PROP_NOT_FOUND;
                     }
                     if (FLAGS_enable_vertex_cache && vertexCache_ != nullptr) {
@@ -77,6 +79,7 @@ public:
                 return ret;
             }
         }
+        rowSize_ = row.size();
         resultDataSet_->rows.emplace_back(std::move(row));
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
@@ -86,6 +89,7 @@ private:
     std::vector<TagNode*>       tagNodes_;
     nebula::DataSet*            resultDataSet_;
     VertexCache*                vertexCache_;
+    size_t                      rowSize_ = 0;
 };
 
 class GetEdgePropNode : public QueryNode<cpp2::EdgeKey> {
@@ -106,6 +110,8 @@ public:
         }
 
         List row;
+        // the rows of a request have the same columns, reserve as many as the last one
+        row.values.reserve(rowSize_);
         auto vIdLen = context_->vIdLen();
         auto isIntId = context_->isIntId();
         for (auto* edgeNode : edgeNodes_) {
@@ -118,12 +124,12 @@ public:
                     }
                     return nebula::cpp2::ErrorCode::SUCCEEDED;
                 },
-                [&row, vIdLen, isIntId] (folly::StringPiece key,
-                                         RowReader* reader,
-                                         const std::vector<PropContext>* props)
+                [this, &row, vIdLen, isIntId] (folly::StringPiece key,
+                                               RowReader* reader,
+                                               const std::vector<PropContext>* props)
                 -> nebula::cpp2::ErrorCode {
-                    if (!QueryUtils::collectEdgeProps(key, vIdLen, isIntId,
-                                                      reader, props, row).ok()) {
+                    if (!QueryUtils::collectEdgeProps(key, vIdLen, isIntId, reader, props, row,
+                                                      context_->propIndexCache()).ok()) {
                         return nebula::cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND;
                     }
                     return nebula::cpp2::ErrorCode::SUCCEEDED;
@@ -132,6 +138,7 @@ public:
                 return ret;
             }
         }
+        rowSize_ = row.size();
         resultDataSet_->rows.emplace_back(std::move(row));
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
@@ -140,6 +147,7 @@ private:
     RunTimeContext*                         context_;
     std::vector<EdgeNode<cpp2::EdgeKey>*>   edgeNodes_;
     nebula::DataSet*                        resultDataSet_;
+    size_t                                  rowSize_ = 0;
 };
 
 }  // namespace storage
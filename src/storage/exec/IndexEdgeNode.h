@@ -32,21 +32,18 @@ public:
             return ret;
         }
 
-        auto ttlProp = CommonUtils::ttlProps(context_->edgeSchema_);
+        IndexTTL ttl(context_->edgeSchema_);
 
         data_.clear();
         std::vector<storage::cpp2::EdgeKey> edges;
         auto* iter = static_cast<EdgeIndexIterator*>(indexScanNode_->iterator());
         while (iter && iter->valid()) {
-            if (!iter->val().empty() && ttlProp.first) {
-                auto v = IndexKeyUtils::parseIndexTTL(iter->val());
-                if (CommonUtils::checkDataExpiredForTTL(context_->edgeSchema_,
-                                                        std::move(v),
-                                                        ttlProp.second.second,
-                                                        ttlProp.second.first)) {
-                    iter->next();
-                    continue;
-                }
+            if (ttl.expired(iter->val())) {
+                iter->next();
+                continue;
+            }
+            if (indexScanNode_->limitReached(iter->key())) {
+                break;
             }
             storage::cpp2::EdgeKey edge;
             edge.set_src(iter->srcId());
@@ -56,6 +53,10 @@ public:
             edges.emplace_back(std::move(edge));
             iter->next();
         }
+        ret = indexScanNode_->scanError();
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return ret;
+        }
         for (const auto& edge : edges) {
             auto prefix = NebulaKeyUtils::edgePrefix(context_->vIdLen(),
                                                      partId,
@@ -65,7 +66,8 @@ public:
                                                      (*edge.dst_ref()).getStr());
             std::unique_ptr<kvstore::KVIterator> eIter;
             ret = context_->env()->kvstore_->prefix(context_->spaceId(),
-                                                       partId, prefix, &eIter);
+                                                       partId, prefix, &eIter,
+                                                       context_->canReadFromFollower());
             if (ret == nebula::cpp2::ErrorCode::SUCCEEDED && eIter && eIter->valid()) {
                 data_.emplace_back(eIter->key(), eIter->val());
             } else {
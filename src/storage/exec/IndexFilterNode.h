@@ -62,6 +62,10 @@ public:
         std::vector<kvstore::KV> data;
         if (evalExprByIndex_) {
             data = indexScanNode_->moveData();
+            ret = indexScanNode_->scanError();
+            if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                return ret;
+            }
         } else if (isEdge_) {
             data = indexEdgeNode_->moveData();
         } else {
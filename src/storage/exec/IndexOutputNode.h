@@ -89,7 +89,11 @@ public:
 
         switch (type_) {
             case IndexResultType::kEdgeFromIndexScan: {
-                ret = collectResult(indexScanNode_->moveData());
+                auto data = indexScanNode_->moveData();
+                ret = indexScanNode_->scanError();
+                if (ret == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    ret = collectResult(data);
+                }
                 break;
             }
             case IndexResultType::kEdgeFromIndexFilter: {
@@ -105,7 +109,11 @@ public:
                 break;
             }
             case IndexResultType::kVertexFromIndexScan: {
-                ret = collectResult(indexScanNode_->moveData());
+                auto data = indexScanNode_->moveData();
+                ret = indexScanNode_->scanError();
+                if (ret == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    ret = collectResult(data);
+                }
                 break;
             }
             case IndexResultType::kVertexFromIndexFilter: {
@@ -178,10 +186,13 @@ private:
     }
 
     nebula::cpp2::ErrorCode vertexRowsFromIndex(const std::vector<kvstore::KV>& data) {
+        locateIndexFields();
+        const auto& colNames = result_->colNames;
         for (const auto& val : data) {
             Row row;
-            for (const auto& col : result_->colNames) {
-                auto ret = addIndexValue(row, val, col);
+            row.values.reserve(colNames.size());
+            for (size_t i = 0; i < colNames.size(); i++) {
+                auto ret = addIndexValue(row, val, colNames[i], indexFields_[i]);
                 if (!ret.ok()) {
                     return nebula::cpp2::ErrorCode::E_INVALID_DATA;
                 }
@@ -217,10 +228,13 @@ private:
     }
 
     nebula::cpp2::ErrorCode edgeRowsFromIndex(const std::vector<kvstore::KV>& data) {
+        locateIndexFields();
+        const auto& colNames = result_->colNames;
         for (const auto& val : data) {
             Row row;
-            for (const auto& col : result_->colNames) {
-                auto ret = addIndexValue(row, val, col);
+            row.values.reserve(colNames.size());
+            for (size_t i = 0; i < colNames.size(); i++) {
+                auto ret = addIndexValue(row, val, colNames[i], indexFields_[i]);
                 if (!ret.ok()) {
                     return nebula::cpp2::ErrorCode::E_INVALID_DATA;
                 }
@@ -237,11 +251,7 @@ private:
         switch (QueryUtils::toReturnColType(col)) {
             case QueryUtils::ReturnColType::kVid : {
                 auto vId = NebulaKeyUtils::getVertexId(context_->vIdLen(), data.first);
-                if (context_->isIntId()) {
-                    row.emplace_back(*reinterpret_cast<const int64_t*>(vId.data()));
-                } else {
-                    row.emplace_back(vId.subpiece(0, vId.find_first_of('\0')).toString());
-                }
+                row.emplace_back(QueryUtils::vIdValue(vId, context_->isIntId()));
                 break;
             }
             case QueryUtils::ReturnColType::kTag : {
@@ -250,11 +260,7 @@ private:
             }
             case QueryUtils::ReturnColType::kSrc : {
                 auto src = NebulaKeyUtils::getSrcId(context_->vIdLen(), data.first);
-                if (context_->isIntId()) {
-                    row.emplace_back(*reinterpret_cast<const int64_t*>(src.data()));
-                } else {
-                    row.emplace_back(src.subpiece(0, src.find_first_of('\0')).toString());
-                }
+                row.emplace_back(QueryUtils::vIdValue(src, context_->isIntId()));
                 break;
             }
             case QueryUtils::ReturnColType::kType : {
@@ -267,11 +273,7 @@ private:
             }
             case QueryUtils::ReturnColType::kDst : {
                 auto dst = NebulaKeyUtils::getDstId(context_->vIdLen(), data.first);
-                if (context_->isIntId()) {
-                    row.emplace_back(*reinterpret_cast<const int64_t*>(dst.data()));
-                } else {
-                    row.emplace_back(dst.subpiece(0, dst.find_first_of('\0')).toString());
-                }
+                row.emplace_back(QueryUtils::vIdValue(dst, context_->isIntId()));
                 break;
             }
             default: {
@@ -286,16 +288,32 @@ private:
         return Status::OK();
     }
 
+    // The yield columns are decoded from every index key, so where they are in the key is only
+    // located once, instead of searching the index columns for each column of each row.
+    void locateIndexFields() {
+        if (indexFields_.size() == result_->colNames.size()) {
+            return;
+        }
+        indexFields_.clear();
+        for (const auto& col : result_->colNames) {
+            IndexKeyUtils::IndexField field;
+            if (QueryUtils::toReturnColType(col) == QueryUtils::ReturnColType::kOther) {
+                // a column not in index is decoded as BAD_DATA, the same as before
+                IndexKeyUtils::locateIndexField(col, fields_, hasNullableCol_, field);
+            }
+            indexFields_.emplace_back(std::move(field));
+        }
+    }
+
     // Add the value by index key
-    Status addIndexValue(Row& row, const kvstore::KV& data, const std::string& col) {
+    Status addIndexValue(Row& row,
+                         const kvstore::KV& data,
+                         const std::string& col,
+                         const IndexKeyUtils::IndexField& field) {
         switch (QueryUtils::toReturnColType(col)) {
             case QueryUtils::ReturnColType::kVid : {
                 auto vId = IndexKeyUtils::getIndexVertexID(context_->vIdLen(), data.first);
-                if (context_->isIntId()) {
-                    row.emplace_back(*reinterpret_cast<const int64_t*>(vId.data()));
-                } else {
-                    row.emplace_back(vId.subpiece(0, vId.find_first_of('\0')).toString());
-                }
+                row.emplace_back(QueryUtils::vIdValue(vId, context_->isIntId()));
                 break;
             }
             case QueryUtils::ReturnColType::kTag : {
@@ -304,11 +322,7 @@ private:
             }
             case QueryUtils::ReturnColType::kSrc : {
                 auto src = IndexKeyUtils::getIndexSrcId(context_->vIdLen(), data.first);
-                if (context_->isIntId()) {
-                    row.emplace_back(*reinterpret_cast<const int64_t*>(src.data()));
-                } else {
-                    row.emplace_back(src.subpiece(0, src.find_first_of('\0')).toString());
-                }
+                row.emplace_back(QueryUtils::vIdValue(src, context_->isIntId()));
                 break;
             }
             case QueryUtils::ReturnColType::kType : {
@@ -321,21 +335,14 @@ private:
             }
             case QueryUtils::ReturnColType::kDst : {
                 auto dst = IndexKeyUtils::getIndexDstId(context_->vIdLen(), data.first);
-                if (context_->isIntId()) {
-                    row.emplace_back(*reinterpret_cast<const int64_t*>(dst.data()));
-                } else {
-                    row.emplace_back(dst.subpiece(0, dst.find_first_of('\0')).toString());
-                }
+                row.emplace_back(QueryUtils::vIdValue(dst, context_->isIntId()));
                 break;
             }
             default: {
-                auto v = IndexKeyUtils::getValueFromIndexKey(context_->vIdLen(),
-                                                             data.first,
-                                                             col,
-                                                             fields_,
-                                                             context_->isEdge(),
-                                                             hasNullableCol_);
-                row.emplace_back(std::move(v));
+                row.emplace_back(IndexKeyUtils::getValueFromIndexKey(context_->vIdLen(),
+                                                                     data.first,
+                                                                     field,
+                                                                     context_->isEdge()));
             }
         }
         return Status::OK();
@@ -351,6 +358,8 @@ private:
     IndexFilterNode<T>*                               indexFilterNode_{nullptr};
     bool                                              hasNullableCol_{};
     std::vector<meta::cpp2::ColumnDef>                fields_;
+    // position in index key of each yield column, only used when decoding from index
+    std::vector<IndexKeyUtils::IndexField>            indexFields_;
 };
 
 }  // namespace storage
@@ -8,8 +8,12 @@
 #define STORAGE_EXEC_INDEXSCANNODE_H_
 
 #include "common/base/Base.h"
+#include "codec/RowReaderWrapper.h"
+#include "storage/exec/IntersectIndexIterator.h"
+#include "storage/exec/ParallelRangeIterator.h"
 #include "storage/exec/RelNode.h"
 #include "storage/exec/StorageIterator.h"
+#include "storage/exec/VerifiedIndexIterator.h"
 
 namespace nebula {
 namespace storage {
@@ -31,13 +35,69 @@ public:
          * if all scanType are PREFIX, means the index scan is prefix scan.
          * there should be only one RANGE hnit, and it must be the last one.
          */
-        for (size_t i = 0; i < columnHints_.size(); i++) {
-            if (columnHints_[i].get_scan_type() == cpp2::ScanType::RANGE) {
-                isRangeScan_ = true;
-                CHECK_EQ(columnHints_.size() - 1, i);
-                break;
+        isRangeScan_ = isRangeScan(columnHints_);
+    }
+
+    /**
+     * Intersect with another index of the same tag or edge, only the index keys whose vertex
+     * (or edge) is also in the scan of `columnHints` on that index are returned. The other
+     * index is only scanned for the tail of index key, no data is read for it.
+     */
+    void intersectWith(IndexID indexId, std::vector<cpp2::IndexColumnHint> columnHints) {
+        intersections_.emplace_back(indexId, std::move(columnHints));
+    }
+
+    /**
+     * Stop the scan of each part after `limit` index keys, and the keys after them with the same
+     * first `tieLen` bytes, i.e. the same values of the columns ordered by. Since the keys are
+     * sorted, the keys taken are the first ones of the part in that order. It is only set if
+     * no filter drops the keys taken.
+     */
+    void setLimit(size_t limit, size_t tieLen) {
+        limit_ = limit;
+        tieLen_ = tieLen;
+    }
+
+    /**
+     * Whether the scan stops before the key, otherwise the key is counted as taken. It is
+     * called for each key not expired by the nodes reading the iterator.
+     */
+    bool limitReached(folly::StringPiece key) {
+        if (taken_ < limit_) {
+            if (++taken_ == limit_ && tieLen_ > 0) {
+                lastTie_.assign(key.data(), std::min(key.size(), tieLen_));
             }
+            return false;
+        }
+        return tieLen_ == 0 || key.size() < tieLen_ || key.subpiece(0, tieLen_) != lastTie_;
+    }
+
+    /**
+     * Count the index keys in the scan of the part, at most `limit`, which is used as the
+     * estimated rows when choosing among the indexes of one condition.
+     */
+    size_t estimateRows(PartitionID partId, size_t limit) {
+        auto scanRet = scanStr(partId, indexId_, columnHints_, isRangeScan_);
+        if (!scanRet.ok()) {
+            return limit;
+        }
+        const auto& [start, end] = scanRet.value();
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto ret = isRangeScan_
+                   ? context_->env()->kvstore_->range(context_->spaceId(), partId,
+                                                      start, end, &iter,
+                                                      context_->canReadFromFollower())
+                   : context_->env()->kvstore_->prefix(context_->spaceId(), partId,
+                                                       start, &iter,
+                                                       context_->canReadFromFollower());
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return limit;
         }
+        size_t rows = 0;
+        for (; iter && iter->valid() && rows < limit; iter->next()) {
+            rows++;
+        }
+        return rows;
     }
 
     nebula::cpp2::ErrorCode execute(PartitionID partId) override {
@@ -45,23 +105,60 @@ public:
         if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
             return ret;
         }
-        auto scanRet = scanStr(partId);
+        std::vector<StringCheck> checks;
+        auto scanRet = scanStr(partId, indexId_, columnHints_, isRangeScan_, &checks);
         if (!scanRet.ok()) {
             return nebula::cpp2::ErrorCode::E_INVALID_FIELD_VALUE;
         }
+        taken_ = 0;
+        parallel_ = nullptr;
         scanPair_ = scanRet.value();
         std::unique_ptr<kvstore::KVIterator> iter;
         ret = isRangeScan_
               ? context_->env()->kvstore_->range(context_->spaceId(), partId,
-                  scanPair_.first, scanPair_.second, &iter)
+                  scanPair_.first, scanPair_.second, &iter, context_->canReadFromFollower())
               : context_->env()->kvstore_->prefix(context_->spaceId(), partId,
-                  scanPair_.first, &iter);
+                  scanPair_.first, &iter, context_->canReadFromFollower());
         if (ret == nebula::cpp2::ErrorCode::SUCCEEDED && iter && iter->valid()) {
+            auto* executor = context_->env()->edgeScanPool_;
+            // the keys read ahead in parallel are a waste if only the first ones are taken
+            if (isRangeScan_ && executor != nullptr && FLAGS_index_scan_parallelism > 1 &&
+                limit_ == std::numeric_limits<size_t>::max()) {
+                auto parallel = std::make_unique<ParallelRangeIterator>(
+                    context_->env()->kvstore_,
+                    context_->spaceId(),
+                    partId,
+                    scanPair_.second,
+                    std::move(iter),
+                    executor,
+                    FLAGS_index_scan_parallel_threshold,
+                    FLAGS_index_scan_parallelism,
+                    context_->canReadFromFollower(),
+                    context_->budget());
+                parallel_ = parallel.get();
+                iter = std::move(parallel);
+            }
+            if (!intersections_.empty()) {
+                IndexKeyTails tails(tailLen(), context_->isIntId());
+                ret = collectIntersection(partId, tails);
+                if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    iter_.reset();
+                    parallel_ = nullptr;
+                    return ret;
+                }
+                iter = std::make_unique<IntersectIndexIterator>(std::move(iter),
+                                                                std::move(tails));
+            }
+            if (!checks.empty()) {
+                iter = std::make_unique<VerifiedIndexIterator>(
+                    std::move(iter), verifier(partId, std::move(checks)));
+            }
             context_->isEdge()
             ? iter_.reset(new EdgeIndexIterator(std::move(iter), context_->vIdLen()))
             : iter_.reset(new VertexIndexIterator(std::move(iter), context_->vIdLen()));
         } else {
             iter_.reset();
+            parallel_ = nullptr;
             return ret;
         }
         return nebula::cpp2::ErrorCode::SUCCEEDED;
@@ -71,20 +168,30 @@ public:
         return iter_.get();
     }
 
+    /**
+     * The error of the scan of part after the iterator is exhausted, since a sub-range scanned
+     * in parallel could fail in the middle. The nodes reading the iterator should check it.
+     */
+    nebula::cpp2::ErrorCode scanError() const {
+        return parallel_ != nullptr ? parallel_->status() : nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
     std::vector<kvstore::KV> moveData() {
-        auto* sh = context_->isEdge() ? context_->edgeSchema_ : context_->tagSchema_;
-        auto ttlProp = CommonUtils::ttlProps(sh);
+        IndexTTL ttl(context_->isEdge() ? context_->edgeSchema_ : context_->tagSchema_);
         data_.clear();
+        auto* budget = context_->budget();
         while (!!iter_ && iter_->valid()) {
-            if (!iter_->val().empty() && ttlProp.first) {
-                auto v = IndexKeyUtils::parseIndexTTL(iter_->val());
-                if (CommonUtils::checkDataExpiredForTTL(sh,
-                                                        std::move(v),
-                                                        ttlProp.second.second,
-                                                        ttlProp.second.first)) {
-                    iter_->next();
-                    continue;
-                }
+            // the rest are dropped once the budget of request is exhausted
+            if (budget != nullptr &&
+                !budget->consume(iter_->key().size() + iter_->val().size())) {
+                break;
+            }
+            if (ttl.expired(iter_->val())) {
+                iter_->next();
+                continue;
+            }
+            if (limitReached(iter_->key())) {
+                break;
             }
             data_.emplace_back(iter_->key(), "");
             iter_->next();
@@ -93,25 +200,117 @@ public:
     }
 
 private:
-    StatusOr<std::pair<std::string, std::string>> scanStr(PartitionID partId) {
+    /**
+     * A hint on a compact string column, see index_string_prefix_len. The index keys of it
+     * sharing the prefix with a boundary, which does not fit in the prefix, are verified
+     * against the rows they point to, since the prefix and the hash could not tell the value.
+     */
+    struct StringCheck {
+        std::string     name;
+        // of the prefix in the index key
+        size_t          offset{0};
+        int16_t         len{0};
+        bool            isRange{false};
+        // the boundaries padded to the length of column, the value looked up if not a range
+        std::string     begin;
+        std::string     end;
+        bool            verifyBegin{false};
+        bool            verifyEnd{false};
+    };
+
+    static bool isRangeScan(const std::vector<cpp2::IndexColumnHint>& columnHints) {
+        for (size_t i = 0; i < columnHints.size(); i++) {
+            if (columnHints[i].get_scan_type() == cpp2::ScanType::RANGE) {
+                CHECK_EQ(columnHints.size() - 1, i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // the tail of index key is the vid of vertex, or the src, rank and dst of edge
+    size_t tailLen() const {
+        return context_->isEdge()
+               ? context_->vIdLen() * 2 + sizeof(EdgeRanking)
+               : context_->vIdLen();
+    }
+
+    // Collect the vertices (or edges) which are in the scans of all intersected indexes
+    nebula::cpp2::ErrorCode collectIntersection(PartitionID partId, IndexKeyTails& result) {
+        auto* budget = context_->budget();
+        for (size_t i = 0; i < intersections_.size(); i++) {
+            const auto& [indexId, columnHints] = intersections_[i];
+            auto isRange = isRangeScan(columnHints);
+            std::vector<StringCheck> checks;
+            auto scanRet = scanStr(partId, indexId, columnHints, isRange, &checks);
+            if (!scanRet.ok()) {
+                return nebula::cpp2::ErrorCode::E_INVALID_FIELD_VALUE;
+            }
+            const auto& [start, end] = scanRet.value();
+            std::unique_ptr<kvstore::KVIterator> iter;
+            auto ret = isRange
+                       ? context_->env()->kvstore_->range(context_->spaceId(), partId,
+                                                          start, end, &iter,
+                                                          context_->canReadFromFollower())
+                       : context_->env()->kvstore_->prefix(context_->spaceId(), partId,
+                                                           start, &iter,
+                                                           context_->canReadFromFollower());
+            if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                return ret;
+            }
+            if (iter && iter->valid() && !checks.empty()) {
+                iter = std::make_unique<VerifiedIndexIterator>(
+                    std::move(iter), verifier(partId, std::move(checks)));
+            }
+            IndexKeyTails tails(tailLen(), context_->isIntId());
+            for (; iter && iter->valid(); iter->next()) {
+                if (budget != nullptr &&
+                    !budget->consume(iter->key().size() + iter->val().size())) {
+                    break;
+                }
+                tails.insert(iter->key());
+            }
+            if (i == 0) {
+                result = std::move(tails);
+            } else {
+                result.intersect(tails);
+            }
+            if (result.size() == 0) {
+                // nothing left, no need to scan the others
+                break;
+            }
+        }
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    StatusOr<std::pair<std::string, std::string>> scanStr(
+        PartitionID partId,
+        IndexID indexId,
+        const std::vector<cpp2::IndexColumnHint>& columnHints,
+        bool isRange,
+        std::vector<StringCheck>* checks = nullptr) {
         auto iRet = context_->isEdge()
-                    ? context_->env()->indexMan_->getEdgeIndex(context_->spaceId(), indexId_)
-                    : context_->env()->indexMan_->getTagIndex(context_->spaceId(), indexId_);
+                    ? context_->env()->indexMan_->getEdgeIndex(context_->spaceId(), indexId)
+                    : context_->env()->indexMan_->getTagIndex(context_->spaceId(), indexId);
         if (!iRet.ok()) {
             return Status::IndexNotFound();
         }
-        if (isRangeScan_) {
-            return getRangeStr(partId, iRet.value()->get_fields());
+        if (isRange) {
+            return getRangeStr(partId, indexId, columnHints, iRet.value()->get_fields(), checks);
         } else {
-            return getPrefixStr(partId, iRet.value()->get_fields());
+            return getPrefixStr(partId, indexId, columnHints, iRet.value()->get_fields(), checks);
         }
     }
 
     StatusOr<std::pair<std::string, std::string>> getPrefixStr(
-        PartitionID partId, const std::vector< ::nebula::meta::cpp2::ColumnDef>& fields) {
+        PartitionID partId,
+        IndexID indexId,
+        const std::vector<cpp2::IndexColumnHint>& columnHints,
+        const std::vector< ::nebula::meta::cpp2::ColumnDef>& fields,
+        std::vector<StringCheck>* checks) {
         std::string prefix;
-        prefix.append(IndexKeyUtils::indexPrefix(partId, indexId_));
-        for (auto& col : columnHints_) {
+        prefix.append(IndexKeyUtils::indexPrefix(partId, indexId));
+        for (auto& col : columnHints) {
             auto iter = std::find_if(fields.begin(), fields.end(), [col](const auto& field) {
                 return col.get_column_name() == field.get_name();
             });
@@ -123,17 +322,22 @@ private:
             if (type == Value::Type::STRING && !iter->type.type_length_ref().has_value()) {
                 return Status::Error("String property index has not set prefix length.");
             }
-            prefix.append(encodeValue(*col.begin_value_ref(), type, iter->type.get_type_length()));
+            prefix.append(encodeValue(*col.begin_value_ref(), *iter));
+            addCheck(checks, col, fields, false);
         }
         return std::make_pair(prefix, "");
     }
 
     StatusOr<std::pair<std::string, std::string>> getRangeStr(
-        PartitionID partId, const std::vector< ::nebula::meta::cpp2::ColumnDef>& fields) {
+        PartitionID partId,
+        IndexID indexId,
+        const std::vector<cpp2::IndexColumnHint>& columnHints,
+        const std::vector< ::nebula::meta::cpp2::ColumnDef>& fields,
+        std::vector<StringCheck>* checks) {
         std::string start, end;
-        start.append(IndexKeyUtils::indexPrefix(partId, indexId_));
-        end.append(IndexKeyUtils::indexPrefix(partId, indexId_));
-        for (auto& col : columnHints_) {
+        start.append(IndexKeyUtils::indexPrefix(partId, indexId));
+        end.append(IndexKeyUtils::indexPrefix(partId, indexId));
+        for (auto& col : columnHints) {
             auto iter = std::find_if(fields.begin(), fields.end(), [col](const auto& field) {
                 return col.get_column_name() == field.get_name();
             });
@@ -146,30 +350,161 @@ private:
                 return Status::Error("String property index has not set prefix length.");
             }
             if (col.get_scan_type() == cpp2::ScanType::PREFIX) {
-                start.append(encodeValue(*col.begin_value_ref(),
-                            type, iter->type.get_type_length()));
-                end.append(encodeValue(*col.begin_value_ref(),
-                            type, iter->type.get_type_length()));
+                start.append(encodeValue(*col.begin_value_ref(), *iter));
+                end.append(encodeValue(*col.begin_value_ref(), *iter));
+                addCheck(checks, col, fields, false);
+            } else if (IndexKeyUtils::isCompactString(*iter)) {
+                // a compact string is ordered by the prefix only, the keys of the prefix of
+                // begin are all after it, and the keys of the prefix of end are all before
+                // it unless the end does not fit in the prefix
+                const auto& begin = *col.begin_value_ref();
+                const auto& endVal = *col.end_value_ref();
+                auto len = *iter->type.get_type_length();
+                auto prefixLen = IndexKeyUtils::compactPrefixLen();
+                start.append(begin.isNull() ? encodeValue(begin, *iter)
+                                            : IndexKeyUtils::encodeValue(begin, len)
+                                                  .substr(0, prefixLen));
+                if (endVal.isNull()) {
+                    end.append(encodeValue(endVal, *iter));
+                } else {
+                    auto full = IndexKeyUtils::encodeValue(endVal, len);
+                    end.append(full.data(), prefixLen);
+                    if (!IndexKeyUtils::fitsCompactPrefix(full)) {
+                        end = NebulaKeyUtils::prefixEnd(end);
+                    }
+                }
+                addCheck(checks, col, fields, true);
             } else {
-                start.append(encodeValue(*col.begin_value_ref(),
-                            type, iter->type.get_type_length()));
-                end.append(encodeValue(*col.end_value_ref(),
-                            type, iter->type.get_type_length()));
+                start.append(encodeValue(*col.begin_value_ref(), *iter));
+                end.append(encodeValue(*col.end_value_ref(), *iter));
             }
         }
         return std::make_pair(start, end);
     }
 
-    // precondition: if type is STRING, strLen must be valid
-    std::string encodeValue(const Value& val, Value::Type type, const int16_t* strLen) {
-        if (val.isNull()) {
-            return IndexKeyUtils::encodeNullValue(type, strLen);
-        }
-        if (type == Value::Type::STRING) {
-            return IndexKeyUtils::encodeValue(val, *strLen);
+    // precondition: if field is STRING, the type length of it must be valid
+    std::string encodeValue(const Value& val, const ::nebula::meta::cpp2::ColumnDef& field) {
+        auto type = IndexKeyUtils::toValueType(field.type.get_type());
+        auto strLen = field.type.get_type_length();
+        std::string raw;
+        if (IndexKeyUtils::isCompactString(field)) {
+            if (val.isNull()) {
+                raw.append(IndexKeyUtils::indexFieldLen(field), static_cast<char>(0xFF));
+            } else {
+                IndexKeyUtils::appendCompactString(&raw, val, *strLen);
+            }
+        } else if (val.isNull()) {
+            IndexKeyUtils::appendNullValue(&raw, type, strLen);
+        } else if (type == Value::Type::STRING) {
+            IndexKeyUtils::appendValue(&raw, val, *strLen);
         } else {
-            return IndexKeyUtils::encodeValue(val);
+            IndexKeyUtils::appendValue(&raw, val);
+        }
+        return raw;
+    }
+
+    // Add the check of the hint if it is on a compact string column and not on a null
+    static void addCheck(std::vector<StringCheck>* checks,
+                         const cpp2::IndexColumnHint& hint,
+                         const std::vector< ::nebula::meta::cpp2::ColumnDef>& fields,
+                         bool isRange) {
+        if (checks == nullptr) {
+            return;
+        }
+        auto col = std::find_if(fields.begin(), fields.end(), [&hint] (const auto& f) {
+            return f.get_name() == hint.get_column_name();
+        });
+        IndexKeyUtils::IndexField field;
+        if (col == fields.end() || !IndexKeyUtils::isCompactString(*col) ||
+            !IndexKeyUtils::locateIndexField(col->get_name(), fields, false, field)) {
+            return;
+        }
+        auto hasValue = [] (const auto& ref) {
+            return ref.has_value() && !(*ref).isNull();
+        };
+        if (!hasValue(hint.begin_value_ref()) || (isRange && !hasValue(hint.end_value_ref()))) {
+            return;
+        }
+        StringCheck check;
+        check.name = col->get_name();
+        check.offset = field.offset_;
+        check.len = *col->type.get_type_length();
+        check.isRange = isRange;
+        check.begin = IndexKeyUtils::encodeValue(*hint.begin_value_ref(), check.len);
+        check.verifyBegin = !IndexKeyUtils::fitsCompactPrefix(check.begin);
+        if (isRange) {
+            check.end = IndexKeyUtils::encodeValue(*hint.end_value_ref(), check.len);
+            check.verifyEnd = !IndexKeyUtils::fitsCompactPrefix(check.end);
+        }
+        if (check.verifyBegin || check.verifyEnd) {
+            checks->emplace_back(std::move(check));
+        }
+    }
+
+    // Verify the index keys sharing the prefix of a boundary in the checks by the rows
+    VerifiedIndexIterator::Verifier verifier(PartitionID partId,
+                                             std::vector<StringCheck> checks) {
+        return [this, partId, checks = std::move(checks)] (folly::StringPiece key) {
+            auto prefixLen = IndexKeyUtils::compactPrefixLen();
+            std::string row;
+            RowReaderWrapper reader;
+            for (const auto& check : checks) {
+                auto prefix = key.subpiece(check.offset, prefixLen);
+                auto sharedWith = [&prefix, prefixLen] (const std::string& boundary) {
+                    return prefix == folly::StringPiece(boundary).subpiece(0, prefixLen);
+                };
+                if (!(check.verifyBegin && sharedWith(check.begin)) &&
+                    !(check.verifyEnd && sharedWith(check.end))) {
+                    continue;
+                }
+                if (!reader && !readRow(partId, key, row, reader)) {
+                    return false;
+                }
+                auto v = reader->getValueByName(check.name);
+                if (v.type() != Value::Type::STRING) {
+                    return false;
+                }
+                auto full = IndexKeyUtils::encodeValue(v, check.len);
+                if (check.isRange ? (full < check.begin || full >= check.end)
+                                  : full != check.begin) {
+                    return false;
+                }
+            }
+            return true;
+        };
+    }
+
+    // Read the row the index key points to, the reader refers to the row
+    bool readRow(PartitionID partId,
+                 folly::StringPiece key,
+                 std::string& row,
+                 RowReaderWrapper& reader) {
+        auto vIdLen = context_->vIdLen();
+        auto prefix = context_->isEdge()
+            ? NebulaKeyUtils::edgePrefix(vIdLen,
+                                         partId,
+                                         IndexKeyUtils::getIndexSrcId(vIdLen, key).str(),
+                                         context_->edgeType_,
+                                         IndexKeyUtils::getIndexRank(vIdLen, key),
+                                         IndexKeyUtils::getIndexDstId(vIdLen, key).str())
+            : NebulaKeyUtils::vertexPrefix(vIdLen,
+                                           partId,
+                                           IndexKeyUtils::getIndexVertexID(vIdLen, key).str(),
+                                           context_->tagId_);
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto ret = context_->env()->kvstore_->prefix(context_->spaceId(), partId, prefix, &iter,
+                                                     context_->canReadFromFollower());
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED || !iter || !iter->valid()) {
+            return false;
         }
+        row = iter->val().str();
+        auto* schemaMan = context_->env()->schemaMan_;
+        reader = context_->isEdge()
+            ? RowReaderWrapper::getEdgePropReader(schemaMan, context_->spaceId(),
+                                                  context_->edgeType_, row)
+            : RowReaderWrapper::getTagPropReader(schemaMan, context_->spaceId(),
+                                                 context_->tagId_, row);
+        return !!reader;
     }
 
 private:
@@ -177,9 +512,18 @@ private:
     IndexID                             indexId_;
     bool                                isRangeScan_{false};
     std::unique_ptr<IndexIterator>      iter_;
+    // the parallel iterator wrapped in iter_ if any
+    ParallelRangeIterator*              parallel_{nullptr};
     std::pair<std::string, std::string> scanPair_;
     std::vector<cpp2::IndexColumnHint>  columnHints_;
     std::vector<kvstore::KV>            data_;
+    // the other indexes to intersect with, and the column hints on them
+    std::vector<std::pair<IndexID, std::vector<cpp2::IndexColumnHint>>> intersections_;
+    // the keys taken of each part at most, and the length of key prefix the ties share
+    size_t                              limit_{std::numeric_limits<size_t>::max()};
+    size_t                              tieLen_{0};
+    size_t                              taken_{0};
+    std::string                         lastTie_;
 };
 
 }  // namespace storage
@@ -35,29 +35,31 @@ public:
             return ret;
         }
 
-        auto ttlProp = CommonUtils::ttlProps(context_->tagSchema_);
+        IndexTTL ttl(context_->tagSchema_);
 
         data_.clear();
         std::vector<VertexID> vids;
         auto* iter = static_cast<VertexIndexIterator*>(indexScanNode_->iterator());
         while (iter && iter->valid()) {
-            if (!iter->val().empty() && ttlProp.first) {
-                auto v = IndexKeyUtils::parseIndexTTL(iter->val());
-                if (CommonUtils::checkDataExpiredForTTL(context_->tagSchema_,
-                                                        std::move(v),
-                                                        ttlProp.second.second,
-                                                        ttlProp.second.first)) {
-                    iter->next();
-                    continue;
-                }
+            if (ttl.expired(iter->val())) {
+                iter->next();
+                continue;
+            }
+            if (indexScanNode_->limitReached(iter->key())) {
+                break;
             }
             vids.emplace_back(iter->vId());
             iter->next();
         }
+        ret = indexScanNode_->scanError();
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return ret;
+        }
         for (const auto& vId : vids) {
             VLOG(1) << "partId " << partId << ", vId " << vId << ", tagId " << context_->tagId_;
             if (FLAGS_enable_vertex_cache && vertexCache_ != nullptr) {
-                auto result = vertexCache_->get(std::make_pair(vId, context_->tagId_));
+                // peek so that the scan won't change the lru order of the cache
+                auto result = vertexCache_->peek(std::make_pair(vId, context_->tagId_));
                 if (result.ok()) {
                     auto vertexKey = NebulaKeyUtils::vertexKey(context_->vIdLen(),
                                                                partId,
@@ -74,7 +76,8 @@ public:
             auto prefix = NebulaKeyUtils::vertexPrefix(context_->vIdLen(), partId,
                                                        vId, context_->tagId_);
             ret = context_->env()->kvstore_->prefix(context_->spaceId(),
-                                                       partId, prefix, &vIter);
+                                                       partId, prefix, &vIter,
+                                                       context_->canReadFromFollower());
             if (ret == nebula::cpp2::ErrorCode::SUCCEEDED && vIter && vIter->valid()) {
                 data_.emplace_back(vIter->key(), vIter->val());
             } else {
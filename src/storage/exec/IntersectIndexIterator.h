@@ -0,0 +1,143 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_INTERSECTINDEXITERATOR_H_
+#define STORAGE_EXEC_INTERSECTINDEXITERATOR_H_
+
+#include "common/base/Base.h"
+#include <folly/container/F14Set.h>
+#include "kvstore/KVIterator.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+IndexKeyTails is the set of vertices or edges hit by an index scan. Whatever the index is, the
+index key of a vertex ends with its vid, and the index key of an edge ends with src, rank and
+dst, so the tail of index key identifies the vertex or edge, and could be compared between the
+different indexes of the same tag or edge.
+
+The int vid of vertex index is kept as int64, the others are kept as the tail string. The tails
+are kept in the flat hash sets, which are looked up by the tail of a key without copying it.
+*/
+class IndexKeyTails final {
+public:
+    IndexKeyTails(size_t tailLen, bool isIntVid)
+        : tailLen_(tailLen)
+        , isInt_(isIntVid && tailLen == sizeof(int64_t)) {}
+
+    void insert(folly::StringPiece key) {
+        auto tail = tailOf(key);
+        if (isInt_) {
+            intTails_.emplace(toInt(tail));
+        } else {
+            strTails_.emplace(tail.str());
+        }
+    }
+
+    bool contains(folly::StringPiece key) const {
+        auto tail = tailOf(key);
+        if (isInt_) {
+            return intTails_.count(toInt(tail)) > 0;
+        }
+        return strTails_.count(tail) > 0;
+    }
+
+    // Only keep the tails which are also in other
+    void intersect(const IndexKeyTails& other) {
+        if (isInt_) {
+            intTails_ = intersectOf(intTails_, other.intTails_);
+        } else {
+            strTails_ = intersectOf(strTails_, other.strTails_);
+        }
+    }
+
+    size_t size() const {
+        return isInt_ ? intTails_.size() : strTails_.size();
+    }
+
+private:
+    folly::StringPiece tailOf(folly::StringPiece key) const {
+        CHECK_GE(key.size(), tailLen_);
+        return key.subpiece(key.size() - tailLen_, tailLen_);
+    }
+
+    // The tails of the smaller set looked up in the larger one
+    template <typename Set>
+    static Set intersectOf(const Set& lhs, const Set& rhs) {
+        const auto& smaller = lhs.size() <= rhs.size() ? lhs : rhs;
+        const auto& larger = lhs.size() <= rhs.size() ? rhs : lhs;
+        Set result;
+        result.reserve(smaller.size());
+        for (const auto& tail : smaller) {
+            if (larger.count(tail) > 0) {
+                result.emplace(tail);
+            }
+        }
+        return result;
+    }
+
+    static int64_t toInt(folly::StringPiece tail) {
+        int64_t v;
+        memcpy(&v, tail.data(), sizeof(int64_t));
+        return v;
+    }
+
+    size_t                              tailLen_;
+    bool                                isInt_;
+    folly::F14FastSet<int64_t>          intTails_;
+    folly::F14FastSet<std::string>      strTails_;
+};
+
+/*
+IntersectIndexIterator skips the index keys of the given iterator whose vertex or edge is not in
+the tails collected from the other indexes, so only the intersection of them is returned, and
+nothing outside of it is read from the data.
+*/
+class IntersectIndexIterator final : public kvstore::KVIterator {
+public:
+    IntersectIndexIterator(std::unique_ptr<kvstore::KVIterator> iter, IndexKeyTails tails)
+        : iter_(std::move(iter))
+        , tails_(std::move(tails)) {
+        moveToValid();
+    }
+
+    bool valid() const override {
+        return !!iter_ && iter_->valid();
+    }
+
+    void next() override {
+        iter_->next();
+        moveToValid();
+    }
+
+    void prev() override {
+        LOG(FATAL) << "IntersectIndexIterator does not support prev";
+    }
+
+    folly::StringPiece key() const override {
+        return iter_->key();
+    }
+
+    folly::StringPiece val() const override {
+        return iter_->val();
+    }
+
+private:
+    void moveToValid() {
+        while (iter_->valid() && !tails_.contains(iter_->key())) {
+            iter_->next();
+        }
+    }
+
+    std::unique_ptr<kvstore::KVIterator>    iter_;
+    IndexKeyTails                           tails_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_INTERSECTINDEXITERATOR_H_
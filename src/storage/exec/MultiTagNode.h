@@ -0,0 +1,102 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_MULTITAGNODE_H_
+#define STORAGE_EXEC_MULTITAGNODE_H_
+
+#include "common/base/Base.h"
+#include "storage/exec/RelNode.h"
+#include "storage/exec/TagNode.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+MultiTagNode reads all the tags of a vertex asked by the TagNodes by one prefix scan over the
+vertex, instead of a prefix seek of each tag, and hands the row of each tag to its TagNode. It
+must be executed before the TagNodes, so it is the first dependency of the node which depends on
+them. The TagNodes still check the vertex cache and the TTL the same way, the vertex is scanned
+only if at least multi_tag_scan_min_tags tags of it are not cached or prefetched.
+*/
+class MultiTagNode final : public RelNode<VertexID> {
+public:
+    using RelNode::execute;
+
+    MultiTagNode(RunTimeContext* context, const std::vector<TagNode*>& tagNodes)
+        : context_(context) {
+        for (auto* tagNode : tagNodes) {
+            tagNodes_.emplace(tagNode->getTagId(), tagNode);
+        }
+    }
+
+    nebula::cpp2::ErrorCode execute(PartitionID partId, const VertexID& vId) override {
+        auto ret = RelNode::execute(partId, vId);
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return ret;
+        }
+        if (context_->pendingRow_ != nullptr) {
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+
+        toRead_.clear();
+        for (auto& tagNode : tagNodes_) {
+            if (tagNode.second->needRead(vId)) {
+                toRead_.emplace_back(tagNode.second);
+            }
+        }
+        if (FLAGS_multi_tag_scan_min_tags <= 0 ||
+            toRead_.size() < static_cast<size_t>(FLAGS_multi_tag_scan_min_tags)) {
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto prefix = NebulaKeyUtils::vertexPrefix(context_->vIdLen(), partId, vId);
+        {
+            LatencySpan span(context_->trace(), LatencyTrace::kKVRead);
+            ret = context_->prefix(partId, prefix, &iter);
+        }
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            // left to the prefix seek of each TagNode
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+        // the tags are sorted by the tag id, so is the map, stop after the last one asked
+        auto last = tagNodes_.rbegin()->first;
+        auto keyLen = kVertexLen + context_->vIdLen();
+        std::unordered_map<TagID, std::string> rows;
+        for (; iter && iter->valid(); iter->next()) {
+            auto key = iter->key();
+            if (key.size() != keyLen) {
+                continue;
+            }
+            auto tagId = NebulaKeyUtils::getTagId(context_->vIdLen(), key);
+            if (tagId > last) {
+                break;
+            }
+            if (tagNodes_.count(tagId) != 0 && rows.count(tagId) == 0) {
+                rows.emplace(tagId, iter->val().str());
+            }
+        }
+        for (auto* tagNode : toRead_) {
+            auto row = rows.find(tagNode->getTagId());
+            if (row != rows.end()) {
+                tagNode->setScanned(std::move(row->second));
+            } else {
+                tagNode->setScanned(folly::none);
+            }
+        }
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+private:
+    RunTimeContext*                 context_;
+    std::map<TagID, TagNode*>       tagNodes_;
+    std::vector<TagNode*>           toRead_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_MULTITAGNODE_H_
@@ -0,0 +1,308 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_PARALLELEDGEITERATOR_H_
+#define STORAGE_EXEC_PARALLELEDGEITERATOR_H_
+
+#include "common/base/Base.h"
+#include <thrift/lib/cpp/util/EnumUtils.h>
+#include "kvstore/KVEngine.h"
+#include "kvstore/KVIterator.h"
+#include "storage/CommonUtils.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+ParallelEdgeIterator is a KVIterator over all edges of a vertex with specified edge type, which
+is used for a super vertex told by the degree counters.
+
+All edges are read on one snapshot of the part's engine. The prefix is split into several
+sub-ranges by the first byte of dst, the first one is read in place, and each of the rest is
+read in the executor in batches of `batchSize` edges to its end, in parallel. A sub-range stops
+reading once it has `kMaxBatches` batches not taken by the reader yet, and goes on when the
+reader takes one, so no more than `kMaxBatches * batchSize` edges of each sub-range are read
+ahead if the reader stops early, e.g. by limit. The keys are still returned in the same order as
+the prefix iterator, so the nodes above (ttl check, filter, limit) won't notice the difference.
+
+A sub-range whose reading is queued but not started when the reader needs its next batch is read
+in place instead, so the reader only waits for the readings running in the executor, never the
+queued ones.
+
+Key layout of the prefix:
+type(1) + partId(3) + srcId(*) + edgeType(4) | edgeRank(8) + dstId(*) + placeHolder(1)
+*/
+class ParallelEdgeIterator final : public kvstore::KVIterator {
+public:
+    using KVs = std::vector<std::pair<std::string, std::string>>;
+
+    // the batches of a sub-range read ahead at most
+    static constexpr size_t kMaxBatches = 2;
+
+    ParallelEdgeIterator(kvstore::KVEngine* engine,
+                         const std::string& prefix,
+                         folly::Executor* executor,
+                         size_t parallelism,
+                         size_t batchSize)
+        : engine_(engine)
+        , prefix_(prefix)
+        , executor_(executor)
+        , parallelism_(parallelism)
+        , batchSize_(std::max<size_t>(batchSize, 1)) {
+        CHECK_NOTNULL(engine_);
+        snapshot_ = engine_->getSnapshot();
+    }
+
+    ~ParallelEdgeIterator() override {
+        // stop the readings queued and wait for the ones running, the iterators must be
+        // released before the snapshot
+        for (auto& range : ranges_) {
+            std::unique_lock<std::mutex> guard(range->lock_);
+            range->stopped_ = true;
+            range->cv_.wait(guard, [&range] { return range->state_ != State::kRunning; });
+            range->state_ = State::kIdle;
+            range->iter_.reset();
+        }
+        if (snapshot_ != nullptr) {
+            engine_->releaseSnapshot(snapshot_);
+        }
+    }
+
+    // Open the sub-ranges on the snapshot and start reading them, which must be called once
+    // before the iterator is used
+    nebula::cpp2::ErrorCode init() {
+        std::unique_ptr<kvstore::KVIterator> head;
+        auto code = engine_->rangeWithPrefix(prefix_, prefix_, &head, snapshot_);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+        if (!head || !head->valid()) {
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+        auto boundaries = splitRange(prefix_, head->key().str(), parallelism_);
+        for (size_t i = 0; i < boundaries.size(); i++) {
+            auto range = std::make_shared<Range>();
+            range->begin_ = std::move(boundaries[i]);
+            if (i + 1 < boundaries.size()) {
+                range->end_ = boundaries[i + 1];
+            }
+            if (i == 0) {
+                range->iter_ = std::move(head);
+            } else {
+                code = engine_->rangeWithPrefix(range->begin_, prefix_, &range->iter_,
+                                                snapshot_);
+                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    LOG(ERROR) << "Open sub range of super vertex failed, error "
+                               << apache::thrift::util::enumNameSafe(code);
+                    return code;
+                }
+            }
+            ranges_.emplace_back(std::move(range));
+        }
+        VLOG(1) << "Scan super vertex in " << ranges_.size() << " sub ranges";
+        // the first sub-range is read in place
+        for (size_t i = 1; i < ranges_.size(); i++) {
+            ranges_[i]->state_ = State::kQueued;
+            schedule(ranges_[i]);
+        }
+        moveToValid();
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    bool valid() const override {
+        return curr_ < ranges_.size();
+    }
+
+    void next() override {
+        if (curr_ == 0) {
+            ranges_[0]->iter_->next();
+        } else {
+            ++ranges_[curr_]->pos_;
+        }
+        moveToValid();
+    }
+
+    void prev() override {
+        LOG(FATAL) << "ParallelEdgeIterator does not support prev";
+    }
+
+    folly::StringPiece key() const override {
+        auto* range = ranges_[curr_].get();
+        if (curr_ == 0) {
+            return range->iter_->key();
+        }
+        return range->buffer_[range->pos_].first;
+    }
+
+    folly::StringPiece val() const override {
+        auto* range = ranges_[curr_].get();
+        if (curr_ == 0) {
+            return range->iter_->val();
+        }
+        return range->buffer_[range->pos_].second;
+    }
+
+    bool isParallel() const {
+        return ranges_.size() > 1;
+    }
+
+    // Split [start, end of prefix) into at most `parallelism` sub-ranges, return the start key
+    // of each sub-range. The boundary is on the first byte of dst of the rank which start is on.
+    static std::vector<std::string> splitRange(const std::string& prefix,
+                                               const std::string& start,
+                                               size_t parallelism) {
+        std::vector<std::string> boundaries{start};
+        auto pos = prefix.size() + sizeof(EdgeRanking);
+        if (parallelism <= 1 || start.size() <= pos) {
+            return boundaries;
+        }
+        uint32_t low = static_cast<uint8_t>(start[pos]);
+        size_t count = std::min<size_t>(parallelism, 256 - low);
+        for (size_t i = 1; i < count; i++) {
+            auto boundary = start.substr(0, pos);
+            boundary.append(1, static_cast<char>(low + (256 - low) * i / count));
+            boundaries.emplace_back(std::move(boundary));
+        }
+        return boundaries;
+    }
+
+private:
+    // kQueued: a reading is added to the executor, kRunning: someone owns the iterator
+    enum class State {
+        kIdle,
+        kQueued,
+        kRunning,
+    };
+
+    // The sub-range [begin_, end_), or from begin_ to the end of prefix if end_ is empty. Its
+    // iterator is only used by whoever sets the state to kRunning, the rest are guarded by
+    // lock_, except buffer_ and pos_ which are only used by the reader.
+    struct Range {
+        // read at most batchSize keys in the range, by the owner of the iterator
+        KVs read(size_t batchSize) {
+            KVs kvs;
+            for (; kvs.size() < batchSize && inRange(); iter_->next()) {
+                kvs.emplace_back(iter_->key().str(), iter_->val().str());
+            }
+            return kvs;
+        }
+
+        bool inRange() const {
+            return iter_ && iter_->valid() &&
+                   (end_.empty() || iter_->key() < folly::StringPiece(end_));
+        }
+
+        // the iterator refers to begin_, so the range is not movable
+        std::string                             begin_;
+        std::string                             end_;
+        std::unique_ptr<kvstore::KVIterator>    iter_;
+
+        std::mutex                              lock_;
+        std::condition_variable                 cv_;
+        std::deque<KVs>                         batches_;
+        State                                   state_{State::kIdle};
+        bool                                    finished_{false};
+        bool                                    stopped_{false};
+
+        KVs                                     buffer_;
+        size_t                                  pos_ = 0;
+    };
+
+    // Read the batches of the range in the executor until it is finished, or enough batches
+    // are read ahead. It gives up if the range has been claimed by the reader or stopped.
+    void schedule(std::shared_ptr<Range> range) {
+        executor_->add([range = std::move(range), batchSize = batchSize_] () {
+            std::unique_lock<std::mutex> guard(range->lock_);
+            if (range->state_ != State::kQueued || range->stopped_) {
+                return;
+            }
+            range->state_ = State::kRunning;
+            while (true) {
+                guard.unlock();
+                auto kvs = range->read(batchSize);
+                auto finished = !range->inRange();
+                guard.lock();
+                range->batches_.emplace_back(std::move(kvs));
+                range->finished_ = finished;
+                if (finished || range->stopped_ || range->batches_.size() >= kMaxBatches) {
+                    range->state_ = State::kIdle;
+                    range->cv_.notify_all();
+                    return;
+                }
+                range->cv_.notify_all();
+            }
+        });
+    }
+
+    // Take the next batch of the range into its buffer, return false if the range is
+    // exhausted. The batch is read in place if nobody is reading it.
+    bool takeBatch(const std::shared_ptr<Range>& range) {
+        std::unique_lock<std::mutex> guard(range->lock_);
+        while (range->batches_.empty()) {
+            if (range->state_ == State::kRunning) {
+                range->cv_.wait(guard);
+                continue;
+            }
+            if (range->finished_) {
+                return false;
+            }
+            range->state_ = State::kRunning;
+            guard.unlock();
+            auto kvs = range->read(batchSize_);
+            auto finished = !range->inRange();
+            guard.lock();
+            range->batches_.emplace_back(std::move(kvs));
+            range->finished_ = finished;
+            range->state_ = State::kIdle;
+        }
+        range->buffer_ = std::move(range->batches_.front());
+        range->batches_.pop_front();
+        range->pos_ = 0;
+        if (range->state_ == State::kIdle && !range->finished_) {
+            range->state_ = State::kQueued;
+            guard.unlock();
+            schedule(range);
+        }
+        return true;
+    }
+
+    // Skip the exhausted sub-ranges, the first one is read in place and the rest by batches
+    void moveToValid() {
+        while (curr_ < ranges_.size()) {
+            auto& range = ranges_[curr_];
+            if (curr_ == 0) {
+                if (range->inRange()) {
+                    return;
+                }
+                range->iter_.reset();
+            } else {
+                if (range->pos_ < range->buffer_.size()) {
+                    return;
+                }
+                if (takeBatch(range)) {
+                    continue;
+                }
+                range->buffer_.clear();
+            }
+            ++curr_;
+        }
+    }
+
+    kvstore::KVEngine*                      engine_;
+    const void*                             snapshot_ = nullptr;
+    // the iterators refer to the prefix
+    std::string                             prefix_;
+    folly::Executor*                        executor_;
+    size_t                                  parallelism_;
+    size_t                                  batchSize_;
+    std::vector<std::shared_ptr<Range>>     ranges_;
+    size_t                                  curr_ = 0;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_PARALLELEDGEITERATOR_H_
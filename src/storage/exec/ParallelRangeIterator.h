@@ -0,0 +1,213 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_PARALLELRANGEITERATOR_H_
+#define STORAGE_EXEC_PARALLELRANGEITERATOR_H_
+
+#include "common/base/Base.h"
+#include <folly/futures/Future.h>
+#include <thrift/lib/cpp/util/EnumUtils.h>
+#include "kvstore/KVIterator.h"
+#include "storage/CommonUtils.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+ParallelRangeIterator is a KVIterator over the range [start, end) of a part, which is used by
+the range scan of index.
+
+It reads at most `threshold` keys from the given range iterator at first. If there are still
+keys left, the rest of the range is split into several sub-ranges on the first byte where the
+current key and end differ, which are scanned in the executor in parallel. Each sub-range is read
+in batches of at most `threshold` keys, the next batch of it is read ahead while the current one
+is returned, and the sub-ranges after only read their first batch, so the keys buffered are
+bounded however large the range is. The keys are still returned in the same order as the range
+iterator, so the nodes above (ttl check, filter, dedup) won't notice the difference.
+
+Once a sub-range fails to be read, the iterator stops and the error is returned by status().
+No more batches are read once the budget of the request is exhausted.
+*/
+class ParallelRangeIterator final : public kvstore::KVIterator {
+public:
+    using KVs = std::vector<std::pair<std::string, std::string>>;
+
+    ParallelRangeIterator(kvstore::KVStore* kvstore,
+                          GraphSpaceID spaceId,
+                          PartitionID partId,
+                          const std::string& end,
+                          std::unique_ptr<kvstore::KVIterator> iter,
+                          folly::Executor* executor,
+                          size_t threshold,
+                          size_t parallelism,
+                          bool canReadFromFollower = false,
+                          QueryBudget* budget = nullptr)
+        : kvstore_(kvstore)
+        , spaceId_(spaceId)
+        , partId_(partId)
+        , executor_(executor)
+        , batchSize_(std::max<size_t>(threshold, 1))
+        , canReadFromFollower_(canReadFromFollower)
+        , budget_(budget) {
+        CHECK(!!iter);
+        for (; iter->valid() && buffer_.size() < threshold; iter->next()) {
+            buffer_.emplace_back(iter->key().str(), iter->val().str());
+        }
+        if (!iter->valid()) {
+            return;
+        }
+
+        VLOG(1) << "Scan index range in parallel, space " << spaceId << ", part " << partId;
+        auto start = iter->key().str();
+        iter.reset();
+        auto boundaries = splitRange(start, end, parallelism);
+        for (size_t i = 0; i + 1 < boundaries.size(); i++) {
+            SubRange range;
+            range.end = boundaries[i + 1];
+            range.pending = readBatch(boundaries[i], range.end);
+            ranges_.emplace_back(std::move(range));
+        }
+        moveToValid();
+    }
+
+    bool valid() const override {
+        return pos_ < buffer_.size();
+    }
+
+    void next() override {
+        ++pos_;
+        moveToValid();
+    }
+
+    void prev() override {
+        LOG(FATAL) << "ParallelRangeIterator does not support prev";
+    }
+
+    folly::StringPiece key() const override {
+        return buffer_[pos_].first;
+    }
+
+    folly::StringPiece val() const override {
+        return buffer_[pos_].second;
+    }
+
+    bool isParallel() const {
+        return !ranges_.empty();
+    }
+
+    // The error of the sub-range failed to be read, the keys after it are not returned
+    nebula::cpp2::ErrorCode status() const {
+        return code_;
+    }
+
+    // Split [start, end) into at most `parallelism` sub-ranges, return the boundaries, the first
+    // one is start and the last one is end. The boundary is on the first byte start and end
+    // differ, so the sub-ranges are not balanced if the keys are skewed on that byte.
+    static std::vector<std::string> splitRange(const std::string& start,
+                                               const std::string& end,
+                                               size_t parallelism) {
+        std::vector<std::string> boundaries{start};
+        size_t pos = 0;
+        while (pos < start.size() && pos < end.size() && start[pos] == end[pos]) {
+            pos++;
+        }
+        if (parallelism > 1 && pos < end.size()) {
+            // if start is a prefix of end, any key longer than start is after it
+            uint32_t low = pos < start.size() ? static_cast<uint8_t>(start[pos]) : 0;
+            uint32_t high = static_cast<uint8_t>(end[pos]);
+            size_t count = std::min<size_t>(parallelism, high > low ? high - low : 0);
+            for (size_t i = 1; i < count; i++) {
+                auto boundary = end.substr(0, pos);
+                boundary.append(1, static_cast<char>(low + (high - low) * i / count));
+                boundaries.emplace_back(std::move(boundary));
+            }
+        }
+        boundaries.emplace_back(end);
+        return boundaries;
+    }
+
+private:
+    struct Batch {
+        nebula::cpp2::ErrorCode     code{nebula::cpp2::ErrorCode::SUCCEEDED};
+        KVs                         kvs;
+        // the first key of the next batch, empty if the sub-range is finished
+        std::string                 next;
+    };
+
+    struct SubRange {
+        std::string                 end;
+        folly::Future<Batch>        pending{Batch()};
+    };
+
+    // Read at most batchSize_ keys of [begin, end) in the executor, which only captures the
+    // values, so it could outlive the iterator
+    folly::Future<Batch> readBatch(const std::string& begin, const std::string& end) {
+        return folly::via(executor_, [kvstore = kvstore_, spaceId = spaceId_, partId = partId_,
+                                      begin, end, batchSize = batchSize_,
+                                      canReadFromFollower = canReadFromFollower_] () {
+            Batch batch;
+            std::unique_ptr<kvstore::KVIterator> iter;
+            batch.code = kvstore->range(spaceId, partId, begin, end, &iter, canReadFromFollower);
+            if (batch.code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                LOG(ERROR) << "Scan sub range of index failed, space " << spaceId
+                           << ", part " << partId << ", error "
+                           << apache::thrift::util::enumNameSafe(batch.code);
+                return batch;
+            }
+            for (; iter && iter->valid(); iter->next()) {
+                if (batch.kvs.size() >= batchSize) {
+                    batch.next = iter->key().str();
+                    break;
+                }
+                batch.kvs.emplace_back(iter->key().str(), iter->val().str());
+            }
+            return batch;
+        });
+    }
+
+    // When the current buffer is exhausted, wait for the next batch in order
+    void moveToValid() {
+        while (pos_ >= buffer_.size() && current_ < ranges_.size() &&
+               code_ == nebula::cpp2::ErrorCode::SUCCEEDED) {
+            auto& range = ranges_[current_];
+            auto batch = std::move(range.pending).get();
+            buffer_.clear();
+            pos_ = 0;
+            if (batch.code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                code_ = batch.code;
+                return;
+            }
+            buffer_ = std::move(batch.kvs);
+            if (batch.next.empty()) {
+                current_++;
+            } else if (budget_ != nullptr && budget_->exhausted()) {
+                // the keys after are dropped by the reader anyway
+                current_ = ranges_.size();
+            } else {
+                range.pending = readBatch(batch.next, range.end);
+            }
+        }
+    }
+
+    kvstore::KVStore*                       kvstore_{nullptr};
+    GraphSpaceID                            spaceId_;
+    PartitionID                             partId_;
+    folly::Executor*                        executor_{nullptr};
+    size_t                                  batchSize_;
+    bool                                    canReadFromFollower_{false};
+    QueryBudget*                            budget_{nullptr};
+
+    KVs                                     buffer_;
+    size_t                                  pos_ = 0;
+    std::vector<SubRange>                   ranges_;
+    size_t                                  current_ = 0;
+    nebula::cpp2::ErrorCode                 code_{nebula::cpp2::ErrorCode::SUCCEEDED};
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_PARALLELRANGEITERATOR_H_
@@ -0,0 +1,319 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_PROPBLOCK_H_
+#define STORAGE_EXEC_PROPBLOCK_H_
+
+#include "common/base/Base.h"
+#include "storage/exec/QueryUtils.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+PropBlock buffers the returned props of a batch of edges in column-major layout, so that
+the nodes which produce a lot of edges (e.g. GetNeighborsNode) don't need to build a
+row of Value for each edge one by one.
+
+Each column remembers the schema it is resolved against and the field index in that schema.
+All edges of a batch are usually written by the same schema version, so the field is looked
+up only once per column instead of once per cell. When the block is full or the target
+column changes, call `flush` to transpose the block into the row-major cell of response.
+
+`flushColumnar` moves the block into the cell column by column instead, which is the format of
+the `_edge_col:` columns of GetNeighbors when get_neighbors_columnar_edges is set. The cell is
+a list of the number of edges and then one value for each returned prop. A column with all values
+of the same int, float, bool or string type is packed into a string, one type byte and then:
+  int, float   the 8 bytes values, in the byte order of the host
+  bool         one byte each
+  string       the uint32 lengths of all values, and then the bytes of all values
+Any other column, e.g. with a null, is a list of its values. So each edge doesn't carry a list
+header, and each value doesn't carry the tag of its type. `decodeColumnar` reverses it.
+*/
+class PropBlock final {
+public:
+    explicit PropBlock(size_t capacity) : capacity_(capacity) {}
+
+    // Reset the columns used by the block, the props must be the same until next flush
+    void reset(const std::vector<PropContext>* props) {
+        if (props_ == props) {
+            return;
+        }
+        CHECK_EQ(0, size_);
+        props_ = props;
+        needReader_ = false;
+        columns_.clear();
+        for (const auto& prop : *props_) {
+            if (prop.returned_) {
+                needReader_ |= prop.propInKeyType_ == PropContext::PropInKeyType::NONE;
+                Column col;
+                col.prop_ = &prop;
+                col.values_.reserve(capacity_);
+                columns_.emplace_back(std::move(col));
+            }
+        }
+    }
+
+    const std::vector<PropContext>* props() const {
+        return props_;
+    }
+
+    size_t size() const {
+        return size_;
+    }
+
+    bool empty() const {
+        return size_ == 0;
+    }
+
+    bool full() const {
+        return size_ >= capacity_;
+    }
+
+    // whether any column is read from value, if not, the reader passed to append could be null
+    bool needReader() const {
+        return needReader_;
+    }
+
+    Status append(folly::StringPiece key, size_t vIdLen, bool isIntId, RowReader* reader) {
+        for (auto& col : columns_) {
+            bool inValue = col.prop_->propInKeyType_ == PropContext::PropInKeyType::NONE;
+            if (inValue && reader->getSchema() != col.schema_) {
+                col.schema_ = reader->getSchema();
+                col.index_ = col.schema_->getFieldIndex(col.prop_->name_);
+            }
+            auto value = inValue
+                       ? QueryUtils::readValueByIndex(reader,
+                                                      col.index_,
+                                                      col.prop_->name_,
+                                                      col.prop_->field_)
+                       : QueryUtils::readEdgeProp(key, vIdLen, isIntId, reader, *col.prop_);
+            if (!value.ok()) {
+                // drop the partial edge, all columns must be of the same length
+                for (auto& c : columns_) {
+                    c.values_.resize(size_);
+                }
+                return value.status();
+            }
+            col.values_.emplace_back(std::move(value).value());
+        }
+        size_++;
+        return Status::OK();
+    }
+
+    void clear() {
+        for (auto& col : columns_) {
+            col.values_.clear();
+        }
+        size_ = 0;
+    }
+
+    // Move all edges in block into cell, each edge would be a list of its props
+    void flush(nebula::List& cell) {
+        for (size_t row = 0; row < size_; row++) {
+            nebula::List list;
+            list.values.reserve(columns_.size());
+            for (auto& col : columns_) {
+                list.values.emplace_back(std::move(col.values_[row]));
+            }
+            cell.values.emplace_back(std::move(list));
+        }
+        clear();
+    }
+
+    // Move all edges in block into the empty cell column by column, see the comment of class
+    void flushColumnar(nebula::List& cell) {
+        DCHECK(cell.values.empty());
+        cell.values.reserve(columns_.size() + 1);
+        cell.values.emplace_back(static_cast<int64_t>(size_));
+        for (auto& col : columns_) {
+            cell.values.emplace_back(packColumn(col.values_));
+        }
+        clear();
+    }
+
+    // Decode the cell written by flushColumnar into a list of props for each edge, return false
+    // if the cell is malformed
+    static bool decodeColumnar(const nebula::List& cell, std::vector<nebula::List>* edges) {
+        if (cell.values.empty() || !cell.values[0].isInt() || cell.values[0].getInt() < 0) {
+            return false;
+        }
+        size_t rows = cell.values[0].getInt();
+        edges->assign(rows, nebula::List());
+        for (size_t i = 1; i < cell.values.size(); i++) {
+            std::vector<nebula::Value> values;
+            if (!unpackColumn(cell.values[i], rows, &values)) {
+                return false;
+            }
+            for (size_t row = 0; row < rows; row++) {
+                (*edges)[row].values.emplace_back(std::move(values[row]));
+            }
+        }
+        return true;
+    }
+
+private:
+    enum ColumnType : char {
+        kInt = 1,
+        kFloat = 2,
+        kBool = 3,
+        kString = 4,
+    };
+
+    static ColumnType typeOf(const nebula::Value& value) {
+        switch (value.type()) {
+            case nebula::Value::Type::INT:
+                return kInt;
+            case nebula::Value::Type::FLOAT:
+                return kFloat;
+            case nebula::Value::Type::BOOL:
+                return kBool;
+            case nebula::Value::Type::STRING:
+                return kString;
+            default:
+                return static_cast<ColumnType>(0);
+        }
+    }
+
+    template <typename T>
+    static void appendRaw(std::string& buf, T val) {
+        buf.append(reinterpret_cast<const char*>(&val), sizeof(T));
+    }
+
+    template <typename T>
+    static T readRaw(const char* data) {
+        T val;
+        memcpy(&val, data, sizeof(T));
+        return val;
+    }
+
+    static nebula::Value packColumn(std::vector<nebula::Value>& values) {
+        auto type = values.empty() ? static_cast<ColumnType>(0) : typeOf(values.front());
+        for (const auto& value : values) {
+            if (typeOf(value) != type) {
+                type = static_cast<ColumnType>(0);
+                break;
+            }
+        }
+        if (type == 0) {
+            return nebula::Value(nebula::List(std::move(values)));
+        }
+        std::string buf;
+        buf.push_back(type);
+        switch (type) {
+            case kInt:
+                buf.reserve(1 + values.size() * sizeof(int64_t));
+                for (const auto& value : values) {
+                    appendRaw<int64_t>(buf, value.getInt());
+                }
+                break;
+            case kFloat:
+                buf.reserve(1 + values.size() * sizeof(double));
+                for (const auto& value : values) {
+                    appendRaw<double>(buf, value.getFloat());
+                }
+                break;
+            case kBool:
+                for (const auto& value : values) {
+                    buf.push_back(value.getBool() ? 1 : 0);
+                }
+                break;
+            case kString: {
+                size_t bytes = 0;
+                for (const auto& value : values) {
+                    appendRaw<uint32_t>(buf, value.getStr().size());
+                    bytes += value.getStr().size();
+                }
+                buf.reserve(buf.size() + bytes);
+                for (const auto& value : values) {
+                    buf.append(value.getStr());
+                }
+                break;
+            }
+        }
+        return nebula::Value(std::move(buf));
+    }
+
+    static bool unpackColumn(const nebula::Value& column,
+                             size_t rows,
+                             std::vector<nebula::Value>* values) {
+        if (column.isList()) {
+            if (column.getList().values.size() != rows) {
+                return false;
+            }
+            *values = column.getList().values;
+            return true;
+        }
+        if (!column.isStr() || column.getStr().empty()) {
+            return false;
+        }
+        const auto& buf = column.getStr();
+        const char* data = buf.data() + 1;
+        size_t size = buf.size() - 1;
+        values->reserve(rows);
+        switch (buf[0]) {
+            case kInt:
+                if (size != rows * sizeof(int64_t)) {
+                    return false;
+                }
+                for (size_t i = 0; i < rows; i++) {
+                    values->emplace_back(readRaw<int64_t>(data + i * sizeof(int64_t)));
+                }
+                return true;
+            case kFloat:
+                if (size != rows * sizeof(double)) {
+                    return false;
+                }
+                for (size_t i = 0; i < rows; i++) {
+                    values->emplace_back(readRaw<double>(data + i * sizeof(double)));
+                }
+                return true;
+            case kBool:
+                if (size != rows) {
+                    return false;
+                }
+                for (size_t i = 0; i < rows; i++) {
+                    values->emplace_back(data[i] != 0);
+                }
+                return true;
+            case kString: {
+                size_t offset = rows * sizeof(uint32_t);
+                if (size < offset) {
+                    return false;
+                }
+                for (size_t i = 0; i < rows; i++) {
+                    auto len = readRaw<uint32_t>(data + i * sizeof(uint32_t));
+                    if (offset + len > size) {
+                        return false;
+                    }
+                    values->emplace_back(std::string(data + offset, len));
+                    offset += len;
+                }
+                return offset == size;
+            }
+            default:
+                return false;
+        }
+    }
+
+    struct Column {
+        const PropContext*                  prop_{nullptr};
+        const meta::SchemaProviderIf*       schema_{nullptr};
+        int64_t                             index_{-1};
+        std::vector<nebula::Value>          values_;
+    };
+
+    size_t                                  capacity_;
+    size_t                                  size_ = 0;
+    const std::vector<PropContext>*         props_{nullptr};
+    bool                                    needReader_ = false;
+    std::vector<Column>                     columns_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_PROPBLOCK_H_
@@ -49,7 +49,39 @@ public:
     static StatusOr<nebula::Value> readValue(RowReader* reader,
                                              const std::string& propName,
                                              const meta::SchemaProviderIf::Field* field) {
-        auto value = reader->getValueByName(propName);
+        return checkValue(reader->getValueByName(propName), propName, field);
+    }
+
+    // same as readValue, but the field index in reader's schema has been resolved by caller
+    static StatusOr<nebula::Value> readValueByIndex(RowReader* reader,
+                                                    int64_t index,
+                                                    const std::string& propName,
+                                                    const meta::SchemaProviderIf::Field* field) {
+        return checkValue(reader->getValueByIndex(index), propName, field);
+    }
+
+    // Read the prop in value of the row by the projection of the prop list on reader's schema,
+    // `i` is the position of prop in the list
+    static StatusOr<nebula::Value> readValueByProjection(RowReader* reader,
+                                                         const PropIndexCache::Projection& proj,
+                                                         size_t i,
+                                                         const PropContext& prop) {
+        auto index = proj.indexes_[i];
+        if (index < 0) {
+            if (proj.missing_[i].hasValue()) {
+                return proj.missing_[i].value();
+            }
+            VLOG(1) << "Fail to read prop " << prop.name_;
+            return Status::Error(folly::stringPrintf("Fail to read prop %s ",
+                                                     prop.name_.c_str()));
+        }
+        return readValueByIndex(reader, index, prop.name_, prop.field_);
+    }
+
+    // Handle the null value read from a row, fill default value or null when possible
+    static StatusOr<nebula::Value> checkValue(nebula::Value value,
+                                              const std::string& propName,
+                                              const meta::SchemaProviderIf::Field* field) {
         if (value.type() == Value::Type::NULLVALUE) {
             // read null value
             auto nullType = value.getNull();
@@ -89,6 +121,21 @@ public:
     }
 
 
+    // The int vid is saved as the 8 bytes of int64 in key, which may not be aligned
+    static int64_t intVid(folly::StringPiece vId) {
+        int64_t val;
+        memcpy(reinterpret_cast<void*>(&val), vId.data(), sizeof(int64_t));
+        return val;
+    }
+
+    // Return the vid in key as the value in response, int vid never builds a string
+    static Value vIdValue(folly::StringPiece vId, bool isIntId) {
+        if (isIntId) {
+            return intVid(vId);
+        }
+        return vId.subpiece(0, vId.find_first_of('\0')).toString();
+    }
+
     static StatusOr<nebula::Value> readEdgeProp(folly::StringPiece key,
                                                 size_t vIdLen,
                                                 bool isIntId,
@@ -101,11 +148,7 @@ public:
             }
             case PropContext::PropInKeyType::SRC: {
                 auto srcId = NebulaKeyUtils::getSrcId(vIdLen, key);
-                if (isIntId) {
-                    return *reinterpret_cast<const int64_t*>(srcId.data());
-                } else {
-                    return srcId.subpiece(0, srcId.find_first_of('\0')).toString();
-                }
+                return vIdValue(srcId, isIntId);
             }
             case PropContext::PropInKeyType::TYPE: {
                 auto edgeType = NebulaKeyUtils::getEdgeType(vIdLen, key);
@@ -117,11 +160,7 @@ public:
             }
             case PropContext::PropInKeyType::DST: {
                 auto dstId = NebulaKeyUtils::getDstId(vIdLen, key);
-                if (isIntId) {
-                    return *reinterpret_cast<const int64_t*>(dstId.data());
-                } else {
-                    return dstId.subpiece(0, dstId.find_first_of('\0')).toString();
-                }
+                return vIdValue(dstId, isIntId);
             }
             default:
                 LOG(FATAL) << "Should not read here";
@@ -141,11 +180,7 @@ public:
             }
             case PropContext::PropInKeyType::VID: {
                 auto vId = NebulaKeyUtils::getVertexId(vIdLen, key);
-                if (isIntId) {
-                    return *reinterpret_cast<const int64_t*>(vId.data());
-                } else {
-                    return vId.subpiece(0, vId.find_first_of('\0')).toString();
-                }
+                return vIdValue(vId, isIntId);
             }
             case PropContext::PropInKeyType::TAG: {
                 auto tag = NebulaKeyUtils::getTagId(vIdLen, key);
@@ -157,16 +192,27 @@ public:
         return Status::Error(folly::stringPrintf("Invalid property %s", prop.name_.c_str()));
     }
 
+    // If indexCache is given, the props in value are read by the projection resolved once for
+    // the schema of reader, instead of by name for each row
     static Status collectVertexProps(folly::StringPiece key,
                                      size_t vIdLen,
                                      bool isIntId,
                                      RowReader* reader,
                                      const std::vector<PropContext>* props,
-                                     nebula::List& list) {
-        for (const auto& prop : *props) {
+                                     nebula::List& list,
+                                     PropIndexCache* indexCache = nullptr) {
+        const PropIndexCache::Projection* proj = nullptr;
+        if (indexCache != nullptr && reader != nullptr) {
+            proj = &indexCache->projection(reader->getSchema(), props);
+        }
+        for (size_t i = 0; i < props->size(); i++) {
+            const auto& prop = (*props)[i];
             if (prop.returned_) {
                 VLOG(2) << "Collect prop " << prop.name_;
-                auto value = QueryUtils::readVertexProp(key, vIdLen, isIntId, reader, prop);
+                auto value = proj != nullptr &&
+                             prop.propInKeyType_ == PropContext::PropInKeyType::NONE
+                           ? readValueByProjection(reader, *proj, i, prop)
+                           : readVertexProp(key, vIdLen, isIntId, reader, prop);
                 if (!value.ok()) {
                     return value.status();
                 }
@@ -176,16 +222,27 @@ public:
         return Status::OK();
     }
 
+    // If indexCache is given, the props in value are read by the projection resolved once for
+    // the schema of reader, instead of by name for each edge
     static Status collectEdgeProps(folly::StringPiece key,
                                    size_t vIdLen,
                                    bool isIntId,
                                    RowReader* reader,
                                    const std::vector<PropContext>* props,
-                                   nebula::List& list) {
-        for (const auto& prop : *props) {
+                                   nebula::List& list,
+                                   PropIndexCache* indexCache = nullptr) {
+        const PropIndexCache::Projection* proj = nullptr;
+        if (indexCache != nullptr && reader != nullptr) {
+            proj = &indexCache->projection(reader->getSchema(), props);
+        }
+        for (size_t i = 0; i < props->size(); i++) {
+            const auto& prop = (*props)[i];
             if (prop.returned_) {
                 VLOG(2) << "Collect prop " << prop.name_;
-                auto value = QueryUtils::readEdgeProp(key, vIdLen, isIntId, reader, prop);
+                auto value = proj != nullptr &&
+                             prop.propInKeyType_ == PropContext::PropInKeyType::NONE
+                           ? readValueByProjection(reader, *proj, i, prop)
+                           : readEdgeProp(key, vIdLen, isIntId, reader, prop);
                 if (!value.ok()) {
                     return value.status();
                 }
@@ -195,6 +252,14 @@ public:
         return Status::OK();
     }
 
+    // return true if all props (returned, filtered or stat) could be read from the key,
+    // in which case the value of the edge doesn't need to be decoded
+    static bool isKeyOnly(const std::vector<PropContext>* props) {
+        return std::all_of(props->begin(), props->end(), [] (const auto& prop) {
+            return prop.propInKeyType_ != PropContext::PropInKeyType::NONE;
+        });
+    }
+
     // return none if no valid ttl, else return the ttl property name and time
     static folly::Optional<std::pair<std::string, int64_t>>
     getEdgeTTLInfo(EdgeContext* edgeContext, EdgeType edgeType) {
@@ -36,7 +36,7 @@ class RelNode {
 public:
     virtual nebula::cpp2::ErrorCode execute(PartitionID partId, const T& input) {
         for (auto* dependency : dependencies_) {
-            auto ret = dependency->execute(partId, input);
+            auto ret = executeDependency(dependency, partId, input);
             if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 return ret;
             }
@@ -46,7 +46,7 @@ public:
 
     virtual nebula::cpp2::ErrorCode execute(PartitionID partId) {
         for (auto* dependency : dependencies_) {
-            auto ret = dependency->execute(partId);
+            auto ret = executeDependency(dependency, partId);
             if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 return ret;
             }
@@ -68,6 +68,26 @@ public:
     std::string name_;
     std::vector<RelNode<T>*> dependencies_;
     bool hasDependents_ = false;
+
+    // the times executed and the time spent including the dependencies, only if the plan is
+    // profiled, see RequestProfile
+    bool profiled_ = false;
+    int64_t calls_ = 0;
+    int64_t nanos_ = 0;
+
+protected:
+    template <typename... Args>
+    static nebula::cpp2::ErrorCode executeDependency(RelNode<T>* dependency, Args&&... args) {
+        if (LIKELY(!dependency->profiled_)) {
+            return dependency->execute(std::forward<Args>(args)...);
+        }
+        auto start = std::chrono::steady_clock::now();
+        auto ret = dependency->execute(std::forward<Args>(args)...);
+        auto elapsed = std::chrono::steady_clock::now() - start;
+        dependency->calls_++;
+        dependency->nanos_ += std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+        return ret;
+    }
 };
 
 // QueryNode is the node which would read data from kvstore, it usually generate a row in response
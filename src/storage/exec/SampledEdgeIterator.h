@@ -0,0 +1,122 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_SAMPLEDEDGEITERATOR_H_
+#define STORAGE_EXEC_SAMPLEDEDGEITERATOR_H_
+
+#include "common/base/Base.h"
+#include <folly/Random.h>
+#include "kvstore/KVIterator.h"
+#include "storage/CommonUtils.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+SampledEdgeIterator is a KVIterator over at most `sampleSize` edges of a vertex with specified
+edge type, picked by random seeks instead of reading all of them, which is used by the random
+sampling of GetNeighbors on the super vertices, see get_neighbors_approximate_sample_degree.
+
+Each seek goes to a random key between the first edge and the upper bound of the prefix, and
+takes the first edge not before it. A seek past the last edge lowers the upper bound to the
+random key, so the keys drawn soon fall in the range the edges really take. The sample is
+approximate: an edge after a large gap of the key space is more likely to be picked. The edges
+picked are returned in the key order, at most 2 * sampleSize seeks are done.
+
+Key layout of the prefix:
+type(1) + partId(3) + srcId(*) + edgeType(4) | edgeRank(8) + dstId(*) + placeHolder(1)
+*/
+class SampledEdgeIterator final : public kvstore::KVIterator {
+public:
+    using KVs = std::vector<std::pair<std::string, std::string>>;
+
+    SampledEdgeIterator(RunTimeContext* context,
+                        PartitionID partId,
+                        const std::string& prefix,
+                        std::unique_ptr<kvstore::KVIterator> iter,
+                        size_t sampleSize) {
+        CHECK(!!iter);
+        if (!iter->valid() || sampleSize == 0) {
+            return;
+        }
+        std::string low = iter->key().str();
+        buffer_.emplace_back(low, iter->val().str());
+        iter.reset();
+        std::string high = prefix;
+        high.append(sizeof(EdgeRanking) + context->vIdLen() + 1, '\xFF');
+
+        std::unordered_set<std::string> picked{low};
+        for (size_t seeks = 0; buffer_.size() < sampleSize && seeks < 2 * sampleSize; seeks++) {
+            auto start = randomKey(low, high);
+            std::unique_ptr<kvstore::KVIterator> it;
+            if (context->range(partId, start, high, &it) != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                break;
+            }
+            if (it == nullptr || !it->valid()) {
+                // no edge from start on
+                it.reset();
+                high = std::move(start);
+                continue;
+            }
+            if (picked.emplace(it->key().str()).second) {
+                buffer_.emplace_back(it->key().str(), it->val().str());
+            }
+        }
+        std::sort(buffer_.begin(), buffer_.end());
+    }
+
+    bool valid() const override {
+        return pos_ < buffer_.size();
+    }
+
+    void next() override {
+        ++pos_;
+    }
+
+    void prev() override {
+        LOG(FATAL) << "SampledEdgeIterator does not support prev";
+    }
+
+    folly::StringPiece key() const override {
+        return buffer_[pos_].first;
+    }
+
+    folly::StringPiece val() const override {
+        return buffer_[pos_].second;
+    }
+
+    // A random key in [low, high), drawn on the 8 bytes from the first byte they differ
+    static std::string randomKey(const std::string& low, const std::string& high) {
+        size_t pos = 0;
+        while (pos < low.size() && pos < high.size() && low[pos] == high[pos]) {
+            pos++;
+        }
+        auto toInt = [pos] (const std::string& key) {
+            uint64_t v = 0;
+            for (size_t i = pos; i < pos + sizeof(uint64_t); i++) {
+                v = (v << 8) | (i < key.size() ? static_cast<uint8_t>(key[i]) : 0);
+            }
+            return v;
+        };
+        auto lo = toInt(low);
+        auto hi = toInt(high);
+        auto v = hi > lo ? lo + folly::Random::rand64(hi - lo) : lo;
+        std::string key = low.substr(0, pos);
+        for (int shift = 56; shift >= 0; shift -= 8) {
+            key.append(1, static_cast<char>((v >> shift) & 0xFF));
+        }
+        return key;
+    }
+
+private:
+    KVs                                     buffer_;
+    size_t                                  pos_ = 0;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_SAMPLEDEDGEITERATOR_H_
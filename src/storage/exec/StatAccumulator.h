@@ -0,0 +1,287 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_STATACCUMULATOR_H_
+#define STORAGE_EXEC_STATACCUMULATOR_H_
+
+#include "common/base/Base.h"
+#include <folly/Bits.h>
+#include <folly/hash/Hash.h>
+#include "common/datatypes/List.h"
+#include "common/datatypes/Value.h"
+#include "common/interface/gen-cpp2/storage_types.h"
+
+namespace nebula {
+namespace storage {
+
+// used to save stat value of each vertex
+struct PropStat {
+    PropStat() = default;
+
+    explicit PropStat(const cpp2::StatType& statType) : statType_(statType) {}
+
+    cpp2::StatType statType_;
+    mutable Value sum_ = 0L;
+    mutable Value count_ = 0L;
+    mutable Value min_ = std::numeric_limits<int64_t>::max();
+    mutable Value max_ = std::numeric_limits<int64_t>::min();
+};
+
+/*
+StatAccumulator collects one stat. The int and float values are accumulated in native types,
+once a value of other types comes, e.g. NULL of a nullable field, it falls back to accumulate
+by Value arithmetic in PropStat. The result is the same as accumulating all by Value.
+*/
+class StatAccumulator final {
+public:
+    StatAccumulator() = default;
+
+    explicit StatAccumulator(cpp2::StatType statType) : stat_(statType) {}
+
+    cpp2::StatType statType() const {
+        return stat_.statType_;
+    }
+
+    void add(const Value& value) {
+        if (stat_.statType_ == cpp2::StatType::COUNT) {
+            count_++;
+            return;
+        }
+        if (!generic_) {
+            if (value.isInt()) {
+                addNumeric(value.getInt(), 0.0, true);
+                return;
+            } else if (value.isFloat()) {
+                addNumeric(0, value.getFloat(), false);
+                return;
+            }
+            toGeneric();
+        }
+        addValue(value);
+    }
+
+    Value result() const {
+        if (!generic_) {
+            switch (stat_.statType_) {
+                case cpp2::StatType::SUM:
+                    return sum();
+                case cpp2::StatType::COUNT:
+                    return count_;
+                case cpp2::StatType::AVG:
+                    // the same as Value division, e.g. NULL if count is 0
+                    return sum() / Value(count_);
+                case cpp2::StatType::MAX:
+                    return maxIsInt_ ? Value(intMax_) : Value(floatMax_);
+                case cpp2::StatType::MIN:
+                    return minIsInt_ ? Value(intMin_) : Value(floatMin_);
+            }
+            return Value::kNullValue;
+        }
+        switch (stat_.statType_) {
+            case cpp2::StatType::SUM:
+                return stat_.sum_;
+            case cpp2::StatType::COUNT:
+                return stat_.count_;
+            case cpp2::StatType::AVG:
+                return stat_.sum_ / stat_.count_;
+            case cpp2::StatType::MAX:
+                return stat_.max_;
+            case cpp2::StatType::MIN:
+                return stat_.min_;
+        }
+        return Value::kNullValue;
+    }
+
+private:
+    Value sum() const {
+        return sumIsInt_ ? Value(intSum_) : Value(floatSum_);
+    }
+
+    // compare int or float like Value does
+    static bool less(int64_t lInt, double lFloat, bool lIsInt,
+                     int64_t rInt, double rFloat, bool rIsInt) {
+        if (lIsInt && rIsInt) {
+            return lInt < rInt;
+        }
+        double lhs = lIsInt ? static_cast<double>(lInt) : lFloat;
+        double rhs = rIsInt ? static_cast<double>(rInt) : rFloat;
+        return lhs < rhs;
+    }
+
+    void addNumeric(int64_t intVal, double floatVal, bool isInt) {
+        count_++;
+        if (sumIsInt_ && isInt) {
+            intSum_ += intVal;
+        } else if (sumIsInt_) {
+            floatSum_ = static_cast<double>(intSum_) + floatVal;
+            sumIsInt_ = false;
+        } else {
+            floatSum_ += isInt ? static_cast<double>(intVal) : floatVal;
+        }
+        if (less(intMax_, floatMax_, maxIsInt_, intVal, floatVal, isInt)) {
+            intMax_ = intVal;
+            floatMax_ = floatVal;
+            maxIsInt_ = isInt;
+        }
+        if (less(intVal, floatVal, isInt, intMin_, floatMin_, minIsInt_)) {
+            intMin_ = intVal;
+            floatMin_ = floatVal;
+            minIsInt_ = isInt;
+        }
+    }
+
+    void toGeneric() {
+        generic_ = true;
+        stat_.sum_ = sum();
+        stat_.count_ = count_;
+        stat_.max_ = maxIsInt_ ? Value(intMax_) : Value(floatMax_);
+        stat_.min_ = minIsInt_ ? Value(intMin_) : Value(floatMin_);
+    }
+
+    void addValue(const Value& value) {
+        if (stat_.statType_ == cpp2::StatType::SUM || stat_.statType_ == cpp2::StatType::AVG) {
+            stat_.sum_ = stat_.sum_ + value;
+            stat_.count_ = stat_.count_ + 1;
+        } else if (stat_.statType_ == cpp2::StatType::MAX) {
+            stat_.max_ = value > stat_.max_ ? value : stat_.max_;
+        } else if (stat_.statType_ == cpp2::StatType::MIN) {
+            stat_.min_ = value < stat_.min_ ? value : stat_.min_;
+        }
+    }
+
+    PropStat stat_;
+    bool generic_ = false;
+    int64_t count_ = 0;
+    bool sumIsInt_ = true;
+    int64_t intSum_ = 0;
+    double floatSum_ = 0.0;
+    bool maxIsInt_ = true;
+    int64_t intMax_ = std::numeric_limits<int64_t>::min();
+    double floatMax_ = 0.0;
+    bool minIsInt_ = true;
+    int64_t intMin_ = std::numeric_limits<int64_t>::max();
+    double floatMin_ = 0.0;
+};
+
+/*
+GroupedStats is an open addressing hash table from group key to the stats of the group, which
+is used for `GROUP BY` in storage. The slots only keep the hash and the group index, so probing
+is done in a small contiguous array without touching the keys. The keys and accumulators of all
+groups are kept in flat arrays in the order they come.
+
+`clear` keeps the capacity, so if it is reused for each vertex, the table is only resized for the
+vertex with more groups than ever.
+*/
+class GroupedStats final {
+public:
+    // stats are the initial accumulators of each group, expected is the estimated groups number
+    GroupedStats(std::vector<StatAccumulator> stats, size_t expected)
+        : init_(std::move(stats)) {
+        reserve(expected);
+    }
+
+    // Return the first accumulator of the group, the group is added if not exists
+    StatAccumulator* find(std::vector<Value>&& key) {
+        auto hash = hashKey(key);
+        auto pos = hash & mask_;
+        while (true) {
+            auto& slot = slots_[pos];
+            if (slot.group_ == kEmpty) {
+                break;
+            }
+            if (slot.hash_ == hash && keys_[slot.group_] == key) {
+                return &stats_[slot.group_ * init_.size()];
+            }
+            pos = (pos + 1) & mask_;
+        }
+        // keep the load factor under 0.5
+        if ((keys_.size() + 1) * 2 > slots_.size()) {
+            reserve(slots_.size());
+            return find(std::move(key));
+        }
+        auto group = keys_.size();
+        slots_[pos] = Slot{hash, group};
+        keys_.emplace_back(std::move(key));
+        stats_.insert(stats_.end(), init_.begin(), init_.end());
+        return &stats_[group * init_.size()];
+    }
+
+    size_t size() const {
+        return keys_.size();
+    }
+
+    // each group is a list of keys followed by stats
+    nebula::List result() const {
+        nebula::List result;
+        result.values.reserve(keys_.size());
+        for (size_t group = 0; group < keys_.size(); group++) {
+            nebula::List row;
+            row.values.reserve(keys_[group].size() + init_.size());
+            row.values.insert(row.values.end(), keys_[group].begin(), keys_[group].end());
+            for (size_t i = 0; i < init_.size(); i++) {
+                row.values.emplace_back(stats_[group * init_.size() + i].result());
+            }
+            result.values.emplace_back(std::move(row));
+        }
+        return result;
+    }
+
+    void clear() {
+        if (keys_.empty()) {
+            return;
+        }
+        std::fill(slots_.begin(), slots_.end(), Slot{0, kEmpty});
+        keys_.clear();
+        stats_.clear();
+    }
+
+private:
+    static constexpr size_t kEmpty = std::numeric_limits<size_t>::max();
+
+    struct Slot {
+        size_t hash_;
+        size_t group_;
+    };
+
+    static size_t hashKey(const std::vector<Value>& key) {
+        size_t hash = 0;
+        for (const auto& value : key) {
+            hash = folly::hash::hash_combine(hash, std::hash<Value>()(value));
+        }
+        return hash;
+    }
+
+    // make room for at least `expected` groups, and rehash the existing groups
+    void reserve(size_t expected) {
+        auto capacity = folly::nextPowTwo(std::max<size_t>(expected * 2, 16));
+        if (capacity <= slots_.size()) {
+            return;
+        }
+        slots_.assign(capacity, Slot{0, kEmpty});
+        mask_ = capacity - 1;
+        for (size_t group = 0; group < keys_.size(); group++) {
+            auto hash = hashKey(keys_[group]);
+            auto pos = hash & mask_;
+            while (slots_[pos].group_ != kEmpty) {
+                pos = (pos + 1) & mask_;
+            }
+            slots_[pos] = Slot{hash, group};
+        }
+        keys_.reserve(expected);
+        stats_.reserve(expected * init_.size());
+    }
+
+    std::vector<StatAccumulator>        init_;
+    std::vector<Slot>                   slots_;
+    size_t                              mask_ = 0;
+    std::vector<std::vector<Value>>     keys_;
+    std::vector<StatAccumulator>        stats_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_STATACCUMULATOR_H_
@@ -41,7 +41,8 @@ public:
             EdgeType edgeType,
             const std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>>* schemas,
             const folly::Optional<std::pair<std::string, int64_t>>* ttl,
-            bool moveToValidRecord = true)
+            bool moveToValidRecord = true,
+            bool keyOnly = false)
         : context_(context)
         , iter_(std::move(iter))
         , edgeType_(edgeType)
@@ -53,6 +54,9 @@ public:
             ttlCol_ = ttl->value().first;
             ttlDuration_ = ttl->value().second;
         }
+        // If all props could be read from key and there is no ttl, the value won't be decoded
+        // until someone asks for the reader (e.g. a filter or stat on edge)
+        lazyDecode_ = keyOnly && !hasTtl_;
         // If moveToValidRecord is true, iterator will try to move to first valid record,
         // which is used in GetNeighbors. If it is false, it will only check the latest record,
         // which is used in GetProps and UpdateEdge.
@@ -66,6 +70,9 @@ public:
     }
 
     bool valid() const override {
+        if (lazyDecode_) {
+            return !stopSearching_ && iter_->valid();
+        }
         return !stopSearching_ && reader_ != nullptr;
     }
 
@@ -92,6 +99,14 @@ public:
     }
 
     RowReader* reader() const override {
+        if (lazyDecode_ && !decoded_) {
+            LatencySpan span(context_->trace(), LatencyTrace::kDecode);
+            decoded_ = true;
+            reader_.reset(*schemas_, iter_->val());
+            if (!reader_) {
+                context_->resultStat_ = ResultStatus::ILLEGAL_DATA;
+            }
+        }
         return reader_.get();
     }
 
@@ -102,6 +117,20 @@ public:
 protected:
     // return true when the value iter to a valid edge value
     bool check() {
+        // stop as if there is no more edge once the budget of request is exhausted
+        auto* budget = context_->budget();
+        if (budget != nullptr && moveToValidRecord_ &&
+            !budget->consume(iter_->key().size() + iter_->val().size())) {
+            stopSearching_ = true;
+            reader_.reset();
+            return true;
+        }
+        if (lazyDecode_) {
+            reader_.reset();
+            decoded_ = false;
+            return true;
+        }
+        LatencySpan span(context_->trace(), LatencyTrace::kDecode);
         reader_.reset(*schemas_, iter_->val());
         if (!reader_) {
             context_->resultStat_ = ResultStatus::ILLEGAL_DATA;
@@ -126,8 +155,10 @@ protected:
     int64_t                                                               ttlDuration_;
     bool                                                                  moveToValidRecord_{true};
     bool                                                                  stopSearching_ = false;
+    bool                                                                  lazyDecode_ = false;
+    mutable bool                                                          decoded_ = false;
 
-    RowReaderWrapper                                                      reader_;
+    mutable RowReaderWrapper                                              reader_;
     EdgeRanking                                                           lastRank_ = 0;
     VertexID                                                              lastDstId_ = "";
 };
@@ -10,6 +10,8 @@
 #include "common/base/Base.h"
 #include "storage/exec/RelNode.h"
 #include "storage/CommonUtils.h"
+#include "storage/RequestProfile.h"
+#include <folly/Demangle.h>
 
 namespace nebula {
 namespace storage {
@@ -34,6 +36,46 @@ FutureDAG in StorageDAGBenchmark.cpp
 template<typename T>
 class StoragePlan {
 public:
+    StoragePlan() = default;
+
+    StoragePlan(StoragePlan&&) = default;
+
+    StoragePlan& operator=(StoragePlan&&) = default;
+
+    ~StoragePlan() {
+        flushProfile();
+    }
+
+    // Profile the nodes added so far into profile, if not null
+    void setProfile(std::shared_ptr<RequestProfile> profile) {
+        profile_ = std::move(profile);
+        for (auto& node : nodes_) {
+            node->profiled_ = profile_ != nullptr;
+        }
+    }
+
+    // Add the nodes profiled into the profile, which is done when the plan is destroyed as well
+    void flushProfile() {
+        if (profile_ == nullptr) {
+            return;
+        }
+        for (size_t i = 0; i < nodes_.size(); i++) {
+            auto& node = nodes_[i];
+            if (node->profiled_ && node->calls_ > 0) {
+                auto name = folly::demangle(typeid(*node)).toStdString();
+                static const std::string kNamespace = "nebula::storage::";
+                for (auto pos = name.find(kNamespace);
+                     pos != std::string::npos;
+                     pos = name.find(kNamespace, pos)) {
+                    name.erase(pos, kNamespace.size());
+                }
+                profile_->addNode(i, name, node->calls_, node->nanos_);
+                node->calls_ = 0;
+                node->nanos_ = 0;
+            }
+        }
+    }
+
     nebula::cpp2::ErrorCode go(PartitionID partId, const T& input) {
         // find all leaf nodes, and a dummy output node depends on all leaf node.
         if (firstLoop_) {
@@ -84,6 +126,7 @@ private:
     bool firstLoop_ = true;
     int32_t outputIdx_ = -1;
     std::vector<std::unique_ptr<RelNode<T>>> nodes_;
+    std::shared_ptr<RequestProfile> profile_;
 };
 
 }  // namespace storage
@@ -42,6 +42,9 @@ public:
 
     nebula::cpp2::ErrorCode execute(PartitionID partId, const VertexID& vId) override {
         reader_.reset();
+        // the row scanned by MultiTagNode is only for this execute
+        auto scanned = std::move(scanned_);
+        scanned_.reset();
         auto ret = RelNode::execute(partId, vId);
         if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
             return ret;
@@ -49,11 +52,20 @@ public:
         VLOG(1) << "partId " << partId << ", vId " << vId << ", tagId " << tagId_
                 << ", prop size " << props_->size();
 
+        // the row written by the update combined before
+        if (context_->pendingRow_ != nullptr) {
+            key_ = context_->pendingRow_->first;
+            value_ = context_->pendingRow_->second;
+            resetReader(vId);
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+
         // when update, has already evicted
         if (FLAGS_enable_vertex_cache && tagContext_->vertexCache_ != nullptr) {
             auto cache = tagContext_->vertexCache_->get(std::make_pair(vId, tagId_));
             if (cache.ok()) {
-                key_ = NebulaKeyUtils::vertexKey(context_->vIdLen(), partId, vId, tagId_);
+                key_.clear();
+                NebulaKeyUtils::appendVertexKey(&key_, context_->vIdLen(), partId, vId, tagId_);
                 value_ = std::move(cache.value());
                 // if data in vertex cache is valid, don't read from kv
                 if (resetReader(vId)) {
@@ -62,11 +74,40 @@ public:
             }
         }
 
+        auto prefetched = prefetched_.find(vId);
+        if (prefetched != prefetched_.end()) {
+            // the vertex has been read by multiGet, none means the tag does not exist
+            if (prefetched->second.hasValue()) {
+                key_.clear();
+                NebulaKeyUtils::appendVertexKey(&key_, context_->vIdLen(), partId, vId, tagId_);
+                value_ = prefetched->second.value();
+                resetReader(vId);
+            }
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+
+        if (scanned.hasValue()) {
+            // the vertex has been scanned by MultiTagNode, none means the tag does not exist
+            if (scanned.value().hasValue()) {
+                key_.clear();
+                NebulaKeyUtils::appendVertexKey(&key_, context_->vIdLen(), partId, vId, tagId_);
+                value_ = std::move(scanned.value().value());
+                resetReader(vId);
+            }
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+
+        if (!context_->mayExist(partId, vId)) {
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
         std::unique_ptr<kvstore::KVIterator> iter;
         auto prefix = NebulaKeyUtils::vertexPrefix(context_->vIdLen(), partId, vId, tagId_);
-        ret = context_->env()->kvstore_->prefix(context_->spaceId(), partId, prefix, &iter);
+        {
+            LatencySpan span(context_->trace(), LatencyTrace::kKVRead);
+            ret = context_->prefix(partId, prefix, &iter);
+        }
         if (ret == nebula::cpp2::ErrorCode::SUCCEEDED && iter && iter->valid()) {
-            key_ = iter->key().str();
+            key_.assign(iter->key().data(), iter->key().size());
             value_ = iter->val().str();
             resetReader(vId);
             return nebula::cpp2::ErrorCode::SUCCEEDED;
@@ -74,6 +115,67 @@ public:
         return ret;
     }
 
+    // Read the tag of a batch of vertices in the same part by one multiGet, the following
+    // execute of these vertices won't read kvstore any more. The vertices found in vertex
+    // cache are skipped. The result is kept until next prefetch or clearPrefetched.
+    nebula::cpp2::ErrorCode prefetch(PartitionID partId, const std::vector<VertexID>& vIds) {
+        prefetched_.clear();
+        std::vector<VertexID> toRead;
+        std::vector<std::string> keys;
+        toRead.reserve(vIds.size());
+        keys.reserve(vIds.size());
+        auto useCache = FLAGS_enable_vertex_cache && tagContext_->vertexCache_ != nullptr;
+        for (const auto& vId : vIds) {
+            if (useCache && tagContext_->vertexCache_->peek(std::make_pair(vId, tagId_)).ok()) {
+                continue;
+            }
+            toRead.emplace_back(vId);
+            keys.emplace_back(NebulaKeyUtils::vertexKey(context_->vIdLen(), partId, vId, tagId_));
+        }
+        if (keys.empty()) {
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+
+        std::vector<std::string> values;
+        LatencySpan span(context_->trace(), LatencyTrace::kKVRead);
+        auto ret = context_->multiGet(partId, keys, &values);
+        if (ret.first != nebula::cpp2::ErrorCode::SUCCEEDED &&
+            ret.first != nebula::cpp2::ErrorCode::E_PARTIAL_RESULT) {
+            return ret.first;
+        }
+        const auto& status = ret.second;
+        CHECK_EQ(toRead.size(), status.size());
+        prefetched_.reserve(toRead.size());
+        for (size_t i = 0; i < toRead.size(); i++) {
+            if (status[i].ok()) {
+                prefetched_[toRead[i]] = std::move(values[i]);
+            } else if (status[i].isKeyNotFound()) {
+                prefetched_[toRead[i]] = folly::none;
+            }
+            // other errors are left to the prefix read of execute
+        }
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+    void clearPrefetched() {
+        prefetched_.clear();
+    }
+
+    // Whether the next execute of the vertex would read kvstore, not found in the vertex cache
+    // or the prefetched
+    bool needRead(const VertexID& vId) const {
+        if (FLAGS_enable_vertex_cache && tagContext_->vertexCache_ != nullptr &&
+            tagContext_->vertexCache_->peek(std::make_pair(vId, tagId_)).ok()) {
+            return false;
+        }
+        return prefetched_.find(vId) == prefetched_.end();
+    }
+
+    // The row of the tag scanned by MultiTagNode for the next execute, none if not found
+    void setScanned(folly::Optional<std::string> row) {
+        scanned_ = std::move(row);
+    }
+
     nebula::cpp2::ErrorCode
     collectTagPropsIfValid(NullHandler nullHandler,
                            PropHandler valueHandler) {
@@ -114,6 +216,7 @@ public:
 
 private:
     bool resetReader(const VertexID& vId) {
+        LatencySpan span(context_->trace(), LatencyTrace::kDecode);
         reader_.reset(*schemas_, value_);
         if (!reader_ || (ttl_.hasValue() && CommonUtils::checkDataExpiredForTTL(
             schemas_->back().get(), reader_.get(), ttl_.value().first, ttl_.value().second))) {
@@ -140,6 +243,8 @@ private:
     std::string                                                           key_;
     std::string                                                           value_;
     RowReaderWrapper                                                      reader_;
+    std::unordered_map<VertexID, folly::Optional<std::string>>            prefetched_;
+    folly::Optional<folly::Optional<std::string>>                         scanned_;
 };
 
 }  // namespace storage
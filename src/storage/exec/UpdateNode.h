@@ -118,6 +118,31 @@ public:
     }
 
 protected:
+    // Write props_ into rowWriter_. When the old row is patched in place, the props not updated
+    // are already in it, only the updated ones are written.
+    WriteResult writeProps() {
+        if (patchRow_) {
+            for (auto& updateProp : updatedProps_) {
+                auto it = props_.find(updateProp.get_name());
+                if (it == props_.end()) {
+                    return WriteResult::UNKNOWN_FIELD;
+                }
+                auto wRet = rowWriter_->setValue(it->first, it->second);
+                if (wRet != WriteResult::SUCCEEDED) {
+                    return wRet;
+                }
+            }
+            return WriteResult::SUCCEEDED;
+        }
+        for (auto& e : props_) {
+            auto wRet = rowWriter_->setValue(e.first, e.second);
+            if (wRet != WriteResult::SUCCEEDED) {
+                return wRet;
+            }
+        }
+        return WriteResult::SUCCEEDED;
+    }
+
     // ============================ input =====================================================
     RunTimeContext                                                         *context_;
     std::vector<std::shared_ptr<nebula::meta::cpp2::IndexItem>>             indexes_;
@@ -135,6 +160,8 @@ protected:
     // use to save old row value
     std::string                                                             val_;
     std::unique_ptr<RowWriterV2>                                            rowWriter_;
+    // Whether rowWriter_ patches the old row in place, then only the updated props are written
+    bool                                                                    patchRow_{false};
     // prop -> value
     std::unordered_map<std::string, Value>                                  props_;
     std::atomic<nebula::cpp2::ErrorCode>                                    exeResult_;
@@ -170,6 +197,10 @@ public:
         CHECK_NOTNULL(context_->env()->kvstore_);
         IndexCountWrapper wrapper(context_->env());
 
+        if (context_->env()->verticesUC_ != nullptr) {
+            return combineUpdate(partId, vId);
+        }
+
         // Update is read-modify-write, which is an atomic operation.
         std::vector<VMLI> dummyLock = {std::make_tuple(context_->spaceId(),
                                                        partId, tagId_, vId)};
@@ -185,6 +216,68 @@ public:
             return nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
         }
 
+        std::string batch;
+        auto ret = computeBatch(partId, vId, &batch);
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return ret;
+        }
+        ret = commitBatch(partId, std::move(batch));
+        // Evicted after the write with the vertex locked, a row cached by a concurrent write
+        // before would be the old one, and no one could cache it again until the lock is freed
+        context_->env()->evictIndexValueCache(vId, tagId_);
+        return ret;
+    }
+
+    // Combine the update with the updates of the same vertex, or of the same part if
+    // update_combine_by_part is set, arrived at the same time. The vertex is locked by its first
+    // update in the group until the combined batch is committed.
+    nebula::cpp2::ErrorCode combineUpdate(PartitionID partId, const VertexID& vId) {
+        auto key = std::make_tuple(context_->spaceId(), partId, tagId_, vId);
+        VMLI groupKey = FLAGS_update_combine_by_part
+                      ? VMLI(context_->spaceId(), partId, 0, VertexID())
+                      : key;
+        std::unique_ptr<nebula::MemoryLockGuard<VMLI>> lg;
+        auto compute = [&] (bool first,
+                            const kvstore::KV* pending,
+                            std::string* batch,
+                            kvstore::KV* row) {
+            if (first) {
+                lg = std::make_unique<nebula::MemoryLockGuard<VMLI>>(
+                    context_->env()->verticesML_.get(), key);
+                if (!*lg) {
+                    LOG(ERROR) << "vertex conflict " << std::get<0>(key) << ":"
+                               << std::get<1>(key) << ":" << std::get<2>(key) << ":"
+                               << std::get<3>(key);
+                    return nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
+                }
+            }
+            context_->pendingRow_ = pending;
+            auto ret = this->computeBatch(partId, vId, batch);
+            context_->pendingRow_ = nullptr;
+            if (ret == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                // the row of vertex is the last one put in the batch
+                auto ops = kvstore::decodeBatchValue(*batch);
+                row->first = ops.back().second.first.str();
+                row->second = ops.back().second.second.str();
+            } else {
+                // nothing is written, the next update of the vertex in the group locks it
+                lg.reset();
+            }
+            return ret;
+        };
+        auto commit = [&] (std::string&& batch) {
+            return this->commitBatch(partId, std::move(batch));
+        };
+        auto ret = context_->env()->verticesUC_->combine(groupKey, key, compute, commit);
+        // the first update of the vertex in the group still holds the lock, see execute
+        context_->env()->evictIndexValueCache(vId, tagId_);
+        return ret;
+    }
+
+    // Read the vertex, and build the batch to write back
+    nebula::cpp2::ErrorCode computeBatch(PartitionID partId,
+                                         const VertexID& vId,
+                                         std::string* batch) {
         auto ret = RelNode::execute(partId, vId);
         if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
             return ret;
@@ -215,18 +308,23 @@ public:
             return ret;
         }
 
-        auto batch = this->updateAndWriteBack(partId, vId);
-        if (batch == folly::none) {
+        auto newBatch = this->updateAndWriteBack(partId, vId);
+        if (newBatch == folly::none) {
             return nebula::cpp2::ErrorCode::E_INVALID_DATA;
         }
+        *batch = std::move(newBatch).value();
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
 
+    nebula::cpp2::ErrorCode commitBatch(PartitionID partId, std::string&& batch) {
+        auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
         folly::Baton<true, std::atomic> baton;
         auto callback = [&ret, &baton] (nebula::cpp2::ErrorCode code) {
             ret = code;
             baton.post();
         };
         context_->env()->kvstore_->asyncAppendBatch(
-            context_->spaceId(), partId, std::move(batch).value(), callback);
+            context_->spaceId(), partId, std::move(batch), callback);
         baton.wait();
         return ret;
     }
@@ -275,6 +373,7 @@ public:
 
         key_ = NebulaKeyUtils::vertexKey(context_->vIdLen(), partId, vId, tagId_);
         rowWriter_ = std::make_unique<RowWriterV2>(schema_);
+        patchRow_ = false;
 
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
@@ -309,10 +408,15 @@ public:
         }
 
         // After alter tag, the schema get from meta and the schema in RowReader
-        // may be inconsistent, so the following method cannot be used
-        // this->rowWriter_ = std::make_unique<RowWriterV2>(schema.get(), reader->getData());
-        rowWriter_ = std::make_unique<RowWriterV2>(schema_);
+        // may be inconsistent, so the old row could only be patched in place when it is
+        // encoded by the latest schema, otherwise it is encoded again
         val_ = reader_->getData();
+        patchRow_ = reader_->readerVer() == 2 && reader_->schemaVer() == schema_->getVersion();
+        if (patchRow_) {
+            rowWriter_ = std::make_unique<RowWriterV2>(schema_, val_);
+        } else {
+            rowWriter_ = std::make_unique<RowWriterV2>(schema_);
+        }
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
 
@@ -332,18 +436,16 @@ public:
             expCtx_->setTagProp(tagName_, propName, std::move(updateVal));
         }
 
-        for (auto& e : props_) {
-            auto wRet = rowWriter_->setValue(e.first, e.second);
-            if (wRet != WriteResult::SUCCEEDED) {
-                LOG(ERROR) << "Add field faild ";
-                return folly::none;
-            }
+        auto wRet = writeProps();
+        if (wRet != WriteResult::SUCCEEDED) {
+            LOG(ERROR) << "Add field faild ";
+            return folly::none;
         }
 
         std::unique_ptr<kvstore::BatchHolder> batchHolder
             = std::make_unique<kvstore::BatchHolder>();
 
-        auto wRet = rowWriter_->finish();
+        wRet = rowWriter_->finish();
         if (wRet != WriteResult::SUCCEEDED) {
             LOG(ERROR) << "Add field faild ";
             return folly::none;
@@ -467,15 +569,20 @@ public:
         auto ret = nebula::cpp2::ErrorCode::SUCCEEDED;
         IndexCountWrapper wrapper(context_->env());
 
-        // Update is read-modify-write, which is an atomic operation.
-        std::vector<EMLI> dummyLock = {
-            std::make_tuple(context_->spaceId(),
-                            partId,
-                            edgeKey.get_src().getStr(),
-                            edgeKey.get_edge_type(),
-                            edgeKey.get_ranking(),
-                            edgeKey.get_dst().getStr())
-        };
+        bool toss = context_->env()->txnMan_ &&
+                    context_->env()->txnMan_->enableToss(context_->spaceId());
+        bool combine = !toss && context_->env()->edgesUC_ != nullptr;
+        // Update is read-modify-write, which is an atomic operation. The update combined is
+        // locked by the leader of its group.
+        std::vector<EMLI> dummyLock;
+        if (!combine) {
+            dummyLock.emplace_back(std::make_tuple(context_->spaceId(),
+                                                   partId,
+                                                   edgeKey.get_src().getStr(),
+                                                   edgeKey.get_edge_type(),
+                                                   edgeKey.get_ranking(),
+                                                   edgeKey.get_dst().getStr()));
+        }
         nebula::MemoryLockGuard<EMLI> lg(context_->env()->edgesML_.get(),
                                          std::move(dummyLock));
         if (!lg) {
@@ -535,8 +642,7 @@ public:
             }
         };
 
-        if (context_->env()->txnMan_ &&
-            context_->env()->txnMan_->enableToss(context_->spaceId())) {
+        if (toss) {
             LOG(INFO) << "before update edge atomic" << TransactionUtils::dumpKey(edgeKey);
             auto f = context_->env()->txnMan_->updateEdgeAtomic(
                 context_->vIdLen(), context_->spaceId(), partId, edgeKey, std::move(op));
@@ -547,6 +653,8 @@ public:
             } else {
                 ret = nebula::cpp2::ErrorCode::E_UNKNOWN;
             }
+        } else if (combine) {
+            ret = combineUpdate(partId, edgeKey, std::move(op));
         } else {
             auto batch = op();
             if (batch == folly::none) {
@@ -566,6 +674,67 @@ public:
         return ret;
     }
 
+    // Combine the update with the updates of the same edge, or of the same part if
+    // update_combine_by_part is set, arrived at the same time, like UpdateTagNode::combineUpdate
+    nebula::cpp2::ErrorCode
+    combineUpdate(PartitionID partId,
+                  const cpp2::EdgeKey& edgeKey,
+                  std::function<folly::Optional<std::string>()> op) {
+        auto key = std::make_tuple(context_->spaceId(),
+                                   partId,
+                                   edgeKey.get_src().getStr(),
+                                   edgeKey.get_edge_type(),
+                                   edgeKey.get_ranking(),
+                                   edgeKey.get_dst().getStr());
+        EMLI groupKey = FLAGS_update_combine_by_part
+                      ? EMLI(context_->spaceId(), partId, VertexID(), 0, 0, VertexID())
+                      : key;
+        std::unique_ptr<nebula::MemoryLockGuard<EMLI>> lg;
+        auto compute = [&] (bool first,
+                            const kvstore::KV* pending,
+                            std::string* batch,
+                            kvstore::KV* row) {
+            if (first) {
+                lg = std::make_unique<nebula::MemoryLockGuard<EMLI>>(
+                    context_->env()->edgesML_.get(), key);
+                if (!*lg) {
+                    LOG(ERROR) << "edge conflict " << std::get<0>(key) << ":"
+                               << std::get<1>(key) << ":" << std::get<2>(key) << ":"
+                               << std::get<3>(key) << ":" << std::get<4>(key) << ":"
+                               << std::get<5>(key);
+                    return nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
+                }
+            }
+            context_->pendingRow_ = pending;
+            auto ret = op();
+            context_->pendingRow_ = nullptr;
+            if (ret == folly::none) {
+                // nothing is written, the next update of the edge in the group locks it
+                lg.reset();
+                return this->exeResult_;
+            }
+            *batch = std::move(ret).value();
+            // the row of edge is the last one put in the batch
+            auto ops = kvstore::decodeBatchValue(*batch);
+            row->first = ops.back().second.first.str();
+            row->second = ops.back().second.second.str();
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        };
+        auto commit = [&] (std::string&& batch) {
+            auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
+            folly::Baton<true, std::atomic> baton;
+            auto callback = [&code, &baton] (nebula::cpp2::ErrorCode rc) {
+                code = rc;
+                baton.post();
+            };
+            context_->env()->kvstore_->asyncAppendBatch(
+                context_->spaceId(), partId, std::move(batch), callback);
+            baton.wait();
+            return code;
+        };
+        return context_->env()->edgesUC_->combine(groupKey, key, compute, commit);
+    }
+
     nebula::cpp2::ErrorCode getLatestEdgeSchemaAndName() {
         auto schemaIter = edgeContext_->schemas_.find(std::abs(edgeType_));
         if (schemaIter == edgeContext_->schemas_.end() ||
@@ -621,6 +790,7 @@ public:
                                        edgeKey.get_ranking(),
                                        edgeKey.get_dst().getStr());
         rowWriter_ = std::make_unique<RowWriterV2>(schema_);
+        patchRow_ = false;
 
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
@@ -660,10 +830,15 @@ public:
         }
 
         // After alter edge, the schema get from meta and the schema in RowReader
-        // may be inconsistent, so the following method cannot be used
-        // this->rowWriter_ = std::make_unique<RowWriterV2>(schema.get(), reader->getData());
-        rowWriter_ = std::make_unique<RowWriterV2>(schema_);
+        // may be inconsistent, so the old row could only be patched in place when it is
+        // encoded by the latest schema, otherwise it is encoded again
         val_ = reader_->getData();
+        patchRow_ = reader_->readerVer() == 2 && reader_->schemaVer() == schema_->getVersion();
+        if (patchRow_) {
+            rowWriter_ = std::make_unique<RowWriterV2>(schema_, val_);
+        } else {
+            rowWriter_ = std::make_unique<RowWriterV2>(schema_);
+        }
         return nebula::cpp2::ErrorCode::SUCCEEDED;
     }
 
@@ -683,18 +858,16 @@ public:
             expCtx_->setEdgeProp(edgeName_, propName, std::move(updateVal));
         }
 
-        for (auto& e : props_) {
-            auto wRet = rowWriter_->setValue(e.first, e.second);
-            if (wRet != WriteResult::SUCCEEDED) {
-                VLOG(1) << "Add field faild ";
-                return folly::none;
-            }
+        auto wRet = writeProps();
+        if (wRet != WriteResult::SUCCEEDED) {
+            VLOG(1) << "Add field faild ";
+            return folly::none;
         }
 
         std::unique_ptr<kvstore::BatchHolder> batchHolder
             = std::make_unique<kvstore::BatchHolder>();
 
-        auto wRet = rowWriter_->finish();
+        wRet = rowWriter_->finish();
         if (wRet != WriteResult::SUCCEEDED) {
             VLOG(1) << "Add field faild ";
             return folly::none;
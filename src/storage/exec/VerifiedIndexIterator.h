@@ -0,0 +1,67 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_EXEC_VERIFIEDINDEXITERATOR_H_
+#define STORAGE_EXEC_VERIFIEDINDEXITERATOR_H_
+
+#include "common/base/Base.h"
+#include "kvstore/KVIterator.h"
+
+namespace nebula {
+namespace storage {
+
+/*
+VerifiedIndexIterator skips the index keys of the given iterator which fail the verifier. It is
+used when the index keys scanned are a superset of the ones wanted, e.g. the keys of a compact
+string column sharing the prefix with the value looked up, see index_string_prefix_len, which
+are verified against the rows they point to.
+*/
+class VerifiedIndexIterator final : public kvstore::KVIterator {
+public:
+    using Verifier = std::function<bool(folly::StringPiece key)>;
+
+    VerifiedIndexIterator(std::unique_ptr<kvstore::KVIterator> iter, Verifier verifier)
+        : iter_(std::move(iter))
+        , verifier_(std::move(verifier)) {
+        moveToValid();
+    }
+
+    bool valid() const override {
+        return !!iter_ && iter_->valid();
+    }
+
+    void next() override {
+        iter_->next();
+        moveToValid();
+    }
+
+    void prev() override {
+        LOG(FATAL) << "VerifiedIndexIterator does not support prev";
+    }
+
+    folly::StringPiece key() const override {
+        return iter_->key();
+    }
+
+    folly::StringPiece val() const override {
+        return iter_->val();
+    }
+
+private:
+    void moveToValid() {
+        while (iter_->valid() && !verifier_(iter_->key())) {
+            iter_->next();
+        }
+    }
+
+    std::unique_ptr<kvstore::KVIterator>    iter_;
+    Verifier                                verifier_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_EXEC_VERIFIEDINDEXITERATOR_H_
@@ -10,11 +10,21 @@
 #include "common/fs/FileUtils.h"
 #include "common/hdfs/HdfsHelper.h"
 #include "kvstore/Part.h"
+#include "kvstore/RocksEngine.h"
 #include <proxygen/httpserver/RequestHandler.h>
 #include <proxygen/lib/http/ProxygenErrorEnum.h>
 #include <proxygen/httpserver/ResponseBuilder.h>
 
 DEFINE_int32(download_thread_num, 3, "download thread number");
+DEFINE_bool(download_sst_by_file, false,
+            "Whether the download threads download the SST files of the parts one by one, "
+            "rather than the dir of a part by a thread");
+DEFINE_int32(download_retry_times, 2,
+             "The times to download an SST file again if it failed or is corrupted, only if "
+             "download_sst_by_file is set");
+DEFINE_bool(download_verify_checksum, false,
+            "Whether to verify the blocks of each SST file downloaded by file, a corrupted file "
+            "is downloaded again");
 
 namespace nebula {
 namespace storage {
@@ -61,6 +71,7 @@ void StorageHttpDownloadHandler::onRequest(std::unique_ptr<HTTPMessage> headers)
      hdfsPath_ = headers->getQueryParam("path");
      partitions_ = headers->getQueryParam("parts");
      spaceID_ = headers->getIntQueryParam("space");
+     ingest_ = headers->hasQueryParam("ingest") && headers->getQueryParam("ingest") == "true";
 
      for (auto &path : paths_) {
          auto downloadPath = folly::stringPrintf("%s/nebula/%d/download", path.c_str(), spaceID_);
@@ -154,16 +165,24 @@ bool StorageHttpDownloadHandler::downloadSSTFiles(const std::string& hdfsHost,
 
     std::vector<folly::SemiFuture<bool>> futures;
 
+    std::vector<PartitionID> partIds;
     for (auto& part : parts) {
-        PartitionID partId;
         try {
-            partId = folly::to<PartitionID>(part);
+            partIds.emplace_back(folly::to<PartitionID>(part));
         } catch (const std::exception& ex) {
             isRunning.clear();
             LOG(ERROR) << "Invalid part: \"" << part << "\"";
             return false;
         }
+    }
+    if (FLAGS_download_sst_by_file) {
+        auto successfully = downloadSSTFilesByFile(hdfsHost, hdfsPort, hdfsPath, partIds);
+        LOG(INFO) << "Download tasks have finished";
+        isRunning.clear();
+        return successfully;
+    }
 
+    for (auto partId : partIds) {
         auto downloader = [hdfsHost, hdfsPort, hdfsPath, partId, this]() {
             auto hdfsPartPath = folly::stringPrintf("%s/%d", hdfsPath.c_str(), partId);
             auto partResult = kvstore_->part(spaceID_, partId);
@@ -200,5 +219,141 @@ bool StorageHttpDownloadHandler::downloadSSTFiles(const std::string& hdfsHost,
     return successfully;
 }
 
+bool StorageHttpDownloadHandler::downloadSSTFilesByFile(const std::string& hdfsHost,
+                                                        int32_t hdfsPort,
+                                                        const std::string& hdfsPath,
+                                                        const std::vector<PartitionID>& parts) {
+    // The files of the parts are listed in parallel first, since the hadoop client takes
+    // seconds to start, then downloaded by the threads file by file. A part is ingested by the
+    // thread downloading its last file if asked, while the files of the others are downloaded.
+    struct PartDownload {
+        PartitionID             partId;
+        std::string             localPath;
+        std::atomic<size_t>     left{0};
+        std::atomic<bool>       failed{false};
+    };
+
+    std::vector<folly::SemiFuture<StatusOr<std::vector<std::string>>>> lists;
+    for (auto partId : parts) {
+        lists.emplace_back(pool_->addTask([hdfsHost, hdfsPort, hdfsPath, partId, this]() {
+            return listSSTFiles(hdfsHost, hdfsPort,
+                                folly::stringPrintf("%s/%d", hdfsPath.c_str(), partId));
+        }));
+    }
+    auto listed = folly::collectAll(lists).get();
+
+    std::vector<std::pair<std::shared_ptr<PartDownload>, std::vector<std::string>>> downloads;
+    for (size_t i = 0; i < parts.size(); i++) {
+        if (listed[i].hasException() || !listed[i].value().ok()) {
+            LOG(ERROR) << "List the SST files of part " << parts[i] << " failed";
+            return false;
+        }
+        auto partResult = kvstore_->part(spaceID_, parts[i]);
+        if (!ok(partResult)) {
+            LOG(ERROR) << "Can't found space: " << spaceID_ << ", part: " << parts[i];
+            return false;
+        }
+        auto download = std::make_shared<PartDownload>();
+        download->partId = parts[i];
+        download->localPath = folly::stringPrintf("%s/download/%d",
+                                                  value(partResult)->engine()->getDataRoot(),
+                                                  parts[i]);
+        if (!fs::FileUtils::exist(download->localPath) &&
+            !fs::FileUtils::makeDir(download->localPath)) {
+            LOG(ERROR) << "Make dir " << download->localPath << " failed";
+            return false;
+        }
+        auto files = std::move(listed[i].value()).value();
+        download->left = files.size();
+        downloads.emplace_back(std::move(download), std::move(files));
+    }
+
+    std::vector<folly::SemiFuture<bool>> futures;
+    for (auto& entry : downloads) {
+        for (auto& file : entry.second) {
+            auto download = entry.first;
+            futures.emplace_back(pool_->addTask([hdfsHost, hdfsPort, file, download, this]() {
+                auto succeeded = downloadSSTFile(hdfsHost, hdfsPort, file, download->localPath);
+                if (!succeeded) {
+                    download->failed = true;
+                }
+                if (--download->left == 0 && !download->failed && ingest_) {
+                    auto code = kvstore_->ingest(spaceID_, download->partId);
+                    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                        LOG(ERROR) << "Ingest part " << download->partId << " failed: "
+                                   << apache::thrift::util::enumNameSafe(code);
+                        succeeded = false;
+                    }
+                }
+                return succeeded;
+            }));
+        }
+    }
+
+    bool successfully{true};
+    auto tries = folly::collectAll(futures).get();
+    for (const auto& t : tries) {
+        if (t.hasException()) {
+            LOG(ERROR) << "Download Failed: " << t.exception();
+            successfully = false;
+        } else if (!t.value()) {
+            successfully = false;
+        }
+    }
+    return successfully;
+}
+
+StatusOr<std::vector<std::string>>
+StorageHttpDownloadHandler::listSSTFiles(const std::string& hdfsHost,
+                                         int32_t hdfsPort,
+                                         const std::string& hdfsPartPath) {
+    auto result = helper_->ls(hdfsHost, hdfsPort, hdfsPartPath);
+    if (!result.ok()) {
+        return result.status();
+    }
+    std::vector<folly::StringPiece> lines;
+    folly::split("\n", result.value(), lines, true);
+    std::vector<std::string> files;
+    for (auto line : lines) {
+        // the path is the last column of a file listed
+        auto pos = line.rfind(' ');
+        auto path = pos == folly::StringPiece::npos ? line : line.subpiece(pos + 1);
+        if (path.endsWith(".sst")) {
+            files.emplace_back(path.str());
+        }
+    }
+    return files;
+}
+
+bool StorageHttpDownloadHandler::downloadSSTFile(const std::string& hdfsHost,
+                                                 int32_t hdfsPort,
+                                                 const std::string& hdfsFile,
+                                                 const std::string& localPath) {
+    auto localFile = folly::stringPrintf("%s/%s", localPath.c_str(),
+                                         hdfsFile.substr(hdfsFile.rfind('/') + 1).c_str());
+    for (int32_t i = 0; i <= FLAGS_download_retry_times; i++) {
+        // what is left by the last try
+        if (fs::FileUtils::exist(localFile)) {
+            fs::FileUtils::remove(localFile.c_str());
+        }
+        auto result = helper_->copyToLocal(hdfsHost, hdfsPort, hdfsFile, localPath);
+        if (!result.ok() || !result.value().empty()) {
+            LOG(WARNING) << "Download " << hdfsFile << " failed: "
+                         << (result.ok() ? result.value() : result.status().toString());
+            continue;
+        }
+        if (FLAGS_download_verify_checksum) {
+            auto status = kvstore::RocksEngine::verifyFile(localFile);
+            if (!status.ok()) {
+                LOG(WARNING) << "Downloaded " << localFile << " is corrupted: "
+                             << status.ToString();
+                continue;
+            }
+        }
+        return true;
+    }
+    return false;
+}
+
 }  // namespace storage
 }  // namespace nebula
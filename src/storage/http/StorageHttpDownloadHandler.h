@@ -46,6 +46,22 @@ private:
                           const std::string& path,
                           const std::vector<std::string>& parts);
 
+    // Download the SST files of the parts by file, ingest each part once downloaded if asked
+    bool downloadSSTFilesByFile(const std::string& hdfsHost,
+                                int32_t hdfsPort,
+                                const std::string& hdfsPath,
+                                const std::vector<PartitionID>& parts);
+
+    // The paths of the SST files in the hdfs dir of a part
+    StatusOr<std::vector<std::string>> listSSTFiles(const std::string& hdfsHost,
+                                                    int32_t hdfsPort,
+                                                    const std::string& hdfsPartPath);
+
+    // Download an SST file into the local path, again if it failed or is corrupted
+    bool downloadSSTFile(const std::string& hdfsHost,
+                         int32_t hdfsPort,
+                         const std::string& hdfsFile,
+                         const std::string& localPath);
 
 private:
     HttpCode err_{HttpCode::SUCCEEDED};
@@ -54,6 +70,8 @@ private:
     int32_t hdfsPort_;
     std::string hdfsPath_;
     std::string partitions_;
+    // ingest each part once its files are downloaded, only if download_sst_by_file is set
+    bool ingest_{false};
     nebula::hdfs::HdfsHelper *helper_;
     nebula::thread::GenericThreadPool *pool_;
     nebula::kvstore::KVStore *kvstore_;
@@ -0,0 +1,132 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/http/StorageHttpSplitHandler.h"
+#include "kvstore/NebulaStore.h"
+#include <folly/json.h>
+#include <proxygen/lib/http/ProxygenErrorEnum.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+
+namespace nebula {
+namespace storage {
+
+using proxygen::HTTPMessage;
+using proxygen::HTTPMethod;
+using proxygen::ProxygenError;
+using proxygen::UpgradeProtocol;
+using proxygen::ResponseBuilder;
+
+void StorageHttpSplitHandler::onRequest(std::unique_ptr<HTTPMessage> headers) noexcept {
+    if (headers->getMethod().value() != HTTPMethod::GET) {
+        // Unsupported method
+        err_ = HttpCode::E_UNSUPPORTED_METHOD;
+        return;
+    }
+    auto* store = dynamic_cast<kvstore::NebulaStore*>(kv_);
+    if (schemaMan_ == nullptr || indexMan_ == nullptr || store == nullptr) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        return;
+    }
+    if (!headers->hasQueryParam("space") || !headers->hasQueryParam("parts") ||
+        !headers->hasQueryParam("op")) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        return;
+    }
+    auto spaceId = headers->getIntQueryParam("space");
+    auto op = headers->getQueryParam("op");
+
+    kvstore::PartSplit split;
+    split.parts = headers->getIntQueryParam("parts");
+    if (split.parts <= 0) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        return;
+    }
+    if (op == "status") {
+        respond(store->splitStatus(spaceId, split.parts));
+        return;
+    }
+
+    using Status = kvstore::PartSplit::Status;
+    static const std::unordered_map<std::string, Status> kOps = {
+        {"freeze", Status::FROZEN},
+        {"copy", Status::COPYING},
+        {"copied", Status::COPIED},
+        {"cleanup", Status::CLEANED},
+    };
+    auto it = kOps.find(op);
+    auto vidLen = schemaMan_->getSpaceVidLen(spaceId);
+    auto vidType = schemaMan_->getSpaceVidType(spaceId);
+    auto indexes = indexMan_->getEdgeIndexes(spaceId);
+    if (it == kOps.end() || !vidLen.ok() || !vidType.ok() || !indexes.ok()) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        return;
+    }
+    split.status = it->second;
+    split.vidLen = vidLen.value();
+    split.intId = vidType.value() == meta::cpp2::PropertyType::INT64;
+    for (auto& index : indexes.value()) {
+        split.edgeIndexes.emplace(index->get_index_id());
+    }
+    LOG(INFO) << "Split step " << op << " of the " << split.parts << " parts of space "
+              << spaceId;
+    respond(store->splitParts(spaceId, split));
+}
+
+void StorageHttpSplitHandler::respond(
+        const ErrorOr<nebula::cpp2::ErrorCode, kvstore::NebulaStore::SplitStatus>& ret) {
+    if (!nebula::ok(ret)) {
+        resp_ = folly::stringPrintf("Split failed! error=%d",
+                                    static_cast<int32_t>(nebula::error(ret)));
+        return;
+    }
+    folly::dynamic parts = folly::dynamic::object();
+    for (auto& entry : nebula::value(ret)) {
+        parts[folly::to<std::string>(entry.first)] = kvstore::PartSplit::toString(entry.second);
+    }
+    resp_ = folly::toJson(parts);
+}
+
+void StorageHttpSplitHandler::onBody(std::unique_ptr<folly::IOBuf>) noexcept {
+    // Do nothing, we only support GET
+}
+
+void StorageHttpSplitHandler::onEOM() noexcept {
+    switch (err_) {
+        case HttpCode::E_UNSUPPORTED_METHOD:
+            ResponseBuilder(downstream_)
+                .status(405, "Method Not Allowed")
+                .sendWithEOM();
+            return;
+        case HttpCode::E_ILLEGAL_ARGUMENT:
+            ResponseBuilder(downstream_)
+                .status(400, "Bad Request")
+                .sendWithEOM();
+            return;
+        default:
+            break;
+    }
+
+    ResponseBuilder(downstream_)
+        .status(200, "OK")
+        .body(resp_)
+        .sendWithEOM();
+}
+
+void StorageHttpSplitHandler::onUpgrade(UpgradeProtocol) noexcept {
+    // Do nothing
+}
+
+void StorageHttpSplitHandler::requestComplete() noexcept {
+    delete this;
+}
+
+void StorageHttpSplitHandler::onError(ProxygenError error) noexcept {
+    LOG(ERROR) << "Web service StorageHttpSplitHandler got error: "
+               << proxygen::getErrorString(error);
+}
+
+}  // namespace storage
+}  // namespace nebula
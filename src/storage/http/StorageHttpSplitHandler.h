@@ -0,0 +1,63 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_HTTP_STORAGEHTTPSPLITHANDLER_H_
+#define STORAGE_HTTP_STORAGEHTTPSPLITHANDLER_H_
+
+#include "common/base/Base.h"
+#include "common/webservice/Common.h"
+#include "common/meta/SchemaManager.h"
+#include "common/meta/IndexManager.h"
+#include "kvstore/NebulaStore.h"
+#include <proxygen/httpserver/RequestHandler.h>
+
+namespace nebula {
+namespace storage {
+
+using nebula::HttpCode;
+
+/*
+StorageHttpSplitHandler runs a step of the split of the parts of a space on this host, it is
+called by metad when the parts of the space are doubled, see kvstore::PartSplit.
+  /split?space=<id>&parts=<n>&op=freeze|copy|copied|cleanup|status
+It responds the status of the split of each part on this host in json.
+*/
+class StorageHttpSplitHandler : public proxygen::RequestHandler {
+public:
+    StorageHttpSplitHandler(meta::SchemaManager* schemaMan,
+                            meta::IndexManager* indexMan,
+                            kvstore::KVStore* kv)
+        : schemaMan_(schemaMan)
+        , indexMan_(indexMan)
+        , kv_(kv) {}
+
+    void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers) noexcept override;
+
+    void onBody(std::unique_ptr<folly::IOBuf> body)  noexcept override;
+
+    void onEOM() noexcept override;
+
+    void onUpgrade(proxygen::UpgradeProtocol protocol) noexcept override;
+
+    void requestComplete() noexcept override;
+
+    void onError(proxygen::ProxygenError error) noexcept override;
+
+private:
+    void respond(const ErrorOr<nebula::cpp2::ErrorCode, kvstore::NebulaStore::SplitStatus>& ret);
+
+private:
+    HttpCode err_{HttpCode::SUCCEEDED};
+    std::string resp_;
+    meta::SchemaManager* schemaMan_ = nullptr;
+    meta::IndexManager*  indexMan_ = nullptr;
+    kvstore::KVStore*    kv_ = nullptr;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_HTTP_STORAGEHTTPSPLITHANDLER_H_
@@ -5,6 +5,7 @@
  */
 
 #include "common/base/Base.h"
+#include "kvstore/EngineEventStats.h"
 #include "kvstore/RocksEngineConfig.h"
 #include "storage/http/StorageHttpStatsHandler.h"
 #include <proxygen/lib/http/ProxygenErrorEnum.h>
@@ -44,9 +45,142 @@ folly::dynamic StorageHttpStatsHandler::getStats() const {
             }
         }
     }
+    addVertexCacheStats(stats);
+    addReclaimStats(stats);
+    addPartTrafficStats(stats);
+    addEngineEventStats(stats);
+    addRequestPerfStats(stats);
     return stats;
 }
 
+void StorageHttpStatsHandler::addVertexCacheStats(folly::dynamic& stats) const {
+    if (vertexCache_ == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < vertexCache_->shardsNum(); i++) {
+        auto shardStats = vertexCache_->shardStats(i);
+        auto prefix = folly::stringPrintf("vertex_cache.shard_%lu.", i);
+        std::vector<std::pair<std::string, uint64_t>> values = {
+            {prefix + "hits", shardStats.hits_},
+            {prefix + "misses", shardStats.misses_},
+            {prefix + "evicts", shardStats.evicts_},
+            {prefix + "lru_evicts", shardStats.lruEvicts_},
+            {prefix + "rejects", shardStats.rejects_},
+            {prefix + "entries", shardStats.entries_},
+            {prefix + "bytes", shardStats.bytes_},
+        };
+        for (const auto& value : values) {
+            if (!statFiltered(value.first)) {
+                addOneStat(stats, value.first, value.second);
+            }
+        }
+    }
+}
+
+void StorageHttpStatsHandler::addReclaimStats(folly::dynamic& stats) const {
+    if (reclaimer_ == nullptr) {
+        return;
+    }
+    auto progress = reclaimer_->progress();
+    std::vector<std::pair<std::string, int64_t>> values = {
+        {"reclaim.dirs", progress.dirs},
+        {"reclaim.bytes_left", progress.bytesLeft},
+        {"reclaim.bytes_reclaimed", progress.bytesReclaimed},
+    };
+    for (const auto& value : values) {
+        if (!statFiltered(value.first)) {
+            addOneStat(stats, value.first, value.second);
+        }
+    }
+}
+
+void StorageHttpStatsHandler::addPartTrafficStats(folly::dynamic& stats) const {
+    if (partTraffic_ == nullptr) {
+        return;
+    }
+    for (auto spaceId : partTraffic_->spaces()) {
+        for (const auto& part : partTraffic_->loads(spaceId)) {
+            auto prefix = folly::stringPrintf("part_traffic.space_%d.part_%d.",
+                                              spaceId, part.first);
+            std::vector<std::pair<std::string, double>> values = {
+                {prefix + "read_qps", part.second.readQps},
+                {prefix + "write_qps", part.second.writeQps},
+                {prefix + "write_bytes_per_sec", part.second.writeBytesPerSec},
+            };
+            for (const auto& value : values) {
+                if (!statFiltered(value.first)) {
+                    addOneStat(stats, value.first, value.second);
+                }
+            }
+        }
+        for (const auto& vertex : partTraffic_->hotVertices(spaceId)) {
+            auto name = folly::stringPrintf("part_traffic.space_%d.hot_vertex.part_%d.%s",
+                                            spaceId, vertex.partId, vertex.vid.c_str());
+            if (!statFiltered(name)) {
+                addOneStat(stats, name, vertex.count);
+            }
+        }
+    }
+}
+
+void StorageHttpStatsHandler::addEngineEventStats(folly::dynamic& stats) const {
+    if (!FLAGS_enable_rocksdb_event_stats) {
+        return;
+    }
+    for (const auto& entry : kvstore::EngineEventStats::instance().snapshot()) {
+        auto prefix = folly::stringPrintf("rocksdb_events.space_%d.%s.",
+                                          entry.first.first,
+                                          entry.first.second.c_str());
+        const auto& counters = entry.second;
+        std::vector<std::pair<std::string, int64_t>> values = {
+            {prefix + "flushes", counters.flushes},
+            {prefix + "flush_bytes", counters.flushBytes},
+            {prefix + "flush_us", counters.flushMicros},
+            {prefix + "compactions", counters.compactions},
+            {prefix + "compaction_read_bytes", counters.compactionReadBytes},
+            {prefix + "compaction_write_bytes", counters.compactionWriteBytes},
+            {prefix + "compaction_us", counters.compactionMicros},
+            {prefix + "write_amplification_pct", counters.writeAmplification()},
+            {prefix + "stalls", counters.stalls},
+            {prefix + "stall_us", counters.stallMicros},
+            {prefix + "ingested_files", counters.ingestedFiles},
+            {prefix + "ingested_bytes", counters.ingestedBytes},
+        };
+        for (const auto& value : values) {
+            if (!statFiltered(value.first)) {
+                addOneStat(stats, value.first, value.second);
+            }
+        }
+    }
+}
+
+void StorageHttpStatsHandler::addRequestPerfStats(folly::dynamic& stats) const {
+    for (const auto& entry : RequestPerfStats::instance().snapshot()) {
+        auto prefix = folly::stringPrintf("rocksdb_perf.%s.space_%d.",
+                                          entry.first.first.c_str(),
+                                          entry.first.second);
+        const auto& perf = entry.second.perf;
+        std::vector<std::pair<std::string, int64_t>> values = {
+            {prefix + "requests", entry.second.requests},
+            {prefix + "block_reads", perf.blockReads},
+            {prefix + "block_read_bytes", perf.blockReadBytes},
+            {prefix + "block_cache_hits", perf.blockCacheHits},
+            {prefix + "bloom_useful", perf.bloomUseful},
+            {prefix + "bloom_checked", perf.bloomChecked},
+            {prefix + "keys_skipped", perf.keysSkipped},
+            {prefix + "deletes_skipped", perf.deletesSkipped},
+            {prefix + "memtable_seeks", perf.memtableSeeks},
+            {prefix + "child_seeks", perf.childSeeks},
+            {prefix + "bytes_read", perf.bytesRead},
+        };
+        for (const auto& value : values) {
+            if (!statFiltered(value.first)) {
+                addOneStat(stats, value.first, value.second);
+            }
+        }
+    }
+}
+
 bool StorageHttpStatsHandler::statFiltered(const std::string& stat) const {
     if (statNames_.empty()) {
         return false;
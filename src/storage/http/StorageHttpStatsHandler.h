@@ -9,18 +9,46 @@
 
 #include "common/base/Base.h"
 #include "common/webservice/GetStatsHandler.h"
+#include "kvstore/DataReclaimer.h"
+#include "storage/PartTraffic.h"
+#include "storage/RequestProfile.h"
+#include "storage/VertexCache.h"
 
 namespace nebula {
 namespace storage {
 
 class StorageHttpStatsHandler : public nebula::GetStatsHandler {
 public:
-    StorageHttpStatsHandler() = default;
+    // stats of vertexCache, the progress of reclaimer and the traffic of the parts are
+    // returned as well if not null
+    explicit StorageHttpStatsHandler(const VertexCache* vertexCache = nullptr,
+                                     const kvstore::DataReclaimer* reclaimer = nullptr,
+                                     const PartTraffic* partTraffic = nullptr)
+        : vertexCache_(vertexCache)
+        , reclaimer_(reclaimer)
+        , partTraffic_(partTraffic) {}
     void onError(proxygen::ProxygenError err) noexcept override;
     folly::dynamic getStats() const override;
 
 private:
     bool statFiltered(const std::string& stat) const;
+
+    void addVertexCacheStats(folly::dynamic& stats) const;
+
+    void addReclaimStats(folly::dynamic& stats) const;
+
+    // the rates of each part and the counts of the hot vertices in the last window
+    void addPartTrafficStats(folly::dynamic& stats) const;
+
+    // the counters of the flushes, compactions and stalls of each space and column family
+    void addEngineEventStats(folly::dynamic& stats) const;
+
+    // the rocksdb perf context of the requests sampled by each request type and space
+    void addRequestPerfStats(folly::dynamic& stats) const;
+
+    const VertexCache* vertexCache_{nullptr};
+    const kvstore::DataReclaimer* reclaimer_{nullptr};
+    const PartTraffic* partTraffic_{nullptr};
 };
 
 }  // namespace storage
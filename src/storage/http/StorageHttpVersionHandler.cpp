@@ -0,0 +1,122 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/http/StorageHttpVersionHandler.h"
+#include <folly/json.h>
+#include <proxygen/lib/http/ProxygenErrorEnum.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+
+namespace nebula {
+namespace storage {
+
+using proxygen::HTTPMessage;
+using proxygen::HTTPMethod;
+using proxygen::ProxygenError;
+using proxygen::UpgradeProtocol;
+using proxygen::ResponseBuilder;
+
+void StorageHttpVersionHandler::onRequest(std::unique_ptr<HTTPMessage> headers) noexcept {
+    if (headers->getMethod().value() != HTTPMethod::GET) {
+        // Unsupported method
+        err_ = HttpCode::E_UNSUPPORTED_METHOD;
+        return;
+    }
+    auto* store = dynamic_cast<kvstore::NebulaStore*>(kv_);
+    if (store == nullptr || !headers->hasQueryParam("space")) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        return;
+    }
+    auto spaceId = headers->getIntQueryParam("space");
+    std::unordered_map<PartitionID, LogID> since;
+    if (headers->hasQueryParam("since") &&
+        !parseSince(headers->getQueryParam("since"), &since)) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        return;
+    }
+
+    auto ret = store->partVersions(spaceId);
+    if (!nebula::ok(ret)) {
+        resp_ = folly::stringPrintf("Get versions failed! error=%d",
+                                    static_cast<int32_t>(nebula::error(ret)));
+        return;
+    }
+    folly::dynamic parts = folly::dynamic::object();
+    for (const auto& entry : nebula::value(ret)) {
+        auto key = folly::to<std::string>(entry.first);
+        auto it = since.find(entry.first);
+        if (it != since.end() && it->second == entry.second.version) {
+            parts[key] = "not_modified";
+            continue;
+        }
+        folly::dynamic part = folly::dynamic::object();
+        part["version"] = entry.second.version;
+        part["leader"] = entry.second.leader;
+        parts[key] = std::move(part);
+    }
+    resp_ = folly::toJson(parts);
+}
+
+bool StorageHttpVersionHandler::parseSince(const std::string& since,
+                                           std::unordered_map<PartitionID, LogID>* versions) {
+    std::vector<folly::StringPiece> items;
+    folly::split(",", since, items, true);
+    for (const auto& item : items) {
+        folly::StringPiece part;
+        folly::StringPiece version;
+        if (!folly::split(":", item, part, version)) {
+            return false;
+        }
+        auto partId = folly::tryTo<PartitionID>(part);
+        auto logId = folly::tryTo<LogID>(version);
+        if (!partId.hasValue() || !logId.hasValue()) {
+            return false;
+        }
+        (*versions)[partId.value()] = logId.value();
+    }
+    return true;
+}
+
+void StorageHttpVersionHandler::onBody(std::unique_ptr<folly::IOBuf>) noexcept {
+    // Do nothing, we only support GET
+}
+
+void StorageHttpVersionHandler::onEOM() noexcept {
+    switch (err_) {
+        case HttpCode::E_UNSUPPORTED_METHOD:
+            ResponseBuilder(downstream_)
+                .status(405, "Method Not Allowed")
+                .sendWithEOM();
+            return;
+        case HttpCode::E_ILLEGAL_ARGUMENT:
+            ResponseBuilder(downstream_)
+                .status(400, "Bad Request")
+                .sendWithEOM();
+            return;
+        default:
+            break;
+    }
+
+    ResponseBuilder(downstream_)
+        .status(200, "OK")
+        .body(resp_)
+        .sendWithEOM();
+}
+
+void StorageHttpVersionHandler::onUpgrade(UpgradeProtocol) noexcept {
+    // Do nothing
+}
+
+void StorageHttpVersionHandler::requestComplete() noexcept {
+    delete this;
+}
+
+void StorageHttpVersionHandler::onError(ProxygenError error) noexcept {
+    LOG(ERROR) << "Web service StorageHttpVersionHandler got error: "
+               << proxygen::getErrorString(error);
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,58 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_HTTP_STORAGEHTTPVERSIONHANDLER_H_
+#define STORAGE_HTTP_STORAGEHTTPVERSIONHANDLER_H_
+
+#include "common/base/Base.h"
+#include "common/webservice/Common.h"
+#include "kvstore/NebulaStore.h"
+#include <proxygen/httpserver/RequestHandler.h>
+
+namespace nebula {
+namespace storage {
+
+using nebula::HttpCode;
+
+/*
+StorageHttpVersionHandler responds the version of the data of each part of a space on this host,
+see NebulaStore::partVersions, so that a cache out of storaged could tell whether a part has
+changed since it was read, and only read the parts changed again.
+  /part_versions?space=<id>[&since=<part>:<version>,<part>:<version>...]
+It responds in json the version and whether this host leads of each part, and a part of the
+version given in since is responded as "not_modified" only.
+*/
+class StorageHttpVersionHandler : public proxygen::RequestHandler {
+public:
+    explicit StorageHttpVersionHandler(kvstore::KVStore* kv)
+        : kv_(kv) {}
+
+    void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers) noexcept override;
+
+    void onBody(std::unique_ptr<folly::IOBuf> body)  noexcept override;
+
+    void onEOM() noexcept override;
+
+    void onUpgrade(proxygen::UpgradeProtocol protocol) noexcept override;
+
+    void requestComplete() noexcept override;
+
+    void onError(proxygen::ProxygenError error) noexcept override;
+
+    // The versions of <part>:<version>,... false if it is malformed
+    static bool parseSince(const std::string& since,
+                           std::unordered_map<PartitionID, LogID>* versions);
+
+private:
+    HttpCode err_{HttpCode::SUCCEEDED};
+    std::string resp_;
+    kvstore::KVStore*    kv_ = nullptr;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_HTTP_STORAGEHTTPVERSIONHANDLER_H_
@@ -43,10 +43,37 @@ protected:
 
     nebula::cpp2::ErrorCode requestCheck(const cpp2::LookupIndexRequest& req);
 
+    // Find the contexts which are intersected with the previous one of the same conjunctive
+    // filter, see conjunctProps
+    void groupIntersectedContexts();
+
+    /**
+     * Collect the properties compared in the conjuncts of the filter. It is false if the filter
+     * is not a conjunction of comparisons, e.g. it has an OR, an IN or a NOT, whose contexts are
+     * the branches of it. The contexts of a conjunctive filter whose hints are all on these
+     * properties could be intersected, since a row matching the filter is in each of them.
+     * */
+    static bool conjunctProps(const Expression* filter, std::unordered_set<std::string>* props);
+
+    // Take the context of the fewest estimated rows in each group as the one to scan, and
+    // intersect with the others from the fewest
+    void estimateIntersectedContexts(const std::vector<PartitionID>& parts);
+
+    // Whether the rows of each part are returned in the order of orderBy_, where to stop the
+    // scans of the parts for limit_ is decided by it
+    void checkOrderLimit();
+
     bool isOutsideIndex(Expression* filter, const meta::cpp2::IndexItem* index);
 
+    // Whether all yield columns could be decoded from the index key without reading the data
+    bool isCoveringIndex(const std::vector<meta::cpp2::ColumnDef>& fields);
+
     StatusOr<StoragePlan<IndexID>> buildPlan(IndexFilterItem* filterItem, nebula::DataSet* result);
 
+    // The scan stops at limit_ unless a filter drops the keys after it
+    std::unique_ptr<IndexScanNode<IndexID>> buildIndexScan(const cpp2::IndexQueryContext& ctx,
+                                                           bool filtered = false);
+
     std::unique_ptr<IndexOutputNode<IndexID>>
     buildPlanBasic(nebula::DataSet* result,
                    const cpp2::IndexQueryContext& ctx,
@@ -82,11 +109,24 @@ protected:
     nebula::DataSet                                                resultDataSet_;
     std::vector<nebula::DataSet>                                   partResults_;
     std::vector<cpp2::IndexQueryContext>                           indexContexts_{};
+    // The contexts with the same filter are the different indexes of one condition, the scan
+    // of the first one is intersected with the others, which are not scanned by themselves.
+    std::vector<std::vector<size_t>>                               intersectContexts_;
+    std::vector<bool>                                              intersected_;
     std::vector<std::string>                                       yieldCols_{};
     std::vector<IndexFilterItem>                                   filterItems_;
     // Save schemas when column is out of index, need to read from data
     std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>> schemas_;
     std::vector<size_t>                                            deDupColPos_;
+    // ORDER BY the yield columns ascending and LIMIT, the limit is -1 if not set
+    std::vector<std::string>                                       orderBy_;
+    int64_t                                                        limit_{-1};
+    // Only one index is scanned and orderBy_ is a prefix of its columns, so the rows of each
+    // part are in the order. The positions of orderBy_ in the yield columns, and the length of
+    // the index key prefix encoding them.
+    bool                                                           ordered_{false};
+    std::vector<size_t>                                            orderPos_;
+    size_t                                                         tieLen_{0};
 };
 
 }  // namespace storage
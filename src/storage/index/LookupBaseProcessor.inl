@@ -21,6 +21,7 @@ LookupBaseProcessor<REQ, RESP>::requestCheck(const cpp2::LookupIndexRequest& req
         this->env_, spaceId_, this->spaceVidLen_, this->isIntId_);
     const auto& indices = req.get_indices();
     this->planContext_->isEdge_ = indices.get_is_edge();
+    this->planContext_->canReadFromFollower_ = FLAGS_enable_follower_read;
     this->context_ = std::make_unique<RunTimeContext>(this->planContext_.get());
     if (context_->isEdge()) {
         context_->edgeType_ = indices.get_tag_or_edge_id();
@@ -61,6 +62,8 @@ LookupBaseProcessor<REQ, RESP>::requestCheck(const cpp2::LookupIndexRequest& req
         return nebula::cpp2::ErrorCode::E_INVALID_OPERATION;
     }
     indexContexts_ = indices.get_contexts();
+    groupIntersectedContexts();
+    estimateIntersectedContexts(req.get_parts());
 
     // setup yield columns.
     if (req.return_columns_ref().has_value()) {
@@ -73,10 +76,213 @@ LookupBaseProcessor<REQ, RESP>::requestCheck(const cpp2::LookupIndexRequest& req
             deDupColPos_.emplace_back(it.index);
         }
     }
+    checkOrderLimit();
 
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
+template<typename REQ, typename RESP>
+void LookupBaseProcessor<REQ, RESP>::checkOrderLimit() {
+    ordered_ = false;
+    if (limit_ < 0 || orderBy_.empty()) {
+        return;
+    }
+    // the rows of one part are in the order of index keys only if one index is scanned
+    const cpp2::IndexQueryContext* scanned = nullptr;
+    for (size_t i = 0; i < indexContexts_.size(); i++) {
+        if (!intersected_[i]) {
+            if (scanned != nullptr) {
+                return;
+            }
+            scanned = &indexContexts_[i];
+        }
+    }
+    if (scanned == nullptr) {
+        return;
+    }
+    auto index = context_->isEdge()
+        ? this->env_->indexMan_->getEdgeIndex(spaceId_, scanned->get_index_id())
+        : this->env_->indexMan_->getTagIndex(spaceId_, scanned->get_index_id());
+    if (!index.ok()) {
+        return;
+    }
+    const auto& fields = index.value()->get_fields();
+    if (orderBy_.size() > fields.size()) {
+        return;
+    }
+    std::vector<size_t> orderPos;
+    size_t tieLen = sizeof(PartitionID) + sizeof(IndexID);
+    for (size_t i = 0; i < orderBy_.size(); i++) {
+        const auto& field = fields[i];
+        if (field.get_name() != orderBy_[i] || field.get_nullable()) {
+            // the null is encoded as a value in the middle of the others
+            return;
+        }
+        // only the types encoded in the order of values, a string is of the fixed length
+        switch (IndexKeyUtils::toValueType(field.get_type().get_type())) {
+            case Value::Type::BOOL:
+            case Value::Type::INT:
+            case Value::Type::FLOAT:
+                break;
+            case Value::Type::STRING:
+                // a compact string is ordered by the prefix only
+                if (field.get_type().get_type_length() == nullptr ||
+                    IndexKeyUtils::isCompactString(field)) {
+                    return;
+                }
+                break;
+            default:
+                return;
+        }
+        auto yield = std::find(yieldCols_.begin(), yieldCols_.end(), orderBy_[i]);
+        if (yield == yieldCols_.end()) {
+            return;
+        }
+        orderPos.emplace_back(yield - yieldCols_.begin());
+        tieLen += IndexKeyUtils::indexFieldLen(field);
+    }
+    ordered_ = true;
+    orderPos_ = std::move(orderPos);
+    tieLen_ = tieLen;
+}
+
+template<typename REQ, typename RESP>
+void LookupBaseProcessor<REQ, RESP>::groupIntersectedContexts() {
+    intersectContexts_.assign(indexContexts_.size(), {});
+    intersected_.assign(indexContexts_.size(), false);
+    if (!FLAGS_enable_index_intersection) {
+        return;
+    }
+    auto filterOf = [] (const cpp2::IndexQueryContext& ctx) -> const std::string* {
+        auto filter = ctx.filter_ref();
+        return filter.is_set() && !(*filter).empty() ? &(*filter) : nullptr;
+    };
+    // The contexts of an OR are unioned by DeDupNode, only the ones whose hints are all implied
+    // by the conjuncts of the filter are taken as the indexes of one condition
+    ObjectPool pool;
+    auto isConjunct = [&pool] (const cpp2::IndexQueryContext& ctx, const std::string& filter) {
+        std::unordered_set<std::string> props;
+        if (!conjunctProps(Expression::decode(&pool, filter), &props)) {
+            return false;
+        }
+        for (const auto& hint : ctx.get_column_hints()) {
+            if (!props.count(hint.get_column_name())) {
+                return false;
+            }
+        }
+        return true;
+    };
+    for (size_t i = 0; i < indexContexts_.size(); i++) {
+        const auto* filter = filterOf(indexContexts_[i]);
+        if (intersected_[i] || filter == nullptr || !isConjunct(indexContexts_[i], *filter)) {
+            continue;
+        }
+        std::unordered_set<IndexID> indexIds{indexContexts_[i].get_index_id()};
+        for (size_t j = i + 1; j < indexContexts_.size(); j++) {
+            const auto* other = filterOf(indexContexts_[j]);
+            // the ranges of the same index are the alternatives of the condition
+            if (!intersected_[j] && other != nullptr && *other == *filter &&
+                indexIds.emplace(indexContexts_[j].get_index_id()).second &&
+                isConjunct(indexContexts_[j], *other)) {
+                intersectContexts_[i].emplace_back(j);
+                intersected_[j] = true;
+            }
+        }
+    }
+}
+
+template<typename REQ, typename RESP>
+bool LookupBaseProcessor<REQ, RESP>::conjunctProps(const Expression* filter,
+                                                   std::unordered_set<std::string>* props) {
+    if (filter == nullptr) {
+        return false;
+    }
+    switch (filter->kind()) {
+        case Expression::Kind::kLogicalAnd: {
+            auto* lExpr = static_cast<const LogicalExpression*>(filter);
+            for (const auto* expr : lExpr->operands()) {
+                if (!conjunctProps(expr, props)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+        case Expression::Kind::kRelLE:
+        case Expression::Kind::kRelGE:
+        case Expression::Kind::kRelEQ:
+        case Expression::Kind::kRelLT:
+        case Expression::Kind::kRelGT: {
+            auto* rExpr = static_cast<const RelationalExpression*>(filter);
+            for (const auto* expr : {rExpr->left(), rExpr->right()}) {
+                switch (expr->kind()) {
+                    case Expression::Kind::kTagProperty:
+                    case Expression::Kind::kEdgeProperty:
+                    case Expression::Kind::kEdgeSrc:
+                    case Expression::Kind::kEdgeType:
+                    case Expression::Kind::kEdgeRank:
+                    case Expression::Kind::kEdgeDst:
+                        props->emplace(static_cast<const PropertyExpression*>(expr)->prop());
+                        break;
+                    default:
+                        break;
+                }
+            }
+            return true;
+        }
+        default: {
+            // OR, XOR, NOT, IN, != and the others are not conjunctions of ranges
+            return false;
+        }
+    }
+}
+
+template<typename REQ, typename RESP>
+void LookupBaseProcessor<REQ, RESP>::estimateIntersectedContexts(
+        const std::vector<PartitionID>& parts) {
+    if (FLAGS_index_estimate_sample_num <= 0) {
+        return;
+    }
+    auto limit = static_cast<size_t>(FLAGS_index_estimate_sample_num);
+    auto estimate = [&] (size_t pos) {
+        IndexScanNode<IndexID> scan(context_.get(),
+                                    indexContexts_[pos].get_index_id(),
+                                    indexContexts_[pos].get_column_hints());
+        size_t rows = 0;
+        for (auto partId : parts) {
+            rows += scan.estimateRows(partId, limit);
+        }
+        return rows;
+    };
+
+    std::vector<std::vector<size_t>> groups;
+    for (size_t i = 0; i < indexContexts_.size(); i++) {
+        if (!intersectContexts_[i].empty()) {
+            std::vector<size_t> group{i};
+            group.insert(group.end(), intersectContexts_[i].begin(), intersectContexts_[i].end());
+            groups.emplace_back(std::move(group));
+        }
+    }
+    for (const auto& group : groups) {
+        // (estimated rows, position of context)
+        std::vector<std::pair<size_t, size_t>> candidates;
+        for (auto pos : group) {
+            candidates.emplace_back(estimate(pos), pos);
+            intersectContexts_[pos].clear();
+            intersected_[pos] = true;
+        }
+        std::stable_sort(candidates.begin(), candidates.end(),
+                         [] (const auto& a, const auto& b) { return a.first < b.first; });
+        auto primary = candidates.front().second;
+        intersected_[primary] = false;
+        for (size_t i = 1; i < candidates.size(); i++) {
+            intersectContexts_[primary].emplace_back(candidates[i].second);
+        }
+        VLOG(1) << "Scan the index " << indexContexts_[primary].get_index_id() << " of "
+                << candidates.front().first << " estimated rows, intersect with "
+                << candidates.size() - 1 << " indexes";
+    }
+}
+
 template<typename REQ, typename RESP>
 bool LookupBaseProcessor<REQ, RESP>::isOutsideIndex(Expression* filter,
                                                     const meta::cpp2::IndexItem* index) {
@@ -128,7 +334,8 @@ bool LookupBaseProcessor<REQ, RESP>::isOutsideIndex(Expression* filter,
             auto it = std::find_if(fields.begin(), fields.end(), [&propName] (const auto& f) {
                 return f.get_name() == propName;
             });
-            return it == fields.end();
+            // only the prefix of a compact string is in the index key
+            return it == fields.end() || IndexKeyUtils::isCompactString(*it);
         }
         default: {
             return false;
@@ -137,6 +344,26 @@ bool LookupBaseProcessor<REQ, RESP>::isOutsideIndex(Expression* filter,
     return false;
 }
 
+template<typename REQ, typename RESP>
+bool LookupBaseProcessor<REQ, RESP>::isCoveringIndex(
+        const std::vector<meta::cpp2::ColumnDef>& fields) {
+    static const std::set<std::string> propsInKey{kVid, kTag, kSrc, kType, kRank, kDst};
+    for (const auto& yieldCol : yieldCols_) {
+        if (propsInKey.count(yieldCol)) {
+            continue;
+        }
+        auto it = std::find_if(fields.begin(),
+                               fields.end(),
+                               [&yieldCol] (const auto& columnDef) {
+                                   return yieldCol == columnDef.get_name();
+                               });
+        if (it == fields.end() || IndexKeyUtils::isCompactString(*it)) {
+            return false;
+        }
+    }
+    return true;
+}
+
 /**
  * lookup plan should be :
  *              +--------+---------+
@@ -150,6 +377,13 @@ bool LookupBaseProcessor<REQ, RESP>::isOutsideIndex(Expression* filter,
  *            +----------+-----------+
  *            +  IndexOutputNode...  +
  *            +----------+-----------+
+ *
+ * If enable_index_intersection is on, the contexts with the same conjunctive filter build only
+ * one IndexOutputNode, its IndexScanNode scans the index of the fewest estimated rows (the
+ * first one if index_estimate_sample_num is 0) and intersects with the others.
+ *
+ * If the rows are ordered by a prefix of the columns of the only index scanned, there is no
+ * DeDupNode, and the scan of each part stops at the limit, see checkOrderLimit.
 **/
 
 template<typename REQ, typename RESP>
@@ -161,7 +395,12 @@ LookupBaseProcessor<REQ, RESP>::buildPlan(IndexFilterItem* filterItem, nebula::D
     std::unique_ptr<IndexOutputNode<IndexID>> out;
     auto pool = &planContext_->objPool_;
 
-    for (const auto& ctx : indexContexts_) {
+    for (size_t i = 0; i < indexContexts_.size(); i++) {
+        if (intersected_[i]) {
+            // it is intersected in the scan of another context
+            continue;
+        }
+        const auto& ctx = indexContexts_[i];
         const auto& indexId = ctx.get_index_id();
         auto needFilter = ctx.filter_ref().is_set() && !(*ctx.filter_ref()).empty();
 
@@ -189,22 +428,9 @@ LookupBaseProcessor<REQ, RESP>::buildPlan(IndexFilterItem* filterItem, nebula::D
             }
         }
 
-        for (const auto& yieldCol : yieldCols_) {
-            static const std::set<std::string> propsInKey{kVid, kTag, kSrc, kType, kRank, kDst};
-            if (propsInKey.count(yieldCol)) {
-                continue;
-            }
-            auto it = std::find_if(fields.begin(),
-                                   fields.end(),
-                                   [&yieldCol] (const auto& columnDef) {
-                                       return yieldCol == columnDef.get_name();
-                                   });
-            if (it == fields.end()) {
-                needData = true;
-                break;
-            }
+        if (!isCoveringIndex(fields)) {
+            needData = true;
         }
-        auto colHints = ctx.get_column_hints();
 
         // Check WHERE clause contains columns that ware not indexed
         if (ctx.filter_ref().is_set() && !(*ctx.filter_ref()).empty()) {
@@ -255,13 +481,38 @@ LookupBaseProcessor<REQ, RESP>::buildPlan(IndexFilterItem* filterItem, nebula::D
         if (out == nullptr) {
             return Status::Error("Index scan plan error");
         }
-        deDup->addDependency(out.get());
+        if (!ordered_) {
+            deDup->addDependency(out.get());
+        }
         plan.addNode(std::move(out));
     }
-    plan.addNode(std::move(deDup));
+    if (!ordered_) {
+        // one index scanned has no duplicate, and sorting for dedup loses the order
+        plan.addNode(std::move(deDup));
+    }
     return plan;
 }
 
+template<typename REQ, typename RESP>
+std::unique_ptr<IndexScanNode<IndexID>>
+LookupBaseProcessor<REQ, RESP>::buildIndexScan(const cpp2::IndexQueryContext& ctx,
+                                               bool filtered) {
+    auto indexScan = std::make_unique<IndexScanNode<IndexID>>(context_.get(),
+                                                              ctx.get_index_id(),
+                                                              ctx.get_column_hints());
+    // any rows are the first ones without order, otherwise the rows of a part must be in order
+    if (limit_ >= 0 && !filtered && (orderBy_.empty() || ordered_)) {
+        indexScan->setLimit(limit_, ordered_ ? tieLen_ : 0);
+    }
+    auto pos = static_cast<size_t>(&ctx - indexContexts_.data());
+    CHECK_LT(pos, indexContexts_.size());
+    for (auto other : intersectContexts_[pos]) {
+        indexScan->intersectWith(indexContexts_[other].get_index_id(),
+                                 indexContexts_[other].get_column_hints());
+    }
+    return indexScan;
+}
+
 /**
  *
  *            +----------+-----------+
@@ -285,11 +536,7 @@ LookupBaseProcessor<REQ, RESP>::buildPlanBasic(
     StoragePlan<IndexID>& plan,
     bool hasNullableCol,
     const std::vector<meta::cpp2::ColumnDef>& fields) {
-    auto indexId = ctx.get_index_id();
-    auto colHints = ctx.get_column_hints();
-    auto indexScan = std::make_unique<IndexScanNode<IndexID>>(context_.get(),
-                                                              indexId,
-                                                              std::move(colHints));
+    auto indexScan = buildIndexScan(ctx);
 
     auto output = std::make_unique<IndexOutputNode<IndexID>>(result,
                                                              context_.get(),
@@ -326,12 +573,7 @@ std::unique_ptr<IndexOutputNode<IndexID>>
 LookupBaseProcessor<REQ, RESP>::buildPlanWithData(nebula::DataSet* result,
                                                   const cpp2::IndexQueryContext& ctx,
                                                   StoragePlan<IndexID>& plan) {
-    auto indexId = ctx.get_index_id();
-    auto colHints = ctx.get_column_hints();
-
-    auto indexScan = std::make_unique<IndexScanNode<IndexID>>(context_.get(),
-                                                              indexId,
-                                                              std::move(colHints));
+    auto indexScan = buildIndexScan(ctx);
     if (context_->isEdge()) {
         auto edge = std::make_unique<IndexEdgeNode<IndexID>>(context_.get(),
                                                              indexScan.get(),
@@ -389,12 +631,7 @@ LookupBaseProcessor<REQ, RESP>::buildPlanWithFilter(nebula::DataSet* result,
                                                     StoragePlan<IndexID>& plan,
                                                     StorageExpressionContext* exprCtx,
                                                     Expression* exp) {
-    auto indexId = ctx.get_index_id();
-    auto colHints = ctx.get_column_hints();
-
-    auto indexScan = std::make_unique<IndexScanNode<IndexID>>(context_.get(),
-                                                              indexId,
-                                                              std::move(colHints));
+    auto indexScan = buildIndexScan(ctx, true);
 
     auto filter = std::make_unique<IndexFilterNode<IndexID>>(indexScan.get(),
                                                              exprCtx,
@@ -445,12 +682,7 @@ LookupBaseProcessor<REQ, RESP>::buildPlanWithDataAndFilter(nebula::DataSet* resu
                                                            StoragePlan<IndexID>& plan,
                                                            StorageExpressionContext* exprCtx,
                                                            Expression* exp) {
-    auto indexId = ctx.get_index_id();
-    auto colHints = ctx.get_column_hints();
-
-    auto indexScan = std::make_unique<IndexScanNode<IndexID>>(context_.get(),
-                                                              indexId,
-                                                              std::move(colHints));
+    auto indexScan = buildIndexScan(ctx, true);
     if (context_->isEdge()) {
         auto edge = std::make_unique<IndexEdgeNode<IndexID>>(context_.get(),
                                                              indexScan.get(),
@@ -32,6 +32,17 @@ void LookupProcessor::doProcess(const cpp2::LookupIndexRequest& req) {
         return;
     }
 
+    planContext_->budget_ = QueryBudget::fromFlags(spaceId_);
+    profile_ = RequestProfile::create("Lookup", spaceId_);
+    if (this->env_->resultCache_ != nullptr) {
+        cacheShape_ = ResultCache::shape("lookup", req);
+        // the order and the limit set aside of the request change the rows of a part as well
+        for (const auto& col : orderBy_) {
+            cacheShape_.append(col).append(1, '\0');
+        }
+        cacheShape_.append(reinterpret_cast<const char*>(&limit_), sizeof(int64_t));
+    }
+
     // todo(doodle): specify by each query
     if (!FLAGS_query_concurrently) {
         runInSingleThread(req);
@@ -51,15 +62,51 @@ void LookupProcessor::runInSingleThread(const cpp2::LookupIndexRequest& req) {
         return;
     }
 
+    plan.value().setProfile(profile_);
     std::unordered_set<PartitionID> failedParts;
+    // the rows of each part end at
+    std::vector<size_t> runEnds;
+    auto* budget = planContext_->budget_.get();
     for (const auto& partId : req.get_parts()) {
+        if (budget != nullptr && budget->exhausted()) {
+            // the part is not scanned
+            pushResultCode(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, partId);
+            continue;
+        }
+        ProfileSpan profileSpan(profile_, partId);
+        // the dedup sorts the rows of all parts scanned so far, which are not of the part only
+        folly::Optional<uint64_t> version;
+        if (deDupColPos_.empty()) {
+            std::shared_ptr<const ResultCache::Rows> cached;
+            version = cachedRows(partId, &cached);
+            if (cached != nullptr) {
+                resultDataSet_.rows.insert(resultDataSet_.rows.end(),
+                                           cached->begin(), cached->end());
+                runEnds.emplace_back(resultDataSet_.rows.size());
+                continue;
+            }
+        }
+        auto start = resultDataSet_.rows.size();
         auto ret = plan.value().go(partId);
         if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
             if (failedParts.find(partId) == failedParts.end()) {
                 failedParts.emplace(partId);
                 handleErrorCode(ret, spaceId_, partId);
             }
+        } else if (budget != nullptr && budget->exhausted()) {
+            pushResultCode(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, partId);
+        } else if (version.has_value()) {
+            this->env_->resultCache_->put(
+                ResultCache::key(spaceId_, partId, cacheShape_), *version,
+                ResultCache::Rows(resultDataSet_.rows.begin() + start,
+                                  resultDataSet_.rows.end()));
         }
+        runEnds.emplace_back(resultDataSet_.rows.size());
+    }
+    applyOrderLimit(runEnds);
+    if (profile_ != nullptr) {
+        plan.value().flushProfile();
+        profile_->setRows(resultDataSet_.rows.size());
     }
     onProcessFinished();
     onFinished();
@@ -83,19 +130,28 @@ void LookupProcessor::runInMultipleThread(const cpp2::LookupIndexRequest& req) {
     folly::collectAll(futures).via(executor_).thenTry([this] (auto&& t) mutable {
         CHECK(!t.hasException());
         const auto& tries = t.value();
+        std::vector<size_t> runEnds;
         for (size_t j = 0; j < tries.size(); j++) {
             CHECK(!tries[j].hasException());
             const auto& [code, partId] = tries[j].value();
             if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 handleErrorCode(code, spaceId_, partId);
-            } else {
+            }
+            // the part stopped by budget still returns what it has collected
+            if (code == nebula::cpp2::ErrorCode::SUCCEEDED ||
+                code == nebula::cpp2::ErrorCode::E_PARTIAL_RESULT) {
                 resultDataSet_.append(std::move(partResults_[j]));
+                runEnds.emplace_back(resultDataSet_.rows.size());
             }
         }
         // when run each part concurrently, we need to dedup again.
-        if (!deDupColPos_.empty()) {
+        if (!deDupColPos_.empty() && !ordered_) {
             DeDupNode<IndexID>::dedup(resultDataSet_.rows, deDupColPos_);
         }
+        applyOrderLimit(runEnds);
+        if (profile_ != nullptr) {
+            profile_->setRows(resultDataSet_.rows.size());
+        }
         this->onProcessFinished();
         this->onFinished();
     });
@@ -105,16 +161,102 @@ folly::Future<std::pair<nebula::cpp2::ErrorCode, PartitionID>>
 LookupProcessor::runInExecutor(IndexFilterItem* filterItem,
                                nebula::DataSet* result,
                                PartitionID partId) {
-    return folly::via(executor_, [this, filterItem, result, partId]() {
+    auto* executor = this->env_->partExecutor(spaceId_, partId, executor_);
+    return folly::via(executor, [this, filterItem, result, partId]() {
+        std::shared_ptr<const ResultCache::Rows> cached;
+        auto version = cachedRows(partId, &cached);
+        if (cached != nullptr) {
+            result->rows = *cached;
+            return std::make_pair(nebula::cpp2::ErrorCode::SUCCEEDED, partId);
+        }
         auto plan = buildPlan(filterItem, result);
         if (!plan.ok()) {
             return std::make_pair(nebula::cpp2::ErrorCode::E_INDEX_NOT_FOUND, partId);
         }
+        plan.value().setProfile(profile_);
+        ProfileSpan profileSpan(profile_, partId);
         auto ret = plan.value().go(partId);
+        auto* budget = planContext_->budget_.get();
+        if (ret == nebula::cpp2::ErrorCode::SUCCEEDED && budget != nullptr &&
+            budget->exhausted()) {
+            ret = nebula::cpp2::ErrorCode::E_PARTIAL_RESULT;
+        }
+        if (ret == nebula::cpp2::ErrorCode::SUCCEEDED && version.has_value()) {
+            this->env_->resultCache_->put(
+                ResultCache::key(spaceId_, partId, cacheShape_), *version, result->rows);
+        }
         return std::make_pair(ret, partId);
     });
 }
 
+folly::Optional<uint64_t>
+LookupProcessor::cachedRows(PartitionID partId,
+                            std::shared_ptr<const ResultCache::Rows>* rows) {
+    if (cacheShape_.empty()) {
+        return folly::none;
+    }
+    auto version = ResultCache::version(this->env_->kvstore_, spaceId_, partId,
+                                        planContext_->canReadFromFollower_);
+    if (version.has_value()) {
+        *rows = this->env_->resultCache_->get(ResultCache::key(spaceId_, partId, cacheShape_),
+                                              *version);
+    }
+    return version;
+}
+
+void LookupProcessor::applyOrderLimit(const std::vector<size_t>& runEnds) {
+    if (limit_ < 0) {
+        return;
+    }
+    auto& rows = resultDataSet_.rows;
+    auto limit = static_cast<size_t>(limit_);
+    if (!ordered_) {
+        // all rows are returned to be sorted if the order is not kept
+        if (orderBy_.empty() && rows.size() > limit) {
+            rows.resize(limit);
+        }
+        return;
+    }
+    auto less = [this] (const Row& lhs, const Row& rhs) {
+        for (auto pos : orderPos_) {
+            if (lhs.values[pos] != rhs.values[pos]) {
+                return lhs.values[pos] < rhs.values[pos];
+            }
+        }
+        return false;
+    };
+    // The rows of a part are in the order of index keys, which only differs from the order of
+    // values among the strings longer than the index column, and the scan takes all of them tied
+    // at the limit. So sorting the few rows of each part is enough to merge them.
+    std::vector<std::pair<size_t, size_t>> runs;
+    size_t start = 0;
+    for (auto end : runEnds) {
+        if (end > start) {
+            std::stable_sort(rows.begin() + start, rows.begin() + end, less);
+            runs.emplace_back(start, end);
+        }
+        start = end;
+    }
+    // k-way merge of the heads of the runs, the least on the top
+    auto greater = [&] (const auto& lhs, const auto& rhs) {
+        return less(rows[rhs.first], rows[lhs.first]);
+    };
+    std::priority_queue<std::pair<size_t, size_t>,
+                        std::vector<std::pair<size_t, size_t>>,
+                        decltype(greater)> heads(greater, std::move(runs));
+    std::vector<Row> merged;
+    merged.reserve(std::min(limit, rows.size()));
+    while (!heads.empty() && merged.size() < limit) {
+        auto [pos, end] = heads.top();
+        heads.pop();
+        merged.emplace_back(std::move(rows[pos]));
+        if (++pos < end) {
+            heads.emplace(pos, end);
+        }
+    }
+    rows = std::move(merged);
+}
+
 void LookupProcessor::onProcessFinished() {
     if (context_->isEdge()) {
         std::transform(resultDataSet_.colNames.begin(),
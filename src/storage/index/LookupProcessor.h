@@ -28,6 +28,13 @@ public:
 
     void process(const cpp2::LookupIndexRequest& req) override;
 
+    // Return at most `limit` rows, the first ones ordered by the yield columns `orderBy`
+    // ascending, which is set before process. LookupIndexRequest has no field for them yet.
+    void setOrderLimit(std::vector<std::string> orderBy, int64_t limit) {
+        orderBy_ = std::move(orderBy);
+        limit_ = limit;
+    }
+
 protected:
     LookupProcessor(StorageEnv* env,
                     const ProcessorCounters* counters,
@@ -46,6 +53,18 @@ private:
     runInExecutor(IndexFilterItem* filterItem, nebula::DataSet* result, PartitionID partId);
 
     void doProcess(const cpp2::LookupIndexRequest& req);
+
+    // Keep the first limit_ rows of the result, which are merged from the rows of each part
+    // ending at runEnds if ordered_
+    void applyOrderLimit(const std::vector<size_t>& runEnds);
+
+    // The write version of the part and the rows cached at it if any, none if not cached
+    folly::Optional<uint64_t> cachedRows(PartitionID partId,
+                                         std::shared_ptr<const ResultCache::Rows>* rows);
+
+private:
+    // the request without the parts in the result cache, empty if it is not cached
+    std::string                                 cacheShape_;
 };
 
 }  // namespace storage
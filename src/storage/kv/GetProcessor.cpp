@@ -6,6 +6,7 @@
 
 #include "storage/kv/GetProcessor.h"
 #include "utils/NebulaKeyUtils.h"
+#include "storage/StorageFlags.h"
 
 namespace nebula {
 namespace storage {
@@ -14,9 +15,13 @@ ProcessorCounters kGetCounters;
 
 void GetProcessor::process(const cpp2::KVGetRequest& req) {
     CHECK_NOTNULL(env_->kvstore_);
+    if (executor_ != nullptr && req.get_parts().size() > 1) {
+        processConcurrently(req);
+        return;
+    }
+
     GraphSpaceID spaceId = req.get_space_id();
     bool returnPartly = req.get_return_partly();
-
     std::unordered_map<std::string, std::string> pairs;
     size_t size = 0;
     for (auto& part : req.get_parts()) {
@@ -25,30 +30,80 @@ void GetProcessor::process(const cpp2::KVGetRequest& req) {
     pairs.reserve(size);
 
     for (auto& part : req.get_parts()) {
-        auto partId = part.first;
-        auto& keys = part.second;
-        std::vector<std::string> kvKeys;
-        kvKeys.reserve(part.second.size());
-        std::transform(keys.begin(), keys.end(), std::back_inserter(kvKeys),
-                       [partId] (const auto& key) { return NebulaKeyUtils::kvKey(partId, key); });
-        std::vector<std::string> values;
-        auto ret = env_->kvstore_->multiGet(spaceId, partId, kvKeys, &values);
-        if ((ret.first == nebula::cpp2::ErrorCode::SUCCEEDED) ||
-            (ret.first == nebula::cpp2::ErrorCode::E_PARTIAL_RESULT && returnPartly)) {
-            auto& status = ret.second;
-            for (size_t i = 0; i < kvKeys.size(); i++) {
-                if (status[i].ok()) {
-                    pairs.emplace(keys[i], values[i]);
-                }
-            }
-        } else {
-            handleErrorCode(ret.first, spaceId, partId);
+        auto result = getPart(spaceId, part.first, part.second, returnPartly);
+        if (result.first != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            handleErrorCode(result.first, spaceId, part.first);
+            continue;
         }
+        pairs.insert(std::make_move_iterator(result.second.begin()),
+                     std::make_move_iterator(result.second.end()));
     }
 
     resp_.set_key_values(std::move(pairs));
     this->onFinished();
 }
 
+void GetProcessor::processConcurrently(const cpp2::KVGetRequest& req) {
+    GraphSpaceID spaceId = req.get_space_id();
+    bool returnPartly = req.get_return_partly();
+    std::vector<PartitionID> parts;
+    std::vector<folly::Future<PartResult>> futures;
+    for (auto& part : req.get_parts()) {
+        auto partId = part.first;
+        parts.emplace_back(partId);
+        // the request may be released before the part is got
+        futures.emplace_back(folly::via(executor_,
+                                        [this, spaceId, partId, keys = part.second,
+                                         returnPartly] {
+            return getPart(spaceId, partId, keys, returnPartly);
+        }));
+    }
+
+    folly::collectAll(futures).via(executor_).thenValue(
+            [this, spaceId, parts = std::move(parts)] (auto&& tries) {
+        std::unordered_map<std::string, std::string> pairs;
+        for (size_t i = 0; i < tries.size(); i++) {
+            CHECK(!tries[i].hasException());
+            auto& result = tries[i].value();
+            if (result.first != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                handleErrorCode(result.first, spaceId, parts[i]);
+                continue;
+            }
+            pairs.insert(std::make_move_iterator(result.second.begin()),
+                         std::make_move_iterator(result.second.end()));
+        }
+        resp_.set_key_values(std::move(pairs));
+        this->onFinished();
+    });
+}
+
+GetProcessor::PartResult GetProcessor::getPart(GraphSpaceID spaceId,
+                                               PartitionID partId,
+                                               const std::vector<std::string>& keys,
+                                               bool returnPartly) {
+    std::vector<std::string> kvKeys;
+    kvKeys.reserve(keys.size());
+    std::transform(keys.begin(), keys.end(), std::back_inserter(kvKeys),
+                   [partId] (const auto& key) { return NebulaKeyUtils::kvKey(partId, key); });
+    std::vector<std::string> values;
+    auto ret = env_->kvstore_->multiGet(spaceId, partId, kvKeys, &values);
+    PartResult result;
+    if ((ret.first != nebula::cpp2::ErrorCode::SUCCEEDED) &&
+        (ret.first != nebula::cpp2::ErrorCode::E_PARTIAL_RESULT || !returnPartly)) {
+        result.first = ret.first;
+        return result;
+    }
+    result.first = nebula::cpp2::ErrorCode::SUCCEEDED;
+    auto& status = ret.second;
+    result.second.reserve(kvKeys.size());
+    for (size_t i = 0; i < kvKeys.size(); i++) {
+        // the expired ones are not got, even if they are not dropped by the compaction yet
+        if (status[i].ok() && !CommonUtils::kvExpired(values[i])) {
+            result.second.emplace(keys[i], std::move(values[i]));
+        }
+    }
+    return result;
+}
+
 }  // namespace storage
 }  // namespace nebula
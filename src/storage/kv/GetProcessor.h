@@ -18,15 +18,33 @@ extern ProcessorCounters kGetCounters;
 class GetProcessor : public BaseProcessor<cpp2::KVGetResponse> {
 public:
     static GetProcessor* instance(StorageEnv* env,
-                                  const ProcessorCounters* counters = &kGetCounters) {
-        return new GetProcessor(env, counters);
+                                  const ProcessorCounters* counters = &kGetCounters,
+                                  folly::Executor* executor = nullptr) {
+        return new GetProcessor(env, counters, executor);
     }
 
     void process(const cpp2::KVGetRequest& req);
 
 protected:
-    explicit GetProcessor(StorageEnv* env, const ProcessorCounters* counters)
-        : BaseProcessor<cpp2::KVGetResponse>(env, counters) {}
+    GetProcessor(StorageEnv* env, const ProcessorCounters* counters, folly::Executor* executor)
+        : BaseProcessor<cpp2::KVGetResponse>(env, counters)
+        , executor_(executor) {}
+
+private:
+    // The keys got of the part, or the code if the part failed
+    using PartResult = std::pair<nebula::cpp2::ErrorCode,
+                                 std::unordered_map<std::string, std::string>>;
+
+    PartResult getPart(GraphSpaceID spaceId,
+                       PartitionID partId,
+                       const std::vector<std::string>& keys,
+                       bool returnPartly);
+
+    // Get the parts in the executor at once
+    void processConcurrently(const cpp2::KVGetRequest& req);
+
+private:
+    folly::Executor* executor_{nullptr};
 };
 
 }  // namespace storage
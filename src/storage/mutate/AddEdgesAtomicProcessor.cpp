@@ -22,9 +22,6 @@ namespace storage {
 
 ProcessorCounters kAddEdgesAtomicCounters;
 
-// use localPart vs remotePart to identify different channel.
-using ChainId = std::pair<PartitionID, PartitionID>;
-
 void AddEdgesAtomicProcessor::process(const cpp2::AddEdgesRequest& req) {
     propNames_ = req.get_prop_names();
     spaceId_ = req.get_space_id();
@@ -96,6 +93,10 @@ void AddEdgesAtomicProcessor::processByChain(const cpp2::AddEdgesRequest& req) {
     }
 
     std::list<folly::Future<folly::Unit>> futures;
+    if (FLAGS_toss_coalesce_remote_part) {
+        processByRemotePart(edgesByChain, futures);
+        edgesByChain.clear();
+    }
     for (auto& chain : edgesByChain) {
         auto localPart = chain.first.first;
         auto remotePart = chain.first.second;
@@ -128,6 +129,48 @@ void AddEdgesAtomicProcessor::processByChain(const cpp2::AddEdgesRequest& req) {
     });
 }
 
+void AddEdgesAtomicProcessor::processByRemotePart(
+        std::unordered_map<ChainId, std::vector<KV>>& edgesByChain,
+        std::list<folly::Future<folly::Unit>>& futures) {
+    // the chains of the same remote part are committed together, and the groups of different
+    // remote parts are still pipelined
+    std::unordered_map<PartitionID, std::unordered_map<PartitionID, std::vector<KV>>> groups;
+    for (auto& chain : edgesByChain) {
+        groups[chain.first.second][chain.first.first] = std::move(chain.second);
+    }
+    for (auto& group : groups) {
+        auto remotePart = group.first;
+        std::vector<PartitionID> localParts;
+        for (auto& part : group.second) {
+            localParts.emplace_back(part.first);
+        }
+        futures.emplace_back(
+            env_->txnMan_
+                ->addSameRemotePartEdges(
+                    vIdLen_, spaceId_, remotePart, std::move(group.second), processor_.get())
+                .thenTry([=](auto&& t) {
+                    if (!t.hasValue()) {
+                        for (auto localPart : localParts) {
+                            pushResultCode(nebula::cpp2::ErrorCode::E_UNKNOWN, localPart);
+                        }
+                        return;
+                    }
+                    for (auto& result : t.value()) {
+                        LOG_IF(INFO, FLAGS_trace_toss) << folly::sformat(
+                            "addSameRemotePartEdges: (space,localPart,remotePart)=({},{},{}), "
+                            "code={}",
+                            spaceId_,
+                            result.first,
+                            remotePart,
+                            apache::thrift::util::enumNameSafe(result.second));
+                        if (result.second != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                            pushResultCode(result.second, result.first);
+                        }
+                    }
+                }));
+    }
+}
+
 nebula::cpp2::ErrorCode
 AddEdgesAtomicProcessor::encodeSingleEdgeProps(const cpp2::NewEdge& e, std::string& encodedVal) {
     auto edgeType = e.get_key().get_edge_type();
@@ -38,6 +38,14 @@ private:
     nebula::cpp2::ErrorCode
     encodeSingleEdgeProps(const cpp2::NewEdge& e, std::string& encodedVal);
 
+    // use localPart vs remotePart to identify different channel.
+    using ChainId = std::pair<PartitionID, PartitionID>;
+
+    // Commit the chains of the same remote part by one forward request, edgesByChain is
+    // moved out
+    void processByRemotePart(std::unordered_map<ChainId, std::vector<KV>>& edgesByChain,
+                             std::list<folly::Future<folly::Unit>>& futures);
+
     GraphSpaceID                                                spaceId_;
     int64_t                                                     vIdLen_;
     std::vector<std::string>                                    propNames_;
@@ -35,6 +35,7 @@ void AddEdgesProcessor::process(const cpp2::AddEdgesRequest& req) {
 
     spaceVidLen_ = ret.value();
     callingNum_ = partEdges.size();
+    oneWayEdges_ = CommonUtils::oneWayEdgeTypes(env_->schemaMan_, spaceId_);
 
     CHECK_NOTNULL(env_->indexMan_);
     auto iRet = env_->indexMan_->getEdgeIndexes(spaceId_);
@@ -47,267 +48,349 @@ void AddEdgesProcessor::process(const cpp2::AddEdgesRequest& req) {
         return;
     }
     indexes_ = std::move(iRet).value();
+    for (const auto& index : indexes_) {
+        edgeIndexes_[index->get_schema_id().get_edge_type()].emplace_back(index);
+    }
 
     CHECK_NOTNULL(env_->kvstore_);
 
-    if (indexes_.empty()) {
+    if (executor_ != nullptr && FLAGS_write_concurrently && partEdges.size() > 1) {
+        doProcessConcurrently(req);
+    } else if (indexes_.empty()) {
         doProcess(req);
     } else {
         doProcessWithIndex(req);
     }
 }
 
-void AddEdgesProcessor::doProcess(const cpp2::AddEdgesRequest& req) {
-    const auto& partEdges = req.get_parts();
-    const auto& propNames = req.get_prop_names();
-    for (auto& part : partEdges) {
-        auto partId = part.first;
-        const auto& newEdges = part.second;
-
-        std::vector<kvstore::KV> data;
-        data.reserve(32);
-        auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
-        std::unordered_set<std::string> visited;
-        visited.reserve(newEdges.size());
-
-        for (auto& newEdge : newEdges) {
-            auto edgeKey = *newEdge.key_ref();
-            VLOG(3) << "PartitionID: " << partId << ", VertexID: " << *edgeKey.src_ref()
-                    << ", EdgeType: " << *edgeKey.edge_type_ref() << ", EdgeRanking: "
-                    << *edgeKey.ranking_ref() << ", VertexID: "
-                    << *edgeKey.dst_ref();
-
-            if (!NebulaKeyUtils::isValidVidLen(
-                    spaceVidLen_, (*edgeKey.src_ref()).getStr(), (*edgeKey.dst_ref()).getStr())) {
-                LOG(ERROR) << "Space " << spaceId_ << " vertex length invalid, "
-                           << "space vid len: " << spaceVidLen_
-                           << ", edge srcVid: " << *edgeKey.src_ref()
-                           << ", dstVid: " << *edgeKey.dst_ref();
-                code = nebula::cpp2::ErrorCode::E_INVALID_VID;
-                break;
+void AddEdgesProcessor::doProcessConcurrently(const cpp2::AddEdgesRequest& req) {
+    // The request may be released before the parts are processed in the executor, and the
+    // processor is released once the last part is done, so nothing of it is touched after
+    // the tasks are added.
+    req_ = req;
+    std::vector<folly::Func> tasks;
+    tasks.reserve(req_.get_parts().size());
+    for (const auto& part : req_.get_parts()) {
+        tasks.emplace_back([this, &part] {
+            if (indexes_.empty()) {
+                processPart(part.first, part.second, req_.get_prop_names());
+            } else {
+                processPartWithIndex(part.first, part.second, req_.get_prop_names());
             }
+        });
+    }
+    for (auto& task : tasks) {
+        executor_->add(std::move(task));
+    }
+}
 
-            auto key = NebulaKeyUtils::edgeKey(spaceVidLen_,
-                                               partId,
-                                               (*edgeKey.src_ref()).getStr(),
-                                               *edgeKey.edge_type_ref(),
-                                               *edgeKey.ranking_ref(),
-                                               (*edgeKey.dst_ref()).getStr());
-           if (ifNotExists_) {
-                if (!visited.emplace(key).second) {
+void AddEdgesProcessor::doProcess(const cpp2::AddEdgesRequest& req) {
+    for (auto& part : req.get_parts()) {
+        processPart(part.first, part.second, req.get_prop_names());
+    }
+}
+
+void AddEdgesProcessor::processPart(PartitionID partId,
+                                    const std::vector<cpp2::NewEdge>& newEdges,
+                                    const std::vector<std::string>& propNames) {
+    if (isApplied(partId)) {
+        handleAsync(spaceId_, partId, nebula::cpp2::ErrorCode::SUCCEEDED);
+        return;
+    }
+    std::vector<kvstore::KV> data;
+    data.reserve(newEdges.size() + 1);
+    auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
+    std::unordered_set<std::string> visited;
+    visited.reserve(newEdges.size());
+
+    for (auto& newEdge : newEdges) {
+        auto edgeKey = *newEdge.key_ref();
+        VLOG(3) << "PartitionID: " << partId << ", VertexID: " << *edgeKey.src_ref()
+                << ", EdgeType: " << *edgeKey.edge_type_ref() << ", EdgeRanking: "
+                << *edgeKey.ranking_ref() << ", VertexID: "
+                << *edgeKey.dst_ref();
+        if (isSkipped(*edgeKey.edge_type_ref())) {
+            continue;
+        }
+
+        if (!NebulaKeyUtils::isValidVidLen(
+                spaceVidLen_, (*edgeKey.src_ref()).getStr(), (*edgeKey.dst_ref()).getStr())) {
+            LOG(ERROR) << "Space " << spaceId_ << " vertex length invalid, "
+                       << "space vid len: " << spaceVidLen_
+                       << ", edge srcVid: " << *edgeKey.src_ref()
+                       << ", dstVid: " << *edgeKey.dst_ref();
+            code = nebula::cpp2::ErrorCode::E_INVALID_VID;
+            break;
+        }
+
+        auto key = NebulaKeyUtils::edgeKey(spaceVidLen_,
+                                           partId,
+                                           (*edgeKey.src_ref()).getStr(),
+                                           *edgeKey.edge_type_ref(),
+                                           *edgeKey.ranking_ref(),
+                                           (*edgeKey.dst_ref()).getStr());
+        env_->evictEdgeCache(spaceId_, spaceVidLen_, key);
+        if (ifNotExists_) {
+            if (!visited.emplace(key).second) {
+                continue;
+            }
+            auto obsIdx = findOldValue(partId, key);
+            if (nebula::ok(obsIdx)) {
+                // already exists in kvstore
+                if (!nebula::value(obsIdx).empty()) {
                     continue;
                 }
-                auto obsIdx = findOldValue(partId, key);
-                if (nebula::ok(obsIdx)) {
-                    // already exists in kvstore
-                    if (!nebula::value(obsIdx).empty()) {
-                        continue;
-                    }
-                } else {
-                    code = nebula::error(obsIdx);
-                    break;
-                }
-            }
-            auto schema = env_->schemaMan_->getEdgeSchema(spaceId_,
-                                                          std::abs(*edgeKey.edge_type_ref()));
-            if (!schema) {
-                LOG(ERROR) << "Space " << spaceId_ << ", Edge "
-                           << *edgeKey.edge_type_ref() << " invalid";
-                code = nebula::cpp2::ErrorCode::E_EDGE_NOT_FOUND;
-                break;
-            }
-
-            auto props = newEdge.get_props();
-            WriteResult wRet;
-            auto retEnc = encodeRowVal(schema.get(), propNames, props, wRet);
-            if (!retEnc.ok()) {
-                LOG(ERROR) << retEnc.status();
-                code = writeResultTo(wRet, true);
-                break;
             } else {
-                data.emplace_back(std::move(key), std::move(retEnc.value()));
+                code = nebula::error(obsIdx);
+                break;
             }
         }
-        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
-            handleAsync(spaceId_, partId, code);
+        auto schema = env_->schemaMan_->getEdgeSchema(spaceId_,
+                                                      std::abs(*edgeKey.edge_type_ref()));
+        if (!schema) {
+            LOG(ERROR) << "Space " << spaceId_ << ", Edge "
+                       << *edgeKey.edge_type_ref() << " invalid";
+            code = nebula::cpp2::ErrorCode::E_EDGE_NOT_FOUND;
+            break;
+        }
+
+        auto props = newEdge.get_props();
+        WriteResult wRet;
+        auto retEnc = encodeRowVal(schema.get(), propNames, props, wRet);
+        if (!retEnc.ok()) {
+            LOG(ERROR) << retEnc.status();
+            code = writeResultTo(wRet, true);
+            break;
         } else {
-            doPut(spaceId_, partId, std::move(data));
+            data.emplace_back(std::move(key), std::move(retEnc.value()));
         }
     }
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED || data.empty()) {
+        // nothing to write if all edges are skipped
+        handleAsync(spaceId_, partId, code);
+    } else {
+        if (dedupEnabled()) {
+            data.emplace_back(NebulaKeyUtils::systemDedupKey(partId, writeId_),
+                              WriteDedupWindow::encode());
+        }
+        doPut(spaceId_, partId, std::move(data));
+    }
 }
 
 void AddEdgesProcessor::doProcessWithIndex(const cpp2::AddEdgesRequest& req) {
-    const auto& partEdges = req.get_parts();
-    const auto& propNames = req.get_prop_names();
-    for (auto& part : partEdges) {
-        IndexCountWrapper wrapper(env_);
-        std::unique_ptr<kvstore::BatchHolder> batchHolder =
-        std::make_unique<kvstore::BatchHolder>();
-        auto partId = part.first;
-        const auto& newEdges = part.second;
-        std::vector<EMLI> dummyLock;
-        dummyLock.reserve(newEdges.size());
-        auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
-
-        std::unordered_set<std::string> visited;
-        visited.reserve(newEdges.size());
-        for (auto& newEdge : newEdges) {
-            auto edgeKey = *newEdge.key_ref();
-            VLOG(3) << "PartitionID: " << partId << ", VertexID: " << *edgeKey.src_ref()
-                    << ", EdgeType: " << *edgeKey.edge_type_ref() << ", EdgeRanking: "
-                    << *edgeKey.ranking_ref() << ", VertexID: "
-                    << *edgeKey.dst_ref();
-
-            if (!NebulaKeyUtils::isValidVidLen(
-                    spaceVidLen_, (*edgeKey.src_ref()).getStr(), (*edgeKey.dst_ref()).getStr())) {
-                LOG(ERROR) << "Space " << spaceId_ << " vertex length invalid, "
-                           << "space vid len: " << spaceVidLen_
-                           << ", edge srcVid: " << *edgeKey.src_ref()
-                           << ", dstVid: " << *edgeKey.dst_ref();
-                code = nebula::cpp2::ErrorCode::E_INVALID_VID;
-                break;
-            }
+    for (auto& part : req.get_parts()) {
+        processPartWithIndex(part.first, part.second, req.get_prop_names());
+    }
+}
 
-            auto key = NebulaKeyUtils::edgeKey(spaceVidLen_,
-                                               partId,
-                                               (*edgeKey.src_ref()).getStr(),
-                                               *edgeKey.edge_type_ref(),
-                                               *edgeKey.ranking_ref(),
-                                               (*edgeKey.dst_ref()).getStr());
-            if (ifNotExists_ && !visited.emplace(key).second) {
-                continue;
-            }
-            auto schema = env_->schemaMan_->getEdgeSchema(spaceId_,
-                                                          std::abs(*edgeKey.edge_type_ref()));
-            if (!schema) {
-                LOG(ERROR) << "Space " << spaceId_ << ", Edge "
-                           << *edgeKey.edge_type_ref() << " invalid";
-                code = nebula::cpp2::ErrorCode::E_EDGE_NOT_FOUND;
-                break;
-            }
+void AddEdgesProcessor::processPartWithIndex(PartitionID partId,
+                                             const std::vector<cpp2::NewEdge>& newEdges,
+                                             const std::vector<std::string>& propNames) {
+    if (isApplied(partId)) {
+        handleAsync(spaceId_, partId, nebula::cpp2::ErrorCode::SUCCEEDED);
+        return;
+    }
+    IndexCountWrapper wrapper(env_);
+    std::unique_ptr<kvstore::BatchHolder> batchHolder =
+    std::make_unique<kvstore::BatchHolder>();
+    std::vector<EMLI> dummyLock;
+    dummyLock.reserve(newEdges.size());
+    auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
+    // the state won't change before the batch is appended, so check it once for the part
+    auto indexState = env_->getIndexState(spaceId_, partId);
 
-            auto props = newEdge.get_props();
-            WriteResult wRet;
-            auto retEnc = encodeRowVal(schema.get(), propNames, props, wRet);
-            if (!retEnc.ok()) {
-                LOG(ERROR) << retEnc.status();
-                code = writeResultTo(wRet, true);
-                break;
-            }
-            if (*edgeKey.edge_type_ref() > 0) {
-                RowReaderWrapper nReader;
-                RowReaderWrapper oReader;
-                auto obsIdx = findOldValue(partId, key);
-                if (nebula::ok(obsIdx)) {
-                    // already exists in kvstore
-                    if (ifNotExists_ && !nebula::value(obsIdx).empty()) {
-                        continue;
-                    }
-                    if (!nebula::value(obsIdx).empty()) {
-                        oReader = RowReaderWrapper::getEdgePropReader(env_->schemaMan_,
-                                                                      spaceId_,
-                                                                      *edgeKey.edge_type_ref(),
-                                                                      nebula::value(obsIdx));
-                    }
-                } else {
-                    code = nebula::error(obsIdx);
-                    break;
+    std::unordered_set<std::string> visited;
+    visited.reserve(newEdges.size());
+    // The value written by this batch of each edge key. If an edge is inserted more than once
+    // in the request, the previous one in the batch is the old value, so that only the index
+    // of the last one is kept.
+    std::unordered_map<std::string, std::string> newValues;
+    for (auto& newEdge : newEdges) {
+        auto edgeKey = *newEdge.key_ref();
+        VLOG(3) << "PartitionID: " << partId << ", VertexID: " << *edgeKey.src_ref()
+                << ", EdgeType: " << *edgeKey.edge_type_ref() << ", EdgeRanking: "
+                << *edgeKey.ranking_ref() << ", VertexID: "
+                << *edgeKey.dst_ref();
+        if (isSkipped(*edgeKey.edge_type_ref())) {
+            continue;
+        }
+
+        if (!NebulaKeyUtils::isValidVidLen(
+                spaceVidLen_, (*edgeKey.src_ref()).getStr(), (*edgeKey.dst_ref()).getStr())) {
+            LOG(ERROR) << "Space " << spaceId_ << " vertex length invalid, "
+                       << "space vid len: " << spaceVidLen_
+                       << ", edge srcVid: " << *edgeKey.src_ref()
+                       << ", dstVid: " << *edgeKey.dst_ref();
+            code = nebula::cpp2::ErrorCode::E_INVALID_VID;
+            break;
+        }
+
+        auto key = NebulaKeyUtils::edgeKey(spaceVidLen_,
+                                           partId,
+                                           (*edgeKey.src_ref()).getStr(),
+                                           *edgeKey.edge_type_ref(),
+                                           *edgeKey.ranking_ref(),
+                                           (*edgeKey.dst_ref()).getStr());
+        env_->evictEdgeCache(spaceId_, spaceVidLen_, key);
+        if (ifNotExists_ && !visited.emplace(key).second) {
+            continue;
+        }
+        auto schema = env_->schemaMan_->getEdgeSchema(spaceId_,
+                                                      std::abs(*edgeKey.edge_type_ref()));
+        if (!schema) {
+            LOG(ERROR) << "Space " << spaceId_ << ", Edge "
+                       << *edgeKey.edge_type_ref() << " invalid";
+            code = nebula::cpp2::ErrorCode::E_EDGE_NOT_FOUND;
+            break;
+        }
+
+        auto props = newEdge.get_props();
+        WriteResult wRet;
+        auto retEnc = encodeRowVal(schema.get(), propNames, props, wRet);
+        if (!retEnc.ok()) {
+            LOG(ERROR) << retEnc.status();
+            code = writeResultTo(wRet, true);
+            break;
+        }
+        if (*edgeKey.edge_type_ref() > 0) {
+            RowReaderWrapper nReader;
+            RowReaderWrapper oReader;
+            auto pending = newValues.find(key);
+            auto obsIdx = pending != newValues.end()
+                          ? ErrorOr<nebula::cpp2::ErrorCode, std::string>(pending->second)
+                          : findOldValue(partId, key);
+            if (nebula::ok(obsIdx)) {
+                // already exists in kvstore
+                if (ifNotExists_ && !nebula::value(obsIdx).empty()) {
+                    continue;
                 }
-                if (!retEnc.value().empty()) {
-                    nReader = RowReaderWrapper::getEdgePropReader(env_->schemaMan_,
+                if (!nebula::value(obsIdx).empty()) {
+                    oReader = RowReaderWrapper::getEdgePropReader(env_->schemaMan_,
                                                                   spaceId_,
                                                                   *edgeKey.edge_type_ref(),
-                                                                  retEnc.value());
+                                                                  nebula::value(obsIdx));
                 }
-                for (auto& index : indexes_) {
-                    if (*edgeKey.edge_type_ref() == index->get_schema_id().get_edge_type()) {
-                        /*
-                        * step 1 , Delete old version index if exists.
-                        */
-                        if (oReader != nullptr) {
-                            auto oi = indexKey(partId, oReader.get(), key, index);
-                            if (!oi.empty()) {
-                                // Check the index is building for the specified partition or not.
-                                auto indexState = env_->getIndexState(spaceId_, partId);
-                                if (env_->checkRebuilding(indexState)) {
-                                    auto delOpKey = OperationKeyUtils::deleteOperationKey(partId);
-                                    batchHolder->put(std::move(delOpKey), std::move(oi));
-                                } else if (env_->checkIndexLocked(indexState)) {
-                                    LOG(ERROR) << "The index has been locked: "
-                                               << index->get_index_name();
-                                    code = nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
-                                    break;
-                                } else {
-                                    batchHolder->remove(std::move(oi));
-                                }
-                            }
+            } else {
+                code = nebula::error(obsIdx);
+                break;
+            }
+            if (!retEnc.value().empty()) {
+                nReader = RowReaderWrapper::getEdgePropReader(env_->schemaMan_,
+                                                              spaceId_,
+                                                              *edgeKey.edge_type_ref(),
+                                                              retEnc.value());
+            }
+            for (auto& index : indexesOf(*edgeKey.edge_type_ref())) {
+                /*
+                * step 1 , Delete old version index if exists.
+                */
+                if (oReader != nullptr) {
+                    auto oi = indexKey(partId, oReader.get(), key, index);
+                    if (!oi.empty()) {
+                        // Check the index is building for the specified partition or not.
+                        if (env_->checkRebuilding(indexState)) {
+                            auto delOpKey = OperationKeyUtils::deleteOperationKey(partId);
+                            batchHolder->put(std::move(delOpKey), std::move(oi));
+                        } else if (env_->checkIndexLocked(indexState)) {
+                            LOG(ERROR) << "The index has been locked: "
+                                       << index->get_index_name();
+                            code = nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
+                            break;
+                        } else {
+                            batchHolder->remove(std::move(oi));
                         }
-                        /*
-                        * step 2 , Insert new edge index
-                        */
-                        if (nReader != nullptr) {
-                            auto nik = indexKey(partId, nReader.get(), key, index);
-                            if (!nik.empty()) {
-                                auto v = CommonUtils::ttlValue(schema.get(), nReader.get());
-                                auto niv = v.ok()
-                                    ? IndexKeyUtils::indexVal(std::move(v).value()) : "";
-                                // Check the index is building for the specified partition or not.
-                                auto indexState = env_->getIndexState(spaceId_, partId);
-                                if (env_->checkRebuilding(indexState)) {
-                                    auto opKey = OperationKeyUtils::modifyOperationKey(
-                                        partId, std::move(nik));
-                                    batchHolder->put(std::move(opKey), std::move(niv));
-                                } else if (env_->checkIndexLocked(indexState)) {
-                                    LOG(ERROR) << "The index has been locked: "
-                                               << index->get_index_name();
-                                    code = nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
-                                    break;
-                                } else {
-                                    batchHolder->put(std::move(nik), std::move(niv));
-                                }
-                            }
+                    }
+                }
+                /*
+                * step 2 , Insert new edge index
+                */
+                if (nReader != nullptr) {
+                    auto nik = indexKey(partId, nReader.get(), key, index);
+                    if (!nik.empty()) {
+                        auto v = CommonUtils::ttlValue(schema.get(), nReader.get());
+                        auto niv = v.ok()
+                            ? IndexKeyUtils::indexVal(std::move(v).value()) : "";
+                        // Check the index is building for the specified partition or not.
+                        if (env_->checkRebuilding(indexState)) {
+                            auto opKey = OperationKeyUtils::modifyOperationKey(
+                                partId, std::move(nik));
+                            batchHolder->put(std::move(opKey), std::move(niv));
+                        } else if (env_->checkIndexLocked(indexState)) {
+                            LOG(ERROR) << "The index has been locked: "
+                                       << index->get_index_name();
+                            code = nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
+                            break;
+                        } else {
+                            batchHolder->put(std::move(nik), std::move(niv));
                         }
                     }
                 }
             }
-            if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
-                break;
-            }
-            batchHolder->put(std::move(key), std::move(retEnc.value()));
-            dummyLock.emplace_back(std::make_tuple(spaceId_,
-                                                   partId,
-                                                   (*edgeKey.src_ref()).getStr(),
-                                                   *edgeKey.edge_type_ref(),
-                                                   *edgeKey.ranking_ref(),
-                                                   (*edgeKey.dst_ref()).getStr()));
         }
         if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
-            handleAsync(spaceId_, partId, code);
-            continue;
+            break;
         }
-        auto batch = encodeBatchValue(std::move(batchHolder)->getBatch());
-        DCHECK(!batch.empty());
-        nebula::MemoryLockGuard<EMLI> lg(env_->edgesML_.get(), std::move(dummyLock), true);
-        if (!lg) {
-            auto conflict = lg.conflictKey();
-            LOG(ERROR) << "edge conflict "
-                        << std::get<0>(conflict) << ":"
-                        << std::get<1>(conflict) << ":"
-                        << std::get<2>(conflict) << ":"
-                        << std::get<3>(conflict) << ":"
-                        << std::get<4>(conflict) << ":"
-                        << std::get<5>(conflict);
-            handleAsync(spaceId_, partId, nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR);
-            continue;
+        if (!ifNotExists_ && *edgeKey.edge_type_ref() > 0) {
+            newValues[key] = retEnc.value();
         }
-        env_->kvstore_->asyncAppendBatch(spaceId_, partId, std::move(batch),
-            [l = std::move(lg), icw = std::move(wrapper), partId, this]
-            (nebula::cpp2::ErrorCode retCode) {
-                UNUSED(l);
-                UNUSED(icw);
-                handleAsync(spaceId_, partId, retCode);
-            });
+        batchHolder->put(std::move(key), std::move(retEnc.value()));
+        dummyLock.emplace_back(std::make_tuple(spaceId_,
+                                               partId,
+                                               (*edgeKey.src_ref()).getStr(),
+                                               *edgeKey.edge_type_ref(),
+                                               *edgeKey.ranking_ref(),
+                                               (*edgeKey.dst_ref()).getStr()));
+    }
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        handleAsync(spaceId_, partId, code);
+        return;
+    }
+    if (dummyLock.empty()) {
+        // nothing to write if all edges are skipped
+        handleAsync(spaceId_, partId, nebula::cpp2::ErrorCode::SUCCEEDED);
+        return;
+    }
+    if (dedupEnabled()) {
+        batchHolder->put(NebulaKeyUtils::systemDedupKey(partId, writeId_),
+                         WriteDedupWindow::encode());
+    }
+    auto batch = encodeBatchValue(std::move(batchHolder)->getBatch());
+    DCHECK(!batch.empty());
+    nebula::MemoryLockGuard<EMLI> lg(env_->edgesML_.get(), std::move(dummyLock), true);
+    if (!lg) {
+        auto conflict = lg.conflictKey();
+        LOG(ERROR) << "edge conflict "
+                    << std::get<0>(conflict) << ":"
+                    << std::get<1>(conflict) << ":"
+                    << std::get<2>(conflict) << ":"
+                    << std::get<3>(conflict) << ":"
+                    << std::get<4>(conflict) << ":"
+                    << std::get<5>(conflict);
+        handleAsync(spaceId_, partId, nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR);
+        return;
+    }
+    env_->kvstore_->asyncAppendBatch(spaceId_, partId, std::move(batch),
+        [l = std::move(lg), icw = std::move(wrapper), partId, this]
+        (nebula::cpp2::ErrorCode retCode) {
+            UNUSED(l);
+            UNUSED(icw);
+            handleAsync(spaceId_, partId, retCode);
+        });
+}
+
+bool AddEdgesProcessor::isApplied(PartitionID partId) {
+    if (!dedupEnabled()) {
+        return false;
+    }
+    std::string value;
+    auto code = env_->kvstore_->get(spaceId_, partId,
+                                    NebulaKeyUtils::systemDedupKey(partId, writeId_), &value);
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED || !env_->writeDedup_->applied(value)) {
+        return false;
     }
+    VLOG(1) << "The write " << writeId_ << " of space " << spaceId_ << ", part " << partId
+            << " has been applied";
+    return true;
 }
 
 ErrorOr<nebula::cpp2::ErrorCode, std::string>
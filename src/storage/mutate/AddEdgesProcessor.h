@@ -23,19 +23,62 @@ class AddEdgesProcessor : public BaseProcessor<cpp2::ExecResponse> {
 public:
     static AddEdgesProcessor* instance(
             StorageEnv* env,
-            const ProcessorCounters* counters = &kAddEdgesCounters) {
-        return new AddEdgesProcessor(env, counters);
+            const ProcessorCounters* counters = &kAddEdgesCounters,
+            folly::Executor* executor = nullptr) {
+        return new AddEdgesProcessor(env, counters, executor);
     }
 
     void process(const cpp2::AddEdgesRequest& req);
 
+    // The write id given by the client, the write is deduped by it if not empty
+    void setWriteId(std::string writeId) {
+        writeId_ = std::move(writeId);
+    }
+
     void doProcess(const cpp2::AddEdgesRequest& req);
 
     void doProcessWithIndex(const cpp2::AddEdgesRequest& req);
 
+    // Process each part in the executor
+    void doProcessConcurrently(const cpp2::AddEdgesRequest& req);
+
 private:
-    AddEdgesProcessor(StorageEnv* env, const ProcessorCounters* counters)
-        : BaseProcessor<cpp2::ExecResponse>(env, counters) {}
+    using IndexItems = std::vector<std::shared_ptr<nebula::meta::cpp2::IndexItem>>;
+
+    AddEdgesProcessor(StorageEnv* env,
+                      const ProcessorCounters* counters,
+                      folly::Executor* executor)
+        : BaseProcessor<cpp2::ExecResponse>(env, counters)
+        , executor_(executor) {}
+
+    void processPart(PartitionID partId,
+                     const std::vector<cpp2::NewEdge>& newEdges,
+                     const std::vector<std::string>& propNames);
+
+    void processPartWithIndex(PartitionID partId,
+                              const std::vector<cpp2::NewEdge>& newEdges,
+                              const std::vector<std::string>& propNames);
+
+    // Return true if the write of the part has been applied with the same write id recently,
+    // so it is acknowledged without applying it again
+    bool isApplied(PartitionID partId);
+
+    // Whether the applied write id should be written with the write of the part
+    bool dedupEnabled() const {
+        return env_->writeDedup_ != nullptr && !writeId_.empty();
+    }
+
+    // The reverse edges of the one way edge types are not written
+    bool isSkipped(EdgeType edgeType) const {
+        return edgeType < 0 && oneWayEdges_.count(-edgeType) > 0;
+    }
+
+    // edgeIndexes_ is read only once built, the parts may be processed concurrently
+    const IndexItems& indexesOf(EdgeType edgeType) const {
+        static const IndexItems kEmpty;
+        auto iter = edgeIndexes_.find(edgeType);
+        return iter == edgeIndexes_.end() ? kEmpty : iter->second;
+    }
 
     ErrorOr<nebula::cpp2::ErrorCode, std::string>
     addEdges(PartitionID partId, const std::vector<kvstore::KV>& edges);
@@ -50,8 +93,16 @@ private:
 
 private:
     GraphSpaceID                                                spaceId_;
-    std::vector<std::shared_ptr<nebula::meta::cpp2::IndexItem>> indexes_;
+    folly::Executor*                                            executor_{nullptr};
+    IndexItems                                                  indexes_;
+    // indexes grouped by edge type
+    std::unordered_map<EdgeType, IndexItems>                    edgeIndexes_;
     bool                                                        ifNotExists_{false};
+    // edge types in one_way_edge_types of the space
+    std::unordered_set<EdgeType>                                oneWayEdges_;
+    // the copy of request processed in the executor
+    cpp2::AddEdgesRequest                                       req_;
+    std::string                                                 writeId_;
 };
 
 }  // namespace storage
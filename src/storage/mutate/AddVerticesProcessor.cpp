@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include "common/time/WallClock.h"
+#include "kvstore/Part.h"
 #include "codec/RowWriterV2.h"
 #include "utils/IndexKeyUtils.h"
 #include "utils/NebulaKeyUtils.h"
@@ -48,288 +49,364 @@ void AddVerticesProcessor::process(const cpp2::AddVerticesRequest& req) {
         return;
     }
     indexes_ = std::move(iRet).value();
+    for (const auto& index : indexes_) {
+        tagIndexes_[index->get_schema_id().get_tag_id()].emplace_back(index);
+    }
 
     CHECK_NOTNULL(env_->kvstore_);
-    if (indexes_.empty()) {
+    if (executor_ != nullptr && FLAGS_write_concurrently && partVertices.size() > 1) {
+        doProcessConcurrently(req);
+    } else if (indexes_.empty()) {
         doProcess(req);
     } else {
         doProcessWithIndex(req);
     }
 }
 
+void AddVerticesProcessor::doProcessConcurrently(const cpp2::AddVerticesRequest& req) {
+    // The request may be released before the parts are processed in the executor, and the
+    // processor is released once the last part is done, so nothing of it is touched after
+    // the tasks are added.
+    req_ = req;
+    std::vector<folly::Func> tasks;
+    tasks.reserve(req_.get_parts().size());
+    for (const auto& part : req_.get_parts()) {
+        tasks.emplace_back([this, &part] {
+            if (indexes_.empty()) {
+                processPart(part.first, part.second, req_.get_prop_names());
+            } else {
+                processPartWithIndex(part.first, part.second, req_.get_prop_names());
+            }
+        });
+    }
+    for (auto& task : tasks) {
+        executor_->add(std::move(task));
+    }
+}
+
 void AddVerticesProcessor::doProcess(const cpp2::AddVerticesRequest& req) {
-    const auto& partVertices = req.get_parts();
-    const auto& propNamesMap = req.get_prop_names();
-    for (auto& part : partVertices) {
-        auto partId = part.first;
-        const auto& vertices = part.second;
-
-        std::vector<kvstore::KV> data;
-        data.reserve(32);
-        auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
-        std::unordered_set<std::string> visited;
-        visited.reserve(vertices.size());
-        for (auto& vertex : vertices) {
-            auto vid = vertex.get_id().getStr();
-            const auto& newTags = vertex.get_tags();
-
-            if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vid)) {
-                LOG(ERROR) << "Space " << spaceId_ << ", vertex length invalid, "
-                           << " space vid len: " << spaceVidLen_ << ",  vid is " << vid;
-                code = nebula::cpp2::ErrorCode::E_INVALID_VID;
+    for (auto& part : req.get_parts()) {
+        processPart(part.first, part.second, req.get_prop_names());
+    }
+}
+
+void AddVerticesProcessor::processPart(PartitionID partId,
+                                       const std::vector<cpp2::NewVertex>& vertices,
+                                       const PropNamesMap& propNamesMap) {
+    std::vector<kvstore::KV> data;
+    data.reserve(vertices.size());
+    auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
+    std::unordered_set<std::string> visited;
+    visited.reserve(vertices.size());
+    for (auto& vertex : vertices) {
+        auto vid = vertex.get_id().getStr();
+        const auto& newTags = vertex.get_tags();
+
+        if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vid)) {
+            LOG(ERROR) << "Space " << spaceId_ << ", vertex length invalid, "
+                       << " space vid len: " << spaceVidLen_ << ",  vid is " << vid;
+            code = nebula::cpp2::ErrorCode::E_INVALID_VID;
+            break;
+        }
+
+        for (auto& newTag : newTags) {
+            auto tagId = newTag.get_tag_id();
+            VLOG(3) << "PartitionID: " << partId << ", VertexID: " << vid
+                    << ", TagID: " << tagId;
+
+            auto schema = env_->schemaMan_->getTagSchema(spaceId_, tagId);
+            if (!schema) {
+                LOG(ERROR) << "Space " << spaceId_ << ", Tag " << tagId << " invalid";
+                code = nebula::cpp2::ErrorCode::E_TAG_NOT_FOUND;
                 break;
             }
 
-            for (auto& newTag : newTags) {
-                auto tagId = newTag.get_tag_id();
-                VLOG(3) << "PartitionID: " << partId << ", VertexID: " << vid
-                        << ", TagID: " << tagId;
-
-                auto schema = env_->schemaMan_->getTagSchema(spaceId_, tagId);
-                if (!schema) {
-                    LOG(ERROR) << "Space " << spaceId_ << ", Tag " << tagId << " invalid";
-                    code = nebula::cpp2::ErrorCode::E_TAG_NOT_FOUND;
-                    break;
+            auto key = NebulaKeyUtils::vertexKey(spaceVidLen_, partId, vid, tagId);
+            if (ifNotExists_) {
+                if (!visited.emplace(key).second) {
+                    continue;
                 }
-
-                auto key = NebulaKeyUtils::vertexKey(spaceVidLen_, partId, vid, tagId);
-                if (ifNotExists_) {
-                    if (!visited.emplace(key).second) {
+                auto obsIdx = findOldValue(partId, vid, tagId);
+                if (nebula::ok(obsIdx)) {
+                    if (!nebula::value(obsIdx).empty()) {
                         continue;
                     }
-                    auto obsIdx = findOldValue(partId, vid, tagId);
-                    if (nebula::ok(obsIdx)) {
-                        if (!nebula::value(obsIdx).empty()) {
-                            continue;
-                        }
-                    } else {
-                        code = nebula::error(obsIdx);
-                        break;
-                    }
-                }
-                auto props = newTag.get_props();
-                auto iter = propNamesMap.find(tagId);
-                std::vector<std::string> propNames;
-                if (iter != propNamesMap.end()) {
-                    propNames = iter->second;
-                }
-
-                WriteResult wRet;
-                auto retEnc = encodeRowVal(schema.get(), propNames, props, wRet);
-                if (!retEnc.ok()) {
-                    LOG(ERROR) << retEnc.status();
-                    code = writeResultTo(wRet, false);
+                } else {
+                    code = nebula::error(obsIdx);
                     break;
                 }
-                data.emplace_back(std::move(key), std::move(retEnc.value()));
+            }
+            auto props = newTag.get_props();
+            auto iter = propNamesMap.find(tagId);
+            std::vector<std::string> propNames;
+            if (iter != propNamesMap.end()) {
+                propNames = iter->second;
+            }
 
-                if (FLAGS_enable_vertex_cache && vertexCache_ != nullptr) {
-                    vertexCache_->evict(std::make_pair(vid, tagId));
-                    VLOG(3) << "Evict cache for vId " << vid
-                            << ", tagId " << tagId;
-                }
+            WriteResult wRet;
+            auto retEnc = encodeRowVal(schema.get(), propNames, props, wRet);
+            if (!retEnc.ok()) {
+                LOG(ERROR) << retEnc.status();
+                code = writeResultTo(wRet, false);
+                break;
+            }
+            data.emplace_back(std::move(key), std::move(retEnc.value()));
+            env_->evictIndexValueCache(vid, tagId);
+
+            if (FLAGS_enable_vertex_cache && vertexCache_ != nullptr) {
+                vertexCache_->evict(std::make_pair(vid, tagId));
+                VLOG(3) << "Evict cache for vId " << vid
+                        << ", tagId " << tagId;
             }
         }
-        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
-            handleAsync(spaceId_, partId, code);
-        } else {
-            doPut(spaceId_, partId, std::move(data));
-        }
+    }
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        handleAsync(spaceId_, partId, code);
+    } else {
+        doPut(spaceId_, partId, std::move(data));
     }
 }
 
 void AddVerticesProcessor::doProcessWithIndex(const cpp2::AddVerticesRequest& req) {
-    const auto& partVertices = req.get_parts();
-    const auto& propNamesMap = req.get_prop_names();
-    for (auto& part : partVertices) {
-        IndexCountWrapper wrapper(env_);
-        std::unique_ptr<kvstore::BatchHolder> batchHolder =
-        std::make_unique<kvstore::BatchHolder>();
-        auto partId = part.first;
-        const auto& vertices = part.second;
-        std::vector<VMLI> dummyLock;
-        dummyLock.reserve(vertices.size());
-        auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
-
-        // cache vertexKey
-        std::unordered_set<std::string> visited;
-        visited.reserve(vertices.size());
-        for (auto& vertex : vertices) {
-            auto vid = vertex.get_id().getStr();
-            const auto& newTags = vertex.get_tags();
-
-            if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vid)) {
-                LOG(ERROR) << "Space " << spaceId_ << ", vertex length invalid, "
-                           << " space vid len: " << spaceVidLen_ << ",  vid is " << vid;
-                code = nebula::cpp2::ErrorCode::E_INVALID_VID;
-                break;
-            }
+    for (auto& part : req.get_parts()) {
+        processPartWithIndex(part.first, part.second, req.get_prop_names());
+    }
+}
 
-            for (auto& newTag : newTags) {
-                auto tagId = newTag.get_tag_id();
-                VLOG(3) << "PartitionID: " << partId << ", VertexID: " << vid
-                        << ", TagID: " << tagId;
+void AddVerticesProcessor::processPartWithIndex(PartitionID partId,
+                                                const std::vector<cpp2::NewVertex>& vertices,
+                                                const PropNamesMap& propNamesMap) {
+    IndexCountWrapper wrapper(env_);
+    std::unique_ptr<kvstore::BatchHolder> batchHolder =
+    std::make_unique<kvstore::BatchHolder>();
+    std::vector<VMLI> dummyLock;
+    dummyLock.reserve(vertices.size());
+    auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
+    // the state won't change before the batch is appended, so check it once for the part
+    auto indexState = env_->getIndexState(spaceId_, partId);
+    // the rows cached in the current term of the part are used as the old values, and the
+    // rows written are cached after the batch is committed
+    auto* valueCache = env_->indexValueCache_;
+    TermID term = -1;
+    if (valueCache != nullptr) {
+        auto partRet = env_->kvstore_->part(spaceId_, partId);
+        if (nebula::ok(partRet)) {
+            term = nebula::value(partRet)->termId();
+        } else {
+            valueCache = nullptr;
+        }
+    }
+    std::vector<std::pair<IndexValueCache::Key, std::string>> written;
 
-                auto schema = env_->schemaMan_->getTagSchema(spaceId_, tagId);
-                if (!schema) {
-                    LOG(ERROR) << "Space " << spaceId_ << ", Tag " << tagId << " invalid";
-                    code = nebula::cpp2::ErrorCode::E_TAG_NOT_FOUND;
-                    break;
-                }
+    // cache vertexKey
+    std::unordered_set<std::string> visited;
+    visited.reserve(vertices.size());
+    // The value written by this batch of each vertex key. If a vertex is inserted more than
+    // once in the request, the previous one in the batch is the old value, so that only the
+    // index of the last one is kept.
+    std::unordered_map<std::string, std::string> newValues;
+    for (auto& vertex : vertices) {
+        auto vid = vertex.get_id().getStr();
+        const auto& newTags = vertex.get_tags();
 
-                auto key = NebulaKeyUtils::vertexKey(spaceVidLen_, partId, vid, tagId);
-                if (ifNotExists_ && !visited.emplace(key).second) {
-                    continue;
-                }
-                auto props = newTag.get_props();
-                auto iter = propNamesMap.find(tagId);
-                std::vector<std::string> propNames;
-                if (iter != propNamesMap.end()) {
-                    propNames = iter->second;
-                }
+        if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vid)) {
+            LOG(ERROR) << "Space " << spaceId_ << ", vertex length invalid, "
+                       << " space vid len: " << spaceVidLen_ << ",  vid is " << vid;
+            code = nebula::cpp2::ErrorCode::E_INVALID_VID;
+            break;
+        }
 
-                RowReaderWrapper nReader;
-                RowReaderWrapper oReader;
-                auto obsIdx = findOldValue(partId, vid, tagId);
-                if (nebula::ok(obsIdx)) {
-                    if (ifNotExists_ && !nebula::value(obsIdx).empty()) {
-                        continue;
-                    }
-                    if (!nebula::value(obsIdx).empty()) {
-                        oReader = RowReaderWrapper::getTagPropReader(env_->schemaMan_,
-                                                                     spaceId_,
-                                                                     tagId,
-                                                                     nebula::value(obsIdx));
-                    }
-                } else {
-                    code = nebula::error(obsIdx);
-                    break;
-                }
+        for (auto& newTag : newTags) {
+            auto tagId = newTag.get_tag_id();
+            VLOG(3) << "PartitionID: " << partId << ", VertexID: " << vid
+                    << ", TagID: " << tagId;
 
-                WriteResult wRet;
-                auto retEnc = encodeRowVal(schema.get(), propNames, props, wRet);
-                if (!retEnc.ok()) {
-                    LOG(ERROR) << retEnc.status();
-                    code = writeResultTo(wRet, false);
-                    break;
-                }
+            auto schema = env_->schemaMan_->getTagSchema(spaceId_, tagId);
+            if (!schema) {
+                LOG(ERROR) << "Space " << spaceId_ << ", Tag " << tagId << " invalid";
+                code = nebula::cpp2::ErrorCode::E_TAG_NOT_FOUND;
+                break;
+            }
 
-                if (!retEnc.value().empty()) {
-                    nReader = RowReaderWrapper::getTagPropReader(env_->schemaMan_,
+            auto key = NebulaKeyUtils::vertexKey(spaceVidLen_, partId, vid, tagId);
+            if (ifNotExists_ && !visited.emplace(key).second) {
+                continue;
+            }
+            auto props = newTag.get_props();
+            auto iter = propNamesMap.find(tagId);
+            std::vector<std::string> propNames;
+            if (iter != propNamesMap.end()) {
+                propNames = iter->second;
+            }
+
+            RowReaderWrapper nReader;
+            RowReaderWrapper oReader;
+            auto pending = newValues.find(key);
+            auto obsIdx = pending != newValues.end()
+                          ? ErrorOr<nebula::cpp2::ErrorCode, std::string>(pending->second)
+                          : findOldValue(partId, vid, tagId, valueCache, term);
+            if (nebula::ok(obsIdx)) {
+                if (ifNotExists_ && !nebula::value(obsIdx).empty()) {
+                    continue;
+                }
+                if (!nebula::value(obsIdx).empty()) {
+                    oReader = RowReaderWrapper::getTagPropReader(env_->schemaMan_,
                                                                  spaceId_,
                                                                  tagId,
-                                                                 retEnc.value());
+                                                                 nebula::value(obsIdx));
                 }
-                for (auto& index : indexes_) {
-                    if (tagId == index->get_schema_id().get_tag_id()) {
-                        /*
-                        * step 1 , Delete old version index if exists.
-                        */
-                        if (oReader != nullptr) {
-                            auto oi = indexKey(partId, vid, oReader.get(), index);
-                            if (!oi.empty()) {
-                                // Check the index is building for the specified partition or not.
-                                auto indexState = env_->getIndexState(spaceId_, partId);
-                                if (env_->checkRebuilding(indexState)) {
-                                    auto delOpKey = OperationKeyUtils::deleteOperationKey(partId);
-                                    batchHolder->put(std::move(delOpKey), std::move(oi));
-                                } else if (env_->checkIndexLocked(indexState)) {
-                                    LOG(ERROR) << "The index has been locked: "
-                                               << index->get_index_name();
-                                    code = nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
-                                    break;
-                                } else {
-                                    batchHolder->remove(std::move(oi));
-                                }
-                            }
-                        }
+            } else {
+                code = nebula::error(obsIdx);
+                break;
+            }
+
+            WriteResult wRet;
+            auto retEnc = encodeRowVal(schema.get(), propNames, props, wRet);
+            if (!retEnc.ok()) {
+                LOG(ERROR) << retEnc.status();
+                code = writeResultTo(wRet, false);
+                break;
+            }
 
-                        /*
-                        * step 2 , Insert new vertex index
-                        */
-                        if (nReader != nullptr) {
-                            auto nik = indexKey(partId, vid, nReader.get(), index);
-                            if (!nik.empty()) {
-                                auto v = CommonUtils::ttlValue(schema.get(), nReader.get());
-                                auto niv = v.ok() ?
-                                    IndexKeyUtils::indexVal(std::move(v).value()) : "";
-                                // Check the index is building for the specified partition or not.
-                                auto indexState = env_->getIndexState(spaceId_, partId);
-                                if (env_->checkRebuilding(indexState)) {
-                                    auto opKey = OperationKeyUtils::modifyOperationKey(partId, nik);
-                                    batchHolder->put(std::move(opKey), std::move(niv));
-                                } else if (env_->checkIndexLocked(indexState)) {
-                                    LOG(ERROR) << "The index has been locked: "
-                                               << index->get_index_name();
-                                    code = nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
-                                    break;
-                                } else {
-                                    batchHolder->put(std::move(nik), std::move(niv));
-                                }
-                            }
+            if (!retEnc.value().empty()) {
+                nReader = RowReaderWrapper::getTagPropReader(env_->schemaMan_,
+                                                             spaceId_,
+                                                             tagId,
+                                                             retEnc.value());
+            }
+            for (auto& index : indexesOf(tagId)) {
+                /*
+                * step 1 , Delete old version index if exists.
+                */
+                if (oReader != nullptr) {
+                    auto oi = indexKey(partId, vid, oReader.get(), index);
+                    if (!oi.empty()) {
+                        // Check the index is building for the specified partition or not.
+                        if (env_->checkRebuilding(indexState)) {
+                            auto delOpKey = OperationKeyUtils::deleteOperationKey(partId);
+                            batchHolder->put(std::move(delOpKey), std::move(oi));
+                        } else if (env_->checkIndexLocked(indexState)) {
+                            LOG(ERROR) << "The index has been locked: "
+                                       << index->get_index_name();
+                            code = nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
+                            break;
+                        } else {
+                            batchHolder->remove(std::move(oi));
                         }
                     }
-                }  // for index data
-                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
-                    break;
                 }
+
                 /*
-                * step 3 , Insert new vertex data
+                * step 2 , Insert new vertex index
                 */
-                batchHolder->put(std::move(key), std::move(retEnc.value()));
-                dummyLock.emplace_back(std::make_tuple(spaceId_, partId, tagId, vid));
-
-                if (FLAGS_enable_vertex_cache && vertexCache_ != nullptr) {
-                    vertexCache_->evict(std::make_pair(vid, tagId));
-                    VLOG(3) << "Evict cache for vId " << vid
-                            << ", tagId " << tagId;
+                if (nReader != nullptr) {
+                    auto nik = indexKey(partId, vid, nReader.get(), index);
+                    if (!nik.empty()) {
+                        auto v = CommonUtils::ttlValue(schema.get(), nReader.get());
+                        auto niv = v.ok() ?
+                            IndexKeyUtils::indexVal(std::move(v).value()) : "";
+                        // Check the index is building for the specified partition or not.
+                        if (env_->checkRebuilding(indexState)) {
+                            auto opKey = OperationKeyUtils::modifyOperationKey(partId, nik);
+                            batchHolder->put(std::move(opKey), std::move(niv));
+                        } else if (env_->checkIndexLocked(indexState)) {
+                            LOG(ERROR) << "The index has been locked: "
+                                       << index->get_index_name();
+                            code = nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR;
+                            break;
+                        } else {
+                            batchHolder->put(std::move(nik), std::move(niv));
+                        }
+                    }
                 }
-            }
+            }  // for index data
             if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 break;
             }
+            /*
+            * step 3 , Insert new vertex data
+            */
+            if (!ifNotExists_) {
+                newValues[key] = retEnc.value();
+            }
+            if (valueCache != nullptr) {
+                written.emplace_back(std::make_pair(vid, tagId), retEnc.value());
+            } else {
+                env_->evictIndexValueCache(vid, tagId);
+            }
+            batchHolder->put(std::move(key), std::move(retEnc.value()));
+            dummyLock.emplace_back(std::make_tuple(spaceId_, partId, tagId, vid));
+
+            if (FLAGS_enable_vertex_cache && vertexCache_ != nullptr) {
+                vertexCache_->evict(std::make_pair(vid, tagId));
+                VLOG(3) << "Evict cache for vId " << vid
+                        << ", tagId " << tagId;
+            }
         }
         if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
-            handleAsync(spaceId_, partId, code);
-            continue;
+            break;
         }
-        auto batch = encodeBatchValue(std::move(batchHolder)->getBatch());
-        DCHECK(!batch.empty());
-        nebula::MemoryLockGuard<VMLI> lg(env_->verticesML_.get(), std::move(dummyLock), true);
-        if (!lg) {
-            auto conflict = lg.conflictKey();
-            LOG(ERROR) << "vertex conflict "
-                        << std::get<0>(conflict) << ":"
-                        << std::get<1>(conflict) << ":"
-                        << std::get<2>(conflict) << ":"
-                        << std::get<3>(conflict);
-            handleAsync(spaceId_, partId, nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR);
-            continue;
-        }
-        env_->kvstore_->asyncAppendBatch(spaceId_, partId, std::move(batch),
-            [l = std::move(lg), icw = std::move(wrapper), partId, this] (
-                nebula::cpp2::ErrorCode retCode) {
-                UNUSED(l);
-                UNUSED(icw);
-                handleAsync(spaceId_, partId, retCode);
-            });
     }
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        handleAsync(spaceId_, partId, code);
+        return;
+    }
+    auto batch = encodeBatchValue(std::move(batchHolder)->getBatch());
+    DCHECK(!batch.empty());
+    nebula::MemoryLockGuard<VMLI> lg(env_->verticesML_.get(), std::move(dummyLock), true);
+    if (!lg) {
+        auto conflict = lg.conflictKey();
+        LOG(ERROR) << "vertex conflict "
+                    << std::get<0>(conflict) << ":"
+                    << std::get<1>(conflict) << ":"
+                    << std::get<2>(conflict) << ":"
+                    << std::get<3>(conflict);
+        handleAsync(spaceId_, partId, nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR);
+        return;
+    }
+    env_->kvstore_->asyncAppendBatch(spaceId_, partId, std::move(batch),
+        [l = std::move(lg), icw = std::move(wrapper), partId, this,
+         valueCache, term, written = std::move(written)] (
+            nebula::cpp2::ErrorCode retCode) {
+            UNUSED(l);
+            UNUSED(icw);
+            // the rows are unknown if the batch failed, they are evicted
+            for (const auto& [cacheKey, row] : written) {
+                if (retCode == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    valueCache->insert(cacheKey, term, row);
+                } else {
+                    valueCache->evict(cacheKey);
+                }
+            }
+            handleAsync(spaceId_, partId, retCode);
+        });
 }
 
 ErrorOr<nebula::cpp2::ErrorCode, std::string>
-AddVerticesProcessor::findOldValue(PartitionID partId, const VertexID& vId, TagID tagId) {
-    const auto& prefix = NebulaKeyUtils::vertexPrefix(spaceVidLen_, partId, vId, tagId);
-    std::unique_ptr<kvstore::KVIterator> iter;
-    auto ret = env_->kvstore_->prefix(spaceId_, partId, prefix, &iter);
+AddVerticesProcessor::findOldValue(PartitionID partId,
+                                   const VertexID& vId,
+                                   TagID tagId,
+                                   IndexValueCache* valueCache,
+                                   TermID term) {
+    if (valueCache != nullptr) {
+        auto cached = valueCache->get(std::make_pair(vId, tagId), term);
+        if (cached.ok()) {
+            return std::move(cached).value();
+        }
+    }
+    // the vertex key is the whole key, a point get is enough
+    auto key = NebulaKeyUtils::vertexKey(spaceVidLen_, partId, vId, tagId);
+    std::string val;
+    auto ret = env_->kvstore_->get(spaceId_, partId, key, &val);
+    if (ret == nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND) {
+        return std::string();
+    }
     if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
         LOG(ERROR) << "Error! ret = " << static_cast<int32_t>(ret)
                    << ", spaceId " << spaceId_;
         return ret;
     }
-    if (iter && iter->valid()) {
-        return iter->val().str();
-    }
-    return std::string();
+    return val;
 }
 
 std::string AddVerticesProcessor::indexKey(PartitionID partId,
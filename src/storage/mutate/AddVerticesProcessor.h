@@ -23,8 +23,9 @@ public:
     static AddVerticesProcessor* instance(
             StorageEnv* env,
             const ProcessorCounters* counters = &kAddVerticesCounters,
-            VertexCache* cache = nullptr) {
-        return new AddVerticesProcessor(env, counters, cache);
+            VertexCache* cache = nullptr,
+            folly::Executor* executor = nullptr) {
+        return new AddVerticesProcessor(env, counters, cache, executor);
     }
 
     void process(const cpp2::AddVerticesRequest& req);
@@ -33,17 +34,42 @@ public:
 
     void doProcessWithIndex(const cpp2::AddVerticesRequest& req);
 
+    // Process each part in the executor
+    void doProcessConcurrently(const cpp2::AddVerticesRequest& req);
+
 private:
+    using PropNamesMap = std::unordered_map<TagID, std::vector<std::string>>;
+    using IndexItems = std::vector<std::shared_ptr<nebula::meta::cpp2::IndexItem>>;
+
     AddVerticesProcessor(StorageEnv* env,
                          const ProcessorCounters* counters,
-                         VertexCache* cache)
+                         VertexCache* cache,
+                         folly::Executor* executor)
         : BaseProcessor<cpp2::ExecResponse>(env, counters)
-        , vertexCache_(cache) {}
+        , vertexCache_(cache)
+        , executor_(executor) {}
+
+    void processPart(PartitionID partId,
+                     const std::vector<cpp2::NewVertex>& vertices,
+                     const PropNamesMap& propNamesMap);
+
+    void processPartWithIndex(PartitionID partId,
+                              const std::vector<cpp2::NewVertex>& vertices,
+                              const PropNamesMap& propNamesMap);
+
+    // tagIndexes_ is read only once built, the parts may be processed concurrently
+    const IndexItems& indexesOf(TagID tagId) const {
+        static const IndexItems kEmpty;
+        auto iter = tagIndexes_.find(tagId);
+        return iter == tagIndexes_.end() ? kEmpty : iter->second;
+    }
 
     ErrorOr<nebula::cpp2::ErrorCode, std::string>
     findOldValue(PartitionID partId,
                  const VertexID& vId,
-                 TagID tagId);
+                 TagID tagId,
+                 IndexValueCache* valueCache = nullptr,
+                 TermID term = -1);
 
     std::string indexKey(PartitionID partId,
                          const VertexID& vId,
@@ -53,8 +79,13 @@ private:
 private:
     GraphSpaceID                                                spaceId_;
     VertexCache*                                                vertexCache_{nullptr};
-    std::vector<std::shared_ptr<nebula::meta::cpp2::IndexItem>> indexes_;
+    folly::Executor*                                            executor_{nullptr};
+    IndexItems                                                  indexes_;
+    // indexes grouped by tag
+    std::unordered_map<TagID, IndexItems>                       tagIndexes_;
     bool                                                        ifNotExists_{false};
+    // the copy of request processed in the executor
+    cpp2::AddVerticesRequest                                    req_;
 };
 
 }  // namespace storage
@@ -71,6 +71,7 @@ void DeleteEdgesProcessor::process(const cpp2::DeleteEdgesRequest& req) {
                                                     *edgeKey.edge_type_ref(),
                                                     *edgeKey.ranking_ref(),
                                                     (*edgeKey.dst_ref()).getStr());
+                env_->evictEdgeCache(spaceId_, spaceVidLen_, edge);
                 keys.emplace_back(edge.data(), edge.size());
             }
             if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
@@ -134,6 +135,7 @@ DeleteEdgesProcessor::deleteEdges(PartitionID partId, const std::vector<cpp2::Ed
         auto rank = *edge.ranking_ref();
         auto dstId = (*edge.dst_ref()).getStr();
         auto prefix = NebulaKeyUtils::edgePrefix(spaceVidLen_, partId, srcId, type, rank, dstId);
+        env_->evictEdgeCache(spaceId_, spaceVidLen_, prefix);
         std::unique_ptr<kvstore::KVIterator> iter;
         auto ret = env_->kvstore_->prefix(spaceId_, partId, prefix, &iter);
         if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
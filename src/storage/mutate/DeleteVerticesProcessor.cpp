@@ -46,13 +46,13 @@ void DeleteVerticesProcessor::process(const cpp2::DeleteVerticesRequest& req) {
 
     CHECK_NOTNULL(env_->kvstore_);
     if (indexes_.empty()) {
-        // Operate every part, the graph layer guarantees the unique of the vid
-        std::vector<std::string> keys;
-        keys.reserve(32);
+        // Operate every part, the graph layer guarantees the unique of the vid. Each tag of a
+        // vertex is removed by its key, so that the listeners see the removes too.
         for (auto& part : partVertices) {
             auto partId = part.first;
             const auto& vertexIds = part.second;
-            keys.clear();
+            kvstore::BatchHolder batchHolder;
+            std::vector<IndexValueCache::Key> evicted;
             auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
             for (auto& vid : vertexIds) {
                 if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vid.getStr())) {
@@ -70,16 +70,20 @@ void DeleteVerticesProcessor::process(const cpp2::DeleteVerticesRequest& req) {
                             << ", spaceID " << spaceId_;
                     break;
                 }
+                if (!iter->valid()) {
+                    continue;
+                }
                 while (iter->valid()) {
                     auto key = iter->key();
                     auto tagId = NebulaKeyUtils::getTagId(spaceVidLen_, key);
                     // Evict vertices from cache
+                    evicted.emplace_back(vid.getStr(), tagId);
                     if (FLAGS_enable_vertex_cache && vertexCache_ != nullptr) {
                         VLOG(3) << "Evict vertex cache for VID " << vid
                                 << ", TagID " << tagId;
                         vertexCache_->evict(std::make_pair(vid.getStr(), tagId));
                     }
-                    keys.emplace_back(key.str());
+                    removeTag(&batchHolder, tagId, key, iter->val());
                     iter->next();
                 }
             }
@@ -87,7 +91,18 @@ void DeleteVerticesProcessor::process(const cpp2::DeleteVerticesRequest& req) {
                 handleAsync(spaceId_, partId, code);
                 continue;
             }
-            doRemove(spaceId_, partId, std::move(keys));
+            if (batchHolder.getBatch().empty()) {
+                handleAsync(spaceId_, partId, nebula::cpp2::ErrorCode::SUCCEEDED);
+                continue;
+            }
+            env_->kvstore_->asyncAppendBatch(spaceId_, partId,
+                                             encodeBatchValue(batchHolder.getBatch()),
+                [partId, evicted = std::move(evicted), this] (nebula::cpp2::ErrorCode retCode) {
+                    for (const auto& key : evicted) {
+                        env_->evictIndexValueCache(key.first, key.second);
+                    }
+                    handleAsync(spaceId_, partId, retCode);
+                });
         }
     } else {
         for (auto& pv : partVertices) {
@@ -100,6 +115,11 @@ void DeleteVerticesProcessor::process(const cpp2::DeleteVerticesRequest& req) {
                 continue;
             }
             DCHECK(!nebula::value(batch).empty());
+            std::vector<IndexValueCache::Key> evicted;
+            evicted.reserve(dummyLock.size());
+            for (const auto& lock : dummyLock) {
+                evicted.emplace_back(std::get<3>(lock), std::get<2>(lock));
+            }
             nebula::MemoryLockGuard<VMLI> lg(env_->verticesML_.get(), std::move(dummyLock), true);
             if (!lg) {
                 auto conflict = lg.conflictKey();
@@ -112,10 +132,15 @@ void DeleteVerticesProcessor::process(const cpp2::DeleteVerticesRequest& req) {
                 continue;
             }
             env_->kvstore_->asyncAppendBatch(spaceId_, partId, std::move(nebula::value(batch)),
-                [l = std::move(lg), icw = std::move(wrapper), partId, this] (
-                    nebula::cpp2::ErrorCode code) {
+                [l = std::move(lg), icw = std::move(wrapper), partId,
+                 evicted = std::move(evicted), this] (nebula::cpp2::ErrorCode code) {
                     UNUSED(l);
                     UNUSED(icw);
+                    // Evicted after the write under the lock of vertices, the rows cached by
+                    // the writes before are the old ones, and none could be cached until then
+                    for (const auto& key : evicted) {
+                        env_->evictIndexValueCache(key.first, key.second);
+                    }
                     handleAsync(spaceId_, partId, code);
                 });
         }
@@ -138,6 +163,9 @@ DeleteVerticesProcessor::deleteVertices(PartitionID partId,
                     << ", spaceId " << spaceId_;
             return ret;
         }
+        if (!iter->valid()) {
+            continue;
+        }
 
         while (iter->valid()) {
             auto key = iter->key();
@@ -187,7 +215,7 @@ DeleteVerticesProcessor::deleteVertices(PartitionID partId,
                 vertexCache_->evict(std::make_pair(vertex.getStr(), tagId));
             }
             target.emplace_back(std::make_tuple(spaceId_, partId, tagId, vertex.getStr()));
-            batchHolder->remove(key.str());
+            removeTag(batchHolder.get(), tagId, key, iter->val());
             iter->next();
         }
     }
@@ -195,5 +223,21 @@ DeleteVerticesProcessor::deleteVertices(PartitionID partId,
     return encodeBatchValue(batchHolder->getBatch());
 }
 
+void DeleteVerticesProcessor::removeTag(kvstore::BatchHolder* batchHolder,
+                                        TagID tagId,
+                                        folly::StringPiece key,
+                                        folly::StringPiece val) {
+    auto iter = ftTags_.find(tagId);
+    if (iter == ftTags_.end()) {
+        iter = ftTags_.emplace(tagId, env_->schemaMan_->getFTIndex(spaceId_, tagId).ok()).first;
+    }
+    if (iter->second) {
+        // the row removed is logged for the fulltext listener to delete its docs
+        batchHolder->remove(key.str(), val.str());
+    } else {
+        batchHolder->remove(key.str());
+    }
+}
+
 }  // namespace storage
 }  // namespace nebula
@@ -40,10 +40,18 @@ private:
                    const std::vector<Value>& vertices,
                    std::vector<VMLI>& target);
 
+    // Remove the tag of a vertex, with the row if the tag has a fulltext index
+    void removeTag(kvstore::BatchHolder* batchHolder,
+                   TagID tagId,
+                   folly::StringPiece key,
+                   folly::StringPiece val);
+
 private:
     GraphSpaceID                                                spaceId_;
     VertexCache*                                                vertexCache_{nullptr};
     std::vector<std::shared_ptr<nebula::meta::cpp2::IndexItem>> indexes_;
+    // whether each tag met has a fulltext index
+    std::unordered_map<TagID, bool>                             ftTags_;
 };
 
 
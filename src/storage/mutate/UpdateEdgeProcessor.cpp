@@ -81,6 +81,12 @@ void UpdateEdgeProcessor::doProcess(const cpp2::UpdateEdgeRequest& req) {
             << ", src: " << edgeKey_.get_src() << ", edge_type: " << edgeKey_.get_edge_type()
             << ", dst: " << edgeKey_.get_dst() << ", ranking: " << edgeKey_.get_ranking();
 
+    env_->evictEdgeCache(spaceId_,
+                         spaceVidLen_,
+                         NebulaKeyUtils::edgePrefix(spaceVidLen_,
+                                                    partId,
+                                                    edgeKey_.get_src().getStr(),
+                                                    edgeKey_.get_edge_type()));
     auto plan = buildPlan(&resultDataSet_);
 
     auto ret = plan.go(partId, edgeKey_);
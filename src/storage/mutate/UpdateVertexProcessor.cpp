@@ -11,6 +11,10 @@
 #include "storage/exec/FilterNode.h"
 #include "storage/exec/UpdateNode.h"
 #include "storage/exec/UpdateResultNode.h"
+#include "storage/MergeOperator.h"
+#include "storage/StorageFlags.h"
+
+DECLARE_string(engine_type);
 
 namespace nebula {
 namespace storage {
@@ -72,6 +76,12 @@ void UpdateVertexProcessor::doProcess(const cpp2::UpdateVertexRequest& req) {
     }
     indexes_ = std::move(iRet).value();
 
+    std::string operand;
+    if (buildMergeOperand(req, partId, &operand)) {
+        doMerge(partId, vId.getStr(), std::move(operand));
+        return;
+    }
+
     VLOG(3) << "Update vertex, spaceId: " << spaceId_
             << ", partId: " << partId << ", vId: " << vId;
     auto plan = buildPlan(&resultDataSet_);
@@ -188,7 +198,8 @@ UpdateVertexProcessor::buildTagContext(const cpp2::UpdateVertexRequest& req) {
     }
     auto tagName = tagNameRet.value();
 
-    // update, evict the old elements
+    // update, evict the old elements. The row cached for index maintenance is evicted after
+    // the write is committed, see UpdateTagNode
     if (FLAGS_enable_vertex_cache && tagContext_.vertexCache_ != nullptr) {
         VLOG(1) << "Evict cache for vId " << vId << ", tagId " << tagId_;
         tagContext_.vertexCache_->evict(std::make_pair(vId.getStr(), tagId_));
@@ -287,6 +298,142 @@ UpdateVertexProcessor::buildTagContext(const cpp2::UpdateVertexRequest& req) {
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
+bool UpdateVertexProcessor::mergeOperandEnabled(PartitionID partId) const {
+    if (!FLAGS_update_by_merge_operand || FLAGS_engine_type != "rocksdb") {
+        return false;
+    }
+    std::vector<folly::StringPiece> spaces;
+    folly::split(",", FLAGS_update_by_merge_operand_spaces, spaces, true);
+    auto opted = std::any_of(spaces.begin(), spaces.end(), [this] (auto space) {
+        auto id = folly::tryTo<GraphSpaceID>(folly::trimWhitespace(space));
+        return id.hasValue() && id.value() == spaceId_;
+    });
+    if (!opted) {
+        return false;
+    }
+    // The listeners, e.g. of the fulltext index, apply the puts of the rows only
+    auto partRet = env_->kvstore_->part(spaceId_, partId);
+    return nebula::ok(partRet) && nebula::value(partRet)->listeners().empty();
+}
+
+bool UpdateVertexProcessor::buildMergeOperand(const cpp2::UpdateVertexRequest& req,
+                                              PartitionID partId,
+                                              std::string* operand) {
+    // The operand is only resolved by the merge operator of rocksdb. The row not existing is
+    // inserted, so only upsert without condition and returned props is written as operand.
+    if (!insertable_ || !mergeOperandEnabled(partId)) {
+        return false;
+    }
+    if (filterExp_ != nullptr ||
+        (req.return_props_ref().has_value() && !req.return_props_ref()->empty())) {
+        return false;
+    }
+    // The index and ttl need the old row
+    for (auto& index : indexes_) {
+        if (tagId_ == index->get_schema_id().get_tag_id()) {
+            return false;
+        }
+    }
+    if (tagContext_.ttlInfo_.find(tagId_) != tagContext_.ttlInfo_.end()) {
+        return false;
+    }
+    // All props of the row inserted are the default value or null
+    auto schema = context_->tagSchema_;
+    for (size_t i = 0; i < schema->getNumFields(); i++) {
+        auto field = schema->field(i);
+        if (!field->hasDefault() && !field->nullable()) {
+            return false;
+        }
+    }
+
+    // Only `prop = prop + constant` and `prop = prop - constant` are written as operand
+    auto pool = context_->objPool();
+    MergeOperand::Props props;
+    for (auto& prop : updatedProps_) {
+        auto field = schema->field(prop.get_name());
+        auto exp = Expression::decode(pool, prop.get_value());
+        if (field == nullptr || exp == nullptr ||
+            (exp->kind() != Expression::Kind::kAdd && exp->kind() != Expression::Kind::kMinus)) {
+            return false;
+        }
+        auto* ariExp = static_cast<const ArithmeticExpression*>(exp);
+        auto* left = ariExp->left();
+        auto* right = ariExp->right();
+        if (left->kind() != Expression::Kind::kSrcProperty ||
+            right->kind() != Expression::Kind::kConstant) {
+            return false;
+        }
+        auto* propExp = static_cast<const PropertyExpression*>(left);
+        if (propExp->sym() != context_->tagName_ || propExp->prop() != prop.get_name()) {
+            return false;
+        }
+        auto value = static_cast<const ConstantExpression*>(right)->value();
+        bool minus = exp->kind() == Expression::Kind::kMinus;
+        switch (field->type()) {
+            case meta::cpp2::PropertyType::INT64:
+                if (!value.isInt()) {
+                    return false;
+                }
+                break;
+            case meta::cpp2::PropertyType::FLOAT:
+            case meta::cpp2::PropertyType::DOUBLE:
+                if (!value.isInt() && !value.isFloat()) {
+                    return false;
+                }
+                break;
+            case meta::cpp2::PropertyType::STRING:
+                if (!value.isStr() || minus) {
+                    return false;
+                }
+                break;
+            default:
+                return false;
+        }
+        if (minus) {
+            if (value.isInt() && value.getInt() == std::numeric_limits<int64_t>::min()) {
+                return false;
+            }
+            value = value.isInt() ? Value(-value.getInt()) : Value(-value.getFloat());
+        }
+        props.emplace_back(prop.get_name(), std::move(value));
+    }
+    if (props.empty()) {
+        return false;
+    }
+    *operand = MergeOperand::encode(spaceId_, false, tagId_, props);
+    return true;
+}
+
+void UpdateVertexProcessor::doMerge(PartitionID partId,
+                                    const VertexID& vId,
+                                    std::string&& operand) {
+    VLOG(3) << "Update vertex by merge operand, spaceId: " << spaceId_
+            << ", partId: " << partId << ", vId: " << vId;
+    // Not interleaved with the read-modify-write of the same vertex
+    std::vector<VMLI> dummyLock = {std::make_tuple(spaceId_, partId, tagId_, vId)};
+    nebula::MemoryLockGuard<VMLI> lg(env_->verticesML_.get(), std::move(dummyLock));
+    if (!lg) {
+        LOG(ERROR) << "vertex conflict " << spaceId_ << ":" << partId << ":"
+                   << tagId_ << ":" << vId;
+        pushResultCode(nebula::cpp2::ErrorCode::E_DATA_CONFLICT_ERROR, partId);
+        onFinished();
+        return;
+    }
+
+    kvstore::BatchHolder batchHolder;
+    batchHolder.merge(NebulaKeyUtils::vertexKey(spaceVidLen_, partId, vId, tagId_),
+                      std::move(operand));
+    callingNum_ = 1;
+    env_->kvstore_->asyncAppendBatch(spaceId_, partId,
+                                     kvstore::encodeBatchValue(batchHolder.getBatch()),
+        [l = std::move(lg), partId, vId, this] (nebula::cpp2::ErrorCode code) {
+            UNUSED(l);
+            // under the lock of vertex, so no row of it is cached again before the write
+            env_->evictIndexValueCache(vId, tagId_);
+            handleAsync(spaceId_, partId, code);
+        });
+}
+
 void UpdateVertexProcessor::onProcessFinished() {
     resp_.set_props(std::move(resultDataSet_));
 }
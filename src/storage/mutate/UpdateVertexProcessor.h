@@ -54,6 +54,17 @@ private:
     // filter expression, update props expression
     nebula::cpp2::ErrorCode buildTagContext(const cpp2::UpdateVertexRequest& req);
 
+    // Whether the space is opted in to update_by_merge_operand, and the part has no listener
+    bool mergeOperandEnabled(PartitionID partId) const;
+
+    // Build the merge operand if the update only adds constants to the props, which is
+    // written without reading the row
+    bool buildMergeOperand(const cpp2::UpdateVertexRequest& req,
+                           PartitionID partId,
+                           std::string* operand);
+
+    void doMerge(PartitionID partId, const VertexID& vId, std::string&& operand);
+
     void onProcessFinished() override;
 
     std::vector<Expression*> getReturnPropsExp() {
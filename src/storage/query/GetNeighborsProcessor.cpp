@@ -7,6 +7,8 @@
 #include "storage/query/GetNeighborsProcessor.h"
 #include "storage/StorageFlags.h"
 #include "storage/exec/TagNode.h"
+#include "storage/exec/MultiTagNode.h"
+#include "storage/query/PlanTemplateCache.h"
 #include "storage/exec/EdgeNode.h"
 #include "storage/exec/HashJoinNode.h"
 #include "storage/exec/FilterNode.h"
@@ -29,6 +31,7 @@ void GetNeighborsProcessor::process(const cpp2::GetNeighborsRequest& req) {
 }
 
 void GetNeighborsProcessor::doProcess(const cpp2::GetNeighborsRequest& req) {
+    traceQueued();
     spaceId_ = req.get_space_id();
     auto retCode = getSpaceVidLen(spaceId_);
     if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
@@ -39,6 +42,10 @@ void GetNeighborsProcessor::doProcess(const cpp2::GetNeighborsRequest& req) {
         return;
     }
     planContext_ = std::make_unique<PlanContext>(env_, spaceId_, spaceVidLen_, isIntId_);
+    planContext_->budget_ = QueryBudget::fromFlags(spaceId_);
+    planContext_->canReadFromFollower_ = FLAGS_enable_follower_read;
+    planContext_->trace_ = trace_.get();
+    profile_ = RequestProfile::create("GetNeighbors", spaceId_);
 
     // build TagContext and EdgeContext
     retCode = checkAndBuildContexts(req);
@@ -50,6 +57,11 @@ void GetNeighborsProcessor::doProcess(const cpp2::GetNeighborsRequest& req) {
         return;
     }
 
+    // dedup the dst of all vertices in a part, which is not supported with random or order by.
+    // The edges are distinct rows only when `_dst` is all they return, otherwise the dedup of
+    // the request is left to graphd.
+    dedup_ = *(*req.traverse_spec_ref()).dedup_ref() && onlyDstReturned();
+
     int64_t limit = FLAGS_max_edge_returned_per_vertex;
     bool random = false;
     if ((*req.traverse_spec_ref()).limit_ref().has_value()) {
@@ -61,6 +73,22 @@ void GetNeighborsProcessor::doProcess(const cpp2::GetNeighborsRequest& req) {
         }
     }
 
+    // the top k and the sampled edges are always returned row by row
+    columnar_ = FLAGS_get_neighbors_columnar_edges && orderBy_.empty() && !random;
+    if (columnar_) {
+        static const std::string kRowPrefix = "_edge:";
+        for (auto& colName : resultDataSet_.colNames) {
+            if (folly::StringPiece(colName).startsWith(kRowPrefix)) {
+                colName = "_edge_col:" + colName.substr(kRowPrefix.size());
+            }
+        }
+    }
+
+    // the sampled edges differ each time
+    if (this->env_->resultCache_ != nullptr && !random) {
+        cacheShape_ = ResultCache::shape("get_neighbors", req);
+    }
+
     // todo(doodle): specify by each query
     if (!FLAGS_query_concurrently) {
         runInSingleThread(req, limit, random);
@@ -69,18 +97,64 @@ void GetNeighborsProcessor::doProcess(const cpp2::GetNeighborsRequest& req) {
     }
 }
 
+bool GetNeighborsProcessor::onlyDstReturned() const {
+    if (edgeContext_.propContexts_.empty() || edgeContext_.statCount_ > 0) {
+        return false;
+    }
+    for (const auto& entry : edgeContext_.propContexts_) {
+        size_t returned = 0;
+        for (const auto& prop : entry.second) {
+            if (!prop.returned_) {
+                continue;
+            }
+            if (prop.propInKeyType_ != PropContext::PropInKeyType::DST) {
+                return false;
+            }
+            ++returned;
+        }
+        if (returned != 1) {
+            return false;
+        }
+    }
+    return true;
+}
+
 void GetNeighborsProcessor::runInSingleThread(const cpp2::GetNeighborsRequest& req,
                                               int64_t limit,
                                               bool random) {
     contexts_.emplace_back(RunTimeContext(planContext_.get()));
     expCtxs_.emplace_back(StorageExpressionContext(spaceVidLen_, isIntId_));
     auto plan = buildPlan(&contexts_.front(), &expCtxs_.front(), &resultDataSet_, limit, random);
+    plan.setProfile(profile_);
     std::unordered_set<PartitionID> failedParts;
+    auto* budget = planContext_->budget_.get();
     for (const auto& partEntry : req.get_parts()) {
         auto partId = partEntry.first;
+        if (budget != nullptr && budget->exhausted()) {
+            // the vertices of the part are not expanded
+            pushResultCode(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, partId);
+            continue;
+        }
+        ProfileSpan profileSpan(profile_, partId);
+        folly::Optional<uint64_t> version;
+        std::string cacheKey;
+        if (!cacheShape_.empty()) {
+            version = ResultCache::version(this->env_->kvstore_, spaceId_, partId,
+                                           planContext_->canReadFromFollower_);
+        }
+        if (version.has_value()) {
+            cacheKey = resultCacheKey(partId, partEntry.second);
+            auto cached = this->env_->resultCache_->get(cacheKey, *version);
+            if (cached != nullptr) {
+                resultDataSet_.rows.insert(resultDataSet_.rows.end(),
+                                           cached->begin(), cached->end());
+                continue;
+            }
+        }
+        auto start = resultDataSet_.rows.size();
         for (const auto& row : partEntry.second) {
             CHECK_GE(row.values.size(), 1);
-            auto vId = row.values[0].getStr();
+            const auto& vId = row.values[0].getStr();
 
             if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vId)) {
                 LOG(ERROR) << "Space " << spaceId_ << ", vertex length invalid, "
@@ -98,9 +172,28 @@ void GetNeighborsProcessor::runInSingleThread(const cpp2::GetNeighborsRequest& r
                     handleErrorCode(ret, spaceId_, partId);
                 }
             }
+            if (budget != nullptr && budget->exhausted()) {
+                if (failedParts.emplace(partId).second) {
+                    pushResultCode(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, partId);
+                }
+                break;
+            }
+        }
+        if (version.has_value() && failedParts.find(partId) == failedParts.end()) {
+            this->env_->resultCache_->put(
+                cacheKey, *version,
+                ResultCache::Rows(resultDataSet_.rows.begin() + start,
+                                  resultDataSet_.rows.end()));
         }
     }
-    onProcessFinished();
+    if (profile_ != nullptr) {
+        plan.flushProfile();
+        profile_->setRows(resultDataSet_.rows.size());
+    }
+    {
+        LatencySpan span(trace_.get(), LatencyTrace::kSerialize);
+        onProcessFinished();
+    }
     onFinished();
 }
 
@@ -129,11 +222,20 @@ void GetNeighborsProcessor::runInMultipleThread(const cpp2::GetNeighborsRequest&
             const auto& [code, partId] = tries[j].value();
             if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
                 handleErrorCode(code, spaceId_, partId);
-            } else {
+            }
+            // the part stopped by budget still returns what it has collected
+            if (code == nebula::cpp2::ErrorCode::SUCCEEDED ||
+                code == nebula::cpp2::ErrorCode::E_PARTIAL_RESULT) {
                 resultDataSet_.append(std::move(results_[j]));
             }
         }
-        this->onProcessFinished();
+        if (profile_ != nullptr) {
+            profile_->setRows(resultDataSet_.rows.size());
+        }
+        {
+            LatencySpan span(trace_.get(), LatencyTrace::kSerialize);
+            this->onProcessFinished();
+        }
         this->onFinished();
     });
 }
@@ -146,13 +248,42 @@ GetNeighborsProcessor::runInExecutor(RunTimeContext* context,
                                      const std::vector<nebula::Row>& rows,
                                      int64_t limit,
                                      bool random) {
+    // the time the part waits in executor is traced as well
+    auto queuedAt = trace_ != nullptr ? std::chrono::steady_clock::now()
+                                      : std::chrono::steady_clock::time_point();
     return folly::via(
-        executor_,
-        [this, context, expCtx, result, partId, input = std::move(rows), limit, random]() {
+        this->env_->partExecutor(spaceId_, partId, executor_),
+        [this, context, expCtx, result, partId, input = std::move(rows), limit, random,
+         queuedAt]() {
+            if (trace_ != nullptr) {
+                auto queued = std::chrono::steady_clock::now() - queuedAt;
+                trace_->add(LatencyTrace::kQueue,
+                            std::chrono::duration_cast<std::chrono::nanoseconds>(queued).count());
+            }
+            folly::Optional<uint64_t> version;
+            std::string cacheKey;
+            if (!cacheShape_.empty()) {
+                version = ResultCache::version(this->env_->kvstore_, spaceId_, partId,
+                                               planContext_->canReadFromFollower_);
+            }
+            if (version.has_value()) {
+                cacheKey = resultCacheKey(partId, input);
+                auto cached = this->env_->resultCache_->get(cacheKey, *version);
+                if (cached != nullptr) {
+                    result->rows = *cached;
+                    return std::make_pair(nebula::cpp2::ErrorCode::SUCCEEDED, partId);
+                }
+            }
             auto plan = buildPlan(context, expCtx, result, limit, random);
+            plan.setProfile(profile_);
+            ProfileSpan profileSpan(profile_, partId);
+            auto* budget = context->budget();
             for (const auto& row : input) {
+                if (budget != nullptr && budget->exhausted()) {
+                    return std::make_pair(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, partId);
+                }
                 CHECK_GE(row.values.size(), 1);
-                auto vId = row.values[0].getStr();
+                const auto& vId = row.values[0].getStr();
 
                 if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vId)) {
                     LOG(ERROR) << "Space " << spaceId_ << ", vertex length invalid, "
@@ -166,10 +297,27 @@ GetNeighborsProcessor::runInExecutor(RunTimeContext* context,
                     return std::make_pair(ret, partId);
                 }
             }
+            if (budget != nullptr && budget->exhausted()) {
+                return std::make_pair(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT, partId);
+            }
+            if (version.has_value()) {
+                this->env_->resultCache_->put(cacheKey, *version, result->rows);
+            }
             return std::make_pair(nebula::cpp2::ErrorCode::SUCCEEDED, partId);
         });
 }
 
+std::string GetNeighborsProcessor::resultCacheKey(PartitionID partId,
+                                                  const std::vector<nebula::Row>& rows) const {
+    std::string input;
+    for (const auto& row : rows) {
+        const auto& vId = row.values[0].getStr();
+        uint32_t len = vId.size();
+        input.append(reinterpret_cast<const char*>(&len), sizeof(uint32_t)).append(vId);
+    }
+    return ResultCache::key(spaceId_, partId, cacheShape_, input);
+}
+
 StoragePlan<VertexID> GetNeighborsProcessor::buildPlan(RunTimeContext* context,
                                                        StorageExpressionContext* expCtx,
                                                        nebula::DataSet* result,
@@ -204,14 +352,27 @@ StoragePlan<VertexID> GetNeighborsProcessor::buildPlan(RunTimeContext* context,
         plan.addNode(std::move(tag));
     }
     std::vector<EdgeNode<VertexID>*> edges;
+    // the sampled edges are returned as they are only if no filter or stat drops any of them
+    bool approximateSample = random && orderBy_.empty() && !filter_ &&
+                             edgeContext_.statCount_ == 0 && limit > 0 &&
+                             FLAGS_get_neighbors_approximate_sample_degree > 0;
     for (const auto& ec : edgeContext_.propContexts_) {
         auto edge = std::make_unique<SingleEdgeNode>(context, &edgeContext_, ec.first, &ec.second);
+        if (approximateSample) {
+            edge->setSampleSize(limit);
+        }
         edges.emplace_back(edge.get());
         plan.addNode(std::move(edge));
     }
 
     auto hashJoin =
         std::make_unique<HashJoinNode>(context, tags, edges, &tagContext_, &edgeContext_, expCtx);
+    if (tags.size() > 1) {
+        // executed before the tag nodes
+        auto multiTag = std::make_unique<MultiTagNode>(context, tags);
+        hashJoin->addDependency(multiTag.get());
+        plan.addNode(std::move(multiTag));
+    }
     for (auto* tag : tags) {
         hashJoin->addDependency(tag);
     }
@@ -238,12 +399,20 @@ StoragePlan<VertexID> GetNeighborsProcessor::buildPlan(RunTimeContext* context,
     }
 
     std::unique_ptr<GetNeighborsNode> output;
-    if (random) {
+    if (!orderBy_.empty()) {
+        // each plan has its own copy of expressions, because eval is not thread-safe
+        GetNeighborsTopKNode::OrderBy orderBy;
+        for (const auto& order : orderBy_) {
+            orderBy.emplace_back(order.first->clone(), order.second);
+        }
+        output = std::make_unique<GetNeighborsTopKNode>(
+            context, join, upstream, &edgeContext_, result, limit, expCtx, std::move(orderBy));
+    } else if (random) {
         output = std::make_unique<GetNeighborsSampleNode>(
             context, join, upstream, &edgeContext_, result, limit);
     } else {
         output = std::make_unique<GetNeighborsNode>(
-            context, join, upstream, &edgeContext_, result, limit);
+            context, join, upstream, &edgeContext_, result, limit, dedup_, columnar_);
     }
     output->addDependency(upstream);
     plan.addNode(std::move(output));
@@ -253,6 +422,31 @@ StoragePlan<VertexID> GetNeighborsProcessor::buildPlan(RunTimeContext* context,
 
 nebula::cpp2::ErrorCode
 GetNeighborsProcessor::checkAndBuildContexts(const cpp2::GetNeighborsRequest& req) {
+    const auto& traverseSpec = req.get_traverse_spec();
+    auto* templates = this->env_->planTemplates_;
+    std::string templateKey;
+    // the requests asking for all tags or edges are not cached
+    bool allTags = traverseSpec.vertex_props_ref().has_value() &&
+                   (*traverseSpec.vertex_props_ref()).empty();
+    bool allEdges = traverseSpec.edge_props_ref().has_value() &&
+                    (*traverseSpec.edge_props_ref()).empty();
+    if (templates != nullptr && !allTags && !allEdges) {
+        templateKey = PlanTemplateCache::key(spaceId_, "get_neighbors", traverseSpec);
+        auto tmpl = templates->get(templateKey, this->env_->schemaMan_, spaceId_);
+        if (tmpl != nullptr) {
+            PlanTemplateCache::apply(*tmpl, &tagContext_, &edgeContext_,
+                                     &resultDataSet_.colNames);
+            // the expressions are decoded into the pool of this request, the props they read
+            // are in the contexts already
+            auto code = buildFilter(req);
+            if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                return code;
+            }
+            buildRankRanges();
+            return buildOrderBy(traverseSpec);
+        }
+    }
+
     resultDataSet_.colNames.emplace_back(kVid);
     // reserve second colname for stat
     resultDataSet_.colNames.emplace_back("_stats");
@@ -281,6 +475,56 @@ GetNeighborsProcessor::checkAndBuildContexts(const cpp2::GetNeighborsRequest& re
     if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
         return code;
     }
+    buildRankRanges();
+    code = buildOrderBy(req.get_traverse_spec());
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return code;
+    }
+    if (!templateKey.empty()) {
+        templates->put(templateKey, tagContext_, edgeContext_, resultDataSet_.colNames);
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+void GetNeighborsProcessor::buildRankRanges() {
+    // the ranges depend on the filter of each request, never on the template applied
+    edgeContext_.rankRanges_.clear();
+    if (!FLAGS_enable_edge_rank_seek || filter_ == nullptr) {
+        return;
+    }
+    auto ranges = EdgeRankRange::collect(filter_);
+    if (ranges.empty()) {
+        return;
+    }
+    for (const auto& entry : edgeContext_.edgeNames_) {
+        auto it = ranges.find(entry.second);
+        if (it != ranges.end()) {
+            VLOG(1) << "Seek the edges of " << entry.second << " to the rank range ["
+                    << it->second.lower_ << ", " << it->second.upper_ << "]";
+            edgeContext_.rankRanges_.emplace(entry.first, it->second);
+        }
+    }
+}
+
+nebula::cpp2::ErrorCode
+GetNeighborsProcessor::buildOrderBy(const cpp2::TraverseSpec& req) {
+    if (!req.order_by_ref().has_value()) {
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    auto pool = &this->planContext_->objPool_;
+    for (const auto& orderBy : *req.order_by_ref()) {
+        auto exp = Expression::decode(pool, orderBy.get_prop());
+        if (exp == nullptr) {
+            return nebula::cpp2::ErrorCode::E_INVALID_FILTER;
+        }
+        // the props in order by need to be set into expression context like filter
+        auto code = checkExp(exp, false, true);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+        bool asc = orderBy.get_direction() == cpp2::OrderDirection::ASCENDING;
+        orderBy_.emplace_back(exp, asc);
+    }
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
@@ -322,6 +566,13 @@ GetNeighborsProcessor::buildEdgeContext(const cpp2::TraverseSpec& req) {
         if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
             return ret;
         }
+        // the expressions of traverse spec are the group keys of stats
+        if (req.expressions_ref().has_value() && !(*req.expressions_ref()).empty()) {
+            ret = handleStatGroupKeys(*req.expressions_ref());
+            if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                return ret;
+            }
+        }
     }
     buildEdgeColName(std::move(returnProps));
     buildEdgeTTLInfo();
@@ -429,6 +680,66 @@ nebula::cpp2::ErrorCode GetNeighborsProcessor::handleEdgeStatProps(
     return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
+nebula::cpp2::ErrorCode
+GetNeighborsProcessor::handleStatGroupKeys(const std::vector<cpp2::Expr>& groupKeys) {
+    const std::string statCol = "_stats";
+    std::string colName = statCol;
+    auto pool = &this->planContext_->objPool_;
+
+    for (const auto& groupKey : groupKeys) {
+        auto exp = Expression::decode(pool, groupKey.get_expr());
+        if (exp == nullptr) {
+            return nebula::cpp2::ErrorCode::E_INVALID_STAT_TYPE;
+        }
+
+        // only group by the prop of edge, e.g. edge type, dst or a prop in value
+        switch (exp->kind()) {
+            case Expression::Kind::kEdgeSrc:
+            case Expression::Kind::kEdgeType:
+            case Expression::Kind::kEdgeRank:
+            case Expression::Kind::kEdgeDst:
+            case Expression::Kind::kEdgeProperty: {
+                auto* edgeExp = static_cast<const PropertyExpression*>(exp);
+                const auto& edgeName = edgeExp->sym();
+                const auto& propName = edgeExp->prop();
+                auto edgeRet = this->env_->schemaMan_->toEdgeType(spaceId_, edgeName);
+                if (!edgeRet.ok()) {
+                    VLOG(1) << "Can't find edge " << edgeName << ", in space " << spaceId_;
+                    return nebula::cpp2::ErrorCode::E_EDGE_NOT_FOUND;
+                }
+
+                auto edgeType = std::abs(edgeRet.value());
+                const meta::SchemaProviderIf::Field* field = nullptr;
+                if (exp->kind() == Expression::Kind::kEdgeProperty) {
+                    auto iter = edgeContext_.schemas_.find(edgeType);
+                    if (iter == edgeContext_.schemas_.end()) {
+                        VLOG(1) << "Can't find spaceId " << spaceId_ << " edgeType " << edgeType;
+                        return nebula::cpp2::ErrorCode::E_EDGE_NOT_FOUND;
+                    }
+                    CHECK(!iter->second.empty());
+                    field = iter->second.back()->field(propName);
+                    if (field == nullptr) {
+                        VLOG(1) << "Can't find related prop " << propName
+                                << " on edge " << edgeName;
+                        return nebula::cpp2::ErrorCode::E_EDGE_PROP_NOT_FOUND;
+                    }
+                }
+                edgeContext_.statGroupKeys_.emplace_back(
+                    edgeType, PropContext(propName.c_str(), field, false, false));
+                break;
+            }
+            default: {
+                return nebula::cpp2::ErrorCode::E_INVALID_STAT_TYPE;
+            }
+        }
+        colName += ":" + groupKey.get_alias();
+    }
+    // the group keys are ahead of stats in both column name and the result of each group
+    resultDataSet_.colNames[1] = colName + resultDataSet_.colNames[1].substr(statCol.size());
+
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
 nebula::cpp2::ErrorCode
 GetNeighborsProcessor::checkStatType(const meta::SchemaProviderIf::Field* field,
                                      cpp2::StatType statType) {
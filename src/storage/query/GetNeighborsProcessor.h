@@ -59,6 +59,10 @@ private:
 
     nebula::cpp2::ErrorCode buildTagContext(const cpp2::TraverseSpec& req);
     nebula::cpp2::ErrorCode buildEdgeContext(const cpp2::TraverseSpec& req);
+    nebula::cpp2::ErrorCode buildOrderBy(const cpp2::TraverseSpec& req);
+
+    // the ranges of rank the filter allows of each edge type, see EdgeRankRange
+    void buildRankRanges();
 
     // build tag/edge col name in response when prop specified
     void buildTagColName(const std::vector<cpp2::VertexProp>& tagProps);
@@ -68,10 +72,17 @@ private:
     nebula::cpp2::ErrorCode
     handleEdgeStatProps(const std::vector<cpp2::StatProp>& statProps);
 
+    // group the stats of each vertex by the props of edge
+    nebula::cpp2::ErrorCode
+    handleStatGroupKeys(const std::vector<cpp2::Expr>& groupKeys);
+
     nebula::cpp2::ErrorCode
     checkStatType(const meta::SchemaProviderIf::Field* field,
                   cpp2::StatType statType);
 
+    // whether `_dst` is the only prop returned of each edge type, without any stat
+    bool onlyDstReturned() const;
+
     void runInSingleThread(const cpp2::GetNeighborsRequest& req, int64_t limit, bool random);
     void runInMultipleThread(const cpp2::GetNeighborsRequest& req, int64_t limit, bool random);
 
@@ -84,10 +95,21 @@ private:
         int64_t limit,
         bool random);
 
+    // The key of the vertices of the part in the result cache
+    std::string resultCacheKey(PartitionID partId, const std::vector<nebula::Row>& rows) const;
+
 private:
     std::vector<RunTimeContext>               contexts_;
     std::vector<StorageExpressionContext>     expCtxs_;
     std::vector<nebula::DataSet>              results_;
+    // order by expression and whether it is ascending
+    std::vector<std::pair<Expression*, bool>> orderBy_;
+    // only return the first edge to each dst in a part, see onlyDstReturned
+    bool                                      dedup_{false};
+    // return the edges column by column in the _edge_col: columns
+    bool                                      columnar_{false};
+    // the request without the parts in the result cache, empty if it is not cached
+    std::string                               cacheShape_;
 };
 
 }  // namespace storage
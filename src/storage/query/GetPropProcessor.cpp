@@ -6,6 +6,8 @@
 
 #include "storage/query/GetPropProcessor.h"
 #include "storage/exec/GetPropNode.h"
+#include "storage/exec/MultiTagNode.h"
+#include "storage/query/PlanTemplateCache.h"
 
 namespace nebula {
 namespace storage {
@@ -24,6 +26,7 @@ void GetPropProcessor::process(const cpp2::GetPropRequest& req) {
 
 void GetPropProcessor::doProcess(const cpp2::GetPropRequest& req) {
     spaceId_ = req.get_space_id();
+    profile_ = RequestProfile::create("GetProp", spaceId_);
     auto retCode = getSpaceVidLen(spaceId_);
     if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
         for (auto& p : req.get_parts()) {
@@ -33,6 +36,7 @@ void GetPropProcessor::doProcess(const cpp2::GetPropRequest& req) {
         return;
     }
     planContext_ = std::make_unique<PlanContext>(env_, spaceId_, spaceVidLen_, isIntId_);
+    planContext_->canReadFromFollower_ = FLAGS_enable_follower_read;
 
     retCode = checkAndBuildContexts(req);
     if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
@@ -55,32 +59,25 @@ void GetPropProcessor::runInSingleThread(const cpp2::GetPropRequest& req) {
     contexts_.emplace_back(RunTimeContext(planContext_.get()));
     std::unordered_set<PartitionID> failedParts;
     if (!isEdge_) {
-        auto plan = buildTagPlan(&contexts_.front(), &resultDataSet_);
+        std::vector<TagNode*> tags;
+        auto plan = buildTagPlan(&contexts_.front(), &resultDataSet_, &tags);
+        plan.setProfile(profile_);
         for (const auto& partEntry : req.get_parts()) {
             auto partId = partEntry.first;
-            for (const auto& row : partEntry.second) {
-                auto vId = row.values[0].getStr();
-
-                if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vId)) {
-                    LOG(ERROR) << "Space " << spaceId_ << ", vertex length invalid, "
-                               << " space vid len: " << spaceVidLen_ << ",  vid is " << vId;
-                    pushResultCode(nebula::cpp2::ErrorCode::E_INVALID_VID, partId);
-                    onFinished();
-                    return;
-                }
-
-                auto ret = plan.go(partId, vId);
-                if (ret != nebula::cpp2::ErrorCode::SUCCEEDED &&
-                    failedParts.find(partId) == failedParts.end()) {
-                    failedParts.emplace(partId);
-                    handleErrorCode(ret, spaceId_, partId);
-                }
+            ProfileSpan profileSpan(profile_, partId);
+            auto ret = processTagRows(plan, tags, partId, partEntry.second, &failedParts);
+            if (ret == nebula::cpp2::ErrorCode::E_INVALID_VID) {
+                pushResultCode(ret, partId);
+                onFinished();
+                return;
             }
         }
     } else {
         auto plan = buildEdgePlan(&contexts_.front(), &resultDataSet_);
+        plan.setProfile(profile_);
         for (const auto& partEntry : req.get_parts()) {
             auto partId = partEntry.first;
+            ProfileSpan profileSpan(profile_, partId);
             for (const auto& row : partEntry.second) {
                 cpp2::EdgeKey edgeKey;
                 edgeKey.set_src(row.values[0].getStr());
@@ -110,6 +107,10 @@ void GetPropProcessor::runInSingleThread(const cpp2::GetPropRequest& req) {
             }
         }
     }
+    // the plans are merged into the profile when they are destroyed
+    if (profile_ != nullptr) {
+        profile_->setRows(resultDataSet_.rows.size());
+    }
     onProcessFinished();
     onFinished();
 }
@@ -139,6 +140,9 @@ void GetPropProcessor::runInMultipleThread(const cpp2::GetPropRequest& req) {
                 resultDataSet_.append(std::move(results_[j]));
             }
         }
+        if (profile_ != nullptr) {
+            profile_->setRows(resultDataSet_.rows.size());
+        }
         this->onProcessFinished();
         this->onFinished();
     });
@@ -150,27 +154,18 @@ GetPropProcessor::runInExecutor(RunTimeContext* context,
                                 PartitionID partId,
                                 const std::vector<nebula::Row>& rows) {
     return folly::via(
-        executor_,
+        this->env_->partExecutor(spaceId_, partId, executor_),
         [this, context, result, partId, input = std::move(rows)]() {
+            ProfileSpan profileSpan(profile_, partId);
             if (!isEdge_) {
-                auto plan = buildTagPlan(context, result);
-                for (const auto& row : input) {
-                    auto vId = row.values[0].getStr();
-
-                    if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vId)) {
-                        LOG(ERROR) << "Space " << spaceId_ << ", vertex length invalid, "
-                                << " space vid len: " << spaceVidLen_ << ",  vid is " << vId;
-                        return std::make_pair(nebula::cpp2::ErrorCode::E_INVALID_VID, partId);
-                    }
-
-                    auto ret = plan.go(partId, vId);
-                    if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
-                        return std::make_pair(ret, partId);
-                    }
-                }
-                return std::make_pair(nebula::cpp2::ErrorCode::SUCCEEDED, partId);
+                std::vector<TagNode*> tags;
+                auto plan = buildTagPlan(context, result, &tags);
+                plan.setProfile(profile_);
+                auto ret = processTagRows(plan, tags, partId, input);
+                return std::make_pair(ret, partId);
             } else {
                 auto plan = buildEdgePlan(context, result);
+                plan.setProfile(profile_);
                 for (const auto& row : input) {
                     cpp2::EdgeKey edgeKey;
                     edgeKey.set_src(row.values[0].getStr());
@@ -198,8 +193,74 @@ GetPropProcessor::runInExecutor(RunTimeContext* context,
         });
 }
 
+nebula::cpp2::ErrorCode
+GetPropProcessor::processTagRows(StoragePlan<VertexID>& plan,
+                                 const std::vector<TagNode*>& tags,
+                                 PartitionID partId,
+                                 const std::vector<nebula::Row>& rows,
+                                 std::unordered_set<PartitionID>* failedParts) {
+    // The vertices are read by batch, so the tag of all vertices in a batch is read by one
+    // multiGet instead of a prefix seek of each vertex
+    size_t batchSize = FLAGS_get_prop_batch_size > 0 ? FLAGS_get_prop_batch_size : 1;
+    auto code = nebula::cpp2::ErrorCode::SUCCEEDED;
+    std::vector<VertexID> vIds;
+    vIds.reserve(std::min(batchSize, rows.size()));
+    for (size_t start = 0; start < rows.size(); start += batchSize) {
+        auto end = std::min(start + batchSize, rows.size());
+        vIds.clear();
+        for (size_t i = start; i < end; i++) {
+            const auto& vId = rows[i].values[0].getStr();
+            if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, vId)) {
+                LOG(ERROR) << "Space " << spaceId_ << ", vertex length invalid, "
+                           << " space vid len: " << spaceVidLen_ << ",  vid is " << vId;
+                return nebula::cpp2::ErrorCode::E_INVALID_VID;
+            }
+            vIds.emplace_back(vId);
+        }
+
+        if (FLAGS_get_prop_batch_size > 0) {
+            for (auto* tag : tags) {
+                auto ret = tag->prefetch(partId, vIds);
+                if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    for (auto* t : tags) {
+                        t->clearPrefetched();
+                    }
+                    if (failedParts != nullptr &&
+                        failedParts->find(partId) == failedParts->end()) {
+                        failedParts->emplace(partId);
+                        handleErrorCode(ret, spaceId_, partId);
+                    }
+                    return ret;
+                }
+            }
+        }
+        for (const auto& vId : vIds) {
+            auto ret = plan.go(partId, vId);
+            if (ret == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                continue;
+            }
+            if (failedParts == nullptr) {
+                code = ret;
+                break;
+            }
+            if (failedParts->find(partId) == failedParts->end()) {
+                failedParts->emplace(partId);
+                handleErrorCode(ret, spaceId_, partId);
+            }
+        }
+        for (auto* tag : tags) {
+            tag->clearPrefetched();
+        }
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return code;
+        }
+    }
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
 StoragePlan<VertexID> GetPropProcessor::buildTagPlan(RunTimeContext* context,
-                                                     nebula::DataSet* result) {
+                                                     nebula::DataSet* result,
+                                                     std::vector<TagNode*>* tagNodes) {
     StoragePlan<VertexID> plan;
     std::vector<TagNode*> tags;
     for (const auto& tc : tagContext_.propContexts_) {
@@ -208,10 +269,19 @@ StoragePlan<VertexID> GetPropProcessor::buildTagPlan(RunTimeContext* context,
         plan.addNode(std::move(tag));
     }
     auto output = std::make_unique<GetTagPropNode>(context, tags, result, tagContext_.vertexCache_);
+    if (tags.size() > 1) {
+        // executed before the tag nodes
+        auto multiTag = std::make_unique<MultiTagNode>(context, tags);
+        output->addDependency(multiTag.get());
+        plan.addNode(std::move(multiTag));
+    }
     for (auto* tag : tags) {
         output->addDependency(tag);
     }
     plan.addNode(std::move(output));
+    if (tagNodes != nullptr) {
+        *tagNodes = std::move(tags);
+    }
     return plan;
 }
 
@@ -253,19 +323,44 @@ GetPropProcessor::checkAndBuildContexts(const cpp2::GetPropRequest& req) {
     if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
         return code;
     }
+    auto* templates = this->env_->planTemplates_;
+    std::string templateKey;
+    // the requests asking for all tags or edges are not cached
+    bool all = isEdge_ ? (*req.edge_props_ref()).empty() : (*req.vertex_props_ref()).empty();
+    if (templates != nullptr && !all) {
+        // the shape is the props asked for
+        cpp2::GetPropRequest shape;
+        if (isEdge_) {
+            shape.set_edge_props(*req.edge_props_ref());
+        } else {
+            shape.set_vertex_props(*req.vertex_props_ref());
+        }
+        templateKey = PlanTemplateCache::key(spaceId_, "get_prop", shape);
+        auto tmpl = templates->get(templateKey, this->env_->schemaMan_, spaceId_);
+        if (tmpl != nullptr) {
+            PlanTemplateCache::apply(*tmpl, &tagContext_, &edgeContext_,
+                                     &resultDataSet_.colNames);
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        }
+    }
+
     if (!isEdge_) {
         code = getSpaceVertexSchema();
         if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
             return code;
         }
-        return buildTagContext(req);
+        code = buildTagContext(req);
     } else {
         code = getSpaceEdgeSchema();
         if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
             return code;
         }
-        return buildEdgeContext(req);
+        code = buildEdgeContext(req);
+    }
+    if (code == nebula::cpp2::ErrorCode::SUCCEEDED && !templateKey.empty()) {
+        templates->put(templateKey, tagContext_, edgeContext_, resultDataSet_.colNames);
     }
+    return code;
 }
 
 nebula::cpp2::ErrorCode GetPropProcessor::buildTagContext(const cpp2::GetPropRequest& req) {
@@ -11,6 +11,7 @@
 #include <gtest/gtest_prod.h>
 #include "storage/query/QueryBaseProcessor.h"
 #include "storage/exec/StoragePlan.h"
+#include "storage/exec/TagNode.h"
 
 namespace nebula {
 namespace storage {
@@ -43,7 +44,18 @@ protected:
                                                                           cache) {}
 
 private:
-    StoragePlan<VertexID> buildTagPlan(RunTimeContext* context, nebula::DataSet* result);
+    StoragePlan<VertexID> buildTagPlan(RunTimeContext* context,
+                                       nebula::DataSet* result,
+                                       std::vector<TagNode*>* tagNodes = nullptr);
+
+    // Run the tag plan of all vertices in a part. If failedParts is not null, the error of a
+    // vertex is handled and the remaining vertices go on, otherwise the error is returned.
+    // E_INVALID_VID is always returned.
+    nebula::cpp2::ErrorCode processTagRows(StoragePlan<VertexID>& plan,
+                                           const std::vector<TagNode*>& tags,
+                                           PartitionID partId,
+                                           const std::vector<nebula::Row>& rows,
+                                           std::unordered_set<PartitionID>* failedParts = nullptr);
 
     StoragePlan<cpp2::EdgeKey> buildEdgePlan(RunTimeContext* context, nebula::DataSet* result);
 
@@ -0,0 +1,91 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "storage/query/PlanTemplateCache.h"
+
+namespace nebula {
+namespace storage {
+
+std::shared_ptr<const PlanTemplateCache::Template>
+PlanTemplateCache::get(const std::string& key,
+                       meta::SchemaManager* schemaMan,
+                       GraphSpaceID spaceId) {
+    auto cached = cache_.get(key);
+    if (!cached.ok()) {
+        return nullptr;
+    }
+    auto tmpl = std::move(cached).value();
+    for (const auto& tag : tmpl->tagVers) {
+        auto ver = schemaMan->getLatestTagSchemaVersion(spaceId, tag.first);
+        if (!ver.ok() || ver.value() != tag.second) {
+            cache_.evict(key);
+            return nullptr;
+        }
+    }
+    for (const auto& edge : tmpl->edgeVers) {
+        auto ver = schemaMan->getLatestEdgeSchemaVersion(spaceId, edge.first);
+        if (!ver.ok() || ver.value() != edge.second) {
+            cache_.evict(key);
+            return nullptr;
+        }
+    }
+    return tmpl;
+}
+
+void PlanTemplateCache::put(const std::string& key,
+                            const TagContext& tagContext,
+                            const EdgeContext& edgeContext,
+                            const std::vector<std::string>& colNames) {
+    auto tmpl = std::make_shared<Template>();
+    tmpl->colNames = colNames;
+    tmpl->tagContext.propContexts_ = tagContext.propContexts_;
+    tmpl->tagContext.indexMap_ = tagContext.indexMap_;
+    tmpl->tagContext.tagNames_ = tagContext.tagNames_;
+    tmpl->tagContext.ttlInfo_ = tagContext.ttlInfo_;
+    for (const auto& tc : tagContext.propContexts_) {
+        auto tagId = tc.first;
+        auto schemas = tagContext.schemas_.find(tagId);
+        if (schemas == tagContext.schemas_.end() || schemas->second.empty()) {
+            return;
+        }
+        tmpl->tagContext.schemas_.emplace(tagId, schemas->second);
+        tmpl->tagVers.emplace_back(tagId, schemas->second.back()->getVersion());
+    }
+
+    tmpl->edgeContext = edgeContext;
+    tmpl->edgeContext.schemas_.clear();
+    std::set<EdgeType> edgeTypes;
+    for (const auto& ec : edgeContext.propContexts_) {
+        edgeTypes.emplace(std::abs(ec.first));
+    }
+    for (const auto& groupKey : edgeContext.statGroupKeys_) {
+        edgeTypes.emplace(std::abs(groupKey.edgeType_));
+    }
+    for (auto edgeType : edgeTypes) {
+        auto schemas = edgeContext.schemas_.find(edgeType);
+        if (schemas == edgeContext.schemas_.end() || schemas->second.empty()) {
+            return;
+        }
+        tmpl->edgeContext.schemas_.emplace(edgeType, schemas->second);
+        tmpl->edgeVers.emplace_back(edgeType, schemas->second.back()->getVersion());
+    }
+    cache_.insert(key, std::move(tmpl));
+}
+
+// static
+void PlanTemplateCache::apply(const Template& tmpl,
+                              TagContext* tagContext,
+                              EdgeContext* edgeContext,
+                              std::vector<std::string>* colNames) {
+    auto* vertexCache = tagContext->vertexCache_;
+    *tagContext = tmpl.tagContext;
+    tagContext->vertexCache_ = vertexCache;
+    *edgeContext = tmpl.edgeContext;
+    *colNames = tmpl.colNames;
+}
+
+}  // namespace storage
+}  // namespace nebula
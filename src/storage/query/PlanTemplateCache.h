@@ -0,0 +1,80 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef STORAGE_QUERY_PLANTEMPLATECACHE_H_
+#define STORAGE_QUERY_PLANTEMPLATECACHE_H_
+
+#include "common/base/Base.h"
+#include "common/base/ConcurrentLRUCache.h"
+#include "storage/query/QueryBaseProcessor.h"
+#include <thrift/lib/cpp2/protocol/Serializer.h>
+
+namespace nebula {
+namespace storage {
+
+/*
+PlanTemplateCache keeps the contexts a read processor builds from the request, keyed by the space
+and the shape of the request, which is the part of the request the contexts are built from, e.g.
+the traverse spec of GetNeighbors without the vertices. A request of a shape seen before copies
+the contexts of the template instead of looking up all the schemas of the space and building the
+prop contexts again. The plans are still built by each request, the nodes keep the state of the
+request.
+
+A template is stale once the latest schema version of any tag or edge it uses has changed, or the
+tag or edge has been dropped, which is checked by get. The requests asking for all the tags or
+edges are not cached, since they are changed by adding a tag or edge.
+*/
+class PlanTemplateCache final {
+public:
+    struct Template {
+        // the schemas are only of the tags and edges used, vertexCache_ is not kept
+        TagContext                                      tagContext;
+        EdgeContext                                     edgeContext;
+        std::vector<std::string>                        colNames;
+        // the latest schema version of each tag and edge used, of the schemas it was built by
+        std::vector<std::pair<TagID, SchemaVer>>        tagVers;
+        std::vector<std::pair<EdgeType, SchemaVer>>     edgeVers;
+    };
+
+    PlanTemplateCache(size_t capacity, uint32_t bucketsExp)
+        : cache_(capacity, bucketsExp) {}
+
+    // The key of the request shape, which is a thrift struct
+    template <typename T>
+    static std::string key(GraphSpaceID spaceId, const char* kind, const T& shape) {
+        std::string key;
+        key.append(reinterpret_cast<const char*>(&spaceId), sizeof(GraphSpaceID))
+           .append(kind)
+           .append(1, '\0');
+        apache::thrift::CompactSerializer::serialize(shape, &key);
+        return key;
+    }
+
+    // The template of the key if it is not stale, otherwise null
+    std::shared_ptr<const Template> get(const std::string& key,
+                                        meta::SchemaManager* schemaMan,
+                                        GraphSpaceID spaceId);
+
+    // Keep the contexts built as the template of the key
+    void put(const std::string& key,
+             const TagContext& tagContext,
+             const EdgeContext& edgeContext,
+             const std::vector<std::string>& colNames);
+
+    // Copy the contexts of the template into the processor, the vertex cache is kept
+    static void apply(const Template& tmpl,
+                      TagContext* tagContext,
+                      EdgeContext* edgeContext,
+                      std::vector<std::string>* colNames);
+
+private:
+    ConcurrentLRUCache<std::string, std::shared_ptr<const Template>> cache_;
+};
+
+}  // namespace storage
+}  // namespace nebula
+
+#endif  // STORAGE_QUERY_PLANTEMPLATECACHE_H_
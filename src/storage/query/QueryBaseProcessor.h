@@ -26,6 +26,7 @@
 #include "common/expression/PredicateExpression.h"
 #include "common/expression/ReduceExpression.h"
 #include "storage/BaseProcessor.h"
+#include "storage/exec/EdgeRankRange.h"
 
 namespace nebula {
 namespace storage {
@@ -117,6 +118,18 @@ struct TagContext {
 };
 
 
+// The key of grouped stat. The prop in edge key, e.g. `_type` or `_dst`, is read from edges of
+// all types, otherwise it is only read from the edge of edgeType_, and is NULL for other edges.
+struct StatGroupKey {
+    StatGroupKey(EdgeType edgeType, PropContext prop)
+        : edgeType_(edgeType)
+        , prop_(std::move(prop)) {}
+
+    EdgeType edgeType_;
+    PropContext prop_;
+};
+
+
 struct EdgeContext {
     // propContexts_, indexMap_, edgeNames_ will contain both +/- edges
     std::vector<std::pair<EdgeType, std::vector<PropContext>>> propContexts_;
@@ -134,6 +147,10 @@ struct EdgeContext {
     // offset is the start index of first edge type in a response row
     size_t                                                              offset_;
     size_t                                                              statCount_ = 0;
+    // if not empty, the stats of a vertex are grouped by them
+    std::vector<StatGroupKey>                                           statGroupKeys_;
+    // EdgeType -> the range of rank the filter allows, only the edges in it are read
+    std::unordered_map<EdgeType, EdgeRankRange>                         rankRanges_;
 };
 
 
@@ -42,11 +42,48 @@ private:
     nebula::cpp2::ErrorCode
     checkAndBuildContexts(const cpp2::ScanEdgeRequest& req) override;
 
+    // A part scanned in this page
+    struct PartScan {
+        PartitionID                 partId{0};
+        std::string                 cursor;
+        // the rows of the page for the part, the part is not scanned in the page if 0
+        int64_t                     rowLimit{0};
+        nebula::cpp2::ErrorCode     code{nebula::cpp2::ErrorCode::SUCCEEDED};
+        std::vector<Row>            rows;
+        // the cursor to continue, empty if the part is finished
+        std::string                 nextCursor;
+        PropIndexCache              propIndexCache;
+    };
+
+    // Scan the part from its cursor, at most rowLimit rows and maxBytes of keys and values
+    // read (0 means unlimited), which could run in parallel with the other parts
+    nebula::cpp2::ErrorCode scanPart(bool readFromFollower,
+                                     int64_t rowLimit,
+                                     int64_t maxBytes,
+                                     MemoryTracker* memory,
+                                     PartScan* scan);
+
+    // Scan the parts of the multi-part cursor, or all the parts the host leads for the first
+    // page, in parallel. The limits of the page are divided among the parts.
+    void scanMultiPart(const cpp2::ScanEdgeRequest& req);
+
+    // Merge the rows and the cursors of the parts scanned into the response
+    void finishMultiPart();
+
+    // Return the session of the cursor with its iterator at the cursor, a new session is
+    // created for the first page.
+    nebula::cpp2::ErrorCode openSession(bool readFromFollower,
+                                        PartitionID partId,
+                                        const std::string& cursor,
+                                        std::unique_ptr<ScanSession>* session);
+
     void buildEdgeColName(const std::vector<cpp2::EdgeProp>& edgeProps);
 
     void onProcessFinished() override;
 
     PartitionID partId_;
+    std::vector<PartScan> partScans_;
+    std::unique_ptr<MemoryTracker> memory_;
 };
 
 }  // namespace storage
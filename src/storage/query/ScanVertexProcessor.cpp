@@ -27,6 +27,7 @@ void ScanVertexProcessor::process(const cpp2::ScanVertexRequest& req) {
 void ScanVertexProcessor::doProcess(const cpp2::ScanVertexRequest& req) {
     spaceId_ = req.get_space_id();
     partId_ = req.get_part_id();
+    profile_ = RequestProfile::create("ScanVertex", spaceId_);
 
     auto retCode = getSpaceVidLen(spaceId_);
     if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
@@ -42,27 +43,162 @@ void ScanVertexProcessor::doProcess(const cpp2::ScanVertexRequest& req) {
         return;
     }
 
-    std::string start;
-    std::string prefix = NebulaKeyUtils::vertexPrefix(partId_);
-    if (req.get_cursor() == nullptr || req.get_cursor()->empty()) {
-        start = prefix;
-    } else {
-        start = *req.get_cursor();
+    if (FLAGS_scan_multi_part && partId_ == ScanSessionManager::kMultiPartId) {
+        scanMultiPart(req);
+        return;
     }
 
-    std::unique_ptr<kvstore::KVIterator> iter;
-    auto kvRet = env_->kvstore_->rangeWithPrefix(
-        spaceId_, partId_, start, prefix, &iter, req.get_enable_read_from_follower());
-    if (kvRet != nebula::cpp2::ErrorCode::SUCCEEDED) {
-        handleErrorCode(kvRet, spaceId_, partId_);
+    // the bytes read are held in the result until the response is sent
+    auto memory = MemoryTracker::forRequest(spaceId_);
+    PartScan scan;
+    scan.partId = partId_;
+    if (req.get_cursor() != nullptr) {
+        scan.cursor = *req.get_cursor();
+    }
+    retCode = scanPart(req.get_enable_read_from_follower(), req.get_limit(),
+                       FLAGS_scan_max_bytes_per_response, memory.get(), &scan);
+    if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        handleErrorCode(retCode, spaceId_, partId_);
         onFinished();
         return;
     }
 
-    auto rowLimit = req.get_limit();
+    resultDataSet_.rows = std::move(scan.rows);
+    resp_.set_has_next(!scan.nextCursor.empty());
+    if (!scan.nextCursor.empty()) {
+        resp_.set_next_cursor(std::move(scan.nextCursor));
+    }
+    if (profile_ != nullptr) {
+        profile_->setRows(resultDataSet_.rows.size());
+    }
+    onProcessFinished();
+    onFinished();
+}
+
+void ScanVertexProcessor::scanMultiPart(const cpp2::ScanVertexRequest& req) {
+    std::vector<std::pair<PartitionID, std::string>> cursors;
+    if (req.get_cursor() != nullptr && !req.get_cursor()->empty()) {
+        if (!ScanSessionManager::decodeMultiPartCursor(*req.get_cursor(), &cursors)) {
+            pushResultCode(nebula::cpp2::ErrorCode::E_INVALID_DATA, partId_);
+            onFinished();
+            return;
+        }
+    } else {
+        // the first page scans all the parts the host leads
+        std::unordered_map<GraphSpaceID, std::vector<meta::cpp2::LeaderInfo>> leaders;
+        env_->kvstore_->allLeader(leaders);
+        for (const auto& leader : leaders[spaceId_]) {
+            cursors.emplace_back(leader.get_part_id(), "");
+        }
+        std::sort(cursors.begin(), cursors.end());
+    }
+
+    partScans_.resize(cursors.size());
+    for (size_t i = 0; i < cursors.size(); i++) {
+        partScans_[i].partId = cursors[i].first;
+        partScans_[i].cursor = std::move(cursors[i].second);
+    }
+    // the limits of the page are shared by the parts, the first ones take the remainder of
+    // rows, so no more than limit rows are returned, and the parts left are in the next pages
+    auto parts = std::max<int64_t>(partScans_.size(), 1);
+    auto limit = std::max<int64_t>(req.get_limit(), 0);
+    for (size_t i = 0; i < partScans_.size(); i++) {
+        partScans_[i].rowLimit = limit / parts + (static_cast<int64_t>(i) < limit % parts);
+    }
+    auto maxBytes = FLAGS_scan_max_bytes_per_response > 0
+                  ? std::max<int64_t>(FLAGS_scan_max_bytes_per_response / parts, 1)
+                  : 0;
+    memory_ = MemoryTracker::forRequest(spaceId_);
+
+    auto readFromFollower = req.get_enable_read_from_follower();
+    if (executor_ == nullptr) {
+        for (auto& scan : partScans_) {
+            if (scan.rowLimit > 0) {
+                scan.code = scanPart(readFromFollower, scan.rowLimit, maxBytes, memory_.get(),
+                                     &scan);
+            }
+        }
+        finishMultiPart();
+        return;
+    }
+    std::vector<folly::Future<folly::Unit>> futures;
+    for (auto& scan : partScans_) {
+        if (scan.rowLimit <= 0) {
+            continue;
+        }
+        futures.emplace_back(folly::via(
+            env_->partExecutor(spaceId_, scan.partId, executor_),
+            [this, readFromFollower, maxBytes, scan = &scan] () {
+                scan->code = scanPart(readFromFollower, scan->rowLimit, maxBytes, memory_.get(),
+                                      scan);
+            }));
+    }
+    folly::collectAll(futures).via(executor_).thenTry([this] (auto&& t) {
+        CHECK(!t.hasException());
+        finishMultiPart();
+    });
+}
+
+void ScanVertexProcessor::finishMultiPart() {
+    std::vector<std::pair<PartitionID, std::string>> nextCursors;
+    for (auto& scan : partScans_) {
+        if (scan.code != nebula::cpp2::ErrorCode::SUCCEEDED || scan.rowLimit <= 0) {
+            // the part failed or not scanned is continued from its cursor in the next page
+            if (scan.code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                handleErrorCode(scan.code, spaceId_, scan.partId);
+            }
+            nextCursors.emplace_back(scan.partId, std::move(scan.cursor));
+            continue;
+        }
+        for (auto& row : scan.rows) {
+            resultDataSet_.rows.emplace_back(std::move(row));
+        }
+        if (!scan.nextCursor.empty()) {
+            nextCursors.emplace_back(scan.partId, std::move(scan.nextCursor));
+        }
+    }
+    resp_.set_has_next(!nextCursors.empty());
+    if (!nextCursors.empty()) {
+        resp_.set_next_cursor(ScanSessionManager::encodeMultiPartCursor(nextCursors));
+    }
+    if (profile_ != nullptr) {
+        profile_->setRows(resultDataSet_.rows.size());
+    }
+    onProcessFinished();
+    onFinished();
+}
+
+nebula::cpp2::ErrorCode ScanVertexProcessor::scanPart(bool readFromFollower,
+                                                      int64_t rowLimit,
+                                                      int64_t maxBytes,
+                                                      MemoryTracker* memory,
+                                                      PartScan* scan) {
+    // the seek of a new session is counted, where the deletes are skipped
+    ProfileSpan profileSpan(profile_, scan->partId);
+    std::unique_ptr<ScanSession> session;
+    auto retCode = openSession(readFromFollower, scan->partId, scan->cursor, &session);
+    if (retCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return retCode;
+    }
+    auto* iter = session->iter_.get();
+
+    // bytes read in this page, the page is cut off when it exceeds
+    int64_t readBytes = 0;
     RowReaderWrapper reader;
+    // the rows of the same tag or edge type have the same columns, reserve as many as the last
+    size_t rowSize = 0;
     for (int64_t rowCount = 0; iter->valid() && rowCount < rowLimit; iter->next()) {
+        if (maxBytes > 0 && readBytes >= maxBytes) {
+            break;
+        }
         auto key = iter->key();
+        auto kvBytes = key.size() + iter->val().size();
+        // over the memory limit, the rows read are returned with the cursor to continue, at
+        // least one row is read so that the scan always moves on
+        if (memory != nullptr && !memory->alloc(kvBytes) && readBytes > 0) {
+            break;
+        }
+        readBytes += kvBytes;
 
         auto tagId = NebulaKeyUtils::getTagId(spaceVidLen_, key);
         auto tagIter = tagContext_.indexMap_.find(tagId);
@@ -79,24 +215,86 @@ void ScanVertexProcessor::doProcess(const cpp2::ScanVertexRequest& req) {
         }
 
         nebula::List list;
+        list.values.reserve(rowSize);
         auto idx = tagIter->second;
         auto props = &(tagContext_.propContexts_[idx].second);
         if (!QueryUtils::collectVertexProps(key, spaceVidLen_, isIntId_,
-                                            reader.get(), props, list).ok()) {
+                                            reader.get(), props, list,
+                                            &scan->propIndexCache).ok()) {
             continue;
         }
-        resultDataSet_.rows.emplace_back(std::move(list));
+        rowSize = list.size();
+        scan->rows.emplace_back(std::move(list));
         rowCount++;
     }
 
+    scan->nextCursor.clear();
     if (iter->valid()) {
-        resp_.set_has_next(true);
-        resp_.set_next_cursor(iter->key().str());
-    } else {
-        resp_.set_has_next(false);
+        if (session->id_ >= 0) {
+            scan->nextCursor = ScanSessionManager::encodeCursor(session->id_, iter->key());
+            env_->scanSessions_->park(std::move(session));
+        } else {
+            scan->nextCursor = iter->key().str();
+        }
     }
-    onProcessFinished();
-    onFinished();
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
+}
+
+nebula::cpp2::ErrorCode
+ScanVertexProcessor::openSession(bool readFromFollower,
+                                 PartitionID partId,
+                                 const std::string& cursor,
+                                 std::unique_ptr<ScanSession>* result) {
+    bool hasCursor = !cursor.empty();
+    int64_t sessionId = -1;
+    std::string cursorKey;
+    if (hasCursor && !ScanSessionManager::decodeCursor(cursor, &sessionId, &cursorKey)) {
+        cursorKey = cursor;
+    }
+
+    std::unique_ptr<ScanSession> session;
+    auto* sessions = env_->scanSessions_;
+    if (sessions != nullptr) {
+        if (sessionId >= 0) {
+            session = sessions->take(spaceId_, partId, sessionId, readFromFollower);
+            if (session == nullptr) {
+                LOG(WARNING) << "Scan session " << sessionId << " of space " << spaceId_
+                             << " part " << partId << " is expired, "
+                             << "the rest data is read from a new snapshot";
+            }
+        }
+        if (session == nullptr) {
+            session = sessions->create(spaceId_, partId);
+        }
+        if (session != nullptr) {
+            session->readFromFollower_ = readFromFollower;
+        }
+    }
+    if (session != nullptr && session->iter_ != nullptr && session->iter_->valid() &&
+        session->iter_->key() == folly::StringPiece(cursorKey)) {
+        // continue the iterator of last page
+        *result = std::move(session);
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+    if (session == nullptr) {
+        // read the latest data without session
+        session = std::make_unique<ScanSession>(-1, spaceId_, partId, nullptr, nullptr);
+    }
+
+    session->iter_.reset();
+    session->prefix_ = NebulaKeyUtils::vertexPrefix(partId);
+    session->start_ = hasCursor ? cursorKey : session->prefix_;
+    auto kvRet = env_->kvstore_->rangeWithPrefix(spaceId_, partId,
+                                                 session->start_, session->prefix_,
+                                                 &session->iter_,
+                                                 readFromFollower,
+                                                 session->snapshot_,
+                                                 kvstore::ScanHint::kFullScan);
+    if (kvRet != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return kvRet;
+    }
+    *result = std::move(session);
+    return nebula::cpp2::ErrorCode::SUCCEEDED;
 }
 
 nebula::cpp2::ErrorCode
@@ -95,6 +95,70 @@ TEST(AddEdgesTest, MultiVersionTest) {
     checkAddEdgesData(req, env, 334, 2);
 }
 
+TEST(AddEdgesTest, ConcurrentlyTest) {
+    FLAGS_write_concurrently = true;
+    fs::TempDir rootPath("/tmp/AddEdgesTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    auto* processor = AddEdgesProcessor::instance(env, nullptr, threadPool.get());
+
+    LOG(INFO) << "Build AddEdgesRequest...";
+    cpp2::AddEdgesRequest req = mock::MockData::mockAddEdgesReq();
+
+    LOG(INFO) << "Test AddEdgesProcessor...";
+    auto fut = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(fut).get();
+    EXPECT_EQ(0, resp.result.failed_parts.size());
+
+    LOG(INFO) << "Check data in kv store...";
+    // The number of data in serve is 334
+    checkAddEdgesData(req, env, 334, 0);
+    FLAGS_write_concurrently = false;
+}
+
+TEST(AddEdgesTest, OneWayEdgeTest) {
+    FLAGS_one_way_edge_types = "1:101";
+    fs::TempDir rootPath("/tmp/AddEdgesTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+
+    auto* processor = AddEdgesProcessor::instance(env, nullptr);
+
+    LOG(INFO) << "Build AddEdgesRequest...";
+    cpp2::AddEdgesRequest req = mock::MockData::mockAddEdgesReq();
+
+    LOG(INFO) << "Test AddEdgesProcessor...";
+    auto fut = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(fut).get();
+    EXPECT_EQ(0, resp.result.failed_parts.size());
+
+    LOG(INFO) << "Check data in kv store...";
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1);
+    ASSERT_TRUE(vIdLen.ok());
+    int32_t outEdges = 0;
+    int32_t inEdges = 0;
+    for (const auto& part : req.get_parts()) {
+        auto prefix = NebulaKeyUtils::edgePrefix(part.first);
+        std::unique_ptr<kvstore::KVIterator> iter;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  env->kvstore_->prefix(1, part.first, prefix, &iter));
+        for (; iter->valid(); iter->next()) {
+            auto edgeType = NebulaKeyUtils::getEdgeType(vIdLen.value(), iter->key());
+            edgeType > 0 ? outEdges++ : inEdges++;
+        }
+    }
+    // only the out edges of serve are written
+    EXPECT_EQ(167, outEdges);
+    EXPECT_EQ(0, inEdges);
+    FLAGS_one_way_edge_types = "";
+}
+
 }  // namespace storage
 }  // namespace nebula
 
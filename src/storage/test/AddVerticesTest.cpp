@@ -96,6 +96,31 @@ TEST(AddVerticesTest, MultiVersionTest) {
     checkAddVerticesData(req, env, 81, 2);
 }
 
+TEST(AddVerticesTest, ConcurrentlyTest) {
+    FLAGS_write_concurrently = true;
+    fs::TempDir rootPath("/tmp/AddVerticesTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    auto* processor = AddVerticesProcessor::instance(env, nullptr, nullptr, threadPool.get());
+
+    LOG(INFO) << "Build AddVerticesRequest...";
+    cpp2::AddVerticesRequest req = mock::MockData::mockAddVerticesReq();
+
+    LOG(INFO) << "Test AddVerticesProcessor...";
+    auto fut = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(fut).get();
+    EXPECT_EQ(0, resp.result.failed_parts.size());
+
+    LOG(INFO) << "Check data in kv store...";
+    // The number of vertices is 81
+    checkAddVerticesData(req, env, 81, 0);
+    FLAGS_write_concurrently = false;
+}
+
 }  // namespace storage
 }  // namespace nebula
 
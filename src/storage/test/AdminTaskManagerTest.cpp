@@ -11,6 +11,9 @@
 #include <folly/executors/IOThreadPoolExecutor.h>
 #include "storage/admin/AdminTaskManager.h"
 
+DECLARE_uint32(max_concurrent_subtasks);
+DECLARE_uint32(max_io_subtasks);
+
 using namespace std::chrono_literals;   // NOLINT
 
 namespace nebula {
@@ -31,6 +34,9 @@ namespace storage {
  * 6. cancel some sub task
  *      6.1 cancel_a_task_before_all_sub_task_running
  *      6.2 cancel_a_task_while_some_sub_task_running
+ * 7. schedule
+ *      7.1 weighted_fair_schedule
+ *      7.2 resource_class_limit
  * */
 
 using ErrOrSubTasks = ErrorOr<nebula::cpp2::ErrorCode, std::vector<AdminSubTask>>;
@@ -61,8 +67,17 @@ struct HookableTask : public AdminTask {
         ctx_.taskId_ = id;
     }
 
+    void setPriority(TaskPriority pri) {
+        ctx_.pri_ = pri;
+    }
+
+    ResourceClass resourceClass() const override {
+        return resource;
+    }
+
     std::function<ErrOrSubTasks()> fGenSubTasks;
     std::vector<AdminSubTask> subTasks;
+    ResourceClass resource{ResourceClass::CPU};
 };
 
 // *** 0. basic component
@@ -811,6 +826,122 @@ TEST(TaskManagerTest, cancel_a_task_while_some_sub_task_running) {
     taskMgr->shutdown();
 }
 
+// *** 7. schedule
+TEST(TaskManagerTest, weighted_fair_schedule) {
+    auto concurrency = FLAGS_max_concurrent_subtasks;
+    FLAGS_max_concurrent_subtasks = 1;
+    auto taskMgr = AdminTaskManager::instance();
+    taskMgr->init();
+
+    std::mutex lock;
+    std::vector<char> order;
+    folly::Promise<int> pStart;
+    auto fStart = pStart.getFuture();
+    folly::Promise<int> pLow;
+    auto fLow = pLow.getFuture();
+    folly::Promise<int> pHigh;
+    auto fHigh = pHigh.getFuture();
+
+    auto vLow = std::make_shared<HookableTask>();
+    vLow->setJobId(++gJobId);
+    vLow->setPriority(TaskPriority::LO);
+    vLow->addSubTask([&]() {
+        fStart.wait();
+        std::lock_guard<std::mutex> g(lock);
+        order.emplace_back('L');
+        return suc;
+    });
+    for (int i = 0; i < 5; i++) {
+        vLow->addSubTask([&]() {
+            std::lock_guard<std::mutex> g(lock);
+            order.emplace_back('L');
+            return suc;
+        });
+    }
+    vLow->setCallback([&](nebula::cpp2::ErrorCode, nebula::meta::cpp2::StatisItem&) {
+        pLow.setValue(0);
+    });
+
+    auto vHigh = std::make_shared<HookableTask>();
+    vHigh->setJobId(++gJobId);
+    vHigh->setPriority(TaskPriority::HI);
+    for (int i = 0; i < 4; i++) {
+        vHigh->addSubTask([&]() {
+            std::lock_guard<std::mutex> g(lock);
+            order.emplace_back('H');
+            return suc;
+        });
+    }
+    vHigh->setCallback([&](nebula::cpp2::ErrorCode, nebula::meta::cpp2::StatisItem&) {
+        pHigh.setValue(0);
+    });
+
+    taskMgr->addAsyncTask(vLow);
+    taskMgr->addAsyncTask(vHigh);
+    // the first subtask of the low priority task is running when the other task comes
+    while (true) {
+        std::lock_guard<std::mutex> g(taskMgr->lock_);
+        if (taskMgr->running_.size() == 2) {
+            break;
+        }
+        usleep(1000);
+    }
+    pStart.setValue(0);
+    fLow.wait();
+    fHigh.wait();
+
+    ASSERT_EQ(10UL, order.size());
+    auto lastHigh = std::find(order.rbegin(), order.rend(), 'H').base();
+    auto lowBefore = std::count(order.begin(), lastHigh, 'L');
+    // the high priority task takes 4 subtasks for each one of the low priority task
+    EXPECT_LE(lowBefore, 2);
+
+    taskMgr->shutdown();
+    FLAGS_max_concurrent_subtasks = concurrency;
+}
+
+TEST(TaskManagerTest, resource_class_limit) {
+    auto taskMgr = AdminTaskManager::instance();
+    taskMgr->init();
+
+    auto runTask = [&](size_t numSubTasks) {
+        std::atomic<int> running{0};
+        std::atomic<int> maxRunning{0};
+        folly::Promise<int> pFinish;
+        auto fFinish = pFinish.getFuture();
+        auto vtask = std::make_shared<HookableTask>();
+        vtask->setJobId(++gJobId);
+        vtask->resource = ResourceClass::IO;
+        for (size_t i = 0; i < numSubTasks; i++) {
+            vtask->addSubTask([&]() {
+                auto now = ++running;
+                auto last = maxRunning.load();
+                while (now > last && !maxRunning.compare_exchange_weak(last, now)) {}
+                usleep(10000);
+                --running;
+                return suc;
+            });
+        }
+        vtask->setCallback([&](nebula::cpp2::ErrorCode, nebula::meta::cpp2::StatisItem&) {
+            pFinish.setValue(0);
+        });
+        taskMgr->addAsyncTask(vtask);
+        fFinish.wait();
+        return maxRunning.load();
+    };
+
+    FLAGS_max_io_subtasks = 2;
+    EXPECT_LE(runTask(8), 2);
+    FLAGS_max_io_subtasks = 0;
+
+    // only one subtask runs when the storage is busy
+    taskMgr->setBusyCheck([] { return true; });
+    EXPECT_EQ(1, runTask(4));
+    taskMgr->setBusyCheck(nullptr);
+
+    taskMgr->shutdown();
+}
+
 }  // namespace storage
 }  // namespace nebula
 
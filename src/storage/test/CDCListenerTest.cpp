@@ -0,0 +1,251 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include "utils/NebulaKeyUtils.h"
+#include <gtest/gtest.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include "codec/RowWriterV2.h"
+#include "kvstore/plugins/cdc/CDCListener.h"
+#include "kvstore/NebulaStore.h"
+#include "mock/AdHocSchemaManager.h"
+#include "mock/MockCluster.h"
+#include "mock/MockData.h"
+#include "storage/mutate/AddVerticesProcessor.h"
+#include "storage/mutate/DeleteVerticesProcessor.h"
+
+DECLARE_string(cdc_sink);
+DECLARE_int32(cdc_batch_size);
+
+namespace nebula {
+namespace kvstore {
+
+struct SinkState {
+    std::vector<CDCEvent> sent;
+    std::vector<CDCEvent> delivered;
+    LogID position{0};
+    int32_t sends{0};
+};
+
+// Deliver the events sent on commit, as a transaction
+class TestSink : public CDCSink {
+public:
+    explicit TestSink(SinkState* state) : state_(state) {}
+
+    bool send(const std::vector<CDCEvent>& events) override {
+        state_->sends++;
+        state_->sent.insert(state_->sent.end(), events.begin(), events.end());
+        return true;
+    }
+
+    bool commit(LogID position) override {
+        if (position > state_->position) {
+            state_->delivered.insert(state_->delivered.end(),
+                                     state_->sent.begin(),
+                                     state_->sent.end());
+            state_->position = position;
+        }
+        state_->sent.clear();
+        return true;
+    }
+
+    void abort() override {
+        state_->sent.clear();
+    }
+
+private:
+    SinkState* state_;
+};
+
+class TestCDCListener : public CDCListener {
+public:
+    using CDCListener::CDCListener;
+
+    ~TestCDCListener() override {
+        status_ = Status::STOPPED;
+    }
+
+    using CDCListener::init;
+    using CDCListener::apply;
+    using CDCListener::remove;
+    using CDCListener::persist;
+    using CDCListener::abortApply;
+    using CDCListener::lastCommittedLogId;
+    using CDCListener::lastApplyLogId;
+    using CDCListener::decodeLogs;
+};
+
+TEST(CDCListenerTest, EventsTest) {
+    fs::TempDir rootPath("/tmp/CDCListenerTest.XXXXXX");
+    GraphSpaceID spaceId = 1;
+    PartitionID partId = 1;
+    TagID tagId = 2;
+    EdgeType edgeType = 101;
+    size_t vIdLen = 32;
+
+    mock::AdHocSchemaManager schemaMan;
+    auto tagSchema = mock::MockData::mockTeamTagSchema();
+    schemaMan.addTagSchema(spaceId, tagId, tagSchema);
+    SinkState state;
+    CDCSink::registerSink("test", [&state] (GraphSpaceID, PartitionID) {
+        return std::make_unique<TestSink>(&state);
+    });
+    FLAGS_cdc_sink = "test";
+    FLAGS_cdc_batch_size = 2;
+
+    auto executor = std::make_shared<folly::CPUThreadPoolExecutor>(1);
+    TestCDCListener listener(spaceId, partId, HostAddr("", 0),
+                             folly::stringPrintf("%s/wal", rootPath.path()),
+                             nullptr, nullptr, executor, nullptr, nullptr, nullptr, &schemaMan);
+    listener.init();
+
+    RowWriterV2 writer(tagSchema.get());
+    ASSERT_EQ(WriteResult::SUCCEEDED, writer.setValue("name", "Spurs"));
+    ASSERT_EQ(WriteResult::SUCCEEDED, writer.finish());
+    std::vector<KV> data;
+    data.emplace_back(NebulaKeyUtils::vertexKey(vIdLen, partId, "Spurs", tagId),
+                      std::move(writer).moveEncodedStr());
+    // the edge schema is not added, the edge is sent without the props
+    data.emplace_back(NebulaKeyUtils::edgeKey(vIdLen, partId, "Tim", edgeType, 0, "Spurs"), "");
+    // the other keys are skipped
+    data.emplace_back(NebulaKeyUtils::systemCommitKey(partId), "");
+    ASSERT_TRUE(listener.apply(data));
+    ASSERT_TRUE(listener.remove({{NebulaKeyUtils::vertexKey(vIdLen, partId, "Tony", tagId), ""}}));
+    // a batch of 2 events is sent, the remove is pending
+    EXPECT_EQ(1, state.sends);
+    EXPECT_TRUE(state.delivered.empty());
+
+    ASSERT_TRUE(listener.persist(10, 1, 10));
+    ASSERT_EQ(3, state.delivered.size());
+    EXPECT_EQ(10, state.position);
+    {
+        const auto& event = state.delivered[0];
+        EXPECT_EQ(CDCEvent::Op::PUT, event.op);
+        EXPECT_FALSE(event.isEdge());
+        EXPECT_EQ(tagId, event.tagId);
+        EXPECT_EQ("Spurs", folly::StringPiece(event.vid).subpiece(0, 5));
+        EXPECT_EQ(Value("Spurs"), event.props.at("name"));
+    }
+    {
+        const auto& event = state.delivered[1];
+        EXPECT_EQ(CDCEvent::Op::PUT, event.op);
+        EXPECT_TRUE(event.isEdge());
+        EXPECT_EQ(edgeType, event.edgeType);
+        EXPECT_EQ("Spurs", folly::StringPiece(event.dst).subpiece(0, 5));
+        EXPECT_TRUE(event.props.empty());
+    }
+    EXPECT_EQ(CDCEvent::Op::REMOVE, state.delivered[2].op);
+
+    // the events of the logs aborted are never delivered
+    ASSERT_TRUE(listener.remove({{NebulaKeyUtils::vertexKey(vIdLen, partId, "Tim", tagId), ""}}));
+    listener.abortApply();
+    ASSERT_TRUE(listener.persist(10, 1, 10));
+    EXPECT_EQ(3, state.delivered.size());
+
+    EXPECT_EQ(10, listener.lastCommittedLogId().first);
+    EXPECT_EQ(1, listener.lastCommittedLogId().second);
+    EXPECT_EQ(10, listener.lastApplyLogId());
+    FLAGS_cdc_sink = "";
+    FLAGS_cdc_batch_size = 1024;
+}
+
+TEST(CDCListenerTest, DeleteVerticesTest) {
+    fs::TempDir rootPath("/tmp/CDCListenerDeleteTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    GraphSpaceID spaceId = 1;
+    TagID tagId = 1;
+    auto* schemaMan = dynamic_cast<mock::AdHocSchemaManager*>(cluster.schemaMan_.get());
+    ASSERT_NE(nullptr, schemaMan);
+    // the rows of the tags with a fulltext index are logged with the removes
+    schemaMan->addFTIndex(spaceId, tagId, "ft_player", meta::cpp2::FTIndex());
+
+    auto addReq = mock::MockData::mockAddVerticesReq();
+    {
+        auto* processor = storage::AddVerticesProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(addReq);
+        auto resp = std::move(fut).get();
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+    }
+
+    std::string vid;
+    PartitionID partId = 0;
+    for (const auto& part : addReq.get_parts()) {
+        for (const auto& vertex : part.second) {
+            if (vertex.get_tags().front().get_tag_id() == tagId) {
+                vid = vertex.get_id().getStr();
+                partId = part.first;
+                break;
+            }
+        }
+        if (!vid.empty()) {
+            break;
+        }
+    }
+    ASSERT_FALSE(vid.empty());
+    {
+        storage::cpp2::DeleteVerticesRequest req;
+        req.set_space_id(spaceId);
+        (*req.parts_ref())[partId].emplace_back(vid);
+        auto* processor = storage::DeleteVerticesProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+    }
+
+    SinkState state;
+    CDCSink::registerSink("delete", [&state] (GraphSpaceID, PartitionID) {
+        return std::make_unique<TestSink>(&state);
+    });
+    FLAGS_cdc_sink = "delete";
+    auto executor = std::make_shared<folly::CPUThreadPoolExecutor>(1);
+    TestCDCListener listener(spaceId, partId, HostAddr("", 0),
+                             folly::stringPrintf("%s/listener", rootPath.path()),
+                             nullptr, nullptr, executor, nullptr, nullptr, nullptr, schemaMan);
+    listener.init();
+
+    // apply the logs of the part in the wal, like the listener of the part
+    auto partRet = env->kvstore_->part(spaceId, partId);
+    ASSERT_TRUE(nebula::ok(partRet));
+    auto wal = nebula::value(partRet)->wal();
+    LogID lastApplyId = wal->firstLogId() - 1;
+    while (lastApplyId < wal->lastLogId()) {
+        auto iter = wal->iterator(lastApplyId + 1, wal->lastLogId());
+        std::vector<KV> data;
+        std::vector<KV> removes;
+        lastApplyId = listener.decodeLogs(iter.get(), 1024, &data, &removes);
+        ASSERT_TRUE(listener.apply(data));
+        ASSERT_TRUE(listener.remove(removes));
+    }
+    ASSERT_TRUE(listener.persist(lastApplyId, 1, lastApplyId));
+
+    std::vector<CDCEvent> removed;
+    for (const auto& event : state.delivered) {
+        if (event.op == CDCEvent::Op::REMOVE) {
+            removed.emplace_back(event);
+        }
+    }
+    ASSERT_EQ(1, removed.size());
+    EXPECT_EQ(tagId, removed[0].tagId);
+    EXPECT_EQ(vid, folly::StringPiece(removed[0].vid).subpiece(0, vid.size()));
+    EXPECT_EQ(Value(vid), removed[0].props.at("name"));
+    FLAGS_cdc_sink = "";
+}
+
+}  // namespace kvstore
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
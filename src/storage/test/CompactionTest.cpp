@@ -13,6 +13,7 @@
 #include "storage/test/QueryTestUtils.h"
 #include "storage/test/TestUtils.h"
 #include "codec/RowWriterV2.h"
+#include "codec/test/RowWriterV1.h"
 #include "mock/AdHocSchemaManager.h"
 #include "mock/AdHocIndexManager.h"
 #include "mock/MockCluster.h"
@@ -499,6 +500,65 @@ TEST(CompactionFilterTest, TTLFilterDataIndexNotExpiredTest) {
     FLAGS_mock_ttl_col = false;
 }
 
+TEST(CompactionFilterTest, RewriteV1RowsTest) {
+    fs::TempDir rootPath("/tmp/CompactionFilterTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path(), HostAddr("", 0),
+                          1, true, false, {}, true);
+    auto* env = cluster.storageEnv_.get();
+    GraphSpaceID spaceId = 1;
+    PartitionID partId = 1;
+    TagID tagId = 3;
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(spaceId).value();
+
+    auto schemaV1 = env->schemaMan_->getTagSchema(spaceId, tagId, 0);
+    RowWriterV1 writer(schemaV1.get());
+    writer << true << 1L << 1.1F << 1.1F << "row1";
+    auto key = NebulaKeyUtils::vertexKey(vIdLen, partId, "v1", tagId);
+    {
+        std::vector<kvstore::KV> data;
+        data.emplace_back(key, writer.encode());
+        folly::Baton<true, std::atomic> baton;
+        env->kvstore_->asyncMultiPut(spaceId, partId, std::move(data),
+                                     [&] (nebula::cpp2::ErrorCode code) {
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+    // the reader version of the row, and its values
+    auto readRow = [&] (int32_t* readerVer) {
+        std::string val;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  env->kvstore_->get(spaceId, partId, key, &val));
+        SchemaVer schemaVer;
+        RowReaderWrapper::getVersions(val, schemaVer, *readerVer);
+        EXPECT_EQ(0, schemaVer);
+        auto reader = RowReaderWrapper::getTagPropReader(env->schemaMan_, spaceId, tagId, val);
+        EXPECT_TRUE(reader != nullptr);
+        std::vector<Value> values;
+        for (size_t i = 0; i < reader->numFields(); i++) {
+            values.emplace_back(reader->getValueByIndex(i));
+        }
+        return values;
+    };
+    int32_t readerVer = 0;
+    auto expected = readRow(&readerVer);
+    EXPECT_EQ(1, readerVer);
+
+    auto* ns = dynamic_cast<kvstore::NebulaStore*>(env->kvstore_);
+    // kept in V1 unless the rewrite is enabled
+    ns->compact(spaceId);
+    EXPECT_EQ(expected, readRow(&readerVer));
+    EXPECT_EQ(1, readerVer);
+
+    FLAGS_rewrite_v1_rows_on_compaction = true;
+    ns->compact(spaceId);
+    EXPECT_EQ(expected, readRow(&readerVer));
+    EXPECT_EQ(2, readerVer);
+    FLAGS_rewrite_v1_rows_on_compaction = false;
+}
+
 }  // namespace storage
 }  // namespace nebula
 
@@ -12,6 +12,8 @@
 #include <rocksdb/db.h>
 #include "storage/mutate/DeleteVerticesProcessor.h"
 #include "storage/mutate/AddVerticesProcessor.h"
+#include "kvstore/LogEncoder.h"
+#include "kvstore/LogEncoder.h"
 #include "utils/NebulaKeyUtils.h"
 #include "mock/MockCluster.h"
 #include "mock/MockData.h"
@@ -64,6 +66,30 @@ TEST(DeleteVerticesTest, SimpleTest) {
 
         // All the added datas are deleted, the number of vertices is 0
         checkVerticesData(spaceVidLen, req.get_space_id(), *req.parts_ref(), env, 0);
+
+        // The tags are removed by their keys, rather than by a range tombstone of each vertex
+        size_t removed = 0;
+        for (const auto& part : *req.parts_ref()) {
+            auto partRet = env->kvstore_->part(req.get_space_id(), part.first);
+            ASSERT_TRUE(nebula::ok(partRet));
+            auto wal = nebula::value(partRet)->wal();
+            auto iter = wal->iterator(wal->firstLogId(), wal->lastLogId());
+            for (; iter->valid(); ++(*iter)) {
+                auto log = iter->logMsg();
+                if (log.size() <= sizeof(int64_t) ||
+                    log[sizeof(int64_t)] != kvstore::OP_BATCH_WRITE) {
+                    continue;
+                }
+                for (const auto& op : kvstore::decodeBatchValue(log)) {
+                    EXPECT_NE(kvstore::BatchLogType::OP_BATCH_REMOVE_RANGE, op.first);
+                    if (op.first == kvstore::BatchLogType::OP_BATCH_REMOVE &&
+                        NebulaKeyUtils::isVertex(spaceVidLen, op.second.first)) {
+                        removed++;
+                    }
+                }
+            }
+        }
+        EXPECT_EQ(81, removed);
     }
 }
 
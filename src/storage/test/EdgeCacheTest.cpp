@@ -0,0 +1,205 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include "storage/query/GetNeighborsProcessor.h"
+#include "storage/mutate/AddEdgesProcessor.h"
+#include "storage/mutate/DeleteEdgesProcessor.h"
+#include "storage/test/QueryTestUtils.h"
+#include "mock/MockCluster.h"
+#include "mock/MockData.h"
+
+namespace nebula {
+namespace storage {
+
+// return the serve edges of given vertices
+std::vector<Value> getServes(StorageEnv* env,
+                             int32_t totalParts,
+                             const std::vector<VertexID>& vertices) {
+    TagID player = 1;
+    EdgeType serve = 101;
+    std::vector<EdgeType> over = {serve};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+    tags.emplace_back(player, std::vector<std::string>{"name"});
+    edges.emplace_back(serve, std::vector<std::string>{"teamName", "startYear", kDst});
+    auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+
+    auto* processor = GetNeighborsProcessor::instance(env, nullptr, nullptr);
+    auto fut = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(fut).get();
+    EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+    std::vector<Value> result;
+    for (const auto& row : (*resp.vertices_ref()).rows) {
+        // vId, stat, player, serve, expr
+        EXPECT_EQ(5, row.values.size());
+        if (row.values[3].isList()) {
+            for (const auto& edge : row.values[3].getList().values) {
+                result.emplace_back(edge);
+            }
+        }
+    }
+    return result;
+}
+
+void checkCache(EdgeCache* cache, uint64_t hits, uint64_t total) {
+    EXPECT_EQ(hits, cache->hits());
+    EXPECT_EQ(total, cache->total());
+}
+
+TEST(EdgeCacheTest, SimpleTest) {
+    fs::TempDir rootPath("/tmp/EdgeCacheTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+
+    std::vector<VertexID> vertices = {"Tracy McGrady"};
+    auto expected = getServes(env, totalParts, vertices);
+    ASSERT_FALSE(expected.empty());
+
+    EdgeCache cache(1000, 0);
+    env->edgeCache_ = &cache;
+    FLAGS_enable_edge_cache = true;
+
+    // The first query puts the edges into cache, the second one hits it
+    ASSERT_EQ(expected, getServes(env, totalParts, vertices));
+    checkCache(&cache, 0, 1);
+    ASSERT_EQ(expected, getServes(env, totalParts, vertices));
+    checkCache(&cache, 1, 2);
+
+    // Delete edges will evict the cache
+    {
+        auto* processor = DeleteEdgesProcessor::instance(env, nullptr);
+        auto req = mock::MockData::mockDeleteEdgesReq(totalParts);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        ASSERT_EQ(0, (*resp.result_ref()).failed_parts.size());
+    }
+    auto afterDelete = getServes(env, totalParts, vertices);
+    ASSERT_NE(expected, afterDelete);
+    checkCache(&cache, 1, 3);
+    ASSERT_EQ(afterDelete, getServes(env, totalParts, vertices));
+    checkCache(&cache, 2, 4);
+
+    // Add edges will evict the cache
+    {
+        auto* processor = AddEdgesProcessor::instance(env, nullptr);
+        auto req = mock::MockData::mockAddEdgesReq(false, totalParts);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        ASSERT_EQ(0, (*resp.result_ref()).failed_parts.size());
+    }
+    auto afterAdd = getServes(env, totalParts, vertices);
+    ASSERT_FALSE(afterAdd.empty());
+    ASSERT_NE(afterDelete, afterAdd);
+    checkCache(&cache, 2, 5);
+
+    FLAGS_enable_edge_cache = false;
+    ASSERT_EQ(afterAdd, getServes(env, totalParts, vertices));
+    checkCache(&cache, 2, 5);
+    env->edgeCache_ = nullptr;
+}
+
+TEST(EdgeCacheTest, WriteWithoutEvictTest) {
+    fs::TempDir rootPath("/tmp/EdgeCacheTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+
+    std::vector<VertexID> vertices = {"Tracy McGrady"};
+    auto expected = getServes(env, totalParts, vertices);
+    ASSERT_FALSE(expected.empty());
+
+    EdgeCache cache(1000, 0);
+    env->edgeCache_ = &cache;
+    FLAGS_enable_edge_cache = true;
+    ASSERT_EQ(expected, getServes(env, totalParts, vertices));
+    ASSERT_EQ(expected, getServes(env, totalParts, vertices));
+    checkCache(&cache, 1, 2);
+
+    // Remove the edges through kvstore, which evicts nothing, as a follower applies the logs
+    {
+        GraphSpaceID spaceId = 1;
+        EdgeType serve = 101;
+        auto vIdLen = env->schemaMan_->getSpaceVidLen(spaceId);
+        ASSERT_TRUE(vIdLen.ok());
+        PartitionID partId = (std::hash<std::string>()(vertices[0]) % totalParts) + 1;
+        auto prefix = NebulaKeyUtils::edgePrefix(vIdLen.value(), partId, vertices[0], serve);
+        std::unique_ptr<kvstore::KVIterator> iter;
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  env->kvstore_->prefix(spaceId, partId, prefix, &iter));
+        std::vector<std::string> keys;
+        for (; iter->valid(); iter->next()) {
+            keys.emplace_back(iter->key().str());
+        }
+        ASSERT_FALSE(keys.empty());
+        folly::Baton<true, std::atomic> baton;
+        env->kvstore_->asyncMultiRemove(spaceId, partId, std::move(keys),
+                                        [&] (nebula::cpp2::ErrorCode code) {
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    }
+    // The entry cached is at a stale write version, which is never used again
+    ASSERT_TRUE(getServes(env, totalParts, vertices).empty());
+
+    FLAGS_enable_edge_cache = false;
+    env->edgeCache_ = nullptr;
+}
+
+TEST(EdgeCacheTest, TooManyEdgesTest) {
+    fs::TempDir rootPath("/tmp/EdgeCacheTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+
+    // Tracy McGrady has more than one serve edges
+    std::vector<VertexID> vertices = {"Tracy McGrady"};
+    auto expected = getServes(env, totalParts, vertices);
+    ASSERT_LT(1, expected.size());
+
+    EdgeCache cache(1000, 0);
+    env->edgeCache_ = &cache;
+    FLAGS_enable_edge_cache = true;
+    auto defaultVal = FLAGS_edge_cache_max_edges;
+    FLAGS_edge_cache_max_edges = 1;
+
+    // The edges are not cached, but the result must be the same
+    ASSERT_EQ(expected, getServes(env, totalParts, vertices));
+    checkCache(&cache, 0, 1);
+    // hit the null entry, read from kvstore directly
+    ASSERT_EQ(expected, getServes(env, totalParts, vertices));
+    checkCache(&cache, 1, 2);
+
+    FLAGS_edge_cache_max_edges = defaultVal;
+    FLAGS_enable_edge_cache = false;
+    env->edgeCache_ = nullptr;
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -8,8 +8,12 @@
 #include "common/fs/TempDir.h"
 #include <gtest/gtest.h>
 #include "storage/query/GetNeighborsProcessor.h"
+#include "storage/exec/ParallelEdgeIterator.h"
+#include "storage/exec/SampledEdgeIterator.h"
 #include "storage/test/QueryTestUtils.h"
 
+DECLARE_bool(enable_degree_counters);
+
 namespace nebula {
 namespace storage {
 ObjectPool objPool;
@@ -578,6 +582,87 @@ TEST(GetNeighborsTest, StatTest) {
     }
 }
 
+TEST(GetNeighborsTest, StatGroupTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    TagID player = 1;
+    EdgeType serve = 101;
+    auto serveName = folly::to<std::string>(serve);
+
+    auto query = [&] (const Expression& groupBy) {
+        std::vector<VertexID> vertices = {"LeBron James"};
+        std::vector<EdgeType> over = {serve};
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        tags.emplace_back(player, std::vector<std::string>{"name"});
+        edges.emplace_back(serve, std::vector<std::string>{"teamName"});
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        std::vector<cpp2::StatProp> statProps;
+        {
+            cpp2::StatProp statProp;
+            statProp.set_alias("count");
+            const auto& exp = *EdgePropertyExpression::make(pool, serveName, "teamGames");
+            statProp.set_prop(Expression::encode(exp));
+            statProp.set_stat(cpp2::StatType::COUNT);
+            statProps.emplace_back(std::move(statProp));
+        }
+        {
+            cpp2::StatProp statProp;
+            statProp.set_alias("games");
+            const auto& exp = *EdgePropertyExpression::make(pool, serveName, "teamGames");
+            statProp.set_prop(Expression::encode(exp));
+            statProp.set_stat(cpp2::StatType::SUM);
+            statProps.emplace_back(std::move(statProp));
+        }
+        {
+            cpp2::StatProp statProp;
+            statProp.set_alias("score");
+            const auto& exp = *EdgePropertyExpression::make(pool, serveName, "teamAvgScore");
+            statProp.set_prop(Expression::encode(exp));
+            statProp.set_stat(cpp2::StatType::AVG);
+            statProps.emplace_back(std::move(statProp));
+        }
+        (*req.traverse_spec_ref()).set_stat_props(std::move(statProps));
+        cpp2::Expr groupKey;
+        groupKey.set_alias("team");
+        groupKey.set_expr(Expression::encode(groupBy));
+        (*req.traverse_spec_ref()).set_expressions({std::move(groupKey)});
+
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        EXPECT_EQ("_stats:team:count:games:score", (*resp.vertices_ref()).colNames[1]);
+        EXPECT_EQ(1, (*resp.vertices_ref()).rows.size());
+        auto groups = (*resp.vertices_ref()).rows[0].values[1].getList().values;
+        std::sort(groups.begin(), groups.end());
+        return groups;
+    };
+
+    // group by the team name in value and the dst in key, they are the same for serve
+    std::vector<Value> expected = {
+        nebula::List({"Cavaliers", 2, 548 + 301, (29.7 + 27.5) / 2}),
+        nebula::List({"Heat", 1, 294, 27.1}),
+        nebula::List({"Lakers", 1, 115, 25.7}),
+    };
+    ASSERT_EQ(expected, query(*EdgePropertyExpression::make(pool, serveName, "teamName")));
+    ASSERT_EQ(expected, query(*EdgeDstIdExpression::make(pool, serveName)));
+
+    // group by edge type, there is only one group
+    expected = {
+        nebula::List({serve, 4, 548 + 294 + 301 + 115, (29.7 + 27.1 + 27.5 + 25.7) / 4}),
+    };
+    ASSERT_EQ(expected, query(*EdgeTypeExpression::make(pool, serveName)));
+}
+
 TEST(GetNeighborsTest, LimitSampleTest) {
     fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
     mock::MockCluster cluster;
@@ -726,6 +811,155 @@ TEST(GetNeighborsTest, LimitSampleTest) {
     }
 }
 
+TEST(GetNeighborsTest, DedupDstTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    TagID player = 1;
+    EdgeType serve = 101;
+    EdgeType teammate = 102;
+
+    // "Tim Duncan" is sent twice, all edges of the second one are skipped
+    std::vector<VertexID> vertices = {"Tim Duncan", "Tony Parker", "Manu Ginobili",
+                                      "LaMarcus Aldridge", "Tim Duncan", "Kobe Bryant"};
+    auto query = [&] (bool dedup, const std::vector<std::string>& props) {
+        std::vector<EdgeType> over = {serve, teammate};
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        tags.emplace_back(player, std::vector<std::string>{"name"});
+        edges.emplace_back(serve, props);
+        edges.emplace_back(teammate, props);
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        (*req.traverse_spec_ref()).set_dedup(dedup);
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        return std::move(*resp.vertices_ref());
+    };
+
+    auto defaultVal = FLAGS_get_neighbors_block_size;
+    for (auto blockSize : {0, 1024}) {
+        LOG(INFO) << "Block size " << blockSize;
+        FLAGS_get_neighbors_block_size = blockSize;
+        // the edges are not distinct rows with other props, which are never deduped
+        auto withProps = query(false, {kDst, "teamName"});
+        ASSERT_EQ(withProps, query(true, {kDst, "teamName"}));
+
+        auto all = query(false, {kDst});
+        auto deduped = query(true, {kDst});
+        ASSERT_EQ(vertices.size(), all.rows.size());
+        ASSERT_EQ(all.rows.size(), deduped.rows.size());
+
+        // only the first edge to each dst of the same part is kept
+        std::hash<std::string> hash;
+        std::unordered_map<PartitionID, std::unordered_set<Value>> dsts;
+        size_t allEdges = 0, dedupedEdges = 0;
+        for (size_t i = 0; i < all.rows.size(); i++) {
+            ASSERT_EQ(all.rows[i].values[0], deduped.rows[i].values[0]);
+            PartitionID partId = (hash(all.rows[i].values[0].getStr()) % totalParts) + 1;
+            auto& partDsts = dsts[partId];
+            // vId, stat, player, serve, teammate, expr
+            for (size_t col = 3; col < 5; col++) {
+                std::vector<Value> expected;
+                if (all.rows[i].values[col].isList()) {
+                    for (const auto& edge : all.rows[i].values[col].getList().values) {
+                        allEdges++;
+                        if (partDsts.emplace(edge.getList().values[0]).second) {
+                            expected.emplace_back(edge);
+                        }
+                    }
+                }
+                std::vector<Value> actual;
+                if (deduped.rows[i].values[col].isList()) {
+                    actual = deduped.rows[i].values[col].getList().values;
+                }
+                dedupedEdges += actual.size();
+                EXPECT_EQ(expected, actual);
+            }
+        }
+        EXPECT_LT(dedupedEdges, allEdges);
+    }
+    FLAGS_get_neighbors_block_size = defaultVal;
+}
+
+TEST(GetNeighborsTest, QueryBudgetTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    TagID team = 2;
+    EdgeType serve = 101;
+    std::vector<VertexID> vertices = {"Spurs"};
+    std::vector<EdgeType> over = {-serve};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+    tags.emplace_back(team, std::vector<std::string>{"name"});
+    edges.emplace_back(-serve, std::vector<std::string>{"playerName", "startYear"});
+    auto getNeighbors = [&] () {
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        return std::move(fut).get();
+    };
+
+    size_t total = 0;
+    {
+        LOG(INFO) << "NoBudget";
+        auto resp = getNeighbors();
+        ASSERT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        ASSERT_EQ(1, (*resp.vertices_ref()).rows.size());
+        total = (*resp.vertices_ref()).rows[0].values[3].getList().values.size();
+        ASSERT_LT(5, total);
+    }
+    {
+        LOG(INFO) << "MaxScannedKeys";
+        FLAGS_query_max_scanned_keys = 5;
+        auto resp = getNeighbors();
+        FLAGS_query_max_scanned_keys = 0;
+        // the edges scanned before the budget is exhausted are returned
+        ASSERT_EQ(1, (*resp.result_ref()).failed_parts.size());
+        ASSERT_EQ(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT,
+                  (*resp.result_ref()).failed_parts[0].get_code());
+        ASSERT_EQ(1, (*resp.vertices_ref()).rows.size());
+        ASSERT_EQ(5, (*resp.vertices_ref()).rows[0].values[3].getList().values.size());
+    }
+    {
+        LOG(INFO) << "MaxScannedBytes";
+        FLAGS_query_max_scanned_bytes = 1;
+        auto resp = getNeighbors();
+        FLAGS_query_max_scanned_bytes = 0;
+        ASSERT_EQ(1, (*resp.result_ref()).failed_parts.size());
+        ASSERT_EQ(nebula::cpp2::ErrorCode::E_PARTIAL_RESULT,
+                  (*resp.result_ref()).failed_parts[0].get_code());
+        ASSERT_EQ(1, (*resp.vertices_ref()).rows.size());
+        ASSERT_TRUE((*resp.vertices_ref()).rows[0].values[3].empty());
+    }
+    {
+        LOG(INFO) << "LargeBudget";
+        FLAGS_query_max_scanned_keys = 10000;
+        FLAGS_query_timeout_ms = 60 * 1000;
+        auto resp = getNeighbors();
+        FLAGS_query_max_scanned_keys = 0;
+        FLAGS_query_timeout_ms = 0;
+        ASSERT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        ASSERT_EQ(total, (*resp.vertices_ref()).rows[0].values[3].getList().values.size());
+    }
+}
+
 TEST(GetNeighborsTest, MaxEdgReturnedPerVertexTest) {
     fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
     mock::MockCluster cluster;
@@ -882,6 +1116,409 @@ TEST(GetNeighborsTest, MaxEdgReturnedPerVertexTest) {
 }
 
 
+TEST(GetNeighborsTest, PropBlockTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    TagID player = 1;
+    EdgeType serve = 101;
+    EdgeType teammate = 102;
+
+    std::vector<VertexID> vertices = {"Tim Duncan", "Tony Parker", "Dwyane Wade"};
+    std::vector<EdgeType> over = {serve, -serve, teammate};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+    tags.emplace_back(player, std::vector<std::string>{"name", "age", "avgScore"});
+    edges.emplace_back(serve, std::vector<std::string>{"teamName", "startYear", kDst});
+    edges.emplace_back(-serve, std::vector<std::string>{"playerName", "teamCareer", kSrc});
+    edges.emplace_back(teammate, std::vector<std::string>{"player1", "player2", kRank});
+
+    auto query = [&] () {
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        auto result = std::move(*resp.vertices_ref());
+        std::sort(result.rows.begin(), result.rows.end(), [] (const auto& a, const auto& b) {
+            return a.values[0] < b.values[0];
+        });
+        return result;
+    };
+
+    auto defaultVal = FLAGS_get_neighbors_block_size;
+    FLAGS_get_neighbors_block_size = 0;
+    auto expected = query();
+    // vId, stat, player, serve, -serve, teammate, expr
+    QueryTestUtils::checkResponse(expected, vertices, over, tags, edges, 3, 7);
+
+    for (auto blockSize : {1, 2, 3, 1024}) {
+        LOG(INFO) << "Block size " << blockSize;
+        FLAGS_get_neighbors_block_size = blockSize;
+        ASSERT_EQ(expected, query());
+    }
+    FLAGS_get_neighbors_block_size = defaultVal;
+}
+
+TEST(GetNeighborsTest, ColumnarEdgesTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    TagID player = 1;
+    EdgeType serve = 101;
+    EdgeType teammate = 102;
+
+    std::vector<VertexID> vertices = {"Tim Duncan", "Tony Parker", "Dwyane Wade"};
+    std::vector<EdgeType> over = {serve, -serve, teammate};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+    tags.emplace_back(player, std::vector<std::string>{"name", "age", "avgScore"});
+    edges.emplace_back(serve, std::vector<std::string>{"teamName", "startYear", kDst});
+    edges.emplace_back(-serve, std::vector<std::string>{"playerName", "teamCareer", kSrc});
+    edges.emplace_back(teammate, std::vector<std::string>{"player1", "player2", kRank});
+
+    auto query = [&] () {
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        auto result = std::move(*resp.vertices_ref());
+        std::sort(result.rows.begin(), result.rows.end(), [] (const auto& a, const auto& b) {
+            return a.values[0] < b.values[0];
+        });
+        return result;
+    };
+
+    auto expected = query();
+    // vId, stat, player, serve, -serve, teammate, expr
+    QueryTestUtils::checkResponse(expected, vertices, over, tags, edges, 3, 7);
+
+    for (auto blockSize : {0, 2, 1024}) {
+        LOG(INFO) << "Block size " << blockSize;
+        auto defaultVal = FLAGS_get_neighbors_block_size;
+        FLAGS_get_neighbors_block_size = blockSize;
+        FLAGS_get_neighbors_columnar_edges = true;
+        auto result = query();
+        FLAGS_get_neighbors_columnar_edges = false;
+        FLAGS_get_neighbors_block_size = defaultVal;
+
+        ASSERT_EQ(expected.colNames.size(), result.colNames.size());
+        for (size_t i = 3; i < 6; i++) {
+            ASSERT_EQ("_edge_col:" + expected.colNames[i].substr(strlen("_edge:")),
+                      result.colNames[i]);
+        }
+        ASSERT_EQ(expected.rows.size(), result.rows.size());
+        for (size_t row = 0; row < expected.rows.size(); row++) {
+            for (size_t col = 0; col < expected.rows[row].values.size(); col++) {
+                const auto& cell = result.rows[row].values[col];
+                if (col < 3 || col >= 6 || !cell.isList()) {
+                    ASSERT_EQ(expected.rows[row].values[col], cell);
+                    continue;
+                }
+                std::vector<nebula::List> decoded;
+                ASSERT_TRUE(PropBlock::decodeColumnar(cell.getList(), &decoded));
+                nebula::List edgeList;
+                for (auto& edge : decoded) {
+                    edgeList.values.emplace_back(std::move(edge));
+                }
+                ASSERT_EQ(expected.rows[row].values[col], Value(std::move(edgeList)));
+            }
+        }
+    }
+}
+
+TEST(GetNeighborsTest, SuperVertexParallelScanTest) {
+    // a super vertex is told by the degree counters
+    FLAGS_enable_degree_counters = true;
+    SCOPE_EXIT {
+        FLAGS_enable_degree_counters = false;
+    };
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+    auto edgeScanPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    TagID team = 2;
+    EdgeType serve = 101;
+
+    std::vector<VertexID> vertices = {"Spurs", "Lakers"};
+    std::vector<EdgeType> over = {-serve};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+    tags.emplace_back(team, std::vector<std::string>{"name"});
+    edges.emplace_back(-serve, std::vector<std::string>{
+                       "playerName", "startYear", "teamCareer", kDst});
+
+    auto query = [&] () {
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        auto result = std::move(*resp.vertices_ref());
+        std::sort(result.rows.begin(), result.rows.end(), [] (const auto& a, const auto& b) {
+            return a.values[0] < b.values[0];
+        });
+        return result;
+    };
+
+    auto expected = query();
+    // vId, stat, team, -serve, expr
+    QueryTestUtils::checkResponse(expected, vertices, over, tags, edges, 2, 5);
+
+    auto defaultThreshold = FLAGS_super_vertex_edge_threshold;
+    auto defaultParallelism = FLAGS_super_vertex_scan_parallelism;
+    auto defaultBatchSize = FLAGS_super_vertex_scan_batch_size;
+    env->edgeScanPool_ = edgeScanPool.get();
+    for (auto threshold : {0, 1, 3}) {
+        for (auto parallelism : {2, 4, 256}) {
+            for (auto batchSize : {1, 2, 1024}) {
+                LOG(INFO) << "Threshold " << threshold << ", parallelism " << parallelism
+                          << ", batch size " << batchSize;
+                FLAGS_super_vertex_edge_threshold = threshold;
+                FLAGS_super_vertex_scan_parallelism = parallelism;
+                FLAGS_super_vertex_scan_batch_size = batchSize;
+                ASSERT_EQ(expected, query());
+            }
+        }
+    }
+    env->edgeScanPool_ = nullptr;
+    FLAGS_super_vertex_edge_threshold = defaultThreshold;
+    FLAGS_super_vertex_scan_parallelism = defaultParallelism;
+    FLAGS_super_vertex_scan_batch_size = defaultBatchSize;
+
+    {
+        LOG(INFO) << "SplitRange";
+        std::string prefix = "prefix";
+        std::string start = prefix + std::string(sizeof(EdgeRanking), '\0') + "\x40dst";
+        auto boundaries = ParallelEdgeIterator::splitRange(prefix, start, 4);
+        ASSERT_EQ(4, boundaries.size());
+        ASSERT_EQ(start, boundaries[0]);
+        for (size_t i = 1; i < boundaries.size(); i++) {
+            ASSERT_LT(boundaries[i - 1], boundaries[i]);
+            ASSERT_EQ(0, boundaries[i].find(prefix));
+        }
+        start = prefix + std::string(sizeof(EdgeRanking), '\0') + "\xfe";
+        ASSERT_EQ(2, ParallelEdgeIterator::splitRange(prefix, start, 4).size());
+    }
+}
+
+TEST(GetNeighborsTest, ApproximateSampleTest) {
+    FLAGS_enable_degree_counters = true;
+    FLAGS_get_neighbors_approximate_sample_degree = 1;
+    SCOPE_EXIT {
+        FLAGS_enable_degree_counters = false;
+        FLAGS_get_neighbors_approximate_sample_degree = 0;
+    };
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    TagID team = 2;
+    EdgeType serve = 101;
+    {
+        LOG(INFO) << "SingleEdgeTypeSample";
+        std::vector<VertexID> vertices = {"Spurs"};
+        std::vector<EdgeType> over = {-serve};
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        tags.emplace_back(team, std::vector<std::string>{"name"});
+        edges.emplace_back(-serve, std::vector<std::string>{
+                           "playerName", "startYear", "teamCareer"});
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        (*req.traverse_spec_ref()).set_limit(10);
+        (*req.traverse_spec_ref()).set_random(true);
+
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        ASSERT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        ASSERT_EQ(1, (*resp.vertices_ref()).rows.size());
+        // vId, stat, team, -serve, expr, the seeks might pick the same edge more than once
+        ASSERT_EQ(5, (*resp.vertices_ref()).rows[0].values.size());
+        auto sampled = (*resp.vertices_ref()).rows[0].values[3].getList().values.size();
+        ASSERT_LE(1, sampled);
+        ASSERT_GE(10, sampled);
+    }
+    {
+        LOG(INFO) << "RandomKey";
+        std::string prefix = "prefix";
+        std::string low = prefix + std::string(sizeof(EdgeRanking), '\0') + "\x40dst";
+        std::string high = prefix + std::string(sizeof(EdgeRanking) + 4, '\xFF');
+        for (int i = 0; i < 1000; i++) {
+            auto key = SampledEdgeIterator::randomKey(low, high);
+            ASSERT_EQ(0, key.find(prefix));
+            ASSERT_LE(low.substr(0, key.size()), key);
+            ASSERT_LT(key, high);
+        }
+        // the keys only differ in dst
+        high = prefix + std::string(sizeof(EdgeRanking), '\0') + "\x41";
+        for (int i = 0; i < 1000; i++) {
+            auto key = SampledEdgeIterator::randomKey(low, high);
+            ASSERT_EQ(0, key.find(low.substr(0, prefix.size() + sizeof(EdgeRanking))));
+            ASSERT_LT(key, high);
+        }
+    }
+}
+
+TEST(GetNeighborsTest, TopKTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    TagID player = 1;
+    EdgeType serve = 101;
+
+    std::vector<VertexID> vertices = {"Dwyane Wade"};
+    std::vector<EdgeType> over = {serve};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+    tags.emplace_back(player, std::vector<std::string>{"name", "age", "avgScore"});
+    edges.emplace_back(serve, std::vector<std::string>{"teamName", "startYear", "endYear"});
+
+    auto query = [&] (bool ascending, int64_t limit) {
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        if (limit >= 0) {
+            cpp2::OrderBy orderBy;
+            const auto& exp = *EdgePropertyExpression::make(
+                pool, folly::to<std::string>(serve), "startYear");
+            orderBy.set_prop(Expression::encode(exp));
+            orderBy.set_direction(ascending ? cpp2::OrderDirection::ASCENDING
+                                            : cpp2::OrderDirection::DESCENDING);
+            (*req.traverse_spec_ref()).set_order_by({std::move(orderBy)});
+            (*req.traverse_spec_ref()).set_limit(limit);
+        }
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        // vId, stat, player, serve, expr
+        EXPECT_EQ(1, (*resp.vertices_ref()).rows.size());
+        EXPECT_EQ(5, (*resp.vertices_ref()).rows[0].values.size());
+        std::vector<Value> years;
+        const auto& cell = (*resp.vertices_ref()).rows[0].values[3];
+        if (cell.isList()) {
+            for (const auto& edge : cell.getList().values) {
+                years.emplace_back(edge.getList().values[1]);
+            }
+        }
+        return years;
+    };
+
+    // Dwyane Wade has 4 serve edges
+    auto all = query(true, -1);
+    ASSERT_EQ(4, all.size());
+    for (int64_t limit : {0, 1, 2, 4, 10}) {
+        for (bool ascending : {true, false}) {
+            LOG(INFO) << "Limit " << limit << ", ascending " << ascending;
+            auto expected = all;
+            std::sort(expected.begin(), expected.end(), [ascending] (const auto& a,
+                                                                     const auto& b) {
+                return ascending ? a < b : b < a;
+            });
+            expected.resize(std::min<size_t>(limit, expected.size()));
+            ASSERT_EQ(expected, query(ascending, limit));
+        }
+    }
+}
+
+TEST(GetNeighborsTest, KeyOnlyPropsTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    TagID player = 1;
+    EdgeType serve = 101;
+
+    std::vector<VertexID> vertices = {"Tracy McGrady"};
+    std::vector<EdgeType> over = {serve};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    tags.emplace_back(player, std::vector<std::string>{"name"});
+
+    // return the dst of each serve edge, which is the last prop of edge
+    auto query = [&] (const std::vector<std::string>& props, const Expression* filter) {
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        edges.emplace_back(serve, props);
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        if (filter != nullptr) {
+            (*req.traverse_spec_ref()).set_filter(Expression::encode(*filter));
+        }
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        // vId, stat, player, serve, expr
+        EXPECT_EQ(1, (*resp.vertices_ref()).rows.size());
+        EXPECT_EQ(5, (*resp.vertices_ref()).rows[0].values.size());
+        std::vector<Value> dsts;
+        const auto& cell = (*resp.vertices_ref()).rows[0].values[3];
+        if (cell.isList()) {
+            for (const auto& edge : cell.getList().values) {
+                dsts.emplace_back(edge.getList().values.back());
+            }
+        }
+        return dsts;
+    };
+
+    auto defaultVal = FLAGS_get_neighbors_block_size;
+    for (auto blockSize : {0, 1024}) {
+        LOG(INFO) << "Block size " << blockSize;
+        FLAGS_get_neighbors_block_size = blockSize;
+        // the edge value is decoded when teamName is required
+        auto expected = query({"teamName", kDst}, nullptr);
+        ASSERT_FALSE(expected.empty());
+        ASSERT_EQ(expected, query({kDst}, nullptr));
+        ASSERT_EQ(expected, query({kRank, kDst}, nullptr));
+
+        // filter on key only props, the value is decoded on demand
+        const auto& exp = *RelationalExpression::makeEQ(
+            pool,
+            EdgePropertyExpression::make(pool, folly::to<std::string>(serve), kDst),
+            ConstantExpression::make(pool, Value("Magic")));
+        ASSERT_EQ(std::vector<Value>{"Magic"}, query({kDst}, &exp));
+    }
+    FLAGS_get_neighbors_block_size = defaultVal;
+}
+
 TEST(GetNeighborsTest, VertexCacheTest) {
     fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
     mock::MockCluster cluster;
@@ -891,7 +1528,7 @@ TEST(GetNeighborsTest, VertexCacheTest) {
     ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
     ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
     auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
-    VertexCache vertexCache(1000, 4);
+    VertexCache vertexCache(1024 * 1024, 4);
 
     TagID player = 1;
     EdgeType serve = 101;
@@ -1846,6 +2483,275 @@ TEST(GetNeighborsTest, FilterTest) {
     }
 }
 
+TEST(GetNeighborsTest, CompiledFilterTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    TagID player = 1;
+    EdgeType serve = 101;
+    auto serveName = folly::to<std::string>(serve);
+    auto playerName = folly::to<std::string>(player);
+
+    auto query = [&] (const Expression& filter) {
+        std::vector<VertexID> vertices = {"Tracy McGrady", "Tim Duncan", "Kobe Bryant",
+                                          "LeBron James", "Dwyane Wade"};
+        std::vector<EdgeType> over = {serve};
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        tags.emplace_back(player, std::vector<std::string>{"name", "age", "avgScore"});
+        edges.emplace_back(serve, std::vector<std::string>{"teamName", "startYear", "endYear"});
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        (*req.traverse_spec_ref()).set_filter(Expression::encode(filter));
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        auto rows = (*resp.vertices_ref()).rows;
+        std::sort(rows.begin(), rows.end(), [] (const auto& lhs, const auto& rhs) {
+            return lhs.values < rhs.values;
+        });
+        return rows;
+    };
+
+    std::vector<const Expression*> filters;
+    // where serve.teamAvgScore > 20, float prop with int constant
+    filters.emplace_back(RelationalExpression::makeGT(
+        pool,
+        EdgePropertyExpression::make(pool, serveName, "teamAvgScore"),
+        ConstantExpression::make(pool, Value(20))));
+    // where 2005 <= serve.startYear, constant on the left
+    filters.emplace_back(RelationalExpression::makeLE(
+        pool,
+        ConstantExpression::make(pool, Value(2005)),
+        EdgePropertyExpression::make(pool, serveName, "startYear")));
+    // where (serve.endYear - serve.startYear > 5) || serve.teamCareer == 4, not compiled
+    filters.emplace_back(LogicalExpression::makeOr(
+        pool,
+        RelationalExpression::makeGT(
+            pool,
+            ArithmeticExpression::makeMinus(
+                pool,
+                EdgePropertyExpression::make(pool, serveName, "endYear"),
+                EdgePropertyExpression::make(pool, serveName, "startYear")),
+            ConstantExpression::make(pool, Value(5))),
+        RelationalExpression::makeEQ(
+            pool,
+            EdgePropertyExpression::make(pool, serveName, "teamCareer"),
+            ConstantExpression::make(pool, Value(4)))));
+    // where ($^.player.age >= 30.5 && serve.endYear < 2015) || serve._rank != 0
+    filters.emplace_back(LogicalExpression::makeOr(
+        pool,
+        LogicalExpression::makeAnd(
+            pool,
+            RelationalExpression::makeGE(
+                pool,
+                SourcePropertyExpression::make(pool, playerName, "age"),
+                ConstantExpression::make(pool, Value(30.5))),
+            RelationalExpression::makeLT(
+                pool,
+                EdgePropertyExpression::make(pool, serveName, "endYear"),
+                ConstantExpression::make(pool, Value(2015)))),
+        RelationalExpression::makeNE(
+            pool,
+            EdgeRankExpression::make(pool, serveName),
+            ConstantExpression::make(pool, Value(0)))));
+    // where serve.notExist > 1, fall back to expression
+    filters.emplace_back(RelationalExpression::makeGT(
+        pool,
+        EdgePropertyExpression::make(pool, serveName, "notExist"),
+        ConstantExpression::make(pool, Value(1))));
+
+    auto defaultVal = FLAGS_enable_compiled_filter;
+    for (const auto* filter : filters) {
+        LOG(INFO) << "Filter " << filter->toString();
+        FLAGS_enable_compiled_filter = false;
+        auto expected = query(*filter);
+        ASSERT_FALSE(expected.empty());
+        FLAGS_enable_compiled_filter = true;
+        ASSERT_EQ(expected, query(*filter));
+    }
+    FLAGS_enable_compiled_filter = defaultVal;
+}
+
+TEST(GetNeighborsTest, RankRangeSeekTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+
+    TagID player = 1;
+    EdgeType serve = 101;
+    auto serveName = folly::to<std::string>(serve);
+
+    auto query = [&] (const Expression& filter) {
+        std::vector<VertexID> vertices = {"Tracy McGrady", "Tim Duncan", "Kobe Bryant",
+                                          "LeBron James", "Dwyane Wade"};
+        std::vector<EdgeType> over = {serve, -serve};
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        tags.emplace_back(player, std::vector<std::string>{"name"});
+        edges.emplace_back(serve, std::vector<std::string>{"teamName", "startYear"});
+        edges.emplace_back(-serve, std::vector<std::string>{"teamName", "startYear"});
+        auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+        (*req.traverse_spec_ref()).set_filter(Expression::encode(filter));
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        auto rows = (*resp.vertices_ref()).rows;
+        std::sort(rows.begin(), rows.end(), [] (const auto& lhs, const auto& rhs) {
+            return lhs.values < rhs.values;
+        });
+        return rows;
+    };
+
+    // the rank of serve is the start year
+    std::vector<const Expression*> filters;
+    // where serve._rank >= 2000 && serve._rank < 2010
+    filters.emplace_back(LogicalExpression::makeAnd(
+        pool,
+        RelationalExpression::makeGE(
+            pool,
+            EdgeRankExpression::make(pool, serveName),
+            ConstantExpression::make(pool, Value(2000))),
+        RelationalExpression::makeLT(
+            pool,
+            EdgeRankExpression::make(pool, serveName),
+            ConstantExpression::make(pool, Value(2010)))));
+    // where 2004 == serve._rank && serve.teamName != "Rockets", constant on the left
+    filters.emplace_back(LogicalExpression::makeAnd(
+        pool,
+        RelationalExpression::makeEQ(
+            pool,
+            ConstantExpression::make(pool, Value(2004)),
+            EdgeRankExpression::make(pool, serveName)),
+        RelationalExpression::makeNE(
+            pool,
+            EdgePropertyExpression::make(pool, serveName, "teamName"),
+            ConstantExpression::make(pool, Value("Rockets")))));
+    // where serve._rank > 2010 && serve._rank <= 2010, an empty range
+    filters.emplace_back(LogicalExpression::makeAnd(
+        pool,
+        RelationalExpression::makeGT(
+            pool,
+            EdgeRankExpression::make(pool, serveName),
+            ConstantExpression::make(pool, Value(2010))),
+        RelationalExpression::makeLE(
+            pool,
+            EdgeRankExpression::make(pool, serveName),
+            ConstantExpression::make(pool, Value(2010)))));
+    // where serve._rank < 2000 || serve._rank > 2010, not pushed down
+    filters.emplace_back(LogicalExpression::makeOr(
+        pool,
+        RelationalExpression::makeLT(
+            pool,
+            EdgeRankExpression::make(pool, serveName),
+            ConstantExpression::make(pool, Value(2000))),
+        RelationalExpression::makeGT(
+            pool,
+            EdgeRankExpression::make(pool, serveName),
+            ConstantExpression::make(pool, Value(2010)))));
+
+    auto defaultVal = FLAGS_enable_edge_rank_seek;
+    for (const auto* filter : filters) {
+        LOG(INFO) << "Filter " << filter->toString();
+        FLAGS_enable_edge_rank_seek = false;
+        auto expected = query(*filter);
+        FLAGS_enable_edge_rank_seek = true;
+        ASSERT_EQ(expected, query(*filter));
+    }
+    FLAGS_enable_edge_rank_seek = defaultVal;
+
+    {
+        auto ranges = EdgeRankRange::collect(filters[0]);
+        ASSERT_EQ(1, ranges.size());
+        EXPECT_EQ(2000, ranges[serveName].lower_);
+        EXPECT_EQ(2009, ranges[serveName].upper_);
+        EXPECT_TRUE(EdgeRankRange::collect(filters[2])[serveName].empty());
+        EXPECT_TRUE(EdgeRankRange::collect(filters[3]).empty());
+    }
+}
+
+TEST(GetNeighborsTest, ResultCacheTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+    ResultCache cache(100, 4, 3600);
+    env->resultCache_ = &cache;
+    SCOPE_EXIT {
+        env->resultCache_ = nullptr;
+    };
+
+    TagID team = 2;
+    EdgeType serve = 101;
+    std::vector<VertexID> vertices = {"Spurs"};
+    std::vector<EdgeType> over = {-serve};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+    tags.emplace_back(team, std::vector<std::string>{"name"});
+    edges.emplace_back(-serve, std::vector<std::string>{"playerName", "startYear"});
+    auto req = QueryTestUtils::buildRequest(totalParts, vertices, over, tags, edges);
+    auto run = [&] () {
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        return *resp.vertices_ref();
+    };
+    auto first = run();
+    ASSERT_EQ(1, first.rows.size());
+    // vId, stat, team, -serve, expr
+    ASSERT_EQ(5, first.rows[0].values.size());
+    ASSERT_LT(0, first.rows[0].values[3].getList().values.size());
+
+    // remove the edges behind the back of the raft, which leaves the write version as it is
+    PartitionID partId = (std::hash<std::string>()("Spurs") % totalParts) + 1;
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1);
+    ASSERT_TRUE(vIdLen.ok());
+    auto partRet = env->kvstore_->part(1, partId);
+    ASSERT_TRUE(nebula::ok(partRet));
+    auto part = nebula::value(partRet);
+    auto prefix = NebulaKeyUtils::edgePrefix(vIdLen.value(), partId, "Spurs");
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              part->engine()->removeRange(prefix, prefix + std::string(64, '\xFF')));
+    {
+        LOG(INFO) << "Cached";
+        auto second = run();
+        ASSERT_EQ(first, second);
+    }
+    {
+        LOG(INFO) << "Stale";
+        part->bumpWriteVersion();
+        auto third = run();
+        ASSERT_EQ(1, third.rows.size());
+        ASSERT_EQ(5, third.rows[0].values.size());
+        ASSERT_FALSE(third.rows[0].values[3].isList());
+    }
+    {
+        LOG(INFO) << "OtherRequest";
+        (*req.traverse_spec_ref()).set_limit(1);
+        auto other = run();
+        ASSERT_EQ(1, other.rows.size());
+        ASSERT_FALSE(other.rows[0].values[3].isList());
+    }
+}
+
 }  // namespace storage
 }  // namespace nebula
 
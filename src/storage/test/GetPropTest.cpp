@@ -8,6 +8,7 @@
 #include "common/fs/TempDir.h"
 #include "kvstore/RocksEngineConfig.h"
 #include "storage/query/GetPropProcessor.h"
+#include "storage/query/PlanTemplateCache.h"
 #include "storage/test/QueryTestUtils.h"
 
 namespace nebula {
@@ -623,6 +624,205 @@ TEST(GetPropTest, ConcurrencyTest) {
     FLAGS_query_concurrently = false;
 }
 
+TEST(GetPropTest, BatchReadTest) {
+    fs::TempDir rootPath("/tmp/GetPropTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+
+    TagID player = 1;
+    TagID team = 2;
+    std::vector<VertexID> vertices = {"Tim Duncan", "Tony Parker", "Not Existed", "Spurs",
+                                      "Manu Ginobili", "Tim Duncan", "LeBron James"};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    tags.emplace_back(player, std::vector<std::string>{"name", "age"});
+    tags.emplace_back(team, std::vector<std::string>{"name"});
+    auto req = buildVertexRequest(totalParts, vertices, tags);
+
+    auto getProps = [&] (int32_t batchSize, bool concurrently) {
+        auto defaultBatchSize = FLAGS_get_prop_batch_size;
+        FLAGS_get_prop_batch_size = batchSize;
+        FLAGS_query_concurrently = concurrently;
+        auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+        auto* processor = GetPropProcessor::instance(
+            env, nullptr, concurrently ? threadPool.get() : nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        FLAGS_get_prop_batch_size = defaultBatchSize;
+        FLAGS_query_concurrently = false;
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        auto rows = (*resp.props_ref()).rows;
+        std::sort(rows.begin(), rows.end(), [] (const auto& lhs, const auto& rhs) {
+            return lhs.values < rhs.values;
+        });
+        return rows;
+    };
+
+    // read one by one
+    auto expected = getProps(0, false);
+    // the vertex not existed is not returned, the duplicated one is returned twice
+    ASSERT_EQ(vertices.size() - 1, expected.size());
+    for (int32_t batchSize : {1, 2, 1024}) {
+        EXPECT_EQ(expected, getProps(batchSize, false));
+        EXPECT_EQ(expected, getProps(batchSize, true));
+    }
+}
+
+TEST(GetPropTest, MultiTagScanTest) {
+    fs::TempDir rootPath("/tmp/GetPropTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+
+    TagID player = 1;
+    TagID team = 2;
+    std::vector<VertexID> vertices = {"Tim Duncan", "Tony Parker", "Not Existed", "Spurs",
+                                      "Manu Ginobili", "LeBron James"};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    tags.emplace_back(player, std::vector<std::string>{"name", "age"});
+    tags.emplace_back(team, std::vector<std::string>{"name"});
+    auto req = buildVertexRequest(totalParts, vertices, tags);
+
+    auto getProps = [&] (int32_t minTags) {
+        auto defaultBatchSize = FLAGS_get_prop_batch_size;
+        FLAGS_get_prop_batch_size = 0;
+        FLAGS_multi_tag_scan_min_tags = minTags;
+        auto* processor = GetPropProcessor::instance(env, nullptr, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        FLAGS_get_prop_batch_size = defaultBatchSize;
+        FLAGS_multi_tag_scan_min_tags = 0;
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        auto rows = (*resp.props_ref()).rows;
+        std::sort(rows.begin(), rows.end(), [] (const auto& lhs, const auto& rhs) {
+            return lhs.values < rhs.values;
+        });
+        return rows;
+    };
+
+    // seek each tag
+    auto expected = getProps(0);
+    ASSERT_EQ(vertices.size() - 1, expected.size());
+    // scan the tags of each vertex once
+    EXPECT_EQ(expected, getProps(2));
+    EXPECT_EQ(expected, getProps(1));
+}
+
+TEST(GetPropTest, PlanTemplateTest) {
+    fs::TempDir rootPath("/tmp/GetPropTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+
+    TagID player = 1;
+    TagID team = 2;
+    std::vector<VertexID> vertices = {"Tim Duncan", "Tony Parker", "Spurs"};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    tags.emplace_back(player, std::vector<std::string>{"name", "age"});
+    tags.emplace_back(team, std::vector<std::string>{"name"});
+    auto req = buildVertexRequest(totalParts, vertices, tags);
+
+    auto getProps = [&] () {
+        auto* processor = GetPropProcessor::instance(env, nullptr, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        return *resp.props_ref();
+    };
+
+    auto expected = getProps();
+    PlanTemplateCache templates(16, 0);
+    env->planTemplates_ = &templates;
+    cpp2::GetPropRequest shape;
+    shape.set_vertex_props(*req.vertex_props_ref());
+    auto key = PlanTemplateCache::key(1, "get_prop", shape);
+    EXPECT_EQ(nullptr, templates.get(key, env->schemaMan_, 1));
+    // built and cached by the first request, copied by the second one
+    EXPECT_EQ(expected, getProps());
+    auto tmpl = templates.get(key, env->schemaMan_, 1);
+    ASSERT_NE(nullptr, tmpl);
+    EXPECT_EQ(2, tmpl->tagContext.propContexts_.size());
+    EXPECT_EQ(2, tmpl->tagContext.schemas_.size());
+    EXPECT_EQ(expected.colNames, tmpl->colNames);
+    EXPECT_EQ(expected, getProps());
+    env->planTemplates_ = nullptr;
+}
+
+TEST(GetPropTest, VertexFilterTest) {
+    fs::TempDir rootPath("/tmp/GetPropTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+
+    TagID player = 1;
+    std::vector<VertexID> vertices = {"Tim Duncan", "Tony Parker", "Not Existed", "Spurs"};
+    std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+    tags.emplace_back(player, std::vector<std::string>{"name", "age"});
+    auto req = buildVertexRequest(totalParts, vertices, tags);
+    auto getProps = [&] () {
+        auto* processor = GetPropProcessor::instance(env, nullptr, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, (*resp.result_ref()).failed_parts.size());
+        auto rows = (*resp.props_ref()).rows;
+        std::sort(rows.begin(), rows.end(), [] (const auto& lhs, const auto& rhs) {
+            return lhs.values < rhs.values;
+        });
+        return rows;
+    };
+    auto expected = getProps();
+
+    GraphSpaceID spaceId = 1;
+    size_t vIdLen = 32;
+    VertexFilter filter(env->schemaMan_, 10);
+    filter.setStore(env->kvstore_);
+    // taken as existing until built
+    EXPECT_TRUE(filter.mayExist(spaceId, 1, "Not Existed"));
+    for (PartitionID partId = 1; partId <= totalParts; partId++) {
+        filter.build(spaceId, partId);
+        ASSERT_TRUE(filter.ready(spaceId, partId));
+    }
+    for (const auto& vId : {"Tim Duncan", "Tony Parker", "Spurs"}) {
+        auto partId = std::hash<std::string>()(vId) % totalParts + 1;
+        EXPECT_TRUE(filter.mayExist(spaceId, partId, vId));
+    }
+    size_t misses = 0;
+    for (size_t i = 0; i < 1000; i++) {
+        auto vId = folly::stringPrintf("Not Existed %lu", i);
+        if (!filter.mayExist(spaceId, i % totalParts + 1, vId)) {
+            misses++;
+        }
+    }
+    EXPECT_LT(900, misses);
+
+    // the skipped reads return the same as the reads
+    env->vertexFilter_ = &filter;
+    EXPECT_EQ(expected, getProps());
+
+    // the vertex committed is never missed
+    auto key = NebulaKeyUtils::vertexKey(vIdLen, 1, "New Player", player);
+    filter.onCommit(spaceId, 1, {key});
+    EXPECT_TRUE(filter.mayExist(spaceId, 1, "New Player"));
+    // built again after reset
+    filter.onReset(spaceId, 0);
+    EXPECT_FALSE(filter.ready(spaceId, 1));
+    EXPECT_TRUE(filter.mayExist(spaceId, 1, "Not Existed"));
+    env->vertexFilter_ = nullptr;
+}
+
 TEST(QueryVertexPropsTest, PrefixBloomFilterTest) {
     FLAGS_enable_rocksdb_statistics = true;
     FLAGS_enable_rocksdb_prefix_filtering = true;
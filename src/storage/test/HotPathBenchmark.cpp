@@ -0,0 +1,434 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+/*
+The benchmarks of the hot paths of the storage, in one target so a release could be compared
+with the former one:
+  the exec nodes, TagNode and SingleEdgeNode alone, and the whole plan of GetNeighbors
+  the codec, encoding and decoding the rows of a schema
+  the key utils, building and parsing the vertex and edge keys
+  MemoryLockCore, locking and unlocking a batch of keys
+  AtomicLogBuffer, pushing and reading the logs
+  the iterators of RocksEngine, prefix scanned
+The scale is set by --degree, --prop_count, --vid_len and --int_vid. The mocked space of the
+exec nodes has the string vids of its own length, the vid flags apply to the others.
+
+Run with --json to print the results as json, and compare two runs by
+  scripts/compare_benchmarks.py base.json new.json --threshold=10
+which exits with 1 if any benchmark is slower by more than the threshold in percent.
+*/
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include <folly/Benchmark.h>
+#include "common/fs/TempDir.h"
+#include "codec/RowWriterV2.h"
+#include "kvstore/RocksEngine.h"
+#include "kvstore/wal/AtomicLogBuffer.h"
+#include "storage/exec/EdgeNode.h"
+#include "storage/exec/TagNode.h"
+#include "storage/query/GetNeighborsProcessor.h"
+#include "storage/test/QueryTestUtils.h"
+#include "utils/MemoryLockCore.h"
+#include "utils/NebulaKeyUtils.h"
+
+DEFINE_uint64(degree, 100, "The edges of each vertex, and the keys of each prefix scanned");
+DEFINE_int32(prop_count, 3, "The props read of each edge, at most the props of the schema");
+DEFINE_int32(vid_len, 32, "The length of the vids of the key utils, the locks and the engine");
+DEFINE_bool(int_vid, false, "Whether the vids of the key utils, the locks and the engine are "
+                            "int64, vid_len is ignored if set");
+
+std::unique_ptr<nebula::mock::MockCluster> gCluster;
+
+namespace nebula {
+namespace storage {
+
+const GraphSpaceID kSpaceId = 1;
+const TagID kPlayer = 1;
+const EdgeType kServe = 101;
+
+size_t vidLen() {
+    return FLAGS_int_vid ? sizeof(int64_t) : FLAGS_vid_len;
+}
+
+// The vid i of the length of vidLen
+std::string benchVid(int64_t i) {
+    if (FLAGS_int_vid) {
+        return std::string(reinterpret_cast<const char*>(&i), sizeof(int64_t));
+    }
+    auto vid = folly::to<std::string>(i);
+    vid.resize(FLAGS_vid_len, '\0');
+    return vid;
+}
+
+// The first prop_count props of serve
+std::vector<std::string> serveProps() {
+    auto schema = gCluster->storageEnv_->schemaMan_->getEdgeSchema(kSpaceId, kServe);
+    CHECK(schema != nullptr);
+    std::vector<std::string> props;
+    auto count = std::min<size_t>(FLAGS_prop_count, schema->getNumFields());
+    for (size_t i = 0; i < count; i++) {
+        props.emplace_back(schema->getFieldName(i));
+    }
+    return props;
+}
+
+void setUp(const char* path) {
+    gCluster = std::make_unique<mock::MockCluster>();
+    gCluster->initStorageKV(path);
+    auto* env = gCluster->storageEnv_.get();
+    auto totalParts = gCluster->getTotalParts();
+    CHECK(QueryTestUtils::mockVertexData(env, totalParts));
+    CHECK(QueryTestUtils::mockBenchEdgeData(env, totalParts, 1, FLAGS_degree));
+}
+
+std::vector<PropContext> propContexts(const meta::NebulaSchemaProvider* schema,
+                                      const std::vector<std::string>& props) {
+    std::vector<PropContext> ctxs;
+    for (const auto& prop : props) {
+        PropContext ctx(prop.c_str());
+        ctx.returned_ = true;
+        ctx.field_ = schema->field(prop);
+        ctxs.emplace_back(std::move(ctx));
+    }
+    return ctxs;
+}
+
+void tagNode(size_t iters) {
+    std::unique_ptr<PlanContext> planCtx;
+    std::unique_ptr<RunTimeContext> context;
+    std::unique_ptr<TagNode> node;
+    TagContext tagContext;
+    std::vector<VertexID> vertices;
+    BENCHMARK_SUSPEND {
+        auto* env = gCluster->storageEnv_.get();
+        auto vIdLen = env->schemaMan_->getSpaceVidLen(kSpaceId).value();
+        planCtx = std::make_unique<PlanContext>(env, kSpaceId, vIdLen, false);
+        context = std::make_unique<RunTimeContext>(planCtx.get());
+        tagContext.schemas_ = std::move(env->schemaMan_->getAllVerTagSchema(kSpaceId)).value();
+        tagContext.tagNames_.emplace(kPlayer,
+                                     env->schemaMan_->toTagName(kSpaceId, kPlayer).value());
+        const auto& schema = tagContext.schemas_[kPlayer].back();
+        tagContext.propContexts_.emplace_back(kPlayer, propContexts(schema.get(), {"name"}));
+        tagContext.indexMap_.emplace(kPlayer, 0);
+        const auto& ctx = tagContext.propContexts_.front();
+        node = std::make_unique<TagNode>(context.get(), &tagContext, ctx.first, &ctx.second);
+        for (const auto& player : mock::MockData::players_) {
+            vertices.emplace_back(player.name_);
+        }
+    }
+    auto totalParts = gCluster->getTotalParts();
+    std::hash<std::string> hash;
+    for (size_t i = 0; i < iters; i++) {
+        const auto& vId = vertices[i % vertices.size()];
+        PartitionID partId = (hash(vId) % totalParts) + 1;
+        node->execute(partId, vId);
+        auto* reader = node->reader();
+        folly::doNotOptimizeAway(reader);
+    }
+}
+
+void edgeNode(size_t iters) {
+    std::unique_ptr<PlanContext> planCtx;
+    std::unique_ptr<RunTimeContext> context;
+    std::unique_ptr<SingleEdgeNode> node;
+    EdgeContext edgeContext;
+    BENCHMARK_SUSPEND {
+        auto* env = gCluster->storageEnv_.get();
+        auto vIdLen = env->schemaMan_->getSpaceVidLen(kSpaceId).value();
+        planCtx = std::make_unique<PlanContext>(env, kSpaceId, vIdLen, false);
+        context = std::make_unique<RunTimeContext>(planCtx.get());
+        edgeContext.schemas_ = std::move(env->schemaMan_->getAllVerEdgeSchema(kSpaceId)).value();
+        edgeContext.edgeNames_.emplace(kServe,
+                                       env->schemaMan_->toEdgeName(kSpaceId, kServe).value());
+        const auto& schema = edgeContext.schemas_[kServe].back();
+        edgeContext.propContexts_.emplace_back(kServe, propContexts(schema.get(), serveProps()));
+        edgeContext.indexMap_.emplace(kServe, 0);
+        const auto& ctx = edgeContext.propContexts_.front();
+        context->props_ = &ctx.second;
+        node = std::make_unique<SingleEdgeNode>(
+            context.get(), &edgeContext, ctx.first, &ctx.second);
+    }
+    auto totalParts = gCluster->getTotalParts();
+    std::hash<std::string> hash;
+    VertexID vId = "Tim Duncan";
+    PartitionID partId = (hash(vId) % totalParts) + 1;
+    for (size_t i = 0; i < iters; i++) {
+        node->execute(partId, vId);
+        for (; node->valid(); node->next()) {
+            auto* reader = node->reader();
+            for (const auto& prop : *context->props_) {
+                auto value = QueryUtils::readValue(reader, prop.name_, prop.field_);
+                folly::doNotOptimizeAway(value);
+            }
+        }
+    }
+}
+
+void getNeighbors(size_t iters) {
+    cpp2::GetNeighborsRequest req;
+    BENCHMARK_SUSPEND {
+        std::vector<std::pair<TagID, std::vector<std::string>>> tags;
+        std::vector<std::pair<EdgeType, std::vector<std::string>>> edges;
+        tags.emplace_back(kPlayer, std::vector<std::string>{"name"});
+        edges.emplace_back(kServe, serveProps());
+        req = QueryTestUtils::buildRequest(
+            gCluster->getTotalParts(), {"Tim Duncan"}, {kServe}, tags, edges);
+    }
+    auto* env = gCluster->storageEnv_.get();
+    for (size_t i = 0; i < iters; i++) {
+        auto* processor = GetNeighborsProcessor::instance(env, nullptr, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        folly::doNotOptimizeAway(resp);
+    }
+}
+
+std::shared_ptr<const meta::NebulaSchemaProvider> serveSchema() {
+    return gCluster->storageEnv_->schemaMan_->getEdgeSchema(kSpaceId, kServe);
+}
+
+std::string encodeServe(const meta::NebulaSchemaProvider* schema) {
+    RowWriterV2 writer(schema);
+    for (size_t i = 0; i < schema->getNumFields(); i++) {
+        auto* field = schema->field(i);
+        if (field->type() == meta::cpp2::PropertyType::STRING) {
+            writer.setValue(i, std::string(16, 'A'));
+        } else if (field->type() == meta::cpp2::PropertyType::INT64) {
+            writer.setValue(i, static_cast<int64_t>(i));
+        } else if (field->type() == meta::cpp2::PropertyType::BOOL) {
+            writer.setValue(i, true);
+        } else if (field->type() == meta::cpp2::PropertyType::DOUBLE) {
+            writer.setValue(i, 1.0);
+        }
+    }
+    writer.finish();
+    return writer.moveEncodedStr();
+}
+
+void encodeRow(size_t iters) {
+    std::shared_ptr<const meta::NebulaSchemaProvider> schema;
+    BENCHMARK_SUSPEND {
+        schema = serveSchema();
+    }
+    for (size_t i = 0; i < iters; i++) {
+        auto encoded = encodeServe(schema.get());
+        folly::doNotOptimizeAway(encoded);
+    }
+}
+
+void decodeRow(size_t iters) {
+    std::vector<std::shared_ptr<const meta::NebulaSchemaProvider>> schemas;
+    std::string encoded;
+    std::vector<std::string> props;
+    BENCHMARK_SUSPEND {
+        schemas.emplace_back(serveSchema());
+        encoded = encodeServe(schemas.back().get());
+        props = serveProps();
+    }
+    RowReaderWrapper reader;
+    for (size_t i = 0; i < iters; i++) {
+        reader.reset(schemas, encoded);
+        for (const auto& prop : props) {
+            auto value = reader->getValueByName(prop);
+            folly::doNotOptimizeAway(value);
+        }
+    }
+}
+
+void buildKeys(size_t iters) {
+    std::vector<std::string> vids;
+    BENCHMARK_SUSPEND {
+        for (int64_t i = 0; i < 1024; i++) {
+            vids.emplace_back(benchVid(i));
+        }
+    }
+    for (size_t i = 0; i < iters; i++) {
+        const auto& src = vids[i % vids.size()];
+        const auto& dst = vids[(i + 1) % vids.size()];
+        auto vertex = NebulaKeyUtils::vertexKey(vidLen(), 1, src, kPlayer);
+        auto edge = NebulaKeyUtils::edgeKey(vidLen(), 1, src, kServe, i, dst);
+        folly::doNotOptimizeAway(vertex);
+        folly::doNotOptimizeAway(edge);
+    }
+}
+
+void parseKeys(size_t iters) {
+    std::vector<std::string> keys;
+    BENCHMARK_SUSPEND {
+        for (int64_t i = 0; i < 1024; i++) {
+            keys.emplace_back(
+                NebulaKeyUtils::edgeKey(vidLen(), 1, benchVid(i), kServe, i, benchVid(i + 1)));
+        }
+    }
+    for (size_t i = 0; i < iters; i++) {
+        const auto& key = keys[i % keys.size()];
+        CHECK(NebulaKeyUtils::isEdge(vidLen(), key));
+        auto src = NebulaKeyUtils::getSrcId(vidLen(), key);
+        auto type = NebulaKeyUtils::getEdgeType(vidLen(), key);
+        auto rank = NebulaKeyUtils::getRank(vidLen(), key);
+        auto dst = NebulaKeyUtils::getDstId(vidLen(), key);
+        folly::doNotOptimizeAway(src);
+        folly::doNotOptimizeAway(type);
+        folly::doNotOptimizeAway(rank);
+        folly::doNotOptimizeAway(dst);
+    }
+}
+
+void lockBatch(size_t iters) {
+    MemoryLockCore<std::string> lock;
+    std::vector<std::string> keys;
+    BENCHMARK_SUSPEND {
+        for (uint64_t i = 0; i < FLAGS_degree; i++) {
+            keys.emplace_back(NebulaKeyUtils::vertexKey(vidLen(), 1, benchVid(i), kPlayer));
+        }
+    }
+    for (size_t i = 0; i < iters; i++) {
+        auto ret = lock.lockBatch(keys);
+        CHECK(ret.second);
+        lock.unlockBatch(keys);
+    }
+}
+
+void logBufferPush(size_t iters) {
+    std::shared_ptr<wal::AtomicLogBuffer> logBuffer;
+    BENCHMARK_SUSPEND {
+        logBuffer = wal::AtomicLogBuffer::instance();
+    }
+    for (size_t i = 0; i < iters; i++) {
+        logBuffer->push(i, 0, 0, std::string(128, 'A'));
+    }
+    BENCHMARK_SUSPEND {
+        logBuffer.reset();
+    }
+}
+
+void logBufferRead(size_t iters) {
+    std::shared_ptr<wal::AtomicLogBuffer> logBuffer;
+    const LogID total = 10000;
+    BENCHMARK_SUSPEND {
+        logBuffer = wal::AtomicLogBuffer::instance();
+        for (LogID i = 0; i < total; i++) {
+            logBuffer->push(i, 0, 0, std::string(128, 'A'));
+        }
+    }
+    for (size_t i = 0; i < iters; i++) {
+        auto start = i % (total - FLAGS_degree);
+        auto iter = logBuffer->iterator(start, start + FLAGS_degree - 1);
+        for (; iter->valid(); ++(*iter)) {
+            auto log = iter->logMsg();
+            folly::doNotOptimizeAway(log);
+        }
+    }
+    BENCHMARK_SUSPEND {
+        logBuffer.reset();
+    }
+}
+
+void enginePrefix(size_t iters) {
+    std::unique_ptr<fs::TempDir> dataPath;
+    std::unique_ptr<kvstore::RocksEngine> engine;
+    std::vector<std::string> prefixes;
+    BENCHMARK_SUSPEND {
+        dataPath = std::make_unique<fs::TempDir>("/tmp/HotPathBenchmark.XXXXXX");
+        engine = std::make_unique<kvstore::RocksEngine>(0, vidLen(), dataPath->path());
+        std::vector<kvstore::KV> data;
+        for (int64_t v = 0; v < 100; v++) {
+            auto src = benchVid(v);
+            prefixes.emplace_back(NebulaKeyUtils::edgePrefix(vidLen(), 1, src, kServe));
+            for (uint64_t rank = 0; rank < FLAGS_degree; rank++) {
+                data.emplace_back(
+                    NebulaKeyUtils::edgeKey(vidLen(), 1, src, kServe, rank, benchVid(v + 1)),
+                    std::string(128, 'A'));
+            }
+        }
+        CHECK_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->multiPut(std::move(data)));
+        CHECK_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->flush());
+    }
+    for (size_t i = 0; i < iters; i++) {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        CHECK_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                 engine->prefix(prefixes[i % prefixes.size()], &iter));
+        size_t count = 0;
+        for (; iter->valid(); iter->next()) {
+            auto val = iter->val();
+            folly::doNotOptimizeAway(val);
+            count++;
+        }
+        CHECK_EQ(FLAGS_degree, count);
+    }
+    BENCHMARK_SUSPEND {
+        engine.reset();
+        dataPath.reset();
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+BENCHMARK(TagNode, iters) {
+    nebula::storage::tagNode(iters);
+}
+
+BENCHMARK(SingleEdgeNode, iters) {
+    nebula::storage::edgeNode(iters);
+}
+
+BENCHMARK(GetNeighborsPlan, iters) {
+    nebula::storage::getNeighbors(iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(EncodeRow, iters) {
+    nebula::storage::encodeRow(iters);
+}
+
+BENCHMARK(DecodeRow, iters) {
+    nebula::storage::decodeRow(iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(BuildKeys, iters) {
+    nebula::storage::buildKeys(iters);
+}
+
+BENCHMARK(ParseKeys, iters) {
+    nebula::storage::parseKeys(iters);
+}
+
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(MemoryLockBatch, iters) {
+    nebula::storage::lockBatch(iters);
+}
+
+BENCHMARK(AtomicLogBufferPush, iters) {
+    nebula::storage::logBufferPush(iters);
+}
+
+BENCHMARK(AtomicLogBufferRead, iters) {
+    nebula::storage::logBufferRead(iters);
+}
+
+BENCHMARK(RocksEnginePrefix, iters) {
+    nebula::storage::enginePrefix(iters);
+}
+
+int main(int argc, char** argv) {
+    folly::init(&argc, &argv, true);
+    if (FLAGS_degree == 0) {
+        LOG(ERROR) << "degree should be positive";
+        return 1;
+    }
+    nebula::fs::TempDir rootPath("/tmp/HotPathBenchmark.XXXXXX");
+    nebula::storage::setUp(rootPath.path());
+    folly::runBenchmarks();
+    gCluster.reset();
+    return 0;
+}
@@ -0,0 +1,85 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include <folly/synchronization/Baton.h>
+#include "mock/MockCluster.h"
+#include "storage/HotVertexWarmer.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+TEST(HotVertexWarmerTest, EncodeTest) {
+    std::vector<std::string> vIds = {"Tim Duncan", "", std::string(8, '\0')};
+    ASSERT_EQ(vIds, HotVertexWarmer::decode(HotVertexWarmer::encode(vIds)));
+    // the truncated one is dropped
+    auto val = HotVertexWarmer::encode(vIds);
+    ASSERT_EQ(std::vector<std::string>{"Tim Duncan"},
+              HotVertexWarmer::decode(folly::StringPiece(val).subpiece(0, 16)));
+}
+
+TEST(HotVertexWarmerTest, PersistTest) {
+    fs::TempDir rootPath("/tmp/HotVertexWarmerTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+
+    PartTraffic traffic(1, 2);
+    for (int i = 0; i < 10; i++) {
+        traffic.recordVertex(1, 1, "Tim Duncan");
+    }
+    traffic.recordVertex(1, 1, "Tony Parker");
+    traffic.recordVertex(1, 2, "Spurs");
+    traffic.rotate();
+
+    HotVertexWarmer warmer(env->schemaMan_, 0);
+    warmer.setStore(env->kvstore_, &traffic);
+    ASSERT_TRUE(warmer.start());
+    {
+        LOG(INFO) << "HotPart";
+        folly::Baton<true, std::atomic> baton;
+        warmer.persist(1, 1, [&] (nebula::cpp2::ErrorCode code) {
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+        std::string val;
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  env->kvstore_->get(1, 1, NebulaKeyUtils::systemHotVerticesKey(1), &val));
+        auto vIds = HotVertexWarmer::decode(val);
+        std::sort(vIds.begin(), vIds.end());
+        ASSERT_EQ((std::vector<std::string>{"Tim Duncan", "Tony Parker"}), vIds);
+        // the committed key is warmed on the worker
+        warmer.warm(1, 1);
+    }
+    {
+        LOG(INFO) << "ColdPart";
+        bool called = false;
+        warmer.persist(1, 3, [&] (nebula::cpp2::ErrorCode code) {
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            called = true;
+        });
+        // nothing to write
+        ASSERT_TRUE(called);
+        std::string val;
+        ASSERT_EQ(nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND,
+                  env->kvstore_->get(1, 3, NebulaKeyUtils::systemHotVerticesKey(3), &val));
+    }
+    warmer.stop();
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
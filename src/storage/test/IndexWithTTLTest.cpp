@@ -848,6 +848,29 @@ TEST(IndexWithTTLTest, LookupEdgeIndexWithTTLExpired) {
     EXPECT_EQ(0, resp.get_data()->rows.size());
 }
 
+TEST(IndexWithTTLTest, IndexTTLTest) {
+    fs::TempDir rootPath("/tmp/IndexTTLTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path(), HostAddr("", 0), 1, true, false, {}, true);
+    auto* env = cluster.storageEnv_.get();
+    createSchema(env->schemaMan_, 2021001, 100);
+    auto schema = env->schemaMan_->getTagSchema(1, 2021001);
+    ASSERT_NE(nullptr, schema);
+
+    auto now = time::WallClock::fastNowInSec();
+    IndexTTL ttl(schema.get());
+    ASSERT_TRUE(ttl.enabled());
+    EXPECT_FALSE(ttl.expired(""));
+    EXPECT_FALSE(ttl.expired(IndexKeyUtils::indexVal(Value(now))));
+    EXPECT_TRUE(ttl.expired(IndexKeyUtils::indexVal(Value(now - 200))));
+    EXPECT_FALSE(ttl.expired(IndexKeyUtils::indexVal(Value(NullType::__NULL__))));
+
+    // no ttl
+    IndexTTL none(nullptr);
+    EXPECT_FALSE(none.enabled());
+    EXPECT_FALSE(none.expired(IndexKeyUtils::indexVal(Value(now - 200))));
+}
+
 }   // namespace storage
 }   // namespace nebula
 
@@ -137,6 +137,235 @@ TEST(IndexTest, SimpleVerticesTest) {
     }
 }
 
+TEST(IndexTest, DuplicateVerticesTest) {
+    fs::TempDir rootPath("/tmp/DuplicateVerticesTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1).value();
+    PartitionID partId = 1;
+
+    auto newVertex = [&] (int64_t colInt) {
+        nebula::storage::cpp2::NewVertex vertex;
+        nebula::storage::cpp2::NewTag newTag;
+        newTag.set_tag_id(3);
+        const Date date = {2020, 2, 20};
+        const DateTime dt = {2020, 2, 20, 10, 30, 45, 0};
+        std::vector<Value>  props;
+        props.emplace_back(Value(true));
+        props.emplace_back(Value(colInt));
+        props.emplace_back(Value(1.1f));
+        props.emplace_back(Value(1.1f));
+        props.emplace_back(Value("string"));
+        props.emplace_back(Value(1L));
+        props.emplace_back(Value(1L));
+        props.emplace_back(Value(1L));
+        props.emplace_back(Value(1L));
+        props.emplace_back(Value(date));
+        props.emplace_back(Value(dt));
+        newTag.set_props(std::move(props));
+        vertex.set_id(convertVertexId(vIdLen, partId));
+        vertex.set_tags({newTag});
+        return vertex;
+    };
+
+    // the same vertex is inserted three times in one request, only the last one is indexed
+    for (auto round = 0; round < 2; round++) {
+        cpp2::AddVerticesRequest req;
+        req.set_space_id(1);
+        req.set_if_not_exists(false);
+        for (int64_t colInt = 1; colInt <= 3; colInt++) {
+            (*req.parts_ref())[partId].emplace_back(newVertex(round * 10 + colInt));
+        }
+        auto* processor = AddVerticesProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto prefix = IndexKeyUtils::indexPrefix(partId, 3);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  env->kvstore_->prefix(1, partId, prefix, &iter));
+        ASSERT_TRUE(iter->valid());
+        auto colInt = IndexKeyUtils::getValueFromIndexKey(
+            vIdLen, iter->key(), "col_int", mock::MockData::mockGeneralTagIndexColumns());
+        EXPECT_EQ(Value(round * 10 + 3L), colInt);
+        iter->next();
+        EXPECT_FALSE(iter->valid());
+    }
+}
+
+// The request to add the vertex with tag 3, which has a tag index on col_int
+cpp2::AddVerticesRequest mockIndexedVertexReq(const VertexID& vId,
+                                              PartitionID partId,
+                                              int64_t colInt) {
+    nebula::storage::cpp2::NewTag newTag;
+    newTag.set_tag_id(3);
+    const Date date = {2020, 2, 20};
+    const DateTime dt = {2020, 2, 20, 10, 30, 45, 0};
+    std::vector<Value>  props;
+    props.emplace_back(Value(true));
+    props.emplace_back(Value(colInt));
+    props.emplace_back(Value(1.1f));
+    props.emplace_back(Value(1.1f));
+    props.emplace_back(Value("string"));
+    props.emplace_back(Value(1L));
+    props.emplace_back(Value(1L));
+    props.emplace_back(Value(1L));
+    props.emplace_back(Value(1L));
+    props.emplace_back(Value(date));
+    props.emplace_back(Value(dt));
+    newTag.set_props(std::move(props));
+    nebula::storage::cpp2::NewVertex vertex;
+    vertex.set_id(vId);
+    vertex.set_tags({newTag});
+
+    cpp2::AddVerticesRequest req;
+    req.set_space_id(1);
+    req.set_if_not_exists(false);
+    (*req.parts_ref())[partId].emplace_back(std::move(vertex));
+    return req;
+}
+
+TEST(IndexTest, IndexValueCacheTest) {
+    fs::TempDir rootPath("/tmp/IndexValueCacheTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    IndexValueCache valueCache(16 * 1024 * 1024, 0);
+    env->indexValueCache_ = &valueCache;
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1).value();
+    PartitionID partId = 1;
+    auto vId = convertVertexId(vIdLen, partId);
+    auto partRet = env->kvstore_->part(1, partId);
+    ASSERT_TRUE(nebula::ok(partRet));
+    auto term = nebula::value(partRet)->termId();
+
+    auto addVertex = [&] (int64_t colInt) {
+        auto req = mockIndexedVertexReq(vId, partId, colInt);
+        auto* processor = AddVerticesProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    };
+    auto checkIndex = [&] (int64_t colInt) {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto prefix = IndexKeyUtils::indexPrefix(partId, 3);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  env->kvstore_->prefix(1, partId, prefix, &iter));
+        ASSERT_TRUE(iter->valid());
+        EXPECT_EQ(Value(colInt), IndexKeyUtils::getValueFromIndexKey(
+            vIdLen, iter->key(), "col_int", mock::MockData::mockGeneralTagIndexColumns()));
+        iter->next();
+        EXPECT_FALSE(iter->valid());
+    };
+
+    // the row written is cached, and used as the old value of the next write
+    addVertex(1);
+    checkIndex(1);
+    std::string firstRow;
+    auto key = NebulaKeyUtils::vertexKey(vIdLen, partId, vId, 3);
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, env->kvstore_->get(1, partId, key, &firstRow));
+    auto cached = valueCache.get(std::make_pair(vId, 3), term);
+    ASSERT_TRUE(cached.ok());
+    EXPECT_EQ(firstRow, cached.value());
+
+    addVertex(2);
+    checkIndex(2);
+    cached = valueCache.get(std::make_pair(vId, 3), term);
+    ASSERT_TRUE(cached.ok());
+    EXPECT_NE(firstRow, cached.value());
+
+    // the row cached in another term is not used, the old value is read from kvstore
+    valueCache.insert(std::make_pair(vId, 3), term + 1, firstRow);
+    addVertex(3);
+    checkIndex(3);
+    EXPECT_FALSE(valueCache.get(std::make_pair(vId, 3), term + 1).ok());
+
+    // the cache is evicted by delete
+    {
+        cpp2::DeleteVerticesRequest req;
+        req.set_space_id(1);
+        (*req.parts_ref())[partId].emplace_back(vId);
+        auto* processor = DeleteVerticesProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    }
+    EXPECT_FALSE(valueCache.get(std::make_pair(vId, 3), term).ok());
+    env->indexValueCache_ = nullptr;
+}
+
+TEST(IndexTest, IndexValueCacheInterleavedTest) {
+    fs::TempDir rootPath("/tmp/IndexValueCacheInterleavedTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    IndexValueCache valueCache(16 * 1024 * 1024, 0);
+    env->indexValueCache_ = &valueCache;
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(1).value();
+    PartitionID partId = 1;
+    auto vId = convertVertexId(vIdLen, partId);
+    auto partRet = env->kvstore_->part(1, partId);
+    ASSERT_TRUE(nebula::ok(partRet));
+    auto term = nebula::value(partRet)->termId();
+    auto key = NebulaKeyUtils::vertexKey(vIdLen, partId, vId, 3);
+    auto cacheKey = std::make_pair(vId, 3);
+
+    // Caches the row of vertex read from kvstore with it locked, as the indexed writes do
+    std::atomic<bool> stop{false};
+    std::thread reader([&] {
+        while (!stop) {
+            nebula::MemoryLockGuard<VMLI> lg(env->verticesML_.get(),
+                                             std::make_tuple(1, partId, 3, vId));
+            if (!lg) {
+                continue;
+            }
+            std::string row;
+            if (env->kvstore_->get(1, partId, key, &row) == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                valueCache.insert(cacheKey, term, row);
+            }
+        }
+    });
+
+    // the writes conflict with the reader, retry until they are done
+    auto retry = [] (auto process) {
+        while (!process()) {
+        }
+    };
+    for (int64_t round = 0; round < 100; round++) {
+        retry([&] {
+            auto req = mockIndexedVertexReq(vId, partId, round);
+            auto* processor = AddVerticesProcessor::instance(env, nullptr);
+            auto fut = processor->getFuture();
+            processor->process(req);
+            return std::move(fut).get().result.failed_parts.empty();
+        });
+        retry([&] {
+            cpp2::DeleteVerticesRequest req;
+            req.set_space_id(1);
+            (*req.parts_ref())[partId].emplace_back(vId);
+            auto* processor = DeleteVerticesProcessor::instance(env, nullptr);
+            auto fut = processor->getFuture();
+            processor->process(req);
+            return std::move(fut).get().result.failed_parts.empty();
+        });
+        // the row read by the reader before the delete is evicted after it, and there is
+        // nothing to read since then
+        nebula::MemoryLockGuard<VMLI> lg(env->verticesML_.get(),
+                                         std::make_tuple(1, partId, 3, vId));
+        if (lg) {
+            ASSERT_FALSE(valueCache.get(cacheKey, term).ok()) << "round " << round;
+        }
+    }
+    stop = true;
+    reader.join();
+    env->indexValueCache_ = nullptr;
+}
+
 TEST(IndexTest, SimpleEdgesTest) {
     fs::TempDir rootPath("/tmp/SimpleEdgesTest.XXXXXX");
     mock::MockCluster cluster;
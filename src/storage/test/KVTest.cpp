@@ -8,6 +8,7 @@
 #include "common/fs/TempDir.h"
 #include "common/network/NetworkUtils.h"
 #include <gtest/gtest.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include "meta/test/TestUtils.h"
 #include "storage/test/TestUtils.h"
 #include "common/clients/storage/GeneralStorageClient.h"
@@ -19,6 +20,7 @@
 
 DECLARE_string(meta_server_addrs);
 DECLARE_int32(heartbeat_interval_secs);
+DECLARE_bool(kv_ttl_header);
 
 namespace nebula {
 namespace storage {
@@ -73,6 +75,88 @@ TEST(KVTest, SimpleTest) {
     }
 }
 
+TEST(KVTest, ConcurrentGetTest) {
+    fs::TempDir rootPath("/tmp/KVConcurrentGetTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    const int32_t totalParts = 6;
+    {
+        auto* processor = PutProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        auto req = mock::MockData::mockKVPut();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    }
+    {
+        // the parts are got in the executor at once
+        auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+        auto* processor = GetProcessor::instance(env, nullptr, executor.get());
+        auto fut = processor->getFuture();
+        auto req = mock::MockData::mockKVGet();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        const auto& pairs = resp.get_key_values();
+        EXPECT_EQ(totalParts, pairs.size());
+        for (size_t part = 1; part <= totalParts; part++) {
+            auto it = pairs.find(folly::stringPrintf("key_%ld", part));
+            ASSERT_NE(pairs.end(), it);
+            EXPECT_EQ(folly::stringPrintf("value_%ld", part), it->second);
+        }
+    }
+}
+
+TEST(KVTest, TTLHeaderTest) {
+    fs::TempDir rootPath("/tmp/KVTTLHeaderTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    const int32_t totalParts = 6;
+    FLAGS_kv_ttl_header = true;
+    {
+        // the values of the odd parts are expired, the even ones never expire
+        auto now = time::WallClock::fastNowInSec();
+        auto req = mock::MockData::mockKVPut();
+        auto parts = req.get_parts();
+        for (auto& part : parts) {
+            int64_t expireAt = part.first % 2 == 1 ? now - 10 : 0;
+            for (auto& pair : part.second) {
+                pair.value = std::string(reinterpret_cast<const char*>(&expireAt),
+                                         sizeof(int64_t)) + pair.value;
+            }
+        }
+        req.set_parts(std::move(parts));
+        auto* processor = PutProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    }
+    {
+        auto* processor = GetProcessor::instance(env, nullptr);
+        auto fut = processor->getFuture();
+        auto req = mock::MockData::mockKVGet();
+        req.set_return_partly(true);
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        const auto& pairs = resp.get_key_values();
+        EXPECT_EQ(totalParts / 2, pairs.size());
+        for (size_t part = 1; part <= totalParts; part++) {
+            auto it = pairs.find(folly::stringPrintf("key_%ld", part));
+            if (part % 2 == 1) {
+                EXPECT_EQ(pairs.end(), it);
+                continue;
+            }
+            ASSERT_NE(pairs.end(), it);
+            EXPECT_EQ(folly::stringPrintf("value_%ld", part),
+                      it->second.substr(sizeof(int64_t)));
+        }
+    }
+    FLAGS_kv_ttl_header = false;
+}
+
 }  // namespace storage
 }  // namespace nebula
 
@@ -0,0 +1,65 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include "storage/LatencyTrace.h"
+
+namespace nebula {
+namespace storage {
+
+TEST(LatencyTraceTest, SampleTest) {
+    FLAGS_latency_trace_sample_rate = 0;
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(nullptr, LatencyTrace::sample());
+    }
+    FLAGS_latency_trace_sample_rate = 1;
+    for (int i = 0; i < 100; i++) {
+        EXPECT_NE(nullptr, LatencyTrace::sample());
+    }
+    FLAGS_latency_trace_sample_rate = 0.5;
+    size_t sampled = 0;
+    for (int i = 0; i < 1000; i++) {
+        sampled += LatencyTrace::sample() != nullptr;
+    }
+    EXPECT_LT(0, sampled);
+    EXPECT_GT(1000, sampled);
+    FLAGS_latency_trace_sample_rate = 0;
+}
+
+TEST(LatencyTraceTest, SpanTest) {
+    {
+        // not sampled
+        LatencySpan span(nullptr, LatencyTrace::kKVRead);
+    }
+    LatencyTrace trace;
+    for (size_t stage = 0; stage < LatencyTrace::kNumStages; stage++) {
+        EXPECT_EQ(0, trace.micros(stage));
+    }
+    for (int i = 0; i < 2; i++) {
+        LatencySpan span(&trace, LatencyTrace::kKVRead);
+        usleep(10000);
+    }
+    {
+        LatencySpan span(&trace, LatencyTrace::kFilter);
+        usleep(10000);
+    }
+    EXPECT_LE(20000, trace.micros(LatencyTrace::kKVRead));
+    EXPECT_LE(10000, trace.micros(LatencyTrace::kFilter));
+    EXPECT_EQ(0, trace.micros(LatencyTrace::kDecode));
+    LOG(INFO) << trace.toString();
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -15,6 +15,8 @@
 #include "mock/MockData.h"
 #include "common/interface/gen-cpp2/storage_types.h"
 #include "common/interface/gen-cpp2/common_types.h"
+#include "storage/exec/DeDupNode.h"
+#include "storage/exec/ParallelRangeIterator.h"
 #include "storage/index/LookupProcessor.h"
 #include "codec/test/RowWriterV1.h"
 #include "codec/RowWriterV2.h"
@@ -2913,6 +2915,454 @@ TEST_P(LookupIndexTest, DedupEdgeIndexTest) {
     }
 }
 
+TEST_P(LookupIndexTest, ParallelRangeScanTest) {
+    fs::TempDir rootPath("/tmp/ParallelRangeScanTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    GraphSpaceID spaceId = 1;
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_TRUE(QueryTestUtils::mockVertexData(env, totalParts, true));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+    auto scanPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    // lookup on player where player.name >= "A" and player.name < "Z"
+    auto lookup = [&] () {
+        cpp2::LookupIndexRequest req;
+        req.set_space_id(spaceId);
+        std::vector<PartitionID> parts;
+        for (int32_t p = 1; p <= totalParts; p++) {
+            parts.emplace_back(p);
+        }
+        req.set_parts(std::move(parts));
+        req.set_return_columns({kVid});
+        cpp2::IndexColumnHint columnHint;
+        columnHint.set_column_name("name");
+        columnHint.set_scan_type(cpp2::ScanType::RANGE);
+        columnHint.set_begin_value(Value("A"));
+        columnHint.set_end_value(Value("Z"));
+        cpp2::IndexQueryContext context;
+        context.set_column_hints({columnHint});
+        context.set_filter("");
+        context.set_index_id(1);
+        cpp2::IndexSpec indices;
+        indices.set_tag_or_edge_id(1);
+        indices.set_is_edge(false);
+        indices.set_contexts({context});
+        req.set_indices(std::move(indices));
+
+        auto* processor = LookupProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        return *resp.get_data();
+    };
+
+    auto expected = lookup();
+    ASSERT_LT(10, expected.rows.size());
+
+    auto defaultThreshold = FLAGS_index_scan_parallel_threshold;
+    auto defaultParallelism = FLAGS_index_scan_parallelism;
+    env->edgeScanPool_ = scanPool.get();
+    for (auto threshold : {0, 1, 3}) {
+        for (auto parallelism : {2, 4, 256}) {
+            LOG(INFO) << "Threshold " << threshold << ", parallelism " << parallelism;
+            FLAGS_index_scan_parallel_threshold = threshold;
+            FLAGS_index_scan_parallelism = parallelism;
+            ASSERT_EQ(expected, lookup());
+        }
+    }
+    env->edgeScanPool_ = nullptr;
+    FLAGS_index_scan_parallel_threshold = defaultThreshold;
+    FLAGS_index_scan_parallelism = defaultParallelism;
+
+    {
+        LOG(INFO) << "SplitRange";
+        std::string start = "prefix\x10" "abc";
+        std::string end = "prefix\x80";
+        auto boundaries = ParallelRangeIterator::splitRange(start, end, 4);
+        ASSERT_EQ(5, boundaries.size());
+        ASSERT_EQ(start, boundaries.front());
+        ASSERT_EQ(end, boundaries.back());
+        for (size_t i = 1; i < boundaries.size(); i++) {
+            ASSERT_LT(boundaries[i - 1], boundaries[i]);
+        }
+        // start is a prefix of end
+        boundaries = ParallelRangeIterator::splitRange("prefix", "prefix\x04", 8);
+        ASSERT_EQ(5, boundaries.size());
+        // no room to split
+        ASSERT_EQ(2, ParallelRangeIterator::splitRange("prefix\x10", "prefix\x11", 4).size());
+        ASSERT_EQ(2, ParallelRangeIterator::splitRange(start, end, 1).size());
+    }
+    {
+        LOG(INFO) << "SubRangeError";
+        auto prefix = IndexKeyUtils::indexPrefix(1, 1);
+        auto end = NebulaKeyUtils::prefixEnd(prefix);
+        std::unique_ptr<kvstore::KVIterator> iter;
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  env->kvstore_->range(spaceId, 1, prefix, end, &iter));
+        // the sub-ranges are read from a part not existed, which fail after the first key
+        ParallelRangeIterator parallel(env->kvstore_, spaceId, totalParts + 1, end,
+                                       std::move(iter), scanPool.get(), 1, 4);
+        ASSERT_TRUE(parallel.isParallel());
+        size_t count = 0;
+        for (; parallel.valid(); parallel.next()) {
+            count++;
+        }
+        EXPECT_EQ(1, count);
+        EXPECT_NE(nebula::cpp2::ErrorCode::SUCCEEDED, parallel.status());
+    }
+    {
+        LOG(INFO) << "SubRangeInBatches";
+        auto prefix = IndexKeyUtils::indexPrefix(1, 1);
+        auto end = NebulaKeyUtils::prefixEnd(prefix);
+        std::unique_ptr<kvstore::KVIterator> iter;
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  env->kvstore_->range(spaceId, 1, prefix, end, &iter));
+        std::vector<std::string> keys;
+        for (; iter->valid(); iter->next()) {
+            keys.emplace_back(iter->key().str());
+        }
+        ASSERT_LT(2, keys.size());
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  env->kvstore_->range(spaceId, 1, prefix, end, &iter));
+        // each sub-range is read in batches of 2 keys
+        ParallelRangeIterator parallel(env->kvstore_, spaceId, 1, end,
+                                       std::move(iter), scanPool.get(), 2, 4);
+        std::vector<std::string> actual;
+        for (; parallel.valid(); parallel.next()) {
+            actual.emplace_back(parallel.key().str());
+        }
+        EXPECT_EQ(keys, actual);
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, parallel.status());
+    }
+}
+
+TEST_P(LookupIndexTest, OrderLimitTest) {
+    fs::TempDir rootPath("/tmp/OrderLimitTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    GraphSpaceID spaceId = 1;
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_TRUE(QueryTestUtils::mockVertexData(env, totalParts, true));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    // lookup on player where player.name >= "A" and player.name < "Z" yield name, age
+    auto lookup = [&] (std::vector<std::string> orderBy, int64_t limit) {
+        cpp2::LookupIndexRequest req;
+        req.set_space_id(spaceId);
+        std::vector<PartitionID> parts;
+        for (int32_t p = 1; p <= totalParts; p++) {
+            parts.emplace_back(p);
+        }
+        req.set_parts(std::move(parts));
+        req.set_return_columns({kVid, "name", "age"});
+        cpp2::IndexColumnHint columnHint;
+        columnHint.set_column_name("name");
+        columnHint.set_scan_type(cpp2::ScanType::RANGE);
+        columnHint.set_begin_value(Value("A"));
+        columnHint.set_end_value(Value("Z"));
+        cpp2::IndexQueryContext context;
+        context.set_column_hints({columnHint});
+        context.set_filter("");
+        context.set_index_id(1);
+        cpp2::IndexSpec indices;
+        indices.set_tag_or_edge_id(1);
+        indices.set_is_edge(false);
+        indices.set_contexts({context});
+        req.set_indices(std::move(indices));
+
+        auto* processor = LookupProcessor::instance(env, nullptr, threadPool.get());
+        processor->setOrderLimit(std::move(orderBy), limit);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        return std::move(*resp.data_ref()).rows;
+    };
+
+    auto all = lookup({}, -1);
+    ASSERT_LT(10, all.size());
+    auto less = [] (const Row& lhs, const Row& rhs) {
+        return lhs.values[1] != rhs.values[1] ? lhs.values[1] < rhs.values[1]
+                                              : lhs.values[2] < rhs.values[2];
+    };
+    std::sort(all.begin(), all.end(), less);
+
+    for (size_t limit : {0, 1, 5, 10}) {
+        LOG(INFO) << "Limit " << limit;
+        std::vector<Row> expected(all.begin(), all.begin() + limit);
+        ASSERT_EQ(expected, lookup({"name"}, limit));
+        ASSERT_EQ(expected, lookup({"name", "age"}, limit));
+        // any rows without order
+        ASSERT_EQ(limit, lookup({}, limit).size());
+    }
+    // the limit larger than the rows
+    ASSERT_EQ(all, lookup({"name"}, all.size() + 10));
+    // not a prefix of the index columns, all rows are returned to be sorted
+    ASSERT_EQ(all.size(), lookup({"age"}, 5).size());
+}
+
+TEST_P(LookupIndexTest, IndexIntersectionTest) {
+    fs::TempDir rootPath("/tmp/IndexIntersectionTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    GraphSpaceID spaceId = 1;
+    auto totalParts = cluster.getTotalParts();
+    // another index of player on age
+    {
+        auto* indexMan = dynamic_cast<mock::AdHocIndexManager*>(env->indexMan_);
+        ASSERT_NE(nullptr, indexMan);
+        meta::cpp2::ColumnDef col;
+        col.name = "age";
+        col.type.set_type(meta::cpp2::PropertyType::INT64);
+        std::vector<meta::cpp2::ColumnDef> cols{col};
+        indexMan->addTagIndex(spaceId, 1, 6, std::move(cols));
+    }
+    ASSERT_TRUE(QueryTestUtils::mockVertexData(env, totalParts, true));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    // lookup on player where player.name >= "A" and player.name < "L" and player.age >= 35,
+    // the context of index 1 scans the name, and the context of index 6 scans the age
+    auto nameGE = RelationalExpression::makeGE(pool,
+                                               TagPropertyExpression::make(pool, "player", "name"),
+                                               ConstantExpression::make(pool, Value("A")));
+    auto nameLT = RelationalExpression::makeLT(pool,
+                                               TagPropertyExpression::make(pool, "player", "name"),
+                                               ConstantExpression::make(pool, Value("L")));
+    auto ageGE = RelationalExpression::makeGE(pool,
+                                              TagPropertyExpression::make(pool, "player", "age"),
+                                              ConstantExpression::make(pool, Value(35L)));
+    auto andFilter = LogicalExpression::makeAnd(
+        pool, LogicalExpression::makeAnd(pool, nameGE, nameLT), ageGE)->encode();
+    auto lookup = [&] (const std::string& filter) {
+        cpp2::LookupIndexRequest req;
+        req.set_space_id(spaceId);
+        std::vector<PartitionID> parts;
+        for (int32_t p = 1; p <= totalParts; p++) {
+            parts.emplace_back(p);
+        }
+        req.set_parts(std::move(parts));
+        req.set_return_columns({kVid, "age"});
+
+        cpp2::IndexColumnHint nameHint;
+        nameHint.set_column_name("name");
+        nameHint.set_scan_type(cpp2::ScanType::RANGE);
+        nameHint.set_begin_value(Value("A"));
+        nameHint.set_end_value(Value("L"));
+        cpp2::IndexQueryContext nameContext;
+        nameContext.set_column_hints({nameHint});
+        nameContext.set_filter(filter);
+        nameContext.set_index_id(1);
+
+        cpp2::IndexColumnHint ageHint;
+        ageHint.set_column_name("age");
+        ageHint.set_scan_type(cpp2::ScanType::RANGE);
+        ageHint.set_begin_value(Value(35L));
+        ageHint.set_end_value(Value(200L));
+        cpp2::IndexQueryContext ageContext;
+        ageContext.set_column_hints({ageHint});
+        ageContext.set_filter(filter);
+        ageContext.set_index_id(6);
+
+        cpp2::IndexSpec indices;
+        indices.set_tag_or_edge_id(1);
+        indices.set_is_edge(false);
+        indices.set_contexts({nameContext, ageContext});
+        req.set_indices(std::move(indices));
+
+        auto* processor = LookupProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        auto rows = resp.get_data()->rows;
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    };
+
+    auto expectedOf = [] (bool isOr) {
+        std::vector<Row> rows;
+        std::unordered_set<std::string> names;
+        for (const auto& player : mock::MockData::players_) {
+            bool inName = player.name_ >= "A" && player.name_ < "L";
+            bool inAge = player.age_ >= 35;
+            if ((isOr ? inName || inAge : inName && inAge) &&
+                names.emplace(player.name_).second) {
+                Row row;
+                row.emplace_back(Value(player.name_));
+                row.emplace_back(Value(static_cast<int64_t>(player.age_)));
+                rows.emplace_back(std::move(row));
+            }
+        }
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    };
+    auto expected = expectedOf(false);
+    ASSERT_FALSE(expected.empty());
+
+    auto defaultIntersection = FLAGS_enable_index_intersection;
+    {
+        // without intersection, the two contexts are unioned, each of them is filtered
+        FLAGS_enable_index_intersection = false;
+        EXPECT_EQ(expected, lookup(andFilter));
+    }
+    auto defaultSampleNum = FLAGS_index_estimate_sample_num;
+    {
+        // the index of fewer estimated rows is scanned, the result is the same whichever it is
+        FLAGS_enable_index_intersection = true;
+        EXPECT_EQ(expected, lookup(andFilter));
+    }
+    {
+        // scan the indexes in the request order
+        FLAGS_index_estimate_sample_num = 0;
+        EXPECT_EQ(expected, lookup(andFilter));
+    }
+    {
+        // all estimations reach the limit, the request order is kept
+        FLAGS_index_estimate_sample_num = 1;
+        EXPECT_EQ(expected, lookup(andFilter));
+    }
+    {
+        // the contexts are the branches of an OR, which are unioned even with the intersection
+        auto orFilter = LogicalExpression::makeOr(
+            pool, LogicalExpression::makeAnd(pool, nameGE, nameLT), ageGE)->encode();
+        auto orExpected = expectedOf(true);
+        EXPECT_LT(expected.size(), orExpected.size());
+        EXPECT_EQ(orExpected, lookup(orFilter));
+    }
+    {
+        // a hint not implied by the conjuncts, the contexts are not taken as one condition
+        auto ageFilter = ageGE->encode();
+        FLAGS_enable_index_intersection = false;
+        auto unioned = lookup(ageFilter);
+        FLAGS_enable_index_intersection = true;
+        EXPECT_EQ(unioned, lookup(ageFilter));
+        EXPECT_LT(expected.size(), unioned.size());
+    }
+    FLAGS_enable_index_intersection = defaultIntersection;
+    FLAGS_index_estimate_sample_num = defaultSampleNum;
+}
+
+TEST_P(LookupIndexTest, CompactStringIndexTest) {
+    fs::TempDir rootPath("/tmp/CompactStringIndexTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    GraphSpaceID spaceId = 1;
+    auto totalParts = cluster.getTotalParts();
+    // the name of player is kept in the index as its first 2 bytes and a hash
+    auto defaultPrefixLen = FLAGS_index_string_prefix_len;
+    FLAGS_index_string_prefix_len = 2;
+    ASSERT_TRUE(QueryTestUtils::mockVertexData(env, totalParts, true));
+    auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
+
+    auto lookup = [&] (cpp2::IndexColumnHint hint) {
+        cpp2::LookupIndexRequest req;
+        req.set_space_id(spaceId);
+        std::vector<PartitionID> parts;
+        for (int32_t p = 1; p <= totalParts; p++) {
+            parts.emplace_back(p);
+        }
+        req.set_parts(std::move(parts));
+        req.set_return_columns({kVid, "name"});
+
+        cpp2::IndexQueryContext context;
+        context.set_column_hints({hint});
+        context.set_filter("");
+        context.set_index_id(1);
+        cpp2::IndexSpec indices;
+        indices.set_tag_or_edge_id(1);
+        indices.set_is_edge(false);
+        indices.set_contexts({context});
+        req.set_indices(std::move(indices));
+
+        auto* processor = LookupProcessor::instance(env, nullptr, threadPool.get());
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        auto rows = resp.get_data()->rows;
+        std::sort(rows.begin(), rows.end());
+        return rows;
+    };
+    // the players whose name padded to the index length is in [begin, end)
+    auto expectedOf = [] (const std::string& begin, const std::string& end) {
+        auto encode = [] (const std::string& str) {
+            return IndexKeyUtils::encodeValue(Value(str), 20);
+        };
+        std::set<std::string> names;
+        for (const auto& player : mock::MockData::players_) {
+            auto name = encode(player.name_);
+            if (name >= encode(begin) && name < encode(end)) {
+                names.emplace(player.name_);
+            }
+        }
+        std::vector<Row> expected;
+        for (const auto& name : names) {
+            expected.emplace_back(Row({name, name}));
+        }
+        return expected;
+    };
+
+    {
+        LOG(INFO) << "lookup on player where player.name == \"Tim Duncan\"";
+        cpp2::IndexColumnHint hint;
+        hint.set_column_name("name");
+        hint.set_scan_type(cpp2::ScanType::PREFIX);
+        hint.set_begin_value(Value("Tim Duncan"));
+        auto rows = lookup(hint);
+        ASSERT_EQ(1, rows.size());
+        EXPECT_EQ(Row({"Tim Duncan", "Tim Duncan"}), rows[0]);
+    }
+    {
+        LOG(INFO) << "lookup on player where player.name >= \"Tim Duncan\" and "
+                  << "player.name < \"Tony Parker\"";
+        // the keys of prefix "Ti" and "To" are verified against the rows
+        cpp2::IndexColumnHint hint;
+        hint.set_column_name("name");
+        hint.set_scan_type(cpp2::ScanType::RANGE);
+        hint.set_begin_value(Value("Tim Duncan"));
+        hint.set_end_value(Value("Tony Parker"));
+        auto expected = expectedOf("Tim Duncan", "Tony Parker");
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(expected, lookup(hint));
+    }
+    {
+        LOG(INFO) << "lookup on player where player.name >= \"A\" and player.name < \"L\"";
+        // both boundaries fit in the prefix, nothing is verified
+        cpp2::IndexColumnHint hint;
+        hint.set_column_name("name");
+        hint.set_scan_type(cpp2::ScanType::RANGE);
+        hint.set_begin_value(Value("A"));
+        hint.set_end_value(Value("L"));
+        auto expected = expectedOf("A", "L");
+        ASSERT_FALSE(expected.empty());
+        EXPECT_EQ(expected, lookup(hint));
+    }
+    FLAGS_index_string_prefix_len = defaultPrefixLen;
+}
+
+TEST(DeDupNodeTest, DedupRowsTest) {
+    std::vector<Row> rows;
+    rows.emplace_back(Row({Value("b"), Value(1L), Value(10L)}));
+    rows.emplace_back(Row({Value("a"), Value(2L), Value(20L)}));
+    rows.emplace_back(Row({Value("b"), Value(1L), Value(30L)}));
+    rows.emplace_back(Row({Value("a"), Value(1L), Value(40L)}));
+    rows.emplace_back(Row({Value("a"), Value(2L), Value(50L)}));
+    DeDupNode<IndexID>::dedup(rows, {0, 1});
+
+    // the first row of each key is kept, sorted by the key
+    std::vector<Row> expected;
+    expected.emplace_back(Row({Value("a"), Value(1L), Value(40L)}));
+    expected.emplace_back(Row({Value("a"), Value(2L), Value(20L)}));
+    expected.emplace_back(Row({Value("b"), Value(1L), Value(10L)}));
+    EXPECT_EQ(expected, rows);
+}
+
 INSTANTIATE_TEST_CASE_P(
     Lookup_concurrently,
     LookupIndexTest,
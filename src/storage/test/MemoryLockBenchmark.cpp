@@ -14,6 +14,9 @@
 DEFINE_int64(total_spaces, 10000, "total spaces number");
 DEFINE_int64(num_threads, 100, "threads number");
 DEFINE_int32(num_batch, 10000, "batch write number");
+DEFINE_int32(num_hot_keys, 4, "hot keys number written by all threads");
+DEFINE_int32(num_hot_writes, 10000, "writes number of the hot keys");
+DEFINE_int32(retry_interval_us, 1000, "interval the conflicted write is retried");
 
 namespace nebula {
 namespace storage {
@@ -59,6 +62,38 @@ BENCHMARK_RELATIVE(StringKey) {
     pool->join();
 }
 
+// Holding the lock of a hot key for a few microseconds, which the write takes
+void writeHotKey(StringLock* lock, int64_t i) noexcept {
+    auto key = folly::to<std::string>(i % FLAGS_num_hot_keys);
+    while (true) {
+        nebula::MemoryLockGuard<std::string> lg(lock, key);
+        if (lg) {
+            usleep(10);
+            return;
+        }
+        // Fail fast, the client retries after a while
+        usleep(FLAGS_retry_interval_us);
+    }
+}
+
+void hotKeys(StringLock* lock) {
+    auto pool = std::make_unique<ThreadPool>(FLAGS_num_threads);
+    for (auto i = 0; i < FLAGS_num_hot_writes; ++i) {
+        pool->add(std::bind(writeHotKey, lock, i));
+    }
+    pool->join();
+}
+
+BENCHMARK(HotKeyRetry) {
+    auto lock = std::make_unique<StringLock>();
+    hotKeys(lock.get());
+}
+
+BENCHMARK_RELATIVE(HotKeyWait) {
+    auto lock = std::make_unique<StringLock>(1000, std::numeric_limits<int32_t>::max());
+    hotKeys(lock.get());
+}
+
 }  // namespace storage
 }  // namespace nebula
 
@@ -68,6 +68,62 @@ TEST_F(MemoryLockTest, MoveTest) {
     }
 }
 
+TEST_F(MemoryLockTest, WaitTest) {
+    MemoryLockCore<std::string> mlock(1000, 2);
+    {
+        LockGuard lk1(&mlock, "1");
+        EXPECT_TRUE(lk1);
+
+        // Wait until the key is unlocked
+        auto* lk2 = new LockGuard(&mlock, "2");
+        std::thread t([&mlock] {
+            LockGuard lk(&mlock, std::vector<std::string>{"2", "3"});
+            EXPECT_TRUE(lk);
+        });
+        usleep(100 * 1000);
+        delete lk2;
+        t.join();
+        EXPECT_EQ(1, mlock.size());
+    }
+    EXPECT_EQ(0, mlock.size());
+    {
+        // Fail after waiting for waitMs
+        LockGuard lk1(&mlock, "1");
+        EXPECT_TRUE(lk1);
+        auto start = std::chrono::steady_clock::now();
+        LockGuard lk2(&mlock, "1");
+        EXPECT_FALSE(lk2);
+        EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(1000));
+        EXPECT_EQ("1", lk2.conflictKey());
+    }
+    {
+        // The waiters more than maxWaiters fail at once
+        auto* lk1 = new LockGuard(&mlock, "1");
+        std::vector<std::thread> threads;
+        std::atomic<int32_t> locked{0};
+        for (int i = 0; i < 2; i++) {
+            threads.emplace_back([&mlock, &locked] {
+                LockGuard lk(&mlock, "1");
+                if (lk) {
+                    locked++;
+                }
+            });
+        }
+        usleep(100 * 1000);
+        auto start = std::chrono::steady_clock::now();
+        {
+            LockGuard lk2(&mlock, "1");
+            EXPECT_FALSE(lk2);
+        }
+        EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(500));
+        delete lk1;
+        for (auto& t : threads) {
+            t.join();
+        }
+        EXPECT_EQ(2, locked);
+    }
+}
+
 }  // namespace storage
 }  // namespace nebula
 
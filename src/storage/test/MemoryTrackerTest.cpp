@@ -0,0 +1,85 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include "storage/MemoryTracker.h"
+#include "storage/CommonUtils.h"
+
+namespace nebula {
+namespace storage {
+
+TEST(MemoryTrackerTest, LimitTest) {
+    MemoryTracker root("root", 100);
+    {
+        MemoryTracker space("space", 80, &root);
+        MemoryTracker request("request", 50, &space);
+        const MemoryTracker* exceeded = nullptr;
+        EXPECT_TRUE(request.alloc(40));
+        EXPECT_EQ(40, space.used());
+        EXPECT_EQ(40, root.used());
+
+        // over the limit of the request, nothing is charged
+        EXPECT_FALSE(request.alloc(20, &exceeded));
+        EXPECT_EQ(&request, exceeded);
+        EXPECT_EQ(40, request.used());
+        EXPECT_EQ(40, root.used());
+        EXPECT_EQ(20, request.refused());
+
+        // over the limit of the space, the request is rolled back as well
+        MemoryTracker other("other", 0, &space);
+        EXPECT_TRUE(other.alloc(30));
+        EXPECT_FALSE(request.alloc(10, &exceeded));
+        EXPECT_EQ(&space, exceeded);
+        EXPECT_EQ(40, request.used());
+        EXPECT_EQ(70, space.used());
+        EXPECT_EQ(70, root.used());
+
+        request.free(40);
+        EXPECT_EQ(0, request.used());
+        EXPECT_EQ(40, request.peak());
+        EXPECT_EQ(30, root.used());
+    }
+    // the bytes left are freed with the trackers destroyed
+    EXPECT_EQ(0, root.used());
+    EXPECT_EQ(70, root.peak());
+}
+
+TEST(MemoryTrackerTest, QueryBudgetTest) {
+    {
+        // no limit is set by default
+        EXPECT_EQ(nullptr, MemoryTracker::forRequest(1));
+        EXPECT_EQ(nullptr, QueryBudget::fromFlags(1));
+    }
+    {
+        FLAGS_query_max_memory_bytes = 100;
+        auto budget = QueryBudget::fromFlags(1);
+        ASSERT_NE(nullptr, budget);
+        auto* space = MemoryTracker::space(1);
+        EXPECT_TRUE(budget->consume(60));
+        EXPECT_EQ(60, space->used());
+        EXPECT_FALSE(budget->consume(60));
+        EXPECT_TRUE(budget->exhausted());
+        EXPECT_TRUE(budget->memoryExceeded());
+        EXPECT_EQ(60, space->used());
+
+        // the memory of the request is released with the budget
+        budget.reset();
+        EXPECT_EQ(0, space->used());
+        EXPECT_EQ(0, MemoryTracker::process().used());
+        FLAGS_query_max_memory_bytes = 0;
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,140 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include <gtest/gtest.h>
+#include "common/expression/ConstantExpression.h"
+#include "kvstore/RocksEngine.h"
+#include "mock/AdHocSchemaManager.h"
+#include "storage/MergeOperator.h"
+#include "utils/NebulaKeyUtils.h"
+
+namespace nebula {
+namespace storage {
+
+class MergeOperatorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        rootPath_ = std::make_unique<fs::TempDir>("/tmp/MergeOperatorTest.XXXXXX");
+        schemaMan_ = std::make_unique<mock::AdHocSchemaManager>();
+        auto schema = std::make_shared<meta::NebulaSchemaProvider>(0);
+        schema->addField("count", meta::cpp2::PropertyType::INT64, 0, false,
+                         ConstantExpression::make(&pool_, 0L));
+        schema->addField("score", meta::cpp2::PropertyType::DOUBLE, 0, true);
+        schema->addField("log", meta::cpp2::PropertyType::STRING, 0, false,
+                         ConstantExpression::make(&pool_, std::string("")));
+        schemaMan_->addTagSchema(kSpace, kTag, schema);
+        engine_ = std::make_unique<kvstore::RocksEngine>(
+            kSpace, kVIdLen, rootPath_->path(), "",
+            std::make_shared<NebulaOperator>(schemaMan_.get()));
+        engine_->addPart(1);
+    }
+
+    void merge(const MergeOperand::Props& props) {
+        auto batch = engine_->startBatchWrite();
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  batch->merge(key_, MergeOperand::encode(kSpace, false, kTag, props)));
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  engine_->commitBatchWrite(std::move(batch), false, false, true));
+    }
+
+    Value read(const std::string& prop) {
+        std::string val;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine_->get(key_, &val));
+        auto reader = RowReaderWrapper::getTagPropReader(schemaMan_.get(), kSpace, kTag, val);
+        EXPECT_TRUE(!!reader);
+        return reader->getValueByName(prop);
+    }
+
+    static constexpr GraphSpaceID kSpace = 1;
+    static constexpr TagID kTag = 1;
+    static constexpr int32_t kVIdLen = 8;
+
+    ObjectPool pool_;
+    std::unique_ptr<fs::TempDir> rootPath_;
+    std::unique_ptr<mock::AdHocSchemaManager> schemaMan_;
+    std::unique_ptr<kvstore::RocksEngine> engine_;
+    std::string key_{NebulaKeyUtils::vertexKey(kVIdLen, 1, "v1", kTag)};
+};
+
+TEST_F(MergeOperatorTest, OperandCodecTest) {
+    MergeOperand::Props props{{"count", 1L}, {"score", 0.5}, {"log", std::string("a")}};
+    auto operand = MergeOperand::encode(kSpace, true, -kTag, props);
+
+    GraphSpaceID space = 0;
+    bool isEdge = false;
+    int32_t schemaId = 0;
+    MergeOperand::Props decoded;
+    ASSERT_TRUE(MergeOperand::decode(operand, &space, &isEdge, &schemaId, &decoded));
+    EXPECT_EQ(kSpace, space);
+    EXPECT_TRUE(isEdge);
+    EXPECT_EQ(-kTag, schemaId);
+    EXPECT_EQ(props, decoded);
+
+    decoded.clear();
+    EXPECT_FALSE(MergeOperand::decode(folly::StringPiece(operand).subpiece(0, operand.size() - 1),
+                                      &space, &isEdge, &schemaId, &decoded));
+}
+
+TEST_F(MergeOperatorTest, MergeWithoutRowTest) {
+    merge({{"count", 1L}, {"log", std::string("a")}});
+    merge({{"count", 2L}, {"log", std::string("b")}});
+    EXPECT_EQ(3, read("count").getInt());
+    EXPECT_EQ("ab", read("log").getStr());
+    // the prop not merged is the default value or null
+    EXPECT_TRUE(read("score").isNull());
+}
+
+TEST_F(MergeOperatorTest, MergeWithRowTest) {
+    auto schema = schemaMan_->getTagSchema(kSpace, kTag);
+    RowWriterV2 writer(schema.get());
+    ASSERT_EQ(WriteResult::SUCCEEDED, writer.setValue("count", 10L));
+    ASSERT_EQ(WriteResult::SUCCEEDED, writer.setValue("score", 1.5));
+    ASSERT_EQ(WriteResult::SUCCEEDED, writer.setValue("log", std::string("x")));
+    ASSERT_EQ(WriteResult::SUCCEEDED, writer.finish());
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine_->put(key_, writer.moveEncodedStr()));
+
+    merge({{"count", -3L}, {"score", 1.0}});
+    merge({{"log", std::string("y")}});
+    EXPECT_EQ(7, read("count").getInt());
+    EXPECT_DOUBLE_EQ(2.5, read("score").getFloat());
+    EXPECT_EQ("xy", read("log").getStr());
+
+    // the merged row is written back by compaction
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine_->compact());
+    EXPECT_EQ(7, read("count").getInt());
+    EXPECT_EQ("xy", read("log").getStr());
+}
+
+TEST_F(MergeOperatorTest, MergeStaleOperandTest) {
+    merge({{"count", 1L}});
+    // the prop not in the schema is skipped, e.g. dropped after the operand is written
+    merge({{"dropped", 1L}, {"count", 1L}});
+    // the prop which can't be merged keeps its value
+    merge({{"count", std::string("a")}});
+    // the bad operand is skipped
+    {
+        auto batch = engine_->startBatchWrite();
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, batch->merge(key_, "bad"));
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  engine_->commitBatchWrite(std::move(batch), false, false, true));
+    }
+    EXPECT_EQ(2, read("count").getInt());
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine_->compact());
+    EXPECT_EQ(2, read("count").getInt());
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
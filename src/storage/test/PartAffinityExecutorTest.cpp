@@ -0,0 +1,48 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include <folly/futures/Future.h>
+#include "storage/PartAffinityExecutor.h"
+
+namespace nebula {
+namespace storage {
+
+TEST(PartAffinityExecutorTest, SameThreadTest) {
+    for (bool pinCores : {false, true}) {
+        PartAffinityExecutor executor(4, pinCores);
+        ASSERT_EQ(4, executor.shards());
+        std::mutex lock;
+        std::unordered_map<PartitionID, std::set<std::thread::id>> threads;
+        std::vector<folly::Future<folly::Unit>> futures;
+        for (int32_t i = 0; i < 100; i++) {
+            PartitionID partId = i % 10 + 1;
+            futures.emplace_back(folly::via(executor.executorOf(1, partId), [&, partId] {
+                std::lock_guard<std::mutex> g(lock);
+                threads[partId].emplace(std::this_thread::get_id());
+            }));
+        }
+        folly::collectAll(std::move(futures)).wait();
+        ASSERT_EQ(10, threads.size());
+        for (const auto& part : threads) {
+            // all the tasks of a part run on its thread
+            EXPECT_EQ(1, part.second.size());
+        }
+        EXPECT_EQ(executor.executorOf(1, 1), executor.executorOf(1, 1));
+        executor.stop();
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,93 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include "storage/PartTraffic.h"
+
+namespace nebula {
+namespace storage {
+
+using Kind = PartTraffic::Kind;
+
+TEST(PartTrafficTest, LoadTest) {
+    std::vector<std::tuple<GraphSpaceID, PartitionID, PartTraffic::Load>> reported;
+    PartTraffic traffic(1, 3, [&] (GraphSpaceID spaceId, PartitionID partId, const auto& load) {
+        reported.emplace_back(spaceId, partId, load);
+    });
+    traffic.record(1, 1, Kind::READ, 10, 0);
+    traffic.record(1, 1, Kind::WRITE, 5, 500);
+    traffic.record(1, 2, Kind::READ, 1, 0);
+    traffic.record(2, 1, Kind::WRITE, 1, 100);
+    // nothing is served until the window is rotated
+    ASSERT_TRUE(traffic.spaces().empty());
+    sleep(1);
+    traffic.rotate();
+
+    ASSERT_EQ((std::vector<GraphSpaceID>{1, 2}), traffic.spaces());
+    auto loads = traffic.loads(1);
+    ASSERT_EQ(2, loads.size());
+    // the window is a bit longer than a second
+    ASSERT_GT(loads[1].readQps, 5);
+    ASSERT_LE(loads[1].readQps, 10);
+    ASSERT_GT(loads[1].writeQps, 2.5);
+    ASSERT_LE(loads[1].writeQps, 5);
+    ASSERT_GT(loads[1].writeBytesPerSec, 250);
+    ASSERT_LE(loads[1].writeBytesPerSec, 500);
+    ASSERT_EQ(0, loads[2].writeQps);
+    ASSERT_EQ(3, reported.size());
+
+    // the parts without traffic in the window are not reported
+    reported.clear();
+    traffic.record(1, 2, Kind::READ, 1, 0);
+    traffic.rotate();
+    ASSERT_EQ(1, traffic.loads(1).size());
+    ASSERT_TRUE(traffic.loads(2).empty());
+    ASSERT_EQ(1, reported.size());
+    ASSERT_EQ(2, std::get<1>(reported[0]));
+}
+
+TEST(PartTrafficTest, HotVertexTest) {
+    PartTraffic traffic(1, 3);
+    // vertex i of part 1 is requested i times, and 1000 cold vertices once of part 2
+    for (int32_t i = 1; i <= 10; i++) {
+        for (int32_t j = 0; j < i * 10; j++) {
+            traffic.recordVertex(1, 1, folly::to<std::string>(i));
+        }
+    }
+    for (int32_t i = 0; i < 1000; i++) {
+        traffic.recordVertex(1, 2, folly::stringPrintf("cold_%d", i));
+    }
+    traffic.rotate();
+
+    auto hot = traffic.hotVertices(1);
+    ASSERT_EQ(3, hot.size());
+    for (size_t i = 0; i < hot.size(); i++) {
+        EXPECT_EQ(1, hot[i].partId);
+        EXPECT_EQ(folly::to<std::string>(10 - i), hot[i].vid);
+        // the estimate is never below the count
+        EXPECT_GE(hot[i].count, (10 - i) * 10);
+    }
+    ASSERT_TRUE(traffic.hotVertices(2).empty());
+
+    // the sketch is reset by the rotation
+    traffic.recordVertex(1, 1, "1");
+    traffic.rotate();
+    hot = traffic.hotVertices(1);
+    ASSERT_EQ(1, hot.size());
+    ASSERT_EQ("1", hot[0].vid);
+    ASSERT_EQ(1, hot[0].count);
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -10,6 +10,7 @@
 #include "common/fs/TempDir.h"
 #include "kvstore/RocksEngineConfig.h"
 #include "mock/MockCluster.h"
+#include "utils/IndexKeyUtils.h"
 #include "utils/NebulaKeyUtils.h"
 #include <gtest/gtest.h>
 
@@ -66,6 +67,55 @@ void testPrefixSeek(StorageEnv* env, int32_t partCount, int32_t iters) {
     }
 }
 
+// index on an int column, each vertex has a distinct value
+void mockIndexData(StorageEnv* env, int32_t partCount) {
+    LOG(INFO) << "Prepare index data...";
+    size_t vIdLen = 16;
+    GraphSpaceID spaceId = 1;
+    IndexID indexId = 1;
+    for (PartitionID partId = 1; partId <= partCount; partId++) {
+        std::vector<kvstore::KV> data;
+        for (int64_t vertexId = partId * FLAGS_vertex_per_part;
+             vertexId < (partId + 1) * FLAGS_vertex_per_part;
+             vertexId++) {
+            auto key = IndexKeyUtils::vertexIndexKey(vIdLen, partId, indexId,
+                                                     std::to_string(vertexId),
+                                                     IndexKeyUtils::encodeValue(Value(vertexId)));
+            data.emplace_back(std::move(key), "");
+        }
+        folly::Baton<true, std::atomic> baton;
+        env->kvstore_->asyncMultiPut(spaceId, partId, std::move(data),
+                                     [&](nebula::cpp2::ErrorCode code) {
+            ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+            folly::doNotOptimizeAway(code);
+        });
+        baton.wait();
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, env->kvstore_->flush(spaceId));
+    }
+}
+
+// equality probe on index, half of them hit nothing
+void testIndexPrefixSeek(StorageEnv* env, int32_t partCount, int32_t iters) {
+    GraphSpaceID spaceId = 1;
+    IndexID indexId = 1;
+    for (decltype(iters) i = 0; i < iters; i++) {
+        for (PartitionID partId = 1; partId <= partCount; partId++) {
+            for (int64_t vertexId = partId * FLAGS_vertex_per_part;
+                 vertexId < (partId + 1) * FLAGS_vertex_per_part;
+                 vertexId++) {
+                auto value = vertexId % 2 == 0 ? vertexId : -vertexId;
+                auto prefix = IndexKeyUtils::indexPrefix(partId, indexId) +
+                              IndexKeyUtils::encodeValue(Value(value));
+                std::unique_ptr<kvstore::KVIterator> iter;
+                auto code = env->kvstore_->prefix(spaceId, partId, prefix, &iter);
+                ASSERT_EQ(code, nebula::cpp2::ErrorCode::SUCCEEDED);
+                CHECK_EQ(value >= 0, iter->valid());
+            }
+        }
+    }
+}
+
 BENCHMARK(PrefixWithFilterOff, n) {
     folly::BenchmarkSuspender braces;
     FLAGS_rocksdb_column_family_options = R"({
@@ -99,6 +149,43 @@ BENCHMARK_RELATIVE(PrefixWithFilterOn, n) {
     testPrefixSeek(env, partCount, n);
 }
 
+BENCHMARK_DRAW_LINE();
+
+BENCHMARK(IndexPrefixWithFilterOff, n) {
+    folly::BenchmarkSuspender braces;
+    FLAGS_rocksdb_column_family_options = R"({
+        "level0_file_num_compaction_trigger":"100"
+    })";
+    FLAGS_enable_rocksdb_prefix_filtering = false;
+    FLAGS_rocksdb_block_cache = 0;
+    fs::TempDir rootPath("/tmp/GetPropTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto partCount = cluster.getTotalParts();
+    auto* env = cluster.storageEnv_.get();
+    mockIndexData(env, partCount);
+    braces.dismiss();
+    testIndexPrefixSeek(env, partCount, n);
+}
+
+BENCHMARK_RELATIVE(IndexPrefixWithFilterOn, n) {
+    folly::BenchmarkSuspender braces;
+    FLAGS_rocksdb_column_family_options = R"({
+        "level0_file_num_compaction_trigger":"100"
+    })";
+    FLAGS_enable_rocksdb_prefix_filtering = true;
+    FLAGS_rocksdb_index_prefix_bloom_filter_length = sizeof(int64_t);
+    FLAGS_rocksdb_block_cache = 0;
+    fs::TempDir rootPath("/tmp/GetPropTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto partCount = cluster.getTotalParts();
+    auto* env = cluster.storageEnv_.get();
+    mockIndexData(env, partCount);
+    braces.dismiss();
+    testIndexPrefixSeek(env, partCount, n);
+}
+
 }  // namespace storage
 }  // namespace nebula
 
@@ -0,0 +1,106 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/synchronization/Baton.h>
+#include "storage/PriorityExecutor.h"
+
+namespace nebula {
+namespace storage {
+
+// The order of the tasks added by the views of low, mid and high priority in turn, while the
+// only thread of the pool is blocked
+std::vector<int8_t> runOrder(bool supportPriority) {
+    folly::CPUThreadPoolExecutor pool(1, 3);
+    PriorityExecutor low(&pool, folly::Executor::LO_PRI, supportPriority);
+    PriorityExecutor mid(&pool, folly::Executor::MID_PRI, supportPriority);
+    PriorityExecutor high(&pool, folly::Executor::HI_PRI, supportPriority);
+
+    folly::Baton<> started;
+    folly::Baton<> blocked;
+    pool.add([&] {
+        started.post();
+        blocked.wait();
+    });
+    started.wait();
+
+    std::mutex lock;
+    std::vector<int8_t> order;
+    std::vector<std::pair<PriorityExecutor*, int8_t>> views = {
+        {&low, folly::Executor::LO_PRI},
+        {&mid, folly::Executor::MID_PRI},
+        {&high, folly::Executor::HI_PRI}};
+    for (int32_t i = 0; i < 3; i++) {
+        for (const auto& view : views) {
+            auto priority = view.second;
+            view.first->add([&, priority] {
+                std::lock_guard<std::mutex> g(lock);
+                order.emplace_back(priority);
+            });
+        }
+    }
+    blocked.post();
+    pool.join();
+    return order;
+}
+
+TEST(PriorityExecutorTest, PriorityTest) {
+    // the tasks of higher priority run first, the ones of the same priority in order
+    auto order = runOrder(true);
+    std::vector<int8_t> expected;
+    for (auto priority : {folly::Executor::HI_PRI,
+                          folly::Executor::MID_PRI,
+                          folly::Executor::LO_PRI}) {
+        expected.insert(expected.end(), 3, priority);
+    }
+    EXPECT_EQ(expected, order);
+}
+
+TEST(PriorityExecutorTest, NoPriorityTest) {
+    // the tasks are added as they are, which run in order
+    auto order = runOrder(false);
+    std::vector<int8_t> expected;
+    for (int32_t i = 0; i < 3; i++) {
+        expected.emplace_back(folly::Executor::LO_PRI);
+        expected.emplace_back(folly::Executor::MID_PRI);
+        expected.emplace_back(folly::Executor::HI_PRI);
+    }
+    EXPECT_EQ(expected, order);
+}
+
+TEST(PriorityExecutorTest, AddWithPriorityTest) {
+    // the priority given explicitly, e.g. by a sub task, takes over the one of the view
+    folly::CPUThreadPoolExecutor pool(1, 3);
+    PriorityExecutor low(&pool, folly::Executor::LO_PRI, true);
+    EXPECT_EQ(3, low.getNumPriorities());
+
+    folly::Baton<> started;
+    folly::Baton<> blocked;
+    pool.add([&] {
+        started.post();
+        blocked.wait();
+    });
+    started.wait();
+
+    std::vector<int32_t> order;
+    low.add([&] { order.emplace_back(1); });
+    low.addWithPriority([&] { order.emplace_back(2); }, folly::Executor::HI_PRI);
+    blocked.post();
+    pool.join();
+    EXPECT_EQ((std::vector<int32_t>{2, 1}), order);
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -9,6 +9,7 @@
 #include <gtest/gtest.h>
 #include "mock/MockCluster.h"
 #include "mock/MockData.h"
+#include "storage/StorageFlags.h"
 #include "storage/admin/AdminTaskManager.h"
 #include "storage/admin/RebuildTagIndexTask.h"
 #include "storage/admin/RebuildEdgeIndexTask.h"
@@ -17,6 +18,7 @@
 #include "storage/mutate/DeleteVerticesProcessor.h"
 #include "storage/mutate/DeleteEdgesProcessor.h"
 #include "storage/test/TestUtils.h"
+#include "utils/OperationKeyUtils.h"
 
 namespace nebula {
 namespace storage {
@@ -554,6 +556,167 @@ TEST_F(RebuildIndexTest, RebuildEdgeIndex) {
     }
 }
 
+TEST_F(RebuildIndexTest, SplitPartTest) {
+    auto prefix = NebulaKeyUtils::vertexPrefix(1);
+    {
+        auto boundaries = RebuildIndexTask::splitPart(prefix, 1);
+        ASSERT_EQ(2, boundaries.size());
+        EXPECT_EQ(prefix, boundaries.front());
+        EXPECT_EQ(NebulaKeyUtils::vertexPrefix(2).size(), boundaries.back().size());
+        EXPECT_LT(prefix, boundaries.back());
+    }
+    {
+        auto boundaries = RebuildIndexTask::splitPart(prefix, 4);
+        ASSERT_EQ(5, boundaries.size());
+        for (size_t i = 0; i + 1 < boundaries.size(); i++) {
+            EXPECT_LT(boundaries[i], boundaries[i + 1]);
+        }
+        // every key of the part is in one of the ranges
+        auto key = NebulaKeyUtils::vertexKey(8, 1, "\xff\xff", 1);
+        EXPECT_LE(boundaries[3], key);
+        EXPECT_LT(key, boundaries[4]);
+    }
+}
+
+TEST_F(RebuildIndexTest, RebuildTagIndexInRanges) {
+    auto ranges = FLAGS_rebuild_index_part_ranges;
+    auto rateLimit = FLAGS_rebuild_index_rate_limit;
+    FLAGS_rebuild_index_part_ranges = 4;
+    FLAGS_rebuild_index_rate_limit = 1;
+
+    // Add Vertices
+    auto* processor = AddVerticesProcessor::instance(RebuildIndexTest::env_, nullptr);
+    cpp2::AddVerticesRequest req = mock::MockData::mockAddVerticesReq();
+    auto fut = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(fut).get();
+    EXPECT_EQ(0, resp.result.failed_parts.size());
+
+    cpp2::TaskPara parameter;
+    parameter.set_space_id(1);
+    std::vector<PartitionID> parts = {1, 2, 3, 4, 5, 6};
+    parameter.set_parts(std::move(parts));
+    parameter.set_task_specfic_paras({"4", "5"});
+
+    cpp2::AddAdminTaskRequest request;
+    request.set_cmd(meta::cpp2::AdminCmd::REBUILD_TAG_INDEX);
+    request.set_job_id(7);
+    request.set_task_id(17);
+    request.set_para(std::move(parameter));
+
+    auto callback = [](nebula::cpp2::ErrorCode, nebula::meta::cpp2::StatisItem&) {};
+    TaskContext context(request, callback);
+
+    auto task = std::make_shared<RebuildTagIndexTask>(RebuildIndexTest::env_, std::move(context));
+    manager_->addAsyncTask(task);
+
+    // Wait for the task finished
+    do {
+        usleep(50);
+    } while (!manager_->isFinished(context.jobId_, context.taskId_));
+
+    // Check the result
+    LOG(INFO) << "Check rebuild tag index in ranges...";
+    for (auto& key : mock::MockData::mockPlayerIndexKeys()) {
+        std::string value;
+        auto code = RebuildIndexTest::env_->kvstore_->get(1, key.first, key.second, &value);
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+    }
+    for (PartitionID part = 1; part <= 6; part++) {
+        EXPECT_EQ(IndexState::FINISHED,
+                  RebuildIndexTest::env_->getIndexState(1, part));
+    }
+
+    RebuildIndexTest::env_->rebuildIndexGuard_->clear();
+    FLAGS_rebuild_index_part_ranges = ranges;
+    FLAGS_rebuild_index_rate_limit = rateLimit;
+    sleep(1);
+}
+
+TEST_F(RebuildIndexTest, RebuildTagIndexResume) {
+    FLAGS_rebuild_index_resume = true;
+    auto* kv = RebuildIndexTest::env_->kvstore_;
+
+    // Add Vertices
+    auto* processor = AddVerticesProcessor::instance(RebuildIndexTest::env_, nullptr);
+    cpp2::AddVerticesRequest req = mock::MockData::mockAddVerticesReq();
+    auto fut = processor->getFuture();
+    processor->process(req);
+    auto resp = std::move(fut).get();
+    EXPECT_EQ(0, resp.result.failed_parts.size());
+
+    auto rebuild = [](JobID jobId, TaskID taskId) {
+        cpp2::TaskPara parameter;
+        parameter.set_space_id(1);
+        std::vector<PartitionID> parts = {1, 2, 3, 4, 5, 6};
+        parameter.set_parts(std::move(parts));
+        parameter.set_task_specfic_paras({"4", "5"});
+
+        cpp2::AddAdminTaskRequest request;
+        request.set_cmd(meta::cpp2::AdminCmd::REBUILD_TAG_INDEX);
+        request.set_job_id(jobId);
+        request.set_task_id(taskId);
+        request.set_para(std::move(parameter));
+
+        auto callback = [](nebula::cpp2::ErrorCode, nebula::meta::cpp2::StatisItem&) {};
+        TaskContext context(request, callback);
+        auto task = std::make_shared<RebuildTagIndexTask>(RebuildIndexTest::env_,
+                                                          std::move(context));
+        manager_->addAsyncTask(task);
+        do {
+            usleep(50);
+        } while (!manager_->isFinished(jobId, taskId));
+        RebuildIndexTest::env_->rebuildIndexGuard_->clear();
+    };
+    auto keysOf = [kv](PartitionID part, const std::string& prefix) {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, kv->prefix(1, part, prefix, &iter));
+        std::vector<std::string> keys;
+        for (; iter && iter->valid(); iter->next()) {
+            keys.emplace_back(iter->key().str());
+        }
+        return keys;
+    };
+
+    rebuild(8, 18);
+    for (PartitionID part = 1; part <= 6; part++) {
+        EXPECT_LT(0, keysOf(part, IndexKeyUtils::indexPrefix(part)).size());
+        // the checkpoints are removed once the part is finished
+        EXPECT_EQ(0, keysOf(part, OperationKeyUtils::operationPrefix(part)).size());
+    }
+
+    // Part 1 is checkpointed as done before the restart, without the index
+    auto indexKeys = keysOf(1, IndexKeyUtils::indexPrefix(1));
+    folly::Baton<true, std::atomic> baton;
+    kv->asyncMultiRemove(1, 1, std::move(indexKeys), [&baton](nebula::cpp2::ErrorCode code) {
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+        baton.post();
+    });
+    baton.wait();
+    auto start = NebulaKeyUtils::vertexPrefix(1);
+    auto end = RebuildIndexTask::splitPart(start, 1).back();
+    std::vector<kvstore::KV> checkpoint;
+    checkpoint.emplace_back(OperationKeyUtils::checkpointKey(1, start),
+                            RebuildIndexTask::encodeCheckpoint(end, {5, 4}, true, ""));
+    baton.reset();
+    kv->asyncMultiPut(1, 1, std::move(checkpoint), [&baton](nebula::cpp2::ErrorCode code) {
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+        baton.post();
+    });
+    baton.wait();
+
+    // The job resubmitted skips part 1
+    rebuild(9, 19);
+    EXPECT_EQ(0, keysOf(1, IndexKeyUtils::indexPrefix(1)).size());
+    for (PartitionID part = 2; part <= 6; part++) {
+        EXPECT_LT(0, keysOf(part, IndexKeyUtils::indexPrefix(part)).size());
+    }
+    EXPECT_EQ(0, keysOf(1, OperationKeyUtils::operationPrefix(1)).size());
+
+    FLAGS_rebuild_index_resume = false;
+    sleep(1);
+}
+
 }  // namespace storage
 }  // namespace nebula
 
@@ -0,0 +1,87 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include "storage/RequestArena.h"
+
+namespace nebula {
+namespace storage {
+
+TEST(RequestArenaTest, AllocateTest) {
+    RequestArena arena(64);
+    {
+        auto* buf = arena.allocate(3);
+        ASSERT_EQ(0, reinterpret_cast<uintptr_t>(buf) % 8);
+        ASSERT_EQ(8, arena.used());
+        ASSERT_EQ(64, arena.capacity());
+    }
+    {
+        // the large buffer takes a block of its own
+        auto* buf = arena.allocate(100);
+        ASSERT_EQ(0, reinterpret_cast<uintptr_t>(buf) % 8);
+        ASSERT_EQ(8 + 104, arena.used());
+        ASSERT_EQ(64 + 104, arena.capacity());
+    }
+    {
+        // not enough room in current block
+        arena.allocate(16);
+        ASSERT_EQ(8 + 104 + 16, arena.used());
+        ASSERT_EQ(64 + 104 + 64, arena.capacity());
+    }
+}
+
+TEST(RequestArenaTest, CopyTest) {
+    RequestArena arena(64);
+    std::vector<std::string> strs;
+    std::vector<folly::StringPiece> copied;
+    for (size_t i = 0; i < 100; i++) {
+        strs.emplace_back(folly::stringPrintf("string_%lu", i));
+        copied.emplace_back(arena.copy(strs.back()));
+    }
+    for (size_t i = 0; i < 100; i++) {
+        ASSERT_EQ(strs[i], copied[i].str());
+        ASSERT_NE(strs[i].data(), copied[i].data());
+    }
+    ASSERT_TRUE(arena.copy("").empty());
+}
+
+TEST(RequestArenaTest, ResetTest) {
+    RequestArena arena(64);
+    for (size_t i = 0; i < 10; i++) {
+        arena.copy(std::string(40, 'a'));
+    }
+    auto capacity = arena.capacity();
+    ASSERT_EQ(10 * 64, capacity);
+
+    // the blocks are reused after reset
+    for (size_t round = 0; round < 10; round++) {
+        arena.reset();
+        ASSERT_EQ(0, arena.used());
+        for (size_t i = 0; i < 10; i++) {
+            auto str = std::string(40, 'a' + i);
+            ASSERT_EQ(str, arena.copy(str).str());
+        }
+        ASSERT_EQ(capacity, arena.capacity());
+    }
+
+    // move keeps the buffers
+    auto copied = arena.copy("nebula");
+    RequestArena moved(std::move(arena));
+    ASSERT_EQ("nebula", copied.str());
+    ASSERT_EQ(capacity, moved.capacity());
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,126 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include "storage/RequestProfile.h"
+#include "storage/exec/StoragePlan.h"
+
+namespace nebula {
+namespace storage {
+
+class SleepNode : public RelNode<VertexID> {
+public:
+    explicit SleepNode(int32_t us) : us_(us) {}
+
+    nebula::cpp2::ErrorCode execute(PartitionID partId, const VertexID& vId) override {
+        auto ret = RelNode::execute(partId, vId);
+        if (ret != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            return ret;
+        }
+        usleep(us_);
+        return nebula::cpp2::ErrorCode::SUCCEEDED;
+    }
+
+private:
+    int32_t us_;
+};
+
+TEST(RequestProfileTest, CreateTest) {
+    FLAGS_slow_request_threshold_ms = 0;
+    EXPECT_EQ(nullptr, RequestProfile::create("GetNeighbors", 1));
+    FLAGS_slow_request_threshold_ms = 100;
+    EXPECT_NE(nullptr, RequestProfile::create("GetNeighbors", 1));
+    FLAGS_slow_request_threshold_ms = 0;
+}
+
+TEST(RequestProfileTest, PlanTest) {
+    auto profile = std::make_shared<RequestProfile>("GetNeighbors", 1);
+    {
+        StoragePlan<VertexID> plan;
+        auto leaf = std::make_unique<SleepNode>(1000);
+        auto root = std::make_unique<SleepNode>(2000);
+        root->addDependency(leaf.get());
+        plan.addNode(std::move(leaf));
+        plan.addNode(std::move(root));
+        plan.setProfile(profile);
+        for (PartitionID partId = 1; partId <= 2; partId++) {
+            ProfileSpan span(profile, partId);
+            for (int32_t i = 0; i < 3; i++) {
+                ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                          plan.go(partId, folly::to<std::string>(i)));
+            }
+        }
+        // the plan is merged into the profile when it is destroyed
+    }
+    profile->setRows(6);
+
+    std::vector<cpp2::PartitionResult> failedParts(1);
+    failedParts[0].set_part_id(2);
+    failedParts[0].set_code(nebula::cpp2::ErrorCode::E_LEADER_CHANGED);
+    auto str = profile->toString(12345, failedParts);
+    LOG(INFO) << str;
+    EXPECT_NE(std::string::npos, str.find("Slow GetNeighbors of space 1 took 12345us"));
+    EXPECT_NE(std::string::npos, str.find("returned 6 rows"));
+    EXPECT_NE(std::string::npos, str.find("2: E_LEADER_CHANGED"));
+    // both nodes are executed 3 times of each part, the root including the leaf
+    EXPECT_NE(std::string::npos, str.find("#0 SleepNode: 6 calls"));
+    EXPECT_NE(std::string::npos, str.find("#1 SleepNode: 6 calls"));
+    EXPECT_NE(std::string::npos, str.find("rocksdb [block reads 0"));
+}
+
+TEST(RequestProfileTest, SampleTest) {
+    FLAGS_slow_request_threshold_ms = 0;
+    FLAGS_rocksdb_perf_context_sample_rate = 1;
+    {
+        auto profile = RequestProfile::create("ScanEdge", 2);
+        ASSERT_NE(nullptr, profile);
+        RequestProfile::PerfCounters perf;
+        perf.deletesSkipped = 100;
+        perf.bytesRead = 4096;
+        profile->addPart(1, 1000, perf);
+        profile->addPart(2, 1000, perf);
+        profile->finish(100, {});
+    }
+    {
+        auto profile = RequestProfile::create("ScanEdge", 2);
+        ASSERT_NE(nullptr, profile);
+        profile->finish(100, {});
+    }
+    FLAGS_rocksdb_perf_context_sample_rate = 0;
+    EXPECT_EQ(nullptr, RequestProfile::create("ScanEdge", 2));
+
+    auto snapshot = RequestPerfStats::instance().snapshot();
+    auto it = snapshot.find(std::make_pair(std::string("ScanEdge"), 2));
+    ASSERT_NE(snapshot.end(), it);
+    EXPECT_EQ(2, it->second.requests);
+    EXPECT_EQ(200, it->second.perf.deletesSkipped);
+    EXPECT_EQ(8192, it->second.perf.bytesRead);
+    EXPECT_EQ(0, it->second.perf.blockReads);
+}
+
+TEST(RequestProfileTest, NotProfiledTest) {
+    // the nodes are not timed without a profile
+    StoragePlan<VertexID> plan;
+    auto node = std::make_unique<SleepNode>(0);
+    auto* raw = node.get();
+    plan.addNode(std::move(node));
+    ProfileSpan span(nullptr, 1);
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, plan.go(1, "1"));
+    EXPECT_FALSE(raw->profiled_);
+    EXPECT_EQ(0, raw->calls_);
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
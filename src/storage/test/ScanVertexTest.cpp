@@ -7,6 +7,8 @@
 #include "common/base/Base.h"
 #include "common/fs/TempDir.h"
 #include <gtest/gtest.h>
+#include <folly/synchronization/Baton.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
 #include "storage/query/ScanVertexProcessor.h"
 #include "storage/test/QueryTestUtils.h"
 
@@ -193,7 +195,273 @@ TEST(ScanVertexTest, CursorTest) {
     }
 }
 
+TEST(ScanVertexTest, MultiPartTest) {
+    fs::TempDir rootPath("/tmp/ScanVertexMultiPartTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    FLAGS_scan_multi_part = true;
+    SCOPE_EXIT {
+        FLAGS_scan_multi_part = false;
+    };
+
+    TagID player = 1;
+    auto tag = std::make_pair(player, std::vector<std::string>{
+        kVid, kTag, "name", "age", "avgScore"});
+    auto executor = std::make_unique<folly::CPUThreadPoolExecutor>(3);
+    auto scan = [&] (folly::Executor* pool, const std::string& cursor, int64_t limit) {
+        auto req = buildRequest(ScanSessionManager::kMultiPartId, cursor, tag, limit);
+        auto* processor = ScanVertexProcessor::instance(env, nullptr, pool);
+        auto f = processor->getFuture();
+        processor->process(req);
+        return std::move(f).get();
+    };
+    for (auto* pool : {static_cast<folly::Executor*>(nullptr),
+                       static_cast<folly::Executor*>(executor.get())}) {
+        // fewer rows than parts in the page of limit = 3
+        for (int64_t limit : {20, 3}) {
+            LOG(INFO) << "Scan all parts in one request with limit = " << limit
+                      << ", executor " << pool;
+            size_t totalRowCount = 0;
+            bool hasNext = true;
+            std::string cursor = "";
+            while (hasNext) {
+                auto resp = scan(pool, cursor, limit);
+                ASSERT_EQ(0, resp.result.failed_parts.size());
+                ASSERT_GE(static_cast<size_t>(limit), (*resp.vertex_data_ref()).rows.size());
+                checkResponse(*resp.vertex_data_ref(), tag, tag.second.size(), totalRowCount);
+                hasNext = resp.get_has_next();
+                if (hasNext) {
+                    CHECK(resp.next_cursor_ref());
+                    cursor = *resp.next_cursor_ref();
+                }
+            }
+            CHECK_EQ(mock::MockData::players_.size(), totalRowCount);
+        }
+    }
+    {
+        LOG(INFO) << "Nothing is scanned with limit = 0";
+        auto resp = scan(nullptr, "", 0);
+        ASSERT_EQ(0, resp.result.failed_parts.size());
+        ASSERT_EQ(0, (*resp.vertex_data_ref()).rows.size());
+        ASSERT_TRUE(resp.get_has_next());
+        std::vector<std::pair<PartitionID, std::string>> cursors;
+        ASSERT_TRUE(ScanSessionManager::decodeMultiPartCursor(*resp.next_cursor_ref(),
+                                                              &cursors));
+        EXPECT_EQ(totalParts, cursors.size());
+    }
+    {
+        LOG(INFO) << "The cursor of a failed part is kept";
+        PartitionID notFound = totalParts + 1;
+        auto cursor = ScanSessionManager::encodeMultiPartCursor({{1, ""}, {notFound, ""}});
+        auto resp = scan(nullptr, cursor, 10000);
+        ASSERT_EQ(1, resp.result.failed_parts.size());
+        EXPECT_EQ(notFound, resp.result.failed_parts[0].get_part_id());
+        ASSERT_TRUE(resp.get_has_next());
+        std::vector<std::pair<PartitionID, std::string>> cursors;
+        ASSERT_TRUE(ScanSessionManager::decodeMultiPartCursor(*resp.next_cursor_ref(),
+                                                              &cursors));
+        ASSERT_EQ(1, cursors.size());
+        EXPECT_EQ(notFound, cursors[0].first);
+    }
+}
+
+TEST(ScanVertexTest, SessionTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+    ASSERT_EQ(true, QueryTestUtils::mockEdgeData(env, totalParts));
+
+    ScanSessionManager sessions(env->kvstore_);
+    env->scanSessions_ = &sessions;
+    TagID player = 1;
+    auto tag = std::make_pair(player, std::vector<std::string>{
+        kVid, kTag, "name", "age", "avgScore"});
+
+    auto scanAll = [&] (int64_t limit) {
+        size_t totalRowCount = 0;
+        for (PartitionID partId = 1; partId <= totalParts; partId++) {
+            bool hasNext = true;
+            std::string cursor = "";
+            while (hasNext) {
+                auto req = buildRequest(partId, cursor, tag, limit);
+                auto* processor = ScanVertexProcessor::instance(env, nullptr);
+                auto f = processor->getFuture();
+                processor->process(req);
+                auto resp = std::move(f).get();
+
+                EXPECT_EQ(0, resp.result.failed_parts.size());
+                checkResponse(*resp.vertex_data_ref(), tag, tag.second.size(), totalRowCount);
+                hasNext = resp.get_has_next();
+                if (hasNext) {
+                    CHECK(resp.next_cursor_ref());
+                    cursor = *resp.next_cursor_ref();
+                    // the iterator is parked for next page
+                    EXPECT_EQ(1, sessions.size());
+                } else {
+                    EXPECT_EQ(0, sessions.size());
+                }
+            }
+        }
+        return totalRowCount;
+    };
+
+    {
+        LOG(INFO) << "Scan with parked iterators";
+        EXPECT_EQ(mock::MockData::players_.size(), scanAll(1));
+        EXPECT_EQ(mock::MockData::players_.size(), scanAll(5));
+    }
+    {
+        LOG(INFO) << "Scan with bytes limit";
+        auto defaultVal = FLAGS_scan_max_bytes_per_response;
+        FLAGS_scan_max_bytes_per_response = 1;
+        EXPECT_EQ(mock::MockData::players_.size(), scanAll(100));
+        FLAGS_scan_max_bytes_per_response = defaultVal;
+    }
+    {
+        LOG(INFO) << "Expired session is restarted from the cursor";
+        auto req = buildRequest(1, "", tag, 1);
+        auto* processor = ScanVertexProcessor::instance(env, nullptr);
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        ASSERT_TRUE(resp.get_has_next());
+        EXPECT_EQ(1, sessions.size());
+
+        auto defaultVal = FLAGS_scan_session_ttl_secs;
+        FLAGS_scan_session_ttl_secs = 0;
+        sessions.expire();
+        EXPECT_EQ(0, sessions.size());
+        FLAGS_scan_session_ttl_secs = defaultVal;
+
+        size_t totalRowCount = 0;
+        req = buildRequest(1, *resp.next_cursor_ref(), tag, 1);
+        processor = ScanVertexProcessor::instance(env, nullptr);
+        f = processor->getFuture();
+        processor->process(req);
+        resp = std::move(f).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        checkResponse(*resp.vertex_data_ref(), tag, tag.second.size(), totalRowCount);
+        EXPECT_EQ(1, totalRowCount);
+
+        // the session expired is not taken, even if not dropped by the expiration yet
+        auto session = sessions.create(1, 1);
+        ASSERT_NE(nullptr, session);
+        auto sessionId = session->id_;
+        sessions.park(std::move(session));
+        FLAGS_scan_session_ttl_secs = 0;
+        EXPECT_EQ(nullptr, sessions.take(1, 1, sessionId, false));
+        FLAGS_scan_session_ttl_secs = defaultVal;
+        sessions.stop();
+    }
+    env->scanSessions_ = nullptr;
+    {
+        LOG(INFO) << "Sessions of the parts removed are dropped";
+        ScanSessionManager manager(env->kvstore_);
+        ASSERT_TRUE(manager.start());
+        manager.park(manager.create(1, 1));
+        manager.park(manager.create(1, 2));
+        auto notFound = manager.create(1, 3);
+        ASSERT_NE(nullptr, notFound);
+        notFound->partId_ = totalParts + 1;
+        manager.park(std::move(notFound));
+        EXPECT_EQ(3, manager.size());
+        manager.dropPart(1, 2);
+        EXPECT_EQ(2, manager.size());
+        manager.expire();
+        EXPECT_EQ(1, manager.size());
+        manager.stop();
+        EXPECT_EQ(0, manager.size());
+    }
+}
+
+TEST(ScanVertexTest, SnapshotTest) {
+    fs::TempDir rootPath("/tmp/GetNeighborsTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    auto totalParts = cluster.getTotalParts();
+    ASSERT_EQ(true, QueryTestUtils::mockVertexData(env, totalParts));
+
+    ScanSessionManager sessions(env->kvstore_);
+    TagID player = 1;
+    auto tag = std::make_pair(player, std::vector<std::string>{kVid, kTag, "name"});
 
+    auto scanPart = [&] (PartitionID partId, const std::string& cursor, int64_t limit) {
+        auto req = buildRequest(partId, cursor, tag, limit);
+        auto* processor = ScanVertexProcessor::instance(env, nullptr);
+        auto f = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(f).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+        return resp;
+    };
+    auto removeAll = [&] (PartitionID partId) {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto prefix = NebulaKeyUtils::vertexPrefix(partId);
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  env->kvstore_->prefix(1, partId, prefix, &iter));
+        std::vector<std::string> keys;
+        for (; iter->valid(); iter->next()) {
+            keys.emplace_back(iter->key().str());
+        }
+        folly::Baton<true, std::atomic> baton;
+        env->kvstore_->asyncMultiRemove(1, partId, std::move(keys),
+                                        [&baton] (nebula::cpp2::ErrorCode code) {
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    };
+
+    PartitionID partId = 1;
+    size_t expected = 0;
+    {
+        auto resp = scanPart(partId, "", 10000);
+        expected = (*resp.vertex_data_ref()).rows.size();
+        ASSERT_LT(1, expected);
+    }
+
+    env->scanSessions_ = &sessions;
+    auto first = scanPart(partId, "", 1);
+    ASSERT_TRUE(first.get_has_next());
+    // all vertices are removed after the first page
+    removeAll(partId);
+
+    // the following pages read the snapshot of the first page
+    size_t totalRowCount = 0;
+    checkResponse(*first.vertex_data_ref(), tag, tag.second.size(), totalRowCount);
+    auto cursor = *first.next_cursor_ref();
+    for (int32_t retry = 0; retry < 2; retry++) {
+        // the retried page starts a new iterator on the same snapshot
+        auto resp = scanPart(partId, cursor, 1);
+        ASSERT_EQ(1, (*resp.vertex_data_ref()).rows.size());
+    }
+    bool hasNext = true;
+    while (hasNext) {
+        auto resp = scanPart(partId, cursor, 1);
+        checkResponse(*resp.vertex_data_ref(), tag, tag.second.size(), totalRowCount);
+        hasNext = resp.get_has_next();
+        if (hasNext) {
+            cursor = *resp.next_cursor_ref();
+        }
+    }
+    EXPECT_EQ(expected, totalRowCount);
+    // the snapshot is released with the last page
+    EXPECT_EQ(0, sessions.size());
+
+    // a new scan reads the latest data
+    auto latest = scanPart(partId, "", 10000);
+    EXPECT_EQ(0, (*latest.vertex_data_ref()).rows.size());
+    EXPECT_FALSE(latest.get_has_next());
+    sessions.stop();
+    env->scanSessions_ = nullptr;
+}
 
 }  // namespace storage
 }  // namespace nebula
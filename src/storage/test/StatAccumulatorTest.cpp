@@ -0,0 +1,116 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include "storage/exec/StatAccumulator.h"
+
+namespace nebula {
+namespace storage {
+
+// accumulate by Value, which is how the stats were collected before
+static Value statByValue(cpp2::StatType statType, const std::vector<Value>& values) {
+    PropStat stat(statType);
+    for (const auto& value : values) {
+        if (statType == cpp2::StatType::SUM || statType == cpp2::StatType::AVG) {
+            stat.sum_ = stat.sum_ + value;
+            stat.count_ = stat.count_ + 1;
+        } else if (statType == cpp2::StatType::COUNT) {
+            stat.count_ = stat.count_ + 1;
+        } else if (statType == cpp2::StatType::MAX) {
+            stat.max_ = value > stat.max_ ? value : stat.max_;
+        } else if (statType == cpp2::StatType::MIN) {
+            stat.min_ = value < stat.min_ ? value : stat.min_;
+        }
+    }
+    switch (statType) {
+        case cpp2::StatType::SUM:
+            return stat.sum_;
+        case cpp2::StatType::COUNT:
+            return stat.count_;
+        case cpp2::StatType::AVG:
+            return stat.sum_ / stat.count_;
+        case cpp2::StatType::MAX:
+            return stat.max_;
+        case cpp2::StatType::MIN:
+            return stat.min_;
+    }
+    return Value();
+}
+
+TEST(StatAccumulatorTest, SameAsValueTest) {
+    std::vector<std::vector<Value>> cases = {
+        {},
+        {1, 2, 3},
+        {29.7, 27.1, 27.5, 25.7},
+        {1, 2.5, 3, -4.5},
+        {std::numeric_limits<int64_t>::min(), 0},
+        {1, Value::kNullValue, 2},
+        {2.5, Value::kNullValue},
+    };
+    std::vector<cpp2::StatType> statTypes = {
+        cpp2::StatType::SUM, cpp2::StatType::COUNT, cpp2::StatType::AVG,
+        cpp2::StatType::MAX, cpp2::StatType::MIN};
+    for (const auto& values : cases) {
+        for (auto statType : statTypes) {
+            StatAccumulator stat(statType);
+            for (const auto& value : values) {
+                stat.add(value);
+            }
+            auto expected = statByValue(statType, values);
+            auto result = stat.result();
+            EXPECT_EQ(expected.type(), result.type());
+            if (expected.isNull()) {
+                EXPECT_TRUE(result.isNull());
+            } else {
+                EXPECT_EQ(expected, result);
+            }
+        }
+    }
+}
+
+TEST(StatAccumulatorTest, GroupTest) {
+    std::vector<StatAccumulator> stats = {StatAccumulator(cpp2::StatType::COUNT),
+                                          StatAccumulator(cpp2::StatType::SUM)};
+    // start from a small table so it is resized several times
+    GroupedStats groups(stats, 0);
+    for (int round = 0; round < 2; round++) {
+        size_t groupNum = 1000;
+        for (int64_t i = 0; i < 10000; i++) {
+            auto* group = groups.find({Value(i % groupNum), Value("group")});
+            group[0].add(Value(i));
+            group[1].add(Value(i));
+        }
+        ASSERT_EQ(groupNum, groups.size());
+        auto result = groups.result();
+        ASSERT_EQ(groupNum, result.size());
+        for (size_t i = 0; i < groupNum; i++) {
+            // groups are in the order they come
+            const auto& group = result.values[i].getList();
+            ASSERT_EQ(4, group.size());
+            EXPECT_EQ(Value(static_cast<int64_t>(i)), group.values[0]);
+            EXPECT_EQ(Value("group"), group.values[1]);
+            EXPECT_EQ(Value(10L), group.values[2]);
+            // i + (i + 1000) + ... + (i + 9000)
+            EXPECT_EQ(Value(static_cast<int64_t>(10 * i + 45000)), group.values[3]);
+        }
+        // cleared for next vertex
+        groups.clear();
+        ASSERT_EQ(0, groups.size());
+        ASSERT_EQ(0, groups.result().size());
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
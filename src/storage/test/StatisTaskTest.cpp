@@ -9,12 +9,19 @@
 #include <gtest/gtest.h>
 #include "mock/MockCluster.h"
 #include "mock/MockData.h"
+#include "storage/StorageFlags.h"
 #include "storage/admin/AdminTaskManager.h"
 #include "storage/admin/StatisTask.h"
 #include "storage/mutate/AddEdgesProcessor.h"
 #include "storage/mutate/AddVerticesProcessor.h"
+#include "storage/mutate/DeleteEdgesProcessor.h"
 #include "storage/test/TestUtils.h"
 #include "common/interface/gen-cpp2/meta_types.h"
+#include "kvstore/PartStats.h"
+#include "kvstore/RocksEngine.h"
+
+DECLARE_bool(enable_incremental_statis);
+DECLARE_bool(enable_degree_counters);
 
 namespace nebula {
 namespace storage {
@@ -42,6 +49,30 @@ protected:
 
     void TearDown() override {}
 
+    static nebula::meta::cpp2::StatisItem statis(GraphSpaceID spaceId,
+                                                 const std::vector<PartitionID>& parts,
+                                                 int32_t taskId) {
+        cpp2::TaskPara parameter;
+        parameter.set_space_id(spaceId);
+        parameter.set_parts(parts);
+
+        cpp2::AddAdminTaskRequest request;
+        request.set_cmd(meta::cpp2::AdminCmd::STATS);
+        request.set_job_id(2);
+        request.set_task_id(taskId);
+        request.set_para(std::move(parameter));
+
+        folly::Promise<nebula::meta::cpp2::StatisItem> promise;
+        auto future = promise.getFuture();
+        auto callback = [&](nebula::cpp2::ErrorCode, nebula::meta::cpp2::StatisItem& result) {
+            promise.setValue(std::move(result));
+        };
+        TaskContext context(request, callback);
+        auto task = std::make_shared<StatisTask>(env_, std::move(context));
+        manager_->addAsyncTask(task);
+        return std::move(future).get();
+    }
+
     static StorageEnv* env_;
     static AdminTaskManager* manager_;
 
@@ -389,6 +420,246 @@ TEST_F(StatisTaskTest, StatisTagAndEdgeData) {
     }
 }
 
+TEST_F(StatisTaskTest, SampleStatisTest) {
+    GraphSpaceID spaceId = 1;
+    std::vector<PartitionID> parts = {1, 2, 3, 4, 5, 6};
+    // All keys are sampled, the statis is exact
+    FLAGS_statis_sample_keys = 10000;
+    {
+        auto item = statis(spaceId, parts, 15);
+        ASSERT_EQ(nebula::meta::cpp2::JobStatus::FINISHED, item.get_status());
+        ASSERT_EQ(81, *item.space_vertices_ref());
+        ASSERT_EQ(167, *item.space_edges_ref());
+        ASSERT_EQ(51, (*item.tag_vertices_ref()).at("1"));
+        ASSERT_EQ(30, (*item.tag_vertices_ref()).at("2"));
+        ASSERT_EQ(167, (*item.edges_ref()).at("101"));
+        ASSERT_EQ(parts.size(), (*item.positive_part_correlativity_ref()).size());
+    }
+    // Only a few keys of each part are sampled, the statis is estimated
+    FLAGS_statis_sample_keys = 5;
+    {
+        auto item = statis(spaceId, parts, 16);
+        ASSERT_EQ(nebula::meta::cpp2::JobStatus::FINISHED, item.get_status());
+        ASSERT_GT(*item.space_vertices_ref(), 0);
+        ASSERT_GT(*item.space_edges_ref(), 0);
+    }
+    FLAGS_statis_sample_keys = 0;
+}
+
+TEST_F(StatisTaskTest, IncrementalStatisTest) {
+    FLAGS_enable_incremental_statis = true;
+    GraphSpaceID spaceId = 1;
+    std::vector<PartitionID> parts = {1, 2, 3, 4, 5, 6};
+    // The data is written before the flag is on, the counters start from the writes again
+    {
+        auto* processor = AddVerticesProcessor::instance(env_, nullptr);
+        cpp2::AddVerticesRequest req = mock::MockData::mockAddVerticesReq();
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    }
+    {
+        auto* processor = AddEdgesProcessor::instance(env_, nullptr);
+        cpp2::AddEdgesRequest req = mock::MockData::mockAddEdgesReq();
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    }
+    auto check = [&parts] (const nebula::meta::cpp2::StatisItem& item, int64_t vertices) {
+        ASSERT_EQ(nebula::meta::cpp2::JobStatus::FINISHED, item.get_status());
+        ASSERT_EQ(vertices, *item.space_vertices_ref());
+        ASSERT_EQ(167, *item.space_edges_ref());
+        int64_t tagVertices = 0;
+        for (const auto& tag : *item.tag_vertices_ref()) {
+            tagVertices += tag.second;
+        }
+        ASSERT_EQ(vertices, tagVertices);
+        ASSERT_EQ(167, (*item.edges_ref()).at("101"));
+        ASSERT_EQ(parts.size(), (*item.positive_part_correlativity_ref()).size());
+    };
+
+    // The counters have not been offset, the parts are scanned
+    check(statis(spaceId, parts, 21), 81);
+    auto partRet = env_->kvstore_->part(spaceId, 1);
+    ASSERT_TRUE(nebula::ok(partRet));
+    auto* engine = nebula::value(partRet)->engine();
+    std::string value;
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              engine->get(NebulaKeyUtils::systemStatisBaseKey(1), &value));
+
+    // Remove a vertex bypassing raft, which is not counted, so the statis is of the counters
+    std::unique_ptr<kvstore::KVIterator> iter;
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              engine->prefix(NebulaKeyUtils::vertexPrefix(1), &iter));
+    ASSERT_TRUE(iter->valid());
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->remove(iter->key().str()));
+    check(statis(spaceId, parts, 22), 81);
+
+    // The counters are reconciled by a scan once the offset is out of date
+    FLAGS_statis_reconcile_interval_secs = 1;
+    sleep(2);
+    check(statis(spaceId, parts, 23), 80);
+    FLAGS_statis_reconcile_interval_secs = 86400;
+    check(statis(spaceId, parts, 24), 80);
+    FLAGS_enable_incremental_statis = false;
+}
+
+TEST(PartStatsTest, RemoveRangeTest) {
+    fs::TempDir rootPath("/tmp/PartStatsTest.XXXXXX");
+    size_t vIdLen = 8;
+    PartitionID partId = 1;
+    kvstore::RocksEngine engine(1, vIdLen, rootPath.path());
+    using Op = std::tuple<kvstore::BatchLogType, std::string, std::string>;
+    auto commit = [&] (LogID logId, const std::vector<Op>& ops) {
+        kvstore::PartStatsUpdater updater(&engine, partId);
+        auto batch = engine.startBatchWrite();
+        for (const auto& op : ops) {
+            const auto& first = std::get<1>(op);
+            const auto& second = std::get<2>(op);
+            updater.apply(logId, {std::get<0>(op), {first, second}});
+            if (std::get<0>(op) == kvstore::BatchLogType::OP_BATCH_PUT) {
+                ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, batch->put(first, second));
+            } else {
+                ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, batch->removeRange(first, second));
+            }
+        }
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, updater.flush(batch.get()));
+        ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  engine.commitBatchWrite(std::move(batch), true, false, true));
+    };
+    auto stats = [&] {
+        std::string value;
+        kvstore::PartStats partStats;
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                  engine.get(NebulaKeyUtils::systemStatisKey(partId), &value));
+        EXPECT_TRUE(kvstore::PartStats::decode(value, &partStats));
+        return partStats;
+    };
+    auto put = [&] (std::string key) {
+        return Op(kvstore::BatchLogType::OP_BATCH_PUT, std::move(key), "");
+    };
+    auto removeVertex = [&] (const std::string& vid) {
+        auto prefix = NebulaKeyUtils::vertexPrefix(vIdLen, partId, vid);
+        return Op(kvstore::BatchLogType::OP_BATCH_REMOVE_RANGE,
+                  prefix,
+                  NebulaKeyUtils::prefixEnd(prefix));
+    };
+
+    commit(1, {put(NebulaKeyUtils::vertexKey(vIdLen, partId, "a", 1)),
+               put(NebulaKeyUtils::vertexKey(vIdLen, partId, "b", 1)),
+               put(NebulaKeyUtils::vertexKey(vIdLen, partId, "b", 2)),
+               put(NebulaKeyUtils::vertexKey(vIdLen, partId, "c", 1)),
+               put(NebulaKeyUtils::edgeKey(vIdLen, partId, "a", 101, 0, "b"))});
+    auto partStats = stats();
+    EXPECT_EQ(0, partStats.since);
+    EXPECT_EQ(3, partStats.vertices);
+    EXPECT_EQ(3, partStats.tags[1]);
+    EXPECT_EQ(1, partStats.tags[2]);
+    EXPECT_EQ(1, partStats.edges);
+
+    // the rows in the range are counted, rather than moving "since" for a rescan
+    commit(2, {removeVertex("b"),
+               put(NebulaKeyUtils::vertexKey(vIdLen, partId, "d", 1)),
+               removeVertex("d")});
+    partStats = stats();
+    EXPECT_EQ(0, partStats.since);
+    EXPECT_EQ(2, partStats.vertices);
+    EXPECT_EQ(2, partStats.tags[1]);
+    EXPECT_EQ(0, partStats.tags[2]);
+    EXPECT_EQ(1, partStats.edges);
+
+    // all vertices of the part are removed at once
+    auto prefix = NebulaKeyUtils::vertexPrefix(partId);
+    commit(3, {Op(kvstore::BatchLogType::OP_BATCH_REMOVE_RANGE,
+                  prefix,
+                  NebulaKeyUtils::prefixEnd(prefix))});
+    partStats = stats();
+    EXPECT_EQ(0, partStats.since);
+    EXPECT_EQ(0, partStats.vertices);
+    EXPECT_TRUE(partStats.tags.empty());
+    EXPECT_EQ(1, partStats.edges);
+}
+
+TEST(DegreeCountersTest, CountTest) {
+    FLAGS_enable_degree_counters = true;
+    fs::TempDir rootPath("/tmp/DegreeCountersTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    GraphSpaceID spaceId = 1;
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(spaceId).value();
+
+    auto addEdges = [env] () {
+        auto* processor = AddEdgesProcessor::instance(env, nullptr);
+        auto req = mock::MockData::mockAddEdgesReq();
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    };
+    // the degree of each src and edge type of the mock edges, and the edges scanned
+    auto check = [&] (bool empty) {
+        auto req = mock::MockData::mockAddEdgesReq();
+        for (const auto& part : *req.parts_ref()) {
+            auto partRet = env->kvstore_->part(spaceId, part.first);
+            ASSERT_TRUE(nebula::ok(partRet));
+            auto* engine = nebula::value(partRet)->engine();
+            ASSERT_TRUE(kvstore::PartDegrees::valid(engine, part.first));
+            for (const auto& edge : part.second) {
+                const auto& src = (*edge.key_ref()).get_src().getStr();
+                auto edgeType = (*edge.key_ref()).get_edge_type();
+                std::unique_ptr<kvstore::KVIterator> iter;
+                auto prefix = NebulaKeyUtils::edgePrefix(vIdLen, part.first, src, edgeType);
+                ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, engine->prefix(prefix, &iter));
+                int64_t expected = 0;
+                for (; iter->valid(); iter->next()) {
+                    expected++;
+                }
+                ASSERT_EQ(empty, expected == 0);
+                std::string value;
+                ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+                          engine->get(NebulaKeyUtils::degreeKey(vIdLen, part.first, src,
+                                                                edgeType), &value));
+                ASSERT_EQ(expected, kvstore::PartDegrees::decode(value));
+            }
+        }
+    };
+
+    addEdges();
+    check(false);
+    // the edges overwritten are not counted again
+    addEdges();
+    check(false);
+    {
+        auto* processor = DeleteEdgesProcessor::instance(env, nullptr);
+        auto req = mock::MockData::mockDeleteEdgesReq();
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    }
+    check(true);
+
+    // the counters are not valid once the logs are committed without counting
+    FLAGS_enable_degree_counters = false;
+    addEdges();
+    auto partRet = env->kvstore_->part(spaceId, 1);
+    ASSERT_TRUE(nebula::ok(partRet));
+    auto* engine = nebula::value(partRet)->engine();
+    ASSERT_FALSE(kvstore::PartDegrees::valid(engine, 1));
+    // the stale counters are removed by the next commit, nothing is changed by the overwrite
+    FLAGS_enable_degree_counters = true;
+    addEdges();
+    ASSERT_TRUE(kvstore::PartDegrees::valid(engine, 1));
+    std::unique_ptr<kvstore::KVIterator> iter;
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              engine->prefix(NebulaKeyUtils::degreePrefix(1), &iter));
+    ASSERT_FALSE(iter->valid());
+    FLAGS_enable_degree_counters = false;
+}
+
 }  // namespace storage
 }  // namespace nebula
 
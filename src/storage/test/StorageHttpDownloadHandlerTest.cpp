@@ -17,6 +17,7 @@
 #include "mock/MockData.h"
 
 DECLARE_string(meta_server_addrs);
+DECLARE_bool(download_sst_by_file);
 
 namespace nebula {
 namespace storage {
@@ -90,6 +91,17 @@ TEST(StorageHttpDownloadHandlerTest, StorageDownloadTest) {
         ASSERT_TRUE(resp.ok());
         ASSERT_EQ("SSTFile download failed", resp.value());
     }
+    {
+        // the parts are listed by file, with no files to download and ingest
+        FLAGS_download_sst_by_file = true;
+        auto url = "/download?host=127.0.0.1&port=9000&path=/data&parts=1,2&space=1&ingest=true";
+        auto request = folly::stringPrintf("http://%s:%d%s", FLAGS_ws_ip.c_str(),
+                                           FLAGS_ws_http_port, url);
+        auto resp = http::HttpClient::get(request);
+        ASSERT_TRUE(resp.ok());
+        ASSERT_EQ("SSTFile download successfully", resp.value());
+        FLAGS_download_sst_by_file = false;
+    }
     {
         helper = std::make_unique<nebula::storage::MockHdfsExistHelper>();
         auto url = "/download?host=127.0.0.1&port=9000&path=/data&parts=1&space=1";
@@ -0,0 +1,127 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include "common/webservice/Router.h"
+#include "common/webservice/WebService.h"
+#include "common/webservice/test/TestUtils.h"
+#include "common/http/HttpClient.h"
+#include <gtest/gtest.h>
+#include <folly/json.h>
+#include <folly/synchronization/Baton.h>
+#include "storage/http/StorageHttpVersionHandler.h"
+#include "storage/test/TestUtils.h"
+#include "mock/MockCluster.h"
+
+namespace nebula {
+namespace storage {
+
+class StorageHttpVersionHandlerTestEnv : public ::testing::Environment {
+public:
+    void SetUp() override {
+        FLAGS_ws_ip = "127.0.0.1";
+        FLAGS_ws_http_port = 0;
+        FLAGS_ws_h2_port = 0;
+        rootPath_ = std::make_unique<fs::TempDir>("/tmp/StorageHttpVersionHandler.XXXXXX");
+        cluster_ = std::make_unique<mock::MockCluster>();
+        cluster_->initStorageKV(rootPath_->path());
+
+        VLOG(1) << "Starting web service...";
+        webSvc_ = std::make_unique<WebService>();
+        auto& router = webSvc_->router();
+        router.get("/part_versions").handler([](nebula::web::PathParams&&) {
+            return new storage::StorageHttpVersionHandler(cluster_->storageEnv_->kvstore_);
+        });
+        auto status = webSvc_->start();
+        ASSERT_TRUE(status.ok()) << status;
+    }
+
+    void TearDown() override {
+        cluster_.reset();
+        webSvc_.reset();
+        rootPath_.reset();
+        VLOG(1) << "Web service stopped";
+    }
+
+    static std::unique_ptr<mock::MockCluster>   cluster_;
+
+protected:
+    std::unique_ptr<WebService>          webSvc_{nullptr};
+    std::unique_ptr<fs::TempDir>         rootPath_{nullptr};
+};
+
+std::unique_ptr<mock::MockCluster> StorageHttpVersionHandlerTestEnv::cluster_{nullptr};
+
+static folly::dynamic request(const std::string& url) {
+    auto request =
+        folly::stringPrintf("http://%s:%d%s", FLAGS_ws_ip.c_str(), FLAGS_ws_http_port, url.c_str());
+    auto resp = http::HttpClient::get(request);
+    EXPECT_TRUE(resp.ok());
+    return folly::parseJson(resp.value());
+}
+
+TEST(StorageHttpVersionHandlerTest, ParseSince) {
+    std::unordered_map<PartitionID, LogID> versions;
+    ASSERT_TRUE(StorageHttpVersionHandler::parseSince("1:10,2:20", &versions));
+    ASSERT_EQ(2, versions.size());
+    ASSERT_EQ(10, versions[1]);
+    ASSERT_EQ(20, versions[2]);
+    ASSERT_FALSE(StorageHttpVersionHandler::parseSince("1:10,2", &versions));
+    ASSERT_FALSE(StorageHttpVersionHandler::parseSince("1:x", &versions));
+}
+
+TEST(StorageHttpVersionHandlerTest, NotModified) {
+    auto* env = StorageHttpVersionHandlerTestEnv::cluster_->storageEnv_.get();
+    auto versions = request("/part_versions?space=1");
+    ASSERT_TRUE(versions.isObject());
+    ASSERT_LT(0, versions.size());
+    std::string since;
+    for (const auto& part : versions.items()) {
+        ASSERT_TRUE(part.second["leader"].asBool());
+        if (!since.empty()) {
+            since.append(",");
+        }
+        since.append(folly::stringPrintf("%s:%ld", part.first.asString().c_str(),
+                                         part.second["version"].asInt()));
+    }
+    auto unchanged = request("/part_versions?space=1&since=" + since);
+    ASSERT_EQ(versions.size(), unchanged.size());
+    for (const auto& part : unchanged.items()) {
+        ASSERT_EQ("not_modified", part.second.asString());
+    }
+
+    // a write into part 1 changes its version only
+    folly::Baton<true, std::atomic> baton;
+    env->kvstore_->asyncMultiPut(1, 1, {{"key", "value"}}, [&] (nebula::cpp2::ErrorCode code) {
+        EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+        baton.post();
+    });
+    baton.wait();
+    auto changed = request("/part_versions?space=1&since=" + since);
+    ASSERT_EQ(versions.size(), changed.size());
+    for (const auto& part : changed.items()) {
+        if (part.first.asString() == "1") {
+            ASSERT_LT(versions["1"]["version"].asInt(), part.second["version"].asInt());
+        } else {
+            ASSERT_EQ("not_modified", part.second.asString());
+        }
+    }
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    ::testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+
+    ::testing::AddGlobalTestEnvironment(new nebula::storage::StorageHttpVersionHandlerTestEnv());
+
+    return RUN_ALL_TESTS();
+}
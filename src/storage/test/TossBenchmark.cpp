@@ -16,6 +16,7 @@
 #define oneReqTenEdges        1
 #define oneReqHundredEdges    1
 #define oneReqThousandEdges   1
+#define manySrcsOneDst        1
 
 
 namespace nebula {
@@ -206,6 +207,47 @@ BENCHMARK_RELATIVE(bmOneReqThousandEdgesToss) {
 }
 #endif
 
+#if manySrcsOneDst
+// The edges of different srcs (local parts) to the same dst (remote part), the chains are
+// coalesced into one forward request if storaged runs with --toss_coalesce_remote_part
+BENCHMARK_DRAW_LINE();
+BENCHMARK(bmManySrcsOneDst) {
+    size_t cnt = 100;
+    int32_t srcId = 90000;
+    int32_t dstId = 90000;
+    std::vector<nebula::Value> vals(gTypes.size());
+    vals[0].setInt(srcId);
+    vals[1].setStr(folly::sformat("{}", __func__));
+
+    auto env = TossEnvironment::getInstance(kMetaName, kMetaPort);
+    std::vector<cpp2::NewEdge> edges;
+    edges.reserve(cnt);
+    for (auto i = 0U; i < cnt; ++i) {
+        ++gAddedEdges[srcId + i];
+        edges.emplace_back(env->generateEdge(srcId + i, gRank, vals, dstId));
+    }
+    env->addEdgesAsync(edges, notToss).wait();
+}
+
+BENCHMARK_RELATIVE(bmManySrcsOneDstToss) {
+    size_t cnt = 100;
+    int32_t srcId = 100000;
+    int32_t dstId = 100000;
+    std::vector<nebula::Value> vals(gTypes.size());
+    vals[0].setInt(srcId);
+    vals[1].setStr(folly::sformat("{}", __func__));
+
+    auto env = TossEnvironment::getInstance(kMetaName, kMetaPort);
+    std::vector<cpp2::NewEdge> edges;
+    edges.reserve(cnt);
+    for (auto i = 0U; i < cnt; ++i) {
+        ++gAddedEdges[srcId + i];
+        edges.emplace_back(env->generateEdge(srcId + i, gRank, vals, dstId));
+    }
+    env->addEdgesAsync(edges, useToss).wait();
+}
+#endif
+
 }  // namespace storage
 }  // namespace nebula
 
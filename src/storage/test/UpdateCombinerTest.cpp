@@ -0,0 +1,216 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include "storage/UpdateCombiner.h"
+
+namespace nebula {
+namespace storage {
+
+using Combiner = UpdateCombiner<std::string>;
+
+// A counter in "store", each update adds one to it
+class UpdateCombinerTest : public ::testing::Test {
+protected:
+    nebula::cpp2::ErrorCode increase(Combiner* combiner,
+                                     std::function<bool(bool leader)> fail = nullptr) {
+        auto compute = [&] (bool leader,
+                            const kvstore::KV* pending,
+                            std::string* batch,
+                            kvstore::KV* row) {
+            if (fail && fail(leader)) {
+                return nebula::cpp2::ErrorCode::E_FILTER_OUT;
+            }
+            int64_t val = 0;
+            if (pending != nullptr) {
+                val = folly::to<int64_t>(pending->second);
+            } else {
+                // reading kvstore takes a while, the others arrived join the group meanwhile
+                std::this_thread::sleep_for(std::chrono::milliseconds(readMs_));
+                std::lock_guard<std::mutex> g(lock_);
+                val = store_;
+            }
+            kvstore::BatchHolder bat;
+            bat.put("counter", folly::to<std::string>(val + 1));
+            *batch = kvstore::encodeBatchValue(bat.getBatch());
+            *row = std::make_pair("counter", folly::to<std::string>(val + 1));
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        };
+        auto commit = [&] (std::string&& batch) {
+            std::lock_guard<std::mutex> g(lock_);
+            for (auto& op : kvstore::decodeBatchValue(batch)) {
+                store_ = folly::to<int64_t>(op.second.second);
+            }
+            commits_++;
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        };
+        return combiner->combine("counter", compute, commit);
+    }
+
+    // Add one to the counter of key in counters_, combined in the group of "part"
+    nebula::cpp2::ErrorCode increaseInPart(Combiner* combiner,
+                                           const std::string& key,
+                                           std::function<bool(bool first)> fail = nullptr) {
+        auto compute = [&] (bool first,
+                            const kvstore::KV* pending,
+                            std::string* batch,
+                            kvstore::KV* row) {
+            if (fail && fail(first)) {
+                return nebula::cpp2::ErrorCode::E_FILTER_OUT;
+            }
+            int64_t val = 0;
+            if (pending != nullptr) {
+                val = folly::to<int64_t>(pending->second);
+            } else {
+                std::this_thread::sleep_for(std::chrono::milliseconds(readMs_));
+                std::lock_guard<std::mutex> g(lock_);
+                val = counters_[key];
+            }
+            kvstore::BatchHolder bat;
+            bat.put(std::string(key), folly::to<std::string>(val + 1));
+            *batch = kvstore::encodeBatchValue(bat.getBatch());
+            *row = std::make_pair(key, folly::to<std::string>(val + 1));
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        };
+        auto commit = [&] (std::string&& batch) {
+            std::lock_guard<std::mutex> g(lock_);
+            for (auto& op : kvstore::decodeBatchValue(batch)) {
+                counters_[op.second.first.str()] = folly::to<int64_t>(op.second.second);
+            }
+            commits_++;
+            return nebula::cpp2::ErrorCode::SUCCEEDED;
+        };
+        return combiner->combine("part", key, compute, commit);
+    }
+
+    std::mutex lock_;
+    int32_t readMs_{10};
+    int64_t store_{0};
+    std::unordered_map<std::string, int64_t> counters_;
+    int32_t commits_{0};
+};
+
+TEST_F(UpdateCombinerTest, CombineTest) {
+    Combiner combiner(100 * 1000);
+    std::atomic<int32_t> succeeded{0};
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 10; i++) {
+        threads.emplace_back([&] {
+            if (increase(&combiner) == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                succeeded++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(10, succeeded);
+    EXPECT_EQ(10, store_);
+    EXPECT_LT(commits_, 10);
+
+    // the next group reads the value committed
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, increase(&combiner));
+    EXPECT_EQ(11, store_);
+}
+
+TEST_F(UpdateCombinerTest, AloneTest) {
+    // the leader alone commits at once, rather than after the window
+    Combiner combiner(10 * 1000 * 1000);
+    readMs_ = 0;
+    auto start = std::chrono::steady_clock::now();
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, increase(&combiner));
+    EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, increase(&combiner));
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(5));
+    EXPECT_EQ(2, store_);
+    EXPECT_EQ(2, commits_);
+}
+
+TEST_F(UpdateCombinerTest, LeaderFailTest) {
+    Combiner combiner(100 * 1000);
+    std::atomic<bool> failed{false};
+    // the first leader fails, the others retry in a new group
+    auto fail = [&] (bool leader) {
+        return leader && !failed.exchange(true);
+    };
+    std::atomic<int32_t> succeeded{0};
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 10; i++) {
+        threads.emplace_back([&] {
+            if (increase(&combiner, fail) == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                succeeded++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(9, succeeded);
+    EXPECT_EQ(9, store_);
+}
+
+TEST_F(UpdateCombinerTest, CombineByPartTest) {
+    Combiner combiner(100 * 1000);
+    std::atomic<int32_t> succeeded{0};
+    std::vector<std::thread> threads;
+    for (auto i = 0; i < 10; i++) {
+        threads.emplace_back([&, i] {
+            auto key = folly::stringPrintf("counter_%d", i % 5);
+            if (increaseInPart(&combiner, key) == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                succeeded++;
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(10, succeeded);
+    ASSERT_EQ(5, counters_.size());
+    for (const auto& counter : counters_) {
+        EXPECT_EQ(2, counter.second);
+    }
+    EXPECT_LT(commits_, 10);
+}
+
+TEST_F(UpdateCombinerTest, LeaderFailByPartTest) {
+    Combiner combiner(100 * 1000);
+    // the leader fails, the others join its group while it computes, and are still committed
+    std::atomic<int32_t> succeeded{0};
+    std::vector<std::thread> threads;
+    auto fail = [&] (bool) {
+        for (auto i = 1; i < 5; i++) {
+            threads.emplace_back([&, i] {
+                auto key = folly::stringPrintf("counter_%d", i);
+                if (increaseInPart(&combiner, key) == nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    succeeded++;
+                }
+            });
+        }
+        // let them join before the leader fails
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        return true;
+    };
+    EXPECT_EQ(nebula::cpp2::ErrorCode::E_FILTER_OUT,
+              increaseInPart(&combiner, "counter_0", fail));
+    for (auto& t : threads) {
+        t.join();
+    }
+    EXPECT_EQ(4, succeeded);
+    EXPECT_EQ(4, counters_.size());
+    EXPECT_EQ(0, counters_.count("counter_0"));
+    EXPECT_EQ(1, commits_);
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -102,9 +102,9 @@ TEST(VertexCacheTest, OperationVertexTest) {
     auto* env = cluster.storageEnv_.get();
     auto parts = cluster.getTotalParts();
 
-    // Here ConcurrentLRUCache capacity is the size of the player data(51), and
-    // has a bucket.
-    VertexCache cache(51, 0);
+    // Here VertexCache is large enough to hold all the player data(51), and
+    // has a shard.
+    VertexCache cache(1024 * 1024, 0);
 
     // Add vertices
     // VertexCache is empty, add vertice only evicts vertex from VertexCache
@@ -265,9 +265,9 @@ TEST(VertexCacheTest, GetNeighborsTest) {
     auto parts = cluster.getTotalParts();
     auto threadPool = std::make_shared<folly::IOThreadPoolExecutor>(4);
 
-    // Here ConcurrentLRUCache capacity is the size of the player data(51), and
-    // has a bucket.
-    VertexCache cache(51, 0);
+    // Here VertexCache is large enough to hold all the player data(51), and
+    // has a shard.
+    VertexCache cache(1024 * 1024, 0);
 
     // Add vertices
     // VertexCache is empty, add vertice only evicts vertex from VertexCache.
@@ -371,9 +371,9 @@ TEST(VertexCacheTest, GetVertexPropTest) {
     auto* env = cluster.storageEnv_.get();
     auto parts = cluster.getTotalParts();
 
-    // Here ConcurrentLRUCache capacity is the size of the player data(51), and
-    // has a bucket.
-    VertexCache cache(51, 0);
+    // Here VertexCache is large enough to hold all the player data(51), and
+    // has a shard.
+    VertexCache cache(1024 * 1024, 0);
 
     // Add vertices
     // VertexCache is empty, add vertice only evicts vertex from VertexCache.
@@ -450,9 +450,9 @@ TEST(VertexCacheTest, GetVertexPropWithTTLTest) {
     auto* env = cluster.storageEnv_.get();
     auto parts = cluster.getTotalParts();
 
-    // Here ConcurrentLRUCache capacity is the size of the player data(51), and
-    // has a bucket.
-    VertexCache cache(51, 0);
+    // Here VertexCache is large enough to hold all the player data(51), and
+    // has a shard.
+    VertexCache cache(1024 * 1024, 0);
 
     // Add vertices
     // VertexCache is empty, add vertice only evicts vertex from VertexCache.
@@ -526,6 +526,94 @@ TEST(VertexCacheTest, GetVertexPropWithTTLTest) {
     FLAGS_mock_ttl_col = false;
 }
 
+// Each entry is charged by key + value + 96 bytes of overhead, so about 5 entries with
+// 100 bytes value could be put into a cache of 1000 bytes.
+TEST(VertexCacheTest, CapacityTest) {
+    VertexCache cache(1000, 0);
+    ASSERT_EQ(1, cache.shardsNum());
+    for (int i = 0; i < 12; i++) {
+        auto key = std::make_pair(folly::to<std::string>(i), 1);
+        // access it before insert, so it is always more frequent than the old ones
+        for (int j = 0; j <= i; j++) {
+            cache.get(key);
+        }
+        cache.insert(key, std::string(100, 'x'));
+        auto stats = cache.shardStats(0);
+        ASSERT_LE(stats.bytes_, 1000);
+    }
+    auto stats = cache.shardStats(0);
+    EXPECT_EQ(5, stats.entries_);
+    EXPECT_EQ(7, stats.lruEvicts_);
+    // the most recent ones are in cache
+    EXPECT_TRUE(cache.get(std::make_pair("11", 1)).ok());
+    EXPECT_FALSE(cache.get(std::make_pair("0", 1)).ok());
+
+    // the entry larger than capacity is rejected
+    cache.insert(std::make_pair("large", 1), std::string(1000, 'x'));
+    EXPECT_FALSE(cache.get(std::make_pair("large", 1)).ok());
+    EXPECT_EQ(1, cache.shardStats(0).rejects_);
+}
+
+// One-off keys won't flush the frequently accessed ones
+TEST(VertexCacheTest, AdmissionTest) {
+    VertexCache cache(1000, 0);
+    std::vector<VertexCache::Key> hotKeys;
+    for (int i = 0; i < 4; i++) {
+        hotKeys.emplace_back(folly::stringPrintf("hot_%d", i), 1);
+        cache.insert(hotKeys.back(), std::string(100, 'x'));
+    }
+    for (int i = 0; i < 5; i++) {
+        for (const auto& key : hotKeys) {
+            ASSERT_TRUE(cache.get(key).ok());
+        }
+    }
+
+    // scan a lot of cold keys
+    for (int i = 0; i < 100; i++) {
+        cache.insert(std::make_pair(folly::stringPrintf("cold_%d", i), 1),
+                     std::string(100, 'x'));
+    }
+    for (const auto& key : hotKeys) {
+        EXPECT_TRUE(cache.get(key).ok());
+    }
+    // all cold keys are rejected
+    auto stats = cache.shardStats(0);
+    EXPECT_EQ(100, stats.rejects_);
+    EXPECT_EQ(0, stats.lruEvicts_);
+
+    // a cold key becomes hot after accessed frequently
+    auto key = std::make_pair(std::string("cold_50"), 1);
+    for (int i = 0; i < 10; i++) {
+        EXPECT_FALSE(cache.get(key).ok());
+    }
+    cache.insert(key, std::string(100, 'x'));
+    EXPECT_TRUE(cache.get(key).ok());
+    EXPECT_EQ(1, cache.shardStats(0).lruEvicts_);
+}
+
+// Peek doesn't change the lru order
+TEST(VertexCacheTest, PeekTest) {
+    VertexCache cache(1000, 0);
+    std::vector<VertexCache::Key> keys;
+    for (int i = 0; i < 5; i++) {
+        keys.emplace_back(folly::to<std::string>(i), 1);
+        cache.insert(keys.back(), std::string(100, 'x'));
+    }
+    // "0" is the least recently used one
+    EXPECT_TRUE(cache.peek(keys[0]).ok());
+
+    auto key = std::make_pair(std::string("new"), 1);
+    for (int i = 0; i < 5; i++) {
+        cache.get(key);
+    }
+    cache.insert(key, std::string(100, 'x'));
+    EXPECT_TRUE(cache.peek(key).ok());
+    EXPECT_FALSE(cache.peek(keys[0]).ok());
+    for (size_t i = 1; i < keys.size(); i++) {
+        EXPECT_TRUE(cache.peek(keys[i]).ok());
+    }
+}
+
 }  // namespace storage
 }  // namespace nebula
 
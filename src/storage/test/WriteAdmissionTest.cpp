@@ -0,0 +1,87 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include "storage/WriteAdmission.h"
+#include "storage/StorageFlags.h"
+
+namespace nebula {
+namespace storage {
+
+using Priority = WriteAdmission::Priority;
+
+TEST(WriteAdmissionTest, QuotaTest) {
+    FLAGS_write_quota_rows_per_sec = 100;
+    FLAGS_write_admission_max_delay_ms = 1000;
+    WriteAdmission admission(nullptr);
+    ASSERT_TRUE(admission.start());
+    std::chrono::milliseconds delay;
+
+    // the first second of quota is admitted at once
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              admission.admit(1, Priority::LOW, 100, 0, &delay));
+    ASSERT_EQ(0, delay.count());
+    // the next rows of the space are delayed
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              admission.admit(1, Priority::LOW, 50, 0, &delay));
+    ASSERT_GT(delay.count(), 0);
+    ASSERT_LE(delay.count(), 1000);
+    // and rejected if they should wait too long
+    ASSERT_EQ(nebula::cpp2::ErrorCode::E_BUFFER_OVERFLOW,
+              admission.admit(1, Priority::LOW, 200, 0, &delay));
+    // the high priority writes are never delayed
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              admission.admit(1, Priority::HIGH, 200, 0, &delay));
+    ASSERT_EQ(0, delay.count());
+    // the quota is of each space
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              admission.admit(2, Priority::LOW, 100, 0, &delay));
+    ASSERT_EQ(0, delay.count());
+
+    FLAGS_write_quota_rows_per_sec = 0;
+    FLAGS_write_admission_max_delay_ms = 100;
+}
+
+TEST(WriteAdmissionTest, StallTest) {
+    FLAGS_write_stall_reject_pressure = 1.0;
+    FLAGS_write_stall_check_interval_ms = 10;
+    std::atomic<double> pressure{0};
+    WriteAdmission admission([&pressure] { return pressure.load(); });
+    ASSERT_TRUE(admission.start());
+    std::chrono::milliseconds delay;
+
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              admission.admit(1, Priority::LOW, 100, 0, &delay));
+    pressure = 1.5;
+    while (admission.stallPressure() < 1.0) {
+        usleep(1000);
+    }
+    ASSERT_EQ(nebula::cpp2::ErrorCode::E_BUFFER_OVERFLOW,
+              admission.admit(1, Priority::LOW, 100, 0, &delay));
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              admission.admit(1, Priority::HIGH, 100, 0, &delay));
+    pressure = 0.5;
+    while (admission.stallPressure() >= 1.0) {
+        usleep(1000);
+    }
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              admission.admit(1, Priority::LOW, 100, 0, &delay));
+    admission.stop();
+
+    FLAGS_write_stall_reject_pressure = 0;
+    FLAGS_write_stall_check_interval_ms = 1000;
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -0,0 +1,121 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "common/fs/TempDir.h"
+#include "common/time/WallClock.h"
+#include <gtest/gtest.h>
+#include "utils/NebulaKeyUtils.h"
+#include "storage/WriteDedupWindow.h"
+#include "storage/mutate/AddEdgesProcessor.h"
+#include "mock/MockCluster.h"
+#include "mock/MockData.h"
+
+namespace nebula {
+namespace storage {
+
+TEST(WriteDedupTest, WindowTest) {
+    WriteDedupWindow window(60);
+    ASSERT_TRUE(window.applied(WriteDedupWindow::encode()));
+    // a broken value is never taken as applied
+    ASSERT_FALSE(window.applied(""));
+
+    int64_t appliedAt = time::WallClock::fastNowInSec() - 120;
+    std::string old(reinterpret_cast<const char*>(&appliedAt), sizeof(int64_t));
+    ASSERT_FALSE(window.applied(old));
+    ASSERT_TRUE(WriteDedupWindow::expired(old, 60));
+    ASSERT_FALSE(WriteDedupWindow::expired(old, 600));
+}
+
+TEST(WriteDedupTest, AddEdgesTest) {
+    fs::TempDir rootPath("/tmp/WriteDedupTest.XXXXXX");
+    mock::MockCluster cluster;
+    cluster.initStorageKV(rootPath.path());
+    auto* env = cluster.storageEnv_.get();
+    WriteDedupWindow window(3600);
+    env->writeDedup_ = &window;
+
+    cpp2::AddEdgesRequest req = mock::MockData::mockAddEdgesReq();
+    auto addEdges = [&] (const std::string& writeId) {
+        auto* processor = AddEdgesProcessor::instance(env, nullptr);
+        processor->setWriteId(writeId);
+        auto fut = processor->getFuture();
+        processor->process(req);
+        auto resp = std::move(fut).get();
+        EXPECT_EQ(0, resp.result.failed_parts.size());
+    };
+
+    GraphSpaceID spaceId = 1;
+    auto vIdLen = env->schemaMan_->getSpaceVidLen(spaceId);
+    ASSERT_TRUE(vIdLen.ok());
+    const auto& part = *req.get_parts().begin();
+    auto partId = part.first;
+    const auto& edgeKey = *part.second.front().key_ref();
+    auto key = NebulaKeyUtils::edgeKey(vIdLen.value(),
+                                       partId,
+                                       (*edgeKey.src_ref()).getStr(),
+                                       *edgeKey.edge_type_ref(),
+                                       *edgeKey.ranking_ref(),
+                                       (*edgeKey.dst_ref()).getStr());
+    auto removeEdge = [&] {
+        folly::Baton<true, std::atomic> baton;
+        env->kvstore_->asyncRemove(spaceId, partId, key, [&baton] (nebula::cpp2::ErrorCode code) {
+            EXPECT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED, code);
+            baton.post();
+        });
+        baton.wait();
+    };
+    auto edgeExists = [&] {
+        std::string value;
+        return env->kvstore_->get(spaceId, partId, key, &value) ==
+               nebula::cpp2::ErrorCode::SUCCEEDED;
+    };
+
+    // the same write without a write id is always applied again
+    addEdges("");
+    ASSERT_TRUE(edgeExists());
+    removeEdge();
+    addEdges("");
+    ASSERT_TRUE(edgeExists());
+
+    // the retry with the same write id is not applied again
+    addEdges("write-1");
+    std::string value;
+    ASSERT_EQ(nebula::cpp2::ErrorCode::SUCCEEDED,
+              env->kvstore_->get(spaceId, partId,
+                                 NebulaKeyUtils::systemDedupKey(partId, "write-1"), &value));
+    ASSERT_TRUE(window.applied(value));
+    removeEdge();
+    addEdges("write-1");
+    ASSERT_FALSE(edgeExists());
+
+    // a new write with the same edges is applied
+    addEdges("write-2");
+    ASSERT_TRUE(edgeExists());
+
+    // the write id is forgotten once expired
+    removeEdge();
+    WriteDedupWindow expired(0);
+    env->writeDedup_ = &expired;
+    addEdges("write-1");
+    ASSERT_TRUE(edgeExists());
+
+    // the dedup is disabled, the edge is written again
+    removeEdge();
+    env->writeDedup_ = nullptr;
+    addEdges("write-2");
+    ASSERT_TRUE(edgeExists());
+}
+
+}  // namespace storage
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}
@@ -20,7 +20,13 @@ void GetValueProcessor::process(const cpp2::GetValueRequest& req) {
     auto key = req.get_key();
 
     std::string value;
-    auto rc = env_->kvstore_->get(spaceId, partId, key, &value);
+    auto rc = nebula::cpp2::ErrorCode::SUCCEEDED;
+    if (FLAGS_toss_read_index) {
+        rc = env_->kvstore_->readIndex(spaceId, partId);
+    }
+    if (rc == nebula::cpp2::ErrorCode::SUCCEEDED) {
+        rc = env_->kvstore_->get(spaceId, partId, key, &value);
+    }
     LOG_IF(INFO, FLAGS_trace_toss) << "getValue for partId=" << partId
                                    << ", key=" << folly::hexlify(key)
                                    << ", rc=" << static_cast<int>(rc);
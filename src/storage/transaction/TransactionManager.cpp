@@ -8,6 +8,7 @@
 
 #include "codec/RowWriterV2.h"
 #include "common/clients/storage/InternalStorageClient.h"
+#include "common/time/WallClock.h"
 #include "storage/CommonUtils.h"
 #include "storage/StorageFlags.h"
 #include "storage/mutate/AddEdgesProcessor.h"
@@ -30,6 +31,97 @@ TransactionManager::TransactionManager(StorageEnv* env) : env_(env) {
                             env_->metaClient_);
 }
 
+bool TransactionManager::start() {
+    resumeWorker_ = std::make_unique<thread::GenericWorker>();
+    if (!resumeWorker_->start("toss-resume")) {
+        return false;
+    }
+    // check the new leaders every second, so the locks are resumed soon after election
+    resumeWorker_->addRepeatTask(1000, &TransactionManager::resumeLocks, this);
+    return true;
+}
+
+void TransactionManager::stop() {
+    if (resumeWorker_ != nullptr) {
+        resumeWorker_->stop();
+        resumeWorker_->wait();
+        resumeWorker_.reset();
+    }
+}
+
+void TransactionManager::resumeLocks() {
+    std::unordered_map<GraphSpaceID, std::vector<meta::cpp2::LeaderInfo>> leaders;
+    env_->kvstore_->allLeader(leaders);
+    auto now = time::WallClock::fastNowInMilliSec();
+    std::unordered_map<std::pair<GraphSpaceID, PartitionID>,
+                       std::pair<TermID, int64_t>> scanned;
+    for (auto& space : leaders) {
+        auto spaceId = space.first;
+        if (!enableToss(spaceId)) {
+            continue;
+        }
+        auto stVidLen = env_->schemaMan_->getSpaceVidLen(spaceId);
+        if (!stVidLen.ok()) {
+            continue;
+        }
+        for (auto& leader : space.second) {
+            auto partId = leader.get_part_id();
+            auto term = leader.get_term();
+            std::pair<GraphSpaceID, PartitionID> key{spaceId, partId};
+            auto it = scannedParts_.find(key);
+            if (it != scannedParts_.end() && it->second.first == term &&
+                now - it->second.second < FLAGS_toss_resume_lock_interval_secs * 1000) {
+                scanned.emplace(key, it->second);
+                continue;
+            }
+            resumeLocksOfPart(stVidLen.value(), spaceId, partId);
+            scanned.emplace(key, std::make_pair(term, now));
+        }
+    }
+    // the parts lost leadership are forgotten, they are scanned once elected again
+    scannedParts_ = std::move(scanned);
+}
+
+void TransactionManager::resumeLocksOfPart(size_t vIdLen,
+                                           GraphSpaceID spaceId,
+                                           PartitionID partId) {
+    std::vector<std::string> lockKeys;
+    {
+        std::unique_ptr<kvstore::KVIterator> iter;
+        auto prefix = NebulaKeyUtils::edgePrefix(partId);
+        auto code = env_->kvstore_->prefix(
+            spaceId, partId, prefix, &iter, false, kvstore::ScanHint::kFullScan);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(WARNING) << "Scan the locks of space " << spaceId << ", part " << partId
+                         << " failed, code " << static_cast<int32_t>(code);
+            return;
+        }
+        for (; iter && iter->valid(); iter->next()) {
+            if (NebulaKeyUtils::isLock(vIdLen, iter->key())) {
+                lockKeys.emplace_back(iter->key().str());
+            }
+        }
+    }
+    if (lockKeys.empty()) {
+        return;
+    }
+
+    LOG(INFO) << "Resume " << lockKeys.size() << " locks of space " << spaceId
+              << ", part " << partId;
+    // the key being written by a txn is locked in memory, resumeTransaction gives up on it.
+    // At most kBatch locks are resumed at the same time, not to flood the remote parts
+    static constexpr size_t kBatch = 64;
+    for (size_t i = 0; i < lockKeys.size(); i += kBatch) {
+        std::vector<folly::Future<nebula::cpp2::ErrorCode>> futures;
+        for (size_t j = i; j < std::min(i + kBatch, lockKeys.size()); j++) {
+            auto result = std::make_shared<folly::Synchronized<KV>>();
+            futures.emplace_back(
+                resumeTransaction(vIdLen, spaceId, std::move(lockKeys[j]), result));
+        }
+        folly::collectAll(std::move(futures)).wait();
+    }
+}
+
 /*
  * multi edges have same local partition and same remote partition
  * will process as a batch
@@ -53,23 +145,15 @@ TransactionManager::addSamePartEdges(size_t vIdLen,
                       << folly::hexlify(dstId) << ", txnId=" << txnId;
         }
     }
+    for (auto& kv : localEdges) {
+        env_->evictEdgeCache(spaceId, vIdLen, kv.first);
+    }
+
     // steps 1: lock edges in memory
-    bool setMemoryLock = true;
-    std::for_each(localEdges.begin(), localEdges.end(), [&](auto& kv){
-        auto keyWoVer = NebulaKeyUtils::keyWithNoVersion(kv.first).str();
-        if (!memLock_.insert(std::make_pair(keyWoVer, txnId)).second) {
-            setMemoryLock = false;
-        }
-    });
+    bool setMemoryLock = lockEdgesInMemory(txnId, localEdges);
 
     auto cleanup = [=]{
-        for (auto& kv : localEdges) {
-            auto keyWoVer = NebulaKeyUtils::keyWithNoVersion(kv.first).str();
-            auto cit = memLock_.find(keyWoVer);
-            if (cit != memLock_.end() && cit->second == txnId) {
-                memLock_.erase(keyWoVer);
-            }
-        }
+        unlockEdgesInMemory(txnId, localEdges);
     };
 
     if (!setMemoryLock) {
@@ -82,37 +166,20 @@ TransactionManager::addSamePartEdges(size_t vIdLen,
 
     // steps 2: batch commit persist locks
     std::string batch;
-    std::vector<KV> lockData = localEdges;
+    std::vector<KV> lockData;
     // insert don't have BatchGetter
     if (!optBatchGetter) {
         // insert don't have batch Getter
-        auto addEdgeErrorCode = nebula::cpp2::ErrorCode::SUCCEEDED;
-        std::transform(lockData.begin(), lockData.end(), lockData.begin(), [&](auto& kv) {
-            if (processor) {
-                processor->spaceId_ = spaceId;
-                processor->spaceVidLen_ = vIdLen;
-                std::vector<KV> data{std::make_pair(kv.first, kv.second)};
-                auto optVal = processor->addEdges(localPart, data);
-                if (nebula::ok(optVal)) {
-                    return std::make_pair(NebulaKeyUtils::toLockKey(kv.first),
-                                          nebula::value(optVal));
-                } else {
-                    addEdgeErrorCode = nebula::cpp2::ErrorCode::E_ATOMIC_OP_FAILED;
-                    return std::make_pair(NebulaKeyUtils::toLockKey(kv.first), std::string(""));
-                }
-            } else {
-                std::vector<KV> data{std::make_pair(kv.first, kv.second)};
-                return std::make_pair(NebulaKeyUtils::toLockKey(kv.first),
-                                      encodeBatch(std::move(data)));
-            }
-        });
-        if (addEdgeErrorCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        auto ret = lockDataOfEdges(vIdLen, spaceId, localPart, localEdges, processor);
+        if (!nebula::ok(ret)) {
             cleanup();
-            return addEdgeErrorCode;
+            return nebula::error(ret);
         }
+        lockData = nebula::value(ret);
         auto lockDataSink = lockData;
         batch = encodeBatch(std::move(lockDataSink));
     } else {   // only update should enter here
+        lockData = localEdges;
         auto optBatch = (*optBatchGetter)();
         if (!optBatch) {
             cleanup();
@@ -151,12 +218,8 @@ TransactionManager::addSamePartEdges(size_t vIdLen,
                 return;
             }
 
-            std::vector<KV> remoteEdges = localEdges;
-            std::transform(
-                remoteEdges.begin(), remoteEdges.end(), remoteEdges.begin(), [=](auto& kv) {
-                    auto key = TransactionUtils::reverseRawKey(vIdLen, remotePart, kv.first);
-                    return std::make_pair(std::move(key), kv.second);
-                });
+            std::vector<KV> remoteEdges;
+            appendRemoteEdges(vIdLen, remotePart, localEdges, &remoteEdges);
             auto remoteBatch = encodeBatch(std::move(remoteEdges));
 
             // steps 3: multi put remote edges
@@ -184,33 +247,7 @@ TransactionManager::addSamePartEdges(size_t vIdLen,
                     }
 
                     // steps 4 & 5: multi put local edges & multi remove persist locks
-                    kvstore::BatchHolder bat;
-                    for (auto& lock : lockData) {
-                        LOG_IF(INFO, FLAGS_trace_toss)
-                            << "remove lock, hex=" << folly::hexlify(lock.first)
-                            << ", txnId=" << txnId;
-                        bat.remove(std::move(lock.first));
-                        auto operations = kvstore::decodeBatchValue(lock.second);
-                        for (auto& op : operations) {
-                            auto opType = op.first;
-                            auto& kv = op.second;
-                            LOG_IF(INFO, FLAGS_trace_toss)
-                                        << "bat op=" << static_cast<int32_t>(opType)
-                                        << ", hex=" << folly::hexlify(kv.first)
-                                        << ", txnId=" << txnId;
-                            switch (opType) {
-                                case kvstore::BatchLogType::OP_BATCH_PUT:
-                                    bat.put(kv.first.str(), kv.second.str());
-                                    break;
-                                case kvstore::BatchLogType::OP_BATCH_REMOVE:
-                                    bat.remove(kv.first.str());
-                                    break;
-                                default:
-                                    LOG(ERROR) << "unexpected opType: " << static_cast<int>(opType);
-                            }
-                        }
-                    }
-                    auto _batch = kvstore::encodeBatchValue(bat.getBatch());
+                    auto _batch = encodeCommitBatch(lockData, txnId);
                     commitBatch(spaceId, localPart, std::move(_batch))
                         .via(exec_.get())
                         .thenValue([=, p = std::move(p)](auto&& rc) mutable {
@@ -225,6 +262,224 @@ TransactionManager::addSamePartEdges(size_t vIdLen,
     return std::move(c.second).via(exec_.get());
 }
 
+/*
+ * The chains of different local parts which have the same remote part, each chain sets its
+ * memory locks and persist locks as addSamePartEdges, then the in-edges of all chains locked
+ * are written in one forwardTransaction, at last each chain commits its out-edges.
+ * */
+folly::Future<std::unordered_map<PartitionID, nebula::cpp2::ErrorCode>>
+TransactionManager::addSameRemotePartEdges(
+        size_t vIdLen,
+        GraphSpaceID spaceId,
+        PartitionID remotePart,
+        std::unordered_map<PartitionID, std::vector<KV>> edgesByPart,
+        AddEdgesProcessor* processor) {
+    struct Chain {
+        PartitionID localPart;
+        int64_t txnId;
+        std::vector<KV> edges;
+        std::vector<KV> lockData;
+    };
+    auto results = std::make_shared<std::unordered_map<PartitionID, nebula::cpp2::ErrorCode>>();
+    auto chains = std::make_shared<std::vector<Chain>>();
+    std::vector<folly::SemiFuture<nebula::cpp2::ErrorCode>> lockFutures;
+    for (auto& part : edgesByPart) {
+        Chain chain{part.first, TransactionUtils::getSnowFlakeUUID(), std::move(part.second), {}};
+        for (auto& kv : chain.edges) {
+            env_->evictEdgeCache(spaceId, vIdLen, kv.first);
+        }
+        // steps 1: lock edges in memory
+        if (!lockEdgesInMemory(chain.txnId, chain.edges)) {
+            LOG(ERROR) << "set memory lock failed, txnId=" << chain.txnId;
+            unlockEdgesInMemory(chain.txnId, chain.edges);
+            (*results)[chain.localPart] = nebula::cpp2::ErrorCode::E_MUTATE_EDGE_CONFLICT;
+            continue;
+        }
+        auto ret = lockDataOfEdges(vIdLen, spaceId, chain.localPart, chain.edges, processor);
+        if (!nebula::ok(ret)) {
+            unlockEdgesInMemory(chain.txnId, chain.edges);
+            (*results)[chain.localPart] = nebula::error(ret);
+            continue;
+        }
+        chain.lockData = nebula::value(ret);
+        // steps 2: batch commit persist locks, the chains are committed in parallel
+        auto lockDataSink = chain.lockData;
+        lockFutures.emplace_back(
+            commitBatch(spaceId, chain.localPart, encodeBatch(std::move(lockDataSink))));
+        chains->emplace_back(std::move(chain));
+    }
+
+    auto cleanup = [=] {
+        for (auto& chain : *chains) {
+            unlockEdgesInMemory(chain.txnId, chain.edges);
+        }
+    };
+    auto c = folly::makePromiseContract<
+        std::unordered_map<PartitionID, nebula::cpp2::ErrorCode>>();
+    folly::collectAll(std::move(lockFutures))
+        .via(exec_.get())
+        .thenValue([=, p = std::move(c.first)](auto&& tries) mutable {
+            std::vector<size_t> locked;
+            std::vector<KV> remoteEdges;
+            for (size_t i = 0; i < tries.size(); i++) {
+                auto& chain = (*chains)[i];
+                auto code = tries[i].hasValue() ? tries[i].value()
+                                                : nebula::cpp2::ErrorCode::E_UNKNOWN;
+                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                    LOG(INFO) << "commitBatch for (" << spaceId << "," << chain.localPart
+                              << "," << remotePart << ") failed, code="
+                              << static_cast<int32_t>(code) << ", txnId=" << chain.txnId;
+                    (*results)[chain.localPart] = code;
+                    continue;
+                }
+                locked.emplace_back(i);
+                appendRemoteEdges(vIdLen, remotePart, chain.edges, &remoteEdges);
+            }
+            if (locked.empty()) {
+                cleanup();
+                p.setValue(*results);
+                return;
+            }
+
+            // steps 3: multi put remote edges of all chains locked
+            auto txnId = (*chains)[locked.front()].txnId;
+            LOG_IF(INFO, FLAGS_trace_toss) << "begin forwardTransaction of " << locked.size()
+                                           << " chains, txnId=" << txnId;
+            interClient_->forwardTransaction(
+                    txnId, spaceId, remotePart, encodeBatch(std::move(remoteEdges)))
+                .via(exec_.get())
+                .thenTry([=, p = std::move(p)](auto&& t) mutable {
+                    auto code = t.hasValue() ? t.value() : nebula::cpp2::ErrorCode::E_UNKNOWN;
+                    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                        for (auto i : locked) {
+                            (*results)[(*chains)[i].localPart] = code;
+                        }
+                        cleanup();
+                        p.setValue(*results);
+                        return;
+                    }
+
+                    // steps 4 & 5: multi put local edges & multi remove persist locks
+                    std::vector<folly::SemiFuture<nebula::cpp2::ErrorCode>> commitFutures;
+                    for (auto i : locked) {
+                        auto& chain = (*chains)[i];
+                        commitFutures.emplace_back(commitBatch(
+                            spaceId, chain.localPart, encodeCommitBatch(chain.lockData,
+                                                                        chain.txnId)));
+                    }
+                    folly::collectAll(std::move(commitFutures))
+                        .via(exec_.get())
+                        .thenValue([=, p = std::move(p)](auto&& commits) mutable {
+                            for (size_t j = 0; j < commits.size(); j++) {
+                                auto rc = commits[j].hasValue()
+                                    ? commits[j].value()
+                                    : nebula::cpp2::ErrorCode::E_UNKNOWN;
+                                if (rc != nebula::cpp2::ErrorCode::SUCCEEDED) {
+                                    (*results)[(*chains)[locked[j]].localPart] = rc;
+                                }
+                            }
+                            cleanup();
+                            p.setValue(*results);
+                        });
+                });
+        });
+    return std::move(c.second).via(exec_.get());
+}
+
+bool TransactionManager::lockEdgesInMemory(int64_t txnId, const std::vector<KV>& edges) {
+    bool setMemoryLock = true;
+    std::for_each(edges.begin(), edges.end(), [&](auto& kv){
+        auto keyWoVer = NebulaKeyUtils::keyWithNoVersion(kv.first).str();
+        if (!memLock_.insert(std::make_pair(keyWoVer, txnId)).second) {
+            setMemoryLock = false;
+        }
+    });
+    return setMemoryLock;
+}
+
+void TransactionManager::unlockEdgesInMemory(int64_t txnId, const std::vector<KV>& edges) {
+    for (auto& kv : edges) {
+        auto keyWoVer = NebulaKeyUtils::keyWithNoVersion(kv.first).str();
+        auto cit = memLock_.find(keyWoVer);
+        if (cit != memLock_.end() && cit->second == txnId) {
+            memLock_.erase(keyWoVer);
+        }
+    }
+}
+
+ErrorOr<nebula::cpp2::ErrorCode, std::vector<KV>>
+TransactionManager::lockDataOfEdges(size_t vIdLen,
+                                    GraphSpaceID spaceId,
+                                    PartitionID localPart,
+                                    const std::vector<KV>& edges,
+                                    AddEdgesProcessor* processor) {
+    std::vector<KV> lockData = edges;
+    auto addEdgeErrorCode = nebula::cpp2::ErrorCode::SUCCEEDED;
+    std::transform(lockData.begin(), lockData.end(), lockData.begin(), [&](auto& kv) {
+        if (processor) {
+            processor->spaceId_ = spaceId;
+            processor->spaceVidLen_ = vIdLen;
+            std::vector<KV> data{std::make_pair(kv.first, kv.second)};
+            auto optVal = processor->addEdges(localPart, data);
+            if (nebula::ok(optVal)) {
+                return std::make_pair(NebulaKeyUtils::toLockKey(kv.first),
+                                      nebula::value(optVal));
+            } else {
+                addEdgeErrorCode = nebula::cpp2::ErrorCode::E_ATOMIC_OP_FAILED;
+                return std::make_pair(NebulaKeyUtils::toLockKey(kv.first), std::string(""));
+            }
+        } else {
+            std::vector<KV> data{std::make_pair(kv.first, kv.second)};
+            return std::make_pair(NebulaKeyUtils::toLockKey(kv.first),
+                                  encodeBatch(std::move(data)));
+        }
+    });
+    if (addEdgeErrorCode != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return addEdgeErrorCode;
+    }
+    return lockData;
+}
+
+void TransactionManager::appendRemoteEdges(size_t vIdLen,
+                                           PartitionID remotePart,
+                                           const std::vector<KV>& edges,
+                                           std::vector<KV>* remoteEdges) {
+    for (auto& kv : edges) {
+        auto key = TransactionUtils::reverseRawKey(vIdLen, remotePart, kv.first);
+        remoteEdges->emplace_back(std::move(key), kv.second);
+    }
+}
+
+std::string TransactionManager::encodeCommitBatch(std::vector<KV> lockData, int64_t txnId) {
+    kvstore::BatchHolder bat;
+    for (auto& lock : lockData) {
+        LOG_IF(INFO, FLAGS_trace_toss)
+            << "remove lock, hex=" << folly::hexlify(lock.first)
+            << ", txnId=" << txnId;
+        bat.remove(std::move(lock.first));
+        auto operations = kvstore::decodeBatchValue(lock.second);
+        for (auto& op : operations) {
+            auto opType = op.first;
+            auto& kv = op.second;
+            LOG_IF(INFO, FLAGS_trace_toss)
+                        << "bat op=" << static_cast<int32_t>(opType)
+                        << ", hex=" << folly::hexlify(kv.first)
+                        << ", txnId=" << txnId;
+            switch (opType) {
+                case kvstore::BatchLogType::OP_BATCH_PUT:
+                    bat.put(kv.first.str(), kv.second.str());
+                    break;
+                case kvstore::BatchLogType::OP_BATCH_REMOVE:
+                    bat.remove(kv.first.str());
+                    break;
+                default:
+                    LOG(ERROR) << "unexpected opType: " << static_cast<int>(opType);
+            }
+        }
+    }
+    return kvstore::encodeBatchValue(bat.getBatch());
+}
+
 folly::Future<nebula::cpp2::ErrorCode>
 TransactionManager::updateEdgeAtomic(size_t vIdLen,
                                      GraphSpaceID spaceId,
@@ -273,19 +528,19 @@ TransactionManager::resumeTransaction(size_t vIdLen,
 
     LOG_IF(INFO, FLAGS_trace_toss) << "try to get remote key=" << folly::hexlify(remoteKey)
         << ", according to lock=" << folly::hexlify(lockKey);
+    // Each step returns the future of the next one, so no thread of exec_ waits for the remote
+    // part or the raft commit
     interClient_->getValue(vIdLen, spaceId, remoteKey)
         .via(exec_.get())
-        .thenValue([=](auto&& errOrVal) mutable {
+        .thenValue([=](auto&& errOrVal) mutable -> folly::Future<nebula::cpp2::ErrorCode> {
             if (!nebula::ok(errOrVal)) {
                 LOG_IF(INFO, FLAGS_trace_toss)
                     << "get remote key failed, lock=" << folly::hexlify(lockKey);
-                *spPromiseVal = nebula::error(errOrVal);
-                return;
+                return nebula::error(errOrVal);
             }
             auto lockedPtr = result->wlock();
             if (!lockedPtr) {
-                *spPromiseVal = nebula::cpp2::ErrorCode::E_MUTATE_EDGE_CONFLICT;
-                return;
+                return nebula::cpp2::ErrorCode::E_MUTATE_EDGE_CONFLICT;
             }
             auto& kv = *lockedPtr;
             kv.first = localKey;
@@ -299,27 +554,30 @@ TransactionManager::resumeTransaction(size_t vIdLen,
              *                  which means we can trust the val of lock as the out-edge
              *              else, don't trust lock.
              * */
-            commitEdgeOut(
+            return commitEdgeOut(
                     spaceId, localPart, std::string(kv.first), std::string(kv.second))
                     .via(exec_.get())
-                    .thenValue([=](auto&& rc) { *spPromiseVal = rc; })
-                    .thenError([=](auto&&) {
-                        *spPromiseVal = nebula::cpp2::ErrorCode::E_UNKNOWN;
+                    .thenError([](auto&&) {
+                        return nebula::cpp2::ErrorCode::E_UNKNOWN;
                     });
         })
-        .thenValue([=](auto&&) {
+        .thenValue([=](nebula::cpp2::ErrorCode rc) -> folly::Future<nebula::cpp2::ErrorCode> {
             // 4th, remove persist lock
             LOG_IF(INFO, FLAGS_trace_toss) << "erase lock " << folly::hexlify(lockKey)
-                << ", *spPromiseVal=" << static_cast<int32_t>(*spPromiseVal);
-            if (*spPromiseVal == nebula::cpp2::ErrorCode::SUCCEEDED ||
-                *spPromiseVal == nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND ||
-                *spPromiseVal == nebula::cpp2::ErrorCode::E_OUTDATED_LOCK) {
-                auto eraseRet = eraseKey(spaceId, localPart, lockKey);
-                eraseRet.wait();
-                auto code = eraseRet.hasValue() ? eraseRet.value() :
-                    nebula::cpp2::ErrorCode::E_UNKNOWN;
-                *spPromiseVal = code;
+                << ", code=" << static_cast<int32_t>(rc);
+            if (rc == nebula::cpp2::ErrorCode::SUCCEEDED ||
+                rc == nebula::cpp2::ErrorCode::E_KEY_NOT_FOUND ||
+                rc == nebula::cpp2::ErrorCode::E_OUTDATED_LOCK) {
+                return eraseKey(spaceId, localPart, lockKey)
+                    .via(exec_.get())
+                    .thenError([](auto&&) {
+                        return nebula::cpp2::ErrorCode::E_UNKNOWN;
+                    });
             }
+            return rc;
+        })
+        .thenValue([=](nebula::cpp2::ErrorCode rc) {
+            *spPromiseVal = rc;
         })
         .thenError([=](auto&& ex) {
             LOG(ERROR) << ex.what();
@@ -357,6 +615,10 @@ TransactionManager::commitEdgeOut(GraphSpaceID spaceId,
                                   PartitionID partId,
                                   std::string&& key,
                                   std::string&& props) {
+    auto vIdLen = env_->schemaMan_->getSpaceVidLen(spaceId);
+    if (vIdLen.ok()) {
+        env_->evictEdgeCache(spaceId, vIdLen.value(), key);
+    }
     std::vector<std::shared_ptr<nebula::meta::cpp2::IndexItem>> indexes;
     auto idxRet = env_->indexMan_->getEdgeIndexes(spaceId);
     if (idxRet.ok()) {
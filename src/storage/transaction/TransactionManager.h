@@ -16,6 +16,7 @@
 #include "common/clients/storage/InternalStorageClient.h"
 #include "common/interface/gen-cpp2/storage_types.h"
 #include "common/meta/SchemaManager.h"
+#include "common/thread/GenericWorker.h"
 #include "common/thrift/ThriftTypes.h"
 #include "kvstore/KVStore.h"
 #include "storage/mutate/AddEdgesProcessor.h"
@@ -35,7 +36,14 @@ class TransactionManager {
 public:
     explicit TransactionManager(storage::StorageEnv* env);
 
-    ~TransactionManager() = default;
+    ~TransactionManager() {
+        stop();
+    }
+
+    // Start the background worker resuming the locks left, see resumeLocks()
+    bool start();
+
+    void stop();
 
     /**
      * @brief edges have same localPart and remotePart will share
@@ -57,6 +65,19 @@ public:
         AddEdgesProcessor* processor = nullptr,
         folly::Optional<GetBatchFunc> optBatchGetter = folly::none);
 
+    /**
+     * @brief add the edges of several chains (local part -> remotePart) together,
+     *        the in-edges of all chains are forwarded to remotePart in one request.
+     *        Each local part is still a transaction of its own, the code of each
+     *        local part failed is returned, an empty map means all succeeded.
+     * */
+    folly::Future<std::unordered_map<PartitionID, nebula::cpp2::ErrorCode>>
+    addSameRemotePartEdges(size_t vIdLen,
+                           GraphSpaceID spaceId,
+                           PartitionID remotePart,
+                           std::unordered_map<PartitionID, std::vector<KV>> edgesByPart,
+                           AddEdgesProcessor* processor = nullptr);
+
     /**
      * @brief update out-edge first, then in-edge
      * @param batchGetter
@@ -122,11 +143,43 @@ protected:
 
     std::string encodeBatch(std::vector<KV>&& data);
 
+    // Set the memory locks of edges, return false if any of them is locked by others
+    bool lockEdgesInMemory(int64_t txnId, const std::vector<KV>& edges);
+
+    void unlockEdgesInMemory(int64_t txnId, const std::vector<KV>& edges);
+
+    // Build the persist locks of the inserted edges, the value is the batch to commit
+    ErrorOr<nebula::cpp2::ErrorCode, std::vector<KV>>
+    lockDataOfEdges(size_t vIdLen,
+                    GraphSpaceID spaceId,
+                    PartitionID localPart,
+                    const std::vector<KV>& edges,
+                    AddEdgesProcessor* processor);
+
+    void appendRemoteEdges(size_t vIdLen,
+                           PartitionID remotePart,
+                           const std::vector<KV>& edges,
+                           std::vector<KV>* remoteEdges);
+
+    // Commit the batch in the persist locks and remove the locks
+    std::string encodeCommitBatch(std::vector<KV> lockData, int64_t txnId);
+
+    // Resume the locks of the toss parts led by this host, the parts elected since the last
+    // round, or not scanned for FLAGS_toss_resume_lock_interval_secs, are scanned
+    void resumeLocks();
+
+    // Scan the edges of the part and resume all locks found
+    void resumeLocksOfPart(size_t vIdLen, GraphSpaceID spaceId, PartitionID partId);
+
 protected:
     StorageEnv*                                         env_{nullptr};
     std::shared_ptr<folly::IOThreadPoolExecutor>        exec_;
     std::unique_ptr<storage::InternalStorageClient>     interClient_;
     MemEdgeLocks                                        memLock_;
+    std::unique_ptr<thread::GenericWorker>              resumeWorker_;
+    // term and time in ms of the last scan of each part, only accessed by resumeWorker_
+    std::unordered_map<std::pair<GraphSpaceID, PartitionID>,
+                       std::pair<TermID, int64_t>>      scannedParts_;
 };
 
 }  // namespace storage
@@ -21,6 +21,14 @@ void InterTxnProcessor::process(const cpp2::InternalTxnRequest& req) {
     LOG_IF(INFO, FLAGS_trace_toss) << "process req, txnId=" << txnId
                                    << ", spaceId=" << spaceId << ", partId=" << partId;
     auto data = req.get_data()[req.get_position()].back();
+    if (env_->edgeCache_ != nullptr) {
+        auto vIdLen = env_->schemaMan_->getSpaceVidLen(spaceId);
+        if (vIdLen.ok()) {
+            for (auto& op : kvstore::decodeBatchValue(data)) {
+                env_->evictEdgeCache(spaceId, vIdLen.value(), op.second.first);
+            }
+        }
+    }
 
     env_->txnMan_->commitBatch(spaceId, partId, std::move(data))
         .via(env_->txnMan_->getExecutor())
@@ -25,12 +25,27 @@ optional:
          A list of meta severs' ip:port seperated by comma.
          Default: 127.0.0.1:45500
 
-       --mode= scan | stat
+       --mode= scan | stat | export | estimate
          scan: print to screen when records meet the condition, and also print statistics
                to screen in final.
          stat: print statistics to screen.
+         export: write the decoded rows of the parts to csv files under output_dir, one
+               file per tag or edge of each part, by threads threads.
+         estimate: print the keys and sizes of each part estimated by the table properties,
+               without reading the data.
          Defualt: scan
 
+       --checkpoint=<checkpoint name>
+         Read the checkpoint of the space instead of the live data.
+
+       --threads=<N>
+         The number of parts exported at the same time.
+         Default: 4
+
+       --output_dir=<path>
+         The directory the rows are exported to.
+         Default: ./dump
+
        --vids=<list of vid>
          A list of vid seperated by comma. This parameter means vertex_id/edge_src_id
          Would scan the whole space's records if it is not given.
@@ -65,6 +80,11 @@ void printParams() {
     std::cout << "tags: " << FLAGS_tags << "\n";
     std::cout << "edges: " << FLAGS_edges << "\n";
     std::cout << "limit: " << FLAGS_limit << "\n";
+    std::cout << "checkpoint: " << FLAGS_checkpoint << "\n";
+    if (FLAGS_mode == "export") {
+        std::cout << "threads: " << FLAGS_threads << "\n";
+        std::cout << "output dir: " << FLAGS_output_dir << "\n";
+    }
     std::cout << "===========================PARAMS============================\n\n";
 }
 
@@ -8,20 +8,57 @@
 #include "common/time/Duration.h"
 #include "tools/db-dump/DbDumper.h"
 #include "utils/NebulaKeyUtils.h"
+#include <fstream>
 
 DEFINE_string(space_name, "", "The space name.");
 DEFINE_string(db_path, "./", "Path to rocksdb.");
 DEFINE_string(meta_server, "127.0.0.1:45500", "Meta servers' address.");
-DEFINE_string(mode, "scan", "Dump mode, scan | stat");
+DEFINE_string(mode, "scan", "Dump mode, scan | stat | export | estimate");
 DEFINE_string(parts, "", "A list of partition id seperated by comma.");
 DEFINE_string(vids, "", "A list of vertex ids seperated by comma.");
 DEFINE_string(tags, "", "A list of tag name seperated by comma.");
 DEFINE_string(edges, "", "A list of edge name seperated by comma.");
 DEFINE_int64(limit, 1000, "Limit to output.");
+DEFINE_int32(threads, 4, "The number of parts exported at the same time.");
+DEFINE_string(output_dir, "./dump", "The directory the rows are exported to.");
+DEFINE_string(checkpoint, "", "The name of the checkpoint to read instead of the live data.");
 
 namespace nebula {
 namespace storage {
 
+namespace {
+
+// quote the strings, and double the quotes in them
+std::string toCsv(const Value& value) {
+    if (value.isNull()) {
+        return "";
+    }
+    if (!value.isStr()) {
+        return value.toString();
+    }
+    std::string field = "\"";
+    for (auto c : value.getStr()) {
+        if (c == '"') {
+            field += '"';
+        }
+        field += c;
+    }
+    field += '"';
+    return field;
+}
+
+}  // namespace
+
+DbDumper::~DbDumper() {
+    if (db_ != nullptr) {
+        for (auto* family : families_) {
+            if (family != db_->DefaultColumnFamily()) {
+                db_->DestroyColumnFamilyHandle(family);
+            }
+        }
+    }
+}
+
 Status DbDumper::init() {
     auto status = initMeta();
     if (!status.ok()) {
@@ -82,6 +119,12 @@ Status DbDumper::initSpace() {
     }
     spaceVidLen_ = spaceVidLen.value();
 
+    auto vidType = schemaMng_->getSpaceVidType(spaceId_);
+    if (!vidType.ok()) {
+        return vidType.status();
+    }
+    intVid_ = vidType.value() == meta::cpp2::PropertyType::INT64;
+
     auto partNum = metaClient_->partsNum(spaceId_);
     if (!partNum.ok()) {
         return Status::Error("Get partition number from '%s' failed.", FLAGS_space_name.c_str());
@@ -116,9 +159,13 @@ Status DbDumper::initParams() {
         edgeTypes_.emplace(edgeType.value());
     }
 
-    if (FLAGS_mode.compare("scan") != 0 && FLAGS_mode.compare("stat") != 0) {
+    if (FLAGS_mode.compare("scan") != 0 && FLAGS_mode.compare("stat") != 0 &&
+        FLAGS_mode.compare("export") != 0 && FLAGS_mode.compare("estimate") != 0) {
         return Status::Error("Unkown mode '%s'.", FLAGS_mode.c_str());
     }
+    if (FLAGS_mode == "export" && FLAGS_threads <= 0) {
+        return Status::Error("Invalid threads %d.", FLAGS_threads);
+    }
     return Status::OK();
 }
 
@@ -134,15 +181,38 @@ Status DbDumper::openDb() {
                              FLAGS_space_name.c_str(), FLAGS_db_path.c_str());
     }
     auto path = fs::FileUtils::joinPath(FLAGS_db_path, *spaceFound);
+    if (!FLAGS_checkpoint.empty()) {
+        // the checkpoint is a consistent copy of the data, which is not changed while dumping
+        path = fs::FileUtils::joinPath(path, "checkpoints");
+        path = fs::FileUtils::joinPath(path, FLAGS_checkpoint);
+        if (!fs::FileUtils::exist(path)) {
+            return Status::Error("Checkpoint '%s' not exists.", path.c_str());
+        }
+    }
     path = fs::FileUtils::joinPath(path, "data");
 
+    // all the column families are opened, the edges may be in their own one
+    std::vector<std::string> names;
+    if (!rocksdb::DB::ListColumnFamilies(options_, path, &names).ok() || names.empty()) {
+        names = {rocksdb::kDefaultColumnFamilyName};
+    }
+    std::vector<rocksdb::ColumnFamilyDescriptor> descriptors;
+    for (auto& name : names) {
+        descriptors.emplace_back(name, rocksdb::ColumnFamilyOptions(options_));
+    }
     rocksdb::DB* dbPtr;
-    auto status = rocksdb::DB::OpenForReadOnly(options_, path, &dbPtr);
+    auto status = rocksdb::DB::OpenForReadOnly(
+        rocksdb::DBOptions(options_), path, descriptors, &families_, &dbPtr);
     if (!status.ok()) {
         return Status::Error("Unable to open database '%s' for reading: '%s'",
                              path.c_str(), status.ToString().c_str());
     }
     db_.reset(dbPtr);
+    for (size_t i = 0; i < names.size(); i++) {
+        if (names[i] == "edge") {
+            edgeFamily_ = families_[i];
+        }
+    }
     return Status::OK();
 }
 
@@ -157,6 +227,16 @@ bool DbDumper::isValidVidLen(VertexID vid) {
 
 void DbDumper::run() {
     time::Duration dur;
+    if (FLAGS_mode == "export") {
+        exportParts();
+        std::cout << "Time cost: " << dur.elapsedInUSec() << " us\n\n";
+        return;
+    }
+    if (FLAGS_mode == "estimate") {
+        estimate();
+        std::cout << "Time cost: " << dur.elapsedInUSec() << " us\n\n";
+        return;
+    }
     auto noPrint = [] (const folly::StringPiece& key) -> bool {
         UNUSED(key);
         return false;
@@ -396,31 +476,45 @@ void DbDumper::run() {
         }
     }
 
+    printStats(stats_);
+    std::cout << "Time cost: " << dur.elapsedInUSec() << " us\n\n";
+}
+
+void DbDumper::printStats(const DumpStats& stats) {
     std::cout << "===========================STATISTICS============================\n";
-    std::cout << "COUNT: " << count_ << "\n";
-    std::cout << "VERTEX COUNT: " << vertexCount_ << "\n";
-    std::cout << "EDGE COUNT: " << edgeCount_ << "\n";
+    std::cout << "COUNT: " << stats.count << "\n";
+    std::cout << "VERTEX COUNT: " << stats.vertexCount << "\n";
+    std::cout << "EDGE COUNT: " << stats.edgeCount << "\n";
     std::cout << "TAG STATISTICS: \n";
-    for (auto &t : tagStat_) {
+    for (auto &t : stats.tagStat) {
         std::cout << "\t" << getTagName(t.first) << " : " << t.second << "\n";
     }
     std::cout << "EDGE STATISTICS: \n";
-    for (auto &e : edgeStat_) {
+    for (auto &e : stats.edgeStat) {
         std::cout << "\t" << getEdgeName(e.first) << " : " << e.second << "\n";
     }
     std::cout << "============================STATISTICS===========================\n";
-    std::cout << "Time cost: " << dur.elapsedInUSec() << " us\n\n";
+}
+
+rocksdb::ColumnFamilyHandle* DbDumper::familyOf(const std::string& prefix) const {
+    if (edgeFamily_ != nullptr && !prefix.empty() &&
+        static_cast<NebulaKeyType>(static_cast<uint8_t>(prefix[0])) == NebulaKeyType::kEdge) {
+        return edgeFamily_;
+    }
+    return db_->DefaultColumnFamily();
 }
 
 void DbDumper::seekToFirst() {
-    const auto it = db_->NewIterator(rocksdb::ReadOptions());
-    it->SeekToFirst();
-    const auto prefixIt = std::make_unique<kvstore::RocksPrefixIter>(it, "");
-    iterates(prefixIt.get());
+    for (auto* family : families_) {
+        const auto it = db_->NewIterator(rocksdb::ReadOptions(), family);
+        it->SeekToFirst();
+        const auto prefixIt = std::make_unique<kvstore::RocksPrefixIter>(it, "");
+        iterates(prefixIt.get());
+    }
 }
 
 void DbDumper::seek(std::string& prefix) {
-    const auto it = db_->NewIterator(rocksdb::ReadOptions());
+    const auto it = db_->NewIterator(rocksdb::ReadOptions(), familyOf(prefix));
     it->Seek(rocksdb::Slice(prefix));
     const auto prefixIt = std::make_unique<kvstore::RocksPrefixIter>(it, prefix);
     iterates(prefixIt.get());
@@ -428,7 +522,7 @@ void DbDumper::seek(std::string& prefix) {
 
 void DbDumper::iterates(kvstore::RocksPrefixIter* it) {
     for (; it->valid(); it->next()) {
-        if (FLAGS_limit > 0 && count_ >= FLAGS_limit) {
+        if (FLAGS_limit > 0 && stats_.count >= FLAGS_limit) {
             break;
         }
 
@@ -462,14 +556,14 @@ void DbDumper::iterates(kvstore::RocksPrefixIter* it) {
             }
 
             // statistics
-            auto tagStat = tagStat_.find(tagId);
-            if (tagStat == tagStat_.end()) {
-                tagStat_.emplace(tagId, 1);
+            auto tagStat = stats_.tagStat.find(tagId);
+            if (tagStat == stats_.tagStat.end()) {
+                stats_.tagStat.emplace(tagId, 1);
             } else {
                 ++(tagStat->second);
             }
-            ++vertexCount_;
-            ++count_;
+            ++stats_.vertexCount;
+            ++stats_.count;
         } else if (NebulaKeyUtils::isEdge(spaceVidLen_, key)) {
             // filter the data
             bool isFiltered = false;
@@ -501,14 +595,14 @@ void DbDumper::iterates(kvstore::RocksPrefixIter* it) {
             }
 
             // statistics
-            auto edgeStat = edgeStat_.find(edgeType);
-            if (edgeStat == edgeStat_.end()) {
-                edgeStat_.emplace(edgeType, 1);
+            auto edgeStat = stats_.edgeStat.find(edgeType);
+            if (edgeStat == stats_.edgeStat.end()) {
+                stats_.edgeStat.emplace(edgeType, 1);
             } else {
                 ++(edgeStat->second);
             }
-            ++edgeCount_;
-            ++count_;
+            ++stats_.edgeCount;
+            ++stats_.count;
         }
     }
 }
@@ -569,5 +663,232 @@ std::string DbDumper::getEdgeName(const EdgeType edgeType) {
         return name.value();
     }
 }
+
+void DbDumper::exportParts() {
+    std::vector<PartitionID> parts(parts_.begin(), parts_.end());
+    if (parts.empty()) {
+        for (PartitionID partId = 1; partId <= partNum_; partId++) {
+            parts.emplace_back(partId);
+        }
+    }
+    std::sort(parts.begin(), parts.end());
+
+    std::atomic<size_t> next{0};
+    std::mutex lock;
+    DumpStats total;
+    std::vector<std::thread> threads;
+    for (int32_t i = 0; i < std::min<int32_t>(FLAGS_threads, parts.size()); i++) {
+        threads.emplace_back([&] {
+            DumpStats stats;
+            for (auto index = next++; index < parts.size(); index = next++) {
+                auto status = exportPart(parts[index], &stats);
+                std::lock_guard<std::mutex> g(lock);
+                if (!status.ok()) {
+                    std::cerr << "Export part " << parts[index] << " failed: " << status << "\n";
+                } else {
+                    std::cout << "Exported part " << parts[index] << "\n";
+                }
+            }
+            std::lock_guard<std::mutex> g(lock);
+            total.merge(stats);
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    printStats(total);
+}
+
+Status DbDumper::exportPart(PartitionID partId, DumpStats* stats) {
+    // the file of each tag and edge of the part, opened when the first row is found
+    std::unordered_map<TagID, std::unique_ptr<std::ofstream>> tagFiles;
+    std::unordered_map<EdgeType, std::unique_ptr<std::ofstream>> edgeFiles;
+    auto open = [&] (const std::string& name,
+                     const meta::SchemaProviderIf* schema,
+                     const std::string& keyColumns) -> std::unique_ptr<std::ofstream> {
+        auto dir = fs::FileUtils::joinPath(FLAGS_output_dir, name);
+        if (!fs::FileUtils::makeDir(dir)) {
+            return nullptr;
+        }
+        auto file = std::make_unique<std::ofstream>(
+            fs::FileUtils::joinPath(dir, folly::stringPrintf("%d.csv", partId)), std::ios::trunc);
+        if (!file->is_open()) {
+            return nullptr;
+        }
+        *file << keyColumns;
+        for (size_t i = 0; i < schema->getNumFields(); i++) {
+            *file << "," << schema->getFieldName(i);
+        }
+        *file << "\n";
+        return file;
+    };
+    auto writeRow = [] (std::ofstream* file,
+                        const meta::SchemaProviderIf* schema,
+                        const RowReader* reader,
+                        const std::string& keyFields) {
+        *file << keyFields;
+        for (size_t i = 0; i < schema->getNumFields(); i++) {
+            // the rows of an older schema have no value of the props added after
+            *file << "," << toCsv(reader->getValueByName(schema->getFieldName(i)));
+        }
+        *file << "\n";
+    };
+
+    auto vertexPrefix = NebulaKeyUtils::vertexPrefix(partId);
+    std::unique_ptr<rocksdb::Iterator> it(
+        db_->NewIterator(rocksdb::ReadOptions(), familyOf(vertexPrefix)));
+    for (it->Seek(vertexPrefix); it->Valid() && it->key().starts_with(vertexPrefix); it->Next()) {
+        folly::StringPiece key(it->key().data(), it->key().size());
+        if (!NebulaKeyUtils::isVertex(spaceVidLen_, key)) {
+            continue;
+        }
+        auto tagId = NebulaKeyUtils::getTagId(spaceVidLen_, key);
+        if (!tagIds_.empty() && !tagIds_.count(tagId)) {
+            continue;
+        }
+        auto schema = schemaMng_->getTagSchema(spaceId_, tagId);
+        auto reader = RowReaderWrapper::getTagPropReader(
+            schemaMng_.get(), spaceId_, tagId,
+            folly::StringPiece(it->value().data(), it->value().size()));
+        if (schema == nullptr || !reader) {
+            continue;
+        }
+        auto& file = tagFiles[tagId];
+        if (file == nullptr) {
+            file = open(getTagName(tagId), schema.get(), "vid");
+            if (file == nullptr) {
+                return Status::Error("Open the file of tag %d failed", tagId);
+            }
+        }
+        auto vid = vidToString(NebulaKeyUtils::getVertexId(spaceVidLen_, key));
+        writeRow(file.get(), schema.get(), reader.get(), toCsv(Value(std::move(vid))));
+        stats->tagStat[tagId]++;
+        stats->vertexCount++;
+        stats->count++;
+    }
+    if (!it->status().ok()) {
+        return Status::Error("%s", it->status().ToString().c_str());
+    }
+
+    auto edgePrefix = NebulaKeyUtils::edgePrefix(partId);
+    it.reset(db_->NewIterator(rocksdb::ReadOptions(), familyOf(edgePrefix)));
+    for (it->Seek(edgePrefix); it->Valid() && it->key().starts_with(edgePrefix); it->Next()) {
+        folly::StringPiece key(it->key().data(), it->key().size());
+        if (!NebulaKeyUtils::isEdge(spaceVidLen_, key)) {
+            continue;
+        }
+        auto edgeType = NebulaKeyUtils::getEdgeType(spaceVidLen_, key);
+        // reverse edge will be discarded
+        if (edgeType < 0 || (!edgeTypes_.empty() && !edgeTypes_.count(edgeType))) {
+            continue;
+        }
+        auto schema = schemaMng_->getEdgeSchema(spaceId_, edgeType);
+        auto reader = RowReaderWrapper::getEdgePropReader(
+            schemaMng_.get(), spaceId_, edgeType,
+            folly::StringPiece(it->value().data(), it->value().size()));
+        if (schema == nullptr || !reader) {
+            continue;
+        }
+        auto& file = edgeFiles[edgeType];
+        if (file == nullptr) {
+            file = open(getEdgeName(edgeType), schema.get(), "src,rank,dst");
+            if (file == nullptr) {
+                return Status::Error("Open the file of edge %d failed", edgeType);
+            }
+        }
+        auto keyFields = folly::stringPrintf(
+            "%s,%ld,%s",
+            toCsv(Value(vidToString(NebulaKeyUtils::getSrcId(spaceVidLen_, key)))).c_str(),
+            NebulaKeyUtils::getRank(spaceVidLen_, key),
+            toCsv(Value(vidToString(NebulaKeyUtils::getDstId(spaceVidLen_, key)))).c_str());
+        writeRow(file.get(), schema.get(), reader.get(), keyFields);
+        stats->edgeStat[edgeType]++;
+        stats->edgeCount++;
+        stats->count++;
+    }
+    if (!it->status().ok()) {
+        return Status::Error("%s", it->status().ToString().c_str());
+    }
+
+    for (auto& file : tagFiles) {
+        file.second->flush();
+        if (!file.second->good()) {
+            return Status::Error("Write the file of tag %d failed", file.first);
+        }
+    }
+    for (auto& file : edgeFiles) {
+        file.second->flush();
+        if (!file.second->good()) {
+            return Status::Error("Write the file of edge %d failed", file.first);
+        }
+    }
+    return Status::OK();
+}
+
+void DbDumper::estimate() {
+    std::cout << "===========================ESTIMATE==============================\n";
+    for (auto* family : families_) {
+        rocksdb::TablePropertiesCollection properties;
+        auto status = db_->GetPropertiesOfAllTables(family, &properties);
+        if (!status.ok()) {
+            std::cerr << "Get table properties failed: " << status.ToString() << "\n";
+            return;
+        }
+        uint64_t entries = 0, deletions = 0, dataSize = 0, rawKeySize = 0, rawValueSize = 0;
+        for (auto& entry : properties) {
+            entries += entry.second->num_entries;
+            deletions += entry.second->num_deletions;
+            dataSize += entry.second->data_size;
+            rawKeySize += entry.second->raw_key_size;
+            rawValueSize += entry.second->raw_value_size;
+        }
+        std::cout << "COLUMN FAMILY " << family->GetName() << ": " << properties.size()
+                  << " files, " << entries << " entries, " << deletions << " deletions, "
+                  << dataSize << " bytes of data, " << rawKeySize << " bytes of raw keys, "
+                  << rawValueSize << " bytes of raw values\n";
+    }
+
+    std::vector<PartitionID> parts(parts_.begin(), parts_.end());
+    if (parts.empty()) {
+        for (PartitionID partId = 1; partId <= partNum_; partId++) {
+            parts.emplace_back(partId);
+        }
+    }
+    std::sort(parts.begin(), parts.end());
+    for (auto partId : parts) {
+        std::cout << "PART " << partId << ":";
+        for (auto vertex : {true, false}) {
+            auto prefix = vertex ? NebulaKeyUtils::vertexPrefix(partId)
+                                 : NebulaKeyUtils::edgePrefix(partId);
+            auto end = NebulaKeyUtils::prefixEnd(prefix);
+            rocksdb::Range range(prefix, end);
+            auto* family = familyOf(prefix);
+            uint64_t size = 0;
+            db_->GetApproximateSizes(family, &range, 1, &size);
+            rocksdb::TablePropertiesCollection properties;
+            uint64_t entries = 0;
+            if (db_->GetPropertiesOfTablesInRange(family, &range, 1, &properties).ok()) {
+                for (auto& entry : properties) {
+                    entries += entry.second->num_entries;
+                }
+            }
+            std::cout << (vertex ? " vertex " : ", edge ") << size << " bytes, at most "
+                      << entries << " keys of the files in range";
+        }
+        std::cout << "\n";
+    }
+    std::cout << "===========================ESTIMATE==============================\n";
+}
+
+std::string DbDumper::vidToString(folly::StringPiece vid) const {
+    if (intVid_ && vid.size() >= sizeof(int64_t)) {
+        int64_t id;
+        memcpy(&id, vid.data(), sizeof(int64_t));
+        return folly::to<std::string>(id);
+    }
+    // the string vids are padded by '\0'
+    return std::string(vid.data(), strnlen(vid.data(), vid.size()));
+}
+
 }  // namespace storage
 }  // namespace nebula
@@ -24,15 +24,46 @@ DECLARE_string(vids);
 DECLARE_string(tags);
 DECLARE_string(edges);
 DECLARE_int64(limit);
+DECLARE_int32(threads);
+DECLARE_string(output_dir);
+DECLARE_string(checkpoint);
 
 namespace nebula {
 namespace storage {
 
+struct DumpStats {
+    std::unordered_map<TagID, uint32_t>                            tagStat;
+    std::unordered_map<EdgeType, uint32_t>                         edgeStat;
+    int64_t                                                        count{0};
+    int64_t                                                        vertexCount{0};
+    int64_t                                                        edgeCount{0};
+
+    void merge(const DumpStats& other) {
+        for (auto& t : other.tagStat) {
+            tagStat[t.first] += t.second;
+        }
+        for (auto& e : other.edgeStat) {
+            edgeStat[e.first] += e.second;
+        }
+        count += other.count;
+        vertexCount += other.vertexCount;
+        edgeCount += other.edgeCount;
+    }
+};
+
+/*
+DbDumper prints or counts the keys of a space read from its rocksdb, or from a checkpoint of
+it by --checkpoint. In the export mode, --threads threads take the parts in turn, and write the
+decoded rows of each tag and edge of a part into "<output_dir>/<tag or edge name>/<part>.csv",
+with a header of the props of the latest schema, so the files could be loaded in parallel by
+the analytics engines. In the estimate mode the keys and sizes of each part are estimated by
+the table properties at once.
+*/
 class DbDumper {
 public:
     DbDumper() = default;
 
-    ~DbDumper() = default;
+    ~DbDumper();
 
     Status init();
 
@@ -65,6 +96,21 @@ private:
 
     bool isValidVidLen(VertexID vid);
 
+    // the column family of the keys with the prefix
+    rocksdb::ColumnFamilyHandle* familyOf(const std::string& prefix) const;
+
+    // Export the decoded rows of the parts by FLAGS_threads threads
+    void exportParts();
+
+    Status exportPart(PartitionID partId, DumpStats* stats);
+
+    // Estimate the keys and sizes by the table properties, without reading any key
+    void estimate();
+
+    std::string vidToString(folly::StringPiece vid) const;
+
+    void printStats(const DumpStats& stats);
+
 private:
     std::unique_ptr<rocksdb::DB>                                   db_;
     rocksdb::Options                                               options_;
@@ -72,6 +118,10 @@ private:
     std::unique_ptr<meta::ServerBasedSchemaManager>                schemaMng_;
     GraphSpaceID                                                   spaceId_;
     int32_t                                                        spaceVidLen_;
+    bool                                                           intVid_{false};
+    // the column families opened, the edges are in their own family if the db has
+    std::vector<rocksdb::ColumnFamilyHandle*>                      families_;
+    rocksdb::ColumnFamilyHandle*                                   edgeFamily_{nullptr};
     int32_t                                                        partNum_;
     std::unordered_set<PartitionID>                                parts_;
     std::unordered_set<VertexID>                                   vids_;
@@ -81,11 +131,7 @@ private:
     std::vector<std::function<bool(const folly::StringPiece&)>>    beforePrintEdge_;
 
     // For statistics
-    std::unordered_map<TagID, uint32_t>                            tagStat_;
-    std::unordered_map<EdgeType, uint32_t>                         edgeStat_;
-    int64_t                                                        count_{0};
-    int64_t                                                        vertexCount_{0};
-    int64_t                                                        edgeCount_{0};
+    DumpStats                                                      stats_;
 };
 
 }  // namespace storage
@@ -11,6 +11,7 @@
 #include "tools/db-upgrade/NebulaKeyUtilsV2.h"
 #include "utils/NebulaKeyUtils.h"
 #include "utils/IndexKeyUtils.h"
+#include <rocksdb/sst_file_writer.h>
 
 DEFINE_string(src_db_path, "", "Source data path(data_path in storage 1.x conf), "
                                "multi paths should be split by comma");
@@ -24,6 +25,12 @@ DEFINE_bool(compactions, true, "When the upgrade of the space is completed, "
                                "whether to compact data");
 DEFINE_uint32(max_concurrent_parts, 10, "The parts could be processed simultaneously");
 DEFINE_uint32(max_concurrent_spaces, 5, "The spaces could be processed simultaneously");
+DEFINE_bool(upgrade_by_sst_file, false, "Whether to write the data of the parts into SST files "
+                                        "which are ingested, rather than by batches");
+DEFINE_uint32(sst_file_batch_num, 1000000, "The rows of a part sorted and written into an SST "
+                                           "file, if upgrade_by_sst_file is set");
+DEFINE_bool(upgrade_resume, false, "Whether to skip the parts upgraded by the last run, which "
+                                   "are checkpointed in the destination data path");
 
 namespace nebula {
 namespace storage {
@@ -81,6 +88,21 @@ Status UpgraderSpace::initSpace(const std::string& sId) {
     LOG(INFO) << "Src data path: " << srcPath_ << " space id " << spaceId_  << " has "
               << parts_.size() << " parts";
 
+    auto spacePath = folly::stringPrintf("%s/nebula/%d", dstPath_.c_str(), spaceId_);
+    checkpointPath_ = fs::FileUtils::joinPath(spacePath, "upgrade_checkpoint");
+    sstPath_ = fs::FileUtils::joinPath(spacePath, "upgrade");
+    if (FLAGS_upgrade_by_sst_file && !fs::FileUtils::makeDir(sstPath_)) {
+        return Status::Error("Make dir %s failed", sstPath_.c_str());
+    }
+    if (FLAGS_upgrade_resume) {
+        auto upgraded = loadCheckpoint();
+        parts_.erase(std::remove_if(parts_.begin(), parts_.end(), [&upgraded] (auto partId) {
+            return upgraded.count(partId) != 0;
+        }), parts_.end());
+        LOG(INFO) << "Space id " << spaceId_ << " has " << upgraded.size()
+                  << " parts upgraded by the last run, " << parts_.size() << " parts left";
+    }
+
     tagSchemas_.clear();
     tagFieldName_.clear();
     tagIndexes_.clear();
@@ -238,6 +260,7 @@ void UpgraderSpace::runPartV1() {
 
         while (iter && iter->valid()) {
             auto key = iter->key();
+            readKeys_.fetch_add(1, std::memory_order_relaxed);
             if (NebulaKeyUtilsV1::isVertex(key)) {
                 auto vId = NebulaKeyUtilsV1::getVertexId(key);
                 auto tagId = NebulaKeyUtilsV1::getTagId(key);
@@ -338,25 +361,15 @@ void UpgraderSpace::runPartV1() {
                 lastDstVertexId = dvId;
             }
 
-            if (data.size() >= FLAGS_write_batch_num) {
-                VLOG(2) << "Send record total rows " << data.size();
-                auto code = writeEngine_->multiPut(data);
-                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
-                    LOG(FATAL) << "Write multi put in space id " << spaceId_
-                               << " part id " << partId << " failed.";
-                }
-                data.clear();
+            if (isBatchFull(data)) {
+                writeData(partId, data);
             }
 
             iter->next();
         }
 
-        auto code = writeEngine_->multiPut(data);
-        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
-            LOG(FATAL) << "Write multi put in space id " << spaceId_
-                       << " part id " << partId << " failed.";
-        }
-        data.clear();
+        writeData(partId, data);
+        checkpointPart(partId);
         LOG(INFO) << "Handle vertex/edge/index data in space id " << spaceId_
                   << " part id " << partId << " finished";
 
@@ -383,6 +396,7 @@ void UpgraderSpace::doProcessV1() {
     LOG(INFO) << "Max concurrenct parts: " << partConcurrency;
 
     unFinishedPart_ = parts_.size();
+    startProgress(&NebulaKeyUtilsV1::prefix);
 
     LOG(INFO) << "Start to handle vertex/edge/index of parts data in space id " << spaceId_;
     for (size_t i = 0; i < partConcurrency; ++i) {
@@ -391,6 +405,7 @@ void UpgraderSpace::doProcessV1() {
 
     while (unFinishedPart_ != 0) {
         sleep(10);
+        reportProgress();
     }
 
     // handle system data
@@ -468,6 +483,7 @@ void UpgraderSpace::runPartV2() {
 
         while (iter && iter->valid()) {
             auto key = iter->key();
+            readKeys_.fetch_add(1, std::memory_order_relaxed);
             if (NebulaKeyUtilsV2::isVertex(spaceVidLen_, key)) {
                 auto vId = NebulaKeyUtilsV2::getVertexId(spaceVidLen_, key).str();
                 auto tagId = NebulaKeyUtilsV2::getTagId(spaceVidLen_, key);
@@ -564,25 +580,15 @@ void UpgraderSpace::runPartV2() {
                 lastDstVertexId = dvId;
             }
 
-            if (data.size() >= FLAGS_write_batch_num) {
-                VLOG(2) << "Send record total rows " << data.size();
-                auto code = writeEngine_->multiPut(data);
-                if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
-                    LOG(FATAL) << "Write multi put in space id " << spaceId_
-                               << " part id " << partId << " failed.";
-                }
-                data.clear();
+            if (isBatchFull(data)) {
+                writeData(partId, data);
             }
 
             iter->next();
         }
 
-        auto code = writeEngine_->multiPut(data);
-        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
-            LOG(FATAL) << "Write multi put in space id " << spaceId_
-                       << " part id " << partId << " failed.";
-        }
-        data.clear();
+        writeData(partId, data);
+        checkpointPart(partId);
         LOG(INFO) << "Handle vertex/edge/index data in space id " << spaceId_
                   << " part id " << partId << " succeed";
 
@@ -608,6 +614,7 @@ void UpgraderSpace::doProcessV2() {
                                     parts_.size());
     LOG(INFO) << "Max concurrenct parts: " << partConcurrency;
     unFinishedPart_ = parts_.size();
+    startProgress(&NebulaKeyUtilsV2::partPrefix);
 
     LOG(INFO) << "Start to handle vertex/edge/index of parts data in space id " << spaceId_;
     for (size_t i = 0; i < partConcurrency; ++i) {
@@ -616,6 +623,7 @@ void UpgraderSpace::doProcessV2() {
 
     while (unFinishedPart_ != 0) {
         sleep(10);
+        reportProgress();
     }
 
     // handle system data
@@ -654,6 +662,146 @@ void UpgraderSpace::doProcessV2() {
     }
 }
 
+bool UpgraderSpace::isBatchFull(const std::vector<kvstore::KV>& data) {
+    return data.size() >= (FLAGS_upgrade_by_sst_file ? FLAGS_sst_file_batch_num
+                                                     : FLAGS_write_batch_num);
+}
+
+void UpgraderSpace::writeData(PartitionID partId, std::vector<kvstore::KV>& data) {
+    if (data.empty()) {
+        return;
+    }
+    int64_t bytes = 0;
+    for (const auto& kv : data) {
+        bytes += kv.first.size() + kv.second.size();
+    }
+    VLOG(2) << "Send record total rows " << data.size();
+    if (FLAGS_upgrade_by_sst_file) {
+        auto ret = writeSstFile(partId, data);
+        if (!ret.ok()) {
+            LOG(FATAL) << "Write SST file in space id " << spaceId_
+                       << " part id " << partId << " failed: " << ret.toString();
+        }
+    } else {
+        auto code = writeEngine_->multiPut(data);
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(FATAL) << "Write multi put in space id " << spaceId_
+                       << " part id " << partId << " failed.";
+        }
+    }
+    writtenRows_.fetch_add(data.size(), std::memory_order_relaxed);
+    writtenBytes_.fetch_add(bytes, std::memory_order_relaxed);
+    data.clear();
+}
+
+Status UpgraderSpace::writeSstFile(PartitionID partId, std::vector<kvstore::KV>& data) {
+    // The keys of an SST file must be sorted and unique, the last one of a key is written as
+    // the writes by batch do. The files of a part overlap each other, so each is ingested once
+    // written, the one ingested later covers the same keys of the ones before.
+    std::stable_sort(data.begin(), data.end(), [] (const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    auto file = folly::stringPrintf("%s/%d_%lu.sst", sstPath_.c_str(), partId,
+                                    sstFileSeq_.fetch_add(1));
+    SCOPE_EXIT {
+        if (fs::FileUtils::exist(file)) {
+            fs::FileUtils::remove(file.c_str());
+        }
+    };
+    rocksdb::Options options;
+    rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
+    auto status = writer.Open(file);
+    for (size_t i = 0; status.ok() && i < data.size(); i++) {
+        if (i + 1 < data.size() && data[i + 1].first == data[i].first) {
+            continue;
+        }
+        status = writer.Put(data[i].first, data[i].second);
+    }
+    if (status.ok()) {
+        status = writer.Finish();
+    }
+    if (!status.ok()) {
+        return Status::Error("%s", status.ToString().c_str());
+    }
+    auto code = writeEngine_->ingest({file});
+    if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+        return Status::Error("Ingest %s failed", file.c_str());
+    }
+    return Status::OK();
+}
+
+std::unordered_set<PartitionID> UpgraderSpace::loadCheckpoint() {
+    std::unordered_set<PartitionID> parts;
+    std::ifstream in(checkpointPath_);
+    PartitionID partId;
+    while (in >> partId) {
+        parts.emplace(partId);
+    }
+    return parts;
+}
+
+void UpgraderSpace::checkpointPart(PartitionID partId) {
+    // The data of the part must be durable before it is checkpointed, which the SST files
+    // ingested already are
+    if (!FLAGS_upgrade_by_sst_file) {
+        auto code = writeEngine_->flush();
+        if (code != nebula::cpp2::ErrorCode::SUCCEEDED) {
+            LOG(ERROR) << "Flush space id " << spaceId_ << " failed, part id " << partId
+                       << " is not checkpointed";
+            return;
+        }
+    }
+    std::lock_guard<std::mutex> g(checkpointLock_);
+    std::ofstream out(checkpointPath_, std::ios::app);
+    out << partId << "\n";
+    out.flush();
+    if (!out.good()) {
+        LOG(ERROR) << "Checkpoint space id " << spaceId_ << " part id " << partId << " failed";
+    }
+}
+
+void UpgraderSpace::startProgress(std::function<std::string(PartitionID)> partPrefix) {
+    // The keys to read are estimated by the SST files of the source, which counts the
+    // multiple versions too, as readKeys_ does
+    totalKeys_ = 0;
+    for (auto partId : parts_) {
+        auto prefix = partPrefix(partId);
+        int64_t keys = 0;
+        std::vector<std::string> splits;
+        auto code = readEngine_->estimateRange(prefix, NebulaKeyUtils::prefixEnd(prefix),
+                                               &keys, &splits);
+        if (code == nebula::cpp2::ErrorCode::SUCCEEDED) {
+            totalKeys_ += keys;
+        }
+    }
+    readKeys_ = 0;
+    writtenRows_ = 0;
+    writtenBytes_ = 0;
+    startTime_ = std::chrono::steady_clock::now();
+}
+
+void UpgraderSpace::reportProgress() {
+    auto secs = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - startTime_).count() / 1000.0;
+    if (secs <= 0) {
+        return;
+    }
+    auto readKeys = readKeys_.load(std::memory_order_relaxed);
+    auto rows = writtenRows_.load(std::memory_order_relaxed);
+    auto bytes = writtenBytes_.load(std::memory_order_relaxed);
+    std::string eta = "unknown";
+    if (readKeys > 0 && totalKeys_ > readKeys) {
+        eta = folly::stringPrintf("%.0fs", (totalKeys_ - readKeys) * secs / readKeys);
+    } else if (readKeys > 0) {
+        eta = "0s";
+    }
+    LOG(INFO) << "Space id " << spaceId_ << " upgraded " << rows << " rows, "
+              << folly::stringPrintf("%.1f rows/s, %.2f MB/s, ", rows / secs,
+                                     bytes / secs / 1024 / 1024)
+              << "read " << readKeys << " of about " << totalKeys_ << " keys, "
+              << unFinishedPart_ << " parts left, eta " << eta;
+}
+
 void UpgraderSpace::encodeVertexValue(PartitionID partId,
                                       RowReader* reader,
                                       const meta::NebulaSchemaProvider* schema,
@@ -27,6 +27,9 @@ DECLARE_uint32(upgrade_version);
 DECLARE_bool(compactions);
 DECLARE_uint32(max_concurrent_parts);
 DECLARE_uint32(max_concurrent_spaces);
+DECLARE_bool(upgrade_by_sst_file);
+DECLARE_uint32(sst_file_batch_num);
+DECLARE_bool(upgrade_resume);
 
 namespace nebula {
 namespace storage {
@@ -111,6 +114,25 @@ private:
 
     void runPartV2();
 
+    bool isBatchFull(const std::vector<kvstore::KV>& data);
+
+    // Write the data of a part by a batch, or into an SST file ingested if upgrade_by_sst_file
+    // is set, the data is cleared then
+    void writeData(PartitionID partId, std::vector<kvstore::KV>& data);
+
+    Status writeSstFile(PartitionID partId, std::vector<kvstore::KV>& data);
+
+    // The parts upgraded, which are checkpointed once their data is durable
+    std::unordered_set<PartitionID> loadCheckpoint();
+
+    void checkpointPart(PartitionID partId);
+
+    // Estimate the keys of the parts to read by their prefixes, and start counting
+    void startProgress(std::function<std::string(PartitionID)> partPrefix);
+
+    // Log the rows and bytes written per second, and the eta by the keys left to read
+    void reportProgress();
+
 public:
     // Souce data path
     std::string                                                    srcPath_;
@@ -159,6 +181,20 @@ private:
     folly::UnboundedBlockingQueue<PartitionID>                                partQueue_;
 
     std::atomic<size_t>                                                       unFinishedPart_;
+
+    // the parts upgraded are checkpointed into the file, one a line
+    std::string                                                               checkpointPath_;
+    std::mutex                                                                checkpointLock_;
+    // the SST files written are here before ingested
+    std::string                                                               sstPath_;
+    std::atomic<uint64_t>                                                     sstFileSeq_{0};
+
+    // the progress of the parts
+    int64_t                                                                   totalKeys_{0};
+    std::atomic<int64_t>                                                      readKeys_{0};
+    std::atomic<int64_t>                                                      writtenRows_{0};
+    std::atomic<int64_t>                                                      writtenBytes_{0};
+    std::chrono::steady_clock::time_point                                     startTime_;
 };
 
 // Upgrade one data path in storage conf
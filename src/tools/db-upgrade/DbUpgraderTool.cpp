@@ -61,6 +61,18 @@ required:
        --max_concurrent_spaces<N>
          Maximum number of concurrent spaces allowed.
          Default: 5
+
+       --upgrade_by_sst_file=<true|false>
+         Write the data of the parts into SST files which are ingested.
+         Default: false
+
+       --sst_file_batch_num=<N>
+         The rows of a part written into an SST file.
+         Default: 1000000
+
+       --upgrade_resume=<true|false>
+         Skip the parts upgraded by the last run, which are checkpointed.
+         Default: false
 )");
 }
 
@@ -78,6 +90,11 @@ void printParams() {
               << FLAGS_max_concurrent_parts << "\n";
     std::cout << "maximum number of concurrent spaces allowed: "
               << FLAGS_max_concurrent_spaces << "\n";
+    std::cout << "whether to write by SST files: "
+              << (FLAGS_upgrade_by_sst_file ? "true" : "false") << "\n";
+    std::cout << "The rows of an SST file written: " << FLAGS_sst_file_batch_num << "\n";
+    std::cout << "whether to resume the last upgrade: "
+              << (FLAGS_upgrade_resume ? "true" : "false") << "\n";
     std::cout << "===========================PARAMS============================\n\n";
 }
 
@@ -0,0 +1,454 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "tools/sst-generator/SstGenerator.h"
+#include <fstream>
+#include <rocksdb/sst_file_writer.h>
+#include "common/fs/FileUtils.h"
+#include "common/time/Duration.h"
+#include "common/time/TimeUtils.h"
+#include "codec/RowReaderWrapper.h"
+#include "utils/IndexKeyUtils.h"
+#include "utils/NebulaKeyUtils.h"
+
+DEFINE_string(meta_server, "127.0.0.1:45500", "Meta servers' address.");
+DEFINE_string(space_name, "", "The space name.");
+DEFINE_string(type, "vertex", "The type of input, vertex | edge");
+DEFINE_string(schema, "", "The tag name or edge name of input.");
+DEFINE_string(input, "", "A list of csv files seperated by comma.");
+DEFINE_string(output_path, "./sst", "The path SST files are written to.");
+DEFINE_string(delimiter, ",", "The delimiter of csv.");
+DEFINE_bool(skip_header, false, "Whether the first line of csv is the header.");
+DEFINE_uint32(threads, 4, "The number of files converted at the same time.");
+DEFINE_uint64(max_keys_per_file, 10 * 1000 * 1000, "Max number of keys in one SST file.");
+
+namespace nebula {
+namespace storage {
+
+Status SstGenerator::init() {
+    auto status = initMeta();
+    if (!status.ok()) {
+        return status;
+    }
+
+    status = initSpace();
+    if (!status.ok()) {
+        return status;
+    }
+
+    status = initSchema();
+    if (!status.ok()) {
+        return status;
+    }
+
+    folly::split(',', FLAGS_input, files_, true);
+    if (files_.empty()) {
+        return Status::Error("Input is not given.");
+    }
+    for (auto& file : files_) {
+        if (!fs::FileUtils::exist(file)) {
+            return Status::Error("Input '%s' not exists.", file.c_str());
+        }
+    }
+    if (FLAGS_delimiter.size() != 1) {
+        return Status::Error("Delimiter should be one char.");
+    }
+    if (FLAGS_max_keys_per_file == 0) {
+        return Status::Error("max_keys_per_file should be positive.");
+    }
+    return Status::OK();
+}
+
+Status SstGenerator::initMeta() {
+    auto addrs = network::NetworkUtils::toHosts(FLAGS_meta_server);
+    if (!addrs.ok()) {
+        return addrs.status();
+    }
+
+    auto ioExecutor = std::make_shared<folly::IOThreadPoolExecutor>(1);
+    meta::MetaClientOptions options;
+    options.skipConfig_ = true;
+    metaClient_ = std::make_unique<meta::MetaClient>(ioExecutor,
+                                                     std::move(addrs.value()),
+                                                     options);
+    if (!metaClient_->waitForMetadReady(1)) {
+        return Status::Error("Meta is not ready: '%s'.", FLAGS_meta_server.c_str());
+    }
+    schemaMng_ = std::make_unique<meta::ServerBasedSchemaManager>();
+    schemaMng_->init(metaClient_.get());
+    indexMng_ = meta::ServerBasedIndexManager::create(metaClient_.get());
+    return Status::OK();
+}
+
+Status SstGenerator::initSpace() {
+    if (FLAGS_space_name.empty()) {
+        return Status::Error("Space name is not given.");
+    }
+    auto space = schemaMng_->toGraphSpaceID(FLAGS_space_name);
+    if (!space.ok()) {
+        return Status::Error("Space '%s' not found in meta server.", FLAGS_space_name.c_str());
+    }
+    spaceId_ = space.value();
+
+    auto spaceVidLen = schemaMng_->getSpaceVidLen(spaceId_);
+    if (!spaceVidLen.ok()) {
+        return spaceVidLen.status();
+    }
+    spaceVidLen_ = spaceVidLen.value();
+
+    auto vIdType = schemaMng_->getSpaceVidType(spaceId_);
+    if (!vIdType.ok()) {
+        return vIdType.status();
+    }
+    isIntId_ = (vIdType.value() == meta::cpp2::PropertyType::INT64);
+    return Status::OK();
+}
+
+Status SstGenerator::initSchema() {
+    if (FLAGS_type == "vertex") {
+        auto tagId = schemaMng_->toTagID(spaceId_, FLAGS_schema);
+        if (!tagId.ok()) {
+            return Status::Error("Tag '%s' not found in meta.", FLAGS_schema.c_str());
+        }
+        schemaId_ = tagId.value();
+        schema_ = schemaMng_->getTagSchema(spaceId_, schemaId_);
+        auto indexes = indexMng_->getTagIndexes(spaceId_);
+        if (!indexes.ok()) {
+            return indexes.status();
+        }
+        for (auto& index : indexes.value()) {
+            if (index->get_schema_id().get_tag_id() == schemaId_) {
+                indexes_.emplace_back(index);
+            }
+        }
+    } else if (FLAGS_type == "edge") {
+        isEdge_ = true;
+        auto edgeType = schemaMng_->toEdgeType(spaceId_, FLAGS_schema);
+        if (!edgeType.ok()) {
+            return Status::Error("Edge '%s' not found in meta.", FLAGS_schema.c_str());
+        }
+        schemaId_ = edgeType.value();
+        schema_ = schemaMng_->getEdgeSchema(spaceId_, schemaId_);
+        auto indexes = indexMng_->getEdgeIndexes(spaceId_);
+        if (!indexes.ok()) {
+            return indexes.status();
+        }
+        for (auto& index : indexes.value()) {
+            if (index->get_schema_id().get_edge_type() == schemaId_) {
+                indexes_.emplace_back(index);
+            }
+        }
+    } else {
+        return Status::Error("Unkown type '%s'.", FLAGS_type.c_str());
+    }
+    if (schema_ == nullptr) {
+        return Status::Error("Schema of '%s' not found in meta.", FLAGS_schema.c_str());
+    }
+    return Status::OK();
+}
+
+Status SstGenerator::run() {
+    time::Duration dur;
+    std::atomic<size_t> next{0};
+    std::mutex lock;
+    Status result = Status::OK();
+    std::vector<std::thread> threads;
+    for (uint32_t i = 0; i < std::max<uint32_t>(FLAGS_threads, 1); i++) {
+        threads.emplace_back([&] {
+            size_t fileId;
+            while ((fileId = next++) < files_.size()) {
+                auto status = generate(fileId, files_[fileId]);
+                if (!status.ok()) {
+                    std::lock_guard<std::mutex> g(lock);
+                    result = status;
+                    return;
+                }
+            }
+        });
+    }
+    for (auto& t : threads) {
+        t.join();
+    }
+    std::cout << "Converted " << lines_ << " lines into " << keys_ << " keys in "
+              << dur.elapsedInSec() << " seconds\n";
+    return result;
+}
+
+Status SstGenerator::generate(size_t fileId, const std::string& file) {
+    std::ifstream in(file);
+    if (!in.is_open()) {
+        return Status::Error("Open '%s' failed.", file.c_str());
+    }
+    std::unordered_map<PartitionID, KVs> parts;
+    std::unordered_map<PartitionID, int32_t> seqs;
+    auto flushPart = [&] (PartitionID partId, KVs* kvs) {
+        auto path = fs::FileUtils::joinPath(FLAGS_output_path, folly::to<std::string>(partId));
+        // the dir of part may be made by the other threads at the same time
+        if (!fs::FileUtils::makeDir(path) && !fs::FileUtils::exist(path)) {
+            return Status::Error("Make dir '%s' failed.", path.c_str());
+        }
+        auto name = folly::stringPrintf("%s/%s-%zu-%d.sst", path.c_str(),
+                                        FLAGS_schema.c_str(), fileId, seqs[partId]++);
+        return flush(name, kvs);
+    };
+
+    std::string line;
+    size_t lineNo = 0;
+    while (std::getline(in, line)) {
+        if (lineNo++ == 0 && FLAGS_skip_header) {
+            continue;
+        }
+        if (line.empty()) {
+            continue;
+        }
+        std::vector<folly::StringPiece> fields;
+        folly::split(FLAGS_delimiter[0], line, fields);
+        auto status = addLine(fields, &parts);
+        if (!status.ok()) {
+            return Status::Error("Line %zu of '%s': %s",
+                                 lineNo, file.c_str(), status.toString().c_str());
+        }
+        lines_++;
+        for (auto& part : parts) {
+            if (part.second.size() >= FLAGS_max_keys_per_file) {
+                status = flushPart(part.first, &part.second);
+                if (!status.ok()) {
+                    return status;
+                }
+            }
+        }
+    }
+    for (auto& part : parts) {
+        if (!part.second.empty()) {
+            auto status = flushPart(part.first, &part.second);
+            if (!status.ok()) {
+                return status;
+            }
+        }
+    }
+    return Status::OK();
+}
+
+Status SstGenerator::addLine(const std::vector<folly::StringPiece>& fields,
+                             std::unordered_map<PartitionID, KVs>* parts) {
+    size_t offset = isEdge_ ? 3 : 1;
+    if (fields.size() != offset + schema_->getNumFields()) {
+        return Status::Error("Expect %zu fields, but got %zu.",
+                             offset + schema_->getNumFields(), fields.size());
+    }
+    auto src = toVid(fields[0]);
+    if (!src.ok()) {
+        return src.status();
+    }
+    auto srcPart = metaClient_->partId(spaceId_, src.value());
+    if (!srcPart.ok()) {
+        return srcPart.status();
+    }
+    auto row = encodeRow(fields, offset);
+    if (!row.ok()) {
+        return row.status();
+    }
+    auto reader = RowReaderWrapper::getRowReader(schema_.get(), row.value());
+    if (!reader) {
+        return Status::Error("Bad row encoded.");
+    }
+
+    auto& srcKVs = (*parts)[srcPart.value()];
+    if (!isEdge_) {
+        for (auto& index : indexes_) {
+            auto values = IndexKeyUtils::collectIndexValues(reader.get(), index->get_fields());
+            if (!values.ok()) {
+                return values.status();
+            }
+            srcKVs.emplace_back(IndexKeyUtils::vertexIndexKey(spaceVidLen_,
+                                                              srcPart.value(),
+                                                              index->get_index_id(),
+                                                              src.value(),
+                                                              std::move(values).value()),
+                                "");
+        }
+        srcKVs.emplace_back(NebulaKeyUtils::vertexKey(spaceVidLen_, srcPart.value(),
+                                                      src.value(), schemaId_),
+                            std::move(row).value());
+        keys_ += indexes_.size() + 1;
+        return Status::OK();
+    }
+
+    auto dst = toVid(fields[1]);
+    if (!dst.ok()) {
+        return dst.status();
+    }
+    auto dstPart = metaClient_->partId(spaceId_, dst.value());
+    if (!dstPart.ok()) {
+        return dstPart.status();
+    }
+    EdgeRanking rank = 0;
+    if (!fields[2].empty()) {
+        auto ret = folly::tryTo<EdgeRanking>(fields[2]);
+        if (!ret.hasValue()) {
+            return Status::Error("Bad rank '%s'.", fields[2].str().c_str());
+        }
+        rank = ret.value();
+    }
+    // the index is built on the out edge only
+    for (auto& index : indexes_) {
+        auto values = IndexKeyUtils::collectIndexValues(reader.get(), index->get_fields());
+        if (!values.ok()) {
+            return values.status();
+        }
+        srcKVs.emplace_back(IndexKeyUtils::edgeIndexKey(spaceVidLen_,
+                                                        srcPart.value(),
+                                                        index->get_index_id(),
+                                                        src.value(),
+                                                        rank,
+                                                        dst.value(),
+                                                        std::move(values).value()),
+                            "");
+    }
+    srcKVs.emplace_back(NebulaKeyUtils::edgeKey(spaceVidLen_, srcPart.value(), src.value(),
+                                                schemaId_, rank, dst.value()),
+                        row.value());
+    (*parts)[dstPart.value()].emplace_back(
+        NebulaKeyUtils::edgeKey(spaceVidLen_, dstPart.value(), dst.value(),
+                                -schemaId_, rank, src.value()),
+        std::move(row).value());
+    keys_ += indexes_.size() + 2;
+    return Status::OK();
+}
+
+StatusOr<std::string> SstGenerator::toVid(folly::StringPiece field) {
+    if (isIntId_) {
+        auto ret = folly::tryTo<int64_t>(field);
+        if (!ret.hasValue()) {
+            return Status::Error("Bad int vid '%s'.", field.str().c_str());
+        }
+        int64_t vid = ret.value();
+        return std::string(reinterpret_cast<const char*>(&vid), sizeof(int64_t));
+    }
+    if (!NebulaKeyUtils::isValidVidLen(spaceVidLen_, field)) {
+        return Status::Error("Bad vid length of '%s'.", field.str().c_str());
+    }
+    return field.str();
+}
+
+StatusOr<std::string> SstGenerator::encodeRow(const std::vector<folly::StringPiece>& fields,
+                                              size_t offset) {
+    RowWriterV2 writer(schema_.get());
+    for (size_t i = 0; i < schema_->getNumFields(); i++) {
+        auto field = schema_->field(i);
+        auto& str = fields[offset + i];
+        // the unset props are the default value or null when finish
+        if (str.empty() && field->type() != meta::cpp2::PropertyType::STRING &&
+            field->type() != meta::cpp2::PropertyType::FIXED_STRING) {
+            continue;
+        }
+        auto value = toValue(field, str);
+        if (!value.ok()) {
+            return value.status();
+        }
+        auto ret = writer.setValue(i, value.value());
+        if (ret != WriteResult::SUCCEEDED) {
+            return Status::Error("Bad value '%s' of prop '%s'.",
+                                 str.str().c_str(), field->name());
+        }
+    }
+    if (writer.finish() != WriteResult::SUCCEEDED) {
+        return Status::Error("Some props are not given and have no default value.");
+    }
+    return std::move(writer).moveEncodedStr();
+}
+
+StatusOr<Value> SstGenerator::toValue(const meta::SchemaProviderIf::Field* field,
+                                      folly::StringPiece str) {
+    switch (field->type()) {
+        case meta::cpp2::PropertyType::BOOL: {
+            auto ret = folly::tryTo<bool>(str);
+            if (ret.hasValue()) {
+                return Value(ret.value());
+            }
+            break;
+        }
+        case meta::cpp2::PropertyType::INT8:
+        case meta::cpp2::PropertyType::INT16:
+        case meta::cpp2::PropertyType::INT32:
+        case meta::cpp2::PropertyType::INT64:
+        case meta::cpp2::PropertyType::TIMESTAMP: {
+            auto ret = folly::tryTo<int64_t>(str);
+            if (ret.hasValue()) {
+                return Value(ret.value());
+            }
+            break;
+        }
+        case meta::cpp2::PropertyType::FLOAT:
+        case meta::cpp2::PropertyType::DOUBLE: {
+            auto ret = folly::tryTo<double>(str);
+            if (ret.hasValue()) {
+                return Value(ret.value());
+            }
+            break;
+        }
+        case meta::cpp2::PropertyType::STRING:
+        case meta::cpp2::PropertyType::FIXED_STRING:
+            return Value(str.str());
+        case meta::cpp2::PropertyType::DATE: {
+            auto ret = time::TimeUtils::parseDate(str.str());
+            if (ret.ok()) {
+                return Value(ret.value());
+            }
+            break;
+        }
+        case meta::cpp2::PropertyType::TIME: {
+            auto ret = time::TimeUtils::parseTime(str.str());
+            if (ret.ok()) {
+                return Value(ret.value());
+            }
+            break;
+        }
+        case meta::cpp2::PropertyType::DATETIME: {
+            auto ret = time::TimeUtils::parseDateTime(str.str());
+            if (ret.ok()) {
+                return Value(ret.value());
+            }
+            break;
+        }
+        default:
+            return Status::Error("Unsupported type of prop '%s'.", field->name());
+    }
+    return Status::Error("Bad value '%s' of prop '%s'.", str.str().c_str(), field->name());
+}
+
+Status SstGenerator::flush(const std::string& name, KVs* kvs) {
+    // the key written later wins if there are duplicated keys
+    std::stable_sort(kvs->begin(), kvs->end(), [] (const auto& a, const auto& b) {
+        return a.first < b.first;
+    });
+    rocksdb::Options options;
+    rocksdb::SstFileWriter writer(rocksdb::EnvOptions(), options);
+    auto status = writer.Open(name);
+    if (!status.ok()) {
+        return Status::Error("Open '%s' failed: %s", name.c_str(), status.ToString().c_str());
+    }
+    for (size_t i = 0; i < kvs->size(); i++) {
+        if (i + 1 < kvs->size() && (*kvs)[i].first == (*kvs)[i + 1].first) {
+            continue;
+        }
+        status = writer.Put((*kvs)[i].first, (*kvs)[i].second);
+        if (!status.ok()) {
+            return Status::Error("Write '%s' failed: %s",
+                                 name.c_str(), status.ToString().c_str());
+        }
+    }
+    status = writer.Finish();
+    if (!status.ok()) {
+        return Status::Error("Finish '%s' failed: %s", name.c_str(), status.ToString().c_str());
+    }
+    LOG(INFO) << "Write " << kvs->size() << " keys into " << name;
+    kvs->clear();
+    return Status::OK();
+}
+
+}  // namespace storage
+}  // namespace nebula
@@ -0,0 +1,101 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef TOOLS_SSTGENERATOR_SSTGENERATOR_H_
+#define TOOLS_SSTGENERATOR_SSTGENERATOR_H_
+
+#include "common/base/Base.h"
+#include "common/base/Status.h"
+#include "common/clients/meta/MetaClient.h"
+#include "common/meta/ServerBasedSchemaManager.h"
+#include "common/meta/ServerBasedIndexManager.h"
+#include "codec/RowWriterV2.h"
+
+DECLARE_string(meta_server);
+DECLARE_string(space_name);
+DECLARE_string(type);
+DECLARE_string(schema);
+DECLARE_string(input);
+DECLARE_string(output_path);
+DECLARE_string(delimiter);
+DECLARE_bool(skip_header);
+DECLARE_uint32(threads);
+DECLARE_uint64(max_keys_per_file);
+
+namespace nebula {
+namespace storage {
+
+/*
+SstGenerator converts the csv files of a tag or an edge into the SST files which could be
+downloaded and ingested by storage, so the bulk load doesn't go through raft.
+
+The keys and rows are encoded just like the storage does, by NebulaKeyUtils, IndexKeyUtils and
+RowWriterV2 with the latest schema, the index keys of the tag or edge are generated as well.
+The files are written to <output_path>/<partId>/, which is the layout expected by the download
+handler. Each input file is converted by one thread, the keys of a part are buffered, sorted
+and written into a new SST file once max_keys_per_file is reached.
+
+A line of vertex is `vid,prop1,prop2...`, a line of edge is `src,dst,rank,prop1,prop2...`, the
+props are in the order of the latest schema. An empty prop is the default value or null. The
+vertices and edges are expected to be unique in the input, otherwise the index keys of the rows
+overwritten are left.
+*/
+class SstGenerator {
+public:
+    SstGenerator() = default;
+
+    ~SstGenerator() = default;
+
+    Status init();
+
+    Status run();
+
+private:
+    using KVs = std::vector<std::pair<std::string, std::string>>;
+
+    Status initMeta();
+
+    Status initSpace();
+
+    Status initSchema();
+
+    // Convert one input file, the SST files are named by fileId
+    Status generate(size_t fileId, const std::string& file);
+
+    Status addLine(const std::vector<folly::StringPiece>& fields,
+                   std::unordered_map<PartitionID, KVs>* parts);
+
+    StatusOr<std::string> toVid(folly::StringPiece field);
+
+    StatusOr<std::string> encodeRow(const std::vector<folly::StringPiece>& fields,
+                                    size_t offset);
+
+    StatusOr<Value> toValue(const meta::SchemaProviderIf::Field* field,
+                            folly::StringPiece str);
+
+    // Sort the keys and write them into a new SST file of name
+    Status flush(const std::string& name, KVs* kvs);
+
+private:
+    std::unique_ptr<meta::MetaClient>                              metaClient_;
+    std::unique_ptr<meta::ServerBasedSchemaManager>                schemaMng_;
+    std::unique_ptr<meta::IndexManager>                            indexMng_;
+    GraphSpaceID                                                   spaceId_;
+    int32_t                                                        spaceVidLen_;
+    bool                                                           isIntId_{false};
+    bool                                                           isEdge_{false};
+    // tagId or edgeType
+    int32_t                                                        schemaId_;
+    std::shared_ptr<const meta::NebulaSchemaProvider>              schema_;
+    std::vector<std::shared_ptr<meta::cpp2::IndexItem>>            indexes_;
+    std::vector<std::string>                                       files_;
+    std::atomic<int64_t>                                           lines_{0};
+    std::atomic<int64_t>                                           keys_{0};
+};
+
+}  // namespace storage
+}  // namespace nebula
+#endif  // TOOLS_SSTGENERATOR_SSTGENERATOR_H_
@@ -0,0 +1,99 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include "tools/sst-generator/SstGenerator.h"
+
+void printHelp() {
+    fprintf(stderr,
+           R"(  ./sst_generator --space_name=<space name> --schema=<tag or edge name> --input=<csv>
+
+Convert the csv files into SST files, which could be downloaded and ingested by storage by
+`/download` and `/ingest` of the storage http service.
+
+required:
+       --space_name=<space name>
+         A space name must be given.
+
+       --schema=<tag or edge name>
+         The tag or edge of the input.
+
+       --input=<list of csv files>
+         A list of csv files seperated by comma. A line of vertex is
+         `vid,prop1,prop2...`, a line of edge is `src,dst,rank,prop1,prop2...`,
+         the props are in the order of the schema. An empty prop is the default value or null.
+
+optional:
+       --type= vertex | edge
+         Default: vertex
+
+       --meta_server=<ip:port,...>
+         A list of meta severs' ip:port seperated by comma.
+         Default: 127.0.0.1:45500
+
+       --output_path=<path>
+         The SST files of part N are written to <output_path>/N, which should be uploaded to
+         the hdfs path given to `/download`.
+         Default: ./sst
+
+       --delimiter=<char>
+         Default: ,
+
+       --skip_header=<true|false>
+         Whether the first line of each csv file is the header.
+         Default: false
+
+       --threads=<N>
+         The number of csv files converted at the same time.
+         Default: 4
+
+       --max_keys_per_file=<N>
+         The keys of a part are buffered in memory and sorted before written, this limits
+         the keys in one SST file.
+         Default: 10000000
+
+
+)");
+}
+
+void printParams() {
+    std::cout << "===========================PARAMS============================\n";
+    std::cout << "meta server: " << FLAGS_meta_server << "\n";
+    std::cout << "space name: " << FLAGS_space_name << "\n";
+    std::cout << "type: " << FLAGS_type << "\n";
+    std::cout << "schema: " << FLAGS_schema << "\n";
+    std::cout << "input: " << FLAGS_input << "\n";
+    std::cout << "output path: " << FLAGS_output_path << "\n";
+    std::cout << "threads: " << FLAGS_threads << "\n";
+    std::cout << "max keys per file: " << FLAGS_max_keys_per_file << "\n";
+    std::cout << "===========================PARAMS============================\n\n";
+}
+
+int main(int argc, char *argv[]) {
+    if (argc == 1) {
+        printHelp();
+        return EXIT_FAILURE;
+    } else {
+        folly::init(&argc, &argv, true);
+    }
+
+    google::SetStderrLogging(google::WARNING);
+
+    printParams();
+
+    nebula::storage::SstGenerator generator;
+    auto status = generator.init();
+    if (!status.ok()) {
+        std::cerr << "Error: " << status << "\n\n";
+        return EXIT_FAILURE;
+    }
+    status = generator.run();
+    if (!status.ok()) {
+        std::cerr << "Error: " << status << "\n\n";
+        return EXIT_FAILURE;
+    }
+    return EXIT_SUCCESS;
+}
@@ -9,9 +9,11 @@
 #include "common/time/Duration.h"
 #include "common/clients/storage/GraphStorageClient.h"
 #include <folly/TokenBucket.h>
+#include <folly/String.h>
 #include <folly/stats/TimeseriesHistogram.h>
 #include <folly/stats/BucketedTimeSeries.h>
 #include <thrift/lib/cpp/util/EnumUtils.h>
+#include <fstream>
 
 
 DEFINE_int32(threads, 1, "Total threads for perf");
@@ -33,22 +35,212 @@ DEFINE_int32(property_size, 1000, "The property size of per property");
 DEFINE_bool(random_message, true, "Whether to write random message to storage service");
 DEFINE_int32(concurrency, 50, "concurrent requests");
 DEFINE_int32(batch_num, 1, "batch vertices for one request");
+DEFINE_string(workload, "", "The weighted mix of the methods, such as "
+                            "\"getNeighbors:70,getVertices:20,addVertices:10\", "
+                            "only --method is tested if it is empty");
+DEFINE_string(key_distribution, "uniform", "The distribution of the vertex ids in "
+                                           "[min_vertex_id, max_vertex_id], "
+                                           "such as uniform, zipfian, hotspot");
+DEFINE_double(zipfian_theta, 0.99, "The skew of the zipfian distribution, in (0, 1)");
+DEFINE_double(hotspot_fraction, 0.2, "The fraction of the vertex ids which are hot");
+DEFINE_double(hotspot_ops, 0.8, "The fraction of the requests to the hot vertex ids");
+DEFINE_int32(property_size_max, 0, "If larger than property_size, the property size of each "
+                                   "request is uniform in [property_size, property_size_max]");
+DEFINE_bool(open_loop, false, "Whether to send the requests at the qps whenever the former "
+                              "ones return, the latency is measured from the time a request "
+                              "is scheduled to be sent, so the queueing is not hidden");
+DEFINE_string(qps_sweep, "", "The qps to test in turn, such as \"1000,2000,4000\", each with "
+                             "totalReqs requests, to find the qps the latency rises sharply");
+DEFINE_string(replay_file, "", "The trace to replay, one request per line as "
+                               "\"<method> <vertex id>\", the trace is replayed again "
+                               "until totalReqs requests are sent");
 
 DECLARE_int32(heartbeat_interval_secs);
 
 namespace nebula {
 namespace storage {
 
-thread_local uint32_t position = 1;
+/*
+LatencyHistogram records the latencies in microseconds in log-linear buckets like a HDR
+histogram: the values less than 32 are exact, and each power of 2 above is split into 16
+buckets, so a percentile is at most 1/16 above the real one whatever the range is.
+*/
+class LatencyHistogram {
+public:
+    void add(int64_t value) {
+        value = std::max<int64_t>(value, 0);
+        counts_[indexOf(value)]++;
+        total_++;
+        auto max = max_.load();
+        while (value > max && !max_.compare_exchange_weak(max, value)) {}
+    }
+
+    int64_t total() const {
+        return total_;
+    }
+
+    int64_t max() const {
+        return max_;
+    }
+
+    void clear() {
+        for (auto& count : counts_) {
+            count = 0;
+        }
+        total_ = 0;
+        max_ = 0;
+    }
+
+    int64_t percentile(double p) const {
+        int64_t target = std::max<int64_t>(std::ceil(p * total_), 1);
+        int64_t count = 0;
+        for (size_t i = 0; i < kBuckets; i++) {
+            count += counts_[i];
+            if (count >= target) {
+                return std::min(valueOf(i), max());
+            }
+        }
+        return max();
+    }
+
+private:
+    static constexpr int32_t kSubBits = 5;
+    // the exact buckets, and the buckets of each power of 2 above
+    static constexpr int64_t kExact = 1 << kSubBits;
+    static constexpr int64_t kSubBuckets = 1 << (kSubBits - 1);
+    static constexpr size_t kBuckets = kExact + (63 - kSubBits) * kSubBuckets;
+
+    static size_t indexOf(int64_t value) {
+        if (value < kExact) {
+            return value;
+        }
+        int32_t shift = 63 - __builtin_clzll(value) - (kSubBits - 1);
+        int64_t sub = value >> shift;
+        return kExact + (shift - 1) * kSubBuckets + (sub - kSubBuckets);
+    }
+
+    // the largest value of the bucket
+    static int64_t valueOf(size_t index) {
+        int64_t i = index;
+        if (i < kExact) {
+            return i;
+        }
+        int64_t shift = (i - kExact) / kSubBuckets + 1;
+        int64_t sub = (i - kExact) % kSubBuckets + kSubBuckets;
+        return ((sub + 1) << shift) - 1;
+    }
+
+private:
+    std::array<std::atomic<int64_t>, kBuckets>      counts_{};
+    std::atomic<int64_t>                            total_{0};
+    std::atomic<int64_t>                            max_{0};
+};
+
+/*
+KeyGenerator draws the vertex ids in [min_vertex_id, max_vertex_id] by key_distribution.
+The zipfian one is the generator of Gray et al. used by YCSB, the smaller ids are the hotter,
+and the hotspot one sends hotspot_ops of the requests to the first hotspot_fraction of the ids.
+*/
+class KeyGenerator {
+public:
+    bool init() {
+        min_ = FLAGS_min_vertex_id;
+        num_ = std::max<int64_t>(FLAGS_max_vertex_id - FLAGS_min_vertex_id, 1);
+        if (FLAGS_key_distribution == "uniform") {
+            dist_ = Distribution::UNIFORM;
+        } else if (FLAGS_key_distribution == "zipfian") {
+            if (FLAGS_zipfian_theta <= 0 || FLAGS_zipfian_theta >= 1) {
+                LOG(ERROR) << "Invalid zipfian_theta " << FLAGS_zipfian_theta;
+                return false;
+            }
+            dist_ = Distribution::ZIPFIAN;
+            theta_ = FLAGS_zipfian_theta;
+            for (int64_t i = 1; i <= num_; i++) {
+                zetan_ += 1.0 / std::pow(i, theta_);
+            }
+            double zeta2 = 1.0 + std::pow(0.5, theta_);
+            alpha_ = 1.0 / (1.0 - theta_);
+            eta_ = (1.0 - std::pow(2.0 / num_, 1.0 - theta_)) / (1.0 - zeta2 / zetan_);
+        } else if (FLAGS_key_distribution == "hotspot") {
+            if (FLAGS_hotspot_fraction <= 0 || FLAGS_hotspot_fraction >= 1) {
+                LOG(ERROR) << "Invalid hotspot_fraction " << FLAGS_hotspot_fraction;
+                return false;
+            }
+            dist_ = Distribution::HOTSPOT;
+            hot_ = std::max<int64_t>(num_ * FLAGS_hotspot_fraction, 1);
+        } else {
+            LOG(ERROR) << "Unknown key_distribution " << FLAGS_key_distribution;
+            return false;
+        }
+        return true;
+    }
+
+    bool uniform() const {
+        return dist_ == Distribution::UNIFORM;
+    }
+
+    int64_t next() const {
+        switch (dist_) {
+            case Distribution::UNIFORM:
+                return min_ + folly::Random::rand64(num_);
+            case Distribution::ZIPFIAN: {
+                double u = folly::Random::randDouble01();
+                double uz = u * zetan_;
+                if (uz < 1.0) {
+                    return min_;
+                }
+                if (uz < 1.0 + std::pow(0.5, theta_)) {
+                    return min_ + 1;
+                }
+                auto rank = static_cast<int64_t>(num_ * std::pow(eta_ * u - eta_ + 1, alpha_));
+                return min_ + std::min(rank, num_ - 1);
+            }
+            case Distribution::HOTSPOT:
+                if (folly::Random::randDouble01() < FLAGS_hotspot_ops || hot_ >= num_) {
+                    return min_ + folly::Random::rand64(hot_);
+                }
+                return min_ + hot_ + folly::Random::rand64(num_ - hot_);
+        }
+        return min_;
+    }
+
+private:
+    enum class Distribution {
+        UNIFORM,
+        ZIPFIAN,
+        HOTSPOT,
+    };
+
+    Distribution    dist_{Distribution::UNIFORM};
+    int64_t         min_{0};
+    int64_t         num_{1};
+    int64_t         hot_{1};
+    double          theta_{0};
+    double          zetan_{0};
+    double          alpha_{0};
+    double          eta_{0};
+};
 
 class Perf {
 public:
+    enum class Method : int8_t {
+        GET_NEIGHBORS = 0,
+        ADD_VERTICES,
+        ADD_EDGES,
+        GET_VERTICES,
+        GET_EDGES,
+        NUM_METHODS,
+    };
+
     Perf()
         : latencies_(10, 0, 3000, {10, {std::chrono::seconds(20)}})
         , qps_(10, 0, 1000000, {10, {std::chrono::seconds(20)}}) {}
 
     int run() {
         LOG(INFO) << "Total threads " << FLAGS_threads << ", qps " << FLAGS_qps;
+        if (!initWorkload()) {
+            return EXIT_FAILURE;
+        }
         auto metaAddrsRet = nebula::network::NetworkUtils::toHosts(FLAGS_meta_server_addrs);
         if (!metaAddrsRet.ok() || metaAddrsRet.value().empty()) {
             LOG(ERROR) << "Can't get metaServer address, status:" << metaAddrsRet.status()
@@ -126,39 +318,97 @@ public:
         }
 
         graphStorageClient_ = std::make_unique<GraphStorageClient>(threadPool_, mClient_.get());
+        if (FLAGS_qps_sweep.empty()) {
+            runPhase(FLAGS_qps);
+        } else {
+            for (auto rate : rates_) {
+                runPhase(rate);
+            }
+            // the throughput-latency curve of each method
+            for (auto& point : curve_) {
+                LOG(INFO) << "Curve of " << point.method << ": target qps " << point.target
+                          << ", qps " << point.qps << ", latency(us) p50 = " << point.p50
+                          << ", p99 = " << point.p99 << ", p999 = " << point.p999;
+            }
+        }
+
+        mClient_->stop();
+        threadPool_->stop();
+        return 0;
+    }
+
+    void runPhase(double qps) {
+        LOG(INFO) << "Test at qps " << qps << (FLAGS_open_loop ? " in open loop" : "");
+        finishedRequests_ = 0;
+        sentRequests_ = 0;
+        for (auto& stats : methodStats_) {
+            stats.latencies.clear();
+            stats.failed = 0;
+        }
         time::Duration duration;
+        phaseStart_ = time::WallClock::fastNowInMicroSec();
 
         std::vector<std::thread> threads;
         threads.reserve(FLAGS_threads);
         for (int i = 0; i < FLAGS_threads; i++) {
-            threads.emplace_back(std::bind(&Perf::runInternal, this));
+            if (FLAGS_open_loop) {
+                threads.emplace_back(std::bind(&Perf::runOpenLoop, this, qps));
+            } else {
+                threads.emplace_back(std::bind(&Perf::runInternal, this, qps));
+            }
         }
         for (auto& t : threads) {
             t.join();
         }
+        // the requests sent in the open loop may not return yet
+        while (finishedRequests_ < sentRequests_) {
+            usleep(1000);
+        }
 
-        mClient_->stop();
-        threadPool_->stop();
         LOG(INFO) << "Total time cost " << duration.elapsedInMSec() << "ms, "
                   << "total requests " << finishedRequests_;
-        return 0;
+        report(duration.elapsedInMSec(), qps);
     }
 
+    /*
+    In the open loop the k-th request of a phase is scheduled at k / qps after the phase
+    starts, by whichever thread takes it. A request late for its time is sent at once, and its
+    latency still counts from the time scheduled, so the time it waits for the tool, and for
+    the former requests the slow server holds, is measured instead of being omitted.
+    */
+    void runOpenLoop(double qps) {
+        double interval = 1000000.0 / qps;
+        while (true) {
+            int64_t k = sentRequests_++;
+            if (k >= FLAGS_totalReqs) {
+                sentRequests_--;
+                break;
+            }
+            int64_t scheduled = phaseStart_ + static_cast<int64_t>(k * interval);
+            auto now = time::WallClock::fastNowInMicroSec();
+            if (scheduled > now) {
+                usleep(scheduled - now);
+            }
+            int64_t id;
+            auto method = nextRequest(&id);
+            send(method, id, scheduled);
+            PLOG_EVERY_N(INFO, 2000)
+                << "Progress " << k / static_cast<double>(FLAGS_totalReqs) * 100 << "%"
+                << ", qps=" << qps_.rate(0)
+                << ", latency(us) median = " << latencies_.getPercentileEstimate(0.5, 0)
+                << ", p90 = " << latencies_.getPercentileEstimate(0.9, 0)
+                << ", p99 = " << latencies_.getPercentileEstimate(0.99, 0);
+        }
+    }
 
-     void runInternal() {
+    void runInternal(double qps) {
         while (finishedRequests_ < FLAGS_totalReqs) {
-            if (FLAGS_method == "getNeighbors") {
-                getNeighborsTask();
-            } else if (FLAGS_method == "addVertices") {
-                addVerticesTask();
-            } else if (FLAGS_method == "addEdges") {
-                addEdgesTask();
-            } else if (FLAGS_method == "getVertices") {
-                getVerticesTask();
-            } else if (FLAGS_method == "getEdges") {
-                getEdgesTask();
-            } else {
-                LOG(FATAL) << "Should not reach here.";
+            auto tokens = tokenBucket_.consumeOrDrain(FLAGS_concurrency, qps, FLAGS_concurrency);
+            for (auto i = 0; i < tokens; i++) {
+                int64_t id;
+                auto method = nextRequest(&id);
+                sentRequests_++;
+                send(method, id, time::WallClock::fastNowInMicroSec());
             }
             PLOG_EVERY_N(INFO, 2000)
                 << "Progress "
@@ -172,20 +422,194 @@ public:
     }
 
 private:
-    std::vector<VertexID> randomVertices() {
-        return {std::to_string(FLAGS_min_vertex_id
-                              + folly::Random::rand32(FLAGS_max_vertex_id - FLAGS_min_vertex_id))};
+    static const char* methodName(Method method) {
+        static const char* names[] = {
+            "getNeighbors", "addVertices", "addEdges", "getVertices", "getEdges"};
+        return names[static_cast<int8_t>(method)];
     }
 
-    std::vector<Value> randomEdges() {
-        std::vector<Value> values;
-        auto src = folly::Random::rand32(FLAGS_max_vertex_id - FLAGS_min_vertex_id)
-                   + FLAGS_min_vertex_id;
-        values.emplace_back(std::to_string(src));
-        values.emplace_back(edgeType_);
-        values.emplace_back(0);
-        values.emplace_back(std::to_string(src + 1));
-        return values;
+    static bool parseMethod(folly::StringPiece name, Method* method) {
+        for (int8_t i = 0; i < static_cast<int8_t>(Method::NUM_METHODS); i++) {
+            if (name == methodName(static_cast<Method>(i))) {
+                *method = static_cast<Method>(i);
+                return true;
+            }
+        }
+        LOG(ERROR) << "Unknown method " << name;
+        return false;
+    }
+
+    bool initWorkload() {
+        if (!keys_.init()) {
+            return false;
+        }
+        if (FLAGS_qps_sweep.empty()) {
+            rates_.emplace_back(FLAGS_qps);
+        } else {
+            std::vector<folly::StringPiece> rates;
+            folly::split(',', FLAGS_qps_sweep, rates, true);
+            for (auto& rate : rates) {
+                auto ret = folly::tryTo<double>(folly::trimWhitespace(rate));
+                if (!ret.hasValue()) {
+                    LOG(ERROR) << "Invalid qps_sweep " << FLAGS_qps_sweep;
+                    return false;
+                }
+                rates_.emplace_back(ret.value());
+            }
+        }
+        for (auto rate : rates_) {
+            if (rate <= 0) {
+                LOG(ERROR) << "Invalid qps " << rate;
+                return false;
+            }
+        }
+        if (!FLAGS_replay_file.empty()) {
+            std::ifstream in(FLAGS_replay_file);
+            if (!in.is_open()) {
+                LOG(ERROR) << "Open the trace " << FLAGS_replay_file << " failed";
+                return false;
+            }
+            std::string line;
+            while (std::getline(in, line)) {
+                std::vector<folly::StringPiece> fields;
+                folly::split(' ', folly::trimWhitespace(line), fields, true);
+                if (fields.empty() || fields[0].startsWith('#')) {
+                    continue;
+                }
+                Method method;
+                if (fields.size() != 2 ||
+                    !folly::tryTo<int64_t>(fields[1]).hasValue() ||
+                    !parseMethod(fields[0], &method)) {
+                    LOG(ERROR) << "Invalid line of the trace: " << line;
+                    return false;
+                }
+                trace_.emplace_back(method, folly::to<int64_t>(fields[1]));
+            }
+            if (trace_.empty()) {
+                LOG(ERROR) << "The trace " << FLAGS_replay_file << " is empty";
+                return false;
+            }
+            LOG(INFO) << "Replay " << trace_.size() << " requests of " << FLAGS_replay_file;
+            return true;
+        }
+
+        if (FLAGS_workload.empty()) {
+            Method method;
+            if (!parseMethod(FLAGS_method, &method)) {
+                return false;
+            }
+            mix_.emplace_back(method, 1);
+        } else {
+            std::vector<folly::StringPiece> items;
+            folly::split(',', FLAGS_workload, items, true);
+            for (auto& item : items) {
+                folly::StringPiece name, weight;
+                Method method;
+                if (!folly::split(':', item, name, weight) ||
+                    !parseMethod(folly::trimWhitespace(name), &method) ||
+                    !folly::tryTo<int32_t>(folly::trimWhitespace(weight)).hasValue() ||
+                    folly::to<int32_t>(folly::trimWhitespace(weight)) <= 0) {
+                    LOG(ERROR) << "Invalid workload " << FLAGS_workload;
+                    return false;
+                }
+                mix_.emplace_back(method, folly::to<int32_t>(folly::trimWhitespace(weight)));
+            }
+            if (mix_.empty()) {
+                LOG(ERROR) << "Invalid workload " << FLAGS_workload;
+                return false;
+            }
+        }
+        for (auto& entry : mix_) {
+            totalWeight_ += entry.second;
+        }
+        // The vertices written by a single method of the uniform keys are sequential as
+        // before, the other workloads write the vertices by the key distribution
+        sequentialWrites_ = FLAGS_workload.empty() && keys_.uniform();
+        return true;
+    }
+
+    // The method and the vertex id of the next request
+    Method nextRequest(int64_t* id) {
+        if (!trace_.empty()) {
+            const auto& request = trace_[replayed_++ % trace_.size()];
+            *id = request.second;
+            return request.first;
+        }
+        auto method = mix_.front().first;
+        auto pick = folly::Random::rand32(totalWeight_);
+        for (auto& entry : mix_) {
+            if (pick < static_cast<uint32_t>(entry.second)) {
+                method = entry.first;
+                break;
+            }
+            pick -= entry.second;
+        }
+        if (sequentialWrites_ &&
+            (method == Method::ADD_VERTICES || method == Method::ADD_EDGES)) {
+            *id = nextWriteId_.fetch_add(FLAGS_batch_num);
+        } else {
+            *id = keys_.next();
+        }
+        return method;
+    }
+
+    void send(Method method, int64_t id, int64_t start) {
+        switch (method) {
+            case Method::GET_NEIGHBORS:
+                getNeighborsTask(id, start);
+                break;
+            case Method::ADD_VERTICES:
+                addVerticesTask(id, start);
+                break;
+            case Method::ADD_EDGES:
+                addEdgesTask(id, start);
+                break;
+            case Method::GET_VERTICES:
+                getVerticesTask(id, start);
+                break;
+            case Method::GET_EDGES:
+                getEdgesTask(id, start);
+                break;
+            default:
+                LOG(FATAL) << "Should not reach here.";
+        }
+    }
+
+    void finish(Method method, int64_t start, bool succeeded) {
+        auto now = time::WallClock::fastNowInMicroSec();
+        auto& stats = methodStats_[static_cast<int8_t>(method)];
+        stats.latencies.add(now - start);
+        if (!succeeded) {
+            stats.failed++;
+        }
+        this->finishedRequests_++;
+        latencies_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()), now - start);
+        qps_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()), 1);
+    }
+
+    void report(int64_t elapsedMs, double target) {
+        for (int8_t i = 0; i < static_cast<int8_t>(Method::NUM_METHODS); i++) {
+            const auto& stats = methodStats_[i];
+            auto total = stats.latencies.total();
+            if (total == 0) {
+                continue;
+            }
+            CurvePoint point;
+            point.method = methodName(static_cast<Method>(i));
+            point.target = target;
+            point.qps = total * 1000.0 / std::max<int64_t>(elapsedMs, 1);
+            point.p50 = stats.latencies.percentile(0.5);
+            point.p99 = stats.latencies.percentile(0.99);
+            point.p999 = stats.latencies.percentile(0.999);
+            LOG(INFO) << point.method << ": requests " << total
+                      << ", failed " << stats.failed
+                      << ", qps " << point.qps
+                      << ", latency(us) p50 = " << point.p50
+                      << ", p99 = " << point.p99
+                      << ", p999 = " << point.p999
+                      << ", max = " << stats.latencies.max();
+            curve_.emplace_back(std::move(point));
+        }
     }
 
     std::vector<cpp2::VertexProp> vertexProps() {
@@ -207,7 +631,7 @@ private:
     }
 
     // generate `size` properties, if random_message is set, each property will be filled
-    // with random char
+    // with random char, and its length is drawn by property_size and property_size_max
     std::vector<Value> genData(int32_t size) {
         std::vector<Value> values;
         std::string value;
@@ -221,9 +645,13 @@ private:
                 return charset[folly::Random::rand32(maxIndex)];
             };
 
-            value.reserve(FLAGS_property_size);
-            // generate random string of length property_size
-            for (int32_t i = 0; i < FLAGS_property_size; i++) {
+            int32_t length = FLAGS_property_size;
+            if (FLAGS_property_size_max > FLAGS_property_size) {
+                length += folly::Random::rand32(FLAGS_property_size_max - FLAGS_property_size + 1);
+            }
+            value.reserve(length);
+            // generate random string of the length
+            for (int32_t i = 0; i < length; i++) {
                 value += randchar();
             }
         }
@@ -233,14 +661,11 @@ private:
         return values;
     }
 
-    std::vector<cpp2::NewVertex> genVertices() {
+    std::vector<cpp2::NewVertex> genVertices(int64_t id) {
         std::vector<cpp2::NewVertex> newVertices;
-        static int vintId = FLAGS_min_vertex_id;
-
         for (int32_t i = 0; i < FLAGS_batch_num; i++) {
             storage::cpp2::NewVertex v;
-            v.set_id(std::to_string(vintId));
-            vintId++;
+            v.set_id(std::to_string(id + i));
             std::vector<nebula::storage::cpp2::NewTag> newTags;
             storage::cpp2::NewTag newTag;
             newTag.set_tag_id(tagId_);
@@ -253,135 +678,99 @@ private:
         return newVertices;
     }
 
-    std::vector<cpp2::NewEdge> genEdges() {
+    std::vector<cpp2::NewEdge> genEdges(int64_t id) {
         std::vector<cpp2::NewEdge> edges;
-        static int vintId = FLAGS_min_vertex_id;
-
         for (int32_t i = 0; i < FLAGS_batch_num; i++) {
             cpp2::NewEdge edge;
             cpp2::EdgeKey eKey;
-            eKey.set_src(std::to_string(vintId));
+            eKey.set_src(std::to_string(id + i));
             eKey.set_edge_type(edgeType_);
-            eKey.set_dst(std::to_string(vintId + 1));
+            eKey.set_dst(std::to_string(id + i + 1));
             eKey.set_ranking(0);
             edge.set_key(std::move(eKey));
             auto props = genData(edgeProps_.size());
             edge.set_props(std::move(props));
             edges.emplace_back(std::move(edge));
-            vintId++;
         }
         return edges;
     }
 
-    void getNeighborsTask() {
+    void getNeighborsTask(int64_t id, int64_t start) {
         auto* evb = threadPool_->getEventBase();
         std::vector<std::string> colNames;
         colNames.emplace_back(kVid);
         std::vector<Row> vertices;
-        for (auto& vertex : randomVertices()) {
-            nebula::Row row;
-            row.values.emplace_back(vertex);
-            vertices.emplace_back(row);
-        }
+        nebula::Row row;
+        row.values.emplace_back(std::to_string(id));
+        vertices.emplace_back(std::move(row));
 
         cpp2::EdgeDirection edgeDire = cpp2::EdgeDirection::BOTH;
         std::vector<cpp2::StatProp> statProps;
         auto vProps = vertexProps();
         auto eProps = edgeProps();
-
-        auto tokens = tokenBucket_.consumeOrDrain(FLAGS_concurrency, FLAGS_qps, FLAGS_concurrency);
-        for (auto i = 0; i < tokens; i++) {
-            auto start = time::WallClock::fastNowInMicroSec();
-
-            graphStorageClient_->getNeighbors(spaceId_, colNames, vertices,
-                                              {edgeType_}, edgeDire,  &statProps,
-                                              &vProps, &eProps, nullptr)
-                .via(evb)
-                .thenValue([this, start](auto&& resps) {
-                    if (!resps.succeeded()) {
-                        LOG(ERROR) << "Request failed!";
-                    } else {
-                        VLOG(3) << "request successed!";
-                    }
-                    this->finishedRequests_++;
-                    auto now = time::WallClock::fastNowInMicroSec();
-                    latencies_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()),
-                                        now - start);
-                    qps_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()), 1);
-                })
-                .thenError([this](auto&& e) {
-                    LOG(ERROR) <<  "request failed, e = " << e.what();
-                    this->finishedRequests_++;
-                });
-        }
+        graphStorageClient_->getNeighbors(spaceId_, colNames, vertices,
+                                          {edgeType_}, edgeDire,  &statProps,
+                                          &vProps, &eProps, nullptr)
+            .via(evb)
+            .thenValue([this, start](auto&& resps) {
+                if (!resps.succeeded()) {
+                    LOG(ERROR) << "Request failed!";
+                } else {
+                    VLOG(3) << "request successed!";
+                }
+                finish(Method::GET_NEIGHBORS, start, resps.succeeded());
+            })
+            .thenError([this, start](auto&& e) {
+                LOG(ERROR) <<  "request failed, e = " << e.what();
+                finish(Method::GET_NEIGHBORS, start, false);
+            });
     }
 
-    void addVerticesTask() {
+    void addVerticesTask(int64_t id, int64_t start) {
         auto* evb = threadPool_->getEventBase();
-        auto tokens = tokenBucket_.consumeOrDrain(FLAGS_concurrency, FLAGS_qps, FLAGS_concurrency);
-        for (auto i = 0; i < tokens; i++) {
-            auto start = time::WallClock::fastNowInMicroSec();
-            graphStorageClient_->addVertices(spaceId_, genVertices(), tagProps_, true)
-                .via(evb).thenValue([this, start](auto&& resps) {
-                    if (!resps.succeeded()) {
-                        for (auto& entry : resps.failedParts()) {
-                            LOG(ERROR) << "Request failed, part " << entry.first << ", error "
-                                       << apache::thrift::util::enumNameSafe(entry.second);
-                        }
-                    } else {
-                        VLOG(1) << "request successed!";
+        graphStorageClient_->addVertices(spaceId_, genVertices(id), tagProps_, true)
+            .via(evb).thenValue([this, start](auto&& resps) {
+                if (!resps.succeeded()) {
+                    for (auto& entry : resps.failedParts()) {
+                        LOG(ERROR) << "Request failed, part " << entry.first << ", error "
+                                   << apache::thrift::util::enumNameSafe(entry.second);
                     }
-                    this->finishedRequests_++;
-                    auto now = time::WallClock::fastNowInMicroSec();
-                    latencies_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()),
-                                        now - start);
-                    qps_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()), 1);
-                })
-                .thenError([this](auto&& e) {
-                    LOG(ERROR) << "Request failed, e = " << e.what();
-                    this->finishedRequests_++;
-                });
-        }
+                } else {
+                    VLOG(1) << "request successed!";
+                }
+                finish(Method::ADD_VERTICES, start, resps.succeeded());
+            })
+            .thenError([this, start](auto&& e) {
+                LOG(ERROR) << "Request failed, e = " << e.what();
+                finish(Method::ADD_VERTICES, start, false);
+            });
     }
 
-    void addEdgesTask() {
+    void addEdgesTask(int64_t id, int64_t start) {
         auto* evb = threadPool_->getEventBase();
-        auto tokens = tokenBucket_.consumeOrDrain(FLAGS_concurrency, FLAGS_qps, FLAGS_concurrency);
-        for (auto i = 0; i < tokens; i++) {
-            auto start = time::WallClock::fastNowInMicroSec();
-            graphStorageClient_->addEdges(spaceId_, genEdges(), edgeProps_, true)
-                .via(evb).thenValue([this, start](auto&& resps) {
-                    if (!resps.succeeded()) {
-                        LOG(ERROR) << "Request failed!";
-                    } else {
-                        VLOG(3) << "request successed!";
-                    }
-                    this->finishedRequests_++;
-                    auto now = time::WallClock::fastNowInMicroSec();
-                    latencies_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()),
-                                        now - start);
-                    qps_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()), 1);
-                }).thenError([this](auto&&) {
+        graphStorageClient_->addEdges(spaceId_, genEdges(id), edgeProps_, true)
+            .via(evb).thenValue([this, start](auto&& resps) {
+                if (!resps.succeeded()) {
                     LOG(ERROR) << "Request failed!";
-                    this->finishedRequests_++;
-                });
-        }
+                } else {
+                    VLOG(3) << "request successed!";
+                }
+                finish(Method::ADD_EDGES, start, resps.succeeded());
+            }).thenError([this, start](auto&&) {
+                LOG(ERROR) << "Request failed!";
+                finish(Method::ADD_EDGES, start, false);
+            });
     }
 
-    void getVerticesTask() {
+    void getVerticesTask(int64_t id, int64_t start) {
         auto* evb = threadPool_->getEventBase();
         nebula::DataSet input;
         input.colNames = {kVid};
         nebula::Row row;
-        auto vertices = randomVertices();
-        for (const auto& vertex : vertices) {
-            row.values.emplace_back(std::move(vertex));
-        }
+        row.values.emplace_back(std::to_string(id));
         input.emplace_back(std::move(row));
         auto vProps = vertexProps();
-        auto start = time::WallClock::fastNowInMicroSec();
-        auto f = graphStorageClient_->getProps(spaceId_, std::move(input), &vProps,
-                                               nullptr, nullptr)
+        graphStorageClient_->getProps(spaceId_, std::move(input), &vProps, nullptr, nullptr)
             .via(evb)
             .thenValue([this, start](auto&& resps) {
                 if (!resps.succeeded()) {
@@ -389,26 +778,26 @@ private:
                 } else {
                     VLOG(3) << "request successed!";
                 }
-                this->finishedRequests_++;
-                auto now = time::WallClock::fastNowInMicroSec();
-                latencies_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()),
-                                    now - start);
-                qps_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()), 1);
-            }).thenError([](auto&&) {
+                finish(Method::GET_VERTICES, start, resps.succeeded());
+            }).thenError([this, start](auto&&) {
                 LOG(ERROR) << "Request failed!";
+                finish(Method::GET_VERTICES, start, false);
             });
     }
 
-    void getEdgesTask() {
+    void getEdgesTask(int64_t id, int64_t start) {
         auto* evb = threadPool_->getEventBase();
         nebula::DataSet input;
         input.colNames = {kSrc, kType, kRank, kDst};
-        nebula::Row row(randomEdges());
+        std::vector<Value> values;
+        values.emplace_back(std::to_string(id));
+        values.emplace_back(edgeType_);
+        values.emplace_back(0);
+        values.emplace_back(std::to_string(id + 1));
+        nebula::Row row(std::move(values));
         input.emplace_back(std::move(row));
         auto eProps = edgeProps();
-        auto start = time::WallClock::fastNowInMicroSec();
-        auto f = graphStorageClient_->getProps(spaceId_, std::move(input), nullptr,
-                                               &eProps, nullptr)
+        graphStorageClient_->getProps(spaceId_, std::move(input), nullptr, &eProps, nullptr)
             .via(evb)
             .thenValue([this, start](auto&& resps) {
                 if (!resps.succeeded()) {
@@ -416,18 +805,33 @@ private:
                 } else {
                     VLOG(3) << "request successed!";
                 }
-                this->finishedRequests_++;
-                auto now = time::WallClock::fastNowInMicroSec();
-                latencies_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()),
-                                    now - start);
-                qps_.addValue(std::chrono::seconds(time::WallClock::fastNowInSec()), 1);
-            }).thenError([](auto&&) {
+                finish(Method::GET_EDGES, start, resps.succeeded());
+            }).thenError([this, start](auto&&) {
                 LOG(ERROR) << "Request failed!";
+                finish(Method::GET_EDGES, start, false);
             });
     }
 
 private:
+    struct CurvePoint {
+        const char*     method;
+        double          target;
+        double          qps;
+        int64_t         p50;
+        int64_t         p99;
+        int64_t         p999;
+    };
+
+    struct MethodStats {
+        LatencyHistogram        latencies;
+        std::atomic<int64_t>    failed{0};
+    };
+
     std::atomic_long                                    finishedRequests_{0};
+    std::atomic_long                                    sentRequests_{0};
+    int64_t                                             phaseStart_{0};
+    std::vector<double>                                 rates_;
+    std::vector<CurvePoint>                             curve_;
     std::unique_ptr<GraphStorageClient>                 graphStorageClient_;
     std::unique_ptr<meta::MetaClient>                   mClient_;
     std::shared_ptr<folly::IOThreadPoolExecutor>        threadPool_;
@@ -439,6 +843,15 @@ private:
     folly::DynamicTokenBucket                           tokenBucket_;
     folly::TimeseriesHistogram<int64_t>                 latencies_;
     folly::TimeseriesHistogram<int64_t>                 qps_;
+
+    KeyGenerator                                        keys_;
+    std::vector<std::pair<Method, int32_t>>             mix_;
+    int32_t                                             totalWeight_{0};
+    bool                                                sequentialWrites_{false};
+    std::atomic<int64_t>                                nextWriteId_{FLAGS_min_vertex_id};
+    std::vector<std::pair<Method, int64_t>>             trace_;
+    std::atomic<uint64_t>                               replayed_{0};
+    std::array<MethodStats, static_cast<size_t>(Method::NUM_METHODS)>   methodStats_;
 };
 
 }  // namespace storage
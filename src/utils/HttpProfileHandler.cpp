@@ -0,0 +1,433 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "utils/HttpProfileHandler.h"
+#include "common/time/WallClock.h"
+#include <folly/Demangle.h>
+#include <folly/FileUtil.h>
+#include <folly/ScopeGuard.h>
+#include <folly/json.h>
+#include <folly/experimental/symbolizer/StackTrace.h>
+#include <folly/experimental/symbolizer/Symbolizer.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/executors/thread_factory/NamedThreadFactory.h>
+#include <folly/io/async/EventBaseManager.h>
+#include <folly/memory/Malloc.h>
+#include <proxygen/lib/http/ProxygenErrorEnum.h>
+#include <proxygen/httpserver/ResponseBuilder.h>
+#include <dirent.h>
+#include <signal.h>
+#include <sys/time.h>
+
+DEFINE_string(profile_dir, "/tmp", "The dir the heap profiles are dumped into");
+
+namespace nebula {
+
+using proxygen::HTTPMessage;
+using proxygen::HTTPMethod;
+using proxygen::ProxygenError;
+using proxygen::UpgradeProtocol;
+using proxygen::ResponseBuilder;
+
+namespace {
+
+constexpr int32_t kMaxSeconds = 300;
+constexpr int32_t kMaxHz = 1000;
+constexpr size_t kMaxDepth = 64;
+// the samples beyond are dropped, which takes kMaxSamples * kMaxDepth * 8 bytes
+constexpr size_t kMaxSamples = 100000;
+// the frames of the signal handler and the trampoline of the kernel
+constexpr size_t kSkipFrames = 2;
+
+// The samples are written by the signal handler, so they are preallocated
+struct CpuSamples {
+    size_t                          capacity{0};
+    std::atomic<size_t>             next{0};
+    std::vector<uintptr_t>          frames;
+    std::vector<std::atomic<int32_t>> depths;
+
+    explicit CpuSamples(size_t num)
+        : capacity(num)
+        , frames(num * kMaxDepth)
+        , depths(num) {}
+};
+
+std::atomic<CpuSamples*> gSamples{nullptr};
+// The signal handlers running, counted before gSamples is loaded, so once gSamples is reset
+// and this is 0, none of them is still writing the samples
+std::atomic<int32_t> gActiveHandlers{0};
+std::mutex gCpuProfileLock;
+// The handler of SIGPROF is kept once installed, a signal delivered late after the profile
+// is ignored by it, rather than killing the process by the default action
+bool gHandlerInstalled{false};
+
+void onProfSignal(int) {
+    gActiveHandlers.fetch_add(1);
+    SCOPE_EXIT {
+        gActiveHandlers.fetch_sub(1);
+    };
+    auto* samples = gSamples.load();
+    if (samples == nullptr) {
+        return;
+    }
+    auto index = samples->next.fetch_add(1, std::memory_order_relaxed);
+    if (index >= samples->capacity) {
+        return;
+    }
+    auto savedErrno = errno;
+    auto depth = folly::symbolizer::getStackTraceSafe(&samples->frames[index * kMaxDepth],
+                                                      kMaxDepth);
+    samples->depths[index].store(depth > 0 ? depth : 0, std::memory_order_release);
+    errno = savedErrno;
+}
+
+// The profiles are run by it rather than the http threads
+folly::Executor* profileExecutor() {
+    static auto* executor = new folly::CPUThreadPoolExecutor(
+        2, std::make_shared<folly::NamedThreadFactory>("http-profile"));
+    return executor;
+}
+
+std::string symbolOf(folly::symbolizer::Symbolizer& symbolizer,
+                     uintptr_t address,
+                     std::unordered_map<uintptr_t, std::string>& cache) {
+    auto it = cache.find(address);
+    if (it != cache.end()) {
+        return it->second;
+    }
+    folly::symbolizer::SymbolizedFrame frame;
+    symbolizer.symbolize(&address, &frame, 1);
+    std::string name;
+    if (frame.found && frame.name != nullptr) {
+        name = folly::demangle(frame.name).toStdString();
+        // the args of the functions make the stacks too long to read
+        auto pos = name.find('(');
+        if (pos != std::string::npos && pos > 0) {
+            name.resize(pos);
+        }
+    } else {
+        name = folly::stringPrintf("0x%lx", address);
+    }
+    // ';' and ' ' are the separators of the folded stacks
+    std::replace(name.begin(), name.end(), ';', ':');
+    std::replace(name.begin(), name.end(), ' ', '_');
+    cache.emplace(address, name);
+    return name;
+}
+
+struct ThreadTicks {
+    std::string name;
+    int64_t     ticks{0};
+};
+
+// The name and the utime + stime of each thread of the process
+std::unordered_map<int64_t, ThreadTicks> readThreadTicks() {
+    std::unordered_map<int64_t, ThreadTicks> threads;
+    auto* dir = opendir("/proc/self/task");
+    if (dir == nullptr) {
+        return threads;
+    }
+    while (auto* entry = readdir(dir)) {
+        if (entry->d_name[0] == '.') {
+            continue;
+        }
+        std::string stat;
+        auto path = folly::stringPrintf("/proc/self/task/%s/stat", entry->d_name);
+        if (!folly::readFile(path.c_str(), stat)) {
+            continue;
+        }
+        // tid (name) state ppid ..., the name could have spaces, utime and stime are the 14th
+        // and 15th fields
+        auto begin = stat.find('(');
+        auto end = stat.rfind(')');
+        if (begin == std::string::npos || end == std::string::npos || end < begin) {
+            continue;
+        }
+        std::vector<folly::StringPiece> fields;
+        folly::split(' ', folly::StringPiece(stat).subpiece(end + 2), fields);
+        if (fields.size() < 13) {
+            continue;
+        }
+        ThreadTicks thread;
+        thread.name = stat.substr(begin + 1, end - begin - 1);
+        thread.ticks = folly::to<int64_t>(fields[11]) + folly::to<int64_t>(fields[12]);
+        threads.emplace(folly::to<int64_t>(entry->d_name), std::move(thread));
+    }
+    closedir(dir);
+    return threads;
+}
+
+// The threads of a pool are named by the pool with an index, such as "executor-pri3-12"
+std::string poolOf(const std::string& thread) {
+    auto pos = thread.find_last_not_of("0123456789");
+    if (pos == std::string::npos) {
+        return thread;
+    }
+    auto pool = thread.substr(0, pos + 1);
+    while (!pool.empty() && (pool.back() == '-' || pool.back() == '_' ||
+                             pool.back() == '.' || pool.back() == ' ')) {
+        pool.pop_back();
+    }
+    return pool.empty() ? thread : pool;
+}
+
+}  // namespace
+
+// static
+StatusOr<std::string> HttpProfileHandler::profileCpu(int32_t seconds, int32_t hz) {
+    std::unique_lock<std::mutex> g(gCpuProfileLock, std::try_to_lock);
+    if (!g.owns_lock()) {
+        return Status::Error("A cpu profile is running");
+    }
+    auto samples = std::make_unique<CpuSamples>(
+        std::min<size_t>(static_cast<size_t>(seconds) * hz * std::thread::hardware_concurrency(),
+                         kMaxSamples));
+    if (!gHandlerInstalled) {
+        struct sigaction action;
+        memset(&action, 0, sizeof(action));
+        action.sa_handler = onProfSignal;
+        action.sa_flags = SA_RESTART;
+        sigemptyset(&action.sa_mask);
+        if (sigaction(SIGPROF, &action, nullptr) != 0) {
+            return Status::Error("Install the handler of SIGPROF failed: %s", strerror(errno));
+        }
+        gHandlerInstalled = true;
+    }
+    gSamples.store(samples.get());
+    // ITIMER_PROF counts the cpu time of the process, the signal goes to the thread on cpu
+    struct itimerval timer;
+    timer.it_interval.tv_sec = 0;
+    timer.it_interval.tv_usec = 1000000 / hz;
+    timer.it_value = timer.it_interval;
+    if (setitimer(ITIMER_PROF, &timer, nullptr) != 0) {
+        gSamples.store(nullptr);
+        return Status::Error("Start the profiling timer failed: %s", strerror(errno));
+    }
+    LOG(INFO) << "Profile cpu for " << seconds << " seconds at " << hz << "hz";
+    sleep(seconds);
+
+    memset(&timer, 0, sizeof(timer));
+    setitimer(ITIMER_PROF, &timer, nullptr);
+    gSamples.store(nullptr);
+    // wait for the handlers running on the other threads, which take microseconds
+    while (gActiveHandlers.load() != 0) {
+        std::this_thread::yield();
+    }
+
+    // fold the same stacks by their addresses first, then symbolize each address once
+    std::map<std::vector<uintptr_t>, int64_t> stacks;
+    auto num = std::min(samples->next.load(), samples->capacity);
+    for (size_t i = 0; i < num; i++) {
+        auto depth = static_cast<size_t>(samples->depths[i].load(std::memory_order_acquire));
+        if (depth <= kSkipFrames) {
+            continue;
+        }
+        auto* frames = &samples->frames[i * kMaxDepth];
+        // root first
+        std::vector<uintptr_t> stack(frames + kSkipFrames, frames + depth);
+        std::reverse(stack.begin(), stack.end());
+        stacks[std::move(stack)]++;
+    }
+    folly::symbolizer::Symbolizer symbolizer(folly::symbolizer::LocationInfoMode::DISABLED);
+    std::unordered_map<uintptr_t, std::string> symbols;
+    std::string folded;
+    for (const auto& stack : stacks) {
+        for (size_t i = 0; i < stack.first.size(); i++) {
+            if (i != 0) {
+                folded.append(1, ';');
+            }
+            // the return addresses are after the calls, except the one interrupted
+            auto address = stack.first[i];
+            if (i + 1 != stack.first.size()) {
+                address--;
+            }
+            folded.append(symbolOf(symbolizer, address, symbols));
+        }
+        folded.append(folly::stringPrintf(" %ld\n", stack.second));
+    }
+    LOG(INFO) << "Profiled " << num << " samples, " << stacks.size() << " stacks";
+    return folded;
+}
+
+// static
+StatusOr<std::string> HttpProfileHandler::dumpHeap(const std::string& dir) {
+    if (!folly::usingJEMalloc()) {
+        return Status::Error("The heap profile needs jemalloc");
+    }
+    bool enabled = false;
+    size_t size = sizeof(enabled);
+    if (mallctl("opt.prof", &enabled, &size, nullptr, 0) != 0 || !enabled) {
+        return Status::Error("The heap profile is not enabled, run with MALLOC_CONF=prof:true");
+    }
+    auto path = folly::stringPrintf("%s/heap.%d.%ld.prof",
+                                    dir.c_str(),
+                                    getpid(),
+                                    time::WallClock::fastNowInMilliSec());
+    const char* file = path.c_str();
+    auto ret = mallctl("prof.dump", nullptr, nullptr, &file, sizeof(file));
+    if (ret != 0) {
+        return Status::Error("Dump the heap profile to %s failed: %s",
+                             path.c_str(), strerror(ret));
+    }
+    LOG(INFO) << "Dump the heap profile to " << path;
+    return path;
+}
+
+// static
+folly::dynamic HttpProfileHandler::threadPoolUsage(int32_t seconds) {
+    auto before = readThreadTicks();
+    sleep(seconds);
+    auto after = readThreadTicks();
+
+    struct PoolUsage {
+        int32_t threads{0};
+        int64_t ticks{0};
+    };
+    std::map<std::string, PoolUsage> pools;
+    for (const auto& thread : after) {
+        auto& pool = pools[poolOf(thread.second.name)];
+        pool.threads++;
+        auto it = before.find(thread.first);
+        pool.ticks += thread.second.ticks - (it == before.end() ? 0 : it->second.ticks);
+    }
+    static const double kTicksPerSec = sysconf(_SC_CLK_TCK);
+    folly::dynamic usage = folly::dynamic::object();
+    for (const auto& pool : pools) {
+        double cpu = pool.second.ticks * 100.0 / kTicksPerSec / seconds;
+        folly::dynamic item = folly::dynamic::object();
+        item["threads"] = pool.second.threads;
+        item["cpu_percent"] = cpu;
+        item["busy_percent"] = cpu / pool.second.threads;
+        usage[pool.first] = std::move(item);
+    }
+    return usage;
+}
+
+void HttpProfileHandler::onRequest(std::unique_ptr<HTTPMessage> headers) noexcept {
+    if (headers->getMethod().value() != HTTPMethod::GET) {
+        // Unsupported method
+        err_ = HttpCode::E_UNSUPPORTED_METHOD;
+        return;
+    }
+    auto type = headers->getQueryParam("type");
+    int32_t seconds = 10;
+    int32_t hz = 99;
+    try {
+        if (headers->hasQueryParam("seconds")) {
+            seconds = folly::to<int32_t>(headers->getQueryParam("seconds"));
+        }
+        if (headers->hasQueryParam("hz")) {
+            hz = folly::to<int32_t>(headers->getQueryParam("hz"));
+        }
+    } catch (const std::exception&) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        return;
+    }
+    if (seconds <= 0 || seconds > kMaxSeconds || hz <= 0 || hz > kMaxHz) {
+        err_ = HttpCode::E_ILLEGAL_ARGUMENT;
+        return;
+    }
+
+    if (type == "cpu") {
+        runAsync([seconds, hz] {
+            auto ret = profileCpu(seconds, hz);
+            return ret.ok() ? std::move(ret).value() : ret.status().toString();
+        });
+    } else if (type == "heap") {
+        auto ret = dumpHeap(FLAGS_profile_dir);
+        if (!ret.ok()) {
+            resp_ = ret.status().toString();
+        } else {
+            if (!folly::readFile(ret.value().c_str(), resp_)) {
+                resp_ = folly::stringPrintf("Read the heap profile %s failed",
+                                            ret.value().c_str());
+            }
+            unlink(ret.value().c_str());
+        }
+    } else if (type == "threads") {
+        runAsync([seconds] {
+            return folly::toPrettyJson(threadPoolUsage(seconds));
+        });
+    } else {
+        resp_ = "Usage: http://ip:port/pprof?type=cpu|heap|threads&seconds=xx&hz=yy";
+    }
+    err_ = HttpCode::SUCCEEDED;
+}
+
+void HttpProfileHandler::onBody(std::unique_ptr<folly::IOBuf>) noexcept {
+    // Do nothing, we only support GET
+}
+
+void HttpProfileHandler::runAsync(std::function<std::string()> profile) {
+    auto* evb = folly::EventBaseManager::get()->getExistingEventBase();
+    if (evb == nullptr) {
+        resp_ = profile();
+        return;
+    }
+    running_ = true;
+    profileExecutor()->add([this, evb, profile = std::move(profile)] () mutable {
+        auto resp = profile();
+        evb->runInEventBaseThread([this, resp = std::move(resp)] () mutable {
+            running_ = false;
+            if (aborted_) {
+                // the handler is kept alive by the profile running when the request failed
+                delete this;
+                return;
+            }
+            resp_ = std::move(resp);
+            if (eom_) {
+                sendResponse();
+            }
+        });
+    });
+}
+
+void HttpProfileHandler::onEOM() noexcept {
+    eom_ = true;
+    if (!running_) {
+        sendResponse();
+    }
+}
+
+void HttpProfileHandler::sendResponse() {
+    switch (err_) {
+        case HttpCode::E_UNSUPPORTED_METHOD:
+            ResponseBuilder(downstream_)
+                .status(405, "Method Not Allowed")
+                .sendWithEOM();
+            return;
+        case HttpCode::E_ILLEGAL_ARGUMENT:
+            ResponseBuilder(downstream_)
+                .status(400, "Bad Request")
+                .sendWithEOM();
+            return;
+        default:
+            break;
+    }
+
+    ResponseBuilder(downstream_)
+        .status(200, "OK")
+        .body(resp_)
+        .sendWithEOM();
+}
+
+void HttpProfileHandler::onUpgrade(UpgradeProtocol) noexcept {
+    // Do nothing
+}
+
+void HttpProfileHandler::requestComplete() noexcept {
+    delete this;
+}
+
+void HttpProfileHandler::onError(ProxygenError error) noexcept {
+    LOG(ERROR) << "Web service HttpProfileHandler got error: "
+               << proxygen::getErrorString(error);
+    if (running_) {
+        aborted_ = true;
+    }
+}
+
+}  // namespace nebula
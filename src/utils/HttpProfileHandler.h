@@ -0,0 +1,72 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef UTILS_HTTPPROFILEHANDLER_H_
+#define UTILS_HTTPPROFILEHANDLER_H_
+
+#include "common/base/Base.h"
+#include "common/webservice/Common.h"
+#include <proxygen/httpserver/RequestHandler.h>
+
+namespace nebula {
+
+/*
+HttpProfileHandler profiles the live process, it is served as /pprof by both storaged and metad.
+  /pprof?type=cpu&seconds=10&hz=99  samples the stacks of the threads on cpu by SIGPROF, the
+                                    stacks are returned folded, one "f1;f2;f3 count" a line,
+                                    which flamegraph.pl takes as it is
+  /pprof?type=heap                  the heap profile dumped by jemalloc, which jeprof takes, the
+                                    process must run with jemalloc and MALLOC_CONF=prof:true
+  /pprof?type=threads&seconds=10    the cpu utilization of each thread pool, the threads are
+                                    grouped by their names without the trailing numbers
+Only one cpu profile is running at once. The cpu and threads profiles run on a thread of their
+own for the seconds, the response is sent from the event base of the request once it is done,
+so the http threads are not blocked meanwhile.
+*/
+class HttpProfileHandler : public proxygen::RequestHandler {
+public:
+    HttpProfileHandler() = default;
+
+    void onRequest(std::unique_ptr<proxygen::HTTPMessage> headers) noexcept override;
+
+    void onBody(std::unique_ptr<folly::IOBuf> body) noexcept override;
+
+    void onEOM() noexcept override;
+
+    void onUpgrade(proxygen::UpgradeProtocol protocol) noexcept override;
+
+    void requestComplete() noexcept override;
+
+    void onError(proxygen::ProxygenError error) noexcept override;
+
+    // The folded stacks sampled in the seconds, or the error
+    static StatusOr<std::string> profileCpu(int32_t seconds, int32_t hz);
+
+    // The path of the heap profile dumped into dir, or the error
+    static StatusOr<std::string> dumpHeap(const std::string& dir);
+
+    // The utilization of each thread pool in the seconds, cpu_percent is of a single core
+    static folly::dynamic threadPoolUsage(int32_t seconds);
+
+private:
+    // Run the profile off the event base, the response is sent once the EOM is received too
+    void runAsync(std::function<std::string()> profile);
+
+    // Send the response, called on the event base
+    void sendResponse();
+
+private:
+    HttpCode err_{HttpCode::SUCCEEDED};
+    std::string resp_;
+    // Only touched on the event base of the request
+    bool eom_{false};
+    bool running_{false};
+    bool aborted_{false};
+};
+
+}  // namespace nebula
+
+#endif  // UTILS_HTTPPROFILEHANDLER_H_
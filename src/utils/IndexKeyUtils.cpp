@@ -7,6 +7,13 @@
 #include "utils/IndexKeyUtils.h"
 #include <thrift/lib/cpp2/protocol/Serializer.h>
 
+DEFINE_int32(index_string_prefix_len, 0,
+             "Keep only the prefix of this length and a hash of a fixed string index column "
+             "longer than it, instead of padding it to the length of column, the rows of a "
+             "prefix shared are verified on lookup. 0 means disabled. It changes the index "
+             "keys, it is recorded in each part and the storage refuses to load a part "
+             "written with another value, the same value must be used by all hosts");
+
 namespace nebula {
 
 // static
@@ -16,26 +23,13 @@ std::string IndexKeyUtils::encodeValues(std::vector<Value>&& values,
     // An index has a maximum of 16 columns. 2 byte (16 bit) is enough.
     u_short nullableBitSet = 0;
     std::string index;
+    index.reserve(indexValuesLen(cols));
 
     for (size_t i = 0; i < values.size(); i++) {
-        auto isNullable = cols[i].nullable_ref().value_or(false);
-        if (isNullable) {
+        if (cols[i].nullable_ref().value_or(false)) {
             hasNullCol = true;
         }
-
-        if (!values[i].isNull()) {
-            // string index need to fill with '\0' if length is less than schema
-            if (cols[i].type.type == meta::cpp2::PropertyType::FIXED_STRING) {
-                auto len = static_cast<size_t>(*cols[i].type.get_type_length());
-                index.append(encodeValue(values[i], len));
-            } else {
-                index.append(encodeValue(values[i]));
-            }
-        } else {
-            nullableBitSet |= 0x8000 >> i;
-            auto type = IndexKeyUtils::toValueType(cols[i].type.get_type());
-            index.append(encodeNullValue(type, cols[i].type.get_type_length()));
-        }
+        appendIndexValue(&index, values[i], i, cols[i], nullableBitSet);
     }
     // if has nullable field, append nullableBitSet to the end
     if (hasNullCol) {
@@ -44,13 +38,54 @@ std::string IndexKeyUtils::encodeValues(std::vector<Value>&& values,
     return index;
 }
 
+// static
+void IndexKeyUtils::appendIndexValue(std::string* index,
+                                     const Value& v,
+                                     size_t i,
+                                     const nebula::meta::cpp2::ColumnDef& col,
+                                     u_short& nullableBitSet) {
+    if (!v.isNull()) {
+        // string index need to fill with '\0' if length is less than schema
+        if (isCompactString(col)) {
+            appendCompactString(index, v, *col.type.get_type_length());
+        } else if (col.type.type == meta::cpp2::PropertyType::FIXED_STRING) {
+            appendValue(index, v, *col.type.get_type_length());
+        } else {
+            appendValue(index, v);
+        }
+    } else {
+        nullableBitSet |= 0x8000 >> i;
+        if (isCompactString(col)) {
+            index->append(indexFieldLen(col), static_cast<char>(0xFF));
+        } else {
+            auto type = IndexKeyUtils::toValueType(col.type.get_type());
+            appendNullValue(index, type, col.type.get_type_length());
+        }
+    }
+}
+
+// static
+size_t IndexKeyUtils::indexValuesLen(const std::vector<nebula::meta::cpp2::ColumnDef>& cols) {
+    size_t len = 0;
+    bool hasNullCol = false;
+    for (const auto& col : cols) {
+        // only a reservation, a string column without the length is left to grow
+        if (col.type.get_type_length() != nullptr ||
+            toValueType(col.type.get_type()) != Value::Type::STRING) {
+            len += indexFieldLen(col);
+        }
+        hasNullCol |= col.nullable_ref().value_or(false);
+    }
+    return hasNullCol ? len + sizeof(u_short) : len;
+}
+
 // static
 std::string IndexKeyUtils::vertexIndexKey(size_t vIdLen, PartitionID partId,
                                           IndexID indexId, const VertexID& vId,
                                           std::string&& values) {
     int32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kIndex);
     std::string key;
-    key.reserve(256);
+    key.reserve(kVertexIndexLen + values.size() + vIdLen);
     key.append(reinterpret_cast<const char*>(&item), sizeof(int32_t))
        .append(reinterpret_cast<const char*>(&indexId), sizeof(IndexID))
        .append(values)
@@ -66,14 +101,14 @@ std::string IndexKeyUtils::edgeIndexKey(size_t vIdLen, PartitionID partId,
                                         std::string&& values) {
     int32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kIndex);
     std::string key;
-    key.reserve(256);
+    key.reserve(kEdgeIndexLen + values.size() + (vIdLen << 1));
     key.append(reinterpret_cast<const char*>(&item), sizeof(int32_t))
        .append(reinterpret_cast<const char*>(&indexId), sizeof(IndexID))
        .append(values)
        .append(srcId.data(), srcId.size())
-       .append(vIdLen - srcId.size(), '\0')
-       .append(IndexKeyUtils::encodeRank(rank))
-       .append(dstId.data(), dstId.size())
+       .append(vIdLen - srcId.size(), '\0');
+    appendInt64(&key, rank);
+    key.append(dstId.data(), dstId.size())
        .append(vIdLen - dstId.size(), '\0');
     return key;
 }
@@ -123,8 +158,13 @@ IndexKeyUtils::collectIndexValues(RowReader* reader,
     if (reader == nullptr) {
         return Status::Error("Invalid row reader");
     }
-    std::vector<Value> values;
-    for (const auto& col : cols) {
+    // the values are encoded as read, without a vector of them in between
+    bool hasNullCol = false;
+    u_short nullableBitSet = 0;
+    std::string index;
+    index.reserve(indexValuesLen(cols));
+    for (size_t i = 0; i < cols.size(); i++) {
+        const auto& col = cols[i];
         auto v = reader->getValueByName(col.get_name());
         auto isNullable = col.nullable_ref().value_or(false);
         auto ret = checkValue(v, isNullable);
@@ -133,9 +173,13 @@ IndexKeyUtils::collectIndexValues(RowReader* reader,
                        << ". status : " << ret;
             return ret;
         }
-        values.emplace_back(std::move(v));
+        hasNullCol |= isNullable;
+        appendIndexValue(&index, v, i, col, nullableBitSet);
     }
-    return encodeValues(std::move(values), cols);
+    if (hasNullCol) {
+        index.append(reinterpret_cast<const char*>(&nullableBitSet), sizeof(u_short));
+    }
+    return index;
 }
 
 // static
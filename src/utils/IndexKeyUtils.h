@@ -13,6 +13,9 @@
 #include "codec/RowReader.h"
 #include "utils/Types.h"
 #include "codec/RowReader.h"
+#include <folly/hash/SpookyHashV2.h>
+
+DECLARE_int32(index_string_prefix_len);
 
 namespace nebula {
 
@@ -55,7 +58,17 @@ public:
         return Value::Type::__EMPTY__;
     }
 
+    /**
+     * Each encodeXxx has an appendXxx, which writes the same bytes at the end of `raw`, so
+     * the values of an index key are encoded into the key itself instead of a string each.
+     * */
     static std::string encodeNullValue(Value::Type type, const int16_t* strLen) {
+        std::string raw;
+        appendNullValue(&raw, type, strLen);
+        return raw;
+    }
+
+    static void appendNullValue(std::string* raw, Value::Type type, const int16_t* strLen) {
         size_t len = 0;
         switch (type) {
             case Value::Type::INT: {
@@ -89,53 +102,114 @@ public:
             default :
                 LOG(ERROR) << "Unsupported default value type";
         }
+        raw->append(len, static_cast<char>(0xFF));
+    }
+
+    static std::string encodeValue(const Value& v, int16_t len) {
         std::string raw;
-        raw.reserve(len);
-        raw.append(len, static_cast<char>(0xFF));
+        appendValue(&raw, v, len);
         return raw;
     }
 
-    static std::string encodeValue(const Value& v, int16_t len) {
+    // A string is padded with '\0' or truncated to len
+    static void appendValue(std::string* raw, const Value& v, int16_t len) {
         if (v.type() == Value::Type::STRING) {
-            std::string fs = v.getStr();
-            if (static_cast<size_t>(len) > v.getStr().size()) {
-                fs.append(len - v.getStr().size(), '\0');
+            const auto& str = v.getStr();
+            if (static_cast<size_t>(len) > str.size()) {
+                raw->append(str).append(len - str.size(), '\0');
             } else {
-                fs = fs.substr(0, len);
+                raw->append(str.data(), len);
             }
-            return fs;
         } else {
-            return encodeValue(v);
+            appendValue(raw, v);
+        }
+    }
+
+    /**
+     * A compact string is the string padded or truncated to len, cut to the prefix of
+     * index_string_prefix_len bytes, followed by the hash of the whole padded string. The same
+     * string is always encoded the same, but two strings of the same prefix are told apart only
+     * by the hash, so the rows of them are verified on read, see fitsCompactPrefix.
+     * */
+    static void appendCompactString(std::string* raw, const Value& v, int16_t len) {
+        auto full = encodeValue(v, len);
+        auto hash = folly::Endian::big(
+            folly::hash::SpookyHashV2::Hash32(full.data(), full.size(), 0));
+        raw->append(full.data(), compactPrefixLen())
+            .append(reinterpret_cast<const char*>(&hash), kStringHashLen);
+    }
+
+    // Whether the string padded is kept whole in the prefix of compact string, i.e. the bytes
+    // after the prefix are all padding, so the prefix alone tells the string
+    static bool fitsCompactPrefix(folly::StringPiece full) {
+        for (size_t i = compactPrefixLen(); i < full.size(); i++) {
+            if (full[i] != '\0') {
+                return false;
+            }
         }
+        return true;
+    }
+
+    static size_t compactPrefixLen() {
+        return static_cast<size_t>(std::max(FLAGS_index_string_prefix_len, 0));
+    }
+
+    /**
+     * The encoding of the index keys written by this process, i.e. the compact prefix length.
+     * It is kept in NebulaKeyUtils::systemIndexEncodingKey of each part when the part is added,
+     * the part is refused on load if it differs, since its index keys couldn't be looked up.
+     * */
+    static std::string indexEncoding() {
+        auto len = static_cast<int32_t>(compactPrefixLen());
+        return std::string(reinterpret_cast<const char*>(&len), sizeof(int32_t));
+    }
+
+    // Whether the column is encoded as a compact string in the index keys, which is only done
+    // for a fixed string longer than the prefix and the hash
+    static bool isCompactString(const meta::cpp2::ColumnDef& col) {
+        return FLAGS_index_string_prefix_len > 0 &&
+               col.type.get_type() == PropertyType::FIXED_STRING &&
+               col.type.get_type_length() != nullptr &&
+               static_cast<size_t>(*col.type.get_type_length()) >
+                   compactPrefixLen() + kStringHashLen;
     }
 
     static std::string encodeValue(const Value& v) {
+        std::string raw;
+        appendValue(&raw, v);
+        return raw;
+    }
+
+    static void appendValue(std::string* raw, const Value& v) {
         switch (v.type()) {
             case Value::Type::INT:
-                return encodeInt64(v.getInt());
+                appendInt64(raw, v.getInt());
+                break;
             case Value::Type::FLOAT:
-                return encodeDouble(v.getFloat());
+                appendDouble(raw, v.getFloat());
+                break;
             case Value::Type::BOOL: {
                 auto val = v.getBool();
-                std::string raw;
-                raw.reserve(sizeof(bool));
-                raw.append(reinterpret_cast<const char*>(&val), sizeof(bool));
-                return raw;
+                raw->append(reinterpret_cast<const char*>(&val), sizeof(bool));
+                break;
             }
             case Value::Type::STRING:
-                return v.getStr();
+                raw->append(v.getStr());
+                break;
             case Value::Type::TIME:
-                return encodeTime(v.getTime());
+                appendTime(raw, v.getTime());
+                break;
             case Value::Type::DATE: {
-                return encodeDate(v.getDate());
+                appendDate(raw, v.getDate());
+                break;
             }
             case Value::Type::DATETIME: {
-                return encodeDateTime(v.getDateTime());
+                appendDateTime(raw, v.getDateTime());
+                break;
             }
             default :
                 LOG(ERROR) << "Unsupported default value type";
         }
-        return "";
     }
 
     /**
@@ -150,14 +224,18 @@ public:
      */
 
     static std::string encodeInt64(int64_t v) {
-        v ^= folly::to<int64_t>(1) << 63;
-        auto val = folly::Endian::big(v);
         std::string raw;
         raw.reserve(sizeof(int64_t));
-        raw.append(reinterpret_cast<const char*>(&val), sizeof(int64_t));
+        appendInt64(&raw, v);
         return raw;
     }
 
+    static void appendInt64(std::string* raw, int64_t v) {
+        v ^= folly::to<int64_t>(1) << 63;
+        auto val = folly::Endian::big(v);
+        raw->append(reinterpret_cast<const char*>(&val), sizeof(int64_t));
+    }
+
     static int64_t decodeInt64(const folly::StringPiece& raw) {
         auto val = *reinterpret_cast<const int64_t*>(raw.data());
         val = folly::Endian::big(val);
@@ -182,6 +260,13 @@ public:
      */
 
     static std::string encodeDouble(double v) {
+        std::string raw;
+        raw.reserve(sizeof(double));
+        appendDouble(&raw, v);
+        return raw;
+    }
+
+    static void appendDouble(std::string* raw, double v) {
         if (v < 0) {
             /**
              *   TODO : now, the -(std::numeric_limits<double>::min())
@@ -194,10 +279,7 @@ public:
         auto val = folly::Endian::big(v);
         auto* c = reinterpret_cast<char*>(&val);
         c[0] ^= 0x80;
-        std::string raw;
-        raw.reserve(sizeof(double));
-        raw.append(c, sizeof(double));
-        return raw;
+        raw->append(c, sizeof(double));
     }
 
     static double decodeDouble(const folly::StringPiece& raw) {
@@ -214,17 +296,21 @@ public:
     }
 
     static std::string encodeTime(const nebula::Time& t) {
+        std::string buf;
+        buf.reserve(sizeof(int32_t) + sizeof(int8_t) * 3);
+        appendTime(&buf, t);
+        return buf;
+    }
+
+    static void appendTime(std::string* buf, const nebula::Time& t) {
         auto hour = folly::Endian::big8(t.hour);
         auto minute = folly::Endian::big8(t.minute);
         auto sec = folly::Endian::big8(t.sec);
         auto microsec = folly::Endian::big32(t.microsec);
-        std::string buf;
-        buf.reserve(sizeof(int32_t) + sizeof(int8_t) * 3);
-        buf.append(reinterpret_cast<const char*>(&hour), sizeof(int8_t))
-           .append(reinterpret_cast<const char*>(&minute), sizeof(int8_t))
-           .append(reinterpret_cast<const char*>(&sec), sizeof(int8_t))
-           .append(reinterpret_cast<const char*>(&microsec), sizeof(int32_t));
-        return buf;
+        buf->append(reinterpret_cast<const char*>(&hour), sizeof(int8_t))
+            .append(reinterpret_cast<const char*>(&minute), sizeof(int8_t))
+            .append(reinterpret_cast<const char*>(&sec), sizeof(int8_t))
+            .append(reinterpret_cast<const char*>(&microsec), sizeof(int32_t));
     }
 
     static nebula::Time decodeTime(const folly::StringPiece& raw) {
@@ -242,17 +328,21 @@ public:
     }
 
     static std::string encodeDate(const nebula::Date& d) {
-        auto year = folly::Endian::big16(d.year);
-        auto month = folly::Endian::big8(d.month);
-        auto day = folly::Endian::big8(d.day);
         std::string buf;
         buf.reserve(sizeof(int8_t) * 2 + sizeof(int16_t));
-        buf.append(reinterpret_cast<const char*>(&year), sizeof(int16_t))
-           .append(reinterpret_cast<const char*>(&month), sizeof(int8_t))
-           .append(reinterpret_cast<const char*>(&day), sizeof(int8_t));
+        appendDate(&buf, d);
         return buf;
     }
 
+    static void appendDate(std::string* buf, const nebula::Date& d) {
+        auto year = folly::Endian::big16(d.year);
+        auto month = folly::Endian::big8(d.month);
+        auto day = folly::Endian::big8(d.day);
+        buf->append(reinterpret_cast<const char*>(&year), sizeof(int16_t))
+            .append(reinterpret_cast<const char*>(&month), sizeof(int8_t))
+            .append(reinterpret_cast<const char*>(&day), sizeof(int8_t));
+    }
+
     static nebula::Date decodeDate(const folly::StringPiece& raw) {
         int16_t year = *reinterpret_cast<const int16_t *>(raw.data());
         int8_t month = *reinterpret_cast<const int8_t *>(raw.data() + sizeof(int16_t));
@@ -264,6 +354,13 @@ public:
     }
 
     static std::string encodeDateTime(const nebula::DateTime& dt) {
+        std::string buf;
+        buf.reserve(sizeof(int32_t) + sizeof(int16_t) + sizeof(int8_t) * 5);
+        appendDateTime(&buf, dt);
+        return buf;
+    }
+
+    static void appendDateTime(std::string* buf, const nebula::DateTime& dt) {
         auto year = folly::Endian::big16(static_cast<uint16_t>(dt.year));
         auto month = folly::Endian::big8(static_cast<uint8_t>(dt.month));
         auto day = folly::Endian::big8(static_cast<uint8_t>(dt.day));
@@ -271,16 +368,13 @@ public:
         auto minute = folly::Endian::big8(static_cast<uint8_t>(dt.minute));
         auto sec = folly::Endian::big8(static_cast<uint8_t>(dt.sec));
         auto microsec = folly::Endian::big32(static_cast<uint32_t>(dt.microsec));
-        std::string buf;
-        buf.reserve(sizeof(int32_t) + sizeof(int16_t) + sizeof(int8_t) * 5);
-        buf.append(reinterpret_cast<const char*>(&year), sizeof(int16_t))
-           .append(reinterpret_cast<const char*>(&month), sizeof(int8_t))
-           .append(reinterpret_cast<const char*>(&day), sizeof(int8_t))
-           .append(reinterpret_cast<const char*>(&hour), sizeof(int8_t))
-           .append(reinterpret_cast<const char*>(&minute), sizeof(int8_t))
-           .append(reinterpret_cast<const char*>(&sec), sizeof(int8_t))
-           .append(reinterpret_cast<const char*>(&microsec), sizeof(int32_t));
-        return buf;
+        buf->append(reinterpret_cast<const char*>(&year), sizeof(int16_t))
+            .append(reinterpret_cast<const char*>(&month), sizeof(int8_t))
+            .append(reinterpret_cast<const char*>(&day), sizeof(int8_t))
+            .append(reinterpret_cast<const char*>(&hour), sizeof(int8_t))
+            .append(reinterpret_cast<const char*>(&minute), sizeof(int8_t))
+            .append(reinterpret_cast<const char*>(&sec), sizeof(int8_t))
+            .append(reinterpret_cast<const char*>(&microsec), sizeof(int32_t));
     }
 
     static nebula::DateTime decodeDateTime(const folly::StringPiece& raw) {
@@ -345,79 +439,88 @@ public:
         return v;
     }
 
+    // The position of a column in the index key. It only depends on the index columns, so it
+    // could be located once for an index, and used to decode the column from every index key.
+    struct IndexField {
+        size_t              offset_{0};
+        size_t              len_{0};
+        Value::Type         type_{Value::Type::__EMPTY__};
+        // the bit in nullableBitSet, -1 if the index has no nullable column
+        int8_t              nullBit_{-1};
+    };
+
+    // the hash after the prefix of a compact string
+    static constexpr size_t kStringHashLen = sizeof(uint32_t);
+
+    static size_t indexFieldLen(const meta::cpp2::ColumnDef& col) {
+        switch (IndexKeyUtils::toValueType(col.type.get_type())) {
+            case Value::Type::BOOL:
+                return sizeof(bool);
+            case Value::Type::INT:
+                return sizeof(int64_t);
+            case Value::Type::FLOAT:
+                return sizeof(double);
+            case Value::Type::STRING:
+                return isCompactString(col) ? compactPrefixLen() + kStringHashLen
+                                            : *col.type.get_type_length();
+            case Value::Type::TIME:
+                return sizeof(int8_t) * 3 + sizeof(int32_t);
+            case Value::Type::DATE:
+                return sizeof(int8_t) * 2 + sizeof(int16_t);
+            case Value::Type::DATETIME:
+                return sizeof(int32_t) + sizeof(int16_t) + sizeof(int8_t) * 5;
+            default:
+                return 0;
+        }
+    }
+
+    // Locate the column `prop` in the index key, return false if it is not an index column
+    static bool locateIndexField(const std::string& prop,
+                                 const std::vector<meta::cpp2::ColumnDef>& cols,
+                                 bool hasNullableCol,
+                                 IndexField& field) {
+        size_t offset = sizeof(PartitionID) + sizeof(IndexID);
+        for (size_t i = 0; i < cols.size(); i++) {
+            auto len = indexFieldLen(cols[i]);
+            if (cols[i].get_name() == prop) {
+                field.offset_ = offset;
+                field.len_ = len;
+                field.type_ = IndexKeyUtils::toValueType(cols[i].get_type().get_type());
+                field.nullBit_ = hasNullableCol ? static_cast<int8_t>(15 - i) : -1;
+                return true;
+            }
+            offset += len;
+        }
+        return false;
+    }
+
+    static Value getValueFromIndexKey(size_t vIdLen,
+                                      folly::StringPiece key,
+                                      const IndexField& field,
+                                      bool isEdgeIndex = false) {
+        if (field.nullBit_ >= 0) {
+            auto tailLen = (!isEdgeIndex) ? vIdLen : vIdLen * 2 + sizeof(EdgeRanking);
+            auto bitOffset = key.size() - tailLen - sizeof(u_short);
+            std::bitset<16> nullableBit =
+                *reinterpret_cast<const u_short*>(key.data() + bitOffset);
+            if (nullableBit.test(field.nullBit_)) {
+                return Value(NullType::__NULL__);
+            }
+        }
+        return decodeValue(key.subpiece(field.offset_, field.len_), field.type_);
+    }
+
     static Value getValueFromIndexKey(size_t vIdLen,
                                       folly::StringPiece key,
                                       const std::string& prop,
                                       const std::vector<meta::cpp2::ColumnDef>& cols,
                                       bool isEdgeIndex = false,
                                       bool hasNullableCol = false) {
-        size_t len = 0;
-        std::bitset<16> nullableBit;
-        int8_t nullableColPosit = 15;
-        size_t offset = sizeof(PartitionID) + sizeof(IndexID);
-        auto tailLen = (!isEdgeIndex) ? vIdLen : vIdLen * 2 + sizeof(EdgeRanking);
-
-        auto it = std::find_if(cols.begin(), cols.end(),
-                               [&prop] (const auto& col) {
-                                   return prop == col.get_name();
-                               });
-        if (it == cols.end()) {
+        IndexField field;
+        if (!locateIndexField(prop, cols, hasNullableCol, field)) {
             return Value(NullType::BAD_DATA);
         }
-        auto type = IndexKeyUtils::toValueType(it->get_type().get_type());
-
-        if (hasNullableCol) {
-            auto bitOffset = key.size() - tailLen - sizeof(u_short);
-            auto v = *reinterpret_cast<const u_short*>(key.data() + bitOffset);
-            nullableBit = v;
-        }
-
-        for (const auto& col : cols) {
-            if (hasNullableCol && col.get_name() == prop && nullableBit.test(nullableColPosit)) {
-                return Value(NullType::__NULL__);
-            }
-            switch (IndexKeyUtils::toValueType(col.type.get_type())) {
-                case Value::Type::BOOL: {
-                    len = sizeof(bool);
-                    break;
-                }
-                case Value::Type::INT: {
-                    len = sizeof(int64_t);
-                    break;
-                }
-                case Value::Type::FLOAT: {
-                    len = sizeof(double);
-                    break;
-                }
-                case Value::Type::STRING: {
-                    len = *col.type.get_type_length();
-                    break;
-                }
-                case Value::Type::TIME: {
-                    len = sizeof(int8_t) * 3 + sizeof(int32_t);
-                    break;
-                }
-                case Value::Type::DATE: {
-                    len = sizeof(int8_t) * 2 + sizeof(int16_t);
-                    break;
-                }
-                case Value::Type::DATETIME: {
-                    len = sizeof(int32_t) + sizeof(int16_t) + sizeof(int8_t) * 5;
-                    break;
-                }
-                default:
-                    len = 0;
-            }
-            if (hasNullableCol) {
-                nullableColPosit -= 1;
-            }
-            if (col.get_name() == prop) {
-                break;
-            }
-            offset += len;
-        }
-        auto propVal = key.subpiece(offset, len);
-        return decodeValue(propVal, type);
+        return getValueFromIndexKey(vIdLen, key, field, isEdgeIndex);
     }
 
     static VertexIDSlice getIndexVertexID(size_t vIdLen, const folly::StringPiece& rawKey) {
@@ -461,6 +564,9 @@ public:
     static std::string encodeValues(std::vector<Value>&& values,
                                     const std::vector<nebula::meta::cpp2::ColumnDef>& cols);
 
+    // The length of the values encoded of the index columns, with the nullable bits if any
+    static size_t indexValuesLen(const std::vector<nebula::meta::cpp2::ColumnDef>& cols);
+
     /**
      * param valueTypes ： column type of each index column. If there are no nullable columns
      *                     in the index, the parameter can be empty.
@@ -494,6 +600,13 @@ private:
     IndexKeyUtils() = delete;
 
     static Status checkValue(const Value& v, bool isNullable);
+
+    // Encode the value of the column i, or the null of it, at the end of index
+    static void appendIndexValue(std::string* index,
+                                 const Value& v,
+                                 size_t i,
+                                 const nebula::meta::cpp2::ColumnDef& col,
+                                 u_short& nullableBitSet);
 };
 
 }  // namespace nebula
@@ -11,11 +11,27 @@
 
 namespace nebula {
 
+/**
+ * By default, locking a key which is already locked fails at once, and the caller returns
+ * E_DATA_CONFLICT_ERROR to the client, which retries the whole request.
+ *
+ * When waitMs > 0, the keys are kept in lock-striped shards instead, and a conflicting lock
+ * waits in the queue of the key for at most waitMs, the waiters of a key get it in the order
+ * they come. At most maxWaiters wait for one key, the others still fail at once.
+ * */
 template<typename Key>
 class MemoryLockCore {
 public:
     MemoryLockCore() = default;
 
+    MemoryLockCore(int32_t waitMs, int32_t maxWaiters, size_t shardsNum = 64)
+        : waitMs_(waitMs)
+        , maxWaiters_(maxWaiters) {
+        if (waitMs_ > 0) {
+            shards_ = std::vector<Shard>(std::max<size_t>(shardsNum, 1));
+        }
+    }
+
     ~MemoryLockCore() = default;
 
     // I assume this may have better perf in high contention
@@ -27,19 +43,33 @@ public:
     }
 
     bool try_lock(const Key& key) {
+        if (waitable()) {
+            return waitLock(key, deadline());
+        }
         return hashMap_.insert(std::make_pair(key, 0)).second;
     }
 
     void unlock(const Key& key) {
+        if (waitable()) {
+            waitUnlock(key);
+            return;
+        }
         hashMap_.erase(key);
     }
 
+    // The keys are locked in order, so the batches sorted (e.g. by MemoryLockGuard with dedup)
+    // don't wait for each other in a cycle
     template<class Iter>
     std::pair<Iter, bool> lockBatch(Iter begin, Iter end) {
         Iter curr = begin;
         bool inserted = false;
+        auto until = deadline();
         while (curr != end) {
-            std::tie(std::ignore, inserted) = hashMap_.insert(std::make_pair(*curr, 0));
+            if (waitable()) {
+                inserted = waitLock(*curr, until);
+            } else {
+                std::tie(std::ignore, inserted) = hashMap_.insert(std::make_pair(*curr, 0));
+            }
             if (!inserted) {
                 unlockBatch(begin, curr);
                 return std::make_pair(curr, false);
@@ -57,7 +87,7 @@ public:
     template<class Iter>
     void unlockBatch(Iter begin, Iter end) {
         for (; begin != end; ++begin) {
-            hashMap_.erase(*begin);
+            unlock(*begin);
         }
     }
 
@@ -67,15 +97,108 @@ public:
     }
 
     void clear() {
+        for (auto& shard : shards_) {
+            std::lock_guard<std::mutex> g(shard.lock);
+            for (auto it = shard.entries.begin(); it != shard.entries.end();) {
+                // The waiting ones get the key in turn
+                it->second.locked = false;
+                it = it->second.waiters.empty() ? shard.entries.erase(it) : std::next(it);
+            }
+            shard.cond.notify_all();
+        }
         hashMap_.clear();
     }
 
     size_t size() {
+        if (waitable()) {
+            size_t locked = 0;
+            for (auto& shard : shards_) {
+                std::lock_guard<std::mutex> g(shard.lock);
+                for (const auto& entry : shard.entries) {
+                    locked += entry.second.locked;
+                }
+            }
+            return locked;
+        }
         return hashMap_.size();
     }
 
 protected:
+    // The waiting lockers of a key are queued by their tickets
+    struct Entry {
+        bool locked{false};
+        uint64_t nextTicket{0};
+        std::deque<uint64_t> waiters;
+    };
+
+    struct Shard {
+        std::mutex lock;
+        std::condition_variable cond;
+        std::unordered_map<Key, Entry> entries;
+    };
+
+    bool waitable() const {
+        return !shards_.empty();
+    }
+
+    std::chrono::steady_clock::time_point deadline() const {
+        return std::chrono::steady_clock::now() + std::chrono::milliseconds(waitMs_);
+    }
+
+    Shard& shardOf(const Key& key) {
+        return shards_[std::hash<Key>()(key) % shards_.size()];
+    }
+
+    bool waitLock(const Key& key, std::chrono::steady_clock::time_point until) {
+        auto& shard = shardOf(key);
+        std::unique_lock<std::mutex> g(shard.lock);
+        // The reference of an entry is stable, it is erased only if no one is waiting on it
+        auto& entry = shard.entries[key];
+        if (!entry.locked && entry.waiters.empty()) {
+            entry.locked = true;
+            return true;
+        }
+        if (static_cast<int32_t>(entry.waiters.size()) >= maxWaiters_) {
+            return false;
+        }
+        auto ticket = entry.nextTicket++;
+        entry.waiters.emplace_back(ticket);
+        bool acquired = shard.cond.wait_until(g, until, [&entry, ticket] {
+            return !entry.locked && entry.waiters.front() == ticket;
+        });
+        entry.waiters.erase(std::find(entry.waiters.begin(), entry.waiters.end(), ticket));
+        if (acquired) {
+            entry.locked = true;
+            return true;
+        }
+        if (!entry.locked && entry.waiters.empty()) {
+            shard.entries.erase(key);
+        } else {
+            // The next waiter might be waiting for this one to leave the head of the queue
+            shard.cond.notify_all();
+        }
+        return false;
+    }
+
+    void waitUnlock(const Key& key) {
+        auto& shard = shardOf(key);
+        std::lock_guard<std::mutex> g(shard.lock);
+        auto it = shard.entries.find(key);
+        if (it == shard.entries.end()) {
+            return;
+        }
+        if (it->second.waiters.empty()) {
+            shard.entries.erase(it);
+            return;
+        }
+        it->second.locked = false;
+        shard.cond.notify_all();
+    }
+
     folly::ConcurrentHashMap<Key, int> hashMap_;
+    int32_t waitMs_{0};
+    int32_t maxWaiters_{0};
+    std::vector<Shard> shards_;
 };
 
 }  // namespace nebula
@@ -22,18 +22,26 @@ std::string NebulaKeyUtils::vertexKey(size_t vIdLen,
                                       PartitionID partId,
                                       const VertexID& vId,
                                       TagID tagId) {
-    CHECK_GE(vIdLen, vId.size());
-    int32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kVertex);
-
     std::string key;
     key.reserve(kVertexLen + vIdLen);
-    key.append(reinterpret_cast<const char*>(&item), sizeof(int32_t))
-       .append(vId.data(), vId.size())
-       .append(vIdLen - vId.size(), '\0')
-       .append(reinterpret_cast<const char*>(&tagId), sizeof(TagID));
+    appendVertexKey(&key, vIdLen, partId, vId, tagId);
     return key;
 }
 
+// static
+void NebulaKeyUtils::appendVertexKey(std::string* key,
+                                     size_t vIdLen,
+                                     PartitionID partId,
+                                     const VertexID& vId,
+                                     TagID tagId) {
+    CHECK_GE(vIdLen, vId.size());
+    int32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kVertex);
+    key->append(reinterpret_cast<const char*>(&item), sizeof(int32_t))
+        .append(vId.data(), vId.size())
+        .append(vIdLen - vId.size(), '\0')
+        .append(reinterpret_cast<const char*>(&tagId), sizeof(TagID));
+}
+
 // static
 std::string NebulaKeyUtils::edgeKey(size_t vIdLen,
                                     PartitionID partId,
@@ -42,23 +50,34 @@ std::string NebulaKeyUtils::edgeKey(size_t vIdLen,
                                     EdgeRanking rank,
                                     const VertexID& dstId,
                                     EdgeVerPlaceHolder ev) {
-    CHECK_GE(vIdLen, srcId.size());
-    CHECK_GE(vIdLen, dstId.size());
-    int32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kEdge);
-
     std::string key;
     key.reserve(kEdgeLen + (vIdLen << 1));
-    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
-       .append(srcId.data(), srcId.size())
-       .append(vIdLen - srcId.size(), '\0')
-       .append(reinterpret_cast<const char*>(&type), sizeof(EdgeType))
-       .append(NebulaKeyUtils::encodeRank(rank))
-       .append(dstId.data(), dstId.size())
-       .append(vIdLen - dstId.size(), '\0')
-       .append(1, ev);
+    appendEdgeKey(&key, vIdLen, partId, srcId, type, rank, dstId, ev);
     return key;
 }
 
+// static
+void NebulaKeyUtils::appendEdgeKey(std::string* key,
+                                   size_t vIdLen,
+                                   PartitionID partId,
+                                   const VertexID& srcId,
+                                   EdgeType type,
+                                   EdgeRanking rank,
+                                   const VertexID& dstId,
+                                   EdgeVerPlaceHolder ev) {
+    CHECK_GE(vIdLen, srcId.size());
+    CHECK_GE(vIdLen, dstId.size());
+    int32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kEdge);
+    key->append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+        .append(srcId.data(), srcId.size())
+        .append(vIdLen - srcId.size(), '\0')
+        .append(reinterpret_cast<const char*>(&type), sizeof(EdgeType));
+    appendRank(key, rank);
+    key->append(dstId.data(), dstId.size())
+        .append(vIdLen - dstId.size(), '\0')
+        .append(1, ev);
+}
+
 // static
 std::string NebulaKeyUtils::systemCommitKey(PartitionID partId) {
     int32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kSystem);
@@ -81,6 +100,109 @@ std::string NebulaKeyUtils::systemPartKey(PartitionID partId) {
     return key;
 }
 
+// static
+std::string NebulaKeyUtils::systemDedupKey(PartitionID partId, const std::string& writeId) {
+    uint32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kSystem);
+    uint32_t type = static_cast<uint32_t>(NebulaSystemKeyType::kSystemDedup);
+    std::string key;
+    key.reserve(kSystemLen + writeId.size());
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+       .append(reinterpret_cast<const char*>(&type), sizeof(NebulaSystemKeyType))
+       .append(writeId);
+    return key;
+}
+
+// static
+std::string NebulaKeyUtils::systemStatisKey(PartitionID partId) {
+    uint32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kSystem);
+    uint32_t type = static_cast<uint32_t>(NebulaSystemKeyType::kSystemStatis);
+    std::string key;
+    key.reserve(kSystemLen);
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+       .append(reinterpret_cast<const char*>(&type), sizeof(NebulaSystemKeyType));
+    return key;
+}
+
+// static
+std::string NebulaKeyUtils::systemStatisBaseKey(PartitionID partId) {
+    uint32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kSystem);
+    uint32_t type = static_cast<uint32_t>(NebulaSystemKeyType::kSystemStatisBase);
+    std::string key;
+    key.reserve(kSystemLen);
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+       .append(reinterpret_cast<const char*>(&type), sizeof(NebulaSystemKeyType));
+    return key;
+}
+
+// static
+std::string NebulaKeyUtils::systemSplitKey(PartitionID partId) {
+    uint32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kSystem);
+    uint32_t type = static_cast<uint32_t>(NebulaSystemKeyType::kSystemSplit);
+    std::string key;
+    key.reserve(kSystemLen);
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+       .append(reinterpret_cast<const char*>(&type), sizeof(NebulaSystemKeyType));
+    return key;
+}
+
+// static
+std::string NebulaKeyUtils::systemDegreeKey(PartitionID partId) {
+    uint32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kSystem);
+    uint32_t type = static_cast<uint32_t>(NebulaSystemKeyType::kSystemDegree);
+    std::string key;
+    key.reserve(kSystemLen);
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+       .append(reinterpret_cast<const char*>(&type), sizeof(NebulaSystemKeyType));
+    return key;
+}
+
+// static
+std::string NebulaKeyUtils::systemHotVerticesKey(PartitionID partId) {
+    uint32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kSystem);
+    uint32_t type = static_cast<uint32_t>(NebulaSystemKeyType::kSystemHotVertices);
+    std::string key;
+    key.reserve(kSystemLen);
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+       .append(reinterpret_cast<const char*>(&type), sizeof(NebulaSystemKeyType));
+    return key;
+}
+
+// static
+std::string NebulaKeyUtils::systemIndexEncodingKey(PartitionID partId) {
+    uint32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kSystem);
+    uint32_t type = static_cast<uint32_t>(NebulaSystemKeyType::kSystemIndexEncoding);
+    std::string key;
+    key.reserve(kSystemLen);
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+       .append(reinterpret_cast<const char*>(&type), sizeof(NebulaSystemKeyType));
+    return key;
+}
+
+// static
+std::string NebulaKeyUtils::degreeKey(size_t vIdLen,
+                                      PartitionID partId,
+                                      const VertexID& vId,
+                                      EdgeType type) {
+    CHECK_GE(vIdLen, vId.size());
+    PartitionID item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kDegree);
+    std::string key;
+    key.reserve(sizeof(PartitionID) + vIdLen + sizeof(EdgeType));
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+       .append(vId.data(), vId.size())
+       .append(vIdLen - vId.size(), '\0')
+       .append(reinterpret_cast<const char*>(&type), sizeof(EdgeType));
+    return key;
+}
+
+// static
+std::string NebulaKeyUtils::degreePrefix(PartitionID partId) {
+    PartitionID item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kDegree);
+    std::string key;
+    key.reserve(sizeof(PartitionID));
+    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID));
+    return key;
+}
+
 // static
 std::string NebulaKeyUtils::kvKey(PartitionID partId, const folly::StringPiece& name) {
     std::string key;
@@ -130,18 +252,26 @@ std::string NebulaKeyUtils::vertexPrefix(PartitionID partId) {
 // static
 std::string NebulaKeyUtils::edgePrefix(size_t vIdLen, PartitionID partId,
                                        const VertexID& srcId, EdgeType type) {
-    CHECK_GE(vIdLen, srcId.size());
-    PartitionID item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kEdge);
-
     std::string key;
     key.reserve(sizeof(PartitionID) + vIdLen + sizeof(EdgeType));
-    key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
-       .append(srcId.data(), srcId.size())
-       .append(vIdLen - srcId.size(), '\0')
-       .append(reinterpret_cast<const char*>(&type), sizeof(EdgeType));
+    appendEdgePrefix(&key, vIdLen, partId, srcId, type);
     return key;
 }
 
+// static
+void NebulaKeyUtils::appendEdgePrefix(std::string* key,
+                                      size_t vIdLen,
+                                      PartitionID partId,
+                                      const VertexID& srcId,
+                                      EdgeType type) {
+    CHECK_GE(vIdLen, srcId.size());
+    PartitionID item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kEdge);
+    key->append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+        .append(srcId.data(), srcId.size())
+        .append(vIdLen - srcId.size(), '\0')
+        .append(reinterpret_cast<const char*>(&type), sizeof(EdgeType));
+}
+
 // static
 std::string NebulaKeyUtils::edgePrefix(size_t vIdLen, PartitionID partId, const VertexID& srcId) {
     CHECK_GE(vIdLen, srcId.size());
@@ -178,9 +308,9 @@ std::string NebulaKeyUtils::edgePrefix(size_t vIdLen,
     key.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
        .append(srcId.data(), srcId.size())
        .append(vIdLen - srcId.size(), '\0')
-       .append(reinterpret_cast<const char*>(&type), sizeof(EdgeType))
-       .append(NebulaKeyUtils::encodeRank(rank))
-       .append(dstId.data(), dstId.size())
+       .append(reinterpret_cast<const char*>(&type), sizeof(EdgeType));
+    appendRank(&key, rank);
+    key.append(dstId.data(), dstId.size())
        .append(vIdLen - dstId.size(), '\0');
     return key;
 }
@@ -201,6 +331,18 @@ std::vector<std::string> NebulaKeyUtils::snapshotPrefix(PartitionID partId) {
     return result;
 }
 
+// static
+std::string NebulaKeyUtils::prefixEnd(const std::string& prefix) {
+    auto end = prefix;
+    while (!end.empty() && static_cast<uint8_t>(end.back()) == 0xFF) {
+        end.pop_back();
+    }
+    if (!end.empty()) {
+        end.back()++;
+    }
+    return end;
+}
+
 std::string NebulaKeyUtils::systemPrefix() {
     int8_t type = static_cast<uint32_t>(NebulaKeyType::kSystem);
     std::string key;
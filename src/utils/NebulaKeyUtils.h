@@ -53,10 +53,60 @@ public:
                                const VertexID& dstId,
                                EdgeVerPlaceHolder ev = 1);
 
+    /**
+     * The same keys appended to `key`, so a caller building keys in a loop could clear and
+     * reuse one string, which allocates only when it grows
+     * */
+    static void appendVertexKey(std::string* key,
+                                size_t vIdLen,
+                                PartitionID partId,
+                                const VertexID& vId,
+                                TagID tagId);
+
+    static void appendEdgeKey(std::string* key,
+                              size_t vIdLen,
+                              PartitionID partId,
+                              const VertexID& srcId,
+                              EdgeType type,
+                              EdgeRanking rank,
+                              const VertexID& dstId,
+                              EdgeVerPlaceHolder ev = 1);
+
     static std::string systemCommitKey(PartitionID partId);
 
     static std::string systemPartKey(PartitionID partId);
 
+    // The write of the part applied with the write id given by the client
+    static std::string systemDedupKey(PartitionID partId, const std::string& writeId);
+
+    // The counters of the part maintained incrementally, and the offset of them
+    static std::string systemStatisKey(PartitionID partId);
+
+    static std::string systemStatisBaseKey(PartitionID partId);
+
+    // The status of the split of the part, see kvstore::PartSplit
+    static std::string systemSplitKey(PartitionID partId);
+
+    // The last log of the part whose edges are counted by the degree counters
+    static std::string systemDegreeKey(PartitionID partId);
+
+    // The hot vertices of the part written by the leader, see storage::HotVertexWarmer
+    static std::string systemHotVerticesKey(PartitionID partId);
+
+    // The encoding of the index keys of the part, see IndexKeyUtils::indexEncoding
+    static std::string systemIndexEncodingKey(PartitionID partId);
+
+    /**
+     * The number of edges of the edge type of a vertex, see kvstore::PartDegrees. The in
+     * edges are counted by the negative edge type.
+     * */
+    static std::string degreeKey(size_t vIdLen,
+                                 PartitionID partId,
+                                 const VertexID& vId,
+                                 EdgeType type);
+
+    static std::string degreePrefix(PartitionID partId);
+
     static std::string kvKey(PartitionID partId, const folly::StringPiece& name);
 
     /**
@@ -79,6 +129,12 @@ public:
                                   const VertexID& srcId,
                                   EdgeType type);
 
+    static void appendEdgePrefix(std::string* key,
+                                 size_t vIdLen,
+                                 PartitionID partId,
+                                 const VertexID& srcId,
+                                 EdgeType type);
+
     static std::string edgePrefix(size_t vIdLen, PartitionID partId, const VertexID& srcId);
 
     static std::string edgePrefix(size_t vIdLen,
@@ -92,6 +148,12 @@ public:
 
     static std::string systemPrefix();
 
+    /**
+     * The smallest key greater than all keys with the prefix, which is the end of range to
+     * remove all of them. Empty if there is not, i.e. the prefix is all 0xFF.
+     * */
+    static std::string prefixEnd(const std::string& prefix);
+
     static std::vector<std::string> snapshotPrefix(PartitionID partId);
 
     static PartitionID getPart(const folly::StringPiece& rawKey) {
@@ -147,6 +209,15 @@ public:
         return static_cast<NebulaKeyType>(type) == NebulaKeyType::kSystem;
     }
 
+    static bool isKV(const folly::StringPiece& rawKey) {
+        if (rawKey.size() < sizeof(PartitionID)) {
+            return false;
+        }
+        constexpr int32_t len = static_cast<int32_t>(sizeof(NebulaKeyType));
+        auto type = readInt<uint32_t>(rawKey.data(), len) & kTypeMask;
+        return static_cast<NebulaKeyType>(type) == NebulaKeyType::kKeyValue;
+    }
+
     static bool isSystemCommit(const folly::StringPiece& rawKey) {
         if (rawKey.size() != kSystemLen) {
             return false;
@@ -173,6 +244,19 @@ public:
         return static_cast<NebulaSystemKeyType>(type) == NebulaSystemKeyType::kSystemPart;
     }
 
+    static bool isSystemDedup(const folly::StringPiece& rawKey) {
+        if (rawKey.size() <= kSystemLen) {
+            return false;
+        }
+        if (!isSystem(rawKey)) {
+            return false;
+        }
+        auto position = rawKey.data() + sizeof(PartitionID);
+        auto len = sizeof(NebulaSystemKeyType);
+        auto type = readInt<uint32_t>(position, len);
+        return static_cast<NebulaSystemKeyType>(type) == NebulaSystemKeyType::kSystemDedup;
+    }
+
     static VertexIDSlice getSrcId(size_t vIdLen, const folly::StringPiece& rawKey) {
         if (rawKey.size() < kEdgeLen + (vIdLen << 1)) {
             dumpBadKey(rawKey, kEdgeLen + (vIdLen << 1), vIdLen);
@@ -207,14 +291,18 @@ public:
     }
 
     static std::string encodeRank(EdgeRanking rank) {
-        rank ^= folly::to<int64_t>(1) << 63;
-        auto val = folly::Endian::big(rank);
         std::string raw;
         raw.reserve(sizeof(int64_t));
-        raw.append(reinterpret_cast<const char*>(&val), sizeof(int64_t));
+        appendRank(&raw, rank);
         return raw;
     }
 
+    static void appendRank(std::string* raw, EdgeRanking rank) {
+        rank ^= folly::to<int64_t>(1) << 63;
+        auto val = folly::Endian::big(rank);
+        raw->append(reinterpret_cast<const char*>(&val), sizeof(int64_t));
+    }
+
     static EdgeRanking decodeRank(const folly::StringPiece& raw) {
         auto val = *reinterpret_cast<const int64_t*>(raw.data());
         val = folly::Endian::big(val);
@@ -59,6 +59,28 @@ std::string OperationKeyUtils::getOperationKey(const folly::StringPiece& rawValu
     return rawValue.subpiece(offset).toString();
 }
 
+// static
+std::string OperationKeyUtils::checkpointKey(PartitionID part, const std::string& start) {
+    uint32_t item = (part << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kOperation);
+    int64_t ts = 0;
+    uint32_t type = static_cast<uint32_t>(NebulaOperationType::kCheckpoint);
+    std::string result;
+    result.reserve(sizeof(int32_t) + sizeof(int64_t) + sizeof(NebulaOperationType) + start.size());
+    result.append(reinterpret_cast<const char*>(&item), sizeof(PartitionID))
+          .append(reinterpret_cast<const char*>(&ts), sizeof(int64_t))
+          .append(reinterpret_cast<const char*>(&type), sizeof(NebulaOperationType))
+          .append(start);
+    return result;
+}
+
+// static
+bool OperationKeyUtils::isCheckpoint(const folly::StringPiece& rawKey) {
+    auto position = rawKey.data() + sizeof(PartitionID) + sizeof(int64_t);
+    auto len = sizeof(NebulaOperationType);
+    auto type = readInt<uint32_t>(position, len);
+    return static_cast<uint32_t>(NebulaOperationType::kCheckpoint) == type;
+}
+
 // static
 std::string OperationKeyUtils::operationPrefix(PartitionID partId) {
     uint32_t item = (partId << kPartitionOffset) | static_cast<uint32_t>(NebulaKeyType::kOperation);
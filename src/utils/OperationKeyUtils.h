@@ -28,6 +28,13 @@ public:
 
     static std::string getOperationKey(const folly::StringPiece& rawValue);
 
+    // The progress of rebuilding the range from start of the part. It is kept with the
+    // operation logs so that it is removed with the legacy logs, and its ts is 0 so that the
+    // checkpoints are before all the logs of the part.
+    static std::string checkpointKey(PartitionID part, const std::string& start);
+
+    static bool isCheckpoint(const folly::StringPiece& rawKey);
+
     static std::string operationPrefix(PartitionID part);
 
 private:
@@ -0,0 +1,113 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "utils/ThreadPoolStats.h"
+
+DEFINE_int32(thread_pool_stats_interval_ms, 0,
+             "The interval the queue length and the active threads of each thread pool are "
+             "sampled into /stats, the wait and run time of the tasks are exported as well, "
+             "0 means disabled");
+
+namespace nebula {
+
+ThreadPoolStats::ThreadPoolStats(int32_t intervalMs)
+    : intervalMs_(intervalMs) {}
+
+ThreadPoolStats::~ThreadPoolStats() {
+    stop();
+}
+
+std::shared_ptr<ThreadPoolStats::Pool> ThreadPoolStats::newPool(const std::string& name) {
+    auto pool = std::make_shared<Pool>();
+    auto prefix = folly::stringPrintf("thread_pool_%s_", name.c_str());
+    pool->queueLength = stats::StatsManager::registerHisto(
+        prefix + "queue_length", 10, 0, 10000, "avg, p75, p95, p99");
+    pool->activeThreads = stats::StatsManager::registerHisto(
+        prefix + "active_threads", 1, 0, 1024, "avg, p75, p95, p99");
+    // up to 10 seconds
+    pool->waitTime = stats::StatsManager::registerHisto(
+        prefix + "wait_us", 1000, 0, 10000000, "avg, p75, p95, p99");
+    pool->runTime = stats::StatsManager::registerHisto(
+        prefix + "run_us", 1000, 0, 10000000, "avg, p75, p95, p99");
+    return pool;
+}
+
+void ThreadPoolStats::addPool(const std::string& name, folly::ThreadPoolExecutor* executor) {
+    CHECK_NOTNULL(executor);
+    auto pool = newPool(name);
+    pool->executor = executor;
+    executor->subscribeToTaskStats([pool] (folly::ThreadPoolExecutor::TaskStats taskStats) {
+        if (!pool->enabled.load(std::memory_order_relaxed)) {
+            return;
+        }
+        using std::chrono::duration_cast;
+        using std::chrono::microseconds;
+        stats::StatsManager::addValue(
+            pool->waitTime, duration_cast<microseconds>(taskStats.waitTime).count());
+        stats::StatsManager::addValue(
+            pool->runTime, duration_cast<microseconds>(taskStats.runTime).count());
+    });
+    std::lock_guard<std::mutex> g(lock_);
+    pools_.emplace_back(std::move(pool));
+}
+
+void ThreadPoolStats::addPool(const std::string& name,
+                              apache::thrift::concurrency::ThreadManager* threadManager) {
+    CHECK_NOTNULL(threadManager);
+    auto pool = newPool(name);
+    pool->threadManager = threadManager;
+    std::lock_guard<std::mutex> g(lock_);
+    pools_.emplace_back(std::move(pool));
+}
+
+bool ThreadPoolStats::start() {
+    worker_ = std::make_unique<thread::GenericWorker>();
+    if (!worker_->start("pool-stats")) {
+        return false;
+    }
+    worker_->addRepeatTask(intervalMs_, &ThreadPoolStats::sample, this);
+    return true;
+}
+
+void ThreadPoolStats::stop() {
+    if (worker_ != nullptr) {
+        worker_->stop();
+        worker_->wait();
+        worker_.reset();
+    }
+    std::lock_guard<std::mutex> g(lock_);
+    for (auto& pool : pools_) {
+        pool->enabled.store(false, std::memory_order_relaxed);
+    }
+    pools_.clear();
+}
+
+void ThreadPoolStats::sample() {
+    std::lock_guard<std::mutex> g(lock_);
+    for (auto& pool : pools_) {
+        if (pool->executor != nullptr) {
+            auto poolStats = pool->executor->getPoolStats();
+            stats::StatsManager::addValue(pool->queueLength, poolStats.pendingTaskCount);
+            stats::StatsManager::addValue(pool->activeThreads, poolStats.activeThreadCount);
+            continue;
+        }
+        auto* threadManager = pool->threadManager;
+        auto workers = threadManager->workerCount();
+        auto idle = threadManager->idleWorkerCount();
+        stats::StatsManager::addValue(pool->queueLength, threadManager->pendingTaskCount());
+        stats::StatsManager::addValue(pool->activeThreads, workers > idle ? workers - idle : 0);
+        // the averages of the tasks run since the last sample, none if there is no task
+        std::chrono::microseconds waitTime{0};
+        std::chrono::microseconds runTime{0};
+        threadManager->getStats(waitTime, runTime, std::numeric_limits<int64_t>::max());
+        if (waitTime.count() > 0 || runTime.count() > 0) {
+            stats::StatsManager::addValue(pool->waitTime, waitTime.count());
+            stats::StatsManager::addValue(pool->runTime, runTime.count());
+        }
+    }
+}
+
+}  // namespace nebula
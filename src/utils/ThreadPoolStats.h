@@ -0,0 +1,74 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#ifndef UTILS_THREADPOOLSTATS_H_
+#define UTILS_THREADPOOLSTATS_H_
+
+#include "common/base/Base.h"
+#include "common/stats/StatsManager.h"
+#include "common/thread/GenericWorker.h"
+#include <folly/executors/ThreadPoolExecutor.h>
+#include <thrift/lib/cpp/concurrency/ThreadManager.h>
+
+DECLARE_int32(thread_pool_stats_interval_ms);
+
+namespace nebula {
+
+/*
+ThreadPoolStats exports how busy each thread pool of a daemon is into the histograms of the
+StatsManager, so /stats tells whether the pools are the bottleneck rather than rocksdb:
+  thread_pool_<name>_queue_length     the tasks waiting, sampled every interval
+  thread_pool_<name>_active_threads   the threads running a task, sampled every interval
+  thread_pool_<name>_wait_us          the time a task waits in the queue
+  thread_pool_<name>_run_us           the time a task runs
+The wait and run time of each task of a folly pool are reported by the pool. A ThreadManager
+only reports the averages of the tasks since the last time, which is added once an interval,
+and it must be created with the stats enabled.
+
+The pools added must outlive stop(). The tasks run on the IO pools are mostly the callbacks of
+their event bases, which are not counted as tasks.
+*/
+class ThreadPoolStats final {
+public:
+    explicit ThreadPoolStats(int32_t intervalMs);
+
+    ~ThreadPoolStats();
+
+    void addPool(const std::string& name, folly::ThreadPoolExecutor* pool);
+
+    void addPool(const std::string& name, apache::thrift::concurrency::ThreadManager* pool);
+
+    bool start();
+
+    void stop();
+
+    // Called every interval by the worker started, public for the tests
+    void sample();
+
+private:
+    struct Pool {
+        folly::ThreadPoolExecutor*                      executor{nullptr};
+        apache::thrift::concurrency::ThreadManager*     threadManager{nullptr};
+        stats::CounterId                                queueLength;
+        stats::CounterId                                activeThreads;
+        stats::CounterId                                waitTime;
+        stats::CounterId                                runTime;
+        // the callback subscribed to a folly pool can't be removed, it stops adding once off
+        std::atomic<bool>                               enabled{true};
+    };
+
+    std::shared_ptr<Pool> newPool(const std::string& name);
+
+private:
+    const int32_t                                       intervalMs_;
+    std::unique_ptr<thread::GenericWorker>              worker_;
+    std::mutex                                          lock_;
+    std::vector<std::shared_ptr<Pool>>                  pools_;
+};
+
+}  // namespace nebula
+
+#endif  // UTILS_THREADPOOLSTATS_H_
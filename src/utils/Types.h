@@ -19,16 +19,25 @@ enum class NebulaKeyType : uint32_t {
     kSystem            = 0x00000004,
     kOperation         = 0x00000005,
     kKeyValue          = 0x00000006,
+    kDegree            = 0x00000007,
 };
 
 enum class NebulaSystemKeyType : uint32_t {
-    kSystemCommit      = 0x00000001,
-    kSystemPart        = 0x00000002,
+    kSystemCommit        = 0x00000001,
+    kSystemPart          = 0x00000002,
+    kSystemDedup         = 0x00000003,
+    kSystemStatis        = 0x00000004,
+    kSystemStatisBase    = 0x00000005,
+    kSystemSplit         = 0x00000006,
+    kSystemDegree        = 0x00000007,
+    kSystemHotVertices   = 0x00000008,
+    kSystemIndexEncoding = 0x00000009,
 };
 
 enum class NebulaOperationType : uint32_t {
     kModify            = 0x00000001,
     kDelete            = 0x00000002,
+    kCheckpoint        = 0x00000003,
 };
 
 using VertexIDSlice = folly::StringPiece;
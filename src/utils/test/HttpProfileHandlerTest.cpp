@@ -0,0 +1,78 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include <gtest/gtest.h>
+#include <folly/system/ThreadName.h>
+#include "utils/HttpProfileHandler.h"
+
+namespace nebula {
+
+// Keep busy on a few threads named like a pool
+class BusyThreads {
+public:
+    explicit BusyThreads(int32_t num) {
+        for (int32_t i = 0; i < num; i++) {
+            threads_.emplace_back([this, i] {
+                folly::setThreadName(folly::stringPrintf("busy-pool-%d", i));
+                volatile uint64_t sum = 0;
+                while (!stopped_) {
+                    sum = sum + 1;
+                }
+            });
+        }
+    }
+
+    ~BusyThreads() {
+        stopped_ = true;
+        for (auto& t : threads_) {
+            t.join();
+        }
+    }
+
+private:
+    std::atomic<bool> stopped_{false};
+    std::vector<std::thread> threads_;
+};
+
+TEST(HttpProfileHandlerTest, CpuProfileTest) {
+    BusyThreads busy(2);
+    auto ret = HttpProfileHandler::profileCpu(1, 99);
+    ASSERT_TRUE(ret.ok()) << ret.status();
+    const auto& folded = ret.value();
+    ASSERT_FALSE(folded.empty());
+    // each line is the stack and its count
+    std::vector<folly::StringPiece> lines;
+    folly::split('\n', folded, lines, true);
+    int64_t total = 0;
+    for (auto line : lines) {
+        auto pos = line.rfind(' ');
+        ASSERT_NE(folly::StringPiece::npos, pos) << line;
+        total += folly::to<int64_t>(line.subpiece(pos + 1));
+    }
+    ASSERT_GT(total, 0);
+}
+
+TEST(HttpProfileHandlerTest, ThreadPoolUsageTest) {
+    BusyThreads busy(2);
+    auto usage = HttpProfileHandler::threadPoolUsage(1);
+    ASSERT_TRUE(usage.isObject());
+    auto* pool = usage.get_ptr("busy-pool");
+    ASSERT_NE(nullptr, pool);
+    ASSERT_EQ(2, (*pool)["threads"].asInt());
+    // two threads spinning, allowing for a loaded machine
+    ASSERT_GT((*pool)["cpu_percent"].asDouble(), 50.0);
+    ASSERT_LE((*pool)["busy_percent"].asDouble(), 100.0 + 1);
+}
+
+}  // namespace nebula
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+
+    return RUN_ALL_TESTS();
+}
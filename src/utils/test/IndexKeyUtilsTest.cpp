@@ -133,6 +133,32 @@ TEST(IndexKeyUtilsTest, encodeValue) {
     EXPECT_TRUE(evalDateTime(dt));
 }
 
+TEST(IndexKeyUtilsTest, appendValue) {
+    // the values appended one after another are the same as the ones encoded
+    std::vector<Value> values{Value(10L), Value(1.5), Value(true), Value("str"),
+                              Value(nebula::Date(2020, 4, 11))};
+    std::string raw = "head";
+    std::string expected = "head";
+    for (const auto& v : values) {
+        IndexKeyUtils::appendValue(&raw, v);
+        expected.append(IndexKeyUtils::encodeValue(v));
+    }
+    EXPECT_EQ(expected, raw);
+
+    raw.clear();
+    IndexKeyUtils::appendValue(&raw, Value("abc"), 5);
+    EXPECT_EQ(IndexKeyUtils::encodeValue(Value("abc"), 5), raw);
+    EXPECT_EQ(5, raw.size());
+    raw.clear();
+    IndexKeyUtils::appendValue(&raw, Value("abcdef"), 3);
+    EXPECT_EQ("abc", raw);
+
+    int16_t len = 4;
+    raw.clear();
+    IndexKeyUtils::appendNullValue(&raw, Value::Type::STRING, &len);
+    EXPECT_EQ(IndexKeyUtils::encodeNullValue(Value::Type::STRING, &len), raw);
+}
+
 TEST(IndexKeyUtilsTest, encodeDouble) {
     EXPECT_TRUE(evalDouble(100.5));
     EXPECT_TRUE(evalDouble(200.5));
@@ -345,6 +371,24 @@ void verifyDecodeIndexKey(bool isEdge,
 
         ASSERT_EQ(data[j].second, actual);
     }
+
+    // decode by the field located once
+    std::vector<IndexKeyUtils::IndexField> fields;
+    for (const auto& col : cols) {
+        IndexKeyUtils::IndexField field;
+        ASSERT_TRUE(IndexKeyUtils::locateIndexField(col.get_name(), cols, nullable, field));
+        fields.emplace_back(std::move(field));
+    }
+    IndexKeyUtils::IndexField notExist;
+    ASSERT_FALSE(IndexKeyUtils::locateIndexField("not_exist", cols, nullable, notExist));
+    for (size_t j = 0; j < data.size(); j++) {
+        std::vector<Value> actual;
+        for (const auto& field : fields) {
+            actual.emplace_back(IndexKeyUtils::getValueFromIndexKey(
+                vIdLen, indexKeys[j], field, isEdge));
+        }
+        ASSERT_EQ(data[j].second, actual);
+    }
 }
 
 TEST(IndexKeyUtilsTest, getValueFromIndexKeyTest) {
@@ -497,6 +541,61 @@ TEST(IndexKeyUtilsTest, getValueFromIndexKeyTest) {
     }
 }
 
+TEST(IndexKeyUtilsTest, compactStringTest) {
+    meta::cpp2::ColumnDef col;
+    col.set_name("col_string");
+    col.type.set_type(meta::cpp2::PropertyType::FIXED_STRING);
+    col.type.set_type_length(20);
+    col.set_nullable(true);
+    auto encode = [&col] (Value v) {
+        return IndexKeyUtils::encodeValues({std::move(v)}, {col});
+    };
+
+    auto defaultPrefixLen = FLAGS_index_string_prefix_len;
+    {
+        // padded to the length of column, with the nullable bits
+        FLAGS_index_string_prefix_len = 0;
+        EXPECT_FALSE(IndexKeyUtils::isCompactString(col));
+        EXPECT_EQ(20 + sizeof(u_short), encode(Value("abc")).size());
+    }
+    {
+        // not compact unless the column is longer than the prefix and the hash
+        FLAGS_index_string_prefix_len = 16;
+        EXPECT_FALSE(IndexKeyUtils::isCompactString(col));
+        EXPECT_EQ(20, IndexKeyUtils::indexFieldLen(col));
+    }
+    {
+        FLAGS_index_string_prefix_len = 8;
+        ASSERT_TRUE(IndexKeyUtils::isCompactString(col));
+        auto len = 8 + IndexKeyUtils::kStringHashLen;
+        EXPECT_EQ(len, IndexKeyUtils::indexFieldLen(col));
+        EXPECT_EQ(len + sizeof(u_short), IndexKeyUtils::indexValuesLen({col}));
+
+        auto shortStr = encode(Value("abc"));
+        ASSERT_EQ(len + sizeof(u_short), shortStr.size());
+        EXPECT_EQ(std::string("abc").append(5, '\0'), shortStr.substr(0, 8));
+        EXPECT_EQ(shortStr, encode(Value("abc")));
+
+        // the same prefix, told apart by the hash
+        auto long1 = encode(Value("abcdefgh_1"));
+        auto long2 = encode(Value("abcdefgh_2"));
+        EXPECT_EQ(long1.substr(0, 8), long2.substr(0, 8));
+        EXPECT_NE(long1.substr(8, 4), long2.substr(8, 4));
+        // truncated to the length of column before hashed
+        EXPECT_EQ(encode(Value("abcdefghijklmnopqrst")), encode(Value("abcdefghijklmnopqrstuvw")));
+
+        EXPECT_EQ(std::string(len, static_cast<char>(0xFF)),
+                  encode(Value(NullType::__NULL__)).substr(0, len));
+
+        EXPECT_TRUE(IndexKeyUtils::fitsCompactPrefix(IndexKeyUtils::encodeValue(Value("abc"), 20)));
+        EXPECT_TRUE(IndexKeyUtils::fitsCompactPrefix(
+            IndexKeyUtils::encodeValue(Value("abcdefgh"), 20)));
+        EXPECT_FALSE(IndexKeyUtils::fitsCompactPrefix(
+            IndexKeyUtils::encodeValue(Value("abcdefghi"), 20)));
+    }
+    FLAGS_index_string_prefix_len = defaultPrefixLen;
+}
+
 }   // namespace nebula
 
 int main(int argc, char** argv) {
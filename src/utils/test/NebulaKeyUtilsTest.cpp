@@ -189,9 +189,60 @@ TEST(KeyUtilsTest, MiscTest) {
     ASSERT_TRUE(NebulaKeyUtils::isSystemCommit(commitKey));
     auto partKey = NebulaKeyUtils::systemPartKey(partId);
     ASSERT_TRUE(NebulaKeyUtils::isSystemPart(partKey));
+    auto dedupKey = NebulaKeyUtils::systemDedupKey(partId, "write-1");
+    ASSERT_TRUE(NebulaKeyUtils::isSystemDedup(dedupKey));
+    ASSERT_FALSE(NebulaKeyUtils::isSystemDedup(partKey));
+    ASSERT_FALSE(NebulaKeyUtils::isSystemPart(dedupKey));
+    auto statisKey = NebulaKeyUtils::systemStatisKey(partId);
+    auto statisBaseKey = NebulaKeyUtils::systemStatisBaseKey(partId);
+    ASSERT_NE(statisKey, statisBaseKey);
+    ASSERT_FALSE(NebulaKeyUtils::isSystemDedup(statisKey));
+    ASSERT_FALSE(NebulaKeyUtils::isSystemPart(statisBaseKey));
     auto systemPrefix = NebulaKeyUtils::systemPrefix();
     ASSERT_EQ(commitKey.find(systemPrefix), 0);
     ASSERT_EQ(partKey.find(systemPrefix), 0);
+    ASSERT_EQ(dedupKey.find(systemPrefix), 0);
+    ASSERT_EQ(statisKey.find(systemPrefix), 0);
+    ASSERT_EQ(statisBaseKey.find(systemPrefix), 0);
+}
+
+TEST(KeyUtilsTest, PrefixEndTest) {
+    ASSERT_EQ("b", NebulaKeyUtils::prefixEnd("a"));
+    ASSERT_EQ("b", NebulaKeyUtils::prefixEnd("a\xFF\xFF"));
+    ASSERT_EQ("", NebulaKeyUtils::prefixEnd("\xFF"));
+
+    auto prefix = NebulaKeyUtils::vertexPrefix(8, 1, "vid");
+    auto end = NebulaKeyUtils::prefixEnd(prefix);
+    auto key = NebulaKeyUtils::vertexKey(8, 1, "vid", 100);
+    ASSERT_LT(prefix, key);
+    ASSERT_LT(key, end);
+    ASSERT_LT(end, NebulaKeyUtils::vertexKey(8, 1, "vie", 100));
+}
+
+TEST(KeyUtilsTest, AppendTest) {
+    // the keys appended into a reused string are the same as the ones returned
+    std::string key;
+    NebulaKeyUtils::appendVertexKey(&key, 8, 1, "vid", 100);
+    ASSERT_EQ(NebulaKeyUtils::vertexKey(8, 1, "vid", 100), key);
+    auto capacity = key.capacity();
+
+    key.clear();
+    NebulaKeyUtils::appendVertexKey(&key, 8, 2, "other", 101);
+    ASSERT_EQ(NebulaKeyUtils::vertexKey(8, 2, "other", 101), key);
+    ASSERT_EQ(capacity, key.capacity());
+
+    key.clear();
+    NebulaKeyUtils::appendEdgeKey(&key, 8, 1, "src", -5, -1, "dst");
+    ASSERT_EQ(NebulaKeyUtils::edgeKey(8, 1, "src", -5, -1, "dst"), key);
+    ASSERT_EQ(-1, NebulaKeyUtils::getRank(8, key));
+
+    key.clear();
+    NebulaKeyUtils::appendEdgePrefix(&key, 8, 1, "src", -5);
+    ASSERT_EQ(NebulaKeyUtils::edgePrefix(8, 1, "src", -5), key);
+
+    std::string rank = "prefix";
+    NebulaKeyUtils::appendRank(&rank, 7);
+    ASSERT_EQ("prefix" + NebulaKeyUtils::encodeRank(7), rank);
 }
 
 
@@ -22,6 +22,18 @@ TEST(OperationKeyUtilsTest, DeleteKeyTest) {
     ASSERT_TRUE(OperationKeyUtils::isDeleteOperation(opKey));
 }
 
+TEST(OperationKeyUtilsTest, CheckpointKeyTest) {
+    PartitionID part = 1;
+    auto key = OperationKeyUtils::checkpointKey(part, "range start");
+    ASSERT_TRUE(OperationKeyUtils::isCheckpoint(key));
+    ASSERT_FALSE(OperationKeyUtils::isModifyOperation(key));
+    ASSERT_FALSE(OperationKeyUtils::isDeleteOperation(key));
+    ASSERT_TRUE(folly::StringPiece(key).startsWith(OperationKeyUtils::operationPrefix(part)));
+    // the checkpoints are before the operation logs
+    ASSERT_LT(key, OperationKeyUtils::deleteOperationKey(part));
+    ASSERT_LT(key, OperationKeyUtils::modifyOperationKey(part, "modify key"));
+}
+
 }  // namespace nebula
 
 int main(int argc, char** argv) {
@@ -0,0 +1,89 @@
+/* Copyright (c) 2021 vesoft inc. All rights reserved.
+ *
+ * This source code is licensed under Apache 2.0 License,
+ * attached with Common Clause Condition 1.0, found in the LICENSES directory.
+ */
+
+#include "common/base/Base.h"
+#include <gtest/gtest.h>
+#include <folly/executors/CPUThreadPoolExecutor.h>
+#include <folly/synchronization/Baton.h>
+#include "utils/ThreadPoolStats.h"
+
+namespace nebula {
+
+TEST(ThreadPoolStatsTest, FollyPoolTest) {
+    folly::CPUThreadPoolExecutor executor(2);
+    ThreadPoolStats stats(100);
+    stats.addPool("test_cpu", &executor);
+
+    folly::Baton<> started;
+    folly::Baton<> blocked;
+    executor.add([&] {
+        started.post();
+        blocked.wait();
+    });
+    started.wait();
+    for (int32_t i = 0; i < 4; i++) {
+        executor.add([] {
+            usleep(10000);
+        });
+    }
+    // one running of the two threads, and one of the four waiting at least
+    stats.sample();
+    blocked.post();
+    executor.join();
+
+    auto active = stats::StatsManager::readValue("thread_pool_test_cpu_active_threads.avg.60");
+    ASSERT_TRUE(active.ok());
+    EXPECT_GE(active.value(), 1);
+    auto runTime = stats::StatsManager::readValue("thread_pool_test_cpu_run_us.p99.60");
+    ASSERT_TRUE(runTime.ok());
+    EXPECT_GE(runTime.value(), 10000);
+
+    // nothing is added once stopped
+    stats.stop();
+}
+
+TEST(ThreadPoolStatsTest, ThreadManagerTest) {
+    auto threadManager =
+        apache::thrift::concurrency::PriorityThreadManager::newPriorityThreadManager(
+            1, true /*stats*/);
+    threadManager->setNamePrefix("test");
+    threadManager->start();
+    ThreadPoolStats stats(100);
+    stats.addPool("test_workers", threadManager.get());
+    ASSERT_TRUE(stats.start());
+
+    folly::Baton<> done;
+    for (int32_t i = 0; i < 4; i++) {
+        threadManager->add([&done, i] {
+            usleep(10000);
+            if (i == 3) {
+                done.post();
+            }
+        });
+    }
+    done.wait();
+    // the averages are added by the worker of stats
+    usleep(300000);
+    stats.stop();
+
+    auto runTime = stats::StatsManager::readValue("thread_pool_test_workers_run_us.avg.60");
+    ASSERT_TRUE(runTime.ok());
+    EXPECT_GE(runTime.value(), 10000);
+    auto waitTime = stats::StatsManager::readValue("thread_pool_test_workers_wait_us.avg.60");
+    ASSERT_TRUE(waitTime.ok());
+    EXPECT_GT(waitTime.value(), 0);
+    threadManager->join();
+}
+
+}  // namespace nebula
+
+
+int main(int argc, char** argv) {
+    testing::InitGoogleTest(&argc, argv);
+    folly::init(&argc, &argv, true);
+    google::SetStderrLogging(google::INFO);
+    return RUN_ALL_TESTS();
+}